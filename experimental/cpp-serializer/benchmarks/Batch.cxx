@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <streambuf>
+
+#include "Batch.h"
+#include "Numa.h"
+#include "Corpus.h"
+#include "PerfCounters.h"
+#include "amqp/ReaderCache.h"
+#include "stats/Stats.h"
+
+/******************************************************************************
+ *
+ * Batch mode over a generated corpus on 1, 2, 4 ... threads, up to as many
+ * as the machine has, so whether the work stealing pool and the shared
+ * reader cache scale can be seen before new hardware is rolled out. Each
+ * thread count is run twice
+ *
+ *   shared  - the workers left wherever the scheduler puts them
+ *   node    - the workers pinned across the NUMA nodes, each blob read
+ *             into memory on its worker's node
+ *
+ * Both read ahead so only the pinning differs. Every run reports blobs
+ * and bytes per second, the p50 and p99 of how long a worker spent on a
+ * blob, in microseconds, and the reader cache's hit rate, plus, with
+ * AMQP_PERF set, the CPU's counters per blob and byte across every
+ * worker, see [PerfCounters]. Run with
+ * --benchmark_filter=Batch --benchmark_format=json, or --benchmark_out,
+ * for results to track over time.
+ *
+ ******************************************************************************/
+
+namespace {
+
+    using amqp::internal::stats::Stats;
+
+    /**
+     * Blobs of a few KB in several shapes, and so several schemas, many
+     * of each so most blobs find their readers already cached
+     */
+    constexpr size_t BLOBS = 2048;
+    constexpr size_t SHAPES = 8;
+
+    /**
+     * Reads waiting on a worker
+     */
+    constexpr size_t DEPTH = 64;
+
+    class Discard : public std::streambuf {
+        protected :
+            int overflow (int c_) override { return c_; }
+
+            std::streamsize xsputn (const char *, std::streamsize n_) override { return n_; }
+    };
+
+    struct Blobs {
+        Corpus m_corpus;
+        std::vector<std::string> m_files;
+        size_t m_bytes { 0 };
+
+        Blobs() : m_corpus (TEST_FILES) {
+            auto from = m_corpus.blobs().size();
+
+            for (size_t i { 0 } ; i < BLOBS ; ++i) {
+                Generator::Shape shape;
+                shape.m_depth = 2 + i % SHAPES / 4;
+                shape.m_fields = 2 + i % SHAPES;
+                shape.m_size = 4096;
+                shape.m_seed = static_cast<uint32_t> (i % SHAPES + 1);
+
+                m_corpus.generate ("batch-" + std::to_string (i), shape);
+            }
+
+            for (auto i { from } ; i < m_corpus.blobs().size() ; ++i) {
+                m_files.push_back (m_corpus.blobs()[i].m_path);
+                m_bytes += m_corpus.blobs()[i].m_size;
+            }
+        }
+    };
+
+    const Blobs &
+    blobs() {
+        static Blobs blobs;
+        return blobs;
+    }
+
+    void
+    threads (benchmark::internal::Benchmark * b_) {
+        auto most = std::max<int> (1, static_cast<int> (std::thread::hardware_concurrency()));
+
+        for (int numa : { 0, 1 }) {
+            for (int n { 1 } ; ; n *= 2) {
+                b_->Args ({ std::min (n, most), numa });
+                if (n >= most) break;
+            }
+        }
+
+        b_->ArgNames ({ "threads", "numa" });
+    }
+
+}
+
+/******************************************************************************/
+
+static void
+BatchScaling (benchmark::State & state_) {
+    const auto & corpus = blobs();
+
+    Batch::Options options;
+    options.m_threads = static_cast<size_t> (state_.range (0));
+    options.m_numa = state_.range (1) != 0;
+    options.m_depth = DEPTH;
+    options.m_ordered = false;
+
+    Batch batch (corpus.m_files, options);
+
+    Discard discard;
+    std::ostream out (&discard);
+
+    auto & cache = amqp::internal::ReaderCache::instance();
+
+    // warm, so every run starts with the schemas already compiled
+    batch.run (out);
+
+    auto hits = cache.hits();
+    auto misses = cache.misses();
+
+    Stats::instance().clear();
+    Stats::enable();
+
+    size_t failures { 0 };
+
+    PerfCounters perf;
+    perf.start();
+
+    for (auto _ : state_) {
+        failures += batch.run (out);
+    }
+
+    perf.stop();
+    Stats::enable (false);
+
+    if (failures) state_.SkipWithError ("blobs failed to decode");
+
+    hits = cache.hits() - hits;
+    misses = cache.misses() - misses;
+
+    auto & stats = Stats::instance();
+
+    state_.counters["p50_us"] = static_cast<double> (stats.percentile (0.5)) / 1e3;
+    state_.counters["p99_us"] = static_cast<double> (stats.percentile (0.99)) / 1e3;
+    state_.counters["hitRate"] = hits + misses == 0
+        ? 0.0
+        : static_cast<double> (hits) / static_cast<double> (hits + misses);
+    state_.counters["nodes"] = static_cast<double> (Numa::nodes());
+
+    auto iterations = static_cast<double> (state_.iterations());
+    perf.report (
+            state_,
+            iterations * static_cast<double> (corpus.m_files.size()),
+            iterations * static_cast<double> (corpus.m_bytes));
+
+    state_.SetLabel (options.m_numa ? "node" : "shared");
+    state_.SetItemsProcessed (static_cast<int64_t> (state_.iterations() * corpus.m_files.size()));
+    state_.SetBytesProcessed (static_cast<int64_t> (state_.iterations() * corpus.m_bytes));
+}
+
+BENCHMARK (BatchScaling)->Apply (threads)->UseRealTime()->Unit (benchmark::kMillisecond); // NOLINT
+
+/******************************************************************************/
@@ -0,0 +1,296 @@
+#include "Corpus.h"
+
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "types.h"
+#include "CordaBytes.h"
+#include "cursor/Cursor.h"
+#include "amqp/AMQPHeader.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+    namespace schema = amqp::internal::schema;
+
+    /**
+     * Header plus the encoding byte
+     */
+    const size_t PREAMBLE = amqp::AMQP_HEADER.size() + 1;
+
+    uPtr<schema::Envelope>
+    envelope (const char * blob_, size_t size_) {
+        cursor::Cursor data (blob_, size_);
+        cursor::auto_enter p (data);
+
+        auto a = data.get_ulong();
+
+        return uPtr<schema::Envelope> (
+                dynamic_cast<schema::Envelope *> (
+                        amqp::internal::AMQPDescriptorRegistory[a]->build (data).release()));
+    }
+
+    void
+    be32 (std::string & out_, uint32_t v_) {
+        out_ += static_cast<char> (v_ >> 24);
+        out_ += static_cast<char> (v_ >> 16);
+        out_ += static_cast<char> (v_ >> 8);
+        out_ += static_cast<char> (v_);
+    }
+
+    /**
+     * Copies a blob value by value. Lists are always written with 32 bit
+     * sizes since what they hold may no longer fit in a byte, everything
+     * else that isn't described is copied verbatim. Maps and arrays are
+     * never looked inside.
+     */
+    class Grower {
+        private :
+            const schema::Schema & m_schema;
+            size_t m_copies;
+            bool m_grown;
+
+            bool isList (const cursor::Cursor & descriptor_) const {
+                if (descriptor_.type() != cursor::symbol_t) return false;
+
+                auto descriptor = descriptor_.get_symbol();
+
+                if (m_schema.descriptorId (descriptor) == schema::SymbolTable::npos) {
+                    return false;
+                }
+
+                const auto & type = *m_schema.fromDescriptor (descriptor)->second.get();
+
+                return type.type() == schema::AMQPTypeNotation::restricted_t
+                    && dynamic_cast<const schema::Restricted &> (type).restrictedType()
+                            == schema::Restricted::RestrictedTypes::list_t;
+            }
+
+        public :
+            Grower (const schema::Schema & schema_, size_t copies_)
+                : m_schema (schema_)
+                , m_copies (copies_)
+                , m_grown (false)
+            { }
+
+            bool grown() const { return m_grown; }
+
+            /**
+             * [inside_] once within a list that's being repeated so no
+             * list within it is
+             */
+            void copy (cursor::Cursor &, std::string &, size_t repeat_, bool inside_);
+    };
+
+    void
+    Grower::copy (
+        cursor::Cursor & data_,
+        std::string & out_,
+        size_t repeat_,
+        bool inside_
+    ) {
+        switch (data_.type()) {
+            case cursor::described_t : {
+                out_ += '\0';
+
+                cursor::auto_enter ae (data_);
+
+                bool list = !inside_ && isList (data_);
+
+                out_.append (data_.encoded());
+                data_.next();
+
+                copy (data_, out_, list ? m_copies : 1, inside_ || list);
+                break;
+            }
+            case cursor::list_t : {
+                std::string body;
+                size_t elements { 0 };
+
+                {
+                    cursor::auto_list_enter ale (data_);
+
+                    while (data_.next()) {
+                        copy (data_, body, 1, inside_);
+                        ++elements;
+                    }
+                }
+
+                if (repeat_ > 1 && elements) m_grown = true;
+
+                out_ += '\xd0';
+                be32 (out_, static_cast<uint32_t> (4 + body.size() * repeat_));
+                be32 (out_, static_cast<uint32_t> (elements * repeat_));
+
+                for (size_t i { 0 } ; i < repeat_ ; ++i) {
+                    out_.append (body);
+                }
+
+                break;
+            }
+            default :
+                out_.append (data_.encoded());
+        }
+    }
+
+    std::string
+    slurp (const std::string & path_) {
+        std::ifstream file (path_, std::ios::binary);
+
+        return std::string (
+                std::istreambuf_iterator<char> (file),
+                std::istreambuf_iterator<char>());
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Corpus
+ *
+ ******************************************************************************/
+
+Corpus::Corpus (const std::string & dir_) {
+    std::vector<std::filesystem::path> files;
+
+    for (const auto & entry : std::filesystem::directory_iterator (dir_)) {
+        if (entry.is_regular_file()) files.push_back (entry.path());
+    }
+
+    std::sort (files.begin(), files.end());
+
+    for (const auto & file : files) {
+        add (file.filename().string(), file.string());
+    }
+
+    m_files = m_blobs.size();
+
+    std::stringstream ss;
+    ss << "blob-benchmarks-" << getpid();
+
+    m_scratch = (std::filesystem::temp_directory_path() / ss.str()).string();
+    std::filesystem::create_directories (m_scratch);
+}
+
+/******************************************************************************/
+
+Corpus::~Corpus() {
+    std::error_code ec;
+    std::filesystem::remove_all (m_scratch, ec);
+}
+
+/******************************************************************************/
+
+void
+Corpus::add (std::string name_, std::string path_) {
+    CordaBytes cb (path_);
+
+    m_blobs.push_back (Blob {
+        std::move (name_),
+        std::move (path_),
+        cb.size(),
+        values (cb.bytes(), cb.size()) });
+}
+
+/******************************************************************************/
+
+void
+Corpus::grow (size_t copies_) {
+    for (size_t i { 0 } ; i < m_files ; ++i) {
+        auto grown = grow (slurp (m_blobs[i].m_path), copies_);
+
+        if (grown.empty()) continue;
+
+        std::stringstream name;
+        name << m_blobs[i].m_name << "x" << copies_;
+
+        auto path = (std::filesystem::path (m_scratch) / name.str()).string();
+
+        std::ofstream (path, std::ios::binary).write (grown.data(), grown.size());
+
+        add (name.str(), path);
+    }
+}
+
+/******************************************************************************/
+
+void
+Corpus::generate (const std::string & name_, const Generator::Shape & shape_) {
+    auto path = (std::filesystem::path (m_scratch) / name_).string();
+
+    {
+        std::ofstream out (path, std::ios::binary);
+        Generator (shape_).write (out);
+    }
+
+    add (name_, path);
+}
+
+/******************************************************************************/
+
+size_t
+Corpus::values (const char * blob_, size_t size_) {
+    cursor::Cursor data (blob_, size_);
+
+    auto walk = [](cursor::Cursor & data_, auto & walk_) -> size_t {
+        size_t rtn { 0 };
+
+        do {
+            ++rtn;
+
+            switch (data_.type()) {
+                case cursor::described_t :
+                case cursor::list_t :
+                case cursor::map_t :
+                case cursor::array_t : {
+                    data_.enter();
+                    if (data_.next()) rtn += walk_ (data_, walk_);
+                    data_.exit();
+                    break;
+                }
+                default : break;
+            }
+        } while (data_.next());
+
+        return rtn;
+    };
+
+    return walk (data, walk);
+}
+
+/******************************************************************************/
+
+std::string
+Corpus::grow (const std::string & blob_, size_t copies_) {
+    if (blob_.size() < PREAMBLE) {
+        throw std::runtime_error ("Not a Corda stream");
+    }
+
+    const char * blob = blob_.data() + PREAMBLE;
+    size_t size = blob_.size() - PREAMBLE;
+
+    auto e = envelope (blob, size);
+
+    Grower grower (dynamic_cast<const schema::Schema &> (e->schema()), copies_);
+
+    std::string rtn { blob_.substr (0, PREAMBLE) };
+
+    cursor::Cursor data (blob, size);
+    grower.copy (data, rtn, 1, false);
+
+    return grower.grown() ? rtn : std::string();
+}
+
+/******************************************************************************/
@@ -0,0 +1,89 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+
+#include "Generator.h"
+
+/******************************************************************************/
+
+/**
+ * The blobs the benchmarks run over, every file in a directory of test
+ * files plus larger ones generated from them.
+ *
+ * A blob is generated by re-encoding a test file with the elements of
+ * each outermost list in its payload repeated a number of times. Lists
+ * are recognised by their descriptor naming a list type in the blob's
+ * own schema, so the generated blob is exactly what would be serialised
+ * had the object simply held more. Files without a list aren't grown.
+ *
+ * Others are synthesised outright by the corpus generator, see
+ * Generator, in whatever shape a benchmark needs.
+ *
+ * Generated blobs are written out beneath the system's temporary
+ * directory so they are loaded the same way as the test files, and
+ * removed again when the corpus is destroyed.
+ */
+class Corpus {
+    public :
+        struct Blob {
+            std::string m_name;
+            std::string m_path;
+            size_t      m_size;
+
+            /**
+             * The number of encoded values in the blob, envelope and
+             * schema included, this is what the benchmarks count as an
+             * object
+             */
+            size_t      m_values;
+        };
+
+    private :
+        std::vector<Blob> m_blobs;
+
+        /**
+         * How many of [m_blobs] are test files, the rest were grown
+         */
+        size_t m_files;
+
+        std::string m_scratch;
+
+        void add (std::string name_, std::string path_);
+
+    public :
+        explicit Corpus (const std::string & dir_);
+        Corpus (const Corpus &) = delete;
+
+        ~Corpus();
+
+        /**
+         * Add a blob for each test file already in the corpus with its
+         * lists made [copies_] times as long
+         */
+        void grow (size_t copies_);
+
+        /**
+         * Add a blob synthesised in the given shape
+         */
+        void generate (const std::string & name_, const Generator::Shape & shape_);
+
+        const std::vector<Blob> & blobs() const { return m_blobs; }
+
+        /**
+         * Walk every value of an encoded blob, entering every compound,
+         * returning how many there were
+         */
+        static size_t values (const char * blob_, size_t size_);
+
+        /**
+         * Re-encode [blob_], a whole Corda stream header and all, with
+         * its outermost lists repeated [copies_] times. Returns an empty
+         * string if it has no list to repeat
+         */
+        static std::string grow (const std::string & blob_, size_t copies_);
+};
+
+/******************************************************************************/
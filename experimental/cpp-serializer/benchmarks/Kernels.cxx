@@ -0,0 +1,162 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include "format/Json.h"
+#include "kernels/Kernels.h"
+
+/******************************************************************************
+ *
+ * Each variant of each kernel that can run here, over buffers from a
+ * cache line to a good deal more than fits in L2, so they can be
+ * compared with each other and with memcpy. Set AMQP_KERNELS to time the
+ * rest of the benchmarks with a particular variant.
+ *
+ ******************************************************************************/
+
+namespace {
+
+    namespace kernels = amqp::internal::kernels;
+
+    std::string
+    random (size_t size_) {
+        std::mt19937 rng (1);
+        std::string rtn (size_, '\0');
+
+        for (auto & c : rtn) c = static_cast<char> (rng());
+
+        return rtn;
+    }
+
+    /**
+     * Several KB of the sort of thing found in a contract's legal prose,
+     * plain ASCII with the odd quote and accented character
+     */
+    std::string
+    prose (size_t size_) {
+        static const std::string sentence {
+            "The \"Borrower\" shall repay the principal to the Lender, "
+            "together with interest at the rate set out in Schedule 1, "
+            "on or before the maturity date agreed by both parties. Any "
+            "payment made late shall incur a fee of 2% \xe2\x82\xac per "
+            "annum, save where the d\xc3\xa9lai is waived in writing.\n" };
+
+        std::string rtn;
+
+        while (rtn.size() < size_) rtn += sentence;
+        rtn.resize (size_);
+
+        return rtn;
+    }
+
+    void
+    variants (benchmark::internal::Benchmark * b_) {
+        for (int variant { 0 } ; variant < kernels::variants_t ; ++variant) {
+            if (!kernels::Kernels::supported (kernels::Variant (variant))) continue;
+
+            for (int n : { 8, 512, 65536 }) {
+                b_->Args ({ variant, n });
+            }
+        }
+        b_->ArgNames ({ "variant", "values" });
+    }
+
+    /**
+     * Runs [fn_] with the variant the benchmark's been given selected
+     */
+    template<typename Fn>
+    void
+    run (benchmark::State & state_, size_t width_, Fn && fn_) {
+        auto variant = kernels::Variant (state_.range (0));
+        auto n = static_cast<size_t> (state_.range (1));
+
+        auto was = kernels::Kernels::variant();
+        kernels::Kernels::force (variant);
+
+        state_.SetLabel (kernels::Kernels::name (variant));
+
+        auto in = random (width_ * n);
+
+        for (auto _ : state_) {
+            fn_ (kernels::Kernels::table(), in.data(), n);
+        }
+
+        kernels::Kernels::force (was);
+
+        state_.SetBytesProcessed (static_cast<int64_t> (state_.iterations() * width_ * n));
+    }
+
+}
+
+/******************************************************************************/
+
+void
+Swap32 (benchmark::State & state_) {
+    std::vector<int64_t> out (state_.range (1));
+
+    run (state_, 4, [&out](const kernels::Table & table_, const char * in_, size_t n_) {
+        table_.m_swap32 (in_, n_, out.data());
+        benchmark::DoNotOptimize (out.data());
+    });
+}
+
+BENCHMARK (Swap32)->Apply (variants); // NOLINT
+
+/******************************************************************************/
+
+void
+Swap64 (benchmark::State & state_) {
+    std::vector<uint64_t> out (state_.range (1));
+
+    run (state_, 8, [&out](const kernels::Table & table_, const char * in_, size_t n_) {
+        table_.m_swap64 (in_, n_, out.data());
+        benchmark::DoNotOptimize (out.data());
+    });
+}
+
+BENCHMARK (Swap64)->Apply (variants); // NOLINT
+
+/******************************************************************************/
+
+/**
+ * Escaping legal prose, to be compared with Memcpy of the same
+ */
+void
+Escape (benchmark::State & state_) {
+    auto in = prose (state_.range (1));
+
+    std::string out;
+    out.reserve (2 * in.size());
+
+    run (state_, 1, [&out, &in](const kernels::Table &, const char *, size_t) {
+        out.clear();
+        amqp::internal::format::escape (in, [&out](std::string_view run_) {
+            out.append (run_);
+        });
+        benchmark::DoNotOptimize (out.data());
+    });
+}
+
+BENCHMARK (Escape)->Apply (variants); // NOLINT
+
+/******************************************************************************/
+
+void
+Memcpy (benchmark::State & state_) {
+    auto in = prose (state_.range (0));
+    std::string out (in.size(), '\0');
+
+    for (auto _ : state_) {
+        std::memcpy (out.data(), in.data(), in.size());
+        benchmark::DoNotOptimize (out.data());
+    }
+
+    state_.SetBytesProcessed (static_cast<int64_t> (state_.iterations() * in.size()));
+}
+
+BENCHMARK (Memcpy)->Arg (8)->Arg (512)->Arg (65536); // NOLINT
+
+/******************************************************************************/
@@ -0,0 +1,179 @@
+#include "Memory.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+
+#include "types.h"
+#include "Corpus.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "reader/Lazy.h"
+#include "reader/Arena.h"
+#include "stats/Allocations.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * What a decoded blob costs to hold, for each way of decoding one, so a
+ * decode mode can be picked for a process short of memory. Modes are
+ *
+ *   tree  - BlobInspector::values on the heap, what dump built before
+ *           it had an arena
+ *   arena - the same tree in a reused arena, as dump builds it now
+ *   tape  - BlobInspector::tape
+ *   lazy  - the handle BlobInspector::lazy returns, nothing beneath it
+ *           decoded
+ *
+ * Each reports, in bytes, resident, what's still held once decoded, and
+ * peak, the most held at once whilst decoding, both beyond the blob
+ * itself, plus each of those per encoded value of the blob, as the other
+ * benchmarks count objects, and allocs, the heap allocations a decode
+ * made. Memory is counted by the replacement operator new, the arena's by
+ * what it handed out, as the bytes asked for, so neither the allocator's
+ * own overhead nor the pages mapped beneath it are seen. Where the arena
+ * wins is in allocs, and so in that overhead. The arena's buffer is left to
+ * grow to fit the blob first, as it will across a batch of them, and
+ * every mode is decoded once before it's measured so the schema's
+ * readers are already cached and aren't counted.
+ *
+ * Run with --benchmark_filter=memory/ for just these.
+ *
+ ******************************************************************************/
+
+namespace {
+
+    using amqp::internal::reader::Arena;
+    using amqp::internal::stats::Allocations;
+
+    struct Footprint {
+        uint64_t m_resident;
+        uint64_t m_peak;
+        uint64_t m_allocations;
+    };
+
+    using Mode = std::function<Footprint (BlobInspector &)>;
+
+    Footprint
+    tree (BlobInspector & inspector_) {
+        Allocations::Scope allocations;
+
+        auto values = inspector_.values();
+        benchmark::DoNotOptimize (values.get());
+
+        return { allocations.live(), allocations.peak(), allocations.allocations() };
+    }
+
+    Footprint
+    arena (BlobInspector & inspector_) {
+        static thread_local Arena arena;
+
+        Footprint rtn { };
+
+        {
+            Arena::Scope scope (arena);
+            Allocations::Scope allocations;
+
+            auto values = inspector_.values();
+            benchmark::DoNotOptimize (values.get());
+
+            rtn = {
+                arena.allocated() + allocations.live(),
+                arena.allocated() + allocations.peak(),
+                allocations.allocations()
+            };
+        }
+
+        arena.reset();
+
+        return rtn;
+    }
+
+    Footprint
+    tape (BlobInspector & inspector_) {
+        Allocations::Scope allocations;
+
+        auto tape = inspector_.tape();
+        benchmark::DoNotOptimize (&tape);
+
+        return { allocations.live(), allocations.peak(), allocations.allocations() };
+    }
+
+    Footprint
+    lazy (BlobInspector & inspector_) {
+        Allocations::Scope allocations;
+
+        auto handle = inspector_.lazy();
+        benchmark::DoNotOptimize (handle.get());
+
+        return { allocations.live(), allocations.peak(), allocations.allocations() };
+    }
+
+    void
+    add (const std::string & name_, const Mode & mode_, const Corpus::Blob & blob_) {
+        benchmark::RegisterBenchmark (
+            ("memory/" + name_ + "/" + blob_.m_name).c_str(),
+            [mode_, blob_](benchmark::State & state_) {
+                CordaBytes cb (blob_.m_path);
+                BlobInspector inspector (cb);
+
+                Footprint footprint { };
+
+                // twice, the first growing the arena and caching the readers
+                try {
+                    mode_ (inspector);
+                    footprint = mode_ (inspector);
+                } catch (const std::runtime_error & e) {
+                    state_.SkipWithError (e.what());
+                    return;
+                }
+
+                for (auto _ : state_) {
+                    footprint = mode_ (inspector);
+                }
+
+                auto values = static_cast<double> (blob_.m_values);
+
+                state_.counters["resident"] = benchmark::Counter (
+                        static_cast<double> (footprint.m_resident),
+                        benchmark::Counter::kDefaults,
+                        benchmark::Counter::kIs1024);
+                state_.counters["peak"] = benchmark::Counter (
+                        static_cast<double> (footprint.m_peak),
+                        benchmark::Counter::kDefaults,
+                        benchmark::Counter::kIs1024);
+                state_.counters["resident/value"] = static_cast<double> (footprint.m_resident) / values;
+                state_.counters["peak/value"] = static_cast<double> (footprint.m_peak) / values;
+                state_.counters["allocs"] = static_cast<double> (footprint.m_allocations);
+
+                state_.SetBytesProcessed (
+                        static_cast<int64_t> (state_.iterations() * blob_.m_size));
+                state_.SetItemsProcessed (
+                        static_cast<int64_t> (state_.iterations() * blob_.m_values));
+            });
+    }
+
+}
+
+/******************************************************************************/
+
+void
+addMemory (const Corpus & corpus_) {
+    const std::pair<std::string, Mode> modes[] = {
+        { "tree",  tree },
+        { "arena", arena },
+        { "tape",  tape },
+        { "lazy",  lazy }
+    };
+
+    for (const auto & mode : modes) {
+        for (const auto & blob : corpus_.blobs()) {
+            add (mode.first, mode.second, blob);
+        }
+    }
+}
+
+/******************************************************************************/
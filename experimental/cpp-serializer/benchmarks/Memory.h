@@ -0,0 +1,16 @@
+#pragma once
+
+/******************************************************************************/
+
+class Corpus;
+
+/******************************************************************************/
+
+/**
+ * Register a benchmark of what holding each blob of [corpus_] decoded
+ * costs in memory, one per blob for each of the value tree, the arena
+ * tree, the tape and a lazy handle
+ */
+void addMemory (const Corpus & corpus_);
+
+/******************************************************************************/
@@ -0,0 +1,149 @@
+#include "PerfCounters.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#if defined (__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/******************************************************************************/
+
+namespace {
+
+#if defined (__linux__)
+
+    struct Event {
+        const char * m_name;
+        uint32_t m_type;
+        uint64_t m_config;
+    };
+
+    constexpr uint64_t
+    cache (uint64_t cache_) {
+        return cache_
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8U)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+    }
+
+    const Event events[] = {
+        { "cycles",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "branchMisses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { "l1dMisses",    PERF_TYPE_HW_CACHE, cache (PERF_COUNT_HW_CACHE_L1D) },
+        { "llcMisses",    PERF_TYPE_HW_CACHE, cache (PERF_COUNT_HW_CACHE_LL) },
+        { "dtlbMisses",   PERF_TYPE_HW_CACHE, cache (PERF_COUNT_HW_CACHE_DTLB) }
+    };
+
+    int
+    attach (const Event & event_) {
+        perf_event_attr attr;
+        std::memset (&attr, 0, sizeof (attr));
+
+        attr.size = sizeof (attr);
+        attr.type = event_.m_type;
+        attr.config = event_.m_config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int> (syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    /**
+     * Scaled up for any time the counter was shared out
+     */
+    double
+    count (int fd_) {
+        uint64_t values[3];
+
+        if (::read (fd_, values, sizeof (values)) != sizeof (values) || values[2] == 0) {
+            return 0.0;
+        }
+
+        return static_cast<double> (values[0])
+            * static_cast<double> (values[1]) / static_cast<double> (values[2]);
+    }
+
+#endif
+
+}
+
+/******************************************************************************/
+
+bool
+PerfCounters::wanted() {
+    const char * env = std::getenv ("AMQP_PERF");
+    return env && *env && std::strcmp (env, "0") != 0;
+}
+
+/******************************************************************************/
+
+PerfCounters::PerfCounters() {
+#if defined (__linux__)
+    if (!wanted()) return;
+
+    for (const auto & event : events) {
+        auto fd = attach (event);
+        if (fd >= 0) m_counters.push_back ({ event.m_name, fd });
+    }
+#endif
+}
+
+/******************************************************************************/
+
+PerfCounters::~PerfCounters() {
+#if defined (__linux__)
+    for (const auto & counter : m_counters) ::close (counter.m_fd);
+#endif
+}
+
+/******************************************************************************/
+
+void
+PerfCounters::start() {
+#if defined (__linux__)
+    for (const auto & counter : m_counters) {
+        ioctl (counter.m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl (counter.m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/******************************************************************************/
+
+void
+PerfCounters::stop() {
+#if defined (__linux__)
+    for (const auto & counter : m_counters) {
+        ioctl (counter.m_fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+}
+
+/******************************************************************************/
+
+void
+PerfCounters::report (benchmark::State & state_, double blobs_, double bytes_) const {
+#if defined (__linux__)
+    for (const auto & counter : m_counters) {
+        auto n = count (counter.m_fd);
+
+        if (blobs_ > 0) state_.counters[counter.m_name + "/blob"] = n / blobs_;
+        if (bytes_ > 0) state_.counters[counter.m_name + "/B"] = n / bytes_;
+    }
+#else
+    (void) state_;
+    (void) blobs_;
+    (void) bytes_;
+#endif
+}
+
+/******************************************************************************/
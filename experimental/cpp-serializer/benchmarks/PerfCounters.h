@@ -0,0 +1,70 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/******************************************************************************/
+
+namespace benchmark {
+
+    class State;
+
+}
+
+/******************************************************************************/
+
+/**
+ * The CPU's own counts of what a benchmark cost it, read through Linux's
+ * perf_event_open without needing libpfm: cycles, instructions, branch
+ * misses, L1 data and last level cache read misses and data TLB misses.
+ *
+ * Only counted when the AMQP_PERF environment variable is set, as opening
+ * the counters can need privileges, a kernel.perf_event_paranoid of 2 or
+ * less being enough, since only user space is counted. An event the CPU
+ * or a virtual machine doesn't offer is left out rather than failing the
+ * rest, and without any, or off Linux, nothing is reported.
+ *
+ * Counters follow the threads the benchmark starts once they've been
+ * opened, so a batch's workers are counted along with it. When more
+ * events are asked for than the CPU can count at once the kernel shares
+ * the counters out and each count is scaled up by how long it actually
+ * ran for.
+ */
+class PerfCounters {
+    private :
+        struct Counter {
+            std::string m_name;
+            int m_fd;
+        };
+
+        std::vector<Counter> m_counters;
+
+    public :
+        /**
+         * Whether AMQP_PERF asks for counting
+         */
+        static bool wanted();
+
+        PerfCounters();
+        PerfCounters (const PerfCounters &) = delete;
+        ~PerfCounters();
+
+        bool available() const { return !m_counters.empty(); }
+
+        /**
+         * Zero every count and begin counting
+         */
+        void start();
+        void stop();
+
+        /**
+         * Each count so far against [state_], as "<event>/blob" over
+         * [blobs_] blobs and "<event>/B" over [bytes_] bytes
+         */
+        void report (benchmark::State & state_, double blobs_, double bytes_) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,370 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+#include "types.h"
+#include "CordaBytes.h"
+#include "cursor/Cursor.h"
+#include "amqp/CompositeFactory.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/schema/OrderedTypeNotations.h"
+#include "amqp/schema/TypeNotationGraph.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/descriptors/AMQPDescriptors.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************
+ *
+ * The schema side of decoding a blob. Decoding type notations is timed
+ * over every one found in the test files, ordering types and building
+ * their readers over synthetic schemas of 10 to 5000 types so the
+ * scaling of each can be seen as well as its constant factor. Synthetic
+ * schemas come in three shapes
+ *
+ *   chain   - each type depends on the next
+ *   fan     - one type depends on every other
+ *   diamond - a chain of diamonds, each type depending on the two after
+ *             it which in turn both depend on the next
+ *
+ ******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+    namespace schema = amqp::internal::schema;
+
+    enum Shape { chain_t, fan_t, diamond_t };
+
+    /**
+     * The names of the types each of [n_] types depends on
+     */
+    std::vector<std::vector<std::string>>
+    graph (Shape shape_, size_t n_) {
+        std::vector<std::vector<std::string>> rtn (n_);
+
+        auto name = [](size_t i_) { return "T" + std::to_string (i_); };
+
+        for (size_t i { 0 } ; i < n_ ; ++i) {
+            switch (shape_) {
+                case chain_t :
+                    if (i + 1 < n_) rtn[i].push_back (name (i + 1));
+                    break;
+                case fan_t :
+                    if (i == 0) {
+                        for (size_t j { 1 } ; j < n_ ; ++j) rtn[i].push_back (name (j));
+                    }
+                    break;
+                case diamond_t :
+                    if (i % 3 == 0) {
+                        if (i + 1 < n_) rtn[i].push_back (name (i + 1));
+                        if (i + 2 < n_) rtn[i].push_back (name (i + 2));
+                    } else if (i + (3 - i % 3) < n_) {
+                        rtn[i].push_back (name (i + (3 - i % 3)));
+                    }
+                    break;
+            }
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Schemas never list their types in any helpful order so neither do
+     * we, but always the same unhelpful order
+     */
+    std::vector<size_t>
+    shuffled (size_t n_) {
+        std::vector<size_t> rtn (n_);
+        for (size_t i { 0 } ; i < n_ ; ++i) rtn[i] = i;
+
+        std::shuffle (rtn.begin(), rtn.end(), std::mt19937 (1));
+
+        return rtn;
+    }
+
+    /**
+     * The least a type needs to be ordered by either container
+     */
+    class Type : public schema::OrderedTypeNotation {
+        private :
+            std::string m_name;
+            std::vector<std::string> m_dependsOn;
+
+        public :
+            Type (std::string name_, std::vector<std::string> dependsOn_)
+                : m_name (std::move (name_))
+                , m_dependsOn (std::move (dependsOn_))
+            { }
+
+            const std::string & name() const { return m_name; }
+
+            decltype (m_dependsOn.cbegin()) begin() const { return m_dependsOn.cbegin(); }
+            decltype (m_dependsOn.cend()) end() const { return m_dependsOn.cend(); }
+
+            int dependsOn (const OrderedTypeNotation & rhs_) const override {
+                const auto & rhs = dynamic_cast<const Type &> (rhs_);
+
+                if (std::find (begin(), end(), rhs.name()) != end()) return 1;
+                if (std::find (rhs.begin(), rhs.end(), name()) != rhs.end()) return 2;
+
+                return 0;
+            }
+
+            std::vector<std::string_view> dependencies() const {
+                return { m_dependsOn.begin(), m_dependsOn.end() };
+            }
+    };
+
+    /**
+     * Composites whose fields are the types they depend on plus an int,
+     * so the leaves have something to read
+     */
+    schema::TypeNotationGraph<schema::AMQPTypeNotation>
+    composites (Shape shape_, size_t n_) {
+        auto deps = graph (shape_, n_);
+
+        schema::TypeNotationGraph<schema::AMQPTypeNotation> rtn;
+
+        for (auto i : shuffled (n_)) {
+            std::vector<uPtr<schema::Field>> fields;
+
+            fields.emplace_back (schema::Field::make ("i", "int", { }, "", "", true, false));
+
+            for (const auto & dep : deps[i]) {
+                fields.emplace_back (schema::Field::make (
+                        "f" + dep, dep, { }, "", "", true, false));
+            }
+
+            auto name = "T" + std::to_string (i);
+
+            rtn.insert (std::make_unique<schema::Composite> (
+                    name,
+                    "",
+                    std::vector<std::string> { },
+                    std::make_unique<schema::Descriptor> ("net.corda:" + name),
+                    std::move (fields)));
+        }
+
+        return rtn;
+    }
+
+    template<class Container>
+    void
+    insertAll (Container & container_, const std::vector<std::vector<std::string>> & deps_) {
+        for (auto i : shuffled (deps_.size())) {
+            container_.insert (std::make_unique<Type> ("T" + std::to_string (i), deps_[i]));
+        }
+    }
+
+    void
+    shapes (benchmark::internal::Benchmark * b_) {
+        for (int shape : { chain_t, fan_t, diamond_t }) {
+            for (int n : { 10, 50, 100, 500, 1000, 5000 }) {
+                b_->Args ({ shape, n });
+            }
+        }
+        b_->ArgNames ({ "shape", "types" });
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Ordering
+ *
+ ******************************************************************************/
+
+/**
+ * Creating the types is timed too, it costs the same for both
+ * containers
+ */
+void
+OrderedTypeNotationsInsert (benchmark::State & state_) {
+    auto deps = graph (Shape (state_.range (0)), state_.range (1));
+
+    for (auto _ : state_) {
+        schema::OrderedTypeNotations<Type> types;
+        insertAll (types, deps);
+        benchmark::DoNotOptimize (types.begin());
+    }
+
+    state_.SetItemsProcessed (state_.iterations() * state_.range (1));
+}
+
+BENCHMARK (OrderedTypeNotationsInsert)->Apply (shapes); // NOLINT
+
+/******************************************************************************/
+
+void
+TypeNotationGraphOrder (benchmark::State & state_) {
+    auto deps = graph (Shape (state_.range (0)), state_.range (1));
+
+    for (auto _ : state_) {
+        schema::TypeNotationGraph<Type> types;
+        insertAll (types, deps);
+        types.order();
+        benchmark::DoNotOptimize (types.begin());
+    }
+
+    state_.SetItemsProcessed (state_.iterations() * state_.range (1));
+}
+
+BENCHMARK (TypeNotationGraphOrder)->Apply (shapes); // NOLINT
+
+/******************************************************************************
+ *
+ * Readers
+ *
+ ******************************************************************************/
+
+void
+CompositeFactoryProcess (benchmark::State & state_) {
+    schema::Schema schema (composites (Shape (state_.range (0)), state_.range (1)));
+
+    for (auto _ : state_) {
+        amqp::internal::CompositeFactory factory;
+        factory.process (schema);
+        benchmark::DoNotOptimize (factory.byType ("T0"));
+    }
+
+    state_.SetItemsProcessed (state_.iterations() * state_.range (1));
+}
+
+BENCHMARK (CompositeFactoryProcess)->Apply (shapes); // NOLINT
+
+/******************************************************************************/
+
+/**
+ * As above but only building what's reachable from T0, which in each
+ * shape is everything
+ */
+void
+CompositeFactoryDemand (benchmark::State & state_) {
+    schema::Schema schema (composites (Shape (state_.range (0)), state_.range (1)));
+
+    for (auto _ : state_) {
+        amqp::internal::CompositeFactory factory;
+        factory.process (schema, "net.corda:T0");
+        benchmark::DoNotOptimize (factory.byType ("T0"));
+    }
+
+    state_.SetItemsProcessed (state_.iterations() * state_.range (1));
+}
+
+BENCHMARK (CompositeFactoryDemand)->Apply (shapes); // NOLINT
+
+/******************************************************************************/
+
+/**
+ * As [CompositeFactoryProcess] with each level built on every core, only
+ * the fan having levels wide enough to be split
+ */
+void
+CompositeFactoryParallel (benchmark::State & state_) {
+    schema::Schema schema (composites (Shape (state_.range (0)), state_.range (1)));
+
+    const size_t threads = std::max (std::thread::hardware_concurrency(), 1U);
+
+    for (auto _ : state_) {
+        amqp::internal::CompositeFactory factory;
+        factory.process (schema, threads);
+        benchmark::DoNotOptimize (factory.byType ("T0"));
+    }
+
+    state_.SetItemsProcessed (state_.iterations() * state_.range (1));
+}
+
+BENCHMARK (CompositeFactoryParallel)->Apply (shapes); // NOLINT
+
+/******************************************************************************
+ *
+ * Decoding type notations
+ *
+ ******************************************************************************/
+
+namespace {
+
+    /**
+     * The encoded type notations of every test file's schema with a
+     * descriptor id of [id_]
+     */
+    std::vector<std::string>
+    notations (int id_) {
+        std::vector<std::string> rtn;
+
+        for (const auto & entry : std::filesystem::directory_iterator (TEST_FILES)) {
+            CordaBytes cb (entry.path().string());
+
+            cursor::Cursor data (cb.bytes(), cb.size());
+
+            // the envelope, then on to its list of payload and schema
+            cursor::auto_enter envelope (data, true);
+            cursor::auto_enter list (data, true);
+
+            // the schema's list of lists of types
+            cursor::auto_enter schema (data, true);
+            cursor::auto_list_enter lists (data);
+
+            while (data.next()) {
+                cursor::auto_list_enter types (data);
+
+                while (data.next()) {
+                    cursor::Cursor type { data };
+                    cursor::auto_enter descriptor (type);
+
+                    if (amqp::stripCorda (type.get_ulong()) == static_cast<uint32_t> (id_)) {
+                        rtn.emplace_back (data.encoded());
+                    }
+                }
+            }
+        }
+
+        return rtn;
+    }
+
+    void
+    build (benchmark::State & state_, int id_) {
+        auto encoded = notations (id_);
+
+        size_t bytes { 0 };
+        for (const auto & e : encoded) bytes += e.size();
+
+        for (auto _ : state_) {
+            for (const auto & e : encoded) {
+                cursor::Cursor data (e.data(), e.size());
+                benchmark::DoNotOptimize (
+                        schema::descriptors::dispatchDescribed<schema::AMQPTypeNotation> (data));
+            }
+        }
+
+        state_.SetBytesProcessed (state_.iterations() * bytes);
+        state_.SetItemsProcessed (state_.iterations() * encoded.size());
+    }
+
+}
+
+/******************************************************************************/
+
+void
+CompositeDescriptorBuild (benchmark::State & state_) {
+    build (state_, amqp::schema::descriptors::COMPOSITE_TYPE);
+}
+
+BENCHMARK (CompositeDescriptorBuild); // NOLINT
+
+/******************************************************************************/
+
+void
+RestrictedDescriptorBuild (benchmark::State & state_) {
+    build (state_, amqp::schema::descriptors::RESTRICTED_TYPE);
+}
+
+BENCHMARK (RestrictedDescriptorBuild); // NOLINT
+
+/******************************************************************************/
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/******************************************************************************
+ *
+ * How long blob-inspector takes from exec to having written its first
+ * blob, everything a script invoking it once per blob pays each time:
+ * loading, static initialisation, reading the schema and decoding. Runs
+ * are
+ *
+ *   exec - /bin/true, what any process costs to start, to subtract
+ *   peek - --peek, the envelope alone
+ *   json - --json, the whole blob
+ *
+ * each writing to /dev/null. Nothing is cached between runs so this is
+ * what a cold process pays, less the page cache.
+ *
+ ******************************************************************************/
+
+extern char ** environ;
+
+/******************************************************************************/
+
+namespace {
+
+    void
+    run (const std::vector<std::string> & argv_) {
+        std::vector<char *> argv;
+        for (const auto & arg : argv_) argv.push_back (const_cast<char *> (arg.c_str()));
+        argv.push_back (nullptr);
+
+        posix_spawn_file_actions_t actions;
+        ::posix_spawn_file_actions_init (&actions);
+        ::posix_spawn_file_actions_addopen (&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+        pid_t pid;
+        auto rtn = ::posix_spawn (&pid, argv[0], &actions, nullptr, argv.data(), environ);
+
+        ::posix_spawn_file_actions_destroy (&actions);
+
+        if (rtn != 0) throw std::runtime_error ("Failed to start " + argv_[0]);
+
+        int status;
+        while (::waitpid (pid, &status, 0) < 0) {
+            if (errno != EINTR) throw std::runtime_error ("Failed waiting for " + argv_[0]);
+        }
+
+        if (!WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+            throw std::runtime_error (argv_[0] + " failed");
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+void
+Startup (benchmark::State & state_) {
+    const std::string blob { TEST_FILES "_Mis_" };
+
+    std::vector<std::string> argv;
+
+    switch (state_.range (0)) {
+        case 0  : argv = { "/bin/true" }; state_.SetLabel ("exec"); break;
+        case 1  : argv = { BLOB_INSPECTOR, "--peek", blob }; state_.SetLabel ("peek"); break;
+        default : argv = { BLOB_INSPECTOR, "--json", blob }; state_.SetLabel ("json"); break;
+    }
+
+    try {
+        for (auto _ : state_) run (argv);
+    } catch (const std::exception & e) {
+        state_.SkipWithError (e.what());
+    }
+}
+
+BENCHMARK (Startup)->DenseRange (0, 2)->UseRealTime()->Unit (benchmark::kMicrosecond); // NOLINT
+
+/******************************************************************************/
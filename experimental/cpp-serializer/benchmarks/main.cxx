@@ -0,0 +1,238 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <functional>
+
+#include "types.h"
+#include "Corpus.h"
+#include "Memory.h"
+#include "PerfCounters.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "cursor/Cursor.h"
+#include "cursor/Structure.h"
+#include "amqp/ReaderCache.h"
+#include "stats/Allocations.h"
+#include "amqp/CompositeFactory.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************
+ *
+ * Each phase of decoding a blob timed on its own over every blob in the
+ * corpus, reporting both bytes and objects, encoded values that is, per
+ * second. Phases are
+ *
+ *   load      - mapping the file, CordaBytes
+ *   scan      - walking every encoded value with the cursor, what used to
+ *               be handing the blob to proton to decode
+ *   structure - indexing where every value starts, cursor::Structure
+ *   envelope  - building the envelope and its schema
+ *   readers   - building the readers for every type in that schema
+ *   render    - BlobInspector::dump with the readers already cached
+ *   total     - loading and dumping a blob with nothing cached
+ *
+ * Bytes and objects are always counted over the whole blob, whatever
+ * part of it a phase actually looks at, so phases can be compared.
+ *
+ * Every phase also reports the heap allocations it made per iteration,
+ * allocs, and the most bytes it had allocated at once, peak. Both
+ * include a phase's setup, what's done before it's timed, but for
+ * anything run more than a handful of times that's lost in the average.
+ *
+ * With AMQP_PERF set each phase also reports the CPU's counts of cycles,
+ * instructions, branch misses and cache and TLB misses, see
+ * [PerfCounters], per blob and per byte, setup included likewise.
+ *
+ * Run with --benchmark_filter=<phase>/ to time just one phase.
+ *
+ ******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+
+    using Phase = std::function<void (const Corpus::Blob &, benchmark::State &)>;
+
+    uPtr<amqp::internal::schema::Envelope>
+    envelope (const CordaBytes & cb_) {
+        cursor::Cursor data (cb_.bytes(), cb_.size());
+        cursor::auto_enter p (data);
+
+        auto a = data.get_ulong();
+
+        return uPtr<amqp::internal::schema::Envelope> (
+                dynamic_cast<amqp::internal::schema::Envelope *> (
+                        amqp::internal::AMQPDescriptorRegistory[a]->build (data).release()));
+    }
+
+    /**
+     * Not every test file can be rendered, those that can't are reported
+     * as such rather than timed
+     */
+    bool
+    renders (CordaBytes & cb_, benchmark::State & state_) {
+        try {
+            BlobInspector (cb_).dump();
+            return true;
+        } catch (const std::runtime_error & e) {
+            state_.SkipWithError (e.what());
+            return false;
+        }
+    }
+
+    void
+    load (const Corpus::Blob & blob_, benchmark::State & state_) {
+        for (auto _ : state_) {
+            CordaBytes cb (blob_.m_path);
+            benchmark::DoNotOptimize (cb.bytes());
+        }
+    }
+
+    void
+    scan (const Corpus::Blob & blob_, benchmark::State & state_) {
+        CordaBytes cb (blob_.m_path);
+
+        for (auto _ : state_) {
+            benchmark::DoNotOptimize (Corpus::values (cb.bytes(), cb.size()));
+        }
+    }
+
+    void
+    structure (const Corpus::Blob & blob_, benchmark::State & state_) {
+        CordaBytes cb (blob_.m_path);
+
+        for (auto _ : state_) {
+            cursor::Structure structure ({ cb.bytes(), cb.size() });
+            benchmark::DoNotOptimize (structure.size());
+        }
+    }
+
+    void
+    buildEnvelope (const Corpus::Blob & blob_, benchmark::State & state_) {
+        CordaBytes cb (blob_.m_path);
+
+        for (auto _ : state_) {
+            benchmark::DoNotOptimize (envelope (cb));
+        }
+    }
+
+    void
+    readers (const Corpus::Blob & blob_, benchmark::State & state_) {
+        CordaBytes cb (blob_.m_path);
+        auto e = envelope (cb);
+
+        for (auto _ : state_) {
+            amqp::internal::CompositeFactory factory;
+            factory.process (e->schema());
+            benchmark::DoNotOptimize (factory.byDescriptor (e->descriptor()));
+        }
+    }
+
+    void
+    render (const Corpus::Blob & blob_, benchmark::State & state_) {
+        CordaBytes cb (blob_.m_path);
+        BlobInspector inspector (cb);
+
+        // which also fills the cache
+        if (!renders (cb, state_)) return;
+
+        for (auto _ : state_) {
+            benchmark::DoNotOptimize (inspector.dump());
+        }
+    }
+
+    void
+    total (const Corpus::Blob & blob_, benchmark::State & state_) {
+        {
+            CordaBytes cb (blob_.m_path);
+            if (!renders (cb, state_)) return;
+        }
+
+        for (auto _ : state_) {
+            amqp::internal::ReaderCache::instance().clear();
+
+            CordaBytes cb (blob_.m_path);
+            benchmark::DoNotOptimize (BlobInspector (cb).dump());
+        }
+    }
+
+    void
+    add (const std::string & name_, const Phase & phase_, const Corpus::Blob & blob_) {
+        benchmark::RegisterBenchmark (
+            (name_ + "/" + blob_.m_name).c_str(),
+            [phase_, blob_](benchmark::State & state_) {
+                amqp::internal::stats::Allocations::Scope allocations;
+                PerfCounters perf;
+
+                perf.start();
+                phase_ (blob_, state_);
+                perf.stop();
+
+                auto iterations = static_cast<double> (state_.iterations());
+                perf.report (state_, iterations, iterations * static_cast<double> (blob_.m_size));
+
+                state_.counters["allocs"] = benchmark::Counter (
+                        static_cast<double> (allocations.allocations()),
+                        benchmark::Counter::kAvgIterations);
+                state_.counters["peak"] = benchmark::Counter (
+                        static_cast<double> (allocations.peak()),
+                        benchmark::Counter::kDefaults,
+                        benchmark::Counter::kIs1024);
+
+                state_.SetBytesProcessed (
+                        static_cast<int64_t> (state_.iterations() * blob_.m_size));
+                state_.SetItemsProcessed (
+                        static_cast<int64_t> (state_.iterations() * blob_.m_values));
+            });
+    }
+
+}
+
+/******************************************************************************/
+
+int
+main (int argc, char ** argv) {
+    benchmark::Initialize (&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments (argc, argv)) {
+        return 1;
+    }
+
+    Corpus corpus (TEST_FILES);
+    corpus.grow (100);
+    corpus.grow (10000);
+
+    Generator::Shape shape;
+    shape.m_size = 1 << 20;
+    corpus.generate ("generated-1M", shape);
+
+    shape.m_size = 16 << 20;
+    corpus.generate ("generated-16M", shape);
+
+    const std::pair<std::string, Phase> phases[] = {
+        { "load",      load },
+        { "scan",      scan },
+        { "structure", structure },
+        { "envelope",  buildEnvelope },
+        { "readers",   readers },
+        { "render",    render },
+        { "total",     total }
+    };
+
+    for (const auto & phase : phases) {
+        for (const auto & blob : corpus.blobs()) {
+            add (phase.first, phase.second, blob);
+        }
+    }
+
+    addMemory (corpus);
+
+    benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,374 @@
+#include "ArrowWriter.h"
+
+#include <ostream>
+#include <stdexcept>
+
+#include "Columns.h"
+
+#include "sink/Dictionary.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Slots and enumerations from Arrow's Schema.fbs, Message.fbs and
+     * File.fbs
+     */
+    constexpr int16_t V5 = 4;
+
+    enum Header : uint8_t { schema_h = 1, dictionaryBatch_h = 2, recordBatch_h = 3 };
+
+    enum TypeId : uint8_t {
+        int_id = 2, floatingPoint_id = 3, binary_id = 4, utf8_id = 5, bool_id = 6,
+        timestamp_id = 10, list_id = 12, struct_id = 13, fixedSizeBinary_id = 15, map_id = 17
+    };
+
+    constexpr int16_t SINGLE = 1;
+    constexpr int16_t DOUBLE = 2;
+    constexpr int16_t MILLISECOND = 1;
+
+    namespace message { enum : uint16_t { version, headerType, header, bodyLength }; }
+    namespace schema { enum : uint16_t { endianness, fields }; }
+    namespace field { enum : uint16_t { name, nullable, typeType, type, dictionary, children }; }
+    namespace encoding { enum : uint16_t { id, indexType, isOrdered }; }
+    namespace batch { enum : uint16_t { length, nodes, buffers }; }
+    namespace dictionary { enum : uint16_t { id, data, isDelta }; }
+    namespace footer { enum : uint16_t { version, schema, dictionaries, recordBatches }; }
+
+    constexpr size_t ALIGNMENT = 8;
+
+    size_t
+    padded (size_t size_) {
+        return (size_ + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    template<class T>
+    void
+    append (std::string & out_, T value_) {
+        out_.append (reinterpret_cast<const char *> (&value_), sizeof (T));
+    }
+
+    Flatbuffer::Table
+    integer (int bits_) {
+        return Flatbuffer::Table()
+                .scalar<int32_t> (0, bits_)
+                .scalar<uint8_t> (1, 1);
+    }
+
+    /**
+     * The type of a column, the value type for a dictionary
+     */
+    std::pair<uint8_t, Flatbuffer::Table>
+    typeOf (const Column & column_) {
+        switch (column_.type()) {
+            case Column::bool_t      : return { bool_id, { } };
+            case Column::int_t       : return { int_id, integer (column_.width()) };
+            case Column::float_t     :
+                return { floatingPoint_id, Flatbuffer::Table().scalar<int16_t> (
+                        0, column_.width() == 32 ? SINGLE : DOUBLE) };
+            case Column::utf8_t      : return { utf8_id, { } };
+            case Column::binary_t    : return { binary_id, { } };
+            case Column::fixed_t     :
+                return { fixedSizeBinary_id, Flatbuffer::Table().scalar<int32_t> (0, column_.width()) };
+            case Column::timestamp_t :
+                return { timestamp_id, Flatbuffer::Table()
+                        .scalar<int16_t> (0, MILLISECOND)
+                        .string (1, "UTC") };
+            case Column::list_t      : return { list_id, { } };
+            case Column::struct_t    : return { struct_id, { } };
+            case Column::map_t       : return { map_id, Flatbuffer::Table().scalar<uint8_t> (0, 0) };
+            case Column::dictionary_t : return { utf8_id, { } };
+        }
+
+        throw std::logic_error ("Unknown column type");
+    }
+
+    Flatbuffer::Table
+    fieldOf (const Column & column_) {
+        auto t = typeOf (column_);
+
+        std::vector<Flatbuffer::Table> children;
+        for (const auto & child : column_.children()) children.push_back (fieldOf (*child));
+
+        Flatbuffer::Table rtn;
+
+        rtn.string (field::name, column_.name())
+           .scalar<uint8_t> (field::nullable, column_.nullable() ? 1 : 0)
+           .scalar<uint8_t> (field::typeType, t.first)
+           .table (field::type, std::move (t.second))
+           .tables (field::children, std::move (children));
+
+        if (column_.type() == Column::dictionary_t) {
+            rtn.table (field::dictionary, Flatbuffer::Table()
+                    .scalar<int64_t> (encoding::id, column_.id())
+                    .table (encoding::indexType, integer (32))
+                    .scalar<uint8_t> (encoding::isOrdered, 0));
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Arrow's field nodes and buffers for [column_] and every column
+     * beneath it, depth first
+     */
+    void
+    collect (const Column & column_, std::string & nodes_, std::vector<std::string_view> & buffers_) {
+        append<int64_t> (nodes_, static_cast<int64_t> (column_.length()));
+        append<int64_t> (nodes_, static_cast<int64_t> (column_.nulls()));
+
+        buffers_.push_back (column_.validity());
+
+        switch (column_.type()) {
+            case Column::utf8_t :
+            case Column::binary_t :
+                buffers_.push_back (column_.offsets());
+                buffers_.push_back (column_.data());
+                break;
+            case Column::list_t :
+            case Column::map_t :
+                buffers_.push_back (column_.offsets());
+                break;
+            case Column::struct_t :
+                break;
+            default :
+                buffers_.push_back (column_.values());
+                break;
+        }
+
+        for (const auto & child : column_.children()) collect (*child, nodes_, buffers_);
+    }
+
+    void
+    enums (const Column & column_, std::vector<const Column *> & out_) {
+        if (column_.type() == Column::dictionary_t) out_.push_back (&column_);
+
+        for (const auto & child : column_.children()) enums (*child, out_);
+    }
+
+}
+
+/******************************************************************************/
+
+ArrowWriter::ArrowWriter (std::ostream & out_, const Column & root_)
+    : m_out (out_)
+    , m_offset (0)
+    , m_closed (false)
+{
+    std::vector<Flatbuffer::Table> fields;
+    for (const auto & child : root_.children()) fields.push_back (fieldOf (*child));
+
+    m_schema.scalar<int16_t> (schema::endianness, 0)
+            .tables (schema::fields, std::move (fields));
+
+    write (MAGIC);
+    pad();
+
+    message (schema_h, m_schema, { });
+
+    std::vector<const Column *> dictionaries;
+    enums (root_, dictionaries);
+
+    for (const auto * column : dictionaries) dictionary (*column, 0, false);
+}
+
+/******************************************************************************/
+
+/**
+ * A growing dictionary's first batch is whatever it holds when the file's
+ * started, often nothing
+ */
+void
+ArrowWriter::dictionary (const Column & column_, size_t from_, bool delta_) {
+    Column values ("values", Column::utf8_t);
+
+    if (column_.grows()) {
+        const auto & strings = column_.strings();
+        for (auto i = from_ ; i < strings.size() ; ++i) values.bytes (strings[static_cast<uint32_t> (i)]);
+
+        m_written[column_.id()] = strings.size();
+    } else {
+        const auto & constants = column_.dictionary();
+        for (auto i = from_ ; i < constants.size() ; ++i) values.bytes (constants[i]);
+    }
+
+    std::string nodes;
+    std::vector<std::string_view> buffers;
+    collect (values, nodes, buffers);
+
+    auto table = Flatbuffer::Table()
+            .scalar<int64_t> (dictionary::id, column_.id())
+            .table (dictionary::data, recordBatch (values.length(), nodes, buffers))
+            .scalar<uint8_t> (dictionary::isDelta, delta_ ? 1 : 0);
+
+    m_dictionaries.push_back (message (dictionaryBatch_h, table, buffers));
+}
+
+/******************************************************************************/
+
+ArrowWriter::~ArrowWriter() {
+    try {
+        close();
+    } catch (...) {
+        // a file that can't be finished can't be read either
+    }
+}
+
+/******************************************************************************/
+
+void
+ArrowWriter::write (std::string_view bytes_) {
+    m_out.write (bytes_.data(), static_cast<std::streamsize> (bytes_.size()));
+    m_offset += static_cast<int64_t> (bytes_.size());
+
+    if (!m_out) throw std::runtime_error ("Failed writing Arrow output");
+}
+
+/******************************************************************************/
+
+void
+ArrowWriter::pad() {
+    static const char zeros[ALIGNMENT] { };
+
+    write ({ zeros, padded (static_cast<size_t> (m_offset)) - static_cast<size_t> (m_offset) });
+}
+
+/******************************************************************************/
+
+/**
+ * Buffers are located by their offset into the message's body
+ */
+Flatbuffer::Table
+ArrowWriter::recordBatch (
+    size_t length_,
+    const std::string & nodes_,
+    const std::vector<std::string_view> & buffers_
+) {
+    std::string buffers;
+    size_t offset { 0 };
+
+    for (const auto & buffer : buffers_) {
+        append<int64_t> (buffers, static_cast<int64_t> (offset));
+        append<int64_t> (buffers, static_cast<int64_t> (buffer.size()));
+
+        offset += padded (buffer.size());
+    }
+
+    return Flatbuffer::Table()
+            .scalar<int64_t> (batch::length, static_cast<int64_t> (length_))
+            .structs (batch::nodes, nodes_, nodes_.size() / 16)
+            .structs (batch::buffers, std::move (buffers), buffers_.size());
+}
+
+/******************************************************************************/
+
+/**
+ * A message is a continuation marker, the length of its metadata and
+ * then the metadata and body, each padded to eight bytes
+ */
+ArrowWriter::Block
+ArrowWriter::message (
+    uint8_t header_,
+    const Flatbuffer::Table & table_,
+    const std::vector<std::string_view> & buffers_
+) {
+    int64_t body { 0 };
+    for (const auto & buffer : buffers_) body += static_cast<int64_t> (padded (buffer.size()));
+
+    auto metadata = Flatbuffer::finish (Flatbuffer::Table()
+            .scalar<int16_t> (message::version, V5)
+            .scalar<uint8_t> (message::headerType, header_)
+            .table (message::header, table_)
+            .scalar<int64_t> (message::bodyLength, body));
+
+    Block rtn { m_offset, static_cast<int32_t> (8 + metadata.size()), body };
+
+    std::string prefix;
+    append<uint32_t> (prefix, 0xFFFFFFFF);
+    append<int32_t> (prefix, static_cast<int32_t> (metadata.size()));
+
+    write (prefix);
+    write (metadata);
+
+    for (const auto & buffer : buffers_) {
+        write (buffer);
+        pad();
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string
+ArrowWriter::blocks (const std::vector<Block> & blocks_) {
+    std::string rtn;
+
+    for (const auto & block : blocks_) {
+        append<int64_t> (rtn, block.m_offset);
+        append<int32_t> (rtn, block.m_metadata);
+        append<int32_t> (rtn, 0);
+        append<int64_t> (rtn, block.m_body);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+ArrowWriter::batch (const Column & root_) {
+    if (m_closed) throw std::runtime_error ("Arrow file already closed");
+
+    std::vector<const Column *> dictionaries;
+    enums (root_, dictionaries);
+
+    for (const auto * column : dictionaries) {
+        if (!column->grows()) continue;
+
+        auto written = m_written[column->id()];
+        if (column->strings().size() > written) dictionary (*column, written, true);
+    }
+
+    std::string nodes;
+    std::vector<std::string_view> buffers;
+
+    for (const auto & child : root_.children()) collect (*child, nodes, buffers);
+
+    m_batches.push_back (message (recordBatch_h, recordBatch (root_.length(), nodes, buffers), buffers));
+}
+
+/******************************************************************************/
+
+/**
+ * The footer follows an end of stream marker so that, the leading magic
+ * aside, the file can also be read as a stream
+ */
+void
+ArrowWriter::close() {
+    if (m_closed) return;
+    m_closed = true;
+
+    std::string eos;
+    append<uint32_t> (eos, 0xFFFFFFFF);
+    append<int32_t> (eos, 0);
+    write (eos);
+
+    auto footer = Flatbuffer::finish (Flatbuffer::Table()
+            .scalar<int16_t> (footer::version, V5)
+            .table (footer::schema, m_schema)
+            .structs (footer::dictionaries, blocks (m_dictionaries), m_dictionaries.size())
+            .structs (footer::recordBatches, blocks (m_batches), m_batches.size()));
+
+    std::string size;
+    append<int32_t> (size, static_cast<int32_t> (footer.size()));
+
+    write (footer);
+    write (size);
+    write (MAGIC);
+
+    m_out.flush();
+}
+
+/******************************************************************************/
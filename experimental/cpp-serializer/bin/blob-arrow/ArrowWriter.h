@@ -0,0 +1,104 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <unordered_map>
+
+#include "Flatbuffer.h"
+
+/******************************************************************************/
+
+class Column;
+
+/******************************************************************************/
+
+/**
+ * Writes columns out as an Arrow IPC file, the format also known as
+ * Feather V2, which pyarrow, DuckDB, Polars and Spark all load directly
+ * and will convert on to Parquet.
+ *
+ * The schema is written from the columns' types, then a dictionary batch
+ * for each enum holding its constants and then, each time [batch] is
+ * called, a record batch of whatever the columns hold. A string column
+ * whose dictionary grows, see [Column::strings], has a delta written
+ * ahead of each record batch holding just the strings it's gained. [close] writes the
+ * footer indexing them all, without which the file isn't readable.
+ * Buffers are uncompressed and little endian, each padded to eight bytes.
+ */
+class ArrowWriter {
+    public :
+        static constexpr std::string_view MAGIC { "ARROW1" };
+
+    private :
+        struct Block {
+            int64_t m_offset;
+            int32_t m_metadata;
+            int64_t m_body;
+        };
+
+        std::ostream & m_out;
+        int64_t m_offset;
+
+        Flatbuffer::Table m_schema;
+
+        std::vector<Block> m_dictionaries;
+        std::vector<Block> m_batches;
+
+        /**
+         * How many strings of each growing dictionary, by id, have been
+         * written
+         */
+        std::unordered_map<int64_t, size_t> m_written;
+
+        bool m_closed;
+
+        void write (std::string_view);
+        void pad();
+
+        /**
+         * Write a message, its metadata then [buffers_] as its body,
+         * returning where it went
+         */
+        Block message (
+            uint8_t header_,
+            const Flatbuffer::Table & table_,
+            const std::vector<std::string_view> & buffers_);
+
+        static Flatbuffer::Table recordBatch (
+            size_t length_,
+            const std::string & nodes_,
+            const std::vector<std::string_view> & buffers_);
+
+        static std::string blocks (const std::vector<Block> &);
+
+        /**
+         * Write a dictionary batch of [column_]'s values from [from_] on
+         */
+        void dictionary (const Column & column_, size_t from_, bool delta_);
+
+    public :
+        /**
+         * Start a file whose columns are the children of [root_]
+         */
+        ArrowWriter (std::ostream &, const Column & root_);
+
+        ArrowWriter (const ArrowWriter &) = delete;
+
+        ~ArrowWriter();
+
+        /**
+         * Write everything [root_]'s children hold as a record batch
+         */
+        void batch (const Column & root_);
+
+        void close();
+
+        size_t batches() const { return m_batches.size(); }
+};
+
+/******************************************************************************/
@@ -0,0 +1,768 @@
+#include "Columns.h"
+
+#include <map>
+#include <limits>
+#include <stdexcept>
+
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+
+#include "cursor/Cursor.h"
+#include "format/Text.h"
+
+#include "amqp/AMQPSectionId.h"
+#include "amqp/reader/IVisitor.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Map.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/List.h"
+#include "amqp/schema/restricted-types/Array.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    /**
+     * Past this a type is taken to contain itself
+     */
+    constexpr size_t MAX_DEPTH = 64;
+
+    void
+    bit (std::string & bits_, size_t i_, bool set_) {
+        if (i_ % 8 == 0) bits_.push_back ('\0');
+        if (set_) bits_.back() = static_cast<char> (bits_.back() | (1U << (i_ % 8)));
+    }
+
+    /**
+     * Drop every bit from [length_] on
+     */
+    void
+    truncate (std::string & bits_, size_t length_) {
+        bits_.resize ((length_ + 7) / 8);
+
+        if (length_ % 8) {
+            bits_.back() = static_cast<char> (bits_.back() & ((1U << (length_ % 8)) - 1));
+        }
+    }
+
+    std::unique_ptr<schema::Envelope>
+    envelope (const CordaBytes & blob_) {
+        amqp::internal::cursor::Cursor data (blob_.bytes(), blob_.size());
+        amqp::internal::cursor::auto_enter ae (data);
+
+        auto descriptor = data.get_ulong();
+
+        return std::unique_ptr<schema::Envelope> (
+                dynamic_cast<schema::Envelope *> (
+                        amqp::internal::AMQPDescriptorRegistory[descriptor]->build (
+                                data).release()));
+    }
+
+    const schema::Restricted *
+    restricted (const schema::AMQPTypeNotation * type_) {
+        return type_ && type_->type() == schema::AMQPTypeNotation::restricted_t
+            ? &dynamic_cast<const schema::Restricted &> (*type_)
+            : nullptr;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Column
+ *
+ ******************************************************************************/
+
+Column::Column (std::string name_, Type type_, int width_, bool nullable_)
+    : m_name (std::move (name_))
+    , m_type (type_)
+    , m_width (width_)
+    , m_nullable (nullable_)
+    , m_id (-1)
+    , m_length (0)
+    , m_nulls (0)
+{
+    clear();
+}
+
+/******************************************************************************/
+
+Column &
+Column::add (uPtr<Column> child_) {
+    m_children.push_back (std::move (child_));
+    return *m_children.back();
+}
+
+/******************************************************************************/
+
+void
+Column::dictionary (std::vector<std::string> constants_, int64_t id_) {
+    m_dictionary = std::move (constants_);
+    m_id = id_;
+
+    for (size_t i { 0 } ; i < m_dictionary.size() ; ++i) {
+        m_codes.emplace (m_dictionary[i], static_cast<int32_t> (i));
+    }
+}
+
+/******************************************************************************/
+
+void
+Column::strings (int64_t id_) {
+    m_strings = std::make_unique<amqp::internal::sink::Dictionary>();
+    m_id = id_;
+}
+
+/******************************************************************************/
+
+std::string_view
+Column::validity() const {
+    return m_nulls ? std::string_view (m_validity) : std::string_view { };
+}
+
+/******************************************************************************/
+
+std::string_view
+Column::offsets() const {
+    return { reinterpret_cast<const char *> (m_offsets.data()), m_offsets.size() * sizeof (int32_t) };
+}
+
+/******************************************************************************/
+
+void
+Column::valid (bool valid_) {
+    bit (m_validity, m_length, valid_);
+
+    if (!valid_) ++m_nulls;
+    ++m_length;
+}
+
+/******************************************************************************/
+
+void
+Column::null() {
+    switch (m_type) {
+        case bool_t    : bit (m_values, m_length, false); break;
+        case int_t     :
+        case float_t   : m_values.append (static_cast<size_t> (m_width / 8), '\0'); break;
+        case fixed_t   : m_values.append (static_cast<size_t> (m_width), '\0'); break;
+        case timestamp_t : fixed<int64_t> (0); break;
+        case dictionary_t : fixed<int32_t> (0); break;
+        case utf8_t    :
+        case binary_t  : m_offsets.push_back (m_offsets.back()); break;
+        case list_t    :
+        case map_t     : m_offsets.push_back (static_cast<int32_t> (m_children.front()->length())); break;
+        case struct_t  :
+            for (auto & child : m_children) child->null();
+            break;
+    }
+
+    valid (false);
+}
+
+/******************************************************************************/
+
+void
+Column::boolean (bool value_) {
+    if (m_type != bool_t) {
+        throw std::runtime_error (m_name + " can't hold a boolean");
+    }
+
+    bit (m_values, m_length, value_);
+    valid (true);
+}
+
+/******************************************************************************/
+
+void
+Column::integer (int64_t value_) {
+    switch (m_type) {
+        case int_t :
+            switch (m_width) {
+                case 8  : fixed (static_cast<int8_t> (value_)); break;
+                case 16 : fixed (static_cast<int16_t> (value_)); break;
+                case 32 : fixed (static_cast<int32_t> (value_)); break;
+                default : fixed (value_); break;
+            }
+            break;
+        case float_t :
+            real (static_cast<double> (value_));
+            return;
+        case timestamp_t :
+            fixed (value_);
+            break;
+        default :
+            throw std::runtime_error (m_name + " can't hold an integer");
+    }
+
+    valid (true);
+}
+
+/******************************************************************************/
+
+void
+Column::real (double value_) {
+    if (m_type != float_t) {
+        throw std::runtime_error (m_name + " can't hold a floating point number");
+    }
+
+    if (m_width == 32) {
+        fixed (static_cast<float> (value_));
+    } else {
+        fixed (value_);
+    }
+
+    valid (true);
+}
+
+/******************************************************************************/
+
+void
+Column::bytes (std::string_view value_) {
+    switch (m_type) {
+        case utf8_t :
+        case binary_t :
+            if (m_data.size() + value_.size() > static_cast<size_t> (std::numeric_limits<int32_t>::max())) {
+                throw std::runtime_error (m_name + " has more than 2GB in a batch");
+            }
+
+            m_data.append (value_);
+            m_offsets.push_back (static_cast<int32_t> (m_data.size()));
+            break;
+        case fixed_t :
+            if (value_.size() != static_cast<size_t> (m_width)) {
+                throw std::runtime_error (m_name + " can't hold " + std::to_string (value_.size()) + " bytes");
+            }
+
+            m_values.append (value_);
+            break;
+        case dictionary_t : {
+            if (m_strings) {
+                auto code = m_strings->add (value_);
+
+                if (code > static_cast<uint32_t> (std::numeric_limits<int32_t>::max())) {
+                    throw std::runtime_error (m_name + " has too many distinct strings");
+                }
+
+                fixed (static_cast<int32_t> (code));
+                break;
+            }
+
+            auto it = m_codes.find (std::string (value_));
+
+            // a constant added since the first blob's schema
+            if (it == m_codes.end()) {
+                null();
+                return;
+            }
+
+            fixed (it->second);
+            break;
+        }
+        default :
+            throw std::runtime_error (m_name + " can't hold a string");
+    }
+
+    valid (true);
+}
+
+/******************************************************************************/
+
+void
+Column::begin() {
+    if (m_type == struct_t) valid (true);
+}
+
+/******************************************************************************/
+
+void
+Column::end() {
+    if (m_type != struct_t) {
+        m_offsets.push_back (static_cast<int32_t> (m_children.front()->length()));
+        valid (true);
+    }
+}
+
+/******************************************************************************/
+
+void
+Column::mark (std::vector<Mark> & marks_) const {
+    marks_.push_back ({ m_length, m_nulls, m_values.size(), m_offsets.size(), m_data.size() });
+
+    for (const auto & child : m_children) child->mark (marks_);
+}
+
+/******************************************************************************/
+
+void
+Column::rollback (const std::vector<Mark> & marks_, size_t & at_) {
+    const auto & mark = marks_[at_++];
+
+    m_length = mark.m_length;
+    m_nulls = mark.m_nulls;
+
+    truncate (m_validity, m_length);
+
+    if (m_type == bool_t) {
+        truncate (m_values, m_length);
+    } else {
+        m_values.resize (mark.m_values);
+    }
+
+    m_offsets.resize (mark.m_offsets);
+    m_data.resize (mark.m_data);
+
+    for (auto & child : m_children) child->rollback (marks_, at_);
+}
+
+/******************************************************************************/
+
+void
+Column::clear() {
+    m_length = 0;
+    m_nulls = 0;
+
+    m_validity.clear();
+    m_values.clear();
+    m_offsets.clear();
+    m_data.clear();
+
+    if (m_type == utf8_t || m_type == binary_t || m_type == list_t || m_type == map_t) {
+        m_offsets.push_back (0);
+    }
+
+    for (auto & child : m_children) child->clear();
+}
+
+/******************************************************************************
+ *
+ * Appender
+ *
+ ******************************************************************************/
+
+namespace {
+
+    /**
+     * Appends what it's shown of a blob to the columns. Anything a column
+     * doesn't exist for is skipped over, nested values and all
+     */
+    class Appender : public amqp::reader::IVisitor {
+        private :
+            struct Frame {
+                Column * m_column;
+
+                /**
+                 * The row of a struct being built, its children having
+                 * no more than this many rows until given a value
+                 */
+                size_t m_row;
+
+                /**
+                 * A struct's column for the property being visited,
+                 * null if there's none
+                 */
+                Column * m_next;
+
+                /**
+                 * A list's element count for padding it out to should
+                 * any be null, or whether a map is expecting a key
+                 */
+                size_t m_count;
+                size_t m_start;
+                bool m_key;
+            };
+
+            Column & m_root;
+            const std::string & m_type;
+
+            std::vector<Frame> m_stack;
+
+            /**
+             * How deep within something being skipped the walk is
+             */
+            size_t m_skip { 0 };
+            bool m_done { false };
+
+            Column * next();
+
+        public :
+            Appender (Column & root_, const std::string & type_) : m_root (root_), m_type (type_) { }
+
+            bool done() const { return m_done; }
+
+            void onBeginComposite (std::string_view) override;
+            void onEndComposite() override;
+            void onField (std::string_view) override;
+
+            void onBeginList (size_t) override;
+            void onEndList() override;
+            void onBeginMap (size_t) override;
+            void onEndMap() override;
+
+            void onBool (bool v_) override { if (auto * c = next()) c->boolean (v_); }
+            void onInt (int32_t v_) override { if (auto * c = next()) c->integer (v_); }
+            void onLong (int64_t v_) override { if (auto * c = next()) c->integer (v_); }
+            void onDouble (double v_) override { if (auto * c = next()) c->real (v_); }
+            void onString (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+            void onShort (int16_t v_) override { if (auto * c = next()) c->integer (v_); }
+            void onByte (int8_t v_) override { if (auto * c = next()) c->integer (v_); }
+            void onFloat (float v_) override { if (auto * c = next()) c->real (v_); }
+            void onTimestamp (int64_t v_) override { if (auto * c = next()) c->integer (v_); }
+            void onUuid (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+            void onDecimal128 (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+            void onSymbol (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+            void onEnum (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+            void onBinary (std::string_view v_) override { if (auto * c = next()) c->bytes (v_); }
+
+            void onChar (char32_t v_) override {
+                if (auto * c = next()) c->bytes (amqp::internal::format::Utf8 (v_).view());
+            }
+    };
+
+    /**************************************************************************/
+
+    /**
+     * The column the next value goes in, null if it's to be skipped
+     */
+    Column *
+    Appender::next() {
+        if (m_skip || m_stack.empty()) return nullptr;
+
+        auto & top = m_stack.back();
+
+        switch (top.m_column->type()) {
+            case Column::struct_t : {
+                auto * rtn = top.m_next;
+                top.m_next = nullptr;
+                return rtn;
+            }
+            case Column::list_t :
+                return &top.m_column->child (0);
+            default : {
+                auto & entries = top.m_column->child (0);
+
+                top.m_key = !top.m_key;
+
+                if (!top.m_key) {
+                    entries.begin();
+                    return &entries.child (0);
+                }
+
+                return &entries.child (1);
+            }
+        }
+    }
+
+    /**************************************************************************/
+
+    void
+    Appender::onBeginComposite (std::string_view type_) {
+        Column * column;
+
+        if (m_stack.empty() && !m_skip) {
+            if (m_done || type_ != m_type) {
+                throw std::runtime_error ("Blob holds a " + std::string (type_) + " not a " + m_type);
+            }
+
+            column = &m_root;
+        } else {
+            column = next();
+        }
+
+        if (!column) {
+            ++m_skip;
+            return;
+        }
+
+        if (column->type() != Column::struct_t) {
+            throw std::runtime_error (column->name() + " can't hold a " + std::string (type_));
+        }
+
+        column->begin();
+        m_stack.push_back ({ column, column->length() - 1, nullptr, 0, 0, false });
+    }
+
+    /**************************************************************************/
+
+    /**
+     * Properties that were never visited were null
+     */
+    void
+    Appender::onEndComposite() {
+        if (m_skip) {
+            --m_skip;
+            return;
+        }
+
+        auto frame = m_stack.back();
+        m_stack.pop_back();
+
+        for (const auto & child : frame.m_column->children()) {
+            if (child->length() == frame.m_row) child->null();
+        }
+
+        if (m_stack.empty()) m_done = true;
+    }
+
+    /**************************************************************************/
+
+    void
+    Appender::onField (std::string_view name_) {
+        if (m_skip || m_stack.empty()) return;
+
+        auto & top = m_stack.back();
+        top.m_next = nullptr;
+
+        for (const auto & child : top.m_column->children()) {
+            // a property given twice keeps its first value
+            if (child->name() == name_ && child->length() == top.m_row) {
+                top.m_next = child.get();
+                break;
+            }
+        }
+    }
+
+    /**************************************************************************/
+
+    void
+    Appender::onBeginList (size_t count_) {
+        auto * column = next();
+
+        if (!column) {
+            ++m_skip;
+            return;
+        }
+
+        if (column->type() != Column::list_t) {
+            throw std::runtime_error (column->name() + " can't hold a list");
+        }
+
+        m_stack.push_back ({ column, 0, nullptr, count_, column->child (0).length(), false });
+    }
+
+    /**************************************************************************/
+
+    /**
+     * Visitors aren't shown null elements so a list that's short is
+     * padded out with them
+     */
+    void
+    Appender::onEndList() {
+        if (m_skip) {
+            --m_skip;
+            return;
+        }
+
+        auto frame = m_stack.back();
+        m_stack.pop_back();
+
+        auto & elements = frame.m_column->child (0);
+        while (elements.length() - frame.m_start < frame.m_count) elements.null();
+
+        frame.m_column->end();
+    }
+
+    /**************************************************************************/
+
+    void
+    Appender::onBeginMap (size_t) {
+        auto * column = next();
+
+        if (!column) {
+            ++m_skip;
+            return;
+        }
+
+        if (column->type() != Column::map_t) {
+            throw std::runtime_error (column->name() + " can't hold a map");
+        }
+
+        m_stack.push_back ({ column, 0, nullptr, 0, 0, true });
+    }
+
+    /**************************************************************************/
+
+    void
+    Appender::onEndMap() {
+        if (m_skip) {
+            --m_skip;
+            return;
+        }
+
+        auto frame = m_stack.back();
+        m_stack.pop_back();
+
+        // a key left without its value
+        if (!frame.m_key) frame.m_column->child (0).child (1).null();
+
+        frame.m_column->end();
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Columns
+ *
+ ******************************************************************************/
+
+Columns::Columns (const CordaBytes & blob_, bool dictionary_)
+    : m_dictionaries (0)
+    , m_strings (dictionary_)
+{
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    auto envelope = ::envelope (blob_);
+    const auto & types = dynamic_cast<const schema::Schema &> (envelope->schema());
+
+    for (const auto & level : types) {
+        for (const auto & type : level) {
+            if (type->descriptor() == envelope->descriptor()) m_type = type->name();
+        }
+    }
+
+    if (m_type.empty()) {
+        throw std::runtime_error ("Blob's schema doesn't describe what it holds");
+    }
+
+    m_root = column (types, m_type, m_type, false, 0);
+
+    if (m_root->type() != Column::struct_t) {
+        throw std::runtime_error (m_type + " isn't a composite");
+    }
+}
+
+/******************************************************************************/
+
+Columns::~Columns() = default;
+
+/******************************************************************************/
+
+/**
+ * The column holding a [type_], named [name_]
+ */
+uPtr<Column>
+Columns::column (
+    const schema::Schema & schema_,
+    std::string name_,
+    const std::string & type_,
+    bool nullable_,
+    size_t depth_
+) {
+    static const std::map<std::string, std::pair<Column::Type, int>> primitives { // NOLINT
+        { "boolean",    { Column::bool_t, 1 } },
+        { "byte",       { Column::int_t, 8 } },
+        { "short",      { Column::int_t, 16 } },
+        { "int",        { Column::int_t, 32 } },
+        { "long",       { Column::int_t, 64 } },
+        { "float",      { Column::float_t, 32 } },
+        { "double",     { Column::float_t, 64 } },
+        { "char",       { Column::utf8_t, 0 } },
+        { "string",     { Column::utf8_t, 0 } },
+        { "symbol",     { Column::utf8_t, 0 } },
+        { "binary",     { Column::binary_t, 0 } },
+        { "timestamp",  { Column::timestamp_t, 64 } },
+        { "uuid",       { Column::fixed_t, 16 } },
+        { "decimal128", { Column::fixed_t, 16 } }
+    };
+
+    if (depth_ > MAX_DEPTH) {
+        throw std::runtime_error (type_ + " contains itself, it has no columns");
+    }
+
+    auto primitive = primitives.find (type_);
+
+    if (m_strings && (type_ == "string" || type_ == "symbol")) {
+        auto rtn = std::make_unique<Column> (std::move (name_), Column::dictionary_t, 32, nullable_);
+        rtn->strings (static_cast<int64_t> (m_dictionaries++));
+        return rtn;
+    }
+
+    if (primitive != primitives.end()) {
+        return std::make_unique<Column> (
+                std::move (name_), primitive->second.first, primitive->second.second, nullable_);
+    }
+
+    const auto * notation = schema_.typeNotation (type_);
+
+    if (!notation) {
+        throw std::runtime_error ("There's no column for " + type_);
+    }
+
+    const auto * r = restricted (notation);
+
+    if (!r) {
+        auto rtn = std::make_unique<Column> (std::move (name_), Column::struct_t, 0, nullable_);
+
+        for (const auto & field : dynamic_cast<const schema::Composite &> (*notation).fields()) {
+            rtn->add (column (schema_, field->name(), field->resolvedType(), true, depth_ + 1));
+        }
+
+        return rtn;
+    }
+
+    switch (r->restrictedType()) {
+        case schema::Restricted::list_t : {
+            auto rtn = std::make_unique<Column> (std::move (name_), Column::list_t, 0, nullable_);
+            rtn->add (column (schema_, "item", dynamic_cast<const schema::List &> (*r).listOf(), true, depth_ + 1));
+            return rtn;
+        }
+        case schema::Restricted::array_t : {
+            auto rtn = std::make_unique<Column> (std::move (name_), Column::list_t, 0, nullable_);
+            rtn->add (column (schema_, "item", dynamic_cast<const schema::Array &> (*r).arrayOf(), true, depth_ + 1));
+            return rtn;
+        }
+        case schema::Restricted::map_t : {
+            auto of = dynamic_cast<const schema::Map &> (*r).mapOf();
+
+            auto rtn = std::make_unique<Column> (std::move (name_), Column::map_t, 0, nullable_);
+            auto & entries = rtn->add (std::make_unique<Column> ("entries", Column::struct_t, 0, false));
+
+            entries.add (column (schema_, "key", of.first.get(), false, depth_ + 1));
+            entries.add (column (schema_, "value", of.second.get(), true, depth_ + 1));
+
+            return rtn;
+        }
+        default : {
+            auto rtn = std::make_unique<Column> (std::move (name_), Column::dictionary_t, 32, nullable_);
+            rtn->dictionary (
+                    dynamic_cast<const schema::Enum &> (*r).makeChoices(),
+                    static_cast<int64_t> (m_dictionaries++));
+            return rtn;
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+Columns::append (CordaBytes & blob_) {
+    std::vector<Column::Mark> marks;
+    m_root->mark (marks);
+
+    try {
+        if (blob_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        Appender appender (*m_root, m_type);
+        BlobInspector (blob_).visit (appender);
+
+        if (!appender.done()) {
+            throw std::runtime_error ("Blob held nothing");
+        }
+    } catch (...) {
+        size_t at { 0 };
+        m_root->rollback (marks, at);
+        throw;
+    }
+}
+
+/******************************************************************************/
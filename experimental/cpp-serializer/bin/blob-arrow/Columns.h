@@ -0,0 +1,249 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "types.h"
+
+#include "sink/Dictionary.h"
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::internal::schema {
+
+    class Schema;
+
+}
+
+/******************************************************************************
+ *
+ * class Column
+ *
+ ******************************************************************************/
+
+/**
+ * One of Arrow's arrays, typed from the schema of the blobs going into it,
+ * along with the buffers it's being built in. A composite is a struct of
+ * its properties, lists and arrays are lists and maps are maps of entries
+ * holding a key and a value. Enums are dictionary encoded against their
+ * constants, uuids and decimal128s are sixteen byte fixed size binaries
+ * and timestamps are milliseconds in UTC. Strings and symbols can be too,
+ * against a dictionary of their own that grows as values are appended,
+ * see [strings].
+ *
+ * Buffers are laid out as Arrow lays them out so they're written as is.
+ * Emptying a column keeps their capacity for the next batch.
+ */
+class Column {
+    public :
+        enum Type {
+            bool_t, int_t, float_t, utf8_t, binary_t, fixed_t, timestamp_t,
+            list_t, struct_t, map_t, dictionary_t
+        };
+
+        /**
+         * How long each of a column's buffers were, so anything appended
+         * since can be dropped
+         */
+        struct Mark {
+            size_t m_length;
+            size_t m_nulls;
+            size_t m_values;
+            size_t m_offsets;
+            size_t m_data;
+        };
+
+    private :
+        std::string m_name;
+        Type m_type;
+
+        /**
+         * Bits of an int or float, bytes of a fixed size binary
+         */
+        int m_width;
+
+        bool m_nullable;
+
+        std::vector<uPtr<Column>> m_children;
+
+        /**
+         * An enum's constants, in the order of their ordinals
+         */
+        std::vector<std::string> m_dictionary;
+        std::unordered_map<std::string, int32_t> m_codes;
+        int64_t m_id;
+
+        /**
+         * A string column's values, when it's dictionary encoded
+         */
+        uPtr<amqp::internal::sink::Dictionary> m_strings;
+
+        size_t m_length;
+        size_t m_nulls;
+
+        std::string m_validity;
+
+        /**
+         * Fixed width values, bits for booleans
+         */
+        std::string m_values;
+
+        std::vector<int32_t> m_offsets;
+        std::string m_data;
+
+        void valid (bool);
+
+        template<class T>
+        void fixed (T value_) {
+            m_values.append (reinterpret_cast<const char *> (&value_), sizeof (T));
+        }
+
+    public :
+        Column (std::string name_, Type, int width_ = 0, bool nullable_ = true);
+
+        Column (const Column &) = delete;
+
+        const std::string & name() const { return m_name; }
+        Type type() const { return m_type; }
+        int width() const { return m_width; }
+        bool nullable() const { return m_nullable; }
+
+        const std::vector<uPtr<Column>> & children() const { return m_children; }
+        Column & child (size_t i_) { return *m_children[i_]; }
+        Column & add (uPtr<Column>);
+
+        const std::vector<std::string> & dictionary() const { return m_dictionary; }
+        void dictionary (std::vector<std::string>, int64_t id_);
+        int64_t id() const { return m_id; }
+
+        /**
+         * Dictionary encode strings against every distinct one appended
+         * so far, each being given the next code when first seen. Codes
+         * outlive [clear], and [rollback], so a batch's codes still mean
+         * what they did in any before it
+         */
+        void strings (int64_t id_);
+        bool grows() const { return m_strings != nullptr; }
+        const amqp::internal::sink::Dictionary & strings() const { return *m_strings; }
+
+        size_t length() const { return m_length; }
+        size_t nulls() const { return m_nulls; }
+
+        /**
+         * Empty when there are no nulls, Arrow then needing no bitmap
+         */
+        std::string_view validity() const;
+        std::string_view values() const { return m_values; }
+        std::string_view offsets() const;
+        std::string_view data() const { return m_data; }
+
+        /**
+         * A null, and a null for each child of a struct so they stay the
+         * same length as it
+         */
+        void null();
+
+        void boolean (bool);
+        void integer (int64_t);
+        void real (double);
+
+        /**
+         * Strings, binaries and, for a dictionary, the name of an enum's
+         * constant, any it doesn't have being null
+         */
+        void bytes (std::string_view);
+
+        /**
+         * Start a non null list or map, or a struct's row, whose
+         * elements or properties are then appended to its children
+         */
+        void begin();
+
+        /**
+         * Finish a list or map, its elements being everything appended
+         * to its child since [begin]
+         */
+        void end();
+
+        /**
+         * Where this column and every one beneath it are, depth first
+         */
+        void mark (std::vector<Mark> &) const;
+        void rollback (const std::vector<Mark> &, size_t & at_);
+
+        /**
+         * Drop every row, children and all
+         */
+        void clear();
+};
+
+/******************************************************************************
+ *
+ * class Columns
+ *
+ ******************************************************************************/
+
+/**
+ * The columns of a set of blobs all holding the same type, one per
+ * property of that type, to which blob after blob is appended as a row.
+ * Blobs are walked with a visitor, values going straight from the blob
+ * into the columns. Properties are matched by name, so blobs written by
+ * an evolved version of the type still append, any property they lack
+ * being null and any they've gained being ignored.
+ */
+class Columns {
+    private :
+        std::string m_type;
+
+        /**
+         * A struct whose children are the columns
+         */
+        uPtr<Column> m_root;
+
+        size_t m_dictionaries;
+
+        /**
+         * Whether strings and symbols are dictionary encoded
+         */
+        bool m_strings;
+
+        uPtr<Column> column (
+            const amqp::internal::schema::Schema &,
+            std::string name_,
+            const std::string & type_,
+            bool nullable_,
+            size_t depth_);
+
+    public :
+        /**
+         * Columns for the type [blob_] holds, as described by its schema,
+         * dictionary encoding its strings and symbols if [dictionary_]
+         */
+        explicit Columns (const CordaBytes & blob_, bool dictionary_ = false);
+
+        ~Columns();
+
+        const std::string & type() const { return m_type; }
+
+        const Column & root() const { return *m_root; }
+
+        size_t rows() const { return m_root->length(); }
+
+        /**
+         * Append [blob_]'s contents as a row. A blob that fails to decode,
+         * or doesn't hold the type the columns are for, throws, leaving
+         * the columns as they were
+         */
+        void append (CordaBytes & blob_);
+
+        void clear() { m_root->clear(); }
+};
+
+/******************************************************************************/
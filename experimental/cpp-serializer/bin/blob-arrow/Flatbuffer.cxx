@@ -0,0 +1,173 @@
+#include "Flatbuffer.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+
+namespace {
+
+    template<class T>
+    void
+    put (std::string & buffer_, size_t at_, T value_) {
+        std::memcpy (&buffer_[at_], &value_, sizeof (T));
+    }
+
+    size_t
+    align (size_t at_, size_t alignment_) {
+        return (at_ + alignment_ - 1) / alignment_ * alignment_;
+    }
+
+}
+
+/******************************************************************************/
+
+void
+Flatbuffer::pad (size_t alignment_) {
+    m_buffer.resize (align (m_buffer.size(), alignment_), '\0');
+}
+
+/******************************************************************************/
+
+/**
+ * Offsets are unsigned and relative to where they're stored
+ */
+void
+Flatbuffer::patch (size_t at_, size_t target_) {
+    put (m_buffer, at_, static_cast<uint32_t> (target_ - at_));
+}
+
+/******************************************************************************/
+
+/**
+ * A table is preceded by its vtable and starts with the signed distance
+ * back to it. Its fields are laid out largest first so none needs more
+ * than the padding after the vtable offset to be aligned. Returns where
+ * the table starts
+ */
+size_t
+Flatbuffer::place (const Table & table_) {
+    uint16_t slots { 0 };
+    for (const auto & field : table_.m_fields) {
+        slots = std::max<uint16_t> (slots, field.m_slot + 1);
+    }
+
+    std::vector<size_t> order (table_.m_fields.size());
+    for (size_t i { 0 } ; i < order.size() ; ++i) order[i] = i;
+
+    std::stable_sort (order.begin(), order.end(), [&table_](size_t a_, size_t b_) {
+        return table_.m_fields[a_].m_size > table_.m_fields[b_].m_size;
+    });
+
+    std::vector<size_t> at (table_.m_fields.size());
+    size_t size { 4 };
+
+    for (auto i : order) {
+        auto width = table_.m_fields[i].m_kind == Table::scalar_t ? table_.m_fields[i].m_size : 4;
+
+        size = align (size, width);
+        at[i] = size;
+        size += width;
+    }
+
+    const size_t vtable = 4 + 2 * slots;
+    const size_t start = align (m_buffer.size() + vtable, 8);
+
+    m_buffer.resize (start + size, '\0');
+
+    put (m_buffer, start - vtable, static_cast<uint16_t> (vtable));
+    put (m_buffer, start - vtable + 2, static_cast<uint16_t> (size));
+
+    for (size_t i { 0 } ; i < table_.m_fields.size() ; ++i) {
+        put (m_buffer, start - vtable + 4 + 2 * table_.m_fields[i].m_slot, static_cast<uint16_t> (at[i]));
+    }
+
+    put (m_buffer, start, static_cast<int32_t> (vtable));
+
+    for (size_t i { 0 } ; i < table_.m_fields.size() ; ++i) {
+        const auto & field = table_.m_fields[i];
+
+        if (field.m_kind == Table::scalar_t) {
+            m_buffer.replace (start + at[i], field.m_size, field.m_bytes);
+        }
+    }
+
+    // only now that the table is whole can what it refers to follow it
+    for (size_t i { 0 } ; i < table_.m_fields.size() ; ++i) {
+        const auto & field = table_.m_fields[i];
+
+        if (field.m_kind != Table::scalar_t) {
+            auto target = place (field);
+            patch (start + at[i], target);
+        }
+    }
+
+    return start;
+}
+
+/******************************************************************************/
+
+size_t
+Flatbuffer::place (const Table::Field & field_) {
+    switch (field_.m_kind) {
+        case Table::table_t :
+            return place (field_.m_tables.front());
+
+        case Table::string_t : {
+            pad (4);
+
+            auto rtn = m_buffer.size();
+
+            m_buffer.resize (rtn + 4);
+            put (m_buffer, rtn, static_cast<uint32_t> (field_.m_bytes.size()));
+            m_buffer.append (field_.m_bytes);
+            m_buffer.push_back ('\0');
+
+            return rtn;
+        }
+
+        case Table::structs_t : {
+            // the structs, not their count, need aligning
+            pad (4);
+            while ((m_buffer.size() + 4) % field_.m_size) m_buffer.append (4, '\0');
+
+            auto rtn = m_buffer.size();
+
+            m_buffer.resize (rtn + 4);
+            put (m_buffer, rtn, static_cast<uint32_t> (field_.m_count));
+            m_buffer.append (field_.m_bytes);
+
+            return rtn;
+        }
+
+        default : {
+            pad (4);
+
+            auto rtn = m_buffer.size();
+
+            m_buffer.resize (rtn + 4 + 4 * field_.m_tables.size(), '\0');
+            put (m_buffer, rtn, static_cast<uint32_t> (field_.m_tables.size()));
+
+            for (size_t i { 0 } ; i < field_.m_tables.size() ; ++i) {
+                auto target = place (field_.m_tables[i]);
+                patch (rtn + 4 + 4 * i, target);
+            }
+
+            return rtn;
+        }
+    }
+}
+
+/******************************************************************************/
+
+std::string
+Flatbuffer::finish (const Table & root_) {
+    Flatbuffer builder;
+
+    builder.m_buffer.assign (4, '\0');
+    builder.patch (0, builder.place (root_));
+    builder.pad (8);
+
+    return std::move (builder.m_buffer);
+}
+
+/******************************************************************************/
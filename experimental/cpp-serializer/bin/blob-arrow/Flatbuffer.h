@@ -0,0 +1,107 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/******************************************************************************/
+
+/**
+ * Just enough of a flatbuffer builder to write Arrow's metadata without
+ * linking in the flatbuffers library or generated code.
+ *
+ * A [Table] is described field by field, each by its slot in the schema
+ * the table belongs to, a union taking one slot for its type and the
+ * next for its value. [finish] then lays the whole tree out, every table
+ * and vector after whatever refers to it so offsets only ever run
+ * forward, with every scalar aligned to its size from the start of the
+ * buffer. The buffer must therefore be placed on an eight byte boundary.
+ */
+class Flatbuffer {
+    public :
+        class Table {
+            private :
+                friend class Flatbuffer;
+
+                enum Kind { scalar_t, table_t, tables_t, structs_t, string_t };
+
+                struct Field {
+                    uint16_t m_slot;
+                    Kind m_kind;
+
+                    /**
+                     * A scalar's value, the packed structs of a vector or
+                     * a string's characters
+                     */
+                    std::string m_bytes;
+
+                    /**
+                     * A scalar's size, or the alignment of a vector's
+                     * structs
+                     */
+                    size_t m_size;
+                    size_t m_count;
+
+                    std::vector<Table> m_tables;
+                };
+
+                std::vector<Field> m_fields;
+
+            public :
+                template<class T>
+                Table & scalar (uint16_t slot_, T value_) {
+                    std::string bytes (sizeof (T), '\0');
+                    std::memcpy (bytes.data(), &value_, sizeof (T));
+
+                    m_fields.push_back ({ slot_, scalar_t, std::move (bytes), sizeof (T), 0, { } });
+                    return *this;
+                }
+
+                Table & table (uint16_t slot_, Table table_) {
+                    m_fields.push_back ({ slot_, table_t, { }, 4, 0, { std::move (table_) } });
+                    return *this;
+                }
+
+                Table & tables (uint16_t slot_, std::vector<Table> tables_) {
+                    m_fields.push_back ({ slot_, tables_t, { }, 4, 0, std::move (tables_) });
+                    return *this;
+                }
+
+                /**
+                 * A vector of [count_] structs, already packed into
+                 * [bytes_], each aligned to [align_]
+                 */
+                Table & structs (uint16_t slot_, std::string bytes_, size_t count_, size_t align_ = 8) {
+                    m_fields.push_back ({ slot_, structs_t, std::move (bytes_), align_, count_, { } });
+                    return *this;
+                }
+
+                Table & string (uint16_t slot_, std::string_view value_) {
+                    m_fields.push_back ({ slot_, string_t, std::string (value_), 4, 0, { } });
+                    return *this;
+                }
+        };
+
+    private :
+        std::string m_buffer;
+
+        size_t place (const Table &);
+        size_t place (const Table::Field &);
+
+        void pad (size_t alignment_);
+
+        void patch (size_t at_, size_t target_);
+
+    public :
+        /**
+         * The buffer for the tree rooted at [root_], padded to a multiple
+         * of eight bytes
+         */
+        static std::string finish (const Table & root_);
+};
+
+/******************************************************************************/
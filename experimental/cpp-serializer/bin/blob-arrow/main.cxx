@@ -0,0 +1,121 @@
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Batch.h"
+#include "Columns.h"
+#include "CordaBytes.h"
+#include "ArrowWriter.h"
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr size_t DEFAULT_ROWS = 65536;
+
+    void
+    usage (const char * name_) {
+        std::cerr << "usage: " << name_ << " [--rows <n>] [--dictionary] <dir|glob|-> <file>" << std::endl;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Converts a set of blobs all holding the same type, the files named as
+ * blob-inspector --batch names them, into a single Arrow IPC file with a
+ * column per property of that type. The first blob decides the columns,
+ * see [Columns]. Rows are written a record batch of [--rows] at a time.
+ * With [--dictionary] strings and symbols are dictionary encoded, each
+ * distinct one being written once however many rows hold it. Any blob
+ * that can't be added is reported on stderr and left out
+ */
+int
+main (int argc, char **argv) {
+    size_t rows { DEFAULT_ROWS };
+    bool dictionary { false };
+    int arg { 1 };
+
+    while (argc > arg + 1) {
+        if (std::strcmp (argv[arg], "--rows") == 0) {
+            rows = std::strtoul (argv[arg + 1], nullptr, 10);
+            arg += 2;
+        } else if (std::strcmp (argv[arg], "--dictionary") == 0) {
+            dictionary = true;
+            ++arg;
+        } else {
+            break;
+        }
+    }
+
+    if (argc - arg != 2 || rows == 0) {
+        usage (argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto files = Batch::expand (argv[arg], std::cin);
+
+        if (files.empty()) {
+            std::cerr << "No blobs found in " << argv[arg] << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::unique_ptr<Columns> columns;
+        std::unique_ptr<ArrowWriter> writer;
+
+        std::ofstream out (argv[arg + 1], std::ios::binary);
+        if (!out) {
+            std::cerr << "Failed to open " << argv[arg + 1] << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        size_t failures { 0 };
+
+        for (const auto & file : files) {
+            try {
+                CordaBytes blob (file);
+
+                if (!columns) {
+                    columns = std::make_unique<Columns> (blob, dictionary);
+                    writer = std::make_unique<ArrowWriter> (out, columns->root());
+                }
+
+                columns->append (blob);
+            } catch (const std::runtime_error & e) {
+                std::cerr << Batch::error (file, e.what()) << std::endl;
+                ++failures;
+                continue;
+            }
+
+            if (columns->rows() == rows) {
+                writer->batch (columns->root());
+                columns->clear();
+            }
+        }
+
+        if (!writer) {
+            std::cerr << "None of the " << files.size() << " blobs could be read" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (columns->rows()) writer->batch (columns->root());
+        writer->close();
+
+        std::cerr << files.size() - failures << " rows of " << columns->type()
+            << " in " << writer->batches() << " batches";
+        if (failures) std::cerr << ", " << failures << " failed";
+        std::cerr << std::endl;
+
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/******************************************************************************/
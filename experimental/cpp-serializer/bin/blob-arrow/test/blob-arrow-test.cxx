@@ -0,0 +1,401 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <cstring>
+
+#include "Columns.h"
+#include "Generator.h"
+#include "CordaBytes.h"
+#include "ArrowWriter.h"
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Just enough of a flatbuffer reader to check what was written
+     */
+    class Reader {
+        private :
+            const std::string & m_buffer;
+            size_t m_table;
+
+            template<class T>
+            T at (size_t at_) const {
+                T rtn;
+                std::memcpy (&rtn, &m_buffer[at_], sizeof (T));
+                return rtn;
+            }
+
+            size_t field (uint16_t slot_) const {
+                auto vtable = m_table - at<int32_t> (m_table);
+                if (4u + 2 * slot_ >= at<uint16_t> (vtable)) return 0;
+
+                auto offset = at<uint16_t> (vtable + 4 + 2 * slot_);
+                return offset ? m_table + offset : 0;
+            }
+
+            size_t follow (size_t at_) const { return at_ + at<uint32_t> (at_); }
+
+        public :
+            Reader (const std::string & buffer_, size_t table_)
+                : m_buffer (buffer_), m_table (table_)
+            { }
+
+            static Reader root (const std::string & buffer_, size_t at_) {
+                return { buffer_, at_ + *reinterpret_cast<const uint32_t *> (&buffer_[at_]) };
+            }
+
+            template<class T>
+            T scalar (uint16_t slot_, T default_ = 0) const {
+                auto f = field (slot_);
+                return f ? at<T> (f) : default_;
+            }
+
+            Reader table (uint16_t slot_) const {
+                auto f = field (slot_);
+                EXPECT_NE (0u, f);
+                return { m_buffer, follow (f) };
+            }
+
+            size_t length (uint16_t slot_) const {
+                auto f = field (slot_);
+                return f ? at<uint32_t> (follow (f)) : 0;
+            }
+
+            Reader table (uint16_t slot_, size_t i_) const {
+                auto vector = follow (field (slot_));
+                return { m_buffer, follow (vector + 4 + 4 * i_) };
+            }
+
+            template<class T>
+            T structs (uint16_t slot_, size_t i_, size_t offset_, size_t size_) const {
+                auto vector = follow (field (slot_));
+                return at<T> (vector + 4 + size_ * i_ + offset_);
+            }
+
+            std::string string (uint16_t slot_) const {
+                auto s = follow (field (slot_));
+                return m_buffer.substr (s + 4, at<uint32_t> (s));
+            }
+    };
+
+    template<class T>
+    T
+    read (const std::string & file_, size_t at_) {
+        T rtn;
+        std::memcpy (&rtn, &file_[at_], sizeof (T));
+        return rtn;
+    }
+
+    /**
+     * A file's footer, checking it's framed as it should be
+     */
+    Reader
+    footer (const std::string & file_) {
+        EXPECT_EQ (0, file_.compare (0, 6, ArrowWriter::MAGIC));
+        EXPECT_EQ (0, file_.compare (file_.size() - 6, 6, ArrowWriter::MAGIC));
+
+        auto length = read<int32_t> (file_, file_.size() - 10);
+        auto start = file_.size() - 10 - length;
+
+        EXPECT_EQ (0u, start % 8);
+
+        auto rtn = Reader::root (file_, start);
+        EXPECT_EQ (4, rtn.scalar<int16_t> (0));
+
+        return rtn;
+    }
+
+    struct Batch {
+        Reader m_header;
+        size_t m_body;
+    };
+
+    /**
+     * The [i_]th record batch the footer indexes, checking its block
+     * agrees with the message there
+     */
+    Batch
+    batch (const std::string & file_, const Reader & footer_, size_t i_, uint16_t slot_ = 3) {
+        auto offset = footer_.structs<int64_t> (slot_, i_, 0, 24);
+        auto metadata = footer_.structs<int32_t> (slot_, i_, 8, 24);
+        auto body = footer_.structs<int64_t> (slot_, i_, 16, 24);
+
+        EXPECT_EQ (0u, offset % 8);
+        EXPECT_EQ (0xFFFFFFFF, read<uint32_t> (file_, offset));
+        EXPECT_EQ (metadata - 8, read<int32_t> (file_, offset + 4));
+
+        auto message = Reader::root (file_, offset + 8);
+        EXPECT_EQ (body, message.scalar<int64_t> (3));
+
+        return { message.table (2), static_cast<size_t> (offset + metadata) };
+    }
+
+    /**
+     * The [i_]th buffer of [batch_]
+     */
+    std::string
+    buffer (const std::string & file_, const Batch & batch_, size_t i_) {
+        auto offset = batch_.m_header.structs<int64_t> (2, i_, 0, 16);
+        auto length = batch_.m_header.structs<int64_t> (2, i_, 8, 16);
+
+        return file_.substr (batch_.m_body + offset, length);
+    }
+
+    std::string
+    write (Columns & columns_) {
+        std::stringstream ss;
+        {
+            ArrowWriter writer (ss, columns_.root());
+            writer.batch (columns_.root());
+        }
+        return ss.str();
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (BlobArrow, primitive) { // NOLINT
+    CordaBytes cb (filepath + "_i_");
+    Columns columns (cb);
+
+    for (int i { 0 } ; i < 3 ; ++i) columns.append (cb);
+    ASSERT_EQ (3u, columns.rows());
+
+    auto file = write (columns);
+    auto f = footer (file);
+
+    auto fields = f.table (1);
+    ASSERT_EQ (1u, fields.length (1));
+
+    auto a = fields.table (1, 0);
+    EXPECT_EQ ("a", a.string (0));
+    EXPECT_EQ (2, a.scalar<uint8_t> (2));
+    EXPECT_EQ (32, a.table (3).scalar<int32_t> (0));
+    EXPECT_EQ (0u, a.length (5));
+
+    ASSERT_EQ (1u, f.length (3));
+    auto b = batch (file, f, 0);
+
+    EXPECT_EQ (3, b.m_header.scalar<int64_t> (0));
+    ASSERT_EQ (1u, b.m_header.length (1));
+    EXPECT_EQ (3, (b.m_header.structs<int64_t> (1, 0, 0, 16)));
+    EXPECT_EQ (0, (b.m_header.structs<int64_t> (1, 0, 8, 16)));
+
+    ASSERT_EQ (2u, b.m_header.length (2));
+    EXPECT_EQ ("", buffer (file, b, 0));
+
+    auto values = buffer (file, b, 1);
+    ASSERT_EQ (12u, values.size());
+    for (int i { 0 } ; i < 3 ; ++i) EXPECT_EQ (69, read<int32_t> (values, 4 * i));
+}
+
+/******************************************************************************/
+
+TEST (BlobArrow, map) { // NOLINT
+    CordaBytes cb (filepath + "_Mis_");
+    Columns columns (cb);
+
+    columns.append (cb);
+    columns.append (cb);
+
+    auto file = write (columns);
+    auto f = footer (file);
+
+    auto a = f.table (1).table (1, 0);
+    EXPECT_EQ (17, a.scalar<uint8_t> (2));
+
+    auto entries = a.table (5, 0);
+    EXPECT_EQ ("entries", entries.string (0));
+    EXPECT_EQ (0, entries.scalar<uint8_t> (1));
+    ASSERT_EQ (2u, entries.length (5));
+    EXPECT_EQ ("key", entries.table (5, 0).string (0));
+    EXPECT_EQ ("value", entries.table (5, 1).string (0));
+
+    // a, entries, key and value
+    auto b = batch (file, f, 0);
+    ASSERT_EQ (4u, b.m_header.length (1));
+    EXPECT_EQ (2, (b.m_header.structs<int64_t> (1, 0, 0, 16)));
+    EXPECT_EQ (6, (b.m_header.structs<int64_t> (1, 1, 0, 16)));
+
+    auto offsets = buffer (file, b, 1);
+    ASSERT_EQ (12u, offsets.size());
+    EXPECT_EQ (0, read<int32_t> (offsets, 0));
+    EXPECT_EQ (3, read<int32_t> (offsets, 4));
+    EXPECT_EQ (6, read<int32_t> (offsets, 8));
+
+    // a's validity and offsets, entries' validity, the key's validity
+    // and values then the value's validity, offsets and data
+    ASSERT_EQ (8u, b.m_header.length (2));
+    EXPECT_EQ (5, read<int32_t> (buffer (file, b, 4), 8));
+    EXPECT_EQ ("twofoursixtwofoursix", buffer (file, b, 7));
+}
+
+/******************************************************************************/
+
+TEST (BlobArrow, enums) { // NOLINT
+    CordaBytes cb (filepath + "_Le_");
+    Columns columns (cb);
+    columns.append (cb);
+
+    auto file = write (columns);
+    auto f = footer (file);
+
+    auto item = f.table (1).table (1, 0).table (5, 0);
+    EXPECT_EQ (5, item.scalar<uint8_t> (2));
+
+    auto encoding = item.table (4);
+    EXPECT_EQ (32, encoding.table (1).scalar<int32_t> (0));
+
+    ASSERT_EQ (1u, f.length (2));
+    auto d = batch (file, f, 0, 2);
+    EXPECT_EQ (encoding.scalar<int64_t> (0), d.m_header.scalar<int64_t> (0));
+
+    auto values = d.m_header.table (1);
+    EXPECT_EQ (3, values.scalar<int64_t> (0));
+
+    // the data buffer of the dictionary's single utf8 column
+    auto offsets = values.structs<int64_t> (2, 2, 0, 16);
+    auto length = values.structs<int64_t> (2, 2, 8, 16);
+    EXPECT_EQ ("ABC", file.substr (d.m_body + offsets, length));
+
+    auto b = batch (file, f, 0);
+    auto indices = buffer (file, b, 3);
+    ASSERT_EQ (12u, indices.size());
+    for (int i { 0 } ; i < 3 ; ++i) EXPECT_EQ (i, read<int32_t> (indices, 4 * i));
+}
+
+/******************************************************************************/
+
+TEST (BlobArrow, mismatched) { // NOLINT
+    CordaBytes i (filepath + "_i_");
+    CordaBytes li (filepath + "_Li_");
+
+    Columns columns (i);
+    columns.append (i);
+
+    EXPECT_THROW (columns.append (li), std::runtime_error); // NOLINT
+    EXPECT_EQ (1u, columns.rows());
+
+    columns.append (i);
+    EXPECT_EQ (2u, columns.rows());
+
+    columns.clear();
+    EXPECT_EQ (0u, columns.rows());
+}
+
+/******************************************************************************/
+
+/**
+ * Batches written from the same columns either side of clearing them hold
+ * only what was appended since
+ */
+TEST (BlobArrow, generated) { // NOLINT
+    Generator::Shape shape;
+    shape.m_size = 8192;
+
+    std::stringstream blob;
+    Generator (shape).write (blob);
+
+    CordaBytes cb (blob);
+    Columns columns (cb);
+
+    std::stringstream ss;
+    {
+        ArrowWriter writer (ss, columns.root());
+
+        for (int i { 0 } ; i < 2 ; ++i) columns.append (cb);
+        writer.batch (columns.root());
+        columns.clear();
+
+        columns.append (cb);
+        writer.batch (columns.root());
+
+        EXPECT_EQ (2u, writer.batches());
+    }
+
+    auto file = ss.str();
+    auto f = footer (file);
+
+    ASSERT_EQ (2u, f.length (3));
+    EXPECT_EQ (2, batch (file, f, 0).m_header.scalar<int64_t> (0));
+    EXPECT_EQ (1, batch (file, f, 1).m_header.scalar<int64_t> (0));
+
+    // the same number of elements every time
+    auto first = batch (file, f, 0).m_header;
+    auto second = batch (file, f, 1).m_header;
+
+    ASSERT_EQ (first.length (1), second.length (1));
+    EXPECT_EQ (
+        (first.structs<int64_t> (1, 1, 0, 16)),
+        2 * (second.structs<int64_t> (1, 1, 0, 16)));
+}
+
+/******************************************************************************/
+
+/**
+ * A dictionary started empty with the file, each batch preceded by a
+ * delta of only the strings it's the first to hold
+ */
+TEST (BlobArrow, dictionary) { // NOLINT
+    CordaBytes cb (filepath + "_Mis_");
+    Columns columns (cb, true);
+
+    std::stringstream ss;
+    {
+        ArrowWriter writer (ss, columns.root());
+
+        columns.append (cb);
+        writer.batch (columns.root());
+        columns.clear();
+
+        columns.append (cb);
+        writer.batch (columns.root());
+    }
+
+    auto file = ss.str();
+    auto f = footer (file);
+
+    auto value = f.table (1).table (1, 0).table (5, 0).table (5, 1);
+    EXPECT_EQ (5, value.scalar<uint8_t> (2));
+    EXPECT_EQ (32, value.table (4).table (1).scalar<int32_t> (0));
+
+    // the empty dictionary and the one delta
+    ASSERT_EQ (2u, f.length (2));
+
+    auto first = batch (file, f, 0, 2);
+    EXPECT_EQ (0, first.m_header.scalar<uint8_t> (2));
+    EXPECT_EQ (0, first.m_header.table (1).scalar<int64_t> (0));
+
+    auto delta = batch (file, f, 1, 2);
+    EXPECT_EQ (1, delta.m_header.scalar<uint8_t> (2));
+
+    auto values = delta.m_header.table (1);
+    EXPECT_EQ (3, values.scalar<int64_t> (0));
+
+    auto offsets = values.structs<int64_t> (2, 2, 0, 16);
+    auto length = values.structs<int64_t> (2, 2, 8, 16);
+    EXPECT_EQ ("twofoursix", file.substr (delta.m_body + offsets, length));
+
+    // both batches coded against the same strings, the value's codes
+    // following a's validity and offsets, entries' validity, the key's
+    // validity and values and the value's validity
+    ASSERT_EQ (2u, f.length (3));
+
+    for (size_t i { 0 } ; i < 2 ; ++i) {
+        auto b = batch (file, f, i);
+        ASSERT_EQ (7u, b.m_header.length (2));
+
+        auto codes = buffer (file, b, 6);
+        ASSERT_EQ (12u, codes.size());
+        for (int j { 0 } ; j < 3 ; ++j) EXPECT_EQ (j, read<int32_t> (codes, 4 * j));
+    }
+}
+
+/******************************************************************************/
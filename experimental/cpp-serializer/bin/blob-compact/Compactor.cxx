@@ -0,0 +1,417 @@
+#include "Compactor.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+
+#include "types.h"
+#include "CordaBytes.h"
+#include "cursor/Cursor.h"
+#include "amqp/AMQPHeader.h"
+#include "amqp/ReaderCache.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/reader/Reader.h"
+#include "amqp/reader/ObjectTable.h"
+#include "amqp/reader/CompositeReader.h"
+#include "amqp/reader/restricted-readers/MapReader.h"
+#include "amqp/reader/restricted-readers/ListReader.h"
+#include "amqp/reader/restricted-readers/ArrayReader.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+    namespace reader = amqp::internal::reader;
+
+    using Hash = Compactor::Hash;
+
+    uint64_t
+    splitmix (uint64_t x_) {
+        x_ += 0x9e3779b97f4a7c15ULL;
+        x_ = (x_ ^ (x_ >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+        x_ = (x_ ^ (x_ >> 27U)) * 0x94d049bb133111ebULL;
+        return x_ ^ (x_ >> 31U);
+    }
+
+    /**
+     * The two halves are built differently so a collision in one is no
+     * more likely to be a collision in the other
+     */
+    void
+    mix (Hash & hash_, std::string_view bytes_) {
+        hash_.m_a = splitmix (hash_.m_a ^ std::hash<std::string_view>{ } (bytes_));
+
+        for (auto c : bytes_) {
+            hash_.m_b = (hash_.m_b ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+
+        hash_.m_b = splitmix (hash_.m_b ^ bytes_.size());
+    }
+
+    void
+    mix (Hash & hash_, uint64_t value_) {
+        hash_.m_a = splitmix (hash_.m_a ^ value_);
+        hash_.m_b = splitmix ((hash_.m_b ^ value_) * 0x100000001b3ULL);
+    }
+
+    void
+    mix (Hash & hash_, const Hash & child_) {
+        mix (hash_, child_.m_a);
+        hash_.m_b = splitmix (hash_.m_b + child_.m_b);
+    }
+
+    /**************************************************************************/
+
+    void
+    be32 (std::string & out_, uint32_t v_) {
+        out_ += static_cast<char> (v_ >> 24U);
+        out_ += static_cast<char> (v_ >> 16U);
+        out_ += static_cast<char> (v_ >> 8U);
+        out_ += static_cast<char> (v_);
+    }
+
+    /**
+     * A list or map holding [elements_] values encoded as [body_], sized
+     * with a byte where they fit in one
+     */
+    void
+    compound (std::string & out_, bool map_, const std::string & body_, size_t elements_) {
+        if (!map_ && elements_ == 0) {
+            out_ += '\x45';
+        } else if (body_.size() < 255 && elements_ < 256) {
+            out_ += map_ ? '\xc1' : '\xc0';
+            out_ += static_cast<char> (body_.size() + 1);
+            out_ += static_cast<char> (elements_);
+        } else {
+            out_ += map_ ? '\xd1' : '\xd0';
+            be32 (out_, static_cast<uint32_t> (body_.size() + 4));
+            be32 (out_, static_cast<uint32_t> (elements_));
+        }
+
+        out_.append (body_);
+    }
+
+    /**************************************************************************/
+
+    enum Shape { composite_s, list_s, map_s, value_s };
+
+    /**
+     * How a value is walked. Anything that isn't a described list or map
+     * where the reader expects one, a null say or an array of ints, is
+     * hashed and copied as it was encoded
+     */
+    Shape
+    shape (const reader::Reader & reader_, const cursor::Cursor & data_) {
+        if (data_.type() != cursor::described_t) return value_s;
+
+        cursor::Cursor peek { data_ };
+        cursor::auto_enter ae (peek, true);
+
+        if (dynamic_cast<const reader::CompositeReader *>(&reader_)) {
+            return peek.type() == cursor::list_t ? composite_s : value_s;
+        }
+
+        if (dynamic_cast<const reader::ListReader *>(&reader_)
+            || dynamic_cast<const reader::ArrayReader *>(&reader_))
+        {
+            return peek.type() == cursor::list_t ? list_s : value_s;
+        }
+
+        if (dynamic_cast<const reader::MapReader *>(&reader_)) {
+            return peek.type() == cursor::map_t ? map_s : value_s;
+        }
+
+        return value_s;
+    }
+
+    const reader::Reader &
+    lock (const reader::Reader * reader_) {
+        if (reader_) {
+            // the cache keeps the graph alive for us
+            return *reader_;
+        }
+
+        throw std::runtime_error ("null reader");
+    }
+
+    /**
+     * The reader of the [idx_]th value within a value of [shape_]
+     */
+    const reader::Reader &
+    child (const reader::Reader & reader_, Shape shape_, size_t idx_) {
+        switch (shape_) {
+            case composite_s : {
+                const auto & readers = dynamic_cast<const reader::CompositeReader &> (
+                        reader_).readers();
+
+                if (idx_ >= readers.size()) {
+                    throw std::runtime_error ("More fields than " + reader_.type() + " has");
+                }
+
+                return lock (readers[idx_]);
+            }
+            case list_s :
+                if (auto list = dynamic_cast<const reader::ListReader *>(&reader_)) {
+                    return lock (list->reader());
+                }
+                return lock (dynamic_cast<const reader::ArrayReader &> (reader_).reader());
+            default : {
+                const auto & map = dynamic_cast<const reader::MapReader &> (reader_);
+                return lock (idx_ % 2 ? map.valueReader() : map.keyReader());
+            }
+        }
+    }
+
+    /**
+     * Move past a REFERENCED_OBJECT returning the index it refers to
+     */
+    size_t
+    index (cursor::Cursor & data_) {
+        cursor::auto_next an (data_);
+        cursor::auto_enter ae (data_, true);
+
+        return data_.type() == cursor::ulong_t ? data_.get_ulong() : data_.get_uint();
+    }
+
+}
+
+/******************************************************************************/
+
+Compactor::Compactor (const CordaBytes & blob_)
+    : m_blob (blob_)
+    , m_next (0)
+    , m_numbered (0)
+    , m_references (0)
+{ }
+
+/******************************************************************************/
+
+/**
+ * Hash the value at the cursor, and everything within it, leaving the
+ * cursor on its next sibling. Numbers the value as the blob did
+ */
+Compactor::Hash
+Compactor::hash (
+    const amqp::internal::reader::Reader & reader_,
+    amqp::internal::cursor::Cursor & data_,
+    bool element_
+) {
+    auto idx = m_nodes.size();
+    m_nodes.push_back ({ { 0, 0 }, 0 });
+
+    Hash rtn { 0xcbf29ce484222325ULL, 0xcbf29ce484222325ULL };
+
+    if (reader::ObjectTable::isReference (data_)) {
+        auto referenced = index (data_);
+
+        if (referenced >= m_old.size()) {
+            std::stringstream ss;
+            ss << "Reference to object " << referenced << " but only "
+               << m_old.size() << " have been decoded";
+            throw std::runtime_error (ss.str());
+        }
+
+        rtn = m_old[referenced];
+    } else {
+        mix (rtn, reader_.type());
+
+        auto s = shape (reader_, data_);
+
+        if (s == value_s) {
+            mix (rtn, data_.encoded());
+            data_.next();
+        } else {
+            cursor::auto_next an (data_);
+            cursor::auto_enter ae (data_);
+
+            mix (rtn, data_.encoded());
+            data_.next();
+
+            size_t elements = s == map_s ? data_.get_map() : data_.get_list();
+            cursor::auto_list_enter ale (data_, true);
+
+            for (size_t i { 0 } ; i < elements ; ++i) {
+                mix (rtn, hash (child (reader_, s, i), data_, s != composite_s));
+            }
+
+            mix (rtn, static_cast<uint64_t> (elements));
+        }
+
+        if (reader_.referenceable (element_)) m_old.push_back (rtn);
+    }
+
+    m_nodes[idx] = { rtn, m_nodes.size() - idx };
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Compactor::reference (const Hash & hash_, std::string & out_) {
+    auto it = m_new.find (hash_);
+
+    if (it == m_new.end()) {
+        throw std::runtime_error ("Reference to an object that hasn't been written");
+    }
+
+    out_ += '\x00';
+    out_ += '\x80';
+
+    uint64_t descriptor = amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS
+        | static_cast<uint64_t> (amqp::schema::descriptors::REFERENCED_OBJECT);
+
+    be32 (out_, static_cast<uint32_t> (descriptor >> 32U));
+    be32 (out_, static_cast<uint32_t> (descriptor));
+
+    if (it->second < 256) {
+        out_ += '\x52';
+        out_ += static_cast<char> (it->second);
+    } else {
+        out_ += '\x70';
+        be32 (out_, it->second);
+    }
+
+    ++m_references;
+}
+
+/******************************************************************************/
+
+/**
+ * Mirrors [hash], walking the same nodes in the same order
+ */
+void
+Compactor::write (
+    const amqp::internal::reader::Reader & reader_,
+    amqp::internal::cursor::Cursor & data_,
+    std::string & out_,
+    bool element_
+) {
+    const auto & node = m_nodes[m_next];
+
+    bool referenceable = reader_.referenceable (element_);
+
+    if (reader::ObjectTable::isReference (data_)
+        || (referenceable && m_new.count (node.m_hash)))
+    {
+        reference (node.m_hash, out_);
+        data_.next();
+        m_next += node.m_nodes;
+        return;
+    }
+
+    ++m_next;
+
+    auto s = shape (reader_, data_);
+
+    if (s == value_s) {
+        out_.append (data_.encoded());
+        data_.next();
+    } else {
+        cursor::auto_next an (data_);
+        cursor::auto_enter ae (data_);
+
+        out_ += '\x00';
+        out_.append (data_.encoded());
+        data_.next();
+
+        size_t elements = s == map_s ? data_.get_map() : data_.get_list();
+        cursor::auto_list_enter ale (data_, true);
+
+        std::string body;
+
+        for (size_t i { 0 } ; i < elements ; ++i) {
+            write (child (reader_, s, i), data_, body, s != composite_s);
+        }
+
+        compound (out_, s == map_s, body, elements);
+    }
+
+    if (referenceable) m_new.emplace (node.m_hash, m_numbered++);
+}
+
+/******************************************************************************/
+
+std::string
+Compactor::compact() {
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    if (m_blob.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    m_nodes.clear();
+    m_old.clear();
+    m_new.clear();
+    m_next = 0;
+    m_numbered = 0;
+    m_references = 0;
+
+    cursor::Cursor data (m_blob.bytes(), m_blob.size());
+
+    auto peek = EnvelopeDescriptor::peek (data);
+
+    auto entry = amqp::internal::ReaderCache::instance().fetch (
+            peek.m_schema,
+            [&data]() {
+                cursor::Cursor envelope { data };
+                cursor::auto_enter p (envelope);
+
+                auto a = envelope.get_ulong();
+
+                return uPtr<amqp::internal::schema::Envelope> (
+                        dynamic_cast<amqp::internal::schema::Envelope *> (
+                                amqp::internal::AMQPDescriptorRegistory[a]->build (envelope).release()));
+            });
+
+    auto root = dynamic_cast<const reader::Reader *> (
+            entry->byDescriptor (std::string { peek.m_descriptor }));
+
+    if (!root) {
+        throw std::runtime_error ("No reader for " + std::string { peek.m_descriptor });
+    }
+
+    std::string rtn (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+    rtn += static_cast<char> (m_blob.encoding());
+
+    {
+        cursor::Cursor payload { data };
+        cursor::auto_enter ae (payload, true);
+        cursor::auto_list_enter ale (payload, true);
+
+        hash (*root, payload, false);
+    }
+
+    {
+        cursor::auto_enter ae (data);
+
+        rtn += '\x00';
+        rtn.append (data.encoded());
+        data.next();
+
+        cursor::auto_list_enter ale (data, true);
+
+        // the payload then the schema and anything else, untouched
+        std::string body;
+        write (*root, data, body, false);
+
+        for (size_t i { 1 } ; i < ale.elements() ; ++i) {
+            body.append (data.encoded());
+            data.next();
+        }
+
+        compound (rtn, false, body, ale.elements());
+    }
+
+    auto end = data.offset() + data.encodedSize();
+    rtn.append (m_blob.bytes() + end, m_blob.size() - end);
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,121 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+namespace amqp::internal::reader {
+
+    class Reader;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Re-encodes a blob replacing every object identical to one already
+ * written with a REFERENCED_OBJECT pointing back at it, the way the JVM
+ * serialiser does for an object it meets twice by identity but here for
+ * any two that are equal by value.
+ *
+ * Only what the JVM numbers, see [ObjectTable], can be referred to, and
+ * the references go by the numbering a decoder will give the compacted
+ * blob. References already in the blob are rewritten to match it.
+ *
+ * Objects are told apart by a 128 bit structural hash of their type and
+ * contents, a reference counting as what it refers to. The first pass
+ * hashes every value, the second writes them, so it's known before an
+ * object is written whether it need be.
+ *
+ * Lists and maps are rewritten with the smallest size that fits what
+ * they now hold, everything else is copied as it was encoded.
+ */
+class Compactor {
+    public :
+        struct Hash {
+            uint64_t m_a;
+            uint64_t m_b;
+
+            bool operator == (const Hash & rhs_) const {
+                return m_a == rhs_.m_a && m_b == rhs_.m_b;
+            }
+        };
+
+    private :
+        struct Hasher {
+            size_t operator() (const Hash & hash_) const {
+                return static_cast<size_t>(hash_.m_a);
+            }
+        };
+
+        /**
+         * Every value the readers decode, in the order they decode them
+         */
+        struct Node {
+            Hash m_hash;
+
+            /**
+             * The nodes making up the value, itself included, how many
+             * to skip to replace it with a reference
+             */
+            size_t m_nodes;
+        };
+
+        const CordaBytes & m_blob;
+
+        std::vector<Node> m_nodes;
+        size_t m_next;
+
+        /**
+         * The hashes of the objects as the blob numbered them, to resolve
+         * the references it already holds
+         */
+        std::vector<Hash> m_old;
+
+        /**
+         * The number each written object has in the compacted blob
+         */
+        std::unordered_map<Hash, uint32_t, Hasher> m_new;
+        uint32_t m_numbered;
+
+        size_t m_references;
+
+        Hash hash (const amqp::internal::reader::Reader &, amqp::internal::cursor::Cursor &, bool element_);
+
+        void write (
+            const amqp::internal::reader::Reader &,
+            amqp::internal::cursor::Cursor &,
+            std::string &,
+            bool element_);
+
+        void reference (const Hash &, std::string &);
+
+    public :
+        explicit Compactor (const CordaBytes &);
+
+        /**
+         * The compacted blob, header and all
+         */
+        std::string compact();
+
+        /**
+         * How many references the last [compact] wrote, including those
+         * the blob already had
+         */
+        size_t references() const { return m_references; }
+};
+
+/******************************************************************************/
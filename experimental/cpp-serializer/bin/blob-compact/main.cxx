@@ -0,0 +1,62 @@
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Compactor.h"
+#include "CordaBytes.h"
+#include "amqp/AMQPHeader.h"
+
+/******************************************************************************/
+
+/**
+ * Re-encodes the blob given, or given "-" the one on stdin, into the file
+ * given or, given "-", stdout, every object equal to one already written
+ * becoming a reference back to it, see [Compactor]. What was saved is
+ * reported on stderr
+ */
+int
+main (int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <blob|-> <file|->" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::unique_ptr<CordaBytes> bytes;
+
+        if (std::string ("-") == argv[1]) {
+            bytes = std::make_unique<CordaBytes> (std::cin);
+        } else {
+            bytes = std::make_unique<CordaBytes> (argv[1]);
+        }
+
+        Compactor compactor (*bytes);
+        auto compacted = compactor.compact();
+
+        if (std::string ("-") == argv[2]) {
+            std::cout.write (compacted.data(), compacted.size());
+        } else {
+            std::ofstream out (argv[2], std::ios::binary);
+            out.write (compacted.data(), compacted.size());
+
+            if (!out) {
+                std::cerr << "Failed to write " << argv[2] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        // the header and encoding aren't counted in the blob's size
+        std::cerr << compactor.references() << " references, "
+            << bytes->size() + amqp::AMQP_HEADER.size() + 1 << " to " << compacted.size() << " bytes"
+            << std::endl;
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
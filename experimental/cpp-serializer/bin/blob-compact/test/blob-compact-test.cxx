@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "Batch.h"
+#include "Compactor.h"
+#include "Generator.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    json (CordaBytes & cb_, bool pointers_ = false) {
+        std::stringstream ss;
+        {
+            amqp::internal::sink::JsonSink sink (ss);
+            BlobInspector (cb_).pointers (pointers_).write (sink);
+        }
+        return ss.str();
+    }
+
+    /**
+     * Compact [cb_] checking the result still decodes to the same thing
+     * both as a tree and streamed out
+     */
+    std::string
+    roundTrip (CordaBytes & cb_, size_t * references_ = nullptr) {
+        Compactor compactor (cb_);
+        auto compacted = compactor.compact();
+
+        if (references_) *references_ = compactor.references();
+
+        std::stringstream ss (compacted);
+        CordaBytes cb (ss);
+
+        EXPECT_EQ (BlobInspector (cb_).dump(), BlobInspector (cb).dump());
+        EXPECT_EQ (json (cb_), json (cb));
+
+        return compacted;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (BlobCompact, testFiles) { // NOLINT
+    std::stringstream none;
+
+    for (const auto & file : Batch::expand (filepath, none)) {
+        SCOPED_TRACE (file);
+
+        CordaBytes cb (file);
+        roundTrip (cb);
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * The references already there are renumbered to suit the compacted blob
+ * and nothing new is found
+ */
+TEST (BlobCompact, existingReferences) { // NOLINT
+    CordaBytes cb (filepath + "_Le_2");
+
+    size_t references;
+    std::stringstream ss (roundTrip (cb, &references));
+    CordaBytes compacted (ss);
+
+    EXPECT_EQ (2U, references);
+    EXPECT_EQ (json (cb, true), json (compacted, true));
+}
+
+/******************************************************************************/
+
+/**
+ * Enum fields repeat throughout a generated blob, as do the composites
+ * holding nothing but them
+ */
+TEST (BlobCompact, generated) { // NOLINT
+    Generator::Shape shape;
+    shape.m_size = 64 << 10;
+    shape.m_enums = 1.0;
+    shape.m_fields = 1;
+    shape.m_listSize = 0;
+    shape.m_mapSize = 0;
+
+    std::stringstream blob;
+    Generator (shape).write (blob);
+
+    CordaBytes cb (blob);
+
+    size_t references;
+    auto compacted = roundTrip (cb, &references);
+
+    EXPECT_LT (0U, references);
+    EXPECT_GT (cb.size() / 2, compacted.size());
+
+    std::stringstream ss (compacted);
+    CordaBytes again (ss);
+
+    // compacting twice finds nothing more
+    EXPECT_EQ (compacted, Compactor (again).compact());
+}
+
+/******************************************************************************/
+
+TEST (BlobCompact, notCorda) { // NOLINT
+    std::stringstream ss (std::string ("corda\x01\x00\x02", 8));
+    CordaBytes cb (ss);
+
+    EXPECT_THROW (Compactor (cb).compact(), std::runtime_error);
+}
+
+/******************************************************************************/
@@ -0,0 +1,335 @@
+#include "Diff.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using Tape = amqp::internal::tape::Tape;
+
+    /**
+     * A map's key as the JSON it would be written as, which is how its
+     * entries are matched and how it appears in a path
+     */
+    std::string
+    key (const Tape & tape_, const Tape::Ref & key_) {
+        std::string rtn;
+        {
+            amqp::internal::sink::JsonSink sink (rtn);
+            tape_.write (key_, sink);
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Add [name_] to [path_] returning how long it was so it can be put
+     * back
+     */
+    size_t
+    field (std::string & path_, std::string_view name_) {
+        const auto rtn = path_.size();
+
+        if (!path_.empty()) path_ += '.';
+        path_ += name_;
+
+        return rtn;
+    }
+
+    size_t
+    element (std::string & path_, std::string_view index_) {
+        const auto rtn = path_.size();
+
+        path_ += '[';
+        path_ += index_;
+        path_ += ']';
+
+        return rtn;
+    }
+
+    const char *
+    name (Diff::Change change_) {
+        switch (change_) {
+            case Diff::added_t   : return "added";
+            case Diff::removed_t : return "removed";
+            default              : return "changed";
+        }
+    }
+
+    /**
+     * The value of an object or map's entry, just past its key
+     */
+    Tape::Ref
+    valueOf (const Tape::Ref & key_) {
+        return key_.next();
+    }
+
+}
+
+/******************************************************************************/
+
+Diff::Diff (const Tape & from_, const Tape & to_)
+    : m_fromTape (from_)
+    , m_toTape (to_)
+    , m_skipped (0)
+{
+    if (from_.empty() || to_.empty()) {
+        throw std::runtime_error ("Nothing to compare");
+    }
+
+    auto from = from_.begin()["Parsed"];
+    auto to = to_.begin()["Parsed"];
+
+    if (from == from_.begin().end() || to == to_.begin().end()) {
+        throw std::runtime_error ("Expected a Parsed value to compare");
+    }
+
+    std::string path;
+    compare (path, from, to);
+}
+
+/******************************************************************************/
+
+void
+Diff::added (const std::string & path_, const Tape::Ref & to_) {
+    m_differences.push_back ({ added_t, path_, m_fromTape.end(), to_ });
+}
+
+/******************************************************************************/
+
+void
+Diff::removed (const std::string & path_, const Tape::Ref & from_) {
+    m_differences.push_back ({ removed_t, path_, from_, m_toTape.end() });
+}
+
+/******************************************************************************/
+
+void
+Diff::changed (const std::string & path_, const Tape::Ref & from_, const Tape::Ref & to_) {
+    m_differences.push_back ({ changed_t, path_, from_, to_ });
+}
+
+/******************************************************************************/
+
+void
+Diff::compare (std::string & path_, const Tape::Ref & from_, const Tape::Ref & to_) {
+    if (from_.type() != to_.type()) {
+        changed (path_, from_, to_);
+        return;
+    }
+
+    switch (from_.type()) {
+        case Tape::object_t : {
+            if (from_.hashed() && to_.hashed() && from_.hash() == to_.hash()) {
+                ++m_skipped;
+                return;
+            }
+
+            compareObjects (path_, from_, to_);
+            return;
+        }
+        case Tape::list_t : compareLists (path_, from_, to_); return;
+        case Tape::map_t  : compareMaps (path_, from_, to_); return;
+        case Tape::null_t : return;
+        case Tape::bool_t : {
+            if (from_.boolean() != to_.boolean()) changed (path_, from_, to_);
+            return;
+        }
+        case Tape::integer_t : {
+            if (from_.integer() != to_.integer()) changed (path_, from_, to_);
+            return;
+        }
+        case Tape::real_t : {
+            // bit for bit, so a NaN is the same as itself
+            auto from = from_.real();
+            auto to = to_.real();
+
+            if (std::memcmp (&from, &to, sizeof (from)) != 0) changed (path_, from_, to_);
+            return;
+        }
+        default : {
+            if (from_.text() != to_.text()) changed (path_, from_, to_);
+            return;
+        }
+    }
+}
+
+/******************************************************************************/
+
+/*
+ * Few enough fields that looking each up by name is no slower than
+ * indexing them
+ */
+void
+Diff::compareObjects (std::string & path_, const Tape::Ref & from_, const Tape::Ref & to_) {
+    const auto fromEnd = from_.end();
+    const auto toEnd = to_.end();
+
+    for (auto it = from_.begin() ; it != fromEnd ; it = valueOf (it).next()) {
+        auto length = field (path_, it.text());
+        auto other = to_[it.text()];
+
+        if (other == toEnd) {
+            removed (path_, valueOf (it));
+        } else {
+            compare (path_, valueOf (it), other);
+        }
+
+        path_.resize (length);
+    }
+
+    for (auto it = to_.begin() ; it != toEnd ; it = valueOf (it).next()) {
+        if (from_[it.text()] != fromEnd) continue;
+
+        auto length = field (path_, it.text());
+        added (path_, valueOf (it));
+        path_.resize (length);
+    }
+}
+
+/******************************************************************************/
+
+void
+Diff::compareLists (std::string & path_, const Tape::Ref & from_, const Tape::Ref & to_) {
+    const auto fromEnd = from_.end();
+    const auto toEnd = to_.end();
+
+    auto from = from_.begin();
+    auto to = to_.begin();
+
+    for (size_t i { 0 } ; from != fromEnd || to != toEnd ; ++i) {
+        auto length = element (path_, std::to_string (i));
+
+        if (to == toEnd) {
+            removed (path_, from);
+            from = from.next();
+        } else if (from == fromEnd) {
+            added (path_, to);
+            to = to.next();
+        } else {
+            compare (path_, from, to);
+            from = from.next();
+            to = to.next();
+        }
+
+        path_.resize (length);
+    }
+}
+
+/******************************************************************************/
+
+void
+Diff::compareMaps (std::string & path_, const Tape::Ref & from_, const Tape::Ref & to_) {
+    const auto fromEnd = from_.end();
+    const auto toEnd = to_.end();
+
+    std::unordered_map<std::string, Tape::Ref> to;
+
+    for (auto it = to_.begin() ; it != toEnd ; it = valueOf (it).next()) {
+        to.emplace (key (m_toTape, it), valueOf (it));
+    }
+
+    std::unordered_set<std::string> seen;
+
+    for (auto it = from_.begin() ; it != fromEnd ; it = valueOf (it).next()) {
+        auto k = key (m_fromTape, it);
+        auto length = element (path_, k);
+        auto other = to.find (k);
+
+        if (other == to.end()) {
+            removed (path_, valueOf (it));
+        } else {
+            compare (path_, valueOf (it), other->second);
+        }
+
+        path_.resize (length);
+        seen.insert (std::move (k));
+    }
+
+    // those added in the order they're in
+    for (auto it = to_.begin() ; it != toEnd ; it = valueOf (it).next()) {
+        auto k = key (m_toTape, it);
+
+        if (seen.count (k)) continue;
+
+        auto length = element (path_, k);
+        added (path_, valueOf (it));
+        path_.resize (length);
+    }
+}
+
+/******************************************************************************/
+
+void
+Diff::write (
+    const Difference & difference_,
+    amqp::reader::ISink & sink_,
+    std::string_view fromFile_,
+    std::string_view toFile_
+) const {
+    sink_.beginObject();
+
+    if (!fromFile_.empty()) {
+        sink_.key ("fromFile");
+        sink_.string (fromFile_);
+        sink_.key ("toFile");
+        sink_.string (toFile_);
+    }
+
+    sink_.key ("path");
+    sink_.string (difference_.m_path);
+    sink_.key ("change");
+    sink_.string (name (difference_.m_change));
+
+    if (difference_.m_from != m_fromTape.end()) {
+        sink_.key ("from");
+        m_fromTape.write (difference_.m_from, sink_);
+    }
+
+    if (difference_.m_to != m_toTape.end()) {
+        sink_.key ("to");
+        m_toTape.write (difference_.m_to, sink_);
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+size_t
+Diff::lines (
+    CordaBytes & from_,
+    CordaBytes & to_,
+    std::string & lines_,
+    std::string_view fromFile_,
+    std::string_view toFile_
+) {
+    const auto from = BlobInspector (from_).tape (true);
+    const auto to = BlobInspector (to_).tape (true);
+
+    Diff diff (from, to);
+
+    lines_.clear();
+
+    for (const auto & difference : diff.differences()) {
+        {
+            amqp::internal::sink::JsonSink sink (lines_);
+            diff.write (difference, sink, fromFile_, toFile_);
+        }
+
+        lines_ += '\n';
+    }
+
+    return diff.differences().size();
+}
+
+/******************************************************************************/
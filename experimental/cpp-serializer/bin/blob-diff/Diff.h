@@ -0,0 +1,117 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+#include "tape/Tape.h"
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************/
+
+/**
+ * The fields that differ between two blobs, found by walking the tapes
+ * of both side by side, see [BlobInspector::tape], rather than rendering
+ * each and comparing the text.
+ *
+ * Every composite on the tapes carries its structural hash, so two whose
+ * hashes match are equal and are passed over without looking inside.
+ * That only holds for composites of the same type, a type's descriptor
+ * being part of its hash, so blobs of different versions of a schema are
+ * still compared field by field, fields being matched by name. Anything
+ * whose type hasn't changed between the versions is again passed over on
+ * its hash.
+ *
+ * Paths are dotted, as [BlobInspector::project] takes them, from the
+ * blob's outermost type, an element of a list adding its index and a
+ * value of a map its key as JSON, "states[3].amount", "balances[\"GBP\"]".
+ * Lists are compared element by element, so an element inserted part
+ * way through shows as every element after it having changed.
+ */
+class Diff {
+    public :
+        using Tape = amqp::internal::tape::Tape;
+
+        enum Change { added_t, removed_t, changed_t };
+
+        /**
+         * A value in one blob but not the other, or in both and not the
+         * same. [m_from] and [m_to] are the value in each, the end of
+         * its tape for whichever doesn't have it
+         */
+        struct Difference {
+            Change m_change;
+            std::string m_path;
+            Tape::Ref m_from;
+            Tape::Ref m_to;
+        };
+
+    private :
+        const Tape & m_fromTape;
+        const Tape & m_toTape;
+
+        std::vector<Difference> m_differences;
+
+        /**
+         * Composites passed over as their hashes matched
+         */
+        size_t m_skipped;
+
+        void compare (std::string & path_, const Tape::Ref &, const Tape::Ref &);
+        void compareObjects (std::string & path_, const Tape::Ref &, const Tape::Ref &);
+        void compareLists (std::string & path_, const Tape::Ref &, const Tape::Ref &);
+        void compareMaps (std::string & path_, const Tape::Ref &, const Tape::Ref &);
+
+        void added (const std::string & path_, const Tape::Ref &);
+        void removed (const std::string & path_, const Tape::Ref &);
+        void changed (const std::string & path_, const Tape::Ref &, const Tape::Ref &);
+
+    public :
+        /**
+         * Compare the "Parsed" values of two tapes, which must have been
+         * built with their hashes and must outlive the [Diff]
+         */
+        Diff (const Tape & from_, const Tape & to_);
+
+        Diff (const Diff &) = delete;
+
+        const std::vector<Difference> & differences() const { return m_differences; }
+
+        size_t skipped() const { return m_skipped; }
+
+        /**
+         * As a single JSON object, { "path" : ..., "change" : ... } and
+         * the "from" and "to" values as there are, first naming the two
+         * files compared if given them
+         */
+        void write (
+            const Difference &,
+            amqp::reader::ISink &,
+            std::string_view fromFile_ = { },
+            std::string_view toFile_ = { }) const;
+
+        /**
+         * The differences between two blobs, each on a line of its own,
+         * as [write] writes them. Returns how many there were
+         */
+        static size_t lines (
+            CordaBytes & from_,
+            CordaBytes & to_,
+            std::string & lines_,
+            std::string_view fromFile_ = { },
+            std::string_view toFile_ = { });
+};
+
+/******************************************************************************/
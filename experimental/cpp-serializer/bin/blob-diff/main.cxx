@@ -0,0 +1,170 @@
+#include <deque>
+#include <string>
+#include <vector>
+#include <thread>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "Diff.h"
+#include "CordaBytes.h"
+#include "WorkStealingPool.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * How many pairs are compared before their lines are written out, so
+     * the lines of a huge manifest needn't all be held at once
+     */
+    constexpr size_t CHUNK = 4096;
+
+    void
+    usage (const char * name_) {
+        std::cerr << "usage: " << name_ << " <from> <to>" << std::endl
+            << "       " << name_ << " [--threads n] --pairs <file|->" << std::endl;
+    }
+
+    struct Pair {
+        std::string m_from;
+        std::string m_to;
+
+        std::string m_lines;
+        size_t m_differences { 0 };
+        std::string m_error;
+    };
+
+    void
+    compare (Pair & pair_, bool named_) {
+        try {
+            CordaBytes from (pair_.m_from);
+            CordaBytes to (pair_.m_to);
+
+            pair_.m_differences = named_
+                ? Diff::lines (from, to, pair_.m_lines, pair_.m_from, pair_.m_to)
+                : Diff::lines (from, to, pair_.m_lines);
+        } catch (const std::exception & e) {
+            pair_.m_error = e.what();
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Writes the fields that differ between two blobs, one JSON object per
+ * line, see [Diff], exiting 0 if there were none, 1 if there were and 2
+ * if the blobs couldn't be compared.
+ *
+ * With --pairs each line of the file given, or stdin given "-", names two
+ * blobs separated by whitespace, each pair being compared in parallel on
+ * as many threads as the machine has unless told otherwise by --threads.
+ * Every line then also names the two files it compares, pairs that
+ * couldn't be compared being reported on stderr
+ */
+int
+main (int argc, char **argv) {
+    size_t threads { 0 };
+    std::string pairs;
+    int arg { 1 };
+
+    for (; arg < argc && std::strncmp (argv[arg], "--", 2) == 0 ; ++arg) {
+        std::string opt { argv[arg] };
+
+        if (opt == "--threads" && arg + 1 < argc) {
+            threads = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--pairs" && arg + 1 < argc) {
+            pairs = argv[++arg];
+        } else {
+            usage (argv[0]);
+            return 2;
+        }
+    }
+
+    if (argc - arg != (pairs.empty() ? 2 : 0)) {
+        usage (argv[0]);
+        return 2;
+    }
+
+    if (pairs.empty()) {
+        Pair pair { argv[arg], argv[arg + 1] };
+        compare (pair, false);
+
+        if (!pair.m_error.empty()) {
+            std::cerr << pair.m_error << std::endl;
+            return 2;
+        }
+
+        std::cout << pair.m_lines;
+
+        return pair.m_differences == 0 ? EXIT_SUCCESS : 1;
+    }
+
+    std::ifstream file;
+
+    if (pairs != "-") {
+        file.open (pairs);
+
+        if (!file) {
+            std::cerr << "Couldn't open " << pairs << std::endl;
+            return 2;
+        }
+    }
+
+    std::istream & in = pairs == "-" ? std::cin : file;
+
+    WorkStealingPool pool (threads == 0 ? std::thread::hardware_concurrency() : threads);
+
+    size_t differences { 0 }, failures { 0 };
+    std::deque<Pair> chunk;
+
+    auto flush = [&]() {
+        for (auto & pair : chunk) {
+            pool.submit ([&pair]() { compare (pair, true); });
+        }
+
+        pool.wait();
+
+        for (const auto & pair : chunk) {
+            if (!pair.m_error.empty()) {
+                std::cerr << pair.m_from << " " << pair.m_to << ": " << pair.m_error << std::endl;
+                ++failures;
+            } else {
+                std::cout << pair.m_lines;
+                differences += pair.m_differences;
+            }
+        }
+
+        chunk.clear();
+    };
+
+    for (std::string line ; std::getline (in, line) ; ) {
+        std::stringstream ss { line };
+        Pair pair;
+
+        if (!(ss >> pair.m_from)) continue;
+
+        if (!(ss >> pair.m_to)) {
+            std::cerr << "Expected two blobs on the line \"" << line << "\"" << std::endl;
+            ++failures;
+            continue;
+        }
+
+        chunk.push_back (std::move (pair));
+
+        if (chunk.size() == CHUNK) flush();
+    }
+
+    flush();
+
+    if (failures) return 2;
+
+    return differences == 0 ? EXIT_SUCCESS : 1;
+}
+
+/******************************************************************************/
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "Diff.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+
+#include "sink/TapeSink.h"
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    using Tape = amqp::internal::tape::Tape;
+
+    std::string
+    diff (const std::string & from_, const std::string & to_) {
+        CordaBytes from (filepath + from_);
+        CordaBytes to (filepath + to_);
+
+        std::string rtn;
+        Diff::lines (from, to, rtn);
+
+        return rtn;
+    }
+
+    /**
+     * { Parsed : { balances : { <currency> : <amount>, ... } } } written
+     * straight onto a tape
+     */
+    Tape
+    balances (const std::map<std::string, int64_t> & balances_) {
+        Tape rtn (nullptr, 0);
+        amqp::internal::sink::TapeSink sink (rtn, true);
+
+        sink.beginObject();
+        sink.key ("Parsed");
+        sink.beginObject();
+        sink.key ("balances");
+        sink.beginMap();
+
+        for (const auto & balance : balances_) {
+            sink.string (balance.first);
+            sink.integer (balance.second);
+        }
+
+        sink.endMap();
+        sink.endObject();
+        sink.endObject();
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Diff, same) { // NOLINT
+    CordaBytes cb (filepath + "__i_LMis_l__");
+
+    const auto from = BlobInspector (cb).tape (true);
+    const auto to = BlobInspector (cb).tape (true);
+
+    Diff diff (from, to);
+
+    EXPECT_TRUE (diff.differences().empty());
+    EXPECT_EQ (1U, diff.skipped());
+
+    EXPECT_EQ ("", ::diff ("_Le_", "_Le_"));
+}
+
+/******************************************************************************/
+
+TEST (Diff, changed) { // NOLINT
+    EXPECT_EQ (
+        "{\"path\":\"a\",\"change\":\"changed\",\"from\":69,\"to\":1}\n",
+        diff ("_i_", "_Oi_"));
+}
+
+/******************************************************************************/
+
+TEST (Diff, lists) { // NOLINT
+    EXPECT_EQ (
+        "{\"path\":\"listy[3]\",\"change\":\"added\",\"to\":\"B\"}\n"
+        "{\"path\":\"listy[4]\",\"change\":\"added\",\"to\":\"A\"}\n",
+        diff ("_Le_", "_Le_2"));
+
+    EXPECT_EQ (
+        "{\"path\":\"listy[3]\",\"change\":\"removed\",\"from\":\"B\"}\n"
+        "{\"path\":\"listy[4]\",\"change\":\"removed\",\"from\":\"A\"}\n",
+        diff ("_Le_2", "_Le_"));
+}
+
+/******************************************************************************/
+
+TEST (Diff, fields) { // NOLINT
+    EXPECT_EQ (
+        "{\"path\":\"a\",\"change\":\"removed\",\"from\":69}\n"
+        "{\"path\":\"x\",\"change\":\"added\",\"to\":[{\"1\":\"two\",\"3\":\"four\",\"5\":\"six\"},{\"7\":\"eight\",\"9\":\"ten\"}]}\n"
+        "{\"path\":\"y\",\"change\":\"added\",\"to\":{\"x\":1000000}}\n"
+        "{\"path\":\"z\",\"change\":\"added\",\"to\":{\"a\":666}}\n",
+        diff ("_i_", "__i_LMis_l__"));
+}
+
+/******************************************************************************/
+
+TEST (Diff, maps) { // NOLINT
+    auto from = balances ({ { "GBP", 10 }, { "USD", 20 }, { "EUR", 5 } });
+    auto to = balances ({ { "GBP", 10 }, { "USD", 25 }, { "CHF", 1 } });
+
+    Diff diff (from, to);
+
+    ASSERT_EQ (3U, diff.differences().size());
+
+    const auto & d = diff.differences();
+
+    EXPECT_EQ (Diff::removed_t, d[0].m_change);
+    EXPECT_EQ ("balances[\"EUR\"]", d[0].m_path);
+    EXPECT_EQ (5, d[0].m_from.integer());
+
+    EXPECT_EQ (Diff::changed_t, d[1].m_change);
+    EXPECT_EQ ("balances[\"USD\"]", d[1].m_path);
+    EXPECT_EQ (20, d[1].m_from.integer());
+    EXPECT_EQ (25, d[1].m_to.integer());
+
+    EXPECT_EQ (Diff::added_t, d[2].m_change);
+    EXPECT_EQ ("balances[\"CHF\"]", d[2].m_path);
+    EXPECT_EQ (from.end(), d[2].m_from);
+}
+
+/******************************************************************************/
+
+TEST (Diff, named) { // NOLINT
+    CordaBytes from (filepath + "_i_");
+    CordaBytes to (filepath + "_Oi_");
+
+    std::string lines;
+    EXPECT_EQ (1U, Diff::lines (from, to, lines, "in/_i_", "out/_Oi_"));
+
+    EXPECT_EQ (
+        "{\"fromFile\":\"in/_i_\",\"toFile\":\"out/_Oi_\","
+        "\"path\":\"a\",\"change\":\"changed\",\"from\":69,\"to\":1}\n",
+        lines);
+}
+
+/******************************************************************************/
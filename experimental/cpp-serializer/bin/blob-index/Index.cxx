@@ -0,0 +1,559 @@
+#include "Index.h"
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "WorkStealingPool.h"
+
+#include "amqp/AMQPSectionId.h"
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    const std::string MAGIC { "CAIX" };
+
+    /**
+     * Bits per value and hashes per lookup, a false positive rate of
+     * about one percent
+     */
+    constexpr size_t BITS_PER_VALUE = 10;
+    constexpr size_t HASHES = 7;
+
+    /**
+     * FNV-1a, the second hash of the pair the probes are made from being
+     * a remix of the first
+     */
+    std::pair<uint64_t, uint64_t>
+    hashes (std::string_view value_) {
+        uint64_t h { 0xcbf29ce484222325ULL };
+
+        for (auto c : value_) {
+            h ^= static_cast<unsigned char> (c);
+            h *= 0x100000001b3ULL;
+        }
+
+        uint64_t g { h ^ (h >> 33) };
+        g *= 0xff51afd7ed558ccdULL;
+        g ^= g >> 33;
+
+        return { h, g | 1 };
+    }
+
+    template<class Fn>
+    void
+    probe (std::string_view value_, size_t bits_, Fn && fn_) {
+        auto [h, g] = hashes (value_);
+
+        for (size_t i { 0 } ; i < HASHES ; ++i) fn_ ((h + i * g) % bits_);
+    }
+
+    std::string
+    join (std::string_view a_, std::string_view b_) {
+        std::string rtn;
+        rtn.reserve (a_.size() + 1 + b_.size());
+        rtn.append (a_).push_back ('\0');
+        return rtn.append (b_);
+    }
+
+    int64_t
+    modified (const struct stat & st_) {
+        return static_cast<int64_t> (st_.st_mtim.tv_sec) * 1000000000 + st_.st_mtim.tv_nsec;
+    }
+
+    /**************************************************************************/
+
+    void
+    put (std::string & out_, uint64_t value_) {
+        while (value_ >= 0x80) {
+            out_.push_back (static_cast<char> (value_ | 0x80));
+            value_ >>= 7;
+        }
+
+        out_.push_back (static_cast<char> (value_));
+    }
+
+    void
+    put (std::string & out_, std::string_view value_) {
+        put (out_, value_.size());
+        out_.append (value_);
+    }
+
+    /**
+     * Reads back what [put] wrote, throwing rather than running off the
+     * end of a truncated or corrupt index
+     */
+    class Input {
+        private :
+            std::string_view m_in;
+
+            [[noreturn]] static void corrupt() {
+                throw std::runtime_error ("Corrupt index");
+            }
+
+        public :
+            explicit Input (std::string_view in_) : m_in (in_) { }
+
+            bool empty() const { return m_in.empty(); }
+
+            uint64_t integer() {
+                uint64_t rtn { 0 };
+
+                for (int shift { 0 } ; ; shift += 7) {
+                    if (m_in.empty() || shift > 63) corrupt();
+
+                    auto c = static_cast<unsigned char> (m_in.front());
+                    m_in.remove_prefix (1);
+
+                    rtn |= static_cast<uint64_t> (c & 0x7f) << shift;
+                    if (!(c & 0x80)) return rtn;
+                }
+            }
+
+            std::string_view string() {
+                auto size = integer();
+                if (size > m_in.size()) corrupt();
+
+                auto rtn = m_in.substr (0, size);
+                m_in.remove_prefix (size);
+                return rtn;
+            }
+
+            uint64_t word() {
+                if (m_in.size() < 8) corrupt();
+
+                uint64_t rtn { 0 };
+                for (int i { 0 } ; i < 8 ; ++i) {
+                    rtn |= static_cast<uint64_t> (static_cast<unsigned char> (m_in[i])) << (8 * i);
+                }
+
+                m_in.remove_prefix (8);
+                return rtn;
+            }
+
+            /**
+             * A count of things each at least [least_] bytes long, which
+             * can't be more than what's left could hold
+             */
+            uint64_t count (size_t least_ = 1) {
+                auto rtn = integer();
+                if (rtn > m_in.size() / least_) corrupt();
+                return rtn;
+            }
+    };
+
+    /**************************************************************************/
+
+    /**
+     * Collects every scalar the blob holds along with the path it's under
+     */
+    class Collector : public amqp::reader::ISink {
+        private :
+            Index::Contents & m_contents;
+
+            std::string m_path;
+            std::string m_key;
+
+            /**
+             * How long the path was before each composite, list or map,
+             * and whether it was a composite, whose fields extend it
+             */
+            std::vector<std::pair<size_t, bool>> m_levels;
+
+            std::string path() const {
+                if (m_levels.empty() || !m_levels.back().second) return m_path;
+                return m_path.empty() ? m_key : m_path + "." + m_key;
+            }
+
+            void open (bool object_) {
+                auto p = path();
+
+                m_levels.emplace_back (m_path.size(), object_);
+                m_path = std::move (p);
+            }
+
+            void close() {
+                m_path.resize (m_levels.back().first);
+                m_levels.pop_back();
+            }
+
+            void value (std::string_view value_) {
+                m_contents.m_fields.insert (join (path(), value_));
+                m_contents.m_values.emplace (value_);
+            }
+
+        public :
+            explicit Collector (Index::Contents & contents_) : m_contents (contents_) { }
+
+            void beginObject() override { open (true); }
+            void endObject() override { close(); }
+            void beginList() override { open (false); }
+            void endList() override { close(); }
+            void beginMap() override { open (false); }
+            void endMap() override { close(); }
+
+            void key (std::string_view key_) override { m_key = key_; }
+
+            void null() override { }
+            void binary (std::string_view) override { }
+
+            void boolean (bool v_) override { value (v_ ? "true" : "false"); }
+
+            void integer (int64_t v_) override { value (std::to_string (v_)); }
+
+            void real (double v_) override {
+                char buffer[32];
+                auto [end, ec] = std::to_chars (buffer, buffer + sizeof (buffer), v_);
+                value (std::string_view (buffer, static_cast<size_t> (end - buffer)));
+            }
+
+            void string (std::string_view v_) override { value (v_); }
+            void symbol (std::string_view v_) override { value (v_); }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * Index::Contents
+ *
+ ******************************************************************************/
+
+Index::Contents::Contents (CordaBytes & cb_) {
+    if (cb_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    BlobInspector inspector (cb_);
+    m_type = inspector.descriptor();
+
+    Collector collector (*this);
+    inspector.writeFields (collector);
+}
+
+/******************************************************************************/
+
+bool
+Index::Contents::holds (const Term & term_) const {
+    if (term_.m_path.empty()) return m_values.count (term_.m_value) != 0;
+    return m_fields.count (join (term_.m_path, term_.m_value)) != 0;
+}
+
+/******************************************************************************
+ *
+ * Index
+ *
+ ******************************************************************************/
+
+Index
+Index::build (
+    const std::vector<std::string> & files_,
+    std::ostream & errors_,
+    size_t threads_
+) {
+    std::vector<std::unique_ptr<Contents>> contents (files_.size());
+
+    Index rtn;
+    rtn.m_files.resize (files_.size());
+
+    {
+        std::mutex lock;
+        WorkStealingPool pool (threads_ == 0 ? std::thread::hardware_concurrency() : threads_);
+
+        for (size_t i { 0 } ; i < files_.size() ; ++i) {
+            pool.submit ([&, i]() {
+                auto & file = rtn.m_files[i];
+                file.m_name = files_[i];
+
+                struct stat st { };
+                if (::stat (file.m_name.c_str(), &st) == 0) {
+                    file.m_size = static_cast<uint64_t> (st.st_size);
+                    file.m_modified = modified (st);
+                }
+
+                try {
+                    CordaBytes cb (file.m_name);
+                    contents[i] = std::make_unique<Contents> (cb);
+                    file.m_type = contents[i]->m_type;
+                } catch (const std::exception & e) {
+                    std::lock_guard<std::mutex> guard (lock);
+                    errors_ << file.m_name << ": " << e.what() << '\n';
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    // merged in order so every posting list comes out sorted
+    rtn.m_blooms.resize (files_.size());
+
+    for (uint32_t i { 0 } ; i < contents.size() ; ++i) {
+        if (!contents[i]) continue;
+
+        const auto & blob = *contents[i];
+
+        for (const auto & field : blob.m_fields) {
+            rtn.m_postings[join (field, blob.m_type)].push_back (i);
+        }
+
+        auto & bloom = rtn.m_blooms[i];
+        bloom.assign ((blob.m_values.size() * BITS_PER_VALUE + 63) / 64 + 1, 0);
+
+        for (const auto & value : blob.m_values) {
+            probe (value, bloom.size() * 64, [&bloom](size_t bit_) {
+                bloom[bit_ / 64] |= 1ULL << (bit_ % 64);
+            });
+        }
+
+        contents[i].reset();
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Index::save (const std::string & path_) const {
+    std::string out { MAGIC };
+    put (out, VERSION);
+
+    put (out, m_files.size());
+    for (const auto & file : m_files) {
+        put (out, file.m_name);
+        put (out, file.m_type);
+        put (out, file.m_size);
+        put (out, static_cast<uint64_t> (file.m_modified));
+    }
+
+    // each posting list as the differences between its blobs
+    put (out, m_postings.size());
+    for (const auto & [key, blobs] : m_postings) {
+        put (out, key);
+        put (out, blobs.size());
+
+        uint32_t last { 0 };
+        for (auto blob : blobs) {
+            put (out, blob - last);
+            last = blob;
+        }
+    }
+
+    for (const auto & bloom : m_blooms) {
+        put (out, bloom.size());
+        for (auto word : bloom) {
+            for (int i { 0 } ; i < 8 ; ++i) out.push_back (static_cast<char> (word >> (8 * i)));
+        }
+    }
+
+    std::ofstream file (path_, std::ios::binary | std::ios::trunc);
+    file.write (out.data(), static_cast<std::streamsize> (out.size()));
+
+    if (!file) throw std::runtime_error ("Failed to write " + path_);
+}
+
+/******************************************************************************/
+
+Index
+Index::load (const std::string & path_) {
+    std::ifstream file (path_, std::ios::binary);
+    if (!file) throw std::runtime_error ("Failed to read " + path_);
+
+    const std::string contents {
+        std::istreambuf_iterator<char> (file),
+        std::istreambuf_iterator<char>() };
+
+    if (contents.compare (0, MAGIC.size(), MAGIC) != 0) {
+        throw std::runtime_error (path_ + " isn't an index");
+    }
+
+    Input in (std::string_view (contents).substr (MAGIC.size()));
+
+    if (in.integer() != VERSION) {
+        throw std::runtime_error (path_ + " is an index of another version");
+    }
+
+    Index rtn;
+
+    rtn.m_files.resize (in.count (4));
+    for (auto & file : rtn.m_files) {
+        file.m_name = in.string();
+        file.m_type = in.string();
+        file.m_size = in.integer();
+        file.m_modified = static_cast<int64_t> (in.integer());
+    }
+
+    for (auto keys = in.count (2) ; keys ; --keys) {
+        auto & blobs = rtn.m_postings[std::string (in.string())];
+        blobs.resize (in.count());
+
+        uint64_t blob { 0 };
+        for (auto & b : blobs) {
+            blob += in.integer();
+            if (blob >= rtn.m_files.size()) throw std::runtime_error ("Corrupt index");
+            b = static_cast<uint32_t> (blob);
+        }
+    }
+
+    rtn.m_blooms.resize (rtn.m_files.size());
+    for (auto & bloom : rtn.m_blooms) {
+        bloom.resize (in.count (8));
+
+        for (auto & word : bloom) word = in.word();
+    }
+
+    if (!in.empty()) throw std::runtime_error ("Corrupt index");
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+bool
+Index::stale (uint32_t blob_) const {
+    const auto & file = m_files[blob_];
+
+    struct stat st { };
+    if (::stat (file.m_name.c_str(), &st) != 0) return false;
+
+    return static_cast<uint64_t> (st.st_size) != file.m_size || modified (st) != file.m_modified;
+}
+
+/******************************************************************************/
+
+std::vector<uint32_t>
+Index::lookup (std::string_view path_, std::string_view value_, std::string_view type_) const {
+    auto prefix = join (path_, value_);
+
+    if (!type_.empty()) {
+        auto it = m_postings.find (join (prefix, type_));
+        return it == m_postings.end() ? std::vector<uint32_t> { } : it->second;
+    }
+
+    prefix.push_back ('\0');
+
+    std::vector<uint32_t> rtn;
+
+    for (auto it = m_postings.lower_bound (prefix) ;
+        it != m_postings.end() && it->first.compare (0, prefix.size(), prefix) == 0 ;
+        ++it)
+    {
+        std::vector<uint32_t> merged;
+        std::set_union (rtn.begin(), rtn.end(), it->second.begin(), it->second.end(), std::back_inserter (merged));
+        rtn.swap (merged);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::vector<uint32_t>
+Index::mentions (std::string_view value_) const {
+    std::vector<uint32_t> rtn;
+
+    for (uint32_t i { 0 } ; i < m_blooms.size() ; ++i) {
+        const auto & bloom = m_blooms[i];
+        if (bloom.empty()) continue;
+
+        bool maybe { true };
+        probe (value_, bloom.size() * 64, [&bloom, &maybe](size_t bit_) {
+            maybe = maybe && (bloom[bit_ / 64] & (1ULL << (bit_ % 64)));
+        });
+
+        if (maybe) rtn.push_back (i);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::vector<uint32_t>
+Index::query (
+    const std::vector<Term> & terms_,
+    std::string_view type_,
+    size_t * decoded_
+) const {
+    std::vector<uint32_t> candidates;
+    std::vector<bool> changed (m_files.size());
+
+    for (uint32_t i { 0 } ; i < m_files.size() ; ++i) {
+        changed[i] = stale (i);
+        if (terms_.empty() && (type_.empty() || m_files[i].m_type == type_)) candidates.push_back (i);
+    }
+
+    bool exact { true };
+
+    for (size_t t { 0 } ; t < terms_.size() ; ++t) {
+        const auto & term = terms_[t];
+
+        auto blobs = term.m_path.empty()
+            ? mentions (term.m_value)
+            : lookup (term.m_path, term.m_value, type_);
+
+        exact = exact && !term.m_path.empty();
+
+        if (t == 0) {
+            candidates.swap (blobs);
+        } else {
+            std::vector<uint32_t> both;
+            std::set_intersection (
+                candidates.begin(), candidates.end(), blobs.begin(), blobs.end(), std::back_inserter (both));
+            candidates.swap (both);
+        }
+    }
+
+    // a file that's changed might hold anything now
+    std::vector<uint32_t> all;
+    for (uint32_t i { 0 } ; i < m_files.size() ; ++i) {
+        if (changed[i] || std::binary_search (candidates.begin(), candidates.end(), i)) all.push_back (i);
+    }
+
+    std::vector<uint32_t> rtn;
+    size_t decoded { 0 };
+
+    for (auto blob : all) {
+        if (exact && !changed[blob]) {
+            if (type_.empty() || m_files[blob].m_type == type_) rtn.push_back (blob);
+            continue;
+        }
+
+        ++decoded;
+
+        try {
+            CordaBytes cb (m_files[blob].m_name);
+            Contents contents (cb);
+
+            if (!type_.empty() && contents.m_type != type_) continue;
+
+            if (std::all_of (terms_.begin(), terms_.end(), [&contents](const Term & term_) {
+                    return contents.holds (term_);
+                }))
+            {
+                rtn.push_back (blob);
+            }
+        } catch (const std::exception &) {
+            // a blob that can't be decoded holds nothing
+        }
+    }
+
+    if (decoded_) *decoded_ = decoded;
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,142 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <unordered_set>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+/******************************************************************************/
+
+/**
+ * An inverted index over a corpus of blobs, built in a single pass, from
+ * each (field path, value, type) any blob holds to the blobs holding it,
+ * alongside a Bloom filter per blob of every value it holds wherever it
+ * holds it.
+ *
+ * Paths are dotted, as [BlobInspector::project] takes them, from the
+ * blob's outermost type, whose descriptor is the type. Every element of
+ * a list shares the list's path, as do the keys and values of a map.
+ * Values are indexed by their text, integers in decimal, reals as the
+ * shortest decimal that reads back the same, enums by constant and
+ * booleans as true or false. Nulls and binaries aren't indexed.
+ *
+ * A query only decodes the blobs the index names as candidates, those
+ * holding every field asked for and, for values asked for anywhere, whose
+ * Bloom filter says they might. The latter are decoded to rule out false
+ * positives, as is any blob whose file has changed since it was indexed,
+ * which is always a candidate.
+ */
+class Index {
+    public :
+        struct File {
+            std::string m_name;
+
+            /**
+             * The descriptor of the blob's outermost type
+             */
+            std::string m_type;
+
+            uint64_t m_size;
+
+            /**
+             * Nanoseconds since the epoch
+             */
+            int64_t m_modified;
+        };
+
+        /**
+         * A field that must hold a value, anywhere in the blob when the
+         * path's empty
+         */
+        struct Term {
+            std::string m_path;
+            std::string m_value;
+        };
+
+        /**
+         * Everything indexable a single blob holds
+         */
+        struct Contents {
+            std::string m_type;
+
+            /**
+             * Path and value, NUL separated
+             */
+            std::unordered_set<std::string> m_fields;
+            std::unordered_set<std::string> m_values;
+
+            explicit Contents (CordaBytes &);
+
+            bool holds (const Term &) const;
+        };
+
+    private :
+        std::vector<File> m_files;
+
+        /**
+         * Keyed by path, value and type, NUL separated, so everything of
+         * one path and value sorts together whatever its type
+         */
+        std::map<std::string, std::vector<uint32_t>, std::less<>> m_postings;
+
+        std::vector<std::vector<uint64_t>> m_blooms;
+
+        bool stale (uint32_t) const;
+
+    public :
+        static constexpr uint32_t VERSION = 1;
+
+        /**
+         * Index [files_] on [threads_] workers, as many as the machine has
+         * when 0. Files that can't be decoded are reported to [errors_]
+         * and hold nothing
+         */
+        static Index build (
+            const std::vector<std::string> & files_,
+            std::ostream & errors_,
+            size_t threads_ = 0);
+
+        static Index load (const std::string &);
+
+        void save (const std::string &) const;
+
+        const std::vector<File> & files() const { return m_files; }
+
+        size_t keys() const { return m_postings.size(); }
+
+        /**
+         * The blobs, as indices into [files], whose [path_] holds
+         * [value_], only those of [type_] unless that's empty
+         */
+        std::vector<uint32_t> lookup (
+            std::string_view path_,
+            std::string_view value_,
+            std::string_view type_ = { }) const;
+
+        /**
+         * The blobs that might hold [value_] somewhere, as far as their
+         * Bloom filters can say
+         */
+        std::vector<uint32_t> mentions (std::string_view value_) const;
+
+        /**
+         * The blobs holding every one of [terms_], restricted to [type_]
+         * unless that's empty, with how many had to be decoded to be
+         * sure left in [decoded_]
+         */
+        std::vector<uint32_t> query (
+            const std::vector<Term> & terms_,
+            std::string_view type_ = { },
+            size_t * decoded_ = nullptr) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Batch.h"
+#include "Index.h"
+
+/******************************************************************************/
+
+namespace {
+
+    void
+    usage (const char * name_) {
+        std::cerr << "usage: " << name_ << " [--threads n] <dir|glob|-> <index>" << std::endl
+            << "       " << name_
+            << " --query <index> [--type descriptor] [--files]"
+            << " [--field path value]... [--mentions value]..." << std::endl;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Given the blobs, named as blob-inspector --batch names them, and a file
+ * writes an index of them to it, see [Index]. Files that couldn't be
+ * indexed are reported on stderr.
+ *
+ * With --query the blobs of the index given holding every --field path
+ * value and every value given by --mentions, anywhere, are written as
+ * blob-inspector --batch writes them, or with --files just their names.
+ * --type keeps only blobs of that descriptor. How many blobs had to be
+ * decoded to answer is reported on stderr
+ */
+int
+main (int argc, char **argv) {
+    size_t threads { 0 };
+    std::string query;
+    bool files { false };
+    std::string type;
+    std::vector<Index::Term> terms;
+    int arg { 1 };
+
+    for (; arg < argc && std::strncmp (argv[arg], "--", 2) == 0 ; ++arg) {
+        std::string opt { argv[arg] };
+
+        if (opt == "--threads" && arg + 1 < argc) {
+            threads = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--query" && arg + 1 < argc) {
+            query = argv[++arg];
+        } else if (opt == "--files") {
+            files = true;
+        } else if (opt == "--type" && arg + 1 < argc) {
+            type = argv[++arg];
+        } else if (opt == "--field" && arg + 2 < argc) {
+            terms.push_back ({ argv[arg + 1], argv[arg + 2] });
+            arg += 2;
+        } else if (opt == "--mentions" && arg + 1 < argc) {
+            terms.push_back ({ std::string(), argv[++arg] });
+        } else {
+            usage (argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - arg != (query.empty() ? 2 : 0)) {
+        usage (argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        if (query.empty()) {
+            auto blobs = Batch::expand (argv[arg], std::cin);
+
+            if (blobs.empty()) {
+                std::cerr << "No blobs found in " << argv[arg] << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            auto index = Index::build (blobs, std::cerr, threads);
+            index.save (argv[arg + 1]);
+
+            std::cerr << index.files().size() << " blobs, " << index.keys() << " keys" << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        auto index = Index::load (query);
+
+        size_t decoded { 0 };
+        auto matches = index.query (terms, type, &decoded);
+
+        std::string line;
+
+        for (auto blob : matches) {
+            const auto & name = index.files()[blob].m_name;
+
+            if (files) {
+                std::cout << name << '\n';
+            } else {
+                Batch::render (name, line);
+                std::cout << line << '\n';
+            }
+        }
+
+        std::cerr << matches.size() << " of " << index.files().size() << " blobs match, "
+            << decoded << " decoded" << std::endl;
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "Batch.h"
+#include "Index.h"
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * The names of [blobs_], sans directory
+     */
+    std::vector<std::string>
+    names (const Index & index_, const std::vector<uint32_t> & blobs_) {
+        std::vector<std::string> rtn;
+
+        for (auto blob : blobs_) {
+            rtn.push_back (std::filesystem::path (index_.files()[blob].m_name).filename());
+        }
+
+        std::sort (rtn.begin(), rtn.end());
+        return rtn;
+    }
+
+    Index
+    testFiles() {
+        std::stringstream none, errors;
+        auto index = Index::build (Batch::expand (filepath, none), errors, 2);
+
+        EXPECT_EQ ("", errors.str());
+        return index;
+    }
+
+    using Names = std::vector<std::string>;
+
+}
+
+/******************************************************************************/
+
+TEST (BlobIndex, lookup) { // NOLINT
+    auto index = testFiles();
+
+    EXPECT_EQ (Names { "_i_" }, names (index, index.lookup ("a", "69")));
+    EXPECT_EQ (Names { "_i_is__" }, names (index, index.lookup ("b.b", "three")));
+    EXPECT_EQ (Names { "__i_LMis_l__" }, names (index, index.lookup ("z.a", "666")));
+    EXPECT_EQ (Names { "_L_i__" }, names (index, index.lookup ("listy.a", "2")));
+    EXPECT_EQ (Names { "_e_" }, names (index, index.lookup ("e", "A")));
+    EXPECT_TRUE (index.lookup ("a", "70").empty());
+    EXPECT_TRUE (index.lookup ("b", "three").empty());
+
+    const auto & type = index.files()[index.lookup ("a", "69")[0]].m_type;
+    EXPECT_FALSE (type.empty());
+    EXPECT_EQ (1U, index.lookup ("a", "69", type).size());
+    EXPECT_TRUE (index.lookup ("a", "69", "net.corda:nope").empty());
+}
+
+/******************************************************************************/
+
+/**
+ * A Bloom filter never misses what a blob holds
+ */
+TEST (BlobIndex, mentions) { // NOLINT
+    auto index = testFiles();
+
+    auto three = names (index, index.mentions ("three"));
+    EXPECT_NE (three.end(), std::find (three.begin(), three.end(), "_i_is__"));
+
+    size_t decoded { 0 };
+    EXPECT_EQ (
+        (Names { "_MiLs_", "_Mi_is__", "_i_is__" }),
+        names (index, index.query ({ { "", "three" } }, { }, &decoded)));
+    EXPECT_EQ (three.size(), decoded);
+
+    EXPECT_TRUE (index.query ({ { "", "seventeen" } }).empty());
+}
+
+/******************************************************************************/
+
+/**
+ * Terms are all needed, and those on a field are answered from the
+ * index alone
+ */
+TEST (BlobIndex, query) { // NOLINT
+    auto index = testFiles();
+
+    size_t decoded { 1 };
+    EXPECT_EQ (Names { "_i_is__" }, names (index, index.query ({ { "a", "1" }, { "b.a", "2" } }, { }, &decoded)));
+    EXPECT_EQ (0U, decoded);
+
+    EXPECT_TRUE (index.query ({ { "a", "1" }, { "b.a", "3" } }).empty());
+    EXPECT_EQ (Names { "_i_is__" }, names (index, index.query ({ { "b.a", "2" }, { "", "three" } })));
+
+    // a map's keys and values are both found under its path
+    EXPECT_EQ (
+        (Names { "_MiLs_", "_Mi_is__", "_i_is__" }),
+        names (index, index.query ({ { "a", "1" }, { "", "three" } })));
+
+    EXPECT_EQ (index.files().size(), index.query ({ }).size());
+}
+
+/******************************************************************************/
+
+TEST (BlobIndex, save) { // NOLINT
+    const std::string path { "blob-index-test.index" };
+
+    auto index = testFiles();
+    index.save (path);
+
+    auto loaded = Index::load (path);
+
+    ASSERT_EQ (index.files().size(), loaded.files().size());
+    EXPECT_EQ (index.keys(), loaded.keys());
+    EXPECT_EQ (index.files()[3].m_type, loaded.files()[3].m_type);
+    EXPECT_EQ (names (index, index.lookup ("listy.a", "3")), names (loaded, loaded.lookup ("listy.a", "3")));
+    EXPECT_EQ (index.mentions ("three"), loaded.mentions ("three"));
+
+    // cut short anywhere it's no longer an index
+    std::string contents;
+    {
+        std::ifstream in (path, std::ios::binary);
+        contents.assign (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char>());
+    }
+
+    for (auto size : { contents.size() - 1, contents.size() / 2, size_t { 5 } }) {
+        {
+            std::ofstream out (path, std::ios::binary | std::ios::trunc);
+            out.write (contents.data(), static_cast<std::streamsize> (size));
+        }
+
+        EXPECT_THROW (Index::load (path), std::runtime_error) << size;
+    }
+
+    std::filesystem::remove (path);
+    EXPECT_THROW (Index::load (path), std::runtime_error);
+}
+
+/******************************************************************************/
+
+/**
+ * A blob changed since it was indexed is decoded to find out what it
+ * holds now
+ */
+TEST (BlobIndex, stale) { // NOLINT
+    const std::string path { "blob-index-test.blob" };
+    std::filesystem::copy_file (filepath + "_i_", path, std::filesystem::copy_options::overwrite_existing);
+
+    std::stringstream errors;
+    auto index = Index::build ({ path }, errors, 1);
+
+    size_t decoded { 1 };
+    EXPECT_EQ (1U, index.query ({ { "a", "69" } }, { }, &decoded).size());
+    EXPECT_EQ (0U, decoded);
+
+    std::filesystem::copy_file (
+            filepath + "_i_is__", path, std::filesystem::copy_options::overwrite_existing);
+
+    EXPECT_TRUE (index.query ({ { "a", "69" } }, { }, &decoded).empty());
+    EXPECT_EQ (1U, decoded);
+    EXPECT_EQ (1U, index.query ({ { "b.b", "three" } }, { }, &decoded).size());
+
+    std::filesystem::remove (path);
+}
+
+/******************************************************************************/
@@ -0,0 +1,456 @@
+#include "Aggregate.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * The tree's fields, one per step of [path_]
+     */
+    template<class Field>
+    Field &
+    insert (Field & root_, const std::string & path_) {
+        auto * at = &root_;
+
+        size_t start { 0 };
+
+        for (;;) {
+            auto dot = path_.find ('.', start);
+            auto name = path_.substr (start, dot == std::string::npos ? std::string::npos : dot - start);
+
+            if (name.empty()) throw std::runtime_error ("Bad path \"" + path_ + "\"");
+
+            at = &at->m_fields[name];
+
+            if (dot == std::string::npos) return *at;
+
+            start = dot + 1;
+        }
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Aggregate::Value
+ *
+ ******************************************************************************/
+
+bool
+Aggregate::Value::operator< (const Value & rhs_) const {
+    if (m_type != rhs_.m_type) return m_type < rhs_.m_type;
+
+    switch (m_type) {
+        case bool_t : return m_bool < rhs_.m_bool;
+        case int_t : return m_int < rhs_.m_int;
+        case real_t : return m_real < rhs_.m_real;
+        case string_t : return m_string < rhs_.m_string;
+        default : return false;
+    }
+}
+
+/******************************************************************************
+ *
+ * Aggregate::Sum
+ *
+ ******************************************************************************/
+
+void
+Aggregate::Sum::add (int64_t v_) {
+    int64_t sum;
+
+    if (!m_isReal && !__builtin_add_overflow (m_int, v_, &sum)) {
+        m_int = sum;
+        return;
+    }
+
+    if (!m_isReal) {
+        m_isReal = true;
+        m_real = static_cast<double> (m_int);
+    }
+
+    m_real += static_cast<double> (v_);
+}
+
+/******************************************************************************/
+
+void
+Aggregate::Sum::add (double v_) {
+    if (!m_isReal) {
+        m_isReal = true;
+        m_real = static_cast<double> (m_int);
+    }
+
+    m_real += v_;
+}
+
+/******************************************************************************/
+
+void
+Aggregate::Sum::add (const Sum & sum_) {
+    if (sum_.m_isReal) {
+        add (sum_.m_real);
+    } else {
+        add (sum_.m_int);
+    }
+}
+
+/******************************************************************************
+ *
+ * Aggregate::Collector
+ *
+ ******************************************************************************/
+
+/**
+ * Follows the projection down the tree of fields as Filter's evaluation
+ * does, noting the values it's after as they're reached
+ */
+class Aggregate::Collector : public amqp::reader::ISink {
+    private :
+        struct Level {
+            const Field * m_field;
+            bool m_list;
+        };
+
+        std::vector<Level> m_levels;
+        const Field * m_next;
+
+        std::vector<Value> m_group;
+        std::vector<bool> m_grouped;
+        std::vector<Sum> m_sums;
+
+        const Field * field() const {
+            return !m_levels.empty() && m_levels.back().m_list ? m_levels.back().m_field : m_next;
+        }
+
+        void open (bool list_) {
+            m_levels.push_back ({ field(), list_ });
+        }
+
+        void close() {
+            m_levels.pop_back();
+            m_next = nullptr;
+        }
+
+        void value (const Value &);
+
+    public :
+        explicit Collector (const Aggregate & aggregate_)
+            : m_next (&aggregate_.m_root)
+            , m_group (aggregate_.m_groupBy.size())
+            , m_grouped (aggregate_.m_groupBy.size(), false)
+            , m_sums (aggregate_.m_sums.size())
+        { }
+
+        /**
+         * Add what's been seen into [table_]
+         */
+        void into (Table & table_);
+
+        void beginObject() override { open (false); }
+        void endObject() override { close(); }
+        void beginList() override { open (true); }
+        void endList() override { close(); }
+
+        // the tree of fields never runs through a map
+        void beginMap() override { m_next = nullptr; open (false); }
+        void endMap() override { close(); }
+
+        void key (std::string_view key_) override {
+            const auto * parent = m_levels.empty() ? nullptr : m_levels.back().m_field;
+
+            if (!parent) {
+                m_next = nullptr;
+                return;
+            }
+
+            auto it = parent->m_fields.find (key_);
+            m_next = it == parent->m_fields.end() ? nullptr : &it->second;
+        }
+
+        void null() override {
+            value ({ Value::null_t });
+        }
+
+        void boolean (bool v_) override {
+            Value v { Value::bool_t };
+            v.m_bool = v_;
+            value (v);
+        }
+
+        void integer (int64_t v_) override {
+            Value v { Value::int_t };
+            v.m_int = v_;
+            value (v);
+        }
+
+        void real (double v_) override {
+            Value v { Value::real_t };
+            v.m_real = v_;
+            value (v);
+        }
+
+        void string (std::string_view v_) override {
+            Value v { Value::string_t };
+            v.m_string = v_;
+            value (v);
+        }
+
+        void symbol (std::string_view v_) override {
+            string (v_);
+        }
+
+        // bytes are neither grouped by nor summed
+        void binary (std::string_view) override { }
+};
+
+/******************************************************************************/
+
+void
+Aggregate::Collector::value (const Value & value_) {
+    const auto * at = field();
+
+    if (!at) return;
+
+    for (auto group : at->m_groups) {
+        if (m_grouped[group]) continue;
+
+        m_group[group] = value_;
+        m_grouped[group] = true;
+    }
+
+    for (auto sum : at->m_sums) {
+        if (value_.m_type == Value::int_t) {
+            m_sums[sum].add (value_.m_int);
+        } else if (value_.m_type == Value::real_t) {
+            m_sums[sum].add (value_.m_real);
+        }
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * The key is each value's type followed by its bytes, strings by their
+ * length first, so no two groups' keys are the same
+ */
+void
+Aggregate::Collector::into (Table & table_) {
+    thread_local std::string key;
+
+    key.clear();
+
+    for (const auto & value : m_group) {
+        key.push_back (static_cast<char> (value.m_type));
+
+        switch (value.m_type) {
+            case Value::bool_t :
+                key.push_back (value.m_bool ? 1 : 0);
+                break;
+            case Value::int_t :
+                key.append (reinterpret_cast<const char *> (&value.m_int), sizeof (value.m_int));
+                break;
+            case Value::real_t :
+                key.append (reinterpret_cast<const char *> (&value.m_real), sizeof (value.m_real));
+                break;
+            case Value::string_t : {
+                const auto size = value.m_string.size();
+                key.append (reinterpret_cast<const char *> (&size), sizeof (size));
+                key.append (value.m_string);
+                break;
+            }
+            default :
+                break;
+        }
+    }
+
+    auto it = table_.find (key);
+
+    if (it == table_.end()) {
+        it = table_.emplace (key, Totals { }).first;
+        it->second.m_group = std::move (m_group);
+        it->second.m_sums.resize (m_sums.size());
+    }
+
+    auto & totals = it->second;
+
+    ++totals.m_count;
+
+    for (size_t i { 0 } ; i < m_sums.size() ; ++i) {
+        totals.m_sums[i].add (m_sums[i]);
+    }
+}
+
+/******************************************************************************
+ *
+ * Aggregate
+ *
+ ******************************************************************************/
+
+std::atomic<size_t> Aggregate::s_ids { 1 };
+
+/******************************************************************************/
+
+Aggregate::Aggregate (
+    std::vector<std::string> groupBy_,
+    std::vector<std::string> sums_,
+    bool count_
+) : m_groupBy (std::move (groupBy_))
+  , m_sums (std::move (sums_))
+  , m_count (count_)
+  , m_id (s_ids++)
+{
+    if (m_sums.empty() && !m_count) {
+        throw std::runtime_error ("Nothing to aggregate, give fields to sum or count");
+    }
+
+    for (size_t i { 0 } ; i < m_groupBy.size() ; ++i) {
+        insert (m_root, m_groupBy[i]).m_groups.push_back (i);
+        m_paths.push_back (m_groupBy[i]);
+    }
+
+    for (size_t i { 0 } ; i < m_sums.size() ; ++i) {
+        insert (m_root, m_sums[i]).m_sums.push_back (i);
+
+        if (std::find (m_paths.begin(), m_paths.end(), m_sums[i]) == m_paths.end()) {
+            m_paths.push_back (m_sums[i]);
+        }
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Each thread finds its table once, the first time it adds to us
+ */
+Aggregate::Table &
+Aggregate::partial() {
+    thread_local size_t t_id { 0 };
+    thread_local Table * t_table { nullptr };
+
+    if (t_id != m_id) {
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        m_partials.push_back (std::make_unique<Table>());
+        t_table = m_partials.back().get();
+        t_id = m_id;
+    }
+
+    return *t_table;
+}
+
+/******************************************************************************/
+
+void
+Aggregate::add (const std::function<void (amqp::reader::ISink &)> & decode_) {
+    Collector collector (*this);
+
+    decode_ (collector);
+
+    collector.into (partial());
+}
+
+/******************************************************************************/
+
+const std::vector<std::string> *
+Aggregate::fields (std::string_view descriptor_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_fields.find (descriptor_);
+    return it == m_fields.end() ? nullptr : &it->second;
+}
+
+/******************************************************************************/
+
+const std::vector<std::string> &
+Aggregate::fields (const std::string & descriptor_, std::vector<std::string> fields_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_fields.emplace (descriptor_, std::move (fields_)).first->second;
+}
+
+/******************************************************************************/
+
+std::vector<Aggregate::Totals>
+Aggregate::totals() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    Table merged;
+
+    for (const auto & partial : m_partials) {
+        for (const auto & group : *partial) {
+            auto it = merged.find (group.first);
+
+            if (it == merged.end()) {
+                merged.emplace (group);
+                continue;
+            }
+
+            it->second.m_count += group.second.m_count;
+
+            for (size_t i { 0 } ; i < group.second.m_sums.size() ; ++i) {
+                it->second.m_sums[i].add (group.second.m_sums[i]);
+            }
+        }
+    }
+
+    std::vector<Totals> rtn;
+    rtn.reserve (merged.size());
+
+    for (auto & group : merged) rtn.push_back (std::move (group.second));
+
+    std::sort (rtn.begin(), rtn.end(), [](const Totals & lhs_, const Totals & rhs_) {
+        return std::lexicographical_compare (
+                lhs_.m_group.begin(), lhs_.m_group.end(),
+                rhs_.m_group.begin(), rhs_.m_group.end());
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Aggregate::write (const Totals & totals_, amqp::reader::ISink & sink_) const {
+    sink_.beginObject();
+
+    for (size_t i { 0 } ; i < m_groupBy.size() ; ++i) {
+        sink_.key (m_groupBy[i]);
+
+        const auto & value = totals_.m_group[i];
+
+        switch (value.m_type) {
+            case Value::bool_t : sink_.boolean (value.m_bool); break;
+            case Value::int_t : sink_.integer (value.m_int); break;
+            case Value::real_t : sink_.real (value.m_real); break;
+            case Value::string_t : sink_.string (value.m_string); break;
+            default : sink_.null(); break;
+        }
+    }
+
+    if (m_count) {
+        sink_.key ("count");
+        sink_.integer (static_cast<int64_t> (totals_.m_count));
+    }
+
+    for (size_t i { 0 } ; i < m_sums.size() ; ++i) {
+        sink_.key (m_sums[i]);
+
+        const auto & sum = totals_.m_sums[i];
+
+        if (sum.m_isReal) {
+            sink_.real (sum.m_real);
+        } else {
+            sink_.integer (sum.m_int);
+        }
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
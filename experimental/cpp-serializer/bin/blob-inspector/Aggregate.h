@@ -0,0 +1,156 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Totals over a batch of blobs, grouped by the values of some of their
+ * fields, for example
+ *
+ *      --group-by issuer --sum amount.quantity --count
+ *
+ * Fields are dotted paths from the blob's outermost type, as projected.
+ * Only they are decoded, see [Projection], their values going straight
+ * from the decode into the totals without anything being rendered.
+ *
+ * A blob's group is the value of each of its group by fields, null when
+ * it hasn't got one or the field isn't a scalar, the first element's
+ * being taken for a path through a list. Fields summed are summed across
+ * every element of such a list, integers staying integers until a real is
+ * added or they'd overflow. Anything else summed is ignored.
+ *
+ * Each thread adds to totals of its own, without locking, and those are
+ * only merged once the batch is done.
+ */
+class Aggregate {
+    public :
+        struct Value {
+            enum Type : uint8_t { null_t, bool_t, int_t, real_t, string_t } m_type { null_t };
+
+            bool m_bool { false };
+            int64_t m_int { 0 };
+            double m_real { 0 };
+            std::string m_string;
+
+            bool operator< (const Value &) const;
+        };
+
+        struct Sum {
+            int64_t m_int { 0 };
+            double m_real { 0 };
+            bool m_isReal { false };
+
+            void add (int64_t);
+            void add (double);
+            void add (const Sum &);
+        };
+
+        struct Totals {
+            std::vector<Value> m_group;
+            uint64_t m_count { 0 };
+            std::vector<Sum> m_sums;
+        };
+
+    private :
+        class Collector;
+
+        /**
+         * The paths as a tree of field names, each naming the group by
+         * fields and sums it ends at
+         */
+        struct Field {
+            std::map<std::string, Field, std::less<>> m_fields;
+            std::vector<size_t> m_groups;
+            std::vector<size_t> m_sums;
+        };
+
+        /**
+         * Keyed on an encoding of each group's values
+         */
+        using Table = std::unordered_map<std::string, Totals>;
+
+        static std::atomic<size_t> s_ids;
+
+        std::vector<std::string> m_groupBy;
+        std::vector<std::string> m_sums;
+        bool m_count;
+
+        std::vector<std::string> m_paths;
+        Field m_root;
+
+        /**
+         * Tells this apart from any aggregate a thread added to before
+         */
+        const size_t m_id;
+
+        mutable std::mutex m_lock;
+        std::vector<std::unique_ptr<Table>> m_partials;
+
+        /**
+         * Which of our fields each type, by descriptor, actually has
+         */
+        std::map<std::string, std::vector<std::string>, std::less<>> m_fields;
+
+        Table & partial();
+
+    public :
+        /**
+         * Throws if there's nothing to total
+         */
+        Aggregate (std::vector<std::string> groupBy_, std::vector<std::string> sums_, bool count_);
+
+        Aggregate (const Aggregate &) = delete;
+
+        /**
+         * Every field grouped by or summed
+         */
+        const std::vector<std::string> & paths() const { return m_paths; }
+
+        /**
+         * Run [decode_], which writes the projection of [paths] into the
+         * sink it's given, adding the blob to its group's totals
+         */
+        void add (const std::function<void (amqp::reader::ISink &)> & decode_);
+
+        /**
+         * As [Filter::fields]
+         */
+        const std::vector<std::string> * fields (std::string_view descriptor_);
+
+        const std::vector<std::string> & fields (
+                const std::string & descriptor_,
+                std::vector<std::string> fields_);
+
+        /**
+         * Every thread's totals merged, ordered by group
+         */
+        std::vector<Totals> totals() const;
+
+        /**
+         * A group's totals as an object of its group by fields, then its
+         * count and sums, each keyed by its path
+         */
+        void write (const Totals &, amqp::reader::ISink &) const;
+};
+
+/******************************************************************************/
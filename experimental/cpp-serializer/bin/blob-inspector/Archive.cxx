@@ -0,0 +1,423 @@
+#include "Archive.h"
+
+#include <cstring>
+#include <istream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Codec.h"
+
+#include "amqp/AMQPHeader.h"
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr size_t BLOCK = 512;
+
+    const char COPY_SIGNATURE[] = "PGCOPY\n\377\r\n";
+
+    uint16_t
+    le16 (const char * p_) {
+        return static_cast<uint16_t> (
+            static_cast<unsigned char> (p_[0]) | static_cast<unsigned char> (p_[1]) << 8U);
+    }
+
+    uint32_t
+    le32 (const char * p_) {
+        return static_cast<uint32_t> (le16 (p_)) | static_cast<uint32_t> (le16 (p_ + 2)) << 16U;
+    }
+
+    uint64_t
+    le64 (const char * p_) {
+        return static_cast<uint64_t> (le32 (p_)) | static_cast<uint64_t> (le32 (p_ + 4)) << 32U;
+    }
+
+    uint64_t
+    big (const char * p_, size_t width_) {
+        uint64_t rtn { 0 };
+
+        for (size_t i { 0 } ; i < width_ ; ++i) {
+            rtn = rtn << 8U | static_cast<unsigned char> (p_[i]);
+        }
+
+        return rtn;
+    }
+
+    /**
+     * A tar header's number, octal or, too big for that, GNU's base 256
+     * flagged by the top bit of its first byte
+     */
+    uint64_t
+    number (const char * p_, size_t width_) {
+        if (static_cast<unsigned char> (p_[0]) & 0x80U) {
+            return big (p_ + 1, width_ - 1);
+        }
+
+        uint64_t rtn { 0 };
+        size_t i { 0 };
+
+        while (i < width_ && (p_[i] == ' ' || p_[i] == '\0')) ++i;
+
+        for (; i < width_ && p_[i] >= '0' && p_[i] <= '7' ; ++i) {
+            rtn = rtn << 3U | static_cast<uint64_t> (p_[i] - '0');
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Its checksum being the sum of its bytes, those of the checksum
+     * taken to be spaces
+     */
+    bool
+    header (const char * block_) {
+        uint64_t sum { 0 };
+
+        for (size_t i { 0 } ; i < BLOCK ; ++i) {
+            sum += i >= 148 && i < 156 ? ' ' : static_cast<unsigned char> (block_[i]);
+        }
+
+        return sum == number (block_ + 148, 8);
+    }
+
+    std::string
+    field (const char * p_, size_t width_) {
+        return { p_, ::strnlen (p_, width_) };
+    }
+
+    /**
+     * The path a pax extended header gives, records being the length of
+     * the whole record, a space, then key=value and a newline
+     */
+    std::string
+    pax (const std::vector<char> & records_) {
+        std::string rtn;
+
+        for (size_t at { 0 } ; at < records_.size() ; ) {
+            size_t length { 0 }, i { at };
+
+            for (; i < records_.size() && records_[i] >= '0' && records_[i] <= '9' ; ++i) {
+                length = length * 10 + static_cast<size_t> (records_[i] - '0');
+            }
+
+            if (length == 0 || at + length > records_.size() || i == records_.size() || records_[i] != ' ') {
+                throw std::runtime_error ("Corrupt pax header");
+            }
+
+            std::string record { records_.data() + i + 1, at + length - i - 2 };
+
+            if (record.compare (0, 5, "path=") == 0) rtn = record.substr (5);
+
+            at += length;
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+Archive::Archive (std::istream & in_, int column_)
+    : m_in (in_)
+    , m_head (BLOCK)
+    , m_headAt (0)
+    , m_format (tar_t)
+    , m_column (column_)
+    , m_entries (0)
+    , m_rows (0)
+    , m_ended (false)
+{
+    m_in.read (m_head.data(), BLOCK);
+    m_head.resize (static_cast<size_t> (m_in.gcount()));
+
+    const auto & head = m_head;
+
+    if (head.empty()) {
+        m_ended = true;
+    } else if (head.size() >= sizeof (COPY_SIGNATURE)
+        && std::memcmp (head.data(), COPY_SIGNATURE, sizeof (COPY_SIGNATURE)) == 0)
+    {
+        m_format = copy_t;
+
+        // the signature, flags and header extension
+        char fixed[sizeof (COPY_SIGNATURE) + 8];
+        read (fixed, sizeof (fixed));
+        skip (big (fixed + sizeof (COPY_SIGNATURE) + 4, 4));
+    } else if (head.size() >= 4 && head[0] == 'P' && head[1] == 'K'
+        && ((head[2] == 3 && head[3] == 4) || (head[2] == 5 && head[3] == 6)))
+    {
+        m_format = zip_t;
+    } else if (head.size() == BLOCK
+        && (std::memcmp (head.data() + 257, "ustar", 5) == 0 || header (head.data())))
+    {
+        m_format = tar_t;
+    } else {
+        throw std::runtime_error ("Not a tar, zip or binary COPY archive");
+    }
+}
+
+/******************************************************************************/
+
+bool
+Archive::read (char * p_, size_t n_) {
+    size_t got { 0 };
+
+    if (m_headAt < m_head.size()) {
+        got = std::min (n_, m_head.size() - m_headAt);
+        std::memcpy (p_, m_head.data() + m_headAt, got);
+        m_headAt += got;
+    }
+
+    if (got < n_) {
+        m_in.read (p_ + got, static_cast<std::streamsize> (n_ - got));
+        got += static_cast<size_t> (m_in.gcount());
+    }
+
+    if (got == n_) return true;
+    if (got == 0) return false;
+
+    throw std::runtime_error ("Archive ended part way through an entry");
+}
+
+/******************************************************************************/
+
+void
+Archive::skip (uint64_t n_) {
+    if (m_headAt < m_head.size()) {
+        auto from = std::min<uint64_t> (n_, m_head.size() - m_headAt);
+        m_headAt += from;
+        n_ -= from;
+    }
+
+    while (n_) {
+        auto chunk = std::min<uint64_t> (n_, 1U << 30U);
+
+        m_in.ignore (static_cast<std::streamsize> (chunk));
+
+        if (static_cast<uint64_t> (m_in.gcount()) != chunk) {
+            throw std::runtime_error ("Archive ended part way through an entry");
+        }
+
+        n_ -= chunk;
+    }
+}
+
+/******************************************************************************/
+
+bool
+Archive::tar (std::string & name_, std::vector<char> & bytes_) {
+    char block[BLOCK];
+    std::string named;
+
+    for (;;) {
+        // a tar's meant to end with two empty blocks, but one cut short
+        // between entries has lost nothing
+        if (!read (block, BLOCK)) return false;
+
+        if (std::all_of (block, block + BLOCK, [](char c_) { return c_ == '\0'; })) {
+            m_ended = true;
+            return false;
+        }
+
+        if (!header (block)) throw std::runtime_error ("Corrupt tar header");
+
+        auto size = number (block + 124, 12);
+        auto padding = (BLOCK - size % BLOCK) % BLOCK;
+        auto type = block[156];
+
+        if (type == 'L' || type == 'x') {
+            m_scratch.resize (size);
+            read (m_scratch.data(), size);
+            skip (padding);
+
+            named = type == 'L' ? field (m_scratch.data(), size) : pax (m_scratch);
+            continue;
+        }
+
+        if (type != '0' && type != '\0' && type != '7') {
+            // directories, links, devices and global pax headers
+            skip (size + padding);
+            if (type != 'g') named.clear();
+            continue;
+        }
+
+        if (named.empty()) {
+            named = field (block, 100);
+
+            // GNU's own headers use the prefix for other things
+            if (std::memcmp (block + 257, "ustar", 6) == 0 && block[345] != '\0') {
+                named = field (block + 345, 155) + '/' + named;
+            }
+        }
+
+        name_ = std::move (named);
+
+        bytes_.resize (size);
+        read (bytes_.data(), size);
+        skip (padding);
+
+        return true;
+    }
+}
+
+/******************************************************************************/
+
+bool
+Archive::zip (std::string & name_, std::vector<char> & bytes_) {
+    for (;;) {
+        char local[30];
+
+        if (!read (local, 4)) return false;
+
+        auto signature = le32 (local);
+
+        // the central directory, and everything after it, is no use
+        if (signature == 0x02014b50 || signature == 0x06054b50 || signature == 0x06064b50) {
+            m_ended = true;
+            return false;
+        }
+
+        if (signature != 0x04034b50) throw std::runtime_error ("Corrupt zip entry");
+
+        read (local + 4, 26);
+
+        auto flags = le16 (local + 6);
+        auto method = le16 (local + 8);
+        uint64_t compressed = le32 (local + 18);
+        uint64_t size = le32 (local + 22);
+
+        name_.resize (le16 (local + 26));
+        read (name_.data(), name_.size());
+
+        m_scratch.resize (le16 (local + 28));
+        read (m_scratch.data(), m_scratch.size());
+
+        // zip64's sizes are in an extra field, each only if it's needed
+        bool zip64 { false };
+
+        for (size_t at { 0 } ; at + 4 <= m_scratch.size() ; ) {
+            auto id = le16 (m_scratch.data() + at);
+            auto length = le16 (m_scratch.data() + at + 2);
+            auto * data = m_scratch.data() + at + 4;
+
+            if (id == 0x0001) {
+                zip64 = true;
+                size_t used { 0 };
+
+                if (size == 0xffffffff && used + 8 <= length) size = le64 (data + used), used += 8;
+                if (compressed == 0xffffffff && used + 8 <= length) compressed = le64 (data + used);
+            }
+
+            at += 4U + length;
+        }
+
+        if (flags & 0x1U) throw std::runtime_error ("Encrypted zip entry " + name_);
+
+        if ((flags & 0x8U) && compressed == 0 && method != 0) {
+            throw std::runtime_error ("Zip entry " + name_ + " is only sized after it");
+        }
+
+        if (method == 0) {
+            bytes_.resize (compressed);
+            read (bytes_.data(), compressed);
+        } else if (method == 8) {
+            m_scratch.resize (compressed);
+            read (m_scratch.data(), compressed);
+
+            bytes_.clear();
+            bytes_.reserve (size);
+            Codec::inflate (m_scratch.data(), compressed, bytes_);
+        } else {
+            throw std::runtime_error (
+                "Zip entry " + name_ + " is compressed by unsupported method " + std::to_string (method));
+        }
+
+        if (flags & 0x8U) {
+            // the CRC and sizes, after a signature that's optional
+            char descriptor[24];
+            read (descriptor, 4);
+
+            auto rest = (zip64 ? 16U : 8U) + (le32 (descriptor) == 0x08074b50 ? 4U : 0U);
+            read (descriptor + 4, rest);
+        }
+
+        if (!name_.empty() && name_.back() == '/') continue;
+
+        return true;
+    }
+}
+
+/******************************************************************************/
+
+bool
+Archive::copy (std::string & name_, std::vector<char> & bytes_) {
+    for (;;) {
+        char count[4];
+
+        if (!read (count, 2)) return false;
+
+        auto fields = static_cast<int16_t> (big (count, 2));
+
+        // the trailer
+        if (fields == -1) {
+            m_ended = true;
+            return false;
+        }
+
+        ++m_rows;
+
+        bool found { false };
+
+        for (int i { 0 } ; i < fields ; ++i) {
+            read (count, 4);
+            auto length = static_cast<int32_t> (big (count, 4));
+
+            // null
+            if (length < 0) continue;
+
+            if (found || (m_column >= 0 && i != m_column)) {
+                skip (static_cast<uint64_t> (length));
+                continue;
+            }
+
+            bytes_.resize (static_cast<size_t> (length));
+            read (bytes_.data(), bytes_.size());
+
+            found = m_column >= 0 || (bytes_.size() >= amqp::AMQP_HEADER.size()
+                && std::equal (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end(), bytes_.begin()));
+        }
+
+        if (!found) continue;
+
+        name_ = "row " + std::to_string (m_rows);
+
+        return true;
+    }
+}
+
+/******************************************************************************/
+
+bool
+Archive::next (std::string & name_, std::vector<char> & bytes_) {
+    if (m_ended) return false;
+
+    bool rtn { false };
+
+    switch (m_format) {
+        case tar_t  : rtn = tar (name_, bytes_); break;
+        case zip_t  : rtn = zip (name_, bytes_); break;
+        case copy_t : rtn = copy (name_, bytes_); break;
+    }
+
+    if (rtn) {
+        ++m_entries;
+    } else {
+        m_ended = true;
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,86 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+/******************************************************************************/
+
+/**
+ * Streams blobs out of an archive of them, a tar or zip file or the
+ * output of Postgres' COPY ... TO STDOUT (FORMAT binary), as they're
+ * read, from a pipe as readily as a file, so a batch never needs them
+ * written out as files of their own first. Which it is is told from
+ * its first block.
+ *
+ * Each blob is read straight into the buffer it's handed over in, the
+ * one it'll be decoded from, bar a zip's deflated entries which are
+ * inflated into it. Nothing beyond the blob being read is held.
+ *
+ * A tar's regular files are its blobs, ustar, GNU and pax alike, long
+ * names included. Directories, links and the like are passed over.
+ *
+ * A zip's entries are read from their local headers, stored or deflated,
+ * the archive's central directory at its end never being needed. Which
+ * means an entry whose sizes only follow it, in a data descriptor, as
+ * some writers streaming a zip leave them, can't be read and throws.
+ *
+ * Each row of a binary COPY is a blob, taken from column [column_] if
+ * given one, counting from zero, or otherwise from the first of its
+ * columns that starts with a blob's header. A row whose column is null
+ * is passed over. Rows are named "row" and their number, from one.
+ */
+class Archive {
+    public :
+        enum Format { tar_t, zip_t, copy_t };
+
+    private :
+        std::istream & m_in;
+
+        /**
+         * What was read to tell the format, to be read again
+         */
+        std::vector<char> m_head;
+        size_t m_headAt;
+
+        Format m_format;
+        int m_column;
+
+        size_t m_entries;
+        size_t m_rows;
+        bool m_ended;
+
+        std::vector<char> m_scratch;
+
+        /**
+         * Read exactly [n_] bytes, false should the stream end first,
+         * having read nothing, and throwing should it end part way
+         */
+        bool read (char *, size_t n_);
+        void skip (uint64_t n_);
+
+        bool tar (std::string & name_, std::vector<char> & bytes_);
+        bool zip (std::string & name_, std::vector<char> & bytes_);
+        bool copy (std::string & name_, std::vector<char> & bytes_);
+
+    public :
+        explicit Archive (std::istream &, int column_ = -1);
+
+        Archive (const Archive &) = delete;
+
+        Format format() const { return m_format; }
+
+        /**
+         * The next blob, its name in [name_] and its bytes in [bytes_],
+         * false once there are none left. An archive that's cut short or
+         * corrupt throws
+         */
+        bool next (std::string & name_, std::vector<char> & bytes_);
+
+        size_t entries() const { return m_entries; }
+};
+
+/******************************************************************************/
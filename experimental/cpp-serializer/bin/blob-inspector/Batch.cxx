@@ -0,0 +1,1216 @@
+#include "Batch.h"
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+#include <glob.h>
+
+#include "CordaBytes.h"
+#include "Memo.h"
+#include "Filter.h"
+#include "Aggregate.h"
+#include "FileReader.h"
+#include "BlobInspector.h"
+#include "Output.h"
+#include "Snapshot.h"
+#include "Schedule.h"
+#include "WorkStealingPool.h"
+
+#include "amqp/AMQPSectionId.h"
+#include "cursor/Hash.h"
+#include "cursor/Cursor.h"
+#include "sink/CsvSink.h"
+#include "sink/CborSink.h"
+#include "sink/JsonSink.h"
+#include "stats/Stats.h"
+
+namespace {
+
+    /**
+     * Passes on just the value of the "Parsed" field, dropping the
+     * key that introduces it
+     */
+    class Contents : public amqp::reader::ISink {
+        private :
+            amqp::reader::ISink & m_sink;
+            size_t m_depth { 0 };
+
+        public :
+            explicit Contents (amqp::reader::ISink & sink_) : m_sink (sink_) { }
+
+            void beginObject() override { ++m_depth; m_sink.beginObject(); }
+            void endObject() override { --m_depth; m_sink.endObject(); }
+            void beginList() override { ++m_depth; m_sink.beginList(); }
+            void endList() override { --m_depth; m_sink.endList(); }
+            void beginMap() override { ++m_depth; m_sink.beginMap(); }
+            void endMap() override { --m_depth; m_sink.endMap(); }
+
+            void key (std::string_view key_) override {
+                if (m_depth) m_sink.key (key_);
+            }
+
+            void key (const Key & key_) override {
+                if (m_depth) m_sink.key (key_);
+            }
+
+            void null() override { m_sink.null(); }
+            void boolean (bool v_) override { m_sink.boolean (v_); }
+            void integer (int64_t v_) override { m_sink.integer (v_); }
+            void real (double v_) override { m_sink.real (v_); }
+            void string (std::string_view v_) override { m_sink.string (v_); }
+
+            void integers (const int64_t * v_, size_t n_) override { m_sink.integers (v_, n_); }
+            void reals (const double * v_, size_t n_) override { m_sink.reals (v_, n_); }
+
+            void symbol (std::string_view v_) override { m_sink.symbol (v_); }
+            void binary (std::string_view v_) override { m_sink.binary (v_); }
+
+            bool hashes() const override { return m_sink.hashes(); }
+            void hash (uint64_t low_, uint64_t high_) override { m_sink.hash (low_, high_); }
+    };
+
+    /**
+     * [line_], a JSON line naming no file, as the line naming [file_]
+     */
+    void
+    named (const std::string & file_, const std::string & line_, std::string & out_) {
+        out_.clear();
+
+        if (line_.empty()) return;
+
+        {
+            amqp::internal::sink::JsonSink sink (out_);
+
+            sink.beginObject();
+            sink.key ("file");
+            sink.string (file_);
+            sink.endObject();
+        }
+
+        out_.back() = ',';
+        out_.append (line_, 1, std::string::npos);
+    }
+
+    /**
+     * What's written of a blob when peeking
+     */
+    void
+    peeked (
+        amqp::reader::ISink & sink_,
+        const std::string & file_,
+        const std::string & type_,
+        const std::string & descriptor_
+    ) {
+        sink_.beginObject();
+        sink_.key ("file");
+        sink_.string (file_);
+
+        if (!type_.empty()) {
+            sink_.key ("type");
+            sink_.string (type_);
+        }
+
+        sink_.key ("descriptor");
+        sink_.string (descriptor_);
+        sink_.endObject();
+    }
+
+}
+
+/******************************************************************************/
+
+Batch::Batch (
+    std::vector<std::string> files_,
+    Options options_
+) : m_files (std::move (files_))
+  , m_options (std::move (options_))
+{
+    if (m_options.m_peek && m_options.m_format == csv_t) {
+        throw std::runtime_error ("Peeking writes JSON or CBOR, not CSV");
+    }
+
+    if (m_options.m_aggregate
+            && (m_options.m_format == csv_t || m_options.m_peek || !m_options.m_route.empty()))
+    {
+        throw std::runtime_error ("Aggregates are written as JSON or CBOR, neither peeked nor routed");
+    }
+
+    if (m_options.m_format == csv_t) {
+        if (m_options.m_paths.empty()) {
+            throw std::runtime_error ("CSV needs the fields to write as its columns");
+        }
+
+        m_columns.emplace_back ("file");
+        for (const auto & path : m_options.m_paths) {
+            m_columns.emplace_back ("Parsed." + path);
+        }
+    }
+
+    // a blob written from the memo would go uncounted
+    if (m_options.m_memo > 0 && m_options.m_format != csv_t && !m_options.m_aggregate) {
+        m_memo = std::make_shared<Memo> (m_options.m_memo);
+    }
+
+    using Paths = amqp::internal::tape::Tape::Paths;
+
+    m_projected = std::make_shared<Paths> (m_options.m_paths);
+
+    if (m_options.m_where) m_tested = std::make_shared<Paths> (m_options.m_where->paths());
+    if (m_options.m_aggregate) m_summed = std::make_shared<Paths> (m_options.m_aggregate->paths());
+}
+
+/******************************************************************************/
+
+std::string
+Batch::error (const std::string & name_, const char * what_) {
+    std::stringstream err;
+    {
+        amqp::internal::sink::JsonSink sink (err);
+
+        sink.beginObject();
+        if (!name_.empty()) {
+            sink.key ("file");
+            sink.string (name_);
+        }
+        sink.key ("error");
+        sink.string (what_);
+        sink.endObject();
+    }
+
+    return err.str();
+}
+
+/******************************************************************************/
+
+bool
+Batch::render (
+    const std::string & file_,
+    std::string & line_,
+    const std::vector<std::string> & paths_,
+    bool pointers_,
+    std::string * error_
+) {
+    std::unique_ptr<CordaBytes> cb;
+
+    try {
+        cb = std::make_unique<CordaBytes> (file_);
+    } catch (const std::exception & e) {
+        line_ = error (file_, e.what());
+        if (error_) *error_ = e.what();
+        return false;
+    }
+
+    return render (*cb, file_, line_, paths_, pointers_, error_);
+}
+
+/******************************************************************************/
+
+bool
+Batch::render (
+    CordaBytes & cb_,
+    const std::string & name_,
+    std::string & line_,
+    const std::vector<std::string> & paths_,
+    bool pointers_,
+    std::string * error_
+) {
+    BlobInspector inspector (cb_);
+    inspector.pointers (pointers_);
+
+    return render (cb_, inspector, name_, line_, paths_, error_);
+}
+
+/******************************************************************************/
+
+bool
+Batch::render (
+    CordaBytes & cb_,
+    BlobInspector & inspector_,
+    const std::string & name_,
+    std::string & line_,
+    const std::vector<std::string> & paths_,
+    std::string * error_
+) {
+    line_.clear();
+
+    try {
+        if (cb_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        amqp::internal::sink::JsonSink sink (line_);
+
+        sink.beginObject();
+        if (!name_.empty()) {
+            sink.key ("file");
+            sink.string (name_);
+        }
+        if (paths_.empty()) {
+            inspector_.writeFields (sink);
+        } else {
+            inspector_.projectFields (sink, paths_);
+        }
+        sink.endObject();
+    } catch (const std::exception & e) {
+        // throw away whatever was written before it went wrong
+        line_ = error (name_, e.what());
+        if (error_) *error_ = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+BlobInspector &
+Batch::configure (BlobInspector & inspector_) const {
+    if (m_options.m_split && inspector_.size() >= m_options.m_split) {
+        if (m_pool) {
+            inspector_.threads (*m_pool);
+        } else {
+            inspector_.threads (m_options.m_threads ? m_options.m_threads : std::thread::hardware_concurrency());
+        }
+    }
+
+    return inspector_
+        .pointers (m_options.m_pointers)
+        .sample (m_options.m_sample, m_options.m_uniform)
+        .limits (m_options.m_limits.get())
+        .nested (m_options.m_nested);
+}
+
+/******************************************************************************/
+
+void
+Batch::contents (BlobInspector & inspector_, amqp::reader::ISink & sink_) const {
+    Contents sink (sink_);
+
+    if (m_options.m_paths.empty()) {
+        configure (inspector_).writeFields (sink);
+    } else {
+        inspector_.nested (m_options.m_nested).projectFields (sink, m_options.m_paths);
+    }
+}
+
+/******************************************************************************/
+
+void
+Batch::contents (const Snapshot & snapshot_, amqp::reader::ISink & sink_) const {
+    Contents sink (sink_);
+
+    if (m_options.m_paths.empty()) {
+        snapshot_.writeFields (sink);
+    } else {
+        snapshot_.projectFields (sink, *m_projected);
+    }
+}
+
+/******************************************************************************/
+
+bool
+Batch::route (CordaBytes & cb_, std::string & route_, std::string & error_) const {
+    route_.clear();
+
+    if (m_options.m_route.empty()) return true;
+
+    try {
+        if (cb_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        return route (BlobInspector (cb_).type(), route_, error_);
+    } catch (const std::exception & e) {
+        error_ = e.what();
+        return false;
+    }
+}
+
+/******************************************************************************/
+
+bool
+Batch::route (std::string type_, std::string & route_, std::string & error_) const {
+    route_.clear();
+
+    if (m_options.m_route.empty()) return true;
+
+    try {
+        if (auto it = m_options.m_routes.find (type_) ; it != m_options.m_routes.end()) {
+            route_ = it->second;
+        } else if (auto any = m_options.m_routes.find ("*") ; any != m_options.m_routes.end()) {
+            route_ = any->second;
+        } else if (!type_.empty()) {
+            route_ = std::move (type_);
+        } else {
+            throw std::runtime_error ("No type to route by");
+        }
+
+        // a type is whatever the blob says it is, so mustn't lead out of the directory
+        if (route_.find ('/') != std::string::npos || route_ == "." || route_ == "..") {
+            throw std::runtime_error ("Can't route to \"" + route_ + "\"");
+        }
+    } catch (const std::exception & e) {
+        error_ = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+Batch::line (
+    const std::string & file_,
+    std::string & out_,
+    std::string & error_,
+    std::string & route_,
+    Checkpoint::Entry * record_
+) const {
+    if (Snapshot::named (file_)) return snapshot (file_, out_, error_, route_, record_);
+
+    std::unique_ptr<CordaBytes> cb;
+
+    try {
+        cb = std::make_unique<CordaBytes> (file_);
+    } catch (const std::exception & e) {
+        out_ = m_options.m_format == json_t ? error (file_, e.what()) : std::string();
+        error_ = e.what();
+        return false;
+    }
+
+    return line (file_, *cb, out_, error_, route_, record_);
+}
+
+/******************************************************************************/
+
+/*
+ * A JSON line is kept without the file it names, that being put back for
+ * every blob it's written for
+ */
+bool
+Batch::line (
+    const std::string & file_,
+    CordaBytes & cb_,
+    std::string & out_,
+    std::string & error_,
+    std::string & route_,
+    Checkpoint::Entry * record_
+) const {
+    using amqp::internal::stats::Stats;
+
+    if (record_) {
+        // statted after it was read, so a blob changed since is hashed next time
+        Checkpoint::stat (file_, *record_);
+        record_->m_hash = amqp::internal::cursor::hash ({ cb_.bytes(), cb_.size() });
+
+        if (m_options.m_incremental) {
+            if (auto * was = m_options.m_checkpoint->find (file_) ; was && was->m_hash == record_->m_hash) {
+                out_.clear();
+                return true;
+            }
+        }
+    }
+
+    if (!route (cb_, route_, error_)) {
+        out_.clear();
+        return false;
+    }
+
+    if (m_options.m_peek) return peek (file_, cb_, out_, error_);
+
+    if (!m_memo || cb_.encoding() != amqp::DATA_AND_STOP) {
+        return decode (file_, cb_, out_, error_);
+    }
+
+    const auto key = Memo::key ({ cb_.bytes(), cb_.size() });
+
+    thread_local Memo::Entry entry;
+
+    if (m_memo->find (key, entry)) {
+        Stats::count (Stats::memo_hits_t);
+    } else {
+        Stats::count (Stats::memo_misses_t);
+
+        entry.m_error.clear();
+        entry.m_ok = decode (std::string(), cb_, entry.m_output, entry.m_error);
+        m_memo->insert (key, entry);
+    }
+
+    if (m_options.m_format != json_t) {
+        out_ = entry.m_output;
+    } else if (entry.m_ok) {
+        named (file_, entry.m_output, out_);
+    } else {
+        out_ = error (file_, entry.m_error.c_str());
+    }
+
+    error_ = entry.m_error;
+
+    return entry.m_ok;
+}
+
+/******************************************************************************/
+
+bool
+Batch::peek (
+    const std::string & file_,
+    CordaBytes & cb_,
+    std::string & out_,
+    std::string & error_
+) const {
+    out_.clear();
+
+    try {
+        if (cb_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        BlobInspector inspector (cb_);
+
+        auto write = [&](amqp::reader::ISink & sink_) {
+            peeked (sink_, file_, inspector.type(), inspector.descriptor());
+        };
+
+        if (m_options.m_format == cbor_t) {
+            amqp::internal::sink::CborSink cbor (out_);
+            cbor.stringrefs (m_options.m_dictionary);
+            write (cbor);
+        } else {
+            amqp::internal::sink::JsonSink json (out_);
+            write (json);
+        }
+    } catch (const std::exception & e) {
+        out_ = m_options.m_format == json_t ? error (file_, e.what()) : std::string();
+        error_ = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+Batch::decode (
+    const std::string & file_,
+    CordaBytes & cb_,
+    std::string & out_,
+    std::string & error_
+) const {
+    /*
+     * Whatever's too corrupt to walk is caught here without anything
+     * being thrown, leaving only blobs that don't match their schema to
+     * fail part way through decoding
+     */
+    if (m_options.m_validate && cb_.encoding() == amqp::DATA_AND_STOP) {
+        if (auto status = amqp::internal::cursor::validate (cb_.bytes(), cb_.size()) ; !status) {
+            error_ = status.message();
+            out_ = m_options.m_format == json_t ? error (file_, error_.c_str()) : std::string();
+            return false;
+        }
+    }
+
+    if (m_options.m_where && cb_.encoding() == amqp::DATA_AND_STOP) {
+        try {
+            BlobInspector inspector (cb_);
+
+            if (!configure (inspector).matches (*m_options.m_where)) {
+                out_.clear();
+                return true;
+            }
+        } catch (const std::exception & e) {
+            out_ = m_options.m_format == json_t ? error (file_, e.what()) : std::string();
+            error_ = e.what();
+            return false;
+        }
+    }
+
+    if (m_options.m_aggregate) {
+        out_.clear();
+
+        try {
+            if (cb_.encoding() != amqp::DATA_AND_STOP) {
+                throw std::runtime_error ("Bad encoding");
+            }
+
+            BlobInspector inspector (cb_);
+            configure (inspector).aggregate (*m_options.m_aggregate);
+        } catch (const std::exception & e) {
+            error_ = e.what();
+            return false;
+        }
+
+        return true;
+    }
+
+    if (m_options.m_format == json_t) {
+        BlobInspector inspector (cb_);
+        return render (cb_, configure (inspector), file_, out_, m_options.m_paths, &error_);
+    }
+
+    out_.clear();
+
+    try {
+        if (cb_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        BlobInspector inspector (cb_);
+
+        if (m_options.m_format == ndjson_t) {
+            amqp::internal::sink::JsonSink json (out_);
+            contents (inspector, json);
+        } else if (m_options.m_format == cbor_t) {
+            amqp::internal::sink::CborSink cbor (out_);
+            cbor.stringrefs (m_options.m_dictionary);
+            contents (inspector, cbor);
+        } else {
+            amqp::internal::sink::CsvSink sink (out_, m_columns);
+
+            sink.beginObject();
+            sink.key ("file");
+            sink.string (file_);
+            inspector.projectFields (sink, m_options.m_paths);
+            sink.endObject();
+
+            // the row's new line is left to [run]
+            out_.pop_back();
+        }
+    } catch (const std::exception & e) {
+        out_.clear();
+        error_ = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+Batch::snapshot (
+    const std::string & file_,
+    std::string & out_,
+    std::string & error_,
+    std::string & route_,
+    Checkpoint::Entry * record_
+) const {
+    std::unique_ptr<Snapshot> snapshot;
+
+    try {
+        snapshot = Snapshot::load (file_);
+    } catch (const std::exception & e) {
+        out_ = m_options.m_format == json_t ? error (file_, e.what()) : std::string();
+        error_ = e.what();
+        return false;
+    }
+
+    if (record_) {
+        const auto blob = snapshot->tape().blob();
+
+        Checkpoint::stat (file_, *record_);
+        record_->m_hash = amqp::internal::cursor::hash (blob);
+
+        if (m_options.m_incremental) {
+            if (auto * was = m_options.m_checkpoint->find (file_) ; was && was->m_hash == record_->m_hash) {
+                out_.clear();
+                return true;
+            }
+        }
+    }
+
+    if (!route (snapshot->type(), route_, error_)) {
+        out_.clear();
+        return false;
+    }
+
+    if (m_options.m_peek) {
+        out_.clear();
+
+        if (m_options.m_format == cbor_t) {
+            amqp::internal::sink::CborSink cbor (out_);
+            cbor.stringrefs (m_options.m_dictionary);
+            peeked (cbor, file_, snapshot->type(), snapshot->descriptor());
+        } else {
+            amqp::internal::sink::JsonSink json (out_);
+            peeked (json, file_, snapshot->type(), snapshot->descriptor());
+        }
+
+        return true;
+    }
+
+    return decode (file_, *snapshot, out_, error_);
+}
+
+/******************************************************************************/
+
+/*
+ * As decoding a blob, only with whatever those decodes would have written
+ * replayed from the tape instead
+ */
+bool
+Batch::decode (
+    const std::string & file_,
+    const Snapshot & snapshot_,
+    std::string & out_,
+    std::string & error_
+) const {
+    out_.clear();
+
+    try {
+        if (m_options.m_where) {
+            auto matched = m_options.m_where->evaluate ([&](amqp::reader::ISink & sink_) {
+                snapshot_.project (sink_, *m_tested);
+            });
+
+            if (!matched) return true;
+        }
+
+        if (m_options.m_aggregate) {
+            m_options.m_aggregate->add ([&](amqp::reader::ISink & sink_) {
+                if (m_options.m_aggregate->paths().empty()) return;
+                snapshot_.project (sink_, *m_summed);
+            });
+
+            return true;
+        }
+
+        if (m_options.m_format == json_t) {
+            amqp::internal::sink::JsonSink sink (out_);
+
+            sink.beginObject();
+            sink.key ("file");
+            sink.string (file_);
+
+            if (m_options.m_paths.empty()) {
+                snapshot_.writeFields (sink);
+            } else {
+                snapshot_.projectFields (sink, *m_projected);
+            }
+
+            sink.endObject();
+        } else if (m_options.m_format == ndjson_t) {
+            amqp::internal::sink::JsonSink json (out_);
+            contents (snapshot_, json);
+        } else if (m_options.m_format == cbor_t) {
+            amqp::internal::sink::CborSink cbor (out_);
+            cbor.stringrefs (m_options.m_dictionary);
+            contents (snapshot_, cbor);
+        } else {
+            amqp::internal::sink::CsvSink sink (out_, m_columns);
+
+            sink.beginObject();
+            sink.key ("file");
+            sink.string (file_);
+            snapshot_.projectFields (sink, *m_projected);
+            sink.endObject();
+
+            // the row's new line is left to [run]
+            out_.pop_back();
+        }
+    } catch (const std::exception & e) {
+        out_ = m_options.m_format == json_t && !m_options.m_aggregate ? error (file_, e.what()) : std::string();
+        error_ = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+size_t
+Batch::run (std::ostream & out_, std::ostream & errors_) const {
+    std::atomic<size_t> failures { 0 };
+
+    // CBOR items follow one another as they are, a CBOR sequence
+    const std::string_view separator { m_options.m_format == cbor_t ? "" : "\n" };
+
+    const bool routed { !m_options.m_route.empty() };
+
+    // routed or aggregated, failures are always reported apart
+    const bool apart { routed || m_options.m_aggregate };
+
+    auto * checkpoint = m_options.m_checkpoint.get();
+
+    if (checkpoint && apart) {
+        throw std::runtime_error ("A checkpoint can't be kept when routing or aggregating");
+    }
+
+    if (checkpoint && m_options.m_archive) {
+        throw std::runtime_error ("A checkpoint can't be kept of an archive");
+    }
+
+    const bool compressed { m_options.m_compress != Compressor::none_t };
+
+    // a checkpoint's offsets are of what was written, not what was compressed
+    if (compressed && (checkpoint || routed)) {
+        throw std::runtime_error ("Output can't be compressed when checkpointed or routed");
+    }
+
+    const auto threads = m_options.m_threads == 0
+        ? std::max (1U, std::thread::hardware_concurrency())
+        : m_options.m_threads;
+
+    std::vector<std::string> remaining;
+    if (checkpoint) remaining = pending (threads);
+
+    const auto & files = checkpoint ? remaining : m_files;
+
+    /*
+     * Where the output stands, only counted with a checkpoint to record
+     * it in. Everything written for a blob before it's recorded
+     */
+    uint64_t offset { m_options.m_offset };
+    std::mutex recording;
+    std::map<size_t, Checkpoint::Entry> records;
+
+    if (checkpoint) checkpoint->begin (offset);
+
+    /*
+     * Compressing, the frames are compressed by the same workers as decode
+     * the blobs, so the pool outlives everything writing to them
+     */
+    WorkStealingPool pool (threads, m_options.m_numa);
+    const auto started = std::chrono::steady_clock::now();
+
+    // blobs configured once the run's over get pools of their own again
+    struct Unset {
+        WorkStealingPool *& m_pool;
+        ~Unset() { m_pool = nullptr; }
+    } unset { m_pool };
+
+    m_pool = &pool;
+
+    std::unique_ptr<Compressor> compressor;
+    std::ostream * out = &out_;
+
+    if (compressed) {
+        compressor = std::make_unique<Compressor> (out_, m_options.m_compress, m_options.m_level, pool);
+        out = &compressor->stream();
+    }
+
+    std::string header;
+
+    if (m_options.m_format == csv_t) {
+        std::vector<std::string> names { "file" };
+        names.insert (names.end(), m_options.m_paths.begin(), m_options.m_paths.end());
+
+        amqp::internal::sink::CsvSink::row (header, names);
+
+        if (!routed && offset == 0) {
+            *out << header;
+            offset += header.size();
+        }
+    }
+
+    if (routed) std::filesystem::create_directories (m_options.m_route);
+
+    const char * extension {
+        m_options.m_format == csv_t ? ".csv" : m_options.m_format == cbor_t ? ".cbor" : ".ndjson" };
+
+    /*
+     * Only ever touched by the output's writer. A route whose file won't
+     * open has its lines counted as failures
+     */
+    std::map<std::string, std::ofstream, std::less<>> routes;
+
+    /*
+     * Only JSON reports failures in line, otherwise the line's left
+     * empty, no line ever being so otherwise, to keep its place, and the
+     * failure reported apart
+     */
+    const auto window = m_options.m_window ? m_options.m_window : WINDOW * threads;
+
+    Output output (
+        [&](size_t i_, const std::string & route_, const std::string & line_, const std::string & report_) {
+            if (!report_.empty()) errors_ << report_ << '\n';
+
+            if (checkpoint) {
+                if (!line_.empty()) {
+                    *out << line_ << separator;
+                    offset += line_.size() + separator.size();
+                }
+
+                Checkpoint::Entry record;
+                {
+                    std::lock_guard<std::mutex> guard (recording);
+
+                    auto it = records.find (i_);
+                    if (it == records.end()) return;
+
+                    record = it->second;
+                    records.erase (it);
+                }
+
+                record.m_end = offset;
+                checkpoint->record (files[i_], record);
+
+                if (checkpoint->due()) {
+                    out_.flush();
+                    checkpoint->commit();
+                }
+
+                return;
+            }
+
+            if (line_.empty()) return;
+
+            if (route_.empty()) {
+                *out << line_ << separator;
+                return;
+            }
+
+            auto it = routes.find (route_);
+
+            if (it == routes.end()) {
+                const auto path = m_options.m_route + "/" + route_ + extension;
+
+                it = routes.emplace (route_, std::ofstream (path, std::ios::out | std::ios::binary)).first;
+
+                if (it->second) {
+                    it->second << header;
+                } else {
+                    errors_ << error (path, "Failed to open") << '\n';
+                }
+            }
+
+            if (it->second) {
+                it->second << line_ << separator;
+            } else {
+                ++failures;
+            }
+        },
+        window,
+        m_options.m_ordered);
+
+    {
+        auto finish = [&](
+            const std::string & file_,
+            size_t i_,
+            bool ok_,
+            std::string & line_,
+            const std::string & error_,
+            std::string_view route_ = { },
+            const Checkpoint::Entry * record_ = nullptr
+        ) {
+            thread_local std::string report;
+
+            report.clear();
+
+            if (!ok_) {
+                ++failures;
+
+                if (m_options.m_format != json_t || apart) {
+                    report = Batch::error (file_, error_.c_str());
+                    line_.clear();
+                }
+            } else if (record_) {
+                // failures are left to be tried again
+                std::lock_guard<std::mutex> guard (recording);
+                records[i_] = *record_;
+            }
+
+            output.put (i_, line_, report, route_);
+        };
+
+        std::unique_ptr<FileReader> reader;
+
+        // tasks take their files from it until the pool's waited on
+        std::unique_ptr<Schedule> schedule;
+
+        /*
+         * Blobs read ahead are already held to what the reader's pool of
+         * buffers holds, there being no way to stop a reader part way
+         * through its queue without stalling the reads it's yet to reap
+         */
+        if (m_options.m_archive) {
+            std::string name;
+            std::vector<char> bytes;
+
+            // read on this thread, each blob's buffer handed to its worker
+            for (size_t i { 0 } ; ; ++i) {
+                {
+                    amqp::internal::stats::Stats::Timer timer (amqp::internal::stats::Stats::io_t);
+
+                    bytes = CordaBytes::buffer();
+                    if (!m_options.m_archive->next (name, bytes)) break;
+                }
+
+                output.admit();
+
+                auto blob = std::make_shared<std::pair<std::string, std::vector<char>>> (
+                        std::move (name), std::move (bytes));
+
+                pool.submit ([&, i, blob]() {
+                    thread_local std::string line;
+                    thread_local std::string error;
+                    thread_local std::string route;
+
+                    const auto & file = blob->first;
+
+                    bool ok;
+
+                    route.clear();
+
+                    try {
+                        amqp::internal::stats::Stats::Latency latency;
+
+                        CordaBytes cb (std::move (blob->second));
+                        ok = this->line (file, cb, line, error, route);
+                    } catch (const std::exception & e) {
+                        line = m_options.m_format == json_t ? Batch::error (file, e.what()) : std::string();
+                        error = e.what();
+                        ok = false;
+                    }
+
+                    finish (file, i, ok, line, error, route);
+                });
+            }
+        } else if (m_options.m_depth) {
+            reader = FileReader::make (m_options.m_io, m_options.m_depth, m_options.m_pages, pool.nodes());
+
+            reader->read (files, [&](size_t i_, FileReader::Buffer && buffer_, size_t size_, const char * error_) {
+                if (error_) {
+                    pool.submit ([&, i_, error_]() {
+                        thread_local std::string line;
+
+                        line = m_options.m_format == json_t ? error (files[i_], error_) : std::string();
+                        finish (files[i_], i_, false, line, error_);
+                    }, i_);
+
+                    return;
+                }
+
+                // std::function needs copyable tasks, so the buffer's
+                // moved in through a shared pointer
+                auto buffer = std::make_shared<FileReader::Buffer> (std::move (buffer_));
+
+                pool.submit ([&, i_, buffer, size_]() {
+                    thread_local std::string line;
+                    thread_local std::string error;
+                    thread_local std::string route;
+
+                    Checkpoint::Entry record { };
+
+                    bool ok;
+
+                    route.clear();
+
+                    try {
+                        amqp::internal::stats::Stats::Latency latency;
+
+                        // a snapshot's mapped whether or not it was read ahead
+                        if (Snapshot::named (files[i_])) {
+                            ok = this->line (files[i_], line, error, route, checkpoint ? &record : nullptr);
+                        } else {
+                            CordaBytes cb (buffer->data(), size_);
+                            ok = this->line (files[i_], cb, line, error, route, checkpoint ? &record : nullptr);
+                        }
+                    } catch (const std::exception & e) {
+                        line = m_options.m_format == json_t ? Batch::error (files[i_], e.what()) : std::string();
+                        error = e.what();
+                        ok = false;
+                    }
+
+                    reader->recycle (std::move (*buffer));
+                    finish (files[i_], i_, ok, line, error, route, checkpoint ? &record : nullptr);
+                }, i_);
+            });
+        } else {
+            if (m_options.m_largest) schedule = std::make_unique<Schedule> (files, window, m_options.m_ordered);
+
+            for (size_t n { 0 } ; n < files.size() ; ++n) {
+                output.admit();
+
+                // scheduled, whichever task runs first takes the largest file left
+                pool.submit ([&, n]() {
+                    const auto i = schedule ? schedule->next() : n;
+
+                    thread_local std::string line;
+                    thread_local std::string error;
+                    thread_local std::string route;
+
+                    Checkpoint::Entry record { };
+
+                    route.clear();
+
+                    bool ok;
+                    {
+                        amqp::internal::stats::Stats::Latency latency;
+                        ok = this->line (files[i], line, error, route, checkpoint ? &record : nullptr);
+                    }
+
+                    finish (files[i], i, ok, line, error, route, checkpoint ? &record : nullptr);
+                });
+            }
+        }
+
+        pool.wait();
+    }
+
+    output.close();
+
+    // what the workers could have spent on blobs, against what they did
+    amqp::internal::stats::Stats::count (amqp::internal::stats::Stats::available_t, threads * static_cast<uint64_t> (
+            std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now() - started).count()));
+
+    if (m_options.m_aggregate) {
+        std::string line;
+
+        for (const auto & totals : m_options.m_aggregate->totals()) {
+            line.clear();
+
+            if (m_options.m_format == cbor_t) {
+                amqp::internal::sink::CborSink cbor (line);
+                m_options.m_aggregate->write (totals, cbor);
+            } else {
+                amqp::internal::sink::JsonSink json (line);
+                m_options.m_aggregate->write (totals, json);
+            }
+
+            *out << line << separator;
+        }
+    }
+
+    if (compressor) compressor->finish();
+
+    out_.flush();
+
+    if (checkpoint) checkpoint->commit();
+
+    for (auto & route : routes) route.second.flush();
+
+    return failures;
+}
+
+/******************************************************************************/
+
+std::vector<std::string>
+Batch::pending (size_t threads_) const {
+    const auto & checkpoint = *m_options.m_checkpoint;
+
+    std::vector<char> done (m_files.size(), 0);
+
+    if (!m_options.m_incremental) {
+        for (size_t i { 0 } ; i < m_files.size() ; ++i) done[i] = checkpoint.find (m_files[i]) != nullptr;
+    } else {
+        std::atomic<size_t> next { 0 };
+        std::vector<std::thread> statting;
+
+        for (size_t t { 0 } ; t < std::min (threads_, m_files.size()) ; ++t) {
+            statting.emplace_back ([&]() {
+                Checkpoint::Entry now { };
+
+                for (size_t i ; (i = next++) < m_files.size() ; ) {
+                    auto * was = checkpoint.find (m_files[i]);
+
+                    done[i] = was && Checkpoint::stat (m_files[i], now)
+                        && now.m_size == was->m_size && now.m_modified == was->m_modified;
+                }
+            });
+        }
+
+        for (auto & thread : statting) thread.join();
+    }
+
+    std::vector<std::string> rtn;
+
+    for (size_t i { 0 } ; i < m_files.size() ; ++i) {
+        if (!done[i]) rtn.push_back (m_files[i]);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::map<std::string, std::string>
+Batch::routes (std::istream & in_) {
+    std::map<std::string, std::string> rtn;
+
+    for (std::string line ; std::getline (in_, line) ; ) {
+        if (auto hash = line.find ('#') ; hash != std::string::npos) line.erase (hash);
+
+        std::stringstream ss { line };
+        std::string type, name, extra;
+
+        if (!(ss >> type)) continue;
+
+        if (!(ss >> name) || (ss >> extra)) {
+            throw std::runtime_error ("Bad route \"" + line + "\"");
+        }
+
+        rtn[type] = name;
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::vector<std::string>
+Batch::expand (const std::string & arg_, std::istream & manifest_) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> rtn;
+
+    if (arg_ == "-") {
+        std::string line;
+        while (std::getline (manifest_, line)) {
+            if (!line.empty()) {
+                rtn.emplace_back (std::move (line));
+            }
+        }
+
+        return rtn;
+    }
+
+    std::error_code ec;
+
+    if (fs::is_directory (arg_, ec)) {
+        for (auto & entry : fs::recursive_directory_iterator (arg_)) {
+            if (entry.is_regular_file()) {
+                rtn.emplace_back (entry.path().string());
+            }
+        }
+
+        // directory iteration order is unspecified, make it repeatable
+        std::sort (rtn.begin(), rtn.end());
+
+        return rtn;
+    }
+
+    glob_t matches { };
+
+    switch (::glob (arg_.c_str(), 0, nullptr, &matches)) {
+        case 0 :
+            for (size_t i { 0 } ; i < matches.gl_pathc ; ++i) {
+                rtn.emplace_back (matches.gl_pathv[i]);
+            }
+            break;
+        case GLOB_NOMATCH :
+            break;
+        default :
+            globfree (&matches);
+            throw std::runtime_error ("Failed to expand " + arg_);
+    }
+
+    globfree (&matches);
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,424 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <memory>
+
+#include "Archive.h"
+#include "FileReader.h"
+#include "Checkpoint.h"
+#include "Compressor.h"
+
+#include "tape/Tape.h"
+
+/******************************************************************************/
+
+class Memo;
+class Filter;
+class Snapshot;
+class Aggregate;
+class CordaBytes;
+class BlobInspector;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::cursor {
+
+    class Limits;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Decodes many blobs at once, spread over a pool of workers, writing one
+ * line of JSON per blob. Every worker shares the process wide reader
+ * cache so a schema is only ever compiled once no matter how many of the
+ * blobs use it.
+ *
+ * Each line is an object naming the blob's file alongside either its
+ * "Parsed" contents or the "error" that stopped it being decoded. As
+ * NDJSON a line holds nothing but the blob's contents, as CBOR so does
+ * each item of the CBOR sequence written in place of lines, and as CSV
+ * it is a row of the blob's file and the fields projected from it,
+ * under a header naming them. In each of these blobs that fail are
+ * reported apart from the output, so it holds nothing but records.
+ *
+ * Each worker renders into a buffer of its own that's reused for every
+ * blob it's given, so nothing is allocated per blob once they've warmed
+ * up bar the lines that, when ordered, finish ahead of their turn.
+ *
+ * Each worker opens and maps the files it's given unless they're to be
+ * read ahead, see [FileReader], the workers then decoding each blob from
+ * the buffer it was read into as soon as it arrives. *
+ * Lines are written by an [Output] of their own, a stage apart from the
+ * workers, which holds back the files still to be decoded once a window
+ * of lines is waiting to be written. A slow output then slows everything
+ * before it rather than the lines it's behind on piling up.
+ *
+ * Aggregating, no line is written per blob, each worker instead adding
+ * it to totals of its own, the totals being merged and written once the
+ * last blob's done.
+ *
+ * Routed, each blob's line is written instead to a file of its own
+ * type's, on the same writer, so a warehouse loading a table per type
+ * needn't sort the output first.
+ *
+ * A file named as a [Snapshot] is, ending ".tape", is mapped and its
+ * projections, filters and aggregations replayed from the tape it holds
+ * rather than anything being decoded, even when other files are read
+ * ahead. It's written as it was decoded when saved, whatever the batch
+ * is told of pointers, sampling or nesting, and never memoised.
+ */
+class Batch {
+    public :
+        enum Format { json_t, ndjson_t, csv_t, cbor_t };
+
+        /**
+         * Lines per worker that may wait to be written by default
+         */
+        static constexpr size_t WINDOW = 16;
+
+        struct Options {
+            size_t m_threads { 0 };
+
+            /**
+             * Write the lines in the order the files were given rather
+             * than as each finishes
+             */
+            bool m_ordered { true };
+
+            /**
+             * When not empty only these fields are decoded from each blob,
+             * see [BlobInspector::project]
+             */
+            std::vector<std::string> m_paths;
+
+            /**
+             * When set only blobs it matches are written, the rest being
+             * dropped without a line and without counting as failures
+             */
+            std::shared_ptr<const Filter> m_where;
+
+            /**
+             * See [BlobInspector::pointers]
+             */
+            bool m_pointers { false };
+
+            /**
+             * See [BlobInspector::sample]
+             */
+            size_t m_sample { 0 };
+            bool m_uniform { false };
+
+            /**
+             * See [BlobInspector::nested]
+             */
+            bool m_nested { false };
+
+            /**
+             * When set what each blob may use before it's abandoned as
+             * a failure, see [BlobInspector::limits]
+             */
+            std::shared_ptr<const amqp::internal::cursor::Limits> m_limits;
+
+            /**
+             * Check each blob is well formed before decoding it, see
+             * [amqp::internal::cursor::validate]
+             */
+            bool m_validate { true };
+
+            /**
+             * When not zero the output of this many distinct blobs is
+             * kept, see [Memo], a blob identical to one of them being
+             * written without being decoded. Not for CSV, whose rows
+             * are cheap to project anyway
+             */
+            size_t m_memo { 0 };
+
+            /**
+             * CSV needs [m_paths] to give it its columns
+             */
+            Format m_format { json_t };
+
+            /**
+             * When not zero files are read ahead by a [FileReader]
+             * keeping this many reads in flight
+             */
+            size_t m_depth { 0 };
+
+            FileReader::Backend m_io { FileReader::any_t };
+
+            /**
+             * What blobs read ahead are read into
+             */
+            Pages::Kind m_pages { Pages::normal_t };
+
+            /**
+             * Pin the workers across the machine's NUMA nodes, each blob
+             * read ahead being read into memory on the node of the worker
+             * it's given to
+             */
+            bool m_numa { false };
+
+            /**
+             * How many lines may be decoded ahead of being written, zero
+             * being [WINDOW] for each worker
+             */
+            size_t m_window { 0 };
+
+            /**
+             * Write only each blob's outermost type, its name and its
+             * descriptor, read from the envelope and schema without
+             * either being decoded, see [BlobInspector::type]
+             */
+            bool m_peek { false };
+
+            /**
+             * When not empty the directory each blob's line is written to
+             * a file of, by its outermost type, see [m_routes], rather than
+             * to the output. Blobs that fail are always reported apart
+             */
+            std::string m_route;
+
+            /**
+             * The file, sans extension, each type's lines are routed to,
+             * "*" naming where types not given go. Without it they go to
+             * a file named for the type
+             */
+            std::map<std::string, std::string> m_routes;
+
+            /**
+             * When set every blob is added to its totals, decoding only
+             * what they need, and once done those are written in place
+             * of the blobs, a line per group. Blobs that fail are then
+             * reported apart. Not for CSV
+             */
+            std::shared_ptr<Aggregate> m_aggregate;
+
+            /**
+             * When set each blob written is recorded in it, see
+             * [Checkpoint], and those it has recorded are skipped, the
+             * run that recorded them being carried on with. Not when
+             * routing or aggregating
+             */
+            std::shared_ptr<Checkpoint> m_checkpoint;
+
+            /**
+             * With [m_checkpoint] only the blobs changed since it recorded
+             * them are written. Those whose size and modification time
+             * are as recorded are skipped without being read, the rest
+             * should their contents hash as they did
+             */
+            bool m_incremental { false };
+
+            /**
+             * Where the output already stands, the offset [m_checkpoint]
+             * records lines from. A CSV header is only written from the
+             * start
+             */
+            uint64_t m_offset { 0 };
+
+            /**
+             * When set the blobs are read out of it, one after another,
+             * rather than from the batch's files, each line naming its
+             * entry in the archive. Not with [m_checkpoint]
+             */
+            std::shared_ptr<Archive> m_archive;
+
+            /**
+             * How the output's compressed, on the batch's own workers,
+             * see [Compressor], [m_level] being the format's default
+             * when zero. Not with [m_checkpoint] or when routing
+             */
+            Compressor::Kind_t m_compress { Compressor::none_t };
+            int m_level { 0 };
+
+            /**
+             * CBOR output writes each blob's repeated strings as
+             * references, see [CborSink::stringrefs]
+             */
+            bool m_dictionary { false };
+
+            /**
+             * Start the largest files first, see [Schedule]. Not for
+             * files read ahead or archives, which are read in order
+             */
+            bool m_largest { false };
+
+            /**
+             * When not zero blobs of at least this many bytes have their
+             * large lists decoded across the batch's [m_threads] workers,
+             * see [BlobInspector::threads]
+             */
+            uint64_t m_split { 0 };
+        };
+
+    private :
+        std::vector<std::string> m_files;
+        Options m_options;
+
+        /**
+         * Where, as CSV, each column's field is found
+         */
+        std::vector<std::string> m_columns;
+
+        std::shared_ptr<Memo> m_memo;
+
+        /**
+         * The workers of whichever [run] is under way, the large lists
+         * of its blobs being split across them rather than across a pool
+         * per blob
+         */
+        mutable WorkStealingPool * m_pool { nullptr };
+
+        /**
+         * [m_paths] and those of the filter and the aggregate, as a
+         * snapshot's tape is projected onto
+         */
+        std::shared_ptr<const amqp::internal::tape::Tape::Paths> m_projected;
+        std::shared_ptr<const amqp::internal::tape::Tape::Paths> m_tested;
+        std::shared_ptr<const amqp::internal::tape::Tape::Paths> m_summed;
+
+        /**
+         * Apply the options that say how a blob's written to [inspector_]
+         */
+        BlobInspector & configure (BlobInspector & inspector_) const;
+
+        /**
+         * Write just the blob's contents, as NDJSON and CBOR do
+         */
+        void contents (BlobInspector &, amqp::reader::ISink &) const;
+        void contents (const Snapshot &, amqp::reader::ISink &) const;
+
+        static bool render (
+            CordaBytes &,
+            BlobInspector &,
+            const std::string & name_,
+            std::string & line_,
+            const std::vector<std::string> & paths_,
+            std::string * error_);
+
+        /**
+         * Where the line goes, [route_] being left empty when not routing
+         */
+        bool route (CordaBytes &, std::string & route_, std::string & error_) const;
+        bool route (std::string type_, std::string & route_, std::string & error_) const;
+
+        /**
+         * When [record_]'s given it's left holding what [m_checkpoint]'s
+         * to record of the blob, which, should it be unchanged, isn't
+         * written at all
+         */
+        bool line (
+            const std::string &,
+            std::string & out_,
+            std::string & error_,
+            std::string & route_,
+            Checkpoint::Entry * record_ = nullptr) const;
+
+        bool line (
+            const std::string &,
+            CordaBytes &,
+            std::string & out_,
+            std::string & error_,
+            std::string & route_,
+            Checkpoint::Entry * record_ = nullptr) const;
+
+        /**
+         * The files [m_checkpoint] hasn't recorded or, when incremental,
+         * whose size or modification time has changed, statted on
+         * [threads_] threads
+         */
+        std::vector<std::string> pending (size_t threads_) const;
+
+        /**
+         * What [line] writes when peeking, the file always being named
+         * so the blobs can be told apart whatever the format
+         */
+        bool peek (const std::string &, CordaBytes &, std::string & out_, std::string & error_) const;
+
+        /**
+         * What [line] writes were there no [Memo]
+         */
+        bool decode (const std::string &, CordaBytes &, std::string & out_, std::string & error_) const;
+
+        /**
+         * What [line] writes of a [Snapshot], mapping it from the file
+         */
+        bool snapshot (
+            const std::string &,
+            std::string & out_,
+            std::string & error_,
+            std::string & route_,
+            Checkpoint::Entry * record_) const;
+
+        bool decode (const std::string &, const Snapshot &, std::string & out_, std::string & error_) const;
+
+    public :
+        Batch (std::vector<std::string>, Options);
+
+        /**
+         * Returns the number of blobs that failed to decode. As JSON
+         * those failures are lines of their own in the output, otherwise
+         * they're written to [errors_] instead
+         */
+        size_t run (std::ostream &, std::ostream & errors_) const;
+
+        size_t run (std::ostream & out_) const { return run (out_, out_); }
+
+        /**
+         * Decode a single file into its line of output, sans new line,
+         * returning false if that line reports an error, the error also
+         * being left in [error_] if given
+         */
+        static bool render (
+            const std::string &,
+            std::string & line_,
+            const std::vector<std::string> & paths_ = { },
+            bool pointers_ = false,
+            std::string * error_ = nullptr);
+
+        /**
+         * As above but for a blob already in memory, the line naming it
+         * [name_] unless that's empty
+         */
+        static bool render (
+            CordaBytes &,
+            const std::string & name_,
+            std::string & line_,
+            const std::vector<std::string> & paths_ = { },
+            bool pointers_ = false,
+            std::string * error_ = nullptr);
+
+        /**
+         * The line reporting why [name_] couldn't be decoded, unnamed if
+         * that's empty
+         */
+        static std::string error (const std::string & name_, const char * what_);
+
+        /**
+         * Read a table of routes, each line a type and the name of the
+         * file its blobs are to be written to, "#" starting a comment
+         */
+        static std::map<std::string, std::string> routes (std::istream &);
+
+        /**
+         * Turn a batch argument into the files it names. A directory is
+         * walked recursively, "-" reads a manifest of paths, one per
+         * line, from [manifest_] and anything else is treated as a glob
+         */
+        static std::vector<std::string> expand (
+            const std::string &,
+            std::istream & manifest_);
+};
+
+/******************************************************************************/
@@ -1,73 +1,988 @@
 #include "BlobInspector.h"
 #include "CordaBytes.h"
+#include "Filter.h"
+#include "Aggregate.h"
+#include "Offsets.h"
+#include "WorkStealingPool.h"
 
-#include <iostream>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <ostream>
 #include <sstream>
+#include <condition_variable>
 
-#include "proton/codec.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "cursor/Limits.h"
+#include "reader/Arena.h"
+#include "reader/Lazy.h"
+#include "reader/ObjectTable.h"
+#include "reader/Sampling.h"
+#include "reader/CompositeReader.h"
+#include "reader/restricted-readers/ListReader.h"
+#include "sink/TapeSink.h"
+#include "stats/Costs.h"
+#include "stats/Stats.h"
+#include "tape/Pointer.h"
 
 #include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
 
+#include "amqp/AMQPHeader.h"
+#include "amqp/ReaderCache.h"
 #include "amqp/CompositeFactory.h"
 #include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
 
 /******************************************************************************/
 
 BlobInspector::BlobInspector (CordaBytes & cb_)
-    : m_data { pn_data (cb_.size()) }
+    : m_blob { cb_.bytes() }
+    , m_size { cb_.size() }
+    , m_pointers { false }
+    , m_threads { 1 }
+    , m_split { SPLIT }
+    , m_pool { nullptr }
+    , m_sample { 0 }
+    , m_uniform { false }
+    , m_limits { nullptr }
+    , m_nested { false }
+    , m_depth { 0 }
 {
-    // returns how many bytes we processed which right now we don't care
-    // about but I assume there is a case where it doesn't process the
-    // entire file
-    auto rtn = pn_data_decode (m_data, cb_.bytes(), cb_.size());
-    assert (rtn == cb_.size());
+}
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+
+    /**
+     * Fetch the readers for the blob's schema. Only if this is a schema
+     * we've not seen before is it actually decoded, otherwise we skip
+     * straight over it. Then hand the reader for the blob's outer type,
+     * the cache entry it came from and the type's descriptor to [fn_]
+     * along with a cursor positioned on the payload. Decoding that's
+     * counted against [limits_], if given, the schema not being as it's
+     * only decoded for the first blob to use it
+     */
+    template<class Fn>
+    void
+    decode (const char * blob_, size_t size_, const cursor::Limits * limits_, Fn && fn_) {
+        using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+        using amqp::internal::stats::Stats;
+
+        Stats::count (Stats::blobs_t);
+
+        amqp::internal::stats::Costs::Scope cost (size_);
+
+        cursor::Cursor data (blob_, size_);
+
+        auto peek = [&data]() {
+            Stats::Timer timer (Stats::peek_t);
+            return EnvelopeDescriptor::peek (data);
+        }();
+
+        auto compiled = amqp::internal::ReaderCache::instance().fetch (
+                peek.m_schema,
+                [&data]() {
+                    Stats::Timer timer (Stats::envelope_t);
+
+                    cursor::Cursor envelope { data };
+                    cursor::auto_enter p (envelope);
+
+                    auto a = envelope.get_ulong();
+
+                    return uPtr<amqp::internal::schema::Envelope> (
+                            dynamic_cast<amqp::internal::schema::Envelope *> (
+                                    amqp::internal::AMQPDescriptorRegistory[a]->build(envelope).release()));
+                });
+
+        // reused from blob to blob, one per level of blobs nested in
+        // blobs, so a warm decode allocates nothing for it
+        static thread_local std::deque<std::string> descriptors;
+        static thread_local size_t nesting { 0 };
+
+        if (descriptors.size() == nesting) descriptors.emplace_back();
+
+        auto & descriptor = descriptors[nesting];
+        descriptor.assign (peek.m_descriptor);
+
+        struct Nested {
+            Nested() { ++nesting; }
+            ~Nested() { --nesting; }
+        } nested;
+
+        auto reader = compiled->byDescriptor (descriptor);
+        if (!reader) throw std::runtime_error ("No reader for " + descriptor);
+
+        cost.type (reader->type());
+
+        // move to the actual blob entry
+        cursor::auto_enter p (data);
+        data.next();
+        cursor::is_list (data);
+        if (data.get_list() != 3) throw std::runtime_error ("Expected an envelope of 3 fields");
+        {
+            cursor::auto_enter p (data);
+
+            Stats::Timer timer (Stats::render_t, reader->type());
+
+            std::optional<cursor::Limits::Scope> limits;
+            if (limits_) limits.emplace (*limits_);
+
+            fn_ (*reader, data, compiled, descriptor);
+        }
+    }
+
+    /**
+     * Each thread reuses a single table from blob to blob
+     */
+    amqp::internal::reader::ObjectTable &
+    objects (bool pointers_) {
+        static thread_local amqp::internal::reader::ObjectTable table;
+
+        table.clear();
+        table.pointers (pointers_);
+
+        return table;
+    }
+
+    /**
+     * Writes a value as its reader would except for the lists within it
+     * of at least [m_split] elements, not counting those inside another
+     * list, whose elements are decoded a chunk at a time on the pool's
+     * workers, each chunk into its own tape. Those are written out in
+     * order as each is finished so only the sink is left to a single
+     * thread.
+     *
+     * Each worker numbers the objects of its chunk in a table of its
+     * own so this is only for blobs holding no references.
+     *
+     * The pool can be a batch's, this itself running on one of its
+     * workers, so nothing waits on chunks that haven't been started.
+     * Whichever chunk is to be written next and hasn't been taken by a
+     * worker is decoded by the thread writing them instead.
+     */
+    class Splitter {
+        private :
+            using Reader = amqp::internal::reader::Reader;
+            using SchemaType = amqp::internal::reader::ObjectTable::SchemaType;
+
+            const SchemaType & m_schema;
+            const char * m_blob;
+            size_t m_size;
+            size_t m_threads;
+            size_t m_split;
+
+            /**
+             * The pool given or, without one, a pool of [m_threads] of
+             * its own started by the first list long enough to split
+             */
+            WorkStealingPool * m_pool;
+            std::unique_ptr<WorkStealingPool> m_owned;
+
+            void composite (
+                const amqp::internal::reader::CompositeReader &,
+                cursor::Cursor &,
+                amqp::reader::ISink &);
+
+            void list (
+                const amqp::internal::reader::ListReader &,
+                cursor::Cursor &,
+                amqp::reader::ISink &);
+
+        public :
+            Splitter (
+                const SchemaType & schema_,
+                const char * blob_,
+                size_t size_,
+                size_t threads_,
+                size_t split_,
+                WorkStealingPool * pool_
+            ) : m_schema (schema_)
+              , m_blob (blob_)
+              , m_size (size_)
+              , m_threads (pool_ ? pool_->size() : threads_)
+              , m_split (std::max<size_t> (split_, 1))
+              , m_pool (pool_)
+            { }
+
+            void write (const Reader &, cursor::Cursor &, amqp::reader::ISink &);
+    };
+
+    /**
+     * A list or composite is described, anything else, nulls included,
+     * is left to its reader
+     */
+    void
+    Splitter::write (
+        const Reader & reader_,
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_
+    ) {
+        using namespace amqp::internal::reader;
+
+        if (data_.is_described()) {
+            if (auto l = dynamic_cast<const ListReader *> (&reader_)) {
+                cursor::Cursor peek { data_ };
+                peek.enter();
+                peek.next();
+                peek.next();
+
+                if (peek.get_list() >= m_split) {
+                    list (*l, data_, sink_);
+                    return;
+                }
+            } else if (auto c = dynamic_cast<const CompositeReader *> (&reader_)) {
+                composite (*c, data_, sink_);
+                return;
+            }
+        }
+
+        ObjectTable::write (reader_, data_, sink_, m_schema, false);
+    }
+
+    /**
+     * As [CompositeReader::write] but each field through [write]
+     */
+    void
+    Splitter::composite (
+        const amqp::internal::reader::CompositeReader & reader_,
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_
+    ) {
+        using amqp::internal::stats::Stats;
+
+        cursor::auto_next an (data_);
+
+        cursor::is_described (data_);
+        cursor::auto_enter ae (data_);
+
+        reader_.enter (data_, m_schema);
+
+        const auto & names = reader_.names();
+
+        cursor::is_list (data_);
+        cursor::auto_enter ae2 (data_);
+
+        Stats::count (Stats::objects_t);
+        Stats::count (Stats::fields_t, names.size());
+
+        sink_.beginObject();
+
+        for (size_t i { 0 } ; i < names.size() ; ++i) {
+            auto l = reader_.readers()[i];
+
+            if (!l) throw std::runtime_error ("null field reader: " + names[i]);
+
+            sink_.key (names[i]);
+            write (*l, data_, sink_);
+        }
+
+        sink_.endObject();
+    }
+
+    /**
+     * The chunk boundaries are found by skipping over the elements, by
+     * their encoded sizes, before any are decoded
+     */
+    void
+    Splitter::list (
+        const amqp::internal::reader::ListReader & reader_,
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_
+    ) {
+        using namespace amqp::internal;
+        using stats::Stats;
+
+        cursor::auto_next an (data_);
+        cursor::is_described (data_);
+
+        cursor::auto_enter ae (data_);
+        cursor::readAndNext<std::string_view>(data_);
+
+        cursor::auto_list_enter ale (data_, true);
+
+        const size_t elements = ale.elements();
+
+        Stats::count (Stats::elements_t, elements);
+
+        auto element = reader_.reader();
+        if (!element) throw std::runtime_error ("null element reader");
+
+        if (!m_pool) {
+            m_owned = std::make_unique<WorkStealingPool> (m_threads);
+            m_pool = m_owned.get();
+        }
+
+        /*
+         * A few chunks a worker so one that's slow to decode doesn't
+         * hold up the rest
+         */
+        const auto per = std::max<size_t> (1, (elements + m_threads * 4 - 1) / (m_threads * 4));
+        const auto chunks = (elements + per - 1) / per;
+
+        std::vector<cursor::Cursor> starts;
+        starts.reserve (chunks);
+
+        for (size_t i { 0 } ; i < chunks ; ++i) {
+            starts.push_back (data_);
+            data_.skip (per);
+        }
+
+        /*
+         * Shared with the tasks, as those still queued when this returns
+         * run later, finding their chunks taken
+         */
+        struct Chunks {
+            std::mutex m_lock;
+            std::condition_variable m_finished;
+
+            std::vector<char> m_taken;
+            std::vector<char> m_done;
+            std::vector<std::unique_ptr<tape::Tape>> m_tapes;
+            std::vector<std::exception_ptr> m_errors;
+
+            explicit Chunks (size_t chunks_)
+                : m_taken (chunks_, 0)
+                , m_done (chunks_, 0)
+                , m_tapes (chunks_)
+                , m_errors (chunks_)
+            { }
+
+            bool take (size_t i_) {
+                std::lock_guard<std::mutex> guard (m_lock);
+                return !std::exchange (m_taken[i_], 1);
+            }
+        };
+
+        auto shared = std::make_shared<Chunks> (chunks);
+
+        auto decode = [&, this](size_t i_) {
+            try {
+                auto rtn = std::make_unique<tape::Tape> (m_blob, m_size);
+
+                reader::ObjectTable table;
+                reader::ObjectTable::Scope scope (table);
+
+                sink::TapeSink sink (*rtn);
+                cursor::Cursor data { starts[i_] };
+
+                const auto last = std::min (elements, (i_ + 1) * per);
+
+                for (auto j { i_ * per } ; j < last ; ++j) {
+                    reader::ObjectTable::write (*element, data, sink, m_schema, true);
+                }
+
+                shared->m_tapes[i_] = std::move (rtn);
+            } catch (...) {
+                shared->m_errors[i_] = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> guard (shared->m_lock);
+                shared->m_done[i_] = 1;
+            }
+
+            shared->m_finished.notify_all();
+        };
+
+        /*
+         * However this returns the chunks not yet taken never will be,
+         * and those that were are finished, before what they decode from
+         * goes
+         */
+        struct Settle {
+            Chunks & m_chunks;
+
+            ~Settle() {
+                std::unique_lock<std::mutex> guard (m_chunks.m_lock);
+
+                for (size_t i { 0 } ; i < m_chunks.m_taken.size() ; ++i) {
+                    if (!std::exchange (m_chunks.m_taken[i], 1)) m_chunks.m_done[i] = 1;
+                }
+
+                m_chunks.m_finished.wait (guard, [this]() {
+                    return std::all_of (m_chunks.m_done.begin(), m_chunks.m_done.end(),
+                            [](char done_) { return done_ != 0; });
+                });
+            }
+        } settle { *shared };
+
+        for (size_t i { 0 } ; i < chunks ; ++i) {
+            m_pool->submit ([shared, decode, i]() {
+                if (shared->take (i)) decode (i);
+            });
+        }
+
+        sink_.beginList();
+
+        for (size_t i { 0 } ; i < chunks ; ++i) {
+            if (shared->take (i)) {
+                decode (i);
+            } else {
+                std::unique_lock<std::mutex> guard (shared->m_lock);
+                shared->m_finished.wait (guard, [&]() { return shared->m_done[i] != 0; });
+            }
+
+            if (shared->m_errors[i]) std::rethrow_exception (shared->m_errors[i]);
+
+            shared->m_tapes[i]->write (sink_);
+            shared->m_tapes[i].reset();
+        }
+
+        sink_.endList();
+    }
+
 }
 
 /******************************************************************************/
 
 std::string
 BlobInspector::dump() {
-    std::unique_ptr<amqp::internal::schema::Envelope> envelope;
+    /*
+     * The tree of values only lives long enough to be rendered so build
+     * it in an arena, each thread reusing its own from blob to blob
+     */
+    static thread_local amqp::internal::reader::Arena arena;
+
+    struct Reset {
+        amqp::internal::reader::Arena & m_arena;
+        ~Reset() { m_arena.reset(); }
+    } reset { arena };
+
+    amqp::internal::reader::Arena::Scope scope (arena);
+    amqp::internal::reader::ObjectTable::Scope objects (::objects (m_pointers));
+
+    std::stringstream ss;
+
+    decode (m_blob, m_size, m_limits, [&ss](auto & reader_, auto & data_, auto & entry_, auto &) {
+        // We wrap our output like this to make sure it's valid JSON to
+        // facilitate easy pretty printing
+        static const std::string parsed { "{ Parsed" };
+
+        ss << reader_.dump (parsed, data_, entry_->schema())->dump()
+           << " }";
+    });
+
+    return ss.str();
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+BlobInspector::values() {
+    amqp::internal::reader::ObjectTable::Scope objects (::objects (m_pointers));
+
+    uPtr<amqp::reader::IValue> rtn;
+
+    decode (m_blob, m_size, m_limits, [&rtn](auto & reader_, auto & data_, auto & entry_, auto &) {
+        static const std::string parsed { "Parsed" };
+
+        rtn = reader_.dump (parsed, data_, entry_->schema());
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string
+BlobInspector::descriptor() const {
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    cursor::Cursor data (m_blob, m_size);
+
+    return std::string (EnvelopeDescriptor::peek (data).m_descriptor);
+}
+
+/******************************************************************************/
+
+bool
+BlobInspector::warm() const {
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    cursor::Cursor data (m_blob, m_size);
 
-    if (pn_data_is_described (m_data)) {
-        proton::auto_enter p (m_data);
+    auto peek = EnvelopeDescriptor::peek (data);
+    auto entry = amqp::internal::ReaderCache::instance().find (peek.m_schema);
+
+    if (!entry) return false;
+
+    static thread_local std::string descriptor;
+    descriptor.assign (peek.m_descriptor);
+
+    return entry->ready (descriptor);
+}
+
+/******************************************************************************/
+
+std::string
+BlobInspector::type() const {
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    cursor::Cursor data (m_blob, m_size);
+
+    return std::string (EnvelopeDescriptor::type (EnvelopeDescriptor::peek (data)));
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::write (amqp::reader::ISink & sink_) {
+    sink_.beginObject();
+    writeFields (sink_);
+    sink_.endObject();
+}
+
+/******************************************************************************/
 
-        auto a = pn_data_get_ulong(m_data);
+bool
+BlobInspector::references() const {
+    const std::string_view blob (m_blob, m_size);
 
-        envelope.reset (
-                dynamic_cast<amqp::internal::schema::Envelope *> (
-                        amqp::internal::AMQPDescriptorRegistory[a]->build(m_data).release()));
+    for (auto at = blob.find ("\x00\x80", 0, 2) ; at != std::string_view::npos && at + 10 <= m_size ;
+        at = blob.find ("\x00\x80", at + 1, 2))
+    {
+        if (amqp::internal::reader::ObjectTable::isReference (blob.substr (at))) return true;
     }
 
-    amqp::internal::CompositeFactory cf;
+    return false;
+}
+
+/******************************************************************************/
+
+/**
+ * Passes everything on as it is except binaries, which are decoded in
+ * place should they hold a blob
+ */
+class BlobInspector::Nesting : public amqp::reader::ISink {
+    private :
+        amqp::reader::ISink & m_sink;
+        const BlobInspector & m_outer;
+
+        bool decode (std::string_view, const std::vector<std::string> * paths_);
+
+    public :
+        Nesting (amqp::reader::ISink & sink_, const BlobInspector & outer_)
+            : m_sink (sink_)
+            , m_outer (outer_)
+        { }
+
+        void beginObject() override { m_sink.beginObject(); }
+        void endObject() override { m_sink.endObject(); }
+        void beginList() override { m_sink.beginList(); }
+        void endList() override { m_sink.endList(); }
+        void beginMap() override { m_sink.beginMap(); }
+        void endMap() override { m_sink.endMap(); }
+
+        void key (std::string_view key_) override { m_sink.key (key_); }
+        void key (const Key & key_) override { m_sink.key (key_); }
 
-    cf.process (envelope->schema());
+        void null() override { m_sink.null(); }
+        void boolean (bool v_) override { m_sink.boolean (v_); }
+        void integer (int64_t v_) override { m_sink.integer (v_); }
+        void real (double v_) override { m_sink.real (v_); }
+        void string (std::string_view v_) override { m_sink.string (v_); }
+
+        void integers (const int64_t * v_, size_t n_) override { m_sink.integers (v_, n_); }
+        void reals (const double * v_, size_t n_) override { m_sink.reals (v_, n_); }
+
+        void symbol (std::string_view v_) override { m_sink.symbol (v_); }
+
+        void binary (std::string_view v_) override {
+            if (!decode (v_, nullptr)) m_sink.binary (v_);
+        }
+
+        void nested (std::string_view v_, const std::vector<std::string> & paths_) override {
+            if (!decode (v_, &paths_)) m_sink.binary (v_);
+        }
+
+        bool hashes() const override { return m_sink.hashes(); }
+        void hash (uint64_t low_, uint64_t high_) override { m_sink.hash (low_, high_); }
+};
+
+/******************************************************************************/
 
-    auto reader = cf.byDescriptor (envelope->descriptor());
-    assert (reader);
+/**
+ * Only a blob that's well formed throughout is decoded, so nothing's
+ * written for one that then turns out not to be
+ */
+bool
+BlobInspector::Nesting::decode (std::string_view bytes_, const std::vector<std::string> * paths_) {
+    const auto & header = amqp::AMQP_HEADER;
 
+    if (m_outer.m_depth >= NESTING
+        || bytes_.size() <= header.size()
+        || !std::equal (header.begin(), header.end(), bytes_.begin()))
     {
-        // move to the actual blob entry in the tree - ideally we'd have
-        // saved this on the Envelope but that's not easily doable as we
-        // can't grab an actual copy of our data pointer
-        proton::auto_enter p (m_data);
-        pn_data_next (m_data);
-        proton::is_list (m_data);
-        assert (pn_data_get_list (m_data) == 3);
+        return false;
+    }
+
+    std::optional<CordaBytes> cb;
+
+    try {
+        cb.emplace (bytes_.data(), bytes_.size());
+    } catch (const std::runtime_error &) {
+        return false;
+    }
+
+    if (cb->encoding() != amqp::DATA_AND_STOP || !cursor::validate (cb->bytes(), cb->size())) {
+        return false;
+    }
+
+    BlobInspector inner (*cb);
+    inner.pointers (m_outer.m_pointers).limits (m_outer.m_limits).nested (true);
+    inner.m_depth = m_outer.m_depth + 1;
+
+    inner.writeNested (m_sink, paths_);
+
+    return true;
+}
+
+/******************************************************************************/
+
+/**
+ * Objects are numbered afresh within each blob, the table of the blob
+ * it's nested in being left as it was
+ */
+void
+BlobInspector::writeNested (amqp::reader::ISink & sink_, const std::vector<std::string> * paths_) {
+    amqp::internal::reader::ObjectTable table (m_pointers);
+    amqp::internal::reader::ObjectTable::Scope objects (table);
+
+    Nesting nesting (sink_, *this);
+
+    decode (m_blob, m_size, m_limits, [&nesting, paths_](
+            auto & reader_, auto & data_, auto & entry_, auto & descriptor_)
+    {
+        if (!paths_) {
+            reader_.write (data_, nesting, entry_->schema());
+            return;
+        }
+
+        std::shared_ptr<const amqp::internal::reader::Projection> projection;
+
+        try {
+            projection = entry_->projection (descriptor_, *paths_);
+        } catch (const std::runtime_error &) {
+            std::vector<std::string> present;
+
+            for (const auto & path : *paths_) {
+                try {
+                    entry_->projection (descriptor_, { path });
+                    present.push_back (path);
+                } catch (const std::runtime_error &) {
+                }
+            }
+
+            if (present.empty()) {
+                nesting.null();
+                return;
+            }
+
+            projection = entry_->projection (descriptor_, present);
+        }
+
+        projection->write (data_, nesting, entry_->schema());
+    });
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::writeFields (amqp::reader::ISink & sink_) {
+    if (!m_nested) {
+        decodeFields (sink_);
+        return;
+    }
+
+    Nesting nesting (sink_, *this);
+    decodeFields (nesting);
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::decodeFields (amqp::reader::ISink & sink_) {
+    using amqp::internal::reader::Sampling;
+
+    amqp::internal::reader::ObjectTable::Scope objects (::objects (m_pointers));
+
+    /*
+     * Sampling is left to the readers, the program writing everything
+     */
+    if (m_sample > 0) {
+        Sampling sampling (m_uniform ? Sampling::uniform_t : Sampling::first_t, m_sample, references());
+        Sampling::Scope scope (sampling);
+
+        decode (m_blob, m_size, m_limits, [&sink_](auto & reader_, auto & data_, auto & entry_, auto &) {
+            reader_.write ("Parsed", data_, sink_, entry_->schema());
+        });
+
+        return;
+    }
+
+    /*
+     * As are hashes, which only the readers work out
+     */
+    if (sink_.hashes()) {
+        decode (m_blob, m_size, m_limits, [&sink_](auto & reader_, auto & data_, auto & entry_, auto &) {
+            reader_.write ("Parsed", data_, sink_, entry_->schema());
+        });
+
+        return;
+    }
+
+    if ((m_pool ? m_pool->size() : m_threads) > 1 && !m_limits && !references()) {
+        decode (m_blob, m_size, m_limits, [this, &sink_](
+                auto & reader_, auto & data_, auto & entry_, auto &)
         {
-            proton::auto_enter p (m_data);
+            sink_.key ("Parsed");
+            Splitter (entry_->schema(), m_blob, m_size, m_threads, m_split, m_pool).write (
+                    dynamic_cast<const amqp::internal::reader::Reader &> (reader_), data_, sink_);
+        });
+
+        return;
+    }
+
+    decode (m_blob, m_size, m_limits, [&sink_](
+            auto & reader_, auto & data_, auto & entry_, auto & descriptor_)
+    {
+        if (auto program = entry_->program (descriptor_)) {
+            sink_.key ("Parsed");
+            program->write (data_, sink_);
+        } else {
+            reader_.write ("Parsed", data_, sink_, entry_->schema());
+        }
+    });
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::visit (amqp::reader::IVisitor & visitor_) {
+    amqp::internal::reader::ObjectTable::Scope objects (::objects (false));
 
-            std::stringstream ss;
+    decode (m_blob, m_size, m_limits, [&visitor_](
+            auto & reader_, auto & data_, auto & entry_, auto &)
+    {
+        reader_.visit ("Parsed", data_, visitor_, entry_->schema());
+    });
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+BlobInspector::lazy() {
+    uPtr<amqp::internal::reader::Lazy> rtn;
+
+    decode (m_blob, m_size, m_limits, [&rtn](
+            auto & reader_, auto & data_, auto & entry_, auto &)
+    {
+        static const std::string parsed { "Parsed" };
+
+        rtn = std::make_unique<amqp::internal::reader::Lazy> (
+                parsed,
+                dynamic_cast<const amqp::internal::reader::Reader &> (reader_),
+                data_, entry_->schema(), entry_);
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::aggregate (Aggregate & aggregate_) {
+    decode (m_blob, m_size, m_limits, [&aggregate_](
+            auto &, auto & data_, auto & entry_, auto & descriptor_)
+    {
+        const auto * fields = aggregate_.fields (descriptor_);
+
+        // as for a filter, whatever the type hasn't got is left out
+        if (!fields) {
+            std::vector<std::string> present;
+
+            for (const auto & path : aggregate_.paths()) {
+                try {
+                    entry_->projection (descriptor_, { path });
+                    present.push_back (path);
+                } catch (const std::runtime_error &) {
+                }
+            }
+
+            fields = &aggregate_.fields (descriptor_, std::move (present));
+        }
+
+        aggregate_.add ([&](amqp::reader::ISink & sink_) {
+            if (fields->empty()) return;
+            entry_->projection (descriptor_, *fields)->write (data_, sink_, entry_->schema());
+        });
+    });
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+BlobInspector::at (const std::string & path_, const Offsets * offsets_) {
+    auto rtn = lazy();
+    const auto * node = offsets_ ? &offsets_->root() : nullptr;
+
+    auto bytes = [this](const Offsets::Node & node_) {
+        return std::string_view (m_blob + node_.m_offset, node_.m_size);
+    };
+
+    auto element = [&](size_t n_) {
+        const Offsets::Node * next { nullptr };
+
+        if (node) next = offsets_->child (*node, n_);
+        rtn = next ? rtn->element (n_, bytes (*next)) : rtn->element (n_);
+        node = next;
+    };
+
+    auto field = [&](std::string_view name_) {
+        const Offsets::Node * next { nullptr };
+
+        if (node) next = offsets_->child (*node, rtn->index (name_));
+        rtn = next ? rtn->field (name_, bytes (*next)) : rtn->field (name_);
+        node = next;
+    };
+
+    // a JSON pointer, every token that reads as an index being one unless it's a field's name
+    if (!path_.empty() && path_[0] == '/') {
+        for (const auto & token : amqp::internal::tape::Pointer (path_)) {
+            if (token.index() != amqp::internal::tape::Pointer::npos
+                && !dynamic_cast<const amqp::internal::reader::CompositeReader *> (&rtn->reader()))
+            {
+                element (token.index());
+            } else {
+                field (token.name());
+            }
+        }
+
+        return rtn;
+    }
+
+    for (size_t i { 0 } ; i < path_.size() ; ) {
+        if (path_[i] == '[') {
+            auto close = path_.find (']', i);
+
+            if (close == std::string::npos || close == i + 1
+                || path_.find_first_not_of ("0123456789", i + 1) != close)
+            {
+                throw std::runtime_error ("Bad path \"" + path_ + "\"");
+            }
+
+            auto n = std::stoul (path_.substr (i + 1, close - i - 1));
+            i = close + 1;
 
-            // We wrap our output like this to make sure it's valid JSON to
-            // facilitate easy pretty printing
-            ss << reader->dump ("{ Parsed", m_data, envelope->schema())->dump()
-               << " }";
+            element (n);
+        } else {
+            if (i > 0 && path_[i] == '.') ++i;
 
-            return ss.str();
+            auto end = std::min (path_.find_first_of (".[", i), path_.size());
+
+            if (end == i) throw std::runtime_error ("Bad path \"" + path_ + "\"");
+
+            auto name = std::string_view (path_).substr (i, end - i);
+            i = end;
+
+            field (name);
         }
     }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape
+BlobInspector::tape (bool hashes_) {
+    amqp::internal::tape::Tape rtn (m_blob, m_size);
+
+    {
+        amqp::internal::sink::TapeSink sink (rtn, hashes_);
+        write (sink);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::project (
+    amqp::reader::ISink & sink_,
+    const std::vector<std::string> & paths_
+) {
+    sink_.beginObject();
+    projectFields (sink_, paths_);
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+void
+BlobInspector::projectFields (
+    amqp::reader::ISink & sink_,
+    const std::vector<std::string> & paths_
+) {
+    std::optional<Nesting> nesting;
+    if (m_nested) nesting.emplace (sink_, *this);
+
+    auto & sink = nesting ? static_cast<amqp::reader::ISink &> (*nesting) : sink_;
+
+    decode (m_blob, m_size, m_limits, [&sink, &paths_](
+            auto &, auto & data_, auto & entry_, auto & descriptor_)
+    {
+        sink.key ("Parsed");
+        entry_->projection (descriptor_, paths_)->write (data_, sink, entry_->schema());
+    });
+}
+
+/******************************************************************************/
+
+bool
+BlobInspector::matches (const Filter & filter_) {
+    bool rtn { false };
+
+    decode (m_blob, m_size, m_limits, [&filter_, &rtn](
+            auto &, auto & data_, auto & entry_, auto & descriptor_)
+    {
+        const auto * fields = filter_.fields (descriptor_);
+
+        /*
+         * Leave out whatever the type hasn't got, worked out the first
+         * time it's seen, those predicates then holding for nothing
+         */
+        if (!fields) {
+            std::vector<std::string> present;
+
+            for (const auto & path : filter_.paths()) {
+                try {
+                    entry_->projection (descriptor_, { path });
+                    present.push_back (path);
+                } catch (const std::runtime_error &) {
+                }
+            }
+
+            fields = &filter_.fields (descriptor_, std::move (present));
+        }
+
+        rtn = filter_.evaluate ([&](amqp::reader::ISink & sink_) {
+            if (fields->empty()) return;
+            entry_->projection (descriptor_, *fields)->write (data_, sink_, entry_->schema());
+        });
+    });
+
+    return rtn;
 }
 
 /******************************************************************************/
@@ -1,23 +1,269 @@
 #pragma once
 
 #include <iosfwd>
+#include <string>
+#include <vector>
 #include "CordaBytes.h"
 
+#include "types.h"
+
+#include "amqp/reader/ISink.h"
+#include "amqp/reader/IVisitor.h"
+#include "tape/Tape.h"
+
 /******************************************************************************/
 
-struct pn_data_t;
+class Filter;
+class Offsets;
+class Aggregate;
+class WorkStealingPool;
+
+namespace amqp::reader {
+
+    class IValue;
+
+}
+
+namespace amqp::internal::reader {
+
+    class Lazy;
+
+}
+
+namespace amqp::internal::cursor {
+
+    class Limits;
+
+}
 
 /******************************************************************************/
 
+/**
+ * Decodes straight from the bytes held by the CordaBytes it was built from,
+ * which must therefore outlive it.
+ *
+ * Referenced objects are expanded into the value they refer to by [dump],
+ * [write], [visit] and [tape]. Neither [lazy] nor [project] decode enough
+ * of a blob to know what a reference refers to and so throw on meeting
+ * one.
+ */
 class BlobInspector {
     private :
-        pn_data_t * m_data;
+        const char * m_blob;
+        size_t m_size;
+        bool m_pointers;
+        size_t m_threads;
+        size_t m_split;
+        WorkStealingPool * m_pool;
+        size_t m_sample;
+        bool m_uniform;
+        const amqp::internal::cursor::Limits * m_limits;
+        bool m_nested;
+
+        /**
+         * How many blobs this one is nested within
+         */
+        size_t m_depth;
+
+        class Nesting;
+
+        /**
+         * What [writeFields] writes whether or not blobs are nested
+         */
+        void decodeFields (amqp::reader::ISink &);
+
+        /**
+         * Write the value of a blob nested in another, or just the
+         * [paths_] of it that it has if given, without a "Parsed" key
+         */
+        void writeNested (amqp::reader::ISink &, const std::vector<std::string> * paths_);
 
     public :
         BlobInspector (CordaBytes &);
 
+        /**
+         * The payload's size, in bytes
+         */
+        size_t size() const { return m_size; }
+
+        /**
+         * Whether anywhere in the blob looks like a REFERENCED_OBJECT,
+         * which only a single pass through it can resolve
+         */
+        bool references() const;
+
+        /**
+         * Write a referenced object as { "$ref" : n }, n being the index of
+         * what it refers to in the order the blob's objects were numbered,
+         * rather than expanding it. Visitors always see the expansion
+         */
+        BlobInspector & pointers (bool pointers_) {
+            m_pointers = pointers_;
+            return *this;
+        }
+
+        /**
+         * Lists of at least [SPLIT] elements that [write] meets outside
+         * of any other list have their elements decoded on [threads_]
+         * workers, a chunk apiece, the chunks then being written out in
+         * order. Blobs holding references are always written by a single
+         * pass as their objects must be numbered in order
+         */
+        BlobInspector & threads (size_t threads_, size_t split_ = SPLIT) {
+            m_threads = threads_;
+            m_split = split_;
+            m_pool = nullptr;
+            return *this;
+        }
+
+        /**
+         * As above but on [pool_]'s workers, a batch's say, rather than
+         * on a pool of the blob's own. Whatever of a list no worker has
+         * started by the time it's needed is decoded by the writer, so
+         * this can be written from one of [pool_]'s own tasks
+         */
+        BlobInspector & threads (WorkStealingPool & pool_, size_t split_ = SPLIT) {
+            m_pool = &pool_;
+            m_split = split_;
+            return *this;
+        }
+
+        static constexpr size_t SPLIT = 4096;
+
+        /**
+         * Have [write] and [project] decode any binary holding a blob of
+         * its own, a Corda header, schema and all, in place of its bytes,
+         * with the same options and reader cache, and those within it
+         * too up to [NESTING] deep. A projection's paths then run on into
+         * them, each nested blob giving whichever it has or, having none,
+         * null. A binary that merely looks like a blob, failing to
+         * validate, is left as it is
+         */
+        BlobInspector & nested (bool nested_) {
+            m_nested = nested_;
+            return *this;
+        }
+
+        static constexpr size_t NESTING = 16;
+
+        /**
+         * Abandon a decode that goes over any of [limits_], which must
+         * outlive this, with an [amqp::internal::cursor::Limits::Exceeded].
+         * Limited, large lists aren't split over threads
+         */
+        BlobInspector & limits (const amqp::internal::cursor::Limits * limits_) {
+            m_limits = limits_;
+            return *this;
+        }
+
+        /**
+         * Have [write] cut down every list, array or map of more than
+         * [n_] elements to its first [n_] or, if [uniform_], [n_] spread
+         * evenly across it, written with how many it actually holds, see
+         * [amqp::internal::reader::Sampling]. Zero writes everything
+         */
+        BlobInspector & sample (size_t n_, bool uniform_ = false) {
+            m_sample = n_;
+            m_uniform = uniform_;
+            return *this;
+        }
+
         std::string dump();
 
+        /**
+         * The tree of values [dump] renders, its outermost value named
+         * "Parsed". Built in the thread's current
+         * [amqp::internal::reader::Arena], if there is one, and so not
+         * to outlive that arena's reset, otherwise on the heap
+         */
+        uPtr<amqp::reader::IValue> values();
+
+        /**
+         * The descriptor of the blob's outermost type, found without
+         * decoding anything
+         */
+        std::string descriptor() const;
+
+        /**
+         * Whether the blob's schema has been seen before and the readers
+         * for its outermost type already built, so decoding it won't
+         * stop to build them
+         */
+        bool warm() const;
+
+        /**
+         * The name of the blob's outermost type, looked up in its schema
+         * without the schema being built, empty if it isn't there
+         */
+        std::string type() const;
+
+        /**
+         * Stream the decoded blob straight into [sink_] without building
+         * an intermediate tree of values
+         */
+        void write (amqp::reader::ISink &);
+
+        /**
+         * As [write] but only emits the "Parsed" field, leaving the caller
+         * to open and close the surrounding object around it
+         */
+        void writeFields (amqp::reader::ISink &);
+
+        /**
+         * Walk the "Parsed" value of the blob with [visitor_], nothing
+         * being decoded beyond what is handed to the callbacks
+         */
+        void visit (amqp::reader::IVisitor &);
+
+        /**
+         * A handle on the "Parsed" value from which just the parts of
+         * interest can be decoded, see [amqp::internal::reader::Lazy].
+         * Nothing is decoded until it's asked for.
+         */
+        uPtr<amqp::internal::reader::Lazy> lazy();
+
+        /**
+         * A handle, as [lazy], on the value at [path_], for example
+         * "states[41233].amount" or, as a JSON pointer into the "Parsed"
+         * value, "/states/41233/amount", reached by skipping over
+         * everything before it or, given the [Offsets] of this blob, by
+         * jumping straight to it
+         */
+        uPtr<amqp::internal::reader::Lazy> at (
+            const std::string & path_,
+            const Offsets * offsets_ = nullptr);
+
+        /**
+         * Decode into a flat tape of tokens, the same ones [write] would
+         * emit, whose strings refer back into the blob. With [hashes_]
+         * every object on it carries its composite's structural hash,
+         * see [amqp::internal::reader::ObjectTable::hash]
+         */
+        amqp::internal::tape::Tape tape (bool hashes_ = false);
+
+        /**
+         * As [write] but only decoding the fields named by [paths_], each
+         * a dotted path such as "amount.quantity" from the outermost type
+         */
+        void project (amqp::reader::ISink &, const std::vector<std::string> & paths_);
+
+        /**
+         * As [project] but leaves the surrounding object to the caller
+         */
+        void projectFields (amqp::reader::ISink &, const std::vector<std::string> & paths_);
+
+        /**
+         * Whether the blob matches [filter_], decoding only the fields it
+         * tests and only until it's decided
+         */
+        bool matches (const Filter & filter_);
+
+        /**
+         * Add the blob to [aggregate_]'s totals, decoding only the fields
+         * it groups by and sums
+         */
+        void aggregate (Aggregate & aggregate_);
+
 };
 
 /******************************************************************************/
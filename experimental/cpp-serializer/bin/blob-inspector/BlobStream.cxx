@@ -0,0 +1,209 @@
+#include "BlobStream.h"
+
+#include <string>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Frames.h"
+#include "CordaBytes.h"
+
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+#include "stats/Stats.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Values are read a chunk at a time so one claiming to be enormous
+     * only costs as much as the stream actually holds
+     */
+    constexpr size_t CHUNK = 64 * 1024;
+
+    constexpr size_t MAX_DEPTH = 128;
+
+    size_t
+    big (const char * bytes_, size_t width_) {
+        size_t rtn { 0 };
+
+        for (size_t i { 0 } ; i < width_ ; ++i) {
+            rtn = rtn << 8 | static_cast<unsigned char> (bytes_[i]);
+        }
+
+        return rtn;
+    }
+
+    int
+    nibble (char c_) {
+        if (c_ >= '0' && c_ <= '9') return c_ - '0';
+        if (c_ >= 'a' && c_ <= 'f') return c_ - 'a' + 10;
+        if (c_ >= 'A' && c_ <= 'F') return c_ - 'A' + 10;
+
+        throw std::runtime_error ("Not a hex encoded blob");
+    }
+
+}
+
+/******************************************************************************/
+
+BlobStream::Framing
+BlobStream::framing (int first_) {
+    if (first_ == '\\') return hex_t;
+    if (first_ == amqp::AMQP_HEADER[0] || first_ == std::istream::traits_type::eof()) return raw_t;
+
+    return prefixed_t;
+}
+
+/******************************************************************************/
+
+BlobStream::BlobStream (std::istream & in_)
+    : m_in (in_)
+    , m_framing (framing (in_.peek()))
+    , m_blobs (0)
+{
+}
+
+/******************************************************************************/
+
+void
+BlobStream::read (size_t n_) {
+    while (n_) {
+        auto chunk = std::min (n_, CHUNK);
+        auto at = m_buffer.size();
+
+        m_buffer.resize (at + chunk);
+        m_in.read (m_buffer.data() + at, static_cast<std::streamsize> (chunk));
+
+        if (static_cast<size_t> (m_in.gcount()) != chunk) {
+            throw std::runtime_error ("Stream ended part way through a blob");
+        }
+
+        n_ -= chunk;
+    }
+}
+
+/******************************************************************************/
+
+void
+BlobStream::value (size_t depth_) {
+    if (depth_ > MAX_DEPTH) throw std::runtime_error ("Blob nests too deeply");
+
+    read (1);
+    auto extent = Frames::extent (static_cast<unsigned char> (m_buffer.back()));
+
+    if (extent.m_described) {
+        value (depth_ + 1);
+        value (depth_ + 1);
+        return;
+    }
+
+    if (!extent.m_width) {
+        read (extent.m_fixed);
+        return;
+    }
+
+    read (extent.m_width);
+    read (big (&m_buffer[m_buffer.size() - extent.m_width], extent.m_width));
+}
+
+/******************************************************************************/
+
+std::unique_ptr<CordaBytes>
+BlobStream::raw() {
+    if (m_in.peek() == std::istream::traits_type::eof()) return nullptr;
+
+    read (amqp::AMQP_HEADER.size() + 1);
+
+    if (std::memcmp (m_buffer.data(), amqp::AMQP_HEADER.data(), amqp::AMQP_HEADER.size()) != 0) {
+        throw std::runtime_error ("Not a Corda stream");
+    }
+
+    if (m_buffer.back() == amqp::ENCODING) {
+        m_buffer.insert (
+            m_buffer.end(),
+            std::istreambuf_iterator<char> (m_in),
+            std::istreambuf_iterator<char>());
+    } else {
+        value (0);
+    }
+
+    return std::make_unique<CordaBytes> (std::move (m_buffer));
+}
+
+/******************************************************************************/
+
+/**
+ * Framed, a blob is whatever its frame holds, compressed or not
+ */
+std::unique_ptr<CordaBytes>
+BlobStream::prefixed() {
+    if (m_in.peek() == std::istream::traits_type::eof()) return nullptr;
+
+    read (4);
+    auto length = big (m_buffer.data(), 4);
+
+    m_buffer.clear();
+    read (length);
+
+    return std::make_unique<CordaBytes> (std::move (m_buffer));
+}
+
+/******************************************************************************/
+
+std::unique_ptr<CordaBytes>
+BlobStream::line() {
+    thread_local std::string line;
+
+    for (;;) {
+        if (!std::getline (m_in, line)) return nullptr;
+
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        // empty lines and the nulls COPY writes as \N
+        if (!line.empty() && line != "\\N") break;
+    }
+
+    // text COPY escapes the backslash bytea's hex output starts with
+    size_t at { 0 };
+    while (at < line.size() && line[at] == '\\') ++at;
+
+    if (at == 0 || at > 2 || at == line.size() || line[at] != 'x' || (line.size() - at - 1) % 2) {
+        throw std::runtime_error ("Not a hex encoded blob");
+    }
+
+    for (size_t i { at + 1 } ; i < line.size() ; i += 2) {
+        m_buffer.push_back (static_cast<char> (nibble (line[i]) << 4 | nibble (line[i + 1])));
+    }
+
+    return std::make_unique<CordaBytes> (std::move (m_buffer));
+}
+
+/******************************************************************************/
+
+std::unique_ptr<CordaBytes>
+BlobStream::next() {
+    amqp::internal::stats::Stats::Timer timer (amqp::internal::stats::Stats::io_t);
+
+    // the last blob took the buffer with it, take back whichever one
+    // this thread was done with
+    if (!m_buffer.capacity()) m_buffer = CordaBytes::buffer();
+    m_buffer.clear();
+
+    std::unique_ptr<CordaBytes> rtn;
+
+    switch (m_framing) {
+        case raw_t      : rtn = raw(); break;
+        case prefixed_t : rtn = prefixed(); break;
+        case hex_t      : rtn = line(); break;
+    }
+
+    if (rtn) ++m_blobs;
+
+    return rtn;
+}
+
+/******************************************************************************/
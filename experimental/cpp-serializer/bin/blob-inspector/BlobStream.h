@@ -0,0 +1,81 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <vector>
+#include <iosfwd>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+/******************************************************************************/
+
+/**
+ * Splits blob after blob off a stream that can't be seeked or sized, stdin
+ * fed by a pipeline or a socket say, each being handed over as soon as
+ * its last byte has arrived.
+ *
+ * A blob has no length of its own but its payload, like any AMQP value,
+ * says how long it is as it goes, so just enough of each is read to learn
+ * that before the rest is read in one go. Nothing is held beyond the blob
+ * being read.
+ *
+ * The stream may instead be the output of psql's COPY ... TO STDOUT, a
+ * bytea per line written as hex, optionally escaped, "\\x636f726461..."
+ * say, which is recognised from its first byte. Null rows are skipped.
+ *
+ * Or each blob may be framed by its length, four bytes big endian, as a
+ * Kafka consumer dumping a partition segment would frame them, told from
+ * a raw stream by not starting with the "corda" of a header.
+ *
+ * A compressed payload runs to the end of whatever it's compressed with,
+ * which only its codec knows, so one is only ever the last blob of a raw
+ * stream, taking everything left. Every frame, and every line of COPY
+ * output, is a blob of its own, compressed or not.
+ */
+class BlobStream {
+    private :
+        enum Framing { raw_t, prefixed_t, hex_t };
+
+        std::istream & m_in;
+
+        Framing m_framing;
+        size_t m_blobs;
+
+        std::vector<char> m_buffer;
+
+        /**
+         * Append exactly [n_] bytes to [m_buffer], throwing if the stream
+         * ends first
+         */
+        void read (size_t n_);
+
+        /**
+         * Read in the AMQP value starting at the end of [m_buffer]
+         */
+        void value (size_t depth_);
+
+        std::unique_ptr<CordaBytes> raw();
+        std::unique_ptr<CordaBytes> prefixed();
+        std::unique_ptr<CordaBytes> line();
+
+        static Framing framing (int first_);
+
+    public :
+        explicit BlobStream (std::istream &);
+
+        BlobStream (const BlobStream &) = delete;
+
+        /**
+         * The next blob, or null once the stream has ended between blobs.
+         * A stream ending part way through a blob, or holding something
+         * other than blobs, throws
+         */
+        std::unique_ptr<CordaBytes> next();
+
+        size_t blobs() const { return m_blobs; }
+};
+
+/******************************************************************************/
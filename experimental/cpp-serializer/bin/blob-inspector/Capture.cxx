@@ -0,0 +1,434 @@
+#include "Capture.h"
+
+#include <cstring>
+#include <istream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr uint8_t FIN = 0x01;
+    constexpr uint8_t SYN = 0x02;
+    constexpr uint8_t RST = 0x04;
+
+    /**
+     * Anything claiming to be bigger is taken to be corrupt rather
+     * than allocated
+     */
+    constexpr size_t MAX_RECORD = 256 * 1024 * 1024;
+
+    uint32_t
+    le32 (const char * p_) {
+        uint32_t rtn { 0 };
+
+        for (int i { 3 } ; i >= 0 ; --i) {
+            rtn = rtn << 8U | static_cast<unsigned char> (p_[i]);
+        }
+
+        return rtn;
+    }
+
+    uint32_t
+    be32 (const char * p_) {
+        uint32_t rtn { 0 };
+
+        for (int i { 0 } ; i < 4 ; ++i) {
+            rtn = rtn << 8U | static_cast<unsigned char> (p_[i]);
+        }
+
+        return rtn;
+    }
+
+    uint16_t
+    be16 (const char * p_) {
+        return static_cast<uint16_t> (
+            static_cast<unsigned char> (p_[0]) << 8U | static_cast<unsigned char> (p_[1]));
+    }
+
+    uint16_t
+    le16 (const char * p_) {
+        return static_cast<uint16_t> (
+            static_cast<unsigned char> (p_[1]) << 8U | static_cast<unsigned char> (p_[0]));
+    }
+
+    std::string
+    endpoint (int family_, const char * address_, uint16_t port_) {
+        char text[INET6_ADDRSTRLEN] { };
+        ::inet_ntop (family_, address_, text, sizeof (text));
+
+        return family_ == AF_INET6
+            ? "[" + std::string (text) + "]:" + std::to_string (port_)
+            : std::string (text) + ":" + std::to_string (port_);
+    }
+
+}
+
+/******************************************************************************/
+
+Capture::Capture (std::istream & in_, Message message_, Failure failure_)
+    : m_in (in_)
+    , m_message (std::move (message_))
+    , m_failure (std::move (failure_))
+    , m_packets (0)
+{
+}
+
+/******************************************************************************/
+
+bool
+Capture::read (char * p_, size_t size_, bool required_) {
+    m_in.read (p_, static_cast<std::streamsize> (size_));
+
+    auto got = static_cast<size_t> (m_in.gcount());
+
+    if (got == size_) return true;
+    if (got == 0 && !required_) return false;
+
+    throw std::runtime_error ("Capture ended part way through a packet");
+}
+
+/******************************************************************************/
+
+void
+Capture::run() {
+    char header[24];
+
+    if (!read (header, 4, false)) return;
+
+    auto magic = le32 (header);
+
+    if (magic == 0x0a0d0d0a) {
+        pcapng (header);
+    } else if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d) {
+        read (header + 4, 20);
+        pcap (header, false);
+    } else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1) {
+        read (header + 4, 20);
+        pcap (header, true);
+    } else {
+        throw std::runtime_error ("Not a pcap or pcapng capture");
+    }
+}
+
+/******************************************************************************/
+
+void
+Capture::pcap (const char * header_, bool swapped_) {
+    auto u32 = [swapped_](const char * p_) { return swapped_ ? be32 (p_) : le32 (p_); };
+
+    auto link = u32 (header_ + 20);
+    char record[16];
+
+    while (read (record, sizeof (record), false)) {
+        auto size = u32 (record + 8);
+
+        if (size > MAX_RECORD) throw std::runtime_error ("Corrupt pcap record");
+
+        m_packet.resize (size);
+        read (m_packet.data(), size);
+
+        packet (link, m_packet.data(), size);
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Blocks each of a type and a length, both repeated at the end, the
+ * byte order being that of the section header's magic
+ */
+void
+Capture::pcapng (const char * header_) {
+    bool swapped { false };
+    auto u32 = [&swapped](const char * p_) { return swapped ? be32 (p_) : le32 (p_); };
+    auto u16 = [&swapped](const char * p_) { return swapped ? be16 (p_) : le16 (p_); };
+
+    auto order = [&swapped](const char * magic_) {
+        if (le32 (magic_) == 0x1a2b3c4d) {
+            swapped = false;
+        } else if (be32 (magic_) == 0x1a2b3c4d) {
+            swapped = true;
+        } else {
+            throw std::runtime_error ("Corrupt pcapng section");
+        }
+    };
+
+    char block[8];
+    std::memcpy (block, header_, 4);
+
+    read (block + 4, 4);
+
+    for (bool first { true } ; ; first = false) {
+        if (!first && !read (block, sizeof (block), false)) return;
+
+        // the section header's length can't be read until its magic has
+        if (le32 (block) == 0x0a0d0d0a) {
+            char magic[4];
+            read (magic, sizeof (magic));
+            order (magic);
+
+            auto length = u32 (block + 4);
+            if (length < 28 || length > MAX_RECORD) throw std::runtime_error ("Corrupt pcapng block");
+
+            m_packet.resize (length - 12);
+            read (m_packet.data(), m_packet.size());
+
+            m_links.clear();
+            continue;
+        }
+
+        auto type = u32 (block);
+        auto length = u32 (block + 4);
+
+        if (length < 12 || length > MAX_RECORD) throw std::runtime_error ("Corrupt pcapng block");
+
+        m_packet.resize (length - 8);
+        read (m_packet.data(), m_packet.size());
+
+        const char * body = m_packet.data();
+        auto size = m_packet.size() - 4;
+
+        if (type == 1 && size >= 2) {
+            m_links.push_back (u16 (body));
+        } else if (type == 6 && size >= 20) {
+            auto interface = u32 (body);
+            auto captured = std::min<size_t> (u32 (body + 12), size - 20);
+
+            if (interface < m_links.size()) packet (m_links[interface], body + 20, captured);
+        } else if (type == 3 && size >= 4 && !m_links.empty()) {
+            auto captured = std::min<size_t> (u32 (body), size - 4);
+
+            packet (m_links[0], body + 4, captured);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+Capture::packet (uint32_t link_, const char * p_, size_t size_) {
+    ++m_packets;
+
+    size_t at;
+    uint16_t type;
+
+    switch (link_) {
+        case 1 : {
+            if (size_ < 14) return;
+
+            type = be16 (p_ + 12);
+            at = 14;
+
+            // VLAN tags, QinQ's included
+            while ((type == 0x8100 || type == 0x88a8) && size_ >= at + 4) {
+                type = be16 (p_ + at + 2);
+                at += 4;
+            }
+
+            break;
+        }
+        case 113 :
+            if (size_ < 16) return;
+            type = be16 (p_ + 14);
+            at = 16;
+            break;
+        case 276 :
+            if (size_ < 20) return;
+            type = be16 (p_);
+            at = 20;
+            break;
+        case 0 :
+            if (size_ < 4) return;
+            ip (p_ + 4, size_ - 4);
+            return;
+        case 12 : case 14 : case 101 : case 228 : case 229 :
+            ip (p_, size_);
+            return;
+        default :
+            return;
+    }
+
+    if (type == 0x0800 || type == 0x86dd) ip (p_ + at, size_ - at);
+}
+
+/******************************************************************************/
+
+void
+Capture::ip (const char * p_, size_t size_) {
+    if (size_ < 1) return;
+
+    int family;
+    const char * source;
+    const char * destination;
+    size_t width;
+    size_t at;
+
+    if ((static_cast<unsigned char> (p_[0]) >> 4U) == 4) {
+        at = (static_cast<unsigned char> (p_[0]) & 0x0fU) * 4U;
+
+        if (size_ < 20 || at < 20 || size_ < at) return;
+
+        // trailing padding, an Ethernet frame's minimum size say
+        size_ = std::min<size_t> (size_, be16 (p_ + 2));
+
+        // fragmented or not TCP
+        if ((be16 (p_ + 6) & 0x3fffU) || p_[9] != 6 || size_ < at) return;
+
+        family = AF_INET;
+        source = p_ + 12;
+        destination = p_ + 16;
+        width = 4;
+    } else if ((static_cast<unsigned char> (p_[0]) >> 4U) == 6) {
+        if (size_ < 40) return;
+
+        size_ = std::min<size_t> (size_, 40U + be16 (p_ + 4));
+
+        auto next = static_cast<unsigned char> (p_[6]);
+        at = 40;
+
+        // hop by hop, routing and destination options
+        while ((next == 0 || next == 43 || next == 60) && size_ >= at + 8) {
+            next = static_cast<unsigned char> (p_[at]);
+            at += (static_cast<unsigned char> (p_[at + 1]) + 1U) * 8U;
+        }
+
+        if (next != 6 || size_ < at) return;
+
+        family = AF_INET6;
+        source = p_ + 8;
+        destination = p_ + 24;
+        width = 16;
+    } else {
+        return;
+    }
+
+    const char * tcp = p_ + at;
+    size_t length = size_ - at;
+
+    if (length < 20) return;
+
+    size_t offset = (static_cast<unsigned char> (tcp[12]) >> 4U) * 4U;
+    if (offset < 20 || offset > length) return;
+
+    thread_local std::string key;
+    key.assign (source, width).append (tcp, 2).append (destination, width).append (tcp + 2, 2);
+
+    auto it = m_streams.find (key);
+
+    if (it == m_streams.end()) {
+        it = m_streams.emplace (key, Stream()).first;
+
+        auto & stream = it->second;
+
+        stream.m_name = endpoint (family, source, be16 (tcp)) + ">" + endpoint (family, destination, be16 (tcp + 2));
+    }
+
+    auto & stream = it->second;
+    auto flags = static_cast<uint8_t> (tcp[13]);
+
+    segment (stream, be32 (tcp + 4), flags, tcp + offset, length - offset);
+
+    if (flags & (FIN | RST)) m_streams.erase (it);
+}
+
+/******************************************************************************/
+
+void
+Capture::segment (Stream & stream_, uint32_t seq_, uint8_t flags_, const char * p_, size_t size_) {
+    if (flags_ & SYN) {
+        // another connection on the same ports starts afresh
+        stream_.m_next = seq_ + 1;
+        stream_.m_synced = true;
+        stream_.m_broken = false;
+        stream_.m_ahead.clear();
+        stream_.m_held = 0;
+        stream_.m_transfers.reset();
+
+        return;
+    }
+
+    if (stream_.m_broken || size_ == 0) return;
+
+    if (!stream_.m_synced) {
+        stream_.m_next = seq_;
+        stream_.m_synced = true;
+    }
+
+    auto ahead = static_cast<int32_t> (seq_ - stream_.m_next);
+
+    if (ahead > 0) {
+        auto & held = stream_.m_ahead[seq_];
+
+        if (held.size() < size_) {
+            stream_.m_held += size_ - held.size();
+            held.assign (p_, size_);
+        }
+
+        if (stream_.m_held > AHEAD) {
+            stream_.m_broken = true;
+            stream_.m_ahead.clear();
+            m_failure (stream_.m_name, "A segment is missing from the capture");
+        }
+
+        return;
+    }
+
+    // a retransmission may carry some bytes that are new
+    if (static_cast<size_t> (-static_cast<int64_t> (ahead)) < size_) {
+        auto seen = static_cast<size_t> (-static_cast<int64_t> (ahead));
+        feed (stream_, p_ + seen, size_ - seen);
+    }
+
+    // whatever was held that now follows on
+    for (bool fed { true } ; fed && !stream_.m_broken ; ) {
+        fed = false;
+
+        for (auto it = stream_.m_ahead.begin() ; it != stream_.m_ahead.end() ; ) {
+            auto behind = -static_cast<int64_t> (static_cast<int32_t> (it->first - stream_.m_next));
+
+            if (behind < 0) {
+                ++it;
+                continue;
+            }
+
+            auto held = std::move (it->second);
+            stream_.m_held -= held.size();
+            it = stream_.m_ahead.erase (it);
+
+            if (static_cast<size_t> (behind) < held.size()) {
+                feed (stream_, held.data() + behind, held.size() - static_cast<size_t> (behind));
+                fed = true;
+                break;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+Capture::feed (Stream & stream_, const char * p_, size_t size_) {
+    stream_.m_next += static_cast<uint32_t> (size_);
+
+    if (!stream_.m_transfers) {
+        stream_.m_transfers = std::make_unique<Transfers> ([this, &stream_](std::string_view body_) {
+            m_message (stream_.m_name, body_);
+        });
+    }
+
+    try {
+        stream_.m_transfers->feed (p_, size_);
+    } catch (const std::exception & e) {
+        stream_.m_broken = true;
+        stream_.m_ahead.clear();
+        stream_.m_held = 0;
+
+        m_failure (stream_.m_name, e.what());
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,102 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <functional>
+#include <string_view>
+
+#include "Transfers.h"
+
+/******************************************************************************/
+
+/**
+ * Reads the AMQP messages out of a packet capture, pcap or pcapng as
+ * tcpdump and Wireshark write them, from a file or a pipe, so traffic to
+ * and from a broker can be inspected passively as it's captured.
+ *
+ * Every TCP connection in the capture is reassembled, each direction
+ * its own stream, segments that arrive out of order being held until
+ * those before them have, and retransmissions trimmed of what's already
+ * been seen. Each stream's bytes go to [Transfers] of its own, each body
+ * it finds being handed over with the stream's name, its source and
+ * destination, "10.0.0.1:61616>10.0.0.2:52114" say.
+ *
+ * Ethernet, VLAN tagged or not, Linux cooked captures, both versions,
+ * raw IP and BSD loopback are understood, over IPv4 or IPv6. A stream
+ * that isn't AMQP or, captured part way through, is joined mid frame,
+ * as is one with a segment missing from the capture, is reported once
+ * and then ignored. IP fragments are passed over.
+ */
+class Capture {
+    public :
+        using Message = std::function<void (const std::string & stream_, std::string_view body_)>;
+        using Failure = std::function<void (const std::string & stream_, const char * error_)>;
+
+        /**
+         * Most bytes of a stream held waiting for a segment missing
+         * before them
+         */
+        static constexpr size_t AHEAD = 16 * 1024 * 1024;
+
+    private :
+        struct Stream {
+            std::string m_name;
+
+            uint32_t m_next { 0 };
+            bool m_synced { false };
+            bool m_broken { false };
+
+            std::map<uint32_t, std::string> m_ahead;
+            size_t m_held { 0 };
+
+            std::unique_ptr<Transfers> m_transfers;
+        };
+
+        std::istream & m_in;
+
+        Message m_message;
+        Failure m_failure;
+
+        std::map<std::string, Stream> m_streams;
+
+        /**
+         * pcapng's link types, one per interface
+         */
+        std::vector<uint32_t> m_links;
+
+        std::vector<char> m_packet;
+
+        size_t m_packets;
+
+        bool read (char *, size_t size_, bool required_ = true);
+
+        void pcap (const char * header_, bool swapped_);
+        void pcapng (const char * header_);
+
+        void packet (uint32_t link_, const char *, size_t);
+        void ip (const char *, size_t);
+
+        void segment (Stream &, uint32_t seq_, uint8_t flags_, const char *, size_t);
+
+        void feed (Stream &, const char *, size_t);
+
+    public :
+        Capture (std::istream &, Message, Failure);
+
+        Capture (const Capture &) = delete;
+
+        /**
+         * Read the capture to its end, throwing should it not be one
+         */
+        void run();
+
+        size_t packets() const { return m_packets; }
+};
+
+/******************************************************************************/
@@ -0,0 +1,169 @@
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <filesystem>
+
+#include <sys/stat.h>
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Anything that isn't a record is passed over
+     */
+    bool
+    parse (const std::string & line_, std::string & file_, Checkpoint::Entry & entry_) {
+        std::istringstream in (line_.substr (2));
+
+        std::string hash;
+
+        if (!(in >> hash >> entry_.m_size >> entry_.m_modified >> entry_.m_end) || hash.size() != 32) {
+            return false;
+        }
+
+        try {
+            entry_.m_hash.m_high = std::stoull (hash.substr (0, 16), nullptr, 16);
+            entry_.m_hash.m_low = std::stoull (hash.substr (16), nullptr, 16);
+        } catch (const std::exception &) {
+            return false;
+        }
+
+        if (in.get() != ' ') return false;
+
+        std::getline (in, file_);
+
+        return !file_.empty();
+    }
+
+}
+
+/******************************************************************************/
+
+Checkpoint::Checkpoint (const std::string & path_)
+    : m_path (path_)
+    , m_end (0)
+    , m_uncommitted (0)
+{
+    bool torn { false };
+
+    {
+        std::ifstream in (path_, std::ios::binary);
+        std::string line, file;
+        Entry entry { };
+
+        while (std::getline (in, line)) {
+            // not knowing how much of the last line was lost it's ignored
+            if (in.eof()) {
+                torn = true;
+                break;
+            }
+
+            if (line.size() > 2 && line[0] == '@' && line[1] == ' ') {
+                try {
+                    m_end = std::stoull (line.substr (2));
+                } catch (const std::exception &) { }
+            } else if (line.size() > 2 && line[0] == '=' && line[1] == ' ' && parse (line, file, entry)) {
+                m_end = entry.m_end;
+                m_entries[file] = entry;
+            }
+        }
+    }
+
+    m_file.open (path_, std::ios::out | std::ios::app | std::ios::binary);
+
+    if (!m_file) throw std::runtime_error ("Failed to open " + path_);
+
+    // what was being written when the batch died mustn't run into what's next
+    if (torn) m_pending += '\n';
+}
+
+/******************************************************************************/
+
+const Checkpoint::Entry *
+Checkpoint::find (const std::string & file_) const {
+    auto it = m_entries.find (file_);
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+/******************************************************************************/
+
+uint64_t
+Checkpoint::reopen (const std::string & output_, std::ofstream & out_) const {
+    std::error_code ec;
+    auto size = std::filesystem::file_size (output_, ec);
+
+    if (ec) {
+        size = 0;
+    } else if (size > m_end) {
+        std::filesystem::resize_file (output_, m_end);
+        size = m_end;
+    }
+
+    out_.open (output_, std::ios::out | std::ios::app | std::ios::binary);
+
+    if (!out_) throw std::runtime_error ("Failed to open " + output_);
+
+    return size;
+}
+
+/******************************************************************************/
+
+void
+Checkpoint::begin (uint64_t at_) {
+    m_pending += "@ " + std::to_string (at_) + '\n';
+    commit();
+}
+
+/******************************************************************************/
+
+void
+Checkpoint::record (const std::string & file_, const Entry & entry_) {
+    char hash[33];
+    std::snprintf (hash, sizeof (hash), "%016llx%016llx",
+        static_cast<unsigned long long> (entry_.m_hash.m_high),
+        static_cast<unsigned long long> (entry_.m_hash.m_low));
+
+    m_pending += "= ";
+    m_pending += hash;
+    m_pending += ' ' + std::to_string (entry_.m_size)
+        + ' ' + std::to_string (entry_.m_modified)
+        + ' ' + std::to_string (entry_.m_end)
+        + ' ' + file_ + '\n';
+
+    ++m_uncommitted;
+}
+
+/******************************************************************************/
+
+void
+Checkpoint::commit() {
+    if (m_pending.empty()) return;
+
+    m_file << m_pending;
+    m_file.flush();
+
+    if (!m_file) throw std::runtime_error ("Failed to write " + m_path);
+
+    m_pending.clear();
+    m_uncommitted = 0;
+}
+
+/******************************************************************************/
+
+bool
+Checkpoint::stat (const std::string & file_, Entry & entry_) {
+    struct stat st { };
+
+    if (::stat (file_.c_str(), &st) != 0) return false;
+
+    entry_.m_size = static_cast<uint64_t> (st.st_size);
+    entry_.m_modified = static_cast<int64_t> (st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+    return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,121 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+/**
+ * What a batch has written, so one that dies part way through can be run
+ * again to carry on where it stopped, and a later one can skip the blobs
+ * that haven't changed since. See [Batch::Options::m_checkpoint].
+ *
+ * The file's a manifest appended to as the batch goes, a line for each
+ * blob whose output's been written. Each records the blob's file, its
+ * size and modification time, a hash of its contents and the offset in
+ * the output just past its line, a line starting each run with where its
+ * output started. What's recorded is only written once the output before
+ * it has been flushed, so after a crash a blob may be written twice but
+ * never not at all, and an output cut back to [end] holds exactly the
+ * lines recorded.
+ *
+ * One run's records are only read by the next, so the workers can look
+ * them up whilst the writer's appending those of its own.
+ */
+class Checkpoint {
+    public :
+        struct Entry {
+            amqp::internal::cursor::Hash m_hash;
+            uint64_t m_size;
+
+            /**
+             * Nanoseconds since the epoch
+             */
+            int64_t m_modified;
+
+            uint64_t m_end;
+        };
+
+        /**
+         * How many records are held waiting for the output to be flushed
+         * before it and they are
+         */
+        static constexpr size_t COMMIT = 1024;
+
+    private :
+        std::string m_path;
+
+        std::unordered_map<std::string, Entry> m_entries;
+
+        uint64_t m_end;
+
+        std::ofstream m_file;
+
+        std::string m_pending;
+        size_t m_uncommitted;
+
+    public :
+        /**
+         * Read whatever's recorded in [path_], creating it if need be
+         */
+        explicit Checkpoint (const std::string & path_);
+
+        Checkpoint (const Checkpoint &) = delete;
+
+        /**
+         * The latest record of [file_] from the runs before this one,
+         * null if there isn't one
+         */
+        const Entry * find (const std::string & file_) const;
+
+        size_t size() const { return m_entries.size(); }
+
+        /**
+         * Where the last run's output ended as far as what was recorded
+         * goes, where it started should nothing have been
+         */
+        uint64_t end() const { return m_end; }
+
+        /**
+         * Open [output_] for this run's lines to be appended to, first
+         * cutting it back to [end] should anything not recorded have been
+         * written after it, returning where they'll start
+         */
+        uint64_t reopen (const std::string & output_, std::ofstream & out_) const;
+
+        /**
+         * Start this run's records, its output starting at [at_]
+         */
+        void begin (uint64_t at_);
+
+        /**
+         * Once the output is written up to the end of this line
+         */
+        void record (const std::string & file_, const Entry &);
+
+        /**
+         * True once enough's been recorded that the output is to be
+         * flushed and [commit]ted
+         */
+        bool due() const { return m_uncommitted >= COMMIT; }
+
+        /**
+         * Write out the records, once the output they cover has been
+         * flushed
+         */
+        void commit();
+
+        /**
+         * The size and modification time of [file_], false if it can't
+         * be read
+         */
+        static bool stat (const std::string & file_, Entry &);
+};
+
+/******************************************************************************/
@@ -0,0 +1,284 @@
+#include "Codec.h"
+
+#include <array>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Snappy's framing format
+     */
+    constexpr unsigned char IDENTIFIER   = 0xFF;
+    constexpr unsigned char COMPRESSED   = 0x00;
+    constexpr unsigned char UNCOMPRESSED = 0x01;
+
+    constexpr std::string_view STREAM { "sNaPpY" };
+
+    /**
+     * Neither sort of chunk may decompress to more than this
+     */
+    constexpr size_t MAX_CHUNK = 65536;
+
+    uint32_t
+    little (const char * bytes_, size_t width_) {
+        uint32_t rtn { 0 };
+
+        for (size_t i { 0 } ; i < width_ ; ++i) {
+            rtn |= static_cast<uint32_t> (static_cast<unsigned char> (bytes_[i])) << (8 * i);
+        }
+
+        return rtn;
+    }
+
+    std::array<uint32_t, 256>
+    table() {
+        std::array<uint32_t, 256> rtn { };
+
+        for (uint32_t i { 0 } ; i < 256 ; ++i) {
+            uint32_t crc { i };
+            for (int j { 0 } ; j < 8 ; ++j) crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78 : 0);
+            rtn[i] = crc;
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Frames hold their data's checksum rotated and offset, so that a
+     * checksum of data that itself holds checksums can't be mistaken
+     */
+    uint32_t
+    mask (uint32_t crc_) {
+        return ((crc_ >> 15) | (crc_ << 17)) + 0xA282EAD8;
+    }
+
+}
+
+/******************************************************************************/
+
+uint32_t
+Codec::crc32c (const char * bytes_, size_t size_) {
+    static const auto crcs = table();
+
+    uint32_t crc { 0xFFFFFFFF };
+
+    for (size_t i { 0 } ; i < size_ ; ++i) {
+        crc = crcs[(crc ^ static_cast<unsigned char> (bytes_[i])) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+/******************************************************************************/
+
+/**
+ * The output grows as needed, starting at a guess of how far the input
+ * will inflate so most blobs need it to grow once at most
+ */
+void
+Codec::inflate (const char * bytes_, size_t size_, std::vector<char> & out_) {
+#if defined (HAVE_ZLIB)
+    z_stream stream { };
+
+    if (::inflateInit2 (&stream, -MAX_WBITS) != Z_OK) {
+        throw std::runtime_error ("Failed to start inflating");
+    }
+
+    stream.next_in = reinterpret_cast<Bytef *> (const_cast<char *> (bytes_));
+    stream.avail_in = static_cast<uInt> (size_);
+
+    auto start = out_.size();
+    out_.resize (start + std::max<size_t> (4 * size_, 1024));
+
+    size_t written { start };
+    int rtn;
+
+    do {
+        if (written == out_.size()) out_.resize (2 * out_.size());
+
+        stream.next_out = reinterpret_cast<Bytef *> (out_.data() + written);
+        stream.avail_out = static_cast<uInt> (out_.size() - written);
+
+        rtn = ::inflate (&stream, Z_NO_FLUSH);
+        written = out_.size() - stream.avail_out;
+    } while (rtn == Z_OK);
+
+    ::inflateEnd (&stream);
+    out_.resize (written);
+
+    if (rtn != Z_STREAM_END) {
+        throw std::runtime_error ("Corrupt DEFLATE stream");
+    }
+#else
+    (void) bytes_; (void) size_; (void) out_;
+    throw std::runtime_error ("DEFLATE compressed blobs need zlib");
+#endif
+}
+
+/******************************************************************************/
+
+void
+Codec::unsnappy (const char * bytes_, size_t size_, std::vector<char> & out_) {
+    const char * p   = bytes_;
+    const char * end = bytes_ + size_;
+
+    uint64_t length { 0 };
+    for (int shift { 0 } ; ; shift += 7) {
+        if (p == end || shift > 28) throw std::runtime_error ("Corrupt Snappy block");
+
+        auto b = static_cast<unsigned char> (*p++);
+        length |= static_cast<uint64_t> (b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+
+    // no element writes more than 64 bytes from the 2 bytes of its tag
+    // and offset, so anything claiming more is corrupt
+    if (length > 32 * size_) throw std::runtime_error ("Corrupt Snappy block");
+
+    auto start = out_.size();
+    out_.resize (start + length);
+
+    char * out     = out_.data() + start;
+    char * written = out;
+    char * limit   = out + length;
+
+    while (p < end) {
+        auto tag = static_cast<unsigned char> (*p++);
+
+        if ((tag & 3) == 0) {
+            size_t literal = (tag >> 2) + 1;
+
+            // lengths of 61 and more are held in the 1 to 4 bytes following
+            if (literal > 60) {
+                auto width = literal - 60;
+                if (static_cast<size_t> (end - p) < width) throw std::runtime_error ("Corrupt Snappy block");
+
+                literal = little (p, width) + 1;
+                p += width;
+            }
+
+            if (static_cast<size_t> (end - p) < literal || static_cast<size_t> (limit - written) < literal) {
+                throw std::runtime_error ("Corrupt Snappy block");
+            }
+
+            std::memcpy (written, p, literal);
+            written += literal;
+            p += literal;
+
+            continue;
+        }
+
+        size_t copy;
+        size_t offset;
+
+        switch (tag & 3) {
+            case 1 :
+                if (p == end) throw std::runtime_error ("Corrupt Snappy block");
+                copy = ((tag >> 2) & 7) + 4;
+                offset = (static_cast<size_t> (tag >> 5) << 8) | static_cast<unsigned char> (*p++);
+                break;
+            case 2 :
+                if (end - p < 2) throw std::runtime_error ("Corrupt Snappy block");
+                copy = (tag >> 2) + 1;
+                offset = little (p, 2);
+                p += 2;
+                break;
+            default :
+                if (end - p < 4) throw std::runtime_error ("Corrupt Snappy block");
+                copy = (tag >> 2) + 1;
+                offset = little (p, 4);
+                p += 4;
+                break;
+        }
+
+        if (offset == 0
+            || offset > static_cast<size_t> (written - out)
+            || copy > static_cast<size_t> (limit - written))
+        {
+            throw std::runtime_error ("Corrupt Snappy block");
+        }
+
+        // copies may overlap what they're writing, repeating a run
+        for (const char * from = written - offset ; copy-- ; ) *written++ = *from++;
+    }
+
+    if (written != limit) throw std::runtime_error ("Corrupt Snappy block");
+}
+
+/******************************************************************************/
+
+void
+Codec::unframe (const char * bytes_, size_t size_, std::vector<char> & out_) {
+    const char * p   = bytes_;
+    const char * end = bytes_ + size_;
+
+    bool identified { false };
+
+    while (p < end) {
+        if (end - p < 4) throw std::runtime_error ("Truncated Snappy frame");
+
+        auto type = static_cast<unsigned char> (p[0]);
+        auto length = little (p + 1, 3);
+        p += 4;
+
+        if (static_cast<size_t> (end - p) < length) throw std::runtime_error ("Truncated Snappy frame");
+
+        if (type == IDENTIFIER) {
+            if (std::string_view (p, length) != STREAM) {
+                throw std::runtime_error ("Not a Snappy stream");
+            }
+            identified = true;
+        } else if (!identified) {
+            throw std::runtime_error ("Not a Snappy stream");
+        } else if (type == COMPRESSED || type == UNCOMPRESSED) {
+            if (length < 4) throw std::runtime_error ("Truncated Snappy frame");
+
+            auto crc = little (p, 4);
+            auto start = out_.size();
+
+            if (type == COMPRESSED) {
+                unsnappy (p + 4, length - 4, out_);
+            } else {
+                out_.insert (out_.end(), p + 4, p + length);
+            }
+
+            if (out_.size() - start > MAX_CHUNK) {
+                throw std::runtime_error ("Snappy chunk too large");
+            }
+
+            if (mask (crc32c (out_.data() + start, out_.size() - start)) != crc) {
+                throw std::runtime_error ("Snappy checksum mismatch");
+            }
+        } else if (type < 0x80) {
+            throw std::runtime_error ("Unknown Snappy chunk " + std::to_string (type));
+        }
+
+        // padding and the rest of the skippable chunks are just that
+
+        p += length;
+    }
+}
+
+/******************************************************************************/
+
+void
+Codec::decode (int encoding_, const char * bytes_, size_t size_, std::vector<char> & out_) {
+    switch (encoding_) {
+        case deflate_t : inflate (bytes_, size_, out_); break;
+        case snappy_t  : unframe (bytes_, size_, out_); break;
+        default :
+            throw std::runtime_error ("Unknown encoding " + std::to_string (encoding_));
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,44 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/******************************************************************************/
+
+/**
+ * The codecs a Corda node may compress a blob's payload with, each
+ * decompressing straight from wherever the compressed bytes are, the
+ * blob's mapping say, onto the end of [out_].
+ *
+ * DEFLATE is raw, without zlib's header or trailer, as the JVM's
+ * Deflater writes it with nowrap set, and needs zlib, being reported as
+ * unsupported where the build couldn't find it. Snappy is its framing
+ * format, chunks of compressed or stored data each checked against its
+ * CRC-32C, as snappy-java's SnappyFramedOutputStream writes it.
+ */
+class Codec {
+    public :
+        enum Encoding { deflate_t = 0, snappy_t = 1 };
+
+        static void inflate (const char *, size_t, std::vector<char> & out_);
+
+        static void unframe (const char *, size_t, std::vector<char> & out_);
+
+        /**
+         * A single Snappy block, as held by one of the frames' chunks
+         */
+        static void unsnappy (const char *, size_t, std::vector<char> & out_);
+
+        static uint32_t crc32c (const char *, size_t);
+
+        /**
+         * Decompress [size_] bytes encoded as [encoding_], the ordinal the
+         * blob's encoding section gives
+         */
+        static void decode (int encoding_, const char *, size_t, std::vector<char> & out_);
+};
+
+/******************************************************************************/
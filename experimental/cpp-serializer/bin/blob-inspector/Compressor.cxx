@@ -0,0 +1,251 @@
+#include "Compressor.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined (HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "WorkStealingPool.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Frames held per worker
+     */
+    constexpr size_t FRAMES = 2;
+
+    void
+    gzip (int level_, const std::string & in_, std::string & out_) {
+#if defined (HAVE_ZLIB)
+        z_stream stream { };
+
+        // a gzip header and trailer rather than zlib's
+        if (::deflateInit2 (&stream, level_ ? level_ : Z_DEFAULT_COMPRESSION,
+                Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error ("Failed to start compressing");
+        }
+
+        out_.resize (::deflateBound (&stream, static_cast<uLong> (in_.size())));
+
+        stream.next_in = reinterpret_cast<Bytef *> (const_cast<char *> (in_.data()));
+        stream.avail_in = static_cast<uInt> (in_.size());
+        stream.next_out = reinterpret_cast<Bytef *> (out_.data());
+        stream.avail_out = static_cast<uInt> (out_.size());
+
+        auto rtn = ::deflate (&stream, Z_FINISH);
+
+        out_.resize (out_.size() - stream.avail_out);
+        ::deflateEnd (&stream);
+
+        if (rtn != Z_STREAM_END) throw std::runtime_error ("Failed to compress");
+#else
+        (void) level_; (void) in_; (void) out_;
+        throw std::runtime_error ("gzip compression needs zlib");
+#endif
+    }
+
+    void
+    zstd (int level_, const std::string & in_, std::string & out_) {
+#if defined (HAVE_ZSTD)
+        out_.resize (::ZSTD_compressBound (in_.size()));
+
+        auto rtn = ::ZSTD_compress (out_.data(), out_.size(), in_.data(), in_.size(),
+                level_ ? level_ : ZSTD_CLEVEL_DEFAULT);
+
+        if (::ZSTD_isError (rtn)) {
+            throw std::runtime_error (std::string ("Failed to compress: ") + ::ZSTD_getErrorName (rtn));
+        }
+
+        out_.resize (rtn);
+#else
+        (void) level_; (void) in_; (void) out_;
+        throw std::runtime_error ("zstd compression needs libzstd");
+#endif
+    }
+
+}
+
+/******************************************************************************/
+
+Compressor::Buffer::int_type
+Compressor::Buffer::overflow (int_type c_) {
+    if (!traits_type::eq_int_type (c_, traits_type::eof())) {
+        char c = traits_type::to_char_type (c_);
+        m_compressor.append ({ &c, 1 });
+    }
+
+    return traits_type::not_eof (c_);
+}
+
+/******************************************************************************/
+
+std::streamsize
+Compressor::Buffer::xsputn (const char * data_, std::streamsize size_) {
+    m_compressor.append ({ data_, static_cast<size_t> (size_) });
+    return size_;
+}
+
+/******************************************************************************/
+
+Compressor::Compressor (
+    std::ostream & out_,
+    Kind_t kind_,
+    int level_,
+    WorkStealingPool & pool_,
+    size_t frame_
+)
+    : m_out (out_)
+    , m_kind (kind_)
+    , m_level (level_)
+    , m_pool (pool_)
+    , m_frame (frame_ ? frame_ : 1)
+    , m_window (FRAMES * std::max<size_t> (pool_.size(), 1))
+    , m_buffer (*this)
+    , m_stream (&m_buffer)
+{
+    if (!supported (m_kind)) {
+        throw std::runtime_error (m_kind == zstd_t
+                ? "zstd compression needs libzstd"
+                : "gzip compression needs zlib");
+    }
+
+    m_current.reserve (m_frame);
+}
+
+/******************************************************************************/
+
+/**
+ * Nothing's written, but whatever's still being compressed is waited on,
+ * its task telling this when it's done
+ */
+Compressor::~Compressor() {
+    std::unique_lock<std::mutex> guard (m_lock);
+
+    for (auto & frame : m_frames) {
+        m_done.wait (guard, [&frame]() { return frame->m_done; });
+    }
+}
+
+/******************************************************************************/
+
+Compressor::Kind_t
+Compressor::kind (std::string_view name_) {
+    if (name_ == "gzip") return gzip_t;
+    if (name_ == "zstd") return zstd_t;
+
+    return none_t;
+}
+
+/******************************************************************************/
+
+bool
+Compressor::supported (Kind_t kind_) {
+    switch (kind_) {
+#if defined (HAVE_ZLIB)
+        case gzip_t : return true;
+#endif
+#if defined (HAVE_ZSTD)
+        case zstd_t : return true;
+#endif
+        default : return false;
+    }
+}
+
+/******************************************************************************/
+
+void
+Compressor::compress (Kind_t kind_, int level_, Frame & frame_) {
+    if (kind_ == zstd_t) {
+        zstd (level_, frame_.m_in, frame_.m_out);
+    } else {
+        gzip (level_, frame_.m_in, frame_.m_out);
+    }
+}
+
+/******************************************************************************/
+
+void
+Compressor::append (std::string_view data_) {
+    while (!data_.empty()) {
+        auto size = std::min (data_.size(), m_frame - m_current.size());
+
+        m_current.append (data_.data(), size);
+        data_.remove_prefix (size);
+
+        if (m_current.size() == m_frame) submit();
+    }
+}
+
+/******************************************************************************/
+
+void
+Compressor::submit() {
+    // room's made before anything more's handed to the pool
+    while (m_frames.size() >= m_window) write();
+
+    auto frame = std::make_shared<Frame>();
+    frame->m_in.swap (m_current);
+    m_current.reserve (m_frame);
+
+    m_frames.push_back (frame);
+
+    m_pool.submit ([this, frame, kind = m_kind, level = m_level]() {
+        std::string error;
+
+        try {
+            compress (kind, level, *frame);
+        } catch (const std::exception & e) {
+            error = e.what();
+        }
+
+        // nothing of the frame's needed once compressed
+        std::string().swap (frame->m_in);
+
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        frame->m_error = std::move (error);
+        frame->m_done = true;
+
+        // whilst locked, so the compressor can't be gone before it's told
+        m_done.notify_all();
+    });
+}
+
+/******************************************************************************/
+
+void
+Compressor::write() {
+    auto frame = m_frames.front();
+
+    {
+        std::unique_lock<std::mutex> guard (m_lock);
+        m_done.wait (guard, [&frame]() { return frame->m_done; });
+    }
+
+    m_frames.pop_front();
+
+    if (!frame->m_error.empty()) throw std::runtime_error (frame->m_error);
+
+    m_out.write (frame->m_out.data(), static_cast<std::streamsize> (frame->m_out.size()));
+}
+
+/******************************************************************************/
+
+void
+Compressor::finish() {
+    if (!m_current.empty()) submit();
+
+    while (!m_frames.empty()) write();
+
+    m_out.flush();
+}
+
+/******************************************************************************/
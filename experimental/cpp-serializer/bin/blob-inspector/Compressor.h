@@ -0,0 +1,136 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <condition_variable>
+
+/******************************************************************************/
+
+class WorkStealingPool;
+
+/******************************************************************************/
+
+/**
+ * Compresses what's written to it in parallel, on a [WorkStealingPool],
+ * before writing it on to an ostream, so the compression of a batch's
+ * output keeps up with however many workers are decoding it.
+ *
+ * What's written is cut into frames, each compressed on its own as a
+ * complete gzip member or zstd frame by whichever worker takes it. The
+ * frames are written out, in order, by whatever's writing to this as
+ * each is done, and concatenated frames being a valid stream of either
+ * format, gunzip and zstd -d read the whole as the one stream.
+ *
+ * At most [window] frames are held at once, being compressed or waiting
+ * for those before them to be, so once that many are held writing to
+ * this waits for the first to be done.
+ *
+ * Tasks submitted to the pool never wait on anything, so a pool whose
+ * workers are all decoding can't hold them up forever.
+ */
+class Compressor {
+    public :
+        enum Kind_t { none_t, gzip_t, zstd_t };
+
+        static constexpr size_t FRAME = 1024 * 1024;
+
+    private :
+        class Buffer : public std::streambuf {
+            private :
+                Compressor & m_compressor;
+
+            protected :
+                int_type overflow (int_type) override;
+                std::streamsize xsputn (const char *, std::streamsize) override;
+
+            public :
+                explicit Buffer (Compressor & compressor_) : m_compressor (compressor_) { }
+        };
+
+        struct Frame {
+            std::string m_in;
+            std::string m_out;
+
+            /**
+             * Set once compressed, or should compressing it have failed
+             */
+            bool m_done { false };
+            std::string m_error;
+        };
+
+        std::ostream & m_out;
+        Kind_t m_kind;
+        int m_level;
+        WorkStealingPool & m_pool;
+        size_t m_frame;
+        size_t m_window;
+
+        std::string m_current;
+
+        /**
+         * In order, those not yet written
+         */
+        std::deque<std::shared_ptr<Frame>> m_frames;
+
+        std::mutex m_lock;
+        std::condition_variable m_done;
+
+        Buffer m_buffer;
+        std::ostream m_stream;
+
+        void submit();
+
+        /**
+         * Write out the first frame once compressed
+         */
+        void write();
+
+        static void compress (Kind_t, int level_, Frame &);
+
+    public :
+        /**
+         * [level_] 0 for the format's default
+         */
+        Compressor (
+            std::ostream & out_,
+            Kind_t kind_,
+            int level_,
+            WorkStealingPool & pool_,
+            size_t frame_ = FRAME);
+
+        Compressor (const Compressor &) = delete;
+
+        /**
+         * Only what's been [finish]ed is written
+         */
+        ~Compressor();
+
+        void append (std::string_view);
+
+        /**
+         * Compress whatever's left and write out every frame
+         */
+        void finish();
+
+        std::ostream & stream() { return m_stream; }
+
+        /**
+         * "gzip" or "zstd", [none_t] for anything else
+         */
+        static Kind_t kind (std::string_view);
+
+        /**
+         * Whether the build can compress as [kind_]
+         */
+        static bool supported (Kind_t kind_);
+};
+
+/******************************************************************************/
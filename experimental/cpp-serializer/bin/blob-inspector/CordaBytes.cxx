@@ -1,38 +1,281 @@
 #include "CordaBytes.h"
 
 #include <array>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+
+#include "Codec.h"
+#include "Registry.h"
+
 #include "amqp/AMQPHeader.h"
+#include "stats/Stats.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Header plus the encoding byte
+     */
+    const size_t PREAMBLE = amqp::AMQP_HEADER.size() + 1;
+
+}
+
+/******************************************************************************/
+
+thread_local std::vector<char> CordaBytes::t_spare;
+thread_local std::vector<char> CordaBytes::t_input;
+
+/******************************************************************************/
+
+std::vector<char>
+CordaBytes::buffer() {
+    std::vector<char> rtn;
+
+    rtn.swap (t_input);
+    rtn.clear();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+CordaBytes::header (const char * bytes_, size_t size_) {
+    if (size_ < PREAMBLE
+        || std::memcmp (bytes_, amqp::AMQP_HEADER.data(), amqp::AMQP_HEADER.size()) != 0)
+    {
+        throw std::runtime_error ("Not a Corda stream");
+    }
+
+    m_encoding = static_cast<amqp::amqp_section_id_t> (
+        static_cast<unsigned char> (bytes_[amqp::AMQP_HEADER.size()]));
+
+    // Disregard the Corda header
+    m_blob = bytes_ + PREAMBLE;
+    m_size = size_ - PREAMBLE;
+
+    // one without even an encoding is left for whoever reads it to reject
+    if (m_encoding == amqp::ENCODING && m_size) decompress();
+    else if (m_encoding == amqp::REGISTERED) restore();
+}
+
+/******************************************************************************/
+
+/**
+ * An encoding section names the codec everything after it is compressed
+ * with, whatever it decompresses to starting with the section that would
+ * otherwise have followed the header.
+ *
+ * Each thread keeps the buffer the last blob it decompressed was done with
+ * so, blob after blob, decompressing needs no allocation once its
+ * capacity has grown to fit
+ */
+void
+CordaBytes::decompress() {
+    const auto encoding = static_cast<unsigned char> (m_blob[0]);
+
+    m_decompressed.swap (t_spare);
+    m_decompressed.clear();
+
+    Codec::decode (encoding, m_blob + 1, m_size - 1, m_decompressed);
+
+    if (m_decompressed.empty()) throw std::runtime_error ("Compressed blob holds nothing");
+
+    m_compression = encoding;
+    m_encoding = static_cast<amqp::amqp_section_id_t> (
+        static_cast<unsigned char> (m_decompressed[0]));
+
+    if (m_encoding == amqp::ENCODING) {
+        throw std::runtime_error ("Blobs are only ever compressed once");
+    }
+
+    m_blob = m_decompressed.data() + 1;
+    m_size = m_decompressed.size() - 1;
+}
+
+/******************************************************************************/
+
+/**
+ * A blob stripped of its schema, see [Registry], put back together into
+ * the same buffer a decompressed one would be
+ */
+void
+CordaBytes::restore() {
+    auto registry = Registry::attached();
+
+    if (!registry) {
+        throw std::runtime_error ("Blob's schema is in a registry and none was given");
+    }
+
+    m_decompressed.swap (t_spare);
+    m_decompressed.clear();
+
+    registry->restore (m_blob, m_size, m_decompressed);
+
+    m_encoding = amqp::DATA_AND_STOP;
+    m_blob = m_decompressed.data() + 1;
+    m_size = m_decompressed.size() - 1;
+}
+
+/******************************************************************************/
+
+void
+CordaBytes::drain (int fd_) {
+    constexpr size_t CHUNK = 64 * 1024;
+
+    m_heap = buffer();
+
+    for (;;) {
+        auto at = m_heap.size();
+        m_heap.resize (at + CHUNK);
+
+        auto rtn = ::read (fd_, m_heap.data() + at, CHUNK);
+
+        if (rtn < 0 && errno == EINTR) {
+            m_heap.resize (at);
+            continue;
+        }
+
+        if (rtn < 0) throw std::runtime_error ("Failed reading blob");
+
+        m_heap.resize (at + static_cast<size_t> (rtn));
+        if (rtn == 0) return;
+    }
+}
 
 /******************************************************************************/
 
 CordaBytes::CordaBytes (const std::string & file_)
     : m_blob { nullptr }
+    , m_compression { -1 }
+    , m_map { MAP_FAILED }
+    , m_mapSize { 0 }
 {
-    std::ifstream file { file_, std::ios::in | std::ios::binary };
+    amqp::internal::stats::Stats::Timer timer (amqp::internal::stats::Stats::io_t);
+
+    int fd = ::open (file_.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw std::runtime_error ("Not a file");
+    }
+
     struct stat results { };
 
-    if (::stat(file_.c_str(), &results) != 0) {
+    if (::fstat (fd, &results) != 0) {
+        ::close (fd);
         throw std::runtime_error ("Not a file");
     }
 
-    // Disregard the Corda header
-    m_size = results.st_size - (amqp::AMQP_HEADER.size() + 1);
+    // pipes, sockets and the like, /dev/stdin or <(psql ...) say, can't
+    // be mapped or sized so are read until they end
+    if (S_ISFIFO (results.st_mode) || S_ISSOCK (results.st_mode) || S_ISCHR (results.st_mode)) {
+        try {
+            drain (fd);
+        } catch (...) {
+            ::close (fd);
+            throw;
+        }
 
-    std::array<char, 7> header { };
-    file.read (header.data(), 7);
+        ::close (fd);
+        header (m_heap.data(), m_heap.size());
+        return;
+    }
 
-    if (header != amqp::AMQP_HEADER) {
+    if (!S_ISREG (results.st_mode)) {
+        ::close (fd);
+        throw std::runtime_error ("Not a file");
+    }
+
+    m_mapSize = results.st_size;
+
+    if (m_mapSize < PREAMBLE) {
+        ::close (fd);
         throw std::runtime_error ("Not a Corda stream");
     }
 
-    file.read (reinterpret_cast<char *>(&m_encoding), 1);
+    m_map = ::mmap (nullptr, m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
 
-    m_blob = new char[m_size];
+    // the mapping holds its own reference to the file
+    ::close (fd);
 
-    memset (m_blob, 0, m_size);
-    file.read (m_blob, m_size);
+    if (m_map == MAP_FAILED) {
+        throw std::runtime_error ("Failed to map " + file_);
+    }
+
+    // we only ever walk the blob front to back
+    ::madvise (m_map, m_mapSize, MADV_SEQUENTIAL);
+
+    try {
+        header (static_cast<const char *>(m_map), m_mapSize);
+    } catch (...) {
+        ::munmap (m_map, m_mapSize);
+        throw;
+    }
 }
 
 /******************************************************************************/
 
+CordaBytes::CordaBytes (std::istream & stream_)
+    : m_blob { nullptr }
+    , m_compression { -1 }
+    , m_map { MAP_FAILED }
+    , m_mapSize { 0 }
+{
+    amqp::internal::stats::Stats::Timer timer (amqp::internal::stats::Stats::io_t);
+
+    m_heap = buffer();
+    m_heap.assign (
+        std::istreambuf_iterator<char> (stream_),
+        std::istreambuf_iterator<char>());
+
+    header (m_heap.data(), m_heap.size());
+}
+
+/******************************************************************************/
+
+CordaBytes::CordaBytes (std::vector<char> bytes_)
+    : m_blob { nullptr }
+    , m_compression { -1 }
+    , m_map { MAP_FAILED }
+    , m_mapSize { 0 }
+    , m_heap { std::move (bytes_) }
+{
+    header (m_heap.data(), m_heap.size());
+}
+
+/******************************************************************************/
+
+CordaBytes::CordaBytes (const char * bytes_, size_t size_)
+    : m_blob { nullptr }
+    , m_compression { -1 }
+    , m_map { MAP_FAILED }
+    , m_mapSize { 0 }
+{
+    header (bytes_, size_);
+}
+
+/******************************************************************************/
+
+CordaBytes::~CordaBytes() {
+    if (m_map != MAP_FAILED) {
+        ::munmap (m_map, m_mapSize);
+    }
+
+    if (m_decompressed.capacity() > t_spare.capacity()) {
+        t_spare.swap (m_decompressed);
+    }
+
+    if (m_heap.capacity() > t_input.capacity()) {
+        t_input.swap (m_heap);
+    }
+}
+
+/******************************************************************************/
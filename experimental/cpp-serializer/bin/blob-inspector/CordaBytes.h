@@ -1,23 +1,74 @@
 #pragma once
 
 #include "string"
+#include <iosfwd>
+#include <vector>
 #include <fstream>
 #include "amqp/AMQPSectionId.h"
 
 /******************************************************************************/
 
+/**
+ * The payload of a serialised Corda blob, that is everything following the
+ * 7 byte AMQP header and the single byte encoding section id. A payload
+ * compressed with DEFLATE or Snappy, as Corda nodes can be configured to
+ * write them, is decompressed into a buffer of our own, see [Codec], its
+ * encoding then being that of the section that was compressed.
+ *
+ * When built from a file name that file is mapped read only into memory,
+ * avoiding the heap copy, unless it's a pipe or socket, which is read
+ * until it ends. Streams, such as stdin or a pipe, which can't be
+ * mapped are instead read in their entirety into a heap buffer, and a
+ * blob already read into one, off a socket say, takes that buffer over.
+ * One already in memory elsewhere can be used where it is, in which case
+ * it has to outlive us.
+ *
+ * A blob whose schema was moved into a [Registry] is restored from the
+ * one attached, again into a buffer of our own.
+ */
 class CordaBytes {
     private :
         amqp::amqp_section_id_t m_encoding;
         size_t m_size;
-        char * m_blob;
+        const char * m_blob;
+
+        /**
+         * The [Codec::Encoding] the payload was compressed with, -1 when
+         * it wasn't
+         */
+        int m_compression;
+        std::vector<char> m_decompressed;
+
+        static thread_local std::vector<char> t_spare;
+
+        /**
+         * The heap buffer the last blob this thread read in was done with
+         */
+        static thread_local std::vector<char> t_input;
+
+        /**
+         * Only one of these will ever be set depending on how we were
+         * constructed
+         */
+        void * m_map;
+        size_t m_mapSize;
+        std::vector<char> m_heap;
+
+        void header (const char *, size_t);
+        void drain (int fd_);
+        void decompress();
+        void restore();
 
     public :
         explicit CordaBytes (const std::string &);
+        explicit CordaBytes (std::istream &);
+        explicit CordaBytes (std::vector<char>);
+        CordaBytes (const char *, size_t);
 
-        ~CordaBytes() {
-            delete [] m_blob;
-        }
+        CordaBytes (const CordaBytes &) = delete;
+        CordaBytes & operator = (const CordaBytes &) = delete;
+
+        ~CordaBytes();
 
         const decltype (m_encoding) & encoding() const {
             return m_encoding;
@@ -25,7 +76,17 @@ class CordaBytes {
 
         decltype (m_size) size() const { return m_size; }
 
-        const char * const bytes() const { return m_blob; }
+        int compression() const { return m_compression; }
+
+        /**
+         * An empty buffer to read a blob into before handing it over,
+         * the one this thread's last blob read onto the heap was done
+         * with, so reading blob after blob needs no allocation once its
+         * capacity has grown to fit
+         */
+        static std::vector<char> buffer();
+
+        const char * bytes() const { return m_blob; }
 };
 
 /******************************************************************************/
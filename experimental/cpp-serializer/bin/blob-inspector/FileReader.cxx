@@ -0,0 +1,529 @@
+#include "FileReader.h"
+
+#include <atomic>
+#include <optional>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined (HAVE_IO_URING)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "WorkStealingPool.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Most blobs fit in the first read of a fresh buffer
+     */
+    constexpr size_t INITIAL = 64 * 1024;
+
+    /**
+     * Past this many threads preads just queue up on the device
+     */
+    constexpr size_t MAX_THREADS = 8;
+
+    /**************************************************************************/
+
+    class Pread : public FileReader {
+        private :
+            static bool open (const std::string &, int & fd_, size_t & size_);
+            static bool fill (int fd_, Buffer &, size_t size_);
+
+        public :
+            Pread (size_t depth_, Pages::Kind pages_, size_t nodes_)
+                : FileReader (depth_, pages_, nodes_)
+            { }
+
+            void read (const std::vector<std::string> &, const Done &) override;
+
+            const char * name() const override { return "pread"; }
+    };
+
+    /**************************************************************************/
+
+#if defined (HAVE_IO_URING)
+
+    class Uring : public FileReader {
+        private :
+            /**
+             * A read in flight, its file being closed through the ring
+             * once the read completes. The buffer's emplaced, a pooled
+             * buffer assigned to it instead being copied into the heap
+             */
+            struct Slot {
+                size_t m_index;
+                int m_fd;
+                std::optional<Buffer> m_buffer;
+                size_t m_size;
+            };
+
+            /**
+             * The user data of a close, whose completion needs nothing
+             * doing
+             */
+            static constexpr uint64_t CLOSE = ~uint64_t { 0 };
+
+            int m_ring;
+
+            void * m_sq;
+            size_t m_sqSize;
+            void * m_cq;
+            size_t m_cqSize;
+
+            io_uring_sqe * m_sqes;
+            size_t m_sqesSize;
+
+            unsigned * m_sqHead;
+            unsigned * m_sqTail;
+            unsigned * m_sqMask;
+            unsigned * m_sqEntries;
+            unsigned * m_sqArray;
+
+            unsigned * m_cqHead;
+            unsigned * m_cqTail;
+            unsigned * m_cqMask;
+            io_uring_cqe * m_cqes;
+
+            unsigned m_unsubmitted;
+
+            void unmap();
+
+            io_uring_sqe * sqe();
+            void enter (unsigned wait_);
+            void submit (Slot &, size_t slot_);
+
+        public :
+            Uring (size_t depth_, Pages::Kind, size_t nodes_);
+
+            ~Uring() override;
+
+            void read (const std::vector<std::string> &, const Done &) override;
+
+            const char * name() const override { return "io_uring"; }
+    };
+
+#endif
+
+}
+
+/******************************************************************************
+ *
+ * FileReader
+ *
+ ******************************************************************************/
+
+FileReader::FileReader (size_t depth_, Pages::Kind pages_, size_t nodes_)
+    : m_outstanding (0)
+    , m_depth (std::max<size_t> (depth_, 1))
+{
+    nodes_ = std::max<size_t> (nodes_, 1);
+
+    for (size_t node { 0 } ; node < nodes_ ; ++node) {
+        m_resources.push_back (pages_ == Pages::normal_t && nodes_ == 1
+            ? std::pmr::new_delete_resource()
+            : Pages::get (pages_, nodes_ > 1 ? static_cast<int> (node) : -1));
+    }
+
+    m_buffers.resize (nodes_);
+}
+
+/******************************************************************************/
+
+FileReader::Buffer
+FileReader::buffer (size_t index_) {
+    const auto node = index_ % m_resources.size();
+
+    std::unique_lock<std::mutex> guard (m_lock);
+
+    m_free.wait (guard, [this]() { return m_outstanding < 2 * m_depth; });
+
+    ++m_outstanding;
+
+    auto & pool = m_buffers[node];
+
+    if (pool.empty()) return Buffer (m_resources[node]);
+
+    auto rtn = std::move (pool.back());
+    pool.pop_back();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+FileReader::recycle (Buffer && buffer_) {
+    if (buffer_.empty()) return;
+
+    const auto * resource = buffer_.get_allocator().resource();
+    const auto node = static_cast<size_t> (
+        std::find (m_resources.begin(), m_resources.end(), resource) - m_resources.begin());
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        m_buffers[node < m_buffers.size() ? node : 0].emplace_back (std::move (buffer_));
+        --m_outstanding;
+    }
+
+    m_free.notify_one();
+}
+
+/******************************************************************************/
+
+std::unique_ptr<FileReader>
+FileReader::make (Backend backend_, size_t depth_, Pages::Kind pages_, size_t nodes_) {
+#if defined (HAVE_IO_URING)
+    if (backend_ != pread_t) {
+        try {
+            return std::make_unique<Uring> (depth_, pages_, nodes_);
+        } catch (const std::exception &) {
+            // seccomp'd containers and old kernels refuse rings
+            if (backend_ == uring_t) throw;
+        }
+    }
+#else
+    if (backend_ == uring_t) throw std::runtime_error ("No io_uring");
+#endif
+
+    return std::make_unique<Pread> (depth_, pages_, nodes_);
+}
+
+/******************************************************************************
+ *
+ * Pread
+ *
+ ******************************************************************************/
+
+bool
+Pread::open (const std::string & file_, int & fd_, size_t & size_) {
+    fd_ = ::open (file_.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd_ < 0) return false;
+
+    struct stat results { };
+
+    if (::fstat (fd_, &results) != 0 || !S_ISREG (results.st_mode)) {
+        ::close (fd_);
+        return false;
+    }
+
+    size_ = static_cast<size_t> (results.st_size);
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+Pread::fill (int fd_, Buffer & buffer_, size_t size_) {
+    if (buffer_.size() < std::max (size_, INITIAL)) buffer_.resize (std::max (size_, INITIAL));
+
+    size_t read { 0 };
+
+    while (read < size_) {
+        auto rtn = ::pread (fd_, buffer_.data() + read, size_ - read, static_cast<off_t> (read));
+
+        if (rtn < 0 && errno == EINTR) continue;
+        if (rtn <= 0) break;
+
+        read += static_cast<size_t> (rtn);
+    }
+
+    return read == size_;
+}
+
+/******************************************************************************/
+
+void
+Pread::read (const std::vector<std::string> & files_, const Done & done_) {
+    WorkStealingPool pool (std::min (m_depth, MAX_THREADS));
+
+    for (size_t i { 0 } ; i < files_.size() ; ++i) {
+        pool.submit ([&, i]() {
+            int fd;
+            size_t size;
+
+            if (!open (files_[i], fd, size)) {
+                done_ (i, { }, 0, "Not a file");
+                return;
+            }
+
+            // constructed rather than assigned so it keeps its node's memory
+            auto buffer = this->buffer (i);
+            bool ok = fill (fd, buffer, size);
+
+            ::close (fd);
+
+            if (ok) {
+                done_ (i, std::move (buffer), size, nullptr);
+            } else {
+                recycle (std::move (buffer));
+                done_ (i, { }, 0, "Failed reading blob");
+            }
+        });
+    }
+
+    pool.wait();
+}
+
+/******************************************************************************
+ *
+ * Uring
+ *
+ ******************************************************************************/
+
+#if defined (HAVE_IO_URING)
+
+/**
+ * Room in the submission queue for a read and a close per slot, the
+ * completion queue the kernel sizes at twice that never overflowing
+ */
+Uring::Uring (size_t depth_, Pages::Kind pages_, size_t nodes_)
+    : FileReader (depth_, pages_, nodes_)
+    , m_sq (MAP_FAILED)
+    , m_cq (MAP_FAILED)
+    , m_sqes (static_cast<io_uring_sqe *> (MAP_FAILED))
+    , m_unsubmitted (0)
+{
+    io_uring_params params { };
+
+    m_ring = static_cast<int> (::syscall (__NR_io_uring_setup, static_cast<unsigned> (2 * m_depth), &params));
+
+    if (m_ring < 0) throw std::runtime_error ("No io_uring");
+
+    m_sqSize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+    m_sqesSize = params.sq_entries * sizeof (io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        m_sqSize = m_cqSize = std::max (m_sqSize, m_cqSize);
+    }
+
+    m_sq = ::mmap (nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+
+    m_cq = (params.features & IORING_FEAT_SINGLE_MMAP)
+        ? m_sq
+        : ::mmap (nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+
+    m_sqes = static_cast<io_uring_sqe *> (::mmap (
+        nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES));
+
+    if (m_sq == MAP_FAILED || m_cq == MAP_FAILED || m_sqes == MAP_FAILED) {
+        unmap();
+        throw std::runtime_error ("Failed to map io_uring");
+    }
+
+    auto * sq = static_cast<char *> (m_sq);
+    auto * cq = static_cast<char *> (m_cq);
+
+    m_sqHead    = reinterpret_cast<unsigned *> (sq + params.sq_off.head);
+    m_sqTail    = reinterpret_cast<unsigned *> (sq + params.sq_off.tail);
+    m_sqMask    = reinterpret_cast<unsigned *> (sq + params.sq_off.ring_mask);
+    m_sqEntries = reinterpret_cast<unsigned *> (sq + params.sq_off.ring_entries);
+    m_sqArray   = reinterpret_cast<unsigned *> (sq + params.sq_off.array);
+
+    m_cqHead = reinterpret_cast<unsigned *> (cq + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned *> (cq + params.cq_off.tail);
+    m_cqMask = reinterpret_cast<unsigned *> (cq + params.cq_off.ring_mask);
+    m_cqes   = reinterpret_cast<io_uring_cqe *> (cq + params.cq_off.cqes);
+}
+
+/******************************************************************************/
+
+Uring::~Uring() {
+    unmap();
+}
+
+/******************************************************************************/
+
+void
+Uring::unmap() {
+    if (m_sqes != MAP_FAILED) ::munmap (m_sqes, m_sqesSize);
+    if (m_cq != MAP_FAILED && m_cq != m_sq) ::munmap (m_cq, m_cqSize);
+    if (m_sq != MAP_FAILED) ::munmap (m_sq, m_sqSize);
+
+    m_sqes = static_cast<io_uring_sqe *> (MAP_FAILED);
+    m_cq = m_sq = MAP_FAILED;
+
+    if (m_ring >= 0) ::close (m_ring);
+    m_ring = -1;
+}
+
+/******************************************************************************/
+
+/**
+ * Submit everything queued, waiting for [wait_] completions
+ */
+void
+Uring::enter (unsigned wait_) {
+    for (;;) {
+        auto rtn = ::syscall (
+            __NR_io_uring_enter, m_ring, m_unsubmitted, wait_,
+            wait_ ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+
+        if (rtn >= 0) {
+            m_unsubmitted -= static_cast<unsigned> (rtn);
+            return;
+        }
+
+        if (errno != EINTR) throw std::runtime_error ("io_uring failed");
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * The next free submission, zeroed, queued once written by bumping the
+ * tail. A full queue is submitted to make room
+ */
+io_uring_sqe *
+Uring::sqe() {
+    auto tail = *m_sqTail;
+
+    while (tail - __atomic_load_n (m_sqHead, __ATOMIC_ACQUIRE) == *m_sqEntries) {
+        enter (0);
+    }
+
+    auto index = tail & *m_sqMask;
+    auto * rtn = &m_sqes[index];
+
+    std::memset (rtn, 0, sizeof (*rtn));
+    m_sqArray[index] = index;
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Uring::submit (Slot & slot_, size_t index_) {
+    auto * read = sqe();
+
+    read->opcode    = IORING_OP_READ;
+    read->fd        = slot_.m_fd;
+    read->off       = slot_.m_size;
+    read->addr      = reinterpret_cast<uint64_t> (slot_.m_buffer->data() + slot_.m_size);
+    read->len       = static_cast<uint32_t> (slot_.m_buffer->size() - slot_.m_size);
+    read->user_data = index_;
+
+    __atomic_store_n (m_sqTail, *m_sqTail + 1, __ATOMIC_RELEASE);
+    ++m_unsubmitted;
+}
+
+/******************************************************************************/
+
+/**
+ * Files are opened as they're queued but read and closed by the ring, a
+ * read filling its buffer being taken to mean there's more, the buffer
+ * then being doubled and read into again. Only files too big for their
+ * buffer need more than one read
+ */
+void
+Uring::read (const std::vector<std::string> & files_, const Done & done_) {
+    std::vector<Slot> slots (m_depth);
+    std::vector<size_t> free;
+
+    for (size_t i { m_depth } ; i-- ; ) free.push_back (i);
+
+    size_t next { 0 };
+    size_t closes { 0 };
+
+    for (;;) {
+        while (!free.empty() && next < files_.size()) {
+            auto i = next++;
+            int fd = ::open (files_[i].c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd < 0) {
+                done_ (i, { }, 0, "Not a file");
+                continue;
+            }
+
+            auto index = free.back();
+            free.pop_back();
+
+            auto & slot = slots[index];
+
+            slot.m_index  = i;
+            slot.m_fd     = fd;
+            slot.m_size   = 0;
+            slot.m_buffer.emplace (buffer (i));
+
+            if (slot.m_buffer->size() < INITIAL) slot.m_buffer->resize (INITIAL);
+
+            submit (slot, index);
+        }
+
+        // with nothing in flight every file's been read
+        if (free.size() == m_depth && closes == 0) break;
+
+        enter (1);
+
+        auto head = *m_cqHead;
+
+        for ( ; head != __atomic_load_n (m_cqTail, __ATOMIC_ACQUIRE) ; ++head) {
+            const auto & cqe = m_cqes[head & *m_cqMask];
+
+            if (cqe.user_data == CLOSE) {
+                --closes;
+                continue;
+            }
+
+            auto index = static_cast<size_t> (cqe.user_data);
+            auto & slot = slots[index];
+
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                submit (slot, index);
+                continue;
+            }
+
+            if (cqe.res > 0) {
+                slot.m_size += static_cast<size_t> (cqe.res);
+
+                if (slot.m_size == slot.m_buffer->size()) {
+                    slot.m_buffer->resize (2 * slot.m_buffer->size());
+                    submit (slot, index);
+                    continue;
+                }
+            }
+
+            auto * close = sqe();
+
+            close->opcode    = IORING_OP_CLOSE;
+            close->fd        = slot.m_fd;
+            close->user_data = CLOSE;
+
+            __atomic_store_n (m_sqTail, *m_sqTail + 1, __ATOMIC_RELEASE);
+            ++m_unsubmitted;
+            ++closes;
+
+            if (cqe.res < 0) {
+                recycle (std::move (*slot.m_buffer));
+                done_ (slot.m_index, { }, 0, "Failed reading blob");
+            } else {
+                done_ (slot.m_index, std::move (*slot.m_buffer), slot.m_size, nullptr);
+            }
+
+            slot.m_buffer.reset();
+
+            free.push_back (index);
+        }
+
+        __atomic_store_n (m_cqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+#endif
+
+/******************************************************************************/
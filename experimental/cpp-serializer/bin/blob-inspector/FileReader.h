@@ -0,0 +1,110 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory_resource>
+#include <condition_variable>
+
+#include "Numa.h"
+
+/******************************************************************************/
+
+/**
+ * Reads a batch's files ahead of the workers decoding them, keeping many
+ * reads in flight at once rather than each worker opening, sizing,
+ * mapping and closing its files one after another, which for small blobs
+ * on fast storage costs more than decoding them.
+ *
+ * Where the kernel offers it files are read through an io_uring, a queue
+ * of reads submitted and reaped together with a single system call, each
+ * read's file closed by the ring too. Elsewhere, and wherever a ring
+ * can't be set up, a few threads pread them instead.
+ *
+ * Files are read into buffers drawn from a pool of at most twice the
+ * queue depth, so no more than that many blobs are held at once however
+ * far decoding falls behind. A buffer is handed over with its blob and
+ * must be given back, see [recycle], once the blob's been decoded, its
+ * capacity then serving whichever file's read next.
+ *
+ * Buffers can be mapped with huge pages, see [Pages], and spread over a
+ * machine's NUMA nodes, file i being read into memory on node i modulo
+ * their number, from a pool of that node's buffers, for a worker pinned
+ * to the node to decode.
+ */
+class FileReader {
+    public :
+        enum Backend { any_t, uring_t, pread_t };
+
+        using Buffer = std::pmr::vector<char>;
+
+        /**
+         * Called, from the reader's own threads, as each file has been
+         * read, with the file's index, the buffer holding its first
+         * [size_] bytes and, if it couldn't be read, why not, in which
+         * case the buffer's empty and needn't be recycled. A buffer is
+         * kept at its full size, not its blob's, so reusing one never
+         * needs it zeroed again
+         */
+        using Done = std::function<void (size_t, Buffer &&, size_t size_, const char * error_)>;
+
+    private :
+        std::mutex m_lock;
+        std::condition_variable m_free;
+
+        /**
+         * Each node's memory and the buffers made from it
+         */
+        std::vector<std::pmr::memory_resource *> m_resources;
+        std::vector<std::vector<Buffer>> m_buffers;
+        size_t m_outstanding;
+
+    protected :
+        const size_t m_depth;
+
+        FileReader (size_t depth_, Pages::Kind, size_t nodes_);
+
+        /**
+         * A buffer for the [index_]th file from its node's pool, waiting
+         * for one to be recycled if every one is out
+         */
+        Buffer buffer (size_t index_);
+
+    public :
+        virtual ~FileReader() = default;
+
+        FileReader (const FileReader &) = delete;
+
+        /**
+         * Read every one of [files_], returning once [done_] has been
+         * called for each
+         */
+        virtual void read (const std::vector<std::string> & files_, const Done & done_) = 0;
+
+        virtual const char * name() const = 0;
+
+        /**
+         * Give back a buffer [Done] was handed, empty ones being ignored
+         */
+        void recycle (Buffer &&);
+
+        size_t nodes() const { return m_resources.size(); }
+
+        /**
+         * A reader keeping [depth_] reads in flight, through an io_uring
+         * if asked for one or any will do and one can be set up, into
+         * buffers of [pages_] spread over [nodes_] nodes. Asking for an
+         * io_uring where there isn't one throws
+         */
+        static std::unique_ptr<FileReader> make (
+            Backend = any_t,
+            size_t depth_ = 64,
+            Pages::Kind pages_ = Pages::normal_t,
+            size_t nodes_ = 1);
+};
+
+/******************************************************************************/
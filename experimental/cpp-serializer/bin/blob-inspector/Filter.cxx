@@ -0,0 +1,619 @@
+#include "Filter.h"
+
+#include <cctype>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Thrown by the sink to stop decoding as soon as the filter's decided
+     */
+    struct Decided {
+        bool m_result;
+    };
+
+    bool
+    identifier (char c_) {
+        return std::isalnum (static_cast<unsigned char> (c_)) || c_ == '_' || c_ == '$';
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Filter::Parser
+ *
+ ******************************************************************************/
+
+/**
+ * Recursive descent over
+ *
+ *      or        := and ("or" and)*
+ *      and       := unary ("and" unary)*
+ *      unary     := "not" unary | "(" or ")" | predicate
+ *      predicate := path compare literal
+ *                 | path "in" "(" literal ("," literal)* ")"
+ *                 | path "~" string
+ */
+class Filter::Parser {
+    private :
+        Filter & m_filter;
+        const std::string & m_text;
+        size_t m_at;
+
+        [[noreturn]] void fail (const std::string & what_) const {
+            throw std::runtime_error (
+                "Bad filter, " + what_ + " at " + std::to_string (m_at) + " in \"" + m_text + "\"");
+        }
+
+        void space() {
+            while (m_at < m_text.size() && std::isspace (static_cast<unsigned char> (m_text[m_at]))) ++m_at;
+        }
+
+        /**
+         * Consume [token_] if it's next, a word only if it isn't just the
+         * start of a longer one
+         */
+        bool accept (std::string_view token_) {
+            space();
+
+            if (m_text.compare (m_at, token_.size(), token_) != 0) return false;
+
+            if (identifier (token_.back())
+                && m_at + token_.size() < m_text.size()
+                && identifier (m_text[m_at + token_.size()]))
+            {
+                return false;
+            }
+
+            m_at += token_.size();
+            return true;
+        }
+
+        void expect (std::string_view token_) {
+            if (!accept (token_)) fail ("expected \"" + std::string (token_) + "\"");
+        }
+
+        size_t node (Node::Op op_, size_t left_, size_t right_ = 0) {
+            m_filter.m_nodes.push_back ({ op_, left_, right_ });
+            return m_filter.m_nodes.size() - 1;
+        }
+
+        std::string path();
+        std::string quoted();
+        Literal literal();
+
+        size_t predicate();
+        size_t unary();
+        size_t conjunction();
+        size_t disjunction();
+
+    public :
+        Parser (Filter & filter_, const std::string & text_)
+            : m_filter (filter_)
+            , m_text (text_)
+            , m_at (0)
+        { }
+
+        void parse() {
+            disjunction();
+
+            space();
+            if (m_at != m_text.size()) fail ("unexpected text");
+        }
+};
+
+/******************************************************************************/
+
+std::string
+Filter::Parser::path() {
+    space();
+
+    auto start = m_at;
+    while (m_at < m_text.size() && (identifier (m_text[m_at]) || m_text[m_at] == '.')) ++m_at;
+
+    auto rtn = m_text.substr (start, m_at - start);
+
+    if (rtn.empty() || rtn.front() == '.' || rtn.back() == '.' || rtn.find ("..") != std::string::npos) {
+        fail ("expected a field");
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string
+Filter::Parser::quoted() {
+    space();
+
+    if (m_at == m_text.size() || (m_text[m_at] != '"' && m_text[m_at] != '\'')) {
+        fail ("expected a string");
+    }
+
+    const auto quote = m_text[m_at++];
+    std::string rtn;
+
+    for (;;) {
+        if (m_at == m_text.size()) fail ("unterminated string");
+
+        auto c = m_text[m_at++];
+
+        if (c == quote) return rtn;
+
+        if (c == '\\') {
+            if (m_at == m_text.size()) fail ("unterminated string");
+            c = m_text[m_at++];
+        }
+
+        rtn.push_back (c);
+    }
+}
+
+/******************************************************************************/
+
+Filter::Literal
+Filter::Parser::literal() {
+    Literal rtn { Literal::null_t };
+
+    space();
+
+    if (accept ("null")) return rtn;
+
+    if (accept ("true") || accept ("false")) {
+        rtn.m_type = Literal::bool_t;
+        rtn.m_bool = m_text[m_at - 1] == 'e' && m_text[m_at - 2] == 'u';
+        return rtn;
+    }
+
+    if (m_at < m_text.size() && (m_text[m_at] == '"' || m_text[m_at] == '\'')) {
+        rtn.m_type = Literal::string_t;
+        rtn.m_string = quoted();
+        return rtn;
+    }
+
+    const char * start = m_text.c_str() + m_at;
+    char * end;
+
+    auto integer = std::strtoll (start, &end, 10);
+    auto length = end - start;
+
+    auto real = std::strtod (start, &end);
+
+    if (end == start) fail ("expected a value");
+
+    if (end - start > length) {
+        rtn.m_type = Literal::real_t;
+        rtn.m_real = real;
+    } else {
+        rtn.m_type = Literal::int_t;
+        rtn.m_int = integer;
+    }
+
+    m_at += static_cast<size_t> (end - start);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+Filter::Parser::predicate() {
+    auto field = path();
+
+    Atom atom;
+
+    if (accept ("in")) {
+        atom.m_compare = in_t;
+
+        expect ("(");
+        do {
+            atom.m_literals.push_back (literal());
+        } while (accept (","));
+        expect (")");
+    } else if (accept ("~")) {
+        atom.m_compare = match_t;
+
+        auto pattern = quoted();
+
+        try {
+            atom.m_regex = std::regex (pattern, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error & e) {
+            fail (std::string ("bad regular expression, ") + e.what());
+        }
+    } else {
+        if (accept ("==") || accept ("=")) {
+            atom.m_compare = eq_t;
+        } else if (accept ("!=")) {
+            atom.m_compare = ne_t;
+        } else if (accept ("<=")) {
+            atom.m_compare = le_t;
+        } else if (accept (">=")) {
+            atom.m_compare = ge_t;
+        } else if (accept ("<")) {
+            atom.m_compare = lt_t;
+        } else if (accept (">")) {
+            atom.m_compare = gt_t;
+        } else {
+            fail ("expected a comparison");
+        }
+
+        atom.m_literals.push_back (literal());
+    }
+
+    // every predicate on a field hangs off the field's place in the tree
+    auto * at = &m_filter.m_root;
+
+    for (size_t start { 0 } ; ; ) {
+        auto dot = field.find ('.', start);
+        at = &at->m_fields[field.substr (start, dot - start)];
+
+        if (dot == std::string::npos) break;
+        start = dot + 1;
+    }
+
+    at->m_atoms.push_back (m_filter.m_atoms.size());
+    m_filter.m_atoms.emplace_back (std::move (atom));
+
+    if (std::find (m_filter.m_paths.begin(), m_filter.m_paths.end(), field) == m_filter.m_paths.end()) {
+        m_filter.m_paths.emplace_back (std::move (field));
+    }
+
+    return node (Node::atom_t, m_filter.m_atoms.size() - 1);
+}
+
+/******************************************************************************/
+
+size_t
+Filter::Parser::unary() {
+    if (accept ("not") || accept ("!")) {
+        return node (Node::not_t, unary());
+    }
+
+    if (accept ("(")) {
+        auto rtn = disjunction();
+        expect (")");
+        return rtn;
+    }
+
+    return predicate();
+}
+
+/******************************************************************************/
+
+size_t
+Filter::Parser::conjunction() {
+    auto rtn = unary();
+
+    while (accept ("and") || accept ("&&")) {
+        auto right = unary();
+        rtn = node (Node::and_t, rtn, right);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+Filter::Parser::disjunction() {
+    auto rtn = conjunction();
+
+    while (accept ("or") || accept ("||")) {
+        auto right = conjunction();
+        rtn = node (Node::or_t, rtn, right);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************
+ *
+ * Filter::Evaluation
+ *
+ ******************************************************************************/
+
+/**
+ * Follows the projection down the tree of fields, testing each scalar
+ * that lands on a field with predicates. Outside of any list a field has
+ * just the one value so its predicates are then decided, within one they
+ * only hold once an element's value does
+ */
+class Filter::Evaluation : public amqp::reader::ISink {
+    private :
+        struct Level {
+            const Field * m_field;
+            bool m_list;
+        };
+
+        const Filter & m_filter;
+
+        std::vector<Truth> m_truths;
+        std::vector<Level> m_levels;
+
+        /**
+         * Where the next value goes, as set by the last key
+         */
+        const Field * m_next;
+        size_t m_lists;
+
+        const Field * field() const {
+            return !m_levels.empty() && m_levels.back().m_list ? m_levels.back().m_field : m_next;
+        }
+
+        void open (bool list_) {
+            auto * at = field();
+
+            m_levels.push_back ({ at, list_ });
+            if (list_) ++m_lists;
+        }
+
+        void close() {
+            if (m_levels.back().m_list) --m_lists;
+            m_levels.pop_back();
+
+            m_next = nullptr;
+        }
+
+        void value (const Literal &);
+
+    public :
+        explicit Evaluation (const Filter & filter_)
+            : m_filter (filter_)
+            , m_truths (filter_.m_atoms.size(), unknown_t)
+            , m_next (&filter_.m_root)
+            , m_lists (0)
+        { }
+
+        /**
+         * Once everything's been seen whatever's still undecided is false
+         */
+        bool result() {
+            for (auto & truth : m_truths) {
+                if (truth == unknown_t) truth = false_t;
+            }
+
+            return m_filter.truth (m_filter.m_nodes.size() - 1, m_truths) == true_t;
+        }
+
+        void beginObject() override { open (false); }
+        void endObject() override { close(); }
+        void beginList() override { open (true); }
+        void endList() override { close(); }
+
+        // the tree of fields never runs through a map
+        void beginMap() override { m_next = nullptr; open (false); }
+        void endMap() override { close(); }
+
+        void key (std::string_view key_) override {
+            const auto * parent = m_levels.empty() ? nullptr : m_levels.back().m_field;
+
+            if (!parent) {
+                m_next = nullptr;
+                return;
+            }
+
+            auto it = parent->m_fields.find (key_);
+            m_next = it == parent->m_fields.end() ? nullptr : &it->second;
+        }
+
+        void null() override {
+            value ({ Literal::null_t });
+        }
+
+        void boolean (bool v_) override {
+            Literal l { Literal::bool_t };
+            l.m_bool = v_;
+            value (l);
+        }
+
+        void integer (int64_t v_) override {
+            Literal l { Literal::int_t };
+            l.m_int = v_;
+            value (l);
+        }
+
+        void real (double v_) override {
+            Literal l { Literal::real_t };
+            l.m_real = v_;
+            value (l);
+        }
+
+        void string (std::string_view v_) override {
+            Literal l { Literal::string_t };
+            l.m_string = v_;
+            value (l);
+        }
+
+        void symbol (std::string_view v_) override {
+            string (v_);
+        }
+
+        // bytes are never compared
+        void binary (std::string_view) override { }
+};
+
+/******************************************************************************/
+
+void
+Filter::Evaluation::value (const Literal & value_) {
+    const auto * at = field();
+
+    if (!at || at->m_atoms.empty()) return;
+
+    bool changed { false };
+
+    for (auto atom : at->m_atoms) {
+        if (m_truths[atom] != unknown_t) continue;
+
+        if (test (m_filter.m_atoms[atom], value_)) {
+            m_truths[atom] = true_t;
+            changed = true;
+        } else if (!m_lists) {
+            m_truths[atom] = false_t;
+            changed = true;
+        }
+    }
+
+    if (!changed) return;
+
+    auto truth = m_filter.truth (m_filter.m_nodes.size() - 1, m_truths);
+    if (truth != unknown_t) throw Decided { truth == true_t };
+}
+
+/******************************************************************************
+ *
+ * Filter
+ *
+ ******************************************************************************/
+
+Filter::Filter (const std::string & expression_) {
+    Parser (*this, expression_).parse();
+}
+
+/******************************************************************************/
+
+bool
+Filter::test (const Atom & atom_, const Literal & value_) {
+    using L = Literal;
+
+    if (atom_.m_compare == match_t) {
+        return value_.m_type == L::string_t && std::regex_search (value_.m_string, atom_.m_regex);
+    }
+
+    auto compare = [&value_](const Literal & literal_, int & order_) {
+        const bool numbers = (value_.m_type == L::int_t || value_.m_type == L::real_t)
+            && (literal_.m_type == L::int_t || literal_.m_type == L::real_t);
+
+        if (!numbers && value_.m_type != literal_.m_type) return false;
+
+        switch (value_.m_type) {
+            case L::null_t :
+                order_ = 0;
+                return true;
+            case L::bool_t :
+                order_ = value_.m_bool == literal_.m_bool ? 0 : 2;
+                return true;
+            case L::string_t :
+                order_ = value_.m_string.compare (literal_.m_string);
+                return true;
+            default :
+                if (value_.m_type == L::int_t && literal_.m_type == L::int_t) {
+                    order_ = value_.m_int < literal_.m_int ? -1 : value_.m_int > literal_.m_int;
+                } else {
+                    auto v = value_.m_type == L::int_t ? static_cast<double> (value_.m_int) : value_.m_real;
+                    auto l = literal_.m_type == L::int_t ? static_cast<double> (literal_.m_int) : literal_.m_real;
+
+                    // NaN is neither equal to nor ordered against anything
+                    if (!(v < l) && !(v > l) && !(v == l)) return false;
+                    order_ = v < l ? -1 : v > l;
+                }
+                return true;
+        }
+    };
+
+    int order { 0 };
+
+    switch (atom_.m_compare) {
+        case in_t :
+            for (const auto & literal : atom_.m_literals) {
+                if (compare (literal, order) && order == 0) return true;
+            }
+            return false;
+        case eq_t : return compare (atom_.m_literals[0], order) && order == 0;
+        case ne_t : return !compare (atom_.m_literals[0], order) || order != 0;
+        default :
+            break;
+    }
+
+    // booleans and nulls aren't ordered
+    if (value_.m_type == L::bool_t || value_.m_type == L::null_t) return false;
+    if (!compare (atom_.m_literals[0], order)) return false;
+
+    switch (atom_.m_compare) {
+        case lt_t : return order < 0;
+        case le_t : return order <= 0;
+        case gt_t : return order > 0;
+        default   : return order >= 0;
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Three valued, so that what's known so far can decide the whole before
+ * every predicate is
+ */
+Filter::Truth
+Filter::truth (size_t node_, const std::vector<Truth> & truths_) const {
+    const auto & node = m_nodes[node_];
+
+    switch (node.m_op) {
+        case Node::atom_t :
+            return truths_[node.m_left];
+        case Node::not_t : {
+            auto t = truth (node.m_left, truths_);
+            return t == unknown_t ? unknown_t : (t == true_t ? false_t : true_t);
+        }
+        case Node::and_t : {
+            auto l = truth (node.m_left, truths_);
+            if (l == false_t) return false_t;
+
+            auto r = truth (node.m_right, truths_);
+            if (r == false_t) return false_t;
+
+            return l == true_t && r == true_t ? true_t : unknown_t;
+        }
+        default : {
+            auto l = truth (node.m_left, truths_);
+            if (l == true_t) return true_t;
+
+            auto r = truth (node.m_right, truths_);
+            if (r == true_t) return true_t;
+
+            return l == false_t && r == false_t ? false_t : unknown_t;
+        }
+    }
+}
+
+/******************************************************************************/
+
+bool
+Filter::evaluate (const std::function<void (amqp::reader::ISink &)> & decode_) const {
+    Evaluation evaluation (*this);
+
+    try {
+        decode_ (evaluation);
+    } catch (const Decided & decided_) {
+        return decided_.m_result;
+    }
+
+    return evaluation.result();
+}
+
+/******************************************************************************/
+
+const std::vector<std::string> *
+Filter::fields (std::string_view descriptor_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_fields.find (descriptor_);
+    return it == m_fields.end() ? nullptr : &it->second;
+}
+
+/******************************************************************************/
+
+const std::vector<std::string> &
+Filter::fields (const std::string & descriptor_, std::vector<std::string> fields_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_fields.emplace (descriptor_, std::move (fields_)).first->second;
+}
+
+/******************************************************************************/
@@ -0,0 +1,137 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************/
+
+/**
+ * A predicate over a blob's fields, such as
+ *
+ *      owner.name == "O=Bank A" and (amount.quantity >= 1000 or not settled)
+ *      currency in ("GBP", "EUR")
+ *      reference ~ "^INV-[0-9]+$"
+ *
+ * Fields are dotted paths from the blob's outermost type, as projected,
+ * compared with ==, !=, <, <=, > or >= against a number, a quoted string,
+ * true, false or null, tested for being one of a list of those with in,
+ * or searched with a regular expression by ~. Predicates combine with
+ * and, or and not, and brackets.
+ *
+ * Only the fields a filter names are decoded, see [Projection], each
+ * predicate being tested as its field is reached. The moment the filter
+ * as a whole is decided, one way or the other, decoding stops and the
+ * rest of the blob is never looked at.
+ *
+ * A path running through a list holds if any element's field does. One
+ * whose field is missing, null, or not a scalar holds for nothing, as
+ * does one the blob's type hasn't got, and values of different types are
+ * never equal, nor ordered, though they do differ.
+ */
+class Filter {
+    public :
+        enum Truth { false_t, true_t, unknown_t };
+
+    private :
+        enum Compare { eq_t, ne_t, lt_t, le_t, gt_t, ge_t, in_t, match_t };
+
+        struct Literal {
+            enum Type { null_t, bool_t, int_t, real_t, string_t } m_type;
+
+            bool m_bool { false };
+            int64_t m_int { 0 };
+            double m_real { 0 };
+            std::string m_string;
+        };
+
+        struct Atom {
+            Compare m_compare;
+            std::vector<Literal> m_literals;
+            std::regex m_regex;
+        };
+
+        /**
+         * The expression, each node's operands preceding it
+         */
+        struct Node {
+            enum Op { and_t, or_t, not_t, atom_t } m_op;
+            size_t m_left;
+            size_t m_right;
+        };
+
+        class Parser;
+        class Evaluation;
+
+        /**
+         * The paths as a tree of field names, each naming the atoms that
+         * test the field it ends at
+         */
+        struct Field {
+            std::map<std::string, Field, std::less<>> m_fields;
+            std::vector<size_t> m_atoms;
+        };
+
+        std::vector<Atom> m_atoms;
+        std::vector<Node> m_nodes;
+        std::vector<std::string> m_paths;
+        Field m_root;
+
+        /**
+         * Which of our fields each type, by descriptor, actually has
+         */
+        mutable std::mutex m_lock;
+        mutable std::map<std::string, std::vector<std::string>, std::less<>> m_fields;
+
+        Truth truth (size_t node_, const std::vector<Truth> &) const;
+
+        static bool test (const Atom &, const Literal &);
+
+    public :
+        /**
+         * Throws, saying where, if [expression_] can't be parsed
+         */
+        explicit Filter (const std::string & expression_);
+
+        Filter (const Filter &) = delete;
+
+        /**
+         * Every field the filter tests
+         */
+        const std::vector<std::string> & paths() const { return m_paths; }
+
+        /**
+         * Run [decode_], which writes the projection of [paths] into the
+         * sink it's given, returning whether the filter held. Whatever is
+         * left undecided once it's done holds for nothing
+         */
+        bool evaluate (const std::function<void (amqp::reader::ISink &)> & decode_) const;
+
+        /**
+         * Those of [paths] the type named by [descriptor_] has, null until
+         * they've been worked out and given by the second form, which
+         * keeps the first it's given
+         */
+        const std::vector<std::string> * fields (std::string_view descriptor_) const;
+
+        const std::vector<std::string> & fields (
+                const std::string & descriptor_,
+                std::vector<std::string> fields_) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,149 @@
+#include "Frames.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr size_t MAX_DEPTH = 128;
+
+    /**
+     * Header plus the encoding byte
+     */
+    const size_t PREAMBLE = amqp::AMQP_HEADER.size() + 1;
+
+    size_t
+    big (const char * bytes_, size_t width_) {
+        size_t rtn { 0 };
+
+        for (size_t i { 0 } ; i < width_ ; ++i) {
+            rtn = rtn << 8 | static_cast<unsigned char> (bytes_[i]);
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Step [at_] past the value starting there
+     */
+    void
+    skip (const char *& at_, const char * end_, size_t depth_) {
+        if (depth_ > MAX_DEPTH) throw std::runtime_error ("Blob nests too deeply");
+        if (at_ == end_) throw std::runtime_error ("Buffer ended part way through a blob");
+
+        auto extent = Frames::extent (static_cast<unsigned char> (*at_++));
+
+        if (extent.m_described) {
+            skip (at_, end_, depth_ + 1);
+            skip (at_, end_, depth_ + 1);
+            return;
+        }
+
+        auto left = static_cast<size_t> (end_ - at_);
+
+        if (left < extent.m_width) throw std::runtime_error ("Buffer ended part way through a blob");
+
+        auto size = extent.m_width ? big (at_, extent.m_width) : extent.m_fixed;
+        at_ += extent.m_width;
+
+        if (left - extent.m_width < size) throw std::runtime_error ("Buffer ended part way through a blob");
+
+        at_ += size;
+    }
+
+}
+
+/******************************************************************************/
+
+Frames::Frames (const char * bytes_, size_t size_)
+    : m_at (bytes_)
+    , m_end (bytes_ + size_)
+    , m_framing (size_ && *bytes_ == amqp::AMQP_HEADER[0] ? concatenated_t : prefixed_t)
+    , m_blobs (0)
+{
+}
+
+/******************************************************************************/
+
+/**
+ * An AMQP constructor's top four bits give the width of what follows it,
+ * fixed for scalars, of the size preceding the encoding otherwise. A
+ * described value is a descriptor followed by the value it describes
+ */
+Frames::Extent
+Frames::extent (unsigned char constructor_) {
+    if (constructor_ == 0x00) return { 0, 0, true };
+
+    switch (constructor_ >> 4) {
+        case 0x4 : return { 0, 0, false };
+        case 0x5 : return { 1, 0, false };
+        case 0x6 : return { 2, 0, false };
+        case 0x7 : return { 4, 0, false };
+        case 0x8 : return { 8, 0, false };
+        case 0x9 : return { 16, 0, false };
+
+        case 0xA :
+        case 0xC :
+        case 0xE : return { 0, 1, false };
+
+        case 0xB :
+        case 0xD :
+        case 0xF : return { 0, 4, false };
+
+        default :
+            throw std::runtime_error ("Not an AMQP value");
+    }
+}
+
+/******************************************************************************/
+
+size_t
+Frames::length (const char * bytes_, size_t size_) {
+    if (size_ < PREAMBLE) throw std::runtime_error ("Buffer ended part way through a blob");
+
+    if (std::memcmp (bytes_, amqp::AMQP_HEADER.data(), amqp::AMQP_HEADER.size()) != 0) {
+        throw std::runtime_error ("Not a Corda stream");
+    }
+
+    if (bytes_[PREAMBLE - 1] == amqp::ENCODING) return size_;
+
+    const char * at = bytes_ + PREAMBLE;
+    skip (at, bytes_ + size_, 0);
+
+    return static_cast<size_t> (at - bytes_);
+}
+
+/******************************************************************************/
+
+bool
+Frames::next (std::string_view & blob_) {
+    if (m_at == m_end) return false;
+
+    auto left = static_cast<size_t> (m_end - m_at);
+
+    if (m_framing == concatenated_t) {
+        auto length = Frames::length (m_at, left);
+
+        blob_ = { m_at, length };
+        m_at += length;
+    } else {
+        if (left < 4) throw std::runtime_error ("Buffer ended part way through a frame");
+
+        auto length = big (m_at, 4);
+        if (left - 4 < length) throw std::runtime_error ("Buffer ended part way through a frame");
+
+        blob_ = { m_at + 4, length };
+        m_at += 4 + length;
+    }
+
+    ++m_blobs;
+
+    return true;
+}
+
+/******************************************************************************/
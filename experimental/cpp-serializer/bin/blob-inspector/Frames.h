@@ -0,0 +1,70 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <string_view>
+
+/******************************************************************************/
+
+/**
+ * Splits blob after blob out of a buffer holding many, a segment of a
+ * Kafka partition say, each viewing the buffer where it is.
+ *
+ * Blobs are either simply concatenated, each being found to end where its
+ * AMQP encoding says it does, or each is prefixed by its length as a four
+ * byte big endian integer, as [Server] frames them. Which is told from
+ * the first byte, a concatenated stream starting with the "corda" of the
+ * first blob's header. A compressed blob's end is known only to its codec
+ * so when concatenated one must be the last in the buffer, taking all
+ * that's left.
+ *
+ * Every blob split out is decoded with whatever the thread already has,
+ * its arena and the process wide reader cache, so nothing is set up per
+ * blob no matter how many there are.
+ */
+class Frames {
+    public :
+        enum Framing { concatenated_t, prefixed_t };
+
+        /**
+         * How an AMQP constructor says how long its value is, [m_fixed]
+         * bytes following it or, for variable width values, compounds and
+         * arrays, a size of [m_width] bytes followed by that many
+         */
+        struct Extent {
+            size_t m_fixed;
+            size_t m_width;
+            bool m_described;
+        };
+
+    private :
+        const char * m_at;
+        const char * m_end;
+
+        Framing m_framing;
+        size_t m_blobs;
+
+    public :
+        Frames (const char *, size_t);
+
+        Framing framing() const { return m_framing; }
+
+        /**
+         * The next blob, header and all, false when there are none left.
+         * A buffer ending part way through a blob throws
+         */
+        bool next (std::string_view & blob_);
+
+        size_t blobs() const { return m_blobs; }
+
+        static Extent extent (unsigned char constructor_);
+
+        /**
+         * The length of the blob at the start of [size_] bytes, throwing
+         * if they end before it does
+         */
+        static size_t length (const char *, size_t size_);
+};
+
+/******************************************************************************/
@@ -0,0 +1,71 @@
+#include "Histogram.h"
+
+#include <cmath>
+#include <algorithm>
+
+/******************************************************************************/
+
+size_t
+Histogram::bucket (uint64_t nanos_) {
+    if (nanos_ < SUB) return nanos_;
+
+    auto power = static_cast<size_t> (63 - __builtin_clzll (nanos_));
+
+    if (power >= RANGE) return BUCKETS - 1;
+
+    auto sub = static_cast<size_t> (nanos_ >> (power - 4)) & (SUB - 1);
+
+    return (power - 3) * SUB + sub;
+}
+
+/******************************************************************************/
+
+uint64_t
+Histogram::upper (size_t bucket_) {
+    if (bucket_ < SUB) return bucket_;
+
+    auto power = bucket_ / SUB + 3;
+    auto sub = bucket_ % SUB;
+
+    return ((SUB + sub + 1) << (power - 4)) - 1;
+}
+
+/******************************************************************************/
+
+void
+Histogram::record (uint64_t nanos_) {
+    m_counts[bucket (nanos_)].fetch_add (1, std::memory_order_relaxed);
+
+    m_count.fetch_add (1, std::memory_order_relaxed);
+    m_total.fetch_add (nanos_, std::memory_order_relaxed);
+
+    auto max = m_max.load (std::memory_order_relaxed);
+    while (nanos_ > max && !m_max.compare_exchange_weak (max, nanos_, std::memory_order_relaxed)) { }
+}
+
+/******************************************************************************/
+
+double
+Histogram::quantile (double q_) const {
+    uint64_t total { 0 };
+    for (const auto & count : m_counts) total += count.load (std::memory_order_relaxed);
+
+    if (total == 0) return 0;
+
+    auto rank = static_cast<uint64_t> (std::ceil (q_ * static_cast<double> (total)));
+    if (rank == 0) rank = 1;
+
+    auto max = m_max.load (std::memory_order_relaxed);
+    uint64_t seen { 0 };
+
+    for (size_t i { 0 } ; i < BUCKETS ; ++i) {
+        seen += m_counts[i].load (std::memory_order_relaxed);
+
+        // the slowest bucket's bound may well be past anything seen
+        if (seen >= rank) return static_cast<double> (std::min (upper (i), max)) / 1e9;
+    }
+
+    return static_cast<double> (max) / 1e9;
+}
+
+/******************************************************************************/
@@ -0,0 +1,65 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/******************************************************************************/
+
+/**
+ * Latencies counted finely enough to read a p99.9 off, rather than the
+ * handful of Prometheus buckets [Metrics] keeps.
+ *
+ * Nanoseconds are bucketed log-linearly, each power of two split into
+ * [SUB] buckets, so any quantile is known to within 1/[SUB]th of its
+ * value, 6% or so, from a nanosecond to well past an hour. Recording is
+ * a single relaxed increment, no lock, so however many threads record
+ * into one they never wait on each other. Read whilst being recorded
+ * into, the counts may be a request or two behind one another.
+ */
+class Histogram {
+    public :
+        static constexpr size_t SUB = 16;
+
+        /**
+         * Everything from 2^[RANGE] nanoseconds up lands in the last bucket
+         */
+        static constexpr size_t RANGE = 44;
+
+        static constexpr size_t BUCKETS = (RANGE - 3) * SUB;
+
+    private :
+        std::array<std::atomic<uint64_t>, BUCKETS> m_counts { };
+
+        std::atomic<uint64_t> m_count { 0 };
+        std::atomic<uint64_t> m_total { 0 };
+        std::atomic<uint64_t> m_max { 0 };
+
+    public :
+        static size_t bucket (uint64_t nanos_);
+
+        /**
+         * The largest number of nanoseconds that would be counted in
+         * [bucket_]
+         */
+        static uint64_t upper (size_t bucket_);
+
+        void record (uint64_t nanos_);
+
+        uint64_t count() const { return m_count.load (std::memory_order_relaxed); }
+
+        double sum() const { return static_cast<double> (m_total.load (std::memory_order_relaxed)) / 1e9; }
+
+        double max() const { return static_cast<double> (m_max.load (std::memory_order_relaxed)) / 1e9; }
+
+        /**
+         * The seconds within which [q_] of what's been recorded took,
+         * 0.999 say, zero if nothing has been
+         */
+        double quantile (double q_) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,63 @@
+#include "Memo.h"
+
+/******************************************************************************/
+
+Memo::Memo (size_t capacity_)
+    : m_capacity (capacity_)
+{ }
+
+/******************************************************************************/
+
+bool
+Memo::find (const Key & key_, Entry & entry_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_index.find (key_);
+
+    if (it == m_index.end()) return false;
+
+    m_entries.splice (m_entries.begin(), m_entries, it->second);
+    entry_ = it->second->second;
+
+    return true;
+}
+
+/******************************************************************************/
+
+/*
+ * Two workers decoding the same blob at once both insert it, the second
+ * simply replacing the first
+ */
+void
+Memo::insert (const Key & key_, Entry entry_) {
+    if (m_capacity == 0) return;
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_index.find (key_);
+
+    if (it != m_index.end()) {
+        it->second->second = std::move (entry_);
+        m_entries.splice (m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    if (m_entries.size() == m_capacity) {
+        m_index.erase (m_entries.back().first);
+        m_entries.pop_back();
+    }
+
+    m_entries.emplace_front (key_, std::move (entry_));
+    m_index.emplace (key_, m_entries.begin());
+}
+
+/******************************************************************************/
+
+size_t
+Memo::size() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_entries.size();
+}
+
+/******************************************************************************/
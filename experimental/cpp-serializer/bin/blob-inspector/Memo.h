@@ -0,0 +1,78 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+/**
+ * What a batch rendered from each of the last few distinct blobs it saw,
+ * keyed on a hash of the blob's bytes, so an identical blob seen again
+ * is written without being decoded at all. Vault exports are full of
+ * them, duplicated and reissued states being byte for byte the same.
+ *
+ * Holds at most [capacity] entries, the least recently used being
+ * dropped to make room. Shared by every worker of the batch so guarded
+ * by a lock, held only to find, copy or replace an entry.
+ */
+class Memo {
+    public :
+        using Key = amqp::internal::cursor::Hash;
+
+        /**
+         * A blob's output, what it failed with when not [m_ok], with
+         * nothing in it naming the blob's file
+         */
+        struct Entry {
+            bool m_ok;
+            std::string m_output;
+            std::string m_error;
+        };
+
+    private :
+        struct KeyHash {
+            size_t operator() (const Key & key_) const { return key_.m_low; }
+        };
+
+        using Entries = std::list<std::pair<Key, Entry>>;
+
+        mutable std::mutex m_lock;
+
+        size_t m_capacity;
+
+        /**
+         * Most recently used first
+         */
+        Entries m_entries;
+        std::unordered_map<Key, Entries::iterator, KeyHash> m_index;
+
+    public :
+        explicit Memo (size_t capacity_);
+
+        Memo (const Memo &) = delete;
+
+        static Key key (std::string_view blob_) {
+            return amqp::internal::cursor::hash (blob_);
+        }
+
+        /**
+         * Copy what's kept for [key_] into [entry_], if anything is,
+         * making it the most recently used
+         */
+        bool find (const Key & key_, Entry & entry_);
+
+        void insert (const Key & key_, Entry entry_);
+
+        size_t capacity() const { return m_capacity; }
+        size_t size() const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,180 @@
+#include "Metrics.h"
+
+#include <sstream>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#include "amqp/ReaderCache.h"
+#include "reader/Arena.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Backslashes, quotes and new lines are all a label value can't
+     * hold as is
+     */
+    std::string
+    escape (const std::string & value_) {
+        std::string rtn;
+
+        for (auto c : value_) {
+            switch (c) {
+                case '\\' : rtn += "\\\\"; break;
+                case '"'  : rtn += "\\\""; break;
+                case '\n' : rtn += "\\n"; break;
+                default   : rtn += c;
+            }
+        }
+
+        return rtn;
+    }
+
+    void
+    metric (
+        std::ostream & out_,
+        const char * name_,
+        const char * type_,
+        const char * help_
+    ) {
+        out_ << "# HELP " << name_ << " " << help_ << "\n"
+             << "# TYPE " << name_ << " " << type_ << "\n";
+    }
+
+}
+
+/******************************************************************************/
+
+void
+Metrics::record (double seconds_, size_t bytes_, const std::string * error_) {
+    for (size_t i { 0 } ; i < BUCKETS.size() ; ++i) {
+        if (seconds_ <= BUCKETS[i]) {
+            m_buckets[i].fetch_add (1, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    m_latency.record (static_cast<uint64_t> (seconds_ * 1e9));
+    m_requests.fetch_add (1, std::memory_order_relaxed);
+    m_bytes.fetch_add (bytes_, std::memory_order_relaxed);
+
+    if (error_) {
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        auto it = m_errors.find (*error_);
+
+        if (it != m_errors.end()) {
+            ++it->second;
+        } else if (m_errors.size() < MAX_ERRORS) {
+            m_errors.emplace (*error_, 1);
+        } else {
+            ++m_errors["other"];
+        }
+    }
+}
+
+/******************************************************************************/
+
+uint64_t
+Metrics::requests() const {
+    return m_requests.load (std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+std::string
+Metrics::text() const {
+    std::stringstream out;
+
+    {
+        // the count read first so no bucket is ever above the +Inf one
+        auto requests = m_requests.load (std::memory_order_relaxed);
+
+        metric (out, "blob_inspector_request_seconds", "histogram",
+                "Time taken to answer a decode request");
+
+        uint64_t cumulative { 0 };
+        for (size_t i { 0 } ; i < BUCKETS.size() ; ++i) {
+            cumulative += m_buckets[i].load (std::memory_order_relaxed);
+            out << "blob_inspector_request_seconds_bucket{le=\"" << BUCKETS[i] << "\"} "
+                << std::min (cumulative, requests) << "\n";
+        }
+
+        out << "blob_inspector_request_seconds_bucket{le=\"+Inf\"} " << requests << "\n"
+            << "blob_inspector_request_seconds_sum " << m_latency.sum() << "\n"
+            << "blob_inspector_request_seconds_count " << requests << "\n";
+
+        metric (out, "blob_inspector_request_latency_seconds", "summary",
+                "Time taken to answer a decode request, to within 1/16th");
+
+        for (auto q : QUANTILES) {
+            out << "blob_inspector_request_latency_seconds{quantile=\"" << q << "\"} "
+                << m_latency.quantile (q) << "\n";
+        }
+
+        out << "blob_inspector_request_latency_seconds_sum " << m_latency.sum() << "\n"
+            << "blob_inspector_request_latency_seconds_count " << m_latency.count() << "\n";
+
+        metric (out, "blob_inspector_request_latency_max_seconds", "gauge",
+                "Longest any decode request has taken to answer");
+        out << "blob_inspector_request_latency_max_seconds " << m_latency.max() << "\n";
+
+        metric (out, "blob_inspector_requests_total", "counter", "Decode requests answered");
+        out << "blob_inspector_requests_total " << requests << "\n";
+
+        metric (out, "blob_inspector_decoded_bytes_total", "counter", "Bytes of blob decoded");
+        out << "blob_inspector_decoded_bytes_total " << m_bytes.load (std::memory_order_relaxed) << "\n";
+
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        metric (out, "blob_inspector_errors_total", "counter", "Requests that failed, by why");
+        for (const auto & error : m_errors) {
+            out << "blob_inspector_errors_total{error=\"" << escape (error.first) << "\"} "
+                << error.second << "\n";
+        }
+    }
+
+    const auto & cache = amqp::internal::ReaderCache::instance();
+
+    metric (out, "blob_inspector_schema_cache_entries", "gauge", "Schemas compiled and cached");
+    out << "blob_inspector_schema_cache_entries " << cache.size() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_hits_total", "counter", "Schemas found already compiled");
+    out << "blob_inspector_schema_cache_hits_total " << cache.hits() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_misses_total", "counter", "Schemas that had to be compiled");
+    out << "blob_inspector_schema_cache_misses_total " << cache.misses() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_restored_total", "counter",
+            "Schemas restored from the on disk store rather than decoded");
+    out << "blob_inspector_schema_cache_restored_total " << cache.restored() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_bytes", "gauge", "Estimated memory held by cached schemas");
+    out << "blob_inspector_schema_cache_bytes " << cache.bytes() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_evictions_total", "counter",
+            "Schemas dropped to keep within --schema-memory");
+    out << "blob_inspector_schema_cache_evictions_total " << cache.evictions() << "\n";
+
+    metric (out, "blob_inspector_schema_cache_compacted", "gauge",
+            "Schemas held compacted, rather than compiled, to keep within --schema-memory");
+    out << "blob_inspector_schema_cache_compacted " << cache.compacted() << "\n";
+
+    metric (out, "blob_inspector_arena_high_water_bytes", "gauge",
+            "Most bytes any one decoded tree needed from its arena");
+    out << "blob_inspector_arena_high_water_bytes "
+        << amqp::internal::reader::Arena::highWater() << "\n";
+
+    rusage usage { };
+    getrusage (RUSAGE_SELF, &usage);
+
+    metric (out, "blob_inspector_max_resident_bytes", "gauge",
+            "Most memory the process has had resident at once");
+    out << "blob_inspector_max_resident_bytes " << static_cast<uint64_t> (usage.ru_maxrss) * 1024 << "\n";
+
+    return out.str();
+}
+
+/******************************************************************************/
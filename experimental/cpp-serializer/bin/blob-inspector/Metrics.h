@@ -0,0 +1,77 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "Histogram.h"
+
+/******************************************************************************/
+
+/**
+ * What a [Server] has been up to, rendered in the Prometheus text
+ * exposition format: how long each request took as a histogram, how many
+ * requests and bytes were decoded, how many failed and why, along with
+ * the state of the reader cache and how much memory the process has
+ * needed at most.
+ *
+ * Failures are counted by their message, "Expected a list" say. Messages
+ * that name the type at fault would make for a label per type so, past
+ * [MAX_ERRORS] distinct messages, further ones are counted as "other".
+ *
+ * Alongside the histogram, whose buckets are too coarse to say much of
+ * the tail, latencies are kept in a [Histogram] and exported as a summary
+ * of [QUANTILES]. Only a failure takes a lock to be recorded so workers
+ * answering requests never wait on one another to count them.
+ */
+class Metrics {
+    public :
+        /**
+         * Upper bounds, in seconds, of the latency histogram's buckets,
+         * anything slower falling only into +Inf
+         */
+        static constexpr std::array<double, 14> BUCKETS {
+            0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+            0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0
+        };
+
+        static constexpr std::array<double, 5> QUANTILES { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+
+        static constexpr size_t MAX_ERRORS = 64;
+
+    private :
+        mutable std::mutex m_lock;
+
+        std::array<std::atomic<uint64_t>, BUCKETS.size()> m_buckets { };
+
+        std::atomic<uint64_t> m_requests { 0 };
+        std::atomic<uint64_t> m_bytes { 0 };
+
+        Histogram m_latency;
+
+        std::map<std::string, uint64_t> m_errors;
+
+    public :
+        /**
+         * A request for a [bytes_] long blob answered in [seconds_],
+         * [error_] being why it failed if not null
+         */
+        void record (double seconds_, size_t bytes_, const std::string * error_ = nullptr);
+
+        uint64_t requests() const;
+
+        const Histogram & latency() const { return m_latency; }
+
+        /**
+         * Everything as a Prometheus scrape would have it
+         */
+        std::string text() const;
+};
+
+/******************************************************************************/
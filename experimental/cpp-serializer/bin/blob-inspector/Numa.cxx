@@ -0,0 +1,240 @@
+#include "Numa.h"
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <utility>
+#include <stdexcept>
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * mbind's policy, from numaif.h, to prefer the node given but take
+     * memory from elsewhere rather than fail when it's exhausted
+     */
+    constexpr int PREFERRED = 1;
+
+    /**
+     * "0-3,8-11" say
+     */
+    std::vector<int>
+    list (const std::string & list_) {
+        std::vector<int> rtn;
+        std::stringstream ss (list_);
+
+        for (std::string range ; std::getline (ss, range, ',') ; ) {
+            if (range.empty() || range == "\n") continue;
+
+            auto dash = range.find ('-');
+            int from = std::stoi (range.substr (0, dash));
+            int to = dash == std::string::npos ? from : std::stoi (range.substr (dash + 1));
+
+            for (int cpu { from } ; cpu <= to ; ++cpu) rtn.push_back (cpu);
+        }
+
+        return rtn;
+    }
+
+    std::vector<std::vector<int>>
+    discover() {
+        std::vector<std::vector<int>> rtn;
+
+        for (int node { 0 } ; ; ++node) {
+            std::ifstream in ("/sys/devices/system/node/node" + std::to_string (node) + "/cpulist");
+            std::string cpus;
+
+            if (!std::getline (in, cpus)) break;
+
+            try {
+                rtn.emplace_back (list (cpus));
+            } catch (const std::exception &) {
+                break;
+            }
+        }
+
+        if (rtn.empty()) {
+            rtn.emplace_back();
+
+            for (long cpu { 0 } ; cpu < ::sysconf (_SC_NPROCESSORS_CONF) ; ++cpu) {
+                rtn.back().push_back (static_cast<int> (cpu));
+            }
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Numa
+ *
+ ******************************************************************************/
+
+const std::vector<std::vector<int>> &
+Numa::cpus() {
+    static const auto cpus = discover();
+    return cpus;
+}
+
+/******************************************************************************/
+
+bool
+Numa::pin (size_t node_) {
+    if (node_ >= nodes()) return false;
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+
+    for (auto cpu : cpus()[node_]) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET (cpu, &set);
+    }
+
+    return ::sched_setaffinity (0, sizeof (set), &set) == 0;
+}
+
+/******************************************************************************/
+
+std::vector<int>
+Numa::usable() {
+    std::vector<int> rtn;
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+
+    if (::sched_getaffinity (0, sizeof (set), &set) == 0) {
+        for (int cpu { 0 } ; cpu < CPU_SETSIZE ; ++cpu) {
+            if (CPU_ISSET (cpu, &set)) rtn.push_back (cpu);
+        }
+    }
+
+    if (rtn.empty()) {
+        for (const auto & node : cpus()) rtn.insert (rtn.end(), node.begin(), node.end());
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+bool
+Numa::pinCpu (int cpu_) {
+    if (cpu_ < 0 || cpu_ >= CPU_SETSIZE) return false;
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET (cpu_, &set);
+
+    return ::sched_setaffinity (0, sizeof (set), &set) == 0;
+}
+
+/******************************************************************************/
+
+void
+Numa::bind (void * memory_, size_t size_, size_t node_) {
+#if defined (__NR_mbind)
+    constexpr size_t BITS = 8 * sizeof (unsigned long);
+
+    if (nodes() < 2 || node_ >= BITS) return;
+
+    unsigned long mask { 1UL << node_ };
+
+    // the kernel counts one fewer node than it's told there are bits
+    ::syscall (__NR_mbind, memory_, size_, PREFERRED, &mask, BITS + 1, 0);
+#else
+    (void) memory_; (void) size_; (void) node_;
+#endif
+}
+
+/******************************************************************************
+ *
+ * Pages
+ *
+ ******************************************************************************/
+
+Pages::Pages (Kind kind_, int node_)
+    : m_kind (kind_)
+    , m_node (node_)
+{
+}
+
+/******************************************************************************/
+
+size_t
+Pages::rounded (size_t size_) const {
+    static const auto page = static_cast<size_t> (::sysconf (_SC_PAGESIZE));
+
+    auto unit = m_kind != normal_t && size_ >= HUGE_PAGE ? HUGE_PAGE : page;
+
+    return (size_ + unit - 1) / unit * unit;
+}
+
+/******************************************************************************/
+
+void *
+Pages::do_allocate (size_t size_, size_t) {
+    auto size = rounded (size_);
+    bool huge = m_kind != normal_t && size >= HUGE_PAGE;
+
+    void * rtn { MAP_FAILED };
+
+#if defined (MAP_HUGETLB)
+    if (huge && m_kind == explicit_t) {
+        rtn = ::mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (rtn == MAP_FAILED) {
+        rtn = ::mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (rtn == MAP_FAILED) throw std::bad_alloc();
+
+#if defined (MADV_HUGEPAGE)
+        if (huge) ::madvise (rtn, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    // before anything touches it, so every page comes from the node
+    if (m_node >= 0) Numa::bind (rtn, size, static_cast<size_t> (m_node));
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Pages::do_deallocate (void * memory_, size_t size_, size_t) {
+    ::munmap (memory_, rounded (size_));
+}
+
+/******************************************************************************/
+
+bool
+Pages::do_is_equal (const std::pmr::memory_resource & other_) const noexcept {
+    return this == &other_;
+}
+
+/******************************************************************************/
+
+Pages *
+Pages::get (Kind kind_, int node_) {
+    static std::mutex lock;
+    static std::map<std::pair<Kind, int>, std::unique_ptr<Pages>> pages;
+
+    std::lock_guard<std::mutex> guard (lock);
+
+    auto & rtn = pages[{ kind_, node_ }];
+    if (!rtn) rtn = std::make_unique<Pages> (kind_, node_);
+
+    return rtn.get();
+}
+
+/******************************************************************************/
@@ -0,0 +1,102 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+
+/******************************************************************************/
+
+/**
+ * The machine's NUMA nodes as Linux describes them under sysfs, a machine
+ * that doesn't being treated as a single node of every CPU.
+ *
+ * Nothing here needs libnuma, pinning being done with the thread's
+ * affinity and placing memory with mbind. Either failing, as they do on
+ * kernels without NUMA or in containers that forbid them, leaves things
+ * as they'd otherwise have been.
+ */
+class Numa {
+    public :
+        /**
+         * The CPUs of each node, in node order
+         */
+        static const std::vector<std::vector<int>> & cpus();
+
+        static size_t nodes() { return cpus().size(); }
+
+        /**
+         * Run the calling thread only on [node_]'s CPUs
+         */
+        static bool pin (size_t node_);
+
+        /**
+         * The CPUs the process is allowed to run on, every one of them
+         * should that not be known
+         */
+        static std::vector<int> usable();
+
+        /**
+         * Run the calling thread only on [cpu_]
+         */
+        static bool pinCpu (int cpu_);
+
+        /**
+         * Have the pages of [size_] bytes at [memory_], which must be page
+         * aligned and not yet touched, come from [node_]
+         */
+        static void bind (void * memory_, size_t size_, size_t node_);
+};
+
+/******************************************************************************/
+
+/**
+ * Memory mapped straight from the kernel rather than the heap, optionally
+ * backed by huge pages, and optionally placed on a NUMA node whichever
+ * thread first touches it.
+ *
+ * Transparent huge pages are asked for with madvise, explicit ones are
+ * mapped from the hugetlbfs pool, falling back to transparent ones when
+ * that's empty. Only allocations of at least a huge page are mapped
+ * huge, smaller ones wasting most of one.
+ *
+ * Every allocation is a mapping of its own so this suits memory that's
+ * allocated once and reused, arenas and pooled buffers, not anything
+ * allocated per value.
+ */
+class Pages : public std::pmr::memory_resource {
+    public :
+        enum Kind { normal_t, transparent_t, explicit_t };
+
+        static constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+    private :
+        Kind m_kind;
+        int m_node;
+
+        size_t rounded (size_t) const;
+
+        void * do_allocate (size_t, size_t) override;
+        void do_deallocate (void *, size_t, size_t) override;
+        bool do_is_equal (const std::pmr::memory_resource &) const noexcept override;
+
+    public :
+        /**
+         * [node_] -1 to leave the memory wherever it's first touched
+         */
+        explicit Pages (Kind, int node_ = -1);
+
+        Kind kind() const { return m_kind; }
+        int node() const { return m_node; }
+
+        /**
+         * The one resource of [kind_] on [node_], living as long as the
+         * process so it outlives anything allocated from it
+         */
+        static Pages * get (Kind kind_, int node_ = -1);
+};
+
+/******************************************************************************/
@@ -0,0 +1,269 @@
+#include "Offsets.h"
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+
+#include "cursor/Structure.h"
+#include "reader/Lazy.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+
+    constexpr char MAGIC[] = "CAOF";
+
+    /**
+     * How much of each end of the blob is hashed, enough to tell blobs
+     * apart without reading the whole of one
+     */
+    constexpr size_t ENDS = 64 * 1024;
+
+    uint64_t
+    fnv (uint64_t h_, std::string_view bytes_) {
+        for (auto c : bytes_) {
+            h_ ^= static_cast<unsigned char> (c);
+            h_ *= 0x100000001b3ULL;
+        }
+
+        return h_;
+    }
+
+    /**
+     * Whether the entry [i_] is a composite, list or map, that is a list
+     * or map or one described
+     */
+    bool
+    compound (const cursor::Structure & structure_, size_t i_) {
+        if (structure_[i_].m_code == 0x00) {
+            i_ = structure_.child (i_, 1);
+
+            if (i_ == structure_.size()) return false;
+        }
+
+        return cursor::Structure::compound (structure_[i_].m_code);
+    }
+
+    /**
+     * What a sidecar starts with, its nodes following straight after
+     */
+    struct Header {
+        char m_magic[4];
+        uint32_t m_version;
+
+        /**
+         * Written as 1 so a sidecar from a machine of the other byte
+         * order is told apart
+         */
+        uint32_t m_order;
+        uint32_t m_unused;
+
+        uint64_t m_blob;
+        uint64_t m_hash;
+        uint64_t m_count;
+    };
+
+    [[noreturn]] void
+    corrupt() {
+        throw std::runtime_error ("Corrupt offsets");
+    }
+
+}
+
+/******************************************************************************/
+
+Offsets::Offsets()
+    : m_blob (0)
+    , m_hash (0)
+    , m_begin (nullptr)
+    , m_count (0)
+    , m_map (nullptr)
+    , m_mapSize (0)
+{
+}
+
+/******************************************************************************/
+
+Offsets::Offsets (CordaBytes & cb_) : Offsets() {
+    m_blob = cb_.size();
+    m_hash = hash (cb_);
+
+    if (m_blob > UINT32_MAX) throw std::runtime_error ("Blob too large for offsets");
+
+    auto root = BlobInspector (cb_).lazy()->encoded();
+
+    cursor::Structure structure (root);
+
+    if (!compound (structure, 0)) {
+        throw std::runtime_error ("Blob holds neither a composite, list nor map");
+    }
+
+    const auto base = static_cast<uint32_t> (root.data() - cb_.bytes());
+
+    m_nodes.push_back ({ base + structure[0].m_offset, structure[0].m_size, 0, 0, 0 });
+
+    walk (structure, 0, 0);
+
+    m_begin = m_nodes.data();
+    m_count = m_nodes.size();
+}
+
+/******************************************************************************/
+
+Offsets::~Offsets() {
+    if (m_map) ::munmap (m_map, m_mapSize);
+}
+
+/******************************************************************************/
+
+/**
+ * Record the children of [node_], the entry [entry_] of [structure_],
+ * which sit together, before walking each of them in turn
+ */
+void
+Offsets::walk (const cursor::Structure & structure_, size_t entry_, size_t node_) {
+    const auto base = m_nodes[node_].m_offset - structure_[entry_].m_offset;
+
+    // a composite's fields being the elements of the list it describes
+    auto value = structure_[entry_].m_code == 0x00 ? structure_.child (entry_, 1) : entry_;
+
+    const auto first = m_nodes.size();
+
+    std::vector<size_t> entries;
+
+    uint32_t position { 0 };
+
+    for (auto child = value + 1 ; child < structure_[value].m_end ; child = structure_[child].m_end, ++position) {
+        if (!compound (structure_, child)) continue;
+
+        m_nodes.push_back ({ base + structure_[child].m_offset, structure_[child].m_size, position, 0, 0 });
+        entries.push_back (child);
+    }
+
+    const auto last = m_nodes.size();
+
+    m_nodes[node_].m_first = static_cast<uint32_t> (first);
+    m_nodes[node_].m_count = static_cast<uint32_t> (last - first);
+
+    for (auto child { first } ; child < last ; ++child) walk (structure_, entries[child - first], child);
+}
+
+/******************************************************************************/
+
+uint64_t
+Offsets::hash (const CordaBytes & cb_) {
+    std::string_view blob (cb_.bytes(), cb_.size());
+
+    auto h = fnv (0xcbf29ce484222325ULL, blob.substr (0, ENDS));
+
+    return blob.size() > ENDS ? fnv (h, blob.substr (blob.size() - ENDS)) : h;
+}
+
+/******************************************************************************/
+
+const Offsets::Node &
+Offsets::check (const Node & node_) const {
+    if (node_.m_offset > m_blob || node_.m_size > m_blob - node_.m_offset
+        || node_.m_first + uint64_t { node_.m_count } > m_count)
+    {
+        corrupt();
+    }
+
+    return node_;
+}
+
+/******************************************************************************/
+
+const Offsets::Node *
+Offsets::child (const Node & node_, size_t position_) const {
+    auto begin = m_begin + node_.m_first;
+    auto end = begin + node_.m_count;
+
+    auto it = std::lower_bound (begin, end, position_, [](const Node & n_, size_t p_) {
+        return n_.m_position < p_;
+    });
+
+    return it == end || it->m_position != position_ ? nullptr : &check (*it);
+}
+
+/******************************************************************************/
+
+void
+Offsets::save (const std::string & path_) const {
+    Header header { { }, VERSION, 1, 0, m_blob, m_hash, m_count };
+    std::memcpy (header.m_magic, MAGIC, sizeof (header.m_magic));
+
+    std::ofstream file (path_, std::ios::binary | std::ios::trunc);
+
+    file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+    file.write (reinterpret_cast<const char *> (m_begin), static_cast<std::streamsize> (m_count * sizeof (Node)));
+
+    if (!file) throw std::runtime_error ("Failed to write " + path_);
+}
+
+/******************************************************************************/
+
+std::unique_ptr<Offsets>
+Offsets::load (const std::string & path_, const CordaBytes & cb_) {
+    int fd = ::open (path_.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error ("Failed to read " + path_);
+
+    struct stat st { };
+    if (::fstat (fd, &st) != 0 || static_cast<size_t> (st.st_size) < sizeof (Header)) {
+        ::close (fd);
+        throw std::runtime_error (path_ + " isn't a blob's offsets");
+    }
+
+    std::unique_ptr<Offsets> rtn (new Offsets());
+
+    rtn->m_mapSize = static_cast<size_t> (st.st_size);
+    auto map = ::mmap (nullptr, rtn->m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+
+    if (map == MAP_FAILED) throw std::runtime_error ("Failed to map " + path_);
+    rtn->m_map = map;
+
+    Header header;
+    std::memcpy (&header, map, sizeof (header));
+
+    if (std::memcmp (header.m_magic, MAGIC, sizeof (header.m_magic)) != 0 || header.m_order != 1) {
+        throw std::runtime_error (path_ + " isn't a blob's offsets");
+    }
+
+    if (header.m_version != VERSION) {
+        throw std::runtime_error (path_ + " holds offsets of another version");
+    }
+
+    if (header.m_blob != cb_.size() || header.m_hash != hash (cb_)) {
+        throw std::runtime_error (path_ + " holds the offsets of another blob");
+    }
+
+    if (header.m_count == 0
+        || header.m_count != (rtn->m_mapSize - sizeof (Header)) / sizeof (Node)
+        || (rtn->m_mapSize - sizeof (Header)) % sizeof (Node) != 0)
+    {
+        corrupt();
+    }
+
+    rtn->m_blob = header.m_blob;
+    rtn->m_hash = header.m_hash;
+    rtn->m_begin = reinterpret_cast<const Node *> (static_cast<const char *> (map) + sizeof (Header));
+    rtn->m_count = header.m_count;
+
+    rtn->check (rtn->root());
+
+    return rtn;
+}
+
+/******************************************************************************/
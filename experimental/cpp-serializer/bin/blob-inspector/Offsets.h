@@ -0,0 +1,120 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::internal::cursor {
+
+    class Structure;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Where in a blob every composite, list and map sits, found by a single
+ * walk over its encoding, so a value deep inside a large blob, the 41233rd
+ * state's amount say, can be reached by jumping straight to its bytes
+ * rather than skipping over everything before it. See [BlobInspector::at].
+ *
+ * The walk needs no schema, being over the blob's [cursor::Structure]
+ * rather than its encoding. A node's children are numbered by position,
+ * a composite's fields in the order its type declares them, a list's
+ * elements by index and a map's keys and values alternately, and only
+ * those that are themselves composites, lists or maps are recorded. An
+ * array's elements share its constructor so can't be jumped to and
+ * aren't recorded.
+ *
+ * Saved beside the blob as a sidecar the nodes are laid out as they sit
+ * in memory, so loading one just maps it, however large, and nothing is
+ * read but the nodes a lookup passes through. It's checked against the
+ * blob it's loaded for by size and a hash of the blob's ends, throwing
+ * if it was made from another, and each node as it's reached, throwing
+ * should one not lie within the blob.
+ */
+class Offsets {
+    public :
+        /**
+         * AMQP's sizes are 32 bits so no blob's bigger
+         */
+        struct Node {
+            /**
+             * From the start of the blob's payload, see [CordaBytes::bytes]
+             */
+            uint32_t m_offset;
+            uint32_t m_size;
+
+            /**
+             * Amongst the parent's children, and the node's own, which
+             * sit together in position order
+             */
+            uint32_t m_position;
+            uint32_t m_first;
+            uint32_t m_count;
+        };
+
+        static constexpr uint32_t VERSION = 1;
+
+    private :
+        uint64_t m_blob;
+        uint64_t m_hash;
+
+        std::vector<Node> m_nodes;
+
+        /**
+         * Either [m_nodes] or, when loaded, the sidecar's mapping of them
+         */
+        const Node * m_begin;
+        size_t m_count;
+
+        void * m_map;
+        size_t m_mapSize;
+
+        Offsets();
+
+        void walk (const amqp::internal::cursor::Structure &, size_t entry_, size_t node_);
+
+        const Node & check (const Node &) const;
+
+        static uint64_t hash (const CordaBytes &);
+
+    public :
+        /**
+         * Walk [cb_], the root being the value it holds
+         */
+        explicit Offsets (CordaBytes & cb_);
+
+        Offsets (const Offsets &) = delete;
+        Offsets & operator = (const Offsets &) = delete;
+
+        ~Offsets();
+
+        /**
+         * Map the sidecar at [path_], throwing unless it was made from
+         * [cb_]
+         */
+        static std::unique_ptr<Offsets> load (const std::string & path_, const CordaBytes & cb_);
+
+        void save (const std::string &) const;
+
+        const Node & root() const { return *m_begin; }
+
+        /**
+         * The recorded child of [node_] at [position_], null when it's
+         * not a composite, list or map, or there isn't one
+         */
+        const Node * child (const Node & node_, size_t position_) const;
+
+        size_t size() const { return m_count; }
+};
+
+/******************************************************************************/
@@ -0,0 +1,191 @@
+#include "Output.h"
+
+#include <algorithm>
+
+/******************************************************************************/
+
+Output::Output (Write write_, size_t window_, bool ordered_)
+    : Output (
+        Routed ([write = std::move (write_)](const std::string &, const std::string & line_, const std::string & report_) {
+            write (line_, report_);
+        }),
+        window_,
+        ordered_)
+{
+}
+
+/******************************************************************************/
+
+Output::Output (Routed write_, size_t window_, bool ordered_)
+    : Output (
+        Indexed ([write = std::move (write_)](
+            size_t,
+            const std::string & route_,
+            const std::string & line_,
+            const std::string & report_
+        ) {
+            write (route_, line_, report_);
+        }),
+        window_,
+        ordered_)
+{
+}
+
+/******************************************************************************/
+
+Output::Output (Indexed write_, size_t window_, bool ordered_)
+    : m_write (std::move (write_))
+    , m_window (window_)
+    , m_ordered (ordered_)
+    , m_ring (ordered_ ? std::max<size_t> (window_, 1) : 0)
+    , m_held (0)
+    , m_admitted (0)
+    , m_written (0)
+    , m_next (0)
+    , m_peak (0)
+    , m_writing (0)
+    , m_closed (false)
+{
+    m_writer = std::thread ([this]() { run(); });
+}
+
+/******************************************************************************/
+
+Output::~Output() {
+    close();
+}
+
+/******************************************************************************/
+
+void
+Output::admit() {
+    std::unique_lock<std::mutex> lock (m_lock);
+
+    if (m_window) {
+        m_space.wait (lock, [this]() { return m_admitted < m_written + m_window; });
+    }
+
+    ++m_admitted;
+}
+
+/******************************************************************************/
+
+void
+Output::put (size_t i_, std::string & line_, std::string & report_, std::string_view route_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    Item item;
+
+    if (!m_spare.empty()) {
+        item = std::move (m_spare.back());
+        m_spare.pop_back();
+    }
+
+    item.m_index = i_;
+    item.m_line.clear();
+    item.m_report.clear();
+    item.m_line.swap (line_);
+    item.m_report.swap (report_);
+    item.m_route.assign (route_);
+    item.m_held = false;
+
+    // one that's missed its turn, its gap written past on closing, goes now
+    if (m_ordered && i_ >= m_next) {
+        while (i_ - m_next >= m_ring.size()) grow();
+
+        auto & held = slot (i_);
+
+        held = std::move (item);
+        held.m_held = true;
+        ++m_held;
+    } else {
+        m_pending.push_back (std::move (item));
+    }
+
+    m_peak = std::max (m_peak, m_held + m_pending.size() + m_writing);
+
+    m_ready.notify_one();
+}
+
+/******************************************************************************/
+
+void
+Output::close() {
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        m_closed = true;
+        m_ready.notify_one();
+    }
+
+    if (m_writer.joinable()) m_writer.join();
+}
+
+/******************************************************************************/
+
+void
+Output::grow() {
+    std::vector<Item> ring (m_ring.size() * 2);
+
+    for (auto i = m_next ; i < m_next + m_ring.size() ; ++i) {
+        ring[i % ring.size()] = std::move (slot (i));
+    }
+
+    m_ring.swap (ring);
+}
+
+/******************************************************************************/
+
+/**
+ * Everything that can be written is taken at once and written without
+ * the lock so workers putting lines never wait on the output. Once closed
+ * anything left is written regardless of gaps, there being nothing more
+ * to wait for
+ */
+void
+Output::run() {
+    std::vector<Item> batch;
+
+    std::unique_lock<std::mutex> lock (m_lock);
+
+    for (;;) {
+        auto ready = [this]() {
+            return !m_pending.empty() || (m_held && (m_closed || slot (m_next).m_held));
+        };
+
+        m_ready.wait (lock, [&]() { return ready() || m_closed; });
+
+        if (!ready()) break;
+
+        for (auto & item : m_pending) batch.push_back (std::move (item));
+        m_pending.clear();
+
+        while (m_held && (m_closed || slot (m_next).m_held)) {
+            auto & held = slot (m_next++);
+
+            if (!held.m_held) continue;
+
+            held.m_held = false;
+            --m_held;
+
+            batch.push_back (std::move (held));
+        }
+
+        m_writing = batch.size();
+
+        lock.unlock();
+
+        for (const auto & item : batch) m_write (item.m_index, item.m_route, item.m_line, item.m_report);
+
+        lock.lock();
+
+        m_written += batch.size();
+        m_writing = 0;
+
+        for (auto & item : batch) m_spare.push_back (std::move (item));
+        batch.clear();
+
+        m_space.notify_all();
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,175 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+#include <functional>
+#include <condition_variable>
+
+/******************************************************************************/
+
+/**
+ * The last stage of a batch. Workers hand each blob's line over by [put]
+ * and go straight back to decoding, the lines being written out by a
+ * thread of the output's own, in the order the blobs were given when
+ * asked to be, so a slow output stalls nobody but that thread.
+ *
+ * Whatever hands out the work [admit]s each blob before it's decoded and
+ * waits there once the window's worth admitted haven't all been written
+ * yet. When the output can't keep up the reading and decoding ahead of it
+ * stop rather than piling up lines, so however slow a pipe or upload it's
+ * writing to at most [window] lines are held at once.
+ *
+ * Blobs must be admitted in the order they're to be written, so the one
+ * the writer's waiting on has always been admitted before anything it's
+ * holding back.
+ *
+ * Ordered, the lines that finish ahead of their turn are held in a ring
+ * of a window's worth of slots, the [i_]th blob's in slot [i_] modulo its
+ * size, so releasing the next in sequence is a look at a single slot.
+ * Admission only counts blobs, not which they are, so one handed out of
+ * order, largest first say, can be put a window or more ahead of the
+ * next to write, its slot still holding another's line. The ring then
+ * doubles until no two held share a slot, and stays that size, so it's
+ * only allocated again the few times a line lands further ahead than it's
+ * been before. Without a window the ring grows to fit whatever's been
+ * held back.
+ *
+ * Each line can be put with a route, the name of the output it's bound
+ * for, which is handed on with it to a [Routed] writer.
+ */
+class Output {
+    public :
+        /**
+         * Called, from the writer's thread, with each line and what's to
+         * be reported apart from the output, either of which may be empty
+         */
+        using Write = std::function<void (const std::string & line_, const std::string & report_)>;
+
+        using Routed = std::function<void (
+            const std::string & route_,
+            const std::string & line_,
+            const std::string & report_)>;
+
+        /**
+         * Also told which blob the line's for, by the index it was [put]
+         * with
+         */
+        using Indexed = std::function<void (
+            size_t i_,
+            const std::string & route_,
+            const std::string & line_,
+            const std::string & report_)>;
+
+    private :
+        struct Item {
+            size_t m_index;
+            std::string m_line;
+            std::string m_report;
+            std::string m_route;
+
+            /**
+             * Whether a ring slot holds a line yet to be written
+             */
+            bool m_held { false };
+        };
+
+        Indexed m_write;
+        const size_t m_window;
+        const bool m_ordered;
+
+        std::mutex m_lock;
+
+        /**
+         * Signalled as items are [put], and closing
+         */
+        std::condition_variable m_ready;
+
+        /**
+         * Signalled as items are written
+         */
+        std::condition_variable m_space;
+
+        /**
+         * Lines held back until their turn when ordered, [m_next] being
+         * the next to write, and how many are held
+         */
+        std::vector<Item> m_ring;
+        size_t m_held;
+
+        /**
+         * Lines ready to write in the order they were put, every line
+         * when unordered
+         */
+        std::vector<Item> m_pending;
+
+        /**
+         * Written items' strings, their capacity swapped back to the
+         * workers for their next lines
+         */
+        std::vector<Item> m_spare;
+
+        size_t m_admitted;
+        size_t m_written;
+        size_t m_next;
+        size_t m_peak;
+
+        /**
+         * Taken from [m_pending] but still being written
+         */
+        size_t m_writing;
+
+        bool m_closed;
+
+        std::thread m_writer;
+
+        Item & slot (size_t i_) { return m_ring[i_ % m_ring.size()]; }
+
+        /**
+         * Double the ring, keeping every held line in its slot
+         */
+        void grow();
+
+        void run();
+
+    public :
+        Output (Write write_, size_t window_, bool ordered_);
+        Output (Routed write_, size_t window_, bool ordered_);
+        Output (Indexed write_, size_t window_, bool ordered_);
+
+        Output (const Output &) = delete;
+
+        /**
+         * Write whatever's left, see [close]
+         */
+        ~Output();
+
+        /**
+         * Wait until one more blob may be started
+         */
+        void admit();
+
+        /**
+         * The line and report for the [i_]th blob, swapped for strings
+         * whose capacity can be reused, and where it's to go
+         */
+        void put (size_t i_, std::string & line_, std::string & report_, std::string_view route_ = { });
+
+        /**
+         * Once everything admitted has been put, write the last of it and
+         * stop the writer
+         */
+        void close();
+
+        /**
+         * The most lines held at once, waiting or being written
+         */
+        size_t peak() const { return m_peak; }
+};
+
+/******************************************************************************/
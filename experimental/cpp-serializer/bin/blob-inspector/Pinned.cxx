@@ -0,0 +1,374 @@
+#include "Pinned.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include "Numa.h"
+#include "Server.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Polled this many times in a row with nothing arriving a worker
+     * yields, so sharing its CPU with anything else it doesn't starve it
+     */
+    constexpr size_t SPINS = 64;
+
+    void
+    relax() {
+#if defined (__x86_64__) || defined (__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    /**
+     * A reply's length and the reply itself in as few writes as the
+     * socket will take
+     */
+    bool
+    reply (int fd_, const std::string & line_) {
+        auto length = static_cast<uint32_t> (line_.size());
+
+        char size[4] {
+            static_cast<char> ((length >> 24) & 0xff),
+            static_cast<char> ((length >> 16) & 0xff),
+            static_cast<char> ((length >> 8) & 0xff),
+            static_cast<char> (length & 0xff)
+        };
+
+        iovec io[2] {
+            { size, sizeof (size) },
+            { const_cast<char *> (line_.data()), line_.size() }
+        };
+
+        msghdr msg { };
+        msg.msg_iov = io;
+        msg.msg_iovlen = 2;
+
+        while (msg.msg_iovlen > 0) {
+            auto sent = ::sendmsg (fd_, &msg, MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+
+            auto left = static_cast<size_t> (sent);
+
+            while (msg.msg_iovlen > 0 && left >= msg.msg_iov->iov_len) {
+                left -= msg.msg_iov->iov_len;
+                ++msg.msg_iov;
+                --msg.msg_iovlen;
+            }
+
+            if (msg.msg_iovlen > 0) {
+                msg.msg_iov->iov_base = static_cast<char *> (msg.msg_iov->iov_base) + left;
+                msg.msg_iov->iov_len -= left;
+            }
+        }
+
+        return true;
+    }
+
+}
+
+/******************************************************************************/
+
+Pinned::Session::Session (size_t frame_)
+    // sized rather than reserved so every page is touched now
+    : m_frame (frame_)
+{
+}
+
+/******************************************************************************/
+
+Pinned::Pinned (size_t workers_, Answer answer_, Warm warm_)
+    : m_answer (std::move (answer_))
+    , m_warm (std::move (warm_))
+    , m_started (0)
+    , m_stopping (false)
+    , m_stopped (false)
+{
+    auto cpus = Numa::usable();
+
+    for (size_t i { 0 } ; i < std::max<size_t> (workers_, 1) ; ++i) {
+        m_workers.push_back (std::make_unique<Worker>());
+
+        auto & worker = *m_workers.back();
+        worker.m_index = i;
+        worker.m_cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+    }
+
+    for (auto & worker : m_workers) {
+        worker->m_thread = std::thread ([this, &worker = *worker]() { work (worker); });
+    }
+
+    m_builder = std::thread ([this]() { build(); });
+
+    // nothing's handed to a worker before it's ready for it
+    while (m_started.load (std::memory_order_acquire) < m_workers.size()) {
+        std::this_thread::yield();
+    }
+}
+
+/******************************************************************************/
+
+Pinned::~Pinned() {
+    stop();
+}
+
+/******************************************************************************/
+
+void
+Pinned::add (int fd_) {
+    std::lock_guard<std::mutex> adding (m_adding);
+
+    auto * least = m_workers.front().get();
+
+    for (auto & worker : m_workers) {
+        if (worker->m_load.load (std::memory_order_relaxed) < least->m_load.load (std::memory_order_relaxed)) {
+            least = worker.get();
+        }
+    }
+
+    least->m_load.fetch_add (1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard (least->m_lock);
+
+    least->m_connections.push_back (fd_);
+    least->m_handed.store (true, std::memory_order_release);
+}
+
+/******************************************************************************/
+
+void
+Pinned::stop() {
+    if (m_stopped) return;
+    m_stopped = true;
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        m_stopping.store (true, std::memory_order_release);
+    }
+
+    m_wake.notify_all();
+
+    m_builder.join();
+
+    for (auto & worker : m_workers) worker->m_thread.join();
+
+    // wherever each connection had got to
+    for (auto & worker : m_workers) {
+        for (auto & session : worker->m_sessions) {
+            if (session->m_fd >= 0) ::close (session->m_fd);
+        }
+
+        for (auto fd : worker->m_connections) ::close (fd);
+    }
+}
+
+/******************************************************************************/
+
+void
+Pinned::work (Worker & worker_) {
+    if (worker_.m_cpu >= 0 && !Numa::pinCpu (worker_.m_cpu)) worker_.m_cpu = -1;
+
+    // allocated on the worker's own CPU, and so node, before any request is
+    worker_.m_sessions.reserve (SESSIONS);
+    worker_.m_serving.reserve (SESSIONS);
+    worker_.m_free.reserve (SESSIONS);
+    worker_.m_connections.reserve (SESSIONS);
+    worker_.m_returned.reserve (SESSIONS);
+
+    for (size_t i { 0 } ; i < SESSIONS ; ++i) {
+        worker_.m_sessions.push_back (std::make_unique<Session> (FRAME));
+        worker_.m_free.push_back (worker_.m_sessions.back().get());
+    }
+
+    worker_.m_line.assign (LINE, '\0');
+    worker_.m_line.clear();
+
+    m_started.fetch_add (1, std::memory_order_release);
+
+    size_t idle { 0 };
+
+    while (!m_stopping.load (std::memory_order_acquire)) {
+        if (worker_.m_handed.load (std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> guard (worker_.m_lock);
+
+            for (auto fd : worker_.m_connections) {
+                if (worker_.m_free.empty()) {
+                    worker_.m_sessions.push_back (std::make_unique<Session> (FRAME));
+                    worker_.m_free.push_back (worker_.m_sessions.back().get());
+                }
+
+                auto * session = worker_.m_free.back();
+                worker_.m_free.pop_back();
+
+                session->m_fd = fd;
+                session->m_worker = worker_.m_index;
+                session->reset();
+
+                worker_.m_serving.push_back (session);
+            }
+
+            for (auto * session : worker_.m_returned) worker_.m_serving.push_back (session);
+
+            worker_.m_connections.clear();
+            worker_.m_returned.clear();
+            worker_.m_handed.store (false, std::memory_order_relaxed);
+        }
+
+        bool busy { false };
+
+        for (size_t i { 0 } ; i < worker_.m_serving.size() ; ) {
+            auto * session = worker_.m_serving[i];
+            auto state = pump (worker_, *session, busy);
+
+            if (state == serving_t) {
+                ++i;
+                continue;
+            }
+
+            if (state == closed_t) close (worker_, *session);
+
+            worker_.m_serving[i] = worker_.m_serving.back();
+            worker_.m_serving.pop_back();
+        }
+
+        if (busy) {
+            idle = 0;
+        } else if (++idle % SPINS == 0) {
+            ::sched_yield();
+        } else {
+            relax();
+        }
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * One request at most is answered per session per pass, so a client
+ * with many queued can't hold the others up
+ */
+Pinned::State
+Pinned::pump (Worker & worker_, Session & session_, bool & busy_) {
+    auto failed = []() {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? serving_t : closed_t;
+    };
+
+    while (session_.header()) {
+        auto got = ::recv (session_.m_fd, session_.m_length + session_.m_read,
+                sizeof (session_.m_length) - session_.m_read, MSG_DONTWAIT);
+
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return failed();
+        if (got == 0) return closed_t;
+
+        busy_ = true;
+        session_.m_read += static_cast<size_t> (got);
+
+        if (session_.header()) continue;
+
+        session_.m_size = (static_cast<size_t> (session_.m_length[0]) << 24)
+            | (static_cast<size_t> (session_.m_length[1]) << 16)
+            | (static_cast<size_t> (session_.m_length[2]) << 8)
+            | static_cast<size_t> (session_.m_length[3]);
+
+        if (session_.m_size > Server::MAX_FRAME) return closed_t;
+        if (session_.m_size > session_.m_frame.size()) session_.m_frame.resize (session_.m_size);
+    }
+
+    while (session_.m_read - sizeof (session_.m_length) < session_.m_size) {
+        auto at = session_.m_read - sizeof (session_.m_length);
+        auto got = ::recv (session_.m_fd, session_.m_frame.data() + at, session_.m_size - at, MSG_DONTWAIT);
+
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return failed();
+        if (got == 0) return closed_t;
+
+        busy_ = true;
+        session_.m_read += static_cast<size_t> (got);
+    }
+
+    session_.m_received = Clock::now();
+
+    if (!m_warm (session_.m_frame.data(), session_.m_size)) {
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            m_building.push_back (&session_);
+        }
+
+        m_wake.notify_one();
+
+        return building_t;
+    }
+
+    m_answer (session_.m_frame.data(), session_.m_size, worker_.m_line, session_.m_received);
+    session_.reset();
+
+    return reply (session_.m_fd, worker_.m_line) ? serving_t : closed_t;
+}
+
+/******************************************************************************/
+
+void
+Pinned::close (Worker & worker_, Session & session_) {
+    ::close (session_.m_fd);
+
+    session_.m_fd = -1;
+    session_.reset();
+
+    worker_.m_free.push_back (&session_);
+    worker_.m_load.fetch_sub (1, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+/**
+ * Whatever's left waiting once stopped is closed with the rest by [stop]
+ */
+void
+Pinned::build() {
+    std::string line;
+
+    while (true) {
+        Session * session;
+
+        {
+            std::unique_lock<std::mutex> guard (m_lock);
+
+            m_wake.wait (guard, [this]() {
+                return !m_building.empty() || m_stopping.load (std::memory_order_acquire);
+            });
+
+            if (m_stopping.load (std::memory_order_acquire)) return;
+
+            session = m_building.front();
+            m_building.pop_front();
+        }
+
+        m_answer (session->m_frame.data(), session->m_size, line, session->m_received);
+        session->reset();
+
+        // a client that's hung up is seen to have by its worker
+        reply (session->m_fd, line);
+
+        auto & worker = *m_workers[session->m_worker];
+
+        std::lock_guard<std::mutex> guard (worker.m_lock);
+
+        worker.m_returned.push_back (session);
+        worker.m_handed.store (true, std::memory_order_release);
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,195 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+/******************************************************************************/
+
+/**
+ * The [Server]'s latency profile, for callers that care how long the
+ * slowest of their requests takes rather than how many are answered.
+ *
+ * Each worker is a thread pinned to a CPU of its own, serving whichever
+ * connections it's been handed by busy polling them, never sleeping in
+ * the kernel waiting for a request to arrive. Every worker is given its
+ * sessions, and the buffers each reads its requests into and writes its
+ * replies from, when it starts, touched so no page of them faults later.
+ * Once a worker has answered a blob of each type it will be sent it
+ * allocates nothing more.
+ *
+ * Only blobs whose schema is already built, see [BlobInspector::warm],
+ * are answered by the workers. Any other request, a blob of a schema not
+ * seen before or the path of a file that could take a while to read, is
+ * handed with its connection to a builder thread, so no worker ever
+ * stalls building readers whilst the requests of its other connections
+ * wait. The builder answers it, and anything else that connection has
+ * sent meanwhile stays queued behind it, before handing the connection
+ * back to the worker it came from.
+ *
+ * Requests and replies are framed just as they are for the [Server],
+ * apart from file descriptors passed alongside frames, and so shared
+ * rings, which workers don't accept.
+ */
+class Pinned {
+    public :
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Answer the request of [size_] bytes at [frame_] into [line_],
+         * [received_] being when it had been read in full
+         */
+        using Answer = std::function<void (
+            const char * frame_, size_t size_, std::string & line_, Clock::time_point received_)>;
+
+        /**
+         * Whether a request can be answered on a worker
+         */
+        using Warm = std::function<bool (const char * frame_, size_t size_)>;
+
+        /**
+         * Sessions each worker starts with, more being added should it
+         * be handed more connections than that
+         */
+        static constexpr size_t SESSIONS = 16;
+
+        /**
+         * How big a request each session, and a reply each worker, can
+         * take without allocating
+         */
+        static constexpr size_t FRAME = 256 * 1024;
+        static constexpr size_t LINE = 1024 * 1024;
+
+    private :
+        struct Session {
+            explicit Session (size_t frame_);
+
+            int m_fd { -1 };
+
+            /**
+             * The length, then the request, read so far
+             */
+            unsigned char m_length[4] { };
+            size_t m_read { 0 };
+            size_t m_size { 0 };
+
+            std::vector<char> m_frame;
+
+            Clock::time_point m_received;
+
+            /**
+             * Where the session's worker is to return it to when the
+             * builder has done with it
+             */
+            size_t m_worker { 0 };
+
+            bool header() const { return m_read < sizeof (m_length); }
+
+            void reset() {
+                m_read = 0;
+                m_size = 0;
+            }
+        };
+
+        enum State { serving_t, building_t, closed_t };
+
+        struct Worker {
+            size_t m_index { 0 };
+
+            std::thread m_thread;
+            int m_cpu { -1 };
+
+            /**
+             * Sessions of its own, those being served and those free to
+             * be, and what's been handed to it, connections and sessions
+             * the builder's done with
+             */
+            std::vector<std::unique_ptr<Session>> m_sessions;
+            std::vector<Session *> m_serving;
+            std::vector<Session *> m_free;
+
+            std::mutex m_lock;
+            std::atomic<bool> m_handed { false };
+            std::vector<int> m_connections;
+            std::vector<Session *> m_returned;
+
+            std::string m_line;
+
+            /**
+             * Connections handed to it that are yet to hang up
+             */
+            std::atomic<size_t> m_load { 0 };
+        };
+
+        Answer m_answer;
+        Warm m_warm;
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<size_t> m_started;
+        std::atomic<bool> m_stopping;
+        bool m_stopped;
+
+        std::thread m_builder;
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        std::deque<Session *> m_building;
+
+        /**
+         * Spreads new connections over the workers
+         */
+        std::mutex m_adding;
+
+        void work (Worker &);
+        void build();
+
+        /**
+         * Read what's arrived for [session_], answering its request
+         * should it then be whole or handing it to the builder, [busy_]
+         * being set should anything have arrived
+         */
+        State pump (Worker &, Session & session_, bool & busy_);
+
+        void close (Worker &, Session &);
+
+    public :
+        /**
+         * [workers_] threads pinned to the first of the CPUs the process
+         * may use, in turn, wrapping round should there be more workers
+         * than CPUs
+         */
+        Pinned (size_t workers_, Answer answer_, Warm warm_);
+
+        Pinned (const Pinned &) = delete;
+
+        ~Pinned();
+
+        /**
+         * Serve [fd_] until its client hangs up, on whichever worker
+         * was handed the fewest connections
+         */
+        void add (int fd_);
+
+        /**
+         * Close every connection and wait for the workers and builder
+         */
+        void stop();
+
+        size_t workers() const { return m_workers.size(); }
+
+        /**
+         * The CPU worker [i_] was pinned to, -1 if pinning it failed
+         */
+        int cpu (size_t i_) const { return m_workers[i_]->m_cpu; }
+};
+
+/******************************************************************************/
@@ -0,0 +1,403 @@
+#include "Registry.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CordaBytes.h"
+
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+#include "cursor/Cursor.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr char MAGIC[] { 'C', 'O', 'R', 'D', 'A', 'R', 'E', 'G' };
+
+    /**
+     * magic, version, count and the index's checksum
+     */
+    constexpr size_t HEADER = sizeof (MAGIC) + 4 + 4 + 8;
+
+    /**
+     * fingerprint, offset, size and padding
+     */
+    constexpr size_t ENTRY = 16 + 8 + 4 + 4;
+
+    /**
+     * How many sections followed the payload and the size of the
+     * envelope's descriptor
+     */
+    constexpr size_t RECORD = 4 + 4;
+
+    /**
+     * The fingerprint and the list's constructor
+     */
+    constexpr size_t STRIPPED = 16 + 1;
+
+    constexpr unsigned char LIST8 = 0xc0;
+    constexpr unsigned char LIST32 = 0xd0;
+
+    std::mutex attachLock;
+    std::shared_ptr<const Registry> attachedRegistry;
+
+    /**************************************************************************/
+
+    uint64_t
+    load (const char * at_) {
+        uint64_t rtn { 0 };
+        for (size_t i { 0 } ; i < 8 ; ++i) {
+            rtn |= static_cast<uint64_t> (static_cast<unsigned char> (at_[i])) << (8 * i);
+        }
+        return rtn;
+    }
+
+    uint32_t
+    load32 (const char * at_) {
+        uint32_t rtn { 0 };
+        for (size_t i { 0 } ; i < 4 ; ++i) {
+            rtn |= static_cast<uint32_t> (static_cast<unsigned char> (at_[i])) << (8 * i);
+        }
+        return rtn;
+    }
+
+    template<class T>
+    void
+    store (std::string & out_, T value_) {
+        for (size_t i { 0 } ; i < sizeof (T) ; ++i) {
+            out_ += static_cast<char> ((static_cast<uint64_t> (value_) >> (8 * i)) & 0xff);
+        }
+    }
+
+    void
+    be32 (std::vector<char> & out_, uint32_t value_) {
+        for (int shift { 24 } ; shift >= 0 ; shift -= 8) {
+            out_.push_back (static_cast<char> ((value_ >> shift) & 0xff));
+        }
+    }
+
+    void
+    append (std::vector<char> & out_, std::string_view bytes_) {
+        out_.insert (out_.end(), bytes_.begin(), bytes_.end());
+    }
+
+    Registry::Fingerprint
+    fingerprint (const char * at_) {
+        return { load (at_), load (at_ + 8) };
+    }
+
+}
+
+/******************************************************************************/
+
+Registry::Registry (std::string path_)
+    : m_path (std::move (path_))
+    , m_map (nullptr)
+    , m_mapSize (0)
+    , m_count (0)
+{
+    int fd = ::open (m_path.c_str(), O_RDONLY);
+
+    if (fd < 0) return;
+
+    struct stat results { };
+
+    if (::fstat (fd, &results) != 0
+        || !S_ISREG (results.st_mode)
+        || static_cast<size_t> (results.st_size) < HEADER)
+    {
+        ::close (fd);
+        return;
+    }
+
+    auto size = static_cast<size_t> (results.st_size);
+    auto * map = ::mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping holds its own reference to the file
+    ::close (fd);
+
+    if (map == MAP_FAILED) return;
+
+    m_map = static_cast<const char *> (map);
+    m_mapSize = size;
+
+    auto count = load32 (m_map + sizeof (MAGIC) + 4);
+
+    bool valid = std::memcmp (m_map, MAGIC, sizeof (MAGIC)) == 0
+        && load32 (m_map + sizeof (MAGIC)) == VERSION
+        && count <= (m_mapSize - HEADER) / ENTRY
+        && load (m_map + sizeof (MAGIC) + 8)
+               == amqp::internal::cursor::hash (std::string_view (m_map + HEADER, count * ENTRY)).m_low;
+
+    if (valid) m_count = count;
+}
+
+/******************************************************************************/
+
+Registry::~Registry() {
+    if (m_map) ::munmap (const_cast<char *> (m_map), m_mapSize);
+}
+
+/******************************************************************************/
+
+size_t
+Registry::size() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_count + m_added.size();
+}
+
+/******************************************************************************/
+
+std::string_view
+Registry::mapped (const Fingerprint & fingerprint_) const {
+    const auto key = std::make_pair (fingerprint_.m_low, fingerprint_.m_high);
+
+    // the entries are sorted by fingerprint, find the first not before ours
+    size_t lo { 0 }, hi { m_count };
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        auto at = fingerprint (m_map + HEADER + mid * ENTRY);
+
+        if (std::make_pair (at.m_low, at.m_high) < key) lo = mid + 1; else hi = mid;
+    }
+
+    if (lo == m_count) return { };
+
+    const char * entry = m_map + HEADER + lo * ENTRY;
+
+    if (fingerprint (entry) != fingerprint_) return { };
+
+    auto offset = load (entry + 16);
+    auto size = load32 (entry + 24);
+
+    if (offset > m_mapSize || m_mapSize - offset < size) return { };
+
+    std::string_view rtn (m_map + offset, size);
+
+    return amqp::internal::cursor::hash (rtn) == fingerprint_ ? rtn : std::string_view { };
+}
+
+/******************************************************************************/
+
+std::string_view
+Registry::find (const Fingerprint & fingerprint_) const {
+    auto rtn = mapped (fingerprint_);
+
+    if (!rtn.empty()) return rtn;
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_added.find (std::make_pair (fingerprint_.m_low, fingerprint_.m_high));
+
+    return it == m_added.end() ? std::string_view { } : std::string_view (it->second);
+}
+
+/******************************************************************************/
+
+/*
+ * The envelope is a described list, the payload then the schema and
+ * whatever else the version of Corda that wrote it adds. Everything
+ * about it but the payload, and the list's size which follows from it,
+ * goes into the record
+ */
+std::string
+Registry::strip (const CordaBytes & blob_) {
+    namespace cursor = amqp::internal::cursor;
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    const char * bytes = blob_.bytes();
+
+    cursor::Cursor data (bytes, blob_.size());
+
+    // throws unless it's an envelope with a schema
+    EnvelopeDescriptor::peek (data);
+
+    std::string_view descriptor, payload, sections;
+    unsigned char constructor;
+    size_t elements, end;
+
+    {
+        cursor::auto_enter ae (data);
+
+        descriptor = std::string_view (bytes, data.offset() + data.encodedSize());
+        data.next();
+
+        constructor = static_cast<unsigned char> (bytes[data.offset()]);
+        end = data.offset() + data.encodedSize();
+
+        if (constructor != LIST8 && constructor != LIST32) {
+            throw std::runtime_error ("Expected the envelope to be a list");
+        }
+
+        cursor::auto_list_enter ale (data, true);
+
+        elements = ale.elements();
+        payload = data.encoded();
+
+        auto from = data.offset() + data.encodedSize();
+        sections = std::string_view (bytes + from, end - from);
+    }
+
+    std::string record;
+    record.reserve (RECORD + descriptor.size() + sections.size());
+
+    store (record, static_cast<uint32_t> (elements - 1));
+    store (record, static_cast<uint32_t> (descriptor.size()));
+    record.append (descriptor);
+    record.append (sections);
+
+    auto fingerprint = amqp::internal::cursor::hash (record);
+
+    if (mapped (fingerprint).empty()) {
+        std::lock_guard<std::mutex> guard (m_lock);
+        m_added.emplace (std::make_pair (fingerprint.m_low, fingerprint.m_high), std::move (record));
+    }
+
+    std::string rtn (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+    rtn += static_cast<char> (amqp::REGISTERED);
+
+    store (rtn, fingerprint.m_low);
+    store (rtn, fingerprint.m_high);
+    rtn += static_cast<char> (constructor);
+    rtn.append (payload);
+    rtn.append (bytes + end, blob_.size() - end);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Registry::restore (const char * blob_, size_t size_, std::vector<char> & out_) const {
+    namespace cursor = amqp::internal::cursor;
+
+    if (size_ < STRIPPED + 1) {
+        throw std::runtime_error ("Registered blob is truncated");
+    }
+
+    auto record = find (fingerprint (blob_));
+
+    if (record.empty()) {
+        throw std::runtime_error ("Blob's schema isn't in the registry");
+    }
+
+    if (record.size() < RECORD || record.size() - RECORD < load32 (record.data() + 4)) {
+        throw std::runtime_error ("Registry record is truncated");
+    }
+
+    auto elements = static_cast<size_t> (load32 (record.data())) + 1;
+    auto descriptor = record.substr (RECORD, load32 (record.data() + 4));
+    auto sections = record.substr (RECORD + descriptor.size());
+
+    auto constructor = static_cast<unsigned char> (blob_[16]);
+
+    std::string_view rest (blob_ + STRIPPED, size_ - STRIPPED);
+    auto payload = rest.substr (0, cursor::Cursor (rest.data(), rest.size()).encodedSize());
+
+    auto body = payload.size() + sections.size();
+
+    out_.reserve (out_.size() + 1 + descriptor.size() + 9 + body + rest.size() - payload.size());
+
+    out_.push_back (static_cast<char> (amqp::DATA_AND_STOP));
+    append (out_, descriptor);
+
+    // the list as it was written, a list8 only ever having held what fits
+    if (constructor == LIST8 && body < 255 && elements < 256) {
+        out_.push_back (static_cast<char> (LIST8));
+        out_.push_back (static_cast<char> (body + 1));
+        out_.push_back (static_cast<char> (elements));
+    } else {
+        out_.push_back (static_cast<char> (LIST32));
+        be32 (out_, static_cast<uint32_t> (body + 4));
+        be32 (out_, static_cast<uint32_t> (elements));
+    }
+
+    append (out_, payload);
+    append (out_, sections);
+    append (out_, rest.substr (payload.size()));
+}
+
+/******************************************************************************/
+
+void
+Registry::save() const {
+    std::map<std::pair<uint64_t, uint64_t>, std::string_view> records;
+
+    for (size_t i { 0 } ; i < m_count ; ++i) {
+        auto at = fingerprint (m_map + HEADER + i * ENTRY);
+        auto bytes = mapped (at);
+
+        if (!bytes.empty()) records.emplace (std::make_pair (at.m_low, at.m_high), bytes);
+    }
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    for (const auto & record : m_added) records.emplace (record.first, record.second);
+
+    std::string index;
+    uint64_t offset { HEADER + records.size() * ENTRY };
+
+    for (const auto & record : records) {
+        store (index, record.first.first);
+        store (index, record.first.second);
+        store (index, offset);
+        store (index, static_cast<uint32_t> (record.second.size()));
+        store (index, static_cast<uint32_t> (0));
+
+        offset += record.second.size();
+    }
+
+    std::string header (MAGIC, sizeof (MAGIC));
+    store (header, VERSION);
+    store (header, static_cast<uint32_t> (records.size()));
+    store (header, amqp::internal::cursor::hash (index).m_low);
+
+    auto tmp = m_path + ".tmp";
+
+    {
+        std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+
+        out << header << index;
+        for (const auto & record : records) out << record.second;
+
+        if (!out.flush()) {
+            throw std::runtime_error ("Failed to write " + tmp);
+        }
+    }
+
+    if (std::rename (tmp.c_str(), m_path.c_str()) != 0) {
+        std::remove (tmp.c_str());
+        throw std::runtime_error ("Failed to replace " + m_path);
+    }
+}
+
+/******************************************************************************/
+
+void
+Registry::attach (std::shared_ptr<const Registry> registry_) {
+    std::lock_guard<std::mutex> guard (attachLock);
+    attachedRegistry = std::move (registry_);
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const Registry>
+Registry::attached() {
+    std::lock_guard<std::mutex> guard (attachLock);
+    return attachedRegistry;
+}
+
+/******************************************************************************/
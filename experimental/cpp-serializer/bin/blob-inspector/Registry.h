@@ -0,0 +1,132 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+class CordaBytes;
+
+/******************************************************************************/
+
+/**
+ * Schemas taken out of blobs and kept once, each keyed on a fingerprint,
+ * a hash of what was taken, so a blob can be stored as just its payload
+ * and the fingerprint of the schema it was written with. Most of a small
+ * state's bytes are its schema, and a vault's states share a handful.
+ *
+ * [strip] turns a blob into one of those, a REGISTERED section holding
+ * the fingerprint, the constructor of the envelope's list and then the
+ * payload, exactly as it was encoded, along with anything that followed
+ * the envelope. [restore] puts the envelope back together, byte for byte
+ * as it was, decompressed should it have been compressed. Once attached,
+ * see [attach], [CordaBytes] does so for any blob it's given, so anything
+ * reading blobs reads stripped ones just as it does any other, and with
+ * the schema's bytes as they were the [ReaderCache] still finds it.
+ *
+ * The registry is a file mapped read only when opened, nothing in it
+ * being read until a fingerprint is looked up.
+ *
+ *   header   "CORDAREG", version, count, checksum of the index
+ *   index    count entries sorted by fingerprint: the fingerprint, the
+ *            offset and size of the record
+ *   records  how many sections followed the payload, the size of the
+ *            envelope's descriptor, then the descriptor and the sections
+ *            as they were encoded
+ *
+ * Every integer is little endian. A file with the wrong magic or version,
+ * or whose index doesn't check out, is treated as empty, and a record
+ * whose fingerprint isn't that of its bytes as missing.
+ */
+class Registry {
+    public :
+        using Fingerprint = amqp::internal::cursor::Hash;
+
+        static constexpr uint32_t VERSION = 1;
+
+    private :
+        std::string m_path;
+
+        const char * m_map;
+        size_t m_mapSize;
+
+        /**
+         * Entries in the mapping's index, zero when it isn't a valid
+         * registry
+         */
+        uint32_t m_count;
+
+        /**
+         * Records [strip] found that the mapping doesn't hold, kept until
+         * [save]d. Nodes of a map don't move so views of them handed out
+         * by [find] stay good as more are added
+         */
+        mutable std::mutex m_lock;
+        std::map<std::pair<uint64_t, uint64_t>, std::string> m_added;
+
+        std::string_view mapped (const Fingerprint &) const;
+
+    public :
+        /**
+         * Map the registry at [path_], which needn't exist yet
+         */
+        explicit Registry (std::string path_);
+
+        Registry (const Registry &) = delete;
+        Registry & operator = (const Registry &) = delete;
+
+        ~Registry();
+
+        const std::string & path() const { return m_path; }
+
+        /**
+         * How many schemas it holds, those added since it was mapped
+         * included
+         */
+        size_t size() const;
+
+        /**
+         * The record of [fingerprint_], empty if there isn't one
+         */
+        std::string_view find (const Fingerprint & fingerprint_) const;
+
+        /**
+         * [blob_] without its schema, the schema being added to the
+         * registry if it doesn't already hold it. Safe to call from
+         * several threads at once
+         */
+        std::string strip (const CordaBytes & blob_);
+
+        /**
+         * Append to [out_] the blob, from its encoding section on, that
+         * the [size_] bytes of a REGISTERED section following its section
+         * id were stripped from
+         */
+        void restore (const char * blob_, size_t size_, std::vector<char> & out_) const;
+
+        /**
+         * Rewrite the file with every schema already in it along with those
+         * added since. The new file is written alongside and renamed over
+         * the old one
+         */
+        void save() const;
+
+        /**
+         * The registry [CordaBytes] restores REGISTERED blobs from, there
+         * being none until one is attached
+         */
+        static void attach (std::shared_ptr<const Registry>);
+        static std::shared_ptr<const Registry> attached();
+};
+
+/******************************************************************************/
@@ -0,0 +1,47 @@
+#include "Schedule.h"
+
+#include <numeric>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+/******************************************************************************/
+
+Schedule::Schedule (const std::vector<std::string> & files_, size_t window_, bool ordered_)
+    : m_next (0)
+{
+    m_sizes.reserve (files_.size());
+
+    for (const auto & file : files_) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size (file, ec);
+
+        m_sizes.push_back (ec ? 0 : size);
+    }
+
+    m_order = order (m_sizes, window_, ordered_);
+}
+
+/******************************************************************************/
+
+/**
+ * Stable, so files of the same size keep their order
+ */
+std::vector<size_t>
+Schedule::order (const std::vector<uint64_t> & sizes_, size_t window_, bool ordered_) {
+    std::vector<size_t> rtn (sizes_.size());
+    std::iota (rtn.begin(), rtn.end(), 0);
+
+    auto largest = [&sizes_](size_t lhs_, size_t rhs_) { return sizes_[lhs_] > sizes_[rhs_]; };
+
+    const auto block = ordered_ ? std::max<size_t> (window_, 1) : rtn.size();
+
+    for (size_t at { 0 } ; at < rtn.size() ; at += block) {
+        auto end = rtn.begin() + static_cast<std::ptrdiff_t> (std::min (rtn.size(), at + block));
+        std::stable_sort (rtn.begin() + static_cast<std::ptrdiff_t> (at), end, largest);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,61 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/******************************************************************************/
+
+/**
+ * The order a batch's files are started in when their sizes are mixed,
+ * most small and a few huge, so a huge one isn't left till last to run
+ * on alone whilst every other worker sits idle.
+ *
+ * Files are started largest first, each worker taking the next as it's
+ * done with the last, so once the largest are running the rest of the
+ * workers work through the smaller ones around them. Those of at least
+ * [LARGE] bytes are also worth a batch splitting across threads of their
+ * own, see [BlobInspector::threads].
+ *
+ * Written in order, a file can't be started more than a window's worth
+ * ahead of the next to be written, see [Output], so files are only put
+ * largest first within each window's worth of them in turn. Unordered,
+ * the whole batch is.
+ *
+ * Sizes are those the files have when scheduled, a file that can't be
+ * statted being taken for empty and so started last.
+ */
+class Schedule {
+    public :
+        static constexpr uint64_t LARGE = 16 * 1024 * 1024;
+
+    private :
+        std::vector<uint64_t> m_sizes;
+        std::vector<size_t> m_order;
+
+        std::atomic<size_t> m_next;
+
+    public :
+        Schedule (const std::vector<std::string> & files_, size_t window_, bool ordered_);
+
+        Schedule (const Schedule &) = delete;
+
+        /**
+         * The indexes of [sizes_] in the order they're to be started
+         */
+        static std::vector<size_t> order (const std::vector<uint64_t> & sizes_, size_t window_, bool ordered_);
+
+        /**
+         * The index of the next file to start, from any thread, each
+         * call giving another until every file's been given
+         */
+        size_t next() { return m_order[m_next.fetch_add (1, std::memory_order_relaxed)]; }
+
+        uint64_t size (size_t i_) const { return m_sizes[i_]; }
+};
+
+/******************************************************************************/
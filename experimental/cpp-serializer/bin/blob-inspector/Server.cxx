@@ -0,0 +1,567 @@
+#include "Server.h"
+
+#include <chrono>
+#include <cerrno>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "Pinned.h"
+#include "CordaBytes.h"
+#include "SharedRing.h"
+#include "BlobInspector.h"
+#include "WorkStealingPool.h"
+
+#include "amqp/AMQPHeader.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * As read but keeping any descriptor passed with the bytes in
+     * [passed_], closing any after the first
+     */
+    ssize_t
+    receive (int fd_, char * to_, size_t size_, int & passed_) {
+        iovec io { to_, size_ };
+
+        alignas (cmsghdr) char control[CMSG_SPACE (sizeof (int))];
+
+        msghdr msg { };
+        msg.msg_iov = &io;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof (control);
+
+        auto got = ::recvmsg (fd_, &msg, MSG_CMSG_CLOEXEC);
+
+        if (got < 0) return got;
+
+        for (auto * cmsg = CMSG_FIRSTHDR (&msg) ; cmsg ; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+
+            int fd;
+            std::memcpy (&fd, CMSG_DATA (cmsg), sizeof (fd));
+
+            if (passed_ >= 0) {
+                ::close (fd);
+            } else {
+                passed_ = fd;
+            }
+        }
+
+        return got;
+    }
+
+    bool
+    readFully (int fd_, char * to_, size_t size_, int * passed_ = nullptr) {
+        while (size_ > 0) {
+            auto got = passed_
+                ? receive (fd_, to_, size_, *passed_)
+                : ::read (fd_, to_, size_);
+
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+
+            to_ += got;
+            size_ -= static_cast<size_t> (got);
+        }
+
+        return true;
+    }
+
+    bool
+    writeFully (int fd_, const char * from_, size_t size_) {
+        while (size_ > 0) {
+            // a client hanging up mustn't take the server down with it
+            auto sent = ::send (fd_, from_, size_, MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+
+            from_ += sent;
+            size_ -= static_cast<size_t> (sent);
+        }
+
+        return true;
+    }
+
+    /**
+     * Wake the other side of a shared ring
+     */
+    bool
+    ring (int fd_) {
+        const char wake { 0 };
+        return writeFully (fd_, &wake, 1);
+    }
+
+    /**
+     * Block until the other side of a shared ring wakes this one, false
+     * once it's hung up
+     */
+    bool
+    sleep (int fd_) {
+        char rung[64];
+
+        ssize_t got;
+        while ((got = ::read (fd_, rung, sizeof (rung))) < 0 && errno == EINTR) { }
+
+        return got > 0;
+    }
+
+    bool
+    isShared (const std::vector<char> & frame_) {
+        return frame_.size() == sizeof (Server::SHARED) - 1
+            && std::memcmp (frame_.data(), Server::SHARED, frame_.size()) == 0;
+    }
+
+    bool
+    isBlob (const char * frame_, size_t size_) {
+        return size_ >= amqp::AMQP_HEADER.size()
+            && std::memcmp (frame_, amqp::AMQP_HEADER.data(), amqp::AMQP_HEADER.size()) == 0;
+    }
+
+    /**
+     * Whether a pinned worker can answer the request without building
+     * anything, a malformed blob being left to the builder to report
+     */
+    bool
+    warm (const char * frame_, size_t size_) {
+        if (!isBlob (frame_, size_)) return false;
+
+        try {
+            CordaBytes cb (frame_, size_);
+            return BlobInspector (cb).warm();
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+Server::Server (std::string path_, Batch::Options options_)
+    : m_path (std::move (path_))
+    , m_options (std::move (options_))
+    , m_listen (-1)
+    , m_http (-1)
+    , m_latency (false)
+    , m_wake { -1, -1 }
+{
+    sockaddr_un addr { };
+    addr.sun_family = AF_UNIX;
+
+    if (m_path.size() >= sizeof (addr.sun_path)) {
+        throw std::runtime_error ("Socket path too long: " + m_path);
+    }
+
+    std::memcpy (addr.sun_path, m_path.c_str(), m_path.size() + 1);
+
+    if (::pipe (m_wake) != 0) {
+        throw std::runtime_error ("Failed to create a pipe");
+    }
+
+    m_listen = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+    ::unlink (m_path.c_str());
+
+    if (m_listen < 0
+        || ::bind (m_listen, reinterpret_cast<sockaddr *> (&addr), sizeof (addr)) != 0
+        || ::listen (m_listen, SOMAXCONN) != 0)
+    {
+        auto err = std::string (std::strerror (errno));
+
+        if (m_listen >= 0) ::close (m_listen);
+        ::close (m_wake[0]);
+        ::close (m_wake[1]);
+
+        throw std::runtime_error ("Failed to listen on " + m_path + ": " + err);
+    }
+}
+
+/******************************************************************************/
+
+Server::~Server() {
+    if (m_http >= 0) ::close (m_http);
+    ::close (m_listen);
+    ::close (m_wake[0]);
+    ::close (m_wake[1]);
+    ::unlink (m_path.c_str());
+}
+
+/******************************************************************************/
+
+bool
+Server::read (int fd_, std::vector<char> & frame_, int * passed_) {
+    unsigned char size[4];
+
+    if (passed_) *passed_ = -1;
+
+    if (!readFully (fd_, reinterpret_cast<char *> (size), sizeof (size), passed_)) {
+        return false;
+    }
+
+    size_t length = (static_cast<size_t> (size[0]) << 24)
+        | (static_cast<size_t> (size[1]) << 16)
+        | (static_cast<size_t> (size[2]) << 8)
+        | static_cast<size_t> (size[3]);
+
+    if (length > MAX_FRAME) return false;
+
+    frame_.resize (length);
+
+    return readFully (fd_, frame_.data(), length);
+}
+
+/******************************************************************************/
+
+bool
+Server::write (int fd_, const std::string & frame_) {
+    auto length = static_cast<uint32_t> (frame_.size());
+
+    const char size[4] {
+        static_cast<char> ((length >> 24) & 0xff),
+        static_cast<char> ((length >> 16) & 0xff),
+        static_cast<char> ((length >> 8) & 0xff),
+        static_cast<char> (length & 0xff)
+    };
+
+    return writeFully (fd_, size, sizeof (size))
+        && writeFully (fd_, frame_.data(), frame_.size());
+}
+
+/******************************************************************************/
+
+bool
+Server::answer (
+    const char * frame_,
+    size_t size_,
+    std::string & line_,
+    std::chrono::steady_clock::time_point start_
+) {
+    static thread_local std::string error;
+
+    size_t bytes { size_ };
+    bool ok;
+
+    if (isBlob (frame_, size_)) {
+        try {
+            // decoded where it is, so the frame's buffer serves the next
+            CordaBytes cb (frame_, size_);
+            ok = Batch::render (cb, { }, line_, m_options.m_paths, m_options.m_pointers, &error);
+        } catch (const std::exception & e) {
+            line_ = Batch::error ({ }, e.what());
+            error = e.what();
+            ok = false;
+        }
+    } else {
+        std::string file (frame_, size_);
+
+        struct stat results { };
+        bytes = ::stat (file.c_str(), &results) == 0 ? results.st_size : 0;
+
+        ok = Batch::render (file, line_, m_options.m_paths, m_options.m_pointers, &error);
+    }
+
+    m_metrics.record (
+        std::chrono::duration<double> (std::chrono::steady_clock::now() - start_).count(),
+        bytes,
+        ok ? nullptr : &error);
+
+    return ok;
+}
+
+/******************************************************************************/
+
+void
+Server::serve (int fd_) {
+    std::vector<char> frame;
+    std::string line;
+
+    int passed;
+
+    while (read (fd_, frame, &passed)) {
+        if (passed >= 0) {
+            auto shared = std::exchange (passed, -1);
+
+            if (isShared (frame)) {
+                share (fd_, shared);
+                break;
+            }
+
+            ::close (shared);
+        }
+
+        answer (frame.data(), frame.size(), line, std::chrono::steady_clock::now());
+
+        if (!write (fd_, line)) break;
+    }
+
+    // passed with a frame that was never read in full
+    if (passed >= 0) ::close (passed);
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        m_clients.erase (fd_);
+    }
+
+    ::close (fd_);
+}
+
+/******************************************************************************/
+
+/**
+ * Answer the requests left in the ring the client passed as [passed_]
+ * until it hangs up. Each request is copied out of its slot before being
+ * looked at, as the client could change the slot whilst it's decoded
+ */
+void
+Server::share (int fd_, int passed_) {
+    std::unique_ptr<SharedRing> ring;
+
+    try {
+        ring = std::make_unique<SharedRing> (passed_);
+    } catch (const std::exception & e) {
+        write (fd_, Batch::error ({ }, e.what()));
+        return;
+    }
+
+    if (!write (fd_, { })) return;
+
+    std::string line;
+    std::string error;
+
+    while (true) {
+        auto * slot = ring->next();
+
+        if (!slot) {
+            ring->serverWaiting (true);
+
+            if (!(slot = ring->next())) {
+                auto awake = sleep (fd_);
+                ring->serverWaiting (false);
+
+                if (!awake) break;
+                continue;
+            }
+
+            ring->serverWaiting (false);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto request = *slot;
+        bool ok { false };
+
+        if (!ring->contains (request.m_blob, request.m_size)
+            || !ring->contains (request.m_result, request.m_capacity))
+        {
+            error = "Not in the shared ring";
+            slot->m_written = 0;
+            slot->m_status = SharedRing::INVALID;
+        } else {
+            try {
+                CordaBytes cb (ring->data() + request.m_blob, request.m_size);
+                ok = Batch::render (cb, { }, line, m_options.m_paths, m_options.m_pointers, &error);
+            } catch (const std::exception & e) {
+                line = Batch::error ({ }, e.what());
+                error = e.what();
+            }
+
+            slot->m_written = line.size();
+
+            if (line.size() > request.m_capacity) {
+                slot->m_status = SharedRing::TRUNCATED;
+            } else {
+                std::memcpy (ring->data() + request.m_result, line.data(), line.size());
+                slot->m_status = ok ? SharedRing::DONE : SharedRing::FAILED;
+            }
+        }
+
+        m_metrics.record (
+            std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count(),
+            request.m_size,
+            ok ? nullptr : &error);
+
+        ring->answer();
+
+        if (ring->clientWaiting() && !::ring (fd_)) break;
+    }
+}
+
+/******************************************************************************/
+
+void
+Server::metrics (uint16_t port_) {
+    sockaddr_in addr { };
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_ANY);
+    addr.sin_port = htons (port_);
+
+    int fd = ::socket (AF_INET, SOCK_STREAM, 0);
+    int reuse { 1 };
+
+    if (fd < 0
+        || ::setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse)) != 0
+        || ::bind (fd, reinterpret_cast<sockaddr *> (&addr), sizeof (addr)) != 0
+        || ::listen (fd, SOMAXCONN) != 0)
+    {
+        auto err = std::string (std::strerror (errno));
+        if (fd >= 0) ::close (fd);
+
+        throw std::runtime_error (
+                "Failed to serve metrics on port " + std::to_string (port_) + ": " + err);
+    }
+
+    if (m_http >= 0) ::close (m_http);
+    m_http = fd;
+}
+
+/******************************************************************************/
+
+uint16_t
+Server::metricsPort() const {
+    if (m_http < 0) return 0;
+
+    sockaddr_in addr { };
+    socklen_t size { sizeof (addr) };
+
+    return ::getsockname (m_http, reinterpret_cast<sockaddr *> (&addr), &size) == 0
+        ? ntohs (addr.sin_port)
+        : 0;
+}
+
+/******************************************************************************/
+
+/**
+ * Answer a single HTTP request. Scrapes are small and rare so they're
+ * answered on the accepting thread rather than taking a worker, a client
+ * that's slow to send its request being given up on after a second
+ */
+void
+Server::scrape (int fd_) {
+    std::string request;
+    char buffer[1024];
+
+    while (request.find ("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        pollfd wait { fd_, POLLIN, 0 };
+
+        if (::poll (&wait, 1, 1000) <= 0) break;
+
+        auto got = ::read (fd_, buffer, sizeof (buffer));
+        if (got <= 0) break;
+
+        request.append (buffer, static_cast<size_t> (got));
+    }
+
+    bool found = request.compare (0, 13, "GET /metrics ") == 0
+        || request.compare (0, 13, "GET /metrics?") == 0;
+
+    auto body = found ? m_metrics.text() : std::string ("Not Found\n");
+
+    auto response = std::string (found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n")
+        + "Content-Type: text/plain; version=0.0.4\r\n"
+        + "Content-Length: " + std::to_string (body.size()) + "\r\n"
+        + "Connection: close\r\n\r\n"
+        + body;
+
+    writeFully (fd_, response.data(), response.size());
+
+    ::close (fd_);
+}
+
+/******************************************************************************/
+
+void
+Server::run() {
+    auto threads = m_options.m_threads == 0
+        ? std::thread::hardware_concurrency()
+        : m_options.m_threads;
+
+    std::optional<WorkStealingPool> pool;
+    std::optional<Pinned> pinned;
+
+    if (m_latency) {
+        pinned.emplace (
+            threads,
+            [this](const char * frame_, size_t size_, std::string & line_, Pinned::Clock::time_point received_) {
+                answer (frame_, size_, line_, received_);
+            },
+            warm);
+    } else {
+        pool.emplace (threads);
+    }
+
+    pollfd fds[3] {
+        { m_listen, POLLIN, 0 },
+        { m_wake[0], POLLIN, 0 },
+        { m_http, POLLIN, 0 }
+    };
+
+    while (true) {
+        if (::poll (fds, m_http >= 0 ? 3 : 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[1].revents) break;
+
+        if (m_http >= 0 && (fds[2].revents & POLLIN)) {
+            int fd = ::accept (m_http, nullptr, nullptr);
+            if (fd >= 0) scrape (fd);
+        }
+
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = ::accept (m_listen, nullptr, nullptr);
+
+        if (fd < 0) continue;
+
+        if (pinned) {
+            pinned->add (fd);
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            m_clients.insert (fd);
+        }
+
+        pool->submit ([this, fd]() { serve (fd); });
+    }
+
+    if (pinned) {
+        pinned->stop();
+    } else {
+        // wake every worker blocked reading from a client
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            for (auto fd : m_clients) ::shutdown (fd, SHUT_RDWR);
+        }
+
+        pool->wait();
+    }
+
+    char drained;
+    while (::read (m_wake[0], &drained, 1) < 0 && errno == EINTR) { }
+}
+
+/******************************************************************************/
+
+void
+Server::stop() {
+    const char wake { 0 };
+    while (::write (m_wake[1], &wake, 1) < 0 && errno == EINTR) { }
+}
+
+/******************************************************************************/
@@ -0,0 +1,145 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+#include "Batch.h"
+#include "Metrics.h"
+
+/******************************************************************************/
+
+/**
+ * Decodes blobs for as long as it runs, handed them over a Unix domain
+ * socket, so everything a process pays for once, from initialising the
+ * descriptor registry to compiling each schema, is paid for once however
+ * many blobs are decoded.
+ *
+ * Requests and replies are both frames: a four byte, big endian, length
+ * followed by that many bytes. A request is either a whole blob, header
+ * and all, or the path of a file holding one. Each is answered, in the
+ * order they were sent, with the line [Batch] would have written for it,
+ * the "file" key being omitted for a blob sent inline. A connection may
+ * send as many requests as it likes and is served by one of a pool of
+ * workers, so up to that many clients are decoded for at once, all of
+ * them sharing the process wide reader cache.
+ *
+ * A client on the same host can instead send a frame holding just
+ * [SHARED] with a [SharedRing]'s descriptor passed alongside it. The
+ * server answers with an empty frame once it's mapped the ring, after
+ * which that connection's blobs are decoded where they lie in the ring
+ * and their lines written back into it, see [SharedClient].
+ *
+ * Given a port to serve [metrics] on, a GET of /metrics there returns
+ * the server's [Metrics] for Prometheus to scrape.
+ *
+ * Asked to favour [latency], connections are served by [Pinned] workers
+ * instead, busy polling rather than waiting on the kernel, and with the
+ * building of readers for a schema not seen before kept off them.
+ */
+class Server {
+    public :
+        /**
+         * The longest request read before the connection is dropped
+         */
+        static constexpr size_t MAX_FRAME = 256 * 1024 * 1024;
+
+        /**
+         * A request to decode through a shared ring from now on
+         */
+        static constexpr char SHARED[] = "shared-ring";
+
+    private :
+        std::string m_path;
+        Batch::Options m_options;
+
+        int m_listen;
+
+        /**
+         * Where scrapes of the metrics are accepted, once asked for
+         */
+        int m_http;
+
+        Metrics m_metrics;
+
+        bool m_latency;
+
+        /**
+         * Written to by [stop] to wake [run]
+         */
+        int m_wake[2];
+
+        std::mutex m_lock;
+        std::set<int> m_clients;
+
+        /**
+         * Answer the request of [size_] bytes at [frame_] into [line_],
+         * timed from [start_], false should it fail
+         */
+        bool answer (
+            const char * frame_,
+            size_t size_,
+            std::string & line_,
+            std::chrono::steady_clock::time_point start_);
+
+        void serve (int);
+        void share (int, int);
+        void scrape (int);
+
+    public :
+        /**
+         * Listen on a socket at [path_], replacing anything already
+         * there. Only [m_threads], [m_paths] and [m_pointers] of
+         * [options_] mean anything to a server
+         */
+        Server (std::string path_, Batch::Options options_);
+
+        Server (const Server &) = delete;
+
+        ~Server();
+
+        /**
+         * Serve metrics over HTTP on [port_], any free port if zero
+         */
+        void metrics (uint16_t port_);
+
+        /**
+         * The port metrics are served on, zero if they aren't
+         */
+        uint16_t metricsPort() const;
+
+        const Metrics & metrics() const { return m_metrics; }
+
+        /**
+         * Serve connections on pinned, busy polling, workers, one per
+         * [m_threads] of the options, from the next [run] on
+         */
+        void latency (bool latency_) { m_latency = latency_; }
+
+        /**
+         * Accept and serve connections until stopped
+         */
+        void run();
+
+        /**
+         * Have [run] return once every open connection has been dropped.
+         * Safe to call from a signal handler
+         */
+        void stop();
+
+        /**
+         * Read one frame from [fd_], false at the end of the stream or
+         * should the frame be over long. Given [passed_], a descriptor
+         * sent along with the frame is left there, -1 if there wasn't one
+         */
+        static bool read (int fd_, std::vector<char> & frame_, int * passed_ = nullptr);
+
+        static bool write (int fd_, const std::string & frame_);
+};
+
+/******************************************************************************/
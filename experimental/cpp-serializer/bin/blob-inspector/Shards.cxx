@@ -0,0 +1,285 @@
+#include "Shards.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Checkpoint.h"
+
+#include "cursor/Hash.h"
+#include "stats/Stats.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Lamping and Veach's jump consistent hash, the bucket of [key_]
+     * changing as [buckets_] grows only for the keys that move to the
+     * new bucket
+     */
+    size_t
+    jump (uint64_t key_, size_t buckets_) {
+        int64_t b { -1 }, j { 0 };
+
+        while (j < static_cast<int64_t> (buckets_)) {
+            b = j;
+            key_ = key_ * 2862933555777941757ULL + 1;
+            j = static_cast<int64_t> (static_cast<double> (b + 1)
+                    * (static_cast<double> (1LL << 31) / static_cast<double> ((key_ >> 33) + 1)));
+        }
+
+        return static_cast<size_t> (b);
+    }
+
+    std::string
+    slurp (const std::string & path_) {
+        std::ifstream in (path_, std::ios::binary);
+        if (!in) throw std::runtime_error ("Failed to open " + path_);
+
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+}
+
+/******************************************************************************/
+
+Shards::Shards (std::string dir_) : m_dir (std::move (dir_)) { }
+
+/******************************************************************************/
+
+std::string
+Shards::path (size_t shard_, const char * suffix_) const {
+    std::stringstream ss;
+    ss << m_dir << "/shard-" << std::setw (5) << std::setfill ('0') << shard_ << suffix_;
+    return ss.str();
+}
+
+/******************************************************************************/
+
+void
+Shards::publish (const std::string & path_, const std::string & contents_) const {
+    auto aside = path_ + ".tmp";
+
+    {
+        std::ofstream out (aside, std::ios::binary | std::ios::trunc);
+        out << contents_;
+        out.flush();
+
+        if (!out) throw std::runtime_error ("Failed to write " + aside);
+    }
+
+    if (std::rename (aside.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error ("Failed to rename " + aside + ": " + std::strerror (errno));
+    }
+}
+
+/******************************************************************************/
+
+size_t
+Shards::shard (const std::string & file_, size_t shards_) {
+    return jump (amqp::internal::cursor::hash (file_).m_low, shards_);
+}
+
+/******************************************************************************/
+
+void
+Shards::plan (const std::vector<std::string> & files_, size_t shards_) const {
+    if (shards_ == 0) throw std::runtime_error ("A plan needs at least one shard");
+
+    std::vector<std::string> manifests (shards_);
+
+    for (const auto & file : files_) {
+        auto & manifest = manifests[shard (file, shards_)];
+        manifest += file;
+        manifest += '\n';
+    }
+
+    for (size_t i { 0 } ; i < shards_ ; ++i) publish (path (i, ".list"), manifests[i]);
+
+    // only once every manifest's there can the workers start
+    publish (m_dir + "/plan", std::to_string (shards_) + '\n');
+}
+
+/******************************************************************************/
+
+size_t
+Shards::size() const {
+    std::ifstream in (m_dir + "/plan");
+    size_t rtn { 0 };
+
+    if (!(in >> rtn) || rtn == 0) throw std::runtime_error ("No plan in " + m_dir);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::vector<std::string>
+Shards::manifest (size_t shard_) const {
+    std::ifstream in (path (shard_, ".list"));
+    if (!in) throw std::runtime_error ("Failed to open " + path (shard_, ".list"));
+
+    std::vector<std::string> rtn;
+    std::string file;
+
+    while (std::getline (in, file)) {
+        if (!file.empty()) rtn.push_back (file);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+bool
+Shards::done (size_t shard_) const {
+    return ::access (path (shard_, ".done").c_str(), F_OK) == 0;
+}
+
+/******************************************************************************/
+
+/**
+ * Creating the claim exclusively is atomic over NFS from v3 on, so only
+ * one worker of however many race for a shard gets it
+ */
+bool
+Shards::claim (size_t shard_) const {
+    auto claim = path (shard_, ".claim");
+
+    int fd = ::open (claim.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+
+    if (fd < 0) {
+        if (errno == EEXIST) return false;
+        throw std::runtime_error ("Failed to claim " + claim + ": " + std::strerror (errno));
+    }
+
+    // who it was, should it need to be put back
+    char host[256] { };
+    ::gethostname (host, sizeof (host) - 1);
+
+    auto who = std::string (host) + ' ' + std::to_string (::getpid()) + '\n';
+    auto written = ::write (fd, who.data(), who.size());
+    (void) written;
+
+    ::close (fd);
+
+    return true;
+}
+
+/******************************************************************************/
+
+size_t
+Shards::work (size_t shard_, const Batch::Options & options_) const {
+    using amqp::internal::stats::Stats;
+
+    auto options = options_;
+    options.m_checkpoint = std::make_shared<Checkpoint> (path (shard_, ".checkpoint"));
+
+    std::ofstream out;
+    options.m_offset = options.m_checkpoint->reopen (path (shard_, ".out"), out);
+
+    // what failed before is tried again, so reported again
+    std::ofstream errors (path (shard_, ".errors"), std::ios::binary | std::ios::trunc);
+    if (!errors) throw std::runtime_error ("Failed to open " + path (shard_, ".errors"));
+
+    // the shard's stats are saved alone, then added back to the rest
+    std::stringstream before;
+
+    if (Stats::enabled()) {
+        Stats::instance().save (before);
+        Stats::instance().clear();
+    }
+
+    auto failures = Batch (manifest (shard_), options).run (out, errors);
+
+    out.close();
+    errors.close();
+
+    if (!out || !errors) throw std::runtime_error ("Failed to write shard " + std::to_string (shard_));
+
+    if (Stats::enabled()) {
+        std::stringstream stats;
+        Stats::instance().save (stats);
+        publish (path (shard_, ".stats"), stats.str());
+
+        Stats::instance().load (before);
+    }
+
+    publish (path (shard_, ".done"), std::to_string (failures) + '\n');
+
+    return failures;
+}
+
+/******************************************************************************/
+
+size_t
+Shards::work (const Batch::Options & options_) const {
+    if (options_.m_aggregate || !options_.m_route.empty()) {
+        throw std::runtime_error ("Shards can't be routed or aggregated");
+    }
+
+    auto shards = size();
+
+    size_t failures { 0 };
+
+    for (size_t i { 0 } ; i < shards ; ++i) {
+        if (done (i) || !claim (i)) continue;
+
+        failures += work (i, options_);
+    }
+
+    return failures;
+}
+
+/******************************************************************************/
+
+size_t
+Shards::merge (std::ostream & out_, std::ostream & errors_, Batch::Format format_) const {
+    auto shards = size();
+
+    std::string missing;
+
+    for (size_t i { 0 } ; i < shards ; ++i) {
+        if (!done (i)) missing += (missing.empty() ? "" : ", ") + std::to_string (i);
+    }
+
+    if (!missing.empty()) throw std::runtime_error ("Shards not done: " + missing);
+
+    size_t failures { 0 };
+
+    for (size_t i { 0 } ; i < shards ; ++i) {
+        failures += std::stoull (slurp (path (i, ".done")));
+
+        auto output = slurp (path (i, ".out"));
+
+        if (format_ == Batch::csv_t && i > 0) {
+            auto header = output.find ('\n');
+            output.erase (0, header == std::string::npos ? output.size() : header + 1);
+        }
+
+        out_ << output;
+        errors_ << slurp (path (i, ".errors"));
+
+        if (amqp::internal::stats::Stats::enabled()) {
+            std::ifstream stats (path (i, ".stats"));
+            if (stats) amqp::internal::stats::Stats::instance().load (stats);
+        }
+    }
+
+    out_.flush();
+
+    return failures;
+}
+
+/******************************************************************************/
@@ -0,0 +1,98 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+#include "Batch.h"
+
+/******************************************************************************/
+
+/**
+ * A batch too big for one machine split into shards that any number of
+ * them can work through together, sharing nothing but a directory, an
+ * NFS mount say, that holds the shards, who's working on which, and what
+ * they wrote.
+ *
+ * The coordinator [plan]s the work once, partitioning the files between
+ * the shards by a consistent hash of their names, so growing the number
+ * of shards moves as few files as it can between them. Each shard's list
+ * of files is written to a manifest of its own, "shard-N.list", and the
+ * number of shards to "plan" once they all have been.
+ *
+ * Workers pull shards, claiming each by exclusively creating its claim,
+ * "shard-N.claim", so no two ever take the same one. A shard's blobs are
+ * decoded by an ordinary [Batch] into "shard-N.out", failures reported
+ * into "shard-N.errors", and with a [Checkpoint] of its own, so the next
+ * claim of a shard whose worker died carries on where it stopped. Its
+ * stats are saved to "shard-N.stats" when they're enabled, and once it's
+ * finished "shard-N.done" records how many of its blobs failed.
+ *
+ * A worker that dies leaves its claim in place. Removing the claim puts
+ * the shard back for another to take.
+ *
+ * Once every shard's done, [merge] concatenates their outputs in order,
+ * as if one batch had written the lot, and the stats saved for each of
+ * them are added to this process's.
+ */
+class Shards {
+    private :
+        std::string m_dir;
+
+        /**
+         * The file in the directory of [shard_] ending in [suffix_]
+         */
+        std::string path (size_t shard_, const char * suffix_) const;
+
+        /**
+         * Atomically, by writing it aside and renaming it into place
+         */
+        void publish (const std::string & path_, const std::string & contents_) const;
+
+        bool claim (size_t shard_) const;
+
+        size_t work (size_t shard_, const Batch::Options &) const;
+
+    public :
+        explicit Shards (std::string dir_);
+
+        /**
+         * Which of [shards_] shards [file_] belongs to, by jump
+         * consistent hashing its name
+         */
+        static size_t shard (const std::string & file_, size_t shards_);
+
+        /**
+         * Split [files_] between [shards_] shards
+         */
+        void plan (const std::vector<std::string> & files_, size_t shards_) const;
+
+        /**
+         * How many shards were planned, throwing should there be no plan
+         */
+        size_t size() const;
+
+        std::vector<std::string> manifest (size_t shard_) const;
+
+        bool done (size_t shard_) const;
+
+        /**
+         * Claim and decode shards until there are none left to claim,
+         * returning how many blobs failed. [options_] are those of each
+         * shard's batch and must neither route nor aggregate
+         */
+        size_t work (const Batch::Options & options_) const;
+
+        /**
+         * Write every shard's output to [out_] and its failures to
+         * [errors_], returning how many blobs failed. CSV shards each
+         * start with the header, written only once. Throws, naming
+         * them, should any shards not be done
+         */
+        size_t merge (std::ostream & out_, std::ostream & errors_, Batch::Format format_) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,181 @@
+#include "SharedClient.h"
+
+#include <cerrno>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+
+#include "Server.h"
+
+/******************************************************************************/
+
+namespace {
+
+    int
+    dial (const std::string & path_) {
+        sockaddr_un addr { };
+        addr.sun_family = AF_UNIX;
+
+        if (path_.size() >= sizeof (addr.sun_path)) {
+            throw std::runtime_error ("Socket path too long: " + path_);
+        }
+
+        std::memcpy (addr.sun_path, path_.c_str(), path_.size() + 1);
+
+        int fd = ::socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (fd < 0 || ::connect (fd, reinterpret_cast<sockaddr *> (&addr), sizeof (addr)) != 0) {
+            auto err = std::string (std::strerror (errno));
+            if (fd >= 0) ::close (fd);
+
+            throw std::runtime_error ("Failed to connect to " + path_ + ": " + err);
+        }
+
+        return fd;
+    }
+
+    /**
+     * The frame asking for a shared ring with the ring's descriptor
+     * passed alongside it
+     */
+    bool
+    offer (int socket_, int ring_) {
+        std::string frame (4, '\0');
+        frame[3] = static_cast<char> (sizeof (Server::SHARED) - 1);
+        frame.append (Server::SHARED, sizeof (Server::SHARED) - 1);
+
+        iovec io { frame.data(), frame.size() };
+
+        alignas (cmsghdr) char control[CMSG_SPACE (sizeof (int))] { };
+
+        msghdr msg { };
+        msg.msg_iov = &io;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof (control);
+
+        auto * cmsg = CMSG_FIRSTHDR (&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+        std::memcpy (CMSG_DATA (cmsg), &ring_, sizeof (int));
+
+        ssize_t sent;
+        while ((sent = ::sendmsg (socket_, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR) { }
+
+        return sent == static_cast<ssize_t> (frame.size());
+    }
+
+}
+
+/******************************************************************************/
+
+SharedClient::SharedClient (const std::string & path_, size_t slots_, size_t data_)
+    : m_ring (slots_, data_)
+    , m_socket (dial (path_))
+{
+    std::vector<char> reply;
+
+    if (!offer (m_socket, m_ring.fd()) || !Server::read (m_socket, reply)) {
+        ::close (m_socket);
+        throw std::runtime_error ("Failed to share a ring with " + path_);
+    }
+
+    // the server answers with nothing once it's mapped the ring
+    if (!reply.empty()) {
+        ::close (m_socket);
+        throw std::runtime_error (std::string (reply.begin(), reply.end()));
+    }
+}
+
+/******************************************************************************/
+
+SharedClient::~SharedClient() {
+    ::close (m_socket);
+}
+
+/******************************************************************************/
+
+bool
+SharedClient::wake() {
+    const char wake { 0 };
+
+    ssize_t sent;
+    while ((sent = ::send (m_socket, &wake, 1, MSG_NOSIGNAL)) < 0 && errno == EINTR) { }
+
+    return sent == 1;
+}
+
+/******************************************************************************/
+
+/**
+ * Block until the server rings, false if it's gone
+ */
+bool
+SharedClient::sleep() {
+    char rung[64];
+
+    ssize_t got;
+    while ((got = ::read (m_socket, rung, sizeof (rung))) < 0 && errno == EINTR) { }
+
+    return got > 0;
+}
+
+/******************************************************************************/
+
+uint64_t
+SharedClient::submit (uint64_t blob_, uint64_t size_, uint64_t result_, uint64_t capacity_) {
+    SharedRing::Slot slot { };
+    slot.m_blob = blob_;
+    slot.m_size = size_;
+    slot.m_result = result_;
+    slot.m_capacity = capacity_;
+
+    auto n = m_ring.pushed();
+
+    // every slot outstanding, so wait for the oldest
+    if (n >= m_ring.slots()) wait (n - m_ring.slots());
+
+    m_ring.push (slot);
+
+    if (m_ring.serverWaiting() && !wake()) {
+        throw std::runtime_error ("The server has gone");
+    }
+
+    return n;
+}
+
+/******************************************************************************/
+
+const SharedRing::Slot &
+SharedClient::wait (uint64_t n_) {
+    while (m_ring.answered() <= n_) {
+        m_ring.clientWaiting (true);
+
+        if (m_ring.answered() <= n_ && !sleep()) {
+            m_ring.clientWaiting (false);
+            throw std::runtime_error ("The server has gone");
+        }
+
+        m_ring.clientWaiting (false);
+    }
+
+    return m_ring.slot (n_);
+}
+
+/******************************************************************************/
+
+std::string_view
+SharedClient::line (const SharedRing::Slot & slot_) const {
+    if (slot_.m_status != SharedRing::DONE && slot_.m_status != SharedRing::FAILED) {
+        return { };
+    }
+
+    return { m_ring.data() + slot_.m_result, slot_.m_written };
+}
+
+/******************************************************************************/
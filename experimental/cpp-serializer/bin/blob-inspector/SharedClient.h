@@ -0,0 +1,69 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+#include "SharedRing.h"
+
+/******************************************************************************/
+
+/**
+ * A client of a [Server] on the same host decoding blobs through a
+ * [SharedRing] rather than sending them over the socket.
+ *
+ * Connecting creates the ring and passes it to the server over its socket,
+ * which is then kept only to wake one side or the other and to learn when
+ * either has gone. Blobs are copied, or better read or mapped, into the
+ * ring's data segment by the caller, wherever it chooses, and [submit]ted
+ * along with where in the segment the line decoded from each is to be
+ * written. Answers come back in the order their requests went.
+ *
+ * A client, and its ring, are for one thread at a time.
+ */
+class SharedClient {
+    private :
+        SharedRing m_ring;
+        int m_socket;
+
+        bool wake();
+        bool sleep();
+
+    public :
+        /**
+         * Connect to the server listening at [path_] with a ring of
+         * [slots_] slots and a data segment of [data_] bytes
+         */
+        SharedClient (const std::string & path_, size_t slots_, size_t data_);
+
+        SharedClient (const SharedClient &) = delete;
+
+        ~SharedClient();
+
+        char * data() { return m_ring.data(); }
+        size_t size() const { return m_ring.size(); }
+
+        /**
+         * Ask for the blob of [size_] bytes at [blob_] in the data segment
+         * to be decoded into the [capacity_] bytes at [result_], returning
+         * the request's number. Each slot's answer only lasts until the
+         * request a ring's worth later is submitted, which waits for the
+         * server should every slot be outstanding
+         */
+        uint64_t submit (uint64_t blob_, uint64_t size_, uint64_t result_, uint64_t capacity_);
+
+        /**
+         * Wait for request [n_] to be answered
+         */
+        const SharedRing::Slot & wait (uint64_t n_);
+
+        /**
+         * The line written for an answered request, empty should it not
+         * have been written
+         */
+        std::string_view line (const SharedRing::Slot &) const;
+};
+
+/******************************************************************************/
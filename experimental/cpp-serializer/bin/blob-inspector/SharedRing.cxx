@@ -0,0 +1,292 @@
+#include "SharedRing.h"
+
+#include <atomic>
+#include <cerrno>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/******************************************************************************/
+
+/**
+ * Each count on a cache line of its own so the side writing one doesn't
+ * keep taking the line the other's is on away from it
+ */
+struct SharedRing::Header {
+    /**
+     * What the client says the ring is, read by the server before it's
+     * mapped
+     */
+    struct Layout {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint64_t m_slots;
+        uint64_t m_data;
+    } m_layout;
+
+    alignas (64) std::atomic<uint64_t> m_pushed;
+    alignas (64) std::atomic<uint64_t> m_answered;
+    alignas (64) std::atomic<uint32_t> m_serverWaiting;
+    alignas (64) std::atomic<uint32_t> m_clientWaiting;
+};
+
+/******************************************************************************/
+
+namespace {
+
+    // shared between processes, so they mustn't be a lock in either one
+    static_assert (std::atomic<uint64_t>::is_always_lock_free);
+    static_assert (std::atomic<uint32_t>::is_always_lock_free);
+
+    /**
+     * No ring needs more than this, and checking a client's header
+     * against it keeps the sums below from overflowing
+     */
+    constexpr uint64_t MAX_SLOTS = 1U << 20;
+
+    constexpr size_t
+    line (size_t size_) {
+        return (size_ + 63) / 64 * 64;
+    }
+
+}
+
+/******************************************************************************/
+
+size_t
+SharedRing::dataAt (uint64_t slots_) {
+    return line (sizeof (Header)) + line (slots_ * sizeof (Slot));
+}
+
+/******************************************************************************/
+
+SharedRing::SharedRing (size_t slots_, size_t data_)
+    : m_header (nullptr)
+    , m_slots (nullptr)
+    , m_data (nullptr)
+    , m_count (0)
+    , m_size (0)
+    , m_mapped (0)
+    , m_fd (-1)
+{
+    uint64_t slots { 1 };
+    while (slots < slots_ && slots < MAX_SLOTS) slots *= 2;
+
+    m_fd = ::memfd_create ("blob-inspector-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (m_fd < 0) {
+        throw std::runtime_error (
+                std::string ("Failed to create shared memory: ") + std::strerror (errno));
+    }
+
+    auto size = dataAt (slots) + data_;
+
+    // sealed at its size, so the server can map it knowing it won't be
+    // cut short beneath it
+    if (::ftruncate (m_fd, static_cast<off_t> (size)) != 0
+        || ::fcntl (m_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0)
+    {
+        auto err = std::string (std::strerror (errno));
+        ::close (m_fd);
+
+        throw std::runtime_error ("Failed to size shared memory: " + err);
+    }
+
+    map (size);
+
+    // a fresh memfd is zeroed so only what isn't zero needs setting
+    m_header->m_layout = { MAGIC, VERSION, slots, data_ };
+
+    place (slots, data_);
+}
+
+/******************************************************************************/
+
+SharedRing::SharedRing (int fd_)
+    : m_header (nullptr)
+    , m_slots (nullptr)
+    , m_data (nullptr)
+    , m_count (0)
+    , m_size (0)
+    , m_mapped (0)
+    , m_fd (fd_)
+{
+    /*
+     * Were the client able to shrink it the server would be killed by a
+     * SIGBUS reading what had been mapped, so it has to have been sealed
+     */
+    auto seals = ::fcntl (m_fd, F_GET_SEALS);
+
+    if (seals < 0 || (seals & F_SEAL_SHRINK) == 0) {
+        ::close (m_fd);
+        throw std::runtime_error ("Not a shared ring, it isn't sealed against shrinking");
+    }
+
+    struct stat results { };
+    Header::Layout layout { };
+
+    if (::fstat (m_fd, &results) != 0
+        || ::pread (m_fd, &layout, sizeof (layout), 0) != static_cast<ssize_t> (sizeof (layout)))
+    {
+        ::close (m_fd);
+        throw std::runtime_error ("Not a shared ring");
+    }
+
+    auto size = static_cast<size_t> (results.st_size);
+    auto slots = layout.m_slots;
+    auto data = layout.m_data;
+
+    // the ring must be all there is, not a header over something larger
+    if (layout.m_magic != MAGIC
+        || layout.m_version != VERSION
+        || slots == 0 || slots > MAX_SLOTS || (slots & (slots - 1)) != 0
+        || dataAt (slots) > size
+        || data != size - dataAt (slots))
+    {
+        ::close (m_fd);
+        throw std::runtime_error ("Not a shared ring");
+    }
+
+    map (size);
+    place (slots, data);
+}
+
+/******************************************************************************/
+
+SharedRing::~SharedRing() {
+    ::munmap (m_header, m_mapped);
+    ::close (m_fd);
+}
+
+/******************************************************************************/
+
+void
+SharedRing::map (size_t size_) {
+    auto * mapped = ::mmap (nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+
+    if (mapped == MAP_FAILED) {
+        auto err = std::string (std::strerror (errno));
+        ::close (m_fd);
+
+        throw std::runtime_error ("Failed to map shared memory: " + err);
+    }
+
+    m_mapped = size_;
+    m_header = static_cast<Header *> (mapped);
+}
+
+/******************************************************************************/
+
+void
+SharedRing::place (uint64_t slots_, uint64_t size_) {
+    auto * base = reinterpret_cast<char *> (m_header);
+
+    m_count = slots_;
+    m_size = size_;
+    m_slots = reinterpret_cast<Slot *> (base + line (sizeof (Header)));
+    m_data = base + dataAt (slots_);
+}
+
+/******************************************************************************/
+
+bool
+SharedRing::push (const Slot & slot_) {
+    auto pushed = m_header->m_pushed.load (std::memory_order_relaxed);
+
+    if (pushed - m_header->m_answered.load (std::memory_order_acquire) >= m_count) {
+        return false;
+    }
+
+    auto & slot = m_slots[pushed & (m_count - 1)];
+
+    slot = slot_;
+    slot.m_written = 0;
+    slot.m_status = PENDING;
+
+    // sequentially consistent, as is reading the server's waiting, so one
+    // side or the other always sees there's something to do
+    m_header->m_pushed.store (pushed + 1);
+
+    return true;
+}
+
+/******************************************************************************/
+
+uint64_t
+SharedRing::pushed() const {
+    return m_header->m_pushed.load();
+}
+
+/******************************************************************************/
+
+uint64_t
+SharedRing::answered() const {
+    return m_header->m_answered.load();
+}
+
+/******************************************************************************/
+
+const SharedRing::Slot &
+SharedRing::slot (uint64_t n_) const {
+    return m_slots[n_ & (m_count - 1)];
+}
+
+/******************************************************************************/
+
+SharedRing::Slot *
+SharedRing::next() {
+    auto answered = m_header->m_answered.load (std::memory_order_relaxed);
+
+    if (answered == m_header->m_pushed.load()) return nullptr;
+
+    return &m_slots[answered & (m_count - 1)];
+}
+
+/******************************************************************************/
+
+void
+SharedRing::answer() {
+    m_header->m_answered.store (m_header->m_answered.load (std::memory_order_relaxed) + 1);
+}
+
+/******************************************************************************/
+
+bool
+SharedRing::contains (uint64_t offset_, uint64_t size_) const {
+    return offset_ <= m_size && size_ <= m_size - offset_;
+}
+
+/******************************************************************************/
+
+void
+SharedRing::serverWaiting (bool waiting_) {
+    m_header->m_serverWaiting.store (waiting_ ? 1 : 0);
+}
+
+/******************************************************************************/
+
+bool
+SharedRing::serverWaiting() const {
+    return m_header->m_serverWaiting.load() != 0;
+}
+
+/******************************************************************************/
+
+void
+SharedRing::clientWaiting (bool waiting_) {
+    m_header->m_clientWaiting.store (waiting_ ? 1 : 0);
+}
+
+/******************************************************************************/
+
+bool
+SharedRing::clientWaiting() const {
+    return m_header->m_clientWaiting.load() != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,173 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+/******************************************************************************/
+
+/**
+ * Memory shared by a [Server] and one client on the same host, through
+ * which blobs are decoded without either being copied through a socket.
+ *
+ * The client creates it, sealed at its size, and hands it to the server
+ * over the server's socket, see [SharedClient]. It holds a ring of
+ * [Slot]s, each describing a request, followed by a data segment the
+ * client lays out as it likes. A request names a blob by where it lies
+ * in the data segment and gives a region of it for the line the server
+ * renders, which is written there.
+ *
+ * There is a single producer, the client, filling in slots and a single
+ * consumer, the server, answering them in order, so neither needs a lock,
+ * only a count each of how many requests have been pushed and answered.
+ * Clients wanting more in flight than one ring allows open more rings, each
+ * being its own connection served by its own worker.
+ *
+ * When either side finds nothing to do it says it's waiting before looking
+ * once more, blocking on the socket if there's still nothing, and the other
+ * side only writes a byte to the socket to wake it when it's said so. A
+ * busy ring therefore passes no bytes through the kernel at all.
+ *
+ * Nothing in the data segment may be changed whilst a request naming it is
+ * outstanding.
+ */
+class SharedRing {
+    public :
+        enum Status : uint32_t {
+            PENDING = 0,
+            DONE,
+            /**
+             * The line describes why the blob couldn't be decoded
+             */
+            FAILED,
+            /**
+             * The line didn't fit, nothing was written and [Slot::m_written]
+             * holds how many bytes it needed
+             */
+            TRUNCATED,
+            /**
+             * The blob or the result region weren't in the data segment
+             */
+            INVALID
+        };
+
+        /**
+         * Offsets are from the start of the data segment
+         */
+        struct Slot {
+            uint64_t m_blob;
+            uint64_t m_size;
+            uint64_t m_result;
+            uint64_t m_capacity;
+
+            /**
+             * Set by the server
+             */
+            uint64_t m_written;
+            uint32_t m_status;
+            uint32_t m_unused;
+        };
+
+        static constexpr uint32_t MAGIC = 0x43524e47; // CRNG
+        static constexpr uint32_t VERSION = 1;
+
+    private :
+        struct Header;
+
+        Header * m_header;
+        Slot * m_slots;
+        char * m_data;
+
+        /**
+         * Kept apart from the header once checked, as the other side
+         * could change what's there
+         */
+        uint64_t m_count;
+        uint64_t m_size;
+
+        size_t m_mapped;
+        int m_fd;
+
+        /**
+         * Where the data segment starts
+         */
+        static size_t dataAt (uint64_t slots_);
+
+        void map (size_t);
+        void place (uint64_t slots_, uint64_t size_);
+
+    public :
+        /**
+         * Create a ring of [slots_] slots, rounded up to a power of two,
+         * and a data segment of [data_] bytes
+         */
+        SharedRing (size_t slots_, size_t data_);
+
+        /**
+         * Map a ring created by a client, taking ownership of [fd_]. It
+         * must be sealed against shrinking and be exactly the size its
+         * header gives, both being checked before it's mapped
+         */
+        explicit SharedRing (int fd_);
+
+        SharedRing (const SharedRing &) = delete;
+        SharedRing & operator = (const SharedRing &) = delete;
+
+        ~SharedRing();
+
+        int fd() const { return m_fd; }
+
+        char * data() { return m_data; }
+        const char * data() const { return m_data; }
+
+        size_t size() const { return m_size; }
+        size_t slots() const { return m_count; }
+
+        /**
+         * Leave [slot_] in the next free slot returning false if every
+         * slot is outstanding. The client must have read whatever answer
+         * it wants from the slot being reused first
+         */
+        bool push (const Slot & slot_);
+
+        /**
+         * How many requests have been pushed, and answered
+         */
+        uint64_t pushed() const;
+        uint64_t answered() const;
+
+        /**
+         * The [n_]th request pushed, its answer being complete once
+         * [answered] has passed it
+         */
+        const Slot & slot (uint64_t n_) const;
+
+        /**
+         * The next request to answer, null if the client hasn't pushed
+         * one
+         */
+        Slot * next();
+
+        /**
+         * Publish the answer to the request [next] returned
+         */
+        void answer();
+
+        /**
+         * Whether the region [offset_, offset_ + size_) lies in the data
+         * segment
+         */
+        bool contains (uint64_t offset_, uint64_t size_) const;
+
+        /**
+         * Each side says it's about to block, or has stopped, and asks
+         * whether the other has
+         */
+        void serverWaiting (bool waiting_);
+        bool serverWaiting() const;
+        void clientWaiting (bool waiting_);
+        bool clientWaiting() const;
+};
+
+/******************************************************************************/
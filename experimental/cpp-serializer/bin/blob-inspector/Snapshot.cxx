@@ -0,0 +1,251 @@
+#include "Snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "BlobInspector.h"
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using Tape = amqp::internal::tape::Tape;
+
+    constexpr char MAGIC[] = "CATP";
+
+    constexpr std::string_view SUFFIX { ".tape" };
+
+    /**
+     * What a snapshot starts with, the tape's words following straight
+     * after, then its hashes and then the bytes of each of the rest in
+     * turn
+     */
+    struct Header {
+        char m_magic[4];
+        uint32_t m_version;
+
+        /**
+         * Written as 1 so a snapshot from a machine of the other byte
+         * order is told apart
+         */
+        uint32_t m_order;
+        uint32_t m_unused;
+
+        uint64_t m_words;
+        uint64_t m_hashes;
+        uint64_t m_blob;
+        uint64_t m_copied;
+        uint32_t m_descriptor;
+        uint32_t m_type;
+    };
+
+    static_assert (sizeof (Header) % alignof (uint64_t) == 0);
+    static_assert (sizeof (Tape::Indexed) == 3 * sizeof (uint64_t));
+
+    [[noreturn]] void
+    corrupt() {
+        throw std::runtime_error ("Corrupt snapshot");
+    }
+
+    /**
+     * Take [count_] items of [size_] bytes from what's [left_] of the
+     * file, throwing should there not be that many
+     */
+    size_t
+    take (size_t & left_, uint64_t count_, size_t size_) {
+        if (count_ > left_ / size_) corrupt();
+
+        auto rtn = static_cast<size_t> (count_) * size_;
+        left_ -= rtn;
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+Snapshot::Snapshot()
+    : m_map (nullptr)
+    , m_mapSize (0)
+{
+}
+
+/******************************************************************************/
+
+Snapshot::Snapshot (BlobInspector & inspector_, bool hashes_)
+    : m_tape (std::make_unique<Tape> (inspector_.tape (hashes_)))
+    , m_descriptor (inspector_.descriptor())
+    , m_type (inspector_.type())
+    , m_map (nullptr)
+    , m_mapSize (0)
+{
+}
+
+/******************************************************************************/
+
+Snapshot::~Snapshot() {
+    // the tape refers into the mapping so goes first
+    m_tape.reset();
+
+    if (m_map) ::munmap (m_map, m_mapSize);
+}
+
+/******************************************************************************/
+
+bool
+Snapshot::named (const std::string & path_) {
+    return path_.size() > SUFFIX.size()
+        && path_.compare (path_.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) == 0;
+}
+
+/******************************************************************************/
+
+void
+Snapshot::save (const std::string & path_) const {
+    const auto hashes = m_tape->hashes();
+    const auto blob = m_tape->blob();
+    const auto copied = m_tape->copied();
+
+    Header header {
+        { }, VERSION, 1, 0,
+        m_tape->size(), hashes.size(), blob.size(), copied.size(),
+        static_cast<uint32_t> (m_descriptor.size()), static_cast<uint32_t> (m_type.size())
+    };
+
+    std::memcpy (header.m_magic, MAGIC, sizeof (header.m_magic));
+
+    std::ofstream file (path_, std::ios::binary | std::ios::trunc);
+
+    file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+    file.write (reinterpret_cast<const char *> (m_tape->data()),
+            static_cast<std::streamsize> (m_tape->size() * sizeof (uint64_t)));
+    file.write (reinterpret_cast<const char *> (hashes.data()),
+            static_cast<std::streamsize> (hashes.size() * sizeof (Tape::Indexed)));
+    file.write (blob.data(), static_cast<std::streamsize> (blob.size()));
+    file.write (copied.data(), static_cast<std::streamsize> (copied.size()));
+    file.write (m_descriptor.data(), static_cast<std::streamsize> (m_descriptor.size()));
+    file.write (m_type.data(), static_cast<std::streamsize> (m_type.size()));
+
+    if (!file) throw std::runtime_error ("Failed to write " + path_);
+}
+
+/******************************************************************************/
+
+std::unique_ptr<Snapshot>
+Snapshot::load (const std::string & path_) {
+    int fd = ::open (path_.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error ("Failed to read " + path_);
+
+    struct stat st { };
+    if (::fstat (fd, &st) != 0 || static_cast<size_t> (st.st_size) < sizeof (Header)) {
+        ::close (fd);
+        throw std::runtime_error (path_ + " isn't a snapshot");
+    }
+
+    std::unique_ptr<Snapshot> rtn (new Snapshot());
+
+    rtn->m_mapSize = static_cast<size_t> (st.st_size);
+    auto map = ::mmap (nullptr, rtn->m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+
+    if (map == MAP_FAILED) throw std::runtime_error ("Failed to map " + path_);
+    rtn->m_map = map;
+
+    Header header;
+    std::memcpy (&header, map, sizeof (header));
+
+    if (std::memcmp (header.m_magic, MAGIC, sizeof (header.m_magic)) != 0 || header.m_order != 1) {
+        throw std::runtime_error (path_ + " isn't a snapshot");
+    }
+
+    // the first version's tapes just never pack an absent
+    if (header.m_version == 0 || header.m_version > VERSION) {
+        throw std::runtime_error (path_ + " is a snapshot of another version");
+    }
+
+    const auto * at = static_cast<const char *> (map) + sizeof (Header);
+    size_t left = rtn->m_mapSize - sizeof (Header);
+
+    const auto * words = reinterpret_cast<const uint64_t *> (at);
+    at += take (left, header.m_words, sizeof (uint64_t));
+
+    const auto * hashes = reinterpret_cast<const Tape::Indexed *> (at);
+    at += take (left, header.m_hashes, sizeof (Tape::Indexed));
+
+    const auto * blob = at;
+    at += take (left, header.m_blob, 1);
+
+    std::string_view copied { at, static_cast<size_t> (header.m_copied) };
+    at += take (left, header.m_copied, 1);
+
+    rtn->m_descriptor.assign (at, take (left, header.m_descriptor, 1));
+    at += header.m_descriptor;
+
+    rtn->m_type.assign (at, take (left, header.m_type, 1));
+
+    if (left != 0 || header.m_words == 0) corrupt();
+
+    rtn->m_tape = std::make_unique<Tape> (blob, static_cast<size_t> (header.m_blob));
+    rtn->m_tape->map (words, header.m_words, copied, hashes, header.m_hashes);
+
+    // the rest's checked as it's walked
+    try {
+        if (rtn->m_tape->begin().type() != Tape::object_t
+            || rtn->m_tape->begin().next() != rtn->m_tape->end())
+        {
+            corrupt();
+        }
+    } catch (const std::runtime_error &) {
+        corrupt();
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Snapshot::writeFields (amqp::reader::ISink & sink_) const {
+    const auto root = m_tape->begin();
+
+    for (auto it = root.begin() ; it != root.end() ; it = it.next()) {
+        m_tape->write (it, sink_);
+    }
+}
+
+/******************************************************************************/
+
+void
+Snapshot::projectFields (
+    amqp::reader::ISink & sink_,
+    const amqp::internal::tape::Tape::Paths & paths_
+) const {
+    sink_.key ("Parsed");
+    project (sink_, paths_);
+}
+
+/******************************************************************************/
+
+void
+Snapshot::project (
+    amqp::reader::ISink & sink_,
+    const amqp::internal::tape::Tape::Paths & paths_
+) const {
+    const auto root = m_tape->begin();
+    const auto parsed = root["Parsed"];
+
+    if (parsed == root.end()) throw std::runtime_error ("Nothing parsed in the snapshot");
+
+    m_tape->project (parsed, paths_, sink_);
+}
+
+/******************************************************************************/
@@ -0,0 +1,105 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "tape/Tape.h"
+
+/******************************************************************************/
+
+class BlobInspector;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************/
+
+/**
+ * A blob decoded once into a [amqp::internal::tape::Tape] and saved, with
+ * a copy of the blob its text refers into, so that projections, filters
+ * and aggregations can be run over it again and again without it ever
+ * being decoded again.
+ *
+ * The file is laid out as it sits in memory, the tape's words and its
+ * objects' hashes, then the blob, the text the tape copied and the blob's
+ * descriptor and type, so loading one maps it and points a tape at it,
+ * nothing being read until it's walked. A snapshot made by a later
+ * version, or on a machine of the other byte order, is refused, and the
+ * tape's checked as it's walked, a corrupt one throwing rather than being
+ * read beyond.
+ *
+ * What's on the tape is whatever the blob was decoded as when it was
+ * saved, with pointers, sampled or nested, those being fixed from then on.
+ */
+class Snapshot {
+    public :
+        static constexpr uint32_t VERSION = 2;
+
+    private :
+        std::unique_ptr<amqp::internal::tape::Tape> m_tape;
+
+        std::string m_descriptor;
+        std::string m_type;
+
+        void * m_map;
+        size_t m_mapSize;
+
+        Snapshot();
+
+    public :
+        /**
+         * Decode the blob [inspector_] was built for onto a tape, with
+         * its objects' hashes if [hashes_]
+         */
+        explicit Snapshot (BlobInspector & inspector_, bool hashes_ = false);
+
+        Snapshot (const Snapshot &) = delete;
+        Snapshot & operator = (const Snapshot &) = delete;
+
+        ~Snapshot();
+
+        /**
+         * Whether [path_] is named as a snapshot is, ending ".tape"
+         */
+        static bool named (const std::string & path_);
+
+        /**
+         * Map the snapshot at [path_], throwing if it isn't one
+         */
+        static std::unique_ptr<Snapshot> load (const std::string & path_);
+
+        void save (const std::string &) const;
+
+        const amqp::internal::tape::Tape & tape() const { return *m_tape; }
+
+        /**
+         * The blob's outermost type, as [BlobInspector::descriptor] and
+         * [BlobInspector::type]
+         */
+        const std::string & descriptor() const { return m_descriptor; }
+        const std::string & type() const { return m_type; }
+
+        /**
+         * As [BlobInspector::writeFields], just the "Parsed" field
+         */
+        void writeFields (amqp::reader::ISink &) const;
+
+        /**
+         * As [BlobInspector::projectFields]
+         */
+        void projectFields (amqp::reader::ISink &, const amqp::internal::tape::Tape::Paths &) const;
+
+        /**
+         * Replay the fields of the "Parsed" value named by [paths_], as a
+         * [Filter] or an [Aggregate] would have them decoded
+         */
+        void project (amqp::reader::ISink &, const amqp::internal::tape::Tape::Paths & paths_) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,329 @@
+#include "Transfers.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Frames.h"
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr size_t MAX_DEPTH = 128;
+
+    /**
+     * The transfer performative and the message sections a body is in
+     */
+    constexpr uint64_t TRANSFER = 0x14;
+    constexpr uint64_t DATA = 0x75;
+    constexpr uint64_t VALUE = 0x77;
+
+    constexpr size_t FRAME_HEADER = 8;
+
+    uint64_t
+    big (const char * bytes_, size_t width_) {
+        uint64_t rtn { 0 };
+
+        for (size_t i { 0 } ; i < width_ ; ++i) {
+            rtn = rtn << 8U | static_cast<unsigned char> (bytes_[i]);
+        }
+
+        return rtn;
+    }
+
+    [[noreturn]] void
+    corrupt() {
+        throw std::runtime_error ("Corrupt AMQP frame");
+    }
+
+    /**
+     * Step [at_] past the value starting there
+     */
+    void
+    skip (const char *& at_, const char * end_, size_t depth_ = 0) {
+        if (depth_ > MAX_DEPTH || at_ == end_) corrupt();
+
+        auto extent = Frames::extent (static_cast<unsigned char> (*at_++));
+
+        if (extent.m_described) {
+            skip (at_, end_, depth_ + 1);
+            skip (at_, end_, depth_ + 1);
+            return;
+        }
+
+        auto left = static_cast<size_t> (end_ - at_);
+
+        if (left < extent.m_width) corrupt();
+
+        auto size = extent.m_width ? big (at_, extent.m_width) : extent.m_fixed;
+        at_ += extent.m_width;
+
+        if (left - extent.m_width < size) corrupt();
+
+        at_ += size;
+    }
+
+    /**
+     * The code of the numeric descriptor starting at [at_], stepping past
+     * it, and ~0 for one that isn't, a symbol say
+     */
+    uint64_t
+    descriptor (const char *& at_, const char * end_) {
+        if (end_ - at_ < 2 || *at_ != 0x00) corrupt();
+
+        ++at_;
+
+        switch (static_cast<unsigned char> (*at_)) {
+            case 0x44 : ++at_; return 0;
+            case 0x53 : at_ += 2; if (at_ > end_) corrupt(); return static_cast<unsigned char> (at_[-1]);
+            case 0x80 : {
+                if (end_ - at_ < 9) corrupt();
+                auto rtn = big (at_ + 1, 8);
+                at_ += 9;
+                return rtn;
+            }
+            default :
+                skip (at_, end_);
+                return ~uint64_t { 0 };
+        }
+    }
+
+    uint64_t
+    unsigned_ (const char *& at_, const char * end_) {
+        auto code = static_cast<unsigned char> (*at_);
+
+        switch (code) {
+            case 0x43 : case 0x44 : ++at_; return 0;
+            case 0x52 : case 0x53 :
+                if (end_ - at_ < 2) corrupt();
+                at_ += 2;
+                return static_cast<unsigned char> (at_[-1]);
+            case 0x70 :
+                if (end_ - at_ < 5) corrupt();
+                at_ += 5;
+                return big (at_ - 4, 4);
+            default :
+                skip (at_, end_);
+                return 0;
+        }
+    }
+
+    bool
+    boolean (const char *& at_, const char * end_) {
+        switch (static_cast<unsigned char> (*at_)) {
+            case 0x41 : ++at_; return true;
+            case 0x42 : ++at_; return false;
+            case 0x56 :
+                if (end_ - at_ < 2) corrupt();
+                at_ += 2;
+                return at_[-1] != 0;
+            default :
+                skip (at_, end_);
+                return false;
+        }
+    }
+
+    /**
+     * The binary value starting at [at_], false should it be anything else
+     */
+    bool
+    binary (const char *& at_, const char * end_, std::string_view & bytes_) {
+        auto code = static_cast<unsigned char> (*at_);
+
+        if (code != 0xa0 && code != 0xb0) {
+            skip (at_, end_);
+            return false;
+        }
+
+        size_t width = code == 0xa0 ? 1 : 4;
+
+        if (static_cast<size_t> (end_ - at_) < 1 + width) corrupt();
+
+        auto size = big (at_ + 1, width);
+        at_ += 1 + width;
+
+        if (static_cast<size_t> (end_ - at_) < size) corrupt();
+
+        bytes_ = { at_, size };
+        at_ += size;
+
+        return true;
+    }
+
+}
+
+/******************************************************************************/
+
+Transfers::Transfers (Message message_)
+    : m_message (std::move (message_))
+    , m_frames (0)
+    , m_messages (0)
+{
+}
+
+/******************************************************************************/
+
+void
+Transfers::feed (const char * bytes_, size_t size_) {
+    if (m_pending.empty()) {
+        auto used = consume (bytes_, size_);
+        m_pending.assign (bytes_ + used, size_ - used);
+    } else {
+        m_pending.append (bytes_, size_);
+
+        auto used = consume (m_pending.data(), m_pending.size());
+        m_pending.erase (0, used);
+    }
+}
+
+/******************************************************************************/
+
+size_t
+Transfers::consume (const char * bytes_, size_t size_) {
+    size_t at { 0 };
+
+    while (size_ - at >= FRAME_HEADER) {
+        const char * p = bytes_ + at;
+
+        // a protocol header, for AMQP itself, SASL or TLS
+        if (std::memcmp (p, "AMQP", 4) == 0) {
+            if (p[4] == 2) throw std::runtime_error ("AMQP connection is encrypted by TLS");
+
+            at += FRAME_HEADER;
+            continue;
+        }
+
+        auto size = big (p, 4);
+
+        // told apart from whatever else it might be before waiting on it
+        if (size < FRAME_HEADER || p[4] < 2 || (p[5] != 0 && p[5] != 1)) corrupt();
+        if (size > size_ - at) break;
+
+        frame (p, size);
+        at += size;
+    }
+
+    return at;
+}
+
+/******************************************************************************/
+
+void
+Transfers::frame (const char * bytes_, size_t size_) {
+    size_t doff = static_cast<unsigned char> (bytes_[4]) * 4U;
+
+    if (doff < FRAME_HEADER || doff > size_) corrupt();
+
+    ++m_frames;
+
+    // SASL, and empty frames kept the connection alive
+    if (bytes_[5] != 0 || doff == size_) return;
+
+    const char * at = bytes_ + doff;
+    const char * end = bytes_ + size_;
+
+    auto channel = static_cast<uint16_t> (big (bytes_ + 6, 2));
+
+    if (descriptor (at, end) != TRANSFER) return;
+
+    if (at == end) corrupt();
+
+    auto code = static_cast<unsigned char> (*at);
+
+    uint32_t handle { 0 };
+    bool more { false };
+    bool aborted { false };
+
+    if (code == 0xc0 || code == 0xd0) {
+        size_t width = code == 0xc0 ? 1 : 4;
+
+        if (static_cast<size_t> (end - at) < 1 + 2 * width) corrupt();
+
+        auto size = big (at + 1, width);
+        auto count = big (at + 1 + width, width);
+
+        if (static_cast<size_t> (end - at) - 1 - width < size) corrupt();
+
+        const char * fields = at + 1 + 2 * width;
+        const char * fieldsEnd = at + 1 + width + size;
+
+        for (uint64_t i { 0 } ; i < count ; ++i) {
+            if (fields >= fieldsEnd) corrupt();
+
+            switch (i) {
+                case 0  : handle = static_cast<uint32_t> (unsigned_ (fields, fieldsEnd)); break;
+                case 5  : more = boolean (fields, fieldsEnd); break;
+                case 9  : aborted = boolean (fields, fieldsEnd); break;
+                default : skip (fields, fieldsEnd); break;
+            }
+        }
+
+        at = fieldsEnd;
+    } else {
+        skip (at, end);
+    }
+
+    const auto key = std::make_pair (channel, handle);
+    auto it = m_deliveries.find (key);
+
+    if (aborted) {
+        if (it != m_deliveries.end()) m_deliveries.erase (it);
+        return;
+    }
+
+    if (more) {
+        m_deliveries[key].append (at, static_cast<size_t> (end - at));
+        return;
+    }
+
+    if (it == m_deliveries.end()) {
+        message (at, static_cast<size_t> (end - at));
+        return;
+    }
+
+    // taken out first, whatever the message callback does
+    auto whole = std::move (it->second);
+    m_deliveries.erase (it);
+
+    whole.append (at, static_cast<size_t> (end - at));
+    message (whole.data(), whole.size());
+}
+
+/******************************************************************************/
+
+void
+Transfers::message (const char * bytes_, size_t size_) {
+    const char * at = bytes_;
+    const char * end = bytes_ + size_;
+
+    std::string_view body;
+    size_t sections { 0 };
+
+    while (at < end) {
+        auto code = descriptor (at, end);
+
+        if (at == end) corrupt();
+
+        std::string_view bytes;
+
+        if ((code == DATA || code == VALUE) && binary (at, end, bytes)) {
+            // a body of more than one section is pieced together
+            if (sections++ == 0) {
+                body = bytes;
+            } else {
+                if (sections == 2) m_body.assign (body.data(), body.size());
+                m_body.append (bytes.data(), bytes.size());
+                body = m_body;
+            }
+        } else if (code != DATA && code != VALUE) {
+            skip (at, end);
+        }
+    }
+
+    if (sections == 0) return;
+
+    ++m_messages;
+    m_message (body);
+}
+
+/******************************************************************************/
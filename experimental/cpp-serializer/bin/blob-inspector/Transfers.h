@@ -0,0 +1,86 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <string_view>
+
+/******************************************************************************/
+
+/**
+ * Finds the messages in one direction of an AMQP 1.0 connection, the
+ * bytes a broker such as Artemis is sent or sends, and hands over each
+ * one's body, a Corda blob for Corda's P2P and RPC traffic, as soon as
+ * its last transfer frame has arrived.
+ *
+ * The bytes are fed in as they come, in pieces of any size, so they can
+ * be read off a socket or reassembled from a capture, see [Capture]. A
+ * frame split between pieces is held until the rest of it arrives, and
+ * otherwise nothing's copied: a body sent in a single transfer is handed
+ * over where it lies in what was fed.
+ *
+ * Only transfers are looked at, every other performative and the whole
+ * of SASL being passed over, along with the protocol headers that start
+ * the connection and its SASL layer. A TLS connection can't be read, so
+ * one starting TLS throws.
+ *
+ * A delivery sent over several transfers, each saying there's more, is
+ * put back together by its channel and link handle, and an aborted one
+ * is dropped. A message's body is its data sections, concatenated, or an
+ * AMQP value section holding binary. One with neither is passed over.
+ */
+class Transfers {
+    public :
+        using Message = std::function<void (std::string_view body_)>;
+
+    private :
+        Message m_message;
+
+        /**
+         * The start of a frame that's yet to arrive in full
+         */
+        std::string m_pending;
+
+        /**
+         * Deliveries with more transfers to come, by channel and handle
+         */
+        std::map<std::pair<uint16_t, uint32_t>, std::string> m_deliveries;
+
+        std::string m_body;
+
+        size_t m_frames;
+        size_t m_messages;
+
+        /**
+         * The frames and headers at the start of [size_] bytes, returning
+         * how many bytes they took
+         */
+        size_t consume (const char *, size_t size_);
+
+        void frame (const char *, size_t);
+        void message (const char *, size_t);
+
+    public :
+        explicit Transfers (Message);
+
+        Transfers (const Transfers &) = delete;
+
+        /**
+         * The next bytes of the connection. Ones that aren't AMQP throw
+         */
+        void feed (const char *, size_t);
+
+        size_t frames() const { return m_frames; }
+        size_t messages() const { return m_messages; }
+
+        /**
+         * Bytes held waiting for the rest of their frame
+         */
+        size_t pending() const { return m_pending.size(); }
+};
+
+/******************************************************************************/
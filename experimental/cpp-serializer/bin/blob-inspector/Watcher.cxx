@@ -0,0 +1,188 @@
+#include "Watcher.h"
+
+#include <cerrno>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <poll.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Writers staging a blob under a hidden name before renaming it into
+     * place are left alone until they have
+     */
+    bool
+    wanted (const std::string & name_) {
+        return !name_.empty() && name_[0] != '.';
+    }
+
+}
+
+/******************************************************************************/
+
+Watcher::Watcher (std::string dir_, const std::string & checkpoint_, Batch::Options options_)
+    : m_dir (std::move (dir_))
+    , m_options (std::move (options_))
+    , m_inotify (-1)
+    , m_wake { -1, -1 }
+    , m_failures (0)
+{
+    if (!checkpoint_.empty()) {
+        std::ifstream in (checkpoint_);
+        std::string name;
+
+        while (std::getline (in, name)) {
+            if (!name.empty()) m_done.insert (name);
+        }
+
+        m_checkpoint.open (checkpoint_, std::ios::out | std::ios::app);
+
+        if (!m_checkpoint) {
+            throw std::runtime_error ("Failed to open " + checkpoint_);
+        }
+    }
+
+    if (::pipe (m_wake) != 0) {
+        throw std::runtime_error ("Failed to create a pipe");
+    }
+
+    m_inotify = ::inotify_init1 (IN_CLOEXEC | IN_NONBLOCK);
+
+    if (m_inotify < 0
+        || ::inotify_add_watch (m_inotify, m_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) < 0)
+    {
+        auto err = std::string (std::strerror (errno));
+
+        if (m_inotify >= 0) ::close (m_inotify);
+        ::close (m_wake[0]);
+        ::close (m_wake[1]);
+
+        throw std::runtime_error ("Failed to watch " + m_dir + ": " + err);
+    }
+}
+
+/******************************************************************************/
+
+Watcher::~Watcher() {
+    ::close (m_inotify);
+    ::close (m_wake[0]);
+    ::close (m_wake[1]);
+}
+
+/******************************************************************************/
+
+void
+Watcher::decode (const std::string & name_, std::ostream & out_) {
+    if (!wanted (name_) || m_done.count (name_)) return;
+
+    std::string line;
+
+    bool ok = Batch::render (m_dir + "/" + name_, line, m_options.m_paths, m_options.m_pointers);
+
+    out_ << line << std::endl;
+
+    if (!ok) {
+        ++m_failures;
+        return;
+    }
+
+    m_done.insert (name_);
+
+    if (m_checkpoint.is_open()) {
+        m_checkpoint << name_ << std::endl;
+    }
+}
+
+/******************************************************************************/
+
+void
+Watcher::catchUp (std::ostream & out_) {
+    std::vector<std::string> names;
+
+    if (auto * dir = ::opendir (m_dir.c_str())) {
+        while (auto * entry = ::readdir (dir)) {
+            if (entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN) {
+                names.emplace_back (entry->d_name);
+            }
+        }
+
+        ::closedir (dir);
+    } else {
+        throw std::runtime_error ("Failed to list " + m_dir + ": " + std::strerror (errno));
+    }
+
+    std::sort (names.begin(), names.end());
+
+    for (const auto & name : names) decode (name, out_);
+}
+
+/******************************************************************************/
+
+bool
+Watcher::poll (std::ostream & out_, int timeout_) {
+    pollfd fds[2] {
+        { m_inotify, POLLIN, 0 },
+        { m_wake[0], POLLIN, 0 }
+    };
+
+    if (::poll (fds, 2, timeout_) < 0) {
+        return errno == EINTR;
+    }
+
+    if (fds[1].revents) return false;
+
+    alignas (inotify_event) char events[64 * 1024];
+
+    ssize_t got;
+
+    while ((got = ::read (m_inotify, events, sizeof (events))) > 0) {
+        for (char * at = events ; at < events + got ; ) {
+            const auto * event = reinterpret_cast<const inotify_event *> (at);
+            at += sizeof (inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events were dropped, so whatever they were for is listed
+                catchUp (out_);
+            } else if (event->mask & IN_IGNORED) {
+                // the directory itself has gone
+                return false;
+            } else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                decode (event->name, out_);
+            }
+        }
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+size_t
+Watcher::run (std::ostream & out_) {
+    catchUp (out_);
+
+    while (poll (out_, -1)) { }
+
+    char drained;
+    while (::read (m_wake[0], &drained, 1) < 0 && errno == EINTR) { }
+
+    return m_failures;
+}
+
+/******************************************************************************/
+
+void
+Watcher::stop() {
+    const char wake { 0 };
+    while (::write (m_wake[1], &wake, 1) < 0 && errno == EINTR) { }
+}
+
+/******************************************************************************/
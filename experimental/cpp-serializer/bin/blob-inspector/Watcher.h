@@ -0,0 +1,95 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <set>
+#include <string>
+#include <fstream>
+#include <ostream>
+
+#include "Batch.h"
+
+/******************************************************************************/
+
+/**
+ * Decodes blobs as they're written into a directory, watched through
+ * inotify, for as long as it runs, each into the line [Batch] would have
+ * written for it. Nothing's rescanned: the directory is listed once, for
+ * whatever arrived while nothing was watching, and after that only the
+ * files inotify reports are looked at. Each is decoded with whatever the
+ * process wide reader cache has already compiled.
+ *
+ * A file is only decoded once it's been closed by whatever wrote it, or
+ * moved into the directory, so blobs written elsewhere and renamed into
+ * place are picked up whole. Only the directory itself is watched, not
+ * any beneath it.
+ *
+ * Given a checkpoint, the name of every file whose line has been written
+ * is appended to it, and a watcher started over the same checkpoint
+ * skips them. A line is flushed before its file's checkpointed, so once
+ * a write's been lost to a crash a blob may be decoded twice but never
+ * not at all. A blob that fails isn't checkpointed, being tried again
+ * should it be written again.
+ */
+class Watcher {
+    private :
+        std::string m_dir;
+        Batch::Options m_options;
+
+        int m_inotify;
+
+        /**
+         * Written to by [stop] to wake [poll]
+         */
+        int m_wake[2];
+
+        std::set<std::string> m_done;
+        std::ofstream m_checkpoint;
+
+        size_t m_failures;
+
+        void decode (const std::string & name_, std::ostream &);
+
+    public :
+        /**
+         * Watch [dir_], recording progress in [checkpoint_] unless that's
+         * empty. Only [m_paths] and [m_pointers] of [options_] mean
+         * anything to a watcher
+         */
+        Watcher (std::string dir_, const std::string & checkpoint_, Batch::Options options_);
+
+        Watcher (const Watcher &) = delete;
+
+        ~Watcher();
+
+        /**
+         * Decode every file already in the directory that hasn't been,
+         * in the order of their names
+         */
+        void catchUp (std::ostream &);
+
+        /**
+         * Wait up to [timeout_] milliseconds, forever if negative, for
+         * files to be written and decode those that were. False once
+         * stopped
+         */
+        bool poll (std::ostream &, int timeout_);
+
+        /**
+         * Catch up and then decode files as they come until stopped,
+         * returning how many failed
+         */
+        size_t run (std::ostream &);
+
+        /**
+         * Have [run] return once it's decoded what it's been told of.
+         * Safe to call from a signal handler
+         */
+        void stop();
+
+        size_t failures() const { return m_failures; }
+
+        const std::set<std::string> & done() const { return m_done; }
+};
+
+/******************************************************************************/
@@ -0,0 +1,192 @@
+#include "WorkStealingPool.h"
+
+#include <utility>
+#include <algorithm>
+
+#include "Numa.h"
+
+/******************************************************************************/
+
+WorkStealingPool::WorkStealingPool (size_t threads_, bool pinned_)
+    : m_queued (0)
+    , m_pending (0)
+    , m_next (0)
+    , m_stop (false)
+    , m_pinned (pinned_)
+    , m_nodes (pinned_ ? std::min (Numa::nodes(), std::max<size_t> (threads_, 1)) : 1)
+{
+    if (threads_ == 0) threads_ = 1;
+
+    for (size_t i { 0 } ; i < threads_ ; ++i) {
+        m_queues.emplace_back (std::make_unique<Queue>());
+    }
+
+    for (size_t i { 0 } ; i < threads_ ; ++i) {
+        m_threads.emplace_back (&WorkStealingPool::run, this, i);
+    }
+}
+
+/******************************************************************************/
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        // nowhere to report a failure to, so it goes with the pool
+        std::unique_lock<std::mutex> guard (m_lock);
+        m_done.wait (guard, [this]() { return m_pending == 0; });
+
+        m_stop = true;
+    }
+
+    m_work.notify_all();
+
+    for (auto & t : m_threads) {
+        t.join();
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Counted under the pool's lock before the task can be taken, so the
+ * worker that takes it can't uncount it first
+ */
+void
+WorkStealingPool::push (size_t queue_, Task task_) {
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        ++m_queued;
+
+        std::lock_guard<std::mutex> queued (m_queues[queue_]->m_lock);
+        m_queues[queue_]->m_tasks.push_back (std::move (task_));
+    }
+
+    m_work.notify_one();
+}
+
+/******************************************************************************/
+
+void
+WorkStealingPool::submit (Task task_) {
+    size_t queue;
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        queue = m_next++ % m_queues.size();
+        ++m_pending;
+    }
+
+    push (queue, std::move (task_));
+}
+
+/******************************************************************************/
+
+/**
+ * A node's workers are every [m_nodes]th from the node's own index, taken
+ * in turn
+ */
+void
+WorkStealingPool::submit (Task task_, size_t node_) {
+    node_ %= m_nodes;
+
+    const auto workers = (m_queues.size() - node_ + m_nodes - 1) / m_nodes;
+    size_t queue;
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        queue = node_ + m_nodes * (m_next++ % workers);
+        ++m_pending;
+    }
+
+    push (queue, std::move (task_));
+}
+
+/******************************************************************************/
+
+void
+WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> guard (m_lock);
+    m_done.wait (guard, [this]() { return m_pending == 0; });
+
+    if (m_failure) std::rethrow_exception (std::exchange (m_failure, nullptr));
+}
+
+/******************************************************************************/
+
+bool
+WorkStealingPool::take (size_t self_, Task & task_) {
+    {
+        auto & own = *m_queues[self_];
+        std::lock_guard<std::mutex> guard (own.m_lock);
+
+        if (!own.m_tasks.empty()) {
+            task_ = std::move (own.m_tasks.back());
+            own.m_tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i { 1 } ; i < m_queues.size() ; ++i) {
+        auto & victim = *m_queues[(self_ + i) % m_queues.size()];
+        std::lock_guard<std::mutex> guard (victim.m_lock);
+
+        if (!victim.m_tasks.empty()) {
+            task_ = std::move (victim.m_tasks.front());
+            victim.m_tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/******************************************************************************/
+
+void
+WorkStealingPool::run (size_t self_) {
+    if (m_pinned) Numa::pin (self_ % m_nodes);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard (m_lock);
+            m_work.wait (guard, [this]() { return m_stop || m_queued > 0; });
+
+            if (m_queued == 0 && m_stop) {
+                return;
+            }
+        }
+
+        Task task;
+
+        if (!take (self_, task)) {
+            // someone else got there first
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            --m_queued;
+        }
+
+        std::exception_ptr failure;
+
+        try {
+            task();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        bool finished;
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            if (failure && !m_failure) m_failure = failure;
+            finished = (--m_pending == 0);
+        }
+
+        if (finished) {
+            m_done.notify_all();
+        }
+    }
+}
+
+/******************************************************************************/
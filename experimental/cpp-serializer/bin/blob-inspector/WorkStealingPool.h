@@ -0,0 +1,99 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+/******************************************************************************/
+
+/**
+ * A fixed size pool of workers, each with its own queue of tasks. Workers
+ * take from the back of their own queue and, when that runs dry, steal
+ * from the front of everyone else's so no worker sits idle whilst there
+ * is still work queued anywhere.
+ *
+ * The first exception a task throws is rethrown by [wait], the pool
+ * carrying on with the rest regardless. Any thrown after it are dropped.
+ *
+ * Pinned, worker i runs only on the CPUs of NUMA node i modulo however
+ * many there are, see [Numa], and a task can be submitted to one of a
+ * node's workers, so it runs beside memory placed on that node unless
+ * stolen by another node's idle worker.
+ */
+class WorkStealingPool {
+    public :
+        using Task = std::function<void()>;
+
+    private :
+        struct Queue {
+            std::mutex       m_lock;
+            std::deque<Task> m_tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_lock;
+        std::condition_variable m_work;
+        std::condition_variable m_done;
+
+        /**
+         * Tasks sitting in a queue, and those submitted but not yet
+         * finished
+         */
+        size_t m_queued;
+        size_t m_pending;
+        size_t m_next;
+        bool   m_stop;
+
+        /**
+         * The first exception a task threw since the last [wait]
+         */
+        std::exception_ptr m_failure;
+
+        const bool m_pinned;
+        const size_t m_nodes;
+
+        bool take (size_t, Task &);
+        void run (size_t);
+        void push (size_t queue_, Task);
+
+    public :
+        explicit WorkStealingPool (
+            size_t threads_ = std::thread::hardware_concurrency(),
+            bool pinned_ = false);
+
+        WorkStealingPool (const WorkStealingPool &) = delete;
+
+        ~WorkStealingPool();
+
+        void submit (Task);
+
+        /**
+         * Queue [task_] for one of [node_]'s workers, or any worker when
+         * not pinned
+         */
+        void submit (Task task_, size_t node_);
+
+        /**
+         * The nodes workers are spread over, one when not pinned
+         */
+        size_t nodes() const { return m_nodes; }
+
+        /**
+         * Block until everything submitted has run, rethrowing the first
+         * exception any of it threw
+         */
+        void wait();
+
+        size_t size() const { return m_threads.size(); }
+};
+
+/******************************************************************************/
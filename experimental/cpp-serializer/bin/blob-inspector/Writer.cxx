@@ -0,0 +1,224 @@
+#include "Writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+
+#include "Numa.h"
+
+/******************************************************************************/
+
+namespace {
+
+    Pages &
+    pages() {
+        return *Pages::get (Pages::normal_t);
+    }
+
+    /**
+     * Errors meaning the descriptor can't be spliced into at all, rather
+     * than that the write failed
+     */
+    bool
+    unspliceable (int errno_) {
+        return errno_ == EINVAL || errno_ == ENOSYS || errno_ == EBADF;
+    }
+
+}
+
+/******************************************************************************/
+
+Writer::Buffer::int_type
+Writer::Buffer::overflow (int_type c_) {
+    if (!traits_type::eq_int_type (c_, traits_type::eof())) m_writer.put (traits_type::to_char_type (c_));
+
+    return traits_type::not_eof (c_);
+}
+
+/******************************************************************************/
+
+std::streamsize
+Writer::Buffer::xsputn (const char * data_, std::streamsize size_) {
+    m_writer.append ({ data_, static_cast<size_t> (size_) });
+    return size_;
+}
+
+/******************************************************************************/
+
+int
+Writer::Buffer::sync() {
+    try {
+        m_writer.flush();
+    } catch (const std::runtime_error &) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
+
+Writer::Writer (int fd_, size_t batch_)
+    : m_fd (fd_)
+    , m_batch (batch_ ? batch_ : 1)
+    , m_pipe (false)
+    , m_buffered (0)
+    , m_buffer (*this)
+    , m_stream (&m_buffer)
+{
+    struct stat results { };
+
+    m_pipe = ::fstat (m_fd, &results) == 0 && S_ISFIFO (results.st_mode);
+}
+
+/******************************************************************************/
+
+Writer::~Writer() {
+    try {
+        flush();
+    } catch (...) {
+        // nowhere left to say so
+    }
+
+    for (auto & chunk : m_chain) pages().deallocate (chunk.m_data, CHUNK);
+    for (auto * chunk : m_pool) pages().deallocate (chunk, CHUNK);
+}
+
+/******************************************************************************/
+
+char *
+Writer::take() {
+    if (m_pool.empty()) return static_cast<char *> (pages().allocate (CHUNK));
+
+    auto * rtn = m_pool.back();
+    m_pool.pop_back();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Writer::release (char * chunk_) {
+    if (m_pool.size() < POOLED) {
+        m_pool.push_back (chunk_);
+    } else {
+        pages().deallocate (chunk_, CHUNK);
+    }
+}
+
+/******************************************************************************/
+
+void
+Writer::append (std::string_view data_) {
+    while (!data_.empty()) {
+        if (m_chain.empty() || m_chain.back().m_size == CHUNK) m_chain.push_back ({ take(), 0 });
+
+        auto & chunk = m_chain.back();
+        auto size = std::min (data_.size(), CHUNK - chunk.m_size);
+
+        std::memcpy (chunk.m_data + chunk.m_size, data_.data(), size);
+
+        chunk.m_size += size;
+        m_buffered += size;
+        data_.remove_prefix (size);
+    }
+
+    if (m_buffered >= m_batch) flush();
+}
+
+/******************************************************************************/
+
+/**
+ * Sent at most IOV_MAX chunks at a time, each call picking up wherever
+ * the last left off. Splicing may stop part way, the pipe refusing, and
+ * whatever's left is then written, but once anything's been spliced the
+ * batch's chunks are all unmapped rather than pooled
+ */
+void
+Writer::flush() {
+    if (m_chain.empty()) return;
+
+    std::vector<iovec> io;
+    io.reserve (std::min<size_t> (m_chain.size(), IOV_MAX));
+
+    bool spliced { false };
+    size_t chunk { 0 };
+    size_t offset { 0 };
+
+    while (chunk < m_chain.size()) {
+        io.clear();
+
+        for (size_t i { chunk } ; i < m_chain.size() && io.size() < IOV_MAX ; ++i) {
+            auto skip = i == chunk ? offset : 0;
+            io.push_back ({ m_chain[i].m_data + skip, m_chain[i].m_size - skip });
+        }
+
+        ssize_t sent;
+
+        if (m_pipe) {
+            sent = ::vmsplice (m_fd, io.data(), io.size(), SPLICE_F_GIFT);
+
+            if (sent < 0 && unspliceable (errno)) {
+                m_pipe = false;
+                continue;
+            }
+
+            if (sent > 0) spliced = true;
+        } else {
+            sent = ::writev (m_fd, io.data(), static_cast<int> (io.size()));
+        }
+
+        if (sent < 0 && errno == EINTR) continue;
+
+        if (sent <= 0) {
+            auto err = std::string (sent < 0 ? std::strerror (errno) : "nothing written");
+
+            // not to be written again, in part, by anything flushing later
+            drop (true);
+
+            throw std::runtime_error ("Failed to write output: " + err);
+        }
+
+        auto left = static_cast<size_t> (sent);
+
+        while (left > 0) {
+            auto size = std::min (left, m_chain[chunk].m_size - offset);
+
+            left -= size;
+            offset += size;
+
+            if (offset == m_chain[chunk].m_size) {
+                ++chunk;
+                offset = 0;
+            }
+        }
+    }
+
+    drop (spliced);
+}
+
+/******************************************************************************/
+
+void
+Writer::drop (bool unmap_) {
+    for (auto & chunk : m_chain) {
+        if (unmap_) {
+            pages().deallocate (chunk.m_data, CHUNK);
+        } else {
+            release (chunk.m_data);
+        }
+    }
+
+    m_chain.clear();
+    m_buffered = 0;
+}
+
+/******************************************************************************/
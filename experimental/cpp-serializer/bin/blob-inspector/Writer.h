@@ -0,0 +1,121 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+/******************************************************************************/
+
+/**
+ * Output to a file descriptor, stdout say, gathered into a chain of page
+ * aligned chunks and written a batch at a time with as few system calls
+ * as it takes, rather than a line at a time through an iostream.
+ *
+ * Whatever's appended is copied once, into the last chunk of the chain,
+ * another being taken from the pool whenever that fills. Once [batch]
+ * bytes are held, or asked to be, the whole chain is written by writev,
+ * its chunks going back to the pool for the next batch.
+ *
+ * When the descriptor's a pipe the chain is spliced into it instead, by
+ * vmsplice, the pipe taking the chunks' pages themselves rather than a
+ * copy of them. Pages spliced may still be being read from long after
+ * the call returns, so those chunks are never written to again, being
+ * unmapped rather than pooled, and fresh ones mapped for the next batch.
+ * Should the kernel refuse to splice, the writing falls back to writev.
+ */
+class Writer {
+    public :
+        /**
+         * Each chunk's size, a whole number of pages
+         */
+        static constexpr size_t CHUNK = 256 * 1024;
+
+        static constexpr size_t BATCH = 1024 * 1024;
+
+        /**
+         * How many chunks are kept for reuse once written
+         */
+        static constexpr size_t POOLED = 8;
+
+    private :
+        /**
+         * For handing a writer to anything that writes to an ostream,
+         * its flushes flushing the writer
+         */
+        class Buffer : public std::streambuf {
+            private :
+                Writer & m_writer;
+
+            protected :
+                int_type overflow (int_type) override;
+                std::streamsize xsputn (const char *, std::streamsize) override;
+                int sync() override;
+
+            public :
+                explicit Buffer (Writer & writer_) : m_writer (writer_) { }
+        };
+
+        struct Chunk {
+            char * m_data;
+            size_t m_size;
+        };
+
+        int m_fd;
+        size_t m_batch;
+        bool m_pipe;
+
+        std::vector<Chunk> m_chain;
+        std::vector<char *> m_pool;
+
+        size_t m_buffered;
+
+        Buffer m_buffer;
+        std::ostream m_stream;
+
+        char * take();
+        void release (char *);
+
+        /**
+         * Empty the chain, its chunks unmapped or back to the pool
+         */
+        void drop (bool unmap_);
+
+    public :
+        /**
+         * Written whenever [batch_] bytes are held
+         */
+        explicit Writer (int fd_, size_t batch_ = BATCH);
+
+        Writer (const Writer &) = delete;
+
+        /**
+         * Anything still held is written, failing quietly
+         */
+        ~Writer();
+
+        void append (std::string_view);
+
+        void put (char c_) { append ({ &c_, 1 }); }
+
+        /**
+         * Write out whatever's held, throwing should the descriptor not
+         * take it all
+         */
+        void flush();
+
+        size_t buffered() const { return m_buffered; }
+
+        /**
+         * Whether output's being spliced into a pipe
+         */
+        bool spliced() const { return m_pipe; }
+
+        std::ostream & stream() { return m_stream; }
+};
+
+/******************************************************************************/
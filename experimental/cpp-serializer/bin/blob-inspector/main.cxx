@@ -1,17 +1,23 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <memory>
+#include <map>
+#include <thread>
 #include <cstddef>
+#include <cstdlib>
 
 #include <assert.h>
+#include <signal.h>
 #include <string.h>
-#include <proton/types.h>
-#include <proton/codec.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include "debug.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "cursor/Limits.h"
 
 #include "amqp/AMQPHeader.h"
 #include "amqp/AMQPSectionId.h"
@@ -19,25 +25,946 @@
 
 #include "amqp/schema/described-types/Envelope.h"
 #include "amqp/CompositeFactory.h"
+#include "amqp/ReaderCache.h"
+#include "amqp/SchemaStore.h"
+#include "reader/Arena.h"
+#include "reader/Lazy.h"
 #include "CordaBytes.h"
+#include "BlobStream.h"
+#include "Batch.h"
+#include "Aggregate.h"
+#include "Archive.h"
+#include "Capture.h"
+#include "Filter.h"
+#include "Offsets.h"
+#include "Registry.h"
+#include "Schedule.h"
+#include "Server.h"
+#include "Shards.h"
+#include "Snapshot.h"
+#include "Transfers.h"
+#include "Watcher.h"
+#include "Writer.h"
 #include "BlobInspector.h"
+#include "sink/CborSink.h"
+#include "sink/JsonSink.h"
+#include "stats/Costs.h"
+#include "stats/Stats.h"
+#include "stats/Trace.h"
 
 /******************************************************************************/
 
+namespace {
+
+    size_t costs { 0 };
+
+    void
+    stats() {
+        if (amqp::internal::stats::Stats::enabled()) {
+            amqp::internal::sink::JsonSink sink (STDERR_FILENO);
+            amqp::internal::stats::Stats::instance().write (sink);
+            sink.flush();
+
+            std::cerr << std::endl;
+        }
+
+        if (amqp::internal::stats::Costs::enabled()) {
+            amqp::internal::sink::JsonSink sink (STDERR_FILENO);
+            amqp::internal::stats::Costs::instance().write (sink, costs);
+            sink.flush();
+
+            std::cerr << std::endl;
+        }
+    }
+
+    void
+    trace (const std::string & path_) {
+        if (path_.empty()) return;
+
+        std::ofstream out (path_);
+        amqp::internal::sink::JsonSink sink (out);
+        amqp::internal::stats::Trace::instance().write (sink);
+        sink.flush();
+    }
+
+    Server * serving { nullptr };
+    Watcher * watching { nullptr };
+
+    void
+    interrupted (int) {
+        if (serving) serving->stop();
+        if (watching) watching->stop();
+    }
+
+    void
+    save (const std::shared_ptr<const amqp::internal::SchemaStore> & store_) {
+        if (!store_) return;
+
+        try {
+            store_->save (amqp::internal::ReaderCache::instance());
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Files are mapped directly into memory, passing "-" instead reads the
+ * blob from stdin.
+ *
+ * With --json the blob is streamed out as strict JSON as it is decoded,
+ * with --cbor as CBOR. The elements of its large lists are decoded on as
+ * many threads as the machine has unless told otherwise by --threads,
+ * one meaning not to
+ *
+ * With --dictionary a string CBOR output's already written, blob by blob,
+ * is written again as a stringref, see [CborSink::stringrefs]. Alone, or
+ * with --batch
+ *
+ * With --pointers an object the blob refers back to rather than repeating
+ * is written as { "$ref" : n } in place of the object itself
+ *
+ * With --nested a binary holding a serialised blob of its own, a
+ * transaction's components say, is decoded in place rather than written
+ * as bytes, recursively, and --project's paths run on down into it, see
+ * [BlobInspector::nested]. Alone, or with --batch
+ *
+ * With --first n every list, array or map of more than n elements is
+ * written as { "$count" : size, "$sample" : [ ... ] } holding just its
+ * first n, with --sample n the n spread evenly across it. Either writes
+ * JSON unless --cbor is given. The rest are skipped, not decoded
+ *
+ * With --limits, for example "depth=64,elements=1m,strings=64m,arena=256m",
+ * a blob that would use more than that to decode is abandoned, see
+ * [amqp::internal::cursor::Limits], and with --batch counted a failure
+ *
+ * With --batch every blob is first checked to be well formed, one that's
+ * not being recorded as failing without a decode being attempted, unless
+ * --no-validate is given, see [amqp::internal::cursor::validate]
+ *
+ * With --memo n a batch keeps what it wrote for the last n distinct blobs
+ * it decoded, a blob byte for byte the same as one of them being written
+ * from that without being decoded, see [Memo]. --stats reports how
+ * often that happened
+ *
+ * With --window n a batch decodes at most n blobs ahead of the lines it's
+ * written, its workers waiting once that many are, 16 for each worker
+ * unless told otherwise. Lines are written by a thread of their own so a
+ * slow output holds up decoding only once the window's full
+ *
+ * With --peek just the blob's outermost type is written, its name and
+ * descriptor as a JSON object, read from the envelope and the schema
+ * without decoding either, and with --batch one such line per blob,
+ * CBOR with --cbor, for routing blobs by type without decoding them
+ *
+ * With --group-by, --sum and --count a batch writes totals rather than
+ * the blobs, a line per group of blobs sharing the values of the comma
+ * separated fields grouped by, of how many there were with --count and
+ * what the fields given to --sum add up to, see [Aggregate]. Only those
+ * fields are decoded, and nothing is rendered until the totals are
+ *
+ * With --route dir a batch writes each blob's line to a file of that
+ * directory by its outermost type rather than to stdout, the file named
+ * for the type unless --routes gives a table of types and the names of
+ * the files they're written to, "*" naming where the rest go. Failures
+ * are reported to stderr
+ *
+ * With --checkpoint a batch records each blob it's written in the file
+ * given, see [Checkpoint], a batch rerun over it writing only those it
+ * didn't get to. With --incremental those it did are skipped only if
+ * they haven't changed since, by their size and modification time or
+ * if those differ by a hash of their contents. Given --output the lines
+ * are appended to that file, cut back first to where the last of them
+ * recorded ended, otherwise they're written to stdout to be appended
+ * by the caller. Neither works with --route or the totals
+ *
+ * With --archive a batch's argument is instead a tar or zip file, or the
+ * output of psql's COPY ... TO STDOUT (FORMAT binary), "-" reading it
+ * from stdin, whose blobs are read out one after another, see [Archive],
+ * and decoded in parallel as a batch's files would be, each line naming
+ * the blob's entry, or for COPY its row. With --column the blobs of a
+ * COPY are taken from that column, counting from zero, rather than the
+ * first holding one
+ *
+ * With --plan n a batch is instead split between n shards for as many
+ * machines as there are to work through, see [Shards], each shard's list
+ * of files written to the directory given by --shards, which they all
+ * share. With --work the argument is that directory, shards being
+ * claimed from it and each decoded as a batch of its own, with the batch
+ * options given, until there are none left, and with --merge it's the
+ * directory of a finished plan, every shard's output being written to
+ * stdout, or to --output, as one batch's would, its failures to stderr
+ * and with --stats the blobs' stats summed over all of them. --csv must
+ * be given to a merge of CSV shards, for the header to be written once
+ *
+ * With --batch the argument is instead a directory, a glob or, given "-",
+ * a list of files on stdin, each of which is decoded in parallel into
+ * its own line of JSON. Those lines are written in the order the files
+ * were found unless --unordered is given, and on as many threads as the
+ * machine has unless told otherwise by --threads. With --ndjson each line
+ * is instead just the blob's contents, with --cbor each blob's contents
+ * are a CBOR item, one after another, and with --csv a line is a row of
+ * the file and each field given by --project, under a header naming
+ * them. All three report blobs that failed to stderr rather than in the
+ * output
+ *
+ * With --io files are read ahead of the workers decoding them, many
+ * reads at once, rather than each worker opening its own, "uring" asking
+ * for an io_uring, "pread" for a few threads of preads and "auto" for
+ * the first that works. --queue-depth sets how many reads are kept in
+ * flight, 64 unless told otherwise
+ *
+ * With --huge-pages, "transparent" or "explicit", the buffers files are
+ * read ahead into, and the arenas decoded values are built in, are
+ * mapped with huge pages, see [Pages]. With --numa the workers are
+ * pinned across the machine's NUMA nodes, each file read ahead being
+ * read into memory on the node of the worker that decodes it
+ *
+ * With --project only the comma separated, dotted field paths given are
+ * decoded, "--project amount.quantity,participants" say, everything else
+ * being skipped. The output is JSON
+ *
+ * With --where a batch only writes the blobs matching the filter given,
+ * "--where 'amount.quantity > 1000 and currency in (\"GBP\", \"EUR\")'"
+ * say, see [Filter], each blob being decoded only as far as it takes to
+ * decide
+ *
+ * With --offsets a sidecar of where every composite, list and map sits in
+ * the blob is written beside it, to <blob>.offsets, see [Offsets]. With
+ * --at only the value at the path given, "states[41233].amount" say, is
+ * written, jumping straight to it when the blob has a sidecar
+ *
+ * With --snapshot the blob is decoded once onto a tape that's saved, with
+ * a copy of the blob, beside it to <blob>.tape, see [Snapshot]. Given a
+ * .tape, alone or in a batch, whatever's asked of it is replayed from the
+ * tape without anything being decoded
+ *
+ * With --stats the time spent in each phase of decoding, how much was
+ * decoded and how well the reader cache did, summed over every blob, is
+ * written to stderr as JSON once done
+ *
+ * With --costs n the n types that cost the most to decode, summed over
+ * every blob, are written to stderr as JSON once done, see [Costs]: the
+ * outermost types of the blobs and, apart from them, every composite
+ * nested anywhere within them, each with how often it was decoded, the
+ * time that took, with and without the composites within it, and how
+ * many bytes it came to. Allocations are counted too by a build
+ * configured with -DBLOB_INSPECTOR_COUNT_ALLOCATIONS=ON. Zero writes
+ * every type
+ *
+ * With --trace each of those phases, along with ordering the schema and
+ * building each type's reader, is recorded as a span and written to the
+ * file given as Chrome trace events, to be loaded into chrome://tracing
+ * or Perfetto. Render spans are detailed with the type being decoded and
+ * when batching each worker thread gets a track of its own
+ *
+ * With --schema-cache schemas are restored from the file given, rather
+ * than decoded, when it already holds them, and any it didn't are added
+ * to it once done. A missing or unreadable file is simply started afresh
+ *
+ * With --schema-memory the compiled schemas are held to roughly the size
+ * given, n taking an optional k, m or g, the least recently used being
+ * dropped, and compiled again should they be seen again, once it's
+ * exceeded. Without it every schema seen is kept
+ *
+ * With --schema-threads n each schema is built whole the first time it's
+ * seen, the readers of each level of its types on n threads, rather than
+ * type by type as they're needed, for schemas of very many types
+ *
+ * With --registry blobs stripped of their schemas by blob-registry are
+ * read, their schemas being found in the registry given, see [Registry]
+ *
+ * With --stream the argument, "-" for stdin, is read as one blob after
+ * another, a pipe or socket being fine, each decoded into its own line of
+ * JSON once it has arrived, see [BlobStream]. The output of psql's
+ * COPY ... TO STDOUT, a hex encoded bytea per line, is read as well, as
+ * are blobs each prefixed by their length
+ *
+ * With --frames the argument, "-" for stdin, is instead one direction of
+ * an AMQP 1.0 connection, the raw bytes a broker was sent or sent, and
+ * with --pcap a packet capture of them, pcap or pcapng, every TCP stream
+ * in it being reassembled, see [Transfers] and [Capture]. Each message's
+ * body is decoded into its own line of JSON as soon as its last transfer
+ * has arrived, named for the stream and the message's number in it, all
+ * of them sharing the one reader cache. A stream that can't be read is
+ * reported to stderr
+ *
+ * With --serve the argument is instead the path of a Unix domain socket
+ * on which blobs, or the paths of files holding them, are decoded for as
+ * long as the process runs, see [Server]. --threads, --pointers and
+ * --project apply to every blob served. An interrupt or SIGTERM stops
+ * the server, the schema cache then being saved as usual. With --metrics
+ * the server's metrics are also served over HTTP, on the port given, at
+ * /metrics. --latency has --threads pinned workers busy poll their
+ * connections instead, see [Pinned], the quantiles of how long requests
+ * took being written to stderr once stopped
+ *
+ * With --watch the argument is instead a directory, each blob written
+ * into it from then on being decoded into its own line of JSON once it's
+ * closed or renamed into place, see [Watcher], along with any already
+ * there. With --checkpoint the files decoded are recorded in the file
+ * given, a watch restarted over it carrying on where it left off rather
+ * than decoding them again. --pointers and --project apply to every blob,
+ * and an interrupt or SIGTERM stops the watch
+ */
 int
 main (int argc, char **argv) {
-    struct stat results { };
+    bool json { false };
+    bool cbor { false };
+    bool batch { false };
+    bool serve { false };
+    bool latency { false };
+    bool stream { false };
+    bool frames { false };
+    bool pcap { false };
+    bool watch { false };
+    std::string checkpoint;
+    std::string output;
+    bool archive { false };
+    int column { -1 };
+    size_t plan { 0 };
+    std::string shards;
+    bool work { false };
+    bool merge { false };
+    Batch::Options options;
+    std::string tracePath;
+    std::string at;
+    bool offsets { false };
+    bool snapshot { false };
+    std::vector<std::string> groupBy;
+    std::vector<std::string> sums;
+    bool count { false };
+    long metricsPort { -1 };
+    std::shared_ptr<const amqp::internal::SchemaStore> store;
+    int arg { 1 };
+
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-' ; ++arg) {
+        std::string opt { argv[arg] };
+
+        if (opt == "--json") {
+            json = true;
+        } else if (opt == "--batch") {
+            batch = true;
+        } else if (opt == "--serve") {
+            serve = true;
+        } else if (opt == "--latency") {
+            latency = true;
+        } else if (opt == "--watch") {
+            watch = true;
+        } else if (opt == "--checkpoint" && arg + 1 < argc) {
+            checkpoint = argv[++arg];
+        } else if (opt == "--incremental") {
+            options.m_incremental = true;
+        } else if (opt == "--output" && arg + 1 < argc) {
+            output = argv[++arg];
+        } else if (opt == "--archive") {
+            archive = true;
+        } else if (opt == "--column" && arg + 1 < argc) {
+            column = static_cast<int> (std::strtol (argv[++arg], nullptr, 10));
+        } else if (opt == "--plan" && arg + 1 < argc) {
+            plan = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--shards" && arg + 1 < argc) {
+            shards = argv[++arg];
+        } else if (opt == "--work") {
+            work = true;
+        } else if (opt == "--merge") {
+            merge = true;
+        } else if (opt == "--stream") {
+            stream = true;
+        } else if (opt == "--frames") {
+            frames = true;
+        } else if (opt == "--pcap") {
+            pcap = true;
+        } else if (opt == "--metrics" && arg + 1 < argc) {
+            metricsPort = std::strtol (argv[++arg], nullptr, 10);
+        } else if (opt == "--nested") {
+            options.m_nested = true;
+        } else if (opt == "--pointers") {
+            options.m_pointers = true;
+        } else if (opt == "--stats") {
+            amqp::internal::stats::Stats::enable();
+        } else if (opt == "--costs" && arg + 1 < argc) {
+            costs = std::strtoul (argv[++arg], nullptr, 10);
+            amqp::internal::stats::Costs::enable();
+        } else if (opt == "--trace" && arg + 1 < argc) {
+            tracePath = argv[++arg];
+            amqp::internal::stats::Trace::enable();
+        } else if (opt == "--schema-cache" && arg + 1 < argc) {
+            store = std::make_shared<const amqp::internal::SchemaStore> (argv[++arg]);
+            amqp::internal::ReaderCache::instance().attach (store);
+        } else if (opt == "--schema-memory" && arg + 1 < argc) {
+            try {
+                amqp::internal::ReaderCache::instance().limit (
+                        amqp::internal::cursor::Limits::bytes (argv[++arg]));
+            } catch (const std::runtime_error & e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (opt == "--schema-threads" && arg + 1 < argc) {
+            amqp::internal::ReaderCache::instance().threads (
+                    std::strtoul (argv[++arg], nullptr, 10));
+        } else if (opt == "--registry" && arg + 1 < argc) {
+            Registry::attach (std::make_shared<const Registry> (argv[++arg]));
+        } else if (opt == "--ndjson") {
+            options.m_format = Batch::ndjson_t;
+        } else if (opt == "--cbor") {
+            cbor = true;
+            options.m_format = Batch::cbor_t;
+        } else if (opt == "--dictionary") {
+            options.m_dictionary = true;
+        } else if (opt == "--csv") {
+            options.m_format = Batch::csv_t;
+        } else if (opt == "--unordered") {
+            options.m_ordered = false;
+        } else if (opt == "--project" && arg + 1 < argc) {
+            std::stringstream paths { argv[++arg] };
+            for (std::string path ; std::getline (paths, path, ',') ; ) {
+                options.m_paths.push_back (path);
+            }
+        } else if (opt == "--where" && arg + 1 < argc) {
+            try {
+                options.m_where = std::make_shared<const Filter> (argv[++arg]);
+            } catch (const std::runtime_error & e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if ((opt == "--first" || opt == "--sample") && arg + 1 < argc) {
+            options.m_sample = std::strtoul (argv[++arg], nullptr, 10);
+            options.m_uniform = opt == "--sample";
+        } else if (opt == "--limits" && arg + 1 < argc) {
+            try {
+                options.m_limits = std::make_shared<const amqp::internal::cursor::Limits> (
+                        amqp::internal::cursor::Limits::parse (argv[++arg]));
+            } catch (const std::runtime_error & e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (opt == "--memo" && arg + 1 < argc) {
+            options.m_memo = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--no-validate") {
+            options.m_validate = false;
+        } else if (opt == "--offsets") {
+            offsets = true;
+        } else if (opt == "--snapshot") {
+            snapshot = true;
+        } else if (opt == "--at" && arg + 1 < argc) {
+            at = argv[++arg];
+        } else if (opt == "--threads" && arg + 1 < argc) {
+            options.m_threads = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--io" && arg + 1 < argc) {
+            std::string io { argv[++arg] };
+
+            if (io == "uring") {
+                options.m_io = FileReader::uring_t;
+            } else if (io == "pread") {
+                options.m_io = FileReader::pread_t;
+            } else if (io != "auto") {
+                arg = argc;
+                break;
+            }
 
-    if (stat(argv[1], &results) != 0) {
+            if (!options.m_depth) options.m_depth = 64;
+        } else if (opt == "--huge-pages" && arg + 1 < argc) {
+            std::string pages { argv[++arg] };
+
+            if (pages == "transparent") {
+                options.m_pages = Pages::transparent_t;
+            } else if (pages == "explicit") {
+                options.m_pages = Pages::explicit_t;
+            } else {
+                arg = argc;
+                break;
+            }
+
+            amqp::internal::reader::Arena::upstream (Pages::get (options.m_pages));
+        } else if (opt == "--numa") {
+            options.m_numa = true;
+        } else if ((opt == "--group-by" || opt == "--sum") && arg + 1 < argc) {
+            std::stringstream paths { argv[++arg] };
+            for (std::string path ; std::getline (paths, path, ',') ; ) {
+                (opt == "--sum" ? sums : groupBy).push_back (path);
+            }
+        } else if (opt == "--count") {
+            count = true;
+        } else if (opt == "--route" && arg + 1 < argc) {
+            options.m_route = argv[++arg];
+        } else if (opt == "--routes" && arg + 1 < argc) {
+            std::ifstream routes (argv[++arg]);
+
+            try {
+                if (!routes) throw std::runtime_error (std::string ("Failed to open ") + argv[arg]);
+                options.m_routes = Batch::routes (routes);
+            } catch (const std::runtime_error & e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (opt == "--peek") {
+            options.m_peek = true;
+        } else if (opt == "--window" && arg + 1 < argc) {
+            options.m_window = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--largest-first") {
+            options.m_largest = true;
+            options.m_split = Schedule::LARGE;
+        } else if (opt == "--compress" && arg + 1 < argc) {
+            options.m_compress = Compressor::kind (argv[++arg]);
+
+            if (options.m_compress == Compressor::none_t) {
+                arg = argc;
+                break;
+            }
+        } else if (opt == "--level" && arg + 1 < argc) {
+            options.m_level = std::atoi (argv[++arg]);
+        } else if (opt == "--queue-depth" && arg + 1 < argc) {
+            options.m_depth = std::strtoul (argv[++arg], nullptr, 10);
+        } else {
+            arg = argc;
+        }
+    }
+
+    if (arg >= argc) {
+        std::cerr << "usage: " << argv[0]
+            << " [--json|--cbor] [--dictionary] [--pointers] [--nested] [--stats] [--costs n] [--trace file] [--threads n] [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file]"
+            << " [--first n|--sample n] [--limits spec] [--project paths] <blob|->" << std::endl
+            << "       " << argv[0] << " [--offsets] [--at path] <blob>" << std::endl
+            << "       " << argv[0] << " [--pointers] [--nested] [--first n|--sample n] --snapshot <blob>" << std::endl
+            << "       " << argv[0] << " [--project paths] <blob.tape>" << std::endl
+            << "       " << argv[0] << " --peek <blob|->" << std::endl
+            << "       " << argv[0]
+            << " --batch [--ndjson|--csv|--cbor] [--dictionary] [--unordered] [--pointers] [--nested] [--stats] [--costs n] [--trace file] [--threads n]"
+            << " [--io uring|pread|auto] [--queue-depth n] [--huge-pages transparent|explicit] [--numa]"
+            << " [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file] [--first n|--sample n] [--limits spec] [--no-validate] [--memo n] [--window n] [--largest-first] [--compress gzip|zstd] [--level n] [--peek] [--group-by paths] [--sum paths] [--count] [--route dir] [--routes file] [--checkpoint file] [--incremental] [--output file] [--project paths] [--where filter] <dir|glob|->"
+            << std::endl
+            << "       " << argv[0]
+            << " --batch --archive [--column n] [batch options] <archive|->"
+            << std::endl
+            << "       " << argv[0]
+            << " --stream [--pointers] [--stats] [--costs n] [--trace file] [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file] [--project paths] <file|->"
+            << std::endl
+            << "       " << argv[0]
+            << " --frames|--pcap [--pointers] [--stats] [--costs n] [--trace file] [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file] [--project paths] <file|->"
+            << std::endl
+            << "       " << argv[0]
+            << " --serve [--pointers] [--stats] [--costs n] [--trace file] [--threads n] [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file]"
+            << " [--metrics port] [--latency] [--project paths] <socket>"
+            << std::endl
+            << "       " << argv[0]
+            << " --plan n --shards dir <dir|glob|->"
+            << std::endl
+            << "       " << argv[0]
+            << " --work [batch options] <dir>"
+            << std::endl
+            << "       " << argv[0]
+            << " --merge [--csv] [--stats] [--output file] <dir>"
+            << std::endl
+            << "       " << argv[0]
+            << " --watch [--checkpoint file] [--pointers] [--stats] [--costs n] [--trace file] [--schema-cache file] [--schema-memory n] [--schema-threads n] [--registry file]"
+            << " [--project paths] <dir>"
+            << std::endl;
         return EXIT_FAILURE;
     }
 
-    CordaBytes cb (argv[1]);
-    
+    if (!groupBy.empty() || !sums.empty() || count) {
+        try {
+            options.m_aggregate = std::make_shared<Aggregate> (groupBy, sums, count);
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (serve) {
+        try {
+            Server server (argv[arg], options);
+
+            if (metricsPort >= 0) {
+                server.metrics (static_cast<uint16_t> (metricsPort));
+            }
+
+            serving = &server;
+            ::signal (SIGINT, interrupted);
+            ::signal (SIGTERM, interrupted);
+
+            server.latency (latency);
+            server.run();
+
+            serving = nullptr;
+
+            if (latency) {
+                const auto & histogram = server.metrics().latency();
+
+                std::cerr << histogram.count() << " requests, p50 " << histogram.quantile (0.5)
+                          << "s, p99 " << histogram.quantile (0.99)
+                          << "s, p99.9 " << histogram.quantile (0.999)
+                          << "s, max " << histogram.max() << "s" << std::endl;
+            }
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (watch) {
+        size_t failures;
+
+        try {
+            Watcher watcher (argv[arg], checkpoint, options);
+
+            watching = &watcher;
+            ::signal (SIGINT, interrupted);
+            ::signal (SIGTERM, interrupted);
+
+            failures = watcher.run (std::cout);
+
+            watching = nullptr;
+        } catch (const std::runtime_error & e) {
+            watching = nullptr;
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (plan > 0 || work || merge) {
+        size_t failures { 0 };
+
+        try {
+            if (plan > 0) {
+                if (shards.empty()) throw std::runtime_error ("--plan needs --shards");
+
+                Shards (shards).plan (Batch::expand (argv[arg], std::cin), plan);
+            } else if (work) {
+                failures = Shards (argv[arg]).work (options);
+            } else {
+                std::ofstream file;
+
+                if (!output.empty()) {
+                    file.open (output, std::ios::out | std::ios::trunc | std::ios::binary);
+                    if (!file) throw std::runtime_error ("Failed to open " + output);
+                }
+
+                failures = Shards (argv[arg]).merge (
+                        output.empty() ? std::cout : file, std::cerr, options.m_format);
+            }
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (batch) {
+        size_t failures;
+
+        try {
+            std::ofstream file;
+            Writer standard (STDOUT_FILENO);
+            std::ostream * out = &standard.stream();
+
+            if (!checkpoint.empty()) {
+                options.m_checkpoint = std::make_shared<Checkpoint> (checkpoint);
+                options.m_offset = options.m_checkpoint->end();
+            }
+
+            if (!output.empty() && options.m_checkpoint) {
+                // whatever was written after the last line recorded is written again
+                options.m_offset = options.m_checkpoint->reopen (output, file);
+                out = &file;
+            } else if (!output.empty()) {
+                file.open (output, std::ios::out | std::ios::trunc | std::ios::binary);
+                if (!file) throw std::runtime_error ("Failed to open " + output);
+                out = &file;
+            }
+
+            std::ifstream archived;
+            std::vector<std::string> files;
+
+            if (archive) {
+                std::istream * in = &std::cin;
+
+                if (std::string ("-") == argv[arg]) {
+                    std::ios::sync_with_stdio (false);
+                } else {
+                    archived.open (argv[arg], std::ios::in | std::ios::binary);
+                    if (!archived) throw std::runtime_error (std::string ("Failed to open ") + argv[arg]);
+                    in = &archived;
+                }
+
+                options.m_archive = std::make_shared<Archive> (*in, column);
+            } else {
+                files = Batch::expand (argv[arg], std::cin);
+            }
+
+            failures = Batch (std::move (files), options).run (*out, std::cerr);
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (stream) {
+        size_t failures { 0 };
+
+        try {
+            std::ifstream file;
+            std::istream * in = &std::cin;
+
+            if (std::string ("-") == argv[arg]) {
+                std::ios::sync_with_stdio (false);
+            } else {
+                file.open (argv[arg], std::ios::in | std::ios::binary);
+                if (!file) throw std::runtime_error (std::string ("Failed to open ") + argv[arg]);
+                in = &file;
+            }
+
+            BlobStream blobs (*in);
+            Writer out (STDOUT_FILENO);
+            std::string line;
+
+            while (auto cb = blobs.next()) {
+                if (!Batch::render (*cb, { }, line, options.m_paths, options.m_pointers)) ++failures;
+
+                out.append (line);
+                out.put ('\n');
+
+                // whoever's at the other end of a pipe wants each batch
+                // as it's done, all that's been read by the time there's
+                // nothing more to read without waiting
+                if (in->rdbuf()->in_avail() <= 0) out.flush();
+            }
+
+            out.flush();
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (frames || pcap) {
+        size_t failures { 0 };
+        std::map<std::string, size_t> messages;
+        std::string line;
+
+        std::ifstream file;
+        std::istream * in = &std::cin;
+
+        Writer out (STDOUT_FILENO);
+
+        auto decode = [&](const std::string & stream_, std::string_view body_) {
+            auto name = stream_ + " #" + std::to_string (++messages[stream_]);
+
+            try {
+                CordaBytes cb (body_.data(), body_.size());
+                if (!Batch::render (cb, name, line, options.m_paths, options.m_pointers)) ++failures;
+            } catch (const std::exception & e) {
+                line = Batch::error (name, e.what());
+                ++failures;
+            }
+
+            out.append (line);
+            out.put ('\n');
+
+            if (in->rdbuf()->in_avail() <= 0) out.flush();
+        };
+
+        try {
+            if (std::string ("-") == argv[arg]) {
+                std::ios::sync_with_stdio (false);
+            } else {
+                file.open (argv[arg], std::ios::in | std::ios::binary);
+                if (!file) throw std::runtime_error (std::string ("Failed to open ") + argv[arg]);
+                in = &file;
+            }
+
+            if (pcap) {
+                Capture capture (*in, decode, [&failures](const std::string & stream_, const char * error_) {
+                    std::cerr << Batch::error (stream_, error_) << std::endl;
+                    ++failures;
+                });
+
+                capture.run();
+            } else {
+                const std::string name { argv[arg] };
+                Transfers transfers ([&](std::string_view body_) { decode (name, body_); });
+
+                std::vector<char> chunk (64 * 1024);
+
+                while (in->read (chunk.data(), static_cast<std::streamsize> (chunk.size())) || in->gcount() > 0) {
+                    transfers.feed (chunk.data(), static_cast<size_t> (in->gcount()));
+                }
+
+                if (transfers.pending() > 0) {
+                    throw std::runtime_error ("Connection ended part way through a frame");
+                }
+            }
+
+            out.flush();
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (Snapshot::named (argv[arg])) {
+        try {
+            auto tape = Snapshot::load (argv[arg]);
+
+            amqp::internal::sink::JsonSink sink (STDOUT_FILENO);
+            sink.beginObject();
+
+            if (options.m_paths.empty()) {
+                tape->writeFields (sink);
+            } else {
+                tape->projectFields (sink, amqp::internal::tape::Tape::Paths (options.m_paths));
+            }
+
+            sink.endObject();
+            sink.flush();
+            std::cout << std::endl;
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        stats();
+        trace (tracePath);
+        save (store);
+
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<CordaBytes> bytes;
+
+    if (std::string ("-") == argv[arg]) {
+        bytes = std::make_unique<CordaBytes> (std::cin);
+    } else {
+        struct stat results { };
+
+        if (stat(argv[arg], &results) != 0) {
+            return EXIT_FAILURE;
+        }
+
+        bytes = std::make_unique<CordaBytes> (argv[arg]);
+    }
+
+    auto & cb = *bytes;
+
     if (cb.encoding() == amqp::DATA_AND_STOP) {
         BlobInspector blobInspector (cb);
-        auto val = blobInspector.dump();
-        std::cout << val << std::endl;
+        blobInspector.pointers (options.m_pointers);
+        blobInspector.threads (
+                options.m_threads == 0 ? std::thread::hardware_concurrency() : options.m_threads);
+        blobInspector.sample (options.m_sample, options.m_uniform);
+        blobInspector.limits (options.m_limits.get());
+        blobInspector.nested (options.m_nested);
+
+        /*
+         * A blob over its limits is reported rather than aborting, whatever
+         * was streamed before that was found being left as it is
+         */
+        try {
+            if (options.m_peek) {
+                amqp::internal::sink::JsonSink sink (STDOUT_FILENO);
+                sink.beginObject();
+
+                if (auto type = blobInspector.type() ; !type.empty()) {
+                    sink.key ("type");
+                    sink.string (type);
+                }
+
+                sink.key ("descriptor");
+                sink.string (blobInspector.descriptor());
+                sink.endObject();
+                sink.flush();
+                std::cout << std::endl;
+            } else if (snapshot) {
+                try {
+                    Snapshot (blobInspector).save (std::string (argv[arg]) + ".tape");
+                } catch (const std::runtime_error & e) {
+                    std::cerr << e.what() << std::endl;
+                    return EXIT_FAILURE;
+                }
+            } else if (offsets || !at.empty()) {
+                const std::string sidecar { std::string (argv[arg]) + ".offsets" };
+
+                try {
+                    std::unique_ptr<Offsets> index;
+
+                    if (offsets) {
+                        index = std::make_unique<Offsets> (cb);
+                        index->save (sidecar);
+                    } else if (std::ifstream (sidecar)) {
+                        index = Offsets::load (sidecar, cb);
+                    }
+
+                    if (!at.empty()) {
+                        std::cout << blobInspector.at (at, index.get())->dump() << std::endl;
+                    }
+                } catch (const std::runtime_error & e) {
+                    std::cerr << e.what() << std::endl;
+                    return EXIT_FAILURE;
+                }
+            } else if (!options.m_paths.empty()) {
+                amqp::internal::sink::JsonSink sink (STDOUT_FILENO);
+                blobInspector.project (sink, options.m_paths);
+                sink.flush();
+                std::cout << std::endl;
+            } else if (cbor) {
+                amqp::internal::sink::CborSink sink (STDOUT_FILENO);
+                sink.stringrefs (options.m_dictionary);
+                blobInspector.write (sink);
+            } else if (json || options.m_sample > 0 || options.m_nested) {
+                amqp::internal::sink::JsonSink sink (STDOUT_FILENO);
+                blobInspector.write (sink);
+                sink.flush();
+                std::cout << std::endl;
+            } else {
+                Writer out (STDOUT_FILENO);
+
+                out.append (blobInspector.dump());
+                out.put ('\n');
+                out.flush();
+            }
+        } catch (const amqp::internal::cursor::Limits::Exceeded & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
     } else {
         std::cerr << "BAD ENCODING " << cb.encoding() << " != "
             << amqp::DATA_AND_STOP << std::endl;
@@ -45,6 +972,10 @@ main (int argc, char **argv) {
         return EXIT_FAILURE;
     }
 
+    stats();
+    trace (tracePath);
+    save (store);
+
     return EXIT_SUCCESS;
 }
 
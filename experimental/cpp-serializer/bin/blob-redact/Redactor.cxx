@@ -0,0 +1,544 @@
+#include "Redactor.h"
+
+#include <set>
+#include <stdexcept>
+#include <string_view>
+
+#include "types.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "cursor/Cursor.h"
+#include "amqp/AMQPHeader.h"
+#include "amqp/ReaderCache.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/reader/Reader.h"
+#include "amqp/reader/ObjectTable.h"
+#include "amqp/reader/DispatchReader.h"
+#include "amqp/reader/CompositeReader.h"
+#include "amqp/reader/property-readers/StringPropertyReader.h"
+#include "amqp/reader/restricted-readers/MapReader.h"
+#include "amqp/reader/restricted-readers/ListReader.h"
+#include "amqp/reader/restricted-readers/ArrayReader.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+    namespace reader = amqp::internal::reader;
+
+    void
+    be32 (std::string & out_, uint32_t v_) {
+        out_ += static_cast<char> (v_ >> 24U);
+        out_ += static_cast<char> (v_ >> 16U);
+        out_ += static_cast<char> (v_ >> 8U);
+        out_ += static_cast<char> (v_);
+    }
+
+    /**
+     * A list or map holding [elements_] values encoded as [body_], sized
+     * with a byte where they fit in one
+     */
+    void
+    compound (std::string & out_, bool map_, const std::string & body_, size_t elements_) {
+        if (!map_ && elements_ == 0) {
+            out_ += '\x45';
+        } else if (body_.size() < 255 && elements_ < 256) {
+            out_ += map_ ? '\xc1' : '\xc0';
+            out_ += static_cast<char> (body_.size() + 1);
+            out_ += static_cast<char> (elements_);
+        } else {
+            out_ += map_ ? '\xd1' : '\xd0';
+            be32 (out_, static_cast<uint32_t> (body_.size() + 4));
+            be32 (out_, static_cast<uint32_t> (elements_));
+        }
+
+        out_.append (body_);
+    }
+
+    /**************************************************************************/
+
+    enum Shape { composite_s, list_s, map_s, value_s };
+
+    /**
+     * How a value is walked, as blob-compact walks them. Anything that
+     * isn't a described list or map where the reader expects one is
+     * copied as it was encoded
+     */
+    Shape
+    shape (const reader::Reader & reader_, const cursor::Cursor & data_) {
+        if (data_.type() != cursor::described_t) return value_s;
+
+        cursor::Cursor peek { data_ };
+        cursor::auto_enter ae (peek, true);
+
+        if (dynamic_cast<const reader::CompositeReader *>(&reader_)) {
+            return peek.type() == cursor::list_t ? composite_s : value_s;
+        }
+
+        if (dynamic_cast<const reader::ListReader *>(&reader_)
+            || dynamic_cast<const reader::ArrayReader *>(&reader_))
+        {
+            return peek.type() == cursor::list_t ? list_s : value_s;
+        }
+
+        if (dynamic_cast<const reader::MapReader *>(&reader_)) {
+            return peek.type() == cursor::map_t ? map_s : value_s;
+        }
+
+        return value_s;
+    }
+
+    const reader::Reader &
+    lock (const reader::Reader * reader_) {
+        if (reader_) {
+            // the cache keeps the graph alive for us
+            return *reader_;
+        }
+
+        throw std::runtime_error ("null reader");
+    }
+
+    /**
+     * The reader of a list or array's elements, null for anything else
+     */
+    const reader::Reader *
+    elements (const reader::Reader & reader_) {
+        if (auto list = dynamic_cast<const reader::ListReader *>(&reader_)) {
+            return &lock (list->reader());
+        }
+
+        if (auto array = dynamic_cast<const reader::ArrayReader *>(&reader_)) {
+            return &lock (array->reader());
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * The reader of the [idx_]th value within a value of [shape_]
+     */
+    const reader::Reader &
+    child (const reader::Reader & reader_, Shape shape_, size_t idx_) {
+        switch (shape_) {
+            case composite_s : {
+                const auto & readers = dynamic_cast<const reader::CompositeReader &> (
+                        reader_).readers();
+
+                if (idx_ >= readers.size()) {
+                    throw std::runtime_error ("More fields than " + reader_.type() + " has");
+                }
+
+                return lock (readers[idx_]);
+            }
+            case list_s :
+                return *elements (reader_);
+            default : {
+                const auto & map = dynamic_cast<const reader::MapReader &> (reader_);
+                return lock (idx_ % 2 ? map.valueReader() : map.keyReader());
+            }
+        }
+    }
+
+    /**
+     * A composite type's schema is a described list of its name, label,
+     * provides and descriptor then its fields, each a described list
+     * starting with its name
+     */
+    constexpr size_t FIELDS = 4;
+
+    std::string_view
+    name (const cursor::Cursor & data_) {
+        cursor::Cursor data { data_ };
+        cursor::auto_enter ae (data, true);
+        cursor::auto_list_enter ale (data, true);
+
+        return data.get_string();
+    }
+
+    bool
+    isComposite (const cursor::Cursor & data_) {
+        if (!data_.is_described()) return false;
+
+        cursor::Cursor data { data_ };
+        cursor::auto_enter ae (data);
+
+        return data.type() == cursor::ulong_t
+            && amqp::stripCorda (data.get_ulong())
+                == static_cast<uint32_t> (amqp::schema::descriptors::COMPOSITE_TYPE);
+    }
+
+}
+
+/******************************************************************************/
+
+Redactor::Redactor (
+    std::vector<std::string> drop_,
+    std::vector<std::string> mask_,
+    std::string with_
+) : m_drop (std::move (drop_))
+  , m_mask (std::move (mask_))
+  , m_with (std::move (with_))
+{ }
+
+/******************************************************************************/
+
+/**
+ * Lists and arrays are walked through to their elements at every step
+ */
+void
+Redactor::resolve (const Reader & root_, const std::string & path_, Action action_) {
+    const Reader * at = &root_;
+
+    size_t start { 0 };
+
+    for (;;) {
+        auto dot = path_.find ('.', start);
+        auto field = path_.substr (start, dot == std::string::npos ? std::string::npos : dot - start);
+
+        while (auto element = elements (*at)) at = element;
+
+        auto composite = dynamic_cast<const reader::CompositeReader *>(at);
+
+        if (!composite || field.empty()) {
+            throw std::runtime_error (
+                    "Can't redact \"" + path_ + "\", " + at->type() + " has no field \"" + field + "\"");
+        }
+
+        const auto & names = composite->names();
+
+        size_t i { 0 };
+        while (i < names.size() && names[i] != field) ++i;
+
+        if (i == names.size()) {
+            throw std::runtime_error (
+                    "No field \"" + field + "\" in " + composite->type() + " for path \"" + path_ + "\"");
+        }
+
+        if (dot == std::string::npos) {
+            auto & actions = m_actions[composite];
+            actions.resize (names.size(), keep_t);
+
+            if (actions[i] == keep_t) {
+                actions[i] = action_;
+                if (action_ == drop_t) m_dropped[composite->type()].push_back (field);
+            }
+
+            return;
+        }
+
+        at = &lock (composite->readers()[i]);
+        start = dot + 1;
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * A value read through an interface is whatever its descriptor says, so
+ * is always walked. Only the answer for the reader first asked after is
+ * kept, anything met again whilst working that out counting for nothing
+ * until then
+ */
+bool
+Redactor::touches (const Reader & reader_) {
+    if (auto it = m_touches.find (&reader_) ; it != m_touches.end()) return it->second;
+
+    std::set<const Reader *> seen;
+
+    std::function<bool (const Reader &)> walk = [&](const Reader & r_) {
+        if (m_actions.count (&r_)) return true;
+        if (!seen.insert (&r_).second) return false;
+
+        if (dynamic_cast<const reader::DispatchReader *>(&r_)) return true;
+
+        if (auto composite = dynamic_cast<const reader::CompositeReader *>(&r_)) {
+            for (const auto * field : composite->readers()) {
+                if (field && walk (*field)) return true;
+            }
+
+            return false;
+        }
+
+        if (auto element = elements (r_)) return walk (*element);
+
+        if (auto map = dynamic_cast<const reader::MapReader *>(&r_)) {
+            return (map->keyReader() && walk (*map->keyReader()))
+                || (map->valueReader() && walk (*map->valueReader()));
+        }
+
+        return false;
+    };
+
+    return m_touches[&reader_] = walk (reader_);
+}
+
+/******************************************************************************/
+
+void
+Redactor::mask (const Reader & reader_, std::string & out_) const {
+    if (!dynamic_cast<const reader::StringPropertyReader *>(&reader_)) {
+        out_ += '\x40';
+        return;
+    }
+
+    if (m_with.size() < 256) {
+        out_ += '\xa1';
+        out_ += static_cast<char> (m_with.size());
+    } else {
+        out_ += '\xb1';
+        be32 (out_, static_cast<uint32_t> (m_with.size()));
+    }
+
+    out_.append (m_with);
+}
+
+/******************************************************************************/
+
+/**
+ * Write the value at the cursor, leaving the cursor on its next sibling
+ */
+void
+Redactor::write (
+    const Reader & reader_,
+    amqp::internal::cursor::Cursor & data_,
+    std::string & out_
+) {
+    const auto & reader = reader::DispatchReader::concrete (reader_, data_);
+
+    if (!touches (reader)) {
+        out_.append (data_.encoded());
+        data_.next();
+        return;
+    }
+
+    auto s = shape (reader, data_);
+
+    if (s == value_s) {
+        out_.append (data_.encoded());
+        data_.next();
+        return;
+    }
+
+    cursor::auto_next an (data_);
+    cursor::auto_enter ae (data_);
+
+    out_ += '\x00';
+    out_.append (data_.encoded());
+    data_.next();
+
+    size_t elements = s == map_s ? data_.get_map() : data_.get_list();
+    cursor::auto_list_enter ale (data_, true);
+
+    auto actions = s == composite_s ? m_actions.find (&reader) : m_actions.end();
+
+    std::string body;
+    size_t written { 0 };
+
+    for (size_t i { 0 } ; i < elements ; ++i) {
+        auto action = actions == m_actions.end() || i >= actions->second.size()
+            ? keep_t
+            : actions->second[i];
+
+        if (action == drop_t) {
+            data_.next();
+            continue;
+        }
+
+        ++written;
+
+        if (action == mask_t) {
+            mask (child (reader, s, i), body);
+            data_.next();
+        } else {
+            write (child (reader, s, i), data_, body);
+        }
+    }
+
+    compound (out_, s == map_s, body, written);
+}
+
+/******************************************************************************/
+
+/**
+ * A composite type that loses fields, or as it was encoded
+ */
+std::string
+Redactor::type (amqp::internal::cursor::Cursor & data_) const {
+    if (!isComposite (data_)) return std::string { data_.encoded() };
+
+    auto dropped = m_dropped.find (name (data_));
+    if (dropped == m_dropped.end()) return std::string { data_.encoded() };
+
+    auto drop = [&dropped](std::string_view field_) {
+        for (const auto & field : dropped->second) {
+            if (field == field_) return true;
+        }
+
+        return false;
+    };
+
+    cursor::Cursor data { data_ };
+
+    std::string rtn;
+    cursor::auto_enter ae (data);
+
+    rtn += '\x00';
+    rtn.append (data.encoded());
+    data.next();
+
+    size_t elements = data.get_list();
+    cursor::auto_list_enter ale (data, true);
+
+    std::string body;
+
+    for (size_t i { 0 } ; i < elements ; ++i, data.next()) {
+        if (i != FIELDS) {
+            body.append (data.encoded());
+            continue;
+        }
+
+        size_t fields = data.get_list();
+        size_t kept { 0 };
+        std::string list;
+        {
+            cursor::auto_list_enter ale2 (data, true);
+
+            for (size_t j { 0 } ; j < fields ; ++j, data.next()) {
+                if (drop (name (data))) continue;
+
+                list.append (data.encoded());
+                ++kept;
+            }
+        }
+
+        compound (body, false, list, kept);
+    }
+
+    compound (rtn, false, body, elements);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * The schema is a described list of lists of types, each only rewritten
+ * if a type within it loses fields
+ */
+std::string
+Redactor::schema (amqp::internal::cursor::Cursor & data_) const {
+    if (m_dropped.empty()) return std::string { data_.encoded() };
+
+    cursor::Cursor data { data_ };
+
+    std::string rtn;
+    cursor::auto_enter ae (data);
+
+    rtn += '\x00';
+    rtn.append (data.encoded());
+    data.next();
+
+    size_t lists = data.get_list();
+    std::string outer;
+    {
+        cursor::auto_list_enter ale (data, true);
+
+        for (size_t i { 0 } ; i < lists ; ++i, data.next()) {
+            size_t types = data.get_list();
+            std::string inner;
+            {
+                cursor::auto_list_enter ale2 (data, true);
+
+                for (size_t j { 0 } ; j < types ; ++j, data.next()) {
+                    inner.append (type (data));
+                }
+            }
+
+            compound (outer, false, inner, types);
+        }
+    }
+
+    compound (rtn, false, outer, lists);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string
+Redactor::redact (CordaBytes & blob_) {
+    using amqp::internal::schema::descriptors::EnvelopeDescriptor;
+
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    if (BlobInspector (blob_).references()) {
+        throw std::runtime_error ("Can't redact a blob holding references");
+    }
+
+    m_actions.clear();
+    m_dropped.clear();
+    m_touches.clear();
+
+    cursor::Cursor data (blob_.bytes(), blob_.size());
+
+    auto peek = EnvelopeDescriptor::peek (data);
+
+    auto entry = amqp::internal::ReaderCache::instance().fetch (
+            peek.m_schema,
+            [&data]() {
+                cursor::Cursor envelope { data };
+                cursor::auto_enter p (envelope);
+
+                auto a = envelope.get_ulong();
+
+                return uPtr<amqp::internal::schema::Envelope> (
+                        dynamic_cast<amqp::internal::schema::Envelope *> (
+                                amqp::internal::AMQPDescriptorRegistory[a]->build (envelope).release()));
+            });
+
+    auto root = dynamic_cast<const Reader *> (
+            entry->byDescriptor (std::string { peek.m_descriptor }));
+
+    if (!root) {
+        throw std::runtime_error ("No reader for " + std::string { peek.m_descriptor });
+    }
+
+    for (const auto & path : m_drop) resolve (*root, path, drop_t);
+    for (const auto & path : m_mask) resolve (*root, path, mask_t);
+
+    std::string rtn (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+    rtn += static_cast<char> (blob_.encoding());
+
+    {
+        cursor::auto_enter ae (data);
+
+        rtn += '\x00';
+        rtn.append (data.encoded());
+        data.next();
+
+        cursor::auto_list_enter ale (data, true);
+
+        // the payload, the schema, then anything else untouched
+        std::string body;
+        write (*root, data, body);
+
+        for (size_t i { 1 } ; i < ale.elements() ; ++i, data.next()) {
+            body.append (i == 1 ? schema (data) : std::string { data.encoded() });
+        }
+
+        compound (rtn, false, body, ale.elements());
+    }
+
+    auto end = data.offset() + data.encodedSize();
+    rtn.append (blob_.bytes() + end, blob_.size() - end);
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,103 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+namespace amqp::internal::reader {
+
+    class Reader;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Re-encodes a blob with some of its fields dropped or masked, PII such
+ * as the names of the parties to a state say, into a blob any decoder
+ * still reads.
+ *
+ * Fields are dotted paths from the blob's outermost type, as projected,
+ * running through lists and arrays but not maps. A path names a field of
+ * a composite type and it's that field of every value of the type, where
+ * ever it appears in the blob, that's redacted, the schema being written
+ * per type. A field dropped is left out of both the value and its type's
+ * schema. A string masked is replaced by the mask, anything else masked
+ * by null.
+ *
+ * Values holding nothing redacted, which is nearly everything, are copied
+ * as the bytes they were encoded as without being walked, as is all of the
+ * schema but the types that lose a field. Lists and maps that are walked
+ * are rewritten with the smallest size that fits what they now hold.
+ *
+ * Redacting could change which objects a reference refers to so a blob
+ * holding any is refused.
+ */
+class Redactor {
+    public :
+        enum Action { keep_t, drop_t, mask_t };
+
+    private :
+        using Reader = amqp::internal::reader::Reader;
+
+        std::vector<std::string> m_drop;
+        std::vector<std::string> m_mask;
+        std::string m_with;
+
+        /**
+         * What's done to each field of the composites that have any
+         * redacted, for the blob being redacted
+         */
+        std::unordered_map<const Reader *, std::vector<Action>> m_actions;
+
+        /**
+         * By type, the names of the fields its schema loses
+         */
+        std::map<std::string, std::vector<std::string>, std::less<>> m_dropped;
+
+        /**
+         * Whether anything within a value a reader reads is redacted
+         */
+        std::unordered_map<const Reader *, bool> m_touches;
+
+        void resolve (const Reader & root_, const std::string & path_, Action);
+
+        bool touches (const Reader &);
+
+        void write (const Reader &, amqp::internal::cursor::Cursor &, std::string &);
+        void mask (const Reader &, std::string &) const;
+
+        std::string schema (amqp::internal::cursor::Cursor &) const;
+        std::string type (amqp::internal::cursor::Cursor &) const;
+
+    public :
+        /**
+         * Drop the fields at [drop_], masking those at [mask_] with
+         * [with_]
+         */
+        Redactor (
+            std::vector<std::string> drop_,
+            std::vector<std::string> mask_,
+            std::string with_ = "***");
+
+        /**
+         * The redacted blob, header and all. Throws if a path isn't a
+         * field of the blob's type
+         */
+        std::string redact (CordaBytes &);
+};
+
+/******************************************************************************/
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "Redactor.h"
+#include "CordaBytes.h"
+
+/******************************************************************************/
+
+namespace {
+
+    void
+    usage (const char * name_) {
+        std::cerr << "usage: " << name_
+            << " [--drop paths] [--mask paths] [--mask-with text] <blob|-> <file|->" << std::endl;
+    }
+
+    void
+    split (const std::string & paths_, std::vector<std::string> & into_) {
+        size_t start { 0 };
+
+        for (;;) {
+            auto comma = paths_.find (',', start);
+            into_.push_back (paths_.substr (start, comma == std::string::npos ? comma : comma - start));
+
+            if (comma == std::string::npos) return;
+
+            start = comma + 1;
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Re-encodes the blob given, or given "-" the one on stdin, into the file
+ * given or, given "-", stdout, with the fields named by --drop left out
+ * of it and those named by --mask masked, see [Redactor].
+ *
+ * Each takes a comma separated list of dotted paths and may be given more
+ * than once. Strings are masked with "***" unless told otherwise by
+ * --mask-with
+ */
+int
+main (int argc, char **argv) {
+    std::vector<std::string> drop, mask;
+    std::string with { "***" };
+    int arg { 1 };
+
+    for (; arg < argc && std::strncmp (argv[arg], "--", 2) == 0 ; ++arg) {
+        std::string opt { argv[arg] };
+
+        if (opt == "--drop" && arg + 1 < argc) {
+            split (argv[++arg], drop);
+        } else if (opt == "--mask" && arg + 1 < argc) {
+            split (argv[++arg], mask);
+        } else if (opt == "--mask-with" && arg + 1 < argc) {
+            with = argv[++arg];
+        } else {
+            usage (argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - arg != 2) {
+        usage (argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::unique_ptr<CordaBytes> bytes;
+
+        if (std::string ("-") == argv[arg]) {
+            bytes = std::make_unique<CordaBytes> (std::cin);
+        } else {
+            bytes = std::make_unique<CordaBytes> (argv[arg]);
+        }
+
+        auto redacted = Redactor (drop, mask, with).redact (*bytes);
+
+        if (std::string ("-") == argv[arg + 1]) {
+            std::cout.write (redacted.data(), redacted.size());
+        } else {
+            std::ofstream out (argv[arg + 1], std::ios::binary);
+            out.write (redacted.data(), redacted.size());
+
+            if (!out) {
+                std::cerr << "Failed to write " << argv[arg + 1] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "Batch.h"
+#include "Redactor.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    json (CordaBytes & cb_) {
+        std::stringstream ss;
+        {
+            amqp::internal::sink::JsonSink sink (ss);
+            BlobInspector (cb_).write (sink);
+        }
+        return ss.str();
+    }
+
+    /**
+     * [file_] redacted then decoded as JSON
+     */
+    std::string
+    redact (
+        const std::string & file_,
+        std::vector<std::string> drop_,
+        std::vector<std::string> mask_ = { }
+    ) {
+        CordaBytes cb (filepath + file_);
+
+        std::stringstream ss (Redactor (std::move (drop_), std::move (mask_)).redact (cb));
+        CordaBytes redacted (ss);
+
+        return json (redacted);
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Redacting nothing leaves every blob decoding exactly as it did
+ */
+TEST (BlobRedact, nothing) { // NOLINT
+    std::stringstream none;
+
+    for (const auto & file : Batch::expand (filepath, none)) {
+        SCOPED_TRACE (file);
+
+        CordaBytes cb (file);
+
+        if (BlobInspector (cb).references()) continue;
+
+        std::stringstream ss (Redactor ({ }, { }).redact (cb));
+        CordaBytes redacted (ss);
+
+        EXPECT_EQ (BlobInspector (cb).dump(), BlobInspector (redacted).dump());
+        EXPECT_EQ (json (cb), json (redacted));
+    }
+}
+
+/******************************************************************************/
+
+TEST (BlobRedact, mask) { // NOLINT
+    EXPECT_EQ (
+        "{\"Parsed\":{\"a\":1,\"b\":{\"a\":2,\"b\":\"***\"}}}",
+        redact ("_i_is__", { }, { "b.b" }));
+}
+
+/******************************************************************************/
+
+/**
+ * A dropped field goes from the schema too, so the redacted blob decodes
+ * as though it'd never had one
+ */
+TEST (BlobRedact, drop) { // NOLINT
+    EXPECT_EQ (
+        "{\"Parsed\":{\"a\":1,\"b\":{\"b\":\"three\"}}}",
+        redact ("_i_is__", { "b.a" }));
+
+    EXPECT_EQ (
+        "{\"Parsed\":{\"b\":{\"a\":2,\"b\":\"***\"}}}",
+        redact ("_i_is__", { "a" }, { "b.b" }));
+}
+
+/******************************************************************************/
+
+TEST (BlobRedact, badPath) { // NOLINT
+    EXPECT_THROW (redact ("_i_is__", { "c" }), std::runtime_error);
+    EXPECT_THROW (redact ("_i_is__", { "a.b" }), std::runtime_error);
+    EXPECT_THROW (redact ("_i_is__", { }, { "b." }), std::runtime_error);
+}
+
+/******************************************************************************/
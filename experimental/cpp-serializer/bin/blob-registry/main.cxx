@@ -0,0 +1,156 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+
+#include "Batch.h"
+#include "Registry.h"
+#include "CordaBytes.h"
+#include "WorkStealingPool.h"
+
+#include "amqp/AMQPHeader.h"
+
+/******************************************************************************/
+
+namespace {
+
+    void
+    usage (const char * name_) {
+        std::cerr << "usage: " << name_ << " [--threads n] <registry> <dir|glob|-> <dir>" << std::endl
+            << "       " << name_ << " --restore <registry> <blob> <file|->" << std::endl;
+    }
+
+    void
+    write (const std::string & file_, const char * bytes_, size_t size_) {
+        std::ofstream out (file_, std::ios::binary | std::ios::trunc);
+
+        out.write (bytes_, static_cast<std::streamsize> (size_));
+
+        if (!out.flush()) throw std::runtime_error ("Failed to write " + file_);
+    }
+
+    int
+    restore (const std::string & registry_, const std::string & blob_, const std::string & out_) {
+        Registry::attach (std::make_shared<const Registry> (registry_));
+
+        try {
+            CordaBytes cb (blob_);
+
+            std::string bytes (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+            bytes += static_cast<char> (cb.encoding());
+            bytes.append (cb.bytes(), cb.size());
+
+            if (out_ == "-") {
+                std::cout.write (bytes.data(), static_cast<std::streamsize> (bytes.size()));
+            } else {
+                write (out_, bytes.data(), bytes.size());
+            }
+        } catch (const std::exception & e) {
+            std::cerr << blob_ << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Given a registry, the blobs, named as blob-inspector --batch names
+ * them, and a directory, writes each blob stripped of its schema to a
+ * file of the same name in that directory, adding any schema the registry
+ * didn't already hold to it, see [Registry]. Blobs are stripped in
+ * parallel on as many threads as the machine has unless told otherwise
+ * by --threads. Those that couldn't be are reported on stderr, along with
+ * how many bytes were read and written.
+ *
+ * blob-inspector --registry reads the stripped blobs as it would any
+ * other. With --restore the blob given is instead written back out as it
+ * was before it was stripped
+ */
+int
+main (int argc, char **argv) {
+    size_t threads { 0 };
+    bool restoring { false };
+    int arg { 1 };
+
+    for (; arg < argc && std::strncmp (argv[arg], "--", 2) == 0 ; ++arg) {
+        std::string opt { argv[arg] };
+
+        if (opt == "--threads" && arg + 1 < argc) {
+            threads = std::strtoul (argv[++arg], nullptr, 10);
+        } else if (opt == "--restore") {
+            restoring = true;
+        } else {
+            usage (argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - arg != 3) {
+        usage (argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (restoring) return restore (argv[arg], argv[arg + 1], argv[arg + 2]);
+
+    Registry registry (argv[arg]);
+    const std::filesystem::path out { argv[arg + 2] };
+
+    std::vector<std::string> files;
+
+    try {
+        std::filesystem::create_directories (out);
+        files = Batch::expand (argv[arg + 1], std::cin);
+    } catch (const std::exception & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<size_t> before { 0 }, after { 0 }, failures { 0 };
+
+    {
+        WorkStealingPool pool (threads == 0 ? std::thread::hardware_concurrency() : threads);
+
+        for (const auto & file : files) {
+            pool.submit ([&, file]() {
+                try {
+                    CordaBytes cb (file);
+                    auto stripped = registry.strip (cb);
+
+                    write (out / std::filesystem::path (file).filename(), stripped.data(), stripped.size());
+
+                    before += std::filesystem::file_size (file);
+                    after += stripped.size();
+                } catch (const std::exception & e) {
+                    std::cerr << file << ": " << e.what() << std::endl;
+                    ++failures;
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    try {
+        registry.save();
+    } catch (const std::exception & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cerr << files.size() - failures << " blobs, " << before << " bytes stripped to " << after
+        << ", " << registry.size() << " schemas" << std::endl;
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/******************************************************************************/
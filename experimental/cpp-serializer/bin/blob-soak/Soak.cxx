@@ -0,0 +1,333 @@
+#include "Soak.h"
+
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined (__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <unistd.h>
+
+#include "CordaBytes.h"
+#include "Histogram.h"
+#include "BlobInspector.h"
+
+#include "amqp/ReaderCache.h"
+#include "reader/Arena.h"
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+namespace {
+
+    struct Heap {
+        size_t m_used;
+        size_t m_free;
+    };
+
+    /**
+     * What malloc has handed out and what it holds free, free memory
+     * that keeps growing whilst what's in use doesn't being the heap
+     * fragmenting
+     */
+    Heap
+    heap() {
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        auto info = ::mallinfo2();
+        return { info.uordblks + info.hblkhd, info.fordblks };
+#elif defined (__GLIBC__)
+        auto info = ::mallinfo();
+        return { static_cast<size_t> (info.uordblks) + static_cast<size_t> (info.hblkhd),
+                 static_cast<size_t> (info.fordblks) };
+#else
+        return { 0, 0 };
+#endif
+    }
+
+    /**
+     * Decode [blob_], rendering it or, given [dump_], dumping it
+     */
+    void
+    decode (const std::string & blob_, bool dump_, std::string & line_) {
+        CordaBytes cb (blob_.data(), blob_.size());
+        BlobInspector inspector (cb);
+
+        if (dump_) {
+            line_ = inspector.dump();
+        } else {
+            line_.clear();
+
+            amqp::internal::sink::JsonSink sink (line_);
+
+            sink.beginObject();
+            inspector.writeFields (sink);
+            sink.endObject();
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+Soak::Soak (Options options_)
+    : m_options (options_)
+    , m_next (0)
+{
+    if (m_options.m_versions == 0) {
+        throw std::runtime_error ("A soak needs at least one version");
+    }
+
+    m_options.m_rotate = std::max<size_t> (m_options.m_rotate, 1);
+
+    for (size_t i { 0 } ; i < m_options.m_versions ; ++i) {
+        m_corpus.push_back (version (m_next++));
+    }
+}
+
+/******************************************************************************/
+
+Generator::Shape
+Soak::shape (uint64_t id_, uint64_t size_, uint32_t seed_) {
+    Generator::Shape rtn;
+
+    rtn.m_fields = 1 + id_ % 6;
+    rtn.m_types = 2 + (id_ / 6) % 5;
+    rtn.m_depth = 2 + (id_ / 30) % 3;
+    rtn.m_enums = 0.25 * static_cast<double> ((id_ / 90) % 3);
+    rtn.m_size = size_;
+    rtn.m_seed = seed_;
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+Soak::Version
+Soak::version (uint64_t id_) const {
+    Version rtn { id_, { } };
+
+    rtn.m_blobs.reserve (BLOBS);
+
+    for (size_t i { 0 } ; i < BLOBS ; ++i) {
+        auto seed = static_cast<uint32_t> (m_options.m_seed + id_ * BLOBS + i);
+
+        std::stringstream ss;
+        Generator (shape (id_, m_options.m_size, seed)).write (ss);
+
+        rtn.m_blobs.push_back (ss.str());
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Soak::rotate() {
+    m_corpus.pop_front();
+    m_corpus.push_back (version (m_next++));
+}
+
+/******************************************************************************/
+
+void
+Soak::run (std::ostream & out_) {
+    using clock = std::chrono::steady_clock;
+
+    if (m_options.m_cacheMemory) {
+        amqp::internal::ReaderCache::instance().limit (m_options.m_cacheMemory);
+    }
+
+    out_ << "elapsed\tblobs\tversions\tresident\theap\tfree\tarena\tcache\tschemas"
+         << "\tp50_us\tp99_us\tp999_us" << std::endl;
+
+    const auto start = clock::now();
+    const auto end = start + m_options.m_duration;
+
+    auto next = start + m_options.m_interval;
+    auto latencies = std::make_unique<Histogram>();
+
+    std::string line;
+    uint64_t blobs { 0 };
+
+    for (auto now = start ; now < end ; ) {
+        const auto & version = m_corpus[blobs % m_corpus.size()];
+        const auto & blob = version.m_blobs[(blobs / m_corpus.size()) % version.m_blobs.size()];
+
+        decode (blob, blobs % DUMPS == DUMPS - 1, line);
+
+        auto then = clock::now();
+        latencies->record (static_cast<uint64_t> (
+                std::chrono::duration_cast<std::chrono::nanoseconds> (then - now).count()));
+        now = then;
+
+        if (++blobs % m_options.m_rotate == 0) {
+            rotate();
+            now = clock::now();
+        }
+
+        if (now < next && now < end) continue;
+
+        auto used = heap();
+        auto & cache = amqp::internal::ReaderCache::instance();
+
+        Sample sample {
+            std::chrono::duration<double> (now - start).count(),
+            blobs,
+            m_next,
+            resident(),
+            used.m_used,
+            used.m_free,
+            amqp::internal::reader::Arena::highWater(),
+            cache.bytes(),
+            cache.size(),
+            latencies->quantile (0.5),
+            latencies->quantile (0.99),
+            latencies->quantile (0.999)
+        };
+
+        m_samples.push_back (sample);
+
+        out_ << sample.m_elapsed << '\t' << sample.m_blobs << '\t' << sample.m_versions
+             << '\t' << sample.m_resident << '\t' << sample.m_heap << '\t' << sample.m_free
+             << '\t' << sample.m_arena << '\t' << sample.m_cache << '\t' << sample.m_schemas
+             << '\t' << sample.m_p50 * 1e6 << '\t' << sample.m_p99 * 1e6
+             << '\t' << sample.m_p999 * 1e6 << std::endl;
+
+        latencies = std::make_unique<Histogram>();
+
+        // a sample that ran long doesn't leave the next to be taken at once
+        while (next <= now) next += m_options.m_interval;
+        now = clock::now();
+    }
+}
+
+/******************************************************************************/
+
+bool
+Soak::drifting (
+    const std::vector<double> & x_,
+    const std::vector<double> & y_,
+    double tolerance_,
+    double floor_,
+    double * from_,
+    double * to_
+) {
+    auto n = std::min (x_.size(), y_.size());
+
+    if (n < 3) return false;
+
+    double sx { 0 }, sy { 0 };
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        sx += x_[i];
+        sy += y_[i];
+    }
+
+    const auto mx = sx / static_cast<double> (n);
+    const auto my = sy / static_cast<double> (n);
+
+    double sxy { 0 }, sxx { 0 };
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        sxy += (x_[i] - mx) * (y_[i] - my);
+        sxx += (x_[i] - mx) * (x_[i] - mx);
+    }
+
+    const auto slope = sxx > 0 ? sxy / sxx : 0;
+
+    const auto from = my + slope * (x_[0] - mx);
+    const auto to = my + slope * (x_[n - 1] - mx);
+
+    if (from_) *from_ = from;
+    if (to_) *to_ = to;
+
+    const auto rise = to - from;
+
+    // the rise's standard error, from how far the points stray from the line
+    double residuals { 0 };
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        auto residual = y_[i] - (my + slope * (x_[i] - mx));
+        residuals += residual * residual;
+    }
+
+    const auto error = sxx > 0
+        ? std::sqrt (residuals / static_cast<double> (n - 2) / sxx) * (x_[n - 1] - x_[0])
+        : 0;
+
+    return rise > floor_ && rise > tolerance_ * std::max (from, 0.0) && rise > SIGNIFICANCE * error;
+}
+
+/******************************************************************************/
+
+/**
+ * Memory measures must grow by a MiB or more to drift, so a cache that
+ * settles a few pages larger than it started doesn't fail a run, and
+ * latency by 100us or more, well clear of a scheduler's hiccup
+ */
+std::vector<Soak::Drift>
+Soak::drifts() const {
+    struct Measure {
+        const char * m_name;
+        double (* m_of) (const Sample &);
+        double m_floor;
+    };
+
+    static const Measure measures[] {
+        { "resident", [](const Sample & s_) { return static_cast<double> (s_.m_resident); }, 1 << 20 },
+        { "heap", [](const Sample & s_) { return static_cast<double> (s_.m_heap); }, 1 << 20 },
+        { "free", [](const Sample & s_) { return static_cast<double> (s_.m_free); }, 1 << 20 },
+        { "arena", [](const Sample & s_) { return static_cast<double> (s_.m_arena); }, 1 << 20 },
+        { "cache", [](const Sample & s_) { return static_cast<double> (s_.m_cache); }, 1 << 20 },
+        { "p50", [](const Sample & s_) { return s_.m_p50; }, 100e-6 },
+        { "p99", [](const Sample & s_) { return s_.m_p99; }, 100e-6 },
+    };
+
+    std::vector<Drift> rtn;
+
+    if (m_samples.size() <= m_options.m_warmup) return rtn;
+
+    std::vector<double> x;
+
+    for (auto i = m_options.m_warmup ; i < m_samples.size() ; ++i) {
+        x.push_back (m_samples[i].m_elapsed);
+    }
+
+    for (const auto & measure : measures) {
+        std::vector<double> y;
+
+        for (auto i = m_options.m_warmup ; i < m_samples.size() ; ++i) {
+            y.push_back (measure.m_of (m_samples[i]));
+        }
+
+        Drift drift { measure.m_name, 0, 0 };
+
+        if (drifting (x, y, m_options.m_tolerance, measure.m_floor, &drift.m_from, &drift.m_to)) {
+            rtn.push_back (drift);
+        }
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+Soak::resident() {
+    std::ifstream statm ("/proc/self/statm");
+
+    size_t size { 0 }, pages { 0 };
+
+    if (!(statm >> size >> pages)) return 0;
+
+    return pages * static_cast<size_t> (::sysconf (_SC_PAGESIZE));
+}
+
+/******************************************************************************/
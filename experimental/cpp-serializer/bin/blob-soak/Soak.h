@@ -0,0 +1,167 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <deque>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstddef>
+#include <cstdint>
+
+#include "Generator.h"
+
+/******************************************************************************/
+
+/**
+ * Decodes a rotating corpus of generated blobs for as long as it's asked
+ * to, sampling the process as it goes, to catch memory or latency that
+ * creeps up over hours where a benchmark's seconds would never see it.
+ *
+ * The corpus holds [Options::m_versions] versions of the same types at
+ * once, each a [Generator::Shape] with a different number of fields,
+ * types, levels and enums, decoded in turn, 270 of them before any
+ * recurs. Every [Options::m_rotate] blobs the oldest
+ * version is dropped and another added, so new schemas keep arriving
+ * and the reader cache keeps compiling, compacting and evicting them, as
+ * it would for a node whose counterparties upgrade at different times.
+ * Blobs are rendered as [Batch] renders them, one in every [DUMPS]
+ * dumped through the thread's arena instead.
+ *
+ * Every [Options::m_interval] a [Sample] is taken: resident memory, what
+ * malloc holds in use and free, the arena high-water mark, the size of
+ * the reader cache and the latency percentiles of the blobs decoded
+ * since the last. Once the first [Options::m_warmup] samples, spent
+ * filling caches and arenas, are passed over, any measure whose fitted
+ * trend grows by more than [Options::m_tolerance] of where it started,
+ * by more than a little in absolute terms and by more than the samples'
+ * scatter about it could account for, is drifting.
+ */
+class Soak {
+    public :
+        /**
+         * One blob in this many is dumped rather than rendered
+         */
+        static constexpr size_t DUMPS = 8;
+
+        /**
+         * Blobs of each version, each with its own values
+         */
+        static constexpr size_t BLOBS = 8;
+
+        /**
+         * The standard errors a trend must rise by to be more than noise
+         */
+        static constexpr double SIGNIFICANCE = 3;
+
+        struct Options {
+            std::chrono::seconds m_duration         { 3600 };
+            std::chrono::milliseconds m_interval    { 10000 };
+
+            size_t m_versions   { 4 };
+            size_t m_rotate     { 1000 };
+            uint64_t m_size     { 16 * 1024 };
+
+            size_t m_warmup     { 3 };
+            double m_tolerance  { 0.1 };
+
+            /**
+             * The reader cache's limit, zero leaving it uncapped. Small
+             * enough by default that schemas are compacted and evicted
+             * as their versions rotate out
+             */
+            size_t m_cacheMemory { 256 * 1024 };
+
+            uint32_t m_seed     { 1 };
+        };
+
+        struct Sample {
+            double m_elapsed;
+            uint64_t m_blobs;
+            uint64_t m_versions;
+
+            size_t m_resident;
+            size_t m_heap;
+            size_t m_free;
+            size_t m_arena;
+            size_t m_cache;
+            size_t m_schemas;
+
+            /**
+             * Of the blobs decoded since the last sample, in seconds
+             */
+            double m_p50;
+            double m_p99;
+            double m_p999;
+        };
+
+        struct Drift {
+            std::string m_measure;
+            double m_from;
+            double m_to;
+        };
+
+    private :
+        struct Version {
+            uint64_t m_id;
+            std::vector<std::string> m_blobs;
+        };
+
+        Options m_options;
+
+        std::deque<Version> m_corpus;
+        uint64_t m_next;
+
+        std::vector<Sample> m_samples;
+
+        Version version (uint64_t id_) const;
+
+        void rotate();
+
+    public :
+        explicit Soak (Options);
+
+        Soak (const Soak &) = delete;
+
+        /**
+         * The shape of version [id_], its fields and types cycling so
+         * that consecutive versions always differ
+         */
+        static Generator::Shape shape (uint64_t id_, uint64_t size_, uint32_t seed_);
+
+        /**
+         * Decode for [Options::m_duration], writing each sample to [out_]
+         * as a line of tab separated columns after a line naming them
+         */
+        void run (std::ostream & out_);
+
+        const std::vector<Sample> & samples() const { return m_samples; }
+
+        /**
+         * Every measure drifting over the samples taken so far
+         */
+        std::vector<Drift> drifts() const;
+
+        /**
+         * Whether the least squares line through [y_] over [x_] rises by
+         * more than [tolerance_] of its starting value, more than [floor_]
+         * and more than [SIGNIFICANCE] standard errors, filling [from_]
+         * and [to_] with its ends. Fewer than three points never drift
+         */
+        static bool drifting (
+            const std::vector<double> & x_,
+            const std::vector<double> & y_,
+            double tolerance_,
+            double floor_,
+            double * from_ = nullptr,
+            double * to_ = nullptr);
+
+        /**
+         * This process's resident set in bytes, zero where it can't
+         * be found
+         */
+        static size_t resident();
+};
+
+/******************************************************************************/
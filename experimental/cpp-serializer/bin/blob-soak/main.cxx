@@ -0,0 +1,129 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Soak.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Bytes, optionally suffixed K, M or G
+     */
+    uint64_t
+    bytes (const char * arg_) {
+        char * end;
+        uint64_t rtn = std::strtoull (arg_, &end, 10);
+
+        switch (*end) {
+            case 'G' : case 'g' : rtn <<= 10; [[fallthrough]];
+            case 'M' : case 'm' : rtn <<= 10; [[fallthrough]];
+            case 'K' : case 'k' : rtn <<= 10; break;
+            default : break;
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Seconds, optionally suffixed m or h
+     */
+    std::chrono::seconds
+    seconds (const char * arg_) {
+        char * end;
+        auto rtn = std::strtoull (arg_, &end, 10);
+
+        switch (*end) {
+            case 'h' : rtn *= 60; [[fallthrough]];
+            case 'm' : rtn *= 60; break;
+            default : break;
+        }
+
+        return std::chrono::seconds (rtn);
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Decodes a rotating generated corpus for as long as it's told, a line
+ * of samples to stdout every interval, see [Soak]. Any measure found to
+ * be drifting upwards is reported on stderr and the exit status is 1
+ *
+ *   --duration     n[m|h]      how long to run for, an hour by default
+ *   --interval     n           seconds between samples
+ *   --versions     n           schema versions decoded at once
+ *   --rotate       n           blobs between one version and the next
+ *   --size         n[K|M|G]    roughly how large each blob is
+ *   --warmup       n           samples passed over before measuring drift
+ *   --tolerance    f           the growth allowed, as a fraction
+ *   --cache-memory n[K|M|G]    the reader cache's limit, 0 for none
+ *   --seed         n           what values are chosen from
+ */
+int
+main (int argc, char **argv) {
+    Soak::Options options;
+    int arg { 1 };
+
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-' ; arg += 2) {
+        std::string opt { argv[arg] };
+        const char * val { argv[arg + 1] };
+
+        if (opt == "--duration") {
+            options.m_duration = seconds (val);
+        } else if (opt == "--interval") {
+            options.m_interval = std::chrono::milliseconds (
+                    static_cast<int64_t> (std::strtod (val, nullptr) * 1000));
+        } else if (opt == "--versions") {
+            options.m_versions = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--rotate") {
+            options.m_rotate = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--size") {
+            options.m_size = bytes (val);
+        } else if (opt == "--warmup") {
+            options.m_warmup = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--tolerance") {
+            options.m_tolerance = std::strtod (val, nullptr);
+        } else if (opt == "--cache-memory") {
+            options.m_cacheMemory = bytes (val);
+        } else if (opt == "--seed") {
+            options.m_seed = std::strtoul (val, nullptr, 10);
+        } else {
+            arg = argc + 1;
+        }
+    }
+
+    if (arg != argc || options.m_interval.count() <= 0) {
+        std::cerr << "usage: " << argv[0]
+            << " [--duration n[m|h]] [--interval n] [--versions n] [--rotate n]"
+            << " [--size n[K|M|G]] [--warmup n] [--tolerance f]"
+            << " [--cache-memory n[K|M|G]] [--seed n]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        Soak soak (options);
+        soak.run (std::cout);
+
+        auto drifts = soak.drifts();
+
+        for (const auto & drift : drifts) {
+            std::cerr << drift.m_measure << " drifted from " << drift.m_from
+                << " to " << drift.m_to << std::endl;
+        }
+
+        std::cerr << soak.samples().size() << " samples, "
+            << (soak.samples().empty() ? 0 : soak.samples().back().m_blobs) << " blobs, "
+            << drifts.size() << " drifting" << std::endl;
+
+        return drifts.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "Soak.h"
+
+/******************************************************************************/
+
+namespace {
+
+    std::vector<double>
+    seconds (size_t n_) {
+        std::vector<double> rtn;
+
+        for (size_t i { 0 } ; i < n_ ; ++i) rtn.push_back (static_cast<double> (i) * 10);
+
+        return rtn;
+    }
+
+    size_t
+    lines (const std::string & str_) {
+        size_t rtn { 0 };
+
+        for (auto c : str_) if (c == '\n') ++rtn;
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Soak, flat) { // NOLINT
+    auto x = seconds (20);
+    std::vector<double> y;
+
+    // noisy, but going nowhere
+    for (size_t i { 0 } ; i < x.size() ; ++i) y.push_back (i % 2 ? 110e6 : 90e6);
+
+    EXPECT_FALSE (Soak::drifting (x, y, 0.1, 1 << 20));
+
+    // nor does one spike at the end
+    y.assign (x.size(), 100e6);
+    y.back() = 150e6;
+
+    EXPECT_FALSE (Soak::drifting (x, y, 0.1, 1 << 20));
+}
+
+/******************************************************************************/
+
+TEST (Soak, rising) { // NOLINT
+    auto x = seconds (20);
+    std::vector<double> y;
+
+    // a leak of a MiB a sample on 100MB
+    for (size_t i { 0 } ; i < x.size() ; ++i) y.push_back (100e6 + static_cast<double> (i << 20));
+
+    double from, to;
+
+    EXPECT_TRUE (Soak::drifting (x, y, 0.1, 1 << 20, &from, &to));
+    EXPECT_NEAR (100e6, from, 1);
+    EXPECT_NEAR (100e6 + (19 << 20), to, 1);
+
+    // but not past what's tolerated
+    EXPECT_FALSE (Soak::drifting (x, y, 0.5, 1 << 20));
+
+    // nor by a floor larger than it grew
+    EXPECT_FALSE (Soak::drifting (x, y, 0.1, 32 << 20));
+
+    // nor when the points scatter too widely to tell
+    for (size_t i { 0 } ; i < x.size() ; ++i) y[i] += i % 2 ? 40e6 : -40e6;
+
+    EXPECT_FALSE (Soak::drifting (x, y, 0.1, 1 << 20));
+
+    // though a steeper climb through the same scatter does
+    for (size_t i { 0 } ; i < x.size() ; ++i) y[i] += static_cast<double> (i) * 5e6;
+
+    EXPECT_TRUE (Soak::drifting (x, y, 0.1, 1 << 20));
+
+    // nor with too few samples to fit
+    EXPECT_FALSE (Soak::drifting ({ 0, 10 }, { 0, 100e6 }, 0.1, 0));
+}
+
+/******************************************************************************/
+
+TEST (Soak, falling) { // NOLINT
+    auto x = seconds (10);
+    std::vector<double> y;
+
+    for (size_t i { 0 } ; i < x.size() ; ++i) y.push_back (100e6 - static_cast<double> (i << 20));
+
+    EXPECT_FALSE (Soak::drifting (x, y, 0.1, 0));
+}
+
+/******************************************************************************/
+
+TEST (Soak, versions) { // NOLINT
+    for (uint64_t i { 0 } ; i < 64 ; ++i) {
+        auto lhs = Soak::shape (i, 4096, 1);
+        auto rhs = Soak::shape (i + 1, 4096, 1);
+
+        EXPECT_TRUE (lhs.m_fields != rhs.m_fields || lhs.m_types != rhs.m_types) << i;
+    }
+}
+
+/******************************************************************************/
+
+TEST (Soak, run) { // NOLINT
+    Soak::Options options;
+
+    options.m_duration = std::chrono::seconds (1);
+    options.m_interval = std::chrono::milliseconds (200);
+    options.m_versions = 2;
+    options.m_rotate = 8;
+    options.m_size = 2048;
+    options.m_warmup = 100;
+
+    Soak soak (options);
+
+    std::stringstream ss;
+    soak.run (ss);
+
+    const auto & samples = soak.samples();
+
+    ASSERT_GE (samples.size(), 2U);
+    EXPECT_EQ (samples.size() + 1, lines (ss.str()));
+
+    EXPECT_GT (samples.back().m_blobs, samples.front().m_blobs);
+    EXPECT_GT (samples.back().m_versions, 2U);
+    EXPECT_GT (samples.back().m_schemas, 0U);
+    EXPECT_GT (samples.back().m_p50, 0);
+    EXPECT_LE (samples.back().m_p50, samples.back().m_p999);
+
+#if defined (__linux__)
+    EXPECT_GT (samples.back().m_resident, 0U);
+#endif
+
+    // every sample is still warming up
+    EXPECT_TRUE (soak.drifts().empty());
+}
+
+/******************************************************************************/
@@ -0,0 +1,572 @@
+#include "corda_amqp.h"
+
+#include <new>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Batch.h"
+#include "Frames.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+
+#include "amqp/ReaderCache.h"
+#include "amqp/SchemaStore.h"
+#include "amqp/AMQPSectionId.h"
+#include "amqp/reader/IVisitor.h"
+#include "sink/CborSink.h"
+#include "sink/JsonSink.h"
+#include "tape/Tape.h"
+#include "tape/Index.h"
+#include "tape/Pointer.h"
+
+/******************************************************************************/
+
+struct corda_amqp_session {
+    std::string m_error;
+    bool m_pointers { false };
+};
+
+struct corda_amqp_cache {
+    std::shared_ptr<const amqp::internal::SchemaStore> m_store;
+};
+
+struct corda_amqp_tape {
+    amqp::internal::tape::Tape m_tape;
+
+    /**
+     * Built by the first [corda_amqp_tape_at]
+     */
+    mutable std::once_flag m_indexed;
+    mutable std::unique_ptr<const amqp::internal::tape::Index> m_index;
+};
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Run [fn_] against [blob_], turning anything it throws into an error
+     * code and the session's error
+     */
+    template<class Fn>
+    int
+    guarded (corda_amqp_session * session_, const void * blob_, size_t size_, Fn && fn_) {
+        if (!session_) return CORDA_AMQP_EINVAL;
+
+        session_->m_error.clear();
+
+        if (!blob_) {
+            session_->m_error = "No blob";
+            return CORDA_AMQP_EINVAL;
+        }
+
+        std::unique_ptr<CordaBytes> cb;
+
+        try {
+            cb = std::make_unique<CordaBytes> (static_cast<const char *> (blob_), size_);
+        } catch (const std::exception & e) {
+            session_->m_error = e.what();
+            return CORDA_AMQP_EFORMAT;
+        }
+
+        if (cb->encoding() != amqp::DATA_AND_STOP) {
+            session_->m_error = "Bad encoding";
+            return CORDA_AMQP_EFORMAT;
+        }
+
+        try {
+            BlobInspector inspector (*cb);
+            inspector.pointers (session_->m_pointers);
+
+            fn_ (inspector);
+        } catch (const std::exception & e) {
+            session_->m_error = e.what();
+            return CORDA_AMQP_EDECODE;
+        } catch (...) {
+            session_->m_error = "Unknown failure";
+            return CORDA_AMQP_EDECODE;
+        }
+
+        return CORDA_AMQP_OK;
+    }
+
+    /**
+     * A copy of [text_] the caller frees with [corda_amqp_free], whatever
+     * it was rendered into being kept by the thread for the next call
+     */
+    void
+    copy (const std::string & text_, char ** out_, size_t * size_) {
+        auto * rtn = static_cast<char *> (std::malloc (text_.size() + 1));
+
+        if (!rtn) throw std::bad_alloc();
+
+        std::memcpy (rtn, text_.c_str(), text_.size() + 1);
+
+        *out_ = rtn;
+        if (size_) *size_ = text_.size();
+    }
+
+    /**
+     * Decode [blob_], or just the [paths_] of it when given, through a
+     * [Sink] rendering into a buffer the thread keeps
+     */
+    template<class Sink>
+    int
+    render (
+        corda_amqp_session * session_,
+        const void * blob_,
+        size_t size_,
+        const std::vector<std::string> * paths_,
+        char ** out_,
+        size_t * outSize_
+    ) {
+        if (!out_) return CORDA_AMQP_EINVAL;
+
+        return guarded (session_, blob_, size_, [&](BlobInspector & inspector_) {
+            thread_local std::string out;
+            out.clear();
+            {
+                Sink sink (out);
+
+                if (paths_) {
+                    inspector_.project (sink, *paths_);
+                } else {
+                    inspector_.write (sink);
+                }
+            }
+
+            copy (out, out_, outSize_);
+        });
+    }
+
+    /**************************************************************************/
+
+    class Visitor : public amqp::reader::IVisitor {
+        private :
+            const corda_amqp_visitor & m_c;
+
+        public :
+            explicit Visitor (const corda_amqp_visitor & c_) : m_c (c_) { }
+
+            void onBeginComposite (std::string_view type_) override {
+                if (m_c.on_begin_composite) m_c.on_begin_composite (m_c.context, type_.data(), type_.size());
+            }
+
+            void onEndComposite() override {
+                if (m_c.on_end_composite) m_c.on_end_composite (m_c.context);
+            }
+
+            void onField (std::string_view name_) override {
+                if (m_c.on_field) m_c.on_field (m_c.context, name_.data(), name_.size());
+            }
+
+            void onBeginList (size_t count_) override {
+                if (m_c.on_begin_list) m_c.on_begin_list (m_c.context, count_);
+            }
+
+            void onEndList() override {
+                if (m_c.on_end_list) m_c.on_end_list (m_c.context);
+            }
+
+            void onBeginMap (size_t count_) override {
+                if (m_c.on_begin_map) m_c.on_begin_map (m_c.context, count_);
+            }
+
+            void onEndMap() override {
+                if (m_c.on_end_map) m_c.on_end_map (m_c.context);
+            }
+
+            void onBool (bool value_) override {
+                if (m_c.on_bool) m_c.on_bool (m_c.context, value_ ? 1 : 0);
+            }
+
+            void onInt (int32_t value_) override {
+                if (m_c.on_int) m_c.on_int (m_c.context, value_);
+            }
+
+            void onLong (int64_t value_) override {
+                if (m_c.on_long) m_c.on_long (m_c.context, value_);
+            }
+
+            void onDouble (double value_) override {
+                if (m_c.on_double) m_c.on_double (m_c.context, value_);
+            }
+
+            void onString (std::string_view value_) override {
+                if (m_c.on_string) m_c.on_string (m_c.context, value_.data(), value_.size());
+            }
+
+            void onChar (char32_t value_) override {
+                if (m_c.on_char) m_c.on_char (m_c.context, static_cast<uint32_t> (value_));
+            }
+
+            void onShort (int16_t value_) override {
+                if (m_c.on_short) m_c.on_short (m_c.context, value_);
+            }
+
+            void onByte (int8_t value_) override {
+                if (m_c.on_byte) m_c.on_byte (m_c.context, value_);
+            }
+
+            void onFloat (float value_) override {
+                if (m_c.on_float) m_c.on_float (m_c.context, value_);
+            }
+
+            void onTimestamp (int64_t value_) override {
+                if (m_c.on_timestamp) m_c.on_timestamp (m_c.context, value_);
+            }
+
+            void onUuid (std::string_view value_) override {
+                if (m_c.on_uuid) m_c.on_uuid (m_c.context, value_.data(), value_.size());
+            }
+
+            void onDecimal128 (std::string_view value_) override {
+                if (m_c.on_decimal128) m_c.on_decimal128 (m_c.context, value_.data(), value_.size());
+            }
+
+            void onSymbol (std::string_view value_) override {
+                if (m_c.on_symbol) m_c.on_symbol (m_c.context, value_.data(), value_.size());
+            }
+
+            void onEnum (std::string_view value_) override {
+                if (m_c.on_enum) m_c.on_enum (m_c.context, value_.data(), value_.size());
+            }
+
+            void onBinary (std::string_view value_) override {
+                if (m_c.on_binary) m_c.on_binary (m_c.context, value_.data(), value_.size());
+            }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * Sessions
+ *
+ ******************************************************************************/
+
+int
+corda_amqp_version() {
+    return CORDA_AMQP_VERSION;
+}
+
+/******************************************************************************/
+
+corda_amqp_session *
+corda_amqp_open() {
+    return new (std::nothrow) corda_amqp_session;
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_close (corda_amqp_session * session_) {
+    delete session_;
+}
+
+/******************************************************************************/
+
+const char *
+corda_amqp_error (const corda_amqp_session * session_) {
+    return session_ ? session_->m_error.c_str() : "No session";
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_pointers (corda_amqp_session * session_, int pointers_) {
+    if (session_) session_->m_pointers = pointers_ != 0;
+}
+
+/******************************************************************************
+ *
+ * Decoding
+ *
+ ******************************************************************************/
+
+int
+corda_amqp_decode_json (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    char ** json_,
+    size_t * jsonSize_
+) {
+    return render<amqp::internal::sink::JsonSink> (session_, blob_, size_, nullptr, json_, jsonSize_);
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_project_json (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    const char * const * paths_,
+    size_t count_,
+    char ** json_,
+    size_t * jsonSize_
+) {
+    if (count_ > 0 && !paths_) return CORDA_AMQP_EINVAL;
+
+    std::vector<std::string> paths (paths_, paths_ + count_);
+
+    return render<amqp::internal::sink::JsonSink> (session_, blob_, size_, &paths, json_, jsonSize_);
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_decode_cbor (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    char ** cbor_,
+    size_t * cborSize_
+) {
+    if (!cborSize_) return CORDA_AMQP_EINVAL;
+
+    return render<amqp::internal::sink::CborSink> (session_, blob_, size_, nullptr, cbor_, cborSize_);
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_project_cbor (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    const char * const * paths_,
+    size_t count_,
+    char ** cbor_,
+    size_t * cborSize_
+) {
+    if (!cborSize_ || (count_ > 0 && !paths_)) return CORDA_AMQP_EINVAL;
+
+    std::vector<std::string> paths (paths_, paths_ + count_);
+
+    return render<amqp::internal::sink::CborSink> (session_, blob_, size_, &paths, cbor_, cborSize_);
+}
+
+/******************************************************************************/
+
+/**
+ * Every blob is decoded in turn by the same thread, reusing its arena and
+ * the compiled schemas the last found, its line rendered straight onto
+ * the end of the output
+ */
+int
+corda_amqp_decode_frames_json (
+    corda_amqp_session * session_,
+    const void * data_,
+    size_t size_,
+    char ** json_,
+    size_t * jsonSize_,
+    size_t * blobs_
+) {
+    if (!session_) return CORDA_AMQP_EINVAL;
+
+    session_->m_error.clear();
+
+    if (!json_ || (!data_ && size_)) return CORDA_AMQP_EINVAL;
+
+    try {
+        Frames frames (static_cast<const char *> (data_), size_);
+
+        thread_local std::string out;
+        thread_local std::string line;
+        std::string_view blob;
+
+        out.clear();
+
+        for (;;) {
+            try {
+                if (!frames.next (blob)) break;
+            } catch (const std::exception & e) {
+                session_->m_error = e.what();
+                if (blobs_) *blobs_ = frames.blobs();
+                return CORDA_AMQP_EFORMAT;
+            }
+
+            try {
+                CordaBytes cb (blob.data(), blob.size());
+                Batch::render (cb, { }, line, { }, session_->m_pointers);
+            } catch (const std::exception & e) {
+                line = Batch::error ({ }, e.what());
+            }
+
+            out += line;
+            out += '\n';
+        }
+
+        copy (out, json_, jsonSize_);
+        if (blobs_) *blobs_ = frames.blobs();
+    } catch (const std::exception & e) {
+        session_->m_error = e.what();
+        return CORDA_AMQP_EDECODE;
+    }
+
+    return CORDA_AMQP_OK;
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_free (void * memory_) {
+    std::free (memory_);
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_visit (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    const corda_amqp_visitor * visitor_
+) {
+    if (!visitor_) return CORDA_AMQP_EINVAL;
+
+    return guarded (session_, blob_, size_, [&](BlobInspector & inspector_) {
+        Visitor visitor (*visitor_);
+        inspector_.visit (visitor);
+    });
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_decode_tape (
+    corda_amqp_session * session_,
+    const void * blob_,
+    size_t size_,
+    corda_amqp_tape ** tape_
+) {
+    if (!tape_) return CORDA_AMQP_EINVAL;
+
+    return guarded (session_, blob_, size_, [&](BlobInspector & inspector_) {
+        *tape_ = new corda_amqp_tape { inspector_.tape() };
+    });
+}
+
+/******************************************************************************/
+
+const uint64_t *
+corda_amqp_tape_words (const corda_amqp_tape * tape_, size_t * count_) {
+    if (!tape_) return nullptr;
+
+    if (count_) *count_ = tape_->m_tape.size();
+    return tape_->m_tape.data();
+}
+
+/******************************************************************************/
+
+const char *
+corda_amqp_tape_text (const corda_amqp_tape * tape_, size_t * size_) {
+    if (!tape_) return nullptr;
+
+    if (size_) *size_ = tape_->m_tape.copied().size();
+    return tape_->m_tape.copied().data();
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_tape_at (const corda_amqp_tape * tape_, const char * pointer_, size_t * index_) {
+    if (!tape_ || !pointer_ || !index_) return CORDA_AMQP_EINVAL;
+
+    try {
+        std::call_once (tape_->m_indexed, [tape_]() {
+            tape_->m_index = std::make_unique<const amqp::internal::tape::Index> (tape_->m_tape);
+        });
+
+        auto at = tape_->m_index->at (amqp::internal::tape::Pointer (pointer_));
+
+        if (at == tape_->m_tape.end()) return CORDA_AMQP_ENOTFOUND;
+
+        *index_ = at.index();
+        return CORDA_AMQP_OK;
+    } catch (...) {
+        return CORDA_AMQP_EINVAL;
+    }
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_tape_free (corda_amqp_tape * tape_) {
+    delete tape_;
+}
+
+/******************************************************************************
+ *
+ * The schema cache
+ *
+ ******************************************************************************/
+
+corda_amqp_cache *
+corda_amqp_cache_open (const char * path_) {
+    if (!path_) return nullptr;
+
+    try {
+        auto * rtn = new corda_amqp_cache {
+            std::make_shared<const amqp::internal::SchemaStore> (path_) };
+
+        amqp::internal::ReaderCache::instance().attach (rtn->m_store);
+
+        return rtn;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+/******************************************************************************/
+
+int
+corda_amqp_cache_save (corda_amqp_cache * cache_) {
+    if (!cache_) return CORDA_AMQP_EINVAL;
+
+    try {
+        cache_->m_store->save (amqp::internal::ReaderCache::instance());
+    } catch (...) {
+        return CORDA_AMQP_EIO;
+    }
+
+    return CORDA_AMQP_OK;
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_cache_close (corda_amqp_cache * cache_) {
+    if (!cache_) return;
+
+    amqp::internal::ReaderCache::instance().detach (cache_->m_store);
+
+    delete cache_;
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_cache_stats (size_t * entries_, size_t * hits_, size_t * misses_) {
+    const auto & cache = amqp::internal::ReaderCache::instance();
+
+    if (entries_) *entries_ = cache.size();
+    if (hits_) *hits_ = cache.hits();
+    if (misses_) *misses_ = cache.misses();
+}
+
+/******************************************************************************/
+
+void
+corda_amqp_cache_clear() {
+    amqp::internal::ReaderCache::instance().clear();
+}
+
+/******************************************************************************/
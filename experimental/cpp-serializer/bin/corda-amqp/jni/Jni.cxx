@@ -0,0 +1,261 @@
+#include <jni.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "corda_amqp.h"
+
+/******************************************************************************/
+
+/**
+ * The native methods of net.corda.amqp.CordaAmqp, over libcorda_amqp's C
+ * interface.
+ *
+ * Blobs are only ever taken from direct ByteBuffers, whose memory the JVM
+ * doesn't move, so they're decoded where they lie without being copied or
+ * pinned. What's rendered comes back either as a byte array or, making no
+ * Java objects at all, written straight into another direct buffer. Every
+ * failure is thrown as a Java exception, nothing being done after one is
+ * pending.
+ */
+
+/******************************************************************************/
+
+namespace {
+
+    const char * const DECODE_EXCEPTION { "net/corda/amqp/CordaAmqp$DecodeException" };
+
+    corda_amqp_session *
+    session (jlong session_) {
+        return reinterpret_cast<corda_amqp_session *> (session_);
+    }
+
+    void
+    raise (JNIEnv * env_, const char * class_, const char * what_) {
+        if (auto * thrown = env_->FindClass (class_)) env_->ThrowNew (thrown, what_);
+    }
+
+    /**
+     * The [size_] bytes at [offset_] in the direct buffer [buffer_], null
+     * with an exception thrown if that isn't where they are
+     */
+    char *
+    view (JNIEnv * env_, jobject buffer_, jint offset_, jint size_) {
+        auto * address = static_cast<char *> (env_->GetDirectBufferAddress (buffer_));
+        auto capacity = env_->GetDirectBufferCapacity (buffer_);
+
+        if (!address || capacity < 0) {
+            raise (env_, "java/lang/IllegalArgumentException", "Not a direct buffer");
+            return nullptr;
+        }
+
+        if (offset_ < 0 || size_ < 0 || static_cast<jlong> (offset_) + size_ > capacity) {
+            raise (env_, "java/lang/IndexOutOfBoundsException", "Outside the buffer");
+            return nullptr;
+        }
+
+        return address + offset_;
+    }
+
+    /**
+     * The paths of a projection, held as C strings for as long as this is
+     */
+    class Paths {
+        private :
+            std::vector<std::string> m_held;
+            std::vector<const char *> m_paths;
+
+        public :
+            /**
+             * False with an exception thrown should any path be null
+             */
+            bool read (JNIEnv * env_, jobjectArray paths_) {
+                auto count = env_->GetArrayLength (paths_);
+
+                m_held.reserve (static_cast<size_t> (count));
+
+                for (jsize i { 0 } ; i < count ; ++i) {
+                    auto path = static_cast<jstring> (env_->GetObjectArrayElement (paths_, i));
+
+                    if (!path) {
+                        raise (env_, "java/lang/NullPointerException", "Null path");
+                        return false;
+                    }
+
+                    const char * chars = env_->GetStringUTFChars (path, nullptr);
+                    if (!chars) return false;
+
+                    m_held.emplace_back (chars);
+
+                    env_->ReleaseStringUTFChars (path, chars);
+                    env_->DeleteLocalRef (path);
+                }
+
+                for (const auto & path : m_held) m_paths.push_back (path.c_str());
+
+                return true;
+            }
+
+            const char * const * data() const { return m_paths.data(); }
+            size_t size() const { return m_paths.size(); }
+    };
+
+    /**
+     * Decode the blob, or just the [paths_] of it unless that's null, as
+     * JSON or CBOR into memory that's the caller's to free. False with an
+     * exception thrown if it couldn't be
+     */
+    bool
+    render (
+        JNIEnv * env_,
+        jlong session_,
+        jobject blob_,
+        jint offset_,
+        jint size_,
+        jobjectArray paths_,
+        jboolean cbor_,
+        char ** out_,
+        size_t * outSize_
+    ) {
+        const char * blob = view (env_, blob_, offset_, size_);
+        if (!blob) return false;
+
+        auto * s = session (session_);
+        auto size = static_cast<size_t> (size_);
+        int rtn;
+
+        if (paths_) {
+            Paths paths;
+            if (!paths.read (env_, paths_)) return false;
+
+            rtn = cbor_
+                ? corda_amqp_project_cbor (s, blob, size, paths.data(), paths.size(), out_, outSize_)
+                : corda_amqp_project_json (s, blob, size, paths.data(), paths.size(), out_, outSize_);
+        } else {
+            rtn = cbor_
+                ? corda_amqp_decode_cbor (s, blob, size, out_, outSize_)
+                : corda_amqp_decode_json (s, blob, size, out_, outSize_);
+        }
+
+        if (rtn != CORDA_AMQP_OK) {
+            raise (env_, DECODE_EXCEPTION, corda_amqp_error (s));
+            return false;
+        }
+
+        return true;
+    }
+
+}
+
+/******************************************************************************/
+
+extern "C" {
+
+/******************************************************************************/
+
+JNIEXPORT jlong JNICALL
+Java_net_corda_amqp_CordaAmqp_open (JNIEnv *, jclass) {
+    return reinterpret_cast<jlong> (corda_amqp_open());
+}
+
+/******************************************************************************/
+
+JNIEXPORT void JNICALL
+Java_net_corda_amqp_CordaAmqp_close (JNIEnv *, jclass, jlong session_) {
+    corda_amqp_close (session (session_));
+}
+
+/******************************************************************************/
+
+JNIEXPORT void JNICALL
+Java_net_corda_amqp_CordaAmqp_pointers (JNIEnv *, jclass, jlong session_, jboolean pointers_) {
+    corda_amqp_pointers (session (session_), pointers_ ? 1 : 0);
+}
+
+/******************************************************************************/
+
+JNIEXPORT jbyteArray JNICALL
+Java_net_corda_amqp_CordaAmqp_render (
+    JNIEnv * env_,
+    jclass,
+    jlong session_,
+    jobject blob_,
+    jint offset_,
+    jint size_,
+    jobjectArray paths_,
+    jboolean cbor_
+) {
+    char * out { nullptr };
+    size_t size { 0 };
+
+    if (!render (env_, session_, blob_, offset_, size_, paths_, cbor_, &out, &size)) {
+        return nullptr;
+    }
+
+    jbyteArray rtn = nullptr;
+
+    if (size > static_cast<size_t> (INT32_MAX)) {
+        raise (env_, "java/lang/OutOfMemoryError", "Too large for a Java array");
+    } else if ((rtn = env_->NewByteArray (static_cast<jsize> (size)))) {
+        env_->SetByteArrayRegion (rtn, 0, static_cast<jsize> (size), reinterpret_cast<const jbyte *> (out));
+    }
+
+    corda_amqp_free (out);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * Returns how many bytes were written or, if they wouldn't fit, how many
+ * would have been, negated
+ */
+JNIEXPORT jint JNICALL
+Java_net_corda_amqp_CordaAmqp_renderInto (
+    JNIEnv * env_,
+    jclass,
+    jlong session_,
+    jobject blob_,
+    jint offset_,
+    jint size_,
+    jobjectArray paths_,
+    jboolean cbor_,
+    jobject into_,
+    jint intoOffset_,
+    jint intoSize_
+) {
+    char * into = view (env_, into_, intoOffset_, intoSize_);
+    if (!into) return 0;
+
+    char * out { nullptr };
+    size_t size { 0 };
+
+    if (!render (env_, session_, blob_, offset_, size_, paths_, cbor_, &out, &size)) {
+        return 0;
+    }
+
+    jint rtn;
+
+    if (size > static_cast<size_t> (INT32_MAX)) {
+        raise (env_, "java/lang/OutOfMemoryError", "Too large for a Java buffer");
+        rtn = 0;
+    } else if (size > static_cast<size_t> (intoSize_)) {
+        rtn = -static_cast<jint> (size);
+    } else {
+        std::memcpy (into, out, size);
+        rtn = static_cast<jint> (size);
+    }
+
+    corda_amqp_free (out);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+}
+
+/******************************************************************************/
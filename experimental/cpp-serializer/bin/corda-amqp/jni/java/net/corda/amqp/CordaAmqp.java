@@ -0,0 +1,141 @@
+package net.corda.amqp;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.Objects;
+
+/**
+ * Decodes Corda's AMQP blobs natively, through libcorda_amqp, rather than
+ * through the Corda serialization stack, so nothing needs to be on the
+ * classpath beyond this class and no JVM objects are made for what's
+ * decoded.
+ *
+ * Blobs are read from direct ByteBuffers, a mapped file say, between their
+ * position and limit, which are left as they were. They're decoded where
+ * they lie, header and all, and rendered as JSON or CBOR, either whole or
+ * just the fields of a projection. What's rendered can be returned or,
+ * allocating nothing on the heap, written into another direct buffer.
+ *
+ * An instance holds a native session and must only be used by one thread
+ * at a time. Any number may be open at once, all of them sharing the
+ * process wide cache of compiled schemas. Close it when done.
+ */
+public final class CordaAmqp implements AutoCloseable {
+
+    static {
+        System.loadLibrary("corda_amqp_jni");
+    }
+
+    /**
+     * Thrown when a blob can't be decoded, with the reason the native
+     * decoder gave
+     */
+    public static final class DecodeException extends RuntimeException {
+        public DecodeException(String message) {
+            super(message);
+        }
+    }
+
+    public enum Format { JSON, CBOR }
+
+    private long session;
+
+    public CordaAmqp() {
+        session = open();
+
+        if (session == 0) throw new OutOfMemoryError("Failed to open a session");
+    }
+
+    @Override
+    public void close() {
+        if (session != 0) {
+            close(session);
+            session = 0;
+        }
+    }
+
+    /**
+     * Write objects a blob refers back to as <code>{ "$ref" : n }</code>
+     * rather than repeating them, off by default
+     */
+    public CordaAmqp pointers(boolean pointers) {
+        pointers(open(null), pointers);
+        return this;
+    }
+
+    /**
+     * The blob as a JSON object, its "Parsed" field holding its contents
+     */
+    public String json(ByteBuffer blob) {
+        return new String(render(blob, Format.JSON, null), StandardCharsets.UTF_8);
+    }
+
+    /**
+     * As {@link #json} but only decoding the dotted field {@code paths},
+     * "amount.quantity" say, and skipping everything else
+     */
+    public String project(ByteBuffer blob, String... paths) {
+        return new String(render(blob, Format.JSON, Objects.requireNonNull(paths)), StandardCharsets.UTF_8);
+    }
+
+    public byte[] cbor(ByteBuffer blob) {
+        return render(blob, Format.CBOR, null);
+    }
+
+    public byte[] projectCbor(ByteBuffer blob, String... paths) {
+        return render(blob, Format.CBOR, Objects.requireNonNull(paths));
+    }
+
+    /**
+     * Render the blob, or just its {@code paths} if any are given, into the
+     * direct buffer {@code into} from its position, UTF-8 encoded for JSON.
+     * Returns how many bytes were written, moving its position past them
+     * or, leaving {@code into} as it was, how many would have been, negated,
+     * should they not fit before its limit
+     */
+    public int render(ByteBuffer blob, ByteBuffer into, Format format, String... paths) {
+        direct(into);
+
+        int written = renderInto(
+                open(blob), blob, blob.position(), blob.remaining(),
+                paths.length == 0 ? null : paths, format == Format.CBOR,
+                into, into.position(), into.remaining());
+
+        if (written > 0) into.position(into.position() + written);
+
+        return written;
+    }
+
+    private byte[] render(ByteBuffer blob, Format format, String[] paths) {
+        return render(open(blob), blob, blob.position(), blob.remaining(), paths, format == Format.CBOR);
+    }
+
+    /**
+     * The session, once {@code blob} is known to be one that can be decoded
+     */
+    private long open(ByteBuffer blob) {
+        if (session == 0) throw new IllegalStateException("Closed");
+        if (blob != null) direct(blob);
+
+        return session;
+    }
+
+    private static void direct(ByteBuffer buffer) {
+        if (!Objects.requireNonNull(buffer).isDirect()) {
+            throw new IllegalArgumentException("Not a direct buffer");
+        }
+    }
+
+    private static native long open();
+
+    private static native void close(long session);
+
+    private static native void pointers(long session, boolean pointers);
+
+    private static native byte[] render(
+            long session, ByteBuffer blob, int offset, int size, String[] paths, boolean cbor);
+
+    private static native int renderInto(
+            long session, ByteBuffer blob, int offset, int size, String[] paths, boolean cbor,
+            ByteBuffer into, int intoOffset, int intoSize);
+}
@@ -0,0 +1,105 @@
+//
+// Run with the built library on java.library.path, from this directory:
+//
+//   java -Djava.library.path=<build>/bin/corda-amqp/jni \
+//       -cp <build>/bin/corda-amqp/jni/corda-amqp.jar CordaAmqpTest.java
+//
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardOpenOption;
+import java.util.Arrays;
+
+import net.corda.amqp.CordaAmqp;
+
+public class CordaAmqpTest {
+
+    private static final Path FILES = Paths.get("../../../test-files");
+
+    private static int failures = 0;
+
+    private static ByteBuffer blob(String name) throws IOException {
+        try (FileChannel channel = FileChannel.open(FILES.resolve(name), StandardOpenOption.READ)) {
+            return channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+        }
+    }
+
+    private static void check(boolean ok, String what) {
+        if (!ok) {
+            System.err.println("FAILED: " + what);
+            ++failures;
+        }
+    }
+
+    private static void json(CordaAmqp amqp) throws IOException {
+        check("{\"Parsed\":{\"a\":69}}".equals(amqp.json(blob("_i_"))), "json");
+        check("{\"Parsed\":{\"b\":{\"a\":2}}}".equals(amqp.project(blob("_i_is__"), "b.a")), "project");
+
+        // the buffer's position is where the blob starts
+        ByteBuffer offset = ByteBuffer.allocateDirect(1024);
+        offset.put(new byte[7]).put(blob("_i_")).flip().position(7);
+        check("{\"Parsed\":{\"a\":69}}".equals(amqp.json(offset)), "offset");
+        check(offset.position() == 7, "position kept");
+    }
+
+    private static void cbor(CordaAmqp amqp) throws IOException {
+        byte[] cbor = amqp.cbor(blob("_i_"));
+        byte[] expected = { (byte) 0xbf, 0x66, 'P', 'a', 'r', 's', 'e', 'd',
+                (byte) 0xbf, 0x61, 'a', 0x18, 0x45, (byte) 0xff, (byte) 0xff };
+
+        check(Arrays.equals(expected, cbor), "cbor");
+    }
+
+    private static void into(CordaAmqp amqp) throws IOException {
+        ByteBuffer out = ByteBuffer.allocateDirect(64);
+
+        int written = amqp.render(blob("_i_"), out, CordaAmqp.Format.JSON);
+        check(written == out.position(), "written");
+
+        out.flip();
+        byte[] bytes = new byte[out.remaining()];
+        out.get(bytes);
+        check("{\"Parsed\":{\"a\":69}}".equals(new String(bytes, StandardCharsets.UTF_8)), "into");
+
+        ByteBuffer small = ByteBuffer.allocateDirect(4);
+        check(amqp.render(blob("_i_"), small, CordaAmqp.Format.JSON) == -19, "too small");
+        check(small.position() == 0, "too small untouched");
+    }
+
+    private static void errors(CordaAmqp amqp) throws IOException {
+        try {
+            amqp.json(ByteBuffer.wrap(new byte[] { 1, 2, 3 }));
+            check(false, "heap buffer");
+        } catch (IllegalArgumentException e) {
+            // expected
+        }
+
+        ByteBuffer junk = ByteBuffer.allocateDirect(16);
+
+        try {
+            amqp.json(junk);
+            check(false, "junk");
+        } catch (CordaAmqp.DecodeException e) {
+            check(e.getMessage() != null && !e.getMessage().isEmpty(), "junk message");
+        }
+    }
+
+    public static void main(String[] args) throws IOException {
+        try (CordaAmqp amqp = new CordaAmqp()) {
+            json(amqp);
+            cbor(amqp);
+            into(amqp);
+            errors(amqp);
+        }
+
+        if (failures > 0) {
+            System.exit(1);
+        }
+
+        System.out.println("OK");
+    }
+}
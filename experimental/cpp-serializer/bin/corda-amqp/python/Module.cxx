@@ -0,0 +1,887 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include "corda_amqp.h"
+
+/******************************************************************************/
+
+/**
+ * The corda_amqp Python module, over libcorda_amqp's C interface.
+ *
+ * Blobs are taken through the buffer protocol so bytes, bytearrays,
+ * memoryviews and mmaps are all decoded where they lie, never copied.
+ * [decode] builds dicts, lists and scalars straight from the visitor
+ * callbacks, [tape] decodes into a tape and hands back a [Value] that
+ * only turns what's asked for into Python objects and [json] renders
+ * JSON. Only [decode] holds the GIL while decoding.
+ */
+
+/******************************************************************************/
+
+namespace {
+
+    PyObject * g_error { nullptr };
+
+    /**
+     * Each thread decodes through a session of its own
+     */
+    corda_amqp_session *
+    session() {
+        struct Session {
+            corda_amqp_session * m_session { corda_amqp_open() };
+            ~Session() { corda_amqp_close (m_session); }
+        };
+
+        static thread_local Session s;
+
+        return s.m_session;
+    }
+
+    PyObject *
+    fail (corda_amqp_session * session_) {
+        PyErr_SetString (g_error, corda_amqp_error (session_));
+        return nullptr;
+    }
+
+    /**
+     * A view of a Python object's bytes, released when done with
+     */
+    struct Buffer {
+        Py_buffer m_view { };
+        bool m_held { false };
+
+        Buffer() = default;
+        Buffer (const Buffer &) = delete;
+
+        ~Buffer() { release(); }
+
+        bool acquire (PyObject * object_) {
+            m_held = PyObject_GetBuffer (object_, &m_view, PyBUF_SIMPLE) == 0;
+            return m_held;
+        }
+
+        void release() {
+            if (m_held) PyBuffer_Release (&m_view);
+            m_held = false;
+        }
+
+        const void * data() const { return m_view.buf; }
+        size_t size() const { return static_cast<size_t> (m_view.len); }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * decode
+ *
+ ******************************************************************************/
+
+namespace {
+
+    /**
+     * Builds Python objects from the visitor's callbacks. Composites and
+     * maps become dicts and lists lists, a property that's null never
+     * being visited is left None. Once anything fails the rest of the
+     * walk is ignored and the Python error left set
+     */
+    class Builder {
+        private :
+            struct Frame {
+                PyObject * m_container;
+                char m_kind;
+
+                /**
+                 * The property, or map key, awaiting its value
+                 */
+                PyObject * m_key;
+            };
+
+            std::vector<Frame> m_stack;
+            bool m_failed { false };
+
+            bool failed (PyObject * made_) {
+                if (!made_) m_failed = true;
+                return m_failed;
+            }
+
+            void add (PyObject * value_) {
+                if (m_failed || failed (value_)) {
+                    Py_XDECREF (value_);
+                    return;
+                }
+
+                auto & top = m_stack.back();
+
+                if (top.m_kind == 'l') {
+                    failed (PyList_Append (top.m_container, value_) == 0 ? value_ : nullptr);
+                } else if (top.m_kind == 'm' && !top.m_key) {
+                    top.m_key = value_;
+                    return;
+                } else if (top.m_key) {
+                    failed (PyDict_SetItem (top.m_container, top.m_key, value_) == 0 ? value_ : nullptr);
+                    Py_CLEAR (top.m_key);
+                }
+
+                Py_DECREF (value_);
+            }
+
+            void push (PyObject * container_, char kind_) {
+                if (m_failed || failed (container_)) {
+                    Py_XDECREF (container_);
+                    // keep the stack balanced for the matching end
+                    m_stack.push_back ({ nullptr, kind_, nullptr });
+                    return;
+                }
+
+                m_stack.push_back ({ container_, kind_, nullptr });
+            }
+
+            void pop() {
+                auto frame = m_stack.back();
+                m_stack.pop_back();
+
+                if (frame.m_kind == 'c' && frame.m_key && !m_failed) {
+                    Py_INCREF (Py_None);
+                    failed (PyDict_SetItem (frame.m_container, frame.m_key, Py_None) == 0
+                            ? Py_None : nullptr);
+                    Py_DECREF (Py_None);
+                }
+
+                Py_XDECREF (frame.m_key);
+
+                if (m_stack.empty()) {
+                    // the root's kept for [result]
+                    m_stack.push_back ({ frame.m_container, 'r', nullptr });
+                } else if (frame.m_container) {
+                    add (frame.m_container);
+                }
+            }
+
+            static Builder & self (void * context_) { return *static_cast<Builder *> (context_); }
+
+            static void
+            text (void * context_, const char * value_, size_t size_) {
+                self (context_).add (PyUnicode_DecodeUTF8 (
+                        value_, static_cast<Py_ssize_t> (size_), "replace"));
+            }
+
+            static void
+            bytes (void * context_, const char * value_, size_t size_) {
+                self (context_).add (PyBytes_FromStringAndSize (
+                        value_, static_cast<Py_ssize_t> (size_)));
+            }
+
+        public :
+            /**
+             * The walk starts with the "Parsed" property of an object
+             * that's never begun
+             */
+            Builder() {
+                push (PyDict_New(), 'c');
+            }
+
+            Builder (const Builder &) = delete;
+
+            ~Builder() {
+                for (auto & frame : m_stack) {
+                    Py_XDECREF (frame.m_container);
+                    Py_XDECREF (frame.m_key);
+                }
+            }
+
+            /**
+             * What "Parsed" held, null with the error set if building it
+             * failed
+             */
+            PyObject * result() {
+                if (m_failed) return nullptr;
+
+                if (m_stack.size() == 1 && m_stack.front().m_kind == 'c') {
+                    pop();
+                }
+
+                if (m_stack.size() != 1 || !m_stack.front().m_container) {
+                    PyErr_SetString (g_error, "Blob's contents ended part way through");
+                    return nullptr;
+                }
+
+                auto * rtn = PyDict_GetItemString (m_stack.front().m_container, "Parsed");
+
+                if (!rtn) {
+                    PyErr_SetString (g_error, "Blob has no contents");
+                    return nullptr;
+                }
+
+                Py_INCREF (rtn);
+                return rtn;
+            }
+
+            corda_amqp_visitor visitor() {
+                corda_amqp_visitor rtn { };
+
+                rtn.context = this;
+
+                rtn.on_begin_composite = [](void * c_, const char *, size_t) {
+                    self (c_).push (PyDict_New(), 'c');
+                };
+                rtn.on_end_composite = [](void * c_) { self (c_).pop(); };
+
+                rtn.on_field = [](void * c_, const char * name_, size_t size_) {
+                    auto & b = self (c_);
+                    if (b.m_failed) return;
+
+                    auto & top = b.m_stack.back();
+
+                    // the last property was null
+                    if (top.m_key) {
+                        Py_INCREF (Py_None);
+                        b.add (Py_None);
+                    }
+
+                    top.m_key = PyUnicode_DecodeUTF8 (name_, static_cast<Py_ssize_t> (size_), "replace");
+                    b.failed (top.m_key);
+                };
+
+                rtn.on_begin_list = [](void * c_, size_t) { self (c_).push (PyList_New (0), 'l'); };
+                rtn.on_end_list = [](void * c_) { self (c_).pop(); };
+                rtn.on_begin_map = [](void * c_, size_t) { self (c_).push (PyDict_New(), 'm'); };
+                rtn.on_end_map = [](void * c_) { self (c_).pop(); };
+
+                rtn.on_bool = [](void * c_, int v_) { self (c_).add (PyBool_FromLong (v_)); };
+                rtn.on_int = [](void * c_, int32_t v_) { self (c_).add (PyLong_FromLong (v_)); };
+                rtn.on_long = [](void * c_, int64_t v_) { self (c_).add (PyLong_FromLongLong (v_)); };
+                rtn.on_double = [](void * c_, double v_) { self (c_).add (PyFloat_FromDouble (v_)); };
+                rtn.on_string = text;
+
+                rtn.on_char = [](void * c_, uint32_t v_) {
+                    self (c_).add (PyUnicode_FromOrdinal (static_cast<int> (v_)));
+                };
+                rtn.on_short = [](void * c_, int16_t v_) { self (c_).add (PyLong_FromLong (v_)); };
+                rtn.on_byte = [](void * c_, int8_t v_) { self (c_).add (PyLong_FromLong (v_)); };
+                rtn.on_float = [](void * c_, float v_) { self (c_).add (PyFloat_FromDouble (v_)); };
+                rtn.on_timestamp = [](void * c_, int64_t v_) { self (c_).add (PyLong_FromLongLong (v_)); };
+                rtn.on_uuid = bytes;
+                rtn.on_decimal128 = bytes;
+                rtn.on_symbol = text;
+                rtn.on_enum = text;
+                rtn.on_binary = bytes;
+
+                return rtn;
+            }
+    };
+
+}
+
+/******************************************************************************/
+
+static PyObject *
+decode (PyObject *, PyObject * blob_) {
+    Buffer buffer;
+    if (!buffer.acquire (blob_)) return nullptr;
+
+    Builder builder;
+    auto visitor = builder.visitor();
+
+    auto * s = session();
+
+    if (corda_amqp_visit (s, buffer.data(), buffer.size(), &visitor) != CORDA_AMQP_OK) {
+        // a failure building the objects takes precedence
+        return PyErr_Occurred() ? nullptr : fail (s);
+    }
+
+    return builder.result();
+}
+
+/******************************************************************************
+ *
+ * json
+ *
+ ******************************************************************************/
+
+static PyObject *
+json (PyObject *, PyObject * args_, PyObject * kwargs_) {
+    static const char * keywords[] { "blob", "paths", "pointers", nullptr };
+
+    PyObject * blob { nullptr };
+    PyObject * paths { Py_None };
+    int pointers { 0 };
+
+    if (!PyArg_ParseTupleAndKeywords (
+            args_, kwargs_, "O|Op", const_cast<char **> (keywords), &blob, &paths, &pointers))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::string> strings;
+
+    if (paths != Py_None) {
+        PyObject * sequence = PySequence_Fast (paths, "paths must be a sequence of strings");
+        if (!sequence) return nullptr;
+
+        for (Py_ssize_t i { 0 } ; i < PySequence_Fast_GET_SIZE (sequence) ; ++i) {
+            const char * path = PyUnicode_AsUTF8 (PySequence_Fast_GET_ITEM (sequence, i));
+
+            if (!path) {
+                Py_DECREF (sequence);
+                return nullptr;
+            }
+
+            strings.emplace_back (path);
+        }
+
+        Py_DECREF (sequence);
+    }
+
+    std::vector<const char *> cpaths;
+    for (const auto & path : strings) cpaths.push_back (path.c_str());
+
+    Buffer buffer;
+    if (!buffer.acquire (blob)) return nullptr;
+
+    auto * s = session();
+    corda_amqp_pointers (s, pointers);
+
+    char * out { nullptr };
+    size_t size { 0 };
+    int rc;
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = paths == Py_None
+        ? corda_amqp_decode_json (s, buffer.data(), buffer.size(), &out, &size)
+        : corda_amqp_project_json (s, buffer.data(), buffer.size(),
+                cpaths.data(), cpaths.size(), &out, &size);
+    Py_END_ALLOW_THREADS
+
+    corda_amqp_pointers (s, 0);
+
+    if (rc != CORDA_AMQP_OK) return fail (s);
+
+    auto * rtn = PyUnicode_DecodeUTF8 (out, static_cast<Py_ssize_t> (size), "replace");
+    corda_amqp_free (out);
+
+    return rtn;
+}
+
+/******************************************************************************
+ *
+ * tape
+ *
+ ******************************************************************************/
+
+namespace {
+
+    /**
+     * A decoded tape and the blob it refers into, shared by every [Value]
+     * taken from it
+     */
+    struct Owned {
+        Buffer m_buffer;
+        corda_amqp_tape * m_tape { nullptr };
+
+        const uint64_t * m_words { nullptr };
+        size_t m_count { 0 };
+
+        const char * m_text { nullptr };
+        size_t m_textSize { 0 };
+
+        /**
+         * The blob sans its 8 byte header, which text offsets are from
+         */
+        const char * m_payload { nullptr };
+        size_t m_payloadSize { 0 };
+
+        ~Owned() { corda_amqp_tape_free (m_tape); }
+    };
+
+    constexpr int TYPE_SHIFT = 56;
+    constexpr uint64_t PAYLOAD = (uint64_t { 1 } << TYPE_SHIFT) - 1;
+
+    char type (const Owned & o_, size_t i_) { return static_cast<char> (o_.m_words[i_] >> TYPE_SHIFT); }
+
+    bool
+    compound (char type_) {
+        return type_ == '{' || type_ == '[' || type_ == '(';
+    }
+
+    /**
+     * The token after the value at [i_], children and all
+     */
+    size_t
+    next (const Owned & o_, size_t i_) {
+        switch (type (o_, i_)) {
+            case '{' : case '[' : case '(' : return (o_.m_words[i_] & PAYLOAD) + 1;
+            case 'k' : case 's' : case 'e' : case 'x' : case 'i' : case 'd' : return i_ + 2;
+            default : return i_ + 1;
+        }
+    }
+
+    size_t end (const Owned & o_, size_t i_) { return o_.m_words[i_] & PAYLOAD; }
+
+    PyObject *
+    text (const Owned & o_, size_t i_, bool bytes_) {
+        auto offset = o_.m_words[i_] & PAYLOAD;
+        auto length = o_.m_words[i_ + 1];
+
+        const char * at;
+
+        if (offset < o_.m_payloadSize && length <= o_.m_payloadSize - offset) {
+            at = o_.m_payload + offset;
+        } else if (offset >= o_.m_payloadSize
+            && offset - o_.m_payloadSize <= o_.m_textSize
+            && length <= o_.m_textSize - (offset - o_.m_payloadSize))
+        {
+            at = o_.m_text + (offset - o_.m_payloadSize);
+        } else {
+            PyErr_SetString (g_error, "Tape text out of range");
+            return nullptr;
+        }
+
+        return bytes_
+            ? PyBytes_FromStringAndSize (at, static_cast<Py_ssize_t> (length))
+            : PyUnicode_DecodeUTF8 (at, static_cast<Py_ssize_t> (length), "replace");
+    }
+
+    /**
+     * Everything at [i_] as Python objects
+     */
+    PyObject *
+    materialise (const Owned & o_, size_t i_) {
+        switch (type (o_, i_)) {
+            case '{' : {
+                PyObject * rtn = PyDict_New();
+                if (!rtn) return nullptr;
+
+                for (size_t k { i_ + 2 } ; k < end (o_, i_) ; ) {
+                    auto v = next (o_, k);
+
+                    PyObject * key = text (o_, k, false);
+                    PyObject * value = key ? materialise (o_, v) : nullptr;
+
+                    if (!value || PyDict_SetItem (rtn, key, value) != 0) {
+                        Py_XDECREF (key);
+                        Py_XDECREF (value);
+                        Py_DECREF (rtn);
+                        return nullptr;
+                    }
+
+                    Py_DECREF (key);
+                    Py_DECREF (value);
+
+                    k = next (o_, v);
+                }
+
+                return rtn;
+            }
+            case '[' : {
+                PyObject * rtn = PyList_New (0);
+                if (!rtn) return nullptr;
+
+                for (size_t k { i_ + 2 } ; k < end (o_, i_) ; k = next (o_, k)) {
+                    PyObject * value = materialise (o_, k);
+
+                    if (!value || PyList_Append (rtn, value) != 0) {
+                        Py_XDECREF (value);
+                        Py_DECREF (rtn);
+                        return nullptr;
+                    }
+
+                    Py_DECREF (value);
+                }
+
+                return rtn;
+            }
+            case '(' : {
+                PyObject * rtn = PyDict_New();
+                if (!rtn) return nullptr;
+
+                for (size_t k { i_ + 2 } ; k < end (o_, i_) ; ) {
+                    auto v = next (o_, k);
+
+                    PyObject * key = materialise (o_, k);
+                    PyObject * value = key ? materialise (o_, v) : nullptr;
+
+                    if (!value || PyDict_SetItem (rtn, key, value) != 0) {
+                        Py_XDECREF (key);
+                        Py_XDECREF (value);
+                        Py_DECREF (rtn);
+                        return nullptr;
+                    }
+
+                    Py_DECREF (key);
+                    Py_DECREF (value);
+
+                    k = next (o_, v);
+                }
+
+                return rtn;
+            }
+            case 'n' : Py_RETURN_NONE;
+            case 'b' : return PyBool_FromLong ((o_.m_words[i_] & PAYLOAD) != 0);
+            case 'i' : return PyLong_FromLongLong (static_cast<int64_t> (o_.m_words[i_ + 1]));
+            case 'd' : {
+                double value;
+                std::memcpy (&value, &o_.m_words[i_ + 1], sizeof (value));
+                return PyFloat_FromDouble (value);
+            }
+            case 'k' : case 's' : case 'e' : return text (o_, i_, false);
+            case 'x' : return text (o_, i_, true);
+            default :
+                PyErr_SetString (g_error, "Unexpected token on the tape");
+                return nullptr;
+        }
+    }
+
+    /**************************************************************************/
+
+    struct Value {
+        PyObject_HEAD
+
+        /**
+         * A capsule holding the [Owned]
+         */
+        PyObject * m_owner;
+        size_t m_index;
+    };
+
+    PyTypeObject ValueType = { PyVarObject_HEAD_INIT (nullptr, 0) };
+
+    const Owned &
+    owned (const Value * v_) {
+        return *static_cast<Owned *> (PyCapsule_GetPointer (v_->m_owner, "corda_amqp.tape"));
+    }
+
+    /**
+     * Compounds are wrapped, anything else converted there and then
+     */
+    PyObject *
+    wrap (PyObject * owner_, size_t i_) {
+        const auto & o = *static_cast<Owned *> (PyCapsule_GetPointer (owner_, "corda_amqp.tape"));
+
+        if (!compound (type (o, i_))) return materialise (o, i_);
+
+        auto * rtn = PyObject_New (Value, &ValueType);
+        if (!rtn) return nullptr;
+
+        Py_INCREF (owner_);
+        rtn->m_owner = owner_;
+        rtn->m_index = i_;
+
+        return reinterpret_cast<PyObject *> (rtn);
+    }
+
+    void
+    Value_dealloc (Value * self_) {
+        Py_XDECREF (self_->m_owner);
+        PyObject_Free (self_);
+    }
+
+    Py_ssize_t
+    Value_length (Value * self_) {
+        const auto & o = owned (self_);
+        auto size = static_cast<Py_ssize_t> (o.m_words[self_->m_index + 1]);
+
+        // a map counts its keys and values separately
+        return type (o, self_->m_index) == '(' ? size / 2 : size;
+    }
+
+    /**
+     * The keys, values or both, of an object or map, as a list. A list's
+     * elements count as its values
+     */
+    PyObject *
+    entries (Value * self_, bool keys_, bool values_) {
+        const auto & o = owned (self_);
+        const auto i = self_->m_index;
+        const auto t = type (o, i);
+
+        PyObject * rtn = PyList_New (0);
+        if (!rtn) return nullptr;
+
+        for (size_t k { i + 2 } ; k < end (o, i) ; ) {
+            PyObject * item;
+
+            if (t == '[') {
+                item = values_ ? wrap (self_->m_owner, k) : nullptr;
+                k = next (o, k);
+            } else {
+                auto v = next (o, k);
+
+                PyObject * key = keys_ ? (t == '{' ? text (o, k, false) : materialise (o, k)) : nullptr;
+                PyObject * value = values_ ? wrap (self_->m_owner, v) : nullptr;
+
+                if ((keys_ && !key) || (values_ && !value)) {
+                    Py_XDECREF (key);
+                    Py_XDECREF (value);
+                    item = nullptr;
+                } else if (keys_ && values_) {
+                    item = PyTuple_Pack (2, key, value);
+                    Py_DECREF (key);
+                    Py_DECREF (value);
+                } else {
+                    item = keys_ ? key : value;
+                }
+
+                k = next (o, v);
+            }
+
+            if (!item || PyList_Append (rtn, item) != 0) {
+                Py_XDECREF (item);
+                Py_DECREF (rtn);
+                return nullptr;
+            }
+
+            Py_DECREF (item);
+        }
+
+        return rtn;
+    }
+
+    PyObject *
+    Value_subscript (Value * self_, PyObject * key_) {
+        const auto & o = owned (self_);
+        const auto i = self_->m_index;
+        const auto t = type (o, i);
+
+        if (t == '[') {
+            auto n = PyNumber_AsSsize_t (key_, PyExc_IndexError);
+            if (n == -1 && PyErr_Occurred()) return nullptr;
+
+            auto length = Value_length (self_);
+            if (n < 0) n += length;
+
+            if (n < 0 || n >= length) {
+                PyErr_SetString (PyExc_IndexError, "list index out of range");
+                return nullptr;
+            }
+
+            size_t k { i + 2 };
+            for (; n > 0 ; --n) k = next (o, k);
+
+            return wrap (self_->m_owner, k);
+        }
+
+        for (size_t k { i + 2 } ; k < end (o, i) ; ) {
+            auto v = next (o, k);
+
+            PyObject * key = t == '{' ? text (o, k, false) : materialise (o, k);
+            if (!key) return nullptr;
+
+            int equal = PyObject_RichCompareBool (key, key_, Py_EQ);
+            Py_DECREF (key);
+
+            if (equal < 0) return nullptr;
+            if (equal) return wrap (self_->m_owner, v);
+
+            k = next (o, v);
+        }
+
+        PyErr_SetObject (PyExc_KeyError, key_);
+        return nullptr;
+    }
+
+    PyObject *
+    Value_iter (Value * self_) {
+        PyObject * list = entries (self_, type (owned (self_), self_->m_index) != '[', false);
+        if (!list) return nullptr;
+
+        PyObject * rtn = PyObject_GetIter (list);
+        Py_DECREF (list);
+
+        return rtn;
+    }
+
+    PyObject *
+    Value_repr (Value * self_) {
+        const char * kinds[] { "object", "list", "map" };
+        auto t = type (owned (self_), self_->m_index);
+
+        return PyUnicode_FromFormat (
+                "<corda_amqp.Value %s of %zd>",
+                kinds[t == '{' ? 0 : t == '[' ? 1 : 2],
+                Value_length (self_));
+    }
+
+    PyObject * Value_keys (Value * self_, PyObject *) { return entries (self_, true, false); }
+    PyObject * Value_values (Value * self_, PyObject *) { return entries (self_, false, true); }
+    PyObject * Value_items (Value * self_, PyObject *) { return entries (self_, true, true); }
+
+    PyObject *
+    Value_value (Value * self_, PyObject *) {
+        return materialise (owned (self_), self_->m_index);
+    }
+
+    PyMethodDef ValueMethods[] {
+        { "keys", reinterpret_cast<PyCFunction> (Value_keys), METH_NOARGS,
+          "The keys of an object or map" },
+        { "values", reinterpret_cast<PyCFunction> (Value_values), METH_NOARGS,
+          "The values of an object or map, or a list's elements" },
+        { "items", reinterpret_cast<PyCFunction> (Value_items), METH_NOARGS,
+          "(key, value) pairs of an object or map" },
+        { "value", reinterpret_cast<PyCFunction> (Value_value), METH_NOARGS,
+          "Everything beneath this value converted to dicts, lists and scalars" },
+        { nullptr, nullptr, 0, nullptr }
+    };
+
+    PyMappingMethods ValueMapping {
+        reinterpret_cast<lenfunc> (Value_length),
+        reinterpret_cast<binaryfunc> (Value_subscript),
+        nullptr
+    };
+
+    void
+    freeOwned (PyObject * capsule_) {
+        delete static_cast<Owned *> (PyCapsule_GetPointer (capsule_, "corda_amqp.tape"));
+    }
+
+}
+
+/******************************************************************************/
+
+static PyObject *
+tape (PyObject *, PyObject * blob_) {
+    auto * owned = new Owned;
+
+    if (!owned->m_buffer.acquire (blob_)) {
+        delete owned;
+        return nullptr;
+    }
+
+    auto * s = session();
+    int rc;
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = corda_amqp_decode_tape (s, owned->m_buffer.data(), owned->m_buffer.size(), &owned->m_tape);
+    Py_END_ALLOW_THREADS
+
+    if (rc != CORDA_AMQP_OK) {
+        delete owned;
+        return fail (s);
+    }
+
+    owned->m_words = corda_amqp_tape_words (owned->m_tape, &owned->m_count);
+    owned->m_text = corda_amqp_tape_text (owned->m_tape, &owned->m_textSize);
+    owned->m_payload = static_cast<const char *> (owned->m_buffer.data()) + 8;
+    owned->m_payloadSize = owned->m_buffer.size() - 8;
+
+    if (owned->m_count == 0 || type (*owned, 0) != '{') {
+        delete owned;
+        PyErr_SetString (g_error, "Blob decoded to an empty tape");
+        return nullptr;
+    }
+
+    PyObject * capsule = PyCapsule_New (owned, "corda_amqp.tape", freeOwned);
+
+    if (!capsule) {
+        delete owned;
+        return nullptr;
+    }
+
+    // the tape's root is { "Parsed" : ... }, hand back what it holds
+    PyObject * root = wrap (capsule, 0);
+    Py_DECREF (capsule);
+
+    if (!root) return nullptr;
+
+    PyObject * key = PyUnicode_FromString ("Parsed");
+    PyObject * rtn = key ? Value_subscript (reinterpret_cast<Value *> (root), key) : nullptr;
+
+    Py_XDECREF (key);
+    Py_DECREF (root);
+
+    return rtn;
+}
+
+/******************************************************************************
+ *
+ * The schema cache
+ *
+ ******************************************************************************/
+
+static PyObject *
+cache_stats (PyObject *, PyObject *) {
+    size_t entries { 0 }, hits { 0 }, misses { 0 };
+    corda_amqp_cache_stats (&entries, &hits, &misses);
+
+    return Py_BuildValue ("{s:n,s:n,s:n}",
+            "entries", static_cast<Py_ssize_t> (entries),
+            "hits", static_cast<Py_ssize_t> (hits),
+            "misses", static_cast<Py_ssize_t> (misses));
+}
+
+/******************************************************************************/
+
+namespace {
+
+    PyMethodDef Methods[] {
+        { "decode", decode, METH_O,
+          "decode(blob)\n\n"
+          "The blob's contents as dicts, lists and scalars, built as it's decoded" },
+        { "json", reinterpret_cast<PyCFunction> (reinterpret_cast<void (*)()> (json)),
+          METH_VARARGS | METH_KEYWORDS,
+          "json(blob, paths=None, pointers=False)\n\n"
+          "The blob as JSON, only the dotted field paths given if any" },
+        { "tape", tape, METH_O,
+          "tape(blob)\n\n"
+          "The blob's contents decoded into a tape, a Value turning only what's asked\n"
+          "for into Python objects. The blob is referred to, not copied" },
+        { "cache_stats", cache_stats, METH_NOARGS,
+          "cache_stats()\n\n"
+          "How many schemas are compiled and how often one was or wasn't" },
+        { nullptr, nullptr, 0, nullptr }
+    };
+
+    PyModuleDef Module {
+        PyModuleDef_HEAD_INIT,
+        "corda_amqp",
+        "Decodes Corda AMQP blobs in process, without copying them",
+        -1,
+        Methods,
+        nullptr, nullptr, nullptr, nullptr
+    };
+
+}
+
+/******************************************************************************/
+
+PyMODINIT_FUNC
+PyInit_corda_amqp() {
+    ValueType.tp_name = "corda_amqp.Value";
+    ValueType.tp_basicsize = sizeof (Value);
+    ValueType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ValueType.tp_doc = "An object, list or map on a decoded tape";
+    ValueType.tp_dealloc = reinterpret_cast<destructor> (Value_dealloc);
+    ValueType.tp_repr = reinterpret_cast<reprfunc> (Value_repr);
+    ValueType.tp_iter = reinterpret_cast<getiterfunc> (Value_iter);
+    ValueType.tp_as_mapping = &ValueMapping;
+    ValueType.tp_methods = ValueMethods;
+
+    if (PyType_Ready (&ValueType) < 0) return nullptr;
+
+    PyObject * module = PyModule_Create (&Module);
+    if (!module) return nullptr;
+
+    g_error = PyErr_NewException ("corda_amqp.Error", PyExc_ValueError, nullptr);
+
+    Py_INCREF (&ValueType);
+
+    if (!g_error
+        || PyModule_AddObject (module, "Error", g_error) != 0
+        || PyModule_AddObject (module, "Value", reinterpret_cast<PyObject *> (&ValueType)) != 0)
+    {
+        Py_XDECREF (g_error);
+        Py_DECREF (&ValueType);
+        Py_DECREF (module);
+        return nullptr;
+    }
+
+    Py_INCREF (g_error);
+
+    return module;
+}
+
+/******************************************************************************/
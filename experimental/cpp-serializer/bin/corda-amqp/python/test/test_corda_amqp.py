@@ -0,0 +1,84 @@
+#
+# Run with the built module on the path, from this directory:
+#
+#   PYTHONPATH=<build>/bin/corda-amqp/python python3 -m unittest test_corda_amqp
+#
+
+import json
+import mmap
+import os
+import unittest
+
+import corda_amqp
+
+FILES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../../test-files")
+
+
+def blob(name):
+    with open(os.path.join(FILES, name), "rb") as f:
+        return f.read()
+
+
+class Decode(unittest.TestCase):
+    def test_native(self):
+        self.assertEqual({"a": 69}, corda_amqp.decode(blob("_i_")))
+        self.assertEqual({"a": 1, "b": {"a": 2, "b": "three"}}, corda_amqp.decode(blob("_i_is__")))
+        self.assertEqual({"a": [1, 2, 3, 4, 5, 6]}, corda_amqp.decode(blob("_Li_")))
+        self.assertEqual({"a": {1: "two", 3: "four", 5: "six"}}, corda_amqp.decode(blob("_Mis_")))
+        self.assertEqual({"listy": ["A", "B", "C"]}, corda_amqp.decode(blob("_Le_")))
+        self.assertEqual({"x": 100000000000}, corda_amqp.decode(blob("_l_")))
+
+    def test_buffers(self):
+        b = blob("__i_LMis_l__")
+        expected = corda_amqp.decode(b)
+
+        self.assertEqual(expected, corda_amqp.decode(bytearray(b)))
+        self.assertEqual(expected, corda_amqp.decode(memoryview(b)))
+
+        with open(os.path.join(FILES, "__i_LMis_l__"), "rb") as f:
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+                self.assertEqual(expected, corda_amqp.decode(m))
+
+    def test_errors(self):
+        with self.assertRaises(corda_amqp.Error):
+            corda_amqp.decode(b"not a blob")
+        with self.assertRaises(corda_amqp.Error):
+            corda_amqp.tape(blob("_i_")[:12])
+        with self.assertRaises(TypeError):
+            corda_amqp.decode("a str has no buffer")
+
+
+class Json(unittest.TestCase):
+    def test_json(self):
+        self.assertEqual('{"Parsed":{"a":69}}', corda_amqp.json(blob("_i_")))
+        self.assertEqual({"Parsed": {"b": {"a": 2}}},
+                         json.loads(corda_amqp.json(blob("_i_is__"), paths=["b.a"])))
+
+
+class Tape(unittest.TestCase):
+    def test_lazy(self):
+        b = blob("__i_LMis_l__")
+        root = corda_amqp.tape(memoryview(b))
+
+        self.assertIsInstance(root, corda_amqp.Value)
+        self.assertEqual(["x", "y", "z"], sorted(root.keys()))
+        self.assertEqual(3, len(root))
+        self.assertEqual(2, len(root["x"]))
+        self.assertEqual("four", root["x"][0][3])
+        self.assertEqual("ten", root["x"][-1][9])
+        self.assertEqual(1000000, root["y"]["x"])
+        self.assertEqual(corda_amqp.decode(b), root.value())
+
+        with self.assertRaises(KeyError):
+            root["nope"]
+        with self.assertRaises(IndexError):
+            root["x"][2]
+
+    def test_outlives(self):
+        # values keep what they were taken from alive
+        inner = corda_amqp.tape(bytes(blob("_Pls_")))["a"]
+        self.assertEqual({"first": 1, "second": "two"}, dict(inner.items()))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,310 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "corda_amqp.h"
+
+/******************************************************************************/
+
+extern "C" int decode_in_c (const void *, size_t, char **);
+
+/******************************************************************************/
+
+const std::string filepath ("../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    std::vector<char>
+    blob (const std::string & file_) {
+        std::ifstream in (filepath + file_, std::ios::binary);
+        return { std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char>() };
+    }
+
+    /**
+     * Closes the session it opens
+     */
+    struct Session {
+        corda_amqp_session * m_session { corda_amqp_open() };
+        ~Session() { corda_amqp_close (m_session); }
+    };
+
+    std::string
+    json (corda_amqp_session * session_, const std::vector<char> & blob_) {
+        char * json { nullptr };
+        size_t size { 0 };
+
+        EXPECT_EQ (CORDA_AMQP_OK, corda_amqp_decode_json (
+                session_, blob_.data(), blob_.size(), &json, &size)) << corda_amqp_error (session_);
+
+        std::string rtn (json ? json : "", size);
+        corda_amqp_free (json);
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, json) { // NOLINT
+    Session s;
+
+    EXPECT_EQ (CORDA_AMQP_VERSION, corda_amqp_version());
+    EXPECT_EQ (R"({"Parsed":{"a":69}})", json (s.m_session, blob ("_i_")));
+    EXPECT_EQ (R"({"Parsed":{"a":1,"b":{"a":2,"b":"three"}}})", json (s.m_session, blob ("_i_is__")));
+    EXPECT_STREQ ("", corda_amqp_error (s.m_session));
+
+    auto b = blob ("_i_");
+    char * fromC { nullptr };
+    EXPECT_EQ (CORDA_AMQP_OK, decode_in_c (b.data(), b.size(), &fromC));
+    EXPECT_STREQ (R"({"Parsed":{"a":69}})", fromC);
+    corda_amqp_free (fromC);
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, project) { // NOLINT
+    Session s;
+    auto b = blob ("_i_is__");
+
+    const char * paths[] { "b.a" };
+    char * json { nullptr };
+
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_project_json (
+            s.m_session, b.data(), b.size(), paths, 1, &json, nullptr));
+    EXPECT_STREQ (R"({"Parsed":{"b":{"a":2}}})", json);
+    corda_amqp_free (json);
+
+    const char * missing[] { "nope" };
+    EXPECT_EQ (CORDA_AMQP_EDECODE, corda_amqp_project_json (
+            s.m_session, b.data(), b.size(), missing, 1, &json, nullptr));
+    EXPECT_STRNE ("", corda_amqp_error (s.m_session));
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, cbor) { // NOLINT
+    Session s;
+    auto b = blob ("_i_is__");
+
+    char * cbor { nullptr };
+    size_t size { 0 };
+
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_decode_cbor (
+            s.m_session, b.data(), b.size(), &cbor, &size)) << corda_amqp_error (s.m_session);
+
+    // { "Parsed" : { "a" : 1, "b" : { "a" : 2, "b" : "three" } } }, every map indefinite
+    const std::string expected {
+        "\xbf\x66Parsed\xbf\x61""a\x01\x61""b\xbf\x61""a\x02\x61""b\x65three\xff\xff\xff", 29 };
+
+    EXPECT_EQ (expected, std::string (cbor, size));
+    corda_amqp_free (cbor);
+
+    const char * paths[] { "b.a" };
+
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_project_cbor (
+            s.m_session, b.data(), b.size(), paths, 1, &cbor, &size));
+    EXPECT_EQ (std::string ("\xbf\x66Parsed\xbf\x61""b\xbf\x61""a\x02\xff\xff\xff", 18), std::string (cbor, size));
+    corda_amqp_free (cbor);
+
+    // there's no telling where CBOR ends without its size
+    EXPECT_EQ (CORDA_AMQP_EINVAL, corda_amqp_decode_cbor (
+            s.m_session, b.data(), b.size(), &cbor, nullptr));
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, errors) { // NOLINT
+    Session s;
+    char * json { nullptr };
+    const char junk[] { "not a corda blob" };
+
+    EXPECT_EQ (CORDA_AMQP_EFORMAT, corda_amqp_decode_json (
+            s.m_session, junk, sizeof (junk), &json, nullptr));
+    EXPECT_STREQ ("Not a Corda stream", corda_amqp_error (s.m_session));
+
+    EXPECT_EQ (CORDA_AMQP_EINVAL, corda_amqp_decode_json (
+            s.m_session, nullptr, 0, &json, nullptr));
+    EXPECT_EQ (CORDA_AMQP_EINVAL, corda_amqp_decode_json (
+            nullptr, junk, sizeof (junk), &json, nullptr));
+
+    // cut short part way through the payload
+    auto b = blob ("_i_is__");
+    EXPECT_EQ (CORDA_AMQP_EDECODE, corda_amqp_decode_json (
+            s.m_session, b.data(), b.size() / 2, &json, nullptr));
+    EXPECT_EQ (nullptr, json);
+}
+
+/******************************************************************************/
+
+namespace {
+
+    struct Counts {
+        int m_composites { 0 };
+        int m_fields { 0 };
+        std::vector<int32_t> m_ints;
+        std::vector<std::string> m_strings;
+    };
+
+}
+
+TEST (CordaAmqp, visit) { // NOLINT
+    Session s;
+    auto b = blob ("_i_is__");
+
+    Counts counts;
+    corda_amqp_visitor visitor { };
+
+    visitor.context = &counts;
+    visitor.on_begin_composite = [](void * c_, const char *, size_t) {
+        ++static_cast<Counts *> (c_)->m_composites;
+    };
+    visitor.on_field = [](void * c_, const char *, size_t) {
+        ++static_cast<Counts *> (c_)->m_fields;
+    };
+    visitor.on_int = [](void * c_, int32_t value_) {
+        static_cast<Counts *> (c_)->m_ints.push_back (value_);
+    };
+    visitor.on_string = [](void * c_, const char * value_, size_t size_) {
+        static_cast<Counts *> (c_)->m_strings.emplace_back (value_, size_);
+    };
+
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_visit (s.m_session, b.data(), b.size(), &visitor));
+
+    EXPECT_EQ (2, counts.m_composites);
+    // "Parsed" as well as the four properties
+    EXPECT_EQ (5, counts.m_fields);
+    EXPECT_EQ ((std::vector<int32_t> { 1, 2 }), counts.m_ints);
+    EXPECT_EQ ((std::vector<std::string> { "three" }), counts.m_strings);
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, tape) { // NOLINT
+    Session s;
+    auto b = blob ("_i_");
+
+    corda_amqp_tape * tape { nullptr };
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_decode_tape (s.m_session, b.data(), b.size(), &tape));
+
+    size_t count { 0 };
+    const auto * words = corda_amqp_tape_words (tape, &count);
+
+    // { "Parsed" : { "a" : 69 } }
+    ASSERT_LT (0U, count);
+    EXPECT_EQ ('{', static_cast<char> (words[0] >> 56));
+
+    size_t text { 0 };
+    EXPECT_NE (nullptr, corda_amqp_tape_text (tape, &text));
+
+    size_t at { 0 };
+    ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_tape_at (tape, "/Parsed/a", &at));
+    ASSERT_LT (at + 1, count);
+    EXPECT_EQ ('i', static_cast<char> (words[at] >> 56));
+    EXPECT_EQ (69U, words[at + 1]);
+
+    EXPECT_EQ (CORDA_AMQP_OK, corda_amqp_tape_at (tape, "", &at));
+    EXPECT_EQ (0U, at);
+
+    EXPECT_EQ (CORDA_AMQP_ENOTFOUND, corda_amqp_tape_at (tape, "/Parsed/b", &at));
+    EXPECT_EQ (CORDA_AMQP_EINVAL, corda_amqp_tape_at (tape, "Parsed", &at));
+    EXPECT_EQ (CORDA_AMQP_EINVAL, corda_amqp_tape_at (tape, nullptr, &at));
+
+    corda_amqp_tape_free (tape);
+}
+
+/******************************************************************************/
+
+TEST (CordaAmqp, cache) { // NOLINT
+    const std::string path { "corda-amqp-test.schemas" };
+    std::remove (path.c_str());
+
+    Session s;
+    auto b = blob ("_i_is__");
+
+    corda_amqp_cache_clear();
+
+    auto * cache = corda_amqp_cache_open (path.c_str());
+    ASSERT_NE (nullptr, cache);
+
+    json (s.m_session, b);
+    json (s.m_session, b);
+
+    size_t entries { 0 }, hits { 0 }, misses { 0 };
+    corda_amqp_cache_stats (&entries, &hits, &misses);
+
+    EXPECT_EQ (1U, entries);
+    EXPECT_EQ (1U, hits);
+    EXPECT_EQ (1U, misses);
+
+    EXPECT_EQ (CORDA_AMQP_OK, corda_amqp_cache_save (cache));
+    corda_amqp_cache_close (cache);
+
+    // reopened the schema is restored rather than decoded, to the same end
+    corda_amqp_cache_clear();
+    cache = corda_amqp_cache_open (path.c_str());
+
+    EXPECT_EQ (R"({"Parsed":{"a":1,"b":{"a":2,"b":"three"}}})", json (s.m_session, b));
+
+    corda_amqp_cache_close (cache);
+    std::remove (path.c_str());
+}
+
+/******************************************************************************/
+
+/**
+ * Many blobs in one buffer, concatenated or each prefixed by its length,
+ * share one session and one compiled schema
+ */
+TEST (CordaAmqp, frames) { // NOLINT
+    Session s;
+
+    auto i = blob ("_i_");
+    auto is = blob ("_i_is__");
+
+    std::vector<char> concatenated (i);
+    concatenated.insert (concatenated.end(), is.begin(), is.end());
+    concatenated.insert (concatenated.end(), i.begin(), i.end());
+
+    std::vector<char> prefixed;
+    for (const auto * b : { &i, &is, &i }) {
+        auto size = b->size();
+        for (int shift { 24 } ; shift >= 0 ; shift -= 8) prefixed.push_back (static_cast<char> (size >> shift));
+        prefixed.insert (prefixed.end(), b->begin(), b->end());
+    }
+
+    const std::string expected {
+        "{\"Parsed\":{\"a\":69}}\n"
+        "{\"Parsed\":{\"a\":1,\"b\":{\"a\":2,\"b\":\"three\"}}}\n"
+        "{\"Parsed\":{\"a\":69}}\n" };
+
+    for (const auto * data : { &concatenated, &prefixed }) {
+        char * json { nullptr };
+        size_t size { 0 }, blobs { 0 };
+
+        ASSERT_EQ (CORDA_AMQP_OK, corda_amqp_decode_frames_json (
+                s.m_session, data->data(), data->size(), &json, &size, &blobs)) << corda_amqp_error (s.m_session);
+
+        EXPECT_EQ (expected, std::string (json, size));
+        EXPECT_EQ (3U, blobs);
+
+        corda_amqp_free (json);
+    }
+
+    // a buffer ending part way through a blob is broken, not just the blob
+    char * json { nullptr };
+    size_t blobs { 0 };
+
+    EXPECT_EQ (CORDA_AMQP_EFORMAT, corda_amqp_decode_frames_json (
+            s.m_session, prefixed.data(), prefixed.size() - 1, &json, nullptr, &blobs));
+    EXPECT_EQ (2U, blobs);
+    EXPECT_STRNE ("", corda_amqp_error (s.m_session));
+}
+
+/******************************************************************************/
@@ -0,0 +1,23 @@
+#include "corda_amqp.h"
+
+/******************************************************************************/
+
+/**
+ * Decode [blob] to JSON through nothing but the C interface, returning
+ * the error code
+ */
+int
+decode_in_c (const void * blob, size_t size, char ** json) {
+    int rtn;
+    corda_amqp_session * session = corda_amqp_open();
+
+    if (!session) return -1;
+
+    rtn = corda_amqp_decode_json (session, blob, size, json, NULL);
+
+    corda_amqp_close (session);
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,591 @@
+#include "Generator.h"
+
+#include <random>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+#include "amqp/schema/Descriptors.h"
+
+/******************************************************************************
+ *
+ * Encoding
+ *
+ ******************************************************************************/
+
+namespace {
+
+    namespace descriptors = amqp::schema::descriptors;
+
+    const std::string PACKAGE { "net.corda.generated." }; // NOLINT
+
+    /**
+     * Byte size of a 32 bit list or map's size and count less its
+     * constructor
+     */
+    const uint64_t LIST32 = 9;
+
+    /**
+     * Size of a described value's descriptor when that's a symbol
+     */
+    uint64_t
+    symbolSize (const std::string & symbol_) {
+        return 1 + 2 + symbol_.size();
+    }
+
+    uint64_t
+    stringSize (size_t size_) {
+        return size_ < 256 ? 2 + size_ : 5 + size_;
+    }
+
+    void
+    be32 (std::string & out_, uint32_t v_) {
+        out_ += static_cast<char> (v_ >> 24);
+        out_ += static_cast<char> (v_ >> 16);
+        out_ += static_cast<char> (v_ >> 8);
+        out_ += static_cast<char> (v_);
+    }
+
+    void
+    be64 (std::string & out_, uint64_t v_) {
+        be32 (out_, static_cast<uint32_t> (v_ >> 32));
+        be32 (out_, static_cast<uint32_t> (v_));
+    }
+
+    void
+    symbol (std::string & out_, const std::string & symbol_) {
+        out_ += '\xa3';
+        out_ += static_cast<char> (symbol_.size());
+        out_ += symbol_;
+    }
+
+    /**
+     * Start a value described by a symbol, as every object is
+     */
+    void
+    described (std::string & out_, const std::string & symbol_) {
+        out_ += '\0';
+        symbol (out_, symbol_);
+    }
+
+    /**
+     * Start a value described by one of the schema's own descriptors
+     */
+    void
+    described (std::string & out_, int id_) {
+        out_ += '\0';
+        out_ += '\x80';
+        be64 (out_, descriptors::DESCRIPTOR_TOP_32BITS | static_cast<uint64_t> (id_));
+    }
+
+    /**
+     * The header of a list or map, [body_] bytes of [count_] elements
+     */
+    void
+    header (std::string & out_, char constructor_, uint64_t body_, uint64_t count_) {
+        if (4 + body_ > UINT32_MAX) {
+            throw std::runtime_error ("Too large to encode in a single blob");
+        }
+
+        out_ += constructor_;
+        be32 (out_, static_cast<uint32_t> (4 + body_));
+        be32 (out_, static_cast<uint32_t> (count_));
+    }
+
+    void
+    str (std::string & out_, const std::string & str_) {
+        if (str_.size() < 256) {
+            out_ += '\xa1';
+            out_ += static_cast<char> (str_.size());
+        } else {
+            out_ += '\xb1';
+            be32 (out_, static_cast<uint32_t> (str_.size()));
+        }
+        out_ += str_;
+    }
+
+    std::string
+    list (const std::vector<std::string> & elements_) {
+        std::string body;
+        for (const auto & e : elements_) body += e;
+
+        std::string rtn;
+        header (rtn, '\xd0', body.size(), elements_.size());
+
+        return rtn + body;
+    }
+
+    /**
+     * A fingerprint of sorts, never actually checked against what it's
+     * meant to be a fingerprint of but unique and stable
+     */
+    std::string
+    fingerprint (const std::string & name_) {
+        static const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        uint64_t hash[2] = { 14695981039346656037UL, 1099511628211UL };
+        for (auto c : name_) {
+            hash[0] = (hash[0] ^ static_cast<unsigned char> (c)) * 1099511628211UL;
+            hash[1] = (hash[1] ^ static_cast<unsigned char> (c)) * 14695981039346656037UL;
+        }
+
+        std::string rtn { "net.corda:" };
+
+        // 16 bytes is 22 base64 digits, the last only 2 bits
+        for (int i { 0 } ; i < 22 ; ++i) {
+            rtn += alphabet[(hash[i / 11] >> (6 * (i % 11))) & 63];
+        }
+
+        return rtn + "==";
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Schema
+ *
+ ******************************************************************************/
+
+namespace {
+
+    std::string
+    descriptor (const std::string & symbol_) {
+        std::string rtn;
+        described (rtn, descriptors::OBJECT);
+
+        std::string s;
+        symbol (s, symbol_);
+
+        return rtn + list ({ s, "\x40" });
+    }
+
+    std::string
+    field (
+        const std::string & name_,
+        const std::string & type_,
+        const std::string & requires_ = ""
+    ) {
+        std::string name, type, requires;
+        str (name, name_);
+        str (type, type_);
+
+        if (!requires_.empty()) {
+            str (requires, requires_);
+        }
+
+        std::string rtn;
+        described (rtn, descriptors::FIELD);
+
+        return rtn + list ({
+            name,
+            type,
+            requires_.empty() ? list ({ }) : list ({ requires }),
+            "\x40",
+            "\x40",
+            "\x41",
+            "\x42" });
+    }
+
+    std::string
+    composite (
+        const std::string & name_,
+        const std::string & symbol_,
+        const std::vector<std::string> & fields_
+    ) {
+        std::string name;
+        str (name, name_);
+
+        std::string rtn;
+        described (rtn, descriptors::COMPOSITE_TYPE);
+
+        return rtn + list ({
+            name, "\x40", "\x45", descriptor (symbol_), list (fields_) });
+    }
+
+    std::string
+    restricted (
+        const std::string & name_,
+        const std::string & source_,
+        const std::string & symbol_,
+        const std::vector<std::string> & choices_ = { }
+    ) {
+        std::string name, source;
+        str (name, name_);
+        str (source, source_);
+
+        std::vector<std::string> choices;
+        for (size_t i { 0 } ; i < choices_.size() ; ++i) {
+            std::string choice, value;
+            str (choice, choices_[i]);
+            str (value, std::to_string (i));
+
+            described (choices.emplace_back(), descriptors::CHOICE);
+            choices.back() += list ({ choice, value });
+        }
+
+        std::string rtn;
+        described (rtn, descriptors::RESTRICTED_TYPE);
+
+        return rtn + list ({
+            name, "\x40", "\x45", source, descriptor (symbol_), list (choices) });
+    }
+
+    const std::vector<std::string> CHOICES { "C0", "C1", "C2", "C3" }; // NOLINT
+
+    const char * const KINDS[] = { "int", "long", "boolean", "double", "string" };
+
+}
+
+/******************************************************************************
+ *
+ * Generator
+ *
+ ******************************************************************************/
+
+Generator::Generator (Shape shape_)
+    : m_shape (shape_)
+    , m_rootSymbol (fingerprint (PACKAGE + "Root"))
+    , m_elementsSymbol (fingerprint ("java.util.List<" + PACKAGE + "T0>"))
+    , m_intsSymbol (fingerprint ("java.util.List<int>"))
+    , m_mapSymbol (fingerprint ("java.util.Map<int, string>"))
+    , m_enumSymbol (fingerprint (PACKAGE + "E"))
+{
+    if (m_shape.m_depth == 0) m_shape.m_depth = 1;
+    if (m_shape.m_types == 0 || m_shape.m_depth == 1) m_shape.m_types = 1;
+
+    /*
+     * The narrowest tree of the shape's depth that can hold every type.
+     * Types are numbered breadth first so the children of T<i> are
+     * T<i * branches + 1> onwards
+     */
+    size_t branches { 1 };
+    for (;; ++branches) {
+        size_t capacity { 0 }, level { 1 };
+        for (size_t d { 0 } ; d < m_shape.m_depth && capacity < m_shape.m_types ; ++d) {
+            capacity += level;
+            level *= branches;
+        }
+
+        if (capacity >= m_shape.m_types) break;
+    }
+
+    // the seed only picks values, the same shape always has the same schema
+    std::mt19937 rng;
+
+    m_types.resize (m_shape.m_types);
+
+    for (size_t i { 0 } ; i < m_types.size() ; ++i) {
+        auto & type = m_types[i];
+
+        type.m_name = PACKAGE + "T" + std::to_string (i);
+        type.m_symbol = fingerprint (type.m_name);
+        type.m_listSymbol = fingerprint ("java.util.List<" + type.m_name + ">");
+
+        for (size_t f { 0 } ; f < m_shape.m_fields ; ++f) {
+            type.m_fields.push_back (rng() % 1000 < m_shape.m_enums * 1000
+                    ? enum_t
+                    : Kind (f % enum_t));
+        }
+
+        for (auto c = i * branches + 1 ; c <= i * branches + branches && c < m_types.size() ; ++c) {
+            type.m_children.push_back (c);
+        }
+    }
+
+    // children are numbered after their parents so are sized first
+    for (auto i = m_types.size() ; i-- > 0 ; ) {
+        m_types[i].m_size = size (i);
+    }
+
+    auto schema = this->schema();
+
+    std::string transforms;
+    described (transforms, descriptors::TRANSFORM_SCHEMA);
+    transforms.append ("\xc1\x01\x00", 3);
+
+    m_tail = schema + transforms;
+
+    /*
+     * Everything bar the elements themselves, the envelope's list, the
+     * payload and its own list and the list of elements
+     */
+    auto fixed = amqp::AMQP_HEADER.size() + 1
+        + 10 + LIST32
+        + symbolSize (m_rootSymbol) + LIST32
+        + symbolSize (m_elementsSymbol) + LIST32
+        + m_tail.size();
+
+    auto each = m_types[0].m_size;
+
+    m_elements = m_shape.m_size > fixed ? (m_shape.m_size - fixed) / each : 0;
+    if (m_elements == 0) m_elements = 1;
+
+    auto elements = m_elements * each;
+    auto elementsValue = symbolSize (m_elementsSymbol) + LIST32 + elements;
+    auto payload = symbolSize (m_rootSymbol) + LIST32 + elementsValue;
+
+    m_head.append (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+    m_head += static_cast<char> (amqp::DATA_AND_STOP);
+
+    described (m_head, descriptors::ENVELOPE);
+    header (m_head, '\xd0', payload + m_tail.size(), 3);
+
+    described (m_head, m_rootSymbol);
+    header (m_head, '\xd0', elementsValue, 1);
+
+    described (m_head, m_elementsSymbol);
+    header (m_head, '\xd0', elements, m_elements);
+}
+
+/******************************************************************************/
+
+uint64_t
+Generator::size (size_t type_) {
+    const auto & type = m_types[type_];
+
+    uint64_t body { 0 };
+
+    for (auto kind : type.m_fields) {
+        switch (kind) {
+            case int_t    : body += 5; break;
+            case long_t   : body += 9; break;
+            case bool_t   : body += 2; break;
+            case double_t : body += 9; break;
+            case string_t : body += stringSize (m_shape.m_stringSize); break;
+            case enum_t   : body += symbolSize (m_enumSymbol) + LIST32 + 4 + 5; break;
+        }
+    }
+
+    if (m_shape.m_listSize) {
+        body += symbolSize (m_intsSymbol) + LIST32 + 5 * m_shape.m_listSize;
+    }
+
+    if (m_shape.m_mapSize) {
+        body += symbolSize (m_mapSymbol) + LIST32
+            + m_shape.m_mapSize * (5 + stringSize (m_shape.m_stringSize));
+    }
+
+    for (auto c : type.m_children) {
+        body += m_types[c].m_size;
+
+        if (m_shape.m_listSize) {
+            body += symbolSize (m_types[c].m_listSymbol) + LIST32
+                + m_shape.m_listSize * m_types[c].m_size;
+        }
+    }
+
+    return symbolSize (type.m_symbol) + LIST32 + body;
+}
+
+/******************************************************************************/
+
+std::string
+Generator::schema() const {
+    std::vector<std::string> types;
+
+    types.push_back (composite (
+            PACKAGE + "Root",
+            m_rootSymbol,
+            { field ("elements", "*", "java.util.List<" + m_types[0].m_name + ">") }));
+
+    types.push_back (restricted (
+            "java.util.List<" + m_types[0].m_name + ">", "list", m_elementsSymbol));
+
+    bool enums { false };
+
+    for (const auto & type : m_types) {
+        std::vector<std::string> fields;
+
+        for (size_t f { 0 } ; f < type.m_fields.size() ; ++f) {
+            auto name = "f" + std::to_string (f);
+
+            if (type.m_fields[f] == enum_t) {
+                fields.push_back (field (name, PACKAGE + "E"));
+                enums = true;
+            } else {
+                fields.push_back (field (name, KINDS[type.m_fields[f]]));
+            }
+        }
+
+        if (m_shape.m_listSize) {
+            fields.push_back (field ("ints", "*", "java.util.List<int>"));
+        }
+
+        if (m_shape.m_mapSize) {
+            fields.push_back (field ("map", "*", "java.util.Map<int, string>"));
+        }
+
+        for (auto c : type.m_children) {
+            const auto & child = m_types[c];
+            auto listName = "java.util.List<" + child.m_name + ">";
+
+            fields.push_back (field ("c" + std::to_string (c), child.m_name));
+
+            if (m_shape.m_listSize) {
+                fields.push_back (field ("l" + std::to_string (c), "*", listName));
+                types.push_back (restricted (listName, "list", child.m_listSymbol));
+            }
+        }
+
+        types.push_back (composite (type.m_name, type.m_symbol, fields));
+    }
+
+    if (m_shape.m_listSize) {
+        types.push_back (restricted ("java.util.List<int>", "list", m_intsSymbol));
+    }
+
+    if (m_shape.m_mapSize) {
+        types.push_back (restricted ("java.util.Map<int, string>", "map", m_mapSymbol));
+    }
+
+    if (enums) {
+        types.push_back (restricted (PACKAGE + "E", "list", m_enumSymbol, CHOICES));
+    }
+
+    std::string rtn;
+    described (rtn, descriptors::SCHEMA);
+
+    return rtn + list ({ list (types) });
+}
+
+/******************************************************************************/
+
+template<class Rng>
+void
+Generator::element (std::string & out_, size_t type_, Rng & rng_) const {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+    auto string = [this, &out_, &rng_]() {
+        if (m_shape.m_stringSize < 256) {
+            out_ += '\xa1';
+            out_ += static_cast<char> (m_shape.m_stringSize);
+        } else {
+            out_ += '\xb1';
+            be32 (out_, static_cast<uint32_t> (m_shape.m_stringSize));
+        }
+
+        for (size_t i { 0 } ; i < m_shape.m_stringSize ; ++i) {
+            out_ += alphabet[rng_() % (sizeof (alphabet) - 1)];
+        }
+    };
+
+    auto int32 = [&out_](uint32_t v_) {
+        out_ += '\x71';
+        be32 (out_, v_);
+    };
+
+    const auto & type = m_types[type_];
+
+    described (out_, type.m_symbol);
+    header (out_, '\xd0', type.m_size - symbolSize (type.m_symbol) - LIST32,
+            type.m_fields.size()
+                + (m_shape.m_listSize ? 1 : 0)
+                + (m_shape.m_mapSize ? 1 : 0)
+                + type.m_children.size() * (m_shape.m_listSize ? 2 : 1));
+
+    for (auto kind : type.m_fields) {
+        switch (kind) {
+            case int_t :
+                int32 (static_cast<uint32_t> (rng_()));
+                break;
+            case long_t :
+                out_ += '\x81';
+                be64 (out_, (static_cast<uint64_t> (rng_()) << 32) | rng_());
+                break;
+            case bool_t :
+                out_ += '\x56';
+                out_ += static_cast<char> (rng_() & 1);
+                break;
+            case double_t : {
+                double d = static_cast<double> (rng_() % 100000000) / 100;
+                uint64_t bits;
+                std::memcpy (&bits, &d, sizeof (bits));
+
+                out_ += '\x82';
+                be64 (out_, bits);
+                break;
+            }
+            case string_t :
+                string();
+                break;
+            case enum_t : {
+                auto choice = rng_() % CHOICES.size();
+
+                described (out_, m_enumSymbol);
+                header (out_, '\xd0', 4 + 5, 2);
+                str (out_, CHOICES[choice]);
+                int32 (static_cast<uint32_t> (choice));
+                break;
+            }
+        }
+    }
+
+    if (m_shape.m_listSize) {
+        described (out_, m_intsSymbol);
+        header (out_, '\xd0', 5 * m_shape.m_listSize, m_shape.m_listSize);
+
+        for (size_t i { 0 } ; i < m_shape.m_listSize ; ++i) {
+            int32 (static_cast<uint32_t> (rng_()));
+        }
+    }
+
+    if (m_shape.m_mapSize) {
+        described (out_, m_mapSymbol);
+        header (out_, '\xd1',
+                m_shape.m_mapSize * (5 + stringSize (m_shape.m_stringSize)),
+                2 * m_shape.m_mapSize);
+
+        for (size_t i { 0 } ; i < m_shape.m_mapSize ; ++i) {
+            int32 (static_cast<uint32_t> (i));
+            string();
+        }
+    }
+
+    for (auto c : type.m_children) {
+        element (out_, c, rng_);
+
+        if (m_shape.m_listSize) {
+            described (out_, m_types[c].m_listSymbol);
+            header (out_, '\xd0',
+                    m_shape.m_listSize * m_types[c].m_size, m_shape.m_listSize);
+
+            for (size_t i { 0 } ; i < m_shape.m_listSize ; ++i) {
+                element (out_, c, rng_);
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+
+uint64_t
+Generator::size() const {
+    return m_head.size() + m_elements * m_types[0].m_size + m_tail.size();
+}
+
+/******************************************************************************/
+
+void
+Generator::write (std::ostream & out_) const {
+    std::mt19937 rng (m_shape.m_seed);
+
+    out_.write (m_head.data(), m_head.size());
+
+    std::string buffer;
+    buffer.reserve (m_types[0].m_size);
+
+    for (uint64_t i { 0 } ; i < m_elements ; ++i) {
+        buffer.clear();
+        element (buffer, 0, rng);
+        out_.write (buffer.data(), buffer.size());
+    }
+
+    out_.write (m_tail.data(), m_tail.size());
+}
+
+/******************************************************************************/
@@ -0,0 +1,131 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+
+/******************************************************************************/
+
+/**
+ * Writes synthetic Corda blobs of a given shape and, roughly, size so
+ * there's something larger than the hand made test files to decode
+ * without needing a JVM to serialise it.
+ *
+ * A blob's payload is always an object holding a single list of
+ * elements, each a tree of composites T0, T1, ... with T0 at its root.
+ * Every composite has some scalar fields, a list of ints and a map of
+ * ints to strings and, for each of its children in the tree, a field of
+ * that type and a list of them. Elements are added until the blob is as
+ * large as it can be without exceeding the size asked for, though there
+ * is always at least one.
+ *
+ * Every value is encoded with a fixed width, ints as full 4 byte ints,
+ * lists with 32 bit sizes and so on, so every element is the same size
+ * and the blob can be streamed out without ever being held in memory.
+ * Values themselves are random but the same for the same seed, the
+ * schema is always the same for the same shape.
+ */
+class Generator {
+    public :
+        struct Shape {
+            /**
+             * How deep the tree of composites beneath each element is,
+             * an element is a depth of one
+             */
+            size_t m_depth      { 3 };
+
+            /**
+             * The number of composite types, at most one when the depth
+             * is, since a tree that shallow can't hold any more
+             */
+            size_t m_types      { 8 };
+
+            /**
+             * Scalar fields per composite
+             */
+            size_t m_fields     { 4 };
+            size_t m_listSize   { 4 };
+            size_t m_mapSize    { 4 };
+            size_t m_stringSize { 16 };
+
+            /**
+             * The fraction of scalar fields that are enums rather than
+             * primitives
+             */
+            double m_enums      { 0.25 };
+
+            /**
+             * The size of the blob, header and all, in bytes
+             */
+            uint64_t m_size     { 1024 };
+
+            uint32_t m_seed     { 1 };
+        };
+
+    private :
+        enum Kind { int_t, long_t, bool_t, double_t, string_t, enum_t };
+
+        struct Type {
+            std::string m_name;
+            std::string m_symbol;
+
+            /**
+             * The symbol of a list of this type, held by its parent
+             */
+            std::string m_listSymbol;
+
+            std::vector<Kind> m_fields;
+            std::vector<size_t> m_children;
+
+            /**
+             * The encoded size of one of these
+             */
+            uint64_t m_size;
+        };
+
+        Shape m_shape;
+
+        std::vector<Type> m_types;
+
+        std::string m_rootSymbol;
+        std::string m_elementsSymbol;
+        std::string m_intsSymbol;
+        std::string m_mapSymbol;
+        std::string m_enumSymbol;
+
+        uint64_t m_elements;
+
+        /**
+         * The blob up to the first element, and after the last
+         */
+        std::string m_head;
+        std::string m_tail;
+
+        uint64_t size (size_t type_);
+        std::string schema() const;
+
+        template<class Rng>
+        void element (std::string & out_, size_t type_, Rng & rng_) const;
+
+    public :
+        explicit Generator (Shape);
+
+        /**
+         * Size of the blob that will be written, in bytes
+         */
+        uint64_t size() const;
+
+        uint64_t elements() const { return m_elements; }
+
+        /**
+         * Composite types, not counting the payload's own
+         */
+        size_t types() const { return m_types.size(); }
+
+        void write (std::ostream &) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Generator.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Bytes, optionally suffixed K, M or G
+     */
+    uint64_t
+    bytes (const char * arg_) {
+        char * end;
+        uint64_t rtn = std::strtoull (arg_, &end, 10);
+
+        switch (*end) {
+            case 'G' : case 'g' : rtn <<= 10; [[fallthrough]];
+            case 'M' : case 'm' : rtn <<= 10; [[fallthrough]];
+            case 'K' : case 'k' : rtn <<= 10; break;
+            default : break;
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Writes a synthetic blob to the file given or, given "-", stdout. The
+ * shape of the blob defaults to that of Generator::Shape, each option
+ * overriding one part of it
+ *
+ *   --size     n[K|M|G]  roughly how large the blob is
+ *   --depth    n         how deeply composites nest
+ *   --types    n         how many composite types there are
+ *   --fields   n         scalar fields per composite
+ *   --list     n         elements of every list
+ *   --map      n         entries of every map
+ *   --string   n         characters of every string
+ *   --enums    f         the fraction of scalar fields that are enums
+ *   --seed     n         what values are chosen from
+ */
+int
+main (int argc, char **argv) {
+    Generator::Shape shape;
+    int arg { 1 };
+
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-' ; arg += 2) {
+        std::string opt { argv[arg] };
+        const char * val { argv[arg + 1] };
+
+        if (opt == "--size") {
+            shape.m_size = bytes (val);
+        } else if (opt == "--depth") {
+            shape.m_depth = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--types") {
+            shape.m_types = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--fields") {
+            shape.m_fields = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--list") {
+            shape.m_listSize = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--map") {
+            shape.m_mapSize = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--string") {
+            shape.m_stringSize = std::strtoul (val, nullptr, 10);
+        } else if (opt == "--enums") {
+            shape.m_enums = std::strtod (val, nullptr);
+        } else if (opt == "--seed") {
+            shape.m_seed = std::strtoul (val, nullptr, 10);
+        } else {
+            arg = argc;
+        }
+    }
+
+    if (arg != argc - 1) {
+        std::cerr << "usage: " << argv[0]
+            << " [--size n[K|M|G]] [--depth n] [--types n] [--fields n]"
+            << " [--list n] [--map n] [--string n] [--enums f] [--seed n]"
+            << " <file|->" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        Generator generator (shape);
+
+        if (std::string ("-") == argv[arg]) {
+            generator.write (std::cout);
+        } else {
+            std::ofstream out (argv[arg], std::ios::binary);
+            generator.write (out);
+
+            if (!out) {
+                std::cerr << "Failed to write " << argv[arg] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::cerr << generator.elements() << " elements of "
+            << generator.types() << " types, "
+            << generator.size() << " bytes" << std::endl;
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
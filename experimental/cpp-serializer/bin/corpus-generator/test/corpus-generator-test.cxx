@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include <regex>
+#include <sstream>
+
+#include "Generator.h"
+#include "CordaBytes.h"
+#include "BlobInspector.h"
+#include "cursor/Cursor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    generate (const Generator::Shape & shape_) {
+        std::stringstream ss;
+        Generator (shape_).write (ss);
+
+        return ss.str();
+    }
+
+    std::string
+    dump (const Generator::Shape & shape_) {
+        std::stringstream ss (generate (shape_));
+        CordaBytes cb (ss);
+
+        return BlobInspector (cb).dump();
+    }
+
+    size_t
+    count (const std::string & str_, const std::string & of_) {
+        size_t rtn { 0 };
+
+        for (auto i = str_.find (of_) ; i != std::string::npos ; i = str_.find (of_, i + 1)) {
+            ++rtn;
+        }
+
+        return rtn;
+    }
+
+    /**
+     * Enter every value, throwing should any run past the end of the blob
+     */
+    void
+    walk (amqp::internal::cursor::Cursor & data_) {
+        do {
+            switch (data_.type()) {
+                case amqp::internal::cursor::described_t :
+                case amqp::internal::cursor::list_t :
+                case amqp::internal::cursor::map_t : {
+                    data_.enter();
+                    if (data_.next()) walk (data_);
+                    data_.exit();
+                    break;
+                }
+                default : break;
+            }
+        } while (data_.next());
+    }
+
+    /**
+     * Just the one int field per element, and so per composite
+     */
+    Generator::Shape
+    flat() {
+        Generator::Shape shape;
+
+        shape.m_depth = 1;
+        shape.m_fields = 1;
+        shape.m_listSize = 0;
+        shape.m_mapSize = 0;
+        shape.m_enums = 0;
+
+        return shape;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Generator, flat) { // NOLINT
+    auto shape = flat();
+    shape.m_size = 200;
+
+    Generator generator (shape);
+
+    EXPECT_EQ (1, generator.types());
+    EXPECT_LT (0, generator.elements());
+
+    auto dumped = dump (shape);
+
+    EXPECT_EQ (generator.elements(), count (dumped, "f0 :"));
+    EXPECT_TRUE (std::regex_search (
+            dumped, std::regex ("^\\{ Parsed : \\{ elements : \\[ \\{ f0 : -?[0-9]+ \\}")));
+}
+
+/******************************************************************************/
+
+TEST (Generator, size) { // NOLINT
+    for (uint64_t size : { 1, 1024, 10000, 1 << 20 }) {
+        Generator::Shape shape;
+        shape.m_size = size;
+
+        Generator generator (shape);
+        auto blob = generate (shape);
+
+        EXPECT_EQ (generator.size(), blob.size());
+
+        if (generator.elements() > 1) {
+            EXPECT_GE (size, blob.size());
+        }
+
+        // another element wouldn't have fit
+        EXPECT_LT (size, blob.size() + blob.size() / generator.elements());
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * The transforms schema, which nothing decodes, included
+ */
+TEST (Generator, wellFormed) { // NOLINT
+    std::stringstream ss (generate (Generator::Shape()));
+    CordaBytes cb (ss);
+
+    amqp::internal::cursor::Cursor data (cb.bytes(), cb.size());
+
+    EXPECT_NO_THROW (walk (data)); // NOLINT
+}
+
+/******************************************************************************/
+
+TEST (Generator, seed) { // NOLINT
+    Generator::Shape shape;
+    shape.m_size = 10000;
+
+    auto a = generate (shape);
+    EXPECT_EQ (a, generate (shape));
+
+    shape.m_seed = 2;
+    auto b = generate (shape);
+
+    EXPECT_EQ (a.size(), b.size());
+    EXPECT_NE (a, b);
+}
+
+/******************************************************************************/
+
+/**
+ * Every composite holds one of each of its children and a list of them,
+ * so each level of the tree has (list + 1) times as many as the one
+ * above it
+ */
+TEST (Generator, depth) { // NOLINT
+    Generator::Shape shape;
+    shape.m_size = 0;
+    shape.m_depth = 3;
+    shape.m_types = 3;
+    shape.m_fields = 0;
+    shape.m_listSize = 2;
+    shape.m_mapSize = 0;
+
+    Generator generator (shape);
+
+    EXPECT_EQ (3, generator.types());
+    EXPECT_EQ (1, generator.elements());
+
+    auto dumped = dump (shape);
+
+    // T0 is the element, T1 its child, T2 its grandchild
+    EXPECT_EQ (1, count (dumped, "c1 :"));
+    EXPECT_EQ (3, count (dumped, "c2 :"));
+    EXPECT_EQ (1 + 3 + 3 * 3, count (dumped, "ints :"));
+}
+
+/******************************************************************************/
+
+TEST (Generator, shapes) { // NOLINT
+    Generator::Shape shape;
+    shape.m_size = 1 << 16;
+
+    for (size_t depth : { 1, 2, 4 }) {
+        for (size_t types : { 1, 5, 20 }) {
+            shape.m_depth = depth;
+            shape.m_types = types;
+
+            EXPECT_NO_THROW (dump (shape)); // NOLINT
+        }
+    }
+}
+
+/******************************************************************************/
+
+TEST (Generator, enums) { // NOLINT
+    auto shape = flat();
+    shape.m_enums = 1;
+
+    auto dumped = dump (shape);
+
+    EXPECT_EQ (Generator (shape).elements(), count (dumped, "f0 : C"));
+}
+
+/******************************************************************************/
+
+TEST (Generator, maps) { // NOLINT
+    auto shape = flat();
+    shape.m_size = 0;
+    shape.m_mapSize = 3;
+    shape.m_stringSize = 4;
+
+    EXPECT_TRUE (std::regex_search (dump (shape), std::regex (
+            "map : \\{ 0 : \"[A-Za-z0-9]{4}\", 1 : \"[A-Za-z0-9]{4}\", 2 : \"[A-Za-z0-9]{4}\" \\}")));
+}
+
+/******************************************************************************/
+
+/**
+ * Strings too long for a single byte size
+ */
+TEST (Generator, longStrings) { // NOLINT
+    auto shape = flat();
+    shape.m_fields = 5;
+    shape.m_stringSize = 300;
+
+    auto dumped = dump (shape);
+
+    EXPECT_TRUE (std::regex_search (dumped, std::regex ("f4 : \"[A-Za-z0-9]{300}\"")));
+}
+
+/******************************************************************************/
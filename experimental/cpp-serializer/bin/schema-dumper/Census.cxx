@@ -0,0 +1,347 @@
+#include "Census.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+
+#include "CordaBytes.h"
+
+#include "cursor/Cursor.h"
+
+#include "amqp/ReaderCache.h"
+#include "amqp/reader/ISink.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+    namespace cursor = amqp::internal::cursor;
+
+    using Types = std::map<std::string, const schema::AMQPTypeNotation *>;
+
+    const schema::Restricted *
+    restricted (const schema::AMQPTypeNotation & type_) {
+        return type_.type() == schema::AMQPTypeNotation::restricted_t
+            ? &dynamic_cast<const schema::Restricted &> (type_)
+            : nullptr;
+    }
+
+    const char *
+    kind (const schema::AMQPTypeNotation & type_) {
+        auto * r = restricted (type_);
+
+        if (!r) return "composite";
+
+        switch (r->restrictedType()) {
+            case schema::Restricted::list_t  : return "list";
+            case schema::Restricted::map_t   : return "map";
+            case schema::Restricted::enum_t  : return "enum";
+            default                          : return "array";
+        }
+    }
+
+    /**
+     * How many composites, lists, maps and arrays deep a [name_] can go,
+     * a primitive or an enum being a single value and nesting not at all.
+     * A type that contains itself is counted down to where it recurses
+     */
+    size_t
+    depth (
+        const std::string & name_,
+        const Types & types_,
+        std::map<std::string, size_t> & depths_,
+        std::set<std::string> & open_
+    ) {
+        auto type = types_.find (name_);
+
+        if (type == types_.end() || open_.count (name_)) return 0;
+
+        auto known = depths_.find (name_);
+        if (known != depths_.end()) return known->second;
+
+        open_.insert (name_);
+
+        size_t inner { 0 };
+
+        if (auto * r = restricted (*type->second)) {
+            if (r->restrictedType() != schema::Restricted::enum_t) {
+                for (const auto & element : *r) {
+                    inner = std::max (inner, depth (element, types_, depths_, open_) + 1);
+                }
+            }
+        } else {
+            inner = 1;
+            for (const auto & field : dynamic_cast<const schema::Composite &> (*type->second).fields()) {
+                inner = std::max (inner, depth (field->resolvedType(), types_, depths_, open_) + 1);
+            }
+        }
+
+        open_.erase (name_);
+
+        return depths_[name_] = inner;
+    }
+
+    /**
+     * The nearest rank [percent_] percentile of sorted [sizes_]
+     */
+    uint32_t
+    percentile (const std::vector<uint32_t> & sizes_, size_t percent_) {
+        auto rank = (sizes_.size() * percent_ + 99) / 100;
+        return sizes_[rank == 0 ? 0 : rank - 1];
+    }
+
+}
+
+/******************************************************************************/
+
+Census::Census()
+    : m_blobs (0)
+    , m_failures (0)
+{ }
+
+/******************************************************************************/
+
+void
+Census::add (const CordaBytes & blob_) {
+    using schema::descriptors::EnvelopeDescriptor;
+
+    try {
+        if (blob_.encoding() != amqp::DATA_AND_STOP) {
+            throw std::runtime_error ("Bad encoding");
+        }
+
+        cursor::Cursor data (blob_.bytes(), blob_.size());
+
+        auto peek = EnvelopeDescriptor::peek (data);
+        auto fingerprint = cursor::hash (peek.m_schema);
+
+        bool known;
+        {
+            std::lock_guard<std::mutex> guard (m_lock);
+            known = m_schemas.count (fingerprint) != 0;
+        }
+
+        if (!known) {
+            // compiled outside of the lock, if someone else beat us to it
+            // they've already surveyed it
+            auto entry = amqp::internal::ReaderCache::instance().fetch (
+                    peek.m_schema,
+                    [&data]() {
+                        cursor::Cursor envelope { data };
+                        cursor::auto_enter p (envelope);
+
+                        auto a = envelope.get_ulong();
+
+                        return uPtr<schema::Envelope> (
+                                dynamic_cast<schema::Envelope *> (
+                                        amqp::internal::AMQPDescriptorRegistory[a]->build (envelope).release()));
+                    });
+
+            const auto & types = dynamic_cast<const schema::Schema &> (entry->envelope().schema());
+
+            size_t count { 0 };
+            for (const auto & level : types) count += level.size();
+
+            std::lock_guard<std::mutex> guard (m_lock);
+
+            if (m_schemas.emplace (fingerprint, Schema { 0, peek.m_schema.size(), count }).second) {
+                survey (types);
+            }
+        }
+
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        ++m_blobs;
+        ++m_schemas[fingerprint].m_blobs;
+
+        auto payload = m_payloads.find (std::string (peek.m_descriptor));
+
+        if (payload != m_payloads.end()) {
+            m_types[payload->second].m_sizes.push_back (static_cast<uint32_t> (blob_.size()));
+        }
+    } catch (...) {
+        fail();
+        throw;
+    }
+}
+
+/******************************************************************************/
+
+void
+Census::fail() {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    ++m_blobs;
+    ++m_failures;
+}
+
+/******************************************************************************/
+
+/*
+ * Called with the lock held, once for each distinct schema
+ */
+void
+Census::survey (const schema::Schema & schema_) {
+    Types types;
+
+    for (const auto & level : schema_) {
+        for (const auto & type : level) types.emplace (type->name(), type.get());
+    }
+
+    std::map<std::string, size_t> depths;
+    std::set<std::string> open;
+
+    for (const auto & type : types) {
+        auto & census = m_types[type.first];
+
+        census.m_kind = kind (*type.second);
+        census.m_depth = std::max (census.m_depth, depth (type.first, types, depths, open));
+        ++census.m_schemas;
+        census.m_descriptors.insert (type.second->descriptor());
+
+        if (!restricted (*type.second)) {
+            census.m_fields = std::max (
+                    census.m_fields,
+                    dynamic_cast<const schema::Composite &> (*type.second).fields().size());
+        }
+
+        m_payloads[type.second->descriptor()] = type.first;
+    }
+}
+
+/******************************************************************************/
+
+size_t
+Census::blobs() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_blobs;
+}
+
+/******************************************************************************/
+
+size_t
+Census::schemas() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_schemas.size();
+}
+
+/******************************************************************************/
+
+std::string
+Census::fingerprint (const cursor::Hash & hash_) {
+    char rtn[33];
+    std::snprintf (rtn, sizeof (rtn), "%016llx%016llx",
+            static_cast<unsigned long long> (hash_.m_high),
+            static_cast<unsigned long long> (hash_.m_low));
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+Census::write (amqp::reader::ISink & sink_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    sink_.beginObject();
+
+    sink_.key ("blobs");
+    sink_.integer (static_cast<int64_t> (m_blobs));
+    sink_.key ("failures");
+    sink_.integer (static_cast<int64_t> (m_failures));
+
+    std::vector<std::pair<std::string, const Schema *>> schemas;
+    for (const auto & schema : m_schemas) schemas.emplace_back (fingerprint (schema.first), &schema.second);
+
+    std::sort (schemas.begin(), schemas.end(), [](const auto & lhs_, const auto & rhs_) {
+        return lhs_.second->m_blobs != rhs_.second->m_blobs
+            ? lhs_.second->m_blobs > rhs_.second->m_blobs
+            : lhs_.first < rhs_.first;
+    });
+
+    sink_.key ("schemas");
+    sink_.beginList();
+
+    for (const auto & schema : schemas) {
+        sink_.beginObject();
+        sink_.key ("fingerprint");
+        sink_.string (schema.first);
+        sink_.key ("blobs");
+        sink_.integer (static_cast<int64_t> (schema.second->m_blobs));
+        sink_.key ("bytes");
+        sink_.integer (static_cast<int64_t> (schema.second->m_bytes));
+        sink_.key ("types");
+        sink_.integer (static_cast<int64_t> (schema.second->m_types));
+        sink_.endObject();
+    }
+
+    sink_.endList();
+
+    sink_.key ("types");
+    sink_.beginList();
+
+    for (const auto & type : m_types) {
+        const auto & census = type.second;
+
+        sink_.beginObject();
+        sink_.key ("name");
+        sink_.string (type.first);
+        sink_.key ("kind");
+        sink_.string (census.m_kind);
+        sink_.key ("schemas");
+        sink_.integer (static_cast<int64_t> (census.m_schemas));
+        sink_.key ("variants");
+        sink_.integer (static_cast<int64_t> (census.m_descriptors.size()));
+
+        if (census.m_kind == "composite") {
+            sink_.key ("fields");
+            sink_.integer (static_cast<int64_t> (census.m_fields));
+        }
+
+        sink_.key ("depth");
+        sink_.integer (static_cast<int64_t> (census.m_depth));
+
+        if (!census.m_sizes.empty()) {
+            auto sizes = census.m_sizes;
+            std::sort (sizes.begin(), sizes.end());
+
+            uint64_t total { 0 };
+            for (auto size : sizes) total += size;
+
+            sink_.key ("blobs");
+            sink_.integer (static_cast<int64_t> (sizes.size()));
+            sink_.key ("sizes");
+            sink_.beginObject();
+            sink_.key ("min");
+            sink_.integer (sizes.front());
+            sink_.key ("mean");
+            sink_.integer (static_cast<int64_t> (total / sizes.size()));
+            sink_.key ("p50");
+            sink_.integer (percentile (sizes, 50));
+            sink_.key ("p90");
+            sink_.integer (percentile (sizes, 90));
+            sink_.key ("p99");
+            sink_.integer (percentile (sizes, 99));
+            sink_.key ("max");
+            sink_.integer (sizes.back());
+            sink_.endObject();
+        }
+
+        sink_.endObject();
+    }
+
+    sink_.endList();
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
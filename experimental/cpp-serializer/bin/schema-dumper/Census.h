@@ -0,0 +1,133 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <set>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::schema {
+
+    class Schema;
+
+}
+
+/******************************************************************************/
+
+/**
+ * What a corpus's schemas hold, gathered blob by blob from just their
+ * envelopes, the payload being skipped over on its encoded size and so
+ * never decoded.
+ *
+ * Each distinct schema, told apart by a fingerprint of its encoded bytes,
+ * is compiled once through the [ReaderCache], and so restored from its
+ * store when one's attached, every blob after the first with that schema
+ * costing no more than finding and hashing the schema's bytes.
+ *
+ * For every type named by any of the schemas is kept how many schemas and
+ * how many of its variants, distinct descriptors being distinct versions
+ * of the type, turned up, its fields and how deeply its values nest. For
+ * those blobs are of, their payload's type, the blobs' sizes as well.
+ *
+ * [add] can be called from as many threads as there are at once.
+ */
+class Census {
+    private :
+        struct KeyHash {
+            size_t operator() (const amqp::internal::cursor::Hash & key_) const {
+                return key_.m_low;
+            }
+        };
+
+        struct Schema {
+            size_t m_blobs { 0 };
+            size_t m_bytes { 0 };
+            size_t m_types { 0 };
+        };
+
+        struct Type {
+            std::string m_kind;
+
+            /**
+             * The most fields, and the deepest nesting, of any of its
+             * variants
+             */
+            size_t m_fields { 0 };
+            size_t m_depth { 0 };
+
+            size_t m_schemas { 0 };
+            std::set<std::string> m_descriptors;
+
+            /**
+             * Of each blob whose payload is one
+             */
+            std::vector<uint32_t> m_sizes;
+        };
+
+        mutable std::mutex m_lock;
+
+        size_t m_blobs;
+        size_t m_failures;
+
+        std::unordered_map<amqp::internal::cursor::Hash, Schema, KeyHash> m_schemas;
+
+        /**
+         * The type of each schema's payloads, by payload descriptor
+         */
+        std::map<std::string, std::string> m_payloads;
+
+        std::map<std::string, Type> m_types;
+
+        void survey (const amqp::internal::schema::Schema &);
+
+    public :
+        Census();
+
+        Census (const Census &) = delete;
+
+        /**
+         * Take a blob's envelope into account, throwing should it not be
+         * one, still counted but as a failure
+         */
+        void add (const CordaBytes &);
+
+        /**
+         * Count a blob that couldn't be read at all
+         */
+        void fail();
+
+        size_t blobs() const;
+        size_t schemas() const;
+
+        /**
+         * The fingerprint of a schema section as written out, its hash in
+         * hex
+         */
+        static std::string fingerprint (const amqp::internal::cursor::Hash &);
+
+        /**
+         * As a single JSON object, { "blobs", "failures", "schemas" :
+         * [ ... ], "types" : [ ... ] }, schemas most used first and types
+         * by name
+         */
+        void write (amqp::reader::ISink &) const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,395 @@
+#include "CppEmitter.h"
+
+#include <set>
+#include <cctype>
+#include <sstream>
+#include <ostream>
+#include <stdexcept>
+
+#include "CordaBytes.h"
+
+#include "cursor/Cursor.h"
+
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Map.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/List.h"
+#include "amqp/schema/restricted-types/Array.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    /**
+     * What each primitive the reflected codecs handle is decoded into
+     */
+    const std::map<std::string, std::string> primitives { // NOLINT
+        { "boolean", "bool" },
+        { "byte",    "int8_t" },
+        { "short",   "int16_t" },
+        { "int",     "int32_t" },
+        { "long",    "int64_t" },
+        { "float",   "float" },
+        { "double",  "double" },
+        { "char",    "char32_t" },
+        { "string",  "std::string" }
+    };
+
+    /**
+     * The most likely to turn up as a JVM property name
+     */
+    const std::set<std::string> keywords { // NOLINT
+        "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "continue", "default", "delete", "do", "double", "else", "enum",
+        "explicit", "false", "float", "for", "friend", "goto", "if", "inline",
+        "int", "long", "namespace", "new", "operator", "private", "protected",
+        "public", "register", "return", "short", "signed", "sizeof", "static",
+        "struct", "switch", "template", "this", "throw", "true", "try",
+        "typedef", "union", "unsigned", "using", "virtual", "void", "volatile",
+        "while"
+    };
+
+    /**
+     * The CORDA_ macros take no more than this many members
+     */
+    const size_t maxMembers = 16;
+
+    /**
+     * [name_] with every run of anything that can't be in an identifier
+     * replaced by a single underscore
+     */
+    std::string
+    sanitise (const std::string & name_) {
+        std::string rtn;
+
+        for (auto c : name_) {
+            if (std::isalnum (static_cast<unsigned char> (c))) {
+                rtn += c;
+            } else if (!rtn.empty() && rtn.back() != '_') {
+                rtn += '_';
+            }
+        }
+
+        while (!rtn.empty() && rtn.back() == '_') rtn.pop_back();
+
+        if (rtn.empty() || std::isdigit (static_cast<unsigned char> (rtn.front()))) {
+            rtn.insert (0, "_");
+        }
+
+        return rtn;
+    }
+
+    /**
+     * kotlin.Pair<long, string> becomes Pair_long_string
+     */
+    std::string
+    simpleName (const std::string & name_) {
+        auto generic = name_.find ('<');
+        auto dot = name_.rfind ('.', generic);
+
+        return sanitise (dot == std::string::npos ? name_ : name_.substr (dot + 1));
+    }
+
+    /**
+     * Members and constants are named for the JVM names they stand in for
+     */
+    const std::string &
+    member (const std::string & type_, const std::string & name_) {
+        bool valid = !name_.empty()
+            && !std::isdigit (static_cast<unsigned char> (name_.front()))
+            && !keywords.count (name_);
+
+        for (auto c : name_) {
+            valid = valid && (std::isalnum (static_cast<unsigned char> (c)) || c == '_');
+        }
+
+        if (!valid) {
+            throw std::runtime_error (
+                    type_ + "'s " + name_ + " can't be named in C++");
+        }
+
+        return name_;
+    }
+
+    std::unique_ptr<schema::Envelope>
+    envelope (const CordaBytes & blob_) {
+        amqp::internal::cursor::Cursor data (blob_.bytes(), blob_.size());
+        amqp::internal::cursor::auto_enter ae (data);
+
+        auto descriptor = data.get_ulong();
+
+        return std::unique_ptr<schema::Envelope> (
+                dynamic_cast<schema::Envelope *> (
+                        amqp::internal::AMQPDescriptorRegistory[descriptor]->build (
+                                data).release()));
+    }
+
+    const schema::Restricted *
+    restricted (const schema::AMQPTypeNotation * type_) {
+        return type_ && type_->type() == schema::AMQPTypeNotation::restricted_t
+            ? &dynamic_cast<const schema::Restricted &> (*type_)
+            : nullptr;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * CppEmitter
+ *
+ ******************************************************************************/
+
+CppEmitter::CppEmitter (std::string namespace_)
+    : m_namespace (std::move (namespace_))
+{ }
+
+/******************************************************************************/
+
+CppEmitter::~CppEmitter() = default;
+
+/******************************************************************************/
+
+void
+CppEmitter::add (const CordaBytes & blob_) {
+    auto envelope = ::envelope (blob_);
+
+    const auto & types = dynamic_cast<const schema::Schema &> (envelope->schema());
+
+    for (const auto & level : types) {
+        for (const auto & type : level) {
+            if (m_byName.count (type->name())) continue;
+
+            m_byName.emplace (type->name(), type.get());
+            m_types.push_back (type.get());
+
+            auto * r = restricted (type.get());
+
+            if (r ? r->restrictedType() == schema::Restricted::enum_t
+                  : !dynamic_cast<const schema::Composite &> (*type).fields().empty())
+            {
+                m_identifiers.emplace (type->name(), identifier (type->name()));
+            }
+        }
+    }
+
+    m_envelopes.push_back (std::move (envelope));
+}
+
+/******************************************************************************/
+
+/**
+ * A type's simple name unless another type already took it
+ */
+std::string
+CppEmitter::identifier (const std::string & name_) {
+    auto rtn = simpleName (name_);
+
+    for (const auto & identifier : m_identifiers) {
+        if (identifier.second == rtn) return sanitise (name_);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * The C++ type a property of the type named [name_] is decoded into,
+ * checking the reflected codec for it would name it as the blob does
+ */
+std::string
+CppEmitter::cppType (const std::string & name_) const {
+    auto primitive = primitives.find (name_);
+
+    if (primitive != primitives.end()) return primitive->second;
+
+    auto it = m_byName.find (name_);
+
+    if (it == m_byName.end()) {
+        throw std::runtime_error ("There's no C++ type for " + name_);
+    }
+
+    const auto * r = restricted (it->second);
+
+    if (!r || r->restrictedType() == schema::Restricted::enum_t) {
+        auto identifier = m_identifiers.find (name_);
+
+        if (identifier == m_identifiers.end()) {
+            throw std::runtime_error (name_ + " has no properties to decode");
+        }
+
+        return identifier->second;
+    }
+
+    std::string rtn;
+    std::string reflected;
+
+    switch (r->restrictedType()) {
+        case schema::Restricted::list_t : {
+            const auto & of = dynamic_cast<const schema::List &> (*r).listOf();
+
+            rtn = "std::vector<" + cppType (of) + ">";
+            reflected = "java.util.List<" + of + ">";
+            break;
+        }
+        case schema::Restricted::map_t : {
+            auto of = dynamic_cast<const schema::Map &> (*r).mapOf();
+
+            rtn = "std::map<" + cppType (of.first) + ", " + cppType (of.second) + ">";
+            reflected = "java.util.Map<" + of.first.get() + ", " + of.second.get() + ">";
+            break;
+        }
+        default : {
+            const auto & of = dynamic_cast<const schema::Array &> (*r).arrayOf();
+            bool packed = name_.size() > 3 && name_.compare (name_.size() - 3, 3, "[p]") == 0;
+
+            rtn = std::string ("amqp::internal::reflect::")
+                + (packed ? "PrimitiveArray<" : "Array<") + cppType (of) + ">";
+            reflected = of + (packed ? "[p]" : "[]");
+            break;
+        }
+    }
+
+    if (reflected != name_) {
+        throw std::runtime_error (
+                name_ + " can't be decoded into C++, it would be described as " + reflected);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+CppEmitter::composite (
+    std::ostream & out_,
+    const schema::AMQPTypeNotation & type_
+) const {
+    const auto & composite = dynamic_cast<const schema::Composite &> (type_);
+    const std::string indent (m_namespace.empty() ? 0 : 4, ' ');
+
+    if (composite.fields().empty()) {
+        out_ << indent << "// " << type_.name() << " has no properties" << std::endl;
+        return;
+    }
+
+    if (composite.fields().size() > maxMembers) {
+        throw std::runtime_error (type_.name() + " has too many properties");
+    }
+
+    const auto & identifier = m_identifiers.at (type_.name());
+
+    out_ << indent << "struct " << identifier << " {" << std::endl;
+
+    for (const auto & field : composite.fields()) {
+        auto type = cppType (field->resolvedType());
+
+        if (!field->mandatory()) type = "std::optional<" + type + ">";
+
+        out_ << indent << "    " << type << " " << member (type_.name(), field->name())
+             << ";" << std::endl;
+    }
+
+    out_ << indent << "};" << std::endl
+         << std::endl
+         << indent << "CORDA_SERIALIZABLE (" << identifier << ", \"" << type_.name() << "\"";
+
+    for (const auto & field : composite.fields()) {
+        out_ << ", " << field->name();
+    }
+
+    out_ << ")" << std::endl;
+}
+
+/******************************************************************************/
+
+void
+CppEmitter::enumeration (
+    std::ostream & out_,
+    const schema::AMQPTypeNotation & type_
+) const {
+    auto choices = dynamic_cast<const schema::Enum &> (type_).makeChoices();
+    const std::string indent (m_namespace.empty() ? 0 : 4, ' ');
+
+    if (choices.empty() || choices.size() > maxMembers) {
+        throw std::runtime_error (type_.name() + " has too many or too few constants");
+    }
+
+    const auto & identifier = m_identifiers.at (type_.name());
+
+    out_ << indent << "enum class " << identifier << " {" << std::endl;
+
+    for (size_t i { 0 } ; i < choices.size() ; ++i) {
+        out_ << indent << "    " << member (type_.name(), choices[i])
+             << (i + 1 < choices.size() ? "," : "") << std::endl;
+    }
+
+    out_ << indent << "};" << std::endl
+         << std::endl
+         << indent << "CORDA_ENUM (" << identifier << ", \"" << type_.name() << "\"";
+
+    for (const auto & choice : choices) out_ << ", " << choice;
+
+    out_ << ")" << std::endl;
+}
+
+/******************************************************************************/
+
+/**
+ * Lists, maps and arrays are spelt out where they're used, only composites
+ * and enums are declared
+ */
+void
+CppEmitter::emit (std::ostream & out_) const {
+    out_ << "#pragma once" << std::endl
+         << std::endl
+         << "/*" << std::endl
+         << " * Generated by schema-dumper --emit-cpp, edits will be lost" << std::endl
+         << " */" << std::endl
+         << std::endl
+         << "#include <map>" << std::endl
+         << "#include <string>" << std::endl
+         << "#include <vector>" << std::endl
+         << "#include <cstdint>" << std::endl
+         << "#include <optional>" << std::endl
+         << std::endl
+         << "#include \"reflect/Reflect.h\"" << std::endl;
+
+    if (!m_namespace.empty()) {
+        out_ << std::endl << "namespace " << m_namespace << " {" << std::endl;
+    }
+
+    for (const auto * type : m_types) {
+        auto * r = restricted (type);
+
+        if (r && r->restrictedType() != schema::Restricted::enum_t) continue;
+
+        out_ << std::endl;
+
+        if (r) {
+            enumeration (out_, *type);
+        } else {
+            composite (out_, *type);
+        }
+    }
+
+    if (!m_namespace.empty()) {
+        out_ << std::endl << "}" << std::endl;
+    }
+}
+
+/******************************************************************************/
+
+std::string
+CppEmitter::emit() const {
+    std::stringstream ss;
+    emit (ss);
+    return ss.str();
+}
+
+/******************************************************************************/
@@ -0,0 +1,81 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::internal::schema {
+
+    class Envelope;
+    class AMQPTypeNotation;
+
+}
+
+/******************************************************************************/
+
+/**
+ * Generates C++ for the types in the schemas of one or more blobs, a
+ * struct declared [CORDA_SERIALIZABLE] for each composite and an enum
+ * declared [CORDA_ENUM] for each enum. Lists, maps and arrays become the
+ * std::vector, std::map and reflect::Array the reflected codecs name the
+ * same way the JVM did, so the generated header is all that's needed to
+ * decode those blobs with reflect::decode, each type's decoder being the
+ * codec the header's types instantiate.
+ *
+ * Types are merged by name across blobs, the first blob to describe one
+ * deciding what it looks like, and emitted in dependency order. Anything
+ * that can't be represented, a property of a type without a C++
+ * equivalent say, throws when emitted.
+ */
+class CppEmitter {
+    private :
+        std::string m_namespace;
+
+        /**
+         * Kept for the types, which they own
+         */
+        std::vector<std::unique_ptr<amqp::internal::schema::Envelope>> m_envelopes;
+
+        /**
+         * Every type, in the order it's to be emitted
+         */
+        std::vector<const amqp::internal::schema::AMQPTypeNotation *> m_types;
+
+        std::map<std::string, const amqp::internal::schema::AMQPTypeNotation *> m_byName;
+
+        /**
+         * The identifier each type that becomes a declaration is given
+         */
+        std::map<std::string, std::string> m_identifiers;
+
+        std::string identifier (const std::string &);
+
+        std::string cppType (const std::string &) const;
+
+        void composite (std::ostream &, const amqp::internal::schema::AMQPTypeNotation &) const;
+        void enumeration (std::ostream &, const amqp::internal::schema::AMQPTypeNotation &) const;
+
+    public :
+        /**
+         * The generated code is wrapped in [namespace_] unless empty
+         */
+        explicit CppEmitter (std::string namespace_ = { });
+
+        ~CppEmitter();
+
+        void add (const CordaBytes &);
+
+        void emit (std::ostream &) const;
+
+        std::string emit() const;
+};
+
+/******************************************************************************/
@@ -0,0 +1,377 @@
+#include "SchemaDiff.h"
+
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Census.h"
+#include "CordaBytes.h"
+
+#include "cursor/Cursor.h"
+#include "sink/JsonSink.h"
+
+#include "amqp/ReaderCache.h"
+#include "amqp/reader/ISink.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    const char *
+    kind (const schema::AMQPTypeNotation & type_) {
+        if (type_.type() == schema::AMQPTypeNotation::composite_t) return "composite";
+
+        switch (dynamic_cast<const schema::Restricted &> (type_).restrictedType()) {
+            case schema::Restricted::list_t  : return "list";
+            case schema::Restricted::map_t   : return "map";
+            case schema::Restricted::enum_t  : return "enum";
+            default                          : return "array";
+        }
+    }
+
+    using Peek = schema::descriptors::EnvelopeDescriptor::Peek;
+
+    /**
+     * The schema of the envelope under [data_]
+     */
+    std::shared_ptr<const amqp::internal::ReaderCache::Entry>
+    compile (const amqp::internal::cursor::Cursor & data_, const Peek & peek_) {
+        namespace cursor = amqp::internal::cursor;
+
+        return amqp::internal::ReaderCache::instance().fetch (
+                peek_.m_schema,
+                [&data_]() {
+                    cursor::Cursor envelope { data_ };
+                    cursor::auto_enter p (envelope);
+
+                    auto a = envelope.get_ulong();
+
+                    return uPtr<schema::Envelope> (
+                            dynamic_cast<schema::Envelope *> (
+                                    amqp::internal::AMQPDescriptorRegistory[a]->build (envelope).release()));
+                });
+    }
+
+    const char *
+    name (SchemaDiff::Change change_) {
+        switch (change_) {
+            case SchemaDiff::typeAdded_t     : return "typeAdded";
+            case SchemaDiff::typeRemoved_t   : return "typeRemoved";
+            case SchemaDiff::kindChanged_t   : return "kindChanged";
+            case SchemaDiff::fieldAdded_t    : return "fieldAdded";
+            case SchemaDiff::fieldRemoved_t  : return "fieldRemoved";
+            case SchemaDiff::fieldRetyped_t  : return "fieldRetyped";
+            case SchemaDiff::choiceAdded_t   : return "choiceAdded";
+            default                          : return "choiceRemoved";
+        }
+    }
+
+    /**
+     * Walk two ranges sorted by [key_] together, calling [only_] for what
+     * only one has and [both_] for what both do
+     */
+    template<class T, class Key, class Only, class Both>
+    void
+    merge (
+        const std::vector<T> & from_,
+        const std::vector<T> & to_,
+        Key key_,
+        Only only_,
+        Both both_
+    ) {
+        auto from = from_.begin();
+        auto to = to_.begin();
+
+        while (from != from_.end() || to != to_.end()) {
+            if (to == to_.end() || (from != from_.end() && key_ (*from) < key_ (*to))) {
+                only_ (*from++, true);
+            } else if (from == from_.end() || key_ (*to) < key_ (*from)) {
+                only_ (*to++, false);
+            } else {
+                both_ (*from++, *to++);
+            }
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+SchemaDiff::Shape
+SchemaDiff::shape (const schema::Schema & schema_) {
+    Shape rtn;
+
+    for (const auto & level : schema_) {
+        for (const auto & type : level) {
+            Shape::Type shaped {
+                m_symbols.intern (type->name()),
+                m_symbols.intern (kind (*type)),
+                { },
+                { }
+            };
+
+            if (type->type() == schema::AMQPTypeNotation::composite_t) {
+                for (const auto & field : dynamic_cast<const schema::Composite &> (*type).fields()) {
+                    shaped.m_fields.emplace_back (
+                            m_symbols.intern (field->name()),
+                            m_symbols.intern (field->resolvedType()));
+                }
+
+                std::sort (shaped.m_fields.begin(), shaped.m_fields.end());
+            } else if (auto * e = dynamic_cast<const schema::Enum *> (type.get())) {
+                for (const auto & choice : e->makeChoices()) {
+                    shaped.m_choices.push_back (m_symbols.intern (choice));
+                }
+
+                std::sort (shaped.m_choices.begin(), shaped.m_choices.end());
+            }
+
+            rtn.m_types.push_back (std::move (shaped));
+        }
+    }
+
+    std::sort (rtn.m_types.begin(), rtn.m_types.end(), [](const auto & lhs_, const auto & rhs_) {
+        return lhs_.m_name < rhs_.m_name;
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+SchemaDiff::Shape
+SchemaDiff::shape (const CordaBytes & blob_) {
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    amqp::internal::cursor::Cursor data (blob_.bytes(), blob_.size());
+
+    auto entry = compile (data, schema::descriptors::EnvelopeDescriptor::peek (data));
+
+    return shape (dynamic_cast<const schema::Schema &> (entry->envelope().schema()));
+}
+
+/******************************************************************************/
+
+std::vector<SchemaDiff::Difference>
+SchemaDiff::diff (const Shape & from_, const Shape & to_) const {
+    std::vector<Difference> rtn;
+
+    merge (
+        from_.m_types,
+        to_.m_types,
+        [](const Shape::Type & type_) { return type_.m_name; },
+        [&rtn](const Shape::Type & type_, bool from_) {
+            if (from_) {
+                rtn.push_back ({ typeRemoved_t, type_.m_name, npos, type_.m_kind, npos });
+            } else {
+                rtn.push_back ({ typeAdded_t, type_.m_name, npos, npos, type_.m_kind });
+            }
+        },
+        [&rtn](const Shape::Type & from_, const Shape::Type & to_) {
+            const auto type = from_.m_name;
+
+            if (from_.m_kind != to_.m_kind) {
+                rtn.push_back ({ kindChanged_t, type, npos, from_.m_kind, to_.m_kind });
+                return;
+            }
+
+            if (from_.m_fields == to_.m_fields && from_.m_choices == to_.m_choices) return;
+
+            merge (
+                from_.m_fields,
+                to_.m_fields,
+                [](const std::pair<Id, Id> & field_) { return field_.first; },
+                [&rtn, type](const std::pair<Id, Id> & field_, bool from_) {
+                    if (from_) {
+                        rtn.push_back ({ fieldRemoved_t, type, field_.first, field_.second, npos });
+                    } else {
+                        rtn.push_back ({ fieldAdded_t, type, field_.first, npos, field_.second });
+                    }
+                },
+                [&rtn, type](const std::pair<Id, Id> & from_, const std::pair<Id, Id> & to_) {
+                    if (from_.second != to_.second) {
+                        rtn.push_back ({ fieldRetyped_t, type, from_.first, from_.second, to_.second });
+                    }
+                });
+
+            merge (
+                from_.m_choices,
+                to_.m_choices,
+                [](Id choice_) { return choice_; },
+                [&rtn, type](Id choice_, bool from_) {
+                    rtn.push_back ({ from_ ? choiceRemoved_t : choiceAdded_t, type, choice_, npos, npos });
+                },
+                [](Id, Id) { });
+        });
+
+    // only what differs meets a string
+    std::sort (rtn.begin(), rtn.end(), [this](const Difference & lhs_, const Difference & rhs_) {
+        static const std::string none;
+
+        const auto & lhsMember = lhs_.m_member == npos ? none : symbol (lhs_.m_member);
+        const auto & rhsMember = rhs_.m_member == npos ? none : symbol (rhs_.m_member);
+
+        return std::tie (symbol (lhs_.m_type), lhsMember, lhs_.m_change)
+             < std::tie (symbol (rhs_.m_type), rhsMember, rhs_.m_change);
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+SchemaDiff::write (const Difference & difference_, amqp::reader::ISink & sink_) const {
+    sink_.beginObject();
+
+    sink_.key ("type");
+    sink_.string (symbol (difference_.m_type));
+    sink_.key ("change");
+    sink_.string (name (difference_.m_change));
+
+    if (difference_.m_member != npos) {
+        const bool choice = difference_.m_change == choiceAdded_t
+            || difference_.m_change == choiceRemoved_t;
+
+        sink_.key (choice ? "choice" : "field");
+        sink_.string (symbol (difference_.m_member));
+    }
+
+    if (difference_.m_from != npos) {
+        sink_.key ("from");
+        sink_.string (symbol (difference_.m_from));
+    }
+
+    if (difference_.m_to != npos) {
+        sink_.key ("to");
+        sink_.string (symbol (difference_.m_to));
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+void
+Evolutions::add (const CordaBytes & blob_, size_t order_) {
+    namespace cursor = amqp::internal::cursor;
+    using schema::descriptors::EnvelopeDescriptor;
+
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    cursor::Cursor data (blob_.bytes(), blob_.size());
+
+    auto peek = EnvelopeDescriptor::peek (data);
+    auto hash = cursor::hash (peek.m_schema);
+
+    auto key = std::make_pair (std::make_pair (hash.m_low, hash.m_high), std::string (peek.m_descriptor));
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        auto seen = m_seen.find (key);
+
+        if (seen != m_seen.end()) {
+            auto & version = m_versions[seen->second.first][seen->second.second];
+            version.m_first = std::min (version.m_first, order_);
+            return;
+        }
+    }
+
+    // compiled outside of the lock
+    auto entry = compile (data, peek);
+    const auto & types = dynamic_cast<const schema::Schema &> (entry->envelope().schema());
+
+    if (types.descriptorId (peek.m_descriptor) == SchemaDiff::npos) {
+        throw std::runtime_error ("Schema has no type " + std::string (peek.m_descriptor));
+    }
+
+    const auto & type = types.fromDescriptor (peek.m_descriptor)->second.get()->name();
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto seen = m_seen.find (key);
+
+    if (seen != m_seen.end()) {
+        auto & version = m_versions[seen->second.first][seen->second.second];
+        version.m_first = std::min (version.m_first, order_);
+        return;
+    }
+
+    auto & versions = m_versions[type];
+
+    m_seen.emplace (std::move (key), std::make_pair (type, versions.size()));
+    versions.push_back ({ order_, Census::fingerprint (hash), m_diff.shape (types) });
+}
+
+/******************************************************************************/
+
+size_t
+Evolutions::versions() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    return m_seen.size();
+}
+
+/******************************************************************************/
+
+size_t
+Evolutions::lines (std::string & lines_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    size_t rtn { 0 };
+
+    for (const auto & type : m_versions) {
+        std::vector<const Version *> versions;
+        for (const auto & version : type.second) versions.push_back (&version);
+
+        std::sort (versions.begin(), versions.end(), [](const Version * lhs_, const Version * rhs_) {
+            return lhs_->m_first < rhs_->m_first;
+        });
+
+        for (size_t i { 1 } ; i < versions.size() ; ++i) {
+            auto differences = m_diff.diff (versions[i - 1]->m_shape, versions[i]->m_shape);
+
+            if (differences.empty()) continue;
+
+            {
+                amqp::internal::sink::JsonSink sink (lines_);
+
+                sink.beginObject();
+                sink.key ("payload");
+                sink.string (type.first);
+                sink.key ("from");
+                sink.string (versions[i - 1]->m_fingerprint);
+                sink.key ("to");
+                sink.string (versions[i]->m_fingerprint);
+                sink.key ("differences");
+                sink.beginList();
+
+                for (const auto & difference : differences) m_diff.write (difference, sink);
+
+                sink.endList();
+                sink.endObject();
+            }
+
+            lines_ += '\n';
+            ++rtn;
+        }
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,176 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "schema/SymbolTable.h"
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::schema {
+
+    class Schema;
+
+}
+
+/******************************************************************************/
+
+/**
+ * How the types of one schema differ from those of another, types being
+ * matched by name, fields by name and enum choices by name, as the JVM
+ * matches them when evolving a type.
+ *
+ * Every name either holds is interned into a table shared by every schema
+ * a [SchemaDiff] is given, so each becomes a [Shape], every type, field
+ * and choice in it an id, once, and comparing two shapes is a merge of
+ * sorted ids with no strings compared. A type that hasn't changed is
+ * told so by comparing two vectors of ids and never looked inside, so
+ * sweeping many versions of many types costs little more than the types
+ * that actually changed. Descriptors aren't trusted to tell, those this
+ * library writes fingerprinting only a type's name.
+ *
+ * Not safe to use from more than one thread at once.
+ */
+class SchemaDiff {
+    public :
+        using Id = amqp::internal::schema::SymbolTable::Id;
+
+        static constexpr Id npos = amqp::internal::schema::SymbolTable::npos;
+
+        enum Change {
+            typeAdded_t, typeRemoved_t, kindChanged_t,
+            fieldAdded_t, fieldRemoved_t, fieldRetyped_t,
+            choiceAdded_t, choiceRemoved_t
+        };
+
+        /**
+         * A schema with every name in it interned, each of its types and
+         * their fields sorted by id
+         */
+        struct Shape {
+            struct Type {
+                Id m_name;
+                Id m_kind;
+
+                /**
+                 * Each field's name and the type it resolves to
+                 */
+                std::vector<std::pair<Id, Id>> m_fields;
+                std::vector<Id> m_choices;
+            };
+
+            std::vector<Type> m_types;
+        };
+
+        /**
+         * [m_member] is the field or choice that changed, [npos] when it's
+         * the type, [m_from] and [m_to] the field's types or the type's
+         * kinds as each has it, [npos] for whichever doesn't
+         */
+        struct Difference {
+            Change m_change;
+            Id m_type;
+            Id m_member;
+            Id m_from;
+            Id m_to;
+        };
+
+    private :
+        amqp::internal::schema::SymbolTable m_symbols;
+
+    public :
+        SchemaDiff() = default;
+        SchemaDiff (const SchemaDiff &) = delete;
+
+        Shape shape (const amqp::internal::schema::Schema &);
+
+        /**
+         * The shape of a blob's schema, compiled through the [ReaderCache]
+         */
+        Shape shape (const CordaBytes &);
+
+        /**
+         * Everything that differs between the two, ordered by type name
+         * then member name
+         */
+        std::vector<Difference> diff (const Shape & from_, const Shape & to_) const;
+
+        const std::string & symbol (Id id_) const { return m_symbols[id_]; }
+
+        /**
+         * As a single JSON object, { "type" : ..., "change" : ... } and the
+         * field or choice, then the "from" and "to" as there are
+         */
+        void write (const Difference &, amqp::reader::ISink &) const;
+};
+
+/******************************************************************************/
+
+/**
+ * Every version of every type a corpus's blobs are of, taken from their
+ * schemas and diffed, one version against the next. A version is a
+ * distinct schema for the blobs' payload type, ordered by the first blob
+ * that had it, and as with a [Census] each is compiled once through the
+ * [ReaderCache] and only ever its [SchemaDiff::Shape] kept.
+ *
+ * [add] can be called from as many threads as there are at once, with the
+ * blob's position in the corpus, so versions are ordered the same however
+ * the blobs were shared out.
+ */
+class Evolutions {
+    private :
+        struct Version {
+            size_t m_first;
+            std::string m_fingerprint;
+            SchemaDiff::Shape m_shape;
+        };
+
+        mutable std::mutex m_lock;
+
+        SchemaDiff m_diff;
+
+        /**
+         * The payload type and version of each schema and payload
+         * descriptor seen
+         */
+        std::map<std::pair<std::pair<uint64_t, uint64_t>, std::string>, std::pair<std::string, size_t>> m_seen;
+
+        /**
+         * By payload type
+         */
+        std::map<std::string, std::vector<Version>> m_versions;
+
+    public :
+        Evolutions() = default;
+        Evolutions (const Evolutions &) = delete;
+
+        void add (const CordaBytes &, size_t order_);
+
+        /**
+         * How many versions there are of all the types
+         */
+        size_t versions() const;
+
+        /**
+         * A line of JSON for each version of each type that differs from
+         * the one before it, { "payload" : ..., "from" : ..., "to" : ...,
+         * "differences" : [ ... ] }, the versions named by their schema's
+         * fingerprint. Returns how many there were
+         */
+        size_t lines (std::string & lines_) const;
+};
+
+/******************************************************************************/
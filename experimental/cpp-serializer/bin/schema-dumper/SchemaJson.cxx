@@ -0,0 +1,140 @@
+#include "SchemaJson.h"
+
+#include <stdexcept>
+
+#include "CordaBytes.h"
+
+#include "cursor/Cursor.h"
+
+#include "amqp/ReaderCache.h"
+#include "amqp/reader/ISink.h"
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    const char *
+    kind (const schema::Restricted & type_) {
+        switch (type_.restrictedType()) {
+            case schema::Restricted::list_t  : return "list";
+            case schema::Restricted::map_t   : return "map";
+            case schema::Restricted::enum_t  : return "enum";
+            default                          : return "array";
+        }
+    }
+
+    void
+    writeFields (const schema::Composite & type_, amqp::reader::ISink & sink_) {
+        sink_.key ("fields");
+        sink_.beginList();
+
+        for (const auto & field : type_.fields()) {
+            sink_.beginObject();
+            sink_.key ("name");
+            sink_.string (field->name());
+            sink_.key ("type");
+            sink_.string (field->resolvedType());
+            sink_.key ("mandatory");
+            sink_.boolean (field->mandatory());
+            sink_.key ("multiple");
+            sink_.boolean (field->multiple());
+            sink_.endObject();
+        }
+
+        sink_.endList();
+    }
+
+    void
+    writeRestricted (const schema::Restricted & type_, amqp::reader::ISink & sink_) {
+        if (auto * e = dynamic_cast<const schema::Enum *> (&type_)) {
+            sink_.key ("choices");
+            sink_.beginList();
+            for (const auto & choice : e->makeChoices()) sink_.string (choice);
+            sink_.endList();
+        } else {
+            sink_.key ("of");
+            sink_.beginList();
+            for (const auto & element : type_) sink_.string (element);
+            sink_.endList();
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+void
+writeSchema (const schema::Schema & schema_, amqp::reader::ISink & sink_) {
+    sink_.beginObject();
+    sink_.key ("types");
+    sink_.beginList();
+
+    for (const auto & level : schema_) {
+        for (const auto & type : level) {
+            sink_.beginObject();
+            sink_.key ("name");
+            sink_.string (type->name());
+            sink_.key ("descriptor");
+            sink_.string (type->descriptor());
+
+            if (type->type() == schema::AMQPTypeNotation::composite_t) {
+                sink_.key ("kind");
+                sink_.string ("composite");
+
+                writeFields (dynamic_cast<const schema::Composite &> (*type), sink_);
+            } else {
+                const auto & restricted = dynamic_cast<const schema::Restricted &> (*type);
+
+                sink_.key ("kind");
+                sink_.string (kind (restricted));
+
+                writeRestricted (restricted, sink_);
+            }
+
+            sink_.endObject();
+        }
+    }
+
+    sink_.endList();
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+void
+writeSchema (const CordaBytes & blob_, amqp::reader::ISink & sink_) {
+    namespace cursor = amqp::internal::cursor;
+    using schema::descriptors::EnvelopeDescriptor;
+
+    if (blob_.encoding() != amqp::DATA_AND_STOP) {
+        throw std::runtime_error ("Bad encoding");
+    }
+
+    cursor::Cursor data (blob_.bytes(), blob_.size());
+
+    auto entry = amqp::internal::ReaderCache::instance().fetch (
+            EnvelopeDescriptor::peek (data).m_schema,
+            [&data]() {
+                cursor::Cursor envelope { data };
+                cursor::auto_enter p (envelope);
+
+                auto a = envelope.get_ulong();
+
+                return uPtr<schema::Envelope> (
+                        dynamic_cast<schema::Envelope *> (
+                                amqp::internal::AMQPDescriptorRegistory[a]->build (envelope).release()));
+            });
+
+    writeSchema (dynamic_cast<const schema::Schema &> (entry->envelope().schema()), sink_);
+}
+
+/******************************************************************************/
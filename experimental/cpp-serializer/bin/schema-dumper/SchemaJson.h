@@ -0,0 +1,38 @@
+#pragma once
+
+/******************************************************************************/
+
+class CordaBytes;
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::schema {
+
+    class Schema;
+
+}
+
+/******************************************************************************/
+
+/**
+ * A schema as a single JSON object, { "types" : [ ... ] }, its types in
+ * the order they depend on one another as the schema has them. Each has
+ * its "name", "descriptor" and "kind" and, as it's a composite, its
+ * "fields", each with its "name", "type", "mandatory" and "multiple",
+ * an enum its "choices" and a list, map or array the types it's "of".
+ *
+ * Written straight to the sink as the schema's walked, so nothing is
+ * held but the sink's buffer however large the schema.
+ */
+void writeSchema (const amqp::internal::schema::Schema &, amqp::reader::ISink &);
+
+/**
+ * The schema of a blob, compiled through the [ReaderCache]
+ */
+void writeSchema (const CordaBytes &, amqp::reader::ISink &);
+
+/******************************************************************************/
@@ -3,16 +3,14 @@
 #include <fstream>
 #include <cstddef>
 
-#include <assert.h>
-#include <string.h>
-#include <proton/types.h>
-#include <proton/codec.h>
-#include <sys/stat.h>
+#include <memory>
+#include <thread>
+#include <functional>
 #include <sstream>
 
 #include "debug.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 #include "amqp/AMQPHeader.h"
 #include "amqp/AMQPSectionId.h"
@@ -20,72 +18,401 @@
 
 #include "amqp/schema/described-types/Envelope.h"
 #include "amqp/CompositeFactory.h"
+#include "amqp/ReaderCache.h"
+#include "amqp/SchemaStore.h"
+#include "Batch.h"
+#include "Census.h"
+#include "Registry.h"
+#include "CordaBytes.h"
+#include "CppEmitter.h"
+#include "SchemaDiff.h"
+#include "SchemaJson.h"
+#include "WorkStealingPool.h"
+#include "sink/JsonSink.h"
+#include "stats/Stats.h"
 
 /******************************************************************************/
 
+/**
+ * Streamed straight out as it's read, never held whole
+ */
 void
-printNode (pn_data_t * d_) {
-    std::stringstream ss;
+printNode (amqp::internal::cursor::Cursor & d_) {
+    if (d_.is_described()) {
+        amqp::internal::AMQPDescriptorRegistory[22UL]->read (d_, std::cout);
+    }
+
+    std::cout << std::endl;
+}
+
 
-    if (pn_data_is_described (d_)) {
-        amqp::internal::AMQPDescriptorRegistory[22UL]->read (d_, ss);
+/******************************************************************************/
+
+/**
+ * Everything the blobs' schemas describe as C++, written to stdout
+ */
+int
+emitCpp (int arg_, int argc, char **argv) {
+    std::string ns;
+
+    if (arg_ + 1 < argc && std::string ("--namespace") == argv[arg_]) {
+        ns = argv[arg_ + 1];
+        arg_ += 2;
+    }
+
+    if (arg_ >= argc) {
+        std::cerr << "usage: " << argv[0]
+            << " --emit-cpp [--namespace ns] <blob|->..." << std::endl;
+        return EXIT_FAILURE;
     }
 
-    std::cout << ss.str() << std::endl;
+    CppEmitter emitter (ns);
+
+    try {
+        for ( ; arg_ < argc ; ++arg_) {
+            if (std::string ("-") == argv[arg_]) {
+                emitter.add (CordaBytes (std::cin));
+            } else {
+                emitter.add (CordaBytes (argv[arg_]));
+            }
+        }
+
+        emitter.emit (std::cout);
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
 }
 
+/******************************************************************************/
+
+/**
+ * What --census and --evolutions share
+ */
+struct Options {
+    size_t m_threads { 0 };
+    std::shared_ptr<const amqp::internal::SchemaStore> m_store;
+};
+
+/**
+ * Consume any of --threads, --schema-cache and --registry, each taking a
+ * value, leaving [arg_] on the first argument that isn't one
+ */
+Options
+options (int & arg_, int argc, char **argv) {
+    Options rtn;
+
+    for (; arg_ + 1 < argc && argv[arg_][0] == '-' && argv[arg_][1] == '-' ; arg_ += 2) {
+        std::string opt { argv[arg_] };
+
+        if (opt == "--threads") {
+            rtn.m_threads = std::strtoul (argv[arg_ + 1], nullptr, 10);
+        } else if (opt == "--schema-cache") {
+            rtn.m_store = std::make_shared<const amqp::internal::SchemaStore> (argv[arg_ + 1]);
+            amqp::internal::ReaderCache::instance().attach (rtn.m_store);
+        } else if (opt == "--registry") {
+            Registry::attach (std::make_shared<const Registry> (argv[arg_ + 1]));
+        } else {
+            break;
+        }
+    }
+
+    return rtn;
+}
 
 /******************************************************************************/
 
-void
-data_and_stop(std::ifstream & f_, ssize_t sz) {
-    char * blob = new char[sz];
-    memset (blob, 0, sz);
-    f_.read(blob, sz);
+/**
+ * Call [fn_] with every blob named by [arg_] and its position, on as many
+ * threads as asked for, reporting those that can't be read, or that [fn_]
+ * throws for, to stderr and to [failed_]. Schemas compiled along the way
+ * are saved to the store if there is one
+ */
+bool
+each (
+    const std::string & arg_,
+    const Options & options_,
+    const std::function<void (const CordaBytes &, size_t)> & fn_,
+    const std::function<void()> & failed_ = { }
+) {
+    std::vector<std::string> files;
+
+    try {
+        files = Batch::expand (arg_, std::cin);
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    {
+        auto threads = options_.m_threads;
+        WorkStealingPool pool (threads == 0 ? std::thread::hardware_concurrency() : threads);
+
+        for (size_t i { 0 } ; i < files.size() ; ++i) {
+            pool.submit ([&files, &fn_, &failed_, i]() {
+                std::unique_ptr<CordaBytes> bytes;
+
+                try {
+                    bytes = std::make_unique<CordaBytes> (files[i]);
+                } catch (const std::exception & e) {
+                    if (failed_) failed_();
+                    std::cerr << files[i] << ": " << e.what() << std::endl;
+                    return;
+                }
+
+                try {
+                    fn_ (*bytes, i);
+                } catch (const std::exception & e) {
+                    std::cerr << files[i] << ": " << e.what() << std::endl;
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    if (options_.m_store) {
+        try {
+            options_.m_store->save (amqp::internal::ReaderCache::instance());
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+/**
+ * A census of the schemas of every blob named, written to stdout as JSON
+ */
+int
+census (int arg_, int argc, char **argv) {
+    auto opts = options (arg_, argc, argv);
+
+    if (arg_ + 1 != argc) {
+        std::cerr << "usage: " << argv[0]
+            << " --census [--threads n] [--schema-cache file] [--registry file] <dir|glob|->" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Census census;
+
+    // add counts those it throws for itself as having failed
+    if (!each (
+            argv[arg_],
+            opts,
+            [&census](const CordaBytes & blob_, size_t) { census.add (blob_); },
+            [&census]() { census.fail(); }))
+    {
+        return EXIT_FAILURE;
+    }
 
-    pn_data_t * d = pn_data(sz);
+    amqp::internal::sink::JsonSink sink (std::cout);
+    census.write (sink);
+    sink.flush();
 
-    // returns how many bytes we processed which right now we don't care
-    // about but I assume there is a case where it doesn't process the
-    // entire file
-    auto rtn = pn_data_decode (d, blob, sz);
-    assert (rtn == sz);
+    std::cout << std::endl;
 
-    printNode (d);
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
+
+/**
+ * Every version of each type the blobs named are of diffed against the
+ * last, a line of JSON for each to stdout
+ */
+int
+evolutions (int arg_, int argc, char **argv) {
+    auto opts = options (arg_, argc, argv);
+
+    if (arg_ + 1 != argc) {
+        std::cerr << "usage: " << argv[0]
+            << " --evolutions [--threads n] [--schema-cache file] [--registry file] <dir|glob|->" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Evolutions evolutions;
+
+    if (!each (argv[arg_], opts, [&evolutions](const CordaBytes & blob_, size_t order_) {
+            evolutions.add (blob_, order_);
+        }))
+    {
+        return EXIT_FAILURE;
+    }
 
+    std::string lines;
+    evolutions.lines (lines);
+
+    std::cout << lines;
+
+    return EXIT_SUCCESS;
 }
 
 /******************************************************************************/
 
+/**
+ * How the schemas of two blobs differ, a line of JSON for each difference
+ * to stdout
+ */
+int
+schemaDiff (int arg_, int argc, char **argv) {
+    auto opts = options (arg_, argc, argv);
+
+    if (arg_ + 2 != argc) {
+        std::cerr << "usage: " << argv[0]
+            << " --schema-diff [--registry file] <from> <to>" << std::endl;
+        return 2;
+    }
+
+    SchemaDiff diff;
+    std::vector<SchemaDiff::Difference> differences;
+
+    try {
+        auto from = diff.shape (CordaBytes (argv[arg_]));
+        auto to = diff.shape (CordaBytes (argv[arg_ + 1]));
+
+        differences = diff.diff (from, to);
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    for (const auto & difference : differences) {
+        amqp::internal::sink::JsonSink sink (std::cout);
+        diff.write (difference, sink);
+        sink.flush();
+
+        std::cout << std::endl;
+    }
+
+    return differences.empty() ? EXIT_SUCCESS : 1;
+}
+
+/******************************************************************************/
+
+/**
+ * With --census every blob of the directory, glob or, given "-", list of
+ * files on stdin is read just as far as its schema, see [Census], and
+ * what they hold, summed up over all of them, written out as JSON. The
+ * blobs are read on as many threads as the machine has unless told
+ * otherwise by --threads, and with --schema-cache schemas are restored
+ * from and saved to the file given as blob-inspector does. --registry
+ * reads blobs stripped by blob-registry.
+ *
+ * With --evolutions the blobs are read the same way and every version of
+ * each type they're of, a distinct schema, diffed against the one before
+ * it, see [Evolutions], each that differs written as a line of JSON.
+ *
+ * With --schema-diff the schemas of just the two blobs given are diffed,
+ * see [SchemaDiff], each difference written as a line of JSON, exiting
+ * 0 if there were none, 1 if there were and 2 if they couldn't be read.
+ *
+ * With --emit-cpp a header declaring C++ types the blobs can be decoded
+ * into is generated instead, see [CppEmitter].
+ *
+ * Otherwise the blob's envelope is dumped as it's read, or with --json
+ * just its schema is written as a single JSON object, see [writeSchema].
+ *
+ * With --stats the time spent reading and dumping the blob is written to
+ * stderr as JSON once done
+ */
 int
 main (int argc, char **argv) {
-    struct stat results { };
+    using amqp::internal::stats::Stats;
+
+    int arg { 1 };
+
+    if (arg < argc && std::string ("--emit-cpp") == argv[arg]) {
+        return emitCpp (arg + 1, argc, argv);
+    }
+
+    if (arg < argc && std::string ("--census") == argv[arg]) {
+        return census (arg + 1, argc, argv);
+    }
+
+    if (arg < argc && std::string ("--evolutions") == argv[arg]) {
+        return evolutions (arg + 1, argc, argv);
+    }
+
+    if (arg < argc && std::string ("--schema-diff") == argv[arg]) {
+        return schemaDiff (arg + 1, argc, argv);
+    }
+
+    bool json { false };
+
+    for ( ; arg < argc ; ++arg) {
+        if (std::string ("--stats") == argv[arg]) {
+            Stats::enable();
+        } else if (std::string ("--json") == argv[arg]) {
+            json = true;
+        } else {
+            break;
+        }
+    }
 
-    if (stat(argv[1], &results) != 0) {
+    if (arg >= argc) {
+        std::cerr << "usage: " << argv[0] << " [--stats] [--json] <blob|->" << std::endl
+                  << "       " << argv[0] << " --emit-cpp [--namespace ns] <blob|->..." << std::endl
+                  << "       " << argv[0] << " --census [--threads n] [--schema-cache file] [--registry file] <dir|glob|->" << std::endl
+                  << "       " << argv[0] << " --evolutions [--threads n] [--schema-cache file] [--registry file] <dir|glob|->" << std::endl
+                  << "       " << argv[0] << " --schema-diff [--registry file] <from> <to>" << std::endl;
         return EXIT_FAILURE;
     }
 
-    std::ifstream f (argv[1], std::ios::in | std::ios::binary);
-    std::array<char, 7> header { };
-    f.read(header.data(), 7);
+    std::unique_ptr<CordaBytes> bytes;
 
-    if (header != amqp::AMQP_HEADER) {
-        std::cerr << "Bad Header in blob" << std::endl;
+    try {
+        if (std::string ("-") == argv[arg]) {
+            bytes = std::make_unique<CordaBytes> (std::cin);
+        } else {
+            bytes = std::make_unique<CordaBytes> (argv[arg]);
+        }
+    } catch (const std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
-    amqp::amqp_section_id_t encoding;
-    f.read((char *)&encoding, 1);
+    if (bytes->encoding() == amqp::DATA_AND_STOP) {
+        amqp::internal::cursor::Cursor d (bytes->bytes(), bytes->size());
 
-    if (encoding == amqp::DATA_AND_STOP) {
-        data_and_stop(f, results.st_size - 8);
+        Stats::count (Stats::blobs_t);
+
+        try {
+            Stats::Timer timer (Stats::render_t);
+
+            if (json) {
+                amqp::internal::sink::JsonSink sink (std::cout);
+                writeSchema (*bytes, sink);
+                sink.flush();
+
+                std::cout << std::endl;
+            } else {
+                printNode (d);
+            }
+        } catch (const std::runtime_error & e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
     } else {
-        std::cerr << "BAD ENCODING " << encoding << " != "
+        std::cerr << "BAD ENCODING " << bytes->encoding() << " != "
             << amqp::DATA_AND_STOP << std::endl;
 
         return EXIT_FAILURE;
     }
 
+    if (Stats::enabled()) {
+        amqp::internal::sink::JsonSink sink (std::cerr);
+        Stats::instance().write (sink);
+        sink.flush();
+
+        std::cerr << std::endl;
+    }
+
     return EXIT_SUCCESS;
 }
 
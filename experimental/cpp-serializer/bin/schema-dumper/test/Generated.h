@@ -0,0 +1,66 @@
+#pragma once
+
+/*
+ * Generated by schema-dumper --emit-cpp, edits will be lost
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+#include "reflect/Reflect.h"
+
+namespace generated {
+
+    struct is {
+        int32_t a;
+        std::string b;
+    };
+
+    CORDA_SERIALIZABLE (is, "net.corda.blobwriter._is_", a, b)
+
+    struct i_is {
+        int32_t a;
+        is b;
+    };
+
+    CORDA_SERIALIZABLE (i_is, "net.corda.blobwriter._i_is__", a, b)
+
+    enum class E {
+        A,
+        B,
+        C
+    };
+
+    CORDA_ENUM (E, "net.corda.blobwriter.E", A, B, C)
+
+    struct e {
+        E e;
+    };
+
+    CORDA_SERIALIZABLE (e, "net.corda.blobwriter._e_", e)
+
+    struct Ci {
+        amqp::internal::reflect::PrimitiveArray<int32_t> z;
+    };
+
+    CORDA_SERIALIZABLE (Ci, "net.corda.blobwriter._Ci_", z)
+
+    struct Pair_long_string {
+        int64_t first;
+        std::string second;
+    };
+
+    CORDA_SERIALIZABLE (Pair_long_string, "kotlin.Pair<long, string>", first, second)
+
+    // java.io.Serializable has no properties
+
+    struct Pls {
+        Pair_long_string a;
+    };
+
+    CORDA_SERIALIZABLE (Pls, "net.corda.blobwriter._Pls_", a)
+
+}
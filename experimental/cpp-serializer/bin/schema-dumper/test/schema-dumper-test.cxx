@@ -0,0 +1,451 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Census.h"
+#include "CordaBytes.h"
+#include "CppEmitter.h"
+#include "SchemaDiff.h"
+#include "SchemaJson.h"
+#include "sink/JsonSink.h"
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+#include "serialiser/Serialiser.h"
+
+/*
+ * What schema-dumper --emit-cpp --namespace generated makes of _i_is__,
+ * _e_, _Ci_ and _Pls_
+ */
+#include "Generated.h"
+
+/******************************************************************************/
+
+const std::string filepath (SCHEMA_DUMPER_TEST_DIR "/../../test-files/"); // NOLINT
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    emit (std::initializer_list<const char *> files_, std::string namespace_ = { }) {
+        CppEmitter emitter (std::move (namespace_));
+
+        for (const auto * file : files_) {
+            emitter.add (CordaBytes (filepath + file));
+        }
+
+        return emitter.emit();
+    }
+
+    /**
+     * Everything after the includes
+     */
+    std::string
+    body (const std::string & emitted_) {
+        const std::string include { "#include \"reflect/Reflect.h\"\n" };
+
+        auto pos = emitted_.find (include);
+        EXPECT_NE (std::string::npos, pos);
+
+        return emitted_.substr (pos + include.size());
+    }
+
+    template<class T>
+    T
+    decode (const char * file_) {
+        CordaBytes cb (filepath + file_);
+        return amqp::internal::reflect::decode<T> (cb.bytes(), cb.size());
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Everything a type depends on is declared before it
+ */
+TEST (CppEmitter, composites) { // NOLINT
+    EXPECT_EQ (
+        "\n"
+        "struct is {\n"
+        "    int32_t a;\n"
+        "    std::string b;\n"
+        "};\n"
+        "\n"
+        "CORDA_SERIALIZABLE (is, \"net.corda.blobwriter._is_\", a, b)\n"
+        "\n"
+        "struct i_is {\n"
+        "    int32_t a;\n"
+        "    is b;\n"
+        "};\n"
+        "\n"
+        "CORDA_SERIALIZABLE (i_is, \"net.corda.blobwriter._i_is__\", a, b)\n",
+        body (emit ({ "_i_is__" })));
+}
+
+/******************************************************************************/
+
+TEST (CppEmitter, restricted) { // NOLINT
+    EXPECT_NE (std::string::npos, emit ({ "__i_LMis_l__" }).find (
+            "    std::vector<std::map<int32_t, std::string>> x;\n"
+            "    l y;\n"
+            "    i z;\n"));
+
+    EXPECT_NE (std::string::npos, emit ({ "_ALd_" }).find (
+            "amqp::internal::reflect::Array<std::vector<double>> a;"));
+
+    EXPECT_EQ (
+        "\n"
+        "enum class E {\n"
+        "    A,\n"
+        "    B,\n"
+        "    C\n"
+        "};\n"
+        "\n"
+        "CORDA_ENUM (E, \"net.corda.blobwriter.E\", A, B, C)\n"
+        "\n"
+        "struct Le {\n"
+        "    std::vector<E> listy;\n"
+        "};\n"
+        "\n"
+        "CORDA_SERIALIZABLE (Le, \"net.corda.blobwriter._Le_\", listy)\n",
+        body (emit ({ "_Le_" })));
+}
+
+/******************************************************************************/
+
+/**
+ * A type described by more than one blob is only declared once
+ */
+TEST (CppEmitter, merged) { // NOLINT
+    auto emitted = body (emit ({ "_i_", "_L_i__", "__i_LMis_l__" }));
+
+    size_t declared { 0 };
+    for (auto pos = emitted.find ("struct i {") ;
+         pos != std::string::npos ;
+         pos = emitted.find ("struct i {", pos + 1))
+    {
+        ++declared;
+    }
+
+    EXPECT_EQ (1U, declared);
+    EXPECT_LT (emitted.find ("struct i {"), emitted.find ("struct L_i {"));
+    EXPECT_LT (emitted.find ("struct l {"), emitted.find ("struct i_LMis_l {"));
+}
+
+/******************************************************************************/
+
+/**
+ * The checked in header is what the emitter makes of its blobs today, and
+ * those blobs decode into it
+ */
+TEST (CppEmitter, generated) { // NOLINT
+    std::ifstream in (SCHEMA_DUMPER_TEST_DIR "/Generated.h");
+    ASSERT_TRUE (in.good());
+
+    std::stringstream expected;
+    expected << in.rdbuf();
+
+    EXPECT_EQ (expected.str(), emit ({ "_i_is__", "_e_", "_Ci_", "_Pls_" }, "generated"));
+
+    auto iis = decode<generated::i_is> ("_i_is__");
+    EXPECT_EQ (1, iis.a);
+    EXPECT_EQ (2, iis.b.a);
+    EXPECT_EQ ("three", iis.b.b);
+
+    EXPECT_EQ (generated::E::A, decode<generated::e> ("_e_").e);
+
+    auto ci = decode<generated::Ci> ("_Ci_");
+    EXPECT_EQ ((std::vector<int32_t> { 1, 2, 3 }), ci.z);
+
+    auto pls = decode<generated::Pls> ("_Pls_");
+    EXPECT_EQ (1, pls.a.first);
+    EXPECT_EQ ("two", pls.a.second);
+}
+
+/******************************************************************************/
+
+/**
+ * Enum constants are matched to the JVM's by name, however the two number
+ * them, and one the C++ enum lacks can't be decoded
+ */
+namespace reordered {
+
+    enum class E { B, A, C };
+
+    CORDA_ENUM (E, "net.corda.blobwriter.E", B, A, C)
+
+    struct e {
+        E e;
+    };
+
+    CORDA_SERIALIZABLE (e, "net.corda.blobwriter._e_", e)
+
+}
+
+namespace removed {
+
+    enum class E { B, C };
+
+    CORDA_ENUM (E, "net.corda.blobwriter.E", B, C)
+
+    struct e {
+        E e;
+    };
+
+    CORDA_SERIALIZABLE (e, "net.corda.blobwriter._e_", e)
+
+}
+
+TEST (CppEmitter, reordered) { // NOLINT
+    EXPECT_EQ (reordered::E::A, decode<reordered::e> ("_e_").e);
+    EXPECT_THROW (decode<removed::e> ("_e_"), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    census (std::initializer_list<const char *> files_) {
+        Census census;
+
+        for (const auto * file : files_) {
+            census.add (CordaBytes (filepath + file));
+        }
+
+        std::string rtn;
+        {
+            amqp::internal::sink::JsonSink sink (rtn);
+            census.write (sink);
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * _Le_ and _Le_2 share a schema, a list of enums nesting inside their
+ * composite
+ */
+TEST (Census, shared) { // NOLINT
+    EXPECT_EQ (
+        "{\"blobs\":2,\"failures\":0,"
+        "\"schemas\":[{\"fingerprint\":\"c07654728ca9644740310424333929b8\",\"blobs\":2,\"bytes\":460,\"types\":3}],"
+        "\"types\":["
+        "{\"name\":\"java.util.List<net.corda.blobwriter.E>\",\"kind\":\"list\",\"schemas\":1,\"variants\":1,\"depth\":1},"
+        "{\"name\":\"net.corda.blobwriter.E\",\"kind\":\"enum\",\"schemas\":1,\"variants\":1,\"depth\":0},"
+        "{\"name\":\"net.corda.blobwriter._Le_\",\"kind\":\"composite\",\"schemas\":1,\"variants\":1,"
+        "\"fields\":1,\"depth\":2,\"blobs\":2,"
+        "\"sizes\":{\"min\":707,\"mean\":718,\"p50\":707,\"p90\":730,\"p99\":730,\"max\":730}}]}",
+        census ({ "_Le_", "_Le_2" }));
+}
+
+/******************************************************************************/
+
+/**
+ * _i_ is both a blob of its own and nested in __i_LMis_l__, whose schema
+ * describes it the same way
+ */
+TEST (Census, types) { // NOLINT
+    Census census;
+
+    census.add (CordaBytes (filepath + "_i_"));
+    census.add (CordaBytes (filepath + "__i_LMis_l__"));
+    census.add (CordaBytes (filepath + "_i_"));
+
+    EXPECT_EQ (3U, census.blobs());
+    EXPECT_EQ (2U, census.schemas());
+
+    std::string json;
+    {
+        amqp::internal::sink::JsonSink sink (json);
+        census.write (sink);
+    }
+
+    EXPECT_NE (std::string::npos, json.find (
+        "{\"name\":\"net.corda.blobwriter._i_\",\"kind\":\"composite\",\"schemas\":2,\"variants\":1,"
+        "\"fields\":1,\"depth\":1,\"blobs\":2,"));
+
+    EXPECT_NE (std::string::npos, json.find (
+        "{\"name\":\"java.util.List<java.util.Map<int, string>>\",\"kind\":\"list\",\"schemas\":1,\"variants\":1,\"depth\":2}"));
+
+    EXPECT_NE (std::string::npos, json.find (
+        "{\"name\":\"net.corda.blobwriter.__i_LMis_l__\",\"kind\":\"composite\",\"schemas\":1,\"variants\":1,"
+        "\"fields\":3,\"depth\":3,\"blobs\":1,"));
+}
+
+/******************************************************************************/
+
+TEST (Census, failures) { // NOLINT
+    Census census;
+
+    std::vector<char> notAnEnvelope (amqp::AMQP_HEADER.begin(), amqp::AMQP_HEADER.end());
+    notAnEnvelope.push_back (amqp::DATA_AND_STOP);
+    notAnEnvelope.push_back ('\x40');
+
+    EXPECT_THROW (census.add (CordaBytes (std::move (notAnEnvelope))), std::runtime_error); // NOLINT
+    census.fail();
+
+    EXPECT_EQ (2U, census.blobs());
+    EXPECT_EQ (0U, census.schemas());
+}
+
+/******************************************************************************/
+
+/**
+ * Two versions of the same class, as a CorDapp's might be either side of
+ * an upgrade
+ */
+namespace before {
+
+    enum class Status { ISSUED, SETTLED };
+
+    CORDA_ENUM (Status, "net.corda.test.Status", ISSUED, SETTLED)
+
+    struct Trade {
+        int32_t amount;
+        std::string party;
+        Status status;
+    };
+
+    CORDA_SERIALIZABLE (Trade, "net.corda.test.Trade", amount, party, status)
+
+}
+
+namespace after {
+
+    enum class Status { ISSUED, SETTLED, DISPUTED };
+
+    CORDA_ENUM (Status, "net.corda.test.Status", ISSUED, SETTLED, DISPUTED)
+
+    struct Trade {
+        int64_t amount;
+        Status status;
+        std::optional<std::string> memo;
+    };
+
+    CORDA_SERIALIZABLE (Trade, "net.corda.test.Trade", amount, status, memo)
+
+}
+
+namespace {
+
+    template<class T>
+    CordaBytes
+    serialise (const T & value_) {
+        serialiser::Serialiser serialiser;
+        std::stringstream ss (serialiser.serialise (
+                amqp::internal::reflect::Serializable<T> (value_)));
+
+        return CordaBytes (ss);
+    }
+
+    std::string
+    diff (const CordaBytes & from_, const CordaBytes & to_) {
+        SchemaDiff differ;
+
+        auto from = differ.shape (from_);
+        auto to = differ.shape (to_);
+
+        std::string rtn;
+
+        for (const auto & difference : differ.diff (from, to)) {
+            {
+                amqp::internal::sink::JsonSink sink (rtn);
+                differ.write (difference, sink);
+            }
+
+            rtn += '\n';
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (SchemaDiff, evolved) { // NOLINT
+    auto from = serialise (before::Trade { 1, "alice", before::Status::ISSUED });
+    auto to = serialise (after::Trade { 2, after::Status::DISPUTED, { } });
+
+    EXPECT_EQ (
+        "{\"type\":\"net.corda.test.Status\",\"change\":\"choiceAdded\",\"choice\":\"DISPUTED\"}\n"
+        "{\"type\":\"net.corda.test.Trade\",\"change\":\"fieldRetyped\",\"field\":\"amount\",\"from\":\"int\",\"to\":\"long\"}\n"
+        "{\"type\":\"net.corda.test.Trade\",\"change\":\"fieldAdded\",\"field\":\"memo\",\"to\":\"string\"}\n"
+        "{\"type\":\"net.corda.test.Trade\",\"change\":\"fieldRemoved\",\"field\":\"party\",\"from\":\"string\"}\n",
+        diff (from, to));
+
+    EXPECT_EQ ("", diff (from, serialise (before::Trade { 3, "bob", before::Status::SETTLED })));
+}
+
+/******************************************************************************/
+
+TEST (SchemaDiff, types) { // NOLINT
+    EXPECT_EQ (
+        "{\"type\":\"net.corda.blobwriter._Oi_\",\"change\":\"typeAdded\",\"to\":\"composite\"}\n"
+        "{\"type\":\"net.corda.blobwriter._i_\",\"change\":\"typeRemoved\",\"from\":\"composite\"}\n",
+        diff (CordaBytes (filepath + "_i_"), CordaBytes (filepath + "_Oi_")));
+}
+
+/******************************************************************************/
+
+/**
+ * Versions are ordered by where in the corpus each first turned up, not
+ * by when they were added
+ */
+TEST (Evolutions, versions) { // NOLINT
+    Evolutions evolutions;
+
+    evolutions.add (serialise (after::Trade { 2, after::Status::SETTLED, { "m" } }), 2);
+    evolutions.add (serialise (before::Trade { 1, "alice", before::Status::ISSUED }), 0);
+    evolutions.add (serialise (before::Trade { 3, "bob", before::Status::SETTLED }), 1);
+    evolutions.add (CordaBytes (filepath + "_i_"), 3);
+
+    EXPECT_EQ (3U, evolutions.versions());
+
+    std::string lines;
+    EXPECT_EQ (1U, evolutions.lines (lines));
+
+    EXPECT_EQ (0U, lines.find ("{\"payload\":\"net.corda.test.Trade\",\"from\":\""));
+    EXPECT_NE (std::string::npos, lines.find (
+        "\"differences\":[{\"type\":\"net.corda.test.Status\",\"change\":\"choiceAdded\",\"choice\":\"DISPUTED\"},"));
+    EXPECT_EQ ('\n', lines.back());
+}
+
+/******************************************************************************/
+
+TEST (SchemaJson, types) { // NOLINT
+    std::string json;
+    {
+        amqp::internal::sink::JsonSink sink (json);
+        writeSchema (CordaBytes (filepath + "_e_"), sink);
+    }
+
+    EXPECT_EQ (
+        "{\"types\":["
+        "{\"name\":\"net.corda.blobwriter.E\",\"descriptor\":\"net.corda:JUvoNLzcBYqyDF5qASLd4Q==\","
+        "\"kind\":\"enum\",\"choices\":[\"A\",\"B\",\"C\"]},"
+        "{\"name\":\"net.corda.blobwriter._e_\",\"descriptor\":\"net.corda:yAHRPBnor3W+WfNP9+FzWg==\","
+        "\"kind\":\"composite\",\"fields\":["
+        "{\"name\":\"e\",\"type\":\"net.corda.blobwriter.E\",\"mandatory\":true,\"multiple\":false}]}]}",
+        json);
+
+    json.clear();
+    {
+        amqp::internal::sink::JsonSink sink (json);
+        writeSchema (CordaBytes (filepath + "_Mis_"), sink);
+    }
+
+    EXPECT_NE (std::string::npos, json.find ("\"kind\":\"map\",\"of\":[\"int\",\"string\"]}"));
+}
+
+/******************************************************************************/
@@ -11,7 +11,13 @@ namespace amqp {
     enum amqp_section_id_t {
         DATA_AND_STOP     = 0,
         ALT_DATA_AND_STOP = 1,
-        ENCODING          = 2
+        ENCODING          = 2,
+
+        /*
+         * Not one Corda writes, a payload whose envelope has had its
+         * schema moved out into a registry, see blob-inspector's Registry
+         */
+        REGISTERED        = 0x52
     };
 
 }
@@ -23,8 +23,11 @@ namespace amqp {
 
             virtual void process (const SchemaType &) = 0;
 
-            virtual const std::shared_ptr<ReaderType> byType (const std::string &) = 0;
-            virtual const std::shared_ptr<ReaderType> byDescriptor (const std::string &) = 0;
+            /**
+             * Owned by the factory, and valid for as long as it is
+             */
+            virtual const ReaderType * byType (const std::string &) = 0;
+            virtual const ReaderType * byDescriptor (const std::string &) = 0;
     };
 
 }
@@ -3,8 +3,11 @@
 /******************************************************************************/
 
 #include <any>
+#include <cstddef>
 
 #include "amqp/AMQPDescribed.h"
+#include "amqp/reader/ISink.h"
+#include "amqp/reader/IVisitor.h"
 
 #include "amqp/schema/described-types/Schema.h"
 
@@ -14,7 +17,11 @@
  *
  ******************************************************************************/
 
-struct pn_data_t;
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
 
 /******************************************************************************
  *
@@ -34,6 +41,14 @@ namespace amqp::reader {
             virtual std::string dump() const = 0;
 
             virtual ~IValue() = default;
+
+            /**
+             * Values are carved out of the calling thread's current
+             * [amqp::internal::reader::Arena] when there is one, falling
+             * back to the heap when there isn't
+             */
+            static void * operator new (std::size_t);
+            static void operator delete (void *) noexcept;
     };
 
 }
@@ -56,16 +71,57 @@ namespace amqp::reader {
             virtual const std::string & name() const = 0;
             virtual const std::string & type() const = 0;
 
-            virtual std::any read (pn_data_t *) const = 0;
-            virtual std::string readString (pn_data_t *) const = 0;
+            virtual std::any read (amqp::internal::cursor::Cursor &) const = 0;
+            virtual std::string readString (amqp::internal::cursor::Cursor &) const = 0;
 
+            /**
+             * Step over the value this reader would decode, leaving the
+             * cursor on its next sibling, without looking inside it
+             */
+            virtual void skip (amqp::internal::cursor::Cursor &) const = 0;
+
+            /**
+             * The value returned refers to, rather than copies, the name
+             * it's given, which must therefore outlive it. Typically that
+             * name is owned by the schema.
+             */
             virtual std::unique_ptr<IValue> dump(
                     const std::string &,
-                    pn_data_t *,
+                    amqp::internal::cursor::Cursor &,
                     const SchemaType &) const = 0;
 
             virtual std::unique_ptr<IValue> dump(
-                    pn_data_t *,
+                    amqp::internal::cursor::Cursor &,
+                    const SchemaType &) const = 0;
+
+            /**
+             * Stream the value into [ISink] rather than building a tree
+             * of [IValue]s to be rendered afterwards.
+             */
+            virtual void write (
+                    const std::string &,
+                    amqp::internal::cursor::Cursor &,
+                    ISink &,
+                    const SchemaType &) const = 0;
+
+            virtual void write (
+                    amqp::internal::cursor::Cursor &,
+                    ISink &,
+                    const SchemaType &) const = 0;
+
+            /**
+             * Drive [IVisitor] straight from the blob, the named form
+             * introducing the value as a composite's field.
+             */
+            virtual void visit (
+                    const std::string &,
+                    amqp::internal::cursor::Cursor &,
+                    IVisitor &,
+                    const SchemaType &) const = 0;
+
+            virtual void visit (
+                    amqp::internal::cursor::Cursor &,
+                    IVisitor &,
                     const SchemaType &) const = 0;
 
     };
@@ -0,0 +1,120 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::reader::ISink
+ *
+ ******************************************************************************/
+
+/**
+ * The streaming alternative to building an [IValue] tree. As a reader
+ * walks the blob it emits a flat sequence of tokens into a sink which is
+ * free to render them however it likes as they arrive.
+ *
+ * Composites are objects, their fields being introduced by a [key]. Maps
+ * alternate between key and value, with the key being whatever value the
+ * map's key reader emits.
+ */
+namespace amqp::reader {
+
+    class ISink {
+        public :
+            /**
+             * An object's key rendered ahead of time, once, by whatever
+             * compiled the object's plan, in each format that can simply
+             * copy it out. Any of them may be empty, [m_name] never is
+             */
+            struct Key {
+                std::string_view m_name;
+
+                /**
+                 * Comma, quoted and escaped name, then colon
+                 */
+                std::string_view m_json;
+
+                /**
+                 * A CBOR text string, head and bytes
+                 */
+                std::string_view m_cbor;
+            };
+
+            virtual ~ISink() = default;
+
+            virtual void beginObject() = 0;
+            virtual void endObject() = 0;
+
+            virtual void beginList() = 0;
+            virtual void endList() = 0;
+
+            virtual void beginMap() = 0;
+            virtual void endMap() = 0;
+
+            virtual void key (std::string_view) = 0;
+
+            /**
+             * As above for a key rendered ahead of time, sinks that can't
+             * make use of that being passed its name
+             */
+            virtual void key (const Key & key_) { key (key_.m_name); }
+
+            virtual void null() = 0;
+            virtual void boolean (bool) = 0;
+            virtual void integer (int64_t) = 0;
+            virtual void real (double) = 0;
+            virtual void string (std::string_view) = 0;
+
+            /**
+             * A run of [n_] list elements, arrays of primitives being
+             * decoded in bulk, as if each were passed on its own. Sinks
+             * that can render a run faster than a value at a time should
+             * override these
+             */
+            virtual void integers (const int64_t * values_, size_t n_) {
+                for (size_t i { 0 } ; i < n_ ; ++i) integer (values_[i]);
+            }
+
+            virtual void reals (const double * values_, size_t n_) {
+                for (size_t i { 0 } ; i < n_ ; ++i) real (values_[i]);
+            }
+
+            /**
+             * Enumeration constants
+             */
+            virtual void symbol (std::string_view) = 0;
+
+            /**
+             * The raw bytes of an AMQP binary, viewing the blob
+             */
+            virtual void binary (std::string_view) = 0;
+
+            /**
+             * A binary a projection runs through, only the [paths_] below
+             * it being wanted of the blob it may hold. Sinks that don't
+             * decode nested blobs are just passed its bytes
+             */
+            virtual void nested (std::string_view bytes_, const std::vector<std::string> & paths_) {
+                binary (bytes_);
+            }
+
+            /**
+             * Sinks that want the structural hash of every composite say
+             * so here, each then being passed to [hash] just before the
+             * [endObject] closing it. Halves of the 128 bit hash, see
+             * [ObjectTable::hash]
+             */
+            virtual bool hashes() const { return false; }
+
+            virtual void hash (uint64_t low_, uint64_t high_) { }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,97 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::reader::IVisitor
+ *
+ ******************************************************************************/
+
+/**
+ * Callbacks driven by a reader as it walks the blob, nothing being
+ * decoded into values along the way. Unlike [ISink], which only cares
+ * about how a value is rendered, a visitor is told the type of each
+ * composite, the number of elements in each collection and the native
+ * type of every primitive, so it can compute over the blob directly.
+ *
+ * Every callback does nothing by default so a visitor need only override
+ * those it's interested in. Strings and names are only valid for the
+ * duration of the call.
+ *
+ * Composite fields are introduced by [onField]. Maps alternate between
+ * key and value, with the key being whatever the map's key reader visits.
+ */
+namespace amqp::reader {
+
+    class IVisitor {
+        public :
+            virtual ~IVisitor() = default;
+
+            virtual void onBeginComposite (std::string_view) { }
+            virtual void onEndComposite() { }
+
+            /**
+             * Visitors that want the structural hash of every composite
+             * say so here, each then being passed to [onHash] just before
+             * the [onEndComposite] closing it. Halves of the 128 bit hash,
+             * see [ObjectTable::hash]
+             */
+            virtual bool hashes() const { return false; }
+            virtual void onHash (uint64_t low_, uint64_t high_) { }
+
+            virtual void onField (std::string_view) { }
+
+            virtual void onBeginList (size_t) { }
+            virtual void onEndList() { }
+
+            /**
+             * [size_t] is the number of entries, not keys and values
+             */
+            virtual void onBeginMap (size_t) { }
+            virtual void onEndMap() { }
+
+            virtual void onBool (bool) { }
+            virtual void onInt (int32_t) { }
+            virtual void onLong (int64_t) { }
+            virtual void onDouble (double) { }
+            virtual void onString (std::string_view) { }
+
+            /**
+             * The rest of AMQP's primitives. A char is a UTF-32 code
+             * point, a timestamp milliseconds since the Unix epoch and a
+             * uuid or decimal128 their 16 raw bytes
+             */
+            virtual void onChar (char32_t) { }
+            virtual void onShort (int16_t) { }
+            virtual void onByte (int8_t) { }
+            virtual void onFloat (float) { }
+            virtual void onTimestamp (int64_t) { }
+            virtual void onUuid (std::string_view) { }
+            virtual void onDecimal128 (std::string_view) { }
+            virtual void onSymbol (std::string_view) { }
+
+            /**
+             * Enumeration constants
+             */
+            virtual void onEnum (std::string_view) { }
+
+            /**
+             * The raw bytes of an AMQP binary
+             */
+            virtual void onBinary (std::string_view) { }
+
+            /**
+             * An unset nullable property, or a null element, in place of
+             * whichever of the above it would otherwise have been
+             */
+            virtual void onNull() { }
+    };
+
+}
+
+/******************************************************************************/
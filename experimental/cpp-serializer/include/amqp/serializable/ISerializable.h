@@ -1,10 +1,43 @@
 #pragma once
 
+/******************************************************************************
+ *
+ * Forward declarations
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    class Encoder;
+    class Schema;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::serializable::ISerializable
+ *
+ ******************************************************************************/
+
+/**
+ * Anything a [serialiser::Serialiser] can write as the payload of a blob.
+ * It first describes its type, and those of everything it holds, into the
+ * blob's schema and then writes itself, usually as an object whose
+ * descriptor the schema handed back
+ */
 namespace amqp::serializable {
 
     class ISerializable {
         public :
-            virtual char * serialize() const = 0;
+            virtual ~ISerializable() = default;
+
+            virtual void describe (internal::encoder::Schema &) const = 0;
+
+            virtual void serialize (
+                internal::encoder::Encoder &,
+                const internal::encoder::Schema &) const = 0;
     };
 
-}
\ No newline at end of file
+}
+
+/******************************************************************************/
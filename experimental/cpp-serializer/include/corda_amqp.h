@@ -0,0 +1,272 @@
+#ifndef CORDA_AMQP_H
+#define CORDA_AMQP_H
+
+/******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+
+/**
+ * The C interface to libcorda_amqp, for decoding Corda's AMQP blobs from
+ * any language able to call C.
+ *
+ * Everything decoding needs is held by a session. A session must only be
+ * used by one thread at a time but any number may be open at once, every
+ * one of them sharing the process wide cache of compiled schemas.
+ *
+ * Blobs are passed whole, header and all, and are never copied. Functions
+ * that can fail return CORDA_AMQP_OK or an error, in which case
+ * [corda_amqp_error] describes it. Nothing ever throws across this
+ * interface.
+ *
+ * Memory returned to the caller is theirs to free with the matching
+ * function, [corda_amqp_free] for text.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+
+#define CORDA_AMQP_VERSION 1
+
+enum {
+    CORDA_AMQP_OK = 0,
+
+    /** Null where a pointer was needed */
+    CORDA_AMQP_EINVAL = 1,
+
+    /** Not a Corda blob, or not one encoded as data and stop */
+    CORDA_AMQP_EFORMAT = 2,
+
+    /** The blob failed to decode */
+    CORDA_AMQP_EDECODE = 3,
+
+    /** Reading or writing a schema cache failed */
+    CORDA_AMQP_EIO = 4,
+
+    /** Nothing where it was looked for */
+    CORDA_AMQP_ENOTFOUND = 5
+};
+
+typedef struct corda_amqp_session corda_amqp_session;
+typedef struct corda_amqp_cache corda_amqp_cache;
+typedef struct corda_amqp_tape corda_amqp_tape;
+
+/**
+ * The version of this interface the library implements,
+ * CORDA_AMQP_VERSION when it matches the header
+ */
+int corda_amqp_version (void);
+
+/******************************************************************************
+ *
+ * Sessions
+ *
+ ******************************************************************************/
+
+corda_amqp_session * corda_amqp_open (void);
+
+void corda_amqp_close (corda_amqp_session * session);
+
+/**
+ * Why the session's last call failed, empty if it didn't. Valid until the
+ * session is next used
+ */
+const char * corda_amqp_error (const corda_amqp_session * session);
+
+/**
+ * Write objects the blob refers back to as { "$ref" : n } rather than
+ * repeating them, off by default
+ */
+void corda_amqp_pointers (corda_amqp_session * session, int pointers);
+
+/******************************************************************************
+ *
+ * Decoding
+ *
+ ******************************************************************************/
+
+/**
+ * Decode [blob] into a NUL terminated JSON object, its "Parsed" field
+ * holding the blob's contents, left in [json] along with its length
+ */
+int corda_amqp_decode_json (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    char ** json,
+    size_t * json_size);
+
+/**
+ * As [corda_amqp_decode_json] but decoding only the [count] dotted field
+ * paths of [paths], "amount.quantity" say, and skipping everything else
+ */
+int corda_amqp_project_json (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    const char * const * paths,
+    size_t count,
+    char ** json,
+    size_t * json_size);
+
+/**
+ * As [corda_amqp_decode_json] and [corda_amqp_project_json] but rendering
+ * CBOR, RFC 8949, as the blob inspector's --cbor does. CBOR isn't text so
+ * [cbor_size] is needed, though a NUL follows it all the same
+ */
+int corda_amqp_decode_cbor (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    char ** cbor,
+    size_t * cbor_size);
+
+int corda_amqp_project_cbor (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    const char * const * paths,
+    size_t count,
+    char ** cbor,
+    size_t * cbor_size);
+
+/**
+ * Decode each of the blobs [data] holds, back to back or each prefixed by
+ * its length as four big endian bytes, into a line of NUL terminated
+ * newline delimited JSON. A blob failing to decode gets a line holding
+ * its "error" instead. The number of blobs found is left in [blobs], if
+ * given, even if [data] ends part way through one, which is an error
+ */
+int corda_amqp_decode_frames_json (
+    corda_amqp_session * session,
+    const void * data,
+    size_t size,
+    char ** json,
+    size_t * json_size,
+    size_t * blobs);
+
+void corda_amqp_free (void * memory);
+
+/**
+ * Callbacks made as a blob is walked, each passed the [context] it was
+ * given. Any left null are skipped. Text is only valid for the duration
+ * of the call and isn't NUL terminated. A map alternates between its
+ * keys and values, [on_begin_map] being given the number of entries
+ */
+typedef struct corda_amqp_visitor {
+    void * context;
+
+    void (*on_begin_composite) (void * context, const char * type, size_t size);
+    void (*on_end_composite) (void * context);
+    void (*on_field) (void * context, const char * name, size_t size);
+
+    void (*on_begin_list) (void * context, size_t count);
+    void (*on_end_list) (void * context);
+    void (*on_begin_map) (void * context, size_t count);
+    void (*on_end_map) (void * context);
+
+    void (*on_bool) (void * context, int value);
+    void (*on_int) (void * context, int32_t value);
+    void (*on_long) (void * context, int64_t value);
+    void (*on_double) (void * context, double value);
+    void (*on_string) (void * context, const char * value, size_t size);
+
+    /**
+     * A char is a UTF-32 code point, a timestamp milliseconds since the
+     * Unix epoch and a uuid or decimal128 their 16 raw bytes
+     */
+    void (*on_char) (void * context, uint32_t value);
+    void (*on_short) (void * context, int16_t value);
+    void (*on_byte) (void * context, int8_t value);
+    void (*on_float) (void * context, float value);
+    void (*on_timestamp) (void * context, int64_t value);
+    void (*on_uuid) (void * context, const char * value, size_t size);
+    void (*on_decimal128) (void * context, const char * value, size_t size);
+    void (*on_symbol) (void * context, const char * value, size_t size);
+    void (*on_enum) (void * context, const char * value, size_t size);
+    void (*on_binary) (void * context, const char * value, size_t size);
+} corda_amqp_visitor;
+
+/**
+ * Walk [blob]'s contents with [visitor]
+ */
+int corda_amqp_visit (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    const corda_amqp_visitor * visitor);
+
+/**
+ * Decode [blob] into a tape of 64 bit tokens, see amqp/tape/Tape.h for
+ * their layout. Text within the blob is referred to by its offset from
+ * the end of the blob's 8 byte header, so [blob] must outlive the tape,
+ * anything else by its offset past the blob's end into the tape's own
+ * [corda_amqp_tape_text]
+ */
+int corda_amqp_decode_tape (
+    corda_amqp_session * session,
+    const void * blob,
+    size_t size,
+    corda_amqp_tape ** tape);
+
+const uint64_t * corda_amqp_tape_words (const corda_amqp_tape * tape, size_t * count);
+
+const char * corda_amqp_tape_text (const corda_amqp_tape * tape, size_t * size);
+
+/**
+ * Set [index] to where in [corda_amqp_tape_words] the value the JSON
+ * pointer [pointer] names starts, "/Parsed/states/4123/amount" say. Tables
+ * over the tape are built the first time it's asked, after which every
+ * lookup costs a step per token, from any number of threads at once. An
+ * absent field's null starts at its key's word. A malformed pointer is
+ * CORDA_AMQP_EINVAL, one naming nothing CORDA_AMQP_ENOTFOUND
+ */
+int corda_amqp_tape_at (const corda_amqp_tape * tape, const char * pointer, size_t * index);
+
+void corda_amqp_tape_free (corda_amqp_tape * tape);
+
+/******************************************************************************
+ *
+ * The schema cache
+ *
+ ******************************************************************************/
+
+/**
+ * Restore compiled schemas from the file at [path] rather than decode
+ * them, for as long as the cache is open. A missing or unreadable file
+ * is treated as empty
+ */
+corda_amqp_cache * corda_amqp_cache_open (const char * path);
+
+/**
+ * Add every schema compiled so far to the cache's file
+ */
+int corda_amqp_cache_save (corda_amqp_cache * cache);
+
+void corda_amqp_cache_close (corda_amqp_cache * cache);
+
+/**
+ * How many schemas are compiled, and how often one was found already
+ * compiled or had to be. Any may be null
+ */
+void corda_amqp_cache_stats (size_t * entries, size_t * hits, size_t * misses);
+
+/**
+ * Forget every compiled schema. Nothing may be decoding at the time
+ */
+void corda_amqp_cache_clear (void);
+
+/******************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/******************************************************************************/
+
+#endif
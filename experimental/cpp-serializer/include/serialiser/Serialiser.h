@@ -2,14 +2,93 @@
 
 /******************************************************************************/
 
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <typeindex>
+#include <unordered_map>
+
+#include "amqp/serializable/ISerializable.h"
+
+/******************************************************************************
+ *
+ * Forward declarations
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    class Buffer;
+    class Encoder;
+
+}
+
+/******************************************************************************
+ *
+ * class serialiser::Serialiser
+ *
+ ******************************************************************************/
+
+/**
+ * Writes whole Corda blobs, the header followed by an envelope holding the
+ * payload, its schema and an empty transforms schema, readable by the JVM
+ * or by anything here that reads blobs.
+ *
+ * A type always describes itself the same way so a serialiser encodes the
+ * schema and transforms for each type it's handed once, keeping the bytes
+ * to copy into every blob after. Each blob's buffer is reserved up front
+ * for as much as the last blob of that type took, so once a few have been
+ * written an encoding never has to grow its buffer.
+ *
+ * Writing many blobs at once, for a corpus or a replay, they're encoded
+ * one straight after another into the same buffer by the same encoder,
+ * the type only being looked up again when it changes and the buffer only
+ * being flushed, and a [StringBuffer] trimmed, once they're all written.
+ */
 namespace serialiser {
 
     class Serialiser {
+        private :
+            struct Type;
 
+            std::unordered_map<std::type_index, std::unique_ptr<Type>> m_types;
+
+            Type & type (const amqp::serializable::ISerializable &);
+
+            size_t write (
+                Type &,
+                const amqp::serializable::ISerializable &,
+                amqp::internal::encoder::Encoder &);
+
+        public :
+            Serialiser();
+            Serialiser (const Serialiser &) = delete;
+            ~Serialiser();
+
+            /**
+             * Append [object_] as a blob to [buffer_] returning how many
+             * bytes it took
+             */
+            size_t serialise (
+                const amqp::serializable::ISerializable & object_,
+                amqp::internal::encoder::Buffer & buffer_);
+
+            /**
+             * Into a string of its own
+             */
+            std::string serialise (const amqp::serializable::ISerializable &);
+
+            /**
+             * Append each of [objects_] as a blob of its own to [buffer_],
+             * in order and back to back, returning how many bytes each
+             * took
+             */
+            std::vector<size_t> serialise (
+                const std::vector<const amqp::serializable::ISerializable *> & objects_,
+                amqp::internal::encoder::Buffer & buffer_);
     };
 
 }
 
 /******************************************************************************/
-
-
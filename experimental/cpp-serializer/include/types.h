@@ -21,6 +21,17 @@ using sVec = std::vector<T>;
 template<typename T>
 using sList = std::list<T>;
 
+/**
+ * As contiguous as an [sVec] but a type of its own, so the elements of a
+ * decoded list or array are told apart from a composite's properties
+ * and rendered as a list rather than an object
+ */
+template<typename T>
+class sSeq : public std::vector<T> {
+    public :
+        using std::vector<T>::vector;
+};
+
 template<typename T>
 using upStrMap_t = std::map<std::string, uPtr<T>>;
 
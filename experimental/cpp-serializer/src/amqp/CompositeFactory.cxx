@@ -2,19 +2,24 @@
 
 #include <set>
 #include <vector>
-#include <iostream>
+#include <ostream>
 #include <algorithm>
 #include <functional>
+#include <thread>
+#include <exception>
 
 #include <assert.h>
 
 #include "debug.h"
 
+#include "stats/Stats.h"
+
 #include "amqp/reader/IReader.h"
 #include "amqp/reader/PropertyReader.h"
 
 #include "reader/Reader.h"
 #include "reader/CompositeReader.h"
+#include "reader/DispatchReader.h"
 #include "reader/RestrictedReader.h"
 #include "reader/restricted-readers/MapReader.h"
 #include "reader/restricted-readers/ListReader.h"
@@ -34,17 +39,17 @@ namespace {
  *
  */
     template<typename T>
-    std::shared_ptr<T> &
+    T *
     computeIfAbsent(
-            spStrMap_t<T> &map_,
+            std::map<std::string, T *> &map_,
             const std::string &k_,
-            std::function<std::shared_ptr<T>(void)> f_
+            std::function<T *(void)> f_
     ) {
         auto it = map_.find(k_);
 
         if (it == map_.end()) {
             DBG ("ComputeIfAbsent \"" << k_ << "\" - missing" << std::endl); // NOLINT
-            map_[k_] = std::move (f_());
+            map_[k_] = f_();
             DBG ("                \"" << k_ << "\" - RTN: " << map_[k_]->name() << " : " << map_[k_]->type()
                                       << std::endl); // NOLINT
             assert (map_[k_]);
@@ -63,6 +68,12 @@ namespace {
         }
     }
 
+    /**
+     * Levels smaller than this are built serially whatever the threads,
+     * there being too little in them to be worth handing out
+     */
+    constexpr size_t PARALLEL_LEVEL = 16;
+
 }
 
 /******************************************************************************
@@ -81,121 +92,444 @@ namespace {
  * we haven't built yet.
  *
  */
+amqp::internal::
+CompositeFactory::CompositeFactory() : m_bytes (0) {
+    m_snapshots.emplace_back (std::make_unique<const Readers>());
+    m_readers.store (m_snapshots.back().get(), std::memory_order_release);
+}
+
+/******************************************************************************/
+
 void
 amqp::internal::
 CompositeFactory::process (const SchemaType & schema_) {
     DBG ("process schema" << std::endl);
 
-    for (const auto & i : dynamic_cast<const schema::Schema &>(schema_)) {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    stats::Stats::Timer timer (stats::Stats::readers_t);
+
+    auto readers = std::make_unique<Readers> (
+            *m_readers.load (std::memory_order_acquire));
+
+    const auto & schema = dynamic_cast<const schema::Schema &>(schema_);
+
+    for (const auto & i : schema) {
         for (const auto & j : i) {
-            process (*j);
-            m_readersByDescriptor[j->descriptor()] = m_readersByType[j->name()];
+            process (*readers, schema, *j);
+            readers->m_byDescriptor[j->descriptor()] = readers->m_byType[j->name()];
+        }
+    }
+
+    link (*readers, schema);
+    publish (std::move (readers));
+}
+
+/******************************************************************************/
+
+/**
+ * Nothing in a level depends on anything else in it, so once whatever
+ * would be added to the maps as a side effect of building a level has
+ * been, serially, its readers can be built at once, each only ever
+ * finding what it reads through, and then adopted and published into
+ * the maps together before the next level's started.
+ */
+void
+amqp::internal::
+CompositeFactory::process (const SchemaType & schema_, size_t threads_) {
+    if (threads_ <= 1) {
+        process (schema_);
+        return;
+    }
+
+    DBG ("process schema on " << threads_ << " threads" << std::endl); // NOLINT
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    stats::Stats::Timer timer (stats::Stats::readers_t);
+
+    auto readers = std::make_unique<Readers> (
+            *m_readers.load (std::memory_order_acquire));
+
+    const auto & schema = dynamic_cast<const schema::Schema &>(schema_);
+
+    for (const auto & level : schema) {
+        std::vector<const schema::AMQPTypeNotation *> types;
+
+        for (const auto & type : level) {
+            if (!readers->m_byType.count (type->name())) {
+                types.push_back (type.get());
+            }
+        }
+
+        if (types.size() < PARALLEL_LEVEL) {
+            for (const auto & type : types) process (*readers, schema, *type);
+        } else {
+            for (const auto & type : types) prepare (*readers, schema, *type);
+
+            std::vector<Built> built (types.size());
+            std::vector<std::exception_ptr> failed (types.size());
+            std::atomic<size_t> next { 0 };
+
+            auto work = [&]() {
+                for (size_t i ; (i = next.fetch_add (1, std::memory_order_relaxed)) < types.size() ; ) {
+                    try {
+                        stats::Trace::Span span ("reader", types[i]->name());
+                        built[i] = build (*readers, *types[i]);
+                    } catch (...) {
+                        failed[i] = std::current_exception();
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve (std::min (threads_, types.size()) - 1);
+
+            for (size_t i { 1 } ; i < threads_ && i < types.size() ; ++i) {
+                workers.emplace_back (work);
+            }
+
+            work();
+
+            for (auto & worker : workers) worker.join();
+
+            for (size_t i { 0 } ; i < types.size() ; ++i) {
+                if (failed[i]) std::rethrow_exception (failed[i]);
+
+                // already in the map should preparing another have put it there
+                auto & reader = readers->m_byType[types[i]->name()];
+                if (!reader) reader = adopt (std::move (built[i]));
+            }
+        }
+
+        for (const auto & type : level) {
+            readers->m_byDescriptor[type->descriptor()] = readers->m_byType[type->name()];
+        }
+    }
+
+    link (*readers, schema);
+    publish (std::move (readers));
+}
+
+/******************************************************************************/
+
+/**
+ * Rather than rely on the schema's ordering, walk down from the root
+ * type building each type's dependencies before the type itself.
+ */
+void
+amqp::internal::
+CompositeFactory::process (
+    const SchemaType & schema_,
+    const std::string & descriptor_
+) {
+    DBG ("process schema from " << descriptor_ << std::endl); // NOLINT
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    stats::Stats::Timer timer (stats::Stats::readers_t, descriptor_);
+
+    const auto * current = m_readers.load (std::memory_order_acquire);
+
+    if (current->m_byDescriptor.count (descriptor_)) {
+        return;
+    }
+
+    const auto & schema = dynamic_cast<const schema::Schema &>(schema_);
+
+    if (schema.descriptorId (descriptor_) == schema::SymbolTable::npos) {
+        throw std::runtime_error ("No type with descriptor " + descriptor_);
+    }
+
+    auto readers = std::make_unique<Readers> (*current);
+    std::set<std::string> building;
+
+    demand (*readers, schema, schema.fromDescriptor (descriptor_)->second.get()->name(), building);
+
+    link (*readers, schema);
+    publish (std::move (readers));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+CompositeFactory::publish (uPtr<Readers> readers_) {
+    // every snapshot is kept, each a full copy of the maps' nodes
+    constexpr size_t node = sizeof (ReaderMap::value_type) + 4 * sizeof (void *);
+
+    m_bytes.fetch_add (
+            sizeof (Readers)
+                + node * (readers_->m_byType.size() + readers_->m_byDescriptor.size()),
+            std::memory_order_relaxed);
+
+    m_snapshots.emplace_back (std::move (readers_));
+    m_readers.store (m_snapshots.back().get(), std::memory_order_release);
+}
+
+/******************************************************************************/
+
+/**
+ * Candidates are only built now, once nothing is part way through being
+ * built, so a type holding a field of an interface it provides itself is
+ * no more a cycle than any other
+ */
+void
+amqp::internal::
+CompositeFactory::link (Readers & readers_, const schema::Schema & schema_) {
+    while (!readers_.m_unlinked.empty()) {
+        auto unlinked = std::move (readers_.m_unlinked);
+        readers_.m_unlinked.clear();
+
+        for (const auto & dispatch : unlinked) {
+            for (const auto & candidate : dispatch->candidates()) {
+                std::set<std::string> building;
+                demand (readers_, schema_, candidate.m_type, building);
+            }
+        }
+
+        for (const auto & dispatch : unlinked) {
+            dispatch->link (readers_.m_byType);
+        }
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Reader *
+amqp::internal::
+CompositeFactory::demand (
+    Readers & readers_,
+    const schema::Schema & schema_,
+    const std::string & type_,
+    std::set<std::string> & building_
+) {
+    auto it = readers_.m_byType.find (type_);
+
+    if (it != readers_.m_byType.end()) {
+        return it->second;
+    }
+
+    const auto * type = schema_.typeNotation (type_);
+
+    // not a type of the schema's own so it had better be a primitive
+    if (!type) {
+        return fetchReaderForRestricted (readers_, schema_, type_);
+    }
+
+    if (!building_.insert (type_).second) {
+        throw std::runtime_error ("Cyclic dependency on " + type_);
+    }
+
+    for (const auto & dependency : type->dependencies()) {
+        // an enum names itself
+        if (dependency == type_) continue;
+
+        std::string name { dependency };
+
+        if (schema_.typeNotation (name)) {
+            demand (readers_, schema_, name, building_);
         }
     }
+
+    building_.erase (type_);
+
+    auto rtn = process (readers_, schema_, *type);
+    readers_.m_byDescriptor[type->descriptor()] = rtn;
+
+    return rtn;
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::reader::Reader *
 amqp::internal::
 CompositeFactory::process (
+    Readers & readers_,
+    const schema::Schema & types_,
     const amqp::internal::schema::AMQPTypeNotation & schema_)
 {
     DBG ("process::" << schema_.name() << std::endl);
 
     return computeIfAbsent<reader::Reader> (
-        m_readersByType,
+        readers_.m_byType,
         schema_.name(),
-        [& schema_, this] () -> std::shared_ptr<reader::Reader> {
-            switch (schema_.type()) {
-                case schema::AMQPTypeNotation::composite_t : {
-                    return processComposite (schema_);
-                }
-                case schema::AMQPTypeNotation::restricted_t : {
-                    return processRestricted (schema_);
-                }
-            }
+        [& schema_, & types_, & readers_, this] () -> reader::Reader * {
+            stats::Trace::Span span ("reader", schema_.name());
+
+            prepare (readers_, types_, schema_);
+
+            return adopt (build (readers_, schema_));
         });
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+/**
+ * Everything building [type_] reads through that can be made without
+ * depending on anything else, primitives and the dispatch readers for
+ * interfaces, is added to the maps here so [build] itself need only
+ * find what it uses
+ */
+void
+amqp::internal::
+CompositeFactory::prepare (
+    Readers & readers_,
+    const schema::Schema & schema_,
+    const amqp::internal::schema::AMQPTypeNotation & type_
+) {
+    if (type_.type() == schema::AMQPTypeNotation::composite_t) {
+        for (const auto & field : dynamic_cast<const schema::Composite &> (type_).fields()) {
+            if (field->primitive()) {
+                computeIfAbsent<reader::Reader> (
+                        readers_.m_byType,
+                        field->resolvedType(),
+                        [&field, this]() -> reader::Reader * {
+                            return adopt (reader::PropertyReader::make (field));
+                        });
+            } else if (!readers_.m_byType.count (field->resolvedType())) {
+                // Insertion sorting ensures any type we depend on will
+                // have already been created and thus exist in the map,
+                // anything else is an interface
+                polymorphic (readers_, schema_, field->resolvedType());
+            }
+        }
+
+        return;
+    }
+
+    const auto & restricted = dynamic_cast<const schema::Restricted &> (type_);
+
+    switch (restricted.restrictedType()) {
+        case schema::Restricted::RestrictedTypes::list_t : {
+            fetchReaderForRestricted (
+                readers_, schema_, dynamic_cast<const schema::List &> (restricted).listOf());
+            break;
+        }
+        case schema::Restricted::RestrictedTypes::map_t : {
+            const auto types = dynamic_cast<const schema::Map &> (restricted).mapOf();
+            fetchReaderForRestricted (readers_, schema_, types.first);
+            fetchReaderForRestricted (readers_, schema_, types.second);
+            break;
+        }
+        case schema::Restricted::RestrictedTypes::array_t : {
+            fetchReaderForRestricted (
+                readers_, schema_, dynamic_cast<const schema::Array &> (restricted).arrayOf());
+            break;
+        }
+        case schema::Restricted::RestrictedTypes::enum_t : {
+            break;
+        }
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::CompositeFactory::Built
+amqp::internal::
+CompositeFactory::build (
+    const Readers & readers_,
+    const amqp::internal::schema::AMQPTypeNotation & type_
+) const {
+    switch (type_.type()) {
+        case schema::AMQPTypeNotation::composite_t : {
+            return processComposite (readers_, type_);
+        }
+        case schema::AMQPTypeNotation::restricted_t : {
+            return processRestricted (readers_, type_);
+        }
+    }
+
+    return { };
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Reader *
+amqp::internal::
+CompositeFactory::find (const Readers & readers_, const std::string & type_) {
+    auto it = readers_.m_byType.find (type_);
+
+    if (it == readers_.m_byType.end()) {
+        throw std::runtime_error ("Missing type in map");
+    }
+
+    return it->second;
+}
+
+/******************************************************************************/
+
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processComposite (
+        const Readers & readers_,
         const amqp::internal::schema::AMQPTypeNotation & type_
 ) {
     DBG ("processComposite - " << type_.name() << std::endl);
-    std::vector<std::weak_ptr<reader::Reader>> readers;
+    std::vector<const reader::Reader *> readers;
+    std::vector<std::string> names;
 
     const auto & fields = dynamic_cast<const schema::Composite &> (
             type_).fields();
 
     readers.reserve (fields.size());
+    names.reserve (fields.size());
 
     for (const auto & field : fields) {
         DBG ("  Field: " << field->name() << ": \"" << field->type()
             << "\" {" << field->resolvedType() << "} "
             << field->fieldType() << std::endl); // NOLINT
 
-       decltype (m_readersByType)::mapped_type reader;
-
-        if (field->primitive()) {
-            reader = computeIfAbsent<reader::Reader> (
-                    m_readersByType,
-                    field->resolvedType(),
-                    [&field]() -> std::shared_ptr<reader::PropertyReader> {
-                        return reader::PropertyReader::make (field);
-                    });
-        }
-        else {
-            // Insertion sorting ensures any type we depend on will have
-            // already been created and thus exist in the map
-            reader = m_readersByType[field->resolvedType()];
-        }
-
+        readers.emplace_back (find (readers_, field->resolvedType()));
 
-        assert (reader);
-        readers.emplace_back (reader);
-        assert (readers.back().lock());
+        names.push_back (field->name());
     }
 
-    return std::make_shared<reader::CompositeReader> (type_.name(), readers);
+    return built (std::make_unique<reader::CompositeReader> (
+            type_.name(), type_.descriptor(), std::move (names), std::move (readers)));
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processEnum (
     const amqp::internal::schema::Enum & enum_
 ) {
     DBG ("Processing Enum - " << enum_.name() << std::endl); // NOLINT
 
-    return std::make_shared<reader::EnumReader> (
+    return built (std::make_unique<reader::EnumReader> (
         enum_.name(),
-        enum_.makeChoices());
+        enum_.makeChoices()));
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::reader::Reader *
 amqp::internal::
-CompositeFactory::fetchReaderForRestricted (const std::string & type_) {
-    decltype(m_readersByType)::mapped_type rtn;
+CompositeFactory::fetchReaderForRestricted (
+    Readers & readers_,
+    const schema::Schema & schema_,
+    const std::string & type_
+) {
+    reader::Reader * rtn;
 
     DBG ("fetchReaderForRestricted - " << type_ << std::endl);
 
     if (schema::Field::typeIsPrimitive(type_)) {
         DBG ("It's primitive" << std::endl);
         rtn = computeIfAbsent<reader::Reader>(
-                m_readersByType,
+                readers_.m_byType,
                 type_,
-                [& type_]() -> std::shared_ptr<reader::PropertyReader> {
-                    return reader::PropertyReader::make (type_);
+                [& type_, this]() -> reader::Reader * {
+                    return adopt (reader::PropertyReader::make (type_));
                 });
     } else {
-        rtn = m_readersByType[type_];
+        auto it = readers_.m_byType.find (type_);
+
+        rtn = it == readers_.m_byType.end()
+            ? polymorphic (readers_, schema_, type_)
+            : it->second;
     }
 
     if (!rtn) {
@@ -207,9 +541,47 @@ CompositeFactory::fetchReaderForRestricted (const std::string & type_) {
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::reader::Reader *
+amqp::internal::
+CompositeFactory::polymorphic (
+    Readers & readers_,
+    const schema::Schema & schema_,
+    const std::string & type_
+) {
+    DBG ("polymorphic - " << type_ << std::endl); // NOLINT
+
+    std::vector<reader::DispatchReader::Candidate> candidates;
+
+    for (const auto & level : schema_) {
+        for (const auto & type : level) {
+            if (type->type() != schema::AMQPTypeNotation::composite_t) continue;
+
+            const auto & provides = dynamic_cast<const schema::Composite &> (*type).provides();
+
+            if (std::find (provides.begin(), provides.end(), type_) != provides.end()) {
+                candidates.push_back ({ type->descriptor(), type->name(), { } });
+            }
+        }
+    }
+
+    if (candidates.empty()) {
+        throw std::runtime_error ("Missing type in map, nothing provides " + type_);
+    }
+
+    auto rtn = adopt (std::make_unique<reader::DispatchReader> (type_, std::move (candidates)));
+
+    readers_.m_byType[type_] = rtn;
+    readers_.m_unlinked.push_back (rtn);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processMap (
+    const Readers & readers_,
     const amqp::internal::schema::Map & map_
 ) {
     DBG ("Processing Map - "
@@ -218,45 +590,48 @@ CompositeFactory::processMap (
 
     const auto types = map_.mapOf();
 
-    return std::make_shared<reader::MapReader> (
+    return built (std::make_unique<reader::MapReader> (
             map_.name(),
-            fetchReaderForRestricted (types.first),
-            fetchReaderForRestricted (types.second));
+            find (readers_, types.first),
+            find (readers_, types.second)));
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processList (
+    const Readers & readers_,
     const amqp::internal::schema::List & list_
 ) {
     DBG ("Processing List - " << list_.listOf() << std::endl); // NOLINT
 
-    return std::make_shared<reader::ListReader> (
+    return built (std::make_unique<reader::ListReader> (
             list_.name(),
-            fetchReaderForRestricted (list_.listOf()));
+            find (readers_, list_.listOf())));
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processArray (
+        const Readers & readers_,
         const amqp::internal::schema::Array & array_
 ) {
     DBG ("Processing Array - " << array_.name() << " " << array_.arrayOf() << std::endl); // NOLINT
 
-    return std::make_shared<reader::ArrayReader> (
+    return built (std::make_unique<reader::ArrayReader> (
             array_.name(),
-            fetchReaderForRestricted (array_.arrayOf()));
+            find (readers_, array_.arrayOf())));
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::Reader>
+amqp::internal::CompositeFactory::Built
 amqp::internal::
 CompositeFactory::processRestricted (
+        const Readers & readers_,
         const amqp::internal::schema::AMQPTypeNotation & type_)
 {
     DBG ("processRestricted - " << type_.name() << std::endl); // NOLINT
@@ -266,6 +641,7 @@ CompositeFactory::processRestricted (
     switch (restricted.restrictedType()) {
         case schema::Restricted::RestrictedTypes::list_t : {
             return processList (
+                readers_,
                 dynamic_cast<const schema::List &> (restricted));
         }
         case schema::Restricted::RestrictedTypes::enum_t : {
@@ -274,37 +650,78 @@ CompositeFactory::processRestricted (
         }
         case schema::Restricted::RestrictedTypes::map_t : {
             return processMap (
+                readers_,
                 dynamic_cast<const schema::Map &> (restricted));
         }
         case schema::Restricted::RestrictedTypes::array_t : {
             DBG ("  array_t" << std::endl);
             return processArray (
+                readers_,
                 dynamic_cast<const schema::Array &> (restricted));
         }
     }
 
     DBG ("  ProcessRestricted: Returning nullptr"); // NOLINT
-    return nullptr;
+    return { };
 }
 
 /******************************************************************************/
 
-const std::shared_ptr<amqp::internal::reader::IReader>
+const amqp::internal::reader::IReader *
 amqp::internal::
 CompositeFactory::byType (const std::string & type_) {
-    auto it = m_readersByType.find (type_);
+    const auto & readers = m_readers.load (std::memory_order_acquire)->m_byType;
+    auto it = readers.find (type_);
 
-    return (it == m_readersByType.end()) ? nullptr : it->second;
+    return (it == readers.end()) ? nullptr : it->second;
 }
 
 /******************************************************************************/
 
-const std::shared_ptr<amqp::internal::reader::IReader>
+const amqp::internal::reader::IReader *
 amqp::internal::
 CompositeFactory::byDescriptor (const std::string & descriptor_) {
-    auto it = m_readersByDescriptor.find (descriptor_);
+    const auto & readers = m_readers.load (std::memory_order_acquire)->m_byDescriptor;
+    auto it = readers.find (descriptor_);
+
+    return (it == readers.end()) ? nullptr : it->second;
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Projection
+amqp::internal::
+CompositeFactory::project (
+    const std::string & descriptor_,
+    const schema::Schema & schema_,
+    const std::vector<std::string> & paths_
+) {
+    if (schema_.descriptorId (descriptor_) == schema::SymbolTable::npos) {
+        throw std::runtime_error ("No type with descriptor " + descriptor_);
+    }
+
+    std::lock_guard<std::mutex> guard (m_lock);
 
-    return (it == m_readersByDescriptor.end()) ? nullptr : it->second;
+    stats::Stats::Timer timer (stats::Stats::readers_t, descriptor_);
+
+    auto readers = std::make_unique<Readers> (
+            *m_readers.load (std::memory_order_acquire));
+
+    std::set<std::string> building;
+
+    auto rtn = reader::Projection::compile (
+            schema_,
+            schema_.fromDescriptor (descriptor_)->second.get()->name(),
+            paths_,
+            [&](const std::string & type_) -> const reader::Reader & {
+                // published below, the snapshot then keeps it alive
+                return *demand (*readers, schema_, type_, building);
+            });
+
+    link (*readers, schema_);
+    publish (std::move (readers));
+
+    return rtn;
 }
 
 /******************************************************************************/
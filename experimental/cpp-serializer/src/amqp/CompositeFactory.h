@@ -4,7 +4,10 @@
 
 #include <map>
 #include <set>
+#include <mutex>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "types.h"
 
@@ -13,6 +16,8 @@
 #include "amqp/schema/described-types/Envelope.h"
 #include "amqp/schema/described-types/Composite.h"
 #include "amqp/reader/CompositeReader.h"
+#include "amqp/reader/DispatchReader.h"
+#include "amqp/reader/Projection.h"
 #include "amqp/schema/restricted-types/Map.h"
 #include "amqp/schema/restricted-types/Array.h"
 #include "amqp/schema/restricted-types/List.h"
@@ -22,6 +27,23 @@
 
 namespace amqp::internal {
 
+    /**
+     * Safe to share between threads. The readers are held in immutable
+     * snapshots, lookups simply load the current one and search it without
+     * ever taking a lock.
+     *
+     * Every reader the factory builds is owned by its arena, [m_arena], and
+     * refers to those it reads through by plain pointer, so decoding never
+     * touches a reference count and the whole graph goes when the factory
+     * does, with the schema it was built for.
+     *
+     * Processing a schema copies the current snapshot, builds the new
+     * readers into that copy and then publishes it in place of the old.
+     * Writers are serialised against one another but never block anyone
+     * looking up a reader. Superseded snapshots are kept until the factory
+     * itself is destroyed so a lookup racing a publish is never left
+     * holding a dangling pointer.
+     */
     class CompositeFactory
         : public ICompositeFactory<schema::SchemaMap::const_iterator>
     {
@@ -29,44 +51,200 @@ namespace amqp::internal {
             using CompositePtr = uPtr<schema::Composite>;
             using EnvelopePtr  = uPtr<schema::Envelope>;
 
-            spStrMap_t<reader::Reader> m_readersByType;
-            spStrMap_t<reader::Reader> m_readersByDescriptor;
+            using ReaderMap = std::map<std::string, reader::Reader *>;
+
+            struct Readers {
+                ReaderMap m_byType;
+                ReaderMap m_byDescriptor;
+
+                /**
+                 * Dispatch readers whose candidates are still to be built
+                 * and bound, always empty once published
+                 */
+                std::vector<reader::DispatchReader *> m_unlinked;
+            };
+
+            std::atomic<const Readers *> m_readers;
+
+            /**
+             * Owns every snapshot ever published, guarded by [m_lock]
+             */
+            std::vector<uPtr<const Readers>> m_snapshots;
+
+            /**
+             * Every reader ever built, whether or not what it was built for
+             * was published, guarded by [m_lock]
+             */
+            std::vector<uPtr<reader::Reader>> m_arena;
+
+            /**
+             * Roughly what the arena and snapshots take up, see [bytes]
+             */
+            std::atomic<size_t> m_bytes;
+
+            std::mutex m_lock;
 
         public :
-            CompositeFactory() = default;
+            CompositeFactory();
+            CompositeFactory (const CompositeFactory &) = delete;
 
             void process (const SchemaType &) override;
 
-            const std::shared_ptr<ReaderType> byType (
-                    const std::string &) override;
-
-            const std::shared_ptr<ReaderType> byDescriptor (
-                    const std::string &) override;
+            /**
+             * As above but with the readers of each level of the schema
+             * built on up to [threads_] threads at once, the types in a
+             * level depending on nothing else in it. Worth it only for a
+             * schema of many types, small levels still being built
+             * serially
+             */
+            void process (const SchemaType &, size_t threads_);
+
+            /**
+             * Build readers only for the type with [descriptor_] and the
+             * types it depends upon, rather than for everything in the
+             * schema. Anything already built is reused
+             */
+            void process (const SchemaType &, const std::string & descriptor_);
+
+            const ReaderType * byType (const std::string &) override;
+
+            const ReaderType * byDescriptor (const std::string &) override;
+
+            /**
+             * Compile a set of dotted field paths against the type with
+             * [descriptor_] in [schema_]. Readers are built only for the
+             * fields selected, not for the types leading to them nor for
+             * anything left out. See [reader::Projection]
+             */
+            reader::Projection project (
+                    const std::string & descriptor_,
+                    const schema::Schema &,
+                    const std::vector<std::string> & paths_);
+
+            /**
+             * An estimate of the memory held by every reader and snapshot
+             * built so far, good enough to budget a cache by rather than
+             * exact
+             */
+            size_t bytes() const { return m_bytes.load (std::memory_order_relaxed); }
 
         private :
-            std::shared_ptr<reader::Reader> process (
+            void publish (uPtr<Readers>);
+
+            /**
+             * A reader built but not yet adopted, with its size
+             */
+            struct Built {
+                uPtr<reader::Reader> m_reader;
+                size_t m_size;
+            };
+
+            template<class T>
+            static Built built (uPtr<T> reader_) {
+                return { std::move (reader_), sizeof (T) };
+            }
+
+            /**
+             * Hand [reader_] to the arena
+             */
+            template<class T>
+            T * adopt (uPtr<T> reader_) {
+                auto rtn = reader_.get();
+                m_bytes.fetch_add (sizeof (T) + sizeof (reader_), std::memory_order_relaxed);
+                m_arena.push_back (std::move (reader_));
+                return rtn;
+            }
+
+            reader::Reader * adopt (Built built_) {
+                auto rtn = built_.m_reader.get();
+                m_bytes.fetch_add (built_.m_size + sizeof (built_.m_reader), std::memory_order_relaxed);
+                m_arena.push_back (std::move (built_.m_reader));
+                return rtn;
+            }
+
+            /**
+             * Build the candidates of every dispatch reader built since the
+             * last publish, and any those in turn need, then bind them
+             */
+            void link (Readers &, const schema::Schema &);
+
+            /**
+             * Build the reader for [type_] after those for everything it
+             * depends on, [building_] being the types part way through so
+             * a cycle can be reported rather than recursed into forever
+             */
+            reader::Reader * demand (
+                    Readers &,
+                    const schema::Schema &,
+                    const std::string & type_,
+                    std::set<std::string> & building_);
+
+            reader::Reader * process (
+                    Readers &,
+                    const schema::Schema &,
                     const schema::AMQPTypeNotation &);
 
-            std::shared_ptr<reader::Reader> processComposite (
+            /**
+             * Add to the maps whatever building [type_] needs that could
+             * be, primitives and interfaces, such that [build] itself only
+             * ever finds what it reads through without changing the maps
+             */
+            void prepare (
+                    Readers &,
+                    const schema::Schema &,
+                    const schema::AMQPTypeNotation & type_);
+
+            /**
+             * The reader for a prepared type, safe to call on many threads
+             * at once for types that don't depend on each other
+             */
+            Built build (
+                    const Readers &,
+                    const schema::AMQPTypeNotation &) const;
+
+            /**
+             * What's been built for [type_], throwing if nothing has
+             */
+            static reader::Reader * find (const Readers &, const std::string & type_);
+
+            static Built processComposite (
+                    const Readers &,
                     const schema::AMQPTypeNotation &);
 
-            std::shared_ptr<reader::Reader> processRestricted (
+            static Built processRestricted (
+                    const Readers &,
                     const schema::AMQPTypeNotation &);
 
-            std::shared_ptr<reader::Reader> processList (
+            static Built processList (
+                    const Readers &,
                     const schema::List &);
 
-            std::shared_ptr<reader::Reader> processEnum (
+            static Built processEnum (
                     const schema::Enum &);
 
-            std::shared_ptr<reader::Reader> processMap (
+            static Built processMap (
+                    const Readers &,
                     const schema::Map &);
 
-            std::shared_ptr<reader::Reader> processArray (
+            static Built processArray (
+                    const Readers &,
                     const schema::Array &);
 
-            decltype(m_readersByType)::mapped_type
-            fetchReaderForRestricted (const std::string &);
+            /**
+             * A reader for a field or element of [type_] that the schema
+             * has no type for, an interface, dispatching on the descriptor
+             * of each value to the schema's composites that provide it.
+             * Those are built by [link], [type_] itself may be one
+             */
+            reader::Reader * polymorphic (
+                    Readers &,
+                    const schema::Schema &,
+                    const std::string & type_);
+
+            reader::Reader * fetchReaderForRestricted (
+                    Readers &,
+                    const schema::Schema &,
+                    const std::string &);
     };
 
 }
@@ -0,0 +1,528 @@
+#include "ReaderCache.h"
+
+#include "debug.h"
+
+#include "SchemaStore.h"
+
+#include "reader/Reader.h"
+#include "stats/Stats.h"
+#include "schema/Compact.h"
+#include "schema/described-types/Schema.h"
+#include "schema/described-types/Composite.h"
+#include "schema/restricted-types/Restricted.h"
+#include "schema/field-types/Field.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    /**
+     * Near enough what a decoded schema holds, each type being indexed
+     * by name and descriptor as well as held in its graph
+     */
+    size_t
+    footprint (const schema::ISchemaType & schema_) {
+        constexpr size_t node = 4 * sizeof (void *);
+
+        auto & schema = dynamic_cast<const schema::Schema &> (schema_);
+
+        size_t rtn = sizeof (schema::Schema);
+
+        for (const auto & level : schema) {
+            for (const auto & type : level) {
+                rtn += 3 * node + 2 * (type->name().capacity() + type->descriptor().capacity());
+
+                if (auto composite = dynamic_cast<const schema::Composite *> (type.get())) {
+                    rtn += sizeof (schema::Composite);
+
+                    for (const auto & field : composite->fields()) {
+                        rtn += sizeof (schema::Field)
+                             + field->name().capacity()
+                             + field->type().capacity();
+                    }
+                } else {
+                    rtn += sizeof (schema::Restricted);
+                }
+            }
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::ReaderCache::Entry
+ *
+ ******************************************************************************/
+
+amqp::internal::
+ReaderCache::Entry::Entry (uPtr<schema::Envelope> envelope_, size_t threads_)
+    : m_envelope (std::move (envelope_))
+    , m_bytes (sizeof (Entry) + footprint (m_envelope->schema()))
+    , m_compiled (0)
+    , m_threads (threads_)
+{
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::Entry::bytes() const {
+    return m_bytes + m_factory.bytes() + m_compiled.load (std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+const amqp::internal::schema::ISchemaType &
+amqp::internal::
+ReaderCache::Entry::schema() const {
+    return m_envelope->schema();
+}
+
+/******************************************************************************/
+
+const amqp::internal::CompositeFactory::ReaderType *
+amqp::internal::
+ReaderCache::Entry::byDescriptor (const std::string & descriptor_) const {
+    if (auto rtn = m_factory.byDescriptor (descriptor_)) {
+        return rtn;
+    }
+
+    if (m_threads > 1) {
+        m_factory.process (m_envelope->schema(), m_threads);
+    } else {
+        m_factory.process (m_envelope->schema(), descriptor_);
+    }
+
+    return m_factory.byDescriptor (descriptor_);
+}
+
+/******************************************************************************/
+
+const amqp::internal::program::Program *
+amqp::internal::
+ReaderCache::Entry::program (const std::string & descriptor_) const {
+    auto reader = dynamic_cast<const reader::Reader *> (
+            byDescriptor (descriptor_));
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_programs.find (descriptor_);
+
+    if (it == m_programs.end()) {
+        uPtr<program::Program> compiled;
+
+        if (reader) {
+            stats::Stats::Timer timer (stats::Stats::readers_t, descriptor_);
+
+            try {
+                compiled = std::make_unique<program::Program> (
+                        program::Program::compile (
+                                *reader,
+                                dynamic_cast<const schema::Schema &> (m_envelope->schema())));
+
+                m_compiled.fetch_add (compiled->bytes(), std::memory_order_relaxed);
+            } catch (const std::runtime_error & e) {
+                DBG ("ReaderCache - not compiling " << descriptor_ << ": " << e.what() << std::endl); // NOLINT
+            }
+        }
+
+        it = m_programs.emplace (descriptor_, std::move (compiled)).first;
+    }
+
+    return it->second.get();
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::
+ReaderCache::Entry::ready (const std::string & descriptor_) const {
+    return m_factory.byDescriptor (descriptor_) != nullptr;
+}
+
+/******************************************************************************/
+
+const std::shared_ptr<const void> &
+amqp::internal::
+ReaderCache::Entry::bind (
+    std::type_index type_,
+    const Binder & binder_
+) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_bound.find (type_);
+
+    if (it == m_bound.end()) {
+        it = m_bound.emplace (
+                type_,
+                binder_ (dynamic_cast<const schema::Schema &> (m_envelope->schema()))).first;
+    }
+
+    return it->second;
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const amqp::internal::reader::Projection>
+amqp::internal::
+ReaderCache::Entry::projection (
+    const std::string & descriptor_,
+    const std::vector<std::string> & paths_
+) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    ProjectionKey key { descriptor_, paths_ };
+
+    auto it = m_projections.find (key);
+
+    if (it == m_projections.end()) {
+        it = m_projections.emplace (
+                std::move (key),
+                std::make_shared<const reader::Projection> (
+                        m_factory.project (
+                                descriptor_,
+                                dynamic_cast<const schema::Schema &> (m_envelope->schema()),
+                                paths_))).first;
+
+        m_compiled.fetch_add (sizeof (reader::Projection), std::memory_order_relaxed);
+    }
+
+    return it->second;
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::ReaderCache
+ *
+ ******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::Node::bytes() const {
+    return m_schema.capacity() + (m_entry ? m_entry->bytes() : m_compact->bytes());
+}
+
+/******************************************************************************/
+
+amqp::internal::
+ReaderCache::ReaderCache()
+    : m_hits (0)
+    , m_misses (0)
+    , m_evictions (0)
+    , m_compactions (0)
+    , m_limit (0)
+    , m_restored (0)
+    , m_threads (1)
+{
+}
+
+/******************************************************************************/
+
+amqp::internal::ReaderCache &
+amqp::internal::
+ReaderCache::instance() {
+    static ReaderCache cache;
+    return cache;
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const amqp::internal::ReaderCache::Entry>
+amqp::internal::
+ReaderCache::find (std::string_view bytes_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    auto it = m_entries.find (bytes_);
+
+    if (it == m_entries.end()) return nullptr;
+
+    m_lru.splice (m_lru.begin(), m_lru, it->second);
+
+    return expand (*it->second);
+}
+
+/******************************************************************************/
+
+std::shared_ptr<const amqp::internal::ReaderCache::Entry>
+amqp::internal::
+ReaderCache::fetch (
+    std::string_view bytes_,
+    const Builder & builder_
+) {
+    std::shared_ptr<const SchemaStore> store;
+    size_t threads;
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+
+        auto it = m_entries.find (bytes_);
+        if (it != m_entries.end()) {
+            ++m_hits;
+            m_lru.splice (m_lru.begin(), m_lru, it->second);
+            return expand (*it->second);
+        }
+
+        store = m_store;
+        threads = m_threads;
+    }
+
+    DBG ("ReaderCache - compiling " << bytes_.size() << " byte schema" << std::endl); // NOLINT
+
+    // compile outside of the lock, if someone else beat us to it we
+    // just use theirs
+    auto envelope = store ? store->find (bytes_) : nullptr;
+    bool restored = envelope != nullptr;
+
+    auto entry = std::make_shared<const Entry> (restored ? std::move (envelope) : builder_(), threads);
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    ++m_misses;
+    if (restored) ++m_restored;
+
+    auto it = m_entries.find (bytes_);
+
+    if (it != m_entries.end()) {
+        m_lru.splice (m_lru.begin(), m_lru, it->second);
+        return expand (*it->second);
+    }
+
+    m_lru.push_front ({ std::string (bytes_), std::move (entry), nullptr });
+    m_entries.emplace (m_lru.front().m_schema, m_lru.begin());
+
+    auto rtn = m_lru.front().m_entry;
+
+    evict();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::evict() {
+    if (m_limit == 0 || m_lru.size() < 2) return;
+
+    size_t used = 0;
+    for (const auto & node : m_lru) used += node.bytes();
+
+    for (auto it = std::prev (m_lru.end()) ; used > m_limit && it != m_lru.begin() ; --it) {
+        if (!it->m_entry) continue;
+
+        DBG ("ReaderCache - compacting " << it->m_schema.size() << " byte schema" << std::endl); // NOLINT
+
+        used -= it->bytes();
+
+        it->m_compact = std::make_shared<const schema::Compact> (it->m_entry->envelope());
+        it->m_entry.reset();
+
+        used += it->bytes();
+        ++m_compactions;
+    }
+
+    while (used > m_limit && m_lru.size() > 1) {
+        auto & node = m_lru.back();
+
+        DBG ("ReaderCache - evicting " << node.m_schema.size() << " byte schema" << std::endl); // NOLINT
+
+        used -= node.bytes();
+
+        m_entries.erase (node.m_schema);
+        m_lru.pop_back();
+        ++m_evictions;
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Left as large as it's become until something's next added, [find] being
+ * const
+ */
+const std::shared_ptr<const amqp::internal::ReaderCache::Entry> &
+amqp::internal::
+ReaderCache::expand (Node & node_) const {
+    if (!node_.m_entry) {
+        node_.m_entry = std::make_shared<const Entry> (node_.m_compact->expand(), m_threads);
+        node_.m_compact.reset();
+    }
+
+    return node_.m_entry;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::limit (size_t bytes_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+    m_limit = bytes_;
+    evict();
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::limit() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_limit;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::threads (size_t threads_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+    m_threads = threads_;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::threads() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_threads;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::bytes() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    size_t rtn = 0;
+    for (const auto & node : m_lru) rtn += node.bytes();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::attach (std::shared_ptr<const SchemaStore> store_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+    m_store = std::move (store_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::detach (const std::shared_ptr<const SchemaStore> & store_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+    if (m_store == store_) m_store.reset();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::each (const std::function<void (std::string_view, const Entry &)> & fn_) const {
+    std::vector<Node> nodes;
+
+    {
+        std::lock_guard<std::mutex> guard (m_lock);
+        nodes.assign (m_lru.begin(), m_lru.end());
+    }
+
+    // a compacted schema's expanded just for the call, not put back
+    for (const auto & node : nodes) {
+        if (node.m_entry) {
+            fn_ (node.m_schema, *node.m_entry);
+        } else {
+            fn_ (node.m_schema, Entry (node.m_compact->expand()));
+        }
+    }
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::size() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_entries.size();
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::hits() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_hits;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::misses() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_misses;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::restored() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_restored;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::evictions() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_evictions;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::compactions() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_compactions;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::
+ReaderCache::compacted() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    size_t rtn { 0 };
+    for (const auto & node : m_lru) rtn += node.m_entry ? 0 : 1;
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+ReaderCache::clear() {
+    std::lock_guard<std::mutex> guard (m_lock);
+    m_entries.clear();
+    m_lru.clear();
+    m_hits = m_misses = m_restored = m_evictions = m_compactions = 0;
+}
+
+/******************************************************************************/
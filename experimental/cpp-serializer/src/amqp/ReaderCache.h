@@ -0,0 +1,307 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <typeindex>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+#include "types.h"
+
+#include "amqp/CompositeFactory.h"
+#include "program/Program.h"
+#include "amqp/schema/described-types/Envelope.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::ReaderCache
+ *
+ ******************************************************************************/
+
+namespace amqp::internal {
+
+    class SchemaStore;
+
+    namespace schema {
+
+        class Compact;
+
+    }
+
+}
+
+/******************************************************************************/
+
+namespace amqp::internal {
+
+    /**
+     * Blobs serialised by the same node from the same set of types carry
+     * byte for byte identical schema sections. Rather than rebuild the
+     * readers for every one of them we compile a schema once and keep it,
+     * keyed on those raw encoded bytes, for the lifetime of the process.
+     *
+     * Keying on the bytes themselves, rather than just a hash of them,
+     * means two different schemas can never be confused.
+     *
+     * A process seeing blobs from many nodes, or from one whose types keep
+     * changing, can be given a budget, [limit]. Beyond it the least
+     * recently used schemas are first compacted, their readers, programs
+     * and decoded types dropped for a [schema::Compact] a fraction of the
+     * size, and only dropped altogether once every schema but the most
+     * recent is compact and still the cache doesn't fit. A compacted
+     * schema found again is expanded back into an entry without the blob's
+     * schema being decoded. Everything is handed out by shared pointer so
+     * a decode still using an evicted entry just keeps it alive until
+     * it's done.
+     */
+    class ReaderCache {
+        public :
+            /**
+             * A compiled schema. The readers reference the schema so the
+             * two live and die together.
+             *
+             * Nothing is built until it's first asked for, and then only
+             * for the type asked for and what it depends on. Usually
+             * that's a blob's outer type and so everything, but a
+             * projection builds just the readers for the fields it
+             * selects.
+             */
+            class Entry {
+                private :
+                    uPtr<schema::Envelope> m_envelope;
+                    mutable CompositeFactory m_factory;
+
+                    mutable std::mutex m_lock;
+
+                    /**
+                     * The readers for each type flattened into programs,
+                     * keyed by descriptor. Any type the compiler can't
+                     * cope with is left to its readers, recorded as null
+                     * so we don't try again
+                     */
+                    mutable std::map<std::string, uPtr<program::Program>> m_programs;
+
+                    /**
+                     * Projections compiled on demand, keyed by descriptor
+                     * and the paths asked for
+                     */
+                    using ProjectionKey = std::pair<std::string, std::vector<std::string>>;
+
+                    mutable std::map<ProjectionKey, std::shared_ptr<const reader::Projection>> m_projections;
+
+                    /**
+                     * What each reflected C++ type was found to match in
+                     * the schema and how it's to be decoded
+                     */
+                    mutable std::map<std::type_index, std::shared_ptr<const void>> m_bound;
+
+                    /**
+                     * The schema's own footprint, fixed once decoded, and
+                     * that of whatever's been compiled from it since
+                     */
+                    size_t m_bytes;
+                    mutable std::atomic<size_t> m_compiled;
+
+                    /**
+                     * Above one the whole schema is built at once, each
+                     * level of it on this many threads, rather than just
+                     * what the first type asked for needs
+                     */
+                    size_t m_threads;
+
+                public :
+                    explicit Entry (uPtr<schema::Envelope>, size_t threads_ = 1);
+
+                    const schema::ISchemaType & schema() const;
+                    const schema::Envelope & envelope() const { return *m_envelope; }
+
+                    const CompositeFactory::ReaderType *
+                    byDescriptor (const std::string &) const;
+
+                    const program::Program * program (const std::string &) const;
+
+                    /**
+                     * Whether the readers for a type are already built,
+                     * so [byDescriptor] wouldn't stop to build them
+                     */
+                    bool ready (const std::string &) const;
+
+                    /**
+                     * Compiled the first time a set of paths is asked for
+                     * against a type, then reused
+                     */
+                    std::shared_ptr<const reader::Projection> projection (
+                        const std::string &,
+                        const std::vector<std::string> &) const;
+
+                    using Binder = std::function<std::shared_ptr<const void> (const schema::Schema &)>;
+
+                    /**
+                     * The first time [type_] is decoded against the schema
+                     * [binder_] checks the two match, throwing if they
+                     * can't, and returns whatever is needed to decode one
+                     * from the other. Later calls just return that
+                     */
+                    const std::shared_ptr<const void> & bind (
+                        std::type_index type_,
+                        const Binder & binder_) const;
+
+                    /**
+                     * An estimate of the memory held by the schema and
+                     * everything built from it so far, growing as more
+                     * of it is compiled
+                     */
+                    size_t bytes() const;
+            };
+
+            using Builder = std::function<uPtr<schema::Envelope>(void)>;
+
+        private :
+            mutable std::mutex m_lock;
+
+            struct Node {
+                std::string m_schema;
+
+                /**
+                 * The one or the other, see [evict]
+                 */
+                std::shared_ptr<const Entry> m_entry;
+                std::shared_ptr<const schema::Compact> m_compact;
+
+                size_t bytes() const;
+            };
+
+            /**
+             * Most recently used first. Finding an entry counts as using
+             * it so this changes under a const [find] too
+             */
+            mutable std::list<Node> m_lru;
+
+            /**
+             * Keyed on views of the bytes held by each node of [m_lru] so
+             * a lookup never has to copy the key to make one
+             */
+            std::unordered_map<std::string_view, std::list<Node>::iterator> m_entries;
+
+            size_t m_hits;
+            size_t m_misses;
+            size_t m_evictions;
+            size_t m_compactions;
+
+            /**
+             * No limit when zero
+             */
+            size_t m_limit;
+
+            /**
+             * Of the misses, how many were restored from [m_store] rather
+             * than decoded
+             */
+            size_t m_restored;
+
+            std::shared_ptr<const SchemaStore> m_store;
+
+            size_t m_threads;
+
+            /**
+             * With the lock held, compact the least recently used entries
+             * until what's left fits [m_limit], then drop the least
+             * recently used compacted ones should it still not. The most
+             * recent is always kept whole, however large
+             */
+            void evict();
+
+            /**
+             * With the lock held, [node_]'s entry, expanding it should it
+             * have been compacted
+             */
+            const std::shared_ptr<const Entry> & expand (Node & node_) const;
+
+        public :
+            ReaderCache();
+            ReaderCache (const ReaderCache &) = delete;
+
+            /**
+             * The single cache shared by everything in the process
+             */
+            static ReaderCache & instance();
+
+            /**
+             * Fetch the compiled readers for the schema encoded by [bytes_],
+             * on a miss [builder_] is called to decode the envelope those
+             * bytes belong to so it can be compiled, unless an attached
+             * store already holds it.
+             */
+            std::shared_ptr<const Entry> fetch (
+                std::string_view bytes_,
+                const Builder & builder_);
+
+            std::shared_ptr<const Entry> find (std::string_view) const;
+
+            /**
+             * Look schemas up in [store_] before decoding them, null
+             * detaching whatever was attached
+             */
+            void attach (std::shared_ptr<const SchemaStore> store_);
+
+            /**
+             * Detach [store_] if it's still the one attached
+             */
+            void detach (const std::shared_ptr<const SchemaStore> & store_);
+
+            /**
+             * Call [fn_] with every schema compiled so far and its entry
+             */
+            void each (const std::function<void (std::string_view, const Entry &)> & fn_) const;
+
+            /**
+             * Cap the memory the cache may hold at roughly [bytes_], zero
+             * lifting it. Entries grow as they're compiled so the cap is
+             * enforced whenever a schema is added rather than exactly
+             */
+            void limit (size_t bytes_);
+
+            size_t limit() const;
+
+            /**
+             * Build each newly cached schema's readers on up to
+             * [threads_] threads, see [CompositeFactory::process]. Only
+             * worth it for schemas of many types on a cold cache, one,
+             * the default, building them as they're needed
+             */
+            void threads (size_t threads_);
+
+            size_t threads() const;
+
+            /**
+             * The estimated memory held by every cached schema and its
+             * readers, see [Entry::bytes]
+             */
+            size_t bytes() const;
+
+            size_t size() const;
+            size_t hits() const;
+            size_t misses() const;
+            size_t restored() const;
+            size_t evictions() const;
+
+            /**
+             * Schemas compacted to keep within [limit] since cleared, and
+             * how many are held compacted now
+             */
+            size_t compactions() const;
+            size_t compacted() const;
+
+            void clear();
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,500 @@
+#include "SchemaStore.h"
+
+#include <map>
+#include <list>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "debug.h"
+
+#include "ReaderCache.h"
+
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace schema = amqp::internal::schema;
+
+    constexpr char MAGIC[] { 'C', 'O', 'R', 'D', 'A', 'S', 'C', 'H' };
+
+    /**
+     * magic, version, count and the index's checksum
+     */
+    constexpr size_t HEADER = sizeof (MAGIC) + 4 + 4 + 8;
+
+    /**
+     * hash, offset, size, padding and the record's checksum
+     */
+    constexpr size_t ENTRY = 8 + 8 + 4 + 4 + 8;
+
+    constexpr uint8_t COMPOSITE = 0;
+    constexpr uint8_t RESTRICTED = 1;
+
+    /**
+     * FNV-1a, a schema's bytes share long runs with every other's so we
+     * want something that mixes every byte
+     */
+    uint64_t
+    hash (std::string_view bytes_) {
+        uint64_t h { 14695981039346656037ULL };
+
+        for (auto c : bytes_) {
+            h ^= static_cast<unsigned char> (c);
+            h *= 1099511628211ULL;
+        }
+
+        return h;
+    }
+
+    /**************************************************************************/
+
+    class Writer {
+        private :
+            std::string m_bytes;
+
+        public :
+            template<class T>
+            void integer (T value_) {
+                for (size_t i { 0 } ; i < sizeof (T) ; ++i) {
+                    m_bytes += static_cast<char> ((static_cast<uint64_t> (value_) >> (8 * i)) & 0xff);
+                }
+            }
+
+            void string (std::string_view value_) {
+                integer (static_cast<uint32_t> (value_.size()));
+                m_bytes.append (value_.data(), value_.size());
+            }
+
+            template<class Strings>
+            void strings (const Strings & values_) {
+                integer (static_cast<uint32_t> (values_.size()));
+                for (const auto & value : values_) string (value);
+            }
+
+            void raw (std::string_view value_) { m_bytes.append (value_.data(), value_.size()); }
+
+            std::string & bytes() { return m_bytes; }
+    };
+
+    /**************************************************************************/
+
+    /**
+     * Everything read is bounds checked, running off the end of the record
+     * throwing for [find] to catch
+     */
+    class Reader {
+        private :
+            std::string_view m_bytes;
+            size_t m_pos { 0 };
+
+            void need (size_t size_) const {
+                if (m_bytes.size() - m_pos < size_) {
+                    throw std::runtime_error ("SchemaStore record is truncated");
+                }
+            }
+
+        public :
+            explicit Reader (std::string_view bytes_) : m_bytes (bytes_) { }
+
+            template<class T>
+            T integer() {
+                need (sizeof (T));
+
+                uint64_t rtn { 0 };
+                for (size_t i { 0 } ; i < sizeof (T) ; ++i) {
+                    rtn |= static_cast<uint64_t> (static_cast<unsigned char> (m_bytes[m_pos++])) << (8 * i);
+                }
+
+                return static_cast<T> (rtn);
+            }
+
+            std::string_view view() {
+                auto size = integer<uint32_t>();
+                need (size);
+
+                auto rtn = m_bytes.substr (m_pos, size);
+                m_pos += size;
+
+                return rtn;
+            }
+
+            std::string string() { return std::string (view()); }
+
+            template<class Strings>
+            Strings strings() {
+                Strings rtn;
+                for (auto i = integer<uint32_t>() ; i > 0 ; --i) rtn.push_back (string());
+                return rtn;
+            }
+
+            bool done() const { return m_pos == m_bytes.size(); }
+    };
+
+    /**************************************************************************/
+
+    void
+    encode (Writer & out_, const schema::AMQPTypeNotation & type_) {
+        if (type_.type() == schema::AMQPTypeNotation::composite_t) {
+            const auto & composite = dynamic_cast<const schema::Composite &> (type_);
+
+            out_.integer (COMPOSITE);
+            out_.string (composite.name());
+            out_.string (composite.label());
+            out_.strings (composite.provides());
+            out_.string (composite.descriptor());
+
+            out_.integer (static_cast<uint32_t> (composite.fields().size()));
+
+            for (const auto & field : composite.fields()) {
+                out_.string (field->name());
+                out_.string (field->type());
+                out_.strings (field->requires());
+                out_.string (field->defaultValue());
+                out_.string (field->label());
+                out_.integer (static_cast<uint8_t> (field->mandatory()));
+                out_.integer (static_cast<uint8_t> (field->multiple()));
+            }
+        } else {
+            const auto & restricted = dynamic_cast<const schema::Restricted &> (type_);
+
+            out_.integer (RESTRICTED);
+            out_.string (restricted.name());
+            out_.string (restricted.label());
+            out_.strings (restricted.provides());
+            out_.string (restricted.descriptor());
+            out_.string (restricted.source() == schema::Restricted::map_t ? "map" : "list");
+
+            if (restricted.restrictedType() == schema::Restricted::enum_t) {
+                out_.strings (dynamic_cast<const schema::Enum &> (restricted).makeChoices());
+            } else {
+                out_.integer (static_cast<uint32_t> (0));
+            }
+        }
+    }
+
+    /**************************************************************************/
+
+    uPtr<schema::AMQPTypeNotation>
+    decode (Reader & in_) {
+        auto kind = in_.integer<uint8_t>();
+        auto name = in_.string();
+        auto label = in_.string();
+
+        if (kind == COMPOSITE) {
+            auto provides = in_.strings<std::vector<std::string>>();
+            auto descriptor = in_.string();
+
+            std::vector<uPtr<schema::Field>> fields;
+            for (auto i = in_.integer<uint32_t>() ; i > 0 ; --i) {
+                auto fieldName = in_.string();
+                auto type = in_.string();
+                auto requires = in_.strings<std::vector<std::string>>();
+                auto value = in_.string();
+                auto fieldLabel = in_.string();
+                auto mandatory = in_.integer<uint8_t>() != 0;
+                auto multiple = in_.integer<uint8_t>() != 0;
+
+                fields.emplace_back (schema::Field::make (
+                        std::move (fieldName), std::move (type), std::move (requires),
+                        std::move (value), std::move (fieldLabel), mandatory, multiple));
+            }
+
+            return std::make_unique<schema::Composite> (
+                    std::move (name),
+                    std::move (label),
+                    std::move (provides),
+                    std::make_unique<schema::Descriptor> (std::move (descriptor)),
+                    std::move (fields));
+        } else if (kind == RESTRICTED) {
+            auto provides = in_.strings<std::vector<std::string>>();
+            auto descriptor = in_.string();
+            auto source = in_.string();
+
+            std::vector<uPtr<schema::Choice>> choices;
+            for (auto i = in_.integer<uint32_t>() ; i > 0 ; --i) {
+                choices.emplace_back (std::make_unique<schema::Choice> (in_.string()));
+            }
+
+            return schema::Restricted::make (
+                    std::make_unique<schema::Descriptor> (std::move (descriptor)),
+                    std::move (name),
+                    std::move (label),
+                    std::move (provides),
+                    std::move (source),
+                    std::move (choices));
+        }
+
+        throw std::runtime_error ("SchemaStore record holds an unknown kind of type");
+    }
+
+    /**************************************************************************/
+
+    uint64_t
+    load (const char * at_) {
+        uint64_t rtn { 0 };
+        for (size_t i { 0 } ; i < 8 ; ++i) {
+            rtn |= static_cast<uint64_t> (static_cast<unsigned char> (at_[i])) << (8 * i);
+        }
+        return rtn;
+    }
+
+    uint32_t
+    load32 (const char * at_) {
+        uint32_t rtn { 0 };
+        for (size_t i { 0 } ; i < 4 ; ++i) {
+            rtn |= static_cast<uint32_t> (static_cast<unsigned char> (at_[i])) << (8 * i);
+        }
+        return rtn;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::SchemaStore
+ *
+ ******************************************************************************/
+
+amqp::internal::
+SchemaStore::SchemaStore (std::string path_)
+    : m_path (std::move (path_))
+    , m_map (nullptr)
+    , m_mapSize (0)
+    , m_count (0)
+{
+    int fd = ::open (m_path.c_str(), O_RDONLY);
+
+    if (fd < 0) return;
+
+    struct stat results { };
+
+    if (::fstat (fd, &results) != 0
+        || !S_ISREG (results.st_mode)
+        || static_cast<size_t> (results.st_size) < HEADER)
+    {
+        ::close (fd);
+        return;
+    }
+
+    auto size = static_cast<size_t> (results.st_size);
+    auto * map = ::mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping holds its own reference to the file
+    ::close (fd);
+
+    if (map == MAP_FAILED) return;
+
+    m_map = static_cast<const char *> (map);
+    m_mapSize = size;
+
+    auto count = load32 (m_map + sizeof (MAGIC) + 4);
+
+    bool valid = std::memcmp (m_map, MAGIC, sizeof (MAGIC)) == 0
+        && load32 (m_map + sizeof (MAGIC)) == VERSION
+        && count <= (m_mapSize - HEADER) / ENTRY
+        && load (m_map + sizeof (MAGIC) + 8)
+               == hash (std::string_view (m_map + HEADER, count * ENTRY));
+
+    if (valid) {
+        m_count = count;
+    } else {
+        DBG ("SchemaStore - ignoring " << m_path << std::endl); // NOLINT
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::
+SchemaStore::~SchemaStore() {
+    if (m_map) ::munmap (const_cast<char *> (m_map), m_mapSize);
+}
+
+/******************************************************************************/
+
+/**
+ * The [i_]th record, empty should its entry point outside the file or its
+ * checksum not match
+ */
+std::string_view
+amqp::internal::
+SchemaStore::record (size_t i_) const {
+    const char * entry = m_map + HEADER + i_ * ENTRY;
+
+    auto offset = load (entry + 8);
+    auto size = load32 (entry + 16);
+
+    if (offset > m_mapSize || m_mapSize - offset < size) return { };
+
+    std::string_view rtn (m_map + offset, size);
+
+    return hash (rtn) == load (entry + 24) ? rtn : std::string_view { };
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::schema::Envelope>
+amqp::internal::
+SchemaStore::find (std::string_view schema_) const {
+    auto h = hash (schema_);
+
+    // the entries are sorted by hash, find the first with ours
+    size_t lo { 0 }, hi { m_count };
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        if (load (m_map + HEADER + mid * ENTRY) < h) lo = mid + 1; else hi = mid;
+    }
+
+    for (; lo < m_count && load (m_map + HEADER + lo * ENTRY) == h ; ++lo) {
+        auto bytes = record (lo);
+
+        if (bytes.empty()) continue;
+
+        try {
+            Reader in (bytes);
+
+            if (in.view() != schema_) continue;
+
+            auto descriptor = in.string();
+
+            std::vector<size_t> levels { 0 };
+            for (auto i = in.integer<uint32_t>() ; i > 0 ; --i) {
+                levels.push_back (levels.back() + in.integer<uint32_t>());
+            }
+
+            std::vector<uPtr<schema::AMQPTypeNotation>> types;
+            while (types.size() < levels.back()) {
+                types.emplace_back (::decode (in));
+            }
+
+            if (!in.done()) {
+                throw std::runtime_error ("SchemaStore record has trailing bytes");
+            }
+
+            schema::TypeNotationGraph<schema::AMQPTypeNotation> graph;
+            graph.restore (std::move (types), std::move (levels));
+
+            auto restored = std::make_unique<schema::Schema> (std::move (graph));
+
+            return std::make_unique<schema::Envelope> (restored, std::move (descriptor));
+        } catch (const std::exception & e) {
+            DBG ("SchemaStore - unreadable record: " << e.what() << std::endl); // NOLINT
+        }
+    }
+
+    return nullptr;
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::
+SchemaStore::encode (std::string_view schema_, const schema::Envelope & envelope_) {
+    const auto & types = dynamic_cast<const schema::Schema &> (envelope_.schema());
+
+    Writer out;
+
+    out.string (schema_);
+    out.string (envelope_.descriptor());
+
+    uint32_t levels { 0 };
+    for (auto it = types.begin() ; it != types.end() ; ++it) ++levels;
+
+    out.integer (levels);
+    for (const auto & level : types) {
+        out.integer (static_cast<uint32_t> (level.size()));
+    }
+
+    for (const auto & level : types) {
+        for (const auto & type : level) {
+            ::encode (out, *type);
+        }
+    }
+
+    return std::move (out.bytes());
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::
+SchemaStore::save (const ReaderCache & cache_) const {
+    /*
+     * Records, keyed on their hash and then their schema, the store's own
+     * copied before we write over the file they're mapped from
+     */
+    std::map<std::pair<uint64_t, std::string>, std::string> records;
+
+    for (size_t i { 0 } ; i < m_count ; ++i) {
+        auto bytes = record (i);
+
+        if (bytes.empty()) continue;
+
+        try {
+            auto key = Reader (bytes).string();
+            auto h = hash (key);
+            records.emplace (std::make_pair (h, std::move (key)), std::string (bytes));
+        } catch (const std::exception &) {
+            // unreadable, drop it
+        }
+    }
+
+    cache_.each ([&records](std::string_view schema_, const ReaderCache::Entry & entry_) {
+        std::pair<uint64_t, std::string> key { hash (schema_), std::string (schema_) };
+
+        if (!records.count (key)) {
+            records.emplace (std::move (key), encode (schema_, entry_.envelope()));
+        }
+    });
+
+    Writer index;
+    uint64_t offset { HEADER + records.size() * ENTRY };
+
+    for (const auto & record : records) {
+        index.integer (record.first.first);
+        index.integer (offset);
+        index.integer (static_cast<uint32_t> (record.second.size()));
+        index.integer (static_cast<uint32_t> (0));
+        index.integer (hash (record.second));
+
+        offset += record.second.size();
+    }
+
+    Writer header;
+    header.raw (std::string_view (MAGIC, sizeof (MAGIC)));
+    header.integer (VERSION);
+    header.integer (static_cast<uint32_t> (records.size()));
+    header.integer (hash (index.bytes()));
+
+    auto tmp = m_path + ".tmp";
+
+    {
+        std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+
+        out << header.bytes() << index.bytes();
+        for (const auto & record : records) out << record.second;
+
+        if (!out.flush()) {
+            throw std::runtime_error ("Failed to write " + tmp);
+        }
+    }
+
+    if (std::rename (tmp.c_str(), m_path.c_str()) != 0) {
+        std::remove (tmp.c_str());
+        throw std::runtime_error ("Failed to replace " + m_path);
+    }
+}
+
+/******************************************************************************/
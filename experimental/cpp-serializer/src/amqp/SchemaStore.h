@@ -0,0 +1,118 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "types.h"
+
+/******************************************************************************/
+
+namespace amqp::internal {
+
+    class ReaderCache;
+
+    namespace schema {
+
+        class Envelope;
+
+    }
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::SchemaStore
+ *
+ ******************************************************************************/
+
+namespace amqp::internal {
+
+    /**
+     * Compiled schemas kept on disk between processes. Each is keyed on
+     * the raw encoded bytes of a blob's schema section, just as the
+     * [ReaderCache] keys them, and holds the schema's types already
+     * decoded and in dependency order. Restoring one skips decoding its
+     * descriptors, unboxing its type names and ordering its types.
+     *
+     * The file is mapped read only when opened and nothing in it is
+     * touched until a schema is looked up, so however many schemas it
+     * holds opening it costs no more than the mapping.
+     *
+     *   header   "CORDASCH", version, count, checksum of the index
+     *   index    count entries sorted by hash: hash of the key, offset
+     *            and size of the record, checksum of the record
+     *   records  the key, the envelope's descriptor, each level's size
+     *            then the types level by level
+     *
+     * Every integer is little endian and every string a 32 bit size and
+     * its bytes. Nothing read from the file is trusted: a file with the
+     * wrong magic or version, or whose index doesn't check out, is
+     * treated as empty, and a record that fails its checksum or doesn't
+     * decode is treated as missing, the schema then being decoded from
+     * the blob as it would have been without the store.
+     */
+    class SchemaStore {
+        public :
+            static constexpr uint32_t VERSION = 1;
+
+        private :
+            std::string m_path;
+
+            const char * m_map;
+            size_t m_mapSize;
+
+            /**
+             * Entries in the mapping's index, zero when it isn't a valid
+             * store
+             */
+            uint32_t m_count;
+
+            std::string_view record (size_t) const;
+
+        public :
+            /**
+             * Map the store at [path_], which needn't exist yet
+             */
+            explicit SchemaStore (std::string path_);
+
+            SchemaStore (const SchemaStore &) = delete;
+            SchemaStore & operator = (const SchemaStore &) = delete;
+
+            ~SchemaStore();
+
+            const std::string & path() const { return m_path; }
+
+            /**
+             * How many schemas the mapped file holds
+             */
+            size_t size() const { return m_count; }
+
+            /**
+             * The envelope compiled from the schema section [schema_], null
+             * if it isn't stored or its record is unreadable
+             */
+            uPtr<schema::Envelope> find (std::string_view schema_) const;
+
+            /**
+             * Rewrite the file with every schema already in it along with
+             * those compiled by [cache_]. The new file is written alongside
+             * and renamed over the old one, so a process stopping part way
+             * through never leaves a truncated store and anything mapping
+             * the old one is unaffected
+             */
+            void save (const ReaderCache & cache_) const;
+
+            /**
+             * The record [find] would restore [envelope_] from, keyed on
+             * [schema_]
+             */
+            static std::string encode (std::string_view schema_, const schema::Envelope & envelope_);
+    };
+
+}
+
+/******************************************************************************/
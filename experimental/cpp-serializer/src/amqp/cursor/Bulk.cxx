@@ -0,0 +1,286 @@
+#include "Bulk.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Limits.h"
+#include "kernels/Kernels.h"
+
+/******************************************************************************/
+
+namespace {
+
+    inline uint8_t
+    u8 (const char * p_) {
+        return static_cast<uint8_t>(*p_);
+    }
+
+    inline uint32_t
+    be32 (const char * p_) {
+        uint32_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return __builtin_bswap32 (rtn);
+    }
+
+    inline uint64_t
+    be64 (const char * p_) {
+        uint64_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return __builtin_bswap64 (rtn);
+    }
+
+    /**
+     * Where the elements of a list or array start and how many there
+     * are, for arrays [m_code] being the constructor they share
+     */
+    struct Header {
+        const char * m_first;
+        const char * m_end;
+        uint32_t m_count;
+        bool m_array;
+        uint8_t m_code;
+    };
+
+    /**
+     * The fewest bytes an element of an array of [code_] can take, 0 for
+     * the encodings that take none, and those that aren't known, whose
+     * count the bytes can't bound
+     */
+    size_t
+    narrowest (uint8_t code_) {
+        switch (code_ >> 4) {
+            case 0x5 : return 1;
+            case 0x6 : return 2;
+            case 0x7 : return 4;
+            case 0x8 : return 8;
+            case 0x9 : return 16;
+            case 0xa : // fall through
+            case 0xc : // fall through
+            case 0xe : return 1;
+            case 0xb : // fall through
+            case 0xd : // fall through
+            case 0xf : return 4;
+            default  : return 0;
+        }
+    }
+
+    /**
+     * Every element of a list takes at least its constructor, and of an
+     * array at least [narrowest] of theirs, so a count claiming more
+     * than that is rejected before anything is sized by it
+     */
+    Header
+    header (std::string_view encoded_) {
+        const char * p = encoded_.data();
+        const char * end = p + encoded_.size();
+
+        auto require = [end](const char * p_, size_t n_) {
+            if (static_cast<size_t>(end - p_) < n_) {
+                throw std::runtime_error ("AMQP stream truncated");
+            }
+            return p_;
+        };
+
+        Header rtn { nullptr, end, 0, false, 0 };
+
+        switch (u8 (require (p, 1))) {
+            case 0x45 :
+                rtn.m_first = p + 1;
+                break;
+            case 0xc0 :
+                rtn.m_count = u8 (require (p + 2, 1));
+                rtn.m_first = p + 3;
+                break;
+            case 0xd0 :
+                rtn.m_count = be32 (require (p + 5, 4));
+                rtn.m_first = p + 9;
+                break;
+            case 0xe0 :
+                rtn.m_count = u8 (require (p + 2, 1));
+                rtn.m_code = u8 (require (p + 3, 1));
+                rtn.m_first = p + 4;
+                rtn.m_array = true;
+                break;
+            case 0xf0 :
+                rtn.m_count = be32 (require (p + 5, 4));
+                rtn.m_code = u8 (require (p + 9, 1));
+                rtn.m_first = p + 10;
+                rtn.m_array = true;
+                break;
+            default :
+                throw std::runtime_error ("Expected a list or array");
+        }
+
+        size_t width = rtn.m_array ? narrowest (rtn.m_code) : 1;
+
+        if (width && static_cast<size_t>(rtn.m_end - rtn.m_first) / width < rtn.m_count) {
+            throw std::runtime_error ("AMQP stream corrupt, more elements than bytes");
+        }
+
+        return rtn;
+    }
+
+    /**
+     * The packed payload of an array of [n_] values [width_] bytes wide
+     */
+    const char *
+    packed (const Header & header_, size_t width_) {
+        if (static_cast<size_t>(header_.m_end - header_.m_first) / width_ < header_.m_count) {
+            throw std::runtime_error ("AMQP stream truncated");
+        }
+
+        return header_.m_first;
+    }
+
+    /**
+     * What's worth reserving for the elements, an array of an encoding
+     * taking no bytes not being bounded by them
+     */
+    size_t
+    reservable (const Header & header_) {
+        return std::min<size_t> (header_.m_count, header_.m_end - header_.m_first);
+    }
+
+    /**
+     * Lists, and arrays of the narrow encodings, a value at a time.
+     * [width_] gives how many bytes a value with a constructor takes, 0
+     * for those not wanted, and [read_] decodes it. The elements are
+     * charged to the [Limits] only once they've all been taken, those
+     * left to the cursor being charged by it
+     */
+    template<typename T, typename Width, typename Read>
+    bool
+    each (const Header & header_, std::vector<T> & out_, Width && width_, Read && read_) {
+        const char * p = header_.m_first;
+
+        for (uint32_t i { 0 } ; i < header_.m_count ; ++i) {
+            uint8_t code;
+
+            if (header_.m_array) {
+                code = header_.m_code;
+            } else {
+                if (p >= header_.m_end) throw std::runtime_error ("AMQP stream truncated");
+                code = u8 (p++);
+            }
+
+            size_t width = width_ (code);
+
+            if (width == 0) return false;
+
+            if (static_cast<size_t>(header_.m_end - p) < width) {
+                throw std::runtime_error ("AMQP stream truncated");
+            }
+
+            out_.push_back (read_ (code, p));
+            p += width;
+        }
+
+        amqp::internal::cursor::Limits::elements (header_.m_count);
+
+        return true;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Bulk readers
+ *
+ ******************************************************************************/
+
+bool
+amqp::internal::cursor::
+readInts (std::string_view encoded_, std::vector<int64_t> & out_) {
+    auto h = header (encoded_);
+
+    out_.clear();
+
+    if (h.m_array && h.m_code == 0x71) {
+        Limits::elements (h.m_count);
+        out_.resize (h.m_count);
+        kernels::Kernels::table().m_swap32 (packed (h, 4), h.m_count, out_.data());
+        return true;
+    }
+
+    out_.reserve (reservable (h));
+
+    return each (h, out_,
+        [](uint8_t code_) -> size_t {
+            switch (code_) {
+                case 0x71 : return 4;
+                case 0x54 : return 1;
+                default   : return 0;
+            }
+        },
+        [](uint8_t code_, const char * p_) -> int64_t {
+            return code_ == 0x71
+                ? static_cast<int32_t>(be32 (p_))
+                : static_cast<int8_t>(u8 (p_));
+        });
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+readLongs (std::string_view encoded_, std::vector<int64_t> & out_) {
+    auto h = header (encoded_);
+
+    out_.clear();
+
+    if (h.m_array && h.m_code == 0x81) {
+        Limits::elements (h.m_count);
+        out_.resize (h.m_count);
+        kernels::Kernels::table().m_swap64 (packed (h, 8), h.m_count, out_.data());
+        return true;
+    }
+
+    out_.reserve (reservable (h));
+
+    return each (h, out_,
+        [](uint8_t code_) -> size_t {
+            switch (code_) {
+                case 0x81 : return 8;
+                case 0x55 : return 1;
+                default   : return 0;
+            }
+        },
+        [](uint8_t code_, const char * p_) -> int64_t {
+            return code_ == 0x81
+                ? static_cast<int64_t>(be64 (p_))
+                : static_cast<int8_t>(u8 (p_));
+        });
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+readDoubles (std::string_view encoded_, std::vector<double> & out_) {
+    auto h = header (encoded_);
+
+    out_.clear();
+
+    if (h.m_array && h.m_code == 0x82) {
+        Limits::elements (h.m_count);
+        out_.resize (h.m_count);
+        kernels::Kernels::table().m_swap64 (packed (h, 8), h.m_count, out_.data());
+        return true;
+    }
+
+    out_.reserve (reservable (h));
+
+    return each (h, out_,
+        [](uint8_t code_) -> size_t {
+            return code_ == 0x82 ? 8 : 0;
+        },
+        [](uint8_t, const char * p_) {
+            double rtn;
+            auto bits = be64 (p_);
+            std::memcpy (&rtn, &bits, sizeof (rtn));
+            return rtn;
+        });
+}
+
+/******************************************************************************/
@@ -0,0 +1,42 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * Decoding whole lists and arrays of primitives at once
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * Decode every element of the encoded list or array [encoded_], its
+     * constructor included as returned by [Cursor::encoded], into [out_]
+     * in a single pass rather than a node at a time.
+     *
+     * True AMQP arrays, whose elements share a constructor and so are
+     * packed back to back, are byte swapped a vector at a time by
+     * whichever [kernels::Kernels] suit the machine. Lists, each element
+     * with a constructor of its own, are decoded element by element but
+     * without the cursor.
+     *
+     * False, with [out_] left holding whatever was decoded so far, should
+     * any element not be of the wanted type, a null say, so the caller can
+     * fall back to decoding it a node at a time and fail like that would.
+     * As entering it with the cursor would, a count more than the bytes
+     * could hold is thrown for and, once decoded, the elements are
+     * charged to whichever [Limits] are in scope.
+     */
+    bool readInts (std::string_view encoded_, std::vector<int64_t> & out_);
+    bool readLongs (std::string_view encoded_, std::vector<int64_t> & out_);
+    bool readDoubles (std::string_view encoded_, std::vector<double> & out_);
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,1349 @@
+#include "Cursor.h"
+#include "Limits.h"
+
+#include <limits>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Used as the remaining child count of the outermost frame, the top
+     * level of a buffer isn't bounded by anything but its size.
+     */
+    constexpr uint32_t UNBOUNDED = std::numeric_limits<uint32_t>::max();
+
+    inline uint8_t
+    u8 (const char * p_) {
+        return static_cast<uint8_t>(*p_);
+    }
+
+    inline uint16_t
+    be16 (const char * p_) {
+        return static_cast<uint16_t>((u8 (p_) << 8U) | u8 (p_ + 1));
+    }
+
+    inline uint32_t
+    be32 (const char * p_) {
+        return (static_cast<uint32_t>(be16 (p_)) << 16U) | be16 (p_ + 2);
+    }
+
+    inline uint64_t
+    be64 (const char * p_) {
+        return (static_cast<uint64_t>(be32 (p_)) << 32U) | be32 (p_ + 4);
+    }
+
+    /**
+     * The size of the fixed width portion of an encoding, for variable
+     * width encodings this is the size of the size prefix.
+     */
+    inline size_t
+    widthOf (uint8_t code_) {
+        switch (code_ & 0xF0U) {
+            case 0x40 : return 0;
+            case 0x50 : return 1;
+            case 0x60 : return 2;
+            case 0x70 : return 4;
+            case 0x80 : return 8;
+            case 0x90 : return 16;
+            case 0xA0 :
+            case 0xC0 :
+            case 0xE0 : return 1;
+            case 0xB0 :
+            case 0xD0 :
+            case 0xF0 : return 4;
+            default : {
+                std::stringstream ss;
+                ss << "Invalid AMQP constructor 0x" << std::hex
+                   << static_cast<unsigned int>(code_);
+                throw std::runtime_error (ss.str());
+            }
+        }
+    }
+
+    amqp::internal::cursor::Type
+    typeOf (uint8_t code_) {
+        using namespace amqp::internal::cursor;
+
+        switch (code_) {
+            case 0x00 : return described_t;
+            case 0x40 : return null_t;
+            case 0x41 :
+            case 0x42 :
+            case 0x56 : return bool_t;
+            case 0x50 : return ubyte_t;
+            case 0x51 : return byte_t;
+            case 0x60 : return ushort_t;
+            case 0x61 : return short_t;
+            case 0x43 :
+            case 0x52 :
+            case 0x70 : return uint_t;
+            case 0x54 :
+            case 0x71 : return int_t;
+            case 0x73 : return char_t;
+            case 0x44 :
+            case 0x53 :
+            case 0x80 : return ulong_t;
+            case 0x55 :
+            case 0x81 : return long_t;
+            case 0x83 : return timestamp_t;
+            case 0x72 : return float_t;
+            case 0x82 : return double_t;
+            case 0x74 : return decimal32_t;
+            case 0x84 : return decimal64_t;
+            case 0x94 : return decimal128_t;
+            case 0x98 : return uuid_t;
+            case 0xA0 :
+            case 0xB0 : return binary_t;
+            case 0xA1 :
+            case 0xB1 : return string_t;
+            case 0xA3 :
+            case 0xB3 : return symbol_t;
+            case 0x45 :
+            case 0xC0 :
+            case 0xD0 : return list_t;
+            case 0xC1 :
+            case 0xD1 : return map_t;
+            case 0xE0 :
+            case 0xF0 : return array_t;
+            default   : return invalid_t;
+        }
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Type
+ *
+ ******************************************************************************/
+
+const char *
+amqp::internal::cursor::
+typeName (Type type_) {
+    switch (type_) {
+        case null_t       : return "null";
+        case bool_t       : return "bool";
+        case ubyte_t      : return "ubyte";
+        case byte_t       : return "byte";
+        case ushort_t     : return "ushort";
+        case short_t      : return "short";
+        case uint_t       : return "uint";
+        case int_t        : return "int";
+        case char_t       : return "char";
+        case ulong_t      : return "ulong";
+        case long_t       : return "long";
+        case timestamp_t  : return "timestamp";
+        case float_t      : return "float";
+        case double_t     : return "double";
+        case decimal32_t  : return "decimal32";
+        case decimal64_t  : return "decimal64";
+        case decimal128_t : return "decimal128";
+        case uuid_t       : return "uuid";
+        case binary_t     : return "binary";
+        case string_t     : return "string";
+        case symbol_t     : return "symbol";
+        case described_t  : return "described";
+        case array_t      : return "array";
+        case list_t       : return "list";
+        case map_t        : return "map";
+        default           : return "invalid";
+    }
+}
+
+/******************************************************************************/
+
+std::ostream &
+amqp::internal::cursor::
+operator << (std::ostream & stream_, const Type & type_) {
+    stream_ << typeName (type_);
+    return stream_;
+}
+
+/******************************************************************************/
+
+/**
+ * Friendly ostream operator for the node a cursor is currently on
+ */
+std::ostream &
+amqp::internal::cursor::
+operator << (std::ostream & stream_, const Cursor & data_) {
+    auto type = data_.type();
+    stream_ << std::setw (2) << static_cast<int>(type) << " " << type;
+
+    switch (type) {
+        case ulong_t  : stream_ << " " << data_.get_ulong(); break;
+        case list_t   : stream_ << " #entries: " << data_.get_list(); break;
+        case string_t : stream_ << " " << data_.get_string(); break;
+        case int_t    : stream_ << " " << data_.get_int(); break;
+        case bool_t   : stream_ << " " << (data_.get_bool() ? "true" : "false"); break;
+        case symbol_t : {
+            auto v = data_.get_symbol();
+            stream_ << " " << v.size() << std::endl << "   -> ";
+            for (auto c : v) {
+                stream_ << c << " ";
+            }
+            break;
+        }
+        default : break;
+    }
+
+    return stream_;
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Cursor
+ *
+ ******************************************************************************/
+
+/**
+ * Much like a freshly decoded pn_data_t the cursor starts positioned on the
+ * first node of the buffer.
+ */
+amqp::internal::cursor::
+Cursor::Cursor (const char * bytes_, size_t size_)
+    : m_begin (bytes_)
+    , m_end (bytes_ + size_)
+    , m_valid (false)
+    , m_current { 0, nullptr, false }
+{
+    m_frames.push_back (Frame {
+        m_current, m_begin, m_end, UNBOUNDED, 0, false, false });
+
+    next();
+}
+
+/******************************************************************************/
+
+const char *
+amqp::internal::cursor::
+Cursor::require (const char * p_, size_t n_) const {
+    if (p_ < m_begin || static_cast<size_t>(m_end - p_) < n_) {
+        throw std::runtime_error ("AMQP stream truncated");
+    }
+    return p_;
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Cursor::Node
+amqp::internal::cursor::
+Cursor::decode (const char * p_) const {
+    auto code = u8 (require (p_, 1));
+
+    if (code != 0x00 && typeOf (code) == invalid_t) {
+        widthOf (code); // throws for anything that isn't an encoding
+        std::stringstream ss;
+        ss << "Unsupported AMQP constructor 0x" << std::hex
+           << static_cast<unsigned int>(code);
+        throw std::runtime_error (ss.str());
+    }
+
+    return Node { code, p_ + 1, false };
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Cursor::Node
+amqp::internal::cursor::
+Cursor::decodeChild (const char * p_, const Frame & frame_) const {
+    if (frame_.m_array && !frame_.m_descriptorPending) {
+        return Node { frame_.m_elementCode, p_, true };
+    }
+
+    return decode (p_);
+}
+
+/******************************************************************************/
+
+/**
+ * Where the node finishes, compound types carry their size so this never
+ * needs to look at a node's children.
+ */
+const char *
+amqp::internal::cursor::
+Cursor::endOf (const Node & node_) const {
+    const char * p = node_.m_payload;
+
+    if (node_.m_code == 0x00) {
+        return endOfValue (endOfValue (p));
+    }
+
+    auto width = widthOf (node_.m_code);
+    require (p, width);
+
+    switch (node_.m_code & 0xF0U) {
+        case 0xA0 : case 0xC0 : case 0xE0 :
+            return require (p, 1 + u8 (p)) + 1 + u8 (p);
+        case 0xB0 : case 0xD0 : case 0xF0 :
+            return require (p, 4 + static_cast<size_t>(be32 (p))) + 4 + be32 (p);
+        default :
+            return p + width;
+    }
+}
+
+/******************************************************************************/
+
+const char *
+amqp::internal::cursor::
+Cursor::endOfValue (const char * p_) const {
+    return endOf (decode (p_));
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::next() {
+    auto & frame = m_frames.back();
+
+    if (frame.m_remaining == 0) {
+        return false;
+    }
+
+    const char * pos;
+
+    if (m_valid) {
+        pos = endOf (m_current);
+
+        // skip the constructor shared by the elements that follow
+        // an array's descriptor
+        if (frame.m_array && frame.m_descriptorPending) {
+            frame.m_descriptorPending = false;
+            ++pos;
+        }
+    } else {
+        pos = frame.m_first;
+    }
+
+    if (frame.m_remaining == UNBOUNDED) {
+        if (pos >= frame.m_end) {
+            return false;
+        }
+    } else if (pos > frame.m_end
+        || (pos == frame.m_end && !(frame.m_array && widthOf (frame.m_elementCode) == 0)))
+    {
+        throw std::runtime_error ("AMQP element overruns its container");
+    }
+
+    m_current = decodeChild (pos, frame);
+    m_valid = true;
+
+    if (frame.m_remaining != UNBOUNDED) {
+        --frame.m_remaining;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::skip (size_t n_) {
+    for (; n_ > 0 ; --n_) {
+        if (!next()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::enter() {
+    if (!m_valid) {
+        return false;
+    }
+
+    const char * p = m_current.m_payload;
+
+    Frame frame { m_current, p, p, 0, 0, false, false };
+
+    switch (m_current.m_code) {
+        case 0x00 : {
+            frame.m_end = endOf (m_current);
+            frame.m_remaining = 2;
+            break;
+        }
+        case 0xC0 :
+        case 0xC1 : {
+            require (p, 2);
+            frame.m_end = p + 1 + u8 (p);
+            frame.m_remaining = u8 (p + 1);
+            frame.m_first = p + 2;
+            break;
+        }
+        case 0xD0 :
+        case 0xD1 : {
+            require (p, 8);
+            frame.m_end = p + 4 + be32 (p);
+            frame.m_remaining = be32 (p + 4);
+            frame.m_first = p + 8;
+            break;
+        }
+        case 0xE0 :
+        case 0xF0 : {
+            const char * elementCode;
+
+            if (m_current.m_code == 0xE0) {
+                require (p, 3);
+                frame.m_end = p + 1 + u8 (p);
+                frame.m_remaining = u8 (p + 1);
+                elementCode = p + 2;
+            } else {
+                require (p, 9);
+                frame.m_end = p + 4 + be32 (p);
+                frame.m_remaining = be32 (p + 4);
+                elementCode = p + 8;
+            }
+
+            frame.m_array = true;
+            frame.m_first = elementCode + 1;
+
+            /*
+             * A described array carries an element descriptor before the
+             * shared constructor, like proton we present that descriptor
+             * as the first child of the array
+             */
+            if (u8 (elementCode) == 0x00) {
+                frame.m_descriptorPending = true;
+                frame.m_elementCode = u8 (require (endOfValue (frame.m_first), 1));
+                ++frame.m_remaining;
+            } else {
+                frame.m_elementCode = u8 (elementCode);
+            }
+
+            break;
+        }
+        default : {
+            // primitives and empty lists have no children to visit
+            break;
+        }
+    }
+
+    if (frame.m_end > m_end) {
+        throw std::runtime_error ("AMQP stream truncated");
+    }
+
+    /*
+     * Every element of a list or map takes at least a byte, so a count
+     * claiming more than that can't be trusted to size anything by
+     */
+    if (!frame.m_array && frame.m_remaining > static_cast<size_t> (frame.m_end - frame.m_first)) {
+        throw std::runtime_error ("AMQP stream corrupt, more elements than bytes");
+    }
+
+    Limits::depth (m_frames.size());
+
+    m_frames.push_back (frame);
+    m_valid = false;
+
+    return true;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::exit() {
+    if (m_frames.size() <= 1) {
+        return false;
+    }
+
+    m_current = m_frames.back().m_parent;
+    m_frames.pop_back();
+    m_valid = true;
+
+    return true;
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Type
+amqp::internal::cursor::
+Cursor::type() const {
+    return m_valid ? typeOf (m_current.m_code) : invalid_t;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::is_described() const {
+    return type() == described_t;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::get_list() const {
+    if (!m_valid) return 0;
+
+    const char * p = m_current.m_payload;
+
+    switch (m_current.m_code) {
+        case 0xC0 : return u8 (require (p, 2) + 1);
+        case 0xD0 : return be32 (require (p, 8) + 4);
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::get_map() const {
+    if (!m_valid) return 0;
+
+    const char * p = m_current.m_payload;
+
+    switch (m_current.m_code) {
+        case 0xC1 : return u8 (require (p, 2) + 1);
+        case 0xD1 : return be32 (require (p, 8) + 4);
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::get_array() const {
+    if (!m_valid) return 0;
+
+    const char * p = m_current.m_payload;
+
+    switch (m_current.m_code) {
+        case 0xE0 : return u8 (require (p, 3) + 1);
+        case 0xF0 : return be32 (require (p, 9) + 4);
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Cursor::get_bool() const {
+    if (!m_valid) return false;
+
+    switch (m_current.m_code) {
+        case 0x41 : return true;
+        case 0x56 : return u8 (require (m_current.m_payload, 1)) != 0;
+        default   : return false;
+    }
+}
+
+/******************************************************************************/
+
+uint8_t
+amqp::internal::cursor::
+Cursor::get_ubyte() const {
+    return type() == ubyte_t ? u8 (require (m_current.m_payload, 1)) : 0;
+}
+
+/******************************************************************************/
+
+int8_t
+amqp::internal::cursor::
+Cursor::get_byte() const {
+    return type() == byte_t
+        ? static_cast<int8_t>(u8 (require (m_current.m_payload, 1)))
+        : 0;
+}
+
+/******************************************************************************/
+
+uint16_t
+amqp::internal::cursor::
+Cursor::get_ushort() const {
+    return type() == ushort_t ? be16 (require (m_current.m_payload, 2)) : 0;
+}
+
+/******************************************************************************/
+
+int16_t
+amqp::internal::cursor::
+Cursor::get_short() const {
+    return type() == short_t
+        ? static_cast<int16_t>(be16 (require (m_current.m_payload, 2)))
+        : 0;
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::cursor::
+Cursor::get_uint() const {
+    if (!m_valid) return 0;
+
+    switch (m_current.m_code) {
+        case 0x70 : return be32 (require (m_current.m_payload, 4));
+        case 0x52 : return u8 (require (m_current.m_payload, 1));
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+int32_t
+amqp::internal::cursor::
+Cursor::get_int() const {
+    if (!m_valid) return 0;
+
+    switch (m_current.m_code) {
+        case 0x71 : return static_cast<int32_t>(be32 (require (m_current.m_payload, 4)));
+        case 0x54 : return static_cast<int8_t>(u8 (require (m_current.m_payload, 1)));
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::cursor::
+Cursor::get_char() const {
+    return type() == char_t ? be32 (require (m_current.m_payload, 4)) : 0;
+}
+
+/******************************************************************************/
+
+uint64_t
+amqp::internal::cursor::
+Cursor::get_ulong() const {
+    if (!m_valid) return 0;
+
+    switch (m_current.m_code) {
+        case 0x80 : return be64 (require (m_current.m_payload, 8));
+        case 0x53 : return u8 (require (m_current.m_payload, 1));
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+int64_t
+amqp::internal::cursor::
+Cursor::get_long() const {
+    if (!m_valid) return 0;
+
+    switch (m_current.m_code) {
+        case 0x81 : return static_cast<int64_t>(be64 (require (m_current.m_payload, 8)));
+        case 0x55 : return static_cast<int8_t>(u8 (require (m_current.m_payload, 1)));
+        default   : return 0;
+    }
+}
+
+/******************************************************************************/
+
+int64_t
+amqp::internal::cursor::
+Cursor::get_timestamp() const {
+    return type() == timestamp_t
+        ? static_cast<int64_t>(be64 (require (m_current.m_payload, 8)))
+        : 0;
+}
+
+/******************************************************************************/
+
+float
+amqp::internal::cursor::
+Cursor::get_float() const {
+    if (type() != float_t) return 0.0F;
+
+    uint32_t bits = be32 (require (m_current.m_payload, 4));
+    float rtn;
+    std::memcpy (&rtn, &bits, sizeof (rtn));
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+double
+amqp::internal::cursor::
+Cursor::get_double() const {
+    if (type() != double_t) return 0.0;
+
+    uint64_t bits = be64 (require (m_current.m_payload, 8));
+    double rtn;
+    std::memcpy (&rtn, &bits, sizeof (rtn));
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Both the 8 and 32 bit width variants of the variable width types
+     * share a layout of size then bytes
+     */
+    std::string_view
+    variable (const char * p_, uint8_t code_, const char * end_) {
+        if ((code_ & 0xF0U) == 0xA0) {
+            if (end_ - p_ < 1 || end_ - p_ - 1 < u8 (p_)) {
+                throw std::runtime_error ("AMQP stream truncated");
+            }
+            return std::string_view (p_ + 1, u8 (p_));
+        } else {
+            if (end_ - p_ < 4 || static_cast<size_t>(end_ - p_ - 4) < be32 (p_)) {
+                throw std::runtime_error ("AMQP stream truncated");
+            }
+            return std::string_view (p_ + 4, be32 (p_));
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::cursor::
+Cursor::get_string() const {
+    if (type() != string_t) return std::string_view { };
+
+    auto rtn = variable (m_current.m_payload, m_current.m_code, m_end);
+    Limits::strings (rtn.size());
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::cursor::
+Cursor::get_symbol() const {
+    return type() == symbol_t
+        ? variable (m_current.m_payload, m_current.m_code, m_end)
+        : std::string_view { };
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::cursor::
+Cursor::get_binary() const {
+    if (type() != binary_t) return std::string_view { };
+
+    auto rtn = variable (m_current.m_payload, m_current.m_code, m_end);
+    Limits::strings (rtn.size());
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::cursor::
+Cursor::get_fixed16() const {
+    auto t = type();
+    if (t != uuid_t && t != decimal128_t) return std::string_view { };
+
+    return std::string_view (require (m_current.m_payload, 16), 16);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::encodedSize() const {
+    if (!m_valid) return 0;
+
+    const char * start = m_current.m_element
+        ? m_current.m_payload
+        : m_current.m_payload - 1;
+
+    return static_cast<size_t>(endOf (m_current) - start);
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::cursor::
+Cursor::encoded() const {
+    if (!m_valid) return std::string_view { };
+
+    return std::string_view (m_begin + offset(), encodedSize());
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::offset() const {
+    const char * start = m_current.m_element || !m_valid
+        ? m_current.m_payload
+        : m_current.m_payload - 1;
+
+    return static_cast<size_t>(start - m_begin);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Cursor::depth() const {
+    return m_frames.size() - 1;
+}
+
+/******************************************************************************
+ *
+ * Free standing helpers
+ *
+ ******************************************************************************/
+
+void
+amqp::internal::cursor::
+mismatch (const Cursor & data_, Type expected_) {
+    std::stringstream ss;
+    ss << "Expected a " << typeName (expected_) << " but found [" << data_ << "]";
+    throw std::runtime_error (ss.str());
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::cursor::
+is_string (const Cursor & data_, bool allowNull) {
+    if (data_.type() != string_t) {
+        if (allowNull && data_.type() != null_t) {
+            throw std::runtime_error ("Expected a String");
+        }
+    }
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::cursor::
+get_string (const Cursor & data_, bool allowNull) {
+    if (data_.type() == string_t) {
+        return std::string { data_.get_string() };
+    } else if (allowNull && data_.type() == null_t) {
+        return "";
+    }
+    throw std::runtime_error ("Expected a String");
+}
+
+/******************************************************************************/
+
+template<>
+std::string
+amqp::internal::cursor::
+get_symbol<std::string> (const Cursor & data_) {
+    is_symbol (data_);
+    return std::string { data_.get_symbol() };
+}
+
+/******************************************************************************/
+
+template<>
+std::string_view
+amqp::internal::cursor::
+get_symbol<std::string_view> (const Cursor & data_) {
+    is_symbol (data_);
+    return data_.get_symbol();
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+get_boolean (const Cursor & data_) {
+    if (data_.type() == bool_t) {
+        return data_.get_bool();
+    }
+    throw std::runtime_error ("Expected a boolean");
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::auto_enter
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+auto_enter::auto_enter (Cursor & data_, bool next_)
+    : m_data (data_)
+{
+    m_data.enter();
+    m_data.next();
+    if (next_) m_data.next();
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::
+auto_enter::~auto_enter() {
+    m_data.exit();
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::auto_next
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+auto_next::auto_next (Cursor & data_)
+    : m_data (data_)
+{ }
+
+/******************************************************************************/
+
+amqp::internal::cursor::
+auto_next::~auto_next() {
+    m_data.next();
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::auto_list_enter
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+auto_list_enter::auto_list_enter (Cursor & data_, bool next_)
+    : m_elements (data_.get_list())
+    , m_data (data_)
+{
+    Limits::elements (m_elements);
+    m_data.enter();
+    if (next_) {
+        m_data.next();
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::
+auto_list_enter::~auto_list_enter() {
+    m_data.exit();
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+auto_list_enter::elements() const {
+    return m_elements;
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::auto_map_enter
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+auto_map_enter::auto_map_enter (Cursor & data_, bool next_)
+    : m_elements (data_.get_map())
+    , m_data (data_)
+{
+    Limits::elements (m_elements);
+    m_data.enter();
+    if (next_) {
+        m_data.next();
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::
+auto_map_enter::~auto_map_enter() {
+    m_data.exit();
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+auto_map_enter::elements() const {
+    return m_elements;
+}
+
+/******************************************************************************
+ *
+ * readAndNext
+ *
+ ******************************************************************************/
+
+template<>
+int8_t
+amqp::internal::cursor::
+readAndNext<int8_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+    return data_.get_byte();
+}
+
+/******************************************************************************/
+
+template<>
+int16_t
+amqp::internal::cursor::
+readAndNext<int16_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+    return data_.get_short();
+}
+
+/******************************************************************************/
+
+template<>
+int32_t
+amqp::internal::cursor::
+readAndNext<int32_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto rtn = data_.get_int();
+    data_.next();
+    return rtn;
+}
+
+/******************************************************************************/
+
+template<>
+std::string_view
+amqp::internal::cursor::
+readAndNext<std::string_view> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+
+    if (data_.type() == string_t) {
+        return data_.get_string();
+    } else if (data_.type() == symbol_t) {
+        return data_.get_symbol();
+    } else  if (tolerateDeviance_ && data_.type() == null_t) {
+        return { };
+    }
+    std::stringstream ss;
+    ss << "Expected a String but found [" << data_ << "]";
+    throw std::runtime_error (ss.str());
+}
+
+/******************************************************************************/
+
+template<>
+std::string
+amqp::internal::cursor::
+readAndNext<std::string> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    return std::string { readAndNext<std::string_view> (data_, tolerateDeviance_) };
+}
+
+/******************************************************************************/
+
+template<>
+bool
+amqp::internal::cursor::
+readAndNext<bool> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    bool rtn = data_.get_bool();
+    data_.next();
+    return rtn;
+}
+
+/******************************************************************************/
+
+template<>
+float
+amqp::internal::cursor::
+readAndNext<float> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+    return data_.get_float();
+}
+
+/******************************************************************************/
+
+template<>
+char32_t
+amqp::internal::cursor::
+readAndNext<char32_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+    return static_cast<char32_t>(data_.get_char());
+}
+
+/******************************************************************************/
+
+template<>
+double
+amqp::internal::cursor::
+readAndNext<double> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto_next an (data_);
+    return data_.get_double();
+}
+
+/******************************************************************************/
+
+template<>
+int64_t
+amqp::internal::cursor::
+readAndNext<int64_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto rtn = data_.get_long();
+    data_.next();
+    return rtn;
+}
+
+/******************************************************************************/
+
+template<>
+uint64_t
+amqp::internal::cursor::
+readAndNext<uint64_t> (
+    Cursor & data_,
+    bool tolerateDeviance_
+) {
+    auto rtn = data_.get_ulong();
+    data_.next();
+    return rtn;
+}
+
+/******************************************************************************/
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::validate
+ *
+ ******************************************************************************/
+
+namespace {
+
+    /**
+     * Far deeper than anything serialised nests but shallow enough that
+     * recursing that far can't exhaust the stack
+     */
+    constexpr size_t MAX_DEPTH = 1024;
+
+    constexpr char TRUNCATED[] = "AMQP stream truncated";
+    constexpr char INVALID[] = "Invalid AMQP constructor";
+    constexpr char OVERCOUNT[] = "AMQP compound claims more elements than it has bytes";
+    constexpr char ODD[] = "AMQP map with an odd number of elements";
+    constexpr char NESTED[] = "AMQP nested too deeply";
+
+    class Validator {
+        private :
+            const char * m_at;
+            const char * m_error;
+
+            bool fail (const char * at_, const char * error_) {
+                m_at = at_;
+                m_error = error_;
+                return false;
+            }
+
+            bool value (uint8_t, const char * &, const char *, size_t);
+            bool compound (uint8_t, const char * &, const char *, size_t);
+
+        public :
+            Validator() : m_at (nullptr), m_error (nullptr) { }
+
+            bool node (const char * &, const char *, size_t);
+
+            const char * at() const { return m_at; }
+            const char * error() const { return m_error; }
+    };
+
+    /**
+     * The node at [p_], constructor and all, leaving [p_] just past it
+     */
+    bool
+    Validator::node (const char * & p_, const char * end_, size_t depth_) {
+        if (p_ >= end_) return fail (p_, TRUNCATED);
+
+        const auto code = u8 (p_++);
+
+        if (code != 0x00) return value (code, p_, end_, depth_);
+
+        if (depth_ >= MAX_DEPTH) return fail (p_ - 1, NESTED);
+
+        return node (p_, end_, depth_ + 1) && node (p_, end_, depth_ + 1);
+    }
+
+    /**
+     * A value whose constructor, [code_], has already been read
+     */
+    bool
+    Validator::value (uint8_t code_, const char * & p_, const char * end_, size_t depth_) {
+        if (code_ == 0x00 || typeOf (code_) == amqp::internal::cursor::invalid_t) {
+            return fail (p_ - 1, INVALID);
+        }
+
+        const auto width = widthOf (code_);
+        const auto left = static_cast<size_t> (end_ - p_);
+
+        switch (code_ & 0xF0U) {
+            case 0x40 :
+            case 0x50 :
+            case 0x60 :
+            case 0x70 :
+            case 0x80 :
+            case 0x90 : {
+                if (left < width) return fail (p_, TRUNCATED);
+                p_ += width;
+                return true;
+            }
+            case 0xA0 :
+            case 0xB0 : {
+                if (left < width) return fail (p_, TRUNCATED);
+
+                const size_t size = width == 1 ? u8 (p_) : be32 (p_);
+                if (left - width < size) return fail (p_, TRUNCATED);
+
+                p_ += width + size;
+                return true;
+            }
+            default :
+                return compound (code_, p_, end_, depth_);
+        }
+    }
+
+    /**
+     * Lists, maps and arrays, each a size then a count, an array's
+     * elements then sharing a single constructor
+     */
+    bool
+    Validator::compound (uint8_t code_, const char * & p_, const char * end_, size_t depth_) {
+        if (depth_ >= MAX_DEPTH) return fail (p_ - 1, NESTED);
+
+        const auto width = widthOf (code_);
+
+        if (static_cast<size_t> (end_ - p_) < 2 * width) return fail (p_, TRUNCATED);
+
+        const size_t size = width == 1 ? u8 (p_) : be32 (p_);
+        const size_t count = width == 1 ? u8 (p_ + 1) : be32 (p_ + width);
+
+        if (size < width || static_cast<size_t> (end_ - p_) - width < size) return fail (p_, TRUNCATED);
+
+        const char * end = p_ + width + size;
+        const char * q = p_ + 2 * width;
+
+        if ((code_ & 0xF0U) != 0xE0 && (code_ & 0xF0U) != 0xF0) {
+            if (count > static_cast<size_t> (end - q)) return fail (p_, OVERCOUNT);
+            if ((code_ == 0xC1 || code_ == 0xD1) && count % 2 != 0) return fail (p_, ODD);
+
+            for (size_t i { 0 } ; i < count ; ++i) {
+                if (!node (q, end, depth_ + 1)) return false;
+            }
+
+            p_ = end;
+            return true;
+        }
+
+        if (q >= end) return fail (q, TRUNCATED);
+
+        auto element = u8 (q++);
+
+        if (element == 0x00) {
+            if (!node (q, end, depth_ + 1)) return false;
+            if (q >= end) return fail (q, TRUNCATED);
+
+            element = u8 (q++);
+        }
+
+        if (element == 0x00 || typeOf (element) == amqp::internal::cursor::invalid_t) {
+            return fail (q - 1, INVALID);
+        }
+
+        /*
+         * Fixed width elements are checked all at once, as an array of a
+         * great many empty ones, nulls say, takes no bytes to claim
+         */
+        const auto elementWidth = widthOf (element);
+
+        switch (element & 0xF0U) {
+            case 0x40 :
+            case 0x50 :
+            case 0x60 :
+            case 0x70 :
+            case 0x80 :
+            case 0x90 : {
+                if (elementWidth > 0 && count > static_cast<size_t> (end - q) / elementWidth) {
+                    return fail (q, OVERCOUNT);
+                }
+
+                break;
+            }
+            default : {
+                if (count > static_cast<size_t> (end - q)) return fail (q, OVERCOUNT);
+
+                for (size_t i { 0 } ; i < count ; ++i) {
+                    if (!value (element, q, end, depth_ + 1)) return false;
+                }
+
+                break;
+            }
+        }
+
+        p_ = end;
+        return true;
+    }
+
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::cursor::
+Status::message() const {
+    if (!m_error) return { };
+
+    return std::string (m_error) + " at byte " + std::to_string (m_offset);
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Status
+amqp::internal::cursor::
+validate (const char * bytes_, size_t size_) noexcept {
+    Validator validator;
+
+    const char * p = bytes_;
+    const char * end = bytes_ + size_;
+
+    while (p < end) {
+        if (!validator.node (p, end, 0)) {
+            return { validator.error(), static_cast<size_t> (validator.at() - bytes_) };
+        }
+    }
+
+    return { nullptr, 0 };
+}
+
+/******************************************************************************/
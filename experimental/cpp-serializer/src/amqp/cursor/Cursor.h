@@ -0,0 +1,401 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "Stack.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Type
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * The AMQP 1.0 type categories a node can have. These are numbered the
+     * same way qpid-proton numbers its pn_type_t so existing keys into the
+     * descriptor registry (22 being "any described type") carry over.
+     */
+    enum Type {
+        invalid_t    = -1,
+        null_t       =  1,
+        bool_t,
+        ubyte_t,
+        byte_t,
+        ushort_t,
+        short_t,
+        uint_t,
+        int_t,
+        char_t,
+        ulong_t,
+        long_t,
+        timestamp_t,
+        float_t,
+        double_t,
+        decimal32_t,
+        decimal64_t,
+        decimal128_t,
+        uuid_t,
+        binary_t,
+        string_t,
+        symbol_t,
+        described_t,
+        array_t,
+        list_t,
+        map_t
+    };
+
+    const char * typeName (Type);
+
+    std::ostream & operator << (std::ostream &, const Type &);
+
+    class Cursor;
+
+    std::ostream & operator << (std::ostream &, const Cursor &);
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Cursor
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * A forward only cursor over an AMQP 1.0 encoded buffer. Rather than
+     * decoding the whole blob into an intermediate tree (as pn_data_decode
+     * does) nodes are decoded in place, straight from their constructor
+     * bytes, as the cursor reaches them.
+     *
+     * Navigation mirrors the pn_data_t model so code written against that
+     * reads the same
+     *
+     *   next  - move to the next sibling, skipping the current node (and
+     *           any children) using its encoded size
+     *   enter - descend into the current compound node, the cursor is then
+     *           positioned *before* the first child
+     *   exit  - return to the parent, which becomes the current node again
+     *
+     * The cursor never owns the bytes it walks, they must outlive it.
+     */
+    class Cursor {
+        public :
+            friend std::ostream & operator << (std::ostream &, const Cursor &);
+
+        private :
+            /**
+             * A decoded node header. For array elements, which share a
+             * single constructor, [m_code] is the array's element
+             * constructor and [m_payload] points directly at the value
+             */
+            struct Node {
+                uint8_t      m_code;
+                const char * m_payload;
+                bool         m_element;
+            };
+
+            struct Frame {
+                Node         m_parent;
+                const char * m_first;
+                const char * m_end;
+                uint32_t     m_remaining;
+
+                /**
+                 * Only meaningful when walking an array, the constructor
+                 * every element shares and, for described arrays, if the
+                 * shared descriptor has yet to be visited
+                 */
+                uint8_t      m_elementCode;
+                bool         m_array;
+                bool         m_descriptorPending;
+            };
+
+            const char * m_begin;
+            const char * m_end;
+
+            /**
+             * Nothing sits at [m_current] when we have just entered a node
+             * and haven't yet moved onto its first child.
+             */
+            bool m_valid;
+            Node m_current;
+
+            Stack<Frame, 16> m_frames;
+
+            Node decode (const char *) const;
+            Node decodeChild (const char *, const Frame &) const;
+
+            const char * endOf (const Node &) const;
+            const char * endOfValue (const char *) const;
+
+            const char * require (const char *, size_t) const;
+
+        public :
+            Cursor (const char *, size_t);
+
+            Cursor (const Cursor &) = default;
+
+            bool next();
+            bool enter();
+            bool exit();
+
+            /**
+             * Step over the current node and the [n_] - 1 siblings after
+             * it without entering any of them. Compound values carry their
+             * encoded size so each is jumped in one go however much it
+             * contains. Returns false if there were fewer siblings left
+             * than asked to move past, as for [next]
+             */
+            bool skip (size_t n_ = 1);
+
+            Type type() const;
+
+            bool is_described() const;
+
+            /**
+             * The number of children of the current node if it is of
+             * the appropriate type, 0 otherwise.
+             */
+            size_t get_list() const;
+            size_t get_map() const;
+            size_t get_array() const;
+
+            bool     get_bool() const;
+            uint8_t  get_ubyte() const;
+            int8_t   get_byte() const;
+            uint16_t get_ushort() const;
+            int16_t  get_short() const;
+            uint32_t get_uint() const;
+            int32_t  get_int() const;
+            uint32_t get_char() const;
+            uint64_t get_ulong() const;
+            int64_t  get_long() const;
+            int64_t  get_timestamp() const;
+            float    get_float() const;
+            double   get_double() const;
+
+            /**
+             * Views straight into the underlying buffer, no copies.
+             */
+            std::string_view get_string() const;
+            std::string_view get_symbol() const;
+            std::string_view get_binary() const;
+
+            /**
+             * The raw 16 bytes of a uuid or decimal128
+             */
+            std::string_view get_fixed16() const;
+
+            /**
+             * The number of bytes of the buffer consumed by the current
+             * node, constructor included
+             */
+            size_t encodedSize() const;
+
+            /**
+             * The encoded bytes of the current node, constructor included.
+             * For array elements, which share their array's constructor,
+             * this is just the value.
+             */
+            std::string_view encoded() const;
+
+            /**
+             * How far into the buffer the current node's constructor sits
+             */
+            size_t offset() const;
+
+            size_t depth() const;
+
+            /**
+             * The current node's constructor byte, 0xff, which never is
+             * one, when there's no current node
+             */
+            uint8_t constructor() const { return m_valid ? m_current.m_code : 0xff; }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * Free standing helpers equivalent to those provided for pn_data_t by the
+ * old proton wrapper
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * Throws saying the current node isn't the [expected_] it should be,
+     * the diagnostic only being formatted once something's wrong
+     */
+    [[noreturn]] void mismatch (const Cursor &, Type expected_);
+
+    /**
+     * Throws unless the current node is a [type_]. Called on every node
+     * decoded so the check is inline and all the failure costs is left to
+     * [mismatch]
+     */
+    inline void is_type (const Cursor & data_, Type type_) {
+        if (data_.type() != type_) mismatch (data_, type_);
+    }
+
+    inline void is_list (const Cursor & data_) { is_type (data_, list_t); }
+    inline void is_ulong (const Cursor & data_) { is_type (data_, ulong_t); }
+    inline void is_symbol (const Cursor & data_) { is_type (data_, symbol_t); }
+    inline void is_described (const Cursor & data_) { is_type (data_, described_t); }
+
+    void is_string (const Cursor &, bool allowNull = false);
+
+    /**
+     * Moves past the current node should it be a null, saying whether it
+     * was. A nullable property that's unset is written as a null in place
+     * of its value, so every reader checks before reading, which costs a
+     * single compare of the constructor
+     */
+    inline bool skip_null (Cursor & data_) {
+        if (data_.constructor() != 0x40) return false;
+
+        data_.next();
+
+        return true;
+    }
+
+    /**
+     * What [validate] made of a buffer, [m_error] being null if it's well
+     * formed and otherwise a fixed description of the first thing wrong,
+     * found [m_offset] bytes in
+     */
+    struct Status {
+        const char * m_error;
+        size_t m_offset;
+
+        explicit operator bool() const { return m_error == nullptr; }
+
+        std::string message() const;
+    };
+
+    /**
+     * Check every node of the buffer is well formed, the constructors
+     * known, every size and element count fitting within what holds it
+     * and nothing nested too deeply to decode. Nothing is thrown nor
+     * allocated so a corrupt buffer costs no more than one that isn't,
+     * whilst one that passes can't throw for the cursor running off its
+     * end however it's then decoded, only for holding something the
+     * reader decoding it didn't expect
+     */
+    Status validate (const char * bytes_, size_t size_) noexcept;
+
+    template<typename T>
+    T get_symbol (const Cursor &);
+
+    template<>
+    std::string get_symbol<std::string> (const Cursor &);
+
+    template<>
+    std::string_view get_symbol<std::string_view> (const Cursor &);
+
+    bool get_boolean (const Cursor &);
+    std::string get_string (const Cursor &, bool allowNull = false);
+
+    /**
+     * Enter the current node and move onto its first child, exiting
+     * upon destruction
+     */
+    class auto_enter {
+        private :
+            Cursor & m_data;
+
+        public :
+            explicit auto_enter (Cursor &, bool next_ = false);
+            auto_enter (const auto_enter &) = delete;
+            ~auto_enter();
+    };
+
+    /**
+     * Move to the next node upon destruction
+     */
+    class auto_next {
+        private :
+            Cursor & m_data;
+
+        public :
+            explicit auto_next (Cursor &);
+            auto_next (const auto_next &) = delete;
+
+            explicit operator Cursor &() {
+                return m_data;
+            }
+
+            ~auto_next();
+    };
+
+    /**
+     * Enter a list, leaving the cursor positioned before the first
+     * element unless asked to move onto it.
+     */
+    class auto_list_enter {
+        private :
+            size_t   m_elements;
+            Cursor & m_data;
+
+        public :
+            explicit auto_list_enter (Cursor &, bool next_ = false);
+            auto_list_enter (const auto_list_enter &) = delete;
+            ~auto_list_enter();
+
+            size_t elements() const;
+    };
+
+    class auto_map_enter {
+        private :
+            size_t   m_elements;
+            Cursor & m_data;
+
+        public :
+            explicit auto_map_enter (Cursor &, bool next_ = false);
+            auto_map_enter (const auto_map_enter &) = delete;
+            ~auto_map_enter();
+
+            size_t elements() const;
+    };
+
+    /**
+     * Read the current node as a T and move the cursor onto the next
+     * node. Specialised in the CXX file.
+     */
+    template<typename T>
+    T readAndNext (Cursor &, bool tolerateDeviance_ = false);
+
+    template<> int8_t readAndNext<int8_t> (Cursor &, bool);
+    template<> int16_t readAndNext<int16_t> (Cursor &, bool);
+    template<> int32_t readAndNext<int32_t> (Cursor &, bool);
+    template<> int64_t readAndNext<int64_t> (Cursor &, bool);
+    template<> uint64_t readAndNext<uint64_t> (Cursor &, bool);
+    template<> bool readAndNext<bool> (Cursor &, bool);
+    template<> float readAndNext<float> (Cursor &, bool);
+    template<> double readAndNext<double> (Cursor &, bool);
+
+    /**
+     * An AMQP char, a UTF-32 code point
+     */
+    template<> char32_t readAndNext<char32_t> (Cursor &, bool);
+    template<> std::string readAndNext<std::string> (Cursor &, bool);
+
+    /**
+     * As for std::string but viewing the bytes in place rather than
+     * copying them out of the buffer
+     */
+    template<> std::string_view readAndNext<std::string_view> (Cursor &, bool);
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,137 @@
+#include "Hash.h"
+
+#include <cstring>
+#include <algorithm>
+
+/******************************************************************************/
+
+namespace {
+
+    constexpr uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t P3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+
+    uint64_t
+    rotl (uint64_t x_, unsigned r_) {
+        return (x_ << r_) | (x_ >> (64U - r_));
+    }
+
+    uint64_t
+    load (const char * p_) {
+        uint64_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return rtn;
+    }
+
+    uint64_t
+    mix (uint64_t lane_, uint64_t input_) {
+        return rotl (lane_ + input_ * P2, 31U) * P1;
+    }
+
+    uint64_t
+    avalanche (uint64_t h_) {
+        h_ ^= h_ >> 33U;
+        h_ *= P2;
+        h_ ^= h_ >> 29U;
+        h_ *= P3;
+        h_ ^= h_ >> 32U;
+        return h_;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Hasher
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+Hasher::Hasher (uint64_t seed_)
+    : m_lanes { seed_ + P1 + P2, seed_ - P1 }
+    , m_size (0)
+    , m_buffer { }
+    , m_buffered (0)
+{ }
+
+/******************************************************************************/
+
+void
+amqp::internal::cursor::
+Hasher::round (const char * p_) {
+    m_lanes[0] = mix (m_lanes[0], load (p_));
+    m_lanes[1] = mix (m_lanes[1], load (p_ + 8));
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Hasher &
+amqp::internal::cursor::
+Hasher::update (const char * bytes_, size_t size_) {
+    m_size += size_;
+
+    if (m_buffered > 0) {
+        auto take = std::min (size_, sizeof (m_buffer) - m_buffered);
+
+        std::memcpy (m_buffer + m_buffered, bytes_, take);
+        m_buffered += take;
+        bytes_ += take;
+        size_ -= take;
+
+        if (m_buffered < sizeof (m_buffer)) return *this;
+
+        round (m_buffer);
+        m_buffered = 0;
+    }
+
+    for ( ; size_ >= sizeof (m_buffer) ; bytes_ += sizeof (m_buffer), size_ -= sizeof (m_buffer)) {
+        round (bytes_);
+    }
+
+    std::memcpy (m_buffer, bytes_, size_);
+    m_buffered = size_;
+
+    return *this;
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Hasher &
+amqp::internal::cursor::
+Hasher::update (uint64_t value_) {
+    char bytes[sizeof (value_)];
+    std::memcpy (bytes, &value_, sizeof (value_));
+
+    return update (bytes, sizeof (bytes));
+}
+
+/******************************************************************************/
+
+/*
+ * The tail is zero padded into a final round, the length then telling
+ * apart tails that differ only by trailing zeros
+ */
+amqp::internal::cursor::Hash
+amqp::internal::cursor::
+Hasher::digest() const {
+    uint64_t lanes[2] = { m_lanes[0], m_lanes[1] };
+
+    if (m_buffered > 0) {
+        char tail[sizeof (m_buffer)] = { };
+        std::memcpy (tail, m_buffer, m_buffered);
+
+        lanes[0] = mix (lanes[0], load (tail));
+        lanes[1] = mix (lanes[1], load (tail + 8));
+    }
+
+    lanes[0] ^= m_size * P4;
+    lanes[1] ^= rotl (m_size, 32U) * P3;
+
+    return {
+        avalanche (lanes[0] + rotl (lanes[1], 27U) * P1),
+        avalanche (lanes[1] ^ rotl (lanes[0], 33U) * P2)
+    };
+}
+
+/******************************************************************************/
@@ -0,0 +1,65 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Hasher
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    struct Hash {
+        uint64_t m_low;
+        uint64_t m_high;
+
+        bool operator== (const Hash & rhs_) const {
+            return m_low == rhs_.m_low && m_high == rhs_.m_high;
+        }
+
+        bool operator!= (const Hash & rhs_) const { return !(*this == rhs_); }
+    };
+
+    /**
+     * A fast, non cryptographic, 128 bit hash fed a run of bytes at a time.
+     * Two lanes in the manner of XXH64, sixteen bytes being consumed per
+     * round, so what's hashed doesn't depend on how it was split between
+     * calls to [update]. Words are read in the machine's order, so hashes
+     * are only comparable between machines of the same endianness
+     */
+    class Hasher {
+        private :
+            uint64_t m_lanes[2];
+            uint64_t m_size;
+
+            char m_buffer[16];
+            size_t m_buffered;
+
+            void round (const char *);
+
+        public :
+            explicit Hasher (uint64_t seed_ = 0);
+
+            Hasher & update (const char *, size_t);
+
+            Hasher & update (std::string_view bytes_) {
+                return update (bytes_.data(), bytes_.size());
+            }
+
+            Hasher & update (uint64_t);
+
+            Hash digest() const;
+    };
+
+    inline Hash hash (std::string_view bytes_) {
+        return Hasher().update (bytes_).digest();
+    }
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,133 @@
+#include "Limits.h"
+
+#include <sstream>
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Limits
+ *
+ ******************************************************************************/
+
+thread_local amqp::internal::cursor::Limits::Scope *
+amqp::internal::cursor::
+Limits::m_current = nullptr;
+
+/******************************************************************************/
+
+namespace {
+
+    using amqp::internal::cursor::Limits;
+
+    const char *
+    name (Limits::Kind kind_) {
+        switch (kind_) {
+            case Limits::depth_t    : return "depth";
+            case Limits::elements_t : return "elements";
+            case Limits::strings_t  : return "strings";
+            default                 : return "arena";
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+/*
+ * The message is all that's allocated, so a blob that hits a limit costs
+ * next to nothing more than one that decodes
+ */
+amqp::internal::cursor::
+Limits::Exceeded::Exceeded (Kind kind_)
+    : std::runtime_error (std::string ("Decode exceeded its ") + name (kind_) + " limit")
+    , m_kind (kind_)
+{ }
+
+/******************************************************************************/
+
+void
+amqp::internal::cursor::
+Limits::exceeded (Kind kind_) {
+    throw Exceeded (kind_);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Limits::bytes (std::string value_) {
+    size_t scale { 1 };
+
+    if (!value_.empty()) {
+        switch (value_.back()) {
+            case 'k' : case 'K' : scale = size_t { 1 } << 10U; break;
+            case 'm' : case 'M' : scale = size_t { 1 } << 20U; break;
+            case 'g' : case 'G' : scale = size_t { 1 } << 30U; break;
+            default : break;
+        }
+    }
+
+    if (scale != 1) value_.pop_back();
+
+    size_t used { 0 };
+    unsigned long long n { 0 };
+
+    try {
+        n = std::stoull (value_, &used);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+
+    if (used == 0 || used != value_.size()) {
+        throw std::runtime_error ("Bad size \"" + value_ + "\"");
+    }
+
+    return static_cast<size_t> (n) * scale;
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Limits
+amqp::internal::cursor::
+Limits::parse (const std::string & spec_) {
+    Limits rtn;
+
+    std::stringstream ss { spec_ };
+
+    for (std::string item ; std::getline (ss, item, ',') ; ) {
+        auto eq = item.find ('=');
+
+        if (eq == std::string::npos || eq + 1 == item.size()) {
+            throw std::runtime_error ("Expected kind=n in limits, not \"" + item + "\"");
+        }
+
+        const auto kind = item.substr (0, eq);
+
+        size_t n;
+
+        try {
+            n = bytes (item.substr (eq + 1));
+        } catch (const std::runtime_error &) {
+            throw std::runtime_error ("Bad limit \"" + item + "\"");
+        }
+
+        Kind k;
+
+        if (kind == "depth") {
+            k = depth_t;
+        } else if (kind == "elements") {
+            k = elements_t;
+        } else if (kind == "strings") {
+            k = strings_t;
+        } else if (kind == "arena") {
+            k = arena_t;
+        } else {
+            throw std::runtime_error ("Unknown limit \"" + kind + "\"");
+        }
+
+        rtn.set (k, n);
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
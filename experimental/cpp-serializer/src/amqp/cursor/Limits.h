@@ -0,0 +1,143 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/******************************************************************************
+ *
+ * class amqp::internal::cursor::Limits
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * What a single decode may use before it's abandoned, so one malformed
+     * or hostile blob can't take the process down with it. Whilst a [Scope]
+     * is active on a thread everything decoded on it is counted against
+     *
+     *   depth    - how deeply the cursor may nest, counted in AMQP nodes
+     *              from the blob's outermost, a composite being two, its
+     *              described node and the list of its fields
+     *   elements - the elements of every list, array and map entered,
+     *              a map's keys and values counted apart
+     *   strings  - the bytes of every string and binary read, though not
+     *              symbols as they're mostly the descriptors naming types
+     *   arena    - the bytes handed out by the thread's [reader::Arena]
+     *
+     * Going over any of them throws an [Exceeded] naming which. Every
+     * limit starts out unbounded.
+     */
+    class Limits {
+        public :
+            enum Kind { depth_t, elements_t, strings_t, arena_t };
+
+            class Exceeded : public std::runtime_error {
+                private :
+                    Kind m_kind;
+
+                public :
+                    explicit Exceeded (Kind);
+
+                    Kind kind() const { return m_kind; }
+            };
+
+            /**
+             * Counts what's been used by the decode it's around against
+             * the limits it was given
+             */
+            class Scope {
+                private :
+                    const Limits & m_limits;
+                    Scope * m_previous;
+
+                    size_t m_elements;
+                    size_t m_strings;
+
+                    friend class Limits;
+
+                public :
+                    explicit Scope (const Limits & limits_)
+                        : m_limits (limits_)
+                        , m_previous (m_current)
+                        , m_elements (0)
+                        , m_strings (0)
+                    {
+                        m_current = this;
+                    }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() {
+                        m_current = m_previous;
+                    }
+            };
+
+        private :
+            static thread_local Scope * m_current;
+
+            size_t m_limits[4];
+
+            [[noreturn]] static void exceeded (Kind);
+
+        public :
+            Limits() : m_limits { SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX } { }
+
+            /**
+             * From a comma separated list of kind=n, such as
+             * "depth=64,strings=16m", n taking an optional k, m or g
+             */
+            static Limits parse (const std::string &);
+
+            /**
+             * A single n, with the same optional k, m or g, throwing if
+             * it's anything else
+             */
+            static size_t bytes (std::string);
+
+            Limits & set (Kind kind_, size_t limit_) {
+                m_limits[kind_] = limit_;
+                return *this;
+            }
+
+            size_t get (Kind kind_) const { return m_limits[kind_]; }
+
+            /**
+             * Called by the cursor entering to [depth_], entering a
+             * collection of [elements_] and reading [bytes_] of text
+             */
+            static void depth (size_t depth_) {
+                if (m_current && depth_ > m_current->m_limits.m_limits[depth_t]) exceeded (depth_t);
+            }
+
+            static void elements (size_t elements_) {
+                if (m_current && (m_current->m_elements += elements_)
+                        > m_current->m_limits.m_limits[elements_t])
+                {
+                    exceeded (elements_t);
+                }
+            }
+
+            static void strings (size_t bytes_) {
+                if (m_current && (m_current->m_strings += bytes_)
+                        > m_current->m_limits.m_limits[strings_t])
+                {
+                    exceeded (strings_t);
+                }
+            }
+
+            /**
+             * Called by the arena about to have handed out [bytes_]
+             */
+            static void arena (size_t bytes_) {
+                if (m_current && bytes_ > m_current->m_limits.m_limits[arena_t]) exceeded (arena_t);
+            }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,64 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <array>
+#include <vector>
+#include <cstddef>
+
+/******************************************************************************
+ *
+ * class amqp::internal::cursor::Stack
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * A stack whose first [N] entries live inline, only those nested
+     * deeper than that spilling onto the heap, so walking a blob of the
+     * usual depth allocates nothing at all, not even when the walker's
+     * copied.
+     */
+    template<typename T, size_t N>
+    class Stack {
+        private :
+            std::array<T, N> m_inline;
+            std::vector<T> m_spilt;
+            size_t m_size { 0 };
+
+        public :
+            void push_back (const T & value_) {
+                if (m_size < N) {
+                    m_inline[m_size] = value_;
+                } else {
+                    m_spilt.push_back (value_);
+                }
+
+                ++m_size;
+            }
+
+            void pop_back() {
+                if (--m_size >= N) m_spilt.pop_back();
+            }
+
+            T & back() {
+                return m_size > N ? m_spilt.back() : m_inline[m_size - 1];
+            }
+
+            const T & back() const {
+                return m_size > N ? m_spilt.back() : m_inline[m_size - 1];
+            }
+
+            size_t size() const { return m_size; }
+            bool empty() const { return m_size == 0; }
+
+            void clear() {
+                m_spilt.clear();
+                m_size = 0;
+            }
+    };
+
+}
+
+/******************************************************************************/
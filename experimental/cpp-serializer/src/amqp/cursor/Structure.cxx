@@ -0,0 +1,320 @@
+#include "Structure.h"
+
+#include <limits>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "kernels/Kernels.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using Entry = amqp::internal::cursor::Structure::Entry;
+
+    inline uint8_t
+    u8 (const char * p_) {
+        return static_cast<uint8_t>(*p_);
+    }
+
+    inline uint32_t
+    be32 (const char * p_) {
+        uint32_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return __builtin_bswap32 (rtn);
+    }
+
+    [[noreturn]] void
+    truncated() {
+        throw std::runtime_error ("AMQP stream truncated");
+    }
+
+    /**
+     * The width of what follows a fixed width constructor, the category
+     * being its top nibble, or -1 for any other
+     */
+    inline int
+    fixed (uint8_t code_) {
+        switch (code_ >> 4U) {
+            case 0x4 : return code_ == 0x45 ? -1 : 0;
+            case 0x5 : return 1;
+            case 0x6 : return 2;
+            case 0x7 : return 4;
+            case 0x8 : return 8;
+            case 0x9 : return 16;
+            default  : return -1;
+        }
+    }
+
+    /**
+     * A list, map or described value whose elements are still being
+     * scanned
+     */
+    struct Frame {
+        uint32_t m_entry;
+
+        /**
+         * Where its elements must end by, exactly for a list or map
+         */
+        const char * m_end;
+
+        uint32_t m_left;
+
+        bool m_list;
+        bool m_sized;
+    };
+
+    class Scanner {
+        private :
+            const char * const m_base;
+            std::vector<Entry> & m_entries;
+            std::vector<Frame> m_frames;
+
+            const amqp::internal::kernels::Table & m_kernels;
+
+            const char * require (const char * p_, size_t n_, const char * end_) const {
+                if (static_cast<size_t>(end_ - p_) < n_) truncated();
+                return p_;
+            }
+
+            uint32_t record (const char * p_, size_t size_, uint32_t count_, uint8_t code_) {
+                auto index = static_cast<uint32_t>(m_entries.size());
+
+                m_entries.push_back ({
+                    static_cast<uint32_t>(p_ - m_base), static_cast<uint32_t>(size_),
+                    index + 1, count_, code_ });
+
+                return index;
+            }
+
+            const char * sized (const char *, const char *, size_t width_, bool list_);
+            const char * value (const char *, const char *);
+            const char * run (const char *, Frame &);
+
+        public :
+            Scanner (const char * base_, std::vector<Entry> & entries_)
+                : m_base (base_)
+                , m_entries (entries_)
+                , m_kernels (amqp::internal::kernels::Kernels::table())
+            { }
+
+            const char * scan (const char * p_, const char * end_);
+    };
+
+    /**
+     * A list or map whose size and count are [width_] bytes each
+     */
+    const char *
+    Scanner::sized (const char * p_, const char * end_, size_t width_, bool list_) {
+        require (p_, 1 + 2 * width_, end_);
+
+        size_t size = width_ == 1 ? u8 (p_ + 1) : be32 (p_ + 1);
+        uint32_t count = width_ == 1 ? u8 (p_ + 1 + width_) : be32 (p_ + 1 + width_);
+
+        if (size < width_ || size > static_cast<size_t>(end_ - p_) - 1 - width_) truncated();
+
+        // every element is at least its constructor
+        if (count > size - width_) {
+            throw std::runtime_error ("AMQP stream corrupt, more elements than bytes");
+        }
+
+        auto entry = record (p_, 1 + width_ + size, count, u8 (p_));
+
+        if (count > 0) {
+            m_frames.push_back ({ entry, p_ + 1 + width_ + size, count, list_, true });
+        }
+
+        return p_ + 1 + 2 * width_;
+    }
+
+    /**
+     * Record the value at [p_], returning where its first element is
+     * should it be a list, map or described value, and otherwise where
+     * the one after it is
+     */
+    const char *
+    Scanner::value (const char * p_, const char * end_) {
+        auto code = u8 (require (p_, 1, end_));
+
+        auto width = fixed (code);
+
+        if (width >= 0) {
+            require (p_, 1 + static_cast<size_t>(width), end_);
+            record (p_, 1 + static_cast<size_t>(width), 0, code);
+
+            return p_ + 1 + width;
+        }
+
+        switch (code) {
+            case 0x00 : {
+                // sized once both its descriptor and value have been
+                auto entry = record (p_, 0, 2, code);
+                m_frames.push_back ({ entry, end_, 2, false, false });
+                return p_ + 1;
+            }
+            case 0x45 :
+                record (p_, 1, 0, code);
+                return p_ + 1;
+            case 0xa0 : case 0xa1 : case 0xa3 : {
+                auto size = 2 + size_t { u8 (require (p_, 2, end_) + 1) };
+                require (p_, size, end_);
+                record (p_, size, 0, code);
+                return p_ + size;
+            }
+            case 0xb0 : case 0xb1 : case 0xb3 : {
+                auto size = 5 + size_t { be32 (require (p_, 5, end_) + 1) };
+                require (p_, size, end_);
+                record (p_, size, 0, code);
+                return p_ + size;
+            }
+            case 0xc0 : return sized (p_, end_, 1, true);
+            case 0xc1 : return sized (p_, end_, 1, false);
+            case 0xd0 : return sized (p_, end_, 4, true);
+            case 0xd1 : return sized (p_, end_, 4, false);
+            case 0xe0 : {
+                require (p_, 3, end_);
+                auto size = 2 + size_t { u8 (p_ + 1) };
+                require (p_, size, end_);
+                record (p_, size, u8 (p_ + 2), code);
+                return p_ + size;
+            }
+            case 0xf0 : {
+                require (p_, 9, end_);
+                auto size = 5 + size_t { be32 (p_ + 1) };
+                require (p_, size, end_);
+                record (p_, size, be32 (p_ + 5), code);
+                return p_ + size;
+            }
+            default : {
+                std::stringstream ss;
+                ss << "Invalid AMQP constructor 0x" << std::hex
+                   << static_cast<unsigned int>(code);
+                throw std::runtime_error (ss.str());
+            }
+        }
+    }
+
+    /**
+     * Record the run of elements of [frame_] that share the fixed width
+     * constructor of the one at [p_], at least that one
+     */
+    const char *
+    Scanner::run (const char * p_, Frame & frame_) {
+        auto code = u8 (p_);
+        auto stride = 1 + static_cast<size_t>(fixed (code));
+        auto bytes = static_cast<size_t>(frame_.m_end - p_);
+
+        if (bytes < stride) truncated();
+
+        size_t n { 1 };
+
+        // most elements of a composite's list of fields differ from the next
+        if (frame_.m_left > 1 && bytes > stride && u8 (p_ + stride) == code) {
+            auto most = frame_.m_left * stride <= bytes ? frame_.m_left : bytes / stride;
+
+            n = m_kernels.m_run (p_, most, stride, code);
+        }
+
+        for (size_t i { 0 } ; i < n ; ++i) {
+            record (p_ + i * stride, stride, 0, code);
+        }
+
+        frame_.m_left -= static_cast<uint32_t>(n);
+
+        return p_ + n * stride;
+    }
+
+    const char *
+    Scanner::scan (const char * p_, const char * end_) {
+        p_ = value (p_, end_);
+
+        while (!m_frames.empty()) {
+            auto & frame = m_frames.back();
+
+            if (frame.m_left == 0) {
+                auto & entry = m_entries[frame.m_entry];
+
+                if (frame.m_sized) {
+                    if (p_ != frame.m_end) {
+                        throw std::runtime_error ("AMQP element overruns its container");
+                    }
+                } else {
+                    entry.m_size = static_cast<uint32_t>(p_ - m_base) - entry.m_offset;
+                }
+
+                entry.m_end = static_cast<uint32_t>(m_entries.size());
+                m_frames.pop_back();
+
+                continue;
+            }
+
+            if (frame.m_list && fixed (u8 (require (p_, 1, frame.m_end))) >= 0) {
+                p_ = run (p_, frame);
+            } else {
+                --frame.m_left;
+
+                // pushing may move [frame]
+                p_ = value (p_, frame.m_end);
+            }
+        }
+
+        return p_;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::cursor::Structure
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::
+Structure::Structure (std::string_view encoded_) : m_encoded (encoded_) {
+    if (encoded_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error ("Blob too large to index");
+    }
+
+    // blobs mostly hold a value every ten bytes or so
+    m_entries.reserve (encoded_.size() / 8);
+
+    Scanner scanner (encoded_.data(), m_entries);
+    auto end = scanner.scan (encoded_.data(), encoded_.data() + encoded_.size());
+
+    m_encoded = m_encoded.substr (0, static_cast<size_t>(end - encoded_.data()));
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::cursor::
+Structure::child (size_t i_, size_t position_) const {
+    const auto & entry = m_entries[i_];
+
+    if (entry.m_code != 0x00 && !compound (entry.m_code)) return m_entries.size();
+
+    size_t rtn { i_ + 1 };
+
+    for (; rtn < entry.m_end && position_ > 0 ; --position_) rtn = m_entries[rtn].m_end;
+
+    return rtn < entry.m_end ? rtn : m_entries.size();
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::cursor::
+Structure::compound (uint8_t code_) {
+    switch (code_) {
+        case 0x45 :
+        case 0xc0 : case 0xc1 :
+        case 0xd0 : case 0xd1 :
+            return true;
+        default :
+            return false;
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,109 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::internal::cursor::Structure
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    /**
+     * Where every value in an encoded blob starts, found by a single pass
+     * over its bytes that needs neither a schema nor a reader, so whatever
+     * wants to jump straight to a value, a projection skipping most of a
+     * blob or a decode splitting one between threads, can find it without
+     * decoding anything before it.
+     *
+     * Every list, map, array and described value is recorded, along with
+     * each element of a list or map, a map's keys and values alternately,
+     * and both the descriptor and value of a described one. An array's
+     * elements share its constructor and aren't. Entries are in the order
+     * their values are encoded, each followed by those within it.
+     *
+     * Compounds are stepped over by their size prefixes. A run of list
+     * elements sharing a fixed width constructor, a list of ints say, is
+     * checked a vector at a time by whichever [kernels::Kernels] suit the
+     * machine rather than element by element.
+     *
+     * Throws should the bytes not be a well formed encoding, though what
+     * lies within a string, binary or array isn't looked at.
+     */
+    class Structure {
+        public :
+            /**
+             * AMQP's sizes are 32 bits so nothing's bigger
+             */
+            struct Entry {
+                /**
+                 * Of the constructor, from the start of what was scanned
+                 */
+                uint32_t m_offset;
+
+                /**
+                 * The whole encoding, constructor included
+                 */
+                uint32_t m_size;
+
+                /**
+                 * The index just past the last entry within this one,
+                 * the next after it should it have none
+                 */
+                uint32_t m_end;
+
+                /**
+                 * The elements of a list, map or array, a map's keys
+                 * and values counted apart, and two for a described value
+                 */
+                uint32_t m_count;
+
+                /**
+                 * 0x00 for a described value
+                 */
+                uint8_t m_code;
+            };
+
+        private :
+            std::string_view m_encoded;
+
+            std::vector<Entry> m_entries;
+
+        public :
+            /**
+             * Index the value encoded in [encoded_], as returned by
+             * [Cursor::encoded]. Anything after that one value is ignored
+             */
+            explicit Structure (std::string_view encoded_);
+
+            size_t size() const { return m_entries.size(); }
+
+            const Entry & operator[] (size_t i_) const { return m_entries[i_]; }
+
+            const std::vector<Entry> & entries() const { return m_entries; }
+
+            std::string_view encoded (const Entry & entry_) const {
+                return m_encoded.substr (entry_.m_offset, entry_.m_size);
+            }
+
+            /**
+             * The index of the entry at [position_] within entry [i_],
+             * [size] should there be no such entry
+             */
+            size_t child (size_t i_, size_t position_) const;
+
+            /**
+             * Whether the constructor [code_] is of a list or map
+             */
+            static bool compound (uint8_t code_);
+    };
+
+}
+
+/******************************************************************************/
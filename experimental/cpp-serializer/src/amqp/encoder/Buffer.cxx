@@ -0,0 +1,127 @@
+#include "Buffer.h"
+
+#include <algorithm>
+
+/******************************************************************************
+ *
+ * amqp::internal::encoder::StringBuffer
+ *
+ ******************************************************************************/
+
+amqp::internal::encoder::
+StringBuffer::StringBuffer (std::string & out_, size_t hint_)
+    : m_out (out_)
+    , m_size (out_.size())
+{
+    m_out.resize (m_size + hint_);
+}
+
+/******************************************************************************/
+
+char *
+amqp::internal::encoder::
+StringBuffer::reserve (size_t n_) {
+    if (m_out.size() < m_size + n_) {
+        m_out.resize (std::max (m_size + n_, 2 * m_out.size()));
+    }
+
+    return &m_out[m_size];
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+StringBuffer::flush() {
+    m_out.resize (m_size);
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::encoder::ChainBuffer
+ *
+ ******************************************************************************/
+
+amqp::internal::encoder::
+ChainBuffer::ChainBuffer (size_t chunk_)
+    : m_chunk (chunk_ ? chunk_ : DEFAULT_CHUNK)
+    , m_size (0)
+{
+    add (m_chunk);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+ChainBuffer::add (size_t capacity_) {
+    m_chunks.push_back (Chunk {
+        std::make_unique<char[]> (capacity_), capacity_, 0, m_size });
+}
+
+/******************************************************************************/
+
+char *
+amqp::internal::encoder::
+ChainBuffer::reserve (size_t n_) {
+    auto * chunk = &m_chunks.back();
+
+    if (chunk->m_capacity - chunk->m_size < n_) {
+        add (std::max (m_chunk, n_));
+        chunk = &m_chunks.back();
+    }
+
+    return chunk->m_bytes.get() + chunk->m_size;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+ChainBuffer::commit (size_t n_) {
+    m_chunks.back().m_size += n_;
+    m_size += n_;
+}
+
+/******************************************************************************/
+
+char *
+amqp::internal::encoder::
+ChainBuffer::at (size_t offset_) {
+    auto chunk = std::upper_bound (
+            m_chunks.begin(), m_chunks.end(), offset_,
+            [](size_t offset_, const Chunk & chunk_) {
+                return offset_ < chunk_.m_offset;
+            });
+
+    --chunk;
+
+    return chunk->m_bytes.get() + (offset_ - chunk->m_offset);
+}
+
+/******************************************************************************/
+
+std::vector<iovec>
+amqp::internal::encoder::
+ChainBuffer::iovecs() const {
+    std::vector<iovec> rtn;
+    rtn.reserve (m_chunks.size());
+
+    for (const auto & chunk : m_chunks) {
+        if (chunk.m_size) rtn.push_back (iovec { chunk.m_bytes.get(), chunk.m_size });
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+ChainBuffer::clear() {
+    m_chunks.resize (1);
+    m_chunks.back().m_size = 0;
+    m_size = 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,158 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include <sys/uio.h>
+
+/******************************************************************************
+ *
+ * class amqp::internal::encoder::Buffer
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    /**
+     * Where an [Encoder] writes its bytes. Space is reserved and then
+     * committed once written so a value is only ever bounds checked once,
+     * however many bytes it takes, and the [Encoder] can come back to a
+     * list's header once it knows how big the list turned out to be.
+     *
+     * Offsets count from the start of the buffer, including anything that
+     * was in it before the encoder was handed it
+     */
+    class Buffer {
+        public :
+            virtual ~Buffer() = default;
+
+            /**
+             * At least [n_] contiguous bytes at the end of the buffer,
+             * valid until the next call to reserve
+             */
+            virtual char * reserve (size_t n_) = 0;
+
+            /**
+             * The first [n_] bytes of the last reservation having been
+             * written
+             */
+            virtual void commit (size_t n_) = 0;
+
+            virtual size_t size() const = 0;
+
+            /**
+             * Bytes already committed, for patching over. Anything written
+             * by a single reservation is contiguous
+             */
+            virtual char * at (size_t offset_) = 0;
+
+            /**
+             * Called once an encoding is complete
+             */
+            virtual void flush() { }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::encoder::StringBuffer
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    /**
+     * Appends to a caller's string. It grows geometrically whilst being
+     * written and is trimmed back to what was actually written on [flush],
+     * so a string reused from blob to blob soon stops being reallocated
+     */
+    class StringBuffer : public Buffer {
+        private :
+            std::string & m_out;
+            size_t m_size;
+
+        public :
+            /**
+             * [hint_] bytes are made room for up front
+             */
+            explicit StringBuffer (std::string & out_, size_t hint_ = 0);
+
+            char * reserve (size_t) override;
+
+            void commit (size_t n_) override { m_size += n_; }
+
+            size_t size() const override { return m_size; }
+
+            char * at (size_t offset_) override { return &m_out[offset_]; }
+
+            void flush() override;
+    };
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::encoder::ChainBuffer
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    /**
+     * A chain of fixed size chunks which, once written, is handed to
+     * writev as is. Nothing written is ever copied again, growing just
+     * adds another chunk, and a value too large for a chunk of its own
+     * gets one as large as it needs
+     */
+    class ChainBuffer : public Buffer {
+        private :
+            struct Chunk {
+                std::unique_ptr<char[]> m_bytes;
+                size_t m_capacity;
+                size_t m_size;
+
+                /**
+                 * Of the chunk's first byte in the buffer as a whole
+                 */
+                size_t m_offset;
+            };
+
+            std::vector<Chunk> m_chunks;
+            size_t m_chunk;
+            size_t m_size;
+
+            void add (size_t capacity_);
+
+        public :
+            static constexpr size_t DEFAULT_CHUNK = 64 * 1024;
+
+            explicit ChainBuffer (size_t chunk_ = DEFAULT_CHUNK);
+
+            char * reserve (size_t) override;
+            void commit (size_t) override;
+
+            size_t size() const override { return m_size; }
+
+            char * at (size_t) override;
+
+            /**
+             * The written bytes of every chunk, in order, valid until the
+             * buffer is next written to
+             */
+            std::vector<iovec> iovecs() const;
+
+            /**
+             * Forget everything written, keeping the first chunk
+             */
+            void clear();
+    };
+
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,561 @@
+#include "Encoder.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "kernels/Kernels.h"
+
+/******************************************************************************/
+
+namespace {
+
+    char *
+    be16 (char * p_, uint16_t v_) {
+        *p_++ = static_cast<char> (v_ >> 8U);
+        *p_++ = static_cast<char> (v_);
+        return p_;
+    }
+
+    char *
+    be32 (char * p_, uint32_t v_) {
+        p_ = be16 (p_, static_cast<uint16_t> (v_ >> 16U));
+        return be16 (p_, static_cast<uint16_t> (v_));
+    }
+
+    char *
+    be64 (char * p_, uint64_t v_) {
+        p_ = be32 (p_, static_cast<uint32_t> (v_ >> 32U));
+        return be32 (p_, static_cast<uint32_t> (v_));
+    }
+
+    template<typename T, typename U>
+    U
+    bits (T v_) {
+        static_assert (sizeof (T) == sizeof (U));
+
+        U rtn;
+        std::memcpy (&rtn, &v_, sizeof (rtn));
+        return rtn;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::encoder::Encoder
+ *
+ ******************************************************************************/
+
+amqp::internal::encoder::
+Encoder::Encoder (Buffer & buffer_)
+    : m_buffer (buffer_)
+    , m_described (false)
+{
+}
+
+/******************************************************************************/
+
+/**
+ * Count a value against whatever it's being written into
+ */
+void
+amqp::internal::encoder::
+Encoder::value() {
+    if (m_described) {
+        m_described = false;
+    } else if (!m_open.empty()) {
+        ++m_open.back().m_count;
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::put (char constructor_) {
+    *m_buffer.reserve (1) = constructor_;
+    m_buffer.commit (1);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::put (char constructor_, uint8_t v_) {
+    auto * p = m_buffer.reserve (2);
+    p[0] = constructor_;
+    p[1] = static_cast<char> (v_);
+    m_buffer.commit (2);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::put (char constructor_, uint16_t v_) {
+    auto * p = m_buffer.reserve (3);
+    *p = constructor_;
+    be16 (p + 1, v_);
+    m_buffer.commit (3);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::put (char constructor_, uint32_t v_) {
+    auto * p = m_buffer.reserve (5);
+    *p = constructor_;
+    be32 (p + 1, v_);
+    m_buffer.commit (5);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::put (char constructor_, uint64_t v_) {
+    auto * p = m_buffer.reserve (9);
+    *p = constructor_;
+    be64 (p + 1, v_);
+    m_buffer.commit (9);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::variable (char small_, std::string_view bytes_) {
+    if (bytes_.size() > UINT32_MAX) {
+        throw std::runtime_error ("Too large to encode as a single value");
+    }
+
+    char * p;
+    size_t header;
+
+    if (bytes_.size() < 256) {
+        header = 2;
+        p = m_buffer.reserve (header + bytes_.size());
+        p[0] = small_;
+        p[1] = static_cast<char> (bytes_.size());
+    } else {
+        header = 5;
+        p = m_buffer.reserve (header + bytes_.size());
+        p[0] = static_cast<char> (small_ + 0x10);
+        be32 (p + 1, static_cast<uint32_t> (bytes_.size()));
+    }
+
+    if (!bytes_.empty()) std::memcpy (p + header, bytes_.data(), bytes_.size());
+
+    m_buffer.commit (header + bytes_.size());
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::begin (char constructor_) {
+    value();
+
+    // the size and count are filled in on closing
+    auto * p = m_buffer.reserve (9);
+    *p = constructor_;
+    m_buffer.commit (9);
+
+    m_open.push_back (Open { m_buffer.size() - 8, 0 });
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::end() {
+    if (m_open.empty()) {
+        throw std::runtime_error ("Closing a list or map that was never opened");
+    }
+
+    if (m_described) {
+        throw std::runtime_error ("A descriptor with nothing to describe");
+    }
+
+    auto open = m_open.back();
+    m_open.pop_back();
+
+    auto size = m_buffer.size() - open.m_offset - 4;
+
+    if (size > UINT32_MAX) {
+        throw std::runtime_error ("Too large to encode as a single value");
+    }
+
+    auto * p = m_buffer.at (open.m_offset);
+    be32 (be32 (p, static_cast<uint32_t> (size)), open.m_count);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::null() {
+    value();
+    put ('\x40');
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::boolean (bool v_) {
+    value();
+    put (v_ ? '\x41' : '\x42');
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::uint8 (uint8_t v_) {
+    value();
+    put ('\x50', v_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::int8 (int8_t v_) {
+    value();
+    put ('\x51', static_cast<uint8_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::uint16 (uint16_t v_) {
+    value();
+    put ('\x60', v_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::int16 (int16_t v_) {
+    value();
+    put ('\x61', static_cast<uint16_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::uint32 (uint32_t v_) {
+    value();
+
+    if (v_ == 0) {
+        put ('\x43');
+    } else if (v_ < 256) {
+        put ('\x52', static_cast<uint8_t> (v_));
+    } else {
+        put ('\x70', v_);
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::int32 (int32_t v_) {
+    value();
+
+    if (v_ >= INT8_MIN && v_ <= INT8_MAX) {
+        put ('\x54', static_cast<uint8_t> (v_));
+    } else {
+        put ('\x71', static_cast<uint32_t> (v_));
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::uint64 (uint64_t v_) {
+    value();
+
+    if (v_ == 0) {
+        put ('\x44');
+    } else if (v_ < 256) {
+        put ('\x53', static_cast<uint8_t> (v_));
+    } else {
+        put ('\x80', v_);
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::int64 (int64_t v_) {
+    value();
+
+    if (v_ >= INT8_MIN && v_ <= INT8_MAX) {
+        put ('\x55', static_cast<uint8_t> (v_));
+    } else {
+        put ('\x81', static_cast<uint64_t> (v_));
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::float32 (float v_) {
+    value();
+    put ('\x72', bits<float, uint32_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::float64 (double v_) {
+    value();
+    put ('\x82', bits<double, uint64_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::character (char32_t v_) {
+    value();
+    put ('\x73', static_cast<uint32_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::timestamp (int64_t v_) {
+    value();
+    put ('\x83', static_cast<uint64_t> (v_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::uuid (const char * bytes_) {
+    value();
+
+    auto * p = m_buffer.reserve (17);
+    *p = '\x98';
+    std::memcpy (p + 1, bytes_, 16);
+    m_buffer.commit (17);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::decimal128 (const char * bytes_) {
+    value();
+
+    auto * p = m_buffer.reserve (17);
+    *p = '\x94';
+    std::memcpy (p + 1, bytes_, 16);
+    m_buffer.commit (17);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::binary (std::string_view v_) {
+    value();
+    variable ('\xa0', v_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::string (std::string_view v_) {
+    value();
+    variable ('\xa1', v_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::symbol (std::string_view v_) {
+    value();
+    variable ('\xa3', v_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::described (uint64_t descriptor_) {
+    value();
+
+    auto * p = m_buffer.reserve (10);
+    p[0] = '\0';
+    p[1] = '\x80';
+    be64 (p + 2, descriptor_);
+    m_buffer.commit (10);
+
+    m_described = true;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::described (std::string_view descriptor_) {
+    value();
+    put ('\0');
+    variable ('\xa3', descriptor_);
+
+    m_described = true;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::beginList() {
+    begin ('\xd0');
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::endList() {
+    end();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::emptyList() {
+    value();
+    put ('\x45');
+}
+
+/******************************************************************************/
+
+/**
+ * With a one byte size and count where both fit, else four of each
+ */
+void
+amqp::internal::encoder::
+Encoder::array (
+    char constructor_,
+    size_t width_,
+    const void * values_,
+    size_t n_,
+    void (*reverse_) (const char *, size_t, void *)
+) {
+    value();
+
+    if (n_ > (UINT32_MAX - 5) / width_) {
+        throw std::runtime_error ("Too large to encode as a single value");
+    }
+
+    auto bytes = n_ * width_;
+    bool small = bytes + 2 < 256;
+    auto header = small ? 4 : 10;
+
+    auto * p = m_buffer.reserve (header + bytes);
+
+    if (small) {
+        p[0] = '\xe0';
+        p[1] = static_cast<char> (bytes + 2);
+        p[2] = static_cast<char> (n_);
+    } else {
+        p[0] = '\xf0';
+        be32 (be32 (p + 1, static_cast<uint32_t> (bytes + 5)), static_cast<uint32_t> (n_));
+    }
+
+    p[header - 1] = constructor_;
+
+    if (n_) reverse_ (static_cast<const char *> (values_), n_, p + header);
+
+    m_buffer.commit (header + bytes);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::ints (const int32_t * values_, size_t n_) {
+    array ('\x71', 4, values_, n_, kernels::Kernels::table().m_reverse32);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::longs (const int64_t * values_, size_t n_) {
+    array ('\x81', 8, values_, n_, kernels::Kernels::table().m_swap64);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::doubles (const double * values_, size_t n_) {
+    array ('\x82', 8, values_, n_, kernels::Kernels::table().m_swap64);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::beginMap() {
+    begin ('\xd1');
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::endMap() {
+    end();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::enumeration (
+    std::string_view descriptor_,
+    std::string_view name_,
+    int32_t ordinal_
+) {
+    beginObject (descriptor_);
+    string (name_);
+    int32 (ordinal_);
+    endObject();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::encoder::
+Encoder::raw (std::string_view bytes_, size_t values_) {
+    if (values_) {
+        value();
+        if (!m_open.empty()) m_open.back().m_count += values_ - 1;
+    }
+
+    std::memcpy (m_buffer.reserve (bytes_.size()), bytes_.data(), bytes_.size());
+    m_buffer.commit (bytes_.size());
+}
+
+/******************************************************************************/
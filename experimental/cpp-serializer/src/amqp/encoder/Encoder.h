@@ -0,0 +1,189 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Buffer.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::encoder::Encoder
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    /**
+     * Writes AMQP 1.0 values into a [Buffer], the inverse of the
+     * [cursor::Cursor]. Each primitive takes the narrowest encoding that
+     * holds it, as the JVM's encoder does, so small integers take a byte
+     * and empty strings two.
+     *
+     * Lists and maps are opened, filled and closed. Their sizes can't be
+     * known until they're closed so both are always written with 32 bit
+     * sizes, reserved when opened and patched over on closing, with the
+     * encoder counting the values written directly inside them. A
+     * described value counts once, its descriptor and value together.
+     *
+     * Nothing is allocated once a buffer has room for what's written
+     * other than when lists and maps nest more deeply than they did
+     * before.
+     */
+    class Encoder {
+        private :
+            struct Open {
+                /**
+                 * Of the size that follows the constructor
+                 */
+                size_t m_offset;
+                uint32_t m_count;
+            };
+
+            Buffer & m_buffer;
+            std::vector<Open> m_open;
+
+            /**
+             * Set between a descriptor and the value it describes
+             */
+            bool m_described;
+
+            void value();
+
+            void put (char);
+            void put (char, uint8_t);
+            void put (char, uint16_t);
+            void put (char, uint32_t);
+            void put (char, uint64_t);
+
+            /**
+             * A string, symbol or binary, [small_] being the constructor
+             * of its one byte length form
+             */
+            void variable (char small_, std::string_view);
+
+            void begin (char constructor_);
+            void end();
+
+            /**
+             * [n_] values of [width_] bytes, each to be written with
+             * [constructor_], reversed into place by [reverse_]
+             */
+            void array (
+                char constructor_,
+                size_t width_,
+                const void * values_,
+                size_t n_,
+                void (*reverse_) (const char *, size_t, void *));
+
+        public :
+            explicit Encoder (Buffer &);
+            Encoder (const Encoder &) = delete;
+
+            Buffer & buffer() { return m_buffer; }
+
+            /**
+             * How many lists and maps are open
+             */
+            size_t depth() const { return m_open.size(); }
+
+            void null();
+            void boolean (bool);
+
+            void uint8 (uint8_t);
+            void int8 (int8_t);
+            void uint16 (uint16_t);
+            void int16 (int16_t);
+            void uint32 (uint32_t);
+            void int32 (int32_t);
+            void uint64 (uint64_t);
+            void int64 (int64_t);
+
+            void float32 (float);
+            void float64 (double);
+
+            /**
+             * A UTF-32 code point
+             */
+            void character (char32_t);
+
+            /**
+             * Milliseconds since the Unix epoch
+             */
+            void timestamp (int64_t);
+
+            /**
+             * 16 raw bytes, as the reader views them
+             */
+            void uuid (const char *);
+            void decimal128 (const char *);
+
+            void binary (std::string_view);
+            void string (std::string_view);
+            void symbol (std::string_view);
+
+            /**
+             * The start of a described value, the next value written
+             * being what it describes
+             */
+            void described (uint64_t);
+            void described (std::string_view);
+
+            void beginList();
+            void endList();
+
+            /**
+             * Without an element in it, just the one byte
+             */
+            void emptyList();
+
+            /**
+             * AMQP arrays rather than lists, the elements sharing the one
+             * constructor and so packed back to back. They're byte swapped
+             * straight from the values into the buffer a vector at a time
+             * by whichever [kernels::Kernels] suit the machine, nothing
+             * being written an element at a time, and the reader's bulk
+             * decode swaps them straight back.
+             *
+             * Every element takes the full width, however small it is.
+             */
+            void ints (const int32_t *, size_t);
+            void longs (const int64_t *, size_t);
+            void doubles (const double *, size_t);
+
+            /**
+             * Keys and values alternate
+             */
+            void beginMap();
+            void endMap();
+
+            /**
+             * An object is a list of its properties described by its
+             * type's descriptor
+             */
+            void beginObject (std::string_view descriptor_) {
+                described (descriptor_);
+                beginList();
+            }
+
+            void endObject() { endList(); }
+
+            /**
+             * An enum constant, its name and ordinal described by the
+             * enum's descriptor
+             */
+            void enumeration (std::string_view descriptor_, std::string_view name_, int32_t ordinal_);
+
+            /**
+             * Bytes already encoded, [values_] values' worth
+             */
+            void raw (std::string_view, size_t values_);
+    };
+
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,219 @@
+#include "Schema.h"
+
+#include <stdexcept>
+
+#include "amqp/schema/Descriptors.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace descriptors = amqp::schema::descriptors;
+
+    uint64_t
+    id (int id_) {
+        return descriptors::DESCRIPTOR_TOP_32BITS | static_cast<uint64_t> (id_);
+    }
+
+    /**
+     * Every type's descriptor is an OBJECT descriptor holding its symbol
+     */
+    void
+    object (amqp::internal::encoder::Encoder & encoder_, const std::string & symbol_) {
+        encoder_.described (id (descriptors::OBJECT));
+        encoder_.beginList();
+        encoder_.symbol (symbol_);
+        encoder_.null();
+        encoder_.endList();
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::encoder::Schema
+ *
+ ******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::add (Type type_) {
+    auto it = m_byName.find (type_.m_name);
+
+    if (it != m_byName.end()) {
+        return m_types[it->second].m_descriptor;
+    }
+
+    if (type_.m_descriptor.empty()) {
+        type_.m_descriptor = fingerprint (type_.m_name);
+    }
+
+    m_byName.emplace (type_.m_name, m_types.size());
+    m_types.push_back (std::move (type_));
+
+    return m_types.back().m_descriptor;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::composite (
+    const std::string & name_,
+    std::vector<Field> fields_,
+    std::string descriptor_,
+    std::vector<std::string> provides_
+) {
+    return add (Type {
+        composite_t, name_, std::move (descriptor_), std::move (fields_), { }, std::move (provides_) });
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::list (const std::string & name_, std::string descriptor_) {
+    return add (Type { list_t, name_, std::move (descriptor_), { }, { } });
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::map (const std::string & name_, std::string descriptor_) {
+    return add (Type { map_t, name_, std::move (descriptor_), { }, { } });
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::enumeration (
+    const std::string & name_,
+    std::vector<std::string> choices_,
+    std::string descriptor_
+) {
+    return add (Type {
+        enum_t, name_, std::move (descriptor_), { }, std::move (choices_) });
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::encoder::
+Schema::descriptor (const std::string & name_) const {
+    auto it = m_byName.find (name_);
+
+    if (it == m_byName.end()) {
+        throw std::runtime_error ("No type " + name_ + " has been described");
+    }
+
+    return m_types[it->second].m_descriptor;
+}
+
+/******************************************************************************/
+
+/**
+ * Types are written in the order they were added, which the reading side
+ * doesn't care about as it orders them by dependency itself
+ */
+void
+amqp::internal::encoder::
+Schema::write (Encoder & encoder_) const {
+    encoder_.described (id (descriptors::SCHEMA));
+    encoder_.beginList();
+    encoder_.beginList();
+
+    for (const auto & type : m_types) {
+        encoder_.described (id (type.m_kind == composite_t
+                ? descriptors::COMPOSITE_TYPE
+                : descriptors::RESTRICTED_TYPE));
+
+        encoder_.beginList();
+        encoder_.string (type.m_name);
+        encoder_.null();            // label
+
+        if (type.m_provides.empty()) {
+            encoder_.emptyList();
+        } else {
+            encoder_.beginList();
+            for (const auto & provides : type.m_provides) encoder_.string (provides);
+            encoder_.endList();
+        }
+
+        if (type.m_kind == composite_t) {
+            object (encoder_, type.m_descriptor);
+
+            encoder_.beginList();
+            for (const auto & field : type.m_fields) {
+                encoder_.described (id (descriptors::FIELD));
+                encoder_.beginList();
+                encoder_.string (field.m_name);
+                encoder_.string (field.m_type);
+
+                if (field.m_requires.empty()) {
+                    encoder_.emptyList();
+                } else {
+                    encoder_.beginList();
+                    encoder_.string (field.m_requires);
+                    encoder_.endList();
+                }
+
+                encoder_.null();    // default
+                encoder_.null();    // label
+                encoder_.boolean (field.m_mandatory);
+                encoder_.boolean (false);
+                encoder_.endList();
+            }
+            encoder_.endList();
+        } else {
+            // enums are restricted lists with choices
+            encoder_.string (type.m_kind == map_t ? "map" : "list");
+
+            object (encoder_, type.m_descriptor);
+
+            encoder_.beginList();
+            for (size_t i { 0 } ; i < type.m_choices.size() ; ++i) {
+                encoder_.described (id (descriptors::CHOICE));
+                encoder_.beginList();
+                encoder_.string (type.m_choices[i]);
+                encoder_.string (std::to_string (i));
+                encoder_.endList();
+            }
+            encoder_.endList();
+        }
+
+        encoder_.endList();
+    }
+
+    encoder_.endList();
+    encoder_.endList();
+}
+
+/******************************************************************************/
+
+/**
+ * FNV-1a, twice over with the primes swapped, as 22 base64 digits
+ */
+std::string
+amqp::internal::encoder::
+Schema::fingerprint (const std::string & name_) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    uint64_t hash[2] = { 14695981039346656037UL, 1099511628211UL };
+    for (auto c : name_) {
+        hash[0] = (hash[0] ^ static_cast<unsigned char> (c)) * 1099511628211UL;
+        hash[1] = (hash[1] ^ static_cast<unsigned char> (c)) * 14695981039346656037UL;
+    }
+
+    std::string rtn { "net.corda:" };
+
+    for (int i { 0 } ; i < 22 ; ++i) {
+        rtn += alphabet[(hash[i / 11] >> (6 * (i % 11))) & 63];
+    }
+
+    return rtn + "==";
+}
+
+/******************************************************************************/
@@ -0,0 +1,110 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+
+#include "Encoder.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::encoder::Schema
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::encoder {
+
+    /**
+     * The types a blob is written in terms of, added as each object is
+     * described and written as the envelope's SCHEMA section exactly as
+     * the [schema::Schema] that reads it back expects.
+     *
+     * Adding a type that's already there does nothing so every object can
+     * describe everything it holds without checking what's been described
+     * before. Each type is identified by its descriptor, which, unless
+     * given one, is a [fingerprint] of its name; stable and unique but not
+     * the hash of the type's shape the JVM would have given it, which
+     * nothing on this side ever checks.
+     */
+    class Schema {
+        public :
+            struct Field {
+                std::string m_name;
+
+                /**
+                 * A primitive's AMQP name, a composite's class name or,
+                 * for anything else, * with [m_requires] naming the type
+                 */
+                std::string m_type;
+                std::string m_requires;
+
+                bool m_mandatory { true };
+            };
+
+        private :
+            enum Kind { composite_t, list_t, map_t, enum_t };
+
+            struct Type {
+                Kind m_kind;
+                std::string m_name;
+                std::string m_descriptor;
+
+                std::vector<Field> m_fields;
+                std::vector<std::string> m_choices;
+                std::vector<std::string> m_provides;
+            };
+
+            std::vector<Type> m_types;
+            std::unordered_map<std::string, size_t> m_byName;
+
+            const std::string & add (Type);
+
+        public :
+            /**
+             * Each returns the type's descriptor. [provides_] are the
+             * interfaces a composite implements, those a field can be
+             * declared as and hold it
+             */
+            const std::string & composite (
+                const std::string & name_,
+                std::vector<Field> fields_,
+                std::string descriptor_ = { },
+                std::vector<std::string> provides_ = { });
+
+            /**
+             * A java.util.List<...> or the like
+             */
+            const std::string & list (const std::string & name_, std::string descriptor_ = { });
+            const std::string & map (const std::string & name_, std::string descriptor_ = { });
+
+            /**
+             * Constants in ordinal order
+             */
+            const std::string & enumeration (
+                const std::string & name_,
+                std::vector<std::string> choices_,
+                std::string descriptor_ = { });
+
+            bool contains (const std::string & name_) const {
+                return m_byName.find (name_) != m_byName.end();
+            }
+
+            /**
+             * Of a type already added
+             */
+            const std::string & descriptor (const std::string & name_) const;
+
+            size_t size() const { return m_types.size(); }
+
+            void write (Encoder &) const;
+
+            static std::string fingerprint (const std::string & name_);
+    };
+
+}
+
+/******************************************************************************/
+
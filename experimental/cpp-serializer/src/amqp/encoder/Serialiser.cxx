@@ -0,0 +1,190 @@
+#include "serialiser/Serialiser.h"
+
+#include <cstring>
+#include <typeinfo>
+#include <stdexcept>
+
+#include "Buffer.h"
+#include "Schema.h"
+#include "Encoder.h"
+
+#include "amqp/AMQPHeader.h"
+#include "amqp/AMQPSectionId.h"
+#include "amqp/schema/Descriptors.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace descriptors = amqp::schema::descriptors;
+
+    uint64_t
+    id (int id_) {
+        return descriptors::DESCRIPTOR_TOP_32BITS | static_cast<uint64_t> (id_);
+    }
+
+    /**
+     * The header plus the encoding byte
+     */
+    const size_t PREAMBLE = amqp::AMQP_HEADER.size() + 1;
+
+}
+
+/******************************************************************************/
+
+struct serialiser::Serialiser::Type {
+    amqp::internal::encoder::Schema m_schema;
+
+    /**
+     * The encoded schema and transforms, the envelope's last two values
+     */
+    std::string m_tail;
+
+    /**
+     * What the last blob of this type took
+     */
+    size_t m_hint;
+};
+
+/******************************************************************************
+ *
+ * serialiser::Serialiser
+ *
+ ******************************************************************************/
+
+serialiser::
+Serialiser::Serialiser() = default;
+
+/******************************************************************************/
+
+serialiser::
+Serialiser::~Serialiser() = default;
+
+/******************************************************************************/
+
+serialiser::Serialiser::Type &
+serialiser::
+Serialiser::type (const amqp::serializable::ISerializable & object_) {
+    auto & type = m_types[std::type_index (typeid (object_))];
+
+    if (!type) {
+        type = std::make_unique<Type>();
+
+        object_.describe (type->m_schema);
+
+        amqp::internal::encoder::StringBuffer buffer (type->m_tail);
+        amqp::internal::encoder::Encoder encoder (buffer);
+
+        type->m_schema.write (encoder);
+
+        encoder.described (id (descriptors::TRANSFORM_SCHEMA));
+        encoder.beginMap();
+        encoder.endMap();
+
+        buffer.flush();
+
+        type->m_hint = PREAMBLE + type->m_tail.size();
+    }
+
+    return *type;
+}
+
+/******************************************************************************/
+
+/**
+ * The whole blob, header and all, through [encoder_] leaving flushing its
+ * buffer to the caller
+ */
+size_t
+serialiser::
+Serialiser::write (
+    Type & type_,
+    const amqp::serializable::ISerializable & object_,
+    amqp::internal::encoder::Encoder & encoder_
+) {
+    auto & buffer = encoder_.buffer();
+    auto start = buffer.size();
+
+    auto * p = buffer.reserve (type_.m_hint);
+    std::memcpy (p, amqp::AMQP_HEADER.data(), amqp::AMQP_HEADER.size());
+    p[amqp::AMQP_HEADER.size()] = static_cast<char> (amqp::DATA_AND_STOP);
+    buffer.commit (PREAMBLE);
+
+    encoder_.described (id (descriptors::ENVELOPE));
+    encoder_.beginList();
+
+    object_.serialize (encoder_, type_.m_schema);
+
+    encoder_.raw (type_.m_tail, 2);
+    encoder_.endList();
+
+    if (encoder_.depth()) {
+        throw std::runtime_error ("Serialised an object without closing everything it opened");
+    }
+
+    type_.m_hint = buffer.size() - start;
+
+    return type_.m_hint;
+}
+
+/******************************************************************************/
+
+size_t
+serialiser::
+Serialiser::serialise (
+    const amqp::serializable::ISerializable & object_,
+    amqp::internal::encoder::Buffer & buffer_
+) {
+    amqp::internal::encoder::Encoder encoder (buffer_);
+
+    auto rtn = write (type (object_), object_, encoder);
+
+    buffer_.flush();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string
+serialiser::
+Serialiser::serialise (const amqp::serializable::ISerializable & object_) {
+    std::string rtn;
+    amqp::internal::encoder::StringBuffer buffer (rtn);
+
+    serialise (object_, buffer);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::vector<size_t>
+serialiser::
+Serialiser::serialise (
+    const std::vector<const amqp::serializable::ISerializable *> & objects_,
+    amqp::internal::encoder::Buffer & buffer_
+) {
+    std::vector<size_t> rtn;
+    rtn.reserve (objects_.size());
+
+    amqp::internal::encoder::Encoder encoder (buffer_);
+
+    const std::type_info * last { nullptr };
+    Type * type { nullptr };
+
+    for (const auto * object : objects_) {
+        if (!last || typeid (*object) != *last) {
+            last = &typeid (*object);
+            type = &this->type (*object);
+        }
+
+        rtn.push_back (write (*type, *object, encoder));
+    }
+
+    buffer_.flush();
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,186 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "kernels/Kernels.h"
+
+/******************************************************************************
+ *
+ * JSON string escaping
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::format {
+
+    /**
+     * The length of the well formed UTF-8 sequence starting at [s_], 0
+     * if it isn't one. Overlong encodings, surrogates and anything past
+     * U+10FFFF are all malformed
+     */
+    inline size_t
+    utf8 (const char * s_, size_t n_) {
+        auto b = [s_](size_t i_) { return static_cast<unsigned char>(s_[i_]); };
+        auto continuation = [&b](size_t i_) { return (b (i_) & 0xC0U) == 0x80; };
+
+        auto lead = b (0);
+
+        if (lead < 0x80) return 1;
+
+        if (lead < 0xC2) return 0;
+
+        if (lead < 0xE0) {
+            return n_ >= 2 && continuation (1) ? 2 : 0;
+        }
+
+        if (lead < 0xF0) {
+            if (n_ < 3 || !continuation (1) || !continuation (2)) return 0;
+
+            // overlong, and surrogates
+            if (lead == 0xE0 && b (1) < 0xA0) return 0;
+            if (lead == 0xED && b (1) >= 0xA0) return 0;
+
+            return 3;
+        }
+
+        if (lead < 0xF5) {
+            if (n_ < 4 || !continuation (1) || !continuation (2) || !continuation (3)) return 0;
+
+            if (lead == 0xF0 && b (1) < 0x90) return 0;
+            if (lead == 0xF4 && b (1) >= 0x90) return 0;
+
+            return 4;
+        }
+
+        return 0;
+    }
+
+    /**
+     * Escapes [s_] for use as the contents of a JSON string in one pass,
+     * handing [put_] runs of it that can be copied as they are along with
+     * the escapes between them. Those runs are found a vector at a time,
+     * so mostly ASCII text goes at close to the speed of a copy.
+     *
+     * Each byte that isn't part of well formed UTF-8 is replaced by the
+     * Unicode replacement character, so whatever the blob holds the output
+     * is valid JSON.
+     */
+    template<typename Put>
+    void
+    escape (std::string_view s_, Put && put_) {
+        static const char hex[] = "0123456789abcdef";
+
+        const auto plain = kernels::Kernels::table().m_plain;
+
+        const char * p = s_.data();
+        size_t n = s_.size();
+
+        while (n) {
+            // multibyte sequences are valid more often than not so carry
+            // on with the run rather than breaking it at each one
+            size_t run { 0 };
+
+            for (;;) {
+                run += plain (p + run, n - run);
+
+                if (run == n || static_cast<unsigned char>(p[run]) < 0x80) break;
+
+                auto len = utf8 (p + run, n - run);
+                if (!len) break;
+
+                run += len;
+            }
+
+            if (run) put_ (std::string_view (p, run));
+
+            p += run;
+            n -= run;
+
+            if (!n) break;
+
+            auto c = static_cast<unsigned char>(*p);
+
+            switch (c) {
+                case '"'  : put_ ("\\\""); break;
+                case '\\' : put_ ("\\\\"); break;
+                case '\n' : put_ ("\\n"); break;
+                case '\r' : put_ ("\\r"); break;
+                case '\t' : put_ ("\\t"); break;
+                case '\b' : put_ ("\\b"); break;
+                case '\f' : put_ ("\\f"); break;
+                default : {
+                    if (c >= 0x80) {
+                        put_ ("\\ufffd");
+                    } else {
+                        char u[] = { '\\', 'u', '0', '0', hex[c >> 4U], hex[c & 0xFU] };
+                        put_ (std::string_view (u, sizeof (u)));
+                    }
+                }
+            }
+
+            ++p;
+            --n;
+        }
+    }
+
+}
+
+/******************************************************************************
+ *
+ * Binary
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::format {
+
+    /**
+     * [s_] encoded as padded base64, handed to [put_] a chunk at a time
+     * so nothing the size of the input is ever built
+     */
+    template<typename Put>
+    void
+    base64 (std::string_view s_, Put && put_) {
+        static const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        char chunk[256];
+        size_t used { 0 };
+
+        auto b = [&s_](size_t i_) { return static_cast<uint32_t>(
+                static_cast<unsigned char>(s_[i_])); };
+
+        size_t i { 0 };
+
+        for ( ; i + 3 <= s_.size() ; i += 3) {
+            auto v = (b (i) << 16U) | (b (i + 1) << 8U) | b (i + 2);
+
+            chunk[used++] = alphabet[(v >> 18U) & 0x3FU];
+            chunk[used++] = alphabet[(v >> 12U) & 0x3FU];
+            chunk[used++] = alphabet[(v >> 6U) & 0x3FU];
+            chunk[used++] = alphabet[v & 0x3FU];
+
+            if (used == sizeof (chunk)) {
+                put_ (std::string_view (chunk, used));
+                used = 0;
+            }
+        }
+
+        if (i < s_.size()) {
+            auto v = b (i) << 16U;
+            if (i + 1 < s_.size()) v |= b (i + 1) << 8U;
+
+            chunk[used++] = alphabet[(v >> 18U) & 0x3FU];
+            chunk[used++] = alphabet[(v >> 12U) & 0x3FU];
+            chunk[used++] = i + 1 < s_.size() ? alphabet[(v >> 6U) & 0x3FU] : '=';
+            chunk[used++] = '=';
+        }
+
+        if (used) put_ (std::string_view (chunk, used));
+    }
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,57 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+/******************************************************************************
+ *
+ * class amqp::internal::format::Number
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::format {
+
+    /**
+     * The one place numbers are turned into text, used by every renderer
+     * so a value reads the same whichever way it's output.
+     *
+     * Built on [std::to_chars] so it never allocates and ignores the
+     * locale. Doubles are written in the shortest form that parses back
+     * to exactly the same value, so nothing is lost, without padding them
+     * out to a fixed number of places.
+     */
+    class Number {
+        public :
+            /**
+             * Enough for any 64 bit integer or the shortest round trip
+             * form of any double
+             */
+            static constexpr size_t MAX_CHARS = 32;
+
+        private :
+            char m_buf[MAX_CHARS];
+            size_t m_size;
+
+        public :
+            template<typename T>
+            explicit Number (T value_) {
+                static_assert (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+                auto res = std::to_chars (m_buf, m_buf + MAX_CHARS, value_);
+                m_size = static_cast<size_t>(res.ptr - m_buf);
+            }
+
+            std::string_view view() const {
+                return { m_buf, m_size };
+            }
+
+            operator std::string_view() const { return view(); }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,274 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <charconv>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * Text forms of the primitives that aren't numbers
+ *
+ * Like [Number] each is built into a buffer of its own so nothing is
+ * allocated and a value reads the same whichever renderer outputs it.
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::format {
+
+    /**
+     * An AMQP char, a UTF-32 code point, as UTF-8. Surrogates and anything
+     * past U+10FFFF become U+FFFD
+     */
+    class Utf8 {
+        private :
+            char m_buf[4];
+            size_t m_size;
+
+        public :
+            explicit Utf8 (char32_t c_) {
+                auto c = static_cast<uint32_t>(c_);
+
+                if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) c = 0xFFFD;
+
+                if (c < 0x80) {
+                    m_buf[0] = static_cast<char>(c);
+                    m_size = 1;
+                } else if (c < 0x800) {
+                    m_buf[0] = static_cast<char>(0xC0 | (c >> 6U));
+                    m_buf[1] = static_cast<char>(0x80 | (c & 0x3FU));
+                    m_size = 2;
+                } else if (c < 0x10000) {
+                    m_buf[0] = static_cast<char>(0xE0 | (c >> 12U));
+                    m_buf[1] = static_cast<char>(0x80 | ((c >> 6U) & 0x3FU));
+                    m_buf[2] = static_cast<char>(0x80 | (c & 0x3FU));
+                    m_size = 3;
+                } else {
+                    m_buf[0] = static_cast<char>(0xF0 | (c >> 18U));
+                    m_buf[1] = static_cast<char>(0x80 | ((c >> 12U) & 0x3FU));
+                    m_buf[2] = static_cast<char>(0x80 | ((c >> 6U) & 0x3FU));
+                    m_buf[3] = static_cast<char>(0x80 | (c & 0x3FU));
+                    m_size = 4;
+                }
+            }
+
+            std::string_view view() const { return { m_buf, m_size }; }
+    };
+
+    /**
+     * An AMQP timestamp, milliseconds since the Unix epoch, in ISO 8601
+     * form, e.g. 2019-03-04T10:11:12.345Z. Worked out by hand rather than
+     * with gmtime, which isn't thread safe and can't reach every year a
+     * timestamp can
+     */
+    class Iso8601 {
+        private :
+            // a sign, a sixteen digit year and the rest
+            char m_buf[40];
+            size_t m_size;
+
+            char * two (char * p_, unsigned v_) {
+                *p_++ = static_cast<char>('0' + v_ / 10);
+                *p_++ = static_cast<char>('0' + v_ % 10);
+                return p_;
+            }
+
+        public :
+            explicit Iso8601 (int64_t millis_) {
+                auto floorDiv = [](int64_t a_, int64_t b_) {
+                    return a_ / b_ - (a_ % b_ < 0 ? 1 : 0);
+                };
+
+                int64_t days = floorDiv (millis_, 86400000);
+                auto ms = static_cast<unsigned>(millis_ - days * 86400000);
+
+                // civil from days, see howardhinnant.github.io/date_algorithms
+                int64_t z = days + 719468;
+                int64_t era = floorDiv (z, 146097);
+                auto doe = static_cast<unsigned>(z - era * 146097);
+                unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+                unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+                unsigned mp = (5 * doy + 2) / 153;
+                unsigned day = doy - (153 * mp + 2) / 5 + 1;
+                unsigned month = mp < 10 ? mp + 3 : mp - 9;
+                int64_t year = static_cast<int64_t>(yoe) + era * 400 + (month <= 2 ? 1 : 0);
+
+                char * p = m_buf;
+
+                if (year < 0) {
+                    *p++ = '-';
+                    year = -year;
+                }
+
+                for (int64_t pad { 1000 } ; pad > 1 && year < pad ; pad /= 10) *p++ = '0';
+                p = std::to_chars (p, m_buf + sizeof (m_buf), year).ptr;
+
+                *p++ = '-';
+                p = two (p, month);
+                *p++ = '-';
+                p = two (p, day);
+                *p++ = 'T';
+                p = two (p, ms / 3600000);
+                *p++ = ':';
+                p = two (p, ms / 60000 % 60);
+                *p++ = ':';
+                p = two (p, ms / 1000 % 60);
+                *p++ = '.';
+                *p++ = static_cast<char>('0' + ms % 1000 / 100);
+                p = two (p, ms % 100);
+                *p++ = 'Z';
+
+                m_size = static_cast<size_t>(p - m_buf);
+            }
+
+            std::string_view view() const { return { m_buf, m_size }; }
+    };
+
+    /**
+     * The 16 raw bytes of a uuid in their canonical 8-4-4-4-12 form
+     */
+    class Uuid {
+        private :
+            char m_buf[36];
+
+        public :
+            explicit Uuid (const char * bytes_) {
+                static const char hex[] = "0123456789abcdef";
+
+                char * p = m_buf;
+
+                for (size_t i { 0 } ; i < 16 ; ++i) {
+                    if (i == 4 || i == 6 || i == 8 || i == 10) *p++ = '-';
+
+                    auto b = static_cast<unsigned char>(bytes_[i]);
+                    *p++ = hex[b >> 4U];
+                    *p++ = hex[b & 0xFU];
+                }
+            }
+
+            std::string_view view() const { return { m_buf, sizeof (m_buf) }; }
+    };
+
+    /**
+     * The 16 raw bytes of an IEEE 754 decimal128, binary integer decimal
+     * encoded and most significant byte first as AMQP has it. Written as
+     * Java's BigDecimal.toString would, in plain form unless the exponent
+     * is large enough that scientific notation is clearer
+     */
+    class Decimal {
+        private :
+            char m_buf[64];
+            size_t m_size;
+
+        public :
+            explicit Decimal (const char * bytes_) {
+                auto be64 = [](const char * p_) {
+                    uint64_t rtn { 0 };
+                    for (size_t i { 0 } ; i < 8 ; ++i) {
+                        rtn = (rtn << 8U) | static_cast<unsigned char>(p_[i]);
+                    }
+                    return rtn;
+                };
+
+                uint64_t hi = be64 (bytes_);
+                uint64_t lo = be64 (bytes_ + 8);
+
+                bool negative = (hi >> 63U) != 0;
+
+                char * p = m_buf;
+
+                auto put = [&p](std::string_view s_) {
+                    std::memcpy (p, s_.data(), s_.size());
+                    p += s_.size();
+                };
+
+                if (((hi >> 58U) & 0x1FU) == 0x1F) {
+                    put ("NaN");
+                    m_size = static_cast<size_t>(p - m_buf);
+                    return;
+                }
+
+                if (negative) *p++ = '-';
+
+                if (((hi >> 58U) & 0x1FU) == 0x1E) {
+                    put ("Infinity");
+                    m_size = static_cast<size_t>(p - m_buf);
+                    return;
+                }
+
+                // a coefficient's 113 bits, marked so -pedantic lets it be
+                __extension__ typedef unsigned __int128 uint128;
+
+                int exponent;
+                uint128 coefficient;
+
+                if (((hi >> 61U) & 0x3U) == 0x3) {
+                    // only ever holds a coefficient too large to be
+                    // canonical, which reads as zero
+                    exponent = static_cast<int>((hi >> 47U) & 0x3FFFU);
+                    coefficient = 0;
+                } else {
+                    exponent = static_cast<int>((hi >> 49U) & 0x3FFFU);
+                    coefficient = (static_cast<uint128>(
+                            hi & 0x1FFFFFFFFFFFFULL) << 64U) | lo;
+                }
+
+                exponent -= 6176;
+
+                const auto max = static_cast<uint128>(10000000000000000ULL)
+                        * 1000000000000000000ULL;
+
+                if (coefficient >= max) coefficient = 0;
+
+                char digits[40];
+                int n { 0 };
+
+                do {
+                    digits[n++] = static_cast<char>('0' + static_cast<int>(coefficient % 10));
+                    coefficient /= 10;
+                } while (coefficient);
+
+                for (int i { 0 } ; i < n / 2 ; ++i) std::swap (digits[i], digits[n - 1 - i]);
+
+                int adjusted = n - 1 + exponent;
+
+                if (exponent <= 0 && adjusted >= -6) {
+                    int point = n + exponent;
+
+                    if (exponent == 0) {
+                        put ({ digits, static_cast<size_t>(n) });
+                    } else if (point > 0) {
+                        put ({ digits, static_cast<size_t>(point) });
+                        *p++ = '.';
+                        put ({ digits + point, static_cast<size_t>(n - point) });
+                    } else {
+                        put ("0.");
+                        for (int i { point } ; i < 0 ; ++i) *p++ = '0';
+                        put ({ digits, static_cast<size_t>(n) });
+                    }
+                } else {
+                    *p++ = digits[0];
+
+                    if (n > 1) {
+                        *p++ = '.';
+                        put ({ digits + 1, static_cast<size_t>(n - 1) });
+                    }
+
+                    *p++ = 'E';
+                    if (adjusted >= 0) *p++ = '+';
+                    p = std::to_chars (p, m_buf + sizeof (m_buf), adjusted).ptr;
+                }
+
+                m_size = static_cast<size_t>(p - m_buf);
+            }
+
+            std::string_view view() const { return { m_buf, m_size }; }
+    };
+
+}
+
+/******************************************************************************/
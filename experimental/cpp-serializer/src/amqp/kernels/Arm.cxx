@@ -0,0 +1,126 @@
+#include "Variants.h"
+
+/******************************************************************************
+ *
+ * NEON, which every AArch64 has
+ *
+ ******************************************************************************/
+
+#if defined (__ARM_NEON)
+
+#include <arm_neon.h>
+
+/******************************************************************************/
+
+namespace {
+
+    using namespace amqp::internal::kernels;
+
+    void
+    swap32Neon (const char * in_, size_t n_, int64_t * out_) {
+        size_t i { 0 };
+
+        for (; i + 4 <= n_ ; i += 4) {
+            auto v = vreinterpretq_s32_u8 (vrev32q_u8 (
+                    vld1q_u8 (reinterpret_cast<const uint8_t *>(in_ + 4 * i))));
+
+            vst1q_s64 (out_ + i, vmovl_s32 (vget_low_s32 (v)));
+            vst1q_s64 (out_ + i + 2, vmovl_s32 (vget_high_s32 (v)));
+        }
+
+        swap32Tail (in_, i, n_, out_);
+    }
+
+    void
+    swap64Neon (const char * in_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 2 <= n_ ; i += 2) {
+            vst1q_u8 (
+                reinterpret_cast<uint8_t *>(out + 8 * i),
+                vrev64q_u8 (vld1q_u8 (reinterpret_cast<const uint8_t *>(in_ + 8 * i))));
+        }
+
+        swap64Tail (in_, i, n_, out_);
+    }
+
+    void
+    reverse32Neon (const char * in_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 4 <= n_ ; i += 4) {
+            vst1q_u8 (
+                reinterpret_cast<uint8_t *>(out + 4 * i),
+                vrev32q_u8 (vld1q_u8 (reinterpret_cast<const uint8_t *>(in_ + 4 * i))));
+        }
+
+        reverse32Tail (in_, i, n_, out_);
+    }
+
+    size_t
+    plainNeon (const char * s_, size_t n_) {
+        const auto space = vdupq_n_u8 (0x20);
+        const auto high = vdupq_n_u8 (0x80);
+        const auto quote = vdupq_n_u8 ('"');
+        const auto backslash = vdupq_n_u8 ('\\');
+
+        size_t i { 0 };
+
+        for (; i + 16 <= n_ ; i += 16) {
+            auto v = vld1q_u8 (reinterpret_cast<const uint8_t *>(s_ + i));
+
+            auto special = vorrq_u8 (
+                    vorrq_u8 (vcltq_u8 (v, space), vcgeq_u8 (v, high)),
+                    vorrq_u8 (vceqq_u8 (v, quote), vceqq_u8 (v, backslash)));
+
+            // narrow each byte's all ones or zeros to a nibble of a 64 bit mask
+            auto mask = vget_lane_u64 (vreinterpret_u64_u8 (
+                    vshrn_n_u16 (vreinterpretq_u16_u8 (special), 4)), 0);
+
+            if (mask) return i + __builtin_ctzll (mask) / 4;
+        }
+
+        return plainTail (s_, i, n_);
+    }
+
+    /**
+     * Each byte's comparison narrowed to a nibble, as for [plainNeon]
+     */
+    size_t
+    runNeon (const char * s_, size_t n_, size_t stride_, uint8_t code_) {
+        // the lowest bit of the nibble of each value's first byte
+        size_t per;
+        const auto want = leads (4 * stride_, 64, per);
+        const auto code = vdupq_n_u8 (code_);
+
+        size_t i { 0 };
+
+        for (; per > 0 && i * stride_ + 16 <= n_ * stride_ ; i += per) {
+            auto v = vceqq_u8 (vld1q_u8 (reinterpret_cast<const uint8_t *>(s_ + i * stride_)), code);
+
+            auto got = vget_lane_u64 (vreinterpret_u64_u8 (
+                    vshrn_n_u16 (vreinterpretq_u16_u8 (v), 4)), 0) & want;
+
+            if (got != want) return i + __builtin_ctzll (~got & want) / 4 / stride_;
+        }
+
+        return runTail (s_, i, n_, stride_, code_);
+    }
+
+    const Table neonTable { neon_t, swap32Neon, swap64Neon, reverse32Neon, plainNeon, runNeon };
+
+}
+
+/******************************************************************************/
+
+const amqp::internal::kernels::Table * const amqp::internal::kernels::neon { &neonTable };
+
+#else
+
+const amqp::internal::kernels::Table * const amqp::internal::kernels::neon { nullptr };
+
+#endif
+
+/******************************************************************************/
@@ -0,0 +1,144 @@
+#include "Kernels.h"
+
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined (__aarch64__) && defined (__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#include "Variants.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using namespace amqp::internal::kernels;
+
+    const char * const names[] = {
+        "scalar", "sse2", "avx2", "avx512", "neon"
+    };
+
+    const Table *
+    tableOf (Variant variant_) {
+        switch (variant_) {
+            case scalar_t : return &scalar;
+            case sse2_t   : return sse2;
+            case avx2_t   : return avx2;
+            case avx512_t : return avx512;
+            case neon_t   : return neon;
+            default       : return nullptr;
+        }
+    }
+
+    bool
+    runnable (Variant variant_) {
+        switch (variant_) {
+            case scalar_t : return true;
+#if defined (__x86_64__) || defined (__i386__)
+            case sse2_t   : return __builtin_cpu_supports ("sse2");
+            case avx2_t   : return __builtin_cpu_supports ("avx2");
+            case avx512_t : return __builtin_cpu_supports ("avx512f")
+                                && __builtin_cpu_supports ("avx512bw");
+#endif
+#if defined (__aarch64__) && defined (__linux__)
+            case neon_t   : return (getauxval (AT_HWCAP) & HWCAP_ASIMD) != 0;
+#elif defined (__ARM_NEON)
+            case neon_t   : return true;
+#endif
+            default       : return false;
+        }
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::kernels::Kernels
+ *
+ ******************************************************************************/
+
+std::atomic<const amqp::internal::kernels::Table *>
+amqp::internal::kernels::Kernels::s_table { nullptr };
+
+/******************************************************************************/
+
+const amqp::internal::kernels::Table *
+amqp::internal::kernels::
+Kernels::select() {
+    auto * rtn = tableOf (best());
+
+    if (const char * env = std::getenv ("AMQP_KERNELS")) {
+        auto variant = parse (env);
+
+        if (variant != variants_t && supported (variant)) {
+            rtn = tableOf (variant);
+        }
+    }
+
+    // whichever thread gets here first decides
+    const Table * expected { nullptr };
+
+    if (!s_table.compare_exchange_strong (expected, rtn, std::memory_order_acq_rel)) {
+        return expected;
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::kernels::
+Kernels::supported (Variant variant_) {
+    return tableOf (variant_) != nullptr && runnable (variant_);
+}
+
+/******************************************************************************/
+
+amqp::internal::kernels::Variant
+amqp::internal::kernels::
+Kernels::best() {
+    for (int i { variants_t - 1 } ; i > scalar_t ; --i) {
+        if (supported (Variant (i))) return Variant (i);
+    }
+
+    return scalar_t;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::kernels::
+Kernels::force (Variant variant_) {
+    if (!supported (variant_)) {
+        throw std::runtime_error (
+                std::string ("Kernels not supported here: ") + name (variant_));
+    }
+
+    s_table.store (tableOf (variant_), std::memory_order_release);
+}
+
+/******************************************************************************/
+
+const char *
+amqp::internal::kernels::
+Kernels::name (Variant variant_) {
+    return variant_ >= scalar_t && variant_ < variants_t ? names[variant_] : "unknown";
+}
+
+/******************************************************************************/
+
+amqp::internal::kernels::Variant
+amqp::internal::kernels::
+Kernels::parse (std::string_view name_) {
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        if (name_ == names[i]) return Variant (i);
+    }
+
+    return variants_t;
+}
+
+/******************************************************************************/
@@ -0,0 +1,114 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::internal::kernels::Kernels
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::kernels {
+
+    /**
+     * The instruction sets kernels are written for, in the order they'd
+     * be preferred on hardware with more than one
+     */
+    enum Variant {
+        scalar_t,
+        sse2_t,
+        avx2_t,
+        avx512_t,
+        neon_t,
+        variants_t
+    };
+
+    /**
+     * One implementation of every kernel, all for the same variant
+     */
+    struct Table {
+        Variant m_variant;
+
+        /**
+         * Big endian to native over [n_] values packed back to back,
+         * widening the 32 bit ones as they go
+         */
+        void (*m_swap32) (const char * in_, size_t n_, int64_t * out_);
+        void (*m_swap64) (const char * in_, size_t n_, void * out_);
+
+        /**
+         * Reverses the bytes of [n_] 32 bit values without widening them.
+         * As reversing is its own inverse this, like [m_swap64], turns
+         * native values big endian just as it does big endian native
+         */
+        void (*m_reverse32) (const char * in_, size_t n_, void * out_);
+
+        /**
+         * How many of the [n_] bytes at [s_] can be copied into a JSON
+         * string as they are, stopping at the first control character,
+         * quote, backslash or byte of a multibyte UTF-8 sequence
+         */
+        size_t (*m_plain) (const char * s_, size_t n_);
+
+        /**
+         * How many of the [n_] values of [stride_] bytes packed back to
+         * back at [s_], the run of list elements sharing a fixed width
+         * constructor say, lead with the byte [code_], stopping at the
+         * first that doesn't
+         */
+        size_t (*m_run) (const char * s_, size_t n_, size_t stride_, uint8_t code_);
+    };
+
+    /**
+     * Picks which variant of the vectorised kernels is used, so a single
+     * binary runs as fast as it can on whatever it finds itself on. Until
+     * told otherwise that's the best the CPU supports, as reported by
+     * CPUID on x86 and the kernel's hardware capabilities on ARM, unless
+     * the AMQP_KERNELS environment variable names another, "scalar" say.
+     *
+     * Tests and benchmarks can [force] a variant to compare them.
+     * Forcing one while other threads are decoding is safe, those threads
+     * simply pick it up from their next call, but hardly useful.
+     */
+    class Kernels {
+        private :
+            static std::atomic<const Table *> s_table;
+
+            static const Table * select();
+
+        public :
+            static const Table & table() {
+                auto * rtn = s_table.load (std::memory_order_acquire);
+                return rtn ? *rtn : *select();
+            }
+
+            static Variant variant() { return table().m_variant; }
+
+            /**
+             * Whether the variant is both built in and runnable here
+             */
+            static bool supported (Variant);
+
+            static Variant best();
+
+            /**
+             * Throws if [variant_] isn't supported
+             */
+            static void force (Variant variant_);
+
+            static const char * name (Variant);
+
+            /**
+             * [variants_t] for a name that isn't one
+             */
+            static Variant parse (std::string_view);
+    };
+
+}
+
+/******************************************************************************/
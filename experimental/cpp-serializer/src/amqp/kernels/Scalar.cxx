@@ -0,0 +1,53 @@
+#include "Variants.h"
+
+/******************************************************************************
+ *
+ * Plain C++, for anywhere nothing better can be run and as the reference
+ * every other variant is tested against
+ *
+ ******************************************************************************/
+
+namespace {
+
+    using namespace amqp::internal::kernels;
+
+    void
+    swap32 (const char * in_, size_t n_, int64_t * out_) {
+        swap32Tail (in_, 0, n_, out_);
+    }
+
+    void
+    swap64 (const char * in_, size_t n_, void * out_) {
+        swap64Tail (in_, 0, n_, out_);
+    }
+
+    void
+    reverse32 (const char * in_, size_t n_, void * out_) {
+        reverse32Tail (in_, 0, n_, out_);
+    }
+
+    size_t
+    plain (const char * s_, size_t n_) {
+        return plainTail (s_, 0, n_);
+    }
+
+    size_t
+    run (const char * s_, size_t n_, size_t stride_, uint8_t code_) {
+        return runTail (s_, 0, n_, stride_, code_);
+    }
+
+}
+
+/******************************************************************************/
+
+const amqp::internal::kernels::Table
+amqp::internal::kernels::scalar {
+    scalar_t,
+    ::swap32,
+    ::swap64,
+    ::reverse32,
+    ::plain,
+    ::run
+};
+
+/******************************************************************************/
@@ -0,0 +1,104 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstring>
+
+#include "Kernels.h"
+
+/******************************************************************************
+ *
+ * The tables of each variant, those not built for this architecture being
+ * null
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::kernels {
+
+    extern const Table scalar;
+    extern const Table * const sse2;
+    extern const Table * const avx2;
+    extern const Table * const avx512;
+    extern const Table * const neon;
+
+    /**
+     * For what's left over once a vector kernel has run out of whole
+     * vectors
+     */
+    inline uint32_t
+    be32 (const char * p_) {
+        uint32_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return __builtin_bswap32 (rtn);
+    }
+
+    inline uint64_t
+    be64 (const char * p_) {
+        uint64_t rtn;
+        std::memcpy (&rtn, p_, sizeof (rtn));
+        return __builtin_bswap64 (rtn);
+    }
+
+    inline bool
+    plain (char c_) {
+        auto c = static_cast<unsigned char>(c_);
+        return c >= 0x20 && c < 0x80 && c != '"' && c != '\\';
+    }
+
+    inline size_t
+    plainTail (const char * s_, size_t from_, size_t n_) {
+        while (from_ < n_ && plain (s_[from_])) ++from_;
+        return from_;
+    }
+
+    inline size_t
+    runTail (const char * s_, size_t from_, size_t n_, size_t stride_, uint8_t code_) {
+        while (from_ < n_ && static_cast<uint8_t>(s_[from_ * stride_]) == code_) ++from_;
+        return from_;
+    }
+
+    /**
+     * A bit for the first byte of each of the values of [stride_] bytes
+     * wholly within a vector of [width_], and how many of them there are,
+     * none should they be wider than it
+     */
+    inline uint64_t
+    leads (size_t stride_, size_t width_, size_t & per_) {
+        uint64_t rtn { 0 };
+        per_ = stride_ == 0 ? 0 : width_ / stride_;
+
+        for (size_t i { 0 } ; i < per_ ; ++i) rtn |= uint64_t { 1 } << (i * stride_);
+
+        return rtn;
+    }
+
+    inline void
+    swap32Tail (const char * in_, size_t from_, size_t n_, int64_t * out_) {
+        for (size_t i { from_ } ; i < n_ ; ++i) {
+            out_[i] = static_cast<int32_t>(be32 (in_ + 4 * i));
+        }
+    }
+
+    inline void
+    reverse32Tail (const char * in_, size_t from_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+
+        for (size_t i { from_ } ; i < n_ ; ++i) {
+            auto v = be32 (in_ + 4 * i);
+            std::memcpy (out + 4 * i, &v, sizeof (v));
+        }
+    }
+
+    inline void
+    swap64Tail (const char * in_, size_t from_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+
+        for (size_t i { from_ } ; i < n_ ; ++i) {
+            auto v = be64 (in_ + 8 * i);
+            std::memcpy (out + 8 * i, &v, sizeof (v));
+        }
+    }
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,372 @@
+#include "Variants.h"
+
+/******************************************************************************
+ *
+ * SSE2, which every x86-64 has, AVX2 and AVX-512. Each function is built
+ * for its own instruction set whatever the compiler's been told to target
+ * for the rest of the library, so they can all sit in the one binary.
+ *
+ ******************************************************************************/
+
+#if defined (__x86_64__) || defined (__i386__)
+
+#include <immintrin.h>
+
+/******************************************************************************/
+
+namespace {
+
+    using namespace amqp::internal::kernels;
+
+    /**
+     * SSE2 has no byte shuffle so bytes are swapped within each 16 bit
+     * word and then the words within each value
+     */
+    __attribute__ ((target ("sse2")))
+    void
+    swap32Sse2 (const char * in_, size_t n_, int64_t * out_) {
+        size_t i { 0 };
+
+        for (; i + 4 <= n_ ; i += 4) {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(in_ + 4 * i));
+
+            v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+            v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+            v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+
+            auto sign = _mm_srai_epi32 (v, 31);
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i *>(out_ + i), _mm_unpacklo_epi32 (v, sign));
+            _mm_storeu_si128 (reinterpret_cast<__m128i *>(out_ + i + 2), _mm_unpackhi_epi32 (v, sign));
+        }
+
+        swap32Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("sse2")))
+    void
+    swap64Sse2 (const char * in_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 2 <= n_ ; i += 2) {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(in_ + 8 * i));
+
+            v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+            v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+            v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i *>(out + 8 * i), v);
+        }
+
+        swap64Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("sse2")))
+    void
+    reverse32Sse2 (const char * in_, size_t n_, void * out_) {
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 4 <= n_ ; i += 4) {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(in_ + 4 * i));
+
+            v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+            v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+            v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+
+            _mm_storeu_si128 (reinterpret_cast<__m128i *>(out + 4 * i), v);
+        }
+
+        reverse32Tail (in_, i, n_, out_);
+    }
+
+    /**
+     * Signed, bytes of 0x80 and above are negative and so less than a
+     * space along with the control characters
+     */
+    __attribute__ ((target ("sse2")))
+    size_t
+    plainSse2 (const char * s_, size_t n_) {
+        const auto space = _mm_set1_epi8 (0x20);
+        const auto quote = _mm_set1_epi8 ('"');
+        const auto backslash = _mm_set1_epi8 ('\\');
+
+        size_t i { 0 };
+
+        for (; i + 16 <= n_ ; i += 16) {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(s_ + i));
+
+            auto special = _mm_or_si128 (
+                    _mm_cmplt_epi8 (v, space),
+                    _mm_or_si128 (_mm_cmpeq_epi8 (v, quote), _mm_cmpeq_epi8 (v, backslash)));
+
+            if (auto mask = _mm_movemask_epi8 (special)) {
+                return i + __builtin_ctz (static_cast<unsigned>(mask));
+            }
+        }
+
+        return plainTail (s_, i, n_);
+    }
+
+    /**
+     * As many whole values as fit in a vector are compared at once, the
+     * last vector read never running past the last value, so values
+     * wider than a vector are left to the tail
+     */
+    __attribute__ ((target ("sse2")))
+    size_t
+    runSse2 (const char * s_, size_t n_, size_t stride_, uint8_t code_) {
+        size_t per;
+        const auto want = static_cast<unsigned> (leads (stride_, 16, per));
+        const auto code = _mm_set1_epi8 (static_cast<char> (code_));
+
+        size_t i { 0 };
+
+        for (; per > 0 && i * stride_ + 16 <= n_ * stride_ ; i += per) {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(s_ + i * stride_));
+
+            auto got = static_cast<unsigned> (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, code))) & want;
+
+            if (got != want) return i + __builtin_ctz (~got & want) / stride_;
+        }
+
+        return runTail (s_, i, n_, stride_, code_);
+    }
+
+    /**************************************************************************/
+
+    __attribute__ ((target ("avx2")))
+    void
+    swap32Avx2 (const char * in_, size_t n_, int64_t * out_) {
+        const auto mask = _mm256_setr_epi8 (
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        size_t i { 0 };
+
+        for (; i + 8 <= n_ ; i += 8) {
+            auto v = _mm256_shuffle_epi8 (
+                    _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(in_ + 4 * i)),
+                    mask);
+
+            _mm256_storeu_si256 (
+                    reinterpret_cast<__m256i *>(out_ + i),
+                    _mm256_cvtepi32_epi64 (_mm256_castsi256_si128 (v)));
+            _mm256_storeu_si256 (
+                    reinterpret_cast<__m256i *>(out_ + i + 4),
+                    _mm256_cvtepi32_epi64 (_mm256_extracti128_si256 (v, 1)));
+        }
+
+        swap32Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx2")))
+    void
+    swap64Avx2 (const char * in_, size_t n_, void * out_) {
+        const auto mask = _mm256_setr_epi8 (
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 4 <= n_ ; i += 4) {
+            _mm256_storeu_si256 (
+                    reinterpret_cast<__m256i *>(out + 8 * i),
+                    _mm256_shuffle_epi8 (
+                            _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(in_ + 8 * i)),
+                            mask));
+        }
+
+        swap64Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx2")))
+    void
+    reverse32Avx2 (const char * in_, size_t n_, void * out_) {
+        const auto mask = _mm256_setr_epi8 (
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 8 <= n_ ; i += 8) {
+            _mm256_storeu_si256 (
+                    reinterpret_cast<__m256i *>(out + 4 * i),
+                    _mm256_shuffle_epi8 (
+                            _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(in_ + 4 * i)),
+                            mask));
+        }
+
+        reverse32Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx2")))
+    size_t
+    plainAvx2 (const char * s_, size_t n_) {
+        const auto space = _mm256_set1_epi8 (0x20);
+        const auto quote = _mm256_set1_epi8 ('"');
+        const auto backslash = _mm256_set1_epi8 ('\\');
+
+        size_t i { 0 };
+
+        for (; i + 32 <= n_ ; i += 32) {
+            auto v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(s_ + i));
+
+            // a space is greater than any control character or negative byte
+            auto special = _mm256_or_si256 (
+                    _mm256_cmpgt_epi8 (space, v),
+                    _mm256_or_si256 (_mm256_cmpeq_epi8 (v, quote), _mm256_cmpeq_epi8 (v, backslash)));
+
+            if (auto mask = _mm256_movemask_epi8 (special)) {
+                return i + __builtin_ctz (static_cast<unsigned>(mask));
+            }
+        }
+
+        return plainSse2 (s_ + i, n_ - i) + i;
+    }
+
+    __attribute__ ((target ("avx2")))
+    size_t
+    runAvx2 (const char * s_, size_t n_, size_t stride_, uint8_t code_) {
+        size_t per;
+        const auto want = static_cast<unsigned> (leads (stride_, 32, per));
+        const auto code = _mm256_set1_epi8 (static_cast<char> (code_));
+
+        size_t i { 0 };
+
+        for (; per > 0 && i * stride_ + 32 <= n_ * stride_ ; i += per) {
+            auto v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *>(s_ + i * stride_));
+
+            auto got = static_cast<unsigned> (_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, code))) & want;
+
+            if (got != want) return i + __builtin_ctz (~got & want) / stride_;
+        }
+
+        return runSse2 (s_ + i * stride_, n_ - i, stride_, code_) + i;
+    }
+
+    /**************************************************************************/
+
+    /**
+     * The byte shuffle needs AVX-512BW on top of the foundation
+     */
+    __attribute__ ((target ("avx512f,avx512bw")))
+    void
+    swap32Avx512 (const char * in_, size_t n_, int64_t * out_) {
+        const auto mask = _mm512_broadcast_i32x4 (_mm_setr_epi8 (
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+
+        size_t i { 0 };
+
+        for (; i + 16 <= n_ ; i += 16) {
+            auto v = _mm512_shuffle_epi8 (
+                    _mm512_loadu_si512 (in_ + 4 * i),
+                    mask);
+
+            _mm512_storeu_si512 (out_ + i, _mm512_cvtepi32_epi64 (_mm512_castsi512_si256 (v)));
+            _mm512_storeu_si512 (out_ + i + 8, _mm512_cvtepi32_epi64 (_mm512_extracti64x4_epi64 (v, 1)));
+        }
+
+        swap32Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx512f,avx512bw")))
+    void
+    swap64Avx512 (const char * in_, size_t n_, void * out_) {
+        const auto mask = _mm512_broadcast_i32x4 (_mm_setr_epi8 (
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 8 <= n_ ; i += 8) {
+            _mm512_storeu_si512 (
+                    out + 8 * i,
+                    _mm512_shuffle_epi8 (_mm512_loadu_si512 (in_ + 8 * i), mask));
+        }
+
+        swap64Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx512f,avx512bw")))
+    void
+    reverse32Avx512 (const char * in_, size_t n_, void * out_) {
+        const auto mask = _mm512_broadcast_i32x4 (_mm_setr_epi8 (
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+
+        auto * out = static_cast<char *>(out_);
+        size_t i { 0 };
+
+        for (; i + 16 <= n_ ; i += 16) {
+            _mm512_storeu_si512 (
+                    out + 4 * i,
+                    _mm512_shuffle_epi8 (_mm512_loadu_si512 (in_ + 4 * i), mask));
+        }
+
+        reverse32Tail (in_, i, n_, out_);
+    }
+
+    __attribute__ ((target ("avx512f,avx512bw")))
+    size_t
+    plainAvx512 (const char * s_, size_t n_) {
+        const auto space = _mm512_set1_epi8 (0x20);
+        const auto quote = _mm512_set1_epi8 ('"');
+        const auto backslash = _mm512_set1_epi8 ('\\');
+
+        size_t i { 0 };
+
+        for (; i + 64 <= n_ ; i += 64) {
+            auto v = _mm512_loadu_si512 (s_ + i);
+
+            auto mask = _mm512_cmplt_epi8_mask (v, space)
+                | _mm512_cmpeq_epi8_mask (v, quote)
+                | _mm512_cmpeq_epi8_mask (v, backslash);
+
+            if (mask) return i + __builtin_ctzll (mask);
+        }
+
+        return plainAvx2 (s_ + i, n_ - i) + i;
+    }
+
+    __attribute__ ((target ("avx512f,avx512bw")))
+    size_t
+    runAvx512 (const char * s_, size_t n_, size_t stride_, uint8_t code_) {
+        size_t per;
+        const auto want = leads (stride_, 64, per);
+        const auto code = _mm512_set1_epi8 (static_cast<char> (code_));
+
+        size_t i { 0 };
+
+        for (; per > 0 && i * stride_ + 64 <= n_ * stride_ ; i += per) {
+            auto got = _mm512_cmpeq_epi8_mask (_mm512_loadu_si512 (s_ + i * stride_), code) & want;
+
+            if (got != want) return i + __builtin_ctzll (~got & want) / stride_;
+        }
+
+        return runAvx2 (s_ + i * stride_, n_ - i, stride_, code_) + i;
+    }
+
+    const Table sse2Table { sse2_t, swap32Sse2, swap64Sse2, reverse32Sse2, plainSse2, runSse2 };
+    const Table avx2Table { avx2_t, swap32Avx2, swap64Avx2, reverse32Avx2, plainAvx2, runAvx2 };
+    const Table avx512Table { avx512_t, swap32Avx512, swap64Avx512, reverse32Avx512, plainAvx512, runAvx512 };
+
+}
+
+/******************************************************************************/
+
+const amqp::internal::kernels::Table * const amqp::internal::kernels::sse2 { &sse2Table };
+const amqp::internal::kernels::Table * const amqp::internal::kernels::avx2 { &avx2Table };
+const amqp::internal::kernels::Table * const amqp::internal::kernels::avx512 { &avx512Table };
+
+#else
+
+const amqp::internal::kernels::Table * const amqp::internal::kernels::sse2 { nullptr };
+const amqp::internal::kernels::Table * const amqp::internal::kernels::avx2 { nullptr };
+const amqp::internal::kernels::Table * const amqp::internal::kernels::avx512 { nullptr };
+
+#endif
+
+/******************************************************************************/
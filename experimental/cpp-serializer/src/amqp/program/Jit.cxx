@@ -0,0 +1,230 @@
+#include "Jit.h"
+
+#include <string>
+#include <cstdlib>
+
+#ifdef HAVE_LLVM
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/TargetSelect.h>
+#endif
+
+/******************************************************************************/
+
+namespace {
+
+    thread_local std::exception_ptr failed;
+
+#ifdef HAVE_LLVM
+
+    /**
+     * One for the process, never destroyed so a program released at
+     * exit can still release its code
+     */
+    struct Engine {
+        std::mutex m_lock;
+        std::unique_ptr<llvm::orc::LLJIT> m_jit;
+        uint64_t m_functions { 0 };
+    };
+
+    Engine *
+    engine() {
+        static Engine * rtn = []() -> Engine * {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+
+            auto jit = llvm::orc::LLJITBuilder().create();
+
+            if (!jit) {
+                llvm::consumeError (jit.takeError());
+                return nullptr;
+            }
+
+            auto * engine = new Engine;
+            engine->m_jit = std::move (*jit);
+
+            return engine;
+        }();
+
+        return rtn;
+    }
+
+#endif
+
+}
+
+/******************************************************************************/
+
+std::atomic<uint32_t> amqp::internal::program::Jit::s_threshold { HOT };
+std::atomic<bool> amqp::internal::program::Jit::s_chosen { false };
+
+/******************************************************************************/
+
+bool
+amqp::internal::program::
+Jit::available() {
+#ifdef HAVE_LLVM
+    return engine() != nullptr;
+#else
+    return false;
+#endif
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::program::
+Jit::select() {
+    static std::once_flag once;
+
+    std::call_once (once, [] {
+        uint32_t threshold { available() ? HOT : 0 };
+
+        if (const char * env = std::getenv ("AMQP_JIT"); env && threshold) {
+            threshold = std::string ("off") == env
+                ? 0
+                : static_cast<uint32_t> (std::strtoul (env, nullptr, 10));
+        }
+
+        s_threshold.store (threshold, std::memory_order_relaxed);
+        s_chosen.store (true, std::memory_order_release);
+    });
+
+    return s_threshold.load (std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Jit::threshold (uint32_t threshold_) {
+    select();
+
+    s_threshold.store (available() ? threshold_ : 0, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Jit::fail (std::exception_ptr exception_) noexcept {
+    failed = std::move (exception_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Jit::rethrow() {
+    auto exception = std::move (failed);
+    failed = nullptr;
+
+    std::rethrow_exception (exception);
+}
+
+/******************************************************************************/
+
+/**
+ * Each step and key is called and passed by its address, as a constant,
+ * so nothing has to be looked up by name when the module's linked
+ */
+amqp::internal::program::Jit::Fields
+amqp::internal::program::
+Jit::compile (Code & code_, const std::vector<Field> & fields_) {
+#ifdef HAVE_LLVM
+    auto * engine = ::engine();
+
+    if (!engine) return nullptr;
+
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = std::make_unique<llvm::Module> ("plan", *context);
+
+    auto * pointer = llvm::Type::getInt8PtrTy (*context);
+    auto * i1 = llvm::Type::getInt1Ty (*context);
+    auto * i32 = llvm::Type::getInt32Ty (*context);
+    auto * i64 = llvm::Type::getInt64Ty (*context);
+
+    auto * stepType = llvm::FunctionType::get (i1, { pointer, i32, pointer, pointer, pointer }, false);
+    auto * fieldsType = llvm::FunctionType::get (i1, { pointer, pointer, pointer }, false);
+
+    std::lock_guard<std::mutex> lock (engine->m_lock);
+
+    auto name = "fields" + std::to_string (engine->m_functions++);
+
+    auto * function = llvm::Function::Create (
+            fieldsType, llvm::Function::ExternalLinkage, name, module.get());
+    function->addFnAttr (llvm::Attribute::NoUnwind);
+
+    auto * program = function->getArg (0);
+    auto * cursor = function->getArg (1);
+    auto * sink = function->getArg (2);
+
+    auto * fail = llvm::BasicBlock::Create (*context, "fail", function);
+    auto * block = llvm::BasicBlock::Create (*context, "entry", function, fail);
+
+    llvm::IRBuilder<> builder (block);
+
+    for (const auto & field : fields_) {
+        auto * step = llvm::ConstantExpr::getIntToPtr (
+                llvm::ConstantInt::get (i64, reinterpret_cast<uintptr_t> (field.m_step)),
+                stepType->getPointerTo());
+
+        auto * key = llvm::ConstantExpr::getIntToPtr (
+                llvm::ConstantInt::get (i64, reinterpret_cast<uintptr_t> (field.m_key)),
+                pointer);
+
+        auto * ok = builder.CreateCall (stepType, step, {
+                program, llvm::ConstantInt::get (i32, field.m_pc), key, cursor, sink });
+
+        auto * next = llvm::BasicBlock::Create (*context, "field", function, fail);
+        builder.CreateCondBr (ok, next, fail);
+        builder.SetInsertPoint (next);
+    }
+
+    builder.CreateRet (llvm::ConstantInt::getTrue (*context));
+
+    builder.SetInsertPoint (fail);
+    builder.CreateRet (llvm::ConstantInt::getFalse (*context));
+
+    if (llvm::verifyFunction (*function)) return nullptr;
+
+    auto tracker = engine->m_jit->getMainJITDylib().createResourceTracker();
+
+    if (auto error = engine->m_jit->addIRModule (
+            tracker, llvm::orc::ThreadSafeModule (std::move (module), std::move (context))))
+    {
+        llvm::consumeError (std::move (error));
+        return nullptr;
+    }
+
+    auto symbol = engine->m_jit->lookup (name);
+
+    if (!symbol) {
+        llvm::consumeError (symbol.takeError());
+        llvm::consumeError (tracker->remove());
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> owned (code_.m_lock);
+
+        code_.m_modules.emplace_back (static_cast<void *> (nullptr), [engine, tracker](void *) {
+            std::lock_guard<std::mutex> lock (engine->m_lock);
+            llvm::consumeError (tracker->remove());
+        });
+    }
+
+    return reinterpret_cast<Fields> (static_cast<uintptr_t> (symbol->getAddress()));
+#else
+    (void) code_;
+    (void) fields_;
+
+    return nullptr;
+#endif
+}
+
+/******************************************************************************/
@@ -0,0 +1,131 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <exception>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::program::Jit
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::program {
+
+    class Program;
+
+    /**
+     * Compiles the fields of a hot composite's plan to native code, the
+     * handful of types that make up most of what's decoded paying for a
+     * switch per field no longer.
+     *
+     * Once a composite's been decoded [threshold] times by a program its
+     * run of field instructions is turned into a function of straight
+     * line calls, one per field, each to a step specialised for that
+     * field's op with its key and instruction baked in as constants. The
+     * composite's header, checking the descriptor and entering the list,
+     * is still run by the interpreter, as is anything that isn't a field
+     * of a hot composite, the interpreter always being what's fallen back
+     * on.
+     *
+     * Built on LLVM's ORC JIT when it was found at build time, otherwise
+     * [available] is false and nothing's ever compiled. The AMQP_JIT
+     * environment variable sets the threshold, "off" or 0 meaning never.
+     *
+     * No exception is ever thrown through native code. A step that fails
+     * stashes what it caught and returns false, the native code returning
+     * false in turn, for the interpreter to [rethrow] where it would have
+     * thrown itself.
+     */
+    class Jit {
+        public :
+            /**
+             * Decode the field at instruction [pc_], [key_] first
+             */
+            using Step = bool (*) (
+                const Program *,
+                uint32_t pc_,
+                const amqp::reader::ISink::Key * key_,
+                cursor::Cursor *,
+                amqp::reader::ISink *);
+
+            /**
+             * Decode every field of a composite, false should one fail
+             */
+            using Fields = bool (*) (const Program *, cursor::Cursor *, amqp::reader::ISink *);
+
+            struct Field {
+                Step m_step;
+                uint32_t m_pc;
+                const amqp::reader::ISink::Key * m_key;
+            };
+
+            /**
+             * The native code compiled for one program, released with it
+             */
+            struct Code {
+                std::mutex m_lock;
+                std::vector<std::shared_ptr<void>> m_modules;
+            };
+
+            static constexpr uint32_t HOT = 256;
+
+        private :
+            static std::atomic<uint32_t> s_threshold;
+            static std::atomic<bool> s_chosen;
+
+            static uint32_t select();
+
+        public :
+            /**
+             * Whether this build can compile anything at all
+             */
+            static bool available();
+
+            /**
+             * How many decodes of a composite make it hot, 0 if none ever
+             * are
+             */
+            static uint32_t threshold() {
+                return s_chosen.load (std::memory_order_acquire)
+                    ? s_threshold.load (std::memory_order_relaxed)
+                    : select();
+            }
+
+            /**
+             * For the programs compiled from then on
+             */
+            static void threshold (uint32_t);
+
+            /**
+             * A function running [fields_] in order, or null should it
+             * not compile, owned by [code_]
+             */
+            static Fields compile (Code & code_, const std::vector<Field> & fields_);
+
+            /**
+             * Held for [rethrow] by a step that failed
+             */
+            static void fail (std::exception_ptr) noexcept;
+
+            [[noreturn]] static void rethrow();
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,1099 @@
+#include "Program.h"
+
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "debug.h"
+
+#include "cursor/Cursor.h"
+#include "stats/Costs.h"
+#include "stats/Stats.h"
+#include "format/Text.h"
+#include "sink/JsonSink.h"
+#include "sink/CborSink.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+#include "reader/Reader.h"
+#include "reader/ObjectTable.h"
+#include "reader/CompositeReader.h"
+#include "reader/DispatchReader.h"
+#include "reader/restricted-readers/MapReader.h"
+#include "reader/restricted-readers/ListReader.h"
+#include "reader/restricted-readers/ArrayReader.h"
+#include "reader/restricted-readers/EnumReader.h"
+#include "amqp/reader/property-readers/IntPropertyReader.h"
+#include "amqp/reader/property-readers/BoolPropertyReader.h"
+#include "amqp/reader/property-readers/LongPropertyReader.h"
+#include "amqp/reader/property-readers/StringPropertyReader.h"
+#include "amqp/reader/property-readers/DoublePropertyReader.h"
+#include "amqp/reader/property-readers/BinaryPropertyReader.h"
+#include "amqp/reader/property-readers/CharPropertyReader.h"
+#include "amqp/reader/property-readers/ShortPropertyReader.h"
+#include "amqp/reader/property-readers/BytePropertyReader.h"
+#include "amqp/reader/property-readers/FloatPropertyReader.h"
+#include "amqp/reader/property-readers/TimestampPropertyReader.h"
+#include "amqp/reader/property-readers/UuidPropertyReader.h"
+#include "amqp/reader/property-readers/Decimal128PropertyReader.h"
+#include "amqp/reader/property-readers/SymbolPropertyReader.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::program::Compiler
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::program {
+
+    /**
+     * Walks the reader graph depth first, emitting a plan for each reader
+     * only after those of its children so every call in the program is to
+     * a plan that already exists. Readers shared between types share a
+     * plan, bar dispatches, which are cheap and emitted afresh wherever
+     * they're called from so each call site caches what it last saw.
+     *
+     * An interface whose types can hold it again, a tree say, can't be
+     * ordered that way and isn't compiled, its readers reading it instead
+     */
+    class Compiler {
+        private :
+            Program & m_program;
+            const schema::Schema & m_schema;
+
+            std::map<std::string, const schema::AMQPTypeNotation *> m_types;
+            std::map<const reader::Reader *, uint32_t> m_plans;
+            std::map<std::string, uint32_t> m_strings;
+
+            /**
+             * The dispatch readers whose candidates are being compiled
+             */
+            std::set<const reader::Reader *> m_open;
+
+            uint32_t string (const std::string &);
+            uint32_t emit (Instruction, const reader::Reader &);
+
+            static bool primitive (const reader::Reader &, Op_t &);
+
+            static const reader::Reader & child (
+                const reader::Reader *,
+                const reader::Reader &);
+
+        public :
+            Compiler (Program & program_, const schema::Schema & schema_)
+                : m_program (program_)
+                , m_schema (schema_)
+            {
+                for (const auto & i : m_schema) {
+                    for (const auto & j : i) {
+                        m_types.emplace (j->name(), j.get());
+                    }
+                }
+            }
+
+            uint32_t plan (const reader::Reader &);
+
+            Instruction field (const reader::Reader &);
+    };
+
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::program::
+Compiler::string (const std::string & string_) {
+    auto it = m_strings.find (string_);
+
+    if (it != m_strings.end()) {
+        return it->second;
+    }
+
+    auto idx = static_cast<uint32_t>(m_program.m_strings.size());
+    m_program.m_strings.push_back (string_);
+    m_strings.emplace (string_, idx);
+
+    return idx;
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::program::
+Compiler::emit (Instruction instruction_, const reader::Reader & reader_) {
+    m_program.m_code.push_back (instruction_);
+    m_program.m_readers.push_back (&reader_);
+    return static_cast<uint32_t>(m_program.m_code.size() - 1);
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::program::
+Compiler::primitive (const reader::Reader & reader_, Op_t & op_) {
+    if (dynamic_cast<const reader::IntPropertyReader *>(&reader_)) {
+        op_ = int_op;
+    } else if (dynamic_cast<const reader::LongPropertyReader *>(&reader_)) {
+        op_ = long_op;
+    } else if (dynamic_cast<const reader::BoolPropertyReader *>(&reader_)) {
+        op_ = bool_op;
+    } else if (dynamic_cast<const reader::DoublePropertyReader *>(&reader_)) {
+        op_ = double_op;
+    } else if (dynamic_cast<const reader::StringPropertyReader *>(&reader_)) {
+        op_ = string_op;
+    } else if (dynamic_cast<const reader::BinaryPropertyReader *>(&reader_)) {
+        op_ = binary_op;
+    } else if (dynamic_cast<const reader::CharPropertyReader *>(&reader_)) {
+        op_ = char_op;
+    } else if (dynamic_cast<const reader::ShortPropertyReader *>(&reader_)) {
+        op_ = short_op;
+    } else if (dynamic_cast<const reader::BytePropertyReader *>(&reader_)) {
+        op_ = byte_op;
+    } else if (dynamic_cast<const reader::FloatPropertyReader *>(&reader_)) {
+        op_ = float_op;
+    } else if (dynamic_cast<const reader::TimestampPropertyReader *>(&reader_)) {
+        op_ = timestamp_op;
+    } else if (dynamic_cast<const reader::UuidPropertyReader *>(&reader_)) {
+        op_ = uuid_op;
+    } else if (dynamic_cast<const reader::Decimal128PropertyReader *>(&reader_)) {
+        op_ = decimal128_op;
+    } else if (dynamic_cast<const reader::SymbolPropertyReader *>(&reader_)) {
+        op_ = symbol_op;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************/
+
+const amqp::internal::reader::Reader &
+amqp::internal::program::
+Compiler::child (
+    const reader::Reader * child_,
+    const reader::Reader & parent_
+) {
+    if (child_) {
+        // the factory that built the graph keeps it alive for us
+        return *child_;
+    }
+
+    throw std::runtime_error ("null reader beneath " + parent_.type());
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Instruction
+amqp::internal::program::
+Compiler::field (const reader::Reader & reader_) {
+    Op_t op;
+
+    if (primitive (reader_, op)) {
+        return { op, 0, 0 };
+    }
+
+    return { call_op, plan (reader_), 0 };
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::program::
+Compiler::plan (const reader::Reader & reader_) {
+    auto it = m_plans.find (&reader_);
+
+    if (it != m_plans.end()) {
+        return it->second;
+    }
+
+    DBG ("Compile: " << reader_.type() << std::endl); // NOLINT
+
+    uint32_t rtn;
+    Op_t op;
+
+    if (primitive (reader_, op)) {
+        rtn = emit ({ op, 0, 0 }, reader_);
+    } else if (auto composite = dynamic_cast<const reader::CompositeReader *>(&reader_)) {
+        std::vector<Instruction> fields;
+        std::vector<const reader::Reader *> readers;
+        fields.reserve (composite->readers().size());
+        readers.reserve (composite->readers().size());
+
+        for (const auto & r : composite->readers()) {
+            readers.push_back (&child (r, reader_));
+            fields.push_back (field (*readers.back()));
+        }
+
+        auto type = m_types.find (reader_.type());
+
+        if (type == m_types.end()) {
+            throw std::runtime_error ("No schema for " + reader_.type());
+        }
+
+        const auto & notation = *type->second;
+        const auto & names = dynamic_cast<const schema::Composite &> (notation).fields();
+
+        if (names.size() != fields.size()) {
+            throw std::runtime_error ("Field mismatch compiling " + reader_.type());
+        }
+
+        rtn = emit ({
+            composite_op,
+            static_cast<uint32_t>(fields.size()),
+            string (notation.descriptor()) },
+            reader_);
+
+        for (size_t i { 0 } ; i < fields.size() ; ++i) {
+            fields[i].m_value = string (names[i]->name());
+            emit (fields[i], *readers[i]);
+        }
+    } else if (auto list = dynamic_cast<const reader::ListReader *>(&reader_)) {
+        rtn = emit ({ list_op, plan (child (list->reader(), reader_)), 0 }, reader_);
+    } else if (auto array = dynamic_cast<const reader::ArrayReader *>(&reader_)) {
+        auto elements = plan (child (array->reader(), reader_));
+
+        rtn = array->primitive() == reader::ArrayReader::none_t
+            ? emit ({ list_op, elements, 0 }, reader_)
+            : emit ({ array_op, elements, array->primitive() }, reader_);
+    } else if (auto map = dynamic_cast<const reader::MapReader *>(&reader_)) {
+        auto key = plan (child (map->keyReader(), reader_));
+        auto value = plan (child (map->valueReader(), reader_));
+
+        rtn = emit ({ map_op, key, value }, reader_);
+    } else if (dynamic_cast<const reader::EnumReader *>(&reader_)) {
+        rtn = emit ({ enum_op, 0, 0 }, reader_);
+    } else if (auto dispatch = dynamic_cast<const reader::DispatchReader *>(&reader_)) {
+        if (!m_open.insert (&reader_).second) {
+            throw std::runtime_error ("Cannot compile the recursive " + reader_.type());
+        }
+
+        std::vector<std::pair<const reader::Reader *, Instruction>> calls;
+        calls.reserve (dispatch->candidates().size());
+
+        for (const auto & candidate : dispatch->candidates()) {
+            const auto & reader = child (candidate.m_reader, reader_);
+
+            calls.emplace_back (&reader, Instruction {
+                call_op, plan (reader), string (candidate.m_descriptor) });
+        }
+
+        m_open.erase (&reader_);
+
+        rtn = emit ({
+            dispatch_op,
+            static_cast<uint32_t>(calls.size()),
+            m_program.m_sites++ },
+            reader_);
+
+        for (const auto & call : calls) {
+            emit (call.second, *call.first);
+        }
+
+        // every site gets a dispatch, and so a cache, of its own
+        return rtn;
+    } else {
+        throw std::runtime_error ("Cannot compile a reader for " + reader_.type());
+    }
+
+    m_plans.emplace (&reader_, rtn);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+namespace {
+
+    using namespace amqp::internal;
+    using namespace amqp::internal::program;
+
+    /**
+     * Each mirrors the [write] of the property reader it was compiled
+     * from
+     */
+    template<Op_t op>
+    inline void
+    primitive (cursor::Cursor & data_, amqp::reader::ISink & sink_) {
+        if constexpr (op == int_op) {
+            sink_.integer (cursor::readAndNext<int32_t> (data_));
+        } else if constexpr (op == long_op) {
+            sink_.integer (cursor::readAndNext<int64_t> (data_));
+        } else if constexpr (op == bool_op) {
+            sink_.boolean (cursor::readAndNext<bool> (data_));
+        } else if constexpr (op == double_op) {
+            sink_.real (cursor::readAndNext<double> (data_));
+        } else if constexpr (op == string_op) {
+            stats::Stats::count (stats::Stats::strings_t);
+            sink_.string (cursor::readAndNext<std::string_view> (data_));
+        } else if constexpr (op == binary_op) {
+            cursor::is_type (data_, cursor::binary_t);
+            cursor::auto_next an (data_);
+            sink_.binary (data_.get_binary());
+        } else if constexpr (op == char_op) {
+            sink_.string (format::Utf8 (cursor::readAndNext<char32_t> (data_)).view());
+        } else if constexpr (op == short_op) {
+            sink_.integer (cursor::readAndNext<int16_t> (data_));
+        } else if constexpr (op == byte_op) {
+            sink_.integer (cursor::readAndNext<int8_t> (data_));
+        } else if constexpr (op == float_op) {
+            sink_.real (cursor::readAndNext<float> (data_));
+        } else if constexpr (op == timestamp_op) {
+            cursor::is_type (data_, cursor::timestamp_t);
+            cursor::auto_next an (data_);
+            sink_.string (format::Iso8601 (data_.get_timestamp()).view());
+        } else if constexpr (op == uuid_op) {
+            cursor::is_type (data_, cursor::uuid_t);
+            cursor::auto_next an (data_);
+            sink_.string (format::Uuid (data_.get_fixed16().data()).view());
+        } else if constexpr (op == decimal128_op) {
+            cursor::is_type (data_, cursor::decimal128_t);
+            cursor::auto_next an (data_);
+            sink_.string (format::Decimal (data_.get_fixed16().data()).view());
+        } else {
+            static_assert (op == symbol_op, "not a primitive");
+
+            cursor::is_type (data_, cursor::symbol_t);
+            cursor::auto_next an (data_);
+            sink_.symbol (data_.get_symbol());
+        }
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::program::Program
+ *
+ ******************************************************************************/
+
+amqp::internal::program::
+Program::Program() : m_schema (nullptr), m_sites (0), m_entry (0), m_threshold (0) {
+
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Program
+amqp::internal::program::
+Program::compile (
+    const reader::Reader & root_,
+    const schema::Schema & schema_
+) {
+    Program rtn;
+
+    rtn.m_schema = &schema_;
+    rtn.m_entry = Compiler (rtn, schema_).plan (root_);
+    rtn.m_caches = std::make_unique<std::atomic<uint32_t>[]> (rtn.m_sites);
+    rtn.render();
+
+    rtn.m_threshold = Jit::threshold();
+
+    if (rtn.m_threshold > 0) {
+        rtn.m_hot = std::make_unique<Hot[]> (rtn.m_code.size());
+        rtn.m_native = std::make_unique<Jit::Code>();
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * Rendered all at once so nothing the keys view moves afterwards, moving
+ * the program itself moving neither the strings nor the renderings
+ */
+void
+amqp::internal::program::
+Program::render() {
+    std::vector<bool> keys (m_strings.size());
+
+    for (size_t pc { 0 } ; pc < m_code.size() ; ++pc) {
+        if (m_code[pc].m_op != composite_op) continue;
+
+        for (uint32_t i { 1 } ; i <= m_code[pc].m_child ; ++i) {
+            keys[m_code[pc + i].m_value] = true;
+        }
+
+        pc += m_code[pc].m_child;
+    }
+
+    std::vector<std::pair<size_t, size_t>> json, cbor;
+
+    for (size_t i { 0 } ; i < m_strings.size() ; ++i) {
+        if (!keys[i]) continue;
+
+        auto j = sink::JsonSink::render (m_strings[i]);
+        json.emplace_back (m_rendered.size(), j.size());
+        m_rendered.insert (m_rendered.end(), j.begin(), j.end());
+
+        auto c = sink::CborSink::render (m_strings[i]);
+        cbor.emplace_back (m_rendered.size(), c.size());
+        m_rendered.insert (m_rendered.end(), c.begin(), c.end());
+    }
+
+    m_keys.reserve (m_strings.size());
+
+    for (size_t i { 0 }, k { 0 } ; i < m_strings.size() ; ++i) {
+        amqp::reader::ISink::Key key { m_strings[i], { }, { } };
+
+        if (keys[i]) {
+            key.m_json = { m_rendered.data() + json[k].first, json[k].second };
+            key.m_cbor = { m_rendered.data() + cbor[k].first, cbor[k].second };
+            ++k;
+        }
+
+        m_keys.push_back (key);
+    }
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::program::
+Program::bytes() const {
+    auto rtn = sizeof (*this)
+            + m_code.capacity() * sizeof (Instruction)
+            + m_strings.capacity() * sizeof (std::string)
+            + m_keys.capacity() * sizeof (amqp::reader::ISink::Key)
+            + m_rendered.capacity()
+            + m_readers.capacity() * sizeof (const reader::Reader *)
+            + m_sites * sizeof (std::atomic<uint32_t>)
+            + (m_hot ? m_code.size() * sizeof (Hot) : 0);
+
+    for (const auto & string : m_strings) rtn += string.capacity();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Program::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_
+) const {
+    exec (m_entry, data_, sink_);
+}
+
+/******************************************************************************/
+
+/**
+ * Each case mirrors the [write] of the reader it was compiled from
+ */
+void
+amqp::internal::program::
+Program::exec (
+    uint32_t pc_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_
+) const {
+    const auto & op = m_code[pc_];
+
+    switch (op.m_op) {
+        case int_op : primitive<int_op> (data_, sink_); break;
+        case long_op : primitive<long_op> (data_, sink_); break;
+        case bool_op : primitive<bool_op> (data_, sink_); break;
+        case double_op : primitive<double_op> (data_, sink_); break;
+        case string_op : primitive<string_op> (data_, sink_); break;
+        case binary_op : primitive<binary_op> (data_, sink_); break;
+        case char_op : primitive<char_op> (data_, sink_); break;
+        case short_op : primitive<short_op> (data_, sink_); break;
+        case byte_op : primitive<byte_op> (data_, sink_); break;
+        case float_op : primitive<float_op> (data_, sink_); break;
+        case timestamp_op : primitive<timestamp_op> (data_, sink_); break;
+        case uuid_op : primitive<uuid_op> (data_, sink_); break;
+        case decimal128_op : primitive<decimal128_op> (data_, sink_); break;
+        case symbol_op : primitive<symbol_op> (data_, sink_); break;
+        case call_op :
+            exec (op.m_child, data_, sink_);
+            break;
+        case composite_op : {
+            stats::Costs::Scope cost (m_readers[pc_]->type(), data_);
+
+            cursor::auto_next an (data_);
+            cursor::is_described (data_);
+            cursor::auto_enter ae (data_);
+
+            if (cursor::get_symbol<std::string_view> (data_) != m_strings[op.m_value]) {
+                std::stringstream ss;
+                ss << "Expected a " << m_strings[op.m_value]
+                   << " but found a " << data_.get_symbol();
+                throw std::runtime_error (ss.str());
+            }
+
+            data_.next();
+
+            cursor::is_list (data_);
+            cursor::auto_enter ae2 (data_);
+
+            stats::Stats::count (stats::Stats::objects_t);
+            stats::Stats::count (stats::Stats::fields_t, op.m_child);
+
+            sink_.beginObject();
+
+            if (auto native = hot (pc_)) {
+                if (!native (this, &data_, &sink_)) Jit::rethrow();
+            } else {
+                for (uint32_t i { 1 } ; i <= op.m_child ; ++i) {
+                    sink_.key (m_keys[m_code[pc_ + i].m_value]);
+                    if (m_hot) profile (pc_ + i, data_);
+                    value (pc_ + i, data_, sink_, false);
+                }
+            }
+
+            sink_.endObject();
+            break;
+        }
+        case array_op :
+        case list_op : {
+            cursor::auto_next an (data_);
+            cursor::is_described (data_);
+            cursor::auto_enter ae (data_);
+            cursor::readAndNext<std::string_view> (data_);
+
+            if (op.m_op == array_op && reader::ArrayReader::writeBulk (
+                    static_cast<reader::ArrayReader::Primitive> (op.m_value), data_, sink_))
+            {
+                break;
+            }
+
+            cursor::auto_list_enter ale (data_, true);
+
+            stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+            if (m_hot) collection (pc_, ale.elements());
+
+            sink_.beginList();
+            for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+                if (m_hot) profile (pc_, data_);
+                value (op.m_child, data_, sink_, true);
+            }
+            sink_.endList();
+            break;
+        }
+        case map_op : {
+            cursor::auto_next an (data_);
+            cursor::is_described (data_);
+            cursor::auto_enter ae (data_);
+            cursor::readAndNext<std::string_view> (data_);
+
+            cursor::auto_map_enter am (data_, true);
+
+            stats::Stats::count (stats::Stats::entries_t, am.elements() / 2);
+
+            if (m_hot) collection (pc_, am.elements() / 2);
+
+            sink_.beginMap();
+            for (size_t i { 0 } ; i < am.elements() ; i += 2) {
+                value (op.m_child, data_, sink_, true);
+                value (op.m_value, data_, sink_, true);
+            }
+            sink_.endMap();
+            break;
+        }
+        case dispatch_op : {
+            auto descriptor = reader::DispatchReader::descriptor (data_);
+
+            auto & cache = m_caches[op.m_value];
+            auto hit = cache.load (std::memory_order_relaxed);
+
+            if (m_strings[m_code[pc_ + 1 + hit].m_value] != descriptor) {
+                hit = 0;
+                while (hit < op.m_child && m_strings[m_code[pc_ + 1 + hit].m_value] != descriptor) {
+                    ++hit;
+                }
+
+                if (hit == op.m_child) {
+                    std::stringstream ss;
+                    ss << "No type providing " << m_readers[pc_]->type()
+                       << " is described by \"" << descriptor << "\"";
+                    throw std::runtime_error (ss.str());
+                }
+
+                cache.store (hit, std::memory_order_relaxed);
+            }
+
+            exec (m_code[pc_ + 1 + hit].m_child, data_, sink_);
+            break;
+        }
+        case enum_op : {
+            cursor::auto_next an (data_);
+
+            sink_.symbol (static_cast<const reader::EnumReader *> (
+                    m_readers[pc_])->choice (data_).m_name);
+            break;
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Program::value (
+    uint32_t pc_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    bool element_
+) const {
+    if (cursor::skip_null (data_)) {
+        sink_.null();
+        return;
+    }
+
+    if (reader::ObjectTable::writeReference (data_, sink_, *m_schema)) return;
+
+    if (!reader::ObjectTable::current()) {
+        exec (pc_, data_, sink_);
+        return;
+    }
+
+    auto encoded = data_.encoded();
+    exec (pc_, data_, sink_);
+
+    reader::ObjectTable::written (encoded, *m_readers[pc_], element_);
+}
+
+/******************************************************************************/
+
+/**
+ * [value] with what [exec] would have run given as [run_]
+ */
+template<amqp::internal::program::Op_t op, class Run>
+void
+amqp::internal::program::
+Program::field (
+    uint32_t pc_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    Run && run_
+) const {
+    if (cursor::skip_null (data_)) {
+        sink_.null();
+        return;
+    }
+
+    if (reader::ObjectTable::writeReference (data_, sink_, *m_schema)) return;
+
+    if (!reader::ObjectTable::current()) {
+        run_();
+        return;
+    }
+
+    auto encoded = data_.encoded();
+    run_();
+
+    reader::ObjectTable::written (encoded, *m_readers[pc_], false);
+}
+
+/******************************************************************************/
+
+/**
+ * Mirrors [exec]'s list, bar the elements with the constructor guarded
+ * for, which can be neither references nor numbered
+ */
+template<amqp::internal::program::Op_t op>
+void
+amqp::internal::program::
+Program::elements (
+    uint32_t pc_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view> (data_);
+
+    cursor::auto_list_enter ale (data_, true);
+
+    stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+    const auto guard = m_hot[pc_].m_guard.load (std::memory_order_relaxed);
+    const auto element = m_code[pc_].m_child;
+
+    sink_.beginList();
+    for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+        if (data_.constructor() == guard) {
+            primitive<op> (data_, sink_);
+        } else {
+            value (element, data_, sink_, true);
+        }
+    }
+    sink_.endList();
+}
+
+/******************************************************************************/
+
+template<amqp::internal::program::Op_t op>
+bool
+amqp::internal::program::
+Program::step (
+    const Program * program_,
+    uint32_t pc_,
+    const amqp::reader::ISink::Key * key_,
+    cursor::Cursor * data_,
+    amqp::reader::ISink * sink_
+) noexcept {
+    try {
+        sink_->key (*key_);
+        program_->field<op> (pc_, *data_, *sink_, [=]() {
+            if constexpr (op == call_op) {
+                program_->exec (program_->m_code[pc_].m_child, *data_, *sink_);
+            } else {
+                primitive<op> (*data_, *sink_);
+            }
+        });
+
+        return true;
+    } catch (...) {
+        Jit::fail (std::current_exception());
+
+        return false;
+    }
+}
+
+/******************************************************************************/
+
+template<amqp::internal::program::Op_t op>
+bool
+amqp::internal::program::
+Program::quick (
+    const Program * program_,
+    uint32_t pc_,
+    const amqp::reader::ISink::Key * key_,
+    cursor::Cursor * data_,
+    amqp::reader::ISink * sink_
+) noexcept {
+    if (data_->constructor() != program_->m_hot[pc_].m_guard.load (std::memory_order_relaxed)) {
+        return step<op> (program_, pc_, key_, data_, sink_);
+    }
+
+    try {
+        sink_->key (*key_);
+        primitive<op> (*data_, *sink_);
+
+        return true;
+    } catch (...) {
+        Jit::fail (std::current_exception());
+
+        return false;
+    }
+}
+
+/******************************************************************************/
+
+template<amqp::internal::program::Op_t op>
+bool
+amqp::internal::program::
+Program::listed (
+    const Program * program_,
+    uint32_t pc_,
+    const amqp::reader::ISink::Key * key_,
+    cursor::Cursor * data_,
+    amqp::reader::ISink * sink_
+) noexcept {
+    try {
+        sink_->key (*key_);
+        program_->field<call_op> (pc_, *data_, *sink_, [=]() {
+            program_->elements<op> (program_->m_code[pc_].m_child, *data_, *sink_);
+        });
+
+        return true;
+    } catch (...) {
+        Jit::fail (std::current_exception());
+
+        return false;
+    }
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::program::
+Program::absent (
+    const Program * program_,
+    uint32_t pc_,
+    const amqp::reader::ISink::Key * key_,
+    cursor::Cursor * data_,
+    amqp::reader::ISink * sink_
+) noexcept {
+    if (data_->constructor() != 0x40) {
+        return step (program_->m_code[pc_].m_op) (program_, pc_, key_, data_, sink_);
+    }
+
+    try {
+        sink_->key (*key_);
+        sink_->null();
+        data_->next();
+
+        return true;
+    } catch (...) {
+        Jit::fail (std::current_exception());
+
+        return false;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Jit::Step
+amqp::internal::program::
+Program::step (Op_t op_) {
+    switch (op_) {
+        case int_op : return &step<int_op>;
+        case long_op : return &step<long_op>;
+        case bool_op : return &step<bool_op>;
+        case double_op : return &step<double_op>;
+        case string_op : return &step<string_op>;
+        case binary_op : return &step<binary_op>;
+        case char_op : return &step<char_op>;
+        case short_op : return &step<short_op>;
+        case byte_op : return &step<byte_op>;
+        case float_op : return &step<float_op>;
+        case timestamp_op : return &step<timestamp_op>;
+        case uuid_op : return &step<uuid_op>;
+        case decimal128_op : return &step<decimal128_op>;
+        case symbol_op : return &step<symbol_op>;
+        case call_op : return &step<call_op>;
+        default : return nullptr;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Jit::Step
+amqp::internal::program::
+Program::quick (Op_t op_) {
+    switch (op_) {
+        case int_op : return &quick<int_op>;
+        case long_op : return &quick<long_op>;
+        case bool_op : return &quick<bool_op>;
+        case double_op : return &quick<double_op>;
+        case string_op : return &quick<string_op>;
+        case binary_op : return &quick<binary_op>;
+        case char_op : return &quick<char_op>;
+        case short_op : return &quick<short_op>;
+        case byte_op : return &quick<byte_op>;
+        case float_op : return &quick<float_op>;
+        case timestamp_op : return &quick<timestamp_op>;
+        case uuid_op : return &quick<uuid_op>;
+        case decimal128_op : return &quick<decimal128_op>;
+        case symbol_op : return &quick<symbol_op>;
+        default : return nullptr;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Jit::Step
+amqp::internal::program::
+Program::listed (Op_t op_) {
+    switch (op_) {
+        case int_op : return &listed<int_op>;
+        case long_op : return &listed<long_op>;
+        case bool_op : return &listed<bool_op>;
+        case double_op : return &listed<double_op>;
+        case string_op : return &listed<string_op>;
+        case binary_op : return &listed<binary_op>;
+        case char_op : return &listed<char_op>;
+        case short_op : return &listed<short_op>;
+        case byte_op : return &listed<byte_op>;
+        case float_op : return &listed<float_op>;
+        case timestamp_op : return &listed<timestamp_op>;
+        case uuid_op : return &listed<uuid_op>;
+        case decimal128_op : return &listed<decimal128_op>;
+        case symbol_op : return &listed<symbol_op>;
+        default : return nullptr;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Jit::Fields
+amqp::internal::program::
+Program::hot (uint32_t pc_) const {
+    if (!m_hot) return nullptr;
+
+    auto & hot = m_hot[pc_];
+
+    if (auto rtn = hot.m_native.load (std::memory_order_acquire)) return rtn;
+
+    // only the decode that makes it hot compiles it, the rest carry on
+    if (hot.m_heat.fetch_add (1, std::memory_order_relaxed) + 1 != m_threshold) return nullptr;
+
+    std::vector<Jit::Field> fields;
+    fields.reserve (m_code[pc_].m_child);
+
+    for (uint32_t i { 1 } ; i <= m_code[pc_].m_child ; ++i) {
+        auto step = specialise (pc_ + i);
+
+        if (!step) return nullptr;
+
+        fields.push_back ({ step, pc_ + i, &m_keys[m_code[pc_ + i].m_value] });
+    }
+
+    auto rtn = Jit::compile (*m_native, fields);
+
+    if (rtn) hot.m_native.store (rtn, std::memory_order_release);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::program::
+Program::natives() const {
+    if (!m_native) return 0;
+
+    std::lock_guard<std::mutex> lock (m_native->m_lock);
+
+    return m_native->m_modules.size();
+}
+
+/******************************************************************************/
+
+/**
+ * Only what can't be a reference, a constructor that's neither described
+ * nor null, is guarded for, and only for what the object table wouldn't
+ * number
+ */
+amqp::internal::program::Jit::Step
+amqp::internal::program::
+Program::specialise (uint32_t pc_) const {
+    auto guardable = [this](uint32_t pc_, bool element_) {
+        auto constructor = m_hot[pc_].m_constructor.load (std::memory_order_relaxed);
+
+        if (constructor >= UNSEEN || constructor == 0x00 || constructor == 0x40) return false;
+        if (m_readers[pc_]->referenceable (element_)) return false;
+
+        m_hot[pc_].m_guard.store (constructor, std::memory_order_relaxed);
+
+        return true;
+    };
+
+    const auto & field = m_code[pc_];
+
+    auto seen = m_hot[pc_].m_seen.load (std::memory_order_relaxed);
+
+    if (seen > 0 && m_hot[pc_].m_nulls.load (std::memory_order_relaxed) == seen && step (field.m_op)) {
+        return &absent;
+    }
+
+    if (field.m_op <= symbol_op) {
+        return guardable (pc_, false) ? quick (field.m_op) : step (field.m_op);
+    }
+
+    const auto & callee = m_code[field.m_child];
+
+    if (field.m_op == call_op
+        && callee.m_op == list_op
+        && m_code[callee.m_child].m_op <= symbol_op
+        && m_hot[field.m_child].m_constructor.load (std::memory_order_relaxed) < UNSEEN)
+    {
+        // the list's elements are profiled against the list, numbered by their own reader
+        auto constructor = m_hot[field.m_child].m_constructor.load (std::memory_order_relaxed);
+
+        if (constructor != 0x00 && constructor != 0x40 && !m_readers[callee.m_child]->referenceable (true)) {
+            m_hot[field.m_child].m_guard.store (constructor, std::memory_order_relaxed);
+
+            return listed (m_code[callee.m_child].m_op);
+        }
+    }
+
+    return step (field.m_op);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Program::profile (uint32_t pc_, const cursor::Cursor & data_) const {
+    auto & hot = m_hot[pc_];
+
+    if (hot.m_seen.load (std::memory_order_relaxed) >= m_threshold) return;
+
+    hot.m_seen.fetch_add (1, std::memory_order_relaxed);
+
+    uint16_t constructor = data_.constructor();
+    auto seen = hot.m_constructor.load (std::memory_order_relaxed);
+
+    if (seen == UNSEEN && hot.m_constructor.compare_exchange_strong (seen, constructor)) {
+        seen = constructor;
+    }
+
+    if (seen != constructor && seen != MIXED) {
+        hot.m_constructor.store (MIXED, std::memory_order_relaxed);
+    }
+
+    switch (data_.type()) {
+        case cursor::null_t :
+            hot.m_nulls.fetch_add (1, std::memory_order_relaxed);
+            break;
+        case cursor::described_t :
+            if (reader::ObjectTable::isReference (data_)) {
+                hot.m_references.fetch_add (1, std::memory_order_relaxed);
+            }
+            break;
+        case cursor::string_t :
+        case cursor::symbol_t :
+        case cursor::binary_t :
+            // the size's width, one byte or four, follows the constructor
+            hot.m_sized.fetch_add (1, std::memory_order_relaxed);
+            hot.m_lengths.fetch_add (
+                    data_.encoded().size() - ((constructor & 0xF0U) == 0xA0 ? 2 : 5),
+                    std::memory_order_relaxed);
+            break;
+        default :
+            break;
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::program::
+Program::collection (uint32_t pc_, size_t elements_) const {
+    auto & hot = m_hot[pc_];
+
+    if (hot.m_collections.load (std::memory_order_relaxed) >= m_threshold) return;
+
+    hot.m_collections.fetch_add (1, std::memory_order_relaxed);
+    hot.m_elements.fetch_add (elements_, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+
+amqp::internal::program::Program::Profile
+amqp::internal::program::
+Program::profile (uint32_t pc_) const {
+    Profile rtn { 0, -1, 0, 0, 0.0, 0.0 };
+
+    if (!m_hot) return rtn;
+
+    const auto & hot = m_hot[pc_];
+
+    auto constructor = hot.m_constructor.load (std::memory_order_relaxed);
+    auto sized = hot.m_sized.load (std::memory_order_relaxed);
+    auto collections = hot.m_collections.load (std::memory_order_relaxed);
+
+    rtn.m_seen = hot.m_seen.load (std::memory_order_relaxed);
+    rtn.m_constructor = constructor < UNSEEN ? constructor : -1;
+    rtn.m_nulls = hot.m_nulls.load (std::memory_order_relaxed);
+    rtn.m_references = hot.m_references.load (std::memory_order_relaxed);
+
+    if (sized) {
+        rtn.m_length = static_cast<double> (hot.m_lengths.load (std::memory_order_relaxed)) / sized;
+    }
+
+    if (collections) {
+        rtn.m_elements = static_cast<double> (hot.m_elements.load (std::memory_order_relaxed)) / collections;
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
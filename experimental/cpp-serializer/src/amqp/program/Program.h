@@ -0,0 +1,326 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "types.h"
+#include "Jit.h"
+
+#include "amqp/reader/ISink.h"
+#include "amqp/schema/described-types/Schema.h"
+
+/******************************************************************************/
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+namespace amqp::internal::reader {
+
+    class Reader;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::program::Program
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::program {
+
+    /**
+     * Every compound type gets a plan, a run of instructions starting at
+     * some index into the program. A composite's plan is a header giving
+     * its field count followed by one instruction per field, a list or
+     * array is a single instruction naming the plan for its elements and a
+     * map one naming the plans for its keys and values.
+     *
+     * Primitive fields are executed inline, anything else is a call into
+     * the plan at [m_child]. Arrays of ints, longs and doubles are an
+     * [array_op], decoded in bulk where they can be and as a list where
+     * they can't.
+     *
+     * An interface's plan is a [dispatch_op] header giving how many types
+     * provide it followed by a [call_op] per type into that type's plan,
+     * [m_value] being the descriptor it's called for
+     */
+    enum Op_t : uint8_t {
+        int_op, long_op, bool_op, double_op, string_op, binary_op,
+        char_op, short_op, byte_op, float_op, timestamp_op, uuid_op,
+        decimal128_op, symbol_op,
+        enum_op, call_op, composite_op, list_op, map_op, array_op,
+        dispatch_op
+    };
+
+    struct Instruction {
+        Op_t m_op;
+
+        /**
+         * The plan to call, the element plan of a list, the key plan of a
+         * map or, for a composite or dispatch header, how many fields or
+         * types follow it
+         */
+        uint32_t m_child;
+
+        /**
+         * The value plan of a map, a composite's descriptor, or a field's
+         * name, as an index into the string table. For an array, which
+         * [reader::ArrayReader::Primitive] its elements are, and for a
+         * dispatch header which of the program's inline caches is its own
+         */
+        uint32_t m_value;
+    };
+
+    /**
+     * A reader graph flattened into an array of instructions so that
+     * decoding a field costs a switch rather than a virtual call.
+     *
+     * Decoding emits exactly what [Reader::write] would for the same
+     * blob. References are resolved against the current [ObjectTable] as
+     * the readers would, what they refer to being written again by the
+     * reader it was decoded with.
+     *
+     * A composite decoded often enough has its fields compiled to native
+     * code, see [Jit], the interpreter running the rest.
+     *
+     * Until then the interpreter profiles the values of its fields, and
+     * the elements of its lists, as it decodes them, the shape of each
+     * that it's seen being what the native code is specialised for. A
+     * primitive field that's never numbered by the object table, and
+     * whose values have all had the same constructor, is decoded without
+     * looking for a reference or numbering it, as is each element of a
+     * list of them. Either is guarded by that constructor, any other
+     * falling back on the generic path. A field that's only ever been
+     * null, an optional one seldom set, is decoded by [absent], which
+     * writes the null without so much as dispatching on the field's op.
+     */
+    class Program {
+        public :
+            /**
+             * What the values at an instruction looked like over the
+             * decodes profiled, those of a field or the elements of a list
+             */
+            struct Profile {
+                uint32_t m_seen;
+
+                /**
+                 * The constructor every one of them had, -1 should they
+                 * have differed or there have been none
+                 */
+                int m_constructor;
+
+                uint32_t m_nulls;
+                uint32_t m_references;
+
+                /**
+                 * The mean length of those that were strings, symbols or
+                 * binary and, for a list or map, its mean size
+                 */
+                double m_length;
+                double m_elements;
+            };
+
+        private :
+            static constexpr uint16_t UNSEEN = 0x100;
+            static constexpr uint16_t MIXED = 0x200;
+
+            /**
+             * Indexed as [m_code], how often the composite whose header's
+             * there has been decoded and, once it's hot, its fields, along
+             * with the profile of the values the instruction decodes
+             */
+            struct Hot {
+                std::atomic<uint32_t> m_heat { 0 };
+                std::atomic<Jit::Fields> m_native { nullptr };
+
+                std::atomic<uint32_t> m_seen { 0 };
+                std::atomic<uint16_t> m_constructor { UNSEEN };
+                std::atomic<uint32_t> m_nulls { 0 };
+                std::atomic<uint32_t> m_references { 0 };
+                std::atomic<uint32_t> m_sized { 0 };
+                std::atomic<uint64_t> m_lengths { 0 };
+                std::atomic<uint32_t> m_collections { 0 };
+                std::atomic<uint64_t> m_elements { 0 };
+
+                /**
+                 * The constructor native code was specialised for, set
+                 * before it's published
+                 */
+                std::atomic<uint16_t> m_guard { UNSEEN };
+            };
+
+            std::vector<Instruction> m_code;
+            std::vector<std::string> m_strings;
+
+            /**
+             * Indexed as [m_strings], those naming a field rendered as a
+             * key in every format that can copy one straight out, the
+             * renderings being held by [m_rendered]
+             */
+            std::vector<amqp::reader::ISink::Key> m_keys;
+            std::vector<char> m_rendered;
+
+            /**
+             * The reader each instruction was compiled from, for numbering
+             * what it decodes
+             */
+            std::vector<const reader::Reader *> m_readers;
+
+            const schema::Schema * m_schema;
+
+            /**
+             * One per dispatch, the type it last dispatched to, so a site
+             * that only ever sees one is a single comparison of descriptors
+             */
+            uPtr<std::atomic<uint32_t>[]> m_caches;
+            uint32_t m_sites;
+
+            uint32_t m_entry;
+
+            uPtr<Hot[]> m_hot;
+            uPtr<Jit::Code> m_native;
+            uint32_t m_threshold;
+
+            void exec (uint32_t, cursor::Cursor &, amqp::reader::ISink &) const;
+
+            /**
+             * [exec] for a field's value or, when [element_], a collection's
+             * element, either of which may be a reference
+             */
+            void value (uint32_t, cursor::Cursor &, amqp::reader::ISink &, bool element_) const;
+
+            /**
+             * [value] for a composite's field whose op is known
+             */
+            template<Op_t, class Run>
+            void field (uint32_t, cursor::Cursor &, amqp::reader::ISink &, Run &&) const;
+
+            /**
+             * The list at [pc_] whose elements are the primitive [Op_t],
+             * each guarded by the constructor it was specialised for
+             */
+            template<Op_t>
+            void elements (uint32_t pc_, cursor::Cursor &, amqp::reader::ISink &) const;
+
+            /**
+             * Record the shape of the value at the cursor against [pc_]
+             * while it's still being profiled
+             */
+            void profile (uint32_t pc_, const cursor::Cursor &) const;
+            void collection (uint32_t pc_, size_t elements_) const;
+
+            /**
+             * What native code calls for each field, see [Jit::Step]
+             */
+            template<Op_t>
+            static bool step (
+                const Program *,
+                uint32_t,
+                const amqp::reader::ISink::Key *,
+                cursor::Cursor *,
+                amqp::reader::ISink *) noexcept;
+
+            /**
+             * [step] for a primitive field, guarded by its constructor,
+             * and for a field holding a list of them
+             */
+            template<Op_t>
+            static bool quick (
+                const Program *,
+                uint32_t,
+                const amqp::reader::ISink::Key *,
+                cursor::Cursor *,
+                amqp::reader::ISink *) noexcept;
+
+            template<Op_t>
+            static bool listed (
+                const Program *,
+                uint32_t,
+                const amqp::reader::ISink::Key *,
+                cursor::Cursor *,
+                amqp::reader::ISink *) noexcept;
+
+            /**
+             * [step] for a field that's always been null, guarded by the
+             * null constructor
+             */
+            static bool absent (
+                const Program *,
+                uint32_t,
+                const amqp::reader::ISink::Key *,
+                cursor::Cursor *,
+                amqp::reader::ISink *) noexcept;
+
+            static Jit::Step step (Op_t);
+            static Jit::Step quick (Op_t);
+            static Jit::Step listed (Op_t);
+
+            /**
+             * The step the field at [pc_] is best decoded by given its
+             * profile, guarding it should it need to be
+             */
+            Jit::Step specialise (uint32_t pc_) const;
+
+            /**
+             * The native fields of the composite at [pc_], should it have
+             * just become hot or already be
+             */
+            Jit::Fields hot (uint32_t pc_) const;
+
+            /**
+             * Once compiled, render the key of every composite's fields
+             */
+            void render();
+
+            friend class Compiler;
+
+        public :
+            Program();
+
+            /**
+             * Flatten the readers reachable from [root_], field names and
+             * descriptors being taken from [schema_]
+             */
+            static Program compile (
+                const reader::Reader & root_,
+                const schema::Schema & schema_);
+
+            /**
+             * Decode the value at the cursor into [sink_], leaving the
+             * cursor on its next sibling
+             */
+            void write (cursor::Cursor &, amqp::reader::ISink &) const;
+
+            size_t size() const { return m_code.size(); }
+
+            /**
+             * The memory the program holds, near enough
+             */
+            size_t bytes() const;
+
+            const std::vector<Instruction> & code() const { return m_code; }
+
+            /**
+             * How many composites have been compiled to native code
+             */
+            size_t natives() const;
+
+            /**
+             * Nothing's profiled once a program's composites are never to
+             * be compiled, the profile then being empty
+             */
+            Profile profile (uint32_t pc_) const;
+    };
+
+}
+
+/******************************************************************************/
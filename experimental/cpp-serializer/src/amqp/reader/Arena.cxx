@@ -0,0 +1,161 @@
+#include "Arena.h"
+
+#include <new>
+#include <cassert>
+
+#include "amqp/reader/IReader.h"
+#include "cursor/Limits.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using amqp::internal::reader::Arena;
+
+    /**
+     * Every value is prefixed by the arena it came from, if any, so
+     * deleting one knows whether to give it back to the heap. Padded to
+     * keep the value itself maximally aligned
+     */
+    union Header {
+        Arena * m_arena;
+        std::max_align_t m_align;
+    };
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Arena
+ *
+ ******************************************************************************/
+
+thread_local amqp::internal::reader::Arena *
+amqp::internal::reader::
+Arena::m_current = nullptr;
+
+/******************************************************************************/
+
+std::atomic<size_t>
+amqp::internal::reader::
+Arena::s_highWater { 0 };
+
+/******************************************************************************/
+
+std::atomic<std::pmr::memory_resource *>
+amqp::internal::reader::
+Arena::s_upstream { nullptr };
+
+/******************************************************************************/
+
+amqp::internal::reader::
+Arena::Arena (size_t block_, std::pmr::memory_resource * upstream_)
+    : m_buffer (block_, upstream_)
+    , m_live (0)
+    , m_allocated (0)
+{
+    m_resource.emplace (m_buffer.data(), m_buffer.size(), upstream_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Arena::upstream (std::pmr::memory_resource * upstream_) {
+    s_upstream.store (upstream_);
+}
+
+/******************************************************************************/
+
+std::pmr::memory_resource *
+amqp::internal::reader::
+Arena::upstream() {
+    auto * rtn = s_upstream.load();
+    return rtn ? rtn : std::pmr::new_delete_resource();
+}
+
+/******************************************************************************/
+
+void *
+amqp::internal::reader::
+Arena::allocate (size_t size_) {
+    cursor::Limits::arena (m_allocated + size_);
+
+    ++m_live;
+    m_allocated += size_;
+    return m_resource->allocate (size_, alignof (std::max_align_t));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Arena::release() {
+    assert (m_live > 0);
+    --m_live;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Arena::reset() {
+    assert (m_live == 0);
+
+    for (auto seen = s_highWater.load (std::memory_order_relaxed) ;
+         m_allocated > seen
+             && !s_highWater.compare_exchange_weak (seen, m_allocated, std::memory_order_relaxed) ; )
+    { }
+
+    if (m_allocated > m_buffer.size()) {
+        // leave some room for alignment padding
+        auto * upstream = m_buffer.get_allocator().resource();
+
+        m_resource.reset();
+        m_buffer = std::pmr::vector<std::byte> (m_allocated + m_allocated / 4, upstream);
+        m_resource.emplace (m_buffer.data(), m_buffer.size(), upstream);
+    } else {
+        m_resource->release();
+    }
+
+    m_allocated = 0;
+}
+
+/******************************************************************************
+ *
+ * amqp::reader::IValue
+ *
+ ******************************************************************************/
+
+void *
+amqp::reader::
+IValue::operator new (std::size_t size_) {
+    const auto size = size_ + sizeof (Header);
+    auto arena = Arena::current();
+
+    auto header = static_cast<Header *> (arena
+            ? arena->allocate (size)
+            : ::operator new (size));
+
+    header->m_arena = arena;
+
+    return header + 1;
+}
+
+/******************************************************************************/
+
+void
+amqp::reader::
+IValue::operator delete (void * ptr_) noexcept {
+    if (!ptr_) return;
+
+    auto header = static_cast<Header *> (ptr_) - 1;
+
+    if (header->m_arena) {
+        header->m_arena->release();
+    } else {
+        ::operator delete (header);
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,122 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <memory_resource>
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::Arena
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * A monotonic arena for decoded [IValue] trees. Whilst a [Scope] is
+     * active every value created on that thread is bump allocated from it,
+     * deleting one is free and the whole lot is handed back at once by
+     * [reset].
+     *
+     * Allocation starts in a buffer the arena owns, only spilling onto the
+     * heap once that's full. On reset the buffer grows to fit whatever the
+     * last blob needed so, across a batch of similar blobs, the heap is
+     * soon left alone entirely.
+     *
+     * Every value allocated from the arena must be destroyed before it is
+     * reset.
+     *
+     * The buffer, and anything spilt past it, comes from whichever memory
+     * resource was the arenas' upstream when the arena was built, huge
+     * pages or node local memory say, see [upstream].
+     */
+    class Arena {
+        private :
+            static thread_local Arena * m_current;
+
+            /**
+             * The most any arena has had allocated from it when reset
+             */
+            static std::atomic<size_t> s_highWater;
+
+            /**
+             * Null for the heap, so there's nothing to call before main
+             */
+            static std::atomic<std::pmr::memory_resource *> s_upstream;
+
+            std::pmr::vector<std::byte> m_buffer;
+            std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+
+            size_t m_live;
+            size_t m_allocated;
+
+        public :
+            static constexpr size_t DEFAULT_BLOCK = 64 * 1024;
+
+            /**
+             * Make [arena_] the thread's current arena until destroyed,
+             * restoring whatever was current before
+             */
+            class Scope {
+                private :
+                    Arena * m_previous;
+
+                public :
+                    explicit Scope (Arena & arena_)
+                        : m_previous (m_current)
+                    {
+                        m_current = &arena_;
+                    }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() {
+                        m_current = m_previous;
+                    }
+            };
+
+            explicit Arena (
+                size_t block_ = DEFAULT_BLOCK,
+                std::pmr::memory_resource * upstream_ = upstream());
+
+            Arena (const Arena &) = delete;
+
+            /**
+             * Where arenas built from now on get their memory, the heap
+             * unless set otherwise. [upstream_] must outlive them
+             */
+            static void upstream (std::pmr::memory_resource * upstream_);
+            static std::pmr::memory_resource * upstream();
+
+            static Arena * current() { return m_current; }
+
+            void * allocate (size_t);
+            void release();
+
+            void reset();
+
+            /**
+             * Values allocated since the last reset that are yet to be
+             * destroyed
+             */
+            size_t live() const { return m_live; }
+
+            /**
+             * Bytes handed out since the last reset
+             */
+            size_t allocated() const { return m_allocated; }
+
+            /**
+             * The most any one arena in the process has handed out
+             * between resets
+             */
+            static size_t highWater() { return s_highWater.load (std::memory_order_relaxed); }
+    };
+
+}
+
+/******************************************************************************/
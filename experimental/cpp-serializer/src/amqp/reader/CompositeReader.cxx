@@ -1,23 +1,17 @@
 #include "CompositeReader.h"
 
 #include <string>
-#include <iostream>
+#include <ostream>
 #include <assert.h>
 
-#include <proton/codec.h>
 #include <sstream>
 #include "debug.h"
 #include "Reader.h"
+#include "ObjectTable.h"
 #include "amqp/reader/IReader.h"
-#include "proton/proton_wrapper.h"
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-CompositeReader::m_name { // NOLINT
-    "Composite Reader"
-};
+#include "cursor/Cursor.h"
+#include "stats/Costs.h"
+#include "stats/Stats.h"
 
 /******************************************************************************
  *
@@ -27,17 +21,32 @@ CompositeReader::m_name { // NOLINT
 amqp::internal::reader::
 CompositeReader::CompositeReader (
         std::string type_,
-        sVec<std::weak_ptr<Reader>> & readers_
-) : m_readers (readers_)
+        std::string descriptor_,
+        std::vector<std::string> names_,
+        std::vector<const Reader *> readers_
+) : m_readers (std::move (readers_))
   , m_type (std::move (type_))
+  , m_descriptor (std::move (descriptor_))
+  , m_names (std::move (names_))
 {
     DBG ("MAKE CompositeReader: " << m_type << ": " << m_readers.size() << std::endl); // NOLINT
+
+    m_primitives.reserve (m_readers.size());
+
     for (auto const reader : m_readers) {
-        assert (reader.lock());
-        if (auto r = reader.lock()) {
+        assert (reader);
+        if (auto r = reader) {
             DBG ("  prop: " << r->name() << " " << r->type() << std::endl); // NOLINT
+            m_primitives.push_back (primitive (*r));
+        } else {
+            m_primitives.push_back (Primitive::none_t);
         }
     }
+
+    m_index.reserve (m_names.size());
+
+    // a name given twice is found at its first
+    for (size_t i { 0 } ; i < m_names.size() ; ++i) m_index.emplace (m_names[i], i);
 }
 
 /******************************************************************************/
@@ -45,7 +54,8 @@ CompositeReader::CompositeReader (
 const std::string &
 amqp::internal::reader::
 CompositeReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -60,17 +70,47 @@ CompositeReader::type() const  {
 
 std::any
 amqp::internal::reader::
-CompositeReader::read (pn_data_t * data_) const {
+CompositeReader::read (cursor::Cursor & data_) const {
     return std::any(1);
 }
 
 /******************************************************************************/
 
+void
+amqp::internal::reader::
+CompositeReader::enter (cursor::Cursor & data_, const SchemaType & schema_) const {
+    auto descriptor = cursor::get_symbol<std::string_view>(data_);
+
+    if (descriptor != m_descriptor) {
+        const auto & type = *schema_.fromDescriptor (descriptor)->second.get();
+
+        if (type.type() != schema::AMQPTypeNotation::composite_t) {
+            throw std::runtime_error ("Expected a composite reading " + m_type);
+        }
+
+        const auto & fields = static_cast<const schema::Composite &> (type).fields();
+
+        if (fields.size() != m_names.size()) {
+            throw std::runtime_error ("Field count mismatch reading " + m_type);
+        }
+
+        for (size_t i { 0 } ; i < fields.size() ; ++i) {
+            if (fields[i]->name() != m_names[i]) {
+                throw std::runtime_error ("Field mismatch reading " + m_type);
+            }
+        }
+    }
+
+    data_.next();
+}
+
+/******************************************************************************/
+
 std::string
 amqp::internal::reader::
-CompositeReader::readString (pn_data_t * data_) const {
-    pn_data_next (data_);
-    proton::auto_enter ae (data_);
+CompositeReader::readString (cursor::Cursor & data_) const {
+    data_.next();
+    cursor::auto_enter ae (data_);
 
     return "Composite";
 }
@@ -81,7 +121,7 @@ CompositeReader::readString (pn_data_t * data_) const {
 sVec<uPtr<amqp::reader::IValue>>
 amqp::internal::reader::
 CompositeReader::_dump (
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
     DBG ("Read Composite: "
@@ -90,35 +130,38 @@ CompositeReader::_dump (
         << type()
         << std::endl); // NOLINT
 
-    proton::is_described (data_);
-    proton::auto_enter ae (data_);
+    stats::Costs::Scope cost (m_type, data_);
 
-    const auto & it = schema_.fromDescriptor (
-            proton::get_symbol<std::string>(data_));
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
 
-    auto & fields = dynamic_cast<schema::Composite &> (
-            *(it->second.get())).fields();
-
-    assert (fields.size() == m_readers.size());
-
-    pn_data_next (data_);
+    enter (data_, schema_);
 
     sVec<uPtr<amqp::reader::IValue>> read;
-    read.reserve (fields.size());
+    read.reserve (m_names.size());
 
-    proton::is_list (data_);
+    stats::Stats::count (stats::Stats::objects_t);
+    stats::Stats::count (stats::Stats::fields_t, m_names.size());
+
+    cursor::is_list (data_);
     {
-        proton::auto_enter ae (data_);
+        cursor::auto_enter ae (data_);
 
         for (int i (0) ; i < m_readers.size() ; ++i) {
-            if (auto l =  m_readers[i].lock()) {
-                DBG (fields[i]->name() << " "
+            /*
+             * The JVM never numbers a primitive property, so there's no
+             * reference to resolve or object to record
+             */
+            if (m_primitives[i] != Primitive::none_t) {
+                read.emplace_back (reader::dump (m_primitives[i], m_names[i], data_));
+            } else if (auto l = m_readers[i]) {
+                DBG (m_names[i] << " "
                     << (l ? "true" : "false") << std::endl); // NOLINT
 
-                read.emplace_back (l->dump (fields[i]->name(), data_, schema_));
+                read.emplace_back (ObjectTable::dump (*l, m_names[i], data_, schema_));
             } else {
                 std::stringstream s;
-                s << "null field reader: " << fields[i]->name();
+                s << "null field reader: " << m_names[i];
                 throw std::runtime_error (s.str());
             }
         }
@@ -133,13 +176,13 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 CompositeReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
     return std::make_unique<TypedPair<sVec<uPtr<amqp::reader::IValue>>>> (
-        name_,
+        borrowed, name_,
         _dump(data_, schema_));
 }
 
@@ -151,10 +194,10 @@ CompositeReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 CompositeReader::dump (
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
     return std::make_unique<TypedSingle<sVec<uPtr<amqp::reader::IValue>>>> (
         _dump (data_, schema_));
@@ -162,3 +205,98 @@ CompositeReader::dump (
 
 /******************************************************************************/
 
+void
+amqp::internal::reader::
+CompositeReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    stats::Costs::Scope cost (m_type, data_);
+
+    const auto encoded = sink_.hashes() ? data_.encoded() : std::string_view { };
+    cursor::auto_next an (data_);
+
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
+
+    enter (data_, schema_);
+
+    cursor::is_list (data_);
+    cursor::auto_enter ae2 (data_);
+
+    stats::Stats::count (stats::Stats::objects_t);
+    stats::Stats::count (stats::Stats::fields_t, m_names.size());
+
+    sink_.beginObject();
+
+    for (size_t i (0) ; i < m_readers.size() ; ++i) {
+        if (m_primitives[i] != Primitive::none_t) {
+            sink_.key (m_names[i]);
+            reader::write (m_primitives[i], data_, sink_);
+        } else if (auto l = m_readers[i]) {
+            l->write (m_names[i], data_, sink_, schema_);
+        } else {
+            std::stringstream s;
+            s << "null field reader: " << m_names[i];
+            throw std::runtime_error (s.str());
+        }
+    }
+
+    if (sink_.hashes()) {
+        auto hash = ObjectTable::hash (encoded);
+        sink_.hash (hash.m_low, hash.m_high);
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+CompositeReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    stats::Costs::Scope cost (m_type, data_);
+
+    const auto encoded = visitor_.hashes() ? data_.encoded() : std::string_view { };
+    cursor::auto_next an (data_);
+
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
+
+    enter (data_, schema_);
+
+    cursor::is_list (data_);
+    cursor::auto_enter ae2 (data_);
+
+    stats::Stats::count (stats::Stats::objects_t);
+    stats::Stats::count (stats::Stats::fields_t, m_names.size());
+
+    visitor_.onBeginComposite (m_type);
+
+    for (size_t i (0) ; i < m_readers.size() ; ++i) {
+        if (m_primitives[i] != Primitive::none_t) {
+            visitor_.onField (m_names[i]);
+            reader::visit (m_primitives[i], data_, visitor_);
+        } else if (auto l = m_readers[i]) {
+            l->visit (m_names[i], data_, visitor_, schema_);
+        } else {
+            std::stringstream s;
+            s << "null field reader: " << m_names[i];
+            throw std::runtime_error (s.str());
+        }
+    }
+
+    if (visitor_.hashes()) {
+        auto hash = ObjectTable::hash (encoded);
+        visitor_.onHash (hash.m_low, hash.m_high);
+    }
+
+    visitor_.onEndComposite();
+}
+
+/******************************************************************************/
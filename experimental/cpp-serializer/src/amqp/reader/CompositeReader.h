@@ -3,10 +3,13 @@
 /******************************************************************************/
 
 #include "Reader.h"
+#include "Primitive.h"
 
 #include <any>
 #include <vector>
-#include <iostream>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
 #include <amqp/schema/described-types/Schema.h>
 
 /******************************************************************************/
@@ -15,38 +18,97 @@ namespace amqp::internal::reader {
 
     class CompositeReader : public Reader {
         private :
-            std::vector<std::weak_ptr<Reader>> m_readers;
+            std::vector<const Reader *> m_readers;
 
-            static const std::string m_name;
+            /**
+             * What each property is if it's a primitive, those being read
+             * straight from the cursor rather than through their readers
+             */
+            std::vector<Primitive> m_primitives;
+
+            static constexpr std::string_view m_name { "Composite Reader" };
 
             std::string m_type;
 
+            /**
+             * The descriptor and property names of the type, bound when
+             * the reader's built so that reading an object only has to
+             * check the descriptor it's described by is this one
+             */
+            std::string m_descriptor;
+            std::vector<std::string> m_names;
+
+            /**
+             * Where each property sits by name, viewing [m_names], so one
+             * can be found without comparing every name before it
+             */
+            std::unordered_map<std::string_view, size_t> m_index;
+
         public :
+            static constexpr size_t npos = static_cast<size_t> (-1);
+
             CompositeReader (
                 std::string,
-                std::vector<std::weak_ptr<Reader>> &);
+                std::string,
+                std::vector<std::string>,
+                std::vector<const Reader *>);
+
+            CompositeReader (const CompositeReader &) = delete;
 
             ~CompositeReader() override = default;
 
-            std::any read (pn_data_t *) const override;
+            std::any read (cursor::Cursor &) const override;
 
-            std::string readString (pn_data_t *) const override;
+            std::string readString (cursor::Cursor &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
                 const SchemaType &) const override;
 
             const std::string & name() const override;
             const std::string & type() const override;
 
+            const std::vector<const Reader *> & readers() const {
+                return m_readers;
+            }
+
+            const std::vector<std::string> & names() const { return m_names; }
+
+            /**
+             * Where the property [name_] sits amongst the others, [npos]
+             * if there's none of that name
+             */
+            size_t index (std::string_view name_) const {
+                auto it = m_index.find (name_);
+                return it == m_index.end() ? npos : it->second;
+            }
+
+            /**
+             * Check the described composite under [data_] is one of ours,
+             * leaving [data_] on its list of properties. One described by
+             * another descriptor is looked up in [schema_] and read only
+             * if its properties are the same as ours
+             */
+            void enter (cursor::Cursor & data_, const SchemaType & schema_) const;
+
         private :
             std::vector<std::unique_ptr<amqp::reader::IValue>> _dump (
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const;
     };
 
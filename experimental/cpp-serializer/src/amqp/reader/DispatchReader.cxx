@@ -0,0 +1,204 @@
+#include "DispatchReader.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "debug.h"
+#include "cursor/Cursor.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::DispatchReader
+ *
+ ******************************************************************************/
+
+amqp::internal::reader::
+DispatchReader::DispatchReader (
+    std::string type_,
+    std::vector<Candidate> candidates_
+) : m_type (std::move (type_))
+  , m_candidates (std::move (candidates_))
+  , m_last (0)
+{
+    DBG ("MAKE DispatchReader: " << m_type << ": " << m_candidates.size() << std::endl); // NOLINT
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+DispatchReader::link (const std::map<std::string, Reader *> & readers_) {
+    for (auto & candidate : m_candidates) {
+        auto it = readers_.find (candidate.m_type);
+
+        if (it == readers_.end() || !it->second) {
+            throw std::runtime_error (
+                    "No reader for " + candidate.m_type + " providing " + m_type);
+        }
+
+        candidate.m_reader = it->second;
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * A described value's encoding is 0x00, then its descriptor, a sym8 of
+ * a one byte length or a sym32 of a four byte one
+ */
+std::string_view
+amqp::internal::reader::
+DispatchReader::descriptor (const cursor::Cursor & data_) {
+    auto bytes = data_.encoded();
+
+    if (bytes.size() < 3 || bytes[0] != 0x00) return { };
+
+    size_t offset, length;
+
+    switch (static_cast<uint8_t> (bytes[1])) {
+        case 0xa3 :
+            offset = 3;
+            length = static_cast<uint8_t> (bytes[2]);
+            break;
+        case 0xb3 :
+            if (bytes.size() < 6) return { };
+
+            offset = 6;
+            length = static_cast<size_t> (static_cast<uint8_t> (bytes[2])) << 24
+                   | static_cast<size_t> (static_cast<uint8_t> (bytes[3])) << 16
+                   | static_cast<size_t> (static_cast<uint8_t> (bytes[4])) << 8
+                   | static_cast<size_t> (static_cast<uint8_t> (bytes[5]));
+            break;
+        default :
+            return { };
+    }
+
+    if (offset + length > bytes.size()) return { };
+
+    return bytes.substr (offset, length);
+}
+
+/******************************************************************************/
+
+const amqp::internal::reader::Reader &
+amqp::internal::reader::
+DispatchReader::resolve (const cursor::Cursor & data_) const {
+    auto descriptor = DispatchReader::descriptor (data_);
+
+    auto i = m_last.load (std::memory_order_relaxed);
+
+    if (m_candidates[i].m_descriptor != descriptor) {
+        i = 0;
+        while (i < m_candidates.size() && m_candidates[i].m_descriptor != descriptor) ++i;
+
+        if (i == m_candidates.size()) {
+            std::stringstream ss;
+            ss << "No type providing " << m_type << " is described by \""
+               << descriptor << "\"";
+            throw std::runtime_error (ss.str());
+        }
+
+        m_last.store (i, std::memory_order_relaxed);
+    }
+
+    if (auto reader = m_candidates[i].m_reader) {
+        // the factory that built the graph keeps it alive for us
+        return *reader;
+    }
+
+    throw std::runtime_error ("null reader for " + m_candidates[i].m_type);
+}
+
+/******************************************************************************/
+
+const amqp::internal::reader::Reader &
+amqp::internal::reader::
+DispatchReader::concrete (const Reader & reader_, const cursor::Cursor & data_) {
+    auto dispatch = dynamic_cast<const DispatchReader *> (&reader_);
+
+    if (!dispatch || descriptor (data_).empty()) return reader_;
+
+    return dispatch->resolve (data_);
+}
+
+/******************************************************************************/
+
+std::any
+amqp::internal::reader::
+DispatchReader::read (cursor::Cursor & data_) const {
+    return resolve (data_).read (data_);
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+DispatchReader::readString (cursor::Cursor & data_) const {
+    return resolve (data_).readString (data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+DispatchReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_
+) const {
+    return resolve (data_).dump (name_, data_, schema_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+DispatchReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_
+) const {
+    return resolve (data_).dump (data_, schema_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+DispatchReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_
+) const {
+    resolve (data_).write (data_, sink_, schema_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+DispatchReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_
+) const {
+    resolve (data_).visit (data_, visitor_, schema_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+DispatchReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+DispatchReader::type() const {
+    return m_type;
+}
+
+/******************************************************************************/
@@ -0,0 +1,111 @@
+#pragma once
+
+/******************************************************************************/
+
+#include "Reader.h"
+
+#include <map>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <string_view>
+
+/******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * Reads a field or element declared as an interface, or as *, that the
+     * schema has no type for of its own. Whatever the value actually is
+     * says so by its descriptor, and each of the schema's types providing
+     * the interface is a candidate for it.
+     *
+     * Every value is handed to the candidate its descriptor names, found
+     * through an inline cache of whichever matched last so a site that
+     * only ever sees one concrete type, as most do, costs a single
+     * comparison, and one that sees several a scan of what few there are.
+     */
+    class DispatchReader : public Reader {
+        public :
+            struct Candidate {
+                std::string m_descriptor;
+                std::string m_type;
+                const Reader * m_reader;
+            };
+
+        private :
+            static constexpr std::string_view m_name { "Dispatch Reader" };
+
+            std::string m_type;
+            std::vector<Candidate> m_candidates;
+
+            /**
+             * Which candidate matched last
+             */
+            mutable std::atomic<size_t> m_last;
+
+        public :
+            /**
+             * The candidates' readers, [Candidate::m_reader], being
+             * bound by [link] as they may well not have been built yet
+             */
+            DispatchReader (std::string, std::vector<Candidate>);
+
+            ~DispatchReader() override = default;
+
+            /**
+             * Bind each candidate to its reader in [readers_] by type
+             */
+            void link (const std::map<std::string, Reader *> & readers_);
+
+            const std::vector<Candidate> & candidates() const { return m_candidates; }
+
+            /**
+             * The reader for the value at [data_]
+             */
+            const Reader & resolve (const cursor::Cursor & data_) const;
+
+            /**
+             * [reader_] itself unless it's a [DispatchReader], in which case
+             * the reader for the value at [data_], or again [reader_] when
+             * that isn't a value dispatch can resolve, a reference say
+             */
+            static const Reader & concrete (const Reader & reader_, const cursor::Cursor & data_);
+
+            /**
+             * The symbol the value at [data_] is described by, read from
+             * its encoding without decoding any of it. Empty if it isn't
+             * described by one
+             */
+            static std::string_view descriptor (const cursor::Cursor & data_);
+
+            std::any read (cursor::Cursor &) const override;
+
+            std::string readString (cursor::Cursor &) const override;
+
+            uPtr<amqp::reader::IValue> dump (
+                const std::string &,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            uPtr<amqp::reader::IValue> dump (
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const override;
+
+            const std::string & name() const override;
+            const std::string & type() const override;
+    };
+
+}
+
+/******************************************************************************/
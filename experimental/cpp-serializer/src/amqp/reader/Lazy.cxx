@@ -0,0 +1,337 @@
+#include "Lazy.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "tape/Pointer.h"
+#include "reader/CompositeReader.h"
+#include "reader/DispatchReader.h"
+#include "reader/restricted-readers/MapReader.h"
+#include "reader/restricted-readers/ListReader.h"
+#include "reader/restricted-readers/ArrayReader.h"
+
+/******************************************************************************/
+
+namespace {
+
+    namespace cursor = amqp::internal::cursor;
+    namespace reader = amqp::internal::reader;
+
+    /**
+     * Lists and arrays are a described pair of their descriptor and the
+     * list of elements, leave [data_] on that list
+     */
+    void
+    toElements (cursor::Cursor & data_, const reader::Lazy::SchemaType & schema_) {
+        cursor::is_described (data_);
+
+        data_.enter();
+        data_.next();
+
+        cursor::readAndNext<std::string_view>(data_);
+    }
+
+    const reader::Reader &
+    elementReader (const reader::Reader & reader_) {
+        const reader::Reader * rtn;
+
+        if (auto list = dynamic_cast<const reader::ListReader *>(&reader_)) {
+            rtn = list->reader();
+        } else if (auto array = dynamic_cast<const reader::ArrayReader *>(&reader_)) {
+            rtn = array->reader();
+        } else {
+            throw std::runtime_error ("Not a list: " + reader_.type());
+        }
+
+        if (!rtn) {
+            throw std::runtime_error ("null reader beneath " + reader_.type());
+        }
+
+        // the graph's owner keeps it alive for us
+        return *rtn;
+    }
+
+    /**
+     * Where the field [name_] of the composite at [data_] sits, and its
+     * name as the schema holds it
+     */
+    std::pair<size_t, const std::string *>
+    fieldOf (
+        const reader::Reader & reader_,
+        const cursor::Cursor & data_,
+        const reader::Lazy::SchemaType & schema_,
+        std::string_view name_
+    ) {
+        auto composite = dynamic_cast<const reader::CompositeReader *>(&reader_);
+
+        if (!composite) {
+            throw std::runtime_error ("Not a composite: " + reader_.type());
+        }
+
+        cursor::Cursor data { data_ };
+
+        cursor::is_described (data);
+        data.enter();
+        data.next();
+
+        composite->enter (data, schema_);
+
+        const auto & names = composite->names();
+        auto i = composite->index (name_);
+
+        if (i == reader::CompositeReader::npos) {
+            std::stringstream ss;
+            ss << "No field \"" << name_ << "\" in " << reader_.type();
+            throw std::runtime_error (ss.str());
+        }
+
+        return { i, &names[i] };
+    }
+
+    const reader::Reader &
+    fieldReader (const reader::Reader & reader_, size_t i_, const std::string & name_) {
+        auto reader = dynamic_cast<const reader::CompositeReader &> (reader_).readers()[i_];
+
+        if (!reader) {
+            throw std::runtime_error ("null field reader: " + name_);
+        }
+
+        // as for elements the graph's owner keeps it alive
+        return *reader;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Lazy
+ *
+ ******************************************************************************/
+
+amqp::internal::reader::
+Lazy::Lazy (
+    const Reader & reader_,
+    const cursor::Cursor & data_,
+    const SchemaType & schema_,
+    std::shared_ptr<const void> owner_
+) : m_reader (&DispatchReader::concrete (reader_, data_))
+  , m_data (data_)
+  , m_schema (&schema_)
+  , m_name (nullptr)
+  , m_owner (std::move (owner_))
+{
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::
+Lazy::Lazy (
+    const std::string & name_,
+    const Reader & reader_,
+    const cursor::Cursor & data_,
+    const SchemaType & schema_,
+    std::shared_ptr<const void> owner_
+) : m_reader (&DispatchReader::concrete (reader_, data_))
+  , m_data (data_)
+  , m_schema (&schema_)
+  , m_name (&name_)
+  , m_owner (std::move (owner_))
+{
+}
+
+/******************************************************************************/
+
+const amqp::reader::IValue &
+amqp::internal::reader::
+Lazy::value() const {
+    if (!m_value) {
+        cursor::Cursor data { m_data };
+
+        m_value = m_name
+            ? m_reader->dump (*m_name, data, *m_schema)
+            : m_reader->dump (data, *m_schema);
+    }
+
+    return *m_value;
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+Lazy::dump() const {
+    return value().dump();
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::reader::
+Lazy::index (std::string_view name_) const {
+    return fieldOf (*m_reader, m_data, *m_schema, name_).first;
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::field (std::string_view name_) const {
+    auto [i, name] = fieldOf (*m_reader, m_data, *m_schema, name_);
+
+    cursor::Cursor data { m_data };
+
+    cursor::is_described (data);
+    data.enter();
+    data.next();
+    data.next();
+    cursor::is_list (data);
+    data.enter();
+    data.next();
+    data.skip (i);
+
+    return std::make_unique<Lazy> (
+            *name, fieldReader (*m_reader, i, *name), data, *m_schema, m_owner);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::field (std::string_view name_, std::string_view encoded_) const {
+    auto [i, name] = fieldOf (*m_reader, m_data, *m_schema, name_);
+
+    cursor::Cursor data (encoded_.data(), encoded_.size());
+
+    return std::make_unique<Lazy> (
+            *name, fieldReader (*m_reader, i, *name), data, *m_schema, m_owner);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::element (size_t n_) const {
+    const auto & reader = elementReader (*m_reader);
+
+    cursor::Cursor data { m_data };
+    toElements (data, *m_schema);
+
+    if (n_ >= data.get_list()) {
+        std::stringstream ss;
+        ss << "No element " << n_ << " in a list of " << data.get_list();
+        throw std::runtime_error (ss.str());
+    }
+
+    data.enter();
+    data.next();
+    data.skip (n_);
+
+    return std::make_unique<Lazy> (reader, data, *m_schema, m_owner);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::element (size_t, std::string_view encoded_) const {
+    const auto & reader = elementReader (*m_reader);
+
+    cursor::Cursor data (encoded_.data(), encoded_.size());
+
+    return std::make_unique<Lazy> (reader, data, *m_schema, m_owner);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::at (const tape::Pointer & pointer_) const {
+    if (pointer_.empty()) {
+        return m_name
+            ? std::make_unique<Lazy> (*m_name, *m_reader, m_data, *m_schema, m_owner)
+            : std::make_unique<Lazy> (*m_reader, m_data, *m_schema, m_owner);
+    }
+
+    uPtr<Lazy> rtn;
+
+    for (const auto & token : pointer_) {
+        const auto & from = rtn ? *rtn : *this;
+
+        if (token.index() != tape::Pointer::npos
+            && !dynamic_cast<const CompositeReader *> (from.m_reader))
+        {
+            rtn = from.element (token.index());
+        } else {
+            rtn = from.field (token.name());
+        }
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::reader::
+Lazy::size() const {
+    elementReader (*m_reader);
+
+    cursor::Cursor data { m_data };
+    toElements (data, *m_schema);
+
+    return data.get_list();
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Lazy::Range<amqp::internal::reader::Lazy>
+amqp::internal::reader::
+Lazy::elements() const {
+    const auto & reader = elementReader (*m_reader);
+
+    cursor::Cursor data { m_data };
+    toElements (data, *m_schema);
+
+    auto size = data.get_list();
+
+    if (size) {
+        data.enter();
+        data.next();
+    }
+
+    return Range<Lazy> (*this, data, size, &reader);
+}
+
+/******************************************************************************/
+
+/**
+ * A map's encoding counts its keys and values alike, each entry being a
+ * key followed by its value
+ */
+amqp::internal::reader::Lazy::Range<amqp::internal::reader::Lazy::Entry>
+amqp::internal::reader::
+Lazy::entries() const {
+    auto map = dynamic_cast<const MapReader *>(m_reader);
+
+    if (!map) {
+        throw std::runtime_error ("Not a map: " + m_reader->type());
+    }
+
+    if (!map->keyReader() || !map->valueReader()) {
+        throw std::runtime_error ("null reader beneath " + m_reader->type());
+    }
+
+    cursor::Cursor data { m_data };
+    toElements (data, *m_schema);
+
+    auto size = data.get_map() / 2;
+
+    if (size) {
+        data.enter();
+        data.next();
+    }
+
+    return Range<Entry> (*this, data, size, map->keyReader(), map->valueReader());
+}
+
+/******************************************************************************/
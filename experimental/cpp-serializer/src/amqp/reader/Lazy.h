@@ -0,0 +1,267 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+#include "Reader.h"
+#include "cursor/Cursor.h"
+
+namespace amqp::internal::tape {
+
+    class Pointer;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::Lazy
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * A handle on a value still sitting undecoded in the blob, holding
+     * nothing more than where it is and the reader that understands it.
+     * The value is only decoded, by that reader's [dump], the first time
+     * [value] or [dump] is called and it is then kept.
+     *
+     * A composite's fields and a list's elements can be reached as handles
+     * of their own without decoding anything but the descriptors on the
+     * way, every sibling passed being skipped over by its encoded size.
+     * One declared as an interface is handled by the reader for whatever
+     * type its descriptor says it is.
+     *
+     * A list's elements, or a map's entries, can be walked one at a time
+     * by [elements] and [entries], each step decoding no more than the
+     * one before it did, so a collection of any size is walked in the
+     * same memory and can be left part way through.
+     *
+     * The bytes must outlive every handle onto them. Whatever owns the
+     * reader graph and schema can be handed in as [owner_] to be kept
+     * alive by the handles, otherwise they too must outlive them.
+     */
+    class Lazy : public Value {
+        public :
+            using SchemaType = IReader::SchemaType;
+
+            template<class Item>
+            class Range;
+
+            using Entry = std::pair<Lazy, Lazy>;
+
+        private :
+            const Reader * m_reader;
+            cursor::Cursor m_data;
+            const SchemaType * m_schema;
+
+            /**
+             * Borrowed from the schema when this is a composite's field,
+             * null otherwise.
+             */
+            const std::string * m_name;
+
+            std::shared_ptr<const void> m_owner;
+
+            mutable uPtr<amqp::reader::IValue> m_value;
+
+        public :
+            Lazy (
+                const Reader &,
+                const cursor::Cursor &,
+                const SchemaType &,
+                std::shared_ptr<const void> owner_ = nullptr);
+
+            Lazy (
+                const std::string & name_,
+                const Reader &,
+                const cursor::Cursor &,
+                const SchemaType &,
+                std::shared_ptr<const void> owner_ = nullptr);
+
+            ~Lazy() override = default;
+
+            std::string dump() const override;
+
+            const amqp::reader::IValue & value() const;
+
+            bool decoded() const { return static_cast<bool>(m_value); }
+
+            const Reader & reader() const { return *m_reader; }
+
+            /**
+             * The named field of a composite, throwing if this isn't one
+             * or it has no such field
+             */
+            uPtr<Lazy> field (std::string_view) const;
+
+            /**
+             * The [n_]th element of a list or array
+             */
+            uPtr<Lazy> element (size_t n_) const;
+
+            /**
+             * As above but for a field or element already known to be
+             * encoded as [encoded_], found by an earlier pass over the
+             * blob, so nothing before it need be skipped to reach it
+             */
+            uPtr<Lazy> field (std::string_view, std::string_view encoded_) const;
+            uPtr<Lazy> element (size_t n_, std::string_view encoded_) const;
+
+            /**
+             * The value [pointer_] names beneath this one, skipping to it
+             * a token at a time, each a composite's field or, reading as
+             * an index, the element of a list or array. Throws as [field]
+             * and [element] do should there be nothing there
+             */
+            uPtr<Lazy> at (const tape::Pointer & pointer_) const;
+
+            /**
+             * Where the named field sits amongst its composite's fields,
+             * throwing as [field] does
+             */
+            size_t index (std::string_view) const;
+
+            /**
+             * The value's bytes as encoded in the blob
+             */
+            std::string_view encoded() const { return m_data.encoded(); }
+
+            /**
+             * The number of elements of a list or array, read from the
+             * encoding without visiting any of them
+             */
+            size_t size() const;
+
+            /**
+             * A single pass over the elements of a list or array, each a
+             * handle of its own valid until the range next moves, throwing
+             * if this is neither
+             */
+            Range<Lazy> elements() const;
+
+            /**
+             * As [elements] but over a map's entries, each a handle on its
+             * key and another on its value
+             */
+            Range<Entry> entries() const;
+    };
+
+    /**
+     * An input range, so begun once. It holds nothing but where it's got
+     * to and the current item, every step past an item skipping it by its
+     * encoded size and constructing the next in its place
+     */
+    template<class Item>
+    class Lazy::Range {
+        private :
+            friend class Lazy;
+
+            const Lazy * m_of;
+            const Reader * m_readers[2];
+            cursor::Cursor m_data;
+            size_t m_size;
+
+            Range (const Lazy & of_, const cursor::Cursor & data_, size_t size_,
+                   const Reader * first_, const Reader * second_ = nullptr)
+                : m_of (&of_)
+                , m_readers { first_, second_ }
+                , m_data (data_)
+                , m_size (size_)
+            { }
+
+        public :
+            class iterator {
+                private :
+                    Range * m_range;
+                    size_t m_left;
+                    std::optional<Item> m_item;
+
+                    void read();
+
+                public :
+                    using iterator_category = std::input_iterator_tag;
+                    using value_type = Item;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const Item *;
+                    using reference = const Item &;
+
+                    iterator() : m_range (nullptr), m_left (0) { }
+
+                    explicit iterator (Range & range_)
+                        : m_range (&range_)
+                        , m_left (range_.m_size)
+                    {
+                        read();
+                    }
+
+                    reference operator*() const { return *m_item; }
+                    pointer operator->() const { return &*m_item; }
+
+                    iterator & operator++() {
+                        --m_left;
+                        read();
+                        return *this;
+                    }
+
+                    bool operator== (const iterator & rhs_) const { return m_left == rhs_.m_left; }
+                    bool operator!= (const iterator & rhs_) const { return m_left != rhs_.m_left; }
+            };
+
+            size_t size() const { return m_size; }
+
+            iterator begin() { return iterator (*this); }
+            iterator end() { return iterator(); }
+    };
+
+}
+
+/******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    template<>
+    inline void
+    Lazy::Range<Lazy>::iterator::read() {
+        m_item.reset();
+
+        if (!m_left) return;
+
+        auto & range = *m_range;
+
+        m_item.emplace (*range.m_readers[0], range.m_data, *range.m_of->m_schema, range.m_of->m_owner);
+        range.m_data.skip();
+    }
+
+    template<>
+    inline void
+    Lazy::Range<Lazy::Entry>::iterator::read() {
+        m_item.reset();
+
+        if (!m_left) return;
+
+        auto & range = *m_range;
+        const auto & schema = *range.m_of->m_schema;
+
+        cursor::Cursor key { range.m_data };
+        range.m_data.skip();
+
+        m_item.emplace (
+                std::piecewise_construct,
+                std::forward_as_tuple (*range.m_readers[0], key, schema, range.m_of->m_owner),
+                std::forward_as_tuple (*range.m_readers[1], range.m_data, schema, range.m_of->m_owner));
+
+        range.m_data.skip();
+    }
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,156 @@
+#include "MapIndex.h"
+
+#include <functional>
+
+/******************************************************************************/
+
+namespace {
+
+    namespace reader = amqp::internal::reader;
+
+    /**
+     * How a [MapIndex]'s entries are dumped, as [Reader.cxx] would the
+     * vector of pairs it was built from
+     */
+    std::string
+    entries (const sVec<uPtr<amqp::reader::IValue>> & pairs_) {
+        std::string rtn { "{ " };
+
+        for (auto it = pairs_.begin() ; it != pairs_.end() ; ++it) {
+            if (it != pairs_.begin()) rtn += ", ";
+            rtn += (*it)->dump();
+        }
+
+        return rtn + " }";
+    }
+
+    /**
+     * The key's own characters when it's a string or symbol, both of
+     * which are decoded as views
+     */
+    const std::string_view *
+    text (const amqp::reader::IValue & key_) {
+        auto * view = dynamic_cast<const reader::TypedSingle<std::string_view> *> (&key_);
+
+        return view ? &view->value() : nullptr;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::MapIndex
+ *
+ ******************************************************************************/
+
+thread_local unsigned
+amqp::internal::reader::
+MapIndex::m_scopes = 0;
+
+/******************************************************************************/
+
+amqp::internal::reader::
+MapIndex::MapIndex (sVec<uPtr<amqp::reader::IValue>> pairs_)
+    : m_pairs (std::move (pairs_))
+{
+    m_entries.reserve (m_pairs.size());
+    m_rendered.reserve (m_pairs.size());
+
+    size_t slots { 1 };
+    while (slots < m_pairs.size() * 2) slots <<= 1;
+
+    m_slots.assign (slots, 0);
+
+    for (const auto & pair : m_pairs) {
+        const auto & key = static_cast<const ValuePair &> (*pair).key();
+
+        std::string_view view;
+
+        if (auto * t = text (key)) {
+            view = *t;
+        } else {
+            view = m_rendered.emplace_back (key.dump());
+        }
+
+        m_entries.push_back ({ std::hash<std::string_view>{} (view), view });
+
+        // the first of any duplicated keys is the one found
+        auto slot = m_entries.back().m_hash & (slots - 1);
+        while (m_slots[slot] != 0) {
+            if (m_entries[m_slots[slot] - 1].m_key == view) break;
+            slot = (slot + 1) & (slots - 1);
+        }
+
+        if (m_slots[slot] == 0) {
+            m_slots[slot] = static_cast<uint32_t> (m_entries.size());
+        }
+    }
+}
+
+/******************************************************************************/
+
+const amqp::reader::IValue *
+amqp::internal::reader::
+MapIndex::find (std::string_view key_) const {
+    auto hash = std::hash<std::string_view>{} (key_);
+    auto mask = m_slots.size() - 1;
+
+    for (auto slot = hash & mask ; m_slots[slot] != 0 ; slot = (slot + 1) & mask) {
+        auto i = m_slots[slot] - 1;
+
+        if (m_entries[i].m_hash == hash && m_entries[i].m_key == key_) {
+            return &static_cast<const ValuePair &> (*m_pairs[i]).value();
+        }
+    }
+
+    return nullptr;
+}
+
+/******************************************************************************/
+
+const amqp::internal::reader::MapIndex *
+amqp::internal::reader::
+MapIndex::of (const amqp::reader::IValue & value_) {
+    if (auto * pair = dynamic_cast<const TypedPair<MapIndex> *> (&value_)) {
+        return &pair->value();
+    }
+
+    if (auto * single = dynamic_cast<const TypedSingle<MapIndex> *> (&value_)) {
+        return &single->value();
+    }
+
+    return nullptr;
+}
+
+/******************************************************************************
+ *
+ * Rendering
+ *
+ ******************************************************************************/
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<amqp::internal::reader::MapIndex>::dump() const {
+    return std::string (m_property) + " : " + entries (m_value.pairs());
+}
+
+/******************************************************************************/
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<amqp::internal::reader::MapIndex>::dumpValue() const {
+    return entries (m_value.pairs());
+}
+
+/******************************************************************************/
+
+template<>
+std::string
+amqp::internal::reader::
+TypedSingle<amqp::internal::reader::MapIndex>::dump() const {
+    return entries (m_value.pairs());
+}
+
+/******************************************************************************/
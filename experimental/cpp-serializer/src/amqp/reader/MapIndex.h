@@ -0,0 +1,116 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "Reader.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::MapIndex
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * A decoded map's entries, in the order they were encoded, with an
+     * open addressing hash index over their keys so an entry can be found
+     * without scanning the rest. It dumps exactly as the plain vector of
+     * [ValuePair]s a [MapReader] otherwise decodes into.
+     *
+     * A map is only materialised as one whilst a [Scope] is active on the
+     * decoding thread, building the index costs nothing when nobody is
+     * going to look anything up.
+     *
+     * Keys are matched by their text, a string or symbol key by its
+     * characters and anything else as it would be dumped, an int as 42
+     * or an enum constant by its name say.
+     */
+    class MapIndex {
+        private :
+            static thread_local unsigned m_scopes;
+
+            struct Entry {
+                size_t m_hash;
+                std::string_view m_key;
+            };
+
+            sVec<uPtr<amqp::reader::IValue>> m_pairs;
+            std::vector<Entry> m_entries;
+
+            /**
+             * The text of keys that aren't strings or symbols. Reserved up
+             * front so the entries' views of them never move
+             */
+            std::vector<std::string> m_rendered;
+
+            /**
+             * One more than the entry in each slot, zero for an empty one.
+             * Always a power of two and at least twice the entries
+             */
+            std::vector<uint32_t> m_slots;
+
+        public :
+            /**
+             * Index maps decoded on this thread until destroyed
+             */
+            class Scope {
+                public :
+                    Scope() { ++m_scopes; }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() { --m_scopes; }
+            };
+
+            static bool enabled() { return m_scopes != 0; }
+
+            /**
+             * [pairs_] being the [ValuePair]s a [MapReader] decodes
+             */
+            explicit MapIndex (sVec<uPtr<amqp::reader::IValue>> pairs_);
+
+            MapIndex (MapIndex &&) noexcept = default;
+
+            size_t size() const { return m_entries.size(); }
+
+            const sVec<uPtr<amqp::reader::IValue>> & pairs() const { return m_pairs; }
+
+            /**
+             * The value of the entry keyed by [key_], null when there isn't
+             * one
+             */
+            const amqp::reader::IValue * find (std::string_view key_) const;
+
+            /**
+             * The index of a map decoded whilst a [Scope] was active, null
+             * if [value_] is anything else
+             */
+            static const MapIndex * of (const amqp::reader::IValue & value_);
+    };
+
+}
+
+/******************************************************************************/
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<amqp::internal::reader::MapIndex>::dump() const;
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<amqp::internal::reader::MapIndex>::dumpValue() const;
+
+template<>
+std::string
+amqp::internal::reader::
+TypedSingle<amqp::internal::reader::MapIndex>::dump() const;
+
+/******************************************************************************/
@@ -0,0 +1,444 @@
+#include "ObjectTable.h"
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/ISink.h"
+#include "amqp/reader/IVisitor.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::ObjectTable
+ *
+ ******************************************************************************/
+
+thread_local amqp::internal::reader::ObjectTable *
+amqp::internal::reader::
+ObjectTable::m_current = nullptr;
+
+/******************************************************************************/
+
+namespace {
+
+    using amqp::internal::reader::ObjectTable;
+
+    ObjectTable &
+    current() {
+        if (auto table = ObjectTable::current()) {
+            return *table;
+        }
+
+        throw std::runtime_error ("Found a referenced object with no object table to resolve it");
+    }
+
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::
+ObjectTable::ObjectTable (bool pointers_)
+    : m_pointers (pointers_)
+    , m_replaying (0)
+{ }
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::clear() {
+    m_objects.clear();
+    m_replaying = 0;
+}
+
+/******************************************************************************/
+
+/**
+ * Asked of every value the program decodes so read the descriptor straight
+ * from the bytes rather than copying the cursor to enter it. Corda's
+ * descriptors always have their top bits set so are always a full ulong.
+ */
+bool
+amqp::internal::reader::
+ObjectTable::isReference (const cursor::Cursor & data_) {
+    return data_.type() == cursor::described_t && isReference (data_.encoded());
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::reader::
+ObjectTable::isReference (std::string_view encoded_) {
+    if (encoded_.size() < 10
+        || encoded_[0] != '\x00'
+        || encoded_[1] != '\x80')
+    {
+        return false;
+    }
+
+    uint64_t descriptor { 0 };
+
+    for (size_t i { 2 } ; i < 10 ; ++i) {
+        descriptor = (descriptor << 8U) | static_cast<unsigned char>(encoded_[i]);
+    }
+
+    return amqp::stripCorda (descriptor)
+        == static_cast<uint32_t>(amqp::schema::descriptors::REFERENCED_OBJECT);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::reader::
+ObjectTable::resolve (cursor::Cursor & data_) const {
+    cursor::auto_next an (data_);
+    cursor::auto_enter ae (data_);
+
+    data_.next();
+
+    size_t rtn = data_.type() == cursor::ulong_t ? data_.get_ulong() : data_.get_uint();
+
+    if (rtn >= m_objects.size()) {
+        std::stringstream ss;
+        ss << "Reference to object " << rtn << " but only "
+           << m_objects.size() << " have been decoded";
+        throw std::runtime_error (ss.str());
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::add (
+    std::string_view encoded_,
+    const Reader & reader_,
+    const amqp::reader::IValue * value_
+) {
+    m_objects.push_back ({ encoded_, &reader_, value_ });
+}
+
+/******************************************************************************/
+
+/**
+ * Decode the referenced object again with the same reader, anything
+ * within it being left unnumbered since it already was
+ */
+template<class Fn>
+void
+amqp::internal::reader::
+ObjectTable::replay (size_t idx_, Fn && fn_) {
+    const auto & object = m_objects[idx_];
+
+    struct Replaying {
+        size_t & m_depth;
+        explicit Replaying (size_t & depth_) : m_depth (depth_) { ++m_depth; }
+        ~Replaying() { --m_depth; }
+    } replaying { m_replaying };
+
+    cursor::Cursor data (object.m_encoded.data(), object.m_encoded.size());
+
+    fn_ (*object.m_reader, data);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::write (
+    size_t idx_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_
+) {
+    if (m_pointers) {
+        sink_.beginObject();
+        sink_.key ("$ref");
+        sink_.integer (static_cast<int64_t> (idx_));
+        sink_.endObject();
+        return;
+    }
+
+    replay (idx_, [&sink_, &schema_](const Reader & reader_, cursor::Cursor & data_) {
+        reader_.write (data_, sink_, schema_);
+    });
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+ObjectTable::dump (
+    const Reader & reader_,
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_
+) {
+    if (cursor::skip_null (data_)) {
+        return std::make_unique<TypedPair<Null>> (borrowed, name_, Null { });
+    }
+
+    if (isReference (data_)) {
+        auto & table = ::current();
+        auto idx = table.resolve (data_);
+
+        return std::make_unique<Reference> (
+                table.m_objects[idx].m_value, idx, table.m_pointers, name_);
+    }
+
+    auto table = m_current;
+
+    if (!table || !table->numbers (reader_, false)) {
+        return reader_.dump (name_, data_, schema_);
+    }
+
+    auto encoded = data_.encoded();
+    auto rtn = reader_.dump (name_, data_, schema_);
+
+    table->add (encoded, reader_, rtn.get());
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+ObjectTable::dump (
+    const Reader & reader_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_
+) {
+    if (cursor::skip_null (data_)) return std::make_unique<TypedSingle<Null>> (Null { });
+
+    if (isReference (data_)) {
+        auto & table = ::current();
+        auto idx = table.resolve (data_);
+
+        return std::make_unique<Reference> (
+                table.m_objects[idx].m_value, idx, table.m_pointers);
+    }
+
+    auto table = m_current;
+
+    if (!table || !table->numbers (reader_, true)) {
+        return reader_.dump (data_, schema_);
+    }
+
+    auto encoded = data_.encoded();
+    auto rtn = reader_.dump (data_, schema_);
+
+    table->add (encoded, reader_, rtn.get());
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::write (
+    const Reader & reader_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_,
+    bool element_
+) {
+    if (cursor::skip_null (data_)) {
+        sink_.null();
+        return;
+    }
+
+    if (writeReference (data_, sink_, schema_)) return;
+
+    auto table = m_current;
+
+    if (!table || !table->numbers (reader_, element_)) {
+        reader_.write (data_, sink_, schema_);
+        return;
+    }
+
+    auto encoded = data_.encoded();
+    reader_.write (data_, sink_, schema_);
+
+    table->add (encoded, reader_, nullptr);
+}
+
+/******************************************************************************/
+
+/**
+ * There being no callback for a reference visitors always see what it
+ * refers to
+ */
+void
+amqp::internal::reader::
+ObjectTable::visit (
+    const Reader & reader_,
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_,
+    bool element_
+) {
+    if (cursor::skip_null (data_)) {
+        visitor_.onNull();
+        return;
+    }
+
+    if (isReference (data_)) {
+        auto & table = ::current();
+
+        table.replay (table.resolve (data_), [&visitor_, &schema_](
+                const Reader & reader_, cursor::Cursor & data_)
+        {
+            reader_.visit (data_, visitor_, schema_);
+        });
+
+        return;
+    }
+
+    auto table = m_current;
+
+    if (!table || !table->numbers (reader_, element_)) {
+        reader_.visit (data_, visitor_, schema_);
+        return;
+    }
+
+    auto encoded = data_.encoded();
+    reader_.visit (data_, visitor_, schema_);
+
+    table->add (encoded, reader_, nullptr);
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::reader::
+ObjectTable::writeReference (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_
+) {
+    if (!isReference (data_)) return false;
+
+    auto & table = ::current();
+    table.write (table.resolve (data_), sink_, schema_);
+
+    return true;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::written (
+    std::string_view encoded_,
+    const Reader & reader_,
+    bool element_
+) {
+    if (auto table = m_current) {
+        if (table->numbers (reader_, element_)) {
+            table->add (encoded_, reader_, nullptr);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ObjectTable::hash (
+    const ObjectTable * table_,
+    cursor::Cursor & data_,
+    cursor::Hasher & hasher_
+) {
+    const auto encoded = data_.encoded();
+
+    if (table_ && isReference (data_)) {
+        cursor::Cursor reference (data_);
+        const auto & object = table_->m_objects[table_->resolve (reference)];
+
+        cursor::Cursor referred (object.m_encoded.data(), object.m_encoded.size());
+        hash (table_, referred, hasher_);
+
+        return;
+    }
+
+    const auto type = data_.type();
+
+    switch (type) {
+        case cursor::described_t :
+        case cursor::list_t :
+        case cursor::map_t : {
+            hasher_.update (static_cast<uint64_t> (type));
+
+            uint64_t count { 0 };
+
+            data_.enter();
+
+            for ( ; data_.next() ; ++count) {
+                hash (table_, data_, hasher_);
+            }
+
+            data_.exit();
+
+            hasher_.update (count);
+            break;
+        }
+        case cursor::string_t :
+        case cursor::symbol_t :
+        case cursor::binary_t : {
+            const size_t width = (static_cast<uint8_t> (encoded[0]) & 0xF0U) == 0xA0 ? 1 : 4;
+
+            hasher_.update (static_cast<uint64_t> (type));
+            hasher_.update (encoded.substr (1 + width));
+            hasher_.update (static_cast<uint64_t> (encoded.size() - 1 - width));
+            break;
+        }
+        default :
+            hasher_.update (encoded);
+            break;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Hash
+amqp::internal::reader::
+ObjectTable::hash (std::string_view encoded_) {
+    cursor::Hasher hasher;
+    cursor::Cursor data (encoded_.data(), encoded_.size());
+
+    hash (m_current, data, hasher);
+
+    return hasher.digest();
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Reference
+ *
+ ******************************************************************************/
+
+std::string
+amqp::internal::reader::
+Reference::dump() const {
+    std::string value;
+
+    if (m_pointer || !m_target) {
+        value = "{ $ref : " + std::to_string (m_index) + " }";
+    } else if (auto pair = dynamic_cast<const Pair *> (m_target)) {
+        value = pair->dumpValue();
+    } else {
+        value = m_target->dump();
+    }
+
+    return m_property.empty()
+        ? value
+        : std::string (m_property) + " : " + value;
+}
+
+/******************************************************************************/
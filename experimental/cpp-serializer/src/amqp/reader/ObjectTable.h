@@ -0,0 +1,242 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Reader.h"
+#include "cursor/Hash.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::ObjectTable
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * The objects of a single decode, in the order the JVM serialiser
+     * numbered them, so a REFERENCED_OBJECT, which it writes in place of
+     * an object it has already written, is resolved by index rather than
+     * by decoding anything again.
+     *
+     * The JVM only numbers what it reads through readObjectOrNull, which
+     * is every value of a composite field that isn't a primitive and every
+     * element, key and value of a collection that isn't a boxed primitive
+     * or a byte array, see [Reader::referenceable]. An object is numbered
+     * once everything inside it has been, and values that are themselves
+     * references never are.
+     *
+     * Whilst a [Scope] is active the readers record every such object on
+     * that thread's table. Building a tree each entry keeps the value it
+     * was decoded into and a reference becomes a [Reference] to it.
+     * Streaming there's nothing to point back into so the referenced
+     * object's bytes are decoded again, unless [pointers] asks for a
+     * reference to be written as { "$ref" : n } instead.
+     */
+    class ObjectTable {
+        public :
+            using SchemaType = IReader::SchemaType;
+
+            struct Object {
+                std::string_view m_encoded;
+                const Reader * m_reader;
+
+                /**
+                 * What the object was dumped into, null if it was written
+                 * or visited instead
+                 */
+                const amqp::reader::IValue * m_value;
+            };
+
+        private :
+            static thread_local ObjectTable * m_current;
+
+            std::vector<Object> m_objects;
+
+            bool m_pointers;
+
+            /**
+             * Objects decoded again to expand a reference were numbered
+             * the first time round
+             */
+            size_t m_replaying;
+
+            /**
+             * Move past the reference at the cursor returning the index of
+             * the object it refers to
+             */
+            size_t resolve (cursor::Cursor &) const;
+
+            void add (std::string_view, const Reader &, const amqp::reader::IValue *);
+
+            bool numbers (const Reader & reader_, bool element_) const {
+                return m_replaying == 0 && reader_.referenceable (element_);
+            }
+
+            template<class Fn>
+            void replay (size_t, Fn &&);
+
+            static void hash (const ObjectTable *, cursor::Cursor &, cursor::Hasher &);
+
+            void write (size_t, amqp::reader::ISink &, const SchemaType &);
+
+        public :
+            /**
+             * Make [table_] the thread's current table until destroyed,
+             * restoring whatever was current before
+             */
+            class Scope {
+                private :
+                    ObjectTable * m_previous;
+
+                public :
+                    explicit Scope (ObjectTable & table_)
+                        : m_previous (m_current)
+                    {
+                        m_current = &table_;
+                    }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() {
+                        m_current = m_previous;
+                    }
+            };
+
+            explicit ObjectTable (bool pointers_ = false);
+            ObjectTable (const ObjectTable &) = delete;
+
+            static ObjectTable * current() { return m_current; }
+
+            bool pointers() const { return m_pointers; }
+            void pointers (bool pointers_) { m_pointers = pointers_; }
+
+            size_t size() const { return m_objects.size(); }
+
+            const Object & operator[] (size_t idx_) const { return m_objects[idx_]; }
+
+            void clear();
+
+            /**
+             * True if the value at the cursor is a REFERENCED_OBJECT
+             */
+            static bool isReference (const cursor::Cursor &);
+
+            /**
+             * True if [encoded_] starts with the REFERENCED_OBJECT
+             * descriptor
+             */
+            static bool isReference (std::string_view encoded_);
+
+            /**
+             * Decode the value at the cursor with [reader_] as the field
+             * [name_], or as an element of a collection if unnamed,
+             * resolving it if it's a reference and numbering it if it's
+             * an object. A null, an unset nullable property, is neither
+             * and is passed over as such
+             */
+            static uPtr<amqp::reader::IValue> dump (
+                const Reader & reader_,
+                const std::string & name_,
+                cursor::Cursor &,
+                const SchemaType &);
+
+            static uPtr<amqp::reader::IValue> dump (
+                const Reader & reader_,
+                cursor::Cursor &,
+                const SchemaType &);
+
+            /**
+             * As [dump], [element_] saying which of the two the value is
+             */
+            static void write (
+                const Reader & reader_,
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &,
+                bool element_);
+
+            static void visit (
+                const Reader & reader_,
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &,
+                bool element_);
+
+            /**
+             * For the compiled program, which does its own decoding. If
+             * the value at the cursor is a reference resolve it into
+             * [sink_] and return true, leaving the cursor on its next
+             * sibling
+             */
+            static bool writeReference (cursor::Cursor &, amqp::reader::ISink &, const SchemaType &);
+
+            /**
+             * Number an object the program decoded from [encoded_]
+             */
+            static void written (std::string_view encoded_, const Reader &, bool element_);
+
+            /**
+             * The structural hash of the encoded value [encoded_], the same
+             * however it was written. A compound is hashed as its kind,
+             * its contents and their count, rather than its size in bytes,
+             * and every REFERENCED_OBJECT within it as the object the
+             * thread's table resolves it to, so equal values hash alike
+             * whether written out in full or as references
+             */
+            static cursor::Hash hash (std::string_view encoded_);
+    };
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::Reference
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * A REFERENCED_OBJECT within a tree, dumped as the value it refers to
+     * or, if the table it was resolved against wanted pointers, as
+     * { $ref : n }. Doesn't own what it refers to, which lives elsewhere
+     * in the same tree
+     */
+    class Reference : public Value {
+        private :
+            const amqp::reader::IValue * m_target;
+            size_t m_index;
+            bool m_pointer;
+
+            /**
+             * Set when it's a composite's field, viewing the name owned
+             * by the schema
+             */
+            std::string_view m_property;
+
+        public :
+            Reference (
+                const amqp::reader::IValue * target_,
+                size_t index_,
+                bool pointer_,
+                std::string_view property_ = { }
+            ) : m_target (target_)
+              , m_index (index_)
+              , m_pointer (pointer_)
+              , m_property (property_)
+            { }
+
+            size_t index() const { return m_index; }
+
+            std::string dump() const override;
+    };
+
+}
+
+/******************************************************************************/
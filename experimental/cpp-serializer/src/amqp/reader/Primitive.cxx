@@ -0,0 +1,62 @@
+#include "Primitive.h"
+
+#include <unordered_map>
+
+#include "PropertyReader.h"
+
+/******************************************************************************/
+
+amqp::internal::reader::Primitive
+amqp::internal::reader::
+primitive (const std::string & type_) {
+    static const std::unordered_map<std::string, Primitive> primitives { // NOLINT
+        { "boolean",    Primitive::boolean_t },
+        { "byte",       Primitive::byte_t },
+        { "short",      Primitive::short_t },
+        { "int",        Primitive::int_t },
+        { "long",       Primitive::long_t },
+        { "float",      Primitive::float_t },
+        { "double",     Primitive::double_t },
+        { "char",       Primitive::char_t },
+        { "string",     Primitive::string_t },
+        { "symbol",     Primitive::symbol_t },
+        { "binary",     Primitive::binary_t },
+        { "timestamp",  Primitive::timestamp_t },
+        { "uuid",       Primitive::uuid_t },
+        { "decimal128", Primitive::decimal128_t }
+    };
+
+    auto it = primitives.find (type_);
+
+    return it == primitives.end() ? Primitive::none_t : it->second;
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Primitive
+amqp::internal::reader::
+primitive (const Reader & reader_) {
+    if (dynamic_cast<const PropertyReader *> (&reader_)) {
+        return primitive (reader_.type());
+    }
+
+    return Primitive::none_t;
+}
+
+/******************************************************************************/
+
+amqp::internal::reader::Primitive
+amqp::internal::reader::
+unnumbered (const Reader * reader_) {
+    if (!reader_) return Primitive::none_t;
+
+    auto rtn = primitive (*reader_);
+
+    if (rtn == Primitive::none_t) return rtn;
+
+    return dispatch (rtn, [](auto kernel_) { return decltype (kernel_)::numbered; })
+        ? Primitive::none_t
+        : rtn;
+}
+
+/******************************************************************************/
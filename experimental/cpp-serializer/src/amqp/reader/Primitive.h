@@ -0,0 +1,429 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "Reader.h"
+
+#include "cursor/Cursor.h"
+#include "stats/Stats.h"
+#include "format/Text.h"
+#include "format/Number.h"
+
+#include "amqp/reader/ISink.h"
+#include "amqp/reader/IVisitor.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Primitive
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * Every type a [PropertyReader] reads. The set is closed, so rather
+     * than going through a reader's virtuals for each primitive property
+     * or element the composite, list and map readers switch on this and
+     * call the matching [PrimitiveKernel] directly, which the compiler is
+     * free to inline
+     */
+    enum class Primitive : uint8_t {
+        none_t,
+        boolean_t,
+        byte_t,
+        short_t,
+        int_t,
+        long_t,
+        float_t,
+        double_t,
+        char_t,
+        string_t,
+        symbol_t,
+        binary_t,
+        timestamp_t,
+        uuid_t,
+        decimal128_t
+    };
+
+    /**
+     * The primitive named [type_] in a schema, none_t for anything else
+     */
+    Primitive primitive (const std::string & type_);
+
+    /**
+     * The primitive [reader_] reads, none_t if it isn't a [PropertyReader]
+     */
+    Primitive primitive (const Reader & reader_);
+
+    /**
+     * As [primitive] but none_t for primitives the JVM numbers when they
+     * are elements of a collection, those having to go through the
+     * [ObjectTable]
+     */
+    Primitive unnumbered (const Reader * reader_);
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::PrimitiveKernel
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * How each primitive is read from the cursor, leaving it on the next
+     * value, and handed to a sink or visitor. [numbered] is whether the
+     * JVM numbers the primitive when it's an element of a collection,
+     * such elements having to go through the [ObjectTable]. As a field
+     * none are.
+     */
+    template<Primitive P>
+    struct PrimitiveKernel;
+
+    template<>
+    struct PrimitiveKernel<Primitive::boolean_t> {
+        static constexpr Primitive primitive = Primitive::boolean_t;
+        using Type = bool;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<bool> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.boolean (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onBool (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::byte_t> {
+        static constexpr Primitive primitive = Primitive::byte_t;
+        using Type = int8_t;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<int8_t> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.integer (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onByte (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::short_t> {
+        static constexpr Primitive primitive = Primitive::short_t;
+        using Type = int16_t;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<int16_t> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.integer (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onShort (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::int_t> {
+        static constexpr Primitive primitive = Primitive::int_t;
+        using Type = int32_t;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<int32_t> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.integer (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onInt (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::long_t> {
+        static constexpr Primitive primitive = Primitive::long_t;
+        using Type = int64_t;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<int64_t> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.integer (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onLong (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::float_t> {
+        static constexpr Primitive primitive = Primitive::float_t;
+        using Type = float;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<float> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.real (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onFloat (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::double_t> {
+        static constexpr Primitive primitive = Primitive::double_t;
+        using Type = double;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<double> (data_); }
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.real (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onDouble (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::char_t> {
+        static constexpr Primitive primitive = Primitive::char_t;
+        using Type = char32_t;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) { return cursor::readAndNext<char32_t> (data_); }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) {
+            sink_.string (format::Utf8 (value_).view());
+        }
+
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onChar (value_); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::string_t> {
+        static constexpr Primitive primitive = Primitive::string_t;
+        using Type = std::string_view;
+        static constexpr bool numbered = true;
+
+        static Type read (cursor::Cursor & data_) {
+            stats::Stats::count (stats::Stats::strings_t);
+            return cursor::readAndNext<std::string_view> (data_);
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.string (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onString (value_); }
+    };
+
+    /**
+     * The symbol's text, viewed in place
+     */
+    template<>
+    struct PrimitiveKernel<Primitive::symbol_t> {
+        static constexpr Primitive primitive = Primitive::symbol_t;
+        using Type = std::string_view;
+        static constexpr bool numbered = true;
+
+        static Type read (cursor::Cursor & data_) {
+            cursor::is_type (data_, cursor::symbol_t);
+            cursor::auto_next an (data_);
+
+            return data_.get_symbol();
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.symbol (value_); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onSymbol (value_); }
+    };
+
+    /**
+     * The binary's bytes, viewed in place
+     */
+    template<>
+    struct PrimitiveKernel<Primitive::binary_t> {
+        static constexpr Primitive primitive = Primitive::binary_t;
+        using Type = Binary;
+        static constexpr bool numbered = false;
+
+        static Type read (cursor::Cursor & data_) {
+            cursor::is_type (data_, cursor::binary_t);
+            cursor::auto_next an (data_);
+
+            return Binary (data_.get_binary());
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) { sink_.binary (value_.view()); }
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) { visitor_.onBinary (value_.view()); }
+    };
+
+    template<>
+    struct PrimitiveKernel<Primitive::timestamp_t> {
+        static constexpr Primitive primitive = Primitive::timestamp_t;
+        using Type = Timestamp;
+        static constexpr bool numbered = true;
+
+        static Type read (cursor::Cursor & data_) {
+            cursor::is_type (data_, cursor::timestamp_t);
+            cursor::auto_next an (data_);
+
+            return Timestamp { data_.get_timestamp() };
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) {
+            sink_.string (format::Iso8601 (value_.m_millis).view());
+        }
+
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) {
+            visitor_.onTimestamp (value_.m_millis);
+        }
+    };
+
+    /**
+     * The uuid's 16 raw bytes, viewed in place
+     */
+    template<>
+    struct PrimitiveKernel<Primitive::uuid_t> {
+        static constexpr Primitive primitive = Primitive::uuid_t;
+        using Type = Uuid;
+        static constexpr bool numbered = true;
+
+        static Type read (cursor::Cursor & data_) {
+            cursor::is_type (data_, cursor::uuid_t);
+            cursor::auto_next an (data_);
+
+            return Uuid { data_.get_fixed16() };
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) {
+            sink_.string (format::Uuid (value_.m_bytes.data()).view());
+        }
+
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) {
+            visitor_.onUuid (value_.m_bytes);
+        }
+    };
+
+    /**
+     * The decimal128's 16 raw bytes, viewed in place
+     */
+    template<>
+    struct PrimitiveKernel<Primitive::decimal128_t> {
+        static constexpr Primitive primitive = Primitive::decimal128_t;
+        using Type = Decimal128;
+        static constexpr bool numbered = true;
+
+        static Type read (cursor::Cursor & data_) {
+            cursor::is_type (data_, cursor::decimal128_t);
+            cursor::auto_next an (data_);
+
+            return Decimal128 { data_.get_fixed16() };
+        }
+
+        static void write (Type value_, amqp::reader::ISink & sink_) {
+            sink_.string (format::Decimal (value_.m_bytes.data()).view());
+        }
+
+        static void visit (Type value_, amqp::reader::IVisitor & visitor_) {
+            visitor_.onDecimal128 (value_.m_bytes);
+        }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * Dispatch
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * [fn_] called with the [PrimitiveKernel] for [primitive_]
+     */
+    template<class Fn>
+    inline decltype (auto)
+    dispatch (Primitive primitive_, Fn && fn_) {
+        switch (primitive_) {
+            case Primitive::boolean_t    : return fn_ (PrimitiveKernel<Primitive::boolean_t> { });
+            case Primitive::byte_t       : return fn_ (PrimitiveKernel<Primitive::byte_t> { });
+            case Primitive::short_t      : return fn_ (PrimitiveKernel<Primitive::short_t> { });
+            case Primitive::int_t        : return fn_ (PrimitiveKernel<Primitive::int_t> { });
+            case Primitive::long_t       : return fn_ (PrimitiveKernel<Primitive::long_t> { });
+            case Primitive::float_t      : return fn_ (PrimitiveKernel<Primitive::float_t> { });
+            case Primitive::double_t     : return fn_ (PrimitiveKernel<Primitive::double_t> { });
+            case Primitive::char_t       : return fn_ (PrimitiveKernel<Primitive::char_t> { });
+            case Primitive::string_t     : return fn_ (PrimitiveKernel<Primitive::string_t> { });
+            case Primitive::symbol_t     : return fn_ (PrimitiveKernel<Primitive::symbol_t> { });
+            case Primitive::binary_t     : return fn_ (PrimitiveKernel<Primitive::binary_t> { });
+            case Primitive::timestamp_t  : return fn_ (PrimitiveKernel<Primitive::timestamp_t> { });
+            case Primitive::uuid_t       : return fn_ (PrimitiveKernel<Primitive::uuid_t> { });
+            case Primitive::decimal128_t : return fn_ (PrimitiveKernel<Primitive::decimal128_t> { });
+            case Primitive::none_t       : break;
+        }
+
+        throw std::logic_error ("Dispatched a value that isn't a primitive");
+    }
+
+    /**
+     * A null in place of any primitive is an unset nullable property,
+     * checked for before the kernel reads what it expects to be there
+     */
+    template<Primitive P>
+    inline uPtr<amqp::reader::IValue>
+    dump (const std::string & name_, cursor::Cursor & data_) {
+        using Kernel = PrimitiveKernel<P>;
+
+        if (cursor::skip_null (data_)) {
+            return std::make_unique<TypedPair<Null>> (borrowed, name_, Null { });
+        }
+
+        return std::make_unique<TypedPair<typename Kernel::Type>> (
+                borrowed, name_, Kernel::read (data_));
+    }
+
+    template<Primitive P>
+    inline uPtr<amqp::reader::IValue>
+    dump (cursor::Cursor & data_) {
+        using Kernel = PrimitiveKernel<P>;
+
+        if (cursor::skip_null (data_)) return std::make_unique<TypedSingle<Null>> (Null { });
+
+        return std::make_unique<TypedSingle<typename Kernel::Type>> (Kernel::read (data_));
+    }
+
+    template<Primitive P>
+    inline void
+    write (cursor::Cursor & data_, amqp::reader::ISink & sink_) {
+        if (cursor::skip_null (data_)) {
+            sink_.null();
+            return;
+        }
+
+        PrimitiveKernel<P>::write (PrimitiveKernel<P>::read (data_), sink_);
+    }
+
+    template<Primitive P>
+    inline void
+    visit (cursor::Cursor & data_, amqp::reader::IVisitor & visitor_) {
+        if (cursor::skip_null (data_)) {
+            visitor_.onNull();
+            return;
+        }
+
+        PrimitiveKernel<P>::visit (PrimitiveKernel<P>::read (data_), visitor_);
+    }
+
+    /**
+     * The same for a primitive only known at run time
+     */
+    inline uPtr<amqp::reader::IValue>
+    dump (Primitive primitive_, const std::string & name_, cursor::Cursor & data_) {
+        return dispatch (primitive_, [&](auto kernel_) {
+            return dump<decltype (kernel_)::primitive> (name_, data_);
+        });
+    }
+
+    inline uPtr<amqp::reader::IValue>
+    dump (Primitive primitive_, cursor::Cursor & data_) {
+        return dispatch (primitive_, [&](auto kernel_) {
+            return dump<decltype (kernel_)::primitive> (data_);
+        });
+    }
+
+    inline void
+    write (Primitive primitive_, cursor::Cursor & data_, amqp::reader::ISink & sink_) {
+        dispatch (primitive_, [&](auto kernel_) {
+            write<decltype (kernel_)::primitive> (data_, sink_);
+        });
+    }
+
+    inline void
+    visit (Primitive primitive_, cursor::Cursor & data_, amqp::reader::IVisitor & visitor_) {
+        dispatch (primitive_, [&](auto kernel_) {
+            visit<decltype (kernel_)::primitive> (data_, visitor_);
+        });
+    }
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,291 @@
+#include "Projection.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/ISink.h"
+
+#include "reader/Reader.h"
+
+#include "schema/restricted-types/List.h"
+#include "schema/restricted-types/Array.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Projection::Compiler
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * Builds the tree of steps one path at a time, paths sharing a prefix
+     * sharing the steps for it
+     */
+    class Projection::Compiler {
+        private :
+            const schema::Schema & m_schema;
+            const Resolver & m_resolver;
+
+        public :
+            Compiler (const schema::Schema & schema_, const Resolver & resolver_)
+                : m_schema (schema_)
+                , m_resolver (resolver_)
+            { }
+
+            void add (
+                Step &,
+                const std::string & type_,
+                const std::string & path_,
+                std::vector<std::string>::const_iterator,
+                std::vector<std::string>::const_iterator);
+    };
+
+}
+
+/******************************************************************************/
+
+namespace {
+
+    std::vector<std::string>
+    split (const std::string & path_) {
+        std::vector<std::string> rtn;
+        std::string::size_type begin { 0 };
+
+        for (;;) {
+            auto end = path_.find ('.', begin);
+            rtn.push_back (path_.substr (begin, end - begin));
+
+            if (rtn.back().empty()) {
+                throw std::runtime_error ("Empty field in path \"" + path_ + "\"");
+            }
+
+            if (end == std::string::npos) break;
+            begin = end + 1;
+        }
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Projection::Compiler::add (
+    Step & step_,
+    const std::string & type_,
+    const std::string & path_,
+    std::vector<std::string>::const_iterator field_,
+    std::vector<std::string>::const_iterator end_
+) {
+    if (field_ == end_) {
+        step_.m_whole = true;
+
+        if (!step_.m_reader) {
+            step_.m_reader = &m_resolver (type_);
+        }
+
+        return;
+    }
+
+    auto cantSelect = [&]() {
+        std::stringstream ss;
+        ss << "Can't select \"" << *field_ << "\" from " << type_
+           << " for path \"" << path_ << "\"";
+        return std::runtime_error (ss.str());
+    };
+
+    if (type_ == "binary") {
+        std::string rest { *field_ };
+        for (auto it = std::next (field_) ; it != end_ ; ++it) rest += "." + *it;
+
+        step_.m_nested.push_back (std::move (rest));
+        return;
+    }
+
+    const auto * type = m_schema.typeNotation (type_);
+
+    if (!type) {
+        throw cantSelect();
+    }
+
+    if (type->type() == schema::AMQPTypeNotation::composite_t) {
+        const auto & fields = dynamic_cast<const schema::Composite &> (
+                *type).fields();
+
+        if (step_.m_fields.empty()) {
+            step_.m_fields.resize (fields.size());
+            for (const auto & f : fields) {
+                step_.m_names.push_back (f->name());
+            }
+        }
+
+        size_t i { 0 };
+        while (i < fields.size() && fields[i]->name() != *field_) ++i;
+
+        if (i == fields.size()) {
+            std::stringstream ss;
+            ss << "No field \"" << *field_ << "\" in " << type_
+               << " for path \"" << path_ << "\"";
+            throw std::runtime_error (ss.str());
+        }
+
+        if (!step_.m_fields[i]) {
+            step_.m_fields[i] = std::make_unique<Step>();
+        }
+
+        step_.m_last = std::max (step_.m_last, i);
+
+        add (*step_.m_fields[i], fields[i]->resolvedType(), path_, std::next (field_), end_);
+        return;
+    }
+
+    const auto & restricted = dynamic_cast<const schema::Restricted &> (*type);
+
+    const std::string * element;
+
+    switch (restricted.restrictedType()) {
+        case schema::Restricted::RestrictedTypes::list_t :
+            element = &dynamic_cast<const schema::List &> (restricted).listOf();
+            break;
+        case schema::Restricted::RestrictedTypes::array_t :
+            element = &dynamic_cast<const schema::Array &> (restricted).arrayOf();
+            break;
+        default :
+            throw cantSelect();
+    }
+
+    if (!step_.m_element) {
+        step_.m_element = std::make_unique<Step>();
+    }
+
+    add (*step_.m_element, *element, path_, field_, end_);
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Projection
+ *
+ ******************************************************************************/
+
+amqp::internal::reader::Projection
+amqp::internal::reader::
+Projection::compile (
+    const schema::Schema & schema_,
+    const std::string & type_,
+    const std::vector<std::string> & paths_,
+    const Resolver & resolver_
+) {
+    Projection rtn;
+    rtn.m_root = std::make_unique<Step>();
+
+    Compiler compiler (schema_, resolver_);
+
+    // with nothing asked for, everything is wanted
+    if (paths_.empty()) {
+        std::vector<std::string> none;
+        compiler.add (*rtn.m_root, type_, "", none.cbegin(), none.cend());
+    }
+
+    for (const auto & path : paths_) {
+        auto fields = split (path);
+        compiler.add (*rtn.m_root, type_, path, fields.cbegin(), fields.cend());
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Projection::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const schema::ISchemaType & schema_
+) const {
+    write (*m_root, data_, sink_, schema_);
+}
+
+/******************************************************************************/
+
+/*
+ * Mirrors the cursor movements of the composite and list readers' own
+ * write, only handing off to a reader once we reach a field that is
+ * wanted in full. Leaving a composite before its last field is fine,
+ * exiting puts us back on the composite itself which is then jumped
+ * over as a whole.
+ */
+void
+amqp::internal::reader::
+Projection::write (
+    const Step & step_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const schema::ISchemaType & schema_
+) {
+    if (step_.m_whole) {
+        step_.m_reader->write (data_, sink_, schema_);
+        return;
+    }
+
+    if (!step_.m_nested.empty()) {
+        cursor::auto_next an (data_);
+
+        if (data_.type() == cursor::null_t) {
+            sink_.null();
+        } else {
+            cursor::is_type (data_, cursor::binary_t);
+            sink_.nested (data_.get_binary(), step_.m_nested);
+        }
+
+        return;
+    }
+
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
+
+    if (step_.m_element) {
+        cursor::readAndNext<std::string_view>(data_);
+
+        cursor::auto_list_enter ale (data_, true);
+
+        sink_.beginList();
+        for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+            write (*step_.m_element, data_, sink_, schema_);
+        }
+        sink_.endList();
+
+        return;
+    }
+
+    cursor::get_symbol<std::string_view>(data_);
+
+    data_.next();
+
+    cursor::is_list (data_);
+    cursor::auto_enter ae2 (data_);
+
+    sink_.beginObject();
+
+    for (size_t i { 0 }, skip { 0 } ; i <= step_.m_last ; ++i) {
+        if (step_.m_fields[i]) {
+            data_.skip (skip);
+            skip = 0;
+
+            sink_.key (step_.m_names[i]);
+            write (*step_.m_fields[i], data_, sink_, schema_);
+        } else {
+            ++skip;
+        }
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
@@ -0,0 +1,141 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "types.h"
+
+#include "amqp/schema/described-types/Schema.h"
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::Projection
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    class Reader;
+
+    /**
+     * A set of dotted field paths, "amount.quantity" say, compiled against
+     * a schema. Only the fields named, and the composites leading to
+     * them, are decoded. Runs of other fields are skipped by the cursor
+     * using their encoded sizes without ever being looked at, and once
+     * the last wanted field of a composite is read the rest of it is left
+     * untouched entirely.
+     *
+     * A path runs through lists and arrays, so naming a field beneath one
+     * selects that field from each of its elements. The last field of a
+     * path is decoded in full whatever its type. A path running on past a
+     * binary is handed, with the binary, to the sink, in case it holds a
+     * blob of its own that the rest of the path can be followed into.
+     *
+     * The output has the same shape as [Reader::write] would produce, just
+     * with the fields that weren't asked for left out.
+     *
+     * The way down to each field is worked out from the schema alone, a
+     * reader is only asked for at the end of each path. So readers for
+     * the types a projection passes through, or never touches, need not
+     * exist at all.
+     */
+    class Projection {
+        private :
+            struct Step {
+                /**
+                 * Decode this in full rather than just the fields below,
+                 * only then is there a reader
+                 */
+                bool m_whole;
+                const Reader * m_reader;
+
+                /**
+                 * For a composite, one per field, null where that field
+                 * is to be skipped
+                 */
+                std::vector<uPtr<Step>> m_fields;
+                std::vector<std::string> m_names;
+
+                /**
+                 * The last field wanted, nothing after it need be touched
+                 */
+                size_t m_last;
+
+                /**
+                 * For a list or array, what to take from each element
+                 */
+                uPtr<Step> m_element;
+
+                /**
+                 * For a binary, the paths below it wanted of the blob
+                 * it holds, see [amqp::reader::ISink::nested]
+                 */
+                std::vector<std::string> m_nested;
+
+                Step()
+                    : m_whole (false)
+                    , m_reader (nullptr)
+                    , m_last (0)
+                { }
+            };
+
+            uPtr<Step> m_root;
+
+            class Compiler;
+
+            static void write (
+                const Step &,
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const schema::ISchemaType &);
+
+        public :
+            /**
+             * Hands back the reader for a named type, building it if need
+             * be. The reader must outlive the projection
+             */
+            using Resolver = std::function<const Reader & (const std::string &)>;
+
+            /**
+             * Paths are followed through [schema_] from the type named
+             * [type_], throwing if any path names a field that doesn't
+             * exist or that runs through something other than a
+             * composite, list or array. No paths at all selects
+             * everything
+             */
+            static Projection compile (
+                const schema::Schema & schema_,
+                const std::string & type_,
+                const std::vector<std::string> & paths_,
+                const Resolver & resolver_);
+
+            /**
+             * Decode the selected fields of the value at the cursor into
+             * [sink_], leaving the cursor on its next sibling
+             */
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const schema::ISchemaType &) const;
+    };
+
+}
+
+/******************************************************************************/
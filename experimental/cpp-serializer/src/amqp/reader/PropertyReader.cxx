@@ -5,15 +5,21 @@
 #include "amqp/reader/property-readers/LongPropertyReader.h"
 #include "amqp/reader/property-readers/StringPropertyReader.h"
 #include "amqp/reader/property-readers/DoublePropertyReader.h"
+#include "amqp/reader/property-readers/BinaryPropertyReader.h"
+#include "amqp/reader/property-readers/CharPropertyReader.h"
+#include "amqp/reader/property-readers/ShortPropertyReader.h"
+#include "amqp/reader/property-readers/BytePropertyReader.h"
+#include "amqp/reader/property-readers/FloatPropertyReader.h"
+#include "amqp/reader/property-readers/TimestampPropertyReader.h"
+#include "amqp/reader/property-readers/UuidPropertyReader.h"
+#include "amqp/reader/property-readers/Decimal128PropertyReader.h"
+#include "amqp/reader/property-readers/SymbolPropertyReader.h"
 
-#include <map>
 #include <string>
-#include <iostream>
-#include <functional>
+#include <stdexcept>
+#include <string_view>
 
-#include <proton/codec.h>
-
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 /******************************************************************************/
 
@@ -21,37 +27,50 @@ namespace {
 
     using namespace amqp::internal::reader;
 
-    std::map<
-            std::string,
-            std::shared_ptr<amqp::internal::reader::PropertyReader>(*)()
-    > propertyMap = { // NOLINT
-        {
-            "int", []() -> std::shared_ptr<PropertyReader> {
-                return std::make_shared<IntPropertyReader> ();
-            }
-        },
-        {
-            "string", []() -> std::shared_ptr<PropertyReader> {
-                return std::make_shared<StringPropertyReader> ();
-            }
-        },
-        {
-            "boolean", []() -> std::shared_ptr<PropertyReader> {
-                return std::make_shared<BoolPropertyReader> ();
-            }
-        },
-        {
-            "long", []() -> std::shared_ptr<PropertyReader> {
-                return std::make_shared<LongPropertyReader> ();
-            }
-        },
-        {
-            "double", []() -> std::shared_ptr<PropertyReader> {
-                return std::make_shared<DoublePropertyReader> ();
-            }
-        }
+    template<class T>
+    uPtr<PropertyReader>
+    construct() {
+        return std::make_unique<T>();
+    }
+
+    struct Factory {
+        std::string_view m_type;
+        uPtr<PropertyReader> (* m_make)();
+    };
+
+    /**
+     * Constant, so there's nothing to build before the first blob's read
+     */
+    constexpr Factory factories[] = {
+        { "int", &construct<IntPropertyReader> },
+        { "string", &construct<StringPropertyReader> },
+        { "boolean", &construct<BoolPropertyReader> },
+        { "long", &construct<LongPropertyReader> },
+        { "double", &construct<DoublePropertyReader> },
+        { "binary", &construct<BinaryPropertyReader> },
+        { "char", &construct<CharPropertyReader> },
+        { "short", &construct<ShortPropertyReader> },
+        { "byte", &construct<BytePropertyReader> },
+        { "float", &construct<FloatPropertyReader> },
+        { "timestamp", &construct<TimestampPropertyReader> },
+        { "uuid", &construct<UuidPropertyReader> },
+        { "decimal128", &construct<Decimal128PropertyReader> },
+        { "symbol", &construct<SymbolPropertyReader> }
     };
 
+    /**
+     * Only ever called building a reader, which are cached, so the few
+     * primitives there are are simply searched
+     */
+    uPtr<PropertyReader>
+    make (const std::string & type_) {
+        for (const auto & factory : factories) {
+            if (factory.m_type == type_) return factory.m_make();
+        }
+
+        throw std::runtime_error ("No reader for primitive type " + type_);
+    }
+
 }
 
 /******************************************************************************
@@ -60,26 +79,26 @@ namespace {
  *
  ******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::PropertyReader>
+uPtr<amqp::internal::reader::PropertyReader>
 amqp::internal::reader::
 PropertyReader::make (const FieldPtr & field_) {
-    return propertyMap[field_->type()]();
+    return ::make (field_->type());
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::PropertyReader>
+uPtr<amqp::internal::reader::PropertyReader>
 amqp::internal::reader::
 PropertyReader::make (const std::string & type_) {
-    return propertyMap[type_]();
+    return ::make (type_);
 }
 
 /******************************************************************************/
 
-std::shared_ptr<amqp::internal::reader::PropertyReader>
+uPtr<amqp::internal::reader::PropertyReader>
 amqp::internal::reader::
 PropertyReader::make (const internal::schema::Field & field_) {
-    return propertyMap[field_.type()]();
+    return ::make (field_.type());
 }
 
 /******************************************************************************/
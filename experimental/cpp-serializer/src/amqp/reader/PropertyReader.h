@@ -18,30 +18,37 @@ namespace amqp::internal::reader {
             /**
              * Static Factory method for creating appropriate derived types
              */
-            static std::shared_ptr<PropertyReader> make (const internal::schema::Field &);
-            static std::shared_ptr<PropertyReader> make (const FieldPtr &);
-            static std::shared_ptr<PropertyReader> make (const std::string &);
+            static uPtr<PropertyReader> make (const internal::schema::Field &);
+            static uPtr<PropertyReader> make (const FieldPtr &);
+            static uPtr<PropertyReader> make (const std::string &);
 
             PropertyReader() = default;
             ~PropertyReader() override = default;
 
-            std::string readString (pn_data_t *) const override = 0;
+            std::string readString (cursor::Cursor &) const override = 0;
 
-            std::any read (pn_data_t *) const override = 0;
+            std::any read (cursor::Cursor &) const override = 0;
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &
             ) const override = 0;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &
             ) const override = 0;
 
             const std::string & name() const override = 0;
             const std::string & type() const override = 0;
+
+            /**
+             * The JVM writes primitive fields, and primitives boxed within
+             * collections, directly. Those that are objects on the JVM are
+             * numbered when they're elements
+             */
+            bool referenceable (bool) const override { return false; }
     };
 
 }
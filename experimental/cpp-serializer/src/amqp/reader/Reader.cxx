@@ -1,5 +1,8 @@
 #include "Reader.h"
 
+#include "ObjectTable.h"
+#include "cursor/Cursor.h"
+
 #include <memory>
 #include <sstream>
 
@@ -11,7 +14,7 @@ namespace {
         std::stringstream & m_stream;
 
         AutoMap (
-                const std::string & s,
+                std::string_view s,
                 std::stringstream & stream_
         ) : m_stream (stream_) {
             m_stream << s << " : { ";
@@ -32,7 +35,7 @@ namespace {
         std::stringstream & m_stream;
 
         AutoList (
-                const std::string & s,
+                std::string_view s,
                 std::stringstream & stream_
         ) : m_stream (stream_) {
             m_stream << s << " : [ ";
@@ -51,7 +54,7 @@ namespace {
 
     template<class Auto, class T>
     std::string
-    dumpPair (const std::string & name_, const T & begin_, const T & end_) {
+    dumpPair (std::string_view name_, const T & begin_, const T & end_) {
         std::stringstream rtn;
         {
             Auto am (name_, rtn);
@@ -116,6 +119,13 @@ TypedPair<sVec<uPtr<amqp::internal::reader::Pair>>>::dump() const {
     return ::dumpPair<AutoMap> (m_property, m_value.begin(), m_value.end());
 }
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sVec<uPtr<amqp::internal::reader::Pair>>>::dumpValue() const {
+    return ::dumpSingle<AutoMap> (m_value.begin(), m_value.end());
+}
+
 template<>
 std::string
 amqp::internal::reader::
@@ -123,6 +133,13 @@ TypedPair<sList<uPtr<amqp::internal::reader::Pair>>>::dump() const {
     return ::dumpPair<AutoMap> (m_property, m_value.begin(), m_value.end());
 }
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sList<uPtr<amqp::internal::reader::Pair>>>::dumpValue() const {
+    return ::dumpSingle<AutoMap> (m_value.begin(), m_value.end());
+}
+
 template<>
 std::string
 amqp::internal::reader::
@@ -130,6 +147,13 @@ TypedPair<sVec<uPtr<amqp::reader::IValue>>>::dump() const {
     return ::dumpPair<AutoMap> (m_property, m_value.begin(), m_value.end());
 }
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sVec<uPtr<amqp::reader::IValue>>>::dumpValue() const {
+    return ::dumpSingle<AutoMap> (m_value.begin(), m_value.end());
+}
+
 template<>
 std::string
 amqp::internal::reader::
@@ -137,6 +161,27 @@ TypedPair<sList<uPtr<amqp::reader::IValue>>>::dump() const {
     return ::dumpPair<AutoList> (m_property, m_value.begin(), m_value.end());
 }
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sList<uPtr<amqp::reader::IValue>>>::dumpValue() const {
+    return ::dumpSingle<AutoList> (m_value.begin(), m_value.end());
+}
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sSeq<uPtr<amqp::reader::IValue>>>::dump() const {
+    return ::dumpPair<AutoList> (m_property, m_value.begin(), m_value.end());
+}
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sSeq<uPtr<amqp::reader::IValue>>>::dumpValue() const {
+    return ::dumpSingle<AutoList> (m_value.begin(), m_value.end());
+}
+
 /******************************************************************************
  *
  *
@@ -150,6 +195,13 @@ TypedSingle<sList<uPtr<amqp::reader::IValue>>>::dump() const {
     return ::dumpSingle<AutoList> (m_value.begin(), m_value.end());
 }
 
+template<>
+std::string
+amqp::internal::reader::
+TypedSingle<sSeq<uPtr<amqp::reader::IValue>>>::dump() const {
+    return ::dumpSingle<AutoList> (m_value.begin(), m_value.end());
+}
+
 template<>
 std::string
 amqp::internal::reader::
@@ -172,3 +224,45 @@ TypedSingle<sVec<uPtr<amqp::internal::reader::Single>>>::dump() const {
 }
 
 /******************************************************************************/
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Reader
+ *
+ ******************************************************************************/
+
+void
+amqp::internal::reader::
+Reader::skip (cursor::Cursor & data_) const {
+    data_.skip();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Reader::write (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_
+) const {
+    sink_.key (name_);
+    ObjectTable::write (*this, data_, sink_, schema_, false);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Reader::visit (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_
+) const {
+    visitor_.onField (name_);
+    ObjectTable::visit (*this, data_, visitor_, schema_, false);
+}
+
+/******************************************************************************/
@@ -3,18 +3,79 @@
 /******************************************************************************/
 
 #include <any>
+#include <cstddef>
+#include <cstdint>
 #include <list>
 #include <string>
 #include <vector>
 #include <memory>
+#include <string_view>
 
 #include "amqp/schema/described-types/Schema.h"
 #include "amqp/reader/IReader.h"
+#include "format/Json.h"
+#include "format/Text.h"
+#include "format/Number.h"
 
 /******************************************************************************/
 
 namespace amqp::internal::reader {
 
+    /**
+     * An AMQP binary, viewing its bytes where they lie in the blob. Kept
+     * apart from a plain string_view so that it's rendered as bytes and
+     * not as text
+     */
+    class Binary {
+        private :
+            std::string_view m_bytes;
+
+        public :
+            explicit Binary (std::string_view bytes_) : m_bytes (bytes_) { }
+
+            const std::byte * data() const {
+                return reinterpret_cast<const std::byte *>(m_bytes.data());
+            }
+
+            size_t size() const { return m_bytes.size(); }
+
+            std::string_view view() const { return m_bytes; }
+    };
+
+    /**
+     * Milliseconds since the Unix epoch
+     */
+    struct Timestamp {
+        int64_t m_millis;
+    };
+
+    /**
+     * A uuid or decimal128, viewing their 16 raw bytes in the blob, each
+     * only turned into text when rendered
+     */
+    struct Uuid {
+        std::string_view m_bytes;
+    };
+
+    struct Decimal128 {
+        std::string_view m_bytes;
+    };
+
+    /**
+     * An enum constant, viewing its name where the enum's reader holds it
+     * rather than copying it out of the blob. Rendered bare, as the
+     * constant's name always was
+     */
+    struct Enumeration {
+        std::string_view m_name;
+        int32_t m_ordinal;
+    };
+
+    /**
+     * An unset nullable property
+     */
+    struct Null { };
+
     class Value : public amqp::reader::IValue {
         public :
             std::string dump() const override = 0;
@@ -23,7 +84,7 @@ namespace amqp::internal::reader {
     };
 
     /*
-     * A Single represents some value read out of a proton tree that
+     * A Single represents some value read out of an AMQP blob that
      * exists without an association. The canonical example is an
      * element of a list. The list itself would be a pair,
      *
@@ -70,28 +131,55 @@ namespace amqp::internal::reader {
             std::string dump() const override;
     };
 
+    /**
+     * Tags a [Pair]'s property as borrowed rather than copied, the caller
+     * guaranteeing whatever it views outlives the pair. Readers use it
+     * with the field names owned by the schema.
+     */
+    struct borrowed_t {
+        explicit borrowed_t() = default;
+    };
+
+    inline constexpr borrowed_t borrowed { };
+
     /*
      * A Pair represents an association between a property and
      * the value of the property, i.e. a : b where property
      * a has value b
      */
     class Pair : public Value {
+        private :
+            std::string m_owned;
+
         protected :
-            std::string m_property;
+            std::string_view m_property;
 
         public:
             explicit Pair (std::string property_)
                 : Value()
-                , m_property (std::move (property_))
+                , m_owned (std::move (property_))
+                , m_property (m_owned)
+            { }
+
+            Pair (borrowed_t, std::string_view property_)
+                : Value()
+                , m_property (property_)
             { }
 
             ~Pair() override = default;
 
             Pair (Pair && pair_) noexcept
-                : m_property (std::move (pair_.m_property))
+                : m_owned (std::move (pair_.m_owned))
+                , m_property (m_owned.empty() ? pair_.m_property : m_owned)
             { }
 
             std::string dump() const override = 0;
+
+            /**
+             * The dump without the property, for something referring to
+             * the value from elsewhere
+             */
+            virtual std::string dumpValue() const = 0;
     };
 
 
@@ -111,8 +199,13 @@ namespace amqp::internal::reader {
                 , m_value (std::move (value_))
             { }
 
+            TypedPair (borrowed_t, std::string_view property_, T && value_)
+                : Pair (borrowed, property_)
+                , m_value (std::move (value_))
+            { }
+
             TypedPair (TypedPair && pair_) noexcept
-                : Pair (std::move (pair_.m_property))
+                : Pair (std::move (pair_))
                 , m_value (std::move (pair_.m_value))
             { }
 
@@ -121,6 +214,7 @@ namespace amqp::internal::reader {
             }
 
             std::string dump() const override;
+            std::string dumpValue() const override;
     };
 
     /**
@@ -143,11 +237,111 @@ namespace amqp::internal::reader {
               , m_value (std::move (value_))
         { }
 
+        const amqp::reader::IValue & key() const { return *m_key; }
+        const amqp::reader::IValue & value() const { return *m_value; }
+
         std::string dump() const override;
     };
 
 }
 
+/******************************************************************************
+ *
+ * Rendering primitive values
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * Primitives are held in the tree as their native type and only turned
+     * into text when the tree is dumped. Strings and binaries are held as
+     * views into the blob so a tree mustn't outlive the bytes it was read
+     * from, whether a [CordaBytes] or a mapping, and enum constants as
+     * views of their reader's choices so nor must it outlive its readers
+     */
+    template<typename T>
+    inline std::string
+    render (T value_) {
+        return std::string (format::Number (value_).view());
+    }
+
+    template<>
+    inline std::string
+    render<bool> (bool value_) {
+        return value_ ? "1" : "0";
+    }
+
+    /**
+     * Quoted and escaped in a single pass
+     */
+    template<>
+    inline std::string
+    render<std::string_view> (std::string_view value_) {
+        std::string rtn;
+        rtn.reserve (value_.size() + 2);
+
+        rtn += '"';
+        format::escape (value_, [&rtn](std::string_view run_) { rtn.append (run_); });
+        rtn += '"';
+
+        return rtn;
+    }
+
+    template<>
+    inline std::string
+    render<Binary> (Binary value_) {
+        std::string rtn;
+        rtn.reserve ((value_.size() + 2) / 3 * 4 + 2);
+
+        rtn += '"';
+        format::base64 (value_.view(), [&rtn](std::string_view run_) { rtn.append (run_); });
+        rtn += '"';
+
+        return rtn;
+    }
+
+    template<>
+    inline std::string
+    render<char32_t> (char32_t value_) {
+        return render (format::Utf8 (value_).view());
+    }
+
+    template<>
+    inline std::string
+    render<Timestamp> (Timestamp value_) {
+        return render (format::Iso8601 (value_.m_millis).view());
+    }
+
+    template<>
+    inline std::string
+    render<Uuid> (Uuid value_) {
+        return render (format::Uuid (value_.m_bytes.data()).view());
+    }
+
+    template<>
+    inline std::string
+    render<Decimal128> (Decimal128 value_) {
+        return render (format::Decimal (value_.m_bytes.data()).view());
+    }
+
+    template<>
+    inline std::string
+    render<Enumeration> (Enumeration value_) {
+        return std::string (value_.m_name);
+    }
+
+    /**
+     * Short enough to live in the string itself, nothing's allocated
+     */
+    template<>
+    inline std::string
+    render<Null> (Null) {
+        return "null";
+    }
+
+}
+
 /******************************************************************************
  *
  * amqp::internal::reader::TypedSingle
@@ -158,7 +352,7 @@ template<typename T>
 inline std::string
 amqp::internal::reader::
 TypedSingle<T>::dump() const {
-    return std::to_string (m_value);
+    return render (m_value);
 }
 
 template<>
@@ -178,6 +372,11 @@ std::string
 amqp::internal::reader::
 TypedSingle<sList<uPtr<amqp::reader::IValue>>>::dump() const;
 
+template<>
+std::string
+amqp::internal::reader::
+TypedSingle<sSeq<uPtr<amqp::reader::IValue>>>::dump() const;
+
 template<>
 std::string
 amqp::internal::reader::
@@ -198,14 +397,28 @@ template<typename T>
 inline std::string
 amqp::internal::reader::
 TypedPair<T>::dump() const {
-    return m_property + " : " + std::to_string (m_value);
+    return std::string (m_property) + " : " + render (m_value);
 }
 
 template<>
 inline std::string
 amqp::internal::reader::
 TypedPair<std::string>::dump() const {
-    return m_property + " : " + m_value;
+    return std::string (m_property) + " : " + m_value;
+}
+
+template<typename T>
+inline std::string
+amqp::internal::reader::
+TypedPair<T>::dumpValue() const {
+    return render (m_value);
+}
+
+template<>
+inline std::string
+amqp::internal::reader::
+TypedPair<std::string>::dumpValue() const {
+    return m_value;
 }
 
 template<>
@@ -213,21 +426,51 @@ std::string
 amqp::internal::reader::
 TypedPair<sVec<uPtr<amqp::reader::IValue>>>::dump() const;
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sVec<uPtr<amqp::reader::IValue>>>::dumpValue() const;
+
 template<>
 std::string
 amqp::internal::reader::
 TypedPair<sList<uPtr<amqp::reader::IValue>>>::dump() const;
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sList<uPtr<amqp::reader::IValue>>>::dumpValue() const;
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sSeq<uPtr<amqp::reader::IValue>>>::dump() const;
+
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sSeq<uPtr<amqp::reader::IValue>>>::dumpValue() const;
+
 template<>
 std::string
 amqp::internal::reader::
 TypedPair<sVec<uPtr<amqp::internal::reader::Pair>>>::dump() const;
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sVec<uPtr<amqp::internal::reader::Pair>>>::dumpValue() const;
+
 template<>
 std::string
 amqp::internal::reader::
 TypedPair<sList<uPtr<amqp::internal::reader::Pair>>>::dump() const;
 
+template<>
+std::string
+amqp::internal::reader::
+TypedPair<sList<uPtr<amqp::internal::reader::Pair>>>::dumpValue() const;
+
 /******************************************************************************
  *
  *
@@ -256,17 +499,59 @@ namespace amqp::internal::reader  {
             const std::string & name() const override = 0;
             const std::string & type() const override = 0;
 
-            std::any read (struct pn_data_t *) const override = 0;
-            std::string readString (struct pn_data_t *) const override = 0;
+            std::any read (cursor::Cursor &) const override = 0;
+            std::string readString (cursor::Cursor &) const override = 0;
+
+            /**
+             * Every value, however compound, is skipped by its encoded
+             * size so no reader needs to do this differently
+             */
+            void skip (cursor::Cursor &) const final;
 
             uPtr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override = 0;
 
             uPtr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override = 0;
+
+            /**
+             * A named value is always just the key followed by the value
+             */
+            void write (
+                const std::string &,
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &) const final;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
                 const SchemaType &) const override = 0;
+
+            /**
+             * As with [write], a named value is the field then the value
+             */
+            void visit (
+                const std::string &,
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const final;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const override = 0;
+
+            /**
+             * Whether the JVM numbers a value this reader reads, and so
+             * whether a later REFERENCED_OBJECT can refer back to it, as
+             * a composite's field or, when [element_], as an element of a
+             * collection. Everything but a primitive is
+             */
+            virtual bool referenceable (bool element_) const { return true; }
     };
 
 }
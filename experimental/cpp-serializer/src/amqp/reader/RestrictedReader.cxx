@@ -1,8 +1,7 @@
 #include "RestrictedReader.h"
 
-#include <iostream>
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 #include "amqp/reader/IReader.h"
 #include "amqp/reader/Reader.h"
@@ -16,17 +15,9 @@ RestrictedReader::RestrictedReader (std::string type_)
 
 /******************************************************************************/
 
-const std::string
-amqp::internal::reader::
-RestrictedReader::m_name { // NOLINT
-    "Restricted Reader"
-};
-
-/******************************************************************************/
-
 std::any
 amqp::internal::reader::
-RestrictedReader::read (pn_data_t *) const {
+RestrictedReader::read (cursor::Cursor &) const {
     return std::any(1);
 }
 
@@ -34,7 +25,7 @@ RestrictedReader::read (pn_data_t *) const {
 
 std::string
 amqp::internal::reader::
-RestrictedReader::readString (pn_data_t * data_) const {
+RestrictedReader::readString (cursor::Cursor & data_) const {
     return "hello";
 }
 
@@ -43,7 +34,8 @@ RestrictedReader::readString (pn_data_t * data_) const {
 const std::string &
 amqp::internal::reader::
 RestrictedReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -6,33 +6,30 @@
 
 #include <any>
 #include <vector>
+#include <string_view>
 
 #include "amqp/schema/restricted-types/Restricted.h"
 
 /******************************************************************************/
 
-struct pn_data_t;
-
-/******************************************************************************/
-
 namespace amqp::internal::reader {
 
     class RestrictedReader : public Reader {
         private :
-            static const std::string m_name;
+            static constexpr std::string_view m_name { "Restricted Reader" };
             const std::string m_type;
 
         public :
             explicit RestrictedReader (std::string);
             ~RestrictedReader() override = default;
 
-            std::any read (pn_data_t *) const override ;
+            std::any read (cursor::Cursor &) const override ;
 
-            std::string readString (pn_data_t *) const override;
+            std::string readString (cursor::Cursor &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override = 0;
 
             const std::string & name() const override;
@@ -0,0 +1,48 @@
+#include "Sampling.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::reader::Sampling
+ *
+ ******************************************************************************/
+
+thread_local const amqp::internal::reader::Sampling *
+amqp::internal::reader::
+Sampling::m_current = nullptr;
+
+/******************************************************************************/
+
+namespace {
+
+    class Discard : public amqp::reader::ISink {
+        public :
+            void beginObject() override { }
+            void endObject() override { }
+            void beginList() override { }
+            void endList() override { }
+            void beginMap() override { }
+            void endMap() override { }
+            void key (std::string_view) override { }
+            void null() override { }
+            void boolean (bool) override { }
+            void integer (int64_t) override { }
+            void real (double) override { }
+            void string (std::string_view) override { }
+            void integers (const int64_t *, size_t) override { }
+            void reals (const double *, size_t) override { }
+            void symbol (std::string_view) override { }
+            void binary (std::string_view) override { }
+    };
+
+}
+
+/******************************************************************************/
+
+amqp::reader::ISink &
+amqp::internal::reader::
+Sampling::discard() {
+    static Discard sink;
+    return sink;
+}
+
+/******************************************************************************/
@@ -0,0 +1,168 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::reader::Sampling
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    /**
+     * How much of each collection to write. Whilst a [Scope] is active a
+     * list, array or map of more than [size] elements, or entries, is
+     * written as { "$count" : n, "$sample" : [ ... ] }, n being how many
+     * it holds and the sample either its first [size] or [size] spread
+     * evenly over the whole, from the first to the last. Smaller ones
+     * are written in full. Each element sampled is itself sampled should
+     * it hold collections of its own.
+     *
+     * Those not sampled are skipped over by their encoded size, except
+     * when [numbers] says the blob holds references. Then each is still
+     * decoded, into nothing, so its objects are numbered for a later
+     * reference to be resolved against.
+     */
+    class Sampling {
+        public :
+            enum Mode { first_t, uniform_t };
+
+        private :
+            static thread_local const Sampling * m_current;
+
+            Mode m_mode;
+            size_t m_size;
+            bool m_numbers;
+
+            /**
+             * Swallows the elements decoded only to be numbered
+             */
+            static amqp::reader::ISink & discard();
+
+        public :
+            /**
+             * Make [sampling_] the thread's current sampling until
+             * destroyed, restoring whatever was current before
+             */
+            class Scope {
+                private :
+                    const Sampling * m_previous;
+
+                public :
+                    explicit Scope (const Sampling & sampling_)
+                        : m_previous (m_current)
+                    {
+                        m_current = &sampling_;
+                    }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() {
+                        m_current = m_previous;
+                    }
+            };
+
+            Sampling (Mode mode_, size_t size_, bool numbers_ = false)
+                : m_mode (mode_)
+                , m_size (size_)
+                , m_numbers (numbers_)
+            { }
+
+            static const Sampling * current() { return m_current; }
+
+            Mode mode() const { return m_mode; }
+            size_t size() const { return m_size; }
+            bool numbers() const { return m_numbers; }
+
+            /**
+             * If the thread's current sampling would cut down a collection
+             * of [elements_] write the sample of it, each element or entry
+             * being [width_] nodes at the cursor written by [write_] into
+             * the sink it's handed, and return true. Otherwise leave the
+             * collection to the caller
+             */
+            template<class Write>
+            static bool write (
+                size_t elements_,
+                size_t width_,
+                cursor::Cursor & data_,
+                amqp::reader::ISink & sink_,
+                Write && write_);
+    };
+
+}
+
+/******************************************************************************/
+
+template<class Write>
+bool
+amqp::internal::reader::
+Sampling::write (
+    size_t elements_,
+    size_t width_,
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    Write && write_
+) {
+    const auto * sampling = m_current;
+
+    if (!sampling || elements_ <= sampling->m_size) return false;
+
+    sink_.beginObject();
+    sink_.key ("$count");
+    sink_.integer (static_cast<int64_t> (elements_));
+    sink_.key ("$sample");
+
+    width_ == 2 ? sink_.beginMap() : sink_.beginList();
+
+    /*
+     * The kth of a uniform sample is element k * (elements - 1) / (size
+     * - 1), which as there are more elements than that never repeats.
+     * It's worked out as k * q + k * r / (size - 1), q and r being the
+     * quotient and remainder of (elements - 1) / (size - 1), neither
+     * product of which can overflow as AMQP counts fewer than 2^32
+     * elements
+     */
+    const size_t spread = sampling->m_size > 1 ? sampling->m_size - 1 : 1;
+    const size_t quotient = (elements_ - 1) / spread;
+    const size_t remainder = (elements_ - 1) % spread;
+
+    size_t taken { 0 };
+    size_t next { 0 };
+
+    for (size_t i { 0 } ; i < elements_ ; ++i) {
+        /*
+         * Leaving the collection early, its parent skips it whole
+         */
+        if (taken == sampling->m_size && !sampling->m_numbers) break;
+
+        if (i == next && taken < sampling->m_size) {
+            write_ (sink_);
+
+            ++taken;
+            next = sampling->m_mode == first_t
+                ? taken
+                : sampling->m_size == 1 ? elements_ : taken * quotient + taken * remainder / spread;
+        } else if (sampling->m_numbers) {
+            write_ (discard());
+        } else if (!data_.skip (width_) && i + 1 < elements_) {
+            throw std::runtime_error ("Collection ends before its last element");
+        }
+    }
+
+    width_ == 2 ? sink_.endMap() : sink_.endList();
+
+    sink_.endObject();
+
+    return true;
+}
+
+/******************************************************************************/
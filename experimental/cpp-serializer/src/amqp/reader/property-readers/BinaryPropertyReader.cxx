@@ -0,0 +1,102 @@
+#include "BinaryPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Json.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * BinaryPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+BinaryPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { PrimitiveKernel<Primitive::binary_t>::read (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+BinaryPropertyReader::readString (cursor::Cursor & data_) const {
+    std::string rtn;
+
+    format::base64 (PrimitiveKernel<Primitive::binary_t>::read (data_).view(), [&rtn](std::string_view run_) {
+        rtn.append (run_);
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+BinaryPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::binary_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+BinaryPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::binary_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BinaryPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::binary_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BinaryPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::binary_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+BinaryPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+BinaryPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
@@ -1,26 +1,7 @@
 #include "BoolPropertyReader.h"
 
-#include "proton/proton_wrapper.h"
-
-/******************************************************************************
- *
- * BoolPropertyReader statics
- *
- ******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-BoolPropertyReader::m_name { // NOLINT
-        "Bool Reader"
-};
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-BoolPropertyReader::m_type { // NOLINT
-        "bool"
-};
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
 
 /******************************************************************************
  *
@@ -30,16 +11,16 @@ BoolPropertyReader::m_type { // NOLINT
 
 std::any
 amqp::internal::reader::
-BoolPropertyReader::read (pn_data_t * data_) const {
-    return std::any (proton::readAndNext<bool> (data_));
+BoolPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any (cursor::readAndNext<bool> (data_));
 }
 
 /******************************************************************************/
 
 std::string
 amqp::internal::reader::
-BoolPropertyReader::readString (pn_data_t * data_) const {
-    return std::to_string (proton::readAndNext<bool> (data_));
+BoolPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<bool> (data_));
 }
 
 /******************************************************************************/
@@ -48,12 +29,10 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 BoolPropertyReader::dump (
         const std::string & name_,
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_) const
 {
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            std::to_string (proton::readAndNext<bool> (data_)));
+    return reader::dump<Primitive::boolean_t> (name_, data_);
 }
 
 /******************************************************************************/
@@ -61,11 +40,34 @@ BoolPropertyReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 BoolPropertyReader::dump (
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_) const
 {
-    return std::make_unique<TypedSingle<std::string>> (
-            std::to_string (proton::readAndNext<bool> (data_)));
+    return reader::dump<Primitive::boolean_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BoolPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::boolean_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BoolPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::boolean_t> (data_, visitor_);
 }
 
 /******************************************************************************/
@@ -73,7 +75,8 @@ BoolPropertyReader::dump (
 const std::string &
 amqp::internal::reader::
 BoolPropertyReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -81,7 +84,8 @@ BoolPropertyReader::name() const {
 const std::string &
 amqp::internal::reader::
 BoolPropertyReader::type() const {
-    return m_type;
+    static const std::string rtn { m_type };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -0,0 +1,95 @@
+#include "BytePropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * BytePropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+BytePropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<int8_t> (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+BytePropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<int8_t> (data_));
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+BytePropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::byte_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+BytePropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::byte_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BytePropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::byte_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+BytePropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::byte_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+BytePropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+BytePropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
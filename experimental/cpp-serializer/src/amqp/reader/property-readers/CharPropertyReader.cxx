@@ -0,0 +1,96 @@
+#include "CharPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Text.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * CharPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+CharPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<char32_t> (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+CharPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (format::Utf8 (cursor::readAndNext<char32_t> (data_)).view());
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+CharPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::char_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+CharPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::char_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+CharPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::char_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+CharPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::char_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+CharPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+CharPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,96 @@
+#include "Decimal128PropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Text.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * Decimal128PropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+Decimal128PropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { PrimitiveKernel<Primitive::decimal128_t>::read (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+Decimal128PropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (format::Decimal (PrimitiveKernel<Primitive::decimal128_t>::read (data_).m_bytes.data()).view());
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+Decimal128PropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::decimal128_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+Decimal128PropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::decimal128_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Decimal128PropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::decimal128_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+Decimal128PropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::decimal128_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+Decimal128PropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+Decimal128PropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,56 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string_view>
+
+#include "PropertyReader.h"
+
+/******************************************************************************/
+
+namespace amqp::internal::reader {
+
+    class Decimal128PropertyReader : public PropertyReader {
+        private :
+            static constexpr std::string_view m_name { "Decimal128 Reader" };
+            static constexpr std::string_view m_type { "decimal128" };
+
+        public :
+            std::string readString (cursor::Cursor &) const override;
+
+            std::any read (cursor::Cursor &) const override;
+
+            uPtr<amqp::reader::IValue> dump (
+                const std::string &,
+                cursor::Cursor &,
+                const SchemaType &
+            ) const override;
+
+            uPtr<amqp::reader::IValue> dump (
+                cursor::Cursor &,
+                const SchemaType &
+            ) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &
+            ) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &
+            ) const override;
+
+            const std::string & name() const override;
+            const std::string & type() const override;
+
+            /**
+             * Numbered only as an element, never as a field
+             */
+            bool referenceable (bool element_) const override { return element_; }
+    };
+}
+
+/******************************************************************************/
@@ -1,24 +1,7 @@
 #include "DoublePropertyReader.h"
 
-#include "proton/proton_wrapper.h"
-
-/******************************************************************************
- *
- * DoublePropertyReader statics
- *
- ******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-DoublePropertyReader::m_name { // NOLINT
-    "Double Reader"
-};
-
-const std::string
-amqp::internal::reader::
-DoublePropertyReader::m_type { // NOLINT
-    "double"
-};
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
 
 /******************************************************************************
  *
@@ -28,16 +11,16 @@ DoublePropertyReader::m_type { // NOLINT
 
 std::any
 amqp::internal::reader::
-DoublePropertyReader::read (pn_data_t * data_) const {
-    return std::any { proton::readAndNext<double> (data_) };
+DoublePropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<double> (data_) };
 }
 
 /******************************************************************************/
 
 std::string
 amqp::internal::reader::
-DoublePropertyReader::readString (pn_data_t * data_) const {
-    return std::to_string (proton::readAndNext<double> (data_));
+DoublePropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<double> (data_));
 }
 
 /******************************************************************************/
@@ -46,12 +29,10 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 DoublePropertyReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            std::to_string (proton::readAndNext<double> (data_)));
+    return reader::dump<Primitive::double_t> (name_, data_);
 }
 
 /******************************************************************************/
@@ -59,11 +40,34 @@ DoublePropertyReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 DoublePropertyReader::dump (
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_) const
 {
-    return std::make_unique<TypedSingle<std::string>> (
-            std::to_string (proton::readAndNext<double> (data_)));
+    return reader::dump<Primitive::double_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+DoublePropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::double_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+DoublePropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::double_t> (data_, visitor_);
 }
 
 /******************************************************************************/
@@ -71,7 +75,8 @@ DoublePropertyReader::dump (
 const std::string &
 amqp::internal::reader::
 DoublePropertyReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -79,7 +84,8 @@ DoublePropertyReader::name() const {
 const std::string &
 amqp::internal::reader::
 DoublePropertyReader::type() const {
-    return m_type;
+    static const std::string rtn { m_type };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -0,0 +1,96 @@
+#include "FloatPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Number.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * FloatPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+FloatPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<float> (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+FloatPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (format::Number (cursor::readAndNext<float> (data_)).view());
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+FloatPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::float_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+FloatPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::float_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+FloatPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::float_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+FloatPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::float_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+FloatPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+FloatPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
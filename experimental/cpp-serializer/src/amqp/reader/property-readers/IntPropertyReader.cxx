@@ -3,31 +3,11 @@
 
 #include <any>
 #include <string>
-#include <proton/codec.h>
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
 #include "amqp/reader/IReader.h"
 
-/******************************************************************************
- *
- * IntPropertyReader statics
- *
- ******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-IntPropertyReader::m_name { // NOLINT
-    "Int Reader"
-};
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-IntPropertyReader::m_type { // NOLINT
-    "int"
-};
-
 /******************************************************************************
  *
  * IntPropertyReader
@@ -36,16 +16,16 @@ IntPropertyReader::m_type { // NOLINT
 
 std::any
 amqp::internal::reader::
-IntPropertyReader::read (pn_data_t * data_) const {
-    return std::any { proton::readAndNext<int> (data_) };
+IntPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<int32_t> (data_) };
 }
 
 /******************************************************************************/
 
 std::string
 amqp::internal::reader::
-IntPropertyReader::readString (pn_data_t * data_) const {
-    return std::to_string (proton::readAndNext<int> (data_));
+IntPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<int32_t> (data_));
 }
 
 /******************************************************************************/
@@ -54,12 +34,10 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 IntPropertyReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            std::to_string (proton::readAndNext<int> (data_)));
+    return reader::dump<Primitive::int_t> (name_, data_);
 }
 
 /******************************************************************************/
@@ -67,11 +45,34 @@ IntPropertyReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 IntPropertyReader::dump (
-    pn_data_t * data_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::int_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+IntPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::int_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+IntPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedSingle<std::string>> (
-            std::to_string (proton::readAndNext<int> (data_)));
+    reader::visit<Primitive::int_t> (data_, visitor_);
 }
 
 /******************************************************************************/
@@ -79,7 +80,8 @@ IntPropertyReader::dump (
 const std::string &
 amqp::internal::reader::
 IntPropertyReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -87,7 +89,8 @@ IntPropertyReader::name() const {
 const std::string &
 amqp::internal::reader::
 IntPropertyReader::type() const {
-    return m_type;
+    static const std::string rtn { m_type };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -1,26 +1,7 @@
 #include "LongPropertyReader.h"
 
-#include "proton/proton_wrapper.h"
-
-/******************************************************************************
- *
- * LongPropertyReader statics
- *
- ******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-LongPropertyReader::m_name { // NOLINT
-        "Long Reader"
-};
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-LongPropertyReader::m_type { // NOLINT
-        "long"
-};
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
 
 /******************************************************************************
  *
@@ -30,16 +11,16 @@ LongPropertyReader::m_type { // NOLINT
 
 std::any
 amqp::internal::reader::
-LongPropertyReader::read (pn_data_t * data_) const {
-    return std::any { proton::readAndNext<long> (data_) };
+LongPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<int64_t> (data_) };
 }
 
 /******************************************************************************/
 
 std::string
 amqp::internal::reader::
-LongPropertyReader::readString (pn_data_t * data_) const {
-    return std::to_string (proton::readAndNext<long> (data_));
+LongPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<int64_t> (data_));
 }
 
 /******************************************************************************/
@@ -48,12 +29,10 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 LongPropertyReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            std::to_string (proton::readAndNext<long> (data_)));
+    return reader::dump<Primitive::long_t> (name_, data_);
 }
 
 /******************************************************************************/
@@ -61,11 +40,34 @@ LongPropertyReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 LongPropertyReader::dump (
-    pn_data_t * data_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::long_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+LongPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::long_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+LongPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedSingle<std::string>> (
-            std::to_string (proton::readAndNext<long> (data_)));
+    reader::visit<Primitive::long_t> (data_, visitor_);
 }
 
 /******************************************************************************/
@@ -73,7 +75,8 @@ LongPropertyReader::dump (
 const std::string &
 amqp::internal::reader::
 LongPropertyReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -81,7 +84,8 @@ LongPropertyReader::name() const {
 const std::string &
 amqp::internal::reader::
 LongPropertyReader::type() const {
-    return m_type;
+    static const std::string rtn { m_type };
+    return rtn;
 }
 
 /******************************************************************************/
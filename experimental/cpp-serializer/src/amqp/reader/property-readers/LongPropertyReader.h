@@ -2,6 +2,8 @@
 
 /******************************************************************************/
 
+#include <string_view>
+
 #include "PropertyReader.h"
 
 /******************************************************************************/
@@ -10,22 +12,34 @@ namespace amqp::internal::reader {
 
     class LongPropertyReader : public PropertyReader {
         private :
-            static const std::string m_name;
-            static const std::string m_type;
+            static constexpr std::string_view m_name { "Long Reader" };
+            static constexpr std::string_view m_type { "long" };
 
         public :
-            std::string readString (pn_data_t *) const override;
+            std::string readString (cursor::Cursor &) const override;
 
-            std::any read (pn_data_t *) const override;
+            std::any read (cursor::Cursor &) const override;
 
             uPtr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &
             ) const override;
 
             uPtr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &
+            ) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &
+            ) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
                 const SchemaType &
             ) const override;
 
@@ -0,0 +1,95 @@
+#include "ShortPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * ShortPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+ShortPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<int16_t> (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+ShortPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::to_string (cursor::readAndNext<int16_t> (data_));
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+ShortPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::short_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+ShortPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::short_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ShortPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::short_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ShortPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::short_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+ShortPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+ShortPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
@@ -1,28 +1,9 @@
 #include "StringPropertyReader.h"
 
-#include <proton/codec.h>
 
-#include "proton/proton_wrapper.h"
-
-/******************************************************************************
- *
- * StringPropertyReader statics
- *
- ******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-StringPropertyReader::m_type { // NOLINT
-        "string"
-};
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::reader::
-StringPropertyReader::m_name { // NOLINT
-        "String Reader"
-};
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "stats/Stats.h"
 
 /******************************************************************************
  *
@@ -32,16 +13,16 @@ StringPropertyReader::m_name { // NOLINT
 
 std::any
 amqp::internal::reader::
-StringPropertyReader::read (pn_data_t * data_) const {
-    return std::any { proton::readAndNext<std::string> (data_) };
+StringPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { cursor::readAndNext<std::string> (data_) };
 }
 
 /******************************************************************************/
 
 std::string
 amqp::internal::reader::
-StringPropertyReader::readString (pn_data_t * data_) const {
-    return proton::readAndNext<std::string> (data_);
+StringPropertyReader::readString (cursor::Cursor & data_) const {
+    return cursor::readAndNext<std::string> (data_);
 }
 
 /******************************************************************************/
@@ -50,12 +31,10 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 StringPropertyReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_) const
 {
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            "\"" + proton::readAndNext<std::string> (data_) + "\"");
+    return reader::dump<Primitive::string_t> (name_, data_);
 }
 
 /******************************************************************************/
@@ -63,11 +42,34 @@ StringPropertyReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 StringPropertyReader::dump (
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_) const
 {
-    return std::make_unique<TypedSingle<std::string>> (
-            "\"" + proton::readAndNext<std::string> (data_) + "\"");
+    return reader::dump<Primitive::string_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+StringPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::string_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+StringPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::string_t> (data_, visitor_);
 }
 
 /******************************************************************************/
@@ -75,7 +77,8 @@ StringPropertyReader::dump (
 const std::string &
 amqp::internal::reader::
 StringPropertyReader::name() const {
-    return m_name;
+    static const std::string rtn { m_name };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -83,7 +86,8 @@ StringPropertyReader::name() const {
 const std::string &
 amqp::internal::reader::
 StringPropertyReader::type() const {
-    return m_type;
+    static const std::string rtn { m_type };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -2,6 +2,8 @@
 
 /******************************************************************************/
 
+#include <string_view>
+
 #include "PropertyReader.h"
 
 /******************************************************************************/
@@ -10,27 +12,44 @@ namespace amqp::internal::reader {
 
     class StringPropertyReader : public PropertyReader {
         private :
-            static const std::string m_name;
-            static const std::string m_type;
+            static constexpr std::string_view m_name { "String Reader" };
+            static constexpr std::string_view m_type { "string" };
 
         public :
-            std::string readString (pn_data_t *) const override;
+            std::string readString (cursor::Cursor &) const override;
 
-            std::any read (pn_data_t *) const override;
+            std::any read (cursor::Cursor &) const override;
 
             uPtr<amqp::reader::IValue> dump (
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &
             ) const override;
 
             uPtr<amqp::reader::IValue> dump (
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &
+            ) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &
+            ) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
                 const SchemaType &
             ) const override;
 
             const std::string & name() const override;
             const std::string & type() const override;
+
+            /**
+             * Numbered only as an element, never as a field
+             */
+            bool referenceable (bool element_) const override { return element_; }
     };
 }
 
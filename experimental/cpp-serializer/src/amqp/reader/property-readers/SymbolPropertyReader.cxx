@@ -0,0 +1,95 @@
+#include "SymbolPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * SymbolPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+SymbolPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { PrimitiveKernel<Primitive::symbol_t>::read (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+SymbolPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (PrimitiveKernel<Primitive::symbol_t>::read (data_));
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+SymbolPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::symbol_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+SymbolPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::symbol_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+SymbolPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::symbol_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+SymbolPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::symbol_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+SymbolPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+SymbolPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
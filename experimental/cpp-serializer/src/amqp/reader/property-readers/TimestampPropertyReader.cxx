@@ -0,0 +1,96 @@
+#include "TimestampPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Text.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * TimestampPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+TimestampPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { PrimitiveKernel<Primitive::timestamp_t>::read (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+TimestampPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (format::Iso8601 (PrimitiveKernel<Primitive::timestamp_t>::read (data_).m_millis).view());
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+TimestampPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::timestamp_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+TimestampPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::timestamp_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+TimestampPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::timestamp_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+TimestampPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::timestamp_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+TimestampPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+TimestampPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
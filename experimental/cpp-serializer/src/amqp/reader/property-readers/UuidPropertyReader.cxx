@@ -0,0 +1,96 @@
+#include "UuidPropertyReader.h"
+
+#include <any>
+#include <string>
+
+#include "cursor/Cursor.h"
+#include "amqp/reader/Primitive.h"
+#include "format/Text.h"
+#include "amqp/reader/IReader.h"
+
+/******************************************************************************
+ *
+ * UuidPropertyReader
+ *
+ ******************************************************************************/
+
+std::any
+amqp::internal::reader::
+UuidPropertyReader::read (cursor::Cursor & data_) const {
+    return std::any { PrimitiveKernel<Primitive::uuid_t>::read (data_) };
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reader::
+UuidPropertyReader::readString (cursor::Cursor & data_) const {
+    return std::string (format::Uuid (PrimitiveKernel<Primitive::uuid_t>::read (data_).m_bytes.data()).view());
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+UuidPropertyReader::dump (
+    const std::string & name_,
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::uuid_t> (name_, data_);
+}
+
+/******************************************************************************/
+
+uPtr<amqp::reader::IValue>
+amqp::internal::reader::
+UuidPropertyReader::dump (
+    cursor::Cursor & data_,
+    const SchemaType & schema_) const
+{
+    return reader::dump<Primitive::uuid_t> (data_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+UuidPropertyReader::write (
+    cursor::Cursor & data_,
+    amqp::reader::ISink & sink_,
+    const SchemaType & schema_) const
+{
+    reader::write<Primitive::uuid_t> (data_, sink_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+UuidPropertyReader::visit (
+    cursor::Cursor & data_,
+    amqp::reader::IVisitor & visitor_,
+    const SchemaType & schema_) const
+{
+    reader::visit<Primitive::uuid_t> (data_, visitor_);
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+UuidPropertyReader::name() const {
+    static const std::string rtn { m_name };
+    return rtn;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::reader::
+UuidPropertyReader::type() const {
+    static const std::string rtn { m_type };
+    return rtn;
+}
+
+/******************************************************************************/
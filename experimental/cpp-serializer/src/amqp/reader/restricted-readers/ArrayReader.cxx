@@ -1,6 +1,85 @@
 #include "ArrayReader.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Bulk.h"
+#include "cursor/Cursor.h"
+#include "stats/Stats.h"
+#include "amqp/reader/ObjectTable.h"
+#include "amqp/reader/Sampling.h"
+
+#include "amqp/reader/property-readers/IntPropertyReader.h"
+#include "amqp/reader/property-readers/LongPropertyReader.h"
+#include "amqp/reader/property-readers/DoublePropertyReader.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using Primitive = amqp::internal::reader::ArrayReader::Primitive;
+
+    Primitive
+    primitiveOf (const amqp::internal::reader::Reader * reader_) {
+        using namespace amqp::internal::reader;
+
+        if (dynamic_cast<const IntPropertyReader *> (reader_)) {
+            return ArrayReader::int_t;
+        } else if (dynamic_cast<const LongPropertyReader *> (reader_)) {
+            return ArrayReader::long_t;
+        } else if (dynamic_cast<const DoublePropertyReader *> (reader_)) {
+            return ArrayReader::double_t;
+        }
+
+        return ArrayReader::none_t;
+    }
+
+    /**
+     * Every array on a thread decodes into the same buffers, they're
+     * only ever needed until its elements have been handed on
+     */
+    std::vector<int64_t> &
+    integers() {
+        static thread_local std::vector<int64_t> buffer;
+        return buffer;
+    }
+
+    std::vector<double> &
+    reals() {
+        static thread_local std::vector<double> buffer;
+        return buffer;
+    }
+
+    /**
+     * Bulk decode the list or array at the cursor, calling [integers_] or
+     * [reals_] with the buffer it went into
+     */
+    template<typename Integers, typename Reals>
+    bool
+    bulk (
+        Primitive primitive_,
+        const amqp::internal::cursor::Cursor & data_,
+        Integers && integers_,
+        Reals && reals_
+    ) {
+        namespace cursor = amqp::internal::cursor;
+
+        switch (primitive_) {
+            case amqp::internal::reader::ArrayReader::int_t :
+                if (!cursor::readInts (data_.encoded(), integers())) return false;
+                integers_ (integers());
+                return true;
+            case amqp::internal::reader::ArrayReader::long_t :
+                if (!cursor::readLongs (data_.encoded(), integers())) return false;
+                integers_ (integers());
+                return true;
+            case amqp::internal::reader::ArrayReader::double_t :
+                if (!cursor::readDoubles (data_.encoded(), reals())) return false;
+                reals_ (reals());
+                return true;
+            default :
+                return false;
+        }
+    }
+
+}
 
 /******************************************************************************
  *
@@ -11,9 +90,10 @@
 amqp::internal::reader::
 ArrayReader::ArrayReader (
     std::string type_,
-    std::weak_ptr<Reader> reader_
+    const Reader * reader_
 ) : RestrictedReader (std::move (type_))
-  , m_reader (std::move (reader_))
+  , m_reader (reader_)
+  , m_primitive (primitiveOf (m_reader))
 { }
 
 /******************************************************************************/
@@ -30,13 +110,13 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 ArrayReader::dump (
         const std::string & name_,
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
-    return std::make_unique<TypedPair<sList<uPtr<amqp::reader::IValue>>>>(
-            name_,
+    return std::make_unique<TypedPair<sSeq<uPtr<amqp::reader::IValue>>>>(
+            borrowed, name_,
             dump_ (data_, schema_));
 }
 
@@ -45,36 +125,67 @@ ArrayReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 ArrayReader::dump(
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
-    return std::make_unique<TypedSingle<sList<uPtr<amqp::reader::IValue>>>>(
+    return std::make_unique<TypedSingle<sSeq<uPtr<amqp::reader::IValue>>>>(
             dump_ (data_, schema_));
 }
 
 /******************************************************************************/
 
-sList<uPtr<amqp::reader::IValue>>
+sSeq<uPtr<amqp::reader::IValue>>
 amqp::internal::reader::
 ArrayReader::dump_(
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::is_described (data_);
+    cursor::is_described (data_);
 
     decltype (dump_ (data_, schema_)) read;
 
     {
-        proton::auto_enter ae (data_);
-        schema_.fromDescriptor (proton::readAndNext<std::string>(data_));
+        cursor::auto_enter ae (data_);
+        cursor::readAndNext<std::string_view>(data_);
+
+        auto values = [&read, this](const auto & values_) {
+            stats::Stats::count (stats::Stats::elements_t, values_.size());
+
+            read.reserve (values_.size());
+
+            for (auto value : values_) {
+                switch (m_primitive) {
+                    case int_t :
+                        read.emplace_back (std::make_unique<TypedSingle<int32_t>> (
+                                static_cast<int32_t> (value)));
+                        break;
+                    case long_t :
+                        read.emplace_back (std::make_unique<TypedSingle<int64_t>> (
+                                static_cast<int64_t> (value)));
+                        break;
+                    default :
+                        read.emplace_back (std::make_unique<TypedSingle<double>> (
+                                static_cast<double> (value)));
+                        break;
+                }
+            }
+        };
+
+        if (bulk (m_primitive, data_, values, values)) {
+            return read;
+        }
 
         {
-            proton::auto_list_enter ale (data_, true);
+            cursor::auto_list_enter ale (data_, true);
+
+            stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+            read.reserve (ale.elements());
 
             for (size_t i { 0 } ; i < ale.elements() ; ++i) {
-                read.emplace_back (m_reader.lock()->dump (data_, schema_));
+                read.emplace_back (ObjectTable::dump (*m_reader, data_, schema_));
             }
         }
     }
@@ -84,3 +195,113 @@ ArrayReader::dump_(
 
 /******************************************************************************/
 
+void
+amqp::internal::reader::
+ArrayReader::write (
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    /*
+     * Sampled, the elements are written one at a time
+     */
+    const auto * sampling = Sampling::current();
+
+    if (!(sampling && data_.get_list() > sampling->size()) && writeBulk (m_primitive, data_, sink_)) return;
+
+    cursor::auto_list_enter ale (data_, true);
+
+    stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+    auto reader = m_reader;
+
+    if (Sampling::write (ale.elements(), 1, data_, sink_, [&](amqp::reader::ISink & into_) {
+        ObjectTable::write (*reader, data_, into_, schema_, true);
+    })) {
+        return;
+    }
+
+    sink_.beginList();
+    for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+        ObjectTable::write (*reader, data_, sink_, schema_, true);
+    }
+    sink_.endList();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ArrayReader::visit (
+        cursor::Cursor & data_,
+        amqp::reader::IVisitor & visitor_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    auto visit = [&visitor_, this](const auto & values_) {
+        stats::Stats::count (stats::Stats::elements_t, values_.size());
+
+        visitor_.onBeginList (values_.size());
+        for (auto value : values_) {
+            switch (m_primitive) {
+                case int_t  : visitor_.onInt (static_cast<int32_t> (value)); break;
+                case long_t : visitor_.onLong (static_cast<int64_t> (value)); break;
+                default     : visitor_.onDouble (static_cast<double> (value)); break;
+            }
+        }
+        visitor_.onEndList();
+    };
+
+    if (bulk (m_primitive, data_, visit, visit)) return;
+
+    cursor::auto_list_enter ale (data_, true);
+
+    stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+    visitor_.onBeginList (ale.elements());
+    for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+        ObjectTable::visit (*m_reader, data_, visitor_, schema_, true);
+    }
+    visitor_.onEndList();
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::reader::
+ArrayReader::writeBulk (
+        Primitive primitive_,
+        const cursor::Cursor & data_,
+        amqp::reader::ISink & sink_
+) {
+    return bulk (
+        primitive_,
+        data_,
+        [&sink_](const std::vector<int64_t> & values_) {
+            stats::Stats::count (stats::Stats::elements_t, values_.size());
+
+            sink_.beginList();
+            sink_.integers (values_.data(), values_.size());
+            sink_.endList();
+        },
+        [&sink_](const std::vector<double> & values_) {
+            stats::Stats::count (stats::Stats::elements_t, values_.size());
+
+            sink_.beginList();
+            sink_.reals (values_.data(), values_.size());
+            sink_.endList();
+        });
+}
+
+/******************************************************************************/
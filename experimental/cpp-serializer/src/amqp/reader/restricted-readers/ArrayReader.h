@@ -9,12 +9,20 @@
 namespace amqp::internal::reader {
 
     class ArrayReader : public RestrictedReader {
+        public :
+            /**
+             * The element types whose arrays are decoded in bulk
+             */
+            enum Primitive { none_t, int_t, long_t, double_t };
+
         private :
             // How to read the underlying types
-            std::weak_ptr<Reader> m_reader;
+            const Reader * m_reader;
 
-            std::list<uPtr<amqp::reader::IValue>> dump_(
-                pn_data_t *,
+            Primitive m_primitive;
+
+            sSeq<uPtr<amqp::reader::IValue>> dump_(
+                cursor::Cursor &,
                 const SchemaType &) const;
 
             /**
@@ -23,7 +31,7 @@ namespace amqp::internal::reader {
             std::string m_primType;
 
         public :
-            ArrayReader (std::string, std::weak_ptr<Reader>);
+            ArrayReader (std::string, const Reader *);
 
             ~ArrayReader() final = default;
 
@@ -31,12 +39,36 @@ namespace amqp::internal::reader {
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
                 const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const override;
+
+            const Reader * reader() const { return m_reader; }
+
+            Primitive primitive() const { return m_primitive; }
+
+            /**
+             * Decode the list or array of [primitive_] at the cursor into
+             * [sink_] in one go, leaving the cursor where it was. False,
+             * with nothing written, when it can't be done like that
+             */
+            static bool writeBulk (
+                Primitive primitive_,
+                const cursor::Cursor &,
+                amqp::reader::ISink &);
     };
 
 }
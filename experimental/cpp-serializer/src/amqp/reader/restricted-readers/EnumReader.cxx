@@ -1,9 +1,11 @@
 #include "EnumReader.h"
 
+#include <sstream>
+
 #include "amqp/reader/IReader.h"
 #include "amqp/schema/Descriptors.h"
 #include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 /******************************************************************************/
 
@@ -19,45 +21,39 @@ EnumReader::EnumReader (
 
 /******************************************************************************/
 
-namespace {
-
-    std::string
-    getValue (pn_data_t * data_) {
-        proton::is_described (data_);
-
-        {
-            proton::auto_enter ae (data_);
-
-            /*
-             * Referenced objects are added to a stream when the serialiser
-             * notices it's writing a value it's already written, so to save
-             * space it will just link back to that. Currently we have
-             * no mechanism for decoding that so just throw an error
-             */
-            if (pn_data_type (data_) == PN_ULONG) {
-                if (amqp::stripCorda(pn_data_get_ulong(data_)) ==
-                amqp::schema::descriptors::REFERENCED_OBJECT
-            ) {
-                    throw std::runtime_error (
-                            "Currently don't support referenced objects");
-                }
-            }
-
-            auto fingerprint = proton::readAndNext<std::string>(data_);
-
-            proton::auto_list_enter ale (data_, true);
-
-            return proton::readAndNext<std::string>(data_);
-
-            /*
-             * After a string representation of the enumerated value
-             * the ordinal value is also encoded. We don't need that for
-             * just dumping things to a string but if I don't leave this
-             * here I'll forget its even a thing
-             */
-            // auto idx = proton::readAndNext<int>(data_);
-        }
+/**
+ * An enum is encoded as a described list of its constant's name and its
+ * ordinal. Only the ordinal is read, the name being looked up amongst the
+ * choices the schema gave the enum, so decoding one never copies a string
+ * out of the blob
+ */
+amqp::internal::reader::Enumeration
+amqp::internal::reader::
+EnumReader::choice (cursor::Cursor & data_) const {
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
+
+    /*
+     * A referenced enum never gets here, it's resolved against
+     * the [ObjectTable] by whatever holds it
+     */
+    cursor::readAndNext<std::string_view> (data_);
+
+    cursor::auto_list_enter ale (data_, true);
+
+    // skip the constant's name
+    data_.next();
+
+    auto ordinal = cursor::readAndNext<int32_t> (data_);
+
+    if (ordinal < 0 || static_cast<size_t> (ordinal) >= m_choices.size()) {
+        std::stringstream ss;
+        ss << type() << " has " << m_choices.size()
+           << " constants but found the ordinal " << ordinal;
+        throw std::runtime_error (ss.str());
     }
+
+    return Enumeration { m_choices[ordinal], ordinal };
 }
 
 /******************************************************************************/
@@ -66,15 +62,15 @@ std::unique_ptr<amqp::reader::IValue>
 amqp::internal::reader::
 EnumReader::dump (
         const std::string & name_,
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
-    proton::is_described (data_);
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
 
-    return std::make_unique<TypedPair<std::string>> (
-            name_,
-            getValue(data_));
+    return std::make_unique<TypedPair<Enumeration>> (
+            borrowed, name_,
+            choice (data_));
 }
 
 /******************************************************************************/
@@ -82,13 +78,43 @@ EnumReader::dump (
 std::unique_ptr<amqp::reader::IValue>
 amqp::internal::reader::
 EnumReader::dump(
-        pn_data_t * data_,
+        cursor::Cursor & data_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    return std::make_unique<TypedSingle<Enumeration>> (choice (data_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+EnumReader::write (
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    sink_.symbol (choice (data_).m_name);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+EnumReader::visit (
+        cursor::Cursor & data_,
+        amqp::reader::IVisitor & visitor_,
         const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
-    proton::is_described (data_);
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
 
-    return std::make_unique<TypedSingle<std::string>> (getValue(data_));
+    visitor_.onEnum (choice (data_).m_name);
 }
 
 /******************************************************************************/
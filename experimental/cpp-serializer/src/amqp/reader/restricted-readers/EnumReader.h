@@ -12,13 +12,29 @@ namespace amqp::internal::reader {
         public :
             EnumReader (std::string, std::vector<std::string>);
 
+            /**
+             * The constant at [data_], which must be positioned on the
+             * enum's descriptor, checked against the schema's choices
+             */
+            Enumeration choice (cursor::Cursor & data_) const;
+
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
+                const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
                 const SchemaType &) const override;
     };
 
@@ -1,6 +1,9 @@
 #include "ListReader.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "stats/Stats.h"
+#include "amqp/reader/ObjectTable.h"
+#include "amqp/reader/Sampling.h"
 
 /******************************************************************************
  *
@@ -20,13 +23,13 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 ListReader::dump (
     const std::string & name_,
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
-    return std::make_unique<TypedPair<sList<uPtr<amqp::reader::IValue>>>>(
-         name_,
+    return std::make_unique<TypedPair<sSeq<uPtr<amqp::reader::IValue>>>>(
+         borrowed, name_,
          dump_ (data_, schema_));
 }
 
@@ -35,36 +38,48 @@ ListReader::dump (
 uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 ListReader::dump(
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
 
-    return std::make_unique<TypedSingle<sList<uPtr<amqp::reader::IValue>>>>(
+    return std::make_unique<TypedSingle<sSeq<uPtr<amqp::reader::IValue>>>>(
          dump_ (data_, schema_));
 }
 
 /******************************************************************************/
 
-sList<uPtr<amqp::reader::IValue>>
+sSeq<uPtr<amqp::reader::IValue>>
 amqp::internal::reader::
 ListReader::dump_(
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::is_described (data_);
+    cursor::is_described (data_);
 
     decltype (dump_(data_, schema_)) read;
 
     {
-        proton::auto_enter ae (data_);
-        schema_.fromDescriptor (proton::readAndNext<std::string>(data_));
+        cursor::auto_enter ae (data_);
+        cursor::readAndNext<std::string_view>(data_);
 
         {
-            proton::auto_list_enter ale (data_, true);
+            cursor::auto_list_enter ale (data_, true);
 
-            for (size_t i { 0 } ; i < ale.elements() ; ++i) {
-                read.emplace_back (m_reader.lock()->dump (data_, schema_));
+            stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+            read.reserve (ale.elements());
+
+            if (m_direct != Primitive::none_t) {
+                for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+                    read.emplace_back (reader::dump (m_direct, data_));
+                }
+            } else {
+                auto reader = m_reader;
+
+                for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+                    read.emplace_back (ObjectTable::dump (*reader, data_, schema_));
+                }
             }
         }
     }
@@ -73,3 +88,81 @@ ListReader::dump_(
 }
 
 /******************************************************************************/
+
+void
+amqp::internal::reader::
+ListReader::write (
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    cursor::auto_list_enter ale (data_, true);
+
+    stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+    auto reader = m_reader;
+
+    if (Sampling::write (ale.elements(), 1, data_, sink_, [&](amqp::reader::ISink & into_) {
+        if (m_direct != Primitive::none_t) {
+            reader::write (m_direct, data_, into_);
+        } else {
+            ObjectTable::write (*reader, data_, into_, schema_, true);
+        }
+    })) {
+        return;
+    }
+
+    sink_.beginList();
+    if (m_direct != Primitive::none_t) {
+        for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+            reader::write (m_direct, data_, sink_);
+        }
+    } else {
+        for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+            ObjectTable::write (*reader, data_, sink_, schema_, true);
+        }
+    }
+    sink_.endList();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+ListReader::visit (
+        cursor::Cursor & data_,
+        amqp::reader::IVisitor & visitor_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    cursor::auto_list_enter ale (data_, true);
+
+    stats::Stats::count (stats::Stats::elements_t, ale.elements());
+
+    visitor_.onBeginList (ale.elements());
+    if (m_direct != Primitive::none_t) {
+        for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+            reader::visit (m_direct, data_, visitor_);
+        }
+    } else {
+        auto reader = m_reader;
+
+        for (size_t i { 0 } ; i < ale.elements() ; ++i) {
+            ObjectTable::visit (*reader, data_, visitor_, schema_, true);
+        }
+    }
+    visitor_.onEndList();
+}
+
+/******************************************************************************/
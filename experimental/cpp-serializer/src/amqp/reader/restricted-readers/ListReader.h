@@ -3,6 +3,7 @@
 /******************************************************************************/
 
 #include "RestrictedReader.h"
+#include "amqp/reader/Primitive.h"
 
 /******************************************************************************/
 
@@ -11,18 +12,25 @@ namespace amqp::internal::reader {
     class ListReader : public RestrictedReader {
         private :
             // How to read the underlying types
-            std::weak_ptr<Reader> m_reader;
+            const Reader * m_reader;
 
-            std::list<uPtr<amqp::reader::IValue>> dump_(
-                pn_data_t *,
+            /**
+             * Set when the elements are primitives the JVM doesn't number,
+             * which are then read straight from the cursor
+             */
+            Primitive m_direct;
+
+            sSeq<uPtr<amqp::reader::IValue>> dump_(
+                cursor::Cursor &,
                 const SchemaType &) const;
 
         public :
             ListReader (
                 const std::string & type_,
-                std::weak_ptr<Reader> reader_
+                const Reader * reader_
             ) : RestrictedReader (type_)
-              , m_reader (std::move (reader_))
+              , m_reader (reader_)
+              , m_direct (unnumbered (m_reader))
             { }
 
             ~ListReader() final = default;
@@ -31,12 +39,24 @@ namespace amqp::internal::reader {
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
                 const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const override;
+
+            const Reader * reader() const { return m_reader; }
     };
 
 }
@@ -1,8 +1,12 @@
 #include "MapReader.h"
 
 #include "Reader.h"
+#include "amqp/reader/MapIndex.h"
+#include "amqp/reader/ObjectTable.h"
+#include "amqp/reader/Sampling.h"
 #include "amqp/reader/IReader.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "stats/Stats.h"
 
 /******************************************************************************/
 
@@ -17,30 +21,45 @@ MapReader::restrictedType() const {
 sVec<uPtr<amqp::reader::IValue>>
 amqp::internal::reader::
 MapReader::dump_(
-    pn_data_t * data_,
+    cursor::Cursor & data_,
     const SchemaType & schema_
 ) const {
-    proton::is_described (data_);
-    proton::auto_enter ae (data_);
+    cursor::is_described (data_);
+    cursor::auto_enter ae (data_);
 
     // gloss over fetching the descriptor from the schema since
     // we don't need it, we know the types this is a reader for
     // and don't need context from the schema as there isn't
     // any. Maps have a Key and a Value, they aren't named
     // parameters, unlike composite types.
-    schema_.fromDescriptor (proton::readAndNext<std::string>(data_));
+    cursor::readAndNext<std::string_view>(data_);
 
     {
-        proton::auto_map_enter am (data_, true);
+        cursor::auto_map_enter am (data_, true);
+
+        stats::Stats::count (stats::Stats::entries_t, am.elements() / 2);
 
         decltype (dump_(data_, schema_)) rtn;
         rtn.reserve (am.elements() / 2);
 
+        auto keyReader = m_keyReader;
+        auto valueReader = m_valueReader;
+
         for (int i {0} ; i < am.elements() ; i += 2) {
+            // the order function arguments are evaluated in is unspecified
+            // so make sure we read the key before the value
+            auto key = m_directKey != Primitive::none_t
+                ? reader::dump (m_directKey, data_)
+                : ObjectTable::dump (*keyReader, data_, schema_);
+
+            auto value = m_directValue != Primitive::none_t
+                ? reader::dump (m_directValue, data_)
+                : ObjectTable::dump (*valueReader, data_, schema_);
+
             rtn.emplace_back (
                 std::make_unique<ValuePair> (
-                    m_keyReader.lock()->dump (data_, schema_),
-                    m_valueReader.lock()->dump (data_, schema_)
+                    std::move (key),
+                    std::move (value)
                 )
             );
         }
@@ -55,13 +74,19 @@ uPtr<amqp::reader::IValue>
 amqp::internal::reader::
 MapReader::dump(
         const std::string & name_,
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
+
+    if (MapIndex::enabled()) {
+        return std::make_unique<TypedPair<MapIndex>> (
+                borrowed, name_,
+                MapIndex (dump_ (data_, schema_)));
+    }
 
     return std::make_unique<TypedPair<sVec<uPtr<amqp::reader::IValue>>>>(
-            name_,
+            borrowed, name_,
             dump_ (data_, schema_));
 }
 
@@ -70,13 +95,102 @@ MapReader::dump(
 std::unique_ptr<amqp::reader::IValue>
 amqp::internal::reader::
 MapReader::dump(
-        pn_data_t * data_,
+        cursor::Cursor & data_,
         const SchemaType & schema_
 ) const  {
-    proton::auto_next an (data_);
+    cursor::auto_next an (data_);
+
+    if (MapIndex::enabled()) {
+        return std::make_unique<TypedSingle<MapIndex>> (
+                MapIndex (dump_ (data_, schema_)));
+    }
 
     return std::make_unique<TypedSingle<sVec<uPtr<amqp::reader::IValue>>>>(
             dump_ (data_, schema_));
 }
 
 /******************************************************************************/
+
+void
+amqp::internal::reader::
+MapReader::write (
+        cursor::Cursor & data_,
+        amqp::reader::ISink & sink_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    cursor::auto_map_enter am (data_, true);
+
+    stats::Stats::count (stats::Stats::entries_t, am.elements() / 2);
+
+    auto keyReader = m_keyReader;
+    auto valueReader = m_valueReader;
+
+    auto entry = [&](amqp::reader::ISink & into_) {
+        if (m_directKey != Primitive::none_t) {
+            reader::write (m_directKey, data_, into_);
+        } else {
+            ObjectTable::write (*keyReader, data_, into_, schema_, true);
+        }
+
+        if (m_directValue != Primitive::none_t) {
+            reader::write (m_directValue, data_, into_);
+        } else {
+            ObjectTable::write (*valueReader, data_, into_, schema_, true);
+        }
+    };
+
+    if (Sampling::write (am.elements() / 2, 2, data_, sink_, entry)) return;
+
+    sink_.beginMap();
+    for (size_t i { 0 } ; i < am.elements() ; i += 2) {
+        entry (sink_);
+    }
+    sink_.endMap();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reader::
+MapReader::visit (
+        cursor::Cursor & data_,
+        amqp::reader::IVisitor & visitor_,
+        const SchemaType & schema_
+) const {
+    cursor::auto_next an (data_);
+    cursor::is_described (data_);
+
+    cursor::auto_enter ae (data_);
+    cursor::readAndNext<std::string_view>(data_);
+
+    cursor::auto_map_enter am (data_, true);
+
+    stats::Stats::count (stats::Stats::entries_t, am.elements() / 2);
+
+    auto keyReader = m_keyReader;
+    auto valueReader = m_valueReader;
+
+    visitor_.onBeginMap (am.elements() / 2);
+    for (size_t i { 0 } ; i < am.elements() ; i += 2) {
+        if (m_directKey != Primitive::none_t) {
+            reader::visit (m_directKey, data_, visitor_);
+        } else {
+            ObjectTable::visit (*keyReader, data_, visitor_, schema_, true);
+        }
+
+        if (m_directValue != Primitive::none_t) {
+            reader::visit (m_directValue, data_, visitor_);
+        } else {
+            ObjectTable::visit (*valueReader, data_, visitor_, schema_, true);
+        }
+    }
+    visitor_.onEndMap();
+}
+
+/******************************************************************************/
@@ -3,6 +3,7 @@
 /******************************************************************************/
 
 #include "RestrictedReader.h"
+#include "amqp/reader/Primitive.h"
 
 /******************************************************************************/
 
@@ -11,21 +12,29 @@ namespace amqp::internal::reader {
     class MapReader : public RestrictedReader {
         private :
             // How to read the underlying types
-            std::weak_ptr<Reader> m_keyReader;
-            std::weak_ptr<Reader> m_valueReader;
+            const Reader * m_keyReader;
+            const Reader * m_valueReader;
+
+            /**
+             * As for a [ListReader]'s elements
+             */
+            Primitive m_directKey;
+            Primitive m_directValue;
 
             sVec<uPtr<amqp::reader::IValue>> dump_(
-                    pn_data_t *,
+                    cursor::Cursor &,
                     const SchemaType &) const;
 
         public :
             MapReader (
                 const std::string & type_,
-                std::weak_ptr<Reader> keyReader_,
-                std::weak_ptr<Reader> valueReader_
+                const Reader * keyReader_,
+                const Reader * valueReader_
             ) : RestrictedReader (type_)
-              , m_keyReader (std::move (keyReader_))
-              , m_valueReader (std::move (valueReader_))
+              , m_keyReader (keyReader_)
+              , m_valueReader (valueReader_)
+              , m_directKey (unnumbered (m_keyReader))
+              , m_directValue (unnumbered (m_valueReader))
             { }
 
             ~MapReader() final = default;
@@ -34,12 +43,25 @@ namespace amqp::internal::reader {
 
             std::unique_ptr<amqp::reader::IValue> dump(
                 const std::string &,
-                pn_data_t *,
+                cursor::Cursor &,
                 const SchemaType &) const override;
 
             std::unique_ptr<amqp::reader::IValue> dump(
-                pn_data_t *,
+                cursor::Cursor &,
+                const SchemaType &) const override;
+
+            void write (
+                cursor::Cursor &,
+                amqp::reader::ISink &,
                 const SchemaType &) const override;
+
+            void visit (
+                cursor::Cursor &,
+                amqp::reader::IVisitor &,
+                const SchemaType &) const override;
+
+            const Reader * keyReader() const { return m_keyReader; }
+            const Reader * valueReader() const { return m_valueReader; }
     };
 
 }
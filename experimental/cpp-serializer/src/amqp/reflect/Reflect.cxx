@@ -0,0 +1,163 @@
+#include "Reflect.h"
+
+#include <atomic>
+#include <algorithm>
+
+#include "reader/ObjectTable.h"
+
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+#include "amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h"
+
+/******************************************************************************/
+
+std::pair<std::shared_ptr<const amqp::internal::ReaderCache::Entry>, std::string_view>
+amqp::internal::reflect::
+entry (const cursor::Cursor & data_) {
+    using schema::descriptors::EnvelopeDescriptor;
+
+    auto peek = EnvelopeDescriptor::peek (data_);
+
+    auto entry = ReaderCache::instance().fetch (peek.m_schema, [&data_]() {
+        cursor::Cursor envelope { data_ };
+        cursor::auto_enter p (envelope);
+
+        auto a = envelope.get_ulong();
+
+        return uPtr<schema::Envelope> (
+                dynamic_cast<schema::Envelope *> (
+                        AMQPDescriptorRegistory[a]->build (envelope).release()));
+    });
+
+    return { std::move (entry), peek.m_descriptor };
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::reflect::
+nextTypeId() {
+    static std::atomic<size_t> next { 0 };
+    return next++;
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::reflect::
+composite (
+    const schema::Schema & schema_,
+    const std::string & name_,
+    const std::vector<Property> & properties_,
+    Plan & plan_
+) {
+    const auto * type = schema_.typeNotation (name_);
+
+    if (!type || type->type() != schema::AMQPTypeNotation::composite_t) {
+        throw std::runtime_error ("The blob's schema has no class " + name_);
+    }
+
+    const auto & composite = dynamic_cast<const schema::Composite &> (*type);
+
+    auto mismatch = [&name_](const std::string & why_) {
+        return std::runtime_error (name_ + " doesn't match the blob's schema, " + why_);
+    };
+
+    Plan plan;
+    std::vector<bool> matched (properties_.size(), false);
+
+    for (const auto & field : composite.fields()) {
+        auto it = std::find_if (properties_.begin(), properties_.end(), [&field](const auto & p_) {
+            return p_.m_name == field->name();
+        });
+
+        // removed from the type since the blob was written, or added since
+        if (it == properties_.end()) {
+            plan.m_map.push_back (-1);
+            continue;
+        }
+
+        if (field->resolvedType() != it->m_type) {
+            throw mismatch (field->name() + " is a "
+                    + field->resolvedType() + " not a " + it->m_type);
+        }
+
+        auto member = static_cast<size_t> (std::distance (properties_.begin(), it));
+
+        matched[member] = true;
+        plan.m_map.push_back (static_cast<int> (member));
+    }
+
+    for (size_t i { 0 } ; i < properties_.size() ; ++i) {
+        if (matched[i]) continue;
+
+        if (properties_[i].m_mandatory) {
+            throw mismatch ("it has no property " + properties_[i].m_name);
+        }
+
+        plan.m_absent.push_back (i);
+    }
+
+    plan.m_identity = plan.m_absent.empty() && plan.m_map.size() == properties_.size();
+
+    for (size_t i { 0 } ; plan.m_identity && i < plan.m_map.size() ; ++i) {
+        plan.m_identity = plan.m_map[i] == static_cast<int> (i);
+    }
+
+    plan_ = std::move (plan);
+
+    return composite.descriptor();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reflect::
+enumeration (
+    const schema::Schema & schema_,
+    const std::string & name_,
+    const std::vector<std::string> & choices_,
+    Plan & plan_
+) {
+    const auto * type = schema_.typeNotation (name_);
+    const auto * restricted = dynamic_cast<const schema::Restricted *> (type);
+
+    if (!restricted || restricted->restrictedType() != schema::Restricted::enum_t) {
+        throw std::runtime_error ("The blob's schema has no enum " + name_);
+    }
+
+    auto choices = dynamic_cast<const schema::Enum &> (*restricted).makeChoices();
+
+    Plan plan;
+    plan.m_identity = choices == choices_;
+
+    /*
+     * A constant only the blob knows is left unmapped, decoding it throws
+     * rather than the whole schema being refused for a value that may
+     * never turn up
+     */
+    for (const auto & choice : choices) {
+        auto it = std::find (choices_.begin(), choices_.end(), choice);
+
+        plan.m_map.push_back (it == choices_.end()
+                ? -1
+                : static_cast<int> (std::distance (choices_.begin(), it)));
+    }
+
+    plan_ = std::move (plan);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::reflect::
+notReference (const cursor::Cursor & data_) {
+    if (reader::ObjectTable::isReference (data_)) {
+        throw std::runtime_error ("Referenced objects can't be decoded into reflected types");
+    }
+}
+
+/******************************************************************************/
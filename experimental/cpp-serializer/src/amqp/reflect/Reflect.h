@@ -0,0 +1,945 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <map>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <typeinfo>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "cursor/Cursor.h"
+#include "encoder/Schema.h"
+#include "encoder/Encoder.h"
+#include "amqp/ReaderCache.h"
+#include "amqp/serializable/ISerializable.h"
+
+/******************************************************************************
+ *
+ * CORDA_SERIALIZABLE
+ *
+ ******************************************************************************/
+
+/**
+ * Makes a plain C++ struct something blobs can be decoded into and encoded
+ * from, naming the JVM class it stands in for and the members that hold
+ * that class's properties, in the order the class declares them
+ *
+ *   struct Cash {
+ *       int64_t quantity;
+ *       std::string currency;
+ *   };
+ *
+ *   CORDA_SERIALIZABLE (Cash, "net.corda.finance.Cash", quantity, currency)
+ *
+ * It must follow the struct in the struct's own namespace, where the
+ * functions it declares are found by argument dependent lookup. Up to
+ * sixteen members can be listed.
+ */
+#define CORDA_SERIALIZABLE(Type_, ClassName_, ...)                             \
+    inline constexpr const char *                                              \
+    cordaClassName (const Type_ *) {                                           \
+        return ClassName_;                                                     \
+    }                                                                          \
+                                                                               \
+    inline constexpr auto                                                      \
+    cordaFields (const Type_ *) {                                              \
+        return std::make_tuple (CORDA_EACH_ (CORDA_FIELD_, Type_, __VA_ARGS__)); \
+    }
+
+/**
+ * Likewise for a C++ enum standing in for a JVM one, its constants listed
+ * in the JVM enum's declaration order, that being what its ordinals are
+ *
+ *   enum class Status { ISSUED, SETTLED };
+ *
+ *   CORDA_ENUM (Status, "net.corda.sample.Status", ISSUED, SETTLED)
+ */
+#define CORDA_ENUM(Type_, ClassName_, ...)                                     \
+    inline constexpr const char *                                              \
+    cordaClassName (const Type_ *) {                                           \
+        return ClassName_;                                                     \
+    }                                                                          \
+                                                                               \
+    inline constexpr auto                                                      \
+    cordaChoices (const Type_ *) {                                             \
+        return std::array<std::pair<const char *, Type_>, CORDA_COUNT_ (__VA_ARGS__)> { { \
+            CORDA_EACH_ (CORDA_CHOICE_, Type_, __VA_ARGS__) } };               \
+    }
+
+#define CORDA_FIELD_(Type_, member_) \
+    ::amqp::internal::reflect::field (#member_, &Type_::member_)
+
+#define CORDA_CHOICE_(Type_, constant_) \
+    std::pair<const char *, Type_> { #constant_, Type_::constant_ }
+
+#define CORDA_CAT_(a_, b_) CORDA_CAT2_ (a_, b_)
+#define CORDA_CAT2_(a_, b_) a_##b_
+
+#define CORDA_COUNT_(...) CORDA_COUNT2_ (__VA_ARGS__, \
+    16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define CORDA_COUNT2_( \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n_, ...) n_
+
+/**
+ * [M_] (T_, a) for each a of the arguments
+ */
+#define CORDA_EACH_(M_, T_, ...) \
+    CORDA_CAT_ (CORDA_EACH_, CORDA_COUNT_ (__VA_ARGS__)) (M_, T_, __VA_ARGS__)
+
+#define CORDA_EACH_1(M_, T_, a_)       M_ (T_, a_)
+#define CORDA_EACH_2(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_1 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_3(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_2 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_4(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_3 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_5(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_4 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_6(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_5 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_7(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_6 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_8(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_7 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_9(M_, T_, a_, ...)  M_ (T_, a_), CORDA_EACH_8 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_10(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_9 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_11(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_10 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_12(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_11 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_13(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_12 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_14(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_13 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_15(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_14 (M_, T_, __VA_ARGS__)
+#define CORDA_EACH_16(M_, T_, a_, ...) M_ (T_, a_), CORDA_EACH_15 (M_, T_, __VA_ARGS__)
+
+/******************************************************************************
+ *
+ * Non template helpers
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    class Schema;
+
+}
+
+namespace amqp::internal::reflect {
+
+    /**
+     * How the blob's schema for one C++ type differs from the type, worked
+     * out once per schema and type. For a composite [m_map] gives the
+     * member each of the blob's properties is decoded into, for an enum
+     * the constant each of the blob's ordinals is, -1 for a property the
+     * type no longer has or a constant it doesn't know. [m_absent] are the
+     * members, always optional, the blob has no property for.
+     *
+     * Most of the time the two agree exactly and decoding ignores the
+     * plan bar checking [m_identity].
+     */
+    struct Plan {
+        bool m_identity { true };
+        std::vector<int> m_map;
+        std::vector<size_t> m_absent;
+    };
+
+    /**
+     * A plan for every reflected type reachable from the one a blob is
+     * decoded into, indexed by [typeId]. Whilst a [Scope] is active they
+     * are what that thread's decodes follow
+     */
+    class Plans {
+        private :
+            inline static thread_local const Plans * m_current = nullptr;
+
+            std::vector<Plan> m_plans;
+
+        public :
+            class Scope {
+                private :
+                    const Plans * m_previous;
+
+                public :
+                    explicit Scope (const Plans & plans_)
+                        : m_previous (m_current)
+                    {
+                        m_current = &plans_;
+                    }
+
+                    Scope (const Scope &) = delete;
+
+                    ~Scope() {
+                        m_current = m_previous;
+                    }
+            };
+
+            Plan &
+            operator[] (size_t id_) {
+                if (id_ >= m_plans.size()) m_plans.resize (id_ + 1);
+                return m_plans[id_];
+            }
+
+            /**
+             * The current plan for the type [id_], which is to decode it
+             * as is when nothing's been planned for it
+             */
+            static const Plan &
+            current (size_t id_) {
+                static const Plan identity { };
+
+                return m_current && id_ < m_current->m_plans.size()
+                    ? m_current->m_plans[id_]
+                    : identity;
+            }
+    };
+
+    size_t nextTypeId();
+
+    /**
+     * A small number unique to each reflected type [T] for the life of
+     * the process
+     */
+    template<class T>
+    size_t
+    typeId() {
+        static const size_t rtn { nextTypeId() };
+        return rtn;
+    }
+
+    /**
+     * A C++ type's member as the schema would describe it
+     */
+    struct Property {
+        std::string m_name;
+        std::string m_type;
+        bool m_mandatory;
+    };
+
+    /**
+     * What a blob's schema matched to a reflected type, kept by the
+     * [ReaderCache] entry for that schema
+     */
+    struct Binding {
+        std::string m_descriptor;
+        Plans m_plans;
+    };
+
+    /**
+     * The blob's compiled schema, fetched from the [ReaderCache] and so
+     * only decoded the first time it's seen, and its payload's descriptor
+     */
+    std::pair<std::shared_ptr<const ReaderCache::Entry>, std::string_view>
+    entry (const cursor::Cursor &);
+
+    /**
+     * Plan decoding [schema_]'s composite [name_] into a type with
+     * [properties_], returning its descriptor. The blob's properties are
+     * matched to the type's by name, in whatever order, any the type
+     * lacks being skipped. Any the blob lacks must be optional. Matched
+     * properties must be of the same type, throwing otherwise
+     */
+    std::string composite (
+        const schema::Schema & schema_,
+        const std::string & name_,
+        const std::vector<Property> & properties_,
+        Plan & plan_);
+
+    /**
+     * Plan decoding [schema_]'s enum [name_] into one with [choices_],
+     * matching constants by name so they may have been reordered or
+     * added to on either side
+     */
+    void enumeration (
+        const schema::Schema & schema_,
+        const std::string & name_,
+        const std::vector<std::string> & choices_,
+        Plan & plan_);
+
+    /**
+     * References need the table a tree decode keeps, which a reflected
+     * decode doesn't
+     */
+    void notReference (const cursor::Cursor &);
+
+    /**
+     * Lists and arrays hold their elements alike
+     */
+    inline size_t
+    elements (const cursor::Cursor & data_) {
+        return data_.type() == cursor::array_t ? data_.get_array() : data_.get_list();
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reflect::Field
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reflect {
+
+    template<class T, class M>
+    struct Field {
+        using Member = M;
+
+        const char * m_name;
+        M T::* m_member;
+    };
+
+    template<class T, class M>
+    constexpr Field<T, M>
+    field (const char * name_, M T::* member_) {
+        return Field<T, M> { name_, member_ };
+    }
+
+    template<class T, class = void>
+    struct IsReflected : std::false_type { };
+
+    template<class T>
+    struct IsReflected<T, std::void_t<decltype (cordaFields (static_cast<const T *> (nullptr)))>>
+        : std::true_type { };
+
+    template<class T, class = void>
+    struct IsReflectedEnum : std::false_type { };
+
+    template<class T>
+    struct IsReflectedEnum<T, std::void_t<decltype (cordaChoices (static_cast<const T *> (nullptr)))>>
+        : std::true_type { };
+
+    /**
+     * A JVM array, T[], rather than a list. Packed arrays of primitives,
+     * T[p], are [PrimitiveArray]s
+     */
+    template<class T>
+    struct Array : public std::vector<T> {
+        using std::vector<T>::vector;
+    };
+
+    template<class T>
+    struct PrimitiveArray : public std::vector<T> {
+        using std::vector<T>::vector;
+    };
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::reflect::Codec
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reflect {
+
+    /**
+     * How a C++ type is named in a schema, described into one, checked
+     * against one and decoded and encoded. Every decode is straight from
+     * the cursor into the member, the type of which picks the codec at
+     * compile time, so once a type has been checked against a schema
+     * nothing is looked up by name and nothing is dispatched virtually.
+     *
+     * [restricted] types are written in a schema as * with the type they
+     * are required to be, everything else by name. [mandatory] is false
+     * for anything that can be null.
+     *
+     * The primary template is for types made serialisable with
+     * [CORDA_SERIALIZABLE], the specialisations below for everything they
+     * can hold.
+     */
+    template<class T, class = void>
+    struct Codec {
+        static_assert (IsReflected<T>::value,
+                "Only types declared CORDA_SERIALIZABLE can be decoded into");
+
+        static constexpr bool restricted = false;
+        static constexpr bool mandatory = true;
+
+        static constexpr auto fields() {
+            return cordaFields (static_cast<const T *> (nullptr));
+        }
+
+        static std::string name() {
+            return cordaClassName (static_cast<const T *> (nullptr));
+        }
+
+        /**
+         * What it's written with, the checked schema's being ignored
+         * once the blob's payload has been matched to it
+         */
+        static const std::string & descriptor() {
+            static const std::string rtn { encoder::Schema::fingerprint (name()) };
+            return rtn;
+        }
+
+        static void describe (encoder::Schema & schema_) {
+            if (schema_.contains (name())) return;
+
+            std::vector<encoder::Schema::Field> fields;
+
+            std::apply ([&schema_, &fields](const auto & ... field_) {
+                (describeField (schema_, fields, field_), ...);
+            }, Codec::fields());
+
+            schema_.composite (name(), std::move (fields), descriptor());
+        }
+
+        static std::string validate (const schema::Schema & schema_, Plans & plans_) {
+            std::vector<Property> properties;
+
+            std::apply ([&schema_, &plans_, &properties](const auto & ... field_) {
+                (validateField (schema_, plans_, properties, field_), ...);
+            }, Codec::fields());
+
+            return composite (schema_, name(), properties, plans_[typeId<T>()]);
+        }
+
+        static void decode (cursor::Cursor & data_, T & value_) {
+            notReference (data_);
+
+            const auto & plan = Plans::current (typeId<T>());
+
+            cursor::auto_enter ae (data_, true);
+            cursor::auto_list_enter ale (data_, true);
+
+            if (plan.m_identity) {
+                std::apply ([&data_, &value_](const auto & ... field_) {
+                    bool first { true };
+                    (decodeField (data_, value_, field_, first), ...);
+                }, fields());
+
+                return;
+            }
+
+            for (size_t i { 0 } ; i < plan.m_map.size() ; ++i) {
+                if (i) data_.next();
+
+                if (plan.m_map[i] >= 0) {
+                    member (static_cast<size_t> (plan.m_map[i]), [&data_, &value_](const auto & field_) {
+                        using M = typename std::decay_t<decltype (field_)>::Member;
+                        Codec<M>::decode (data_, value_.*(field_.m_member));
+                    });
+                }
+            }
+
+            for (auto absent : plan.m_absent) {
+                member (absent, [&value_](const auto & field_) {
+                    using M = typename std::decay_t<decltype (field_)>::Member;
+                    value_.*(field_.m_member) = M { };
+                });
+            }
+        }
+
+        static void encode (encoder::Encoder & encoder_, const T & value_) {
+            encoder_.beginObject (descriptor());
+
+            std::apply ([&encoder_, &value_](const auto & ... field_) {
+                (Codec<typename std::decay_t<decltype (field_)>::Member>::encode (
+                        encoder_, value_.*(field_.m_member)), ...);
+            }, fields());
+
+            encoder_.endObject();
+        }
+
+        private :
+            template<class M>
+            static void describeField (
+                encoder::Schema & schema_,
+                std::vector<encoder::Schema::Field> & fields_,
+                const Field<T, M> & field_
+            ) {
+                Codec<M>::describe (schema_);
+
+                if (Codec<M>::restricted) {
+                    fields_.push_back ({ field_.m_name, "*", Codec<M>::name(), Codec<M>::mandatory });
+                } else {
+                    fields_.push_back ({ field_.m_name, Codec<M>::name(), { }, Codec<M>::mandatory });
+                }
+            }
+
+            template<class M>
+            static void validateField (
+                const schema::Schema & schema_,
+                Plans & plans_,
+                std::vector<Property> & properties_,
+                const Field<T, M> &  field_
+            ) {
+                Codec<M>::validate (schema_, plans_);
+                properties_.push_back ({ field_.m_name, Codec<M>::name(), Codec<M>::mandatory });
+            }
+
+            /**
+             * [fn_] applied to the [n_]th member, for decoding an evolved
+             * blob in its own order
+             */
+            template<class Fn>
+            static void member (size_t n_, Fn && fn_) {
+                std::apply ([n_, &fn_](const auto & ... field_) {
+                    size_t i { 0 };
+                    ((i++ == n_ ? (fn_ (field_), true) : false) || ...);
+                }, fields());
+            }
+
+            template<class M>
+            static void decodeField (
+                cursor::Cursor & data_,
+                T & value_,
+                const Field<T, M> & field_,
+                bool & first_
+            ) {
+                if (!first_) data_.next();
+                first_ = false;
+
+                Codec<M>::decode (data_, value_.*(field_.m_member));
+            }
+    };
+
+    /**
+     * What every primitive shares
+     */
+    struct Primitive {
+        static constexpr bool restricted = false;
+        static constexpr bool mandatory = true;
+
+        static void describe (encoder::Schema &) { }
+        static void validate (const schema::Schema &, Plans &) { }
+    };
+
+    template<>
+    struct Codec<bool> : Primitive {
+        static std::string name() { return "boolean"; }
+
+        static void decode (cursor::Cursor & data_, bool & value_) { value_ = data_.get_bool(); }
+        static void encode (encoder::Encoder & encoder_, bool value_) { encoder_.boolean (value_); }
+    };
+
+    template<>
+    struct Codec<int8_t> : Primitive {
+        static std::string name() { return "byte"; }
+
+        static void decode (cursor::Cursor & data_, int8_t & value_) { value_ = data_.get_byte(); }
+        static void encode (encoder::Encoder & encoder_, int8_t value_) { encoder_.int8 (value_); }
+    };
+
+    template<>
+    struct Codec<int16_t> : Primitive {
+        static std::string name() { return "short"; }
+
+        static void decode (cursor::Cursor & data_, int16_t & value_) { value_ = data_.get_short(); }
+        static void encode (encoder::Encoder & encoder_, int16_t value_) { encoder_.int16 (value_); }
+    };
+
+    template<>
+    struct Codec<int32_t> : Primitive {
+        static std::string name() { return "int"; }
+
+        static void decode (cursor::Cursor & data_, int32_t & value_) { value_ = data_.get_int(); }
+        static void encode (encoder::Encoder & encoder_, int32_t value_) { encoder_.int32 (value_); }
+    };
+
+    template<>
+    struct Codec<int64_t> : Primitive {
+        static std::string name() { return "long"; }
+
+        static void decode (cursor::Cursor & data_, int64_t & value_) { value_ = data_.get_long(); }
+        static void encode (encoder::Encoder & encoder_, int64_t value_) { encoder_.int64 (value_); }
+    };
+
+    template<>
+    struct Codec<float> : Primitive {
+        static std::string name() { return "float"; }
+
+        static void decode (cursor::Cursor & data_, float & value_) { value_ = data_.get_float(); }
+        static void encode (encoder::Encoder & encoder_, float value_) { encoder_.float32 (value_); }
+    };
+
+    template<>
+    struct Codec<double> : Primitive {
+        static std::string name() { return "double"; }
+
+        static void decode (cursor::Cursor & data_, double & value_) { value_ = data_.get_double(); }
+        static void encode (encoder::Encoder & encoder_, double value_) { encoder_.float64 (value_); }
+    };
+
+    template<>
+    struct Codec<char32_t> : Primitive {
+        static std::string name() { return "char"; }
+
+        static void decode (cursor::Cursor & data_, char32_t & value_) {
+            value_ = static_cast<char32_t> (data_.get_char());
+        }
+
+        static void encode (encoder::Encoder & encoder_, char32_t value_) { encoder_.character (value_); }
+    };
+
+    template<>
+    struct Codec<std::string> : Primitive {
+        static std::string name() { return "string"; }
+
+        static void decode (cursor::Cursor & data_, std::string & value_) {
+            value_.assign (data_.get_string());
+        }
+
+        static void encode (encoder::Encoder & encoder_, const std::string & value_) {
+            encoder_.string (value_);
+        }
+    };
+
+    /**
+     * Null when empty
+     */
+    template<class T>
+    struct Codec<std::optional<T>> {
+        static constexpr bool restricted = Codec<T>::restricted;
+        static constexpr bool mandatory = false;
+
+        static std::string name() { return Codec<T>::name(); }
+
+        static void describe (encoder::Schema & schema_) { Codec<T>::describe (schema_); }
+        static void validate (const schema::Schema & schema_, Plans & plans_) {
+            Codec<T>::validate (schema_, plans_);
+        }
+
+        static void decode (cursor::Cursor & data_, std::optional<T> & value_) {
+            if (data_.type() == cursor::null_t) {
+                value_.reset();
+            } else {
+                Codec<T>::decode (data_, value_.emplace());
+            }
+        }
+
+        static void encode (encoder::Encoder & encoder_, const std::optional<T> & value_) {
+            if (value_) {
+                Codec<T>::encode (encoder_, *value_);
+            } else {
+                encoder_.null();
+            }
+        }
+    };
+
+    template<class T>
+    struct Codec<std::vector<T>> {
+        static constexpr bool restricted = true;
+        static constexpr bool mandatory = true;
+
+        static std::string name() { return "java.util.List<" + Codec<T>::name() + ">"; }
+
+        static const std::string & descriptor() {
+            static const std::string rtn { encoder::Schema::fingerprint (name()) };
+            return rtn;
+        }
+
+        static void describe (encoder::Schema & schema_) {
+            Codec<T>::describe (schema_);
+            schema_.list (name(), descriptor());
+        }
+
+        static void validate (const schema::Schema & schema_, Plans & plans_) {
+            Codec<T>::validate (schema_, plans_);
+        }
+
+        static void decode (cursor::Cursor & data_, std::vector<T> & value_) {
+            notReference (data_);
+
+            cursor::auto_enter ae (data_, true);
+
+            auto elements = reflect::elements (data_);
+
+            value_.clear();
+            value_.reserve (elements);
+
+            cursor::auto_list_enter ale (data_, true);
+
+            for (size_t i { 0 } ; i < elements ; ++i) {
+                if (i) data_.next();
+
+                // not straight into the vector, vector<bool> has no bool &
+                T element { };
+                Codec<T>::decode (data_, element);
+                value_.push_back (std::move (element));
+            }
+        }
+
+        static void encode (encoder::Encoder & encoder_, const std::vector<T> & value_) {
+            encoder_.described (descriptor());
+            encoder_.beginList();
+            for (const auto & element : value_) Codec<T>::encode (encoder_, element);
+            encoder_.endList();
+        }
+    };
+
+    template<class K, class V>
+    struct Codec<std::map<K, V>> {
+        static constexpr bool restricted = true;
+        static constexpr bool mandatory = true;
+
+        static std::string name() {
+            return "java.util.Map<" + Codec<K>::name() + ", " + Codec<V>::name() + ">";
+        }
+
+        static const std::string & descriptor() {
+            static const std::string rtn { encoder::Schema::fingerprint (name()) };
+            return rtn;
+        }
+
+        static void describe (encoder::Schema & schema_) {
+            Codec<K>::describe (schema_);
+            Codec<V>::describe (schema_);
+            schema_.map (name(), descriptor());
+        }
+
+        static void validate (const schema::Schema & schema_, Plans & plans_) {
+            Codec<K>::validate (schema_, plans_);
+            Codec<V>::validate (schema_, plans_);
+        }
+
+        static void decode (cursor::Cursor & data_, std::map<K, V> & value_) {
+            notReference (data_);
+
+            cursor::auto_enter ae (data_, true);
+
+            auto entries = data_.get_map() / 2;
+
+            value_.clear();
+
+            cursor::auto_map_enter ame (data_, true);
+
+            for (size_t i { 0 } ; i < entries ; ++i) {
+                if (i) data_.next();
+
+                K key { };
+                Codec<K>::decode (data_, key);
+
+                data_.next();
+
+                Codec<V>::decode (data_, value_[std::move (key)]);
+            }
+        }
+
+        static void encode (encoder::Encoder & encoder_, const std::map<K, V> & value_) {
+            encoder_.described (descriptor());
+            encoder_.beginMap();
+            for (const auto & kv : value_) {
+                Codec<K>::encode (encoder_, kv.first);
+                Codec<V>::encode (encoder_, kv.second);
+            }
+            encoder_.endMap();
+        }
+    };
+
+}
+
+namespace amqp::internal::reflect {
+
+    /**
+     * Arrays are written and read as lists, only their names differ, bar
+     * packed arrays of ints, longs and doubles which are written as AMQP
+     * arrays straight from the vector, see [encoder::Encoder::ints]
+     */
+    template<class A, class T>
+    struct ArrayCodec {
+        static constexpr bool restricted = false;
+        static constexpr bool mandatory = true;
+
+        static std::string name() {
+            return Codec<T>::name() + (std::is_same_v<A, Array<T>> ? "[]" : "[p]");
+        }
+
+        static const std::string & descriptor() {
+            static const std::string rtn { encoder::Schema::fingerprint (name()) };
+            return rtn;
+        }
+
+        static void describe (encoder::Schema & schema_) {
+            Codec<T>::describe (schema_);
+            schema_.list (name(), descriptor());
+        }
+
+        static void validate (const schema::Schema & schema_, Plans & plans_) {
+            Codec<T>::validate (schema_, plans_);
+        }
+
+        static void decode (cursor::Cursor & data_, A & value_) {
+            Codec<std::vector<T>>::decode (data_, value_);
+        }
+
+        static void encode (encoder::Encoder & encoder_, const A & value_) {
+            encoder_.described (descriptor());
+
+            if constexpr (std::is_same_v<A, PrimitiveArray<int32_t>>) {
+                encoder_.ints (value_.data(), value_.size());
+            } else if constexpr (std::is_same_v<A, PrimitiveArray<int64_t>>) {
+                encoder_.longs (value_.data(), value_.size());
+            } else if constexpr (std::is_same_v<A, PrimitiveArray<double>>) {
+                encoder_.doubles (value_.data(), value_.size());
+            } else {
+                encoder_.beginList();
+                for (const auto & element : value_) Codec<T>::encode (encoder_, element);
+                encoder_.endList();
+            }
+        }
+    };
+
+    template<class T>
+    struct Codec<Array<T>> : public ArrayCodec<Array<T>, T> { };
+
+    template<class T>
+    struct Codec<PrimitiveArray<T>> : public ArrayCodec<PrimitiveArray<T>, T> { };
+
+    /**
+     * Enums declared with [CORDA_ENUM]. A constant is decoded from its
+     * ordinal, renumbered by the plan when the blob's enum doesn't number
+     * its constants the same
+     */
+    template<class T>
+    struct Codec<T, std::enable_if_t<std::is_enum_v<T>>> {
+        static_assert (IsReflectedEnum<T>::value,
+                "Only enums declared CORDA_ENUM can be decoded into");
+
+        static constexpr bool restricted = false;
+        static constexpr bool mandatory = true;
+
+        static constexpr auto choices() {
+            return cordaChoices (static_cast<const T *> (nullptr));
+        }
+
+        static std::string name() {
+            return cordaClassName (static_cast<const T *> (nullptr));
+        }
+
+        static const std::string & descriptor() {
+            static const std::string rtn { encoder::Schema::fingerprint (name()) };
+            return rtn;
+        }
+
+        static std::vector<std::string> names() {
+            std::vector<std::string> rtn;
+            for (const auto & choice : choices()) rtn.emplace_back (choice.first);
+            return rtn;
+        }
+
+        static void describe (encoder::Schema & schema_) {
+            schema_.enumeration (name(), names(), descriptor());
+        }
+
+        static void validate (const schema::Schema & schema_, Plans & plans_) {
+            enumeration (schema_, name(), names(), plans_[typeId<T>()]);
+        }
+
+        static void decode (cursor::Cursor & data_, T & value_) {
+            notReference (data_);
+
+            cursor::auto_enter ae (data_, true);
+            cursor::auto_list_enter ale (data_, true);
+
+            // past the constant's name
+            data_.next();
+
+            auto encoded = data_.get_int();
+            auto ordinal = encoded;
+
+            const auto & plan = Plans::current (typeId<T>());
+
+            if (!plan.m_identity) {
+                ordinal = encoded >= 0 && static_cast<size_t> (encoded) < plan.m_map.size()
+                    ? plan.m_map[static_cast<size_t> (encoded)]
+                    : -1;
+            }
+
+            if (ordinal < 0 || static_cast<size_t> (ordinal) >= choices().size()) {
+                throw std::runtime_error (name() + " has no constant " + std::to_string (encoded));
+            }
+
+            value_ = choices()[static_cast<size_t> (ordinal)].second;
+        }
+
+        static void encode (encoder::Encoder & encoder_, T value_) {
+            const auto & choices = Codec::choices();
+
+            for (size_t i { 0 } ; i < choices.size() ; ++i) {
+                if (choices[i].second == value_) {
+                    encoder_.enumeration (descriptor(), choices[i].first, static_cast<int32_t> (i));
+                    return;
+                }
+            }
+
+            throw std::runtime_error ("Not a constant of " + name());
+        }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * Decoding and encoding whole blobs
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::reflect {
+
+    /**
+     * Decode the blob, everything after its header, into [value_]. The
+     * first time a schema is seen with [T] the two are checked against
+     * each other and a plan made for any way in which the schema's types
+     * have evolved from, or into, [T]'s. After that only that the payload
+     * is a [T] is checked, the plan being kept with the schema
+     */
+    template<class T>
+    void
+    decode (const char * blob_, size_t size_, T & value_) {
+        cursor::Cursor data (blob_, size_);
+
+        auto [ entry, descriptor ] = reflect::entry (data);
+
+        const auto & bound = *std::static_pointer_cast<const Binding> (entry->bind (
+                typeid (T),
+                [](const schema::Schema & schema_) {
+                    auto rtn = std::make_shared<Binding>();
+                    rtn->m_descriptor = Codec<T>::validate (schema_, rtn->m_plans);
+                    return std::shared_ptr<const void> (std::move (rtn));
+                }));
+
+        if (bound.m_descriptor != descriptor) {
+            throw std::runtime_error ("Blob doesn't hold a " + Codec<T>::name());
+        }
+
+        Plans::Scope scope (bound.m_plans);
+
+        cursor::auto_enter envelope (data, true);
+        cursor::auto_list_enter payload (data, true);
+
+        Codec<T>::decode (data, value_);
+    }
+
+    template<class T>
+    T
+    decode (const char * blob_, size_t size_) {
+        T rtn { };
+        decode (blob_, size_, rtn);
+        return rtn;
+    }
+
+    /**
+     * Lets a [serialiser::Serialiser] write [T] as a blob's payload
+     */
+    template<class T>
+    class Serializable : public amqp::serializable::ISerializable {
+        private :
+            const T & m_value;
+
+        public :
+            explicit Serializable (const T & value_) : m_value (value_) { }
+
+            void describe (encoder::Schema & schema_) const override {
+                Codec<T>::describe (schema_);
+            }
+
+            void serialize (encoder::Encoder & encoder_, const encoder::Schema &) const override {
+                Codec<T>::encode (encoder_, m_value);
+            }
+    };
+
+}
+
+/******************************************************************************/
+
@@ -3,6 +3,8 @@
 /******************************************************************************/
 
 #include <memory>
+#include <vector>
+#include <string_view>
 #include <types.h>
 
 #include "amqp/schema/described-types/Descriptor.h"
@@ -57,6 +59,12 @@ namespace amqp::internal::schema {
 
             virtual Type type() const = 0;
 
+            /**
+             * The names of the types this one refers to, the inverse of
+             * what [dependsOn] works out pair by pair
+             */
+            virtual std::vector<std::string_view> dependencies() const = 0;
+
             virtual int dependsOnRHS (const Restricted &) const = 0;
             virtual int dependsOnRHS (const Composite &) const = 0;
     };
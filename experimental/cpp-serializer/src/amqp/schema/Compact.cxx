@@ -0,0 +1,259 @@
+#include "Compact.h"
+
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "amqp/schema/described-types/Schema.h"
+#include "amqp/schema/described-types/Envelope.h"
+#include "amqp/schema/described-types/Composite.h"
+#include "amqp/schema/restricted-types/Enum.h"
+#include "amqp/schema/restricted-types/Restricted.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::schema::Compact
+ *
+ ******************************************************************************/
+
+amqp::internal::schema::
+Compact::Compact (const Envelope & envelope_) {
+    const auto & schema = dynamic_cast<const Schema &> (envelope_.schema());
+
+    // only needed whilst building, the pool's what's kept
+    std::unordered_map<std::string_view, Text> pooled;
+    std::vector<std::string_view> strings;
+
+    auto size = [](size_t size_) {
+        if (size_ > UINT32_MAX) throw std::runtime_error ("Schema too large to compact");
+        return static_cast<uint32_t> (size_);
+    };
+
+    // every string's offset is fixed before the pool's built so views
+    // of the envelope's strings do as keys throughout
+    uint32_t pool { 0 };
+
+    auto intern = [&](std::string_view string_) {
+        auto it = pooled.find (string_);
+
+        if (it != pooled.end()) return it->second;
+
+        Text rtn { pool, size (string_.size()) };
+        pool = size (size_t { pool } + string_.size());
+
+        strings.push_back (string_);
+        pooled.emplace (string_, rtn);
+
+        return rtn;
+    };
+
+    auto run = [&](const auto & strings_) {
+        Run rtn { size (m_lists.size()), size (strings_.size()) };
+        for (const auto & string : strings_) m_lists.push_back (intern (string));
+        return rtn;
+    };
+
+    // the choices being made anew they're kept, unmoved, until the pool is built
+    std::deque<std::vector<std::string>> choices;
+
+    m_descriptor = intern (envelope_.descriptor());
+    m_levels.push_back (0);
+
+    for (const auto & level : schema) {
+        for (const auto & type : level) {
+            Type compact { };
+
+            compact.m_name = intern (type->name());
+            compact.m_descriptor = intern (type->descriptor());
+
+            if (type->type() == AMQPTypeNotation::composite_t) {
+                const auto & composite = dynamic_cast<const Composite &> (*type);
+
+                compact.m_kind = composite_t;
+                compact.m_source = composite_t;
+                compact.m_label = intern (composite.label());
+                compact.m_provides = run (composite.provides());
+                compact.m_members = { size (m_fields.size()), size (composite.fields().size()) };
+
+                for (const auto & field : composite.fields()) {
+                    m_fields.push_back ({
+                        intern (field->name()),
+                        intern (field->type()),
+                        intern (field->defaultValue()),
+                        intern (field->label()),
+                        run (field->requires()),
+                        field->mandatory(),
+                        field->multiple() });
+                }
+            } else {
+                const auto & restricted = dynamic_cast<const Restricted &> (*type);
+
+                switch (restricted.restrictedType()) {
+                    case Restricted::list_t  : compact.m_kind = list_t; break;
+                    case Restricted::map_t   : compact.m_kind = map_t; break;
+                    case Restricted::enum_t  : compact.m_kind = enum_t; break;
+                    case Restricted::array_t : compact.m_kind = array_t; break;
+                }
+
+                compact.m_source = restricted.source() == Restricted::map_t ? map_t : list_t;
+                compact.m_label = intern (restricted.label());
+                compact.m_provides = run (restricted.provides());
+
+                if (compact.m_kind == enum_t) {
+                    choices.push_back (dynamic_cast<const Enum &> (restricted).makeChoices());
+                    compact.m_members = run (choices.back());
+                }
+            }
+
+            m_types.push_back (compact);
+        }
+
+        m_levels.push_back (size (m_types.size()));
+    }
+
+    m_pool.reserve (pool);
+    for (auto string : strings) m_pool.append (string);
+
+    m_byDescriptor.resize (m_types.size());
+    m_byName.resize (m_types.size());
+
+    for (uint32_t i { 0 } ; i < m_types.size() ; ++i) m_byDescriptor[i] = m_byName[i] = i;
+
+    auto by = [this](Text Type::* text_) {
+        return [this, text_](uint32_t lhs_, uint32_t rhs_) {
+            return text (m_types[lhs_].*text_) < text (m_types[rhs_].*text_);
+        };
+    };
+
+    std::sort (m_byDescriptor.begin(), m_byDescriptor.end(), by (&Type::m_descriptor));
+    std::sort (m_byName.begin(), m_byName.end(), by (&Type::m_name));
+
+    m_types.shrink_to_fit();
+    m_fields.shrink_to_fit();
+    m_lists.shrink_to_fit();
+    m_levels.shrink_to_fit();
+}
+
+/******************************************************************************/
+
+/**
+ * Types are made just as a [SchemaStore] restores them
+ */
+uPtr<amqp::internal::schema::Envelope>
+amqp::internal::schema::
+Compact::expand() const {
+    auto strings = [this](Run run_) {
+        std::vector<std::string> rtn;
+        rtn.reserve (run_.m_size);
+
+        for (uint32_t i { 0 } ; i < run_.m_size ; ++i) {
+            rtn.emplace_back (text (m_lists[run_.m_begin + i]));
+        }
+
+        return rtn;
+    };
+
+    std::vector<uPtr<AMQPTypeNotation>> types;
+    types.reserve (m_types.size());
+
+    for (const auto & type : m_types) {
+        auto descriptor = std::make_unique<Descriptor> (std::string (text (type.m_descriptor)));
+
+        if (type.m_kind == composite_t) {
+            std::vector<uPtr<schema::Field>> fields;
+            fields.reserve (type.m_members.m_size);
+
+            for (uint32_t i { 0 } ; i < type.m_members.m_size ; ++i) {
+                const auto & field = m_fields[type.m_members.m_begin + i];
+
+                fields.emplace_back (schema::Field::make (
+                        std::string (text (field.m_name)),
+                        std::string (text (field.m_type)),
+                        strings (field.m_requires),
+                        std::string (text (field.m_default)),
+                        std::string (text (field.m_label)),
+                        field.m_mandatory,
+                        field.m_multiple));
+            }
+
+            types.emplace_back (std::make_unique<Composite> (
+                    std::string (text (type.m_name)),
+                    std::string (text (type.m_label)),
+                    strings (type.m_provides),
+                    std::move (descriptor),
+                    std::move (fields)));
+        } else {
+            std::vector<uPtr<Choice>> choices;
+
+            if (type.m_kind == enum_t) {
+                for (auto & choice : strings (type.m_members)) {
+                    choices.emplace_back (std::make_unique<Choice> (std::move (choice)));
+                }
+            }
+
+            types.emplace_back (Restricted::make (
+                    std::move (descriptor),
+                    std::string (text (type.m_name)),
+                    std::string (text (type.m_label)),
+                    strings (type.m_provides),
+                    type.m_source == map_t ? "map" : "list",
+                    std::move (choices)));
+        }
+    }
+
+    TypeNotationGraph<AMQPTypeNotation> graph;
+    graph.restore (std::move (types), { m_levels.begin(), m_levels.end() });
+
+    auto schema = std::make_unique<Schema> (std::move (graph));
+
+    return std::make_unique<Envelope> (schema, std::string (descriptor()));
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::schema::
+Compact::bytes() const {
+    return sizeof (Compact)
+        + m_pool.capacity()
+        + m_types.capacity() * sizeof (Type)
+        + m_fields.capacity() * sizeof (Field)
+        + m_lists.capacity() * sizeof (Text)
+        + m_levels.capacity() * sizeof (uint32_t)
+        + (m_byDescriptor.capacity() + m_byName.capacity()) * sizeof (uint32_t);
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::schema::
+Compact::search (
+    const std::vector<uint32_t> & index_,
+    Text Type::* text_,
+    std::string_view key_
+) const {
+    auto it = std::lower_bound (index_.begin(), index_.end(), key_, [&](uint32_t type_, std::string_view key_) {
+        return text (m_types[type_].*text_) < key_;
+    });
+
+    return it != index_.end() && text (m_types[*it].*text_) == key_ ? *it : npos;
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::schema::
+Compact::byDescriptor (std::string_view descriptor_) const {
+    return search (m_byDescriptor, &Type::m_descriptor, descriptor_);
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::schema::
+Compact::byName (std::string_view name_) const {
+    return search (m_byName, &Type::m_name, name_);
+}
+
+/******************************************************************************/
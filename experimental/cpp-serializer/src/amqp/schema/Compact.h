@@ -0,0 +1,161 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "types.h"
+
+/******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    class Envelope;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::schema::Compact
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    /**
+     * An immutable schema laid out as a handful of flat arrays rather than
+     * a graph of heap allocated types, for holding many more schemas than
+     * could be kept decoded. Every name, descriptor, label and type string
+     * is stored once in a single pool, however many fields or types share
+     * it, and referred to by its offset and size. Types are one array, in
+     * the order their graph levelled them, their fields another, and the
+     * lists of provides, requires and enum choices a third, each type and
+     * field naming the run of the next array that's its own. Types are
+     * also indexed by descriptor and by name, sorted, so either is found
+     * by a binary search with nothing allocated.
+     *
+     * Nothing can be decoded with one directly. [expand] turns it back
+     * into the [Envelope] it was made from, its types already ordered, so
+     * readers can be built from that as they would from one just decoded.
+     */
+    class Compact {
+        public :
+            enum Kind_t : uint8_t { composite_t, list_t, map_t, enum_t, array_t };
+
+            static constexpr uint32_t npos = UINT32_MAX;
+
+        private :
+            struct Text {
+                uint32_t m_offset;
+                uint32_t m_size;
+            };
+
+            /**
+             * A run of [m_lists]
+             */
+            struct Run {
+                uint32_t m_begin;
+                uint32_t m_size;
+            };
+
+            struct Type {
+                Text m_name;
+                Text m_label;
+                Text m_descriptor;
+                Run m_provides;
+
+                /**
+                 * Fields of a composite, the choices of an enum
+                 */
+                Run m_members;
+
+                Kind_t m_kind;
+
+                /**
+                 * Whether a restricted type was serialised from a map or
+                 * a list, whatever it restricts that to
+                 */
+                Kind_t m_source;
+            };
+
+            struct Field {
+                Text m_name;
+                Text m_type;
+                Text m_default;
+                Text m_label;
+                Run m_requires;
+                bool m_mandatory;
+                bool m_multiple;
+            };
+
+            std::string m_pool;
+
+            std::vector<Type> m_types;
+            std::vector<Field> m_fields;
+            std::vector<Text> m_lists;
+
+            /**
+             * Where each level of types starts, a last entry marking the
+             * end of the last
+             */
+            std::vector<uint32_t> m_levels;
+
+            /**
+             * Indexes of [m_types] sorted by descriptor and by name
+             */
+            std::vector<uint32_t> m_byDescriptor;
+            std::vector<uint32_t> m_byName;
+
+            Text m_descriptor;
+
+            std::string_view text (Text text_) const { return { m_pool.data() + text_.m_offset, text_.m_size }; }
+
+            uint32_t search (const std::vector<uint32_t> &, Text Type::*, std::string_view) const;
+
+        public :
+            explicit Compact (const Envelope &);
+
+            Compact (const Compact &) = delete;
+
+            /**
+             * The envelope this was made from, built afresh
+             */
+            uPtr<Envelope> expand() const;
+
+            /**
+             * What it holds, pool and arrays, to the byte
+             */
+            size_t bytes() const;
+
+            /**
+             * The envelope's descriptor, that of the blob's outer type
+             */
+            std::string_view descriptor() const { return text (m_descriptor); }
+
+            size_t size() const { return m_types.size(); }
+
+            Kind_t kind (uint32_t type_) const { return m_types[type_].m_kind; }
+            std::string_view name (uint32_t type_) const { return text (m_types[type_].m_name); }
+            std::string_view descriptor (uint32_t type_) const { return text (m_types[type_].m_descriptor); }
+
+            /**
+             * A composite's fields or an enum's choices, none for lists
+             * and maps
+             */
+            size_t members (uint32_t type_) const { return m_types[type_].m_members.m_size; }
+
+            /**
+             * The type with [descriptor_] or [name_], [npos] if there's
+             * none
+             */
+            uint32_t byDescriptor (std::string_view descriptor_) const;
+            uint32_t byName (std::string_view name_) const;
+    };
+
+}
+
+/******************************************************************************/
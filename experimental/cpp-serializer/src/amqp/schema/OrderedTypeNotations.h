@@ -2,7 +2,6 @@
 
 #include <list>
 #include <ostream>
-#include <iostream>
 
 #include "debug.h"
 #include "types.h"
@@ -0,0 +1,104 @@
+#include "SymbolTable.h"
+
+/******************************************************************************/
+
+amqp::internal::schema::
+SymbolTable::SymbolTable() : m_slots (16, Slot { 0, npos }) {
+
+}
+
+/******************************************************************************/
+
+/**
+ * FNV-1a, descriptors share long common prefixes so we want something
+ * that mixes every byte
+ */
+uint32_t
+amqp::internal::schema::
+SymbolTable::hash (std::string_view symbol_) {
+    uint32_t h { 2166136261U };
+
+    for (auto c : symbol_) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619U;
+    }
+
+    return h;
+}
+
+/******************************************************************************/
+
+/**
+ * The slot holding [symbol_] or, if it's absent, the empty slot where it
+ * would go
+ */
+size_t
+amqp::internal::schema::
+SymbolTable::slot (std::string_view symbol_, uint32_t hash_) const {
+    const size_t mask { m_slots.size() - 1 };
+
+    for (size_t i { hash_ & mask } ; ; i = (i + 1) & mask) {
+        const auto & s = m_slots[i];
+
+        if (s.m_id == npos
+            || (s.m_hash == hash_ && m_symbols[s.m_id] == symbol_))
+        {
+            return i;
+        }
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::schema::
+SymbolTable::grow() {
+    std::vector<Slot> old (m_slots.size() * 2, Slot { 0, npos });
+    old.swap (m_slots);
+
+    const size_t mask { m_slots.size() - 1 };
+
+    for (const auto & s : old) {
+        if (s.m_id == npos) continue;
+
+        size_t i { s.m_hash & mask };
+        while (m_slots[i].m_id != npos) {
+            i = (i + 1) & mask;
+        }
+
+        m_slots[i] = s;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::schema::SymbolTable::Id
+amqp::internal::schema::
+SymbolTable::intern (std::string_view symbol_) {
+    auto h = hash (symbol_);
+    auto i = slot (symbol_, h);
+
+    if (m_slots[i].m_id != npos) {
+        return m_slots[i].m_id;
+    }
+
+    auto id = static_cast<Id>(m_symbols.size());
+    m_symbols.emplace_back (symbol_);
+    m_slots[i] = Slot { h, id };
+
+    if (m_symbols.size() * 2 > m_slots.size()) {
+        grow();
+    }
+
+    return id;
+}
+
+/******************************************************************************/
+
+amqp::internal::schema::SymbolTable::Id
+amqp::internal::schema::
+SymbolTable::find (std::string_view symbol_) const {
+    return m_slots[slot (symbol_, hash (symbol_))].m_id;
+}
+
+/******************************************************************************/
@@ -0,0 +1,71 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::internal::schema::SymbolTable
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    /**
+     * Interns symbols, handing each distinct one a dense id starting from
+     * zero. Lookups take a [std::string_view] straight out of the blob so
+     * resolving a descriptor neither allocates nor walks a tree, it's a
+     * hash and, almost always, a single compare.
+     *
+     * The table is open addressed with linear probing and kept at most
+     * half full.
+     */
+    class SymbolTable {
+        public :
+            using Id = uint32_t;
+
+            static constexpr Id npos = UINT32_MAX;
+
+        private :
+            struct Slot {
+                uint32_t m_hash;
+                Id       m_id;
+            };
+
+            std::vector<Slot> m_slots;
+            std::vector<std::string> m_symbols;
+
+            static uint32_t hash (std::string_view);
+
+            size_t slot (std::string_view, uint32_t) const;
+
+            void grow();
+
+        public :
+            SymbolTable();
+
+            /**
+             * Return the id of [symbol_], adding it if we've not seen it
+             * before
+             */
+            Id intern (std::string_view symbol_);
+
+            /**
+             * Return the id of [symbol_] or [npos] if it's not in the table
+             */
+            Id find (std::string_view symbol_) const;
+
+            const std::string & operator[] (Id id_) const {
+                return m_symbols[id_];
+            }
+
+            size_t size() const { return m_symbols.size(); }
+    };
+
+}
+
+/******************************************************************************/
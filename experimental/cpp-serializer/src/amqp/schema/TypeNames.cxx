@@ -0,0 +1,199 @@
+#include "TypeNames.h"
+
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include "debug.h"
+
+/******************************************************************************/
+
+namespace {
+
+    using amqp::internal::schema::TypeName;
+
+    /**
+     * Constant, as is everything the names are checked against, so none
+     * of it's built before the first is interned. Each name's only ever
+     * parsed once, so they're simply searched
+     */
+    constexpr std::string_view primitives[] {
+        "string", "long", "boolean", "int", "double", "binary", "char",
+        "short", "byte", "float", "timestamp", "uuid", "decimal128", "symbol"
+    };
+
+    /**
+     * Java has two types of primitive, boxed and unboxed, essentially
+     * actual primitives and classes representing those primitives. Of
+     * course, we don't care about that, so treat boxed primitives as their
+     * underlying type.
+     */
+    constexpr std::pair<std::string_view, std::string_view> boxedToUnboxed[] {
+            { "java.lang.Integer", "int" },
+            { "java.lang.Boolean", "boolean" },
+            { "java.lang.Byte", "char" },
+            { "java.lang.Short", "short" },
+            { "java.lang.Character", "char" },
+            { "java.lang.Float", "float" },
+            { "java.lang.Long", "long" },
+            { "java.lang.Double", "double" }
+    };
+
+    std::string_view
+    trim (std::string_view name_) {
+        while (!name_.empty() && name_.front() == ' ') name_.remove_prefix (1);
+        while (!name_.empty() && name_.back() == ' ') name_.remove_suffix (1);
+        return name_;
+    }
+
+    bool
+    endsWith (std::string_view name_, std::string_view suffix_) {
+        return name_.size() > suffix_.size()
+            && name_.substr (name_.size() - suffix_.size()) == suffix_;
+    }
+
+    /**
+     * The comma separated arguments between a generic's outermost angle
+     * brackets, empty if they don't balance
+     */
+    std::vector<std::string_view>
+    arguments (std::string_view name_, size_t open_) {
+        std::vector<std::string_view> rtn;
+
+        size_t nesting { 0 };
+        size_t start { open_ + 1 };
+
+        for (size_t i { start } ; i < name_.size() ; ++i) {
+            switch (name_[i]) {
+                case '<' :
+                    ++nesting;
+                    break;
+                case '>' :
+                    if (nesting == 0) {
+                        if (i + 1 != name_.size()) return { };
+                        rtn.push_back (trim (name_.substr (start, i - start)));
+                        return rtn;
+                    }
+                    --nesting;
+                    break;
+                case ',' :
+                    if (nesting == 0) {
+                        rtn.push_back (trim (name_.substr (start, i - start)));
+                        start = i + 1;
+                    }
+                    break;
+                default :
+                    break;
+            }
+        }
+
+        return { };
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::schema::TypeNames
+ *
+ ******************************************************************************/
+
+amqp::internal::schema::TypeNames &
+amqp::internal::schema::
+TypeNames::instance() {
+    static TypeNames names;
+    return names;
+}
+
+/******************************************************************************/
+
+const amqp::internal::schema::TypeName &
+amqp::internal::schema::
+TypeNames::parse (std::string_view name_) {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return intern (trim (name_));
+}
+
+/******************************************************************************/
+
+/**
+ * With the lock held. Arguments are interned before the name they're part
+ * of so each name's id is its place in [m_names]
+ */
+const amqp::internal::schema::TypeName &
+amqp::internal::schema::
+TypeNames::intern (std::string_view name_) {
+    if (auto id = m_symbols.find (name_) ; id != SymbolTable::npos) {
+        return m_names[id];
+    }
+
+    DBG ("TypeNames - parsing " << name_ << std::endl); // NOLINT
+
+    TypeName rtn;
+    rtn.m_kind = TypeName::class_t;
+    rtn.m_name = std::string { name_ };
+    rtn.m_base = rtn.m_name;
+    rtn.m_unboxed = rtn.m_name;
+
+    if (name_ == "*") {
+        rtn.m_kind = TypeName::any_t;
+    } else if (std::find (std::begin (primitives), std::end (primitives), name_) != std::end (primitives)) {
+        rtn.m_kind = TypeName::primitive_t;
+    } else if (endsWith (name_, "[]") || endsWith (name_, "[p]")) {
+        auto packed = name_.back() == ']' && name_[name_.size() - 2] == 'p';
+        auto element = trim (name_.substr (0, name_.rfind ('[')));
+
+        if (!element.empty()) {
+            rtn.m_kind = packed ? TypeName::packed_t : TypeName::array_t;
+            rtn.m_args.push_back (intern (element).id());
+        }
+    } else if (auto open = name_.find ('<') ; open != std::string_view::npos) {
+        auto args = arguments (name_, open);
+
+        if (!args.empty()) {
+            rtn.m_kind = TypeName::generic_t;
+            rtn.m_base = std::string { trim (name_.substr (0, open)) };
+
+            for (const auto & arg : args) {
+                rtn.m_args.push_back (intern (arg).id());
+            }
+        }
+    } else if (auto it = std::find_if (
+            std::begin (boxedToUnboxed), std::end (boxedToUnboxed),
+            [name_](const auto & boxed_) { return boxed_.first == name_; })
+        ; it != std::end (boxedToUnboxed))
+    {
+        rtn.m_unboxed = std::string { it->second };
+    }
+
+    rtn.m_id = m_symbols.intern (name_);
+
+    if (rtn.m_id != m_names.size()) {
+        throw std::runtime_error ("Type names out of step interning " + rtn.m_name);
+    }
+
+    m_names.push_back (std::move (rtn));
+
+    return m_names.back();
+}
+
+/******************************************************************************/
+
+const amqp::internal::schema::TypeName &
+amqp::internal::schema::
+TypeNames::operator[] (TypeName::Id id_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_names.at (id_);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::schema::
+TypeNames::size() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+    return m_names.size();
+}
+
+/******************************************************************************/
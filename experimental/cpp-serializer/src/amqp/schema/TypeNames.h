@@ -0,0 +1,131 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "SymbolTable.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::schema::TypeName
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    /**
+     * A Java type name as a schema spells it, parsed. One of
+     *
+     *    *                                  any_t
+     *    int, string, ...                   primitive_t
+     *    net.corda.Foo, java.lang.Integer   class_t
+     *    java.util.Map<K, V>                generic_t, [args] being K and V
+     *    net.corda.Foo[]                    array_t, [args] being the element
+     *    int[p]                             packed_t, an array of unboxed
+     *                                       primitives, likewise
+     *
+     * Arguments and elements are referred to by id, each being spelt
+     * exactly as it was within the name, so they can be looked up in a
+     * schema by it.
+     */
+    class TypeName {
+        public :
+            using Id = SymbolTable::Id;
+
+            enum Kind : uint8_t { any_t, primitive_t, class_t, generic_t, array_t, packed_t };
+
+        private :
+            friend class TypeNames;
+
+            Id m_id;
+            Kind m_kind;
+
+            std::string m_name;
+
+            /**
+             * A generic's name without its arguments, otherwise the name
+             */
+            std::string m_base;
+
+            /**
+             * Boxed primitives as the primitive they box, otherwise the
+             * name
+             */
+            std::string m_unboxed;
+
+            std::vector<Id> m_args;
+
+        public :
+            Id id() const { return m_id; }
+            Kind kind() const { return m_kind; }
+
+            const std::string & name() const { return m_name; }
+            const std::string & base() const { return m_base; }
+            const std::string & unboxed() const { return m_unboxed; }
+
+            const std::vector<Id> & args() const { return m_args; }
+
+            bool isPrimitive() const { return m_kind == primitive_t; }
+            bool isArray() const { return m_kind == array_t || m_kind == packed_t; }
+    };
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::schema::TypeNames
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    /**
+     * Every type name seen by the process, each parsed the first time it
+     * turns up and interned, along with its arguments, so however many
+     * schemas and readers ask after it the string is only ever picked
+     * apart once. Asking what a name is thereafter compares its [Kind].
+     *
+     * Names are never forgotten, there being a bounded number of types
+     * in the world any one process sees. Parsed names are never moved so
+     * references to them stay good for the life of the process.
+     */
+    class TypeNames {
+        private :
+            mutable std::mutex m_lock;
+
+            SymbolTable m_symbols;
+
+            /**
+             * Indexed by id
+             */
+            std::deque<TypeName> m_names;
+
+            const TypeName & intern (std::string_view);
+
+        public :
+            TypeNames() = default;
+            TypeNames (const TypeNames &) = delete;
+
+            static TypeNames & instance();
+
+            /**
+             * [name_] parsed, parsing it if it's not been seen before. A
+             * name that won't parse, unbalanced brackets say, is taken
+             * as the name of a class
+             */
+            const TypeName & parse (std::string_view name_);
+
+            const TypeName & operator[] (TypeName::Id) const;
+
+            size_t size() const;
+    };
+
+}
+
+/******************************************************************************/
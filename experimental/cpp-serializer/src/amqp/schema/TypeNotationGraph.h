@@ -0,0 +1,305 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+#include "types.h"
+#include "schema/SymbolTable.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::schema::TypeNotationGraph
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::schema {
+
+    /**
+     * Orders a set of type notations into levels such that a type always
+     * sits in a later level than every type it depends upon, so walking
+     * them in order meets every type after what it's built from. The same
+     * contract as [OrderedTypeNotations] but without comparing every type
+     * against every other.
+     *
+     * Types are simply collected as they're inserted. [order] then interns
+     * their names, builds the graph of dependencies once and sorts it
+     * topologically, a type's level being the length of the longest chain
+     * of dependencies beneath it. That's linear in the number of types and
+     * dependencies. Within a level types keep the order they were
+     * inserted in.
+     *
+     * The levels are laid out back to back in a single vector so iterating
+     * them is a walk along contiguous memory.
+     *
+     * [T] needs a [name] and a [dependencies] method, the latter returning
+     * the names of the types it refers to. Names that aren't in the graph
+     * are ignored, as are types that depend on themselves. Should there be
+     * a cycle between types everything on it, and everything depending on
+     * that, is put in a final level of its own.
+     */
+    template<class T>
+    class TypeNotationGraph {
+        public :
+            /**
+             * A run of types within the graph's storage
+             */
+            class Level {
+                private :
+                    const uPtr<T> * m_begin;
+                    const uPtr<T> * m_end;
+
+                public :
+                    Level (const uPtr<T> * begin_, const uPtr<T> * end_)
+                        : m_begin (begin_)
+                        , m_end (end_)
+                    { }
+
+                    const uPtr<T> * begin() const { return m_begin; }
+                    const uPtr<T> * end() const { return m_end; }
+
+                    size_t size() const { return m_end - m_begin; }
+            };
+
+            class const_iterator {
+                private :
+                    const TypeNotationGraph * m_graph;
+                    size_t m_level;
+
+                public :
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type        = Level;
+                    using difference_type   = std::ptrdiff_t;
+                    using pointer           = void;
+                    using reference         = Level;
+
+                    const_iterator (const TypeNotationGraph & graph_, size_t level_)
+                        : m_graph (&graph_)
+                        , m_level (level_)
+                    { }
+
+                    Level operator * () const {
+                        const auto * base = m_graph->m_types.data();
+
+                        return Level (
+                            base + m_graph->m_levels[m_level],
+                            base + m_graph->m_levels[m_level + 1]);
+                    }
+
+                    const_iterator & operator ++ () {
+                        ++m_level;
+                        return *this;
+                    }
+
+                    bool operator == (const const_iterator & rhs_) const {
+                        return m_level == rhs_.m_level;
+                    }
+
+                    bool operator != (const const_iterator & rhs_) const {
+                        return m_level != rhs_.m_level;
+                    }
+            };
+
+        private :
+            std::vector<uPtr<T>> m_types;
+
+            /**
+             * Where each level starts in [m_types], with a final entry
+             * marking the end of the last. Empty until ordered
+             */
+            std::vector<size_t> m_levels;
+
+            bool m_ordered { true };
+
+            void ordered() const {
+                if (!m_ordered) {
+                    throw std::runtime_error ("TypeNotationGraph has not been ordered");
+                }
+            }
+
+        public :
+            void insert (uPtr<T> && ptr_) {
+                m_types.emplace_back (std::move (ptr_));
+                m_ordered = false;
+            }
+
+            void order();
+
+            /**
+             * Take on [types_] as already ordered, [levels_] being where
+             * each level starts with a final entry marking the end of the
+             * last, as a graph ordered earlier laid them out
+             */
+            void restore (std::vector<uPtr<T>> types_, std::vector<size_t> levels_) {
+                bool valid = levels_.empty()
+                    ? types_.empty()
+                    : levels_.front() == 0 && levels_.back() == types_.size()
+                        && std::is_sorted (levels_.begin(), levels_.end());
+
+                if (!valid) {
+                    throw std::runtime_error ("TypeNotationGraph levels don't fit its types");
+                }
+
+                m_types = std::move (types_);
+                m_levels = std::move (levels_);
+                m_ordered = true;
+            }
+
+            size_t size() const { return m_types.size(); }
+
+            const_iterator begin() const {
+                ordered();
+                return const_iterator (*this, 0);
+            }
+
+            const_iterator end() const {
+                ordered();
+                return const_iterator (*this, m_levels.empty() ? 0 : m_levels.size() - 1);
+            }
+    };
+
+}
+
+/******************************************************************************/
+
+template<class T>
+void
+amqp::internal::schema::
+TypeNotationGraph<T>::order() {
+    if (m_ordered) return;
+
+    const size_t n { m_types.size() };
+
+    /*
+     * Every type gets a dense id by way of its name, a repeated name
+     * resolving to whichever type claimed it first
+     */
+    SymbolTable names;
+    std::vector<size_t> byId;
+    byId.reserve (n);
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        if (names.intern (m_types[i]->name()) == byId.size()) {
+            byId.push_back (i);
+        }
+    }
+
+    /*
+     * The edges, from each type to those depending on it, in compressed
+     * sparse row form. [pending] counts each type's dependencies
+     */
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<size_t> pending (n, 0);
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        for (const auto & dependency : m_types[i]->dependencies()) {
+            auto id = names.find (dependency);
+            if (id == SymbolTable::npos) continue;
+
+            auto j = byId[id];
+            if (j == i) continue;
+
+            edges.emplace_back (j, i);
+            ++pending[i];
+        }
+    }
+
+    std::vector<size_t> first (n + 1, 0);
+    std::vector<size_t> to (edges.size());
+
+    for (const auto & edge : edges) ++first[edge.first + 1];
+    for (size_t i { 0 } ; i < n ; ++i) first[i + 1] += first[i];
+
+    {
+        std::vector<size_t> next (first.begin(), first.end() - 1);
+        for (const auto & edge : edges) to[next[edge.first]++] = edge.second;
+    }
+
+    /*
+     * Kahn's algorithm, starting from the types that depend on nothing.
+     * A type is only queued once every one of its dependencies has been
+     * visited, so by then its level is final.
+     */
+    std::vector<size_t> level (n, 0);
+    std::vector<size_t> queue;
+    queue.reserve (n);
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        if (pending[i] == 0) queue.push_back (i);
+    }
+
+    size_t levels { 0 };
+
+    for (size_t q { 0 } ; q < queue.size() ; ++q) {
+        auto i = queue[q];
+
+        levels = std::max (levels, level[i] + 1);
+
+        for (auto e = first[i] ; e < first[i + 1] ; ++e) {
+            auto j = to[e];
+
+            level[j] = std::max (level[j], level[i] + 1);
+
+            if (--pending[j] == 0) queue.push_back (j);
+        }
+    }
+
+    // anything never reached is on, or depends upon, a cycle
+    if (queue.size() != n) {
+        for (size_t i { 0 } ; i < n ; ++i) {
+            if (pending[i] != 0) level[i] = levels;
+        }
+        ++levels;
+    }
+
+    /*
+     * Counting sort into place, stable so each level keeps the insertion
+     * order
+     */
+    m_levels.assign (levels + 1, 0);
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        ++m_levels[level[i] + 1];
+    }
+
+    for (size_t l { 0 } ; l < levels ; ++l) {
+        m_levels[l + 1] += m_levels[l];
+    }
+
+    std::vector<uPtr<T>> sorted (n);
+    std::vector<size_t> next (m_levels.begin(), m_levels.end() - 1);
+
+    for (size_t i { 0 } ; i < n ; ++i) {
+        sorted[next[level[i]]++] = std::move (m_types[i]);
+    }
+
+    m_types = std::move (sorted);
+    m_ordered = true;
+}
+
+/******************************************************************************/
+
+template<class T>
+std::ostream &
+operator << (
+        std::ostream & stream_,
+        const amqp::internal::schema::TypeNotationGraph<T> & graph_
+) {
+    int idx1 { 0 };
+    for (const auto & i : graph_) {
+        stream_ << "level " << ++idx1 << std::endl;
+        for (const auto & j : i) {
+            stream_ << "    * " << j->name() << std::endl;
+        }
+        stream_ << std::endl;
+    }
+
+    return stream_;
+}
+
+/******************************************************************************/
@@ -1,6 +1,6 @@
 #include "Choice.h"
 
-#include <iostream>
+#include <ostream>
 
 /******************************************************************************/
 
@@ -6,7 +6,7 @@
 #include "amqp/schema/restricted-types/Restricted.h"
 
 #include <iomanip>
-#include <iostream>
+#include <ostream>
 
 /******************************************************************************/
 
@@ -38,7 +38,7 @@ amqp::internal::schema::
 Composite::Composite (
         std::string name_,
         std::string label_,
-        sList<std::string> provides_,
+        std::vector<std::string> provides_,
         uPtr<Descriptor> descriptor_,
         std::vector<uPtr<Field>> fields_
 ) : AMQPTypeNotation (
@@ -67,6 +67,21 @@ Composite::type() const {
 
 /******************************************************************************/
 
+std::vector<std::string_view>
+amqp::internal::schema::
+Composite::dependencies() const {
+    std::vector<std::string_view> rtn;
+    rtn.reserve (m_fields.size());
+
+    for (const auto & field : m_fields) {
+        rtn.emplace_back (field->resolvedType());
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
 /**
  * Use a visitor style pattern to work out weather two types, composite or
  * restricted, are "less than" one or not. In this case we define being
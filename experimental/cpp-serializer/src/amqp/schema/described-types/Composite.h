@@ -2,7 +2,6 @@
 
 /******************************************************************************/
 
-#include <list>
 #include <vector>
 #include <iosfwd>
 #include <string>
@@ -53,7 +52,7 @@ namespace amqp::internal::schema {
             // we don't know about knowing the interfaces (java concept)
             // that this class implemented isn't al that useful but we'll
             // at least preserve the list
-            std::list<std::string> m_provides;
+            std::vector<std::string> m_provides;
 
             /**
              * The properties of the Class
@@ -64,7 +63,7 @@ namespace amqp::internal::schema {
             Composite (
                 std::string name_,
                 std::string label_,
-                std::list<std::string> provides_,
+                std::vector<std::string> provides_,
                 std::unique_ptr<Descriptor> descriptor_,
                 std::vector<std::unique_ptr<Field>> fields_);
 
@@ -72,10 +71,15 @@ namespace amqp::internal::schema {
 
             Type type() const override;
 
+            std::vector<std::string_view> dependencies() const override;
+
             int dependsOn (const OrderedTypeNotation &) const override;
             int dependsOnRHS (const class Restricted &) const override;
             int dependsOnRHS (const Composite &) const override;
 
+            const decltype (m_label) & label() const { return m_label; }
+            const decltype (m_provides) & provides() const { return m_provides; }
+
             decltype(m_fields)::const_iterator begin() const { return m_fields.cbegin();}
             decltype(m_fields)::const_iterator end() const { return m_fields.cend(); }
     };
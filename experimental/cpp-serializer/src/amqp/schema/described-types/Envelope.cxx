@@ -1,6 +1,6 @@
 #include "Envelope.h"
 
-#include <iostream>
+#include <ostream>
 
 #include "amqp/schema/described-types/Schema.h"
 #include "amqp/schema/ISchema.h"
@@ -5,10 +5,12 @@
 #include "Schema.h"
 #include "types.h"
 
+#include "stats/Trace.h"
+
 #include "debug.h"
 
 #include <memory>
-#include <iostream>
+#include <ostream>
 
 /******************************************************************************
  *
@@ -40,20 +42,29 @@ operator << (std::ostream & stream_, const Schema & schema_) {
 
 amqp::internal::schema::
 Schema::Schema (
-    OrderedTypeNotations<AMQPTypeNotation> types_
+    TypeNotationGraph<AMQPTypeNotation> types_
 ) : m_types (std::move (types_)) {
+    {
+        stats::Trace::Span span ("order");
+        m_types.order();
+    }
+
     for (auto i { m_types.begin() } ; i != m_types.end() ; ++i) {
         for (auto & j : *i) {
             DBG ("Schema: " << j->descriptor() << " " << j->name() << std::endl); // NOLINT
-            m_descriptorToType.emplace (j->descriptor(), std::ref (j));
+            auto it = m_descriptorToType.emplace (j->descriptor(), std::ref (j));
             m_typeToDescriptor.emplace (j->name(), std::ref (j));
+
+            if (m_symbols.intern (j->descriptor()) == m_byId.size()) {
+                m_byId.push_back (it.first);
+            }
         }
     }
 }
 
 /******************************************************************************/
 
-const amqp::internal::schema::OrderedTypeNotations<amqp::internal::schema::AMQPTypeNotation> &
+const amqp::internal::schema::TypeNotationGraph<amqp::internal::schema::AMQPTypeNotation> &
 amqp::internal::schema::
 Schema::types() const {
     return m_types;
@@ -71,8 +82,28 @@ Schema::fromType (const std::string & type_) const {
 
 amqp::internal::schema::SchemaMap::const_iterator
 amqp::internal::schema::
-Schema::fromDescriptor (const std::string & descriptor_) const {
-    return m_descriptorToType.find (descriptor_);
+Schema::fromDescriptor (std::string_view descriptor_) const {
+    auto id = m_symbols.find (descriptor_);
+
+    return id == SymbolTable::npos ? m_descriptorToType.end() : m_byId[id];
+}
+
+/******************************************************************************/
+
+const amqp::internal::schema::AMQPTypeNotation *
+amqp::internal::schema::
+Schema::typeNotation (const std::string & type_) const {
+    auto it = m_typeToDescriptor.find (type_);
+
+    return it == m_typeToDescriptor.end() ? nullptr : it->second.get().get();
+}
+
+/******************************************************************************/
+
+amqp::internal::schema::SymbolTable::Id
+amqp::internal::schema::
+Schema::descriptorId (std::string_view descriptor_) const {
+    return m_symbols.find (descriptor_);
 }
 
 /******************************************************************************/
@@ -9,7 +9,8 @@
 #include "types.h"
 #include "Composite.h"
 #include "Descriptor.h"
-#include "schema/OrderedTypeNotations.h"
+#include "schema/SymbolTable.h"
+#include "schema/TypeNotationGraph.h"
 
 #include "amqp/AMQPDescribed.h"
 #include "amqp/schema/ISchema.h"
@@ -38,18 +39,38 @@ namespace amqp::internal::schema {
             friend std::ostream & operator << (std::ostream &, const Schema &);
 
         private :
-            OrderedTypeNotations<AMQPTypeNotation> m_types;
+            TypeNotationGraph<AMQPTypeNotation> m_types;
 
             SchemaMap m_descriptorToType;
             SchemaMap m_typeToDescriptor;
 
+            /**
+             * Descriptors interned so they can be resolved straight from
+             * the bytes of a blob, [m_byId] being indexed by their ids
+             */
+            SymbolTable m_symbols;
+            std::vector<SchemaMap::const_iterator> m_byId;
+
         public :
-            explicit Schema (OrderedTypeNotations<AMQPTypeNotation>);
+            explicit Schema (TypeNotationGraph<AMQPTypeNotation>);
 
-            const OrderedTypeNotations<AMQPTypeNotation> & types() const;
+            const TypeNotationGraph<AMQPTypeNotation> & types() const;
 
             SchemaMap::const_iterator fromType (const std::string &) const override;
-            SchemaMap::const_iterator fromDescriptor (const std::string &) const override ;
+            SchemaMap::const_iterator fromDescriptor (std::string_view) const override;
+
+            /**
+             * The type named [type_], null if the schema has no such type
+             */
+            const AMQPTypeNotation * typeNotation (const std::string &) const;
+
+            /**
+             * The dense id of a descriptor within this schema, or
+             * [SymbolTable::npos]
+             */
+            SymbolTable::Id descriptorId (std::string_view) const;
+
+            const SymbolTable & symbols() const { return m_symbols; }
 
             decltype (m_types.begin()) begin() const { return m_types.begin(); }
             decltype (m_types.end()) end() const { return m_types.end(); }
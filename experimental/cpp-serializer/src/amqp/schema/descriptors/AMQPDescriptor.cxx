@@ -1,9 +1,10 @@
 #include "AMQPDescriptor.h"
 
 #include <sstream>
+#include <algorithm>
 #include <amqp/schema/descriptors/corda-descriptors/EnvelopeDescriptor.h>
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 #include "AMQPDescriptorRegistory.h"
 
 /******************************************************************************/
@@ -12,7 +13,14 @@ namespace amqp::internal::schema::descriptors {
 
     std::ostream &
     operator<<(std::ostream &stream_, const AutoIndent &ai_) {
-        stream_ << ai_.indent;
+        static const std::string spaces (64, ' ');
+
+        for (auto width = 2 * ai_.m_depth ; width ; ) {
+            auto n = std::min (width, spaces.size());
+            stream_.write (spaces.data(), static_cast<std::streamsize> (n));
+            width -= n;
+        }
+
         return stream_;
     }
 
@@ -30,7 +38,7 @@ AMQPDescriptor::symbol() const {
 
 std::unique_ptr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-AMQPDescriptor::build (pn_data_t *) const {
+AMQPDescriptor::build (cursor::Cursor &) const {
     throw std::runtime_error ("Should never be called");
 }
 
@@ -39,8 +47,8 @@ AMQPDescriptor::build (pn_data_t *) const {
 inline void
 amqp::internal::schema::descriptors::
 AMQPDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_
+        cursor::Cursor & data_,
+        std::ostream & ss_
 ) const {
     return read (data_, ss_, AutoIndent());
 }
@@ -50,39 +58,39 @@ AMQPDescriptor::read (
 void
 amqp::internal::schema::descriptors::
 AMQPDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const {
-    switch (pn_data_type (data_)) {
-        case PN_DESCRIBED : {
-            ss_ << ai_ << "DESCRIBED: " << std::endl;
+    switch (data_.type()) {
+        case cursor::described_t : {
+            ss_ << ai_ << "DESCRIBED: " << '\n';
             {
                 AutoIndent ai { ai_ } ; // NOLINT
-                proton::auto_enter p (data_);
+                cursor::auto_enter p (data_);
 
-                switch (pn_data_type (data_)) {
-                    case PN_ULONG : {
-                        auto key = proton::readAndNext<u_long>(data_);
+                switch (data_.type()) {
+                    case cursor::ulong_t : {
+                        auto key = cursor::readAndNext<uint64_t>(data_);
 
                         ss_ << ai << "key  : "
                             << key << " :: " << amqp::stripCorda(key)
                             << " -> "
                             <<  amqp::describedToString ((uint64_t )key)
-                            << std::endl;
+                            << '\n';
 
-                        proton::is_list (data_);
+                        cursor::is_list (data_);
                         ss_ << ai << "list : entries: "
-                            << pn_data_get_list(data_)
-                            << std::endl;
+                            << data_.get_list()
+                            << '\n';
 
                         AMQPDescriptorRegistory[key]->read (data_, ss_, ai);
                         break;
                     }
-                    case PN_SYMBOL : {
+                    case cursor::symbol_t : {
                         ss_ << ai << "blob: bytes: "
-                            << pn_data_get_symbol(data_).size
-                            << std::endl;
+                            << data_.get_symbol().size()
+                            << '\n';
                         break;
                     }
                     default : {
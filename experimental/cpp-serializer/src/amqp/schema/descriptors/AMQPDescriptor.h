@@ -5,7 +5,7 @@
 #include <map>
 #include <memory>
 #include <string>
-#include <iostream>
+#include <ostream>
 
 #include "amqp/AMQPDescribed.h"
 
@@ -15,7 +15,11 @@
  *
  ******************************************************************************/
 
-struct pn_data_t;
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
 
 /******************************************************************************
  *
@@ -25,14 +29,19 @@ struct pn_data_t;
 
 namespace amqp::internal::schema::descriptors {
 
+    /**
+     * How deep a dump is, a copy being one level deeper than what it was
+     * copied from. Only the depth is kept, the indent being written
+     * straight from a run of spaces, so nesting allocates nothing
+     */
     class AutoIndent {
         private :
-            std::string indent;
+            size_t m_depth;
         public :
-            AutoIndent() : indent { "" } { }
+            AutoIndent() : m_depth { 0 } { }
 
             AutoIndent (const AutoIndent & ai_)
-                : indent { ai_.indent + "  "}
+                : m_depth { ai_.m_depth + 1 }
             { }
 
             friend std::ostream &
@@ -68,17 +77,17 @@ namespace amqp::internal::schema::descriptors {
 
             const std::string & symbol() const;
 
-            void validateAndNext (pn_data_t *) const;
+            void validateAndNext (cursor::Cursor &) const;
 
-            virtual std::unique_ptr<AMQPDescribed> build (pn_data_t *) const;
+            virtual std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const;
 
             virtual void read (
-                pn_data_t *,
-                std::stringstream &) const;
+                cursor::Cursor &,
+                std::ostream &) const;
 
             virtual void read (
-                pn_data_t *,
-                std::stringstream &,
+                cursor::Cursor &,
+                std::ostream &,
                 const AutoIndent &) const;
     };
 
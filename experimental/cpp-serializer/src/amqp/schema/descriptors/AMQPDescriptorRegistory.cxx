@@ -13,87 +13,107 @@
 
 #include <limits>
 #include <climits>
+#include <sstream>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
 
 /******************************************************************************/
 
-/**
+namespace {
+
+    using namespace amqp::internal::schema::descriptors;
+
+    /**
+     * Indexed by the stripped Corda id, slot zero being the bootstrap
+     * descriptor for a described node whose id we've yet to read
+     */
+    const AMQPDescriptor * const *
+    table() {
+        static const AMQPDescriptor described ("DESCRIBED", -1);
+        static const EnvelopeDescriptor envelope (
+                "ENVELOPE", ::amqp::schema::descriptors::ENVELOPE);
+        static const SchemaDescriptor schema (
+                "SCHEMA", ::amqp::schema::descriptors::SCHEMA);
+        static const ObjectDescriptor object (
+                "OBJECT_DESCRIPTOR", ::amqp::schema::descriptors::OBJECT);
+        static const FieldDescriptor field (
+                "FIELD", ::amqp::schema::descriptors::FIELD);
+        static const CompositeDescriptor composite (
+                "COMPOSITE_TYPE", ::amqp::schema::descriptors::COMPOSITE_TYPE);
+        static const RestrictedDescriptor restricted (
+                "RESTRICTED_TYPE", ::amqp::schema::descriptors::RESTRICTED_TYPE);
+        static const ChoiceDescriptor choice (
+                "CHOICE", ::amqp::schema::descriptors::CHOICE);
+        static const ReferencedObjectDescriptor referenced (
+                "REFERENCED_OBJECT", ::amqp::schema::descriptors::REFERENCED_OBJECT);
+        static const TransformSchemaDescriptor transformSchema (
+                "TRANSFORM_SCHEMA", ::amqp::schema::descriptors::TRANSFORM_SCHEMA);
+        static const TransformElementDescriptor transformElement (
+                "TRANSFORM_ELEMENT", ::amqp::schema::descriptors::TRANSFORM_ELEMENT);
+        static const TransformElementKeyDescriptor transformElementKey (
+                "TRANSFORM_ELEMENT_KEY", ::amqp::schema::descriptors::TRANSFORM_ELEMENT_KEY);
+
+        static const AMQPDescriptor * const descriptors[] = {
+            &described,
+            &envelope,
+            &schema,
+            &object,
+            &field,
+            &composite,
+            &restricted,
+            &choice,
+            &referenced,
+            &transformSchema,
+            &transformElement,
+            &transformElementKey
+        };
+
+        static_assert (
+            sizeof (descriptors) / sizeof (descriptors[0])
+                == amqp::internal::DescriptorRegistory::MAX_ID + 1);
+
+        return descriptors;
+    }
+
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::DescriptorRegistory
  *
- */
-namespace amqp::internal {
-
-    std::map<uint64_t, std::shared_ptr<internal::schema::descriptors::AMQPDescriptor>>
-    AMQPDescriptorRegistory = {
-        {
-            22UL,
-            std::make_shared<internal::schema::descriptors::AMQPDescriptor> ("DESCRIBED", -1)
-        },
-        {
-            1UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::EnvelopeDescriptor> (
-                    "ENVELOPE",
-                    ::amqp::schema::descriptors::ENVELOPE)
-        },
-        {
-            2UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::SchemaDescriptor> (
-                    "SCHEMA",
-                    ::amqp::schema::descriptors::SCHEMA)
-        },
-        {
-            3UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::ObjectDescriptor> (
-                    "OBJECT_DESCRIPTOR",
-                    ::amqp::schema::descriptors::OBJECT)
-        },
-        {
-            4UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::FieldDescriptor> (
-                    "FIELD",
-                    ::amqp::schema::descriptors::FIELD)
-        },
-        {
-            5UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::CompositeDescriptor> (
-                    "COMPOSITE_TYPE",
-                    ::amqp::schema::descriptors::COMPOSITE_TYPE)
-        },
-        {
-            6UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::RestrictedDescriptor> (
-                    "RESTRICTED_TYPE",
-                    ::amqp::schema::descriptors::RESTRICTED_TYPE)
-        },
-        {
-            7UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::ChoiceDescriptor> (
-                    "CHOICE",
-                    ::amqp::schema::descriptors::CHOICE)
-        },
-        {
-            8UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::ReferencedObjectDescriptor> (
-                    "REFERENCED_OBJECT",
-                    ::amqp::schema::descriptors::REFERENCED_OBJECT)
-        },
-        {
-            9UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::TransformSchemaDescriptor> (
-                    "TRANSFORM_SCHEMA",
-                    ::amqp::schema::descriptors::TRANSFORM_SCHEMA)
-        },
-        {
-            10UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::TransformElementDescriptor> (
-                    "TRANSFORM_ELEMENT",
-                    ::amqp::schema::descriptors::TRANSFORM_ELEMENT)
-        },
-        {
-            11UL | ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS,
-            std::make_shared<internal::schema::descriptors::TransformElementKeyDescriptor> (
-                    "TRANSFORM_ELEMENT_KEY",
-                    ::amqp::schema::descriptors::TRANSFORM_ELEMENT_KEY)
-        }
-    };
+ ******************************************************************************/
+
+const amqp::internal::schema::descriptors::AMQPDescriptor *
+amqp::internal::
+DescriptorRegistory::find (uint64_t id_) const noexcept {
+    if (id_ == cursor::described_t) {
+        return table()[0];
+    }
+
+    constexpr uint64_t top = ~static_cast<uint64_t>(UINT_MAX);
+
+    if ((id_ & top) != ::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS) {
+        return nullptr;
+    }
+
+    auto id = stripCorda (id_);
+
+    return (id == 0 || id > MAX_ID) ? nullptr : table()[id];
+}
+
+/******************************************************************************/
+
+const amqp::internal::schema::descriptors::AMQPDescriptor *
+amqp::internal::
+DescriptorRegistory::operator[] (uint64_t id_) const {
+    if (auto rtn = find (id_)) {
+        return rtn;
+    }
+
+    std::stringstream ss;
+    ss << "Unknown described type " << std::hex << id_;
+    throw std::runtime_error (ss.str());
 }
 
 /******************************************************************************/
@@ -105,6 +125,13 @@ amqp::stripCorda (uint64_t id) {
 
 /******************************************************************************/
 
+bool
+amqp::isCorda (uint64_t id, int code) {
+    return id == (::amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS | static_cast<uint32_t>(code));
+}
+
+/******************************************************************************/
+
 std::string
 amqp::describedToString (uint64_t val_) {
       switch (val_) {
@@ -2,24 +2,47 @@
 
 /******************************************************************************/
 
-#include <map>
-#include <memory>
+#include <cstdint>
 
 /******************************************************************************/
 
 #include "AMQPDescriptor.h"
 
-/******************************************************************************/
-
-
 /******************************************************************************/
 
 /**
+ * Maps a described type's id onto the descriptor that knows how to decode
+ * it. The Corda ids are small and dense so dispatch is just an index into
+ * a fixed table, the only other key being the AMQP described type itself,
+ * [cursor::described_t], used to bootstrap reading an unknown node.
  *
+ * The registry is stateless, so is constant initialised, and the
+ * descriptors themselves are built on first use. It's therefore safe to
+ * use from anywhere, including the static initialisation of other
+ * translation units.
  */
 namespace amqp::internal {
 
-    extern std::map<uint64_t, std::shared_ptr<internal::schema::descriptors::AMQPDescriptor>> AMQPDescriptorRegistory;
+    class DescriptorRegistory {
+        public :
+            /**
+             * The largest Corda descriptor id we know about
+             */
+            static constexpr uint32_t MAX_ID = 11;
+
+            /**
+             * Returns nullptr for anything that isn't one of ours
+             */
+            const schema::descriptors::AMQPDescriptor * find (uint64_t) const noexcept;
+
+            /**
+             * As [find] but throws for an unknown id rather than returning
+             * nullptr
+             */
+            const schema::descriptors::AMQPDescriptor * operator[] (uint64_t) const;
+    };
+
+    inline constexpr DescriptorRegistory AMQPDescriptorRegistory { };
 
 }
 
@@ -39,6 +62,12 @@ namespace amqp {
      */
     uint32_t stripCorda (uint64_t id);
 
+    /**
+     * Whether [id] is Corda's descriptor [code], its top 32 bits and all,
+     * as [DescriptorRegistory::find] would have it
+     */
+    bool isCorda (uint64_t id, int code);
+
     std::string describedToString (uint64_t);
     std::string describedToString (uint32_t);
 }
@@ -3,9 +3,7 @@
 #include "amqp/schema/Descriptors.h"
 
 #include <string>
-#include <iostream>
-#include <proton/types.h>
-#include <proton/codec.h>
+#include <ostream>
 #include "colours.h"
 
 #include "debug.h"
@@ -17,7 +15,7 @@
 #include "amqp/schema/OrderedTypeNotations.h"
 #include "amqp/AMQPDescribed.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 #include "AMQPDescriptorRegistory.h"
 
 /******************************************************************************
@@ -28,25 +26,25 @@
 
 void
 amqp::internal::schema::descriptors::
-AMQPDescriptor::validateAndNext (pn_data_t * const data_) const {
-    if (pn_data_type(data_) != PN_ULONG) {
+AMQPDescriptor::validateAndNext (cursor::Cursor & data_) const {
+    if (data_.type() != cursor::ulong_t) {
         throw std::runtime_error ("Bad type for a descriptor");
     }
 
     if (   (m_val == -1)
-        || (pn_data_get_ulong(data_) != (static_cast<uint32_t>(m_val) | amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS)))
+        || (data_.get_ulong() != (static_cast<uint32_t>(m_val) | amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS)))
     {
         throw std::runtime_error ("Invalid Type");
     }
 
-    pn_data_next (data_);
+    data_.next();
 }
 
 /******************************************************************************/
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-ReferencedObjectDescriptor::build (pn_data_t * data_) const {
+ReferencedObjectDescriptor::build (cursor::Cursor & data_) const {
     validateAndNext (data_);
 
     DBG ("REFERENCED OBJECT " << data_ << std::endl); // NOLINT
@@ -58,7 +56,7 @@ ReferencedObjectDescriptor::build (pn_data_t * data_) const {
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-TransformSchemaDescriptor::build (pn_data_t * data_) const {
+TransformSchemaDescriptor::build (cursor::Cursor & data_) const {
     validateAndNext (data_);
 
     DBG ("TRANSFORM SCHEMA " << data_ << std::endl); // NOLINT
@@ -70,7 +68,7 @@ TransformSchemaDescriptor::build (pn_data_t * data_) const {
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-TransformElementDescriptor::build (pn_data_t * data_) const {
+TransformElementDescriptor::build (cursor::Cursor & data_) const {
     validateAndNext (data_);
 
     DBG ("TRANSFORM ELEMENT " << data_ << std::endl); // NOLINT
@@ -82,7 +80,7 @@ TransformElementDescriptor::build (pn_data_t * data_) const {
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-TransformElementKeyDescriptor::build (pn_data_t * data_) const {
+TransformElementKeyDescriptor::build (cursor::Cursor & data_) const {
     validateAndNext (data_);
 
     DBG ("TRANSFORM ELEMENT KEY" << data_ << std::endl); // NOLINT
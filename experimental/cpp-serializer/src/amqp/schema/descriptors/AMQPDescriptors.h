@@ -6,21 +6,16 @@
 #include <map>
 #include <string>
 #include <memory>
-#include <iostream>
 
 #include "types.h"
 #include "amqp/AMQPDescribed.h"
 #include "AMQPDescriptor.h"
 #include "amqp/schema/described-types/Descriptor.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 #include "AMQPDescriptorRegistory.h"
 
 /******************************************************************************/
 
-struct pn_data_t;
-
-/******************************************************************************/
-
 namespace amqp::internal::schema::descriptors {
 
     /**
@@ -31,12 +26,12 @@ namespace amqp::internal::schema::descriptors {
      */
     template<class T>
     uPtr <T>
-    dispatchDescribed(pn_data_t *data_) {
-        proton::is_described(data_);
-        proton::auto_enter p(data_);
-        proton::is_ulong(data_);
+    dispatchDescribed(cursor::Cursor & data_) {
+        cursor::is_described(data_);
+        cursor::auto_enter p(data_);
+        cursor::is_ulong(data_);
 
-        auto id = pn_data_get_ulong(data_);
+        auto id = data_.get_ulong();
 
         return uPtr<T>(
             static_cast<T *>(
@@ -58,7 +53,7 @@ namespace amqp::internal::schema::descriptors {
 
             ~ReferencedObjectDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
     };
 
 }
@@ -77,7 +72,7 @@ namespace amqp::internal::schema::descriptors {
 
             ~TransformSchemaDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
     };
 
 }
@@ -96,7 +91,7 @@ namespace amqp::internal::schema::descriptors {
 
             ~TransformElementDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
     };
 
 }
@@ -115,7 +110,7 @@ namespace amqp::internal::schema::descriptors {
 
             ~TransformElementKeyDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
     };
 
 }
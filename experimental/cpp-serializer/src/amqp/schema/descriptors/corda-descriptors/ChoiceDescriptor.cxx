@@ -3,7 +3,7 @@
 
 #include "types.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 /******************************************************************************/
 
@@ -18,11 +18,11 @@ ChoiceDescriptor::ChoiceDescriptor (
 
 std::unique_ptr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-ChoiceDescriptor::build (pn_data_t * data_) const  {
+ChoiceDescriptor::build (cursor::Cursor & data_) const  {
     validateAndNext (data_);
-    proton::auto_enter ae (data_);
+    cursor::auto_enter ae (data_);
 
-    auto name = proton::get_string (data_);
+    auto name = cursor::get_string (data_);
 
     return std::make_unique<schema::Choice> (name);
 }
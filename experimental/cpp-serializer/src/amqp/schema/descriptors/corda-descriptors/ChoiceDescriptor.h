@@ -18,7 +18,7 @@ namespace amqp::internal::schema::descriptors {
 
             ~ChoiceDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
     };
 
 }
@@ -2,12 +2,12 @@
 
 #include <string>
 #include <sstream>
-#include <iostream>
+#include <ostream>
 
 #include "types.h"
 #include "debug.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 #include "amqp/schema/descriptors/AMQPDescriptors.h"
 
@@ -33,56 +33,56 @@ CompositeDescriptor::CompositeDescriptor (
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-CompositeDescriptor::build (pn_data_t * data_) const {
+CompositeDescriptor::build (cursor::Cursor & data_) const {
     DBG ("COMPOSITE" << std::endl); // NOLINT
 
     validateAndNext(data_);
 
-    proton::auto_enter p (data_);
+    cursor::auto_enter p (data_);
 
     /* Class Name - String */
-    auto name = proton::get_string(data_);
+    auto name = cursor::get_string(data_);
 
-    pn_data_next(data_);
+    data_.next();
 
     /* Label Name - Nullable String */
-    auto label = proton::get_string (data_, true);
+    auto label = cursor::get_string (data_, true);
 
-    pn_data_next(data_);
+    data_.next();
 
     /* provides: List<String> */
-    std::list<std::string> provides;
+    std::vector<std::string> provides;
+    provides.reserve (data_.get_list());
     {
-        proton::auto_list_enter p2 (data_);
-        while (pn_data_next(data_)) {
-            provides.push_back (proton::get_string (data_));
+        cursor::auto_list_enter p2 (data_);
+        while (data_.next()) {
+            provides.push_back (cursor::get_string (data_));
         }
     }
 
-    pn_data_next (data_);
+    data_.next();
 
     /* descriptor: Descriptor */
     auto descriptor = descriptors::dispatchDescribed<schema::Descriptor>(data_);
 
-    pn_data_next (data_);
+    data_.next();
 
     /* fields: List<Described>*/
     std::vector<uPtr<schema::Field>> fields;
-    fields.reserve (pn_data_get_list (data_));
+    fields.reserve (data_.get_list());
     {
-        proton::auto_list_enter p2 (data_);
-        while (pn_data_next (data_)) {
+        cursor::auto_list_enter p2 (data_);
+        while (data_.next()) {
             fields.emplace_back (descriptors::dispatchDescribed<schema::Field>(data_));
         }
     }
 
     return std::make_unique<schema::Composite> (
-            schema::Composite (
-                    std::move (name),
-                    std::move (label),
-                    std::move (provides),
-                    std::move (descriptor),
-                    std::move (fields)));
+            std::move (name),
+            std::move (label),
+            std::move (provides),
+            std::move (descriptor),
+            std::move (fields));
 }
 
 /******************************************************************************/
@@ -90,58 +90,58 @@ CompositeDescriptor::build (pn_data_t * data_) const {
 void
 amqp::internal::schema::descriptors::
 CompositeDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const {
-    proton::is_list(data_);
+    cursor::is_list(data_);
 
     {
         AutoIndent ai { ai_ };
-        proton::auto_enter p (data_);
+        cursor::auto_enter p (data_);
 
-        proton::is_string (data_);
+        cursor::is_string (data_);
         ss_ << ai
             << "1] String: ClassName: "
-            << proton::readAndNext<std::string>(data_)
-            << std::endl;
+            << cursor::readAndNext<std::string>(data_)
+            << '\n';
 
-        proton::is_string (data_);
+        cursor::is_string (data_);
         ss_ << ai
             << "2] String: Label: \""
-            << proton::readAndNext<std::string>(data_, true)
-            << "\"" << std::endl;
+            << cursor::readAndNext<std::string>(data_, true)
+            << "\"" << '\n';
 
-        proton::is_list (data_);
+        cursor::is_list (data_);
 
         ss_ << ai << "3] List: Provides: [ ";
         {
-            proton::auto_list_enter ale (data_);
-            while (pn_data_next(data_)) {
-                ss_ << ai << (proton::get_string (data_)) << " ";
+            cursor::auto_list_enter ale (data_);
+            while (data_.next()) {
+                ss_ << ai << (cursor::get_string (data_)) << " ";
             }
         }
-        ss_ << "]" << std::endl;
+        ss_ << "]" << '\n';
 
-        pn_data_next (data_);
-        proton::is_described (data_);
+        data_.next();
+        cursor::is_described (data_);
 
-        ss_ << ai << "4] Descriptor:" << std::endl;
+        ss_ << ai << "4] Descriptor:" << '\n';
 
-        AMQPDescriptorRegistory[pn_data_type(data_)]->read (
-            (pn_data_t *)proton::auto_next(data_), ss_, AutoIndent { ai });
+        AMQPDescriptorRegistory[data_.type()]->read (
+            (cursor::Cursor &)cursor::auto_next(data_), ss_, AutoIndent { ai });
 
-        ss_ << ai << "5] List: Fields: " << std::endl;
+        ss_ << ai << "5] List: Fields: " << '\n';
         {
             AutoIndent ai2 { ai };
 
-            proton::auto_list_enter ale (data_);
-            for (int i { 1 } ; pn_data_next (data_) ; ++i) {
+            cursor::auto_list_enter ale (data_);
+            for (int i { 1 } ; data_.next() ; ++i) {
                 ss_ << ai2 << i << "/"
                     << ale.elements() << "]"
-                    << std::endl;
+                    << '\n';
 
-                AMQPDescriptorRegistory[pn_data_type(data_)]->read (
+                AMQPDescriptorRegistory[data_.type()]->read (
                         data_, ss_, AutoIndent { ai2 });
             }
         }
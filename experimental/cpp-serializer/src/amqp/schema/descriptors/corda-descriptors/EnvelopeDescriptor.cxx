@@ -2,7 +2,9 @@
 
 #include "amqp/schema/described-types/Schema.h"
 #include "amqp/schema/described-types/Envelope.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
 
 #include "types.h"
 #include "debug.h"
@@ -13,11 +15,59 @@
 
 namespace {
 
+    namespace cursor = amqp::internal::cursor;
+
     const std::string
-    consumeBlob (pn_data_t * data_) {
-        proton::is_described (data_);
-        proton::auto_enter p (data_);
-        return proton::get_symbol<std::string> (data_);
+    consumeBlob (cursor::Cursor & data_) {
+        cursor::is_described (data_);
+        cursor::auto_enter p (data_);
+        return cursor::get_symbol<std::string> (data_);
+    }
+
+    /**
+     * The name of the composite or restricted type under [data_] if it's
+     * the one described by [descriptor_]. Both are a described list of
+     * the name, label and provides, a restricted type then having its
+     * source, before the descriptor, itself a described list whose first
+     * element is the symbol
+     */
+    std::string_view
+    named (const cursor::Cursor & data_, std::string_view descriptor_) {
+        using namespace amqp::schema::descriptors;
+
+        if (!data_.is_described()) return { };
+
+        cursor::Cursor data { data_ };
+        data.enter();
+        data.next();
+
+        size_t before;
+        auto code = static_cast<int> (amqp::stripCorda (data.get_ulong()));
+
+        if (code == COMPOSITE_TYPE) {
+            before = 3;
+        } else if (code == RESTRICTED_TYPE) {
+            before = 4;
+        } else {
+            return { };
+        }
+
+        data.next();
+        data.enter();
+        data.next();
+
+        auto name = data.get_string();
+
+        data.skip (before);
+        if (!data.is_described()) return { };
+
+        data.enter();
+        data.next();
+        data.next();
+        data.enter();
+        data.next();
+
+        return data.get_symbol() == descriptor_ ? name : std::string_view { };
     }
 
 }
@@ -37,25 +87,25 @@ namespace {
 void
 amqp::internal::schema::descriptors::
 EnvelopeDescriptor::read (
-    pn_data_t * data_,
-    std::stringstream & ss_,
+    cursor::Cursor & data_,
+    std::ostream & ss_,
     const AutoIndent & ai_
 ) const {
     // lets just make sure we haven't entered this already
-    proton::is_list (data_);
+    cursor::is_list (data_);
 
     {
         AutoIndent ai { ai_ };
-        proton::auto_enter p (data_);
+        cursor::auto_enter p (data_);
 
-        ss_ << ai << "1]" << std::endl;
-        AMQPDescriptorRegistory[pn_data_type(data_)]->read (
-                (pn_data_t *)proton::auto_next (data_), ss_, AutoIndent { ai });
+        ss_ << ai << "1]" << '\n';
+        AMQPDescriptorRegistory[data_.type()]->read (
+                (cursor::Cursor &)cursor::auto_next (data_), ss_, AutoIndent { ai });
 
 
-        ss_ << ai << "2]" << std::endl;
-        AMQPDescriptorRegistory[pn_data_type(data_)]->read (
-                (pn_data_t *)proton::auto_next(data_), ss_, AutoIndent { ai });
+        ss_ << ai << "2]" << '\n';
+        AMQPDescriptorRegistory[data_.type()]->read (
+                (cursor::Cursor &)cursor::auto_next(data_), ss_, AutoIndent { ai });
 
     }
 }
@@ -72,14 +122,80 @@ EnvelopeDescriptor::EnvelopeDescriptor (
 
 /******************************************************************************/
 
+amqp::internal::schema::descriptors::EnvelopeDescriptor::Peek
+amqp::internal::schema::descriptors::
+EnvelopeDescriptor::peek (const cursor::Cursor & data_) {
+    cursor::Cursor data { data_ };
+
+    cursor::is_described (data);
+    cursor::auto_enter p (data);
+    cursor::is_ulong (data);
+
+    // the whole descriptor, so a hit in the cache rejects what decoding would
+    if (!amqp::isCorda (data.get_ulong(), amqp::schema::descriptors::ENVELOPE)) {
+        throw std::runtime_error ("Expected an Envelope");
+    }
+
+    data.next();
+    cursor::is_list (data);
+    cursor::auto_enter p2 (data);
+
+    Peek rtn;
+
+    {
+        cursor::is_described (data);
+        cursor::auto_enter p3 (data);
+        rtn.m_descriptor = cursor::get_symbol<std::string_view> (data);
+    }
+
+    if (!data.next()) {
+        throw std::runtime_error ("Envelope has no schema");
+    }
+
+    cursor::is_described (data);
+    rtn.m_schema = data.encoded();
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * The schema is a described list of lists of types
+ */
+std::string_view
+amqp::internal::schema::descriptors::
+EnvelopeDescriptor::type (const Peek & peek_) {
+    cursor::Cursor data (peek_.m_schema.data(), peek_.m_schema.size());
+
+    cursor::is_described (data);
+    cursor::auto_enter p (data, true);
+    cursor::is_list (data);
+    cursor::auto_list_enter p2 (data);
+
+    while (data.next()) {
+        cursor::auto_list_enter p3 (data);
+
+        while (data.next()) {
+            if (auto name = named (data, peek_.m_descriptor) ; !name.empty()) {
+                return name;
+            }
+        }
+    }
+
+    return { };
+}
+
+/******************************************************************************/
+
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-EnvelopeDescriptor::build (pn_data_t * data_) const {
+EnvelopeDescriptor::build (cursor::Cursor & data_) const {
     DBG ("ENVELOPE" << std::endl); // NOLINT
 
     validateAndNext(data_);
 
-    proton::auto_enter p (data_);
+    cursor::auto_enter p (data_);
 
     /*
      * The actual blob... if this was java we would use the type symbols
@@ -89,14 +205,14 @@ EnvelopeDescriptor::build (pn_data_t * data_) const {
      */
     std::string outerType = consumeBlob(data_);
 
-    pn_data_next (data_);
+    data_.next();
 
     /*
      * The schema
      */
     auto schema = descriptors::dispatchDescribed<schema::Schema> (data_);
 
-    pn_data_next(data_);
+    data_.next();
 
     /*
      * The transforms schema
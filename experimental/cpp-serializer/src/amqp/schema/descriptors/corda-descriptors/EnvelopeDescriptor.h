@@ -2,16 +2,9 @@
 
 
 #include <string>
+#include <string_view>
 
-#include "AMQPDescriptors.h"
-
-/******************************************************************************
- *
- * Forward Class Declarations
- *
- ******************************************************************************/
-
-struct pn_data_t;
+#include "amqp/schema/descriptors/AMQPDescriptors.h"
 
 /******************************************************************************
  *
@@ -23,16 +16,42 @@ namespace amqp::internal::schema::descriptors {
 
     class EnvelopeDescriptor : public AMQPDescriptor {
         public :
+            /**
+             * What is needed to decode a blob against a schema we have
+             * already built, found without decoding that schema. Both
+             * are views into the blob itself.
+             */
+            struct Peek {
+                std::string_view m_descriptor;  // the payload's type
+                std::string_view m_schema;      // the encoded schema section
+            };
+
+            /**
+             * Walk just far enough into the envelope under the cursor to
+             * find the payload's descriptor and the extent of the schema,
+             * skipping over each section using its encoded size. The cursor
+             * itself isn't moved.
+             */
+            static Peek peek (const cursor::Cursor &);
+
+            /**
+             * The name of the payload's type, found in the schema section
+             * by its descriptor, reading nothing but each type's name and
+             * descriptor and skipping the rest, so nothing is built. Empty
+             * if the schema doesn't describe it
+             */
+            static std::string_view type (const Peek &);
+
             EnvelopeDescriptor() = delete;
             EnvelopeDescriptor (std::string, int);
 
             ~EnvelopeDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
 
             void read (
-                    pn_data_t *,
-                    std::stringstream &,
+                    cursor::Cursor &,
+                    std::ostream &,
                     const AutoIndent &) const override;
     };
 
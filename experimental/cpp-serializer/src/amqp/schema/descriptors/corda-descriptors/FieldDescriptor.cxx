@@ -3,7 +3,7 @@
 #include "debug.h"
 #include "types.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 
 #include "amqp/schema/field-types/Field.h"
 
@@ -27,59 +27,61 @@ FieldDescriptor::FieldDescriptor (
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-FieldDescriptor::build (pn_data_t * data_) const {
+FieldDescriptor::build (cursor::Cursor & data_) const {
     DBG ("FIELD" << std::endl); // NOLINT
 
     validateAndNext (data_);
 
-    proton::auto_enter ae (data_);
+    cursor::auto_enter ae (data_);
 
     /* name: String */
-    auto name = proton::get_string (data_);
+    auto name = cursor::get_string (data_);
 
     DBG ("FIELD::name: \"" << name << "\"" << std::endl); // NOLINT
 
-    pn_data_next (data_);
+    data_.next();
 
     /* type: String */
-    auto type = proton::get_string (data_);
+    auto type = cursor::get_string (data_);
 
     DBG ("FIELD::type: \"" << type << "\"" << std::endl); // NOLINT
 
-    pn_data_next (data_);
+    data_.next();
 
     /* requires: List<String> */
-    std::list<std::string> requires;
+    std::vector<std::string> requires;
+    requires.reserve (data_.get_list());
     {
-        proton::auto_list_enter ale (data_);
-        while (pn_data_next(data_)) {
-            requires.push_back (proton::get_string(data_));
+        cursor::auto_list_enter ale (data_);
+        while (data_.next()) {
+            requires.push_back (cursor::get_string(data_));
         }
     }
 
-    pn_data_next (data_);
+    data_.next();
 
     /* default: String? */
-    auto def = proton::get_string (data_, true);
+    auto def = cursor::get_string (data_, true);
 
-    pn_data_next (data_);
+    data_.next();
 
     /* label: String? */
-    auto label = proton::get_string (data_, true);
+    auto label = cursor::get_string (data_, true);
 
-    pn_data_next (data_);
+    data_.next();
 
     /* mandatory: Boolean - copes with the Kotlin concept of nullability.
        If something is mandatory then it cannot be null */
-    auto mandatory = proton::get_boolean (data_);
+    auto mandatory = cursor::get_boolean (data_);
 
-    pn_data_next (data_);
+    data_.next();
 
     /* multiple: Boolean */
-    auto multiple = proton::get_boolean(data_);
+    auto multiple = cursor::get_boolean(data_);
 
     return schema::Field::make (
-            name, type, requires, def, label, mandatory, multiple);
+            std::move (name), std::move (type), std::move (requires),
+            std::move (def), std::move (label), mandatory, multiple);
 }
 
 /******************************************************************************/
@@ -87,51 +89,51 @@ FieldDescriptor::build (pn_data_t * data_) const {
 void
 amqp::internal::schema::descriptors::
 FieldDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const  {
-    proton::is_list (data_);
+    cursor::is_list (data_);
 
-    proton::auto_list_enter ale (data_, true);
+    cursor::auto_list_enter ale (data_, true);
     AutoIndent ai { ai_ };
 
     ss_ << ai << "1/7] String: Name: "
-        << proton::get_string ((pn_data_t *)proton::auto_next (data_))
-        << std::endl;
+        << cursor::get_string ((cursor::Cursor &)cursor::auto_next (data_))
+        << '\n';
     ss_ << ai << "2/7] String: Type: "
-        << proton::get_string ((pn_data_t *)proton::auto_next (data_))
-        << std::endl;
+        << cursor::get_string ((cursor::Cursor &)cursor::auto_next (data_))
+        << '\n';
 
     {
-        proton::auto_list_enter ale2 (data_);
+        cursor::auto_list_enter ale2 (data_);
 
         ss_ << ai << "3/7] List: Requires: elements " << ale2.elements()
-            << std::endl;
+            << '\n';
 
         AutoIndent ai2 { ai };
 
-        while (pn_data_next(data_)) {
-            ss_ << ai2 << proton::get_string (data_) << std::endl;
+        while (data_.next()) {
+            ss_ << ai2 << cursor::get_string (data_) << '\n';
         }
     }
 
-    pn_data_next (data_);
+    data_.next();
 
-    proton::is_string (data_, true);
+    cursor::is_string (data_, true);
 
     ss_ << ai << "4/7] String: Default: "
-        << proton::get_string ((pn_data_t *)proton::auto_next (data_), true)
-        << std::endl;
+        << cursor::get_string ((cursor::Cursor &)cursor::auto_next (data_), true)
+        << '\n';
     ss_ << ai << "5/7] String: Label: "
-        << proton::get_string ((pn_data_t *)proton::auto_next (data_), true)
-        << std::endl;
+        << cursor::get_string ((cursor::Cursor &)cursor::auto_next (data_), true)
+        << '\n';
     ss_ << ai << "6/7] Boolean: Mandatory: "
-        << proton::get_boolean ((pn_data_t *)proton::auto_next (data_))
-        << std::endl;
+        << cursor::get_boolean ((cursor::Cursor &)cursor::auto_next (data_))
+        << '\n';
     ss_ << ai << "7/7] Boolean: Multiple: "
-        << proton::get_boolean ((pn_data_t *)proton::auto_next (data_))
-        << std::endl;
+        << cursor::get_boolean ((cursor::Cursor &)cursor::auto_next (data_))
+        << '\n';
 }
 
 /******************************************************************************/
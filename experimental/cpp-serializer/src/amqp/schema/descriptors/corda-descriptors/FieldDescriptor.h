@@ -2,7 +2,6 @@
 
 /******************************************************************************/
 
-#include "proton/codec.h"
 #include "amqp/AMQPDescribed.h"
 #include "amqp/schema/descriptors/AMQPDescriptor.h"
 
@@ -17,11 +16,11 @@ namespace amqp::internal::schema::descriptors {
 
             ~FieldDescriptor() final = default;
 
-            std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+            std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
 
             void read (
-                pn_data_t *,
-                std::stringstream &,
+                cursor::Cursor &,
+                std::ostream &,
                 const AutoIndent &) const override;
     };
 
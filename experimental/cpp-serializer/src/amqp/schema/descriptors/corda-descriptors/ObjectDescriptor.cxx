@@ -3,7 +3,7 @@
 #include "types.h"
 #include "debug.h"
 
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 #include "amqp/schema/described-types/Descriptor.h"
 
 #include <sstream>
@@ -28,14 +28,14 @@ ObjectDescriptor::ObjectDescriptor (
  */
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-ObjectDescriptor::build (pn_data_t * data_) const {
+ObjectDescriptor::build (cursor::Cursor & data_) const {
     DBG ("DESCRIPTOR" << std::endl); // NOLINT
 
     validateAndNext (data_);
 
-    proton::auto_enter p (data_);
+    cursor::auto_enter p (data_);
 
-    auto symbol = proton::get_symbol<std::string> (data_);
+    auto symbol = cursor::get_symbol<std::string> (data_);
 
     return std::make_unique<schema::Descriptor> (symbol);
 }
@@ -45,23 +45,23 @@ ObjectDescriptor::build (pn_data_t * data_) const {
 void
 amqp::internal::schema::descriptors::
 ObjectDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const  {
-    proton::is_list (data_);
+    cursor::is_list (data_);
 
     {
         AutoIndent ai { ai_ };
-        proton::auto_list_enter ale (data_);
-        pn_data_next(data_);
+        cursor::auto_list_enter ale (data_);
+        data_.next();
 
         ss_ << ai << "1/2] "
-            << proton::get_symbol<std::string>(
-                          (pn_data_t *)proton::auto_next (data_))
-            << std::endl;
+            << cursor::get_symbol<std::string>(
+                          (cursor::Cursor &)cursor::auto_next (data_))
+            << '\n';
 
-        ss_ << ai << "2/2] " << data_ << std::endl;
+        ss_ << ai << "2/2] " << data_ << '\n';
     }
 }
 
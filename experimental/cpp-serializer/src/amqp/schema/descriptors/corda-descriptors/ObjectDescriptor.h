@@ -6,10 +6,6 @@
 
 /******************************************************************************/
 
-struct pn_data_t;
-
-/******************************************************************************/
-
 namespace amqp::internal::schema::descriptors {
 
     class ObjectDescriptor : public AMQPDescriptor {
@@ -20,11 +16,11 @@ namespace amqp::internal::schema::descriptors {
 
         ~ObjectDescriptor() final = default;
 
-        std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+        std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
 
         void read (
-                pn_data_t *,
-                std::stringstream &,
+                cursor::Cursor &,
+                std::ostream &,
                 const AutoIndent &) const override;
     };
 
@@ -7,47 +7,26 @@
 #include "amqp/schema/restricted-types/Restricted.h"
 #include "amqp/schema/descriptors/AMQPDescriptors.h"
 
-#include <map>
-#include <regex>
 #include <sstream>
+#include <string_view>
 
 /******************************************************************************/
 
 namespace {
 
-    const std::map<std::string, std::pair<std::regex, std::string>> regexs {
-            {
-                "java.lang.Integer",
-                std::pair { std::regex { "java.lang.Integer"}, "int"}
-            },
-            {
-                "java.lang.Boolean",
-                std::pair { std::regex { "java.lang.Boolean"}, "bool"}
-            },
-            {
-                "java.lang.Byte",
-                std::pair { std::regex { "java.lang.Byte"}, "char"}
-            },
-            {
-                "java.lang.Short",
-                std::pair { std::regex { "java.lang.Short"}, "short"}
-            },
-            {
-                "java.lang.Character",
-                std::pair { std::regex { "java.lang.Character"}, "char"}
-            },
-            {
-                "java.lang.Float",
-                std::pair { std::regex { "java.lang.Float"}, "float"}
-            },
-            {
-                "java.lang.Long",
-                std::pair { std::regex { "java.lang.Long"}, "long"}
-            },
-            {
-                "java.lang.Double",
-                std::pair { std::regex { "java.lang.Double"}, "double"}
-            }
+    /**
+     * Boxed primitives as the unboxed types they stand for, in the order
+     * they're replaced
+     */
+    constexpr std::pair<std::string_view, std::string_view> boxed[] {
+        { "java.lang.Boolean",   "boolean" },
+        { "java.lang.Byte",      "char" },
+        { "java.lang.Character", "char" },
+        { "java.lang.Double",    "double" },
+        { "java.lang.Float",     "float" },
+        { "java.lang.Integer",   "int" },
+        { "java.lang.Long",      "long" },
+        { "java.lang.Short",     "short" }
     };
 
 }
@@ -59,8 +38,15 @@ namespace amqp::internal::schema::descriptors {
     std::string
     RestrictedDescriptor::makePrim (const std::string & name_) {
         std::string name { name_ };
-        for (const auto & i: regexs) {
-            name = std::regex_replace (name, i.second.first, i.second.second);
+
+        // most names box nothing, and cost no more than the one search
+        if (name.find ("java.lang.") == std::string::npos) return name;
+
+        for (const auto & i : boxed) {
+            for (auto at = name.find (i.first) ; at != std::string::npos ; at = name.find (i.first, at)) {
+                name.replace (at, i.first.size(), i.second);
+                at += i.second.size();
+            }
         }
 
         return name;
@@ -99,43 +85,45 @@ RestrictedDescriptor::RestrictedDescriptor (
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-RestrictedDescriptor::build (pn_data_t * data_) const {
+RestrictedDescriptor::build (cursor::Cursor & data_) const {
     DBG ("RESTRICTED" << std::endl); // NOLINT
     validateAndNext(data_);
 
-    proton::auto_enter ae (data_);
+    cursor::auto_enter ae (data_);
 
-    auto name  = makePrim (proton::readAndNext<std::string>(data_));
-    auto label = proton::readAndNext<std::string>(data_, true);
+    auto name  = makePrim (cursor::readAndNext<std::string>(data_));
+    auto label = cursor::readAndNext<std::string>(data_, true);
 
     DBG ("  name: " << name << ", label: \"" << label << "\"" << std::endl);
 
     std::vector<std::string> provides;
+    provides.reserve (data_.get_list());
     {
-        proton::auto_list_enter ae2 (data_);
-        while (pn_data_next(data_)) {
-            provides.push_back (proton::get_string (data_));
+        cursor::auto_list_enter ae2 (data_);
+        while (data_.next()) {
+            provides.push_back (cursor::get_string (data_));
 
             DBG ("  provides: " << provides.back() << std::endl);
         }
     }
 
-    pn_data_next (data_);
+    data_.next();
 
-    auto source = proton::readAndNext<std::string> (data_);
+    auto source = cursor::readAndNext<std::string> (data_);
 
     DBG ("source: " << source << std::endl);
 
     auto descriptor = descriptors::dispatchDescribed<schema::Descriptor> (data_);
 
-    pn_data_next (data_);
+    data_.next();
 
     DBG ("choices: " << data_ << std::endl);
 
     std::vector<std::unique_ptr<schema::Choice>> choices;
+    choices.reserve (data_.get_list());
     {
-        proton::auto_list_enter ae2 (data_);
-        while (pn_data_next (data_)) {
+        cursor::auto_list_enter ae2 (data_);
+        while (data_.next()) {
             choices.push_back (
                 descriptors::dispatchDescribed<schema::Choice> (data_));
 
@@ -159,39 +147,39 @@ RestrictedDescriptor::build (pn_data_t * data_) const {
 void
 amqp::internal::schema::descriptors::
 RestrictedDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const {
-    proton::is_list (data_);
-    proton::auto_enter ae (data_);
+    cursor::is_list (data_);
+    cursor::auto_enter ae (data_);
     AutoIndent ai { ai_ };
 
     ss_ << ai << "1] String: Name: "
-        << proton::readAndNext<std::string> (data_)
-        << std::endl;
+        << cursor::readAndNext<std::string> (data_)
+        << '\n';
     ss_ << ai << "2] String: Label: "
-        << proton::readAndNext<std::string> (data_, true)
-        << std::endl;
+        << cursor::readAndNext<std::string> (data_, true)
+        << '\n';
     ss_ << ai << "3] List: Provides: [ ";
 
     {
-        proton::auto_list_enter ae2 (data_);
-        while (pn_data_next(data_)) {
-            ss_ << proton::get_string (data_) << " ";
+        cursor::auto_list_enter ae2 (data_);
+        while (data_.next()) {
+            ss_ << cursor::get_string (data_) << " ";
         }
-        ss_ << "]" << std::endl;
+        ss_ << "]" << '\n';
     }
 
-    pn_data_next (data_);
+    data_.next();
     ss_ << ai << "4] String: Source: "
-        << proton::readAndNext<std::string> (data_)
-        << std::endl;
+        << cursor::readAndNext<std::string> (data_)
+        << '\n';
 
-    ss_ << ai << "5] Descriptor:" << std::endl;
+    ss_ << ai << "5] Descriptor:" << '\n';
 
-    AMQPDescriptorRegistory[pn_data_type(data_)]->read (
-            (pn_data_t *)proton::auto_next(data_), ss_, AutoIndent { ai });
+    AMQPDescriptorRegistory[data_.type()]->read (
+            (cursor::Cursor &)cursor::auto_next(data_), ss_, AutoIndent { ai });
 }
 
 /******************************************************************************/
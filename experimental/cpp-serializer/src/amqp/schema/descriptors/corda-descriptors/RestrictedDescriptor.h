@@ -25,11 +25,11 @@ namespace amqp::internal::schema::descriptors {
 
         ~RestrictedDescriptor() final = default;
 
-        std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+        std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
 
         void read (
-                pn_data_t *,
-                std::stringstream &,
+                cursor::Cursor &,
+                std::ostream &,
                 const AutoIndent &) const override;
     };
 
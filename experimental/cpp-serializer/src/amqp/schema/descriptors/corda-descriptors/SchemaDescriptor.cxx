@@ -4,12 +4,11 @@
 #include "debug.h"
 #include "AMQPDescriptor.h"
 
-#include "proton/codec.h"
-#include "proton/proton_wrapper.h"
+#include "cursor/Cursor.h"
 #include "amqp/AMQPDescribed.h"
 #include "amqp/schema/descriptors/AMQPDescriptors.h"
 #include "amqp/schema/described-types/Schema.h"
-#include "amqp/schema/OrderedTypeNotations.h"
+#include "amqp/schema/TypeNotationGraph.h"
 #include "amqp/schema/AMQPTypeNotation.h"
 
 #include <sstream>
@@ -27,28 +26,26 @@ SchemaDescriptor::SchemaDescriptor (
 
 uPtr<amqp::AMQPDescribed>
 amqp::internal::schema::descriptors::
-SchemaDescriptor::build (pn_data_t * data_) const {
+SchemaDescriptor::build (cursor::Cursor & data_) const {
     DBG ("SCHEMA" << std::endl); // NOLINT
 
     validateAndNext(data_);
 
-    schema::OrderedTypeNotations<schema::AMQPTypeNotation> schemas;
+    schema::TypeNotationGraph<schema::AMQPTypeNotation> schemas;
 
     /*
      * The Schema is stored as a list of lists of described objects
      */
     {
-        proton::auto_list_enter ale (data_);
+        cursor::auto_list_enter ale (data_);
 
-        for (int i { 1 } ; pn_data_next(data_) ; ++i) {
+        for (int i { 1 } ; data_.next() ; ++i) {
             DBG ("  " << i << "/" << ale.elements() << std::endl); // NOLINT
-            proton::auto_list_enter ale2 (data_);
-            while (pn_data_next(data_)) {
+            cursor::auto_list_enter ale2 (data_);
+            while (data_.next()) {
                 schemas.insert (
                     descriptors::dispatchDescribed<schema::AMQPTypeNotation> (
                         data_));
-
-                DBG("=======" << std::endl << schemas << "======" << std::endl);
             }
         }
     }
@@ -62,30 +59,30 @@ SchemaDescriptor::build (pn_data_t * data_) const {
 void
 amqp::internal::schema::descriptors::
 SchemaDescriptor::read (
-        pn_data_t * data_,
-        std::stringstream & ss_,
+        cursor::Cursor & data_,
+        std::ostream & ss_,
         const AutoIndent & ai_
 ) const {
-    proton::is_list (data_);
+    cursor::is_list (data_);
 
     {
         AutoIndent ai { ai_ };
-        proton::auto_list_enter ale (data_);
+        cursor::auto_list_enter ale (data_);
 
-        for (int i { 1 } ; pn_data_next (data_) ; ++i) {
-            proton::is_list (data_);
+        for (int i { 1 } ; data_.next() ; ++i) {
+            cursor::is_list (data_);
             ss_ << ai << i << "/" << ale.elements() <<"]";
 
             AutoIndent ai2 { ai };
 
-            proton::auto_list_enter ale2 (data_);
-            ss_ << " list: entries: " << ale2.elements() << std::endl;
+            cursor::auto_list_enter ale2 (data_);
+            ss_ << " list: entries: " << ale2.elements() << '\n';
 
-            for (int j { 1 } ; pn_data_next (data_) ; ++j) {
+            for (int j { 1 } ; data_.next() ; ++j) {
                 ss_ << ai2 << i << ":" << j << "/" << ale2.elements()
-                        << "] " << std::endl;
+                        << "] " << '\n';
 
-                AMQPDescriptorRegistory[pn_data_type(data_)]->read (
+                AMQPDescriptorRegistory[data_.type()]->read (
                         data_, ss_,
                         AutoIndent { ai2 });
             }
@@ -4,10 +4,6 @@
 
 /******************************************************************************/
 
-struct pn_data_t;
-
-/******************************************************************************/
-
 namespace amqp::internal::schema::descriptors {
 
     class SchemaDescriptor : public AMQPDescriptor {
@@ -16,11 +12,11 @@ namespace amqp::internal::schema::descriptors {
         SchemaDescriptor (std::string, int);
         ~SchemaDescriptor() final = default;
 
-        std::unique_ptr<AMQPDescribed> build (pn_data_t *) const override;
+        std::unique_ptr<AMQPDescribed> build (cursor::Cursor &) const override;
 
         void read (
-                pn_data_t *,
-                std::stringstream &,
+                cursor::Cursor &,
+                std::ostream &,
                 const AutoIndent &) const override;
     };
 
@@ -2,15 +2,7 @@
 
 #include "debug.h"
 
-#include <iostream>
-
-/******************************************************************************/
-
-const std::string
-amqp::internal::schema::
-ArrayField::m_fieldType {
-        "array"
-};
+#include <ostream>
 
 /******************************************************************************/
 
@@ -18,7 +10,7 @@ amqp::internal::schema::
 ArrayField::ArrayField (
     std::string name_,
     std::string type_,
-    std::list<std::string> requires_,
+    std::vector<std::string> requires_,
     std::string default_,
     std::string label_,
     bool mandatory_,
@@ -48,7 +40,8 @@ ArrayField::resolvedType() const {
 const std::string &
 amqp::internal::schema::
 ArrayField::fieldType() const {
-    return m_fieldType;
+    static const std::string rtn { m_fieldType };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -8,11 +8,11 @@ namespace amqp::internal::schema {
 
     class ArrayField : public RestrictedField {
         private :
-            static const std::string m_fieldType;
+            static constexpr std::string_view m_fieldType { "array" };
 
         public :
             ArrayField (
-                std::string, std::string, std::list<std::string>,
+                std::string, std::string, std::vector<std::string>,
                 std::string, std::string, bool, bool);
 
             const std::string & fieldType() const override;
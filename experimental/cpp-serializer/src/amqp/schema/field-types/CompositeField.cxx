@@ -1,6 +1,6 @@
 #include "CompositeField.h"
 
-#include <iostream>
+#include <ostream>
 
 #include "Field.h"
 
@@ -8,18 +8,11 @@
 
 /******************************************************************************/
 
-const std::string
-amqp::internal::schema::CompositeField::m_fieldType {
-        "composite"
-};
-
-/******************************************************************************/
-
 amqp::internal::schema::
 CompositeField::CompositeField (
         std::string name_,
         std::string type_,
-        std::list<std::string> requires_,
+        std::vector<std::string> requires_,
         std::string default_,
         std::string label_,
         bool mandatory_,
@@ -49,7 +42,8 @@ CompositeField::primitive() const {
 const std::string &
 amqp::internal::schema::
 CompositeField::fieldType() const {
-    return m_fieldType;
+    static const std::string rtn { m_fieldType };
+    return rtn;
 }
 
 /******************************************************************************/
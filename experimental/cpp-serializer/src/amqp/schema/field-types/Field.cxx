@@ -1,7 +1,7 @@
 #include "Field.h"
 
 #include <sstream>
-#include <iostream>
+#include <ostream>
 
 #include "debug.h"
 
@@ -10,7 +10,7 @@
 #include "CompositeField.h"
 #include "RestrictedField.h"
 
-#include "../restricted-types/Array.h"
+#include "amqp/schema/TypeNames.h"
 
 /******************************************************************************/
 
@@ -37,13 +37,15 @@ amqp::internal::schema::
 Field::make (
         std::string name_,
         std::string type_,
-        std::list<std::string> requires_,
+        std::vector<std::string> requires_,
         std::string default_,
         std::string label_,
         bool mandatory_,
         bool multiple_
 ) {
-    if (typeIsPrimitive (type_)) {
+    const auto kind = TypeNames::instance().parse (type_).kind();
+
+    if (kind == TypeName::primitive_t) {
         DBG ("-> primitive" << std::endl);
         return std::make_unique<PrimitiveField>(
                 std::move (name_),
@@ -52,7 +54,7 @@ Field::make (
                 std::move (label_),
                 mandatory_,
                 multiple_);
-    } else if (Array::isArrayType (type_)) {
+    } else if (kind == TypeName::array_t || kind == TypeName::packed_t) {
         DBG ("-> array" << std::endl);
         return std::make_unique<ArrayField>(
                 std::move (name_),
@@ -63,7 +65,7 @@ Field::make (
                 mandatory_,
                 multiple_);
 
-    } else if (type_ == "*") {
+    } else if (kind == TypeName::any_t) {
         DBG ("-> restricted" << std::endl);
         return std::make_unique<RestrictedField>(
                 std::move (name_),
@@ -97,7 +99,7 @@ amqp::internal::schema::
 Field::Field (
     std::string name_,
     std::string type_,
-    std::list<std::string> requires_,
+    std::vector<std::string> requires_,
     std::string default_,
     std::string label_,
     bool mandatory_,
@@ -118,11 +120,7 @@ Field::Field (
 bool
 amqp::internal::schema::
 Field::typeIsPrimitive (const std::string & type_) {
-    return (type_ == "string" ||
-            type_ == "long" ||
-            type_ == "boolean" ||
-            type_ == "int" ||
-            type_ == "double");
+    return TypeNames::instance().parse (type_).isPrimitive();
 }
 
 /******************************************************************************/
@@ -143,7 +141,7 @@ Field::type() const {
 
 /******************************************************************************/
 
-const std::list<std::string> &
+const std::vector<std::string> &
 amqp::internal::schema::
 Field::requires() const {
     return m_requires;
@@ -151,3 +149,35 @@ Field::requires() const {
 
 /******************************************************************************/
 
+bool
+amqp::internal::schema::
+Field::mandatory() const {
+    return m_mandatory;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::schema::
+Field::multiple() const {
+    return m_multiple;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::schema::
+Field::defaultValue() const {
+    return m_default;
+}
+
+/******************************************************************************/
+
+const std::string &
+amqp::internal::schema::
+Field::label() const {
+    return m_label;
+}
+
+/******************************************************************************/
+
@@ -7,7 +7,7 @@
 
 #include "types.h"
 
-#include <list>
+#include <vector>
 #include <string>
 #include <iosfwd>
 
@@ -33,26 +33,35 @@ namespace amqp::internal::schema {
             static bool typeIsPrimitive (const std::string &);
 
             static uPtr<Field> make (
-                    std::string, std::string, std::list<std::string>,
+                    std::string, std::string, std::vector<std::string>,
                     std::string, std::string, bool, bool);
 
         private :
             std::string            m_name;
             std::string            m_type;
-            std::list<std::string> m_requires;
+            std::vector<std::string> m_requires;
             std::string            m_default;
             std::string            m_label;
             bool                   m_mandatory;
             bool                   m_multiple;
 
         protected :
-            Field (std::string, std::string, std::list<std::string>,
+            Field (std::string, std::string, std::vector<std::string>,
                std::string, std::string, bool, bool);
 
         public :
             const std::string & name() const;
             const std::string & type() const;
-            const std::list<std::string> & requires() const;
+            const std::vector<std::string> & requires() const;
+
+            /**
+             * False when the property can be null
+             */
+            bool mandatory() const;
+            bool multiple() const;
+
+            const std::string & defaultValue() const;
+            const std::string & label() const;
 
             virtual bool primitive() const = 0;
             virtual const std::string & fieldType() const = 0;
@@ -2,13 +2,6 @@
 
 /******************************************************************************/
 
-const std::string
-amqp::internal::schema::PrimitiveField::m_fieldType {
-        "primitive"
-};
-
-/******************************************************************************/
-
 amqp::internal::schema::
 PrimitiveField::PrimitiveField (
     std::string name_,
@@ -41,7 +34,8 @@ PrimitiveField::primitive() const {
 const std::string &
 amqp::internal::schema::
 PrimitiveField::fieldType() const {
-    return m_fieldType;
+    static const std::string rtn { m_fieldType };
+    return rtn;
 }
 
 /******************************************************************************/
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include "Field.h"
 
 /******************************************************************************/
@@ -8,7 +10,7 @@ namespace amqp::internal::schema {
 
     class PrimitiveField : public Field {
         private :
-            static const std::string m_fieldType;
+            static constexpr std::string_view m_fieldType { "primitive" };
 
         public :
             PrimitiveField (
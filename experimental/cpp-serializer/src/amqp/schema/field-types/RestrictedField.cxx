@@ -2,18 +2,11 @@
 
 /******************************************************************************/
 
-const std::string
-amqp::internal::schema::RestrictedField::m_fieldType {
-    "restricted"
-};
-
-/******************************************************************************/
-
 amqp::internal::schema::
 RestrictedField::RestrictedField (
     std::string name_,
     std::string type_,
-    std::list<std::string> requires_,
+    std::vector<std::string> requires_,
     std::string default_,
     std::string label_,
     bool mandatory_,
@@ -42,7 +35,8 @@ RestrictedField::primitive() const {
 const std::string &
 amqp::internal::schema::
 RestrictedField::fieldType() const {
-    return m_fieldType;
+    static const std::string rtn { m_fieldType };
+    return rtn;
 }
 
 /******************************************************************************/
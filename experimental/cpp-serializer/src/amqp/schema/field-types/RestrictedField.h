@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include "Field.h"
 
 /******************************************************************************/
@@ -8,11 +10,11 @@ namespace amqp::internal::schema {
 
     class RestrictedField : public Field {
         private :
-            static const std::string m_fieldType;
+            static constexpr std::string_view m_fieldType { "restricted" };
 
         public :
             RestrictedField (
-                std::string, std::string, std::list<std::string>,
+                std::string, std::string, std::vector<std::string>,
                 std::string, std::string, bool, bool);
 
             bool primitive() const override;
@@ -3,6 +3,7 @@
 #include "Map.h"
 #include "List.h"
 #include "Enum.h"
+#include "amqp/schema/TypeNames.h"
 #include "amqp/schema/described-types/Composite.h"
 
 /******************************************************************************
@@ -11,32 +12,24 @@
  *
  ******************************************************************************/
 
-namespace {
-
-    const std::string array { "[]" };
-    const std::string primArray { "[p]" };
-
-}
-
+/**
+ * The element type, as spelt within the array's name
+ */
 std::string
 amqp::internal::schema::
 Array::arrayType (const std::string & array_) {
-    auto pos = array_.find ('[');
-    return std::string { array_.substr (0, pos) };
+    auto & names = TypeNames::instance();
+    const auto & type = names.parse (array_);
+
+    return type.isArray() ? names[type.args().front()].name() : type.name();
 }
 
-/**
- * when C++20 is done we can use .endswith, until then we have to do a reverse search
- */
+/******************************************************************************/
+
 bool
 amqp::internal::schema::
 Array::isArrayType (const std::string & type_) {
-    return (std::equal (
-                type_.rbegin(), type_.rbegin() + array.size(),
-                array.rbegin(), array.rend())
-        || std::equal (
-                type_.rbegin(), type_.rbegin() + primArray.size(),
-                primArray.rbegin(), primArray.rend()));
+    return TypeNames::instance().parse (type_).isArray();
 }
 
 /******************************************************************************
@@ -1,4 +1,4 @@
-#include <iostream>
+#include <stdexcept>
 #include "List.h"
 #include "Map.h"
 #include "Enum.h"
@@ -6,6 +6,7 @@
 #include "debug.h"
 #include "colours.h"
 
+#include "amqp/schema/TypeNames.h"
 #include "amqp/schema/described-types/Composite.h"
 
 /******************************************************************************
@@ -17,12 +18,16 @@
 std::pair<std::string, std::string>
 amqp::internal::schema::
 List::listType (const std::string & list_) {
-    auto pos = list_.find ('<');
+    auto & names = TypeNames::instance();
+    const auto & type = names.parse (list_);
+
+    if (type.kind() != TypeName::generic_t || type.args().size() != 1) {
+        throw std::runtime_error ("Expected a list of one type, not " + list_);
+    }
 
     return std::make_pair (
-           std::string { unbox (list_.substr (0, pos)) },
-           std::string { unbox (list_.substr(pos + 1, list_.size() - pos - 2)) }
-    );
+           unbox (type.base()),
+           names[type.args().front()].unboxed());
 }
 
 /******************************************************************************
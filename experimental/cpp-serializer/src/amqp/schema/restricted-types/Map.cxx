@@ -1,6 +1,10 @@
 #include "Map.h"
+
+#include <stdexcept>
+
 #include "List.h"
 #include "Enum.h"
+#include "amqp/schema/TypeNames.h"
 #include "amqp/schema/described-types/Composite.h"
 
 /******************************************************************************
@@ -12,26 +16,18 @@
 std::tuple<std::string, std::string, std::string>
 amqp::internal::schema::
 Map::mapType (const std::string & map_) {
-    uint pos = map_.find ('<');
-
-    uint idx { pos + 1 };
-    for (uint nesting { 0 } ; idx < map_.size(); ++idx) {
-        if (map_[idx] == '<') {
-            ++nesting;
-        } else if (map_[idx] == '>') {
-            --nesting;
-        } else if (map_[idx] == ',' && nesting == 0) {
-            break;
-        }
-    }
+    auto & names = TypeNames::instance();
+    const auto & type = names.parse (map_);
 
-    auto map = std::string { map_.substr (0, pos) };
-    auto of  = std::string { map_.substr (pos + 1, idx - pos - 1) };
-    of = of.erase(0, of.find_first_not_of(' '));
-    auto to  = std::string { map_.substr (idx + 1, map_.size() - (idx + 2)) };
-    to = to.erase(0, to.find_first_not_of(' '));
+    if (type.kind() != TypeName::generic_t || type.args().size() != 2) {
+        throw std::runtime_error ("Expected a map of two types, not " + map_);
+    }
 
-    return { map, unbox (of), unbox (to) };
+    return {
+        type.base(),
+        names[type.args()[0]].unboxed(),
+        names[type.args()[1]].unboxed()
+    };
 }
 
 /******************************************************************************
@@ -5,9 +5,11 @@
 #include "Enum.h"
 #include "Array.h"
 
+#include "schema/TypeNames.h"
+
 #include <string>
 #include <vector>
-#include <iostream>
+#include <ostream>
 
 /******************************************************************************
  *
@@ -78,25 +80,10 @@ namespace amqp::internal::schema {
  *
  ******************************************************************************/
 
-namespace {
-
-    std::map<std::string, std::string> boxedToUnboxed = {
-            { "java.lang.Integer", "int" },
-            { "java.lang.Boolean", "bool" },
-            { "java.lang.Byte", "char" },
-            { "java.lang.Short", "short" },
-            { "java.lang.Character", "char" },
-            { "java.lang.Float", "float" },
-            { "java.lang.Long", "long" },
-            { "java.lang.Double", "double" }
-    };
-
-}
-
 /******************************************************************************/
 
 /**
- * Java gas two types of primitive, boxed and unboxed, essentially actual
+ * Java has two types of primitive, boxed and unboxed, essentially actual
  * primitives and classes representing those primitives. Of course, we
  * don't care about that, so treat boxed primitives as their underlying
  * type.
@@ -104,9 +91,7 @@ namespace {
 std::string
 amqp::internal::schema::
 Restricted::unbox (const std::string & type_) {
-    auto it = boxedToUnboxed.find (type_);
-    if (it == boxedToUnboxed.end()) return type_;
-    else return it->second;
+    return TypeNames::instance().parse (type_).unboxed();
 }
 
 
@@ -147,13 +132,7 @@ Restricted::make(
      */
     if (source_ == "list") {
         if (choices_.empty()) {
-            const std::string array { "[]" };
-            const std::string primArray { "[p]" };
-
-            // when C++20 is done we can use .endswith, until then we have to do a reverse search
-            if (   std::equal (name_.rbegin(), name_.rbegin() + array.size(), array.rbegin(), array.rend())
-                || std::equal (name_.rbegin(), name_.rbegin() + primArray.size(), primArray.rbegin(), primArray.rend()))
-            {
+            if (TypeNames::instance().parse (name_).isArray()) {
                 return std::make_unique<Array>(
                         std::move (descriptor_),
                         std::move (name_),
@@ -225,6 +204,14 @@ Restricted::restrictedType() const {
 
 /******************************************************************************/
 
+std::vector<std::string_view>
+amqp::internal::schema::
+Restricted::dependencies() const {
+    return { begin(), end() };
+}
+
+/******************************************************************************/
+
 int
 amqp::internal::schema::
 Restricted::dependsOn (const OrderedTypeNotation & rhs_) const {
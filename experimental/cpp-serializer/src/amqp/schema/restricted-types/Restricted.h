@@ -104,6 +104,8 @@ namespace amqp::internal::schema {
             virtual std::vector<std::string>::const_iterator begin() const = 0;
             virtual std::vector<std::string>::const_iterator end() const = 0;
 
+            std::vector<std::string_view> dependencies() const override;
+
             int dependsOn (const OrderedTypeNotation &) const override;
             int dependsOnRHS (const Restricted &) const override;
 
@@ -0,0 +1,557 @@
+#include "CborSink.h"
+
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+/******************************************************************************/
+
+namespace {
+
+    enum Major : uint8_t {
+        unsigned_m = 0, negative_m = 1, bytes_m = 2, text_m = 3,
+        array_m = 4, map_m = 5, tag_m = 6
+    };
+
+    /**
+     * Tags of the stringref extension, a namespace and a reference
+     * within it
+     */
+    constexpr uint64_t STRINGREF_NAMESPACE = 256;
+    constexpr uint64_t STRINGREF = 25;
+
+    /**
+     * The shortest string worth numbering when [n_] already are, any
+     * shorter being no longer than the reference that'd replace it
+     */
+    size_t
+    shortest (size_t n_) {
+        if (n_ < 24) return 3;
+        if (n_ < 256) return 4;
+        if (n_ < 65536) return 5;
+        if (n_ < 4294967296ULL) return 7;
+        return 11;
+    }
+
+    /**
+     * The additional information of an item whose length is left open
+     * until a break
+     */
+    constexpr uint8_t INDEFINITE = 31;
+
+    constexpr char FALSE = '\xF4';
+    constexpr char TRUE  = '\xF5';
+    constexpr char NIL   = '\xF6';
+    constexpr char BREAK = '\xFF';
+
+    constexpr char FLOAT  = '\xFA';
+    constexpr char DOUBLE = '\xFB';
+
+    /**
+     * Half precision's quiet NaN, the shortest form every NaN takes
+     */
+    constexpr std::string_view NAN_ { "\xF9\x7E\x00", 3 };
+
+    /**
+     * The initial byte of an item of [major_] type and the argument
+     * following it, in as few bytes as hold it, written to [bytes_]
+     * returning how many were
+     */
+    size_t
+    head (uint8_t major_, uint64_t argument_, char * bytes_) {
+        size_t width;
+
+        if (argument_ < 24) {
+            bytes_[0] = static_cast<char> (major_ << 5 | argument_);
+            return 1;
+        } else if (argument_ <= 0xFF) {
+            bytes_[0] = static_cast<char> (major_ << 5 | 24);
+            width = 1;
+        } else if (argument_ <= 0xFFFF) {
+            bytes_[0] = static_cast<char> (major_ << 5 | 25);
+            width = 2;
+        } else if (argument_ <= 0xFFFFFFFF) {
+            bytes_[0] = static_cast<char> (major_ << 5 | 26);
+            width = 4;
+        } else {
+            bytes_[0] = static_cast<char> (major_ << 5 | 27);
+            width = 8;
+        }
+
+        for (size_t i { 0 } ; i < width ; ++i) {
+            bytes_[width - i] = static_cast<char> (argument_ >> (8 * i));
+        }
+
+        return width + 1;
+    }
+
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CborSink::CborSink (std::ostream & stream_, size_t capacity_)
+    : m_levels { { top_t, false } }
+    , m_stream (&stream_)
+    , m_string (nullptr)
+    , m_fd (-1)
+    , m_capacity (capacity_ ? capacity_ : 1)
+    , m_buffer (m_own)
+    , m_stringrefs (false)
+{
+    m_buffer.reserve (m_capacity);
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CborSink::CborSink (int fd_, size_t capacity_)
+    : m_levels { { top_t, false } }
+    , m_stream (nullptr)
+    , m_string (nullptr)
+    , m_fd (fd_)
+    , m_capacity (capacity_ ? capacity_ : 1)
+    , m_buffer (m_own)
+    , m_stringrefs (false)
+{
+    m_buffer.reserve (m_capacity);
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CborSink::CborSink (std::string & out_, size_t)
+    : m_levels { { top_t, false } }
+    , m_stream (nullptr)
+    , m_string (&out_)
+    , m_fd (-1)
+    , m_capacity (std::string::npos)
+    , m_buffer (out_)
+    , m_stringrefs (false)
+{
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CborSink::~CborSink() {
+    try {
+        flush();
+    } catch (...) {
+        // nothing sensible to do with a failed write on teardown
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::flush() {
+    // a string's already been written to
+    if (m_buffer.empty() || m_string) return;
+
+    if (m_stream) {
+        m_stream->write (m_buffer.data(), m_buffer.size());
+    } else {
+        const char * p = m_buffer.data();
+        size_t left    = m_buffer.size();
+
+        while (left) {
+            auto rtn = ::write (m_fd, p, left);
+            if (rtn < 0) {
+                if (errno == EINTR) continue;
+                m_buffer.clear();
+                throw std::runtime_error ("Failed writing CBOR output");
+            }
+            p += rtn;
+            left -= rtn;
+        }
+    }
+
+    m_buffer.clear();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::put (std::string_view s_) {
+    if (m_buffer.size() + s_.size() > m_capacity) {
+        flush();
+
+        // too big to be worth buffering
+        if (s_.size() >= m_capacity) {
+            m_buffer.assign (s_.begin(), s_.end());
+            flush();
+            return;
+        }
+    }
+
+    m_buffer.append (s_.begin(), s_.end());
+}
+
+/******************************************************************************/
+
+/**
+ * Arguments below 24 fit in the initial byte, anything larger follows it
+ * big endian in one, two, four or eight bytes
+ */
+void
+amqp::internal::sink::
+CborSink::head (uint8_t major_, uint64_t argument_) {
+    char bytes[9];
+
+    if (argument_ < 24) {
+        put (static_cast<char> (major_ << 5 | argument_));
+    } else {
+        put ({ bytes, ::head (major_, argument_, bytes) });
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::encode (int64_t value_) {
+    if (value_ < 0) {
+        // -1 - value, without overflowing on the smallest long
+        head (negative_m, ~static_cast<uint64_t> (value_));
+    } else {
+        head (unsigned_m, static_cast<uint64_t> (value_));
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::encode (double value_) {
+    if (std::isnan (value_)) {
+        put (NAN_);
+        return;
+    }
+
+    char bytes[9];
+    size_t width;
+    uint64_t bits;
+
+    auto single = static_cast<float> (value_);
+
+    if (static_cast<double> (single) == value_) {
+        uint32_t b;
+        std::memcpy (&b, &single, sizeof (b));
+
+        bytes[0] = FLOAT;
+        bits = b;
+        width = 4;
+    } else {
+        std::memcpy (&bits, &value_, sizeof (bits));
+
+        bytes[0] = DOUBLE;
+        width = 8;
+    }
+
+    for (size_t i { 0 } ; i < width ; ++i) {
+        bytes[width - i] = static_cast<char> (bits >> (8 * i));
+    }
+
+    put ({ bytes, width + 1 });
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::before() {
+    auto context = m_levels.back().m_context;
+
+    if (context == object_t) {
+        throw std::runtime_error ("CBOR object value without a key");
+    }
+
+    if (context == top_t && m_stringrefs) {
+        m_strings.clear();
+        head (tag_m, STRINGREF_NAMESPACE);
+    }
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::sink::
+CborSink::reference (uint8_t major_, std::string_view value_) {
+    if (!m_stringrefs) return false;
+
+    auto i = m_strings.find (value_, major_);
+
+    if (i != Dictionary::npos) {
+        head (tag_m, STRINGREF);
+        head (unsigned_m, i);
+        return true;
+    }
+
+    if (value_.size() >= shortest (m_strings.size())) m_strings.add (value_, major_);
+
+    return false;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::after() {
+    auto & level = m_levels.back();
+
+    if (level.m_context == map_t) {
+        level.m_key = !level.m_key;
+    } else if (level.m_context == value_t) {
+        level.m_context = object_t;
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::open (uint8_t major_, Context context_) {
+    before();
+    put (static_cast<char> (major_ << 5 | INDEFINITE));
+    m_levels.push_back ( { context_, context_ == map_t } );
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::close (Context context_) {
+    if (m_levels.size() < 2 || m_levels.back().m_context != context_) {
+        throw std::runtime_error ("Mismatched end of CBOR container");
+    }
+
+    m_levels.pop_back();
+    put (BREAK);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::beginObject() {
+    open (map_m, object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::endObject() {
+    close (object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::beginList() {
+    open (array_m, list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::endList() {
+    close (list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::beginMap() {
+    open (map_m, map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::endMap() {
+    if (m_levels.back().m_context == map_t && !m_levels.back().m_key) {
+        throw std::runtime_error ("CBOR map key without a value");
+    }
+
+    close (map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::key (std::string_view key_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != object_t) {
+        throw std::runtime_error ("CBOR key outside of an object");
+    }
+
+    if (!reference (text_m, key_)) {
+        head (text_m, key_.size());
+        put (key_);
+    }
+
+    level.m_context = value_t;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::key (const Key & key_) {
+    if (key_.m_cbor.empty() || m_stringrefs) {
+        key (key_.m_name);
+        return;
+    }
+
+    auto & level = m_levels.back();
+
+    if (level.m_context != object_t) {
+        throw std::runtime_error ("CBOR key outside of an object");
+    }
+
+    put (key_.m_cbor);
+
+    level.m_context = value_t;
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::sink::
+CborSink::render (std::string_view key_) {
+    char bytes[9];
+
+    std::string rtn { bytes, ::head (text_m, key_.size(), bytes) };
+    rtn.append (key_);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::null() {
+    before();
+    put (NIL);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::boolean (bool value_) {
+    before();
+    put (value_ ? TRUE : FALSE);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::integer (int64_t value_) {
+    before();
+    encode (value_);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::real (double value_) {
+    before();
+    encode (value_);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::string (std::string_view value_) {
+    before();
+
+    if (!reference (text_m, value_)) {
+        head (text_m, value_.size());
+        put (value_);
+    }
+
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::symbol (std::string_view value_) {
+    string (value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::binary (std::string_view value_) {
+    before();
+
+    if (!reference (bytes_m, value_)) {
+        head (bytes_m, value_.size());
+        put (value_);
+    }
+
+    after();
+}
+
+/******************************************************************************/
+
+/**
+ * A run is only ever written to a list, where values need nothing doing
+ * between them
+ */
+void
+amqp::internal::sink::
+CborSink::integers (const int64_t * values_, size_t n_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != list_t) {
+        ISink::integers (values_, n_);
+        return;
+    }
+
+    for (size_t i { 0 } ; i < n_ ; ++i) encode (values_[i]);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CborSink::reals (const double * values_, size_t n_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != list_t) {
+        ISink::reals (values_, n_);
+        return;
+    }
+
+    for (size_t i { 0 } ; i < n_ ; ++i) encode (values_[i]);
+}
+
+/******************************************************************************/
@@ -0,0 +1,160 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+#include <string_view>
+
+#include "amqp/reader/ISink.h"
+
+#include "Dictionary.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::sink::CborSink
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::sink {
+
+    /**
+     * Renders the token stream as CBOR, RFC 8949, into a fixed size buffer
+     * flushed to a file descriptor, an ostream or the end of a string
+     * whenever it fills, exactly as [JsonSink] does.
+     *
+     * Integers are written in the fewest bytes that hold them, reals as
+     * single precision floats where that loses nothing and doubles where
+     * it would, and binaries as byte strings, so nothing needs parsing on
+     * the way back in. Symbols are text. Since no sizes are known until a
+     * compound ends, objects, lists and maps are all of indefinite length.
+     * Objects are maps keyed by text and maps keep whatever keys they
+     * were given, compound or not.
+     *
+     * Multiple top level values are simply concatenated, a CBOR sequence
+     * as RFC 8742 has it.
+     *
+     * With [stringrefs] each top level value is a stringref namespace,
+     * tag 256, any string, key or byte string within it that's already
+     * been written being written again as tag 25 and its number in a
+     * [Dictionary] of those that were, as the stringref extension has it.
+     * Strings too short to gain by it are never numbered.
+     */
+    class CborSink : public amqp::reader::ISink {
+        private :
+            /**
+             * An object is [value_t] between a key and its value
+             */
+            enum Context { top_t, object_t, value_t, list_t, map_t };
+
+            struct Level {
+                Context m_context;
+
+                /**
+                 * Within a map, whether the next value is a key
+                 */
+                bool m_key;
+            };
+
+            std::vector<Level> m_levels;
+
+            std::ostream * m_stream;
+            std::string * m_string;
+            int m_fd;
+
+            size_t m_capacity;
+
+            /**
+             * Output to a string is written straight into it, everything
+             * else into a buffer of our own before being flushed
+             */
+            std::string m_own;
+            std::string & m_buffer;
+
+            bool m_stringrefs;
+            Dictionary m_strings;
+
+            void put (char c_) {
+                m_buffer.push_back (c_);
+                if (m_buffer.size() >= m_capacity) flush();
+            }
+
+            void put (std::string_view);
+
+            /**
+             * The initial byte, and any argument following it, of an item
+             * of [major_] type
+             */
+            void head (uint8_t major_, uint64_t argument_);
+
+            void encode (int64_t);
+            void encode (double);
+
+            /**
+             * Writes a reference to [value_] should it have been written
+             * before, numbering it otherwise if it's long enough to be
+             * worth it, returning whether it was referenced
+             */
+            bool reference (uint8_t major_, std::string_view value_);
+
+            void before();
+            void after();
+
+            void open (uint8_t, Context);
+            void close (Context);
+
+        public :
+            static constexpr size_t DEFAULT_BUFFER = 64 * 1024;
+
+            explicit CborSink (std::ostream &, size_t capacity_ = DEFAULT_BUFFER);
+            explicit CborSink (int, size_t capacity_ = DEFAULT_BUFFER);
+
+            /**
+             * Appends straight to [out_], nothing being buffered
+             */
+            explicit CborSink (std::string & out_, size_t capacity_ = DEFAULT_BUFFER);
+
+            CborSink (const CborSink &) = delete;
+
+            ~CborSink() override;
+
+            void flush();
+
+            /**
+             * Whether repeated strings are written as references, see
+             * above, from the next top level value on
+             */
+            void stringrefs (bool stringrefs_) { m_stringrefs = stringrefs_; }
+
+            void beginObject() override;
+            void endObject() override;
+            void beginList() override;
+            void endList() override;
+            void beginMap() override;
+            void endMap() override;
+
+            void key (std::string_view) override;
+            void key (const Key &) override;
+
+            /**
+             * [key_] as [Key::m_cbor], ready to be copied out by [key]
+             */
+            static std::string render (std::string_view key_);
+
+            void null() override;
+            void boolean (bool) override;
+            void integer (int64_t) override;
+            void real (double) override;
+            void string (std::string_view) override;
+
+            void integers (const int64_t *, size_t) override;
+            void reals (const double *, size_t) override;
+            void symbol (std::string_view) override;
+            void binary (std::string_view) override;
+    };
+
+}
+
+/******************************************************************************/
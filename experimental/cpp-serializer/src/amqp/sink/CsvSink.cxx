@@ -0,0 +1,310 @@
+#include "CsvSink.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "JsonSink.h"
+
+#include "format/Json.h"
+#include "format/Number.h"
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Compound values of a column are small enough not to be worth the
+     * usual buffer
+     */
+    constexpr size_t NESTED_BUFFER = 1024;
+
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CsvSink::CsvSink (
+    std::string & out_,
+    const std::vector<std::string> & columns_
+) : m_out (out_)
+  , m_cells (columns_.size())
+  , m_captured (0)
+  , m_depth (0)
+{
+    for (size_t i { 0 } ; i < columns_.size() ; ++i) {
+        m_columns.emplace (columns_[i], i);
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+CsvSink::~CsvSink() = default;
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::cell (std::string & out_, std::string_view value_) {
+    if (value_.find_first_of (",\"\r\n") == std::string_view::npos) {
+        out_.append (value_);
+        return;
+    }
+
+    out_.push_back ('"');
+    for (auto c : value_) {
+        if (c == '"') out_.push_back ('"');
+        out_.push_back (c);
+    }
+    out_.push_back ('"');
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::row (std::string & out_, const std::vector<std::string> & cells_) {
+    for (size_t i { 0 } ; i < cells_.size() ; ++i) {
+        if (i) out_.push_back (',');
+        cell (out_, cells_[i]);
+    }
+
+    out_.push_back ('\n');
+}
+
+/******************************************************************************/
+
+long
+amqp::internal::sink::
+CsvSink::column() {
+    // only values reached through nothing but objects have a path
+    if (m_levels.empty() || m_keys.size() != m_levels.size()) return -1;
+
+    m_path.clear();
+    for (const auto & key : m_keys) {
+        if (!m_path.empty()) m_path.push_back ('.');
+        m_path.append (key);
+    }
+
+    auto it = m_columns.find (m_path);
+
+    return it == m_columns.end() ? -1 : static_cast<long> (it->second);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::scalar (std::string_view value_) {
+    auto c = column();
+    if (c >= 0) m_cells[c].assign (value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::open (Context context_) {
+    bool path = m_keys.size() == m_levels.size();
+
+    if (!m_json) {
+        auto c = column();
+
+        if (c >= 0) {
+            m_nested.clear();
+            m_json = std::make_unique<JsonSink> (m_nested, NESTED_BUFFER);
+            m_captured = static_cast<size_t> (c);
+            m_depth = m_levels.size();
+        }
+    }
+
+    if (m_json) {
+        switch (context_) {
+            case object_t : m_json->beginObject(); break;
+            case list_t   : m_json->beginList(); break;
+            case map_t    : m_json->beginMap(); break;
+        }
+    }
+
+    m_levels.push_back (context_);
+
+    if (path && context_ == object_t && !m_json) m_keys.emplace_back();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::close (Context context_) {
+    if (m_levels.empty() || m_levels.back() != context_) {
+        throw std::runtime_error ("Mismatched end of CSV row");
+    }
+
+    m_levels.pop_back();
+    if (m_keys.size() > m_levels.size()) m_keys.pop_back();
+
+    if (m_json) {
+        switch (context_) {
+            case object_t : m_json->endObject(); break;
+            case list_t   : m_json->endList(); break;
+            case map_t    : m_json->endMap(); break;
+        }
+
+        if (m_levels.size() == m_depth) {
+            m_json.reset();
+            m_cells[m_captured].assign (m_nested);
+        }
+    }
+
+    if (m_levels.empty()) {
+        row (m_out, m_cells);
+        for (auto & cell : m_cells) cell.clear();
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::beginObject() {
+    open (object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::endObject() {
+    close (object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::beginList() {
+    open (list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::endList() {
+    close (list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::beginMap() {
+    open (map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::endMap() {
+    close (map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::key (std::string_view key_) {
+    if (m_json) {
+        m_json->key (key_);
+    } else if (!m_keys.empty() && m_keys.size() == m_levels.size()) {
+        m_keys.back().assign (key_);
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::null() {
+    if (m_json) m_json->null();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::boolean (bool value_) {
+    if (m_json) {
+        m_json->boolean (value_);
+    } else {
+        scalar (value_ ? "true" : "false");
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::integer (int64_t value_) {
+    if (m_json) {
+        m_json->integer (value_);
+    } else {
+        scalar (format::Number (value_));
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::real (double value_) {
+    if (m_json) {
+        m_json->real (value_);
+    } else if (std::isfinite (value_)) {
+        scalar (format::Number (value_));
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::string (std::string_view value_) {
+    if (m_json) {
+        m_json->string (value_);
+    } else {
+        scalar (value_);
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::symbol (std::string_view value_) {
+    if (m_json) {
+        m_json->symbol (value_);
+    } else {
+        scalar (value_);
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+CsvSink::binary (std::string_view value_) {
+    if (m_json) {
+        m_json->binary (value_);
+        return;
+    }
+
+    auto c = column();
+    if (c < 0) return;
+
+    m_cells[c].clear();
+    format::base64 (value_, [this, c](std::string_view run_) { m_cells[c].append (run_); });
+}
+
+/******************************************************************************/
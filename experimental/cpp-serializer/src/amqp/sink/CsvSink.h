@@ -0,0 +1,105 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::sink::CsvSink
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::sink {
+
+    class JsonSink;
+
+    /**
+     * Flattens each top level object of the token stream into one RFC 4180
+     * row, appended to a string. Every column is a dotted path of keys
+     * from that object, "Parsed.amount.quantity" say: a scalar found there
+     * is written as is, strings unquoted unless they need it, and an
+     * object, list or map as compact JSON. Anything at no column's path is
+     * ignored and a column nothing was found at is left empty, as are
+     * nulls.
+     *
+     * A row's cells are only held until the object ends, nothing of one
+     * row being kept for the next but the capacity of its buffers.
+     */
+    class CsvSink : public amqp::reader::ISink {
+        private :
+            enum Context { object_t, list_t, map_t };
+
+            std::string & m_out;
+
+            std::unordered_map<std::string, size_t> m_columns;
+            std::vector<std::string> m_cells;
+
+            std::vector<Context> m_levels;
+
+            /**
+             * The keys leading to the current value, one per enclosing
+             * object that has only had objects above it
+             */
+            std::vector<std::string> m_keys;
+            std::string m_path;
+
+            /**
+             * Renders the compound value of a column, [m_captured]
+             * being where it's going and [m_depth] how deep it started
+             */
+            std::unique_ptr<JsonSink> m_json;
+            std::string m_nested;
+            size_t m_captured;
+            size_t m_depth;
+
+            /**
+             * The column the next value belongs in, -1 if none
+             */
+            long column();
+
+            void scalar (std::string_view);
+            void open (Context);
+            void close (Context);
+
+        public :
+            CsvSink (std::string & out_, const std::vector<std::string> & columns_);
+
+            CsvSink (const CsvSink &) = delete;
+
+            ~CsvSink() override;
+
+            /**
+             * Append [cells_] to [out_] as a row, quoting where needed
+             */
+            static void row (std::string & out_, const std::vector<std::string> & cells_);
+
+            static void cell (std::string & out_, std::string_view);
+
+            void beginObject() override;
+            void endObject() override;
+            void beginList() override;
+            void endList() override;
+            void beginMap() override;
+            void endMap() override;
+
+            void key (std::string_view) override;
+
+            void null() override;
+            void boolean (bool) override;
+            void integer (int64_t) override;
+            void real (double) override;
+            void string (std::string_view) override;
+            void symbol (std::string_view) override;
+            void binary (std::string_view) override;
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,88 @@
+#include "Dictionary.h"
+
+#include <stdexcept>
+
+/******************************************************************************
+ *
+ * amqp::internal::sink::Dictionary
+ *
+ ******************************************************************************/
+
+amqp::internal::cursor::Hash
+amqp::internal::sink::
+Dictionary::hash (std::string_view value_, uint8_t kind_) {
+    return cursor::Hasher (kind_).update (value_).digest();
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::sink::
+Dictionary::matches (const Entry & entry_, std::string_view value_, uint8_t kind_) const {
+    return entry_.m_kind == kind_
+        && entry_.m_size == value_.size()
+        && m_pool.compare (entry_.m_offset, entry_.m_size, value_) == 0;
+}
+
+/******************************************************************************/
+
+uint32_t
+amqp::internal::sink::
+Dictionary::find (std::string_view value_, uint8_t kind_) const {
+    auto it = m_index.find (hash (value_, kind_));
+
+    if (it == m_index.end() || !matches (m_entries[it->second], value_, kind_)) return npos;
+
+    return it->second;
+}
+
+/******************************************************************************/
+
+/**
+ * Should another value share its hash it's added all the same, but only
+ * the first is ever found
+ */
+uint32_t
+amqp::internal::sink::
+Dictionary::add (std::string_view value_, uint8_t kind_) {
+    auto key = hash (value_, kind_);
+    auto it = m_index.find (key);
+
+    if (it != m_index.end() && matches (m_entries[it->second], value_, kind_)) return it->second;
+
+    if (m_entries.size() == npos || value_.size() > UINT32_MAX) {
+        throw std::runtime_error ("Too many strings for the dictionary");
+    }
+
+    auto rtn = static_cast<uint32_t> (m_entries.size());
+
+    m_entries.push_back ({ m_pool.size(), static_cast<uint32_t> (value_.size()), kind_ });
+    m_pool.append (value_);
+
+    if (it == m_index.end()) m_index.emplace (key, rtn);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::sink::
+Dictionary::bytes() const {
+    return sizeof (Dictionary)
+        + m_pool.capacity()
+        + m_entries.capacity() * sizeof (Entry)
+        + m_index.size() * (sizeof (cursor::Hash) + sizeof (uint32_t) + 2 * sizeof (void *));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+Dictionary::clear() {
+    m_pool.clear();
+    m_entries.clear();
+    m_index.clear();
+}
+
+/******************************************************************************/
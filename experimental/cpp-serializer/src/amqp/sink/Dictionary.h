@@ -0,0 +1,102 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::sink::Dictionary
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::sink {
+
+    /**
+     * The distinct string values met over a session, each stored once and
+     * numbered in the order it was first added, so a sink can write a
+     * value's number in place of any repeat of it. Currency codes, party
+     * names and class names repeat millions of times across a corpus and
+     * are held, and written, but once.
+     *
+     * Values are found by the [cursor::hash] of their bytes, the value
+     * itself being compared before its number's given out. Each is added
+     * with a kind, text or bytes say, values of different kinds never
+     * being taken for one another however alike their bytes.
+     *
+     * Every value lives in a single pool, so nothing is allocated per
+     * value beyond its entry.
+     */
+    class Dictionary {
+        public :
+            static constexpr uint32_t npos = UINT32_MAX;
+
+        private :
+            struct Entry {
+                uint64_t m_offset;
+                uint32_t m_size;
+                uint8_t m_kind;
+            };
+
+            struct Hashed {
+                size_t operator() (const cursor::Hash & hash_) const {
+                    return static_cast<size_t> (hash_.m_low);
+                }
+            };
+
+            std::string m_pool;
+            std::vector<Entry> m_entries;
+
+            std::unordered_map<cursor::Hash, uint32_t, Hashed> m_index;
+
+            static cursor::Hash hash (std::string_view, uint8_t kind_);
+
+            bool matches (const Entry &, std::string_view, uint8_t kind_) const;
+
+        public :
+            Dictionary() = default;
+
+            Dictionary (const Dictionary &) = delete;
+
+            /**
+             * [value_]'s number, [npos] if it's not been added
+             */
+            uint32_t find (std::string_view value_, uint8_t kind_ = 0) const;
+
+            /**
+             * [value_]'s number, adding it as the next should it not have
+             * been already
+             */
+            uint32_t add (std::string_view value_, uint8_t kind_ = 0);
+
+            std::string_view operator[] (uint32_t i_) const {
+                return { m_pool.data() + m_entries[i_].m_offset, m_entries[i_].m_size };
+            }
+
+            uint8_t kind (uint32_t i_) const { return m_entries[i_].m_kind; }
+
+            size_t size() const { return m_entries.size(); }
+            bool empty() const { return m_entries.empty(); }
+
+            /**
+             * What it holds, pool, entries and index
+             */
+            size_t bytes() const;
+
+            /**
+             * Forget every value, keeping the capacity to hold as many
+             * again
+             */
+            void clear();
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,427 @@
+#include "JsonSink.h"
+
+#include <cmath>
+#include <cerrno>
+#include <ostream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "format/Json.h"
+#include "format/Number.h"
+
+/******************************************************************************/
+
+amqp::internal::sink::
+JsonSink::JsonSink (std::ostream & stream_, size_t capacity_)
+    : m_stream (&stream_)
+    , m_string (nullptr)
+    , m_fd (-1)
+    , m_capacity (capacity_ ? capacity_ : 1)
+    , m_buffer (m_own)
+{
+    m_levels.push_back ({ top_t, true });
+    m_buffer.reserve (m_capacity);
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+JsonSink::JsonSink (int fd_, size_t capacity_)
+    : m_stream (nullptr)
+    , m_string (nullptr)
+    , m_fd (fd_)
+    , m_capacity (capacity_ ? capacity_ : 1)
+    , m_buffer (m_own)
+{
+    m_levels.push_back ({ top_t, true });
+    m_buffer.reserve (m_capacity);
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+JsonSink::JsonSink (std::string & out_, size_t)
+    : m_stream (nullptr)
+    , m_string (&out_)
+    , m_fd (-1)
+    , m_capacity (std::string::npos)
+    , m_buffer (out_)
+{
+    m_levels.push_back ({ top_t, true });
+}
+
+/******************************************************************************/
+
+amqp::internal::sink::
+JsonSink::~JsonSink() {
+    try {
+        flush();
+    } catch (...) {
+        // nothing sensible to do with a failed write on teardown
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::flush() {
+    // a string's already been written to
+    if (m_buffer.empty() || m_string) return;
+
+    if (m_stream) {
+        m_stream->write (m_buffer.data(), m_buffer.size());
+    } else {
+        const char * p = m_buffer.data();
+        size_t left    = m_buffer.size();
+
+        while (left) {
+            auto rtn = ::write (m_fd, p, left);
+            if (rtn < 0) {
+                if (errno == EINTR) continue;
+                m_buffer.clear();
+                throw std::runtime_error ("Failed writing JSON output");
+            }
+            p += rtn;
+            left -= rtn;
+        }
+    }
+
+    m_buffer.clear();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::put (std::string_view s_) {
+    if (m_buffer.size() + s_.size() > m_capacity) {
+        flush();
+
+        // too big to be worth buffering
+        if (s_.size() >= m_capacity) {
+            m_buffer.assign (s_.begin(), s_.end());
+            flush();
+            return;
+        }
+    }
+
+    m_buffer.append (s_.begin(), s_.end());
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::quoted (std::string_view s_) {
+    put ('"');
+    format::escape (s_, [this](std::string_view run_) { put (run_); });
+    put ('"');
+}
+
+/******************************************************************************/
+
+/**
+ * JSON only allows strings as object keys so anything else being used as
+ * a map key needs quoting
+ */
+void
+amqp::internal::sink::
+JsonSink::scalar (std::string_view s_) {
+    before();
+    if (m_levels.back().m_context == mapKey_t) {
+        quoted (s_);
+    } else {
+        put (s_);
+    }
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::before() {
+    auto & level = m_levels.back();
+
+    switch (level.m_context) {
+        case top_t    : if (!level.m_first) put ('\n'); break;
+        case list_t   :
+        case mapKey_t : if (!level.m_first) put (','); break;
+        case object_t :
+        case mapValue_t : break;
+    }
+
+    level.m_first = false;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::after() {
+    auto & level = m_levels.back();
+
+    if (level.m_context == mapKey_t) {
+        put (':');
+        level.m_context = mapValue_t;
+    } else if (level.m_context == mapValue_t) {
+        level.m_context = mapKey_t;
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::open (char c_, Context context_) {
+    if (m_levels.back().m_context == mapKey_t) {
+        throw std::runtime_error ("JSON map keys must be scalar values");
+    }
+
+    before();
+    put (c_);
+    m_levels.push_back ( { context_, true } );
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::close (char c_, Context context_) {
+    if (m_levels.size() < 2 || m_levels.back().m_context != context_) {
+        throw std::runtime_error ("Mismatched end of JSON container");
+    }
+
+    m_levels.pop_back();
+    put (c_);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::beginObject() {
+    open ('{', object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::endObject() {
+    close ('}', object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::beginList() {
+    open ('[', list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::endList() {
+    close (']', list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::beginMap() {
+    open ('{', mapKey_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::endMap() {
+    if (m_levels.back().m_context == mapValue_t) {
+        throw std::runtime_error ("JSON map key without a value");
+    }
+
+    close ('}', mapKey_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::key (std::string_view key_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != object_t) {
+        throw std::runtime_error ("JSON key outside of an object");
+    }
+
+    if (!level.m_first) put (',');
+    level.m_first = false;
+
+    quoted (key_);
+    put (':');
+}
+
+/******************************************************************************/
+
+/**
+ * The comma's only dropped for an object's first key
+ */
+void
+amqp::internal::sink::
+JsonSink::key (const Key & key_) {
+    if (key_.m_json.empty()) {
+        key (key_.m_name);
+        return;
+    }
+
+    auto & level = m_levels.back();
+
+    if (level.m_context != object_t) {
+        throw std::runtime_error ("JSON key outside of an object");
+    }
+
+    put (level.m_first ? key_.m_json.substr (1) : key_.m_json);
+    level.m_first = false;
+}
+
+/******************************************************************************/
+
+std::string
+amqp::internal::sink::
+JsonSink::render (std::string_view key_) {
+    std::string rtn { ",\"" };
+    format::escape (key_, [&rtn](std::string_view run_) { rtn.append (run_); });
+    rtn.append ("\":");
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::null() {
+    scalar ("null");
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::boolean (bool value_) {
+    scalar (value_ ? "true" : "false");
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::integer (int64_t value_) {
+    scalar (format::Number (value_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::real (double value_) {
+    // JSON has no representation for these
+    if (!std::isfinite (value_)) {
+        scalar ("null");
+        return;
+    }
+
+    scalar (format::Number (value_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::string (std::string_view value_) {
+    before();
+    quoted (value_);
+    after();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::symbol (std::string_view value_) {
+    string (value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::binary (std::string_view value_) {
+    before();
+    put ('"');
+    format::base64 (value_, [this](std::string_view run_) { put (run_); });
+    put ('"');
+    after();
+}
+
+/******************************************************************************/
+
+/**
+ * Within a list, which is all a run is ever written to, each value needs
+ * nothing more than a separating comma so they're appended straight to
+ * the buffer without going through [before] and [after] each time
+ */
+void
+amqp::internal::sink::
+JsonSink::integers (const int64_t * values_, size_t n_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != list_t) {
+        ISink::integers (values_, n_);
+        return;
+    }
+
+    for (size_t i { 0 } ; i < n_ ; ++i) {
+        if (!level.m_first) m_buffer.push_back (',');
+        level.m_first = false;
+
+        m_buffer.append (format::Number (values_[i]).view());
+
+        if (m_buffer.size() >= m_capacity) flush();
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+JsonSink::reals (const double * values_, size_t n_) {
+    auto & level = m_levels.back();
+
+    if (level.m_context != list_t) {
+        ISink::reals (values_, n_);
+        return;
+    }
+
+    for (size_t i { 0 } ; i < n_ ; ++i) {
+        if (!level.m_first) m_buffer.push_back (',');
+        level.m_first = false;
+
+        if (std::isfinite (values_[i])) {
+            m_buffer.append (format::Number (values_[i]).view());
+        } else {
+            m_buffer.append ("null");
+        }
+
+        if (m_buffer.size() >= m_capacity) flush();
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,121 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <string_view>
+
+#include "amqp/reader/ISink.h"
+#include "amqp/cursor/Stack.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::sink::JsonSink
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::sink {
+
+    /**
+     * Renders the token stream as compact JSON into a fixed size buffer
+     * which is flushed to a file descriptor, an ostream or the end of a
+     * string whenever it fills, so the memory used is constant no matter how large the
+     * blob. The only state kept is the nesting of the current token.
+     *
+     * Maps are rendered as objects, their keys, which must be scalars,
+     * being quoted where necessary.
+     *
+     * Binaries are rendered as base64 strings.
+     *
+     * Multiple top level values are separated by new lines
+     */
+    class JsonSink : public amqp::reader::ISink {
+        private :
+            enum Context { top_t, object_t, list_t, mapKey_t, mapValue_t };
+
+            struct Level {
+                Context m_context;
+                bool    m_first;
+            };
+
+            cursor::Stack<Level, 32> m_levels;
+
+            std::ostream * m_stream;
+            std::string * m_string;
+            int m_fd;
+
+            size_t m_capacity;
+
+            /**
+             * Output to a string is written straight into it, everything
+             * else into a buffer of our own before being flushed
+             */
+            std::string m_own;
+            std::string & m_buffer;
+
+            void put (char c_) {
+                m_buffer.push_back (c_);
+                if (m_buffer.size() >= m_capacity) flush();
+            }
+
+            void put (std::string_view);
+
+            void quoted (std::string_view);
+            void scalar (std::string_view);
+
+            void before();
+            void after();
+
+            void open (char, Context);
+            void close (char, Context);
+
+        public :
+            static constexpr size_t DEFAULT_BUFFER = 64 * 1024;
+
+            explicit JsonSink (std::ostream &, size_t capacity_ = DEFAULT_BUFFER);
+            explicit JsonSink (int, size_t capacity_ = DEFAULT_BUFFER);
+
+            /**
+             * Appends straight to [out_], nothing being buffered, so its
+             * capacity can be reused from one document to the next
+             */
+            explicit JsonSink (std::string & out_, size_t capacity_ = DEFAULT_BUFFER);
+
+            JsonSink (const JsonSink &) = delete;
+
+            ~JsonSink() override;
+
+            void flush();
+
+            void beginObject() override;
+            void endObject() override;
+            void beginList() override;
+            void endList() override;
+            void beginMap() override;
+            void endMap() override;
+
+            void key (std::string_view) override;
+            void key (const Key &) override;
+
+            /**
+             * [key_] as [Key::m_json], ready to be copied out by [key]
+             */
+            static std::string render (std::string_view key_);
+
+            void null() override;
+            void boolean (bool) override;
+            void integer (int64_t) override;
+            void real (double) override;
+            void string (std::string_view) override;
+
+            void integers (const int64_t *, size_t) override;
+            void reals (const double *, size_t) override;
+            void symbol (std::string_view) override;
+            void binary (std::string_view) override;
+    };
+
+}
+
+/******************************************************************************/
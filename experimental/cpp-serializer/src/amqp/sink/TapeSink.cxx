@@ -0,0 +1,273 @@
+#include "TapeSink.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+
+/******************************************************************************/
+
+using Tape = amqp::internal::tape::Tape;
+
+/******************************************************************************/
+
+amqp::internal::sink::
+TapeSink::TapeSink (tape::Tape & tape_, bool hashes_)
+    : m_tape (tape_)
+    , m_hashes (hashes_)
+    , m_keyed (false)
+{
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::push (tape::Tape::Type type_, uint64_t payload_) {
+    m_keyed = false;
+
+    m_tape.m_words.push_back (
+            (static_cast<uint64_t>(type_) << Tape::TYPE_SHIFT)
+                | (payload_ & Tape::PAYLOAD));
+}
+
+/******************************************************************************/
+
+/*
+ * Every value bar a key counts towards the size of the compound it's in
+ */
+void
+amqp::internal::sink::
+TapeSink::value() {
+    if (!m_open.empty()) {
+        ++m_tape.m_words[m_open.back() + 1];
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::open (tape::Tape::Type type_) {
+    value();
+
+    m_open.push_back (m_tape.m_words.size());
+
+    push (type_);
+    m_tape.m_words.push_back (0);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::close (tape::Tape::Type type_) {
+    if (m_open.empty()
+        || (m_tape.m_words[m_open.back()] >> Tape::TYPE_SHIFT) != type_)
+    {
+        throw std::runtime_error ("TapeSink: mismatched end");
+    }
+
+    auto open = m_open.back();
+    m_open.pop_back();
+
+    m_tape.m_words[open] |= m_tape.m_words.size();
+    push (Tape::end_t, open);
+}
+
+/******************************************************************************/
+
+/*
+ * Text already in the blob is referred to in place, anything else, such
+ * as a field name owned by the schema, is copied aside. Keys are all but
+ * always the latter, and the same few over and over, as are the values
+ * decoded out of line, a char's UTF-8 or an enum's constant say, so each
+ * is only copied the first time
+ */
+void
+amqp::internal::sink::
+TapeSink::text (tape::Tape::Type type_, std::string_view text_) {
+    uint64_t offset;
+
+    if (text_.data() >= m_tape.m_blob
+        && text_.data() + text_.size() <= m_tape.m_blob + m_tape.m_size)
+    {
+        offset = static_cast<uint64_t>(text_.data() - m_tape.m_blob);
+    } else {
+        auto hash = std::hash<std::string_view>() (text_);
+        auto it = m_copied.find (hash);
+
+        if (it != m_copied.end()
+            && it->second <= m_tape.m_text.size()
+            && m_tape.m_text.compare (it->second, text_.size(), text_) == 0)
+        {
+            offset = m_tape.m_size + it->second;
+        } else {
+            // first seen, or another key with the same hash was
+            m_copied[hash] = m_tape.m_text.size();
+
+            offset = m_tape.m_size + m_tape.m_text.size();
+            m_tape.m_text.append (text_);
+        }
+    }
+
+    push (type_, offset);
+    m_tape.m_words.push_back (text_.size());
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::beginObject() {
+    open (Tape::object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::endObject() {
+    close (Tape::object_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::beginList() {
+    open (Tape::list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::endList() {
+    close (Tape::list_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::beginMap() {
+    open (Tape::map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::endMap() {
+    close (Tape::map_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::key (std::string_view key_) {
+    text (Tape::key_t, key_);
+
+    m_keyed = true;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::null() {
+    value();
+
+    auto & words = m_tape.m_words;
+
+    if (m_keyed) {
+        auto offset = words[words.size() - 2] & Tape::PAYLOAD;
+        auto length = words.back();
+
+        if (offset <= Tape::KEY_OFFSET && length <= (Tape::PAYLOAD >> Tape::KEY_SHIFT)) {
+            words.pop_back();
+            words.pop_back();
+
+            push (Tape::absent_t, (length << Tape::KEY_SHIFT) | offset);
+            return;
+        }
+    }
+
+    push (Tape::null_t);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::boolean (bool value_) {
+    value();
+    push (Tape::bool_t, value_ ? 1 : 0);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::integer (int64_t value_) {
+    value();
+    push (Tape::integer_t);
+    m_tape.m_words.push_back (static_cast<uint64_t>(value_));
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::real (double value_) {
+    uint64_t bits;
+    std::memcpy (&bits, &value_, sizeof (bits));
+
+    value();
+    push (Tape::real_t);
+    m_tape.m_words.push_back (bits);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::string (std::string_view value_) {
+    value();
+    text (Tape::string_t, value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::symbol (std::string_view value_) {
+    value();
+    text (Tape::symbol_t, value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::binary (std::string_view value_) {
+    value();
+    text (Tape::binary_t, value_);
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::sink::
+TapeSink::hash (uint64_t low_, uint64_t high_) {
+    if (m_open.empty()
+        || (m_tape.m_words[m_open.back()] >> Tape::TYPE_SHIFT) != Tape::object_t)
+    {
+        throw std::runtime_error ("TapeSink: hash outside an object");
+    }
+
+    m_tape.m_hashes[m_open.back()] = { low_, high_ };
+}
+
+/******************************************************************************/
@@ -0,0 +1,85 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "amqp/reader/ISink.h"
+#include "tape/Tape.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::sink::TapeSink
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::sink {
+
+    /**
+     * Records the token stream onto a [tape::Tape]. The only state kept
+     * beyond the tape itself is where each open compound started so its
+     * end can be patched in once reached, whether the last token was a
+     * key, so a null following it can be folded in as an absent, and
+     * where each key or value that had to be copied was, so it's copied
+     * but once however many objects it's a field of.
+     */
+    class TapeSink : public amqp::reader::ISink {
+        private :
+            tape::Tape & m_tape;
+
+            std::vector<size_t> m_open;
+
+            bool m_hashes;
+
+            bool m_keyed;
+
+            /**
+             * Where in the tape's copied text each key or value is, keyed
+             * on its hash, the text being compared before it's reused
+             */
+            std::unordered_map<size_t, uint64_t> m_copied;
+
+            void push (tape::Tape::Type, uint64_t payload_ = 0);
+            void value();
+
+            void open (tape::Tape::Type);
+            void close (tape::Tape::Type);
+
+            void text (tape::Tape::Type, std::string_view);
+
+        public :
+            /**
+             * With [hashes_] the structural hash of every composite is
+             * recorded alongside its object
+             */
+            explicit TapeSink (tape::Tape &, bool hashes_ = false);
+
+            TapeSink (const TapeSink &) = delete;
+
+            void beginObject() override;
+            void endObject() override;
+            void beginList() override;
+            void endList() override;
+            void beginMap() override;
+            void endMap() override;
+
+            void key (std::string_view) override;
+
+            void null() override;
+            void boolean (bool) override;
+            void integer (int64_t) override;
+            void real (double) override;
+            void string (std::string_view) override;
+            void symbol (std::string_view) override;
+            void binary (std::string_view) override;
+
+            bool hashes() const override { return m_hashes; }
+            void hash (uint64_t low_, uint64_t high_) override;
+    };
+
+}
+
+/******************************************************************************/
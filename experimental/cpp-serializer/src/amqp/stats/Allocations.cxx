@@ -0,0 +1,14 @@
+#include "Allocations.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Allocations
+ *
+ ******************************************************************************/
+
+bool amqp::internal::stats::Allocations::s_hooked { false };
+
+thread_local amqp::internal::stats::Allocations::Counts
+amqp::internal::stats::Allocations::t_counts { };
+
+/******************************************************************************/
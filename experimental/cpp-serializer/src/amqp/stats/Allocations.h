@@ -0,0 +1,108 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+/******************************************************************************
+ *
+ * class amqp::internal::stats::Allocations
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::stats {
+
+    /**
+     * A count of the calling thread's heap allocations, and how many
+     * bytes they came to, kept by the replacement operator new and delete
+     * of CountingNew.cxx. Nothing links those in but the tests and the
+     * benchmarks, everywhere else [hooked] is false and every count zero.
+     */
+    class Allocations {
+        private :
+            struct Counts {
+                uint64_t m_allocations;
+                uint64_t m_bytes;
+                uint64_t m_live;
+                uint64_t m_peak;
+            };
+
+            static bool s_hooked;
+
+            static thread_local Counts t_counts;
+
+        public :
+            class Scope;
+
+            /**
+             * Whether operator new has been replaced
+             */
+            static bool hooked() { return s_hooked; }
+            static void hook() { s_hooked = true; }
+
+            static void allocated (size_t size_) noexcept {
+                auto & counts = t_counts;
+
+                ++counts.m_allocations;
+                counts.m_bytes += size_;
+                counts.m_live += size_;
+
+                if (counts.m_live > counts.m_peak) counts.m_peak = counts.m_live;
+            }
+
+            /**
+             * Memory freed by another thread than allocated it can take
+             * the live total of this one below zero, which is clamped
+             */
+            static void freed (size_t size_) noexcept {
+                auto & counts = t_counts;
+                counts.m_live = counts.m_live > size_ ? counts.m_live - size_ : 0;
+            }
+    };
+
+    /**
+     * Allocations made by this thread since the scope began. The peak is
+     * how many more bytes than at the start were live, at most, along the
+     * way
+     */
+    class Allocations::Scope {
+        private :
+            Counts m_start;
+
+        public :
+            Scope() : m_start (t_counts) {
+                t_counts.m_peak = t_counts.m_live;
+            }
+
+            Scope (const Scope &) = delete;
+
+            uint64_t allocations() const {
+                return t_counts.m_allocations - m_start.m_allocations;
+            }
+
+            uint64_t bytes() const {
+                return t_counts.m_bytes - m_start.m_bytes;
+            }
+
+            uint64_t peak() const {
+                return t_counts.m_peak - m_start.m_live;
+            }
+
+            /**
+             * How many more bytes are live now than at the start, what's
+             * been allocated and kept
+             */
+            uint64_t live() const {
+                return t_counts.m_live > m_start.m_live ? t_counts.m_live - m_start.m_live : 0;
+            }
+
+            ~Scope() {
+                // so an enclosing scope's peak still covers this one's
+                if (m_start.m_peak > t_counts.m_peak) t_counts.m_peak = m_start.m_peak;
+            }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,236 @@
+#include "Costs.h"
+
+#include <map>
+#include <algorithm>
+
+#include "amqp/reader/ISink.h"
+#include "cursor/Cursor.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Costs
+ *
+ ******************************************************************************/
+
+bool amqp::internal::stats::Costs::s_enabled { false };
+
+/******************************************************************************/
+
+amqp::internal::stats::Costs &
+amqp::internal::stats::
+Costs::instance() {
+    static Costs costs;
+    return costs;
+}
+
+/******************************************************************************/
+
+/**
+ * Owned by the instance, as [Stats]'s are, to outlive the threads
+ */
+amqp::internal::stats::Costs::Block &
+amqp::internal::stats::
+Costs::local() {
+    static thread_local Block * block { nullptr };
+
+    if (!block) {
+        auto & costs = instance();
+
+        std::lock_guard<std::mutex> guard (costs.m_lock);
+
+        block = costs.m_blocks.emplace_back (std::make_unique<Block>()).get();
+    }
+
+    return *block;
+}
+
+/******************************************************************************/
+
+/**
+ * A type's entry stays where it is however many are added after it, so
+ * a scope can hold on to it
+ */
+amqp::internal::stats::Costs::Cost &
+amqp::internal::stats::
+Costs::cost (Table table_, std::string_view type_) {
+    auto & block = local();
+    auto & costs = block.m_costs[table_];
+
+    auto it = costs.find (type_);
+
+    if (it != costs.end()) return it->second;
+
+    const auto & name = block.m_names.emplace_back (type_);
+
+    return costs.emplace (name, Cost { }).first->second;
+}
+
+/******************************************************************************/
+
+std::vector<amqp::internal::stats::Costs::Entry>
+amqp::internal::stats::
+Costs::top (Table table_, size_t top_) const {
+    std::map<std::string_view, Cost> summed;
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    for (const auto & block : m_blocks) {
+        for (const auto & [ type, cost ] : block->m_costs[table_]) {
+            auto & sum = summed[type];
+
+            sum.m_count += cost.m_count;
+            sum.m_nanos += cost.m_nanos;
+            sum.m_self += cost.m_self;
+            sum.m_bytes += cost.m_bytes;
+            sum.m_allocations += cost.m_allocations;
+            sum.m_allocated += cost.m_allocated;
+        }
+    }
+
+    std::vector<Entry> rtn;
+    rtn.reserve (summed.size());
+
+    for (const auto & [ type, cost ] : summed) {
+        if (cost.m_count) rtn.push_back ({ std::string (type), cost });
+    }
+
+    // stable, so types that cost the same stay in the order of their names
+    std::stable_sort (rtn.begin(), rtn.end(), [](const Entry & lhs_, const Entry & rhs_) {
+        return lhs_.m_cost.m_nanos > rhs_.m_cost.m_nanos;
+    });
+
+    if (top_ && rtn.size() > top_) rtn.resize (top_);
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Costs::write (amqp::reader::ISink & sink_, size_t top_) const {
+    static const char * const tables[] = { "roots", "composites" };
+
+    const bool allocations = Allocations::hooked();
+
+    sink_.beginObject();
+
+    for (int i { 0 } ; i < tables_t ; ++i) {
+        sink_.key (tables[i]);
+        sink_.beginList();
+
+        for (const auto & entry : top (static_cast<Table> (i), top_)) {
+            const auto & cost = entry.m_cost;
+
+            sink_.beginObject();
+            sink_.key ("type");
+            sink_.string (entry.m_type);
+            sink_.key ("count");
+            sink_.integer (static_cast<int64_t> (cost.m_count));
+            sink_.key ("seconds");
+            sink_.real (static_cast<double> (cost.m_nanos) / 1e9);
+
+            if (i == composites_t) {
+                sink_.key ("self");
+                sink_.real (static_cast<double> (cost.m_self) / 1e9);
+            }
+
+            sink_.key ("bytes");
+            sink_.integer (static_cast<int64_t> (cost.m_bytes));
+
+            if (allocations) {
+                sink_.key ("allocations");
+                sink_.integer (static_cast<int64_t> (cost.m_allocations));
+                sink_.key ("allocated");
+                sink_.integer (static_cast<int64_t> (cost.m_allocated));
+            }
+
+            sink_.endObject();
+        }
+
+        sink_.endList();
+    }
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+/**
+ * The tables are emptied rather than their blocks dropped, the names
+ * being kept for the costs of the same types again
+ */
+void
+amqp::internal::stats::
+Costs::clear() {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    for (auto & block : m_blocks) {
+        for (auto & costs : block->m_costs) {
+            for (auto & entry : costs) entry.second = Cost { };
+        }
+    }
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Costs::Scope
+ *
+ ******************************************************************************/
+
+thread_local amqp::internal::stats::Costs::Scope *
+amqp::internal::stats::Costs::Scope::t_current { nullptr };
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Costs::Scope::start() {
+    if (Allocations::hooked()) m_allocations.emplace();
+
+    m_start = Clock::now();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Costs::Scope::start (std::string_view type_, const cursor::Cursor & data_) {
+    m_bytes = data_.encodedSize();
+    m_cost = &cost (m_table, type_);
+
+    m_parent = t_current;
+    t_current = this;
+
+    start();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Costs::Scope::stop() {
+    auto elapsed = static_cast<uint64_t> (
+            std::chrono::duration_cast<std::chrono::nanoseconds> (
+                    Clock::now() - m_start).count());
+
+    if (m_table == composites_t) {
+        if (m_parent) m_parent->m_nested += elapsed;
+        t_current = m_parent;
+    }
+
+    // a blob that failed before its type was known is charged to none
+    if (!m_cost) return;
+
+    ++m_cost->m_count;
+    m_cost->m_nanos += elapsed;
+    m_cost->m_self += elapsed - std::min (elapsed, m_nested);
+    m_cost->m_bytes += m_bytes;
+
+    if (m_allocations) {
+        m_cost->m_allocations += m_allocations->allocations();
+        m_cost->m_allocated += m_allocations->bytes();
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,194 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "Allocations.h"
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::cursor {
+
+    class Cursor;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::stats::Costs
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::stats {
+
+    /**
+     * What decoding each type has cost, summed over every blob and every
+     * thread in the process, so the types, and the CorDapps whose states
+     * they are, most worth compiling, warming or asking their authors
+     * about can be told apart. Like [Stats] nothing is recorded until
+     * [enable] is called, each thread counts into a block of its own and
+     * a report must wait until the counting threads are done.
+     *
+     * Blobs are charged to their outermost type, from peeking at the
+     * envelope to the last of the payload, and every composite decoded,
+     * outermost or nested, to its own. A composite's time includes that
+     * of the composites within it, its self time doesn't. Its bytes are
+     * those of its encoding and its allocations, counted only where
+     * operator new has been replaced, see [Allocations], those made
+     * decoding it and whatever it holds.
+     */
+    class Costs {
+        public :
+            enum Table {
+                roots_t,
+                composites_t,
+                tables_t
+            };
+
+            struct Cost {
+                uint64_t m_count;
+                uint64_t m_nanos;
+                uint64_t m_self;
+                uint64_t m_bytes;
+                uint64_t m_allocations;
+                uint64_t m_allocated;
+            };
+
+            struct Entry {
+                std::string m_type;
+                Cost m_cost;
+            };
+
+            class Scope;
+
+        private :
+            struct Block {
+                /**
+                 * Every type named, keying the tables without a copy of
+                 * its name having to be made to look it up
+                 */
+                std::deque<std::string> m_names;
+                std::unordered_map<std::string_view, Cost> m_costs[tables_t];
+            };
+
+            static bool s_enabled;
+
+            mutable std::mutex m_lock;
+            std::vector<std::unique_ptr<Block>> m_blocks;
+
+            static Block & local();
+
+            static Cost & cost (Table, std::string_view type_);
+
+        public :
+            static Costs & instance();
+
+            static void enable (bool enabled_ = true) { s_enabled = enabled_; }
+            static bool enabled() { return s_enabled; }
+
+            /**
+             * The [top_] most costly types of [table_], by their time,
+             * every one of them given zero
+             */
+            std::vector<Entry> top (Table table_, size_t top_ = 0) const;
+
+            /**
+             * The [top_] most costly roots and composites as a JSON object
+             * of two lists, allocations only being given where they were
+             * counted
+             */
+            void write (amqp::reader::ISink &, size_t top_) const;
+
+            void clear();
+    };
+
+    /**
+     * Charges its own scope to a type of one of the tables
+     */
+    class Costs::Scope {
+        private :
+            using Clock = std::chrono::steady_clock;
+
+            bool m_active;
+            Table m_table;
+
+            Cost * m_cost;
+            uint64_t m_bytes;
+
+            Clock::time_point m_start;
+            std::optional<Allocations::Scope> m_allocations;
+
+            Scope * m_parent;
+
+            /**
+             * Time spent in composites nested within this one
+             */
+            uint64_t m_nested;
+
+            static thread_local Scope * t_current;
+
+            void start();
+            void start (std::string_view type_, const cursor::Cursor &);
+            void stop();
+
+        public :
+            /**
+             * A composite's cost, the cursor being on its encoding
+             */
+            Scope (std::string_view type_, const cursor::Cursor & data_)
+                : m_active (Costs::enabled())
+                , m_table (composites_t)
+                , m_cost (nullptr)
+                , m_bytes (0)
+                , m_parent (nullptr)
+                , m_nested (0)
+            {
+                if (m_active) start (type_, data_);
+            }
+
+            /**
+             * A blob's cost, charged to whichever root [type] is given
+             * once it's known, the blob being [bytes_] long
+             */
+            explicit Scope (size_t bytes_)
+                : m_active (Costs::enabled())
+                , m_table (roots_t)
+                , m_cost (nullptr)
+                , m_bytes (bytes_)
+                , m_parent (nullptr)
+                , m_nested (0)
+            {
+                if (m_active) start();
+            }
+
+            Scope (const Scope &) = delete;
+
+            ~Scope() {
+                if (m_active) stop();
+            }
+
+            void type (std::string_view type_) {
+                if (m_active) m_cost = &cost (m_table, type_);
+            }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,144 @@
+#include "Allocations.h"
+
+#include <new>
+#include <cstdlib>
+
+/******************************************************************************
+ *
+ * Replacement global operator new and delete counting every allocation
+ * into Allocations. Linked, via the amqp-counting-new object library,
+ * into the tests and benchmarks only.
+ *
+ * Each block is prefixed by a header holding its size, since unsized
+ * deletes have to know it too, padded to the block's alignment so what's
+ * handed back stays aligned.
+ *
+ ******************************************************************************/
+
+namespace {
+
+    using amqp::internal::stats::Allocations;
+
+    const bool hooked = (Allocations::hook(), true);
+
+    void *
+    allocate (size_t size_, size_t align_) noexcept {
+        if (align_ < alignof (std::max_align_t)) align_ = alignof (std::max_align_t);
+
+        // aligned_alloc wants a multiple of the alignment
+        auto total = (align_ + size_ + align_ - 1) / align_ * align_;
+
+        auto * block = static_cast<char *> (
+                align_ == alignof (std::max_align_t)
+                    ? std::malloc (total)
+                    : std::aligned_alloc (align_, total));
+
+        if (!block) return nullptr;
+
+        *reinterpret_cast<size_t *> (block + align_ - sizeof (size_t)) = size_;
+
+        Allocations::allocated (size_);
+
+        return block + align_;
+    }
+
+    void
+    release (void * ptr_, size_t align_) noexcept {
+        if (!ptr_) return;
+
+        if (align_ < alignof (std::max_align_t)) align_ = alignof (std::max_align_t);
+
+        auto * block = static_cast<char *> (ptr_) - align_;
+
+        Allocations::freed (*reinterpret_cast<size_t *> (block + align_ - sizeof (size_t)));
+
+        std::free (block);
+    }
+
+    void *
+    allocateOrThrow (size_t size_, size_t align_) {
+        for (;;) {
+            if (auto * rtn = allocate (size_, align_)) return rtn;
+
+            auto handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+void * operator new (size_t size_) {
+    return allocateOrThrow (size_, 0);
+}
+
+void * operator new[] (size_t size_) {
+    return allocateOrThrow (size_, 0);
+}
+
+void * operator new (size_t size_, const std::nothrow_t &) noexcept {
+    return allocate (size_, 0);
+}
+
+void * operator new[] (size_t size_, const std::nothrow_t &) noexcept {
+    return allocate (size_, 0);
+}
+
+void * operator new (size_t size_, std::align_val_t align_) {
+    return allocateOrThrow (size_, static_cast<size_t> (align_));
+}
+
+void * operator new[] (size_t size_, std::align_val_t align_) {
+    return allocateOrThrow (size_, static_cast<size_t> (align_));
+}
+
+void * operator new (size_t size_, std::align_val_t align_, const std::nothrow_t &) noexcept {
+    return allocate (size_, static_cast<size_t> (align_));
+}
+
+void * operator new[] (size_t size_, std::align_val_t align_, const std::nothrow_t &) noexcept {
+    return allocate (size_, static_cast<size_t> (align_));
+}
+
+/******************************************************************************/
+
+void operator delete (void * ptr_) noexcept { release (ptr_, 0); }
+void operator delete[] (void * ptr_) noexcept { release (ptr_, 0); }
+void operator delete (void * ptr_, size_t) noexcept { release (ptr_, 0); }
+void operator delete[] (void * ptr_, size_t) noexcept { release (ptr_, 0); }
+
+void operator delete (void * ptr_, const std::nothrow_t &) noexcept {
+    release (ptr_, 0);
+}
+
+void operator delete[] (void * ptr_, const std::nothrow_t &) noexcept {
+    release (ptr_, 0);
+}
+
+void operator delete (void * ptr_, std::align_val_t align_) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+void operator delete[] (void * ptr_, std::align_val_t align_) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+void operator delete (void * ptr_, size_t, std::align_val_t align_) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+void operator delete[] (void * ptr_, size_t, std::align_val_t align_) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+void operator delete (void * ptr_, std::align_val_t align_, const std::nothrow_t &) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+void operator delete[] (void * ptr_, std::align_val_t align_, const std::nothrow_t &) noexcept {
+    release (ptr_, static_cast<size_t> (align_));
+}
+
+/******************************************************************************/
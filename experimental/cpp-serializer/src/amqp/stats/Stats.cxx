@@ -0,0 +1,453 @@
+#include "Stats.h"
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "amqp/ReaderCache.h"
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Stats
+ *
+ ******************************************************************************/
+
+bool amqp::internal::stats::Stats::s_enabled { false };
+
+/******************************************************************************/
+
+amqp::internal::stats::Stats &
+amqp::internal::stats::
+Stats::instance() {
+    static Stats stats;
+    return stats;
+}
+
+/******************************************************************************/
+
+/**
+ * Blocks are owned by the instance rather than the thread so are still
+ * there to be summed once a batch's workers have gone
+ */
+amqp::internal::stats::Stats::Block &
+amqp::internal::stats::
+Stats::local() {
+    static thread_local Block * block { nullptr };
+
+    if (!block) {
+        auto & stats = instance();
+
+        std::lock_guard<std::mutex> guard (stats.m_lock);
+
+        block = stats.m_blocks.emplace_back (std::make_unique<Block>()).get();
+    }
+
+    return *block;
+}
+
+/******************************************************************************/
+
+amqp::internal::stats::Stats::Block
+amqp::internal::stats::
+Stats::sum() const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    Block rtn;
+
+    for (const auto & block : m_blocks) {
+        for (int i { 0 } ; i < counters_t ; ++i) {
+            rtn.m_counts[i] += block->m_counts[i];
+        }
+
+        for (int i { 0 } ; i < phases_t ; ++i) {
+            rtn.m_nanos[i] += block->m_nanos[i];
+            rtn.m_calls[i] += block->m_calls[i];
+        }
+
+        for (int i { 0 } ; i < BUCKETS ; ++i) {
+            rtn.m_latencies[i] += block->m_latencies[i];
+        }
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+/**
+ * Latencies below [SUB_BUCKETS] nanoseconds get a bucket each, the rest
+ * are bucketed by their top bit and the three bits below it
+ */
+int
+amqp::internal::stats::
+Stats::bucket (uint64_t nanos_) {
+    if (nanos_ < SUB_BUCKETS) return static_cast<int> (nanos_);
+
+    auto top = 63 - __builtin_clzll (nanos_);
+    auto sub = static_cast<int> ((nanos_ >> (top - 3)) & (SUB_BUCKETS - 1));
+
+    return (top - 2) * SUB_BUCKETS + sub;
+}
+
+/******************************************************************************/
+
+uint64_t
+amqp::internal::stats::
+Stats::ceiling (int bucket_) {
+    if (bucket_ < SUB_BUCKETS) return static_cast<uint64_t> (bucket_);
+
+    auto top = bucket_ / SUB_BUCKETS + 2;
+    auto sub = static_cast<uint64_t> (bucket_ % SUB_BUCKETS);
+
+    if (top >= 63 && sub == SUB_BUCKETS - 1) return UINT64_MAX;
+
+    return ((SUB_BUCKETS + sub + 1) << (top - 3)) - 1;
+}
+
+/******************************************************************************/
+
+uint64_t
+amqp::internal::stats::
+Stats::percentile (double fraction_) const {
+    auto total = sum();
+
+    uint64_t blobs { 0 };
+    for (auto n : total.m_latencies) blobs += n;
+
+    if (blobs == 0) return 0;
+
+    // the rank of the blob wanted, counting from one
+    auto rank = static_cast<uint64_t> (fraction_ * static_cast<double> (blobs) + 0.5);
+    rank = std::max<uint64_t> (1, std::min (rank, blobs));
+
+    uint64_t seen { 0 };
+
+    for (int i { 0 } ; i < BUCKETS ; ++i) {
+        seen += total.m_latencies[i];
+        if (seen >= rank) return ceiling (i);
+    }
+
+    return ceiling (BUCKETS - 1);
+}
+
+/******************************************************************************/
+
+namespace {
+
+    const char * const phases[] = {
+        "io", "peek", "envelope", "readers", "render"
+    };
+
+    /**
+     * The reader cache may itself have been cleared since the stats were
+     */
+    uint64_t
+    since (uint64_t now_, uint64_t base_) {
+        return now_ >= base_ ? now_ - base_ : now_;
+    }
+
+    template<size_t N>
+    void
+    save (std::ostream & out_, const char * name_, const uint64_t (& values_)[N]) {
+        out_ << name_;
+        for (auto value : values_) out_ << ' ' << value;
+        out_ << '\n';
+    }
+
+    template<size_t N>
+    void
+    load (std::istream & in_, uint64_t (& values_)[N]) {
+        for (auto & value : values_) {
+            uint64_t n;
+            if (!(in_ >> n)) throw std::runtime_error ("Malformed stats");
+            value += n;
+        }
+    }
+
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Stats::cache (uint64_t & hits_, uint64_t & misses_) const {
+    // the cache counts under its own lock, so is asked before taking this one
+    auto & cache = ReaderCache::instance();
+    auto hits = cache.hits();
+    auto misses = cache.misses();
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    hits_ = since (hits, m_cacheBase[0]) + m_cacheLoaded[0];
+    misses_ = since (misses, m_cacheBase[1]) + m_cacheLoaded[1];
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Stats::write (amqp::reader::ISink & sink_) const {
+    static const char * const counters[] = {
+        "blobs", "objects", "fields", "elements", "entries", "strings"
+    };
+
+    auto total = sum();
+
+    sink_.beginObject();
+
+    sink_.key ("seconds");
+    sink_.beginObject();
+    for (int i { 0 } ; i < phases_t ; ++i) {
+        sink_.key (phases[i]);
+        sink_.real (static_cast<double> (total.m_nanos[i]) / 1e9);
+    }
+    sink_.endObject();
+
+    sink_.key ("calls");
+    sink_.beginObject();
+    for (int i { 0 } ; i < phases_t ; ++i) {
+        sink_.key (phases[i]);
+        sink_.integer (static_cast<int64_t> (total.m_calls[i]));
+    }
+    sink_.endObject();
+
+    sink_.key ("counts");
+    sink_.beginObject();
+    for (int i { 0 } ; i < memo_hits_t ; ++i) {
+        sink_.key (counters[i]);
+        sink_.integer (static_cast<int64_t> (total.m_counts[i]));
+    }
+    sink_.endObject();
+
+    uint64_t hits, misses;
+    cache (hits, misses);
+
+    sink_.key ("cache");
+    sink_.beginObject();
+    sink_.key ("hits");
+    sink_.integer (static_cast<int64_t> (hits));
+    sink_.key ("misses");
+    sink_.integer (static_cast<int64_t> (misses));
+    sink_.key ("hitRate");
+    sink_.real (hits + misses == 0
+            ? 0.0
+            : static_cast<double> (hits) / static_cast<double> (hits + misses));
+    sink_.endObject();
+
+    auto memoHits = total.m_counts[memo_hits_t];
+    auto memoMisses = total.m_counts[memo_misses_t];
+
+    sink_.key ("memo");
+    sink_.beginObject();
+    sink_.key ("hits");
+    sink_.integer (static_cast<int64_t> (memoHits));
+    sink_.key ("misses");
+    sink_.integer (static_cast<int64_t> (memoMisses));
+    sink_.key ("hitRate");
+    sink_.real (memoHits + memoMisses == 0
+            ? 0.0
+            : static_cast<double> (memoHits) / static_cast<double> (memoHits + memoMisses));
+    sink_.endObject();
+
+    uint64_t blobs { 0 };
+    int highest { -1 };
+
+    for (int i { 0 } ; i < BUCKETS ; ++i) {
+        blobs += total.m_latencies[i];
+        if (total.m_latencies[i]) highest = i;
+    }
+
+    sink_.key ("latency");
+    sink_.beginObject();
+    sink_.key ("blobs");
+    sink_.integer (static_cast<int64_t> (blobs));
+    sink_.key ("p50");
+    sink_.real (static_cast<double> (percentile (0.5)) / 1e9);
+    sink_.key ("p99");
+    sink_.real (static_cast<double> (percentile (0.99)) / 1e9);
+    sink_.key ("max");
+    sink_.real (highest < 0 ? 0.0 : static_cast<double> (ceiling (highest)) / 1e9);
+    sink_.endObject();
+
+    auto busy = total.m_counts[busy_t];
+    auto available = total.m_counts[available_t];
+
+    sink_.key ("utilisation");
+    sink_.beginObject();
+    sink_.key ("busy");
+    sink_.real (static_cast<double> (busy) / 1e9);
+    sink_.key ("available");
+    sink_.real (static_cast<double> (available) / 1e9);
+    sink_.key ("ratio");
+    sink_.real (available == 0
+            ? 0.0
+            : std::min (1.0, static_cast<double> (busy) / static_cast<double> (available)));
+    sink_.endObject();
+
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+/**
+ * A line each of counts, phase times and calls, the cache's hits and
+ * misses and the latency buckets that aren't empty, as bucket:count
+ */
+void
+amqp::internal::stats::
+Stats::save (std::ostream & out_) const {
+    auto total = sum();
+
+    uint64_t hits, misses;
+    cache (hits, misses);
+
+    out_ << "stats 1\n";
+
+    ::save (out_, "counts", total.m_counts);
+    ::save (out_, "nanos", total.m_nanos);
+    ::save (out_, "calls", total.m_calls);
+
+    out_ << "cache " << hits << ' ' << misses << '\n';
+
+    out_ << "latencies";
+    for (int i { 0 } ; i < BUCKETS ; ++i) {
+        if (total.m_latencies[i]) out_ << ' ' << i << ':' << total.m_latencies[i];
+    }
+    out_ << '\n';
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Stats::load (std::istream & in_) {
+    Block loaded;
+    uint64_t cached[2] { };
+
+    std::string line;
+
+    if (!std::getline (in_, line) || line != "stats 1") {
+        throw std::runtime_error ("Malformed stats");
+    }
+
+    for (const char * name : { "counts", "nanos", "calls", "cache", "latencies" }) {
+        if (!std::getline (in_, line)) throw std::runtime_error ("Malformed stats");
+
+        std::istringstream fields (line);
+        std::string got;
+
+        if (!(fields >> got) || got != name) throw std::runtime_error ("Malformed stats");
+
+        if (got == "counts") {
+            ::load (fields, loaded.m_counts);
+        } else if (got == "nanos") {
+            ::load (fields, loaded.m_nanos);
+        } else if (got == "calls") {
+            ::load (fields, loaded.m_calls);
+        } else if (got == "cache") {
+            ::load (fields, cached);
+        } else {
+            int bucket;
+            char colon;
+            uint64_t n;
+
+            while (fields >> bucket >> colon >> n) {
+                if (bucket < 0 || bucket >= BUCKETS || colon != ':') {
+                    throw std::runtime_error ("Malformed stats");
+                }
+
+                loaded.m_latencies[bucket] += n;
+            }
+
+            if (!fields.eof()) throw std::runtime_error ("Malformed stats");
+        }
+    }
+
+    auto & block = local();
+
+    for (int i { 0 } ; i < counters_t ; ++i) block.m_counts[i] += loaded.m_counts[i];
+
+    for (int i { 0 } ; i < phases_t ; ++i) {
+        block.m_nanos[i] += loaded.m_nanos[i];
+        block.m_calls[i] += loaded.m_calls[i];
+    }
+
+    for (int i { 0 } ; i < BUCKETS ; ++i) block.m_latencies[i] += loaded.m_latencies[i];
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    m_cacheLoaded[0] += cached[0];
+    m_cacheLoaded[1] += cached[1];
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Stats::clear() {
+    auto & cache = ReaderCache::instance();
+    auto hits = cache.hits();
+    auto misses = cache.misses();
+
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    for (auto & block : m_blocks) {
+        *block = Block();
+    }
+
+    m_cacheBase[0] = hits;
+    m_cacheBase[1] = misses;
+    m_cacheLoaded[0] = m_cacheLoaded[1] = 0;
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Stats::Timer
+ *
+ ******************************************************************************/
+
+thread_local amqp::internal::stats::Stats::Timer *
+amqp::internal::stats::Stats::Timer::t_current { nullptr };
+
+/******************************************************************************/
+
+amqp::internal::stats::
+Stats::Timer::Timer (Phase phase_, std::string_view detail_)
+    : m_span (phases[phase_], detail_)
+    , m_phase (phase_)
+    , m_active (Stats::enabled())
+    , m_parent (nullptr)
+    , m_nested (0)
+{
+    if (m_active) {
+        m_parent = t_current;
+        t_current = this;
+        m_start = Clock::now();
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::stats::
+Stats::Timer::~Timer() {
+    if (!m_active) return;
+
+    auto elapsed = static_cast<uint64_t> (
+            std::chrono::duration_cast<std::chrono::nanoseconds> (
+                    Clock::now() - m_start).count());
+
+    auto & block = local();
+
+    block.m_nanos[m_phase] += elapsed - m_nested;
+    ++block.m_calls[m_phase];
+
+    if (m_parent) m_parent->m_nested += elapsed;
+
+    t_current = m_parent;
+}
+
+/******************************************************************************/
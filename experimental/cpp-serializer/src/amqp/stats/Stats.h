@@ -0,0 +1,242 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+#include "Trace.h"
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::stats::Stats
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::stats {
+
+    /**
+     * Where the time goes and how much was decoded, summed over every
+     * blob and every thread in the process. Nothing is recorded until
+     * [enable] is called so, unless asked for, all this costs is a test
+     * of a flag.
+     *
+     * Each thread counts into a block of its own, with no locking or
+     * atomics, blocks only being summed when a report is written. That
+     * must therefore wait until the counting threads are done.
+     *
+     * Time in a phase is exclusive of any phase nested inside it, so the
+     * time spent building readers during a render isn't counted twice.
+     *
+     * Each blob a batch decodes also has its latency, how long a worker
+     * spent on it from start to finish, added to a histogram whose
+     * buckets are an eighth of a power of two wide, so any percentile is
+     * known to within about 10% however long or short the blobs take.
+     */
+    class Stats {
+        public :
+            enum Phase {
+                io_t,       // reading or mapping the blob
+                peek_t,     // finding the schema and payload in the envelope
+                envelope_t, // building the envelope and its schema
+                readers_t,  // CompositeFactory::process and friends
+                render_t,   // decoding the payload
+                phases_t
+            };
+
+            enum Counter {
+                blobs_t,
+                objects_t,
+                fields_t,
+                elements_t,
+                entries_t,
+                strings_t,
+
+                /**
+                 * Blobs a batch found, or didn't, the output of an
+                 * identical blob already kept for, reported apart from
+                 * the counts of what was decoded
+                 */
+                memo_hits_t,
+                memo_misses_t,
+
+                /**
+                 * Nanoseconds workers spent on blobs, see [Latency], and
+                 * those a batch's workers had between them, reported as
+                 * its utilisation
+                 */
+                busy_t,
+                available_t,
+
+                counters_t
+            };
+
+            class Timer;
+            class Latency;
+
+            /**
+             * Eight to each power of two of nanoseconds
+             */
+            static constexpr int SUB_BUCKETS = 8;
+            static constexpr int BUCKETS = 64 * SUB_BUCKETS;
+
+        private :
+            struct Block {
+                uint64_t m_counts[counters_t] { };
+                uint64_t m_nanos[phases_t] { };
+                uint64_t m_calls[phases_t] { };
+                uint64_t m_latencies[BUCKETS] { };
+            };
+
+            static bool s_enabled;
+
+            mutable std::mutex m_lock;
+            std::vector<std::unique_ptr<Block>> m_blocks;
+
+            /**
+             * The reader cache's hits and misses when last [clear]ed, and
+             * those [load]ed since
+             */
+            uint64_t m_cacheBase[2] { };
+            uint64_t m_cacheLoaded[2] { };
+
+            void cache (uint64_t & hits_, uint64_t & misses_) const;
+
+            static Block & local();
+
+            Block sum() const;
+
+        public :
+            static Stats & instance();
+
+            static void enable (bool enabled_ = true) { s_enabled = enabled_; }
+            static bool enabled() { return s_enabled; }
+
+            static void count (Counter counter_, uint64_t n_ = 1) {
+                if (s_enabled) local().m_counts[counter_] += n_;
+            }
+
+            static int bucket (uint64_t nanos_);
+
+            /**
+             * The most nanoseconds a latency in [bucket_] could have been
+             */
+            static uint64_t ceiling (int bucket_);
+
+            /**
+             * Add a blob's latency to the histogram
+             */
+            static void latency (uint64_t nanos_) {
+                if (s_enabled) ++local().m_latencies[bucket (nanos_)];
+            }
+
+            /**
+             * The latency, in nanoseconds, [fraction_] of the blobs took
+             * no longer than, 0.99 being the 99th percentile. Zero when
+             * none have been recorded
+             */
+            uint64_t percentile (double fraction_) const;
+
+            /**
+             * Everything recorded so far, along with the reader cache's
+             * hits and misses, the batch memo's, the p50, p99 and most
+             * of the blobs' latencies and how busy a batch kept its
+             * workers, as a single JSON object
+             */
+            void write (amqp::reader::ISink &) const;
+
+            /**
+             * Everything recorded so far as it's counted rather than as
+             * it's reported, for another process to [load] and add to its
+             * own, so the reports of several, latencies and all, can be
+             * summed exactly
+             */
+            void save (std::ostream &) const;
+
+            /**
+             * Add what another process [save]d to what's been recorded
+             * here. It all goes to the calling thread's block, so nothing
+             * else may be counting on it
+             */
+            void load (std::istream &);
+
+            void clear();
+    };
+
+    /**
+     * Times its own scope as a [Phase] and, when tracing, records it as a
+     * span named for that phase with [detail_], normally the type being
+     * worked on, as its detail
+     */
+    class Stats::Timer {
+        private :
+            using Clock = std::chrono::steady_clock;
+
+            Trace::Span m_span;
+
+            Phase m_phase;
+            bool m_active;
+
+            Clock::time_point m_start;
+
+            Timer * m_parent;
+
+            /**
+             * Time spent in timers nested within this one
+             */
+            uint64_t m_nested;
+
+            static thread_local Timer * t_current;
+
+        public :
+            explicit Timer (Phase, std::string_view detail_ = { });
+            Timer (const Timer &) = delete;
+
+            ~Timer();
+    };
+
+    /**
+     * Records its own scope as a blob's [latency]
+     */
+    class Stats::Latency {
+        private :
+            using Clock = std::chrono::steady_clock;
+
+            bool m_active;
+            Clock::time_point m_start;
+
+        public :
+            Latency() : m_active (Stats::enabled()) {
+                if (m_active) m_start = Clock::now();
+            }
+
+            Latency (const Latency &) = delete;
+
+            ~Latency() {
+                if (!m_active) return;
+
+                auto nanos = static_cast<uint64_t> (
+                        std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                Clock::now() - m_start).count());
+
+                Stats::latency (nanos);
+                Stats::count (busy_t, nanos);
+            }
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,179 @@
+#include "Trace.h"
+
+#include <string>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Trace
+ *
+ ******************************************************************************/
+
+bool amqp::internal::stats::Trace::s_enabled { false };
+
+/******************************************************************************/
+
+amqp::internal::stats::
+Trace::Trace() : m_epoch (Clock::now()) {
+}
+
+/******************************************************************************/
+
+amqp::internal::stats::Trace &
+amqp::internal::stats::
+Trace::instance() {
+    static Trace trace;
+    return trace;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Trace::enable (bool enabled_) {
+    // make sure the epoch predates the first span
+    instance();
+    s_enabled = enabled_;
+}
+
+/******************************************************************************/
+
+std::vector<amqp::internal::stats::Trace::Event> &
+amqp::internal::stats::
+Trace::local() {
+    static thread_local std::vector<Event> * track { nullptr };
+
+    if (!track) {
+        auto & trace = instance();
+
+        std::lock_guard<std::mutex> guard (trace.m_lock);
+
+        track = trace.m_tracks.emplace_back (
+                std::make_unique<std::vector<Event>>()).get();
+    }
+
+    return *track;
+}
+
+/******************************************************************************/
+
+/**
+ * Times are in microseconds, and threads are numbered in the order they
+ * first recorded something
+ */
+void
+amqp::internal::stats::
+Trace::write (amqp::reader::ISink & sink_) const {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    sink_.beginObject();
+    sink_.key ("displayTimeUnit");
+    sink_.string ("ms");
+
+    sink_.key ("traceEvents");
+    sink_.beginList();
+
+    for (size_t i { 0 } ; i < m_tracks.size() ; ++i) {
+        auto tid = static_cast<int64_t> (i + 1);
+
+        sink_.beginObject();
+        sink_.key ("name");
+        sink_.string ("thread_name");
+        sink_.key ("ph");
+        sink_.string ("M");
+        sink_.key ("pid");
+        sink_.integer (1);
+        sink_.key ("tid");
+        sink_.integer (tid);
+        sink_.key ("args");
+        sink_.beginObject();
+        sink_.key ("name");
+        sink_.string ("thread " + std::to_string (tid));
+        sink_.endObject();
+        sink_.endObject();
+
+        for (const auto & event : *m_tracks[i]) {
+            sink_.beginObject();
+            sink_.key ("name");
+            sink_.string (event.m_name);
+            sink_.key ("cat");
+            sink_.string ("decode");
+            sink_.key ("ph");
+            sink_.string ("X");
+            sink_.key ("ts");
+            sink_.real (static_cast<double> (event.m_start) / 1e3);
+            sink_.key ("dur");
+            sink_.real (static_cast<double> (event.m_duration) / 1e3);
+            sink_.key ("pid");
+            sink_.integer (1);
+            sink_.key ("tid");
+            sink_.integer (tid);
+
+            if (!event.m_detail.empty()) {
+                sink_.key ("args");
+                sink_.beginObject();
+                sink_.key ("detail");
+                sink_.string (event.m_detail);
+                sink_.endObject();
+            }
+
+            sink_.endObject();
+        }
+    }
+
+    sink_.endList();
+    sink_.endObject();
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::stats::
+Trace::clear() {
+    std::lock_guard<std::mutex> guard (m_lock);
+
+    for (auto & track : m_tracks) {
+        track->clear();
+    }
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::stats::Trace::Span
+ *
+ ******************************************************************************/
+
+amqp::internal::stats::
+Trace::Span::Span (const char * name_, std::string_view detail_)
+    : m_name (name_)
+    , m_active (Trace::enabled())
+{
+    if (m_active) {
+        m_detail = detail_;
+        m_start = Clock::now();
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::stats::
+Trace::Span::~Span() {
+    if (!m_active) return;
+
+    auto end = Clock::now();
+    auto & trace = instance();
+
+    auto ns = [](Clock::duration d_) {
+        return static_cast<uint64_t> (
+                std::chrono::duration_cast<std::chrono::nanoseconds> (d_).count());
+    };
+
+    local().push_back (Event {
+            m_name,
+            std::move (m_detail),
+            ns (m_start - trace.m_epoch),
+            ns (end - m_start) });
+}
+
+/******************************************************************************/
@@ -0,0 +1,99 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::stats::Trace
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::stats {
+
+    /**
+     * Scoped spans recorded as Chrome trace events, the JSON format both
+     * chrome://tracing and Perfetto load, with a track per thread. Each
+     * span is a complete ("X") event so nesting falls out of the times.
+     *
+     * As with [Stats] nothing is recorded unless [enable] is called and
+     * each thread records into a track of its own, tracks only being read
+     * once the threads recording into them are done.
+     */
+    class Trace {
+        public :
+            class Span;
+
+        private :
+            using Clock = std::chrono::steady_clock;
+
+            struct Event {
+                const char * m_name;
+                std::string m_detail;
+                uint64_t m_start;
+                uint64_t m_duration;
+            };
+
+            static bool s_enabled;
+
+            mutable std::mutex m_lock;
+            std::vector<std::unique_ptr<std::vector<Event>>> m_tracks;
+
+            Clock::time_point m_epoch;
+
+            Trace();
+
+            static std::vector<Event> & local();
+
+        public :
+            static Trace & instance();
+
+            static void enable (bool enabled_ = true);
+            static bool enabled() { return s_enabled; }
+
+            /**
+             * Every span recorded so far as a trace event object
+             */
+            void write (amqp::reader::ISink &) const;
+
+            void clear();
+    };
+
+    /**
+     * A span lasting as long as its scope, [name_] must outlive the trace
+     * and so is normally a literal. [detail_] is copied, and shown as the
+     * span's "detail" argument, when given
+     */
+    class Trace::Span {
+        private :
+            const char * m_name;
+            std::string m_detail;
+            bool m_active;
+
+            Clock::time_point m_start;
+
+        public :
+            explicit Span (const char * name_, std::string_view detail_ = { });
+            Span (const Span &) = delete;
+
+            ~Span();
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,219 @@
+#include "Index.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Pointer.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::tape::Index
+ *
+ ******************************************************************************/
+
+amqp::internal::tape::
+Index::Index (const Tape & tape_)
+    : m_tape (&tape_)
+    , m_root { 0, SCALAR }
+{
+    if (tape_.size() >= ABSENT) {
+        throw std::runtime_error ("Tape too large to index");
+    }
+
+    if (tape_.empty()) return;
+
+    auto root = tape_.begin();
+
+    if (!root.compound()) return;
+
+    // only needed whilst building, to find the shape each object has
+    std::unordered_map<std::string, uint32_t> shapes;
+    std::string keys;
+
+    m_root.m_compound = 0;
+    m_compounds.push_back ({ 0, 0, SCALAR, root.type() });
+
+    index (root, 0, shapes, keys);
+}
+
+/******************************************************************************/
+
+/**
+ * A compound's table is filled before any compound inside it is indexed,
+ * so each table is a single run
+ */
+void
+amqp::internal::tape::
+Index::index (
+    const Tape::Ref & ref_,
+    uint32_t compound_,
+    std::unordered_map<std::string, uint32_t> & shapes_,
+    std::string & keys_
+) {
+    const auto first = static_cast<uint32_t> (m_values.size());
+    const auto type = ref_.type();
+    const auto last = ref_.end();
+
+    if (type == Tape::object_t) keys_.clear();
+
+    for (auto it = ref_.begin() ; it != last ; it = it.next()) {
+        if (type == Tape::object_t) {
+            auto key = it.text();
+            auto size = static_cast<uint32_t> (key.size());
+
+            // lengths first so no two sequences of keys run together the same
+            keys_.append (reinterpret_cast<const char *> (&size), sizeof (size));
+            keys_.append (key);
+
+            auto value = it.next();
+
+            m_values.push_back ({
+                static_cast<uint32_t> (value.index()),
+                value.index() == it.index() ? ABSENT : SCALAR });
+
+            it = value;
+        } else {
+            m_values.push_back ({ static_cast<uint32_t> (it.index()), SCALAR });
+        }
+    }
+
+    auto size = static_cast<uint32_t> (m_values.size()) - first;
+    auto shape = SCALAR;
+
+    if (type == Tape::object_t) {
+        auto found = shapes_.find (keys_);
+
+        if (found == shapes_.end()) {
+            found = shapes_.emplace (keys_, static_cast<uint32_t> (m_shapes.size())).first;
+
+            Shape fields;
+
+            for (uint32_t i { 0 }, at { 0 } ; i < size ; ++i) {
+                uint32_t length;
+                std::memcpy (&length, keys_.data() + at, sizeof (length));
+                at += sizeof (length);
+
+                // a name given twice is found at its first
+                fields.m_fields.emplace (keys_.substr (at, length), i);
+                at += length;
+            }
+
+            m_shapes.push_back (std::move (fields));
+        }
+
+        shape = found->second;
+    }
+
+    m_compounds[compound_] = { first, size, shape, type };
+
+    for (auto i = first ; i < first + size ; ++i) {
+        if (m_values[i].m_compound == ABSENT) continue;
+
+        auto value = ref (m_values[i]);
+
+        if (!value.compound()) continue;
+
+        auto compound = static_cast<uint32_t> (m_compounds.size());
+
+        m_values[i].m_compound = compound;
+        m_compounds.push_back ({ 0, 0, SCALAR, value.type() });
+
+        index (value, compound, shapes_, keys_);
+    }
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::tape::
+Index::entry (const Compound & map_, const std::string & name_, size_t index_) const {
+    for (size_t i { 0 } ; i + 1 < map_.m_size ; i += 2) {
+        auto key = ref (m_values[map_.m_first + i]);
+
+        switch (key.type()) {
+            case Tape::string_t : case Tape::symbol_t :
+                if (key.text() == name_) return i + 1;
+                break;
+            case Tape::integer_t :
+                if (index_ != npos && key.integer() >= 0
+                    && static_cast<uint64_t> (key.integer()) == index_)
+                {
+                    return i + 1;
+                }
+                break;
+            default :
+                break;
+        }
+    }
+
+    return npos;
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Index::at (const Pointer & pointer_) const {
+    if (m_tape->empty()) return m_tape->end();
+
+    auto at = m_root;
+
+    for (const auto & token : pointer_) {
+        if (at.m_compound >= ABSENT) return m_tape->end();
+
+        const auto & compound = m_compounds[at.m_compound];
+
+        size_t i { npos };
+
+        switch (compound.m_type) {
+            case Tape::object_t : {
+                const auto & fields = m_shapes[compound.m_shape].m_fields;
+                auto it = fields.find (token.name());
+
+                if (it != fields.end()) i = it->second;
+                break;
+            }
+            case Tape::list_t :
+                if (token.index() < compound.m_size) i = token.index();
+                break;
+            default :
+                i = entry (compound, token.name(), token.index());
+                break;
+        }
+
+        if (i == npos) return m_tape->end();
+
+        at = m_values[compound.m_first + i];
+    }
+
+    return ref (at);
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Index::at (std::string_view pointer_) const {
+    return at (Pointer (pointer_));
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::tape::
+Index::bytes() const {
+    auto rtn = sizeof (Index)
+        + m_compounds.capacity() * sizeof (Compound)
+        + m_values.capacity() * sizeof (Value)
+        + m_shapes.capacity() * sizeof (Shape);
+
+    for (const auto & shape : m_shapes) {
+        for (const auto & field : shape.m_fields) {
+            rtn += sizeof (field) + field.first.capacity() + 2 * sizeof (void *);
+        }
+    }
+
+    return rtn;
+}
+
+/******************************************************************************/
@@ -0,0 +1,126 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "Tape.h"
+
+/******************************************************************************
+ *
+ * class amqp::internal::tape::Index
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::tape {
+
+    class Pointer;
+
+    /**
+     * Tables over a [Tape] that take a [Pointer] straight to the value
+     * it names, a step per token, rather than walking every sibling on
+     * the way and comparing keys as [Tape::Ref::operator[]] does. Built
+     * once, in a single pass, for a tape that's to be queried again and
+     * again, a decoded state held in a cache say.
+     *
+     * Every compound has a table of where each value directly inside it
+     * starts, so a list's element is found by its index. An object's
+     * keys aren't kept with it but with its shape, the sequence of keys
+     * it has, which every object of the same composite type shares since
+     * their fields are always written in the order the reader has them.
+     * A shape maps each of its names to its position, so a field is found
+     * by a single hash lookup however many fields come before it, and the
+     * tables cost nothing per object beyond its values.
+     *
+     * A map's keys are compared with the token in turn, text to strings
+     * and symbols, indices to integers.
+     *
+     * The tape mustn't change, or go, before the index does. Being read
+     * only once built, an index can be shared by any number of threads.
+     */
+    class Index {
+        public :
+            static constexpr size_t npos = static_cast<size_t> (-1);
+
+        private :
+            static constexpr uint32_t SCALAR = UINT32_MAX;
+
+            /**
+             * The null an absent field stands in for
+             */
+            static constexpr uint32_t ABSENT = UINT32_MAX - 1;
+
+            /**
+             * A value, by where it starts on the tape and, for a compound,
+             * which one it is
+             */
+            struct Value {
+                uint32_t m_token;
+                uint32_t m_compound;
+            };
+
+            struct Compound {
+                uint32_t m_first;
+                uint32_t m_size;
+                uint32_t m_shape;
+                Tape::Type m_type;
+            };
+
+            struct Shape {
+                std::unordered_map<std::string, uint32_t> m_fields;
+            };
+
+            const Tape * m_tape;
+
+            Value m_root;
+
+            std::vector<Compound> m_compounds;
+
+            /**
+             * Each compound's table a run of this, a map's keys and values
+             * alternating
+             */
+            std::vector<Value> m_values;
+
+            std::vector<Shape> m_shapes;
+
+            void index (const Tape::Ref &, uint32_t compound_,
+                    std::unordered_map<std::string, uint32_t> & shapes_, std::string & keys_);
+
+            size_t entry (const Compound &, const std::string & name_, size_t index_) const;
+
+            Tape::Ref ref (const Value & value_) const {
+                return Tape::Ref (*m_tape, value_.m_token, value_.m_compound == ABSENT);
+            }
+
+        public :
+            explicit Index (const Tape &);
+
+            Index (const Index &) = delete;
+
+            /**
+             * The value [pointer_] names, the tape's end if there's
+             * nothing there
+             */
+            Tape::Ref at (const Pointer & pointer_) const;
+            Tape::Ref at (std::string_view pointer_) const;
+
+            /**
+             * The distinct shapes of object met
+             */
+            size_t shapes() const { return m_shapes.size(); }
+
+            /**
+             * Roughly what the tables hold
+             */
+            size_t bytes() const;
+    };
+
+}
+
+/******************************************************************************/
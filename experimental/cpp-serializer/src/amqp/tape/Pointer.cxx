@@ -0,0 +1,55 @@
+#include "Pointer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/******************************************************************************
+ *
+ * amqp::internal::tape::Pointer
+ *
+ ******************************************************************************/
+
+amqp::internal::tape::
+Pointer::Pointer (std::string_view pointer_) {
+    if (pointer_.empty()) return;
+
+    if (pointer_[0] != '/') {
+        throw std::runtime_error ("Bad pointer \"" + std::string (pointer_) + "\"");
+    }
+
+    for (size_t i { 1 } ; ; ) {
+        auto end = std::min (pointer_.find ('/', i), pointer_.size());
+
+        Token token;
+        token.m_name.reserve (end - i);
+
+        for (auto j = i ; j < end ; ++j) {
+            if (pointer_[j] != '~') {
+                token.m_name.push_back (pointer_[j]);
+            } else if (j + 1 < end && (pointer_[j + 1] == '0' || pointer_[j + 1] == '1')) {
+                token.m_name.push_back (pointer_[++j] == '0' ? '~' : '/');
+            } else {
+                throw std::runtime_error ("Bad escape in pointer \"" + std::string (pointer_) + "\"");
+            }
+        }
+
+        const auto & name = token.m_name;
+
+        token.m_index = npos;
+
+        if (!name.empty() && name.size() < 20
+            && name.find_first_not_of ("0123456789") == std::string::npos
+            && (name[0] != '0' || name.size() == 1))
+        {
+            token.m_index = std::stoull (name);
+        }
+
+        m_tokens.push_back (std::move (token));
+
+        if (end == pointer_.size()) break;
+
+        i = end + 1;
+    }
+}
+
+/******************************************************************************/
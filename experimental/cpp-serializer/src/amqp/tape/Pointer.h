@@ -0,0 +1,67 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+/******************************************************************************
+ *
+ * class amqp::internal::tape::Pointer
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::tape {
+
+    /**
+     * A JSON Pointer, RFC 6901, "/states/4123/amount/quantity" say, parsed
+     * once so it can be resolved over and over. Each token names a field
+     * of an object, or a key of a map, or indexes a list. One that reads
+     * as an index, digits without a leading zero, is parsed as one too,
+     * so resolving it never goes back to its text. "~1" and "~0" stand
+     * for '/' and '~' in a name, and the empty pointer is the whole value.
+     */
+    class Pointer {
+        public :
+            static constexpr size_t npos = static_cast<size_t> (-1);
+
+            class Token {
+                private :
+                    std::string m_name;
+                    size_t m_index;
+
+                    friend class Pointer;
+
+                public :
+                    const std::string & name() const { return m_name; }
+
+                    /**
+                     * The list index the token reads as, [npos] if it doesn't
+                     */
+                    size_t index() const { return m_index; }
+            };
+
+        private :
+            std::vector<Token> m_tokens;
+
+        public :
+            /**
+             * Throws should [pointer_] not be empty or begin with a '/',
+             * or hold a '~' other than as an escape
+             */
+            explicit Pointer (std::string_view pointer_);
+
+            const std::vector<Token> & tokens() const { return m_tokens; }
+
+            auto begin() const { return m_tokens.begin(); }
+            auto end() const { return m_tokens.end(); }
+
+            size_t size() const { return m_tokens.size(); }
+            bool empty() const { return m_tokens.empty(); }
+    };
+
+}
+
+/******************************************************************************/
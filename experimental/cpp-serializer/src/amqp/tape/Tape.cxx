@@ -0,0 +1,492 @@
+#include "Tape.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "amqp/reader/ISink.h"
+
+/******************************************************************************
+ *
+ * amqp::internal::tape::Tape::Ref
+ *
+ ******************************************************************************/
+
+uint64_t
+amqp::internal::tape::
+Tape::Ref::word (size_t n_) const {
+    return m_tape->word (m_index + n_);
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Type
+amqp::internal::tape::
+Tape::Ref::type() const {
+    auto rtn = static_cast<Type>(word() >> TYPE_SHIFT);
+
+    if (rtn == absent_t) return m_null ? null_t : key_t;
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::tape::
+Tape::Ref::compound() const {
+    switch (type()) {
+        case object_t : case list_t : case map_t : return true;
+        default : return false;
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Tape::Ref::next() const {
+    switch (static_cast<Type>(word() >> TYPE_SHIFT)) {
+        case object_t : case list_t : case map_t : {
+            auto end = word() & PAYLOAD;
+
+            // an end before its open would have a walk go round in circles
+            if (end <= m_index) Tape::corrupt();
+
+            return Ref (*m_tape, end + 1);
+        }
+        case absent_t :
+            return m_null ? Ref (*m_tape, m_index + 1) : Ref (*m_tape, m_index, true);
+        case key_t : case string_t : case symbol_t : case binary_t :
+        case integer_t : case real_t :
+            return Ref (*m_tape, m_index + 2);
+        default :
+            return Ref (*m_tape, m_index + 1);
+    }
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Tape::Ref::begin() const {
+    if (!compound()) {
+        throw std::runtime_error ("Not a compound value");
+    }
+
+    return Ref (*m_tape, m_index + 2);
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Tape::Ref::end() const {
+    if (!compound()) {
+        throw std::runtime_error ("Not a compound value");
+    }
+
+    return Ref (*m_tape, word() & PAYLOAD);
+}
+
+/******************************************************************************/
+
+size_t
+amqp::internal::tape::
+Tape::Ref::size() const {
+    if (!compound()) {
+        throw std::runtime_error ("Not a compound value");
+    }
+
+    return word (1);
+}
+
+/******************************************************************************/
+
+amqp::internal::tape::Tape::Ref
+amqp::internal::tape::
+Tape::Ref::operator[] (std::string_view key_) const {
+    if (type() != object_t) {
+        throw std::runtime_error ("Not an object");
+    }
+
+    const auto last = end();
+
+    for (auto it = begin() ; it != last ; ) {
+        auto value = it.next();
+
+        if (it.text() == key_) {
+            return value;
+        }
+
+        it = value.next();
+    }
+
+    return last;
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::tape::
+Tape::Ref::boolean() const {
+    if (type() != bool_t) {
+        throw std::runtime_error ("Not a boolean");
+    }
+
+    return (word() & PAYLOAD) != 0;
+}
+
+/******************************************************************************/
+
+int64_t
+amqp::internal::tape::
+Tape::Ref::integer() const {
+    if (type() != integer_t) {
+        throw std::runtime_error ("Not an integer");
+    }
+
+    return static_cast<int64_t>(word (1));
+}
+
+/******************************************************************************/
+
+double
+amqp::internal::tape::
+Tape::Ref::real() const {
+    if (type() != real_t) {
+        throw std::runtime_error ("Not a real");
+    }
+
+    uint64_t bits = word (1);
+    double rtn;
+    std::memcpy (&rtn, &bits, sizeof (rtn));
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+std::string_view
+amqp::internal::tape::
+Tape::Ref::text() const {
+    switch (type()) {
+        case key_t : case string_t : case symbol_t : case binary_t : break;
+        default : throw std::runtime_error ("Not text");
+    }
+
+    uint64_t offset, length;
+
+    if ((word() >> TYPE_SHIFT) == absent_t) {
+        offset = word() & KEY_OFFSET;
+        length = (word() & PAYLOAD) >> KEY_SHIFT;
+    } else {
+        offset = word() & PAYLOAD;
+        length = word (1);
+    }
+
+    if (offset < m_tape->m_size) {
+        if (length > m_tape->m_size - offset) Tape::corrupt();
+
+        return { m_tape->m_blob + offset, length };
+    }
+
+    const auto copied = m_tape->copied();
+
+    if (offset - m_tape->m_size > copied.size() || length > copied.size() - (offset - m_tape->m_size)) {
+        Tape::corrupt();
+    }
+
+    return { copied.data() + (offset - m_tape->m_size), length };
+}
+
+/******************************************************************************/
+
+bool
+amqp::internal::tape::
+Tape::Ref::hashed() const {
+    return m_tape->find (m_index) != nullptr;
+}
+
+/******************************************************************************/
+
+amqp::internal::cursor::Hash
+amqp::internal::tape::
+Tape::Ref::hash() const {
+    const auto * rtn = m_tape->find (m_index);
+
+    if (!rtn) throw std::runtime_error ("Not a hashed object");
+
+    return *rtn;
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::tape::Tape::Paths
+ *
+ ******************************************************************************/
+
+amqp::internal::tape::
+Tape::Paths::Paths (const std::vector<std::string> & paths_)
+    : m_root { { }, paths_.empty(), { } }
+{
+    for (const auto & path : paths_) {
+        auto * node = &m_root;
+
+        for (size_t i { 0 } ; !node->m_whole ; ) {
+            auto end = std::min (path.find ('.', i), path.size());
+
+            if (end == i) throw std::runtime_error ("Bad path \"" + path + "\"");
+
+            auto name = path.substr (i, end - i);
+
+            auto it = std::find_if (node->m_fields.begin(), node->m_fields.end(), [&name](const Node & n_) {
+                return n_.m_name == name;
+            });
+
+            if (it == node->m_fields.end()) {
+                node->m_fields.push_back ({ name, false, { } });
+                it = std::prev (node->m_fields.end());
+            }
+
+            node = &*it;
+
+            // a path ending here takes the whole field, whatever else was asked of it
+            if (end == path.size()) {
+                node->m_whole = true;
+                node->m_fields.clear();
+            }
+
+            i = end + 1;
+        }
+    }
+}
+
+/******************************************************************************
+ *
+ * amqp::internal::tape::Tape
+ *
+ ******************************************************************************/
+
+amqp::internal::tape::
+Tape::Tape (const char * blob_, size_t size_)
+    : m_mapped (nullptr)
+    , m_count (0)
+    , m_indexed (nullptr)
+    , m_indexes (0)
+    , m_blob (blob_)
+    , m_size (size_)
+{
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::tape::
+Tape::corrupt() {
+    throw std::runtime_error ("Corrupt tape");
+}
+
+/******************************************************************************/
+
+const amqp::internal::cursor::Hash *
+amqp::internal::tape::
+Tape::find (size_t index_) const {
+    if (!m_mapped) {
+        auto it = m_hashes.find (index_);
+        return it == m_hashes.end() ? nullptr : &it->second;
+    }
+
+    const auto * end = m_indexed + m_indexes;
+    const auto * it = std::lower_bound (m_indexed, end, index_, [](const Indexed & i_, size_t index_) {
+        return i_.m_index < index_;
+    });
+
+    return it == end || it->m_index != index_ ? nullptr : &it->m_hash;
+}
+
+/******************************************************************************/
+
+std::vector<amqp::internal::tape::Tape::Indexed>
+amqp::internal::tape::
+Tape::hashes() const {
+    if (m_mapped) return { m_indexed, m_indexed + m_indexes };
+
+    std::vector<Indexed> rtn;
+    rtn.reserve (m_hashes.size());
+
+    for (const auto & hash : m_hashes) {
+        rtn.push_back ({ hash.first, hash.second });
+    }
+
+    std::sort (rtn.begin(), rtn.end(), [](const Indexed & lhs_, const Indexed & rhs_) {
+        return lhs_.m_index < rhs_.m_index;
+    });
+
+    return rtn;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::tape::
+Tape::map (
+    const uint64_t * words_,
+    size_t count_,
+    std::string_view copied_,
+    const Indexed * hashes_,
+    size_t indexes_
+) {
+    clear();
+
+    m_mapped = words_;
+    m_count = count_;
+    m_copy = copied_;
+    m_indexed = hashes_;
+    m_indexes = indexes_;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::tape::
+Tape::clear() {
+    m_words.clear();
+    m_text.clear();
+    m_hashes.clear();
+
+    m_mapped = nullptr;
+    m_count = 0;
+    m_copy = { };
+    m_indexed = nullptr;
+    m_indexes = 0;
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::tape::
+Tape::write (amqp::reader::ISink & sink_) const {
+    for (auto it = begin() ; it != end() ; it = it.next()) {
+        write (it, sink_);
+    }
+}
+
+/******************************************************************************/
+
+/*
+ * Compounds are replayed by walking their tokens in order, the end of
+ * each finding what it closes from the open it points back to.
+ */
+void
+amqp::internal::tape::
+Tape::write (const Ref & ref_, amqp::reader::ISink & sink_) const {
+    const auto last = ref_.next();
+
+    for (auto token = ref_ ; token != last ; ) {
+        // a walk past the end of a corrupt tape never reaches [last]
+        if (token.index() > last.index()) corrupt();
+
+        switch (token.type()) {
+            case object_t : sink_.beginObject(); token = Ref (*this, token.index() + 2); continue;
+            case list_t   : sink_.beginList(); token = Ref (*this, token.index() + 2); continue;
+            case map_t    : sink_.beginMap(); token = Ref (*this, token.index() + 2); continue;
+            case end_t    : {
+                Ref open (*this, word (token.index()) & PAYLOAD);
+
+                switch (open.type()) {
+                    case object_t : {
+                        if (sink_.hashes() && open.hashed()) {
+                            auto hash = open.hash();
+                            sink_.hash (hash.m_low, hash.m_high);
+                        }
+
+                        sink_.endObject();
+                        break;
+                    }
+                    case list_t   : sink_.endList(); break;
+                    default       : sink_.endMap(); break;
+                }
+                break;
+            }
+            case key_t     : sink_.key (token.text()); break;
+            case null_t    : sink_.null(); break;
+            case bool_t    : sink_.boolean (token.boolean()); break;
+            case integer_t : sink_.integer (token.integer()); break;
+            case real_t    : sink_.real (token.real()); break;
+            case string_t  : sink_.string (token.text()); break;
+            case symbol_t  : sink_.symbol (token.text()); break;
+            case binary_t  : sink_.binary (token.text()); break;
+            default : throw std::runtime_error ("Corrupt tape");
+        }
+
+        token = token.next();
+    }
+}
+
+/******************************************************************************/
+
+void
+amqp::internal::tape::
+Tape::project (const Ref & ref_, const Paths & paths_, amqp::reader::ISink & sink_) const {
+    project (ref_, paths_.m_root, sink_);
+}
+
+/******************************************************************************/
+
+/*
+ * Whatever a path can't run on through, a null in place of a composite
+ * say, is written as it is
+ */
+void
+amqp::internal::tape::
+Tape::project (const Ref & ref_, const Paths::Node & node_, amqp::reader::ISink & sink_) const {
+    if (node_.m_whole) {
+        write (ref_, sink_);
+        return;
+    }
+
+    switch (ref_.type()) {
+        case object_t : {
+            sink_.beginObject();
+
+            const auto last = ref_.end();
+
+            for (auto it = ref_.begin() ; it != last ; ) {
+                auto value = it.next();
+                auto name = it.text();
+
+                auto field = std::find_if (node_.m_fields.begin(), node_.m_fields.end(), [&name](const auto & n_) {
+                    return n_.m_name == name;
+                });
+
+                if (field != node_.m_fields.end()) {
+                    sink_.key (name);
+                    project (value, *field, sink_);
+                }
+
+                it = value.next();
+            }
+
+            sink_.endObject();
+            break;
+        }
+        case list_t : {
+            sink_.beginList();
+
+            const auto last = ref_.end();
+
+            for (auto it = ref_.begin() ; it != last ; it = it.next()) {
+                project (it, node_, sink_);
+            }
+
+            sink_.endList();
+            break;
+        }
+        default :
+            write (ref_, sink_);
+            break;
+    }
+}
+
+/******************************************************************************/
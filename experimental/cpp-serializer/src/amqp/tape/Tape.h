@@ -0,0 +1,329 @@
+#pragma once
+
+/******************************************************************************/
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+namespace amqp::reader {
+
+    class ISink;
+
+}
+
+namespace amqp::internal::sink {
+
+    class TapeSink;
+
+}
+
+namespace amqp::internal::tape {
+
+    class Index;
+
+}
+
+/******************************************************************************
+ *
+ * class amqp::internal::tape::Tape
+ *
+ ******************************************************************************/
+
+namespace amqp::internal::tape {
+
+    /**
+     * The tokens [ISink] sees, laid end to end in a single array of 64 bit
+     * words rather than as a tree of [IValue]s. Each token is a word whose
+     * top byte is its [Type] and the rest a payload, some tokens taking a
+     * second word
+     *
+     *   object, list, map - the index of the matching end, then the
+     *                       number of values directly inside
+     *   end               - the index of the matching open
+     *   key, string,
+     *   symbol, binary    - the offset of the text, then its length
+     *   integer, real     - nothing, then the value itself
+     *   boolean           - the value
+     *   null              - nothing
+     *   absent            - a key and a null both, the key's length in
+     *                       the payload's top 16 bits and its offset in
+     *                       the rest
+     *
+     * An optional field that's unset, a key followed by a null, is the
+     * commonest thing in a sparse state so it's packed in one word rather
+     * than three. Walked, an absent is the key then the null just as they
+     * would have been written, only [Ref::index] telling them apart from
+     * the tokens they stand in for.
+     *
+     * Text that lies within the blob the tape was built from is referred
+     * to by its offset into that blob, which must therefore outlive the
+     * tape. Anything else is copied to the end of a side buffer and its
+     * offset is past the end of the blob.
+     *
+     * Since every open knows where it ends, skipping a value, however
+     * large, is a single jump. Rendering is a linear walk and freeing the
+     * whole thing a couple of deallocations.
+     *
+     * Built by a [TapeSink] that asked for them, objects also carry their
+     * structural hash, kept apart from the tokens.
+     *
+     * Rather than owning its tokens a tape can be [map]ped onto ones held
+     * elsewhere, a file saved earlier say, and queried just the same
+     * without anything being decoded or copied. Since those might have
+     * been corrupted each token of a mapped tape is checked as it's
+     * reached, a walk that would run off the end of the tape, or a
+     * string off the end of its text, throwing instead.
+     */
+    class Tape {
+        public :
+            enum Type : uint8_t {
+                object_t = '{',
+                list_t   = '[',
+                map_t    = '(',
+                end_t    = ')',
+                key_t    = 'k',
+                null_t   = 'n',
+                bool_t   = 'b',
+                integer_t = 'i',
+                real_t   = 'd',
+                string_t = 's',
+                symbol_t = 'e',
+                binary_t = 'x',
+                absent_t = 'a'
+            };
+
+            static constexpr int KEY_SHIFT = 40;
+            static constexpr uint64_t KEY_OFFSET = (uint64_t { 1 } << KEY_SHIFT) - 1;
+
+            /**
+             * A position on the tape, refers to the tape rather than
+             * owning anything so is cheap to copy about
+             */
+            class Ref {
+                private :
+                    const Tape * m_tape;
+                    size_t m_index;
+
+                    /**
+                     * At an absent, whether this is its null rather than
+                     * its key
+                     */
+                    bool m_null;
+
+                    uint64_t word (size_t n_ = 0) const;
+
+                    Ref (const Tape & tape_, size_t index_, bool null_)
+                        : m_tape (&tape_)
+                        , m_index (index_)
+                        , m_null (null_)
+                    { }
+
+                    friend class Tape;
+                    friend class Index;
+
+                public :
+                    Ref (const Tape & tape_, size_t index_)
+                        : m_tape (&tape_)
+                        , m_index (index_)
+                        , m_null (false)
+                    { }
+
+                    Type type() const;
+
+                    size_t index() const { return m_index; }
+
+                    bool compound() const;
+
+                    /**
+                     * The token after this one's value, children and all
+                     */
+                    Ref next() const;
+
+                    /**
+                     * Iterate the values directly inside a compound, for
+                     * an object each value is preceded by its key
+                     */
+                    Ref begin() const;
+                    Ref end() const;
+
+                    /**
+                     * The number of values inside a compound, excluding
+                     * an object's keys and counting a map's keys and
+                     * values separately
+                     */
+                    size_t size() const;
+
+                    /**
+                     * The value of an object's field, an end ref if there
+                     * is no such field.
+                     */
+                    Ref operator[] (std::string_view) const;
+
+                    bool boolean() const;
+                    int64_t integer() const;
+                    double real() const;
+
+                    /**
+                     * Keys, strings, symbols and the bytes of binaries
+                     */
+                    std::string_view text() const;
+
+                    /**
+                     * The structural hash of an object, which it only has
+                     * if the tape was built with them, see [hashed]
+                     */
+                    bool hashed() const;
+                    cursor::Hash hash() const;
+
+                    bool operator== (const Ref & rhs_) const {
+                        return m_tape == rhs_.m_tape && m_index == rhs_.m_index && m_null == rhs_.m_null;
+                    }
+
+                    bool operator!= (const Ref & rhs_) const {
+                        return !(*this == rhs_);
+                    }
+            };
+
+            /**
+             * An object's hash as a mapped tape holds them, ordered by the
+             * index of the object
+             */
+            struct Indexed {
+                uint64_t m_index;
+                cursor::Hash m_hash;
+            };
+
+            /**
+             * Dotted field paths, "amount.quantity" say, to [project]. As
+             * with [amqp::internal::reader::Projection] a path runs
+             * through lists, selecting the field from each element, and
+             * the last field of a path is written in full. No paths at
+             * all selects everything
+             */
+            class Paths {
+                private :
+                    struct Node {
+                        std::string m_name;
+                        bool m_whole;
+                        std::vector<Node> m_fields;
+                    };
+
+                    Node m_root;
+
+                    friend class Tape;
+
+                public :
+                    explicit Paths (const std::vector<std::string> &);
+            };
+
+        private :
+            std::vector<uint64_t> m_words;
+            std::string m_text;
+
+            /**
+             * Keyed on the index of the object each is the hash of
+             */
+            std::unordered_map<size_t, cursor::Hash> m_hashes;
+
+            /**
+             * Either null, the tape owning its tokens, or what it's been
+             * mapped onto in place of [m_words], [m_text] and [m_hashes]
+             */
+            const uint64_t * m_mapped;
+            size_t m_count;
+            std::string_view m_copy;
+            const Indexed * m_indexed;
+            size_t m_indexes;
+
+            const char * m_blob;
+            size_t m_size;
+
+            friend class amqp::internal::sink::TapeSink;
+
+            [[noreturn]] static void corrupt();
+
+            uint64_t word (size_t i_) const {
+                if (!m_mapped) return m_words[i_];
+                if (i_ >= m_count) corrupt();
+
+                return m_mapped[i_];
+            }
+
+            const cursor::Hash * find (size_t index_) const;
+
+            void project (const Ref &, const Paths::Node &, amqp::reader::ISink &) const;
+
+        public :
+            static constexpr int TYPE_SHIFT = 56;
+            static constexpr uint64_t PAYLOAD = (uint64_t { 1 } << TYPE_SHIFT) - 1;
+
+            Tape (const char * blob_, size_t size_);
+
+            Ref begin() const { return Ref (*this, 0); }
+            Ref end() const { return Ref (*this, size()); }
+
+            bool empty() const { return size() == 0; }
+
+            /**
+             * The tokens' words
+             */
+            const uint64_t * data() const { return m_mapped ? m_mapped : m_words.data(); }
+            size_t size() const { return m_mapped ? m_count : m_words.size(); }
+
+            /**
+             * The text that isn't in the blob, at offsets from its end
+             */
+            std::string_view copied() const { return m_mapped ? m_copy : std::string_view (m_text); }
+
+            std::string_view blob() const { return { m_blob, m_size }; }
+
+            /**
+             * Every object's hash, in order of the object's index
+             */
+            std::vector<Indexed> hashes() const;
+
+            /**
+             * Refer to [words_], [copied_] and [hashes_] rather than to
+             * anything of the tape's own, all of which must outlive it
+             * and none of which are copied. Whatever the tape held is
+             * dropped
+             */
+            void map (
+                const uint64_t * words_,
+                size_t count_,
+                std::string_view copied_,
+                const Indexed * hashes_,
+                size_t indexes_);
+
+            void clear();
+
+            /**
+             * Replay the tape's tokens into [sink_], along with the hash
+             * of each object if it has them and the sink wants them
+             */
+            void write (amqp::reader::ISink & sink_) const;
+
+            /**
+             * Replay just the value at [ref_]
+             */
+            void write (const Ref & ref_, amqp::reader::ISink & sink_) const;
+
+            /**
+             * Replay just the fields of the value at [ref_] named by
+             * [paths_], as [amqp::internal::reader::Projection::write]
+             * would have decoded them. Fields the value hasn't got are
+             * left out
+             */
+            void project (const Ref & ref_, const Paths & paths_, amqp::reader::ISink & sink_) const;
+    };
+
+}
+
+/******************************************************************************/
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "Reader.h"
+#include "reader/Arena.h"
+
+/******************************************************************************/
+
+using namespace amqp::reader;
+using namespace amqp::internal::reader;
+
+/******************************************************************************/
+
+TEST (Arena, scoped) { // NOLINT
+    Arena arena (256);
+
+    EXPECT_EQ (nullptr, Arena::current());
+
+    {
+        Arena::Scope scope (arena);
+        EXPECT_EQ (&arena, Arena::current());
+
+        sVec<uPtr<IValue>> values;
+        for (int i { 0 } ; i < 100 ; ++i) {
+            values.emplace_back (std::make_unique<TypedSingle<int>> (i));
+        }
+
+        EXPECT_EQ (100U, arena.live());
+        EXPECT_LT (256U, arena.allocated());
+
+        auto pair = std::make_unique<TypedPair<sVec<uPtr<IValue>>>> (
+                "a", std::move (values));
+
+        EXPECT_EQ ("a : { 0, 1, 2", pair->dump().substr (0, 13));
+        EXPECT_EQ (101U, arena.live());
+    }
+
+    EXPECT_EQ (nullptr, Arena::current());
+    EXPECT_EQ (0U, arena.live());
+
+    auto spilled = arena.allocated();
+    arena.reset();
+    EXPECT_EQ (0U, arena.allocated());
+
+    {
+        // the second time round everything fits in the arena's own buffer
+        Arena::Scope scope (arena);
+        auto v = std::make_unique<TypedSingle<std::string>> ("hello");
+        EXPECT_EQ ("hello", v->dump());
+        EXPECT_EQ (1U, arena.live());
+        EXPECT_GT (spilled, arena.allocated());
+    }
+
+    arena.reset();
+}
+
+/******************************************************************************/
+
+TEST (Arena, nested) { // NOLINT
+    Arena outer;
+    Arena inner;
+
+    Arena::Scope s1 (outer);
+    {
+        Arena::Scope s2 (inner);
+        auto v = std::make_unique<TypedSingle<int>> (1);
+        EXPECT_EQ (0U, outer.live());
+        EXPECT_EQ (1U, inner.live());
+    }
+
+    EXPECT_EQ (&outer, Arena::current());
+
+    auto v = std::make_unique<TypedSingle<int>> (2);
+    EXPECT_EQ (1U, outer.live());
+}
+
+/******************************************************************************/
+
+TEST (Arena, heap) { // NOLINT
+    // without a scope values come off the heap as they always did
+    auto v = std::make_unique<TypedSingle<int>> (3);
+    EXPECT_EQ ("3", v->dump());
+}
+
+/******************************************************************************/
+
+/**
+ * Arenas take their memory from whatever upstream they were built with
+ */
+TEST (Arena, upstream) { // NOLINT
+    struct Counting : std::pmr::memory_resource {
+        size_t m_allocated { 0 };
+
+        void * do_allocate (size_t size_, size_t align_) override {
+            m_allocated += size_;
+            return std::pmr::new_delete_resource()->allocate (size_, align_);
+        }
+
+        void do_deallocate (void * p_, size_t size_, size_t align_) override {
+            std::pmr::new_delete_resource()->deallocate (p_, size_, align_);
+        }
+
+        bool do_is_equal (const std::pmr::memory_resource & other_) const noexcept override {
+            return this == &other_;
+        }
+    } counting;
+
+    EXPECT_EQ (std::pmr::new_delete_resource(), Arena::upstream());
+
+    Arena::upstream (&counting);
+    {
+        Arena arena (256);
+        EXPECT_LE (256U, counting.m_allocated);
+
+        {
+            Arena::Scope scope (arena);
+
+            sVec<uPtr<IValue>> values;
+            for (int i { 0 } ; i < 100 ; ++i) {
+                values.emplace_back (std::make_unique<TypedSingle<int>> (i));
+            }
+        }
+
+        // spilt past its buffer, then grown to fit, still upstream
+        auto spilt = counting.m_allocated;
+        EXPECT_LT (256U + arena.allocated() / 2, spilt);
+
+        arena.reset();
+        EXPECT_LT (spilt, counting.m_allocated);
+    }
+    Arena::upstream (nullptr);
+
+    EXPECT_EQ (std::pmr::new_delete_resource(), Arena::upstream());
+}
+
+/******************************************************************************/
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+#include "cursor/Bulk.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::cursor;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<unsigned char> bytes_) {
+        return std::string (bytes_.begin(), bytes_.end());
+    }
+
+    void
+    be (std::string & out_, uint64_t v_, size_t width_) {
+        for (size_t i { width_ } ; i > 0 ; --i) {
+            out_ += static_cast<char> (v_ >> (8 * (i - 1)));
+        }
+    }
+
+    /**
+     * An array32 of [values_] sharing constructor [code_]
+     */
+    template<typename T>
+    std::string
+    array (uint8_t code_, const std::vector<T> & values_) {
+        std::string body;
+        be (body, values_.size(), 4);
+        body += static_cast<char> (code_);
+
+        for (auto v : values_) {
+            uint64_t bits { 0 };
+            std::memcpy (&bits, &v, sizeof (v));
+            be (body, bits, sizeof (v));
+        }
+
+        std::string rtn (1, '\xf0');
+        be (rtn, body.size(), 4);
+
+        return rtn + body;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Lists, each element carrying its own constructor, may mix encodings
+ */
+TEST (Bulk, ints) { // NOLINT
+    auto b = bytes ({
+        0xc0, 0x0a, 0x03,
+        0x54, 0xfe,                     // smallint -2
+        0x71, 0x00, 0x00, 0x01, 0x00,   // int 256
+        0x54, 0x07                      // smallint 7
+    });
+
+    std::vector<int64_t> out;
+
+    ASSERT_TRUE (readInts (b, out));
+    EXPECT_EQ ((std::vector<int64_t> { -2, 256, 7 }), out);
+
+    ASSERT_TRUE (readInts (bytes ({ 0x45 }), out));
+    EXPECT_TRUE (out.empty());
+}
+
+/******************************************************************************/
+
+/**
+ * Enough elements to cover both the vector loop and what's left after it
+ */
+TEST (Bulk, intArray) { // NOLINT
+    std::vector<int32_t> values { 1, -1, 256, -65536, 0x7fffffff, -0x7fffffff - 1, 42 };
+
+    std::vector<int64_t> out;
+
+    ASSERT_TRUE (readInts (array (0x71, values), out));
+    EXPECT_EQ (std::vector<int64_t> (values.begin(), values.end()), out);
+}
+
+/******************************************************************************/
+
+TEST (Bulk, longArray) { // NOLINT
+    std::vector<int64_t> values { 1, -1, 1LL << 40, -(1LL << 40), 5 };
+
+    std::vector<int64_t> out;
+
+    ASSERT_TRUE (readLongs (array (0x81, values), out));
+    EXPECT_EQ (values, out);
+}
+
+/******************************************************************************/
+
+TEST (Bulk, doubleArray) { // NOLINT
+    std::vector<double> values { 10.1, -0.5, 1e300, 0.0, 13.4 };
+
+    std::vector<double> out;
+
+    ASSERT_TRUE (readDoubles (array (0x82, values), out));
+    EXPECT_EQ (values, out);
+}
+
+/******************************************************************************/
+
+/**
+ * Anything else is left to be decoded a node at a time
+ */
+TEST (Bulk, fallBack) { // NOLINT
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+
+    // a null amongst the ints
+    EXPECT_FALSE (readInts (bytes ({ 0xc0, 0x04, 0x02, 0x54, 0x01, 0x40 }), ints));
+
+    // longs aren't ints
+    EXPECT_FALSE (readInts (array (0x81, std::vector<int64_t> { 1 }), ints));
+    EXPECT_FALSE (readLongs (bytes ({ 0xc0, 0x03, 0x01, 0x54, 0x01 }), ints));
+    EXPECT_FALSE (readDoubles (bytes ({ 0xc0, 0x03, 0x01, 0x54, 0x01 }), doubles));
+}
+
+/******************************************************************************/
+
+TEST (Bulk, truncated) { // NOLINT
+    std::vector<int64_t> out;
+
+    auto list = bytes ({ 0xc0, 0x06, 0x02, 0x71, 0x00, 0x00, 0x01, 0x00, 0x71, 0x00 });
+    EXPECT_THROW (readInts (list, out), std::runtime_error); // NOLINT
+
+    auto packed = array (0x71, std::vector<int32_t> { 1, 2, 3 });
+    packed.resize (packed.size() - 1);
+    EXPECT_THROW (readInts (packed, out), std::runtime_error); // NOLINT
+
+    EXPECT_THROW (readInts (bytes ({ 0xa1, 0x00 }), out), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
+
+/**
+ * A count the bytes couldn't hold is refused before anything is sized
+ * by it
+ */
+TEST (Bulk, hostileCount) { // NOLINT
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+
+    auto ints32 = bytes ({
+            0xf0, 0x00, 0x00, 0x00, 0x0a, 0xff, 0xff, 0xff, 0xff, 0x71,
+            0x00, 0x00, 0x00, 0x01, 0x00 });
+
+    EXPECT_THROW (readInts (ints32, ints), std::runtime_error); // NOLINT
+
+    auto bytes8 = bytes ({ 0xe0, 0x03, 0xff, 0x51, 0x01 });
+
+    EXPECT_THROW (readInts (bytes8, ints), std::runtime_error); // NOLINT
+
+    auto list = bytes ({ 0xd0, 0x00, 0x00, 0x00, 0x06, 0xff, 0xff, 0xff, 0xff, 0x54, 0x01 });
+
+    EXPECT_THROW (readLongs (list, ints), std::runtime_error); // NOLINT
+    EXPECT_THROW (readDoubles (list, doubles), std::runtime_error); // NOLINT
+
+    // an encoding taking no bytes isn't wanted, and isn't reserved for
+    auto nulls = bytes ({ 0xf0, 0x00, 0x00, 0x00, 0x05, 0xff, 0xff, 0xff, 0xff, 0x40 });
+
+    EXPECT_FALSE (readInts (nulls, ints));
+    EXPECT_LE (ints.capacity(), nulls.size());
+}
+
+/******************************************************************************/
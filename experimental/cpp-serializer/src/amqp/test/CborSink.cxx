@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <limits>
+#include <stdexcept>
+
+#include "sink/CborSink.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::sink;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<int> bytes_) {
+        std::string rtn;
+        for (auto b : bytes_) rtn.push_back (static_cast<char> (b));
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * Examples from RFC 8949's appendix A
+ */
+TEST (CborSink, scalars) { // NOLINT
+    auto encode = [](auto write_) {
+        std::string out;
+        {
+            CborSink sink (out);
+            write_ (sink);
+        }
+        return out;
+    };
+
+    EXPECT_EQ (bytes ({ 0x00 }), encode ([](CborSink & s_) { s_.integer (0); }));
+    EXPECT_EQ (bytes ({ 0x17 }), encode ([](CborSink & s_) { s_.integer (23); }));
+    EXPECT_EQ (bytes ({ 0x18, 0x18 }), encode ([](CborSink & s_) { s_.integer (24); }));
+    EXPECT_EQ (bytes ({ 0x19, 0x03, 0xe8 }), encode ([](CborSink & s_) { s_.integer (1000); }));
+    EXPECT_EQ (bytes ({ 0x1a, 0x00, 0x0f, 0x42, 0x40 }), encode ([](CborSink & s_) { s_.integer (1000000); }));
+    EXPECT_EQ (
+        bytes ({ 0x1b, 0x00, 0x00, 0x00, 0xe8, 0xd4, 0xa5, 0x10, 0x00 }),
+        encode ([](CborSink & s_) { s_.integer (1000000000000); }));
+
+    EXPECT_EQ (bytes ({ 0x20 }), encode ([](CborSink & s_) { s_.integer (-1); }));
+    EXPECT_EQ (bytes ({ 0x38, 0x63 }), encode ([](CborSink & s_) { s_.integer (-100); }));
+    EXPECT_EQ (
+        bytes ({ 0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }),
+        encode ([](CborSink & s_) { s_.integer (std::numeric_limits<int64_t>::min()); }));
+
+    EXPECT_EQ (bytes ({ 0xfa, 0x47, 0xc3, 0x50, 0x00 }), encode ([](CborSink & s_) { s_.real (100000.0); }));
+    EXPECT_EQ (
+        bytes ({ 0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a }),
+        encode ([](CborSink & s_) { s_.real (1.1); }));
+    EXPECT_EQ (bytes ({ 0xf9, 0x7e, 0x00 }), encode ([](CborSink & s_) { s_.real (std::nan ("")); }));
+
+    EXPECT_EQ (bytes ({ 0xf4 }), encode ([](CborSink & s_) { s_.boolean (false); }));
+    EXPECT_EQ (bytes ({ 0xf5 }), encode ([](CborSink & s_) { s_.boolean (true); }));
+    EXPECT_EQ (bytes ({ 0xf6 }), encode ([](CborSink & s_) { s_.null(); }));
+
+    EXPECT_EQ (bytes ({ 0x64, 'I', 'E', 'T', 'F' }), encode ([](CborSink & s_) { s_.string ("IETF"); }));
+    EXPECT_EQ (bytes ({ 0x61, 'A' }), encode ([](CborSink & s_) { s_.symbol ("A"); }));
+    EXPECT_EQ (
+        bytes ({ 0x44, 0x01, 0x02, 0x03, 0x04 }),
+        encode ([](CborSink & s_) { s_.binary (bytes ({ 1, 2, 3, 4 })); }));
+}
+
+/******************************************************************************/
+
+TEST (CborSink, compounds) { // NOLINT
+    std::string out;
+    {
+        CborSink sink (out, 4);
+
+        sink.beginObject();
+        sink.key ("a");
+        sink.integer (1);
+        sink.key ("b");
+        sink.beginList();
+        int64_t run[] { 2, 3 };
+        sink.integers (run, 2);
+        sink.endList();
+        sink.key ("c");
+        sink.beginMap();
+        sink.beginList();
+        sink.endList();
+        sink.string ("x");
+        sink.endMap();
+        sink.endObject();
+
+        // a second top level value follows straight on
+        sink.integer (4);
+    }
+
+    EXPECT_EQ (bytes ({
+        0xbf,
+            0x61, 'a', 0x01,
+            0x61, 'b', 0x9f, 0x02, 0x03, 0xff,
+            0x61, 'c', 0xbf, 0x9f, 0xff, 0x61, 'x', 0xff,
+        0xff,
+        0x04 }), out);
+}
+
+/******************************************************************************/
+
+TEST (CborSink, mismatched) { // NOLINT
+    std::string out;
+
+    {
+        CborSink sink (out);
+        sink.beginObject();
+        EXPECT_THROW (sink.integer (1), std::runtime_error); // NOLINT
+        EXPECT_THROW (sink.endList(), std::runtime_error); // NOLINT
+        sink.key ("a");
+        EXPECT_THROW (sink.endObject(), std::runtime_error); // NOLINT
+    }
+
+    {
+        CborSink sink (out);
+        sink.beginMap();
+        EXPECT_THROW (sink.key ("a"), std::runtime_error); // NOLINT
+        sink.integer (1);
+        EXPECT_THROW (sink.endMap(), std::runtime_error); // NOLINT
+        sink.null();
+        sink.endMap();
+        EXPECT_THROW (sink.endMap(), std::runtime_error); // NOLINT
+    }
+}
+
+/******************************************************************************/
+
+TEST (CborSink, renderedKeys) { // NOLINT
+    std::string name (30, 'x');
+
+    EXPECT_EQ (bytes ({ 0x61, 'a' }), CborSink::render ("a"));
+    EXPECT_EQ (bytes ({ 0x78, 30 }) + name, CborSink::render (name));
+
+    auto rendered = CborSink::render (name);
+
+    std::string copied, named;
+    {
+        CborSink sink (copied);
+        sink.beginObject();
+        sink.key (amqp::reader::ISink::Key { name, { }, rendered });
+        sink.integer (1);
+        sink.endObject();
+    }
+    {
+        CborSink sink (named);
+        sink.beginObject();
+        sink.key (name);
+        sink.integer (1);
+        sink.endObject();
+    }
+
+    EXPECT_EQ (named, copied);
+}
+
+/******************************************************************************/
+
+/**
+ * Each top level value its own namespace, strings written a second time
+ * as references unless too short to be numbered, text and bytes never
+ * confused
+ */
+TEST (CborSink, stringrefs) { // NOLINT
+    std::string out;
+    {
+        CborSink sink (out);
+        sink.stringrefs (true);
+
+        sink.beginList();
+        sink.string ("aaa");
+        sink.symbol ("aaa");
+        sink.string ("bb");
+        sink.string ("bb");
+        sink.binary ("aaa");
+        sink.binary ("aaa");
+        sink.endList();
+
+        sink.string ("aaa");
+    }
+
+    EXPECT_EQ (
+        bytes ({ 0xd9, 0x01, 0x00, 0x9f,
+                 0x63, 'a', 'a', 'a', 0xd8, 0x19, 0x00,
+                 0x62, 'b', 'b', 0x62, 'b', 'b',
+                 0x43, 'a', 'a', 'a', 0xd8, 0x19, 0x01,
+                 0xff,
+                 0xd9, 0x01, 0x00, 0x63, 'a', 'a', 'a' }),
+        out);
+
+    std::string keyed;
+    {
+        CborSink sink (keyed);
+        sink.stringrefs (true);
+
+        auto rendered = CborSink::render ("key");
+
+        sink.beginList();
+        for (int i { 0 } ; i < 2 ; ++i) {
+            sink.beginObject();
+            sink.key (amqp::reader::ISink::Key { "key", { }, rendered });
+            sink.integer (i);
+            sink.endObject();
+        }
+        sink.endList();
+    }
+
+    EXPECT_EQ (
+        bytes ({ 0xd9, 0x01, 0x00, 0x9f,
+                 0xbf, 0x63, 'k', 'e', 'y', 0x00, 0xff,
+                 0xbf, 0xd8, 0x19, 0x00, 0x01, 0xff,
+                 0xff }),
+        keyed);
+}
+
+/******************************************************************************/
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "sink/CsvSink.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::sink;
+
+/******************************************************************************/
+
+TEST (CsvSink, rows) { // NOLINT
+    std::string out;
+    {
+        CsvSink sink (out, { "a", "b.c", "d", "e" });
+
+        for (int i { 0 } ; i < 2 ; ++i) {
+            sink.beginObject();
+            sink.key ("a");
+            sink.integer (i);
+            sink.key ("b");
+            sink.beginObject();
+            sink.key ("c");
+            sink.string (i ? "plain" : "with, \"quotes\"");
+            sink.key ("x");
+            sink.boolean (true);
+            sink.endObject();
+            sink.key ("d");
+            sink.null();
+            sink.endObject();
+        }
+    }
+
+    EXPECT_EQ ("0,\"with, \"\"quotes\"\"\",,\n1,plain,,\n", out);
+}
+
+/******************************************************************************/
+
+TEST (CsvSink, compounds) { // NOLINT
+    std::string out;
+    {
+        CsvSink sink (out, { "list", "map", "after" });
+
+        sink.beginObject();
+        sink.key ("list");
+        sink.beginList();
+        sink.integer (1);
+        sink.beginObject();
+        sink.key ("list");
+        sink.integer (2);
+        sink.endObject();
+        sink.endList();
+        sink.key ("map");
+        sink.beginMap();
+        sink.integer (3);
+        sink.string ("three");
+        sink.endMap();
+        sink.key ("after");
+        sink.real (0.5);
+        sink.endObject();
+    }
+
+    EXPECT_EQ ("\"[1,{\"\"list\"\":2}]\",\"{\"\"3\"\":\"\"three\"\"}\",0.5\n", out);
+}
+
+/******************************************************************************/
+
+TEST (CsvSink, mismatched) { // NOLINT
+    std::string out;
+    CsvSink sink (out, { "a" });
+
+    sink.beginObject();
+    EXPECT_THROW (sink.endList(), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
@@ -0,0 +1,387 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "cursor/Limits.h"
+#include "cursor/Hash.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::cursor;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<unsigned char> bytes_) {
+        return std::string (bytes_.begin(), bytes_.end());
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Cursor, primitives) { // NOLINT
+    auto b = bytes ({
+        0x54, 0xfe,                                     // smallint -2
+        0x71, 0x00, 0x00, 0x01, 0x00,                   // int 256
+        0x53, 0x07,                                     // smallulong 7
+        0x81, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, // long -2
+        0x41,                                           // true
+        0x56, 0x00,                                     // false
+        0x40,                                           // null
+        0xa1, 0x03, 'a', 'b', 'c',                      // str8 "abc"
+        0xa3, 0x02, 'x', 'y'                            // sym8 "xy"
+    });
+
+    Cursor c (b.data(), b.size());
+
+    EXPECT_EQ (int_t, c.type());
+    EXPECT_EQ (-2, c.get_int());
+    EXPECT_EQ (0U, c.offset());
+    EXPECT_EQ (2U, c.encodedSize());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (256, c.get_int());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (ulong_t, c.type());
+    EXPECT_EQ (7U, c.get_ulong());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (long_t, c.type());
+    EXPECT_EQ (-2, c.get_long());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_TRUE (c.get_bool());
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (bool_t, c.type());
+    EXPECT_FALSE (c.get_bool());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (null_t, c.type());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ ("abc", c.get_string());
+    EXPECT_EQ ("", c.get_symbol());
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ ("xy", c.get_symbol());
+
+    EXPECT_FALSE (c.next());
+}
+
+/******************************************************************************/
+
+TEST (Cursor, describedList) { // NOLINT
+    auto b = bytes ({
+        0x00, 0x53, 0x01,                 // described, descriptor 1
+        0xc0, 0x07, 0x03,                 // list8, size 7, 3 elements
+            0x54, 0x01,
+            0x45,                         // list0
+            0xa1, 0x01, 'z',
+        0x54, 0x02
+    });
+
+    Cursor c (b.data(), b.size());
+
+    ASSERT_TRUE (c.is_described());
+    EXPECT_EQ (12U, c.encodedSize());
+
+    {
+        auto_enter ae (c);
+        EXPECT_EQ (1U, c.get_ulong());
+
+        ASSERT_TRUE (c.next());
+        is_list (c);
+        EXPECT_EQ (3U, c.get_list());
+
+        {
+            auto_list_enter ale (c, true);
+            EXPECT_EQ (3U, ale.elements());
+            EXPECT_EQ (2U, c.depth());
+
+            EXPECT_EQ (1, readAndNext<int32_t> (c));
+            EXPECT_EQ (list_t, c.type());
+            EXPECT_EQ (0U, c.get_list());
+
+            {
+                // entering an empty list leaves nothing to visit
+                auto_list_enter ale2 (c);
+                EXPECT_FALSE (c.next());
+            }
+
+            ASSERT_TRUE (c.next());
+            EXPECT_EQ ("z", readAndNext<std::string> (c));
+            EXPECT_FALSE (c.next());
+        }
+
+        EXPECT_FALSE (c.next());
+    }
+
+    EXPECT_EQ (0U, c.depth());
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (2, c.get_int());
+    EXPECT_FALSE (c.next());
+}
+
+/******************************************************************************/
+
+/**
+ * Skipping never enters a node, a compound value being stepped over as a
+ * whole
+ */
+TEST (Cursor, skip) { // NOLINT
+    auto b = bytes ({
+        0x00, 0x53, 0x01,                 // described, descriptor 1
+        0xc0, 0x07, 0x03,                 // list8, size 7, 3 elements
+            0x54, 0x01,
+            0x45,
+            0xa1, 0x01, 'z',
+        0x54, 0x02,
+        0x54, 0x03,
+        0x54, 0x04
+    });
+
+    Cursor c (b.data(), b.size());
+
+    ASSERT_TRUE (c.skip());
+    EXPECT_EQ (0U, c.depth());
+    EXPECT_EQ (12U, c.offset());
+    EXPECT_EQ (2, c.get_int());
+
+    ASSERT_TRUE (c.skip (0));
+    EXPECT_EQ (2, c.get_int());
+
+    ASSERT_TRUE (c.skip (2));
+    EXPECT_EQ (4, c.get_int());
+
+    EXPECT_FALSE (c.skip());
+
+    Cursor c2 (b.data(), b.size());
+    EXPECT_FALSE (c2.skip (5));
+}
+
+/******************************************************************************/
+
+TEST (Cursor, array) { // NOLINT
+    auto b = bytes ({
+        0xe0, 0x05, 0x03, 0x54,           // array8 of 3 smallints
+            0x01, 0x02, 0x03,
+        0xe0, 0x05, 0x02, 0x00, 0x53, 0x09, 0x41, // described bools
+    });
+
+    Cursor c (b.data(), b.size());
+
+    EXPECT_EQ (array_t, c.type());
+    EXPECT_EQ (3U, c.get_array());
+
+    {
+        auto_enter ae (c);
+
+        for (int i { 1 } ; i <= 3 ; ++i) {
+            EXPECT_EQ (int_t, c.type());
+            EXPECT_EQ (i, c.get_int());
+            EXPECT_EQ (1U, c.encodedSize());
+            c.next();
+        }
+    }
+
+    ASSERT_TRUE (c.next());
+    EXPECT_EQ (2U, c.get_array());
+
+    {
+        auto_enter ae (c);
+
+        // the element descriptor is the first child
+        EXPECT_EQ (9U, c.get_ulong());
+
+        ASSERT_TRUE (c.next());
+        EXPECT_TRUE (c.get_bool());
+        ASSERT_TRUE (c.next());
+        EXPECT_TRUE (c.get_bool());
+        EXPECT_FALSE (c.next());
+    }
+
+    EXPECT_FALSE (c.next());
+}
+
+/******************************************************************************/
+
+TEST (Cursor, map) { // NOLINT
+    auto b = bytes ({
+        0xc1, 0x09, 0x04,
+            0x54, 0x01, 0xa1, 0x01, 'a',
+            0x54, 0x02, 0x40
+    });
+
+    Cursor c (b.data(), b.size());
+
+    EXPECT_EQ (map_t, c.type());
+
+    auto_map_enter ame (c, true);
+
+    EXPECT_EQ (4U, ame.elements());
+    EXPECT_EQ (1, readAndNext<int32_t> (c));
+    EXPECT_EQ ("a", readAndNext<std::string> (c));
+    EXPECT_EQ (2, readAndNext<int32_t> (c));
+    EXPECT_EQ ("", readAndNext<std::string> (c, true));
+}
+
+/******************************************************************************/
+
+TEST (Cursor, errors) { // NOLINT
+    {
+        // list claims more bytes than the buffer holds
+        auto b = bytes ({ 0xc0, 0x10, 0x01, 0x54 });
+        Cursor c (b.data(), b.size());
+        EXPECT_THROW (c.enter(), std::runtime_error);
+    }
+
+    {
+        // string longer than the buffer
+        auto b = bytes ({ 0xa1, 0x04, 'a' });
+        Cursor c (b.data(), b.size());
+        EXPECT_THROW (c.get_string(), std::runtime_error);
+        EXPECT_THROW (c.next(), std::runtime_error);
+    }
+
+    {
+        auto b = bytes ({ 0x54, 0x01 });
+        Cursor c (b.data(), b.size());
+        EXPECT_THROW (is_list (c), std::runtime_error);
+        EXPECT_THROW (readAndNext<std::string> (c), std::runtime_error);
+    }
+
+    {
+        // list claims more elements than it has bytes
+        auto b = bytes ({ 0xc0, 0x02, 0xff, 0x40 });
+        Cursor c (b.data(), b.size());
+        EXPECT_THROW (c.enter(), std::runtime_error);
+    }
+}
+
+/******************************************************************************/
+
+TEST (Cursor, limits) { // NOLINT
+    auto b = bytes ({
+        0xc0, 0x0a, 0x02,                               // list8 of 2
+        0xc0, 0x02, 0x01, 0x40,                         //   list8 [ null ]
+        0xa1, 0x03, 'a', 'b', 'c'                       //   str8 "abc"
+    });
+
+    auto walk = [&b]() {
+        Cursor c (b.data(), b.size());
+        auto_list_enter outer (c, true);
+        auto_list_enter inner (c, true);
+        c.exit();
+        c.next();
+        return c.get_string();
+    };
+
+    auto kind = [&walk](const Limits & limits_) {
+        Limits::Scope scope (limits_);
+
+        try {
+            walk();
+        } catch (const Limits::Exceeded & e) {
+            return static_cast<int> (e.kind());
+        }
+
+        return -1;
+    };
+
+    EXPECT_EQ ("abc", walk());
+
+    EXPECT_EQ (-1, kind (Limits().set (Limits::depth_t, 2).set (Limits::elements_t, 3).set (Limits::strings_t, 3)));
+    EXPECT_EQ (Limits::depth_t, kind (Limits().set (Limits::depth_t, 1)));
+    EXPECT_EQ (Limits::elements_t, kind (Limits().set (Limits::elements_t, 2)));
+    EXPECT_EQ (Limits::strings_t, kind (Limits().set (Limits::strings_t, 2)));
+
+    // nothing outside a scope is counted
+    EXPECT_EQ ("abc", walk());
+
+    auto parsed = Limits::parse ("depth=64,strings=16m,arena=1k");
+    EXPECT_EQ (64U, parsed.get (Limits::depth_t));
+    EXPECT_EQ (SIZE_MAX, parsed.get (Limits::elements_t));
+    EXPECT_EQ (16U << 20U, parsed.get (Limits::strings_t));
+    EXPECT_EQ (1024U, parsed.get (Limits::arena_t));
+
+    EXPECT_THROW (Limits::parse ("depth"), std::runtime_error);
+    EXPECT_THROW (Limits::parse ("depth=x"), std::runtime_error);
+    EXPECT_THROW (Limits::parse ("width=1"), std::runtime_error);
+}
+
+/******************************************************************************/
+
+TEST (Cursor, validate) { // NOLINT
+    auto check = [](const std::string & b_) {
+        return validate (b_.data(), b_.size());
+    };
+
+    auto good = bytes ({
+        0x00, 0xa3, 0x01, 'x',                          // described by sym8 "x"
+        0xc0, 0x0a, 0x02,                               //   list8 of 2
+        0xc1, 0x04, 0x02, 0x54, 0x01, 0x40,             //     map8 { 1 : null }
+        0xa1, 0x01, 'a'                                 //     str8 "a"
+    });
+
+    EXPECT_TRUE (check (good));
+    EXPECT_TRUE (check ({ }));
+    EXPECT_FALSE (check (good).m_error);
+
+    auto truncated = check (good.substr (0, good.size() - 1));
+    EXPECT_FALSE (truncated);
+    EXPECT_EQ (5U, truncated.m_offset);
+    EXPECT_EQ ("AMQP stream truncated at byte 5", truncated.message());
+
+    // 0x01 isn't a constructor
+    EXPECT_FALSE (check (bytes ({ 0xc0, 0x02, 0x01, 0x01 })));
+
+    // list8 claiming more elements than it has bytes
+    EXPECT_FALSE (check (bytes ({ 0xc0, 0x02, 0xff, 0x40 })));
+
+    // map8 of a key without its value
+    EXPECT_FALSE (check (bytes ({ 0xc1, 0x02, 0x01, 0x40 })));
+
+    // a huge array of nulls takes no bytes and is fine, of ints it isn't
+    EXPECT_TRUE (check (bytes ({ 0xf0, 0x00, 0x00, 0x00, 0x05, 0x7f, 0xff, 0xff, 0xff, 0x40 })));
+    EXPECT_FALSE (check (bytes ({ 0xf0, 0x00, 0x00, 0x00, 0x05, 0x7f, 0xff, 0xff, 0xff, 0x71 })));
+
+    // described nodes nested past all reason
+    std::string deep (10000, '\0');
+    deep += '\x40';
+    EXPECT_FALSE (check (deep));
+}
+
+/******************************************************************************/
+
+TEST (Cursor, hash) { // NOLINT
+    std::string bytes;
+    for (int i { 0 } ; i < 100 ; ++i) bytes += static_cast<char> (i * 7);
+
+    const auto whole = hash (bytes);
+
+    // however the bytes are split between updates
+    for (size_t split : { 0, 1, 15, 16, 17, 50, 99 }) {
+        Hasher hasher;
+        hasher.update (bytes.data(), split).update (bytes.data() + split, bytes.size() - split);
+        EXPECT_EQ (whole, hasher.digest()) << split;
+    }
+
+    EXPECT_NE (whole, hash (bytes.substr (1)));
+    EXPECT_NE (whole, Hasher (1).update (bytes).digest());
+
+    // trailing zeros still count
+    EXPECT_NE (hash (std::string (3, '\0')), hash (std::string (4, '\0')));
+    EXPECT_NE (hash ({ }), hash (std::string (1, '\0')));
+
+    auto one = hash ("a");
+    EXPECT_NE (one.m_low, one.m_high);
+}
+
+/******************************************************************************/
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "amqp/schema/Descriptors.h"
+#include "amqp/schema/descriptors/AMQPDescriptorRegistory.h"
+
+/******************************************************************************/
+
+using amqp::internal::AMQPDescriptorRegistory;
+using amqp::schema::descriptors::DESCRIPTOR_TOP_32BITS;
+
+/******************************************************************************/
+
+TEST (DescriptorRegistory, lookup) { // NOLINT
+    ASSERT_NE (nullptr, AMQPDescriptorRegistory.find (amqp::internal::cursor::described_t));
+    EXPECT_EQ ("DESCRIBED", AMQPDescriptorRegistory[22UL]->symbol());
+
+    EXPECT_EQ ("ENVELOPE", AMQPDescriptorRegistory[1UL | DESCRIPTOR_TOP_32BITS]->symbol());
+    EXPECT_EQ ("TRANSFORM_ELEMENT_KEY",
+        AMQPDescriptorRegistory[11UL | DESCRIPTOR_TOP_32BITS]->symbol());
+
+    // the same descriptor each time
+    EXPECT_EQ (
+        AMQPDescriptorRegistory[5UL | DESCRIPTOR_TOP_32BITS],
+        AMQPDescriptorRegistory.find (5UL | DESCRIPTOR_TOP_32BITS));
+}
+
+/******************************************************************************/
+
+TEST (DescriptorRegistory, misses) { // NOLINT
+    EXPECT_EQ (nullptr, AMQPDescriptorRegistory.find (0UL | DESCRIPTOR_TOP_32BITS));
+    EXPECT_EQ (nullptr, AMQPDescriptorRegistory.find (12UL | DESCRIPTOR_TOP_32BITS));
+
+    // Corda ids without the Corda prefix aren't ours
+    EXPECT_EQ (nullptr, AMQPDescriptorRegistory.find (1UL));
+    EXPECT_EQ (nullptr, AMQPDescriptorRegistory.find (1UL | (1UL << 32U) | DESCRIPTOR_TOP_32BITS));
+
+    EXPECT_THROW (AMQPDescriptorRegistory[99UL], std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
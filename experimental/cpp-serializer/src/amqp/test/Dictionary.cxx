@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sink/Dictionary.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::sink;
+
+/******************************************************************************/
+
+TEST (Dictionary, values) { // NOLINT
+    Dictionary dictionary;
+
+    EXPECT_EQ (Dictionary::npos, dictionary.find ("GBP"));
+
+    EXPECT_EQ (0U, dictionary.add ("GBP"));
+    EXPECT_EQ (1U, dictionary.add ("USD"));
+    EXPECT_EQ (0U, dictionary.add ("GBP"));
+    EXPECT_EQ (2U, dictionary.add ("GBP", 1));
+    EXPECT_EQ (3U, dictionary.add (""));
+
+    EXPECT_EQ (4U, dictionary.size());
+    EXPECT_EQ (1U, dictionary.find ("USD"));
+    EXPECT_EQ (2U, dictionary.find ("GBP", 1));
+    EXPECT_EQ (Dictionary::npos, dictionary.find ("USD", 1));
+
+    EXPECT_EQ ("USD", dictionary[1]);
+    EXPECT_EQ (1, dictionary.kind (2));
+    EXPECT_EQ ("", dictionary[3]);
+
+    // values are found however the pool grows
+    std::string big (1 << 16, 'x');
+    dictionary.add (big);
+    EXPECT_EQ ("GBP", dictionary[0]);
+    EXPECT_EQ (big, dictionary[4]);
+
+    dictionary.clear();
+
+    EXPECT_TRUE (dictionary.empty());
+    EXPECT_EQ (Dictionary::npos, dictionary.find ("GBP"));
+    EXPECT_EQ (0U, dictionary.add ("USD"));
+}
+
+/******************************************************************************/
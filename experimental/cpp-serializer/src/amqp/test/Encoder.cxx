@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "cursor/Bulk.h"
+#include "cursor/Cursor.h"
+#include "encoder/Buffer.h"
+#include "encoder/Encoder.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<unsigned char> bytes_) {
+        return std::string (bytes_.begin(), bytes_.end());
+    }
+
+    /**
+     * A bit of everything, a list holding a described map
+     */
+    void
+    encode (encoder::Encoder & encoder_, const std::string & long_) {
+        encoder_.beginList();
+        encoder_.int32 (-2);
+        encoder_.int32 (256);
+        encoder_.string (long_);
+        encoder_.described ("sym");
+        encoder_.beginMap();
+        encoder_.symbol ("k");
+        encoder_.float64 (1.5);
+        encoder_.endMap();
+        encoder_.emptyList();
+        encoder_.endList();
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Encoder, primitives) { // NOLINT
+    std::string out;
+    encoder::StringBuffer buffer (out);
+    encoder::Encoder encoder (buffer);
+
+    encoder.int32 (-2);
+    encoder.int32 (256);
+    encoder.uint32 (0);
+    encoder.uint64 (7);
+    encoder.int64 (-200);
+    encoder.boolean (true);
+    encoder.null();
+    encoder.string ("abc");
+    encoder.symbol ("xy");
+    encoder.described (0x42);
+    encoder.uint16 (1);
+    buffer.flush();
+
+    EXPECT_EQ (bytes ({
+        0x54, 0xfe,
+        0x71, 0x00, 0x00, 0x01, 0x00,
+        0x43,
+        0x53, 0x07,
+        0x81, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x38,
+        0x41,
+        0x40,
+        0xa1, 0x03, 'a', 'b', 'c',
+        0xa3, 0x02, 'x', 'y',
+        0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x42,
+        0x60, 0x00, 0x01
+    }), out);
+}
+
+/******************************************************************************/
+
+TEST (Encoder, compound) { // NOLINT
+    std::string out;
+    encoder::StringBuffer buffer (out);
+    encoder::Encoder encoder (buffer);
+
+    std::string longString (300, 'x');
+
+    encode (encoder, longString);
+    buffer.flush();
+
+    EXPECT_EQ (0U, encoder.depth());
+
+    cursor::Cursor data (out.data(), out.size());
+
+    EXPECT_EQ (out.size(), data.encodedSize());
+    ASSERT_EQ (5U, data.get_list());
+
+    cursor::auto_list_enter ale (data, true);
+
+    EXPECT_EQ (-2, data.get_int());
+    ASSERT_TRUE (data.next());
+    EXPECT_EQ (256, data.get_int());
+    ASSERT_TRUE (data.next());
+    EXPECT_EQ (longString, data.get_string());
+    ASSERT_TRUE (data.next());
+    ASSERT_EQ (cursor::described_t, data.type());
+    {
+        cursor::auto_enter ae (data);
+
+        EXPECT_EQ ("sym", data.get_symbol());
+        ASSERT_TRUE (data.next());
+        ASSERT_EQ (2U, data.get_map());
+
+        cursor::auto_map_enter ame (data, true);
+
+        EXPECT_EQ ("k", data.get_symbol());
+        ASSERT_TRUE (data.next());
+        EXPECT_EQ (1.5, data.get_double());
+    }
+    ASSERT_TRUE (data.next());
+    EXPECT_EQ (0U, data.get_list());
+    EXPECT_FALSE (data.next());
+}
+
+/******************************************************************************/
+
+/**
+ * Packed arrays come back through the bulk readers, the short ones with
+ * one byte sizes and the long ones with four
+ */
+TEST (Encoder, arrays) { // NOLINT
+    std::string out;
+    encoder::StringBuffer buffer (out);
+    encoder::Encoder encoder (buffer);
+
+    const int32_t ints[] = { -2, 256 };
+
+    encoder.beginList();
+    encoder.ints (ints, 2);
+    encoder.ints (nullptr, 0);
+    encoder.endList();
+    buffer.flush();
+
+    EXPECT_EQ (bytes ({
+        0xd0, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x02,
+        0xe0, 0x0a, 0x02, 0x71,
+            0xff, 0xff, 0xff, 0xfe, 0x00, 0x00, 0x01, 0x00,
+        0xe0, 0x02, 0x00, 0x71
+    }), out);
+
+    std::vector<int64_t> longs (1000);
+    std::vector<double> doubles (1000);
+
+    for (size_t i { 0 } ; i < longs.size() ; ++i) {
+        longs[i] = static_cast<int64_t> (i * i) - 1000;
+        doubles[i] = static_cast<double> (i) / 3;
+    }
+
+    std::vector<int32_t> narrow (longs.begin(), longs.end());
+
+    out.clear();
+    encoder::StringBuffer again (out);
+    encoder::Encoder arrays (again);
+
+    arrays.ints (narrow.data(), narrow.size());
+    auto first = out.size();
+    arrays.longs (longs.data(), longs.size());
+    auto second = out.size();
+    arrays.doubles (doubles.data(), doubles.size());
+    again.flush();
+
+    EXPECT_EQ (10U + 4 * narrow.size(), first);
+    EXPECT_EQ ('\xf0', out[0]);
+
+    std::vector<int64_t> intsRead, longsRead;
+    std::vector<double> doublesRead;
+
+    ASSERT_TRUE (cursor::readInts (std::string_view (out).substr (0, first), intsRead));
+    ASSERT_TRUE (cursor::readLongs (std::string_view (out).substr (first, second - first), longsRead));
+    ASSERT_TRUE (cursor::readDoubles (std::string_view (out).substr (second), doublesRead));
+
+    EXPECT_EQ (longs, intsRead);
+    EXPECT_EQ (longs, longsRead);
+    EXPECT_EQ (doubles, doublesRead);
+}
+
+/******************************************************************************/
+
+TEST (Encoder, unbalanced) { // NOLINT
+    std::string out;
+    encoder::StringBuffer buffer (out);
+
+    encoder::Encoder closing (buffer);
+    EXPECT_THROW (closing.endList(), std::runtime_error); // NOLINT
+
+    encoder::Encoder describing (buffer);
+    describing.beginList();
+    describing.described ("sym");
+    EXPECT_THROW (describing.endList(), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
+
+/**
+ * Appends to whatever the string already held
+ */
+TEST (Buffer, string) { // NOLINT
+    std::string out { "abc" };
+
+    {
+        encoder::StringBuffer buffer (out, 1024);
+        encoder::Encoder encoder (buffer);
+
+        EXPECT_EQ (3U, buffer.size());
+
+        encoder.boolean (false);
+        buffer.flush();
+    }
+
+    EXPECT_EQ (bytes ({ 'a', 'b', 'c', 0x42 }), out);
+}
+
+/******************************************************************************/
+
+/**
+ * Chunks far too small for any list so the headers being patched and the
+ * string each land in chunks of their own
+ */
+TEST (Buffer, chain) { // NOLINT
+    std::string longString (300, 'x');
+
+    std::string expected;
+    {
+        encoder::StringBuffer buffer (expected);
+        encoder::Encoder encoder (buffer);
+        encode (encoder, longString);
+        buffer.flush();
+    }
+
+    encoder::ChainBuffer buffer (16);
+    encoder::Encoder encoder (buffer);
+    encode (encoder, longString);
+
+    EXPECT_EQ (expected.size(), buffer.size());
+
+    auto iovecs = buffer.iovecs();
+    EXPECT_LT (2U, iovecs.size());
+
+    std::string actual;
+    for (const auto & iov : iovecs) {
+        actual.append (static_cast<const char *> (iov.iov_base), iov.iov_len);
+    }
+
+    EXPECT_EQ (expected, actual);
+
+    buffer.clear();
+    EXPECT_EQ (0U, buffer.size());
+    EXPECT_TRUE (buffer.iovecs().empty());
+}
+
+/******************************************************************************/
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "sink/JsonSink.h"
+#include "reader/restricted-readers/EnumReader.h"
+#include "amqp/schema/TypeNotationGraph.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal;
+
+/******************************************************************************/
+
+namespace {
+
+    const schema::Schema &
+    empty() {
+        static const schema::Schema schema (
+                schema::TypeNotationGraph<schema::AMQPTypeNotation> { });
+        return schema;
+    }
+
+    /**
+     * A described list of [name_] and [ordinal_], as the JVM encodes an
+     * enum constant
+     */
+    std::string
+    constant (char name_, unsigned char ordinal_) {
+        const unsigned char bytes[] {
+            0x00, 0xa3, 0x01, 'f',
+            0xc0, 0x06, 0x02,
+            0xa1, 0x01, static_cast<unsigned char> (name_),
+            0x54, ordinal_
+        };
+
+        return std::string (std::begin (bytes), std::end (bytes));
+    }
+
+    reader::EnumReader
+    abc() {
+        return reader::EnumReader ("E", { "A", "B", "C" });
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (EnumReader, dump) { // NOLINT
+    auto b = constant ('B', 1);
+
+    cursor::Cursor data (b.data(), b.size());
+    EXPECT_EQ ("x : B", abc().dump ("x", data, empty())->dump());
+
+    std::stringstream ss;
+    {
+        cursor::Cursor write (b.data(), b.size());
+        sink::JsonSink sink (ss);
+        abc().write (write, sink, empty());
+    }
+
+    EXPECT_EQ (R"("B")", ss.str());
+}
+
+/******************************************************************************/
+
+/**
+ * The ordinal decides which constant it is, the constant's name in the
+ * blob is never read
+ */
+TEST (EnumReader, ordinal) { // NOLINT
+    auto b = constant ('A', 2);
+    auto reader = abc();
+
+    cursor::Cursor data (b.data(), b.size());
+    auto choice = reader.choice (data);
+
+    EXPECT_EQ ("C", choice.m_name);
+    EXPECT_EQ (2, choice.m_ordinal);
+}
+
+/******************************************************************************/
+
+TEST (EnumReader, range) { // NOLINT
+    auto b = constant ('D', 3);
+
+    cursor::Cursor data (b.data(), b.size());
+    EXPECT_THROW (abc().dump (data, empty()), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::sink;
+
+/******************************************************************************/
+
+TEST (JsonSink, scalars) { // NOLINT
+    std::stringstream ss;
+    {
+        JsonSink sink (ss);
+
+        sink.beginList();
+        sink.null();
+        sink.boolean (true);
+        sink.integer (-42);
+        sink.real (0.5);
+        sink.string ("a\"b\\c\n\x01");
+        sink.symbol ("A");
+        sink.endList();
+    }
+
+    EXPECT_EQ (R"([null,true,-42,0.5,"a\"b\\c\n\u0001","A"])", ss.str());
+}
+
+/******************************************************************************/
+
+TEST (JsonSink, nested) { // NOLINT
+    std::stringstream ss;
+    {
+        JsonSink sink (ss);
+
+        sink.beginObject();
+        sink.key ("a");
+        sink.beginMap();
+        sink.integer (1);
+        sink.beginList();
+        sink.endList();
+        sink.string ("k");
+        sink.beginObject();
+        sink.endObject();
+        sink.endMap();
+        sink.key ("b");
+        sink.boolean (false);
+        sink.endObject();
+    }
+
+    EXPECT_EQ (R"({"a":{"1":[],"k":{}},"b":false})", ss.str());
+}
+
+/******************************************************************************/
+
+TEST (JsonSink, multipleValues) { // NOLINT
+    std::stringstream ss;
+    {
+        // tiny buffer to force flushing mid value
+        JsonSink sink (ss, 2);
+
+        sink.string ("hello world");
+        sink.integer (2);
+    }
+
+    EXPECT_EQ ("\"hello world\"\n2", ss.str());
+}
+
+/******************************************************************************/
+
+/**
+ * Runs read the same as the values written one at a time
+ */
+TEST (JsonSink, runs) { // NOLINT
+    const int64_t ints[] = { 1, -2, 300 };
+    const double reals[] = { 0.5, std::numeric_limits<double>::infinity(), -1.25 };
+
+    std::stringstream ss;
+    {
+        // small enough to flush mid run
+        JsonSink sink (ss, 4);
+
+        sink.beginList();
+        sink.integer (0);
+        sink.integers (ints, 3);
+        sink.endList();
+
+        sink.beginList();
+        sink.reals (reals, 3);
+        sink.endList();
+
+        sink.beginMap();
+        sink.integers (ints, 2);
+        sink.endMap();
+    }
+
+    EXPECT_EQ ("[0,1,-2,300]\n[0.5,null,-1.25]\n{\"1\":-2}", ss.str());
+}
+
+/******************************************************************************/
+
+/**
+ * Well formed UTF-8 is passed through as it is, anything else replaced,
+ * and escapes are found however far into a string they are
+ */
+TEST (JsonSink, utf8) { // NOLINT
+    auto json = [](std::string_view s_) {
+        std::stringstream ss;
+        {
+            JsonSink sink (ss);
+            sink.string (s_);
+        }
+        return ss.str();
+    };
+
+    EXPECT_EQ ("\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\"", json ("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"));
+
+    // a stray continuation, a truncated sequence, an overlong and a surrogate
+    EXPECT_EQ (R"("a\ufffdb")", json ("a\x80" "b"));
+    EXPECT_EQ (R"("a\ufffd")", json ("a\xc3"));
+    EXPECT_EQ (R"("\ufffd\ufffd")", json ("\xc0\xaf"));
+    EXPECT_EQ (R"("\ufffd\ufffd\ufffd")", json ("\xed\xa0\x80"));
+
+    std::string prose (1000, 'x');
+    prose[700] = '"';
+    prose[900] = '\x02';
+
+    EXPECT_EQ (
+        "\"" + prose.substr (0, 700) + "\\\"" + prose.substr (701, 199)
+            + "\\u0002" + prose.substr (901) + "\"",
+        json (prose));
+}
+
+/******************************************************************************/
+
+TEST (JsonSink, binary) { // NOLINT
+    auto json = [](std::string_view s_) {
+        std::stringstream ss;
+        {
+            JsonSink sink (ss);
+            sink.binary (s_);
+        }
+        return ss.str();
+    };
+
+    EXPECT_EQ (R"("")", json (""));
+    EXPECT_EQ (R"("AA==")", json (std::string_view ("\0", 1)));
+    EXPECT_EQ (R"("AP8=")", json (std::string_view ("\0\xff", 2)));
+    EXPECT_EQ (R"("TWFu")", json ("Man"));
+    EXPECT_EQ (R"("aGVsbG8gd29ybGQ=")", json ("hello world"));
+
+    // longer than a chunk of the encoder
+    std::string bytes (300, '\xfb');
+    std::string expected;
+    for (size_t i { 0 } ; i < 100 ; ++i) expected += "+/v7";
+
+    EXPECT_EQ ("\"" + expected + "\"", json (bytes));
+}
+
+/******************************************************************************/
+
+TEST (JsonSink, misuse) { // NOLINT
+    std::stringstream ss;
+    JsonSink sink (ss);
+
+    EXPECT_THROW (sink.key ("a"), std::runtime_error);
+    EXPECT_THROW (sink.endList(), std::runtime_error);
+
+    sink.beginMap();
+    EXPECT_THROW (sink.beginList(), std::runtime_error);
+}
+
+/******************************************************************************/
+
+TEST (JsonSink, renderedKeys) { // NOLINT
+    auto a = JsonSink::render ("a");
+    auto b = JsonSink::render ("b\"c");
+
+    EXPECT_EQ (R"(,"b\"c":)", b);
+
+    std::string out;
+    {
+        JsonSink sink (out);
+
+        sink.beginObject();
+        sink.key (amqp::reader::ISink::Key { "a", a, { } });
+        sink.integer (1);
+        sink.key (amqp::reader::ISink::Key { "b\"c", b, { } });
+        sink.integer (2);
+
+        // nothing rendered falls back on the name
+        sink.key (amqp::reader::ISink::Key { "d", { }, { } });
+        sink.integer (3);
+        sink.endObject();
+    }
+
+    EXPECT_EQ (R"({"a":1,"b\"c":2,"d":3})", out);
+}
+
+/******************************************************************************/
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "kernels/Kernels.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::kernels;
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * Puts back whatever was selected before
+     */
+    struct Forced {
+        const Variant m_was;
+
+        explicit Forced (Variant variant_) : m_was (Kernels::variant()) {
+            Kernels::force (variant_);
+        }
+
+        ~Forced() { Kernels::force (m_was); }
+    };
+
+    std::string
+    random (size_t size_) {
+        std::mt19937 rng (size_);
+        std::string rtn (size_, '\0');
+
+        for (auto & c : rtn) c = static_cast<char> (rng());
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Kernels, names) { // NOLINT
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        EXPECT_EQ (Variant (i), Kernels::parse (Kernels::name (Variant (i))));
+    }
+
+    EXPECT_EQ (variants_t, Kernels::parse ("mmx"));
+}
+
+/******************************************************************************/
+
+TEST (Kernels, selection) { // NOLINT
+    EXPECT_TRUE (Kernels::supported (scalar_t));
+    EXPECT_TRUE (Kernels::supported (Kernels::best()));
+    EXPECT_FALSE (Kernels::supported (variants_t));
+
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        if (!Kernels::supported (Variant (i))) {
+            EXPECT_THROW (Kernels::force (Variant (i)), std::runtime_error); // NOLINT
+        } else {
+            Forced forced { Variant (i) };
+            EXPECT_EQ (Variant (i), Kernels::variant());
+        }
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * Every variant that can run here must agree with the scalar one for
+ * every length, so both the vector loops and their tails are covered
+ */
+TEST (Kernels, swap) { // NOLINT
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        if (!Kernels::supported (Variant (i))) continue;
+
+        for (size_t n { 0 } ; n < 70 ; ++n) {
+            auto in = random (8 * n);
+
+            std::vector<int64_t> expected32 (n), actual32 (n);
+            std::vector<uint64_t> expected64 (n), actual64 (n);
+            std::vector<uint32_t> expectedReversed (n), actualReversed (n);
+
+            {
+                Forced forced { scalar_t };
+                Kernels::table().m_swap32 (in.data(), n, expected32.data());
+                Kernels::table().m_swap64 (in.data(), n, expected64.data());
+                Kernels::table().m_reverse32 (in.data(), n, expectedReversed.data());
+            }
+
+            Forced forced { Variant (i) };
+            Kernels::table().m_swap32 (in.data(), n, actual32.data());
+            Kernels::table().m_swap64 (in.data(), n, actual64.data());
+            Kernels::table().m_reverse32 (in.data(), n, actualReversed.data());
+
+            EXPECT_EQ (expected32, actual32) << Kernels::name (Variant (i)) << " " << n;
+            EXPECT_EQ (expected64, actual64) << Kernels::name (Variant (i)) << " " << n;
+            EXPECT_EQ (expectedReversed, actualReversed) << Kernels::name (Variant (i)) << " " << n;
+        }
+    }
+
+    // and the scalar one must be right
+    const char in[] = { '\xff', '\xff', '\xff', '\xfe', 0, 0, 1, 0 };
+    int64_t out32[2];
+    uint64_t out64;
+    uint32_t reversed[2];
+
+    Forced forced { scalar_t };
+    Kernels::table().m_swap32 (in, 2, out32);
+    Kernels::table().m_swap64 (in, 1, &out64);
+    Kernels::table().m_reverse32 (in, 2, reversed);
+
+    EXPECT_EQ (-2, out32[0]);
+    EXPECT_EQ (256, out32[1]);
+    EXPECT_EQ (0xfffffffe00000100ULL, out64);
+    EXPECT_EQ (0xfffffffeU, reversed[0]);
+    EXPECT_EQ (256U, reversed[1]);
+}
+
+/******************************************************************************/
+
+/**
+ * A single special byte at every position of every length, along with
+ * one of each kind of special byte
+ */
+TEST (Kernels, plain) { // NOLINT
+    const char specials[] = { '"', '\\', '\n', '\x01', '\x1f', '\x80', '\xc3', '\xff' };
+
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        if (!Kernels::supported (Variant (i))) continue;
+
+        Forced forced { Variant (i) };
+
+        for (size_t n { 0 } ; n < 140 ; ++n) {
+            std::string s (n, 'a');
+
+            EXPECT_EQ (n, Kernels::table().m_plain (s.data(), n)) << Kernels::name (Variant (i));
+
+            for (size_t at { 0 } ; at < n ; ++at) {
+                for (auto special : specials) {
+                    s[at] = special;
+
+                    ASSERT_EQ (at, Kernels::table().m_plain (s.data(), n))
+                        << Kernels::name (Variant (i)) << " " << n << " " << at;
+
+                    s[at] = '~';
+                }
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+
+/**
+ * A run broken at every position, for strides narrower and wider than
+ * any vector
+ */
+TEST (Kernels, run) { // NOLINT
+    for (int i { 0 } ; i < variants_t ; ++i) {
+        if (!Kernels::supported (Variant (i))) continue;
+
+        Forced forced { Variant (i) };
+
+        for (size_t stride : { 1, 2, 3, 5, 9, 17, 33, 65 }) {
+            for (size_t n { 0 } ; n < 40 ; ++n) {
+                auto s = random (stride * n);
+                for (size_t at { 0 } ; at < n ; ++at) s[at * stride] = '\x71';
+
+                // the byte after the last value mustn't be looked at
+                s += '\x71';
+
+                EXPECT_EQ (n, Kernels::table().m_run (s.data(), n, stride, 0x71))
+                    << Kernels::name (Variant (i)) << " " << stride << " " << n;
+
+                for (size_t at { 0 } ; at < n ; ++at) {
+                    s[at * stride] = '\x70';
+
+                    ASSERT_EQ (at, Kernels::table().m_run (s.data(), n, stride, 0x71))
+                        << Kernels::name (Variant (i)) << " " << stride << " " << n << " " << at;
+
+                    s[at * stride] = '\x71';
+                }
+            }
+        }
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+#include <cstdlib>
+
+#include "format/Number.h"
+
+/******************************************************************************/
+
+using amqp::internal::format::Number;
+
+/******************************************************************************/
+
+TEST (Number, integers) { // NOLINT
+    EXPECT_EQ ("0", Number (0).view());
+    EXPECT_EQ ("-2147483648", Number (std::numeric_limits<int32_t>::min()).view());
+    EXPECT_EQ ("-9223372036854775808", Number (std::numeric_limits<int64_t>::min()).view());
+    EXPECT_EQ ("18446744073709551615", Number (std::numeric_limits<uint64_t>::max()).view());
+}
+
+/******************************************************************************/
+
+TEST (Number, shortest) { // NOLINT
+    EXPECT_EQ ("10", Number (10.0).view());
+    EXPECT_EQ ("0.1", Number (0.1).view());
+    EXPECT_EQ ("1234567.89", Number (1234567.89).view());
+    EXPECT_EQ ("1e-07", Number (1e-7).view());
+    EXPECT_EQ ("-0", Number (-0.0).view());
+}
+
+/******************************************************************************/
+
+TEST (Number, roundTrip) { // NOLINT
+    for (double d : {
+        0.1 + 0.2,
+        1.0 / 3.0,
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::denorm_min(),
+        123456789012.345678 })
+    {
+        Number n (d);
+        ASSERT_LE (n.view().size(), Number::MAX_CHARS);
+        EXPECT_EQ (d, std::strtod (std::string (n.view()).c_str(), nullptr)) << n.view();
+    }
+}
+
+/******************************************************************************/
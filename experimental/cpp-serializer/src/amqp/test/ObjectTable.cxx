@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "Reader.h"
+#include "ObjectTable.h"
+#include "cursor/Cursor.h"
+#include "reader/restricted-readers/EnumReader.h"
+
+/******************************************************************************/
+
+using namespace amqp::reader;
+using namespace amqp::internal::reader;
+
+/******************************************************************************/
+
+/**
+ * A reference dumps as what it refers to, dropping the property that
+ * value was a field under
+ */
+TEST (Reference, expands) { // NOLINT
+    TypedPair<int> field ("a", 1);
+    TypedSingle<std::string_view> element ("x");
+
+    EXPECT_EQ ("1", Reference (&field, 0, false).dump());
+    EXPECT_EQ ("b : 1", Reference (&field, 0, false, "b").dump());
+    EXPECT_EQ (R"("x")", Reference (&element, 1, false).dump());
+}
+
+/******************************************************************************/
+
+TEST (Reference, pointers) { // NOLINT
+    TypedPair<int> field ("a", 1);
+
+    EXPECT_EQ ("{ $ref : 3 }", Reference (&field, 3, true).dump());
+    EXPECT_EQ ("b : { $ref : 3 }", Reference (&field, 3, true, "b").dump());
+
+    // written or visited rather than dumped there's nothing to expand
+    EXPECT_EQ ("{ $ref : 4 }", Reference (nullptr, 4, false).dump());
+}
+
+/******************************************************************************/
+
+TEST (Reference, containers) { // NOLINT
+    sList<uPtr<IValue>> values;
+    values.emplace_back (std::make_unique<TypedSingle<int>> (1));
+    values.emplace_back (std::make_unique<TypedSingle<int>> (2));
+
+    TypedPair<sList<uPtr<IValue>>> list ("l", std::move (values));
+
+    EXPECT_EQ ("l : [ 1, 2 ]", list.dump());
+    EXPECT_EQ ("[ 1, 2 ]", list.dumpValue());
+    EXPECT_EQ ("[ 1, 2 ]", Reference (&list, 0, false).dump());
+}
+
+/******************************************************************************/
+
+TEST (ObjectTable, scope) { // NOLINT
+    EXPECT_EQ (nullptr, ObjectTable::current());
+
+    ObjectTable outer;
+    {
+        ObjectTable::Scope s1 (outer);
+        EXPECT_EQ (&outer, ObjectTable::current());
+
+        ObjectTable inner (true);
+        {
+            ObjectTable::Scope s2 (inner);
+            EXPECT_EQ (&inner, ObjectTable::current());
+            EXPECT_TRUE (ObjectTable::current()->pointers());
+        }
+
+        EXPECT_EQ (&outer, ObjectTable::current());
+    }
+
+    EXPECT_EQ (nullptr, ObjectTable::current());
+}
+
+/******************************************************************************/
+
+TEST (ObjectTable, isReference) { // NOLINT
+    // a REFERENCED_OBJECT to object 2 and a described list
+    const char ref[] = "\x00\x80\x00\x00\xc5\x62\x00\x00\x00\x08\x52\x02";
+    const char other[] = "\x00\x80\x00\x00\xc5\x62\x00\x00\x00\x01\x45";
+
+    amqp::internal::cursor::Cursor r (ref, sizeof (ref) - 1);
+    amqp::internal::cursor::Cursor o (other, sizeof (other) - 1);
+    amqp::internal::cursor::Cursor i ("\x54\x01", 2);
+
+    EXPECT_TRUE (ObjectTable::isReference (r));
+    EXPECT_FALSE (ObjectTable::isReference (o));
+    EXPECT_FALSE (ObjectTable::isReference (i));
+}
+
+/******************************************************************************/
+
+/**
+ * Equal values hash alike however wide their compounds and wherever a
+ * reference stands in for what it refers to
+ */
+TEST (ObjectTable, hash) { // NOLINT
+    using namespace std::string_literals;
+
+    // described by "x", a list of 1 and an empty list
+    const auto object = "\x00\xa3\x01x\xc0\x04\x02\x54\x01\x45"s;
+    const auto other = "\x00\xa3\x01x\xc0\x04\x02\x54\x02\x45"s;
+    const auto reference = "\x00\x80\x00\x00\xc5\x62\x00\x00\x00\x08\x52\x00"s;
+
+    const auto inlined = "\xc0\x15\x02"s + object + object;
+    const auto referred = "\xc0\x17\x02"s + object + reference;
+    const auto wide = "\xd0\x00\x00\x00\x18\x00\x00\x00\x02"s + object + object;
+
+    EXPECT_EQ (ObjectTable::hash (inlined), ObjectTable::hash (wide));
+    EXPECT_NE (ObjectTable::hash (object), ObjectTable::hash (other));
+    EXPECT_NE (ObjectTable::hash (inlined), ObjectTable::hash ("\xc0\x15\x02"s + object + other));
+
+    // with nothing to resolve it against a reference is just bytes
+    EXPECT_NE (ObjectTable::hash (inlined), ObjectTable::hash (referred));
+
+    EnumReader reader ("E", { "A" });
+
+    ObjectTable table;
+    ObjectTable::Scope scope (table);
+    ObjectTable::written (object, reader, true);
+
+    EXPECT_EQ (ObjectTable::hash (inlined), ObjectTable::hash (referred));
+}
+
+/******************************************************************************/
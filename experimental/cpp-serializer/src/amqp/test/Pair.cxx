@@ -31,7 +31,7 @@ TEST (Pair, UP1) { // NOLINT
     std::unique_ptr<TypedPair<double>> test =
         std::make_unique<TypedPair<double>> ("property", 10.0);
 
-    EXPECT_EQ("property : 10.000000", test->dump());
+    EXPECT_EQ("property : 10", test->dump());
 }
 
 /******************************************************************************/
@@ -59,3 +59,20 @@ TEST (Pair, UP2) { // NOLINT
 
 /******************************************************************************/
 
+TEST (Pair, borrowed) { // NOLINT
+    const std::string name { "a_rather_long_field_name_beyond_sso" };
+
+    TypedPair<std::string> p (borrowed, name, "1");
+    EXPECT_EQ (name + " : 1", p.dump());
+
+    // moving keeps pointing at the borrowed name
+    TypedPair<std::string> moved (std::move (p));
+    EXPECT_EQ (name + " : 1", moved.dump());
+
+    // whilst an owned name moves with the pair
+    TypedPair<std::string> owned (std::string ("b"), "2");
+    TypedPair<std::string> moved2 (std::move (owned));
+    EXPECT_EQ ("b : 2", moved2.dump());
+}
+
+/******************************************************************************/
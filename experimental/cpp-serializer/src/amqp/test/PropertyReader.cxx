@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "sink/JsonSink.h"
+#include "reader/PropertyReader.h"
+#include "amqp/reader/Primitive.h"
+#include "amqp/reader/IVisitor.h"
+#include "amqp/schema/TypeNotationGraph.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<unsigned char> bytes_) {
+        return std::string (bytes_.begin(), bytes_.end());
+    }
+
+    const schema::Schema &
+    empty() {
+        static const schema::Schema schema (
+                schema::TypeNotationGraph<schema::AMQPTypeNotation> { });
+        return schema;
+    }
+
+    /**
+     * What the reader for [type_] dumps, and writes as JSON, for the value
+     * encoded in [encoded_]
+     */
+    std::pair<std::string, std::string>
+    decode (const std::string & type_, const std::string & encoded_) {
+        auto reader = reader::PropertyReader::make (type_);
+
+        cursor::Cursor dump (encoded_.data(), encoded_.size());
+        auto value = reader->dump ("x", dump, empty());
+
+        std::stringstream ss;
+        {
+            cursor::Cursor write (encoded_.data(), encoded_.size());
+            sink::JsonSink sink (ss);
+            reader->write (write, sink, empty());
+        }
+
+        return { value->dump(), ss.str() };
+    }
+
+    struct Natives : public amqp::reader::IVisitor {
+        std::stringstream m_seen;
+
+        void onChar (char32_t c_) override { m_seen << "c" << static_cast<uint32_t>(c_) << " "; }
+        void onShort (int16_t v_) override { m_seen << "s" << v_ << " "; }
+        void onByte (int8_t v_) override { m_seen << "b" << static_cast<int>(v_) << " "; }
+        void onFloat (float v_) override { m_seen << "f" << v_ << " "; }
+        void onTimestamp (int64_t v_) override { m_seen << "t" << v_ << " "; }
+        void onUuid (std::string_view v_) override { m_seen << "u" << v_.size() << " "; }
+        void onDecimal128 (std::string_view v_) override { m_seen << "d" << v_.size() << " "; }
+        void onSymbol (std::string_view v_) override { m_seen << "y" << v_ << " "; }
+    };
+
+}
+
+/******************************************************************************/
+
+TEST (PropertyReader, natives) { // NOLINT
+    using Expected = std::pair<std::string, std::string>;
+
+    EXPECT_EQ (Expected (R"(x : "é")", R"("é")"),
+               decode ("char", bytes ({ 0x73, 0x00, 0x00, 0x00, 0xe9 })));
+    EXPECT_EQ (Expected ("x : -2", "-2"), decode ("short", bytes ({ 0x61, 0xff, 0xfe })));
+    EXPECT_EQ (Expected ("x : -128", "-128"), decode ("byte", bytes ({ 0x51, 0x80 })));
+    EXPECT_EQ (Expected ("x : 1.5", "1.5"),
+               decode ("float", bytes ({ 0x72, 0x3f, 0xc0, 0x00, 0x00 })));
+    EXPECT_EQ (Expected (R"(x : "xy")", R"("xy")"),
+               decode ("symbol", bytes ({ 0xa3, 0x02, 'x', 'y' })));
+
+    // 2019-03-04T10:11:12.345Z
+    EXPECT_EQ (Expected (R"(x : "2019-03-04T10:11:12.345Z")", R"("2019-03-04T10:11:12.345Z")"),
+               decode ("timestamp", bytes ({
+                   0x83, 0x00, 0x00, 0x01, 0x69, 0x48, 0x2f, 0x97, 0x59 })));
+
+    EXPECT_EQ (Expected (R"(x : "12345678-9abc-def0-0123-456789abcdef")",
+                         R"("12345678-9abc-def0-0123-456789abcdef")"),
+               decode ("uuid", bytes ({
+                   0x98, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0,
+                   0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef })));
+
+    // 123 x 10^-2
+    EXPECT_EQ (Expected (R"(x : "1.23")", R"("1.23")"),
+               decode ("decimal128", bytes ({
+                   0x94, 0x30, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7b })));
+
+    EXPECT_EQ (Expected (R"(x : "AAH/")", R"("AAH/")"),
+               decode ("binary", bytes ({ 0xa0, 0x03, 0x00, 0x01, 0xff })));
+}
+
+/******************************************************************************/
+
+TEST (PropertyReader, visit) { // NOLINT
+    auto b = bytes ({
+        0x73, 0x00, 0x00, 0x00, 0x41,
+        0x61, 0x00, 0x07,
+        0x51, 0xff,
+        0x72, 0x3f, 0xc0, 0x00, 0x00,
+        0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2a,
+        0x98, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x94, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0xa3, 0x01, 'z'
+    });
+
+    Natives natives;
+    cursor::Cursor data (b.data(), b.size());
+
+    for (const auto * type : {
+        "char", "short", "byte", "float", "timestamp", "uuid", "decimal128", "symbol" })
+    {
+        reader::PropertyReader::make (type)->visit (data, natives, empty());
+    }
+
+    EXPECT_EQ ("c65 s7 b-1 f1.5 t42 u16 d16 yz ", natives.m_seen.str());
+}
+
+/******************************************************************************/
+
+TEST (PropertyReader, mismatch) { // NOLINT
+    auto b = bytes ({ 0xa1, 0x01, 'a' });
+
+    cursor::Cursor data (b.data(), b.size());
+    EXPECT_THROW (reader::PropertyReader::make ("uuid")->dump (data, empty()), std::runtime_error);
+
+    EXPECT_THROW (reader::PropertyReader::make ("ulong"), std::runtime_error);
+}
+
+/******************************************************************************/
+
+/**
+ * The closed dispatch the composite, list and map readers use for their
+ * primitive children reads exactly what the property reader does
+ */
+TEST (PropertyReader, primitives) { // NOLINT
+    EXPECT_EQ (reader::Primitive::int_t, reader::primitive ("int"));
+    EXPECT_EQ (reader::Primitive::none_t, reader::primitive ("ulong"));
+
+    uPtr<reader::Reader> string = reader::PropertyReader::make ("string");
+    uPtr<reader::Reader> integer = reader::PropertyReader::make ("int");
+
+    EXPECT_EQ (reader::Primitive::string_t, reader::primitive (*string));
+
+    // strings are numbered as elements so still go through the reader
+    EXPECT_EQ (reader::Primitive::none_t, reader::unnumbered (string.get()));
+    EXPECT_EQ (reader::Primitive::int_t, reader::unnumbered (integer.get()));
+
+    auto b = bytes ({ 0x71, 0x00, 0x00, 0x00, 0x2a, 0xa1, 0x02, 'x', 'y' });
+
+    cursor::Cursor data (b.data(), b.size());
+    EXPECT_EQ ("x : 42", reader::dump (reader::Primitive::int_t, "x", data)->dump());
+    EXPECT_EQ ("\"xy\"", reader::dump (reader::Primitive::string_t, data)->dump());
+}
+
+/******************************************************************************/
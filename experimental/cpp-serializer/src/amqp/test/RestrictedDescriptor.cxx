@@ -23,3 +23,9 @@ TEST (RestrictedDescriptor, makePrim4) { // NOLINT
 TEST (RestrictedDescriptor, makePrim5) { // NOLINT§
     EXPECT_EQ ("int[], int", RestrictedDescriptor::makePrim ("java.lang.Integer[], java.lang.Integer"));
 }
+
+TEST (RestrictedDescriptor, makePrim6) { // NOLINT
+    EXPECT_EQ ("java.util.Map<long, java.util.List<boolean>>",
+        RestrictedDescriptor::makePrim ("java.util.Map<java.lang.Long, java.util.List<java.lang.Boolean>>"));
+    EXPECT_EQ ("java.lang.String[]", RestrictedDescriptor::makePrim ("java.lang.String[]"));
+}
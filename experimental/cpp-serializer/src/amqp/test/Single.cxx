@@ -19,6 +19,27 @@ TEST (Single, string) { // NOLINT
 
 /******************************************************************************/
 
+/**
+ * Views are only rendered, and so quoted, when dumped
+ */
+TEST (Single, views) { // NOLINT
+    std::string blob { "say \"hi\"" };
+
+    TypedSingle<std::string_view> str (blob);
+
+    EXPECT_EQ (blob.data(), str.value().data());
+    EXPECT_EQ (R"("say \"hi\"")", str.dump());
+
+    TypedSingle<Binary> bin (Binary (std::string_view (blob).substr (0, 3)));
+
+    EXPECT_EQ (3U, bin.value().size());
+    EXPECT_EQ (R"("c2F5")", bin.dump());
+
+    EXPECT_EQ (R"(x : "hi")", TypedPair<std::string_view> ("x", "hi").dump());
+}
+
+/******************************************************************************/
+
 TEST (Single, list) { // NOLINT
 
     struct builder {
@@ -42,4 +63,39 @@ TEST (Single, list) { // NOLINT
 
     EXPECT_EQ("[ 1, 2, 3, 4, 5 ]", test->dump());
 }
+
+/******************************************************************************/
+
+/**
+ * What lists and arrays decode into, contiguous but rendered as a list
+ * unlike the [sVec] a composite's properties are held in
+ */
+TEST (Single, seq) { // NOLINT
+    sSeq<uPtr<IValue>> seq;
+    seq.reserve (3);
+
+    seq.emplace_back (std::make_unique<TypedSingle<int>> (1));
+    seq.emplace_back (std::make_unique<TypedSingle<int>> (2));
+    seq.emplace_back (std::make_unique<TypedSingle<int>> (3));
+
+    EXPECT_EQ ("[ 1, 2, 3 ]", TypedSingle<sSeq<uPtr<IValue>>> (std::move (seq)).dump());
+
+    sSeq<uPtr<IValue>> named;
+    named.emplace_back (std::make_unique<TypedSingle<int>> (4));
+
+    TypedPair<sSeq<uPtr<IValue>>> pair ("l", std::move (named));
+
+    EXPECT_EQ ("l : [ 4 ]", pair.dump());
+    EXPECT_EQ ("[ 4 ]", pair.dumpValue());
+}
+/******************************************************************************/
+
+TEST (Single, typed) { // NOLINT
+    EXPECT_EQ ("-2147483648", TypedSingle<int32_t> (INT32_MIN).dump());
+    EXPECT_EQ ("9223372036854775807", TypedSingle<int64_t> (INT64_MAX).dump());
+    EXPECT_EQ ("12.3", TypedSingle<double> (12.3).dump());
+    EXPECT_EQ ("1", TypedSingle<bool> (true).dump());
+    EXPECT_EQ ("x : 0", TypedPair<bool> ("x", false).dump());
+}
+
 /******************************************************************************/
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "cursor/Cursor.h"
+#include "cursor/Structure.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::cursor;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    bytes (std::initializer_list<unsigned char> bytes_) {
+        return std::string (bytes_.begin(), bytes_.end());
+    }
+
+    /**
+     * A list32 of [n_] ints, every [every_]th a smallint instead
+     */
+    std::string
+    ints (size_t n_, size_t every_) {
+        std::string body;
+
+        for (size_t i { 0 } ; i < n_ ; ++i) {
+            if (every_ && i % every_ == every_ - 1) {
+                body += bytes ({ 0x54, static_cast<unsigned char> (i) });
+            } else {
+                body += bytes ({ 0x71, 0, 0, 0, static_cast<unsigned char> (i) });
+            }
+        }
+
+        auto size = body.size() + 4;
+        auto rtn = bytes ({ 0xd0,
+            static_cast<unsigned char> (size >> 24U), static_cast<unsigned char> (size >> 16U),
+            static_cast<unsigned char> (size >> 8U), static_cast<unsigned char> (size),
+            static_cast<unsigned char> (n_ >> 24U), static_cast<unsigned char> (n_ >> 16U),
+            static_cast<unsigned char> (n_ >> 8U), static_cast<unsigned char> (n_) });
+
+        return rtn + body;
+    }
+
+}
+
+/******************************************************************************/
+
+/**
+ * A described list holding a string, a map, an array and an empty list
+ */
+TEST (Structure, entries) { // NOLINT
+    auto b = bytes ({
+        0x00, 0x53, 0x10,
+        0xc0, 0x12, 0x04,
+            0xa1, 0x02, 'h', 'i',
+            0xc1, 0x04, 0x02, 0x41, 0x52, 0x07,
+            0xe0, 0x04, 0x02, 0x50, 0x01, 0x02,
+            0x45 });
+
+    Structure structure (b);
+
+    ASSERT_EQ (9U, structure.size());
+
+    EXPECT_EQ (0x00, structure[0].m_code);
+    EXPECT_EQ (b.size(), structure[0].m_size);
+    EXPECT_EQ (9U, structure[0].m_end);
+    EXPECT_EQ (2U, structure[0].m_count);
+
+    auto list = structure.child (0, 1);
+    ASSERT_EQ (2U, list);
+    EXPECT_EQ (0xc0, structure[list].m_code);
+    EXPECT_EQ (3U, structure[list].m_offset);
+    EXPECT_EQ (4U, structure[list].m_count);
+
+    auto map = structure.child (list, 1);
+    ASSERT_EQ (4U, map);
+    EXPECT_EQ (0xc1, structure[map].m_code);
+    EXPECT_EQ (7U, structure[map].m_end);
+    EXPECT_EQ (0x52, structure[structure.child (map, 1)].m_code);
+
+    auto array = structure.child (list, 2);
+    EXPECT_EQ (0xe0, structure[array].m_code);
+    EXPECT_EQ (2U, structure[array].m_count);
+    EXPECT_EQ (array + 1, structure[array].m_end);
+
+    EXPECT_EQ (0x45, structure[structure.child (list, 3)].m_code);
+    EXPECT_EQ (structure.size(), structure.child (list, 4));
+    EXPECT_EQ (structure.size(), structure.child (3, 0));
+
+    EXPECT_EQ (bytes ({ 0xa1, 0x02, 'h', 'i' }), structure.encoded (structure[3]));
+}
+
+/******************************************************************************/
+
+/**
+ * Runs of ints broken by smallints land where the cursor finds them
+ */
+TEST (Structure, runs) { // NOLINT
+    for (size_t every : { 0, 1, 2, 7, 100 }) {
+        auto b = ints (1000, every);
+
+        Structure structure (b);
+        ASSERT_EQ (1001U, structure.size());
+
+        Cursor data (b.data(), b.size());
+        data.enter();
+
+        for (size_t i { 1 } ; data.next() ; ++i) {
+            auto encoded = data.encoded();
+
+            ASSERT_EQ (static_cast<size_t> (encoded.data() - b.data()), structure[i].m_offset) << every;
+            ASSERT_EQ (encoded.size(), structure[i].m_size) << every;
+            ASSERT_EQ (i + 1, structure[i].m_end);
+        }
+    }
+}
+
+/******************************************************************************/
+
+TEST (Structure, malformed) { // NOLINT
+    // truncated, within a run and not
+    EXPECT_THROW (Structure (ints (10, 0).substr (0, 30)), std::runtime_error); // NOLINT
+    EXPECT_THROW (Structure (bytes ({ 0xa1, 0x05, 'h' })), std::runtime_error); // NOLINT
+
+    // more elements than bytes
+    EXPECT_THROW (Structure (bytes ({ 0xc0, 0x02, 0x05, 0x40 })), std::runtime_error); // NOLINT
+
+    // elements running past their list
+    EXPECT_THROW ( // NOLINT
+        Structure (bytes ({ 0xc0, 0x03, 0x01, 0x71, 0, 0, 0, 1 })), std::runtime_error);
+
+    // bytes left within the list after its elements
+    EXPECT_THROW (Structure (bytes ({ 0xc0, 0x03, 0x01, 0x40, 0x40 })), std::runtime_error); // NOLINT
+
+    EXPECT_THROW (Structure (bytes ({ 0x20 })), std::runtime_error); // NOLINT
+
+    // but what follows the value is nothing to do with it
+    EXPECT_EQ (1U, Structure (bytes ({ 0x40, 0x20 })).size());
+}
+
+/******************************************************************************/
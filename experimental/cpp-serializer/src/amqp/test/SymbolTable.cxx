@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "schema/SymbolTable.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::schema;
+
+/******************************************************************************/
+
+TEST (SymbolTable, intern) { // NOLINT
+    SymbolTable st;
+
+    EXPECT_EQ (0U, st.size());
+    EXPECT_EQ (SymbolTable::npos, st.find ("net.corda:a"));
+
+    EXPECT_EQ (0U, st.intern ("net.corda:a"));
+    EXPECT_EQ (1U, st.intern ("net.corda:b"));
+    EXPECT_EQ (0U, st.intern (std::string ("net.corda:a")));
+
+    EXPECT_EQ (2U, st.size());
+    EXPECT_EQ (1U, st.find ("net.corda:b"));
+    EXPECT_EQ ("net.corda:a", st[0]);
+
+    // lookups straight out of a larger buffer
+    std::string blob { "xxnet.corda:byy" };
+    EXPECT_EQ (1U, st.find (std::string_view (blob).substr (2, 11)));
+    EXPECT_EQ (SymbolTable::npos, st.find (std::string_view (blob).substr (2, 10)));
+}
+
+/******************************************************************************/
+
+TEST (SymbolTable, grow) { // NOLINT
+    SymbolTable st;
+
+    for (uint32_t i { 0 } ; i < 1000 ; ++i) {
+        EXPECT_EQ (i, st.intern ("net.corda:" + std::to_string (i)));
+    }
+
+    for (uint32_t i { 0 } ; i < 1000 ; ++i) {
+        EXPECT_EQ (i, st.find ("net.corda:" + std::to_string (i)));
+        EXPECT_EQ ("net.corda:" + std::to_string (i), st[i]);
+    }
+
+    EXPECT_EQ (SymbolTable::npos, st.find ("net.corda:1000"));
+    EXPECT_EQ (1000U, st.size());
+}
+
+/******************************************************************************/
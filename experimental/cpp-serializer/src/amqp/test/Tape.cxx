@@ -0,0 +1,403 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "tape/Tape.h"
+#include "tape/Index.h"
+#include "tape/Pointer.h"
+#include "sink/TapeSink.h"
+#include "sink/JsonSink.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal;
+
+/******************************************************************************/
+
+namespace {
+
+    std::string
+    json (const tape::Tape & tape_) {
+        std::stringstream ss;
+        {
+            sink::JsonSink sink (ss);
+            tape_.write (sink);
+        }
+
+        return ss.str();
+    }
+
+    /**
+     * { "a" : { 1 : [ ], "k" : { } }, "b" : false, "c" : [ 1.5, "xyz", A ] }
+     */
+    void
+    build (tape::Tape & tape_, std::string_view blob_) {
+        sink::TapeSink sink (tape_);
+
+        sink.beginObject();
+        sink.key ("a");
+        sink.beginMap();
+        sink.integer (1);
+        sink.beginList();
+        sink.endList();
+        sink.string ("k");
+        sink.beginObject();
+        sink.endObject();
+        sink.endMap();
+        sink.key ("b");
+        sink.boolean (false);
+        sink.key ("c");
+        sink.beginList();
+        sink.real (1.5);
+        sink.string (blob_.substr (1, 3));
+        sink.symbol ("A");
+        sink.null();
+        sink.endList();
+        sink.endObject();
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Tape, roundTrip) { // NOLINT
+    std::string blob { "-xyz-" };
+    tape::Tape tape (blob.data(), blob.size());
+
+    build (tape, blob);
+
+    EXPECT_EQ (
+        R"({"a":{"1":[],"k":{}},"b":false,"c":[1.5,"xyz","A",null]})",
+        json (tape));
+
+    tape.clear();
+    EXPECT_TRUE (tape.empty());
+    EXPECT_EQ ("", json (tape));
+}
+
+/******************************************************************************/
+
+/**
+ * Binaries view the blob like strings do
+ */
+TEST (Tape, binary) { // NOLINT
+    std::string blob { "-Man-" };
+    tape::Tape tape (blob.data(), blob.size());
+
+    {
+        sink::TapeSink sink (tape);
+        sink.binary (std::string_view (blob).substr (1, 3));
+    }
+
+    EXPECT_EQ (tape::Tape::binary_t, tape.begin().type());
+    EXPECT_EQ (blob.data() + 1, tape.begin().text().data());
+    EXPECT_EQ (R"("TWFu")", json (tape));
+}
+
+/******************************************************************************/
+
+TEST (Tape, navigate) { // NOLINT
+    std::string blob { "-xyz-" };
+    tape::Tape tape (blob.data(), blob.size());
+
+    build (tape, blob);
+
+    auto root = tape.begin();
+    ASSERT_EQ (tape::Tape::object_t, root.type());
+    EXPECT_EQ (3U, root.size());
+    EXPECT_EQ (tape.end(), root.next());
+
+    auto a = root["a"];
+    ASSERT_EQ (tape::Tape::map_t, a.type());
+    EXPECT_EQ (4U, a.size());
+    EXPECT_EQ (1, a.begin().integer());
+    EXPECT_EQ (0U, a.begin().next().size());
+
+    EXPECT_FALSE (root["b"].boolean());
+    EXPECT_EQ (root.end(), root["nope"]);
+
+    auto c = root["c"];
+    ASSERT_EQ (tape::Tape::list_t, c.type());
+    EXPECT_EQ (4U, c.size());
+
+    auto it = c.begin();
+    EXPECT_EQ (1.5, it.real());
+    it = it.next();
+    EXPECT_EQ ("xyz", it.text());
+    // text from the blob is viewed in place
+    EXPECT_EQ (blob.data() + 1, it.text().data());
+    it = it.next();
+    EXPECT_EQ (tape::Tape::symbol_t, it.type());
+    EXPECT_EQ ("A", it.text());
+    it = it.next();
+    EXPECT_EQ (tape::Tape::null_t, it.type());
+    EXPECT_EQ (c.end(), it.next());
+
+    EXPECT_THROW (it.integer(), std::runtime_error);
+    EXPECT_THROW (root["b"].begin(), std::runtime_error);
+
+    std::stringstream ss;
+    {
+        sink::JsonSink sink (ss);
+        tape.write (c, sink);
+    }
+
+    EXPECT_EQ (R"([1.5,"xyz","A",null])", ss.str());
+}
+
+/******************************************************************************/
+
+TEST (Tape, mismatched) { // NOLINT
+    tape::Tape tape (nullptr, 0);
+    sink::TapeSink sink (tape);
+
+    sink.beginList();
+    EXPECT_THROW (sink.endObject(), std::runtime_error);
+    EXPECT_THROW (sink::TapeSink (tape).endList(), std::runtime_error);
+}
+
+/******************************************************************************/
+
+/**
+ * Just the fields asked for, through lists, in the order they're on the
+ * tape
+ */
+TEST (Tape, project) { // NOLINT
+    std::string blob { "-xyz-" };
+    tape::Tape tape (blob.data(), blob.size());
+
+    build (tape, blob);
+
+    auto project = [&tape](const std::vector<std::string> & paths_) {
+        std::stringstream ss;
+        {
+            sink::JsonSink sink (ss);
+            tape.project (tape.begin(), tape::Tape::Paths (paths_), sink);
+        }
+
+        return ss.str();
+    };
+
+    EXPECT_EQ (json (tape), project ({ }));
+    EXPECT_EQ (R"({"b":false,"c":[1.5,"xyz","A",null]})", project ({ "c", "b" }));
+    EXPECT_EQ (R"({"a":{"1":[],"k":{}}})", project ({ "a.k", "a" }));
+    EXPECT_EQ (R"({})", project ({ "nope" }));
+    EXPECT_THROW (project ({ "a." }), std::runtime_error);
+}
+
+/******************************************************************************/
+
+/**
+ * A tape mapped onto another's words reads the same, and one that's
+ * corrupt throws rather than being read beyond
+ */
+TEST (Tape, map) { // NOLINT
+    std::string blob { "-xyz-" };
+    tape::Tape built (blob.data(), blob.size());
+
+    build (built, blob);
+
+    std::vector<uint64_t> words (built.data(), built.data() + built.size());
+    std::string copied { built.copied() };
+
+    tape::Tape mapped (blob.data(), blob.size());
+    mapped.map (words.data(), words.size(), copied, nullptr, 0);
+
+    EXPECT_EQ (json (built), json (mapped));
+    EXPECT_EQ (words.data(), mapped.data());
+
+    // the root claiming to end past the end of the tape
+    words[0] = (uint64_t { tape::Tape::object_t } << tape::Tape::TYPE_SHIFT) | (words.size() + 4);
+    EXPECT_THROW (json (mapped), std::runtime_error);
+
+    // and a string claiming to run on past the blob
+    words = { (uint64_t { tape::Tape::string_t } << tape::Tape::TYPE_SHIFT) | 3, 10 };
+    mapped.map (words.data(), words.size(), copied, nullptr, 0);
+    EXPECT_THROW (json (mapped), std::runtime_error);
+}
+
+/******************************************************************************/
+
+/**
+ * Each unset field is folded into a single word, read back as the key and
+ * the null it stands for, and each key is only copied once
+ */
+TEST (Tape, absent) { // NOLINT
+    tape::Tape tape (nullptr, 0);
+
+    {
+        sink::TapeSink sink (tape);
+
+        sink.beginList();
+
+        for (int i { 0 } ; i < 2 ; ++i) {
+            sink.beginObject();
+            sink.key (std::string ("maybe"));
+            sink.null();
+            sink.key (std::string ("set"));
+            sink.integer (i);
+            sink.key (std::string ("nothing"));
+            sink.null();
+            sink.endObject();
+        }
+
+        sink.null();
+        sink.endList();
+    }
+
+    EXPECT_EQ (
+        R"([{"maybe":null,"set":0,"nothing":null},{"maybe":null,"set":1,"nothing":null},null])",
+        json (tape));
+
+    // each object three words of open and end, two absents and a key and integer
+    EXPECT_EQ (2U + 2 * 9 + 1 + 1, tape.size());
+    EXPECT_EQ ("maybesetnothing", tape.copied());
+
+    auto first = tape.begin().begin();
+    ASSERT_EQ (tape::Tape::object_t, first.type());
+    EXPECT_EQ (3U, first.size());
+
+    auto key = first.begin();
+    EXPECT_EQ (tape::Tape::key_t, key.type());
+    EXPECT_EQ ("maybe", key.text());
+
+    auto value = key.next();
+    EXPECT_EQ (tape::Tape::null_t, value.type());
+    EXPECT_EQ (key.index(), value.index());
+    EXPECT_NE (key, value);
+    EXPECT_EQ ("set", value.next().text());
+
+    EXPECT_EQ (tape::Tape::null_t, first["nothing"].type());
+    EXPECT_EQ (first.end(), first["nothing"].next());
+    EXPECT_EQ (first.end(), first["nope"]);
+
+    std::stringstream ss;
+    {
+        sink::JsonSink sink (ss);
+        tape.write (first["nothing"], sink);
+    }
+
+    EXPECT_EQ ("null", ss.str());
+
+    std::vector<uint64_t> words (tape.data(), tape.data() + tape.size());
+    std::string copied { tape.copied() };
+
+    tape::Tape mapped (nullptr, 0);
+    mapped.map (words.data(), words.size(), copied, nullptr, 0);
+
+    EXPECT_EQ (json (tape), json (mapped));
+}
+
+/******************************************************************************/
+
+TEST (Tape, pointer) { // NOLINT
+    EXPECT_TRUE (tape::Pointer ("").empty());
+
+    tape::Pointer p ("/states/4123/a~1b/m~0n//07");
+    ASSERT_EQ (6U, p.size());
+
+    EXPECT_EQ ("states", p.tokens()[0].name());
+    EXPECT_EQ (tape::Pointer::npos, p.tokens()[0].index());
+    EXPECT_EQ (4123U, p.tokens()[1].index());
+    EXPECT_EQ ("a/b", p.tokens()[2].name());
+    EXPECT_EQ ("m~n", p.tokens()[3].name());
+    EXPECT_EQ ("", p.tokens()[4].name());
+
+    // a leading zero makes it a name and nothing else
+    EXPECT_EQ ("07", p.tokens()[5].name());
+    EXPECT_EQ (tape::Pointer::npos, p.tokens()[5].index());
+
+    EXPECT_EQ (0U, tape::Pointer ("/0").tokens()[0].index());
+
+    EXPECT_THROW (tape::Pointer ("states"), std::runtime_error);
+    EXPECT_THROW (tape::Pointer ("/a~2"), std::runtime_error);
+    EXPECT_THROW (tape::Pointer ("/a~"), std::runtime_error);
+}
+
+/******************************************************************************/
+
+TEST (Tape, index) { // NOLINT
+    std::string blob { "-xyz-" };
+    tape::Tape tape (blob.data(), blob.size());
+
+    build (tape, blob);
+
+    tape::Index index (tape);
+
+    // { "a" : { 1 : [ ], "k" : { } }, "b" : false, "c" : [ 1.5, "xyz", A, null ] }
+    EXPECT_EQ (tape.begin(), index.at (""));
+    EXPECT_EQ (tape.begin()["a"], index.at ("/a"));
+    EXPECT_EQ (tape::Tape::list_t, index.at ("/a/1").type());
+    EXPECT_EQ (tape::Tape::object_t, index.at ("/a/k").type());
+    EXPECT_FALSE (index.at ("/b").boolean());
+    EXPECT_EQ (1.5, index.at ("/c/0").real());
+    EXPECT_EQ ("xyz", index.at ("/c/1").text());
+    EXPECT_EQ ("A", index.at ("/c/2").text());
+    EXPECT_EQ (tape::Tape::null_t, index.at ("/c/3").type());
+
+    // nothing there
+    EXPECT_EQ (tape.end(), index.at ("/c/4"));
+    EXPECT_EQ (tape.end(), index.at ("/c/x"));
+    EXPECT_EQ (tape.end(), index.at ("/nope"));
+    EXPECT_EQ (tape.end(), index.at ("/b/0"));
+    EXPECT_EQ (tape.end(), index.at ("/a/2"));
+    EXPECT_EQ (tape.end(), index.at ("/a/1/0"));
+
+    // the root and the empty object in "a"
+    EXPECT_EQ (2U, index.shapes());
+    EXPECT_LT (0U, index.bytes());
+
+    tape::Tape empty (nullptr, 0);
+    EXPECT_EQ (empty.end(), tape::Index (empty).at ("/a"));
+}
+
+/******************************************************************************/
+
+/**
+ * Objects with the same fields share a shape, absent fields and all, and
+ * a field's found wherever it sits
+ */
+TEST (Tape, indexShapes) { // NOLINT
+    tape::Tape tape (nullptr, 0);
+
+    {
+        sink::TapeSink sink (tape);
+
+        sink.beginList();
+
+        for (int i { 0 } ; i < 100 ; ++i) {
+            sink.beginObject();
+            sink.key (std::string ("maybe"));
+            sink.null();
+            sink.key (std::string ("set"));
+            sink.integer (i);
+            sink.key (std::string ("nested"));
+            sink.beginObject();
+            sink.key (std::string ("value"));
+            sink.integer (i * 2);
+            sink.endObject();
+            sink.endObject();
+        }
+
+        sink.endList();
+    }
+
+    tape::Index index (tape);
+
+    EXPECT_EQ (2U, index.shapes());
+
+    for (size_t i { 0 } ; i < 100 ; ++i) {
+        auto at = "/" + std::to_string (i);
+
+        EXPECT_EQ (static_cast<int64_t> (i), index.at (at + "/set").integer());
+        EXPECT_EQ (static_cast<int64_t> (i * 2), index.at (tape::Pointer (at + "/nested/value")).integer());
+        EXPECT_EQ (tape::Tape::null_t, index.at (at + "/maybe").type());
+        EXPECT_EQ (tape.begin().begin()["maybe"].type(), index.at ("/0/maybe").type());
+    }
+
+    EXPECT_EQ (tape.end(), index.at ("/100/set"));
+    EXPECT_EQ (tape.end(), index.at ("/0/maybe/x"));
+}
+
+/******************************************************************************/
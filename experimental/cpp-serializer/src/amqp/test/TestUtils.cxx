@@ -1,5 +1,6 @@
 #include "TestUtils.h"
 
+#include <iostream>
 #include <algorithm>
 #include <string>
 #include "types.h"
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <cstdint>
+
+#include "format/Text.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::format;
+
+/******************************************************************************/
+
+namespace {
+
+    /**
+     * A decimal128 of [coefficient_] x 10^[exponent_], most significant
+     * byte first
+     */
+    std::string
+    decimal (uint64_t coefficient_, int exponent_, bool negative_ = false) {
+        uint64_t hi = static_cast<uint64_t>(exponent_ + 6176) << 49U;
+        if (negative_) hi |= uint64_t { 1 } << 63U;
+
+        std::string rtn;
+        for (int i { 56 } ; i >= 0 ; i -= 8) rtn += static_cast<char>(hi >> i);
+        for (int i { 56 } ; i >= 0 ; i -= 8) rtn += static_cast<char>(coefficient_ >> i);
+
+        return rtn;
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (Text, utf8) { // NOLINT
+    EXPECT_EQ ("a", Utf8 (U'a').view());
+    EXPECT_EQ ("\xc3\xa9", Utf8 (U'é').view());
+    EXPECT_EQ ("\xe2\x82\xac", Utf8 (U'€').view());
+    EXPECT_EQ ("\xf0\x9f\x98\x80", Utf8 (U'\U0001F600').view());
+
+    // a surrogate and something past the last code point
+    EXPECT_EQ ("\xef\xbf\xbd", Utf8 (char32_t { 0xD800 }).view());
+    EXPECT_EQ ("\xef\xbf\xbd", Utf8 (char32_t { 0x110000 }).view());
+}
+
+/******************************************************************************/
+
+TEST (Text, iso8601) { // NOLINT
+    EXPECT_EQ ("1970-01-01T00:00:00.000Z", Iso8601 (0).view());
+    EXPECT_EQ ("2019-03-04T10:11:12.345Z", Iso8601 (1551694272345).view());
+    EXPECT_EQ ("2000-02-29T23:59:59.999Z", Iso8601 (951868799999).view());
+    EXPECT_EQ ("1969-12-31T23:59:59.999Z", Iso8601 (-1).view());
+    EXPECT_EQ ("0001-01-01T00:00:00.000Z", Iso8601 (-62135596800000).view());
+    EXPECT_EQ ("-0001-01-01T00:00:00.000Z", Iso8601 (-62198755200000).view());
+    EXPECT_EQ ("292278994-08-17T07:12:55.807Z", Iso8601 (INT64_MAX).view());
+}
+
+/******************************************************************************/
+
+TEST (Text, uuid) { // NOLINT
+    const char bytes[] = "\x12\x34\x56\x78\x9a\xbc\xde\xf0\x01\x23\x45\x67\x89\xab\xcd\xef";
+
+    EXPECT_EQ ("12345678-9abc-def0-0123-456789abcdef", Uuid (bytes).view());
+}
+
+/******************************************************************************/
+
+TEST (Text, decimal) { // NOLINT
+    EXPECT_EQ ("0", Decimal (decimal (0, 0).data()).view());
+    EXPECT_EQ ("123", Decimal (decimal (123, 0).data()).view());
+    EXPECT_EQ ("1.23", Decimal (decimal (123, -2).data()).view());
+    EXPECT_EQ ("-1.23", Decimal (decimal (123, -2, true).data()).view());
+    EXPECT_EQ ("0.00123", Decimal (decimal (123, -5).data()).view());
+    EXPECT_EQ ("1.23E+5", Decimal (decimal (123, 3).data()).view());
+    EXPECT_EQ ("1.23E-8", Decimal (decimal (123, -10).data()).view());
+    EXPECT_EQ ("0E+2", Decimal (decimal (0, 2).data()).view());
+
+    std::string nan (16, '\0');
+    nan[0] = '\x7c';
+    EXPECT_EQ ("NaN", Decimal (nan.data()).view());
+
+    std::string inf (16, '\0');
+    inf[0] = '\xf8';
+    EXPECT_EQ ("-Infinity", Decimal (inf.data()).view());
+}
+
+/******************************************************************************/
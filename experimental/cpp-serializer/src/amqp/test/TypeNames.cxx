@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "schema/TypeNames.h"
+#include "restricted-types/Array.h"
+
+/******************************************************************************/
+
+using namespace amqp::internal::schema;
+
+/******************************************************************************/
+
+TEST (TypeNames, kinds) { // NOLINT
+    auto & names = TypeNames::instance();
+
+    EXPECT_EQ (TypeName::any_t, names.parse ("*").kind());
+    EXPECT_EQ (TypeName::primitive_t, names.parse ("int").kind());
+    EXPECT_EQ (TypeName::class_t, names.parse ("net.corda.Foo").kind());
+    EXPECT_EQ (TypeName::generic_t, names.parse ("java.util.List<int>").kind());
+    EXPECT_EQ (TypeName::array_t, names.parse ("net.corda.Foo[]").kind());
+    EXPECT_EQ (TypeName::packed_t, names.parse ("int[p]").kind());
+
+    // boxed primitives are classes that unbox to the primitive
+    const auto & boxed = names.parse ("java.lang.Integer");
+    EXPECT_EQ (TypeName::class_t, boxed.kind());
+    EXPECT_EQ ("int", boxed.unboxed());
+
+    // nor do short names trip up finding a suffix
+    EXPECT_EQ (TypeName::class_t, names.parse ("[]").kind());
+    EXPECT_EQ (TypeName::class_t, names.parse ("a").kind());
+}
+
+/******************************************************************************/
+
+TEST (TypeNames, generics) { // NOLINT
+    auto & names = TypeNames::instance();
+
+    const auto & map = names.parse (
+            "java.util.Map<java.lang.String, java.util.List<net.corda.Foo>>");
+
+    EXPECT_EQ ("java.util.Map", map.base());
+    ASSERT_EQ (2U, map.args().size());
+    EXPECT_EQ ("java.lang.String", names[map.args()[0]].name());
+
+    const auto & list = names[map.args()[1]];
+    EXPECT_EQ ("java.util.List<net.corda.Foo>", list.name());
+    EXPECT_EQ (TypeName::generic_t, list.kind());
+    EXPECT_EQ ("net.corda.Foo", names[list.args().front()].name());
+
+    // arguments keep their own spelling, only the space around them goes
+    const auto & pair = names.parse ("java.util.Map<java.util.Pair<int, int>, string>");
+    EXPECT_EQ ("java.util.Pair<int, int>", names[pair.args()[0]].name());
+
+    // anything that won't balance is just a name
+    EXPECT_EQ (TypeName::class_t, names.parse ("java.util.List<int").kind());
+    EXPECT_EQ (TypeName::class_t, names.parse ("java.util.List<int>>").kind());
+}
+
+/******************************************************************************/
+
+TEST (TypeNames, arrays) { // NOLINT
+    auto & names = TypeNames::instance();
+
+    const auto & nested = names.parse ("int[p][]");
+    EXPECT_EQ (TypeName::array_t, nested.kind());
+    EXPECT_EQ ("int[p]", names[nested.args().front()].name());
+
+    EXPECT_EQ ("int[p]", Array::arrayType ("int[p][]"));
+    EXPECT_EQ ("java.util.List<int>", Array::arrayType ("java.util.List<int>[]"));
+    EXPECT_TRUE (Array::isArrayType ("net.corda.Foo[]"));
+    EXPECT_FALSE (Array::isArrayType ("java.util.List<int[]>"));
+}
+
+/******************************************************************************/
+
+TEST (TypeNames, interned) { // NOLINT
+    auto & names = TypeNames::instance();
+
+    const auto & a = names.parse ("java.util.List<java.util.List<net.corda.Interned>>");
+    auto size = names.size();
+
+    // parsed once, the same name again is found, not parsed
+    const auto & b = names.parse ("java.util.List<java.util.List<net.corda.Interned>>");
+    EXPECT_EQ (&a, &b);
+    EXPECT_EQ (size, names.size());
+
+    // as is an argument already seen within another name
+    EXPECT_EQ (a.args().front(), names.parse ("java.util.List<net.corda.Interned>").id());
+    EXPECT_EQ (size, names.size());
+
+    EXPECT_EQ (&a, &names[a.id()]);
+}
+
+/******************************************************************************/
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "TypeNotationGraph.h"
+
+/******************************************************************************/
+
+namespace {
+
+    class TN {
+        private :
+            std::string m_name;
+            std::vector<std::string> m_dependsOn;
+
+        public :
+            TN (std::string name_, std::vector<std::string> dependsOn_)
+                : m_name (std::move (name_))
+                , m_dependsOn (std::move (dependsOn_))
+            { }
+
+            const std::string & name() const { return m_name; }
+
+            std::vector<std::string_view> dependencies() const {
+                return { m_dependsOn.begin(), m_dependsOn.end() };
+            }
+    };
+
+    using Graph = amqp::internal::schema::TypeNotationGraph<TN>;
+
+    /**
+     * Levels separated by a "|"
+     */
+    std::string
+    str (const Graph & graph_) {
+        std::stringstream ss;
+
+        auto first { true };
+        for (const auto & level : graph_) {
+            if (!first) ss << " | ";
+            first = false;
+
+            auto firstInLevel { true };
+            for (const auto & tn : level) {
+                if (!firstInLevel) ss << " ";
+                firstInLevel = false;
+
+                ss << tn->name();
+            }
+        }
+
+        return ss.str();
+    }
+
+    void
+    add (Graph & graph_, std::string name_, std::vector<std::string> deps_ = { }) {
+        graph_.insert (std::make_unique<TN> (std::move (name_), std::move (deps_)));
+    }
+
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, empty) { // NOLINT
+    Graph graph;
+    graph.order();
+
+    EXPECT_EQ ("", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, unordered) { // NOLINT
+    Graph graph;
+    add (graph, "A");
+
+    EXPECT_THROW (graph.begin(), std::runtime_error); // NOLINT
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, independent) { // NOLINT
+    Graph graph;
+    add (graph, "A");
+    add (graph, "B");
+    add (graph, "C");
+    graph.order();
+
+    EXPECT_EQ ("A B C", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, chain) { // NOLINT
+    Graph graph;
+    add (graph, "C");
+    add (graph, "A", { "B" });
+    add (graph, "B", { "C" });
+    graph.order();
+
+    EXPECT_EQ ("C | B | A", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, diamond) { // NOLINT
+    Graph graph;
+    add (graph, "D");
+    add (graph, "B", { "D" });
+    add (graph, "C", { "D", "int" });
+    add (graph, "A", { "B", "C" });
+    graph.order();
+
+    EXPECT_EQ ("D | B C | A", str (graph));
+}
+
+/******************************************************************************/
+
+/**
+ * A type is pushed above the longest chain of types it depends on
+ */
+TEST (TypeNotationGraph, longest) { // NOLINT
+    Graph graph;
+    add (graph, "A", { "B", "D" });
+    add (graph, "B", { "C" });
+    add (graph, "C", { "D" });
+    add (graph, "D");
+    add (graph, "E", { "A" });
+    graph.order();
+
+    EXPECT_EQ ("D | C | B | A | E", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, self) { // NOLINT
+    Graph graph;
+    add (graph, "A", { "A", "B" });
+    add (graph, "B");
+    graph.order();
+
+    EXPECT_EQ ("B | A", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, cycle) { // NOLINT
+    Graph graph;
+    add (graph, "A", { "B" });
+    add (graph, "B", { "C" });
+    add (graph, "C", { "B" });
+    add (graph, "D");
+    graph.order();
+
+    EXPECT_EQ ("D | A B C", str (graph));
+}
+
+/******************************************************************************/
+
+TEST (TypeNotationGraph, random) { // NOLINT
+    std::mt19937 rng (1);
+
+    const int n { 500 };
+
+    Graph graph;
+    for (int i { 0 } ; i < n ; ++i) {
+        std::vector<std::string> deps;
+
+        // only ever depend on later types so there's no cycle
+        for (int j { i + 1 } ; j < n ; ++j) {
+            if (rng() % 50 == 0) deps.push_back (std::to_string (j));
+        }
+
+        add (graph, std::to_string (i), std::move (deps));
+    }
+
+    graph.order();
+
+    std::map<std::string, int> levels;
+
+    int l { 0 };
+    for (const auto & level : graph) {
+        for (const auto & tn : level) {
+            levels[tn->name()] = l;
+        }
+        ++l;
+    }
+
+    ASSERT_EQ (n, levels.size());
+
+    for (const auto & level : graph) {
+        for (const auto & tn : level) {
+            for (const auto & dep : tn->dependencies()) {
+                EXPECT_GT (levels[tn->name()], levels[std::string (dep)]);
+            }
+        }
+    }
+}
+
+/******************************************************************************/